@@ -44,9 +44,12 @@
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/ReplacementsYaml.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/CachingFileSystem.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
 #include <utility>
 
 using namespace clang::ast_matchers;
@@ -393,6 +396,8 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
     Profiling = std::make_unique<ClangTidyProfiling>(
         Context.getProfileStorageParams());
     FinderOptions.CheckProfiling.emplace(Profiling->Records);
+    FinderOptions.CheckProfiling->PerMatcher =
+        Context.getEnableMatcherProfiling();
   }
 
   std::unique_ptr<ast_matchers::MatchFinder> Finder(
@@ -565,6 +570,46 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
   return DiagConsumer.take();
 }
 
+std::vector<ClangTidyError> runClangTidyInParallel(
+    ClangTidyContext &Context,
+    llvm::function_ref<std::unique_ptr<ClangTidyContext>()> CreateContext,
+    const CompilationDatabase &Compilations, ArrayRef<std::string> InputFiles,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+    unsigned NumThreads, bool EnableCheckProfile,
+    llvm::StringRef StoreCheckProfile) {
+  NumThreads = std::max(1u, std::min<unsigned>(NumThreads, InputFiles.size()));
+  std::vector<std::unique_ptr<ClangTidyContext>> Contexts;
+  for (unsigned I = 0; I < NumThreads; ++I)
+    Contexts.push_back(CreateContext());
+
+  // The caching file systems have working directories of their own and only
+  // pass absolute paths to BaseFS, whose working directory never changes.
+  llvm::vfs::SharedFileSystemCache Cache;
+  std::vector<std::vector<ClangTidyError>> ErrorsPerFile(InputFiles.size());
+  std::atomic<size_t> NextFile(0);
+  llvm::ThreadPool Pool(NumThreads);
+  for (const std::unique_ptr<ClangTidyContext> &WorkerContext : Contexts) {
+    Pool.async([&, Worker = WorkerContext.get()] {
+      IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> WorkerFS(
+          new llvm::vfs::OverlayFileSystem(
+              llvm::vfs::createCachingFileSystem(Cache, BaseFS)));
+      for (size_t I = NextFile++; I < InputFiles.size(); I = NextFile++)
+        ErrorsPerFile[I] =
+            runClangTidy(*Worker, Compilations, InputFiles[I], WorkerFS,
+                         EnableCheckProfile, StoreCheckProfile);
+    });
+  }
+  Pool.wait();
+
+  std::vector<ClangTidyError> Errors;
+  for (std::vector<ClangTidyError> &FileErrors : ErrorsPerFile)
+    std::move(FileErrors.begin(), FileErrors.end(), std::back_inserter(Errors));
+  sortAndDeduplicateErrors(Errors);
+  for (const std::unique_ptr<ClangTidyContext> &WorkerContext : Contexts)
+    Context.addStats(WorkerContext->getStats());
+  return Errors;
+}
+
 void handleErrors(llvm::ArrayRef<ClangTidyError> Errors,
                   ClangTidyContext &Context, bool Fix,
                   unsigned &WarningsAsErrorsCount,
@@ -12,6 +12,7 @@
 #include "ClangTidyCheck.h"
 #include "ClangTidyDiagnosticConsumer.h"
 #include "ClangTidyOptions.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
 #include <vector>
@@ -79,6 +80,24 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
              bool EnableCheckProfile = false,
              llvm::StringRef StoreCheckProfile = StringRef());
 
+/// \brief Runs clang-tidy like \c runClangTidy, processing up to
+/// \p NumThreads translation units in parallel in this process.
+///
+/// Each thread uses a \c ClangTidyContext of its own created by
+/// \p CreateContext, and all of them read the files through a single cache
+/// over \p BaseFS, so that the headers shared by the translation units are
+/// only read once. \p Compilations must allow concurrent queries. The
+/// statistics of the threads are added to \p Context, and the diagnostics are
+/// sorted and deduplicated as \c runClangTidy does.
+std::vector<ClangTidyError> runClangTidyInParallel(
+    ClangTidyContext &Context,
+    llvm::function_ref<std::unique_ptr<ClangTidyContext>()> CreateContext,
+    const tooling::CompilationDatabase &Compilations,
+    ArrayRef<std::string> InputFiles,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+    unsigned NumThreads, bool EnableCheckProfile = false,
+    llvm::StringRef StoreCheckProfile = StringRef());
+
 // FIXME: This interface will need to be significantly extended to be useful.
 // FIXME: Implement confidence levels for displaying/fixing errors.
 //
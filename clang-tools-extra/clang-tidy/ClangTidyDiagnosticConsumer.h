@@ -165,10 +165,18 @@ public:
   /// counters.
   const ClangTidyStats &getStats() const { return Stats; }
 
+  /// \brief Adds the counters of \p Other, collected by another context, to
+  /// the statistics of this one.
+  void addStats(const ClangTidyStats &Other);
+
   /// \brief Control profile collection in clang-tidy.
   void setEnableProfiling(bool Profile);
   bool getEnableProfiling() const { return Profile; }
 
+  /// \brief Control whether profiles time each matcher of a check separately.
+  void setEnableMatcherProfiling(bool Profile) { MatcherProfile = Profile; }
+  bool getEnableMatcherProfiling() const { return MatcherProfile; }
+
   /// \brief Control storage of profile date.
   void setProfileStoragePrefix(StringRef ProfilePrefix);
   llvm::Optional<ClangTidyProfiling::StorageParams>
@@ -221,6 +229,7 @@ private:
   llvm::DenseMap<unsigned, std::string> CheckNamesByDiagnosticID;
 
   bool Profile;
+  bool MatcherProfile;
   std::string ProfilePrefix;
 
   bool AllowEnablingAnalyzerAlphaCheckers;
@@ -243,6 +252,15 @@ bool ShouldSuppressDiagnostic(DiagnosticsEngine::Level DiagLevel,
                               const Diagnostic &Info, ClangTidyContext &Context,
                               bool CheckMacroExpansion = true);
 
+/// \brief Sorts \p Errors by location and removes the duplicates. If
+/// \p RemoveIncompatibleErrors is true, the fixes that overlap with other fixes
+/// are dropped as well.
+///
+/// \c ClangTidyDiagnosticConsumer::take() does this with the diagnostics it
+/// captured; it is also useful to combine the diagnostics of several consumers.
+void sortAndDeduplicateErrors(std::vector<ClangTidyError> &Errors,
+                              bool RemoveIncompatibleErrors = true);
+
 /// \brief A diagnostic consumer that turns each \c Diagnostic into a
 /// \c SourceManager-independent \c ClangTidyError.
 //
@@ -265,7 +283,6 @@ public:
 
 private:
   void finalizeLastError();
-  void removeIncompatibleErrors();
 
   /// \brief Returns the \c HeaderFilter constructed for the options set in the
   /// context.
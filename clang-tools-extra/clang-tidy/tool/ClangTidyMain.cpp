@@ -20,6 +20,7 @@
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 
 using namespace clang::ast_matchers;
 using namespace clang::driver;
@@ -182,6 +183,16 @@ report to stderr.
                                         cl::init(false),
                                         cl::cat(ClangTidyCategory));
 
+static cl::opt<bool> EnableMatcherProfile("enable-matcher-profile",
+                                          cl::desc(R"(
+With -enable-check-profile, time each AST
+matcher of a check separately. The matchers are
+named after the check, the kind of node they
+match and their position among its matchers.
+)"),
+                                          cl::init(false),
+                                          cl::cat(ClangTidyCategory));
+
 static cl::opt<std::string> StoreCheckProfile("store-check-profile",
                                               cl::desc(R"(
 By default reports are printed in tabulated
@@ -216,6 +227,14 @@ options are specified.
                            cl::init(false),
                            cl::cat(ClangTidyCategory));
 
+static cl::opt<unsigned> Jobs("j", cl::desc(R"(
+Number of translation units to process in
+parallel within this process, which then share
+the files they read. 0 means one for each
+hardware thread.
+)"),
+                              cl::init(1), cl::cat(ClangTidyCategory));
+
 static cl::opt<std::string> VfsOverlay("vfsoverlay", cl::desc(R"(
 Overlay the virtual filesystem described by file
 over the real file system.
@@ -426,9 +445,23 @@ static int clangTidyMain(int argc, const char **argv) {
 
   ClangTidyContext Context(std::move(OwningOptionsProvider),
                            AllowEnablingAnalyzerAlphaCheckers);
-  std::vector<ClangTidyError> Errors =
-      runClangTidy(Context, OptionsParser.getCompilations(), PathList, BaseFS,
-                   EnableCheckProfile, ProfilePrefix);
+  Context.setEnableMatcherProfiling(EnableMatcherProfile);
+  unsigned NumThreads = Jobs == 0 ? llvm::hardware_concurrency() : Jobs;
+  std::vector<ClangTidyError> Errors;
+  if (NumThreads > 1 && PathList.size() > 1) {
+    auto CreateContext = [&] {
+      auto ThreadContext = std::make_unique<ClangTidyContext>(
+          createOptionsProvider(BaseFS), AllowEnablingAnalyzerAlphaCheckers);
+      ThreadContext->setEnableMatcherProfiling(EnableMatcherProfile);
+      return ThreadContext;
+    };
+    Errors = runClangTidyInParallel(
+        Context, CreateContext, OptionsParser.getCompilations(), PathList,
+        BaseFS, NumThreads, EnableCheckProfile, ProfilePrefix);
+  } else {
+    Errors = runClangTidy(Context, OptionsParser.getCompilations(), PathList,
+                          BaseFS, EnableCheckProfile, ProfilePrefix);
+  }
   bool FoundErrors = llvm::find_if(Errors, [](const ClangTidyError &E) {
                        return E.DiagLevel == ClangTidyError::Error;
                      }) != Errors.end();
@@ -1074,6 +1074,16 @@ void ClangdLSPServer::onSymbolInfo(const TextDocumentPositionParams &Params,
                      std::move(Reply));
 }
 
+void ClangdLSPServer::onMemoryUsage(
+    const NoParams &, Callback<std::vector<FileMemoryUsage>> Reply) {
+  std::vector<FileMemoryUsage> Result;
+  for (const auto &FileAndBytes : Server->getUsedBytesPerFile())
+    Result.push_back(
+        {URIForFile::canonicalize(FileAndBytes.first, FileAndBytes.first),
+         FileAndBytes.second});
+  Reply(std::move(Result));
+}
+
 ClangdLSPServer::ClangdLSPServer(
     class Transport &Transp, const FileSystemProvider &FSProvider,
     const clangd::CodeCompleteOptions &CCOpts,
@@ -1116,6 +1126,7 @@ ClangdLSPServer::ClangdLSPServer(
   MsgHandler->bind("textDocument/symbolInfo", &ClangdLSPServer::onSymbolInfo);
   MsgHandler->bind("textDocument/typeHierarchy", &ClangdLSPServer::onTypeHierarchy);
   MsgHandler->bind("typeHierarchy/resolve", &ClangdLSPServer::onResolveTypeHierarchy);
+  MsgHandler->bind("$/memoryUsage", &ClangdLSPServer::onMemoryUsage);
   // clang-format on
 }
 
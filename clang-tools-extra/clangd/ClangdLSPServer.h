@@ -107,6 +107,7 @@ private:
   void onChangeConfiguration(const DidChangeConfigurationParams &);
   void onSymbolInfo(const TextDocumentPositionParams &,
                     Callback<std::vector<SymbolDetails>>);
+  void onMemoryUsage(const NoParams &, Callback<std::vector<FileMemoryUsage>>);
 
   std::vector<Fix> getFixes(StringRef File, const clangd::Diagnostic &D);
 
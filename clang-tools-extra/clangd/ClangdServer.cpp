@@ -198,6 +198,19 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
     if (isCancelled())
       return CB(llvm::make_error<CancelledError>());
 
+    // If the user only typed more of the identifier being completed, filter
+    // the previous results instead of running Sema again.
+    llvm::Optional<CodeCompleteResult> Refined;
+    {
+      std::lock_guard<std::mutex> Lock(CachedCompletionMutex);
+      auto Cached = CachedCompletionByFile.find(File);
+      if (Cached != CachedCompletionByFile.end())
+        Refined = refineCachedCompletion(Cached->second, IP->Contents, Pos,
+                                         CodeCompleteOpts);
+    }
+    if (Refined)
+      return CB(std::move(*Refined));
+
     llvm::Optional<SpeculativeFuzzyFind> SpecFuzzyFind;
     if (!IP->Preamble) {
       // No speculation in Fallback mode, as it's supposed to be much faster
@@ -219,6 +232,14 @@ void ClangdServer::codeComplete(PathRef File, Position Pos,
     CodeCompleteResult Result = clangd::codeComplete(
         File, IP->Command, IP->Preamble, IP->Contents, Pos, FS,
         CodeCompleteOpts, SpecFuzzyFind ? SpecFuzzyFind.getPointer() : nullptr);
+    {
+      // Only results with all the candidates can be refined later.
+      std::lock_guard<std::mutex> Lock(CachedCompletionMutex);
+      if (!Result.HasMore && Result.RanParser)
+        CachedCompletionByFile[File] = {IP->Contents, Pos, Result};
+      else
+        CachedCompletionByFile.erase(File);
+    }
     {
       clang::clangd::trace::Span Tracer("Completion results callback");
       CB(std::move(Result));
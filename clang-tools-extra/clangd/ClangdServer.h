@@ -333,6 +333,11 @@ private:
       CachedCompletionFuzzyFindRequestByFile;
   mutable std::mutex CachedCompletionFuzzyFindRequestMutex;
 
+  // The last code completion in each file, if it had all the results.
+  // GUARDED_BY(CachedCompletionMutex)
+  llvm::StringMap<CachedCompletion> CachedCompletionByFile;
+  mutable std::mutex CachedCompletionMutex;
+
   llvm::Optional<std::string> WorkspaceRoot;
   // WorkScheduler has to be the last member, because its destructor has to be
   // called before all other members to stop the worker thread that references
@@ -53,6 +53,7 @@ struct PreambleData {
                std::unique_ptr<PreambleFileStatusCache> StatCache,
                CanonicalIncludes CanonIncludes);
 
+  // The command the preamble was built with.
   tooling::CompileCommand CompileCommand;
   PrecompiledPreamble Preamble;
   std::vector<Diag> Diags;
@@ -169,6 +170,13 @@ buildPreamble(PathRef FileName, CompilerInvocation &CI,
               const ParseInputs &Inputs, bool StoreInMemory,
               PreambleParsedCallback PreambleCallback);
 
+/// Returns true if \p Preamble can be used to build the AST for \p Inputs,
+/// i.e. the compile command, the preamble region of the main file and the
+/// headers it includes did not change.
+bool isPreambleCompatible(const PreambleData &Preamble, PathRef FileName,
+                          const CompilerInvocation &CI,
+                          const ParseInputs &Inputs);
+
 /// Build an AST from provided user inputs. This function does not check if
 /// preamble can be reused, as this function expects that \p Preamble is the
 /// result of calling buildPreamble.
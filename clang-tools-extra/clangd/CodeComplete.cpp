@@ -1737,6 +1737,70 @@ codeComplete(PathRef FileName, const tooling::CompileCommand &Command,
                    {FileName, Command, Preamble, Contents, *Offset, VFS});
 }
 
+llvm::Optional<CodeCompleteResult>
+refineCachedCompletion(const CachedCompletion &Cached,
+                       llvm::StringRef Contents, Position Pos,
+                       const CodeCompleteOptions &Opts) {
+  if (Cached.Result.HasMore || !Cached.Result.RanParser ||
+      Pos.line != Cached.Pos.line)
+    return None;
+  auto OldOffset = positionToOffset(Cached.Contents, Cached.Pos);
+  if (!OldOffset) {
+    llvm::consumeError(OldOffset.takeError());
+    return None;
+  }
+  auto Offset = positionToOffset(Contents, Pos);
+  if (!Offset) {
+    llvm::consumeError(Offset.takeError());
+    return None;
+  }
+  // The new contents must be the old ones with identifier characters inserted
+  // at the old completion point, so that Sema would see the same context.
+  llvm::StringRef OldContents = Cached.Contents;
+  if (*Offset <= *OldOffset ||
+      Contents.size() - *Offset != OldContents.size() - *OldOffset ||
+      Contents.take_front(*OldOffset) != OldContents.take_front(*OldOffset) ||
+      Contents.drop_front(*Offset) != OldContents.drop_front(*OldOffset))
+    return None;
+  llvm::StringRef Typed = Contents.slice(*OldOffset, *Offset);
+  if (!llvm::all_of(Typed, [](char C) { return isIdentifierBody(C); }))
+    return None;
+
+  trace::Span Tracer("RefineCachedCompletion");
+  FuzzyMatcher Filter(guessCompletionPrefix(Contents, *Offset).Name);
+  CodeCompleteResult Output;
+  Output.Context = Cached.Result.Context;
+  for (const CodeCompletion &C : Cached.Result.Completions) {
+    // Like CodeCompleteFlow, only match macros by prefix.
+    if (C.Kind == CompletionItemKind::Text &&
+        bool(C.Origin & SymbolOrigin::AST) &&
+        !llvm::StringRef(C.Name).startswith_lower(Filter.pattern()))
+      continue;
+    auto NameMatch = Filter.match(C.Name);
+    if (!NameMatch)
+      continue;
+    Output.Completions.push_back(C);
+    CodeCompletion &Refined = Output.Completions.back();
+    Refined.Score.Total = C.Score.ExcludingName * *NameMatch;
+    // The typed characters are ASCII, each is one UTF-16 code unit.
+    Refined.CompletionTokenRange.end.character += Typed.size();
+  }
+  llvm::sort(Output.Completions,
+             [](const CodeCompletion &L, const CodeCompletion &R) {
+               if (L.Score.Total != R.Score.Total)
+                 return L.Score.Total > R.Score.Total;
+               return L.Name < R.Name; // Earlier name is better.
+             });
+  if (Opts.Limit && Output.Completions.size() > Opts.Limit) {
+    Output.Completions.resize(Opts.Limit);
+    Output.HasMore = true;
+  }
+  SPAN_ATTACH(Tracer, "returned_results", int64_t(Output.Completions.size()));
+  log("Code complete: refined {0} cached results to {1}.",
+      Cached.Result.Completions.size(), Output.Completions.size());
+  return Output;
+}
+
 SignatureHelp signatureHelp(PathRef FileName,
                             const tooling::CompileCommand &Command,
                             const PreambleData *Preamble,
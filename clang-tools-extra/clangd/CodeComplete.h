@@ -238,6 +238,16 @@ struct SpeculativeFuzzyFind {
   std::future<SymbolSlab> Result;
 };
 
+/// A past code completion whose results can be refined without running Sema
+/// again, while the user keeps typing the same identifier.
+struct CachedCompletion {
+  /// The file contents and position the completion ran at.
+  std::string Contents;
+  Position Pos;
+  /// All the completions in that context, i.e. HasMore is false.
+  CodeCompleteResult Result;
+};
+
 /// Gets code completions at a specified \p Pos in \p FileName.
 ///
 /// If \p Preamble is nullptr, this runs code completion without compiling the
@@ -256,6 +266,15 @@ CodeCompleteResult codeComplete(PathRef FileName,
                                 CodeCompleteOptions Opts,
                                 SpeculativeFuzzyFind *SpecFuzzyFind = nullptr);
 
+/// Gets code completions at \p Pos from \p Cached, if \p Contents only differ
+/// from the cached contents by identifier characters typed at the cached
+/// position, and \p Pos is right after them. The cached completions are
+/// matched and ranked again against the longer identifier. Returns None if
+/// Sema needs to run instead.
+llvm::Optional<CodeCompleteResult>
+refineCachedCompletion(const CachedCompletion &Cached, StringRef Contents,
+                       Position Pos, const CodeCompleteOptions &Opts);
+
 /// Get signature help at a specified \p Pos in \p FileName.
 SignatureHelp signatureHelp(PathRef FileName,
                             const tooling::CompileCommand &Command,
@@ -595,6 +595,13 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &O, const SymbolDetails &S) {
   return O;
 }
 
+llvm::json::Value toJSON(const FileMemoryUsage &U) {
+  return llvm::json::Object{
+      {"uri", U.uri},
+      {"bytes", static_cast<int64_t>(U.bytes)},
+  };
+}
+
 bool fromJSON(const llvm::json::Value &Params, WorkspaceSymbolParams &R) {
   llvm::json::ObjectMapper O(Params);
   return O && O.map("query", R.query);
@@ -861,6 +861,16 @@ llvm::json::Value toJSON(const SymbolDetails &);
 llvm::raw_ostream &operator<<(llvm::raw_ostream &, const SymbolDetails &);
 bool operator==(const SymbolDetails &, const SymbolDetails &);
 
+/// Memory used by an open file.
+/// This is returned from $/memoryUsage, which is a clangd extension.
+struct FileMemoryUsage {
+  URIForFile uri;
+
+  /// Bytes used by the idle AST and the preamble of the file.
+  std::size_t bytes = 0;
+};
+llvm::json::Value toJSON(const FileMemoryUsage &);
+
 /// The parameters of a Workspace Symbol Request.
 struct WorkspaceSymbolParams {
   /// A non-empty query string
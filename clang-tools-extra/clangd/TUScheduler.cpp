@@ -77,40 +77,50 @@ llvm::Optional<llvm::StringRef> TUScheduler::getFileBeingProcessedInContext() {
 }
 
 /// An LRU cache of idle ASTs.
-/// Because we want to limit the overall number of these we retain, the cache
-/// owns ASTs (and may evict them) while their workers are idle.
+/// Because we want to limit the overall number and size of these we retain,
+/// the cache owns ASTs (and may evict them) while their workers are idle.
 /// Workers borrow ASTs when active, and return them when done.
 class TUScheduler::ASTCache {
 public:
   using Key = const ASTWorker *;
 
-  ASTCache(unsigned MaxRetainedASTs) : MaxRetainedASTs(MaxRetainedASTs) {}
+  ASTCache(unsigned MaxRetainedASTs, std::size_t MaxRetainedBytes)
+      : MaxRetainedASTs(MaxRetainedASTs), MaxRetainedBytes(MaxRetainedBytes) {}
 
   /// Returns result of getUsedBytes() for the AST cached by \p K.
   /// If no AST is cached, 0 is returned.
   std::size_t getUsedBytes(Key K) {
     std::lock_guard<std::mutex> Lock(Mut);
     auto It = findByKey(K);
-    if (It == LRU.end() || !It->second)
+    if (It == LRU.end())
       return 0;
-    return It->second->getUsedBytes();
+    return It->UsedBytes;
   }
 
-  /// Store the value in the pool, possibly removing the last used AST.
+  /// Store the value in the pool, possibly removing the last used ASTs.
   /// The value should not be in the pool when this function is called.
   void put(Key K, std::unique_ptr<ParsedAST> V) {
+    // Computing the size walks the allocators, do it outside the lock.
+    std::size_t UsedBytes = V ? V->getUsedBytes() : 0;
     std::unique_lock<std::mutex> Lock(Mut);
     assert(findByKey(K) == LRU.end());
 
-    LRU.insert(LRU.begin(), {K, std::move(V)});
-    if (LRU.size() <= MaxRetainedASTs)
-      return;
-    // We're past the limit, remove the last element.
-    std::unique_ptr<ParsedAST> ForCleanup = std::move(LRU.back().second);
-    LRU.pop_back();
-    // Run the expensive destructor outside the lock.
+    LRU.insert(LRU.begin(), {K, std::move(V), UsedBytes});
+    TotalBytes += UsedBytes;
+    // Remove the last elements while we're past the limits. The value we just
+    // stored is kept even if it's over the size limit on its own, as its file
+    // is the one being worked on.
+    std::vector<std::unique_ptr<ParsedAST>> ForCleanup;
+    while (LRU.size() > MaxRetainedASTs ||
+           (MaxRetainedBytes != 0 && LRU.size() > 1 &&
+            TotalBytes > MaxRetainedBytes)) {
+      TotalBytes -= LRU.back().UsedBytes;
+      ForCleanup.push_back(std::move(LRU.back().AST));
+      LRU.pop_back();
+    }
+    // Run the expensive destructors outside the lock.
     Lock.unlock();
-    ForCleanup.reset();
+    ForCleanup.clear();
   }
 
   /// Returns the cached value for \p K, or llvm::None if the value is not in
@@ -121,7 +131,8 @@ public:
     auto Existing = findByKey(K);
     if (Existing == LRU.end())
       return None;
-    std::unique_ptr<ParsedAST> V = std::move(Existing->second);
+    std::unique_ptr<ParsedAST> V = std::move(Existing->AST);
+    TotalBytes -= Existing->UsedBytes;
     LRU.erase(Existing);
     // GCC 4.8 fails to compile `return V;`, as it tries to call the copy
     // constructor of unique_ptr, so we call the move ctor explicitly to avoid
@@ -130,16 +141,80 @@ public:
   }
 
 private:
-  using KVPair = std::pair<Key, std::unique_ptr<ParsedAST>>;
+  struct Entry {
+    Key K;
+    std::unique_ptr<ParsedAST> AST;
+    /// Result of getUsedBytes() for AST when it was stored.
+    std::size_t UsedBytes;
+  };
 
-  std::vector<KVPair>::iterator findByKey(Key K) {
-    return llvm::find_if(LRU, [K](const KVPair &P) { return P.first == K; });
+  std::vector<Entry>::iterator findByKey(Key K) {
+    return llvm::find_if(LRU, [K](const Entry &E) { return E.K == K; });
   }
 
   std::mutex Mut;
   unsigned MaxRetainedASTs;
+  std::size_t MaxRetainedBytes;
   /// Items sorted in LRU order, i.e. first item is the most recently accessed
   /// one.
+  std::vector<Entry> LRU;     /* GUARDED_BY(Mut) */
+  std::size_t TotalBytes = 0; /* GUARDED_BY(Mut) */
+};
+
+/// An LRU cache of the preambles of closed files.
+/// A worker created for a file that was recently closed starts from its old
+/// preamble, which is reused if the headers did not change. Preambles are
+/// never handed to another file: a PCH records the main file it was built
+/// for.
+class TUScheduler::PreambleCache {
+public:
+  PreambleCache(unsigned MaxRetainedPreambles)
+      : MaxRetainedPreambles(MaxRetainedPreambles) {}
+
+  /// Store the preamble of a closed file, possibly removing the least recently
+  /// stored one.
+  void put(PathRef File, std::shared_ptr<const PreambleData> Preamble) {
+    if (!Preamble || MaxRetainedPreambles == 0)
+      return;
+    std::unique_lock<std::mutex> Lock(Mut);
+    auto Existing = findByKey(File);
+    if (Existing != LRU.end())
+      LRU.erase(Existing);
+    LRU.insert(LRU.begin(), {File, std::move(Preamble)});
+    if (LRU.size() <= MaxRetainedPreambles)
+      return;
+    std::shared_ptr<const PreambleData> ForCleanup =
+        std::move(LRU.back().second);
+    LRU.pop_back();
+    // Run the expensive destructor outside the lock.
+    Lock.unlock();
+    ForCleanup.reset();
+  }
+
+  /// Removes the preamble stored for \p File from the cache and returns it, or
+  /// returns null if there is none.
+  std::shared_ptr<const PreambleData> take(PathRef File) {
+    std::lock_guard<std::mutex> Lock(Mut);
+    auto Existing = findByKey(File);
+    if (Existing == LRU.end())
+      return nullptr;
+    std::shared_ptr<const PreambleData> Preamble = std::move(Existing->second);
+    LRU.erase(Existing);
+    return Preamble;
+  }
+
+private:
+  using KVPair = std::pair<Path, std::shared_ptr<const PreambleData>>;
+
+  std::vector<KVPair>::iterator findByKey(PathRef File) {
+    return llvm::find_if(LRU,
+                         [File](const KVPair &P) { return P.first == File; });
+  }
+
+  std::mutex Mut;
+  unsigned MaxRetainedPreambles;
+  /// Items sorted in LRU order, i.e. first item is the most recently stored
+  /// one.
   std::vector<KVPair> LRU; /* GUARDED_BY(Mut) */
 };
 
@@ -161,7 +236,8 @@ class ASTWorker {
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
             TUScheduler::ASTCache &LRUCache, Semaphore &Barrier, bool RunSync,
             steady_clock::duration UpdateDebounce, bool StorePreamblesInMemory,
-            ParsingCallbacks &Callbacks);
+            ParsingCallbacks &Callbacks,
+            std::shared_ptr<const PreambleData> InitialPreamble);
 
 public:
   /// Create a new ASTWorker and return a handle to it.
@@ -169,11 +245,14 @@ public:
   /// is null, all requests will be processed on the calling thread
   /// synchronously instead. \p Barrier is acquired when processing each
   /// request, it is used to limit the number of actively running threads.
+  /// If \p InitialPreamble is set, it is served as a stale preamble until the
+  /// first update builds one, and is reused by that update if possible.
   static ASTWorkerHandle
   create(PathRef FileName, const GlobalCompilationDatabase &CDB,
          TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
          Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-         bool StorePreamblesInMemory, ParsingCallbacks &Callbacks);
+         bool StorePreamblesInMemory, ParsingCallbacks &Callbacks,
+         std::shared_ptr<const PreambleData> InitialPreamble);
   ~ASTWorker();
 
   void update(ParseInputs Inputs, WantDiagnostics);
@@ -323,10 +402,11 @@ ASTWorkerHandle
 ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
                   TUScheduler::ASTCache &IdleASTs, AsyncTaskRunner *Tasks,
                   Semaphore &Barrier, steady_clock::duration UpdateDebounce,
-                  bool StorePreamblesInMemory, ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(
-      new ASTWorker(FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks,
-                    UpdateDebounce, StorePreamblesInMemory, Callbacks));
+                  bool StorePreamblesInMemory, ParsingCallbacks &Callbacks,
+                  std::shared_ptr<const PreambleData> InitialPreamble) {
+  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
+      FileName, CDB, IdleASTs, Barrier, /*RunSync=*/!Tasks, UpdateDebounce,
+      StorePreamblesInMemory, Callbacks, std::move(InitialPreamble)));
   if (Tasks)
     Tasks->runAsync("worker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -337,13 +417,15 @@ ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
                      TUScheduler::ASTCache &LRUCache, Semaphore &Barrier,
                      bool RunSync, steady_clock::duration UpdateDebounce,
-                     bool StorePreamblesInMemory, ParsingCallbacks &Callbacks)
+                     bool StorePreamblesInMemory, ParsingCallbacks &Callbacks,
+                     std::shared_ptr<const PreambleData> InitialPreamble)
     : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(UpdateDebounce),
       FileName(FileName), CDB(CDB),
       StorePreambleInMemory(StorePreamblesInMemory),
       Callbacks(Callbacks), Status{TUAction(TUAction::Idle, ""),
                                    TUStatus::BuildDetails()},
-      Barrier(Barrier), Done(false) {
+      Barrier(Barrier), LastBuiltPreamble(std::move(InitialPreamble)),
+      Done(false) {
   auto Inputs = std::make_shared<ParseInputs>();
   // Set a fallback command because compile command can be accessed before
   // `Inputs` is initialized. Other fields are only used after initialization
@@ -381,7 +463,6 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
         std::tie(PrevInputs->CompileCommand, PrevInputs->Contents) ==
         std::tie(Inputs.CompileCommand, Inputs.Contents);
 
-    tooling::CompileCommand OldCommand = PrevInputs->CompileCommand;
     bool RanCallbackForPrevInputs = RanASTCallback;
     {
       std::lock_guard<std::mutex> Lock(Mutex);
@@ -409,11 +490,36 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
       return;
     }
 
+    auto RunPublish = [&](llvm::function_ref<void()> Publish) {
+      // Ensure we only publish results from the worker if the file was not
+      // removed, making sure there are not race conditions.
+      std::lock_guard<std::mutex> Lock(PublishMu);
+      if (CanPublishResults)
+        Publish();
+    };
+
     std::shared_ptr<const PreambleData> OldPreamble =
         getPossiblyStalePreamble();
+    // Rebuilding the preamble parses all the headers again. Publish the
+    // diagnostics of an AST built on the old preamble first, so that editing
+    // the includes doesn't hold them up. They are refreshed below once the new
+    // preamble is ready.
+    if (OldPreamble && OldPreamble->Preamble.getBounds().Size > 0 &&
+        WantDiags != WantDiagnostics::No &&
+        !isPreambleCompatible(*OldPreamble, FileName, *Invocation, Inputs)) {
+      IdleASTs.take(this); // The old AST is outdated either way.
+      llvm::Optional<ParsedAST> StaleAST =
+          buildAST(FileName, std::make_unique<CompilerInvocation>(*Invocation),
+                   Inputs, OldPreamble);
+      if (StaleAST) {
+        trace::Span Span("Running main AST callback with stale preamble");
+        Callbacks.onMainAST(FileName, *StaleAST, RunPublish);
+      }
+    }
     std::shared_ptr<const PreambleData> NewPreamble = buildPreamble(
-        FileName, *Invocation, OldPreamble, OldCommand, Inputs,
-        StorePreambleInMemory,
+        FileName, *Invocation, OldPreamble,
+        OldPreamble ? OldPreamble->CompileCommand : tooling::CompileCommand(),
+        Inputs, StorePreambleInMemory,
         [this](ASTContext &Ctx, std::shared_ptr<clang::Preprocessor> PP,
                const CanonicalIncludes &CanonIncludes) {
           Callbacks.onPreambleAST(FileName, Ctx, std::move(PP), CanonIncludes);
@@ -487,14 +593,6 @@ void ASTWorker::update(ParseInputs Inputs, WantDiagnostics WantDiags) {
     // Note *AST can still be null if buildAST fails.
     if (*AST) {
       trace::Span Span("Running main AST callback");
-      auto RunPublish = [&](llvm::function_ref<void()> Publish) {
-        // Ensure we only publish results from the worker if the file was not
-        // removed, making sure there are not race conditions.
-        std::lock_guard<std::mutex> Lock(PublishMu);
-        if (CanPublishResults)
-          Publish();
-      };
-
       Callbacks.onMainAST(FileName, **AST, RunPublish);
       RanASTCallback = true;
     }
@@ -831,7 +929,10 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
       Callbacks(Callbacks ? move(Callbacks)
                           : std::make_unique<ParsingCallbacks>()),
       Barrier(AsyncThreadsCount),
-      IdleASTs(std::make_unique<ASTCache>(RetentionPolicy.MaxRetainedASTs)),
+      IdleASTs(std::make_unique<ASTCache>(RetentionPolicy.MaxRetainedASTs,
+                                          RetentionPolicy.MaxRetainedBytes)),
+      ClosedPreambles(std::make_unique<PreambleCache>(
+          RetentionPolicy.MaxRetainedPreambles)),
       UpdateDebounce(UpdateDebounce) {
   if (0 < AsyncThreadsCount) {
     PreambleTasks.emplace();
@@ -869,7 +970,8 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
     ASTWorkerHandle Worker = ASTWorker::create(
         File, CDB, *IdleASTs,
         WorkerThreads ? WorkerThreads.getPointer() : nullptr, Barrier,
-        UpdateDebounce, StorePreamblesInMemory, *Callbacks);
+        UpdateDebounce, StorePreamblesInMemory, *Callbacks,
+        ClosedPreambles->take(File));
     FD = std::unique_ptr<FileData>(
         new FileData{Inputs.Contents, std::move(Worker)});
   } else {
@@ -880,10 +982,14 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
 }
 
 void TUScheduler::remove(PathRef File) {
-  bool Removed = Files.erase(File);
-  if (!Removed)
+  auto It = Files.find(File);
+  if (It == Files.end()) {
     elog("Trying to remove file from TUScheduler that is not tracked: {0}",
          File);
+    return;
+  }
+  ClosedPreambles->put(File, It->second->Worker->getPossiblyStalePreamble());
+  Files.erase(It);
 }
 
 llvm::StringRef TUScheduler::getContents(PathRef File) const {
@@ -960,13 +1066,14 @@ void TUScheduler::runWithPreamble(llvm::StringRef Name, PathRef File,
     if (ConsistentPreamble.valid()) {
       Preamble = ConsistentPreamble.get();
     } else {
-      if (Consistency != PreambleConsistency::StaleOrAbsent) {
+      Preamble = Worker->getPossiblyStalePreamble();
+      if (!Preamble && Consistency != PreambleConsistency::StaleOrAbsent) {
         // Wait until the preamble is built for the first time, if preamble is
         // required. This avoids extra work of processing the preamble headers
         // in parallel multiple times.
         Worker->waitForFirstPreamble();
+        Preamble = Worker->getPossiblyStalePreamble();
       }
-      Preamble = Worker->getPossiblyStalePreamble();
     }
 
     std::lock_guard<Semaphore> BarrierLock(Barrier);
@@ -55,6 +55,13 @@ struct ASTRetentionPolicy {
   /// Maximum number of ASTs to be retained in memory when there are no pending
   /// requests for them.
   unsigned MaxRetainedASTs = 3;
+  /// Maximum total size of the retained ASTs, as reported by
+  /// ParsedAST::getUsedBytes(). The most recently used AST is retained even if
+  /// it's bigger on its own. 0 means no limit.
+  std::size_t MaxRetainedBytes = 0;
+  /// Maximum number of preambles of closed files to be retained, so that
+  /// reopening one of them doesn't parse its headers again.
+  unsigned MaxRetainedPreambles = 3;
 };
 
 struct TUAction {
@@ -228,6 +235,8 @@ public:
   /// Responsible for retaining and rebuilding idle ASTs. An implementation is
   /// an LRU cache.
   class ASTCache;
+  /// Retains the preambles of recently closed files.
+  class PreambleCache;
 
   // The file being built/processed in the current thread. This is a hack in
   // order to get the file name into the index implementations. Do not depend on
@@ -243,6 +252,7 @@ private:
   Semaphore Barrier;
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
+  std::unique_ptr<PreambleCache> ClosedPreambles;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
@@ -8,12 +8,15 @@
 
 #include "../index/Serialization.h"
 #include "../index/dex/Dex.h"
+#include "../index/dex/Iterator.h"
+#include "../index/dex/PostingList.h"
 #include "benchmark/benchmark.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Regex.h"
 #include <fstream>
+#include <random>
 #include <streambuf>
 #include <string>
 
@@ -83,6 +86,36 @@ static void DexQueries(benchmark::State &State) {
 }
 BENCHMARK(DexQueries);
 
+// Returns sorted DocIDs with random gaps of up to MaxGap.
+std::vector<dex::DocID> randomDocIDs(size_t Size, dex::DocID MaxGap) {
+  std::mt19937 Generator(Size);
+  std::uniform_int_distribution<dex::DocID> Gap(1, MaxGap);
+  std::vector<dex::DocID> Result;
+  dex::DocID Last = 0;
+  for (size_t I = 0; I < Size; ++I)
+    Result.push_back(Last += Gap(Generator));
+  return Result;
+}
+
+// Intersects a dense posting list with one that is State.range(0) times
+// sparser, the way AND iterators of Dex queries combine trigrams, scopes and
+// other filters.
+static void PostingListIntersection(benchmark::State &State) {
+  const size_t Size = 1000000;
+  const auto Ratio = static_cast<dex::DocID>(State.range(0));
+  const dex::PostingList Dense(randomDocIDs(Size, 4));
+  const dex::PostingList Sparse(randomDocIDs(Size / Ratio, 4 * Ratio));
+  const dex::Corpus Corpus(4 * Size);
+  for (auto _ : State) {
+    auto And = Corpus.intersect(Dense.iterator(), Sparse.iterator());
+    size_t Matches = 0;
+    for (; !And->reachedEnd(); And->advance())
+      ++Matches;
+    benchmark::DoNotOptimize(Matches);
+  }
+}
+BENCHMARK(PostingListIntersection)->Arg(1)->Arg(16)->Arg(256)->Arg(4096);
+
 } // namespace
 } // namespace clangd
 } // namespace clang
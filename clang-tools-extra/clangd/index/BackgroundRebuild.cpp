@@ -20,6 +20,7 @@
 #include "index/FileIndex.h"
 #include "index/IndexAction.h"
 #include "index/MemIndex.h"
+#include "index/Merge.h"
 #include "index/Ref.h"
 #include "index/Relation.h"
 #include "index/Serialization.h"
@@ -48,6 +49,23 @@
 
 namespace clang {
 namespace clangd {
+namespace {
+
+// Serves an index of the files updated since a full rebuild on top of the
+// index that rebuild produced, and keeps both alive.
+class IncrementalIndex : public MergedIndex {
+public:
+  IncrementalIndex(std::unique_ptr<SymbolIndex> Changed,
+                   std::shared_ptr<SymbolIndex> Base)
+      : MergedIndex(Changed.get(), Base.get()), Changed(std::move(Changed)),
+        Base(std::move(Base)) {}
+
+private:
+  std::unique_ptr<SymbolIndex> Changed;
+  std::shared_ptr<SymbolIndex> Base;
+};
+
+} // namespace
 
 bool BackgroundIndexRebuilder::enoughTUsToRebuild() const {
   if (!ActiveVersion)                         // never built
@@ -64,7 +82,7 @@ void BackgroundIndexRebuilder::indexedTU() {
     if (ActiveVersion != StartedVersion) // currently building
       return false;                      // no urgency, avoid overlapping builds
     return enoughTUsToRebuild();
-  });
+  }, /*AllowIncremental=*/true);
 }
 
 void BackgroundIndexRebuilder::idle() {
@@ -103,22 +121,43 @@ void BackgroundIndexRebuilder::shutdown() {
 }
 
 void BackgroundIndexRebuilder::maybeRebuild(const char *Reason,
-                                            std::function<bool()> Check) {
+                                            std::function<bool()> Check,
+                                            bool AllowIncremental) {
   unsigned BuildVersion = 0;
+  std::shared_ptr<SymbolIndex> OldBase;
+  unsigned OldBaseVersion = 0;
   {
     std::lock_guard<std::mutex> Lock(Mu);
     if (!ShouldStop && Check()) {
       BuildVersion = ++StartedVersion;
       IndexedTUsAtLastRebuild = IndexedTUs;
+      if (AllowIncremental && Base &&
+          IndexedTUs < IndexedTUsAtLastFullRebuild + TUsBeforeFullRebuild) {
+        OldBase = Base;
+        OldBaseVersion = BaseVersion;
+      } else {
+        IndexedTUsAtLastFullRebuild = IndexedTUs;
+      }
     }
   }
   if (BuildVersion) {
-    std::unique_ptr<SymbolIndex> NewIndex;
+    std::shared_ptr<SymbolIndex> NewIndex;
+    unsigned SourceVersion = 0;
     {
-      vlog("BackgroundIndex: building version {0} {1}", BuildVersion, Reason);
+      vlog("BackgroundIndex: building version {0} {1}{2}", BuildVersion,
+           Reason, OldBase ? " (incremental)" : "");
       trace::Span Tracer("RebuildBackgroundIndex");
       SPAN_ATTACH(Tracer, "reason", Reason);
-      NewIndex = Source->buildIndex(IndexType::Heavy, DuplicateHandling::Merge);
+      SPAN_ATTACH(Tracer, "incremental", bool(OldBase));
+      if (OldBase)
+        NewIndex = std::make_shared<IncrementalIndex>(
+            Source->buildIndex(IndexType::Heavy, DuplicateHandling::Merge,
+                               OldBaseVersion),
+            OldBase);
+      else
+        NewIndex = Source->buildIndex(IndexType::Heavy,
+                                      DuplicateHandling::Merge,
+                                      /*ChangedSince=*/0, &SourceVersion);
     }
     {
       std::lock_guard<std::mutex> Lock(Mu);
@@ -127,6 +166,10 @@ void BackgroundIndexRebuilder::maybeRebuild(const char *Reason,
         ActiveVersion = BuildVersion;
         vlog("BackgroundIndex: serving version {0} ({1} bytes)", BuildVersion,
              NewIndex->estimateMemoryUsage());
+        if (!OldBase) {
+          Base = NewIndex;
+          BaseVersion = SourceVersion;
+        }
         Target->reset(std::move(NewIndex));
       }
     }
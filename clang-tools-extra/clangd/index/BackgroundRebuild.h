@@ -37,8 +37,15 @@ namespace clangd {
 // Waiting for a few random TUs yields coverage of the most common headers.
 //
 // The index is rebuilt every N TUs, to keep if fresh as files are indexed.
+// These rebuilds are incremental: only the files updated since the last full
+// rebuild are indexed again, and served on top of the index that rebuild
+// produced. Every M TUs the rebuild is a full one instead, so that the
+// incremental part stays small.
 //
-// The index is rebuilt every time the queue goes idle, if it's stale.
+// The index is rebuilt every time the queue goes idle, if it's stale. This and
+// rebuilds after loading shards are full rebuilds: an incremental index can't
+// hide symbols that were removed from a file, so the index only serves them
+// until the next full rebuild.
 //
 // All methods are threadsafe. They're called after FileSymbols is updated
 // etc. Without external locking, the rebuilt index may include more updates
@@ -73,10 +80,14 @@ public:
   // Thresholds for rebuilding as TUs get indexed.
   const unsigned TUsBeforeFirstBuild; // Typically one per worker thread.
   const unsigned TUsBeforeRebuild = 100;
+  const unsigned TUsBeforeFullRebuild = 1000;
 
 private:
   // Run Check under the lock, and rebuild if it returns true.
-  void maybeRebuild(const char *Reason, std::function<bool()> Check);
+  // The rebuild is incremental if AllowIncremental and not too many TUs were
+  // indexed since the last full rebuild.
+  void maybeRebuild(const char *Reason, std::function<bool()> Check,
+                    bool AllowIncremental = false);
   bool enoughTUsToRebuild() const;
 
   // All transient state is guarded by the mutex.
@@ -88,6 +99,11 @@ private:
   // How many TUs have we indexed so far since startup?
   unsigned IndexedTUs = 0;
   unsigned IndexedTUsAtLastRebuild = 0;
+  unsigned IndexedTUsAtLastFullRebuild = 0;
+  // The index built by the last full rebuild, and the version of Source it
+  // was built from. Incremental rebuilds are served on top of it.
+  std::shared_ptr<SymbolIndex> Base;
+  unsigned BaseVersion = 0;
   // Are we loading shards? May be multiple concurrent sessions.
   unsigned Loading = 0;
   unsigned LoadedShards; // In the current loading session.
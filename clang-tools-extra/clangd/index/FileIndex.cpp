@@ -96,6 +96,7 @@ void FileSymbols::update(PathRef Path, std::unique_ptr<SymbolSlab> Symbols,
                          std::unique_ptr<RelationSlab> Relations,
                          bool CountReferences) {
   std::lock_guard<std::mutex> Lock(Mutex);
+  FileToVersion[Path] = ++CurrentVersion;
   if (!Symbols)
     FileToSymbols.erase(Path);
   else
@@ -115,35 +116,54 @@ void FileSymbols::update(PathRef Path, std::unique_ptr<SymbolSlab> Symbols,
 }
 
 std::unique_ptr<SymbolIndex>
-FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle) {
+FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle,
+                        unsigned ChangedSince, unsigned *Version) {
   std::vector<std::shared_ptr<SymbolSlab>> SymbolSlabs;
   std::vector<std::shared_ptr<RefSlab>> RefSlabs;
   std::vector<std::shared_ptr<RelationSlab>> RelationSlabs;
   std::vector<RefSlab *> MainFileRefs;
   {
     std::lock_guard<std::mutex> Lock(Mutex);
+    auto Changed = [&](llvm::StringRef Path) {
+      return FileToVersion.lookup(Path) > ChangedSince;
+    };
     for (const auto &FileAndSymbols : FileToSymbols)
-      SymbolSlabs.push_back(FileAndSymbols.second);
+      if (Changed(FileAndSymbols.first()))
+        SymbolSlabs.push_back(FileAndSymbols.second);
     for (const auto &FileAndRefs : FileToRefs) {
+      if (!Changed(FileAndRefs.first()))
+        continue;
       RefSlabs.push_back(FileAndRefs.second.Slab);
       if (FileAndRefs.second.CountReferences)
         MainFileRefs.push_back(RefSlabs.back().get());
     }
     for (const auto &FileAndRelations : FileToRelations)
-      RelationSlabs.push_back(FileAndRelations.second);
+      if (Changed(FileAndRelations.first()))
+        RelationSlabs.push_back(FileAndRelations.second);
+    if (Version)
+      *Version = CurrentVersion;
   }
   std::vector<const Symbol *> AllSymbols;
   std::vector<Symbol> SymsStorage;
   switch (DuplicateHandle) {
   case DuplicateHandling::Merge: {
-    llvm::DenseMap<SymbolID, Symbol> Merged;
+    // Merge straight into SymsStorage: keeping the merged symbols in the map
+    // and moving them out afterwards needs room for all of them twice.
+    size_t Count = 0;
+    for (const auto &Slab : SymbolSlabs)
+      Count += Slab->size();
+    SymsStorage.reserve(Count);
+    llvm::DenseMap<SymbolID, size_t> Merged;
     for (const auto &Slab : SymbolSlabs) {
       for (const auto &Sym : *Slab) {
         assert(Sym.References == 0 &&
                "Symbol with non-zero references sent to FileSymbols");
-        auto I = Merged.try_emplace(Sym.ID, Sym);
-        if (!I.second)
-          I.first->second = mergeSymbol(I.first->second, Sym);
+        auto I = Merged.try_emplace(Sym.ID, SymsStorage.size());
+        if (I.second)
+          SymsStorage.push_back(Sym);
+        else
+          SymsStorage[I.first->second] =
+              mergeSymbol(SymsStorage[I.first->second], Sym);
       }
     }
     for (const RefSlab *Refs : MainFileRefs)
@@ -152,13 +172,10 @@ FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle) {
         // This might happen while background-index is still running.
         if (It == Merged.end())
           continue;
-        It->getSecond().References += Sym.second.size();
+        SymsStorage[It->second].References += Sym.second.size();
       }
-    SymsStorage.reserve(Merged.size());
-    for (auto &Sym : Merged) {
-      SymsStorage.push_back(std::move(Sym.second));
-      AllSymbols.push_back(&SymsStorage.back());
-    }
+    for (const Symbol &Sym : SymsStorage)
+      AllSymbols.push_back(&Sym);
     break;
   }
   case DuplicateHandling::PickOne: {
@@ -177,24 +194,34 @@ FileSymbols::buildIndex(IndexType Type, DuplicateHandling DuplicateHandle) {
   std::vector<Ref> RefsStorage; // Contiguous ranges for each SymbolID.
   llvm::DenseMap<SymbolID, llvm::ArrayRef<Ref>> AllRefs;
   {
-    llvm::DenseMap<SymbolID, llvm::SmallVector<Ref, 4>> MergedRefs;
+    // Count the refs of each symbol first, so that they can be copied to
+    // their final place directly instead of through a per-symbol buffer.
+    // Each range is [Begin, End), where End is where the next ref goes.
+    llvm::DenseMap<SymbolID, std::pair<size_t, size_t>> Ranges;
+    for (const auto &RefSlab : RefSlabs)
+      for (const auto &Sym : *RefSlab)
+        Ranges[Sym.first].second += Sym.second.size();
     size_t Count = 0;
+    for (auto &Sym : Ranges) {
+      size_t Size = Sym.second.second;
+      Sym.second = {Count, Count};
+      Count += Size;
+    }
+    RefsStorage.resize(Count);
     for (const auto &RefSlab : RefSlabs)
       for (const auto &Sym : *RefSlab) {
-        MergedRefs[Sym.first].append(Sym.second.begin(), Sym.second.end());
-        Count += Sym.second.size();
+        auto &Range = Ranges[Sym.first];
+        llvm::copy(Sym.second, RefsStorage.begin() + Range.second);
+        Range.second += Sym.second.size();
       }
-    RefsStorage.reserve(Count);
-    AllRefs.reserve(MergedRefs.size());
-    for (auto &Sym : MergedRefs) {
-      auto &SymRefs = Sym.second;
+    AllRefs.reserve(Ranges.size());
+    for (const auto &Sym : Ranges) {
+      auto SymRefs = llvm::MutableArrayRef<Ref>(RefsStorage)
+                         .slice(Sym.second.first,
+                                Sym.second.second - Sym.second.first);
       // Sorting isn't required, but yields more stable results over rebuilds.
       llvm::sort(SymRefs);
-      llvm::copy(SymRefs, back_inserter(RefsStorage));
-      AllRefs.try_emplace(
-          Sym.first,
-          llvm::ArrayRef<Ref>(&RefsStorage[RefsStorage.size() - SymRefs.size()],
-                              SymRefs.size()));
+      AllRefs.try_emplace(Sym.first, SymRefs);
     }
   }
 
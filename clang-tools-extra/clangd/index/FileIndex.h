@@ -69,9 +69,16 @@ public:
   /// The index keeps the symbols alive.
   /// Will count Symbol::References based on number of references in the main
   /// files, while building the index with DuplicateHandling::Merge option.
+  ///
+  /// Only includes the files updated after \p ChangedSince, a version earlier
+  /// returned in \p Version. Such an index is meant to be merged on top of
+  /// the one built at that version; files removed since are not reflected.
+  /// If \p Version is set, it receives the version of the data the index was
+  /// built from.
   std::unique_ptr<SymbolIndex>
   buildIndex(IndexType,
-             DuplicateHandling DuplicateHandle = DuplicateHandling::PickOne);
+             DuplicateHandling DuplicateHandle = DuplicateHandling::PickOne,
+             unsigned ChangedSince = 0, unsigned *Version = nullptr);
 
 private:
   struct RefSlabAndCountReferences {
@@ -86,6 +93,10 @@ private:
   llvm::StringMap<RefSlabAndCountReferences> FileToRefs;
   /// Stores the latest relation snapshots for all active files.
   llvm::StringMap<std::shared_ptr<RelationSlab>> FileToRelations;
+  /// Stores the version of the latest update of each file.
+  llvm::StringMap<unsigned> FileToVersion;
+  /// The number of updates so far.
+  unsigned CurrentVersion = 0;
 };
 
 /// This manages symbols from files and an in-memory index on all symbols.
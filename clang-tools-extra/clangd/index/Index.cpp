@@ -17,7 +17,7 @@
 namespace clang {
 namespace clangd {
 
-void SwapIndex::reset(std::unique_ptr<SymbolIndex> Index) {
+void SwapIndex::reset(std::shared_ptr<SymbolIndex> Index) {
   // Keep the old index alive, so we don't destroy it under lock (may be slow).
   std::shared_ptr<SymbolIndex> Pin;
   {
@@ -31,29 +31,105 @@ std::shared_ptr<SymbolIndex> SwapIndex::snapshot() const {
   return Index;
 }
 
+// Limits are optional, and toJSON() writes a missing one as null.
+static bool mapLimit(llvm::json::ObjectMapper &O,
+                     llvm::Optional<uint32_t> &Limit) {
+  llvm::Optional<int64_t> Value;
+  if (!O.map("Limit", Value))
+    return false;
+  if (Value && *Value >= 0 && *Value <= std::numeric_limits<uint32_t>::max())
+    Limit = *Value;
+  return true;
+}
+
+static bool mapIDs(llvm::json::ObjectMapper &O, llvm::StringRef Prop,
+                   llvm::DenseSet<SymbolID> &IDs) {
+  std::vector<std::string> Strings;
+  if (!O.map(Prop, Strings))
+    return false;
+  for (const std::string &S : Strings) {
+    auto ID = SymbolID::fromStr(S);
+    if (!ID) {
+      llvm::consumeError(ID.takeError());
+      return false;
+    }
+    IDs.insert(*ID);
+  }
+  return true;
+}
+
+static llvm::json::Array toJSON(const llvm::DenseSet<SymbolID> &IDs) {
+  llvm::json::Array Result;
+  for (const SymbolID &ID : IDs)
+    Result.push_back(ID.str());
+  return Result;
+}
+
 bool fromJSON(const llvm::json::Value &Parameters, FuzzyFindRequest &Request) {
   llvm::json::ObjectMapper O(Parameters);
-  int64_t Limit;
-  bool OK =
-      O && O.map("Query", Request.Query) && O.map("Scopes", Request.Scopes) &&
-      O.map("AnyScope", Request.AnyScope) && O.map("Limit", Limit) &&
-      O.map("RestrictForCodeCompletion", Request.RestrictForCodeCompletion) &&
-      O.map("ProximityPaths", Request.ProximityPaths) &&
-      O.map("PreferredTypes", Request.PreferredTypes);
-  if (OK && Limit <= std::numeric_limits<uint32_t>::max())
-    Request.Limit = Limit;
-  return OK;
+  return O && O.map("Query", Request.Query) &&
+         O.map("Scopes", Request.Scopes) &&
+         O.map("AnyScope", Request.AnyScope) && mapLimit(O, Request.Limit) &&
+         O.map("RestrictForCodeCompletion",
+               Request.RestrictForCodeCompletion) &&
+         O.map("ProximityPaths", Request.ProximityPaths) &&
+         O.map("PreferredTypes", Request.PreferredTypes);
 }
 
 llvm::json::Value toJSON(const FuzzyFindRequest &Request) {
   return llvm::json::Object{
       {"Query", Request.Query},
-      {"Scopes", llvm::json::Array{Request.Scopes}},
+      {"Scopes", llvm::json::Array(Request.Scopes)},
       {"AnyScope", Request.AnyScope},
       {"Limit", Request.Limit},
       {"RestrictForCodeCompletion", Request.RestrictForCodeCompletion},
-      {"ProximityPaths", llvm::json::Array{Request.ProximityPaths}},
-      {"PreferredTypes", llvm::json::Array{Request.PreferredTypes}},
+      {"ProximityPaths", llvm::json::Array(Request.ProximityPaths)},
+      {"PreferredTypes", llvm::json::Array(Request.PreferredTypes)},
+  };
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, LookupRequest &Request) {
+  llvm::json::ObjectMapper O(Parameters);
+  return O && mapIDs(O, "IDs", Request.IDs);
+}
+
+llvm::json::Value toJSON(const LookupRequest &Request) {
+  return llvm::json::Object{{"IDs", toJSON(Request.IDs)}};
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, RefsRequest &Request) {
+  llvm::json::ObjectMapper O(Parameters);
+  int64_t Filter;
+  if (!O || !mapIDs(O, "IDs", Request.IDs) || !O.map("Filter", Filter) ||
+      !mapLimit(O, Request.Limit))
+    return false;
+  Request.Filter = static_cast<RefKind>(Filter) & RefKind::All;
+  return true;
+}
+
+llvm::json::Value toJSON(const RefsRequest &Request) {
+  return llvm::json::Object{
+      {"IDs", toJSON(Request.IDs)},
+      {"Filter", static_cast<int64_t>(Request.Filter)},
+      {"Limit", Request.Limit},
+  };
+}
+
+bool fromJSON(const llvm::json::Value &Parameters, RelationsRequest &Request) {
+  llvm::json::ObjectMapper O(Parameters);
+  int64_t Predicate;
+  if (!O || !mapIDs(O, "Subjects", Request.Subjects) ||
+      !O.map("Predicate", Predicate) || !mapLimit(O, Request.Limit))
+    return false;
+  Request.Predicate = static_cast<index::SymbolRole>(Predicate);
+  return true;
+}
+
+llvm::json::Value toJSON(const RelationsRequest &Request) {
+  return llvm::json::Object{
+      {"Subjects", toJSON(Request.Subjects)},
+      {"Predicate", static_cast<int64_t>(Request.Predicate)},
+      {"Limit", Request.Limit},
   };
 }
 
@@ -63,6 +63,8 @@ llvm::json::Value toJSON(const FuzzyFindRequest &Request);
 struct LookupRequest {
   llvm::DenseSet<SymbolID> IDs;
 };
+bool fromJSON(const llvm::json::Value &Value, LookupRequest &Request);
+llvm::json::Value toJSON(const LookupRequest &Request);
 
 struct RefsRequest {
   llvm::DenseSet<SymbolID> IDs;
@@ -72,6 +74,8 @@ struct RefsRequest {
   /// results.
   llvm::Optional<uint32_t> Limit;
 };
+bool fromJSON(const llvm::json::Value &Value, RefsRequest &Request);
+llvm::json::Value toJSON(const RefsRequest &Request);
 
 struct RelationsRequest {
   llvm::DenseSet<SymbolID> Subjects;
@@ -79,6 +83,8 @@ struct RelationsRequest {
   /// If set, limit the number of relations returned from the index.
   llvm::Optional<uint32_t> Limit;
 };
+bool fromJSON(const llvm::json::Value &Value, RelationsRequest &Request);
+llvm::json::Value toJSON(const RelationsRequest &Request);
 
 /// Interface for symbol indexes that can be used for searching or
 /// matching symbols among a set of symbols based on names or unique IDs.
@@ -128,7 +134,8 @@ public:
   // If an index is not provided, reset() must be called.
   SwapIndex(std::unique_ptr<SymbolIndex> Index = nullptr)
       : Index(std::move(Index)) {}
-  void reset(std::unique_ptr<SymbolIndex>);
+  // The new index may still be shared with other owners.
+  void reset(std::shared_ptr<SymbolIndex>);
 
   // SymbolIndex methods delegate to the current index, which is kept alive
   // until the call returns (even if reset() is called).
@@ -10,6 +10,7 @@
 #include "Iterator.h"
 #include "Token.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MathExtras.h"
 
@@ -26,7 +27,7 @@ public:
   explicit ChunkIterator(const Token *Tok, llvm::ArrayRef<Chunk> Chunks)
       : Tok(Tok), Chunks(Chunks), CurrentChunk(Chunks.begin()) {
     if (!Chunks.empty()) {
-      DecompressedChunk = CurrentChunk->decompress();
+      CurrentChunk->decompress(DecompressedChunk);
       CurrentID = DecompressedChunk.begin();
     }
   }
@@ -94,19 +95,35 @@ private:
     ++CurrentChunk;
     if (CurrentChunk == Chunks.end()) // Reached the end of PostingList.
       return;
-    DecompressedChunk = CurrentChunk->decompress();
+    CurrentChunk->decompress(DecompressedChunk);
     CurrentID = DecompressedChunk.begin();
   }
 
-  /// Advances CurrentChunk to the chunk which might contain ID.
+  /// Advances CurrentChunk to the chunk which might contain ID, i.e. the last
+  /// chunk with Head <= ID.
+  ///
+  /// AND iterators advance their children to IDs that are usually close by,
+  /// so this gallops: it doubles the step until it overshoots ID, and only
+  /// then binary searches the last step. This takes time logarithmic in
+  /// the distance skipped rather than in the size of the posting list.
   void advanceToChunk(DocID ID) {
     if ((CurrentChunk != Chunks.end() - 1) &&
         ((CurrentChunk + 1)->Head <= ID)) {
+      auto Low = CurrentChunk + 1; // Low->Head <= ID.
+      size_t Step = 1;
+      while (Step < static_cast<size_t>(Chunks.end() - Low) &&
+             Low[Step].Head <= ID) {
+        Low += Step;
+        Step *= 2;
+      }
+      auto High = Chunks.end() - Low > static_cast<std::ptrdiff_t>(Step)
+                      ? Low + Step
+                      : Chunks.end();
       CurrentChunk =
-          std::partition_point(CurrentChunk + 1, Chunks.end(),
-                               [&](const Chunk &C) { return C.Head < ID; });
+          std::partition_point(Low + 1, High,
+                               [&](const Chunk &C) { return C.Head <= ID; });
       --CurrentChunk;
-      DecompressedChunk = CurrentChunk->decompress();
+      CurrentChunk->decompress(DecompressedChunk);
       CurrentID = DecompressedChunk.begin();
     }
   }
@@ -182,38 +199,55 @@ std::vector<Chunk> encodeStream(llvm::ArrayRef<DocID> Documents) {
   return std::vector<Chunk>(Result); // no move, shrink-to-fit
 }
 
-/// Reads variable length DocID from the buffer and updates the buffer size. If
-/// the stream is terminated, return None.
-llvm::Optional<DocID> readVByte(llvm::ArrayRef<uint8_t> &Bytes) {
-  if (Bytes.front() == 0 || Bytes.empty())
-    return None;
-  DocID Result = 0;
-  bool HasNextByte = true;
-  for (size_t Length = 0; HasNextByte && !Bytes.empty(); ++Length) {
-    assert(Length <= 5 && "Malformed VByte encoding sequence.");
-    // Write meaningful bits to the correct place in the document decoding.
-    Result |= (Bytes.front() & 0x7f) << (BitsPerEncodingByte * Length);
-    if ((Bytes.front() & 0x80) == 0)
-      HasNextByte = false;
-    Bytes = Bytes.drop_front();
-  }
-  return Result;
+/// Returns true if all four bytes of \p Word encode single-byte deltas: none
+/// of them has the continuation bit set or is 0, which ends the stream.
+bool isFourSingleByteDeltas(uint32_t Word) {
+  constexpr uint32_t Ones = 0x01010101, HighBits = 0x80808080;
+  bool HasContinuation = Word & HighBits;
+  bool HasZero = (Word - Ones) & ~Word & HighBits;
+  return !HasContinuation && !HasZero;
 }
 
 } // namespace
 
 llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Chunk::decompress() const {
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result{Head};
-  llvm::ArrayRef<uint8_t> Bytes(Payload);
-  DocID Delta;
-  for (DocID Current = Head; !Bytes.empty(); Current += Delta) {
-    auto MaybeDelta = readVByte(Bytes);
-    if (!MaybeDelta)
-      break;
-    Delta = *MaybeDelta;
-    Result.push_back(Current + Delta);
+  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result;
+  decompress(Result);
+  return Result;
+}
+
+void Chunk::decompress(llvm::SmallVectorImpl<DocID> &Out) const {
+  Out.clear();
+  Out.push_back(Head);
+  DocID Current = Head;
+  size_t I = 0;
+  while (I < PayloadSize && Payload[I] != 0) {
+    // Dense posting lists mostly have gaps below 128, which take one byte
+    // each. Decode those four at a time.
+    if (I + 4 <= PayloadSize) {
+      uint32_t Word = llvm::support::endian::read32le(&Payload[I]);
+      if (isFourSingleByteDeltas(Word)) {
+        for (unsigned Byte = 0; Byte < 4; ++Byte) {
+          Current += (Word >> (8 * Byte)) & 0xff;
+          Out.push_back(Current);
+        }
+        I += 4;
+        continue;
+      }
+    }
+    uint8_t Byte = Payload[I++];
+    DocID Delta = Byte & 0x7f;
+    for (unsigned Shift = BitsPerEncodingByte;
+         (Byte & 0x80) != 0 && I < PayloadSize; Shift += BitsPerEncodingByte) {
+      assert(Shift < 5 * BitsPerEncodingByte &&
+             "Malformed VByte encoding sequence.");
+      Byte = Payload[I++];
+      // Write meaningful bits to the correct place in the document decoding.
+      Delta |= static_cast<DocID>(Byte & 0x7f) << Shift;
+    }
+    Current += Delta;
+    Out.push_back(Current);
   }
-  return llvm::SmallVector<DocID, Chunk::PayloadSize + 1>{Result};
 }
 
 PostingList::PostingList(llvm::ArrayRef<DocID> Documents)
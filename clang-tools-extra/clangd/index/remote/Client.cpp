@@ -0,0 +1,151 @@
+//===--- Client.cpp - Connect to a remote index ------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/remote/Client.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "index/remote/Marshalling.h"
+#include "index/remote/Socket.h"
+#include <mutex>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+// How long requests fail without trying to connect after a failed attempt.
+constexpr std::chrono::seconds RetryDelay(5);
+
+class IndexClient : public SymbolIndex {
+public:
+  IndexClient(llvm::StringRef Address, std::chrono::milliseconds Timeout)
+      : Address(Address), Timeout(Timeout) {}
+
+  bool
+  fuzzyFind(const FuzzyFindRequest &Req,
+            llvm::function_ref<void(const Symbol &)> Callback) const override {
+    auto R = call("fuzzyFind", toJSON(Req));
+    if (!R)
+      return false;
+    if (R->Results.Symbols)
+      for (const Symbol &S : *R->Results.Symbols)
+        Callback(S);
+    return R->HasMore;
+  }
+
+  void
+  lookup(const LookupRequest &Req,
+         llvm::function_ref<void(const Symbol &)> Callback) const override {
+    auto R = call("lookup", toJSON(Req));
+    if (!R || !R->Results.Symbols)
+      return;
+    for (const Symbol &S : *R->Results.Symbols)
+      Callback(S);
+  }
+
+  void refs(const RefsRequest &Req,
+            llvm::function_ref<void(const Ref &)> Callback) const override {
+    auto R = call("refs", toJSON(Req));
+    if (!R || !R->Results.Refs)
+      return;
+    for (const auto &SymbolRefs : *R->Results.Refs)
+      for (const Ref &Ref : SymbolRefs.second)
+        Callback(Ref);
+  }
+
+  void relations(const RelationsRequest &Req,
+                 llvm::function_ref<void(const SymbolID &, const Symbol &)>
+                     Callback) const override {
+    auto R = call("relations", toJSON(Req));
+    if (!R || !R->Results.Relations || !R->Results.Symbols)
+      return;
+    for (const Relation &Rel : *R->Results.Relations) {
+      auto Object = R->Results.Symbols->find(Rel.Object);
+      if (Object != R->Results.Symbols->end())
+        Callback(Rel.Subject, *Object);
+    }
+  }
+
+  // The index lives in the server.
+  size_t estimateMemoryUsage() const override { return 0; }
+
+private:
+  llvm::Optional<Response> call(llvm::StringRef Method,
+                                llvm::json::Value Params) const {
+    trace::Span Tracer("RemoteIndex");
+    SPAN_ATTACH(Tracer, "method", Method.str());
+    std::string Message = serializeRequest(Method, std::move(Params));
+
+    std::lock_guard<std::mutex> Lock(Mu);
+    bool Reused = Conn != nullptr;
+    if (!Conn && !connectLocked())
+      return llvm::None;
+    auto Reply = roundTripLocked(Message);
+    if (!Reply && Reused) {
+      // The server may have dropped the connection since the last request.
+      llvm::consumeError(Reply.takeError());
+      Conn.reset();
+      if (!connectLocked())
+        return llvm::None;
+      Reply = roundTripLocked(Message);
+    }
+    if (!Reply) {
+      elog("Remote index request {0} failed: {1}", Method, Reply.takeError());
+      Conn.reset();
+      return llvm::None;
+    }
+    auto R = parseResponse(*Reply);
+    if (!R) {
+      elog("Bad remote index response to {0}: {1}", Method, R.takeError());
+      return llvm::None;
+    }
+    return std::move(*R);
+  }
+
+  llvm::Expected<std::string> roundTripLocked(llvm::StringRef Message) const {
+    if (llvm::Error Err = Conn->writeFrame(Message))
+      return std::move(Err);
+    return Conn->readFrame();
+  }
+
+  bool connectLocked() const {
+    auto Now = std::chrono::steady_clock::now();
+    if (Now < RetryAfter)
+      return false;
+    auto C = connect(Address);
+    if (!C) {
+      elog("Can't connect to remote index at {0}: {1}", Address,
+           C.takeError());
+      RetryAfter = Now + RetryDelay;
+      return false;
+    }
+    Conn = std::move(*C);
+    Conn->setTimeout(Timeout);
+    log("Connected to remote index at {0}", Address);
+    return true;
+  }
+
+  std::string Address;
+  std::chrono::milliseconds Timeout;
+
+  // Requests share one connection and are sent one at a time.
+  mutable std::mutex Mu;
+  mutable std::unique_ptr<Connection> Conn;                 // GUARDED_BY(Mu)
+  mutable std::chrono::steady_clock::time_point RetryAfter; // GUARDED_BY(Mu)
+};
+
+} // namespace
+
+std::unique_ptr<SymbolIndex> getClient(llvm::StringRef Address,
+                                       std::chrono::milliseconds Timeout) {
+  return std::make_unique<IndexClient>(Address, Timeout);
+}
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
@@ -0,0 +1,37 @@
+//===--- Client.h - Connect to a remote index --------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_CLIENT_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_CLIENT_H
+
+#include "index/Index.h"
+#include "llvm/ADT/StringRef.h"
+#include <chrono>
+#include <memory>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+
+/// Returns an index that forwards every request to the clangd-index-server
+/// listening on \p Address ("host:port").
+///
+/// The connection is made on the first request and reopened when it breaks.
+/// Requests that fail, or that take longer than \p Timeout, return no
+/// results; while the server is unreachable, requests fail without trying to
+/// connect for a few seconds, so that a missing server doesn't slow down
+/// every completion.
+std::unique_ptr<SymbolIndex>
+getClient(llvm::StringRef Address,
+          std::chrono::milliseconds Timeout = std::chrono::seconds(10));
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
+
+#endif
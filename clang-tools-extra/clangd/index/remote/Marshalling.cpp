@@ -0,0 +1,83 @@
+//===--- Marshalling.cpp - Remote index messages -----------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/remote/Marshalling.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+enum Status : char {
+  OK = 0,
+  OKWithMore = 1,
+  Failed = 2,
+};
+
+llvm::Error error(const llvm::Twine &Message) {
+  return llvm::make_error<llvm::StringError>(Message,
+                                             llvm::inconvertibleErrorCode());
+}
+
+} // namespace
+
+std::string serializeRequest(llvm::StringRef Method, llvm::json::Value Params) {
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  OS << llvm::json::Object{{"method", Method}, {"params", std::move(Params)}};
+  return OS.str();
+}
+
+llvm::Expected<Request> parseRequest(llvm::StringRef Message) {
+  auto Parsed = llvm::json::parse(Message);
+  if (!Parsed)
+    return Parsed.takeError();
+  Request R;
+  llvm::json::ObjectMapper O(*Parsed);
+  if (!O || !O.map("method", R.Method))
+    return error("request must have a method");
+  if (const llvm::json::Value *Params = Parsed->getAsObject()->get("params"))
+    R.Params = *Params;
+  return std::move(R);
+}
+
+std::string serializeResponse(const IndexFileOut &Results, bool HasMore) {
+  std::string Result(1, HasMore ? OKWithMore : OK);
+  llvm::raw_string_ostream OS(Result);
+  IndexFileOut Out = Results;
+  Out.Format = IndexFileFormat::RIFF;
+  OS << Out;
+  return OS.str();
+}
+
+std::string serializeError(llvm::StringRef Message) {
+  return (llvm::Twine(static_cast<char>(Failed)) + Message).str();
+}
+
+llvm::Expected<Response> parseResponse(llvm::StringRef Message) {
+  if (Message.empty())
+    return error("empty response");
+  char Code = Message.front();
+  Message = Message.drop_front();
+  if (Code == Failed)
+    return error("server error: " + Message);
+  if (Code != OK && Code != OKWithMore)
+    return error("unknown response status");
+  auto Results = readIndexFile(Message);
+  if (!Results)
+    return Results.takeError();
+  Response R;
+  R.Results = std::move(*Results);
+  R.HasMore = Code == OKWithMore;
+  return std::move(R);
+}
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
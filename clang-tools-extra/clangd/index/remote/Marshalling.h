@@ -0,0 +1,63 @@
+//===--- Marshalling.h - Remote index messages -------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The messages exchanged by the remote index client and server.
+//
+// A request is a JSON object naming the SymbolIndex method to call and its
+// parameters, e.g. {"method": "lookup", "params": {"IDs": [...]}}.
+//
+// A response starts with a status byte. A successful response carries the
+// results as an index file in the RIFF format, which the client reads back
+// into slabs: symbols for fuzzyFind and lookup, refs for refs, and the
+// relations with the symbols they point to for relations. A failed response
+// carries an error message instead.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_MARSHALLING_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_MARSHALLING_H
+
+#include "index/Serialization.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include <string>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+
+/// Encodes a call of the index method \p Method with \p Params.
+std::string serializeRequest(llvm::StringRef Method, llvm::json::Value Params);
+
+/// A decoded request.
+struct Request {
+  std::string Method;
+  llvm::json::Value Params = nullptr;
+};
+llvm::Expected<Request> parseRequest(llvm::StringRef Message);
+
+/// Encodes the results of a call. \p HasMore is the result of fuzzyFind.
+std::string serializeResponse(const IndexFileOut &Results,
+                              bool HasMore = false);
+/// Encodes a call that failed.
+std::string serializeError(llvm::StringRef Message);
+
+/// A decoded successful response.
+struct Response {
+  IndexFileIn Results;
+  bool HasMore = false;
+};
+/// Fails if the message is malformed or reports an error.
+llvm::Expected<Response> parseResponse(llvm::StringRef Message);
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
+
+#endif
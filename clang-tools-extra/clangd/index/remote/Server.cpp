@@ -0,0 +1,126 @@
+//===--- Server.cpp - Serve a SymbolIndex to remote clients ------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/remote/Server.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "index/remote/Marshalling.h"
+#include <limits>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+std::string fuzzyFind(const SymbolIndex &Index, const FuzzyFindRequest &Req) {
+  SymbolSlab::Builder Symbols;
+  bool HasMore =
+      Index.fuzzyFind(Req, [&](const Symbol &S) { Symbols.insert(S); });
+  SymbolSlab Slab = std::move(Symbols).build();
+  IndexFileOut Out;
+  Out.Symbols = &Slab;
+  return serializeResponse(Out, HasMore);
+}
+
+std::string lookup(const SymbolIndex &Index, const LookupRequest &Req) {
+  SymbolSlab::Builder Symbols;
+  Index.lookup(Req, [&](const Symbol &S) { Symbols.insert(S); });
+  SymbolSlab Slab = std::move(Symbols).build();
+  IndexFileOut Out;
+  Out.Symbols = &Slab;
+  return serializeResponse(Out);
+}
+
+std::string refs(const SymbolIndex &Index, const RefsRequest &Req) {
+  // The refs callback doesn't say which symbol a ref belongs to, so query one
+  // symbol at a time to group them.
+  RefSlab::Builder Refs;
+  uint32_t Remaining =
+      Req.Limit.getValueOr(std::numeric_limits<uint32_t>::max());
+  for (const SymbolID &ID : Req.IDs) {
+    if (Remaining == 0)
+      break;
+    RefsRequest One;
+    One.IDs.insert(ID);
+    One.Filter = Req.Filter;
+    One.Limit = Remaining;
+    Index.refs(One, [&](const Ref &R) {
+      if (Remaining == 0)
+        return;
+      Refs.insert(ID, R);
+      --Remaining;
+    });
+  }
+  SymbolSlab NoSymbols;
+  RefSlab Slab = std::move(Refs).build();
+  IndexFileOut Out;
+  Out.Symbols = &NoSymbols;
+  Out.Refs = &Slab;
+  return serializeResponse(Out);
+}
+
+std::string relations(const SymbolIndex &Index, const RelationsRequest &Req) {
+  SymbolSlab::Builder Objects;
+  RelationSlab::Builder Relations;
+  Index.relations(Req, [&](const SymbolID &Subject, const Symbol &Object) {
+    Objects.insert(Object);
+    Relations.insert(Relation{Subject, Req.Predicate, Object.ID});
+  });
+  SymbolSlab ObjectSlab = std::move(Objects).build();
+  RelationSlab RelationsSlab = std::move(Relations).build();
+  IndexFileOut Out;
+  Out.Symbols = &ObjectSlab;
+  Out.Relations = &RelationsSlab;
+  return serializeResponse(Out);
+}
+
+template <typename RequestT>
+std::string handle(const SymbolIndex &Index, const Request &R,
+                   std::string (*Handler)(const SymbolIndex &,
+                                          const RequestT &)) {
+  RequestT Req;
+  if (!fromJSON(R.Params, Req))
+    return serializeError("invalid parameters for " + R.Method);
+  trace::Span Tracer(R.Method);
+  return Handler(Index, Req);
+}
+
+} // namespace
+
+std::string handleRequest(const SymbolIndex &Index, llvm::StringRef Message) {
+  auto R = parseRequest(Message);
+  if (!R)
+    return serializeError(llvm::toString(R.takeError()));
+  if (R->Method == "fuzzyFind")
+    return handle(Index, *R, fuzzyFind);
+  if (R->Method == "lookup")
+    return handle(Index, *R, lookup);
+  if (R->Method == "refs")
+    return handle(Index, *R, refs);
+  if (R->Method == "relations")
+    return handle(Index, *R, relations);
+  return serializeError("unknown method " + R->Method);
+}
+
+void serveConnection(Connection &Conn, const SymbolIndex &Index) {
+  while (true) {
+    auto Message = Conn.readFrame();
+    if (!Message) {
+      vlog("Remote index connection closed: {0}", Message.takeError());
+      return;
+    }
+    if (llvm::Error Err = Conn.writeFrame(handleRequest(Index, *Message))) {
+      elog("Can't send remote index response: {0}", std::move(Err));
+      return;
+    }
+  }
+}
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
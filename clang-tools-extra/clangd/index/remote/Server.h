@@ -0,0 +1,32 @@
+//===--- Server.h - Serve a SymbolIndex to remote clients --------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_SERVER_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_SERVER_H
+
+#include "index/Index.h"
+#include "index/remote/Socket.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+
+/// Runs the encoded request \p Message against \p Index and returns the
+/// encoded response.
+std::string handleRequest(const SymbolIndex &Index, llvm::StringRef Message);
+
+/// Answers the requests arriving on \p Conn until the client disconnects.
+void serveConnection(Connection &Conn, const SymbolIndex &Index);
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
+
+#endif
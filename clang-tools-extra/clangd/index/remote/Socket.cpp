@@ -0,0 +1,245 @@
+//===--- Socket.cpp - Framed messages over TCP sockets -----------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "index/remote/Socket.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Errno.h"
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+// Large enough for any response, small enough to reject garbage lengths.
+constexpr uint32_t MaxFrameSize = 1u << 30;
+
+llvm::Error socketError(const llvm::Twine &What) {
+  std::error_code EC(errno, std::generic_category());
+  return llvm::make_error<llvm::StringError>(
+      What + ": " + llvm::sys::StrError(), EC);
+}
+
+llvm::Error error(const llvm::Twine &Message) {
+  return llvm::make_error<llvm::StringError>(Message,
+                                             llvm::inconvertibleErrorCode());
+}
+
+// Splits "host:port" and "[host]:port".
+llvm::Error parseAddress(llvm::StringRef Address, std::string &Host,
+                         std::string &Port) {
+  llvm::StringRef HostPart, PortPart;
+  if (Address.consume_front("[")) {
+    std::tie(HostPart, PortPart) = Address.split(']');
+    if (!PortPart.consume_front(":"))
+      return error("expected port after ']' in address");
+  } else {
+    std::tie(HostPart, PortPart) = Address.rsplit(':');
+    if (HostPart.size() == Address.size())
+      return error("address must be host:port");
+  }
+  unsigned Number;
+  if (PortPart.getAsInteger(10, Number) || Number > 65535)
+    return error("invalid port '" + PortPart + "'");
+  Host = HostPart;
+  Port = PortPart;
+  return llvm::Error::success();
+}
+
+// Resolves \p Address and returns the candidate socket addresses, which the
+// caller must release with freeaddrinfo().
+llvm::Expected<addrinfo *> resolve(llvm::StringRef Address, bool Passive) {
+  std::string Host, Port;
+  if (llvm::Error Err = parseAddress(Address, Host, Port))
+    return std::move(Err);
+  addrinfo Hints = {};
+  Hints.ai_family = AF_UNSPEC;
+  Hints.ai_socktype = SOCK_STREAM;
+  if (Passive)
+    Hints.ai_flags = AI_PASSIVE;
+  addrinfo *Result;
+  int Status = getaddrinfo(Host.empty() ? nullptr : Host.c_str(), Port.c_str(),
+                           &Hints, &Result);
+  if (Status != 0)
+    return error("can't resolve " + Address + ": " + gai_strerror(Status));
+  return Result;
+}
+
+void configure(int FD) {
+  // Requests and responses are small and latency matters, so don't wait to
+  // coalesce them.
+  int One = 1;
+  setsockopt(FD, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+#ifdef SO_NOSIGPIPE
+  setsockopt(FD, SOL_SOCKET, SO_NOSIGPIPE, &One, sizeof(One));
+#endif
+}
+
+llvm::Error writeAll(int FD, llvm::StringRef Data) {
+#ifdef MSG_NOSIGNAL
+  const int Flags = MSG_NOSIGNAL;
+#else
+  const int Flags = 0;
+#endif
+  while (!Data.empty()) {
+    ssize_t Written = ::send(FD, Data.data(), Data.size(), Flags);
+    if (Written < 0) {
+      if (errno == EINTR)
+        continue;
+      return socketError("write failed");
+    }
+    Data = Data.drop_front(Written);
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error readAll(int FD, char *Data, size_t Size) {
+  while (Size > 0) {
+    ssize_t Read = ::recv(FD, Data, Size, 0);
+    if (Read < 0) {
+      if (errno == EINTR)
+        continue;
+      return socketError("read failed");
+    }
+    if (Read == 0)
+      return error("connection closed");
+    Data += Read;
+    Size -= Read;
+  }
+  return llvm::Error::success();
+}
+
+} // namespace
+
+Connection::~Connection() { ::close(FD); }
+
+llvm::Error Connection::writeFrame(llvm::StringRef Data) {
+  if (Data.size() > MaxFrameSize)
+    return error("message too large");
+  std::string Frame(sizeof(uint32_t), '\0');
+  llvm::support::endian::write32le(&Frame[0], Data.size());
+  Frame += Data;
+  return writeAll(FD, Frame);
+}
+
+llvm::Expected<std::string> Connection::readFrame() {
+  char Header[sizeof(uint32_t)];
+  if (llvm::Error Err = readAll(FD, Header, sizeof(Header)))
+    return std::move(Err);
+  uint32_t Size = llvm::support::endian::read32le(Header);
+  if (Size > MaxFrameSize)
+    return error("message too large");
+  std::string Data(Size, '\0');
+  if (llvm::Error Err = readAll(FD, &Data[0], Size))
+    return std::move(Err);
+  return std::move(Data);
+}
+
+void Connection::setTimeout(std::chrono::milliseconds Timeout) {
+  timeval TV;
+  TV.tv_sec = Timeout.count() / 1000;
+  TV.tv_usec = (Timeout.count() % 1000) * 1000;
+  setsockopt(FD, SOL_SOCKET, SO_RCVTIMEO, &TV, sizeof(TV));
+  setsockopt(FD, SOL_SOCKET, SO_SNDTIMEO, &TV, sizeof(TV));
+}
+
+llvm::Expected<std::unique_ptr<Connection>> connect(llvm::StringRef Address) {
+  auto Addresses = resolve(Address, /*Passive=*/false);
+  if (!Addresses)
+    return Addresses.takeError();
+  auto Free = llvm::make_scope_exit([&] { freeaddrinfo(*Addresses); });
+
+  llvm::Error Err = error("no addresses for " + Address);
+  for (addrinfo *AI = *Addresses; AI; AI = AI->ai_next) {
+    int FD = ::socket(AI->ai_family, AI->ai_socktype, AI->ai_protocol);
+    if (FD < 0) {
+      llvm::consumeError(std::move(Err));
+      Err = socketError("can't create socket");
+      continue;
+    }
+    int Status;
+    do
+      Status = ::connect(FD, AI->ai_addr, AI->ai_addrlen);
+    while (Status < 0 && errno == EINTR);
+    if (Status == 0) {
+      llvm::consumeError(std::move(Err));
+      configure(FD);
+      return std::make_unique<Connection>(FD);
+    }
+    llvm::consumeError(std::move(Err));
+    Err = socketError("can't connect to " + Address);
+    ::close(FD);
+  }
+  return std::move(Err);
+}
+
+llvm::Expected<std::unique_ptr<Listener>>
+Listener::listen(llvm::StringRef Address) {
+  auto Addresses = resolve(Address, /*Passive=*/true);
+  if (!Addresses)
+    return Addresses.takeError();
+  auto Free = llvm::make_scope_exit([&] { freeaddrinfo(*Addresses); });
+
+  llvm::Error Err = error("no addresses for " + Address);
+  for (addrinfo *AI = *Addresses; AI; AI = AI->ai_next) {
+    int FD = ::socket(AI->ai_family, AI->ai_socktype, AI->ai_protocol);
+    if (FD < 0) {
+      llvm::consumeError(std::move(Err));
+      Err = socketError("can't create socket");
+      continue;
+    }
+    int One = 1;
+    setsockopt(FD, SOL_SOCKET, SO_REUSEADDR, &One, sizeof(One));
+    if (::bind(FD, AI->ai_addr, AI->ai_addrlen) == 0 &&
+        ::listen(FD, SOMAXCONN) == 0) {
+      llvm::consumeError(std::move(Err));
+      return std::unique_ptr<Listener>(new Listener(FD));
+    }
+    llvm::consumeError(std::move(Err));
+    Err = socketError("can't listen on " + Address);
+    ::close(FD);
+  }
+  return std::move(Err);
+}
+
+Listener::~Listener() { ::close(FD); }
+
+llvm::Expected<std::unique_ptr<Connection>> Listener::accept() {
+  int ConnFD;
+  do
+    ConnFD = ::accept(FD, nullptr, nullptr);
+  while (ConnFD < 0 && errno == EINTR);
+  if (ConnFD < 0)
+    return socketError("accept failed");
+  configure(ConnFD);
+  return std::make_unique<Connection>(ConnFD);
+}
+
+unsigned Listener::getPort() const {
+  sockaddr_storage Addr;
+  socklen_t Len = sizeof(Addr);
+  if (getsockname(FD, reinterpret_cast<sockaddr *>(&Addr), &Len) != 0)
+    return 0;
+  if (Addr.ss_family == AF_INET)
+    return ntohs(reinterpret_cast<sockaddr_in *>(&Addr)->sin_port);
+  if (Addr.ss_family == AF_INET6)
+    return ntohs(reinterpret_cast<sockaddr_in6 *>(&Addr)->sin6_port);
+  return 0;
+}
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
@@ -0,0 +1,82 @@
+//===--- Socket.h - Framed messages over TCP sockets -------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The remote index client and server exchange messages over a TCP connection.
+// Each message is sent as a frame: its length as a 32-bit little-endian
+// integer, followed by that many bytes.
+//
+// Addresses are written "host:port". The host may be a name or a numeric
+// address, IPv6 addresses are written in brackets, as in "[::1]:50051".
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_SOCKET_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_REMOTE_SOCKET_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+
+/// A connected stream socket, which is closed when the object is destroyed.
+class Connection {
+public:
+  explicit Connection(int FD) : FD(FD) {}
+  ~Connection();
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  /// Sends \p Data as one frame.
+  llvm::Error writeFrame(llvm::StringRef Data);
+  /// Receives the next frame. Fails if the peer closed the connection, if the
+  /// frame is malformed, or if the read times out.
+  llvm::Expected<std::string> readFrame();
+
+  /// Makes reads and writes that block for longer than \p Timeout fail.
+  void setTimeout(std::chrono::milliseconds Timeout);
+
+private:
+  int FD;
+};
+
+/// Connects to the server listening on \p Address.
+llvm::Expected<std::unique_ptr<Connection>> connect(llvm::StringRef Address);
+
+/// A socket that accepts connections on a local address.
+class Listener {
+public:
+  /// Starts listening on \p Address. Port 0 picks any free port.
+  static llvm::Expected<std::unique_ptr<Listener>>
+  listen(llvm::StringRef Address);
+
+  ~Listener();
+  Listener(const Listener &) = delete;
+  Listener &operator=(const Listener &) = delete;
+
+  /// Waits for the next connection.
+  llvm::Expected<std::unique_ptr<Connection>> accept();
+
+  /// The port the socket is bound to.
+  unsigned getPort() const;
+
+private:
+  explicit Listener(int FD) : FD(FD) {}
+
+  int FD;
+};
+
+} // namespace remote
+} // namespace clangd
+} // namespace clang
+
+#endif
@@ -0,0 +1,95 @@
+//===--- ServerMain.cpp ------------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// clangd-index-server serves an index built by clangd-indexer to clangd
+// instances started with -remote-index-address.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Logger.h"
+#include "Threading.h"
+#include "index/Serialization.h"
+#include "index/remote/Server.h"
+#include "index/remote/Socket.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+static const std::string Overview = R"(
+This is an **experimental** server that answers index requests from clangd
+instances, using an index file produced by clangd-indexer. Start clangd with
+-remote-index-address=<host>:<port> to use it.
+)";
+
+llvm::cl::opt<std::string> IndexPath(llvm::cl::desc("<INDEX FILE>"),
+                                     llvm::cl::Positional,
+                                     llvm::cl::Required);
+
+llvm::cl::opt<std::string> ListenAddress(
+    "listen",
+    llvm::cl::desc("Address to listen on, as host:port. An empty host accepts "
+                   "connections on all interfaces"),
+    llvm::cl::init("localhost:50051"));
+
+llvm::cl::opt<Logger::Level> LogLevel(
+    "log", llvm::cl::desc("Verbosity of log messages written to stderr"),
+    llvm::cl::values(
+        clEnumValN(Logger::Error, "error", "Error messages only"),
+        clEnumValN(Logger::Info, "info", "High level execution tracing"),
+        clEnumValN(Logger::Debug, "verbose", "Low level details")),
+    llvm::cl::init(Logger::Info));
+
+int run() {
+  std::unique_ptr<SymbolIndex> Index = loadIndex(IndexPath, /*UseDex=*/true);
+  if (!Index) {
+    elog("Failed to load the index from {0}", IndexPath);
+    return 1;
+  }
+
+  auto Server = Listener::listen(ListenAddress);
+  if (!Server) {
+    elog("{0}", Server.takeError());
+    return 1;
+  }
+  log("Serving {0} on port {1}", IndexPath, (*Server)->getPort());
+
+  // Each client keeps its connection open, so serve each one on its own
+  // thread. Dex answers concurrent requests without locking.
+  AsyncTaskRunner Connections;
+  while (true) {
+    auto Conn = (*Server)->accept();
+    if (!Conn) {
+      elog("{0}", Conn.takeError());
+      continue;
+    }
+    Connections.runAsync("connection", [&Index, C = std::move(*Conn)] {
+      serveConnection(*C, *Index);
+    });
+  }
+}
+
+} // namespace
+} // namespace remote
+} // namespace clangd
+} // namespace clang
+
+int main(int argc, const char *argv[]) {
+  using namespace clang::clangd::remote;
+
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+  llvm::cl::ParseCommandLineOptions(argc, argv, Overview);
+
+  clang::clangd::StreamLogger Logger(llvm::errs(), LogLevel);
+  clang::clangd::LoggingSession LoggingSession(Logger);
+  return run();
+}
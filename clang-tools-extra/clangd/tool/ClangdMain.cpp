@@ -15,6 +15,9 @@
 #include "Transport.h"
 #include "index/Background.h"
 #include "index/Serialization.h"
+#if CLANGD_ENABLE_REMOTE
+#include "index/remote/Client.h"
+#endif
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
 #include "llvm/ADT/Optional.h"
@@ -272,6 +275,14 @@ opt<unsigned> WorkerThreadsCount{
     init(getDefaultAsyncThreadsCount()),
 };
 
+opt<unsigned> ASTCacheLimit{
+    "ast-cache-limit",
+    cat(Misc),
+    desc("Maximum memory, in MB, used by the ASTs retained for idle open "
+         "files. 0 means no limit"),
+    init(0),
+};
+
 opt<Path> IndexFile{
     "index-file",
     cat(Misc),
@@ -284,6 +295,17 @@ opt<Path> IndexFile{
     Hidden,
 };
 
+opt<std::string> RemoteIndexAddress{
+    "remote-index-address",
+    cat(Misc),
+    desc("Address (host:port) of a clangd-index-server to use as the static "
+         "index, instead of -index-file\n"
+         "WARNING: This option is experimental only, and will be removed "
+         "eventually. Don't rely on it"),
+    init(""),
+    Hidden,
+};
+
 opt<bool> Test{
     "lit-test",
     cat(Misc),
@@ -426,7 +448,8 @@ const char TestScheme::TestDir[] = "/clangd-test";
 
 enum class ErrorResultCode : int {
   NoShutdownRequest = 1,
-  CantRunAsXPCService = 2
+  CantRunAsXPCService = 2,
+  CantUseRemoteIndex = 3
 };
 
 int main(int argc, char *argv[]) {
@@ -582,7 +605,17 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
   Opts.BackgroundIndex = EnableBackgroundIndex;
   std::unique_ptr<SymbolIndex> StaticIdx;
   std::future<void> AsyncIndexLoad; // Block exit while loading the index.
-  if (EnableIndex && !IndexFile.empty()) {
+  if (EnableIndex && !RemoteIndexAddress.empty()) {
+#if CLANGD_ENABLE_REMOTE
+    if (!IndexFile.empty())
+      elog("Ignoring -index-file, the remote index is used instead");
+    StaticIdx = remote::getClient(RemoteIndexAddress);
+#else
+    llvm::errs() << "This clangd binary wasn't built with remote index "
+                    "support.\n";
+    return (int)ErrorResultCode::CantUseRemoteIndex;
+#endif
+  } else if (EnableIndex && !IndexFile.empty()) {
     // Load the index asynchronously. Meanwhile SwapIndex returns no results.
     SwapIndex *Placeholder;
     StaticIdx.reset(Placeholder = new SwapIndex(std::make_unique<MemIndex>()));
@@ -595,6 +628,8 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
   }
   Opts.StaticIndex = StaticIdx.get();
   Opts.AsyncThreadsCount = WorkerThreadsCount;
+  Opts.RetentionPolicy.MaxRetainedBytes =
+      static_cast<std::size_t>(ASTCacheLimit) * 1024 * 1024;
 
   clangd::CodeCompleteOptions CCOpts;
   CCOpts.IncludeIneligibleResults = IncludeIneligibleResults;
@@ -619,6 +619,29 @@ TEST_F(BackgroundIndexRebuilderTest, IndexingTUs) {
   EXPECT_TRUE(checkRebuild([&] { Rebuilder.indexedTU(); }));
 }
 
+TEST_F(BackgroundIndexRebuilderTest, IncrementalRebuilds) {
+  for (unsigned I = 0; I < Rebuilder.TUsBeforeFirstBuild - 1; ++I)
+    Rebuilder.indexedTU();
+  EXPECT_TRUE(checkRebuild([&] { Rebuilder.indexedTU(); }));
+
+  auto HasTestSymbol = [&] {
+    bool Found = false;
+    LookupRequest Req;
+    Req.IDs.insert(TestSymbol.ID);
+    Target.lookup(Req, [&](const Symbol &) { Found = true; });
+    return Found;
+  };
+  // Incremental rebuilds still serve the symbols of removed files...
+  Source.update("", nullptr, nullptr, nullptr, false);
+  for (unsigned I = 0; I < Rebuilder.TUsBeforeRebuild; ++I)
+    Rebuilder.indexedTU();
+  EXPECT_TRUE(HasTestSymbol());
+  // ...until the next full rebuild.
+  Rebuilder.indexedTU();
+  Rebuilder.idle();
+  EXPECT_FALSE(HasTestSymbol());
+}
+
 TEST_F(BackgroundIndexRebuilderTest, LoadingShards) {
   Rebuilder.startLoading();
   Rebuilder.loadedShard(10);
@@ -206,6 +206,83 @@ TEST(CompletionTest, Filter) {
               AllOf(Has("Car"), Not(Has("MotorCar"))));
 }
 
+TEST(CompletionTest, RefineCachedCompletion) {
+  Annotations Old(R"cpp(
+    #define MotorCar
+    int Car;
+    struct S {
+      int FooBar;
+      int FooBaz;
+      int Qux;
+    };
+    int main() { S().F^ }
+  )cpp");
+  CachedCompletion Cached{Old.code(), Old.point(), completions(Old.code())};
+  ASSERT_FALSE(Cached.Result.HasMore);
+  ASSERT_THAT(Cached.Result.Completions, Has("FooBar"));
+
+  // Typing more of the identifier filters the cached completions.
+  Annotations Typed(R"cpp(
+    #define MotorCar
+    int Car;
+    struct S {
+      int FooBar;
+      int FooBaz;
+      int Qux;
+    };
+    int main() { S().Foobr^ }
+  )cpp");
+  auto Refined = refineCachedCompletion(Cached, Typed.code(), Typed.point(),
+                                        clangd::CodeCompleteOptions());
+  ASSERT_TRUE(Refined);
+  EXPECT_THAT(Refined->Completions, ElementsAre(Named("FooBar")));
+  EXPECT_EQ(Refined->Completions.front().CompletionTokenRange.end,
+            Typed.point());
+
+  clangd::CodeCompleteOptions Opts;
+  Opts.Limit = 1;
+  Typed = Annotations(R"cpp(
+    #define MotorCar
+    int Car;
+    struct S {
+      int FooBar;
+      int FooBaz;
+      int Qux;
+    };
+    int main() { S().Fo^ }
+  )cpp");
+  Refined = refineCachedCompletion(Cached, Typed.code(), Typed.point(), Opts);
+  ASSERT_TRUE(Refined);
+  EXPECT_THAT(Refined->Completions, ElementsAre(Named("FooBar")));
+  EXPECT_TRUE(Refined->HasMore);
+
+  // Other edits need Sema to run again.
+  Annotations Edited(R"cpp(
+    #define MotorCar
+    int Car;
+    struct S {
+      int FooBar;
+      int FooBaz;
+    };
+    int main() { S().Foo^ }
+  )cpp");
+  EXPECT_FALSE(refineCachedCompletion(Cached, Edited.code(), Edited.point(),
+                                      clangd::CodeCompleteOptions()));
+  Annotations NotIdentifier(R"cpp(
+    #define MotorCar
+    int Car;
+    struct S {
+      int FooBar;
+      int FooBaz;
+      int Qux;
+    };
+    int main() { S().F(^ }
+  )cpp");
+  EXPECT_FALSE(refineCachedCompletion(Cached, NotIdentifier.code(),
+                                      NotIdentifier.point(),
+                                      clangd::CodeCompleteOptions()));
+}
+
 void TestAfterDotCompletion(clangd::CodeCompleteOptions Opts) {
   auto Results = completions(
       R"cpp(
@@ -20,11 +20,13 @@
 #include "llvm/Support/raw_ostream.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 
 using ::testing::AnyOf;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
 
@@ -68,6 +70,28 @@ TEST(DexIterators, DocumentIterator) {
   EXPECT_TRUE(DocIterator->reachedEnd());
 }
 
+TEST(DexIterators, DocumentIteratorManyChunks) {
+  // Mix gaps that take one, two and three bytes to encode.
+  std::vector<DocID> Docs;
+  DocID Last = 0;
+  for (DocID I = 0; I < 2000; ++I)
+    Docs.push_back(Last += (I % 7 == 0) ? 300 : (I % 13 == 0) ? 20000 : 1);
+  const PostingList L(Docs);
+
+  auto DocIterator = L.iterator();
+  EXPECT_THAT(consumeIDs(*DocIterator), ElementsAreArray(Docs));
+
+  DocIterator = L.iterator();
+  for (DocID Target = 0; Target <= Docs.back(); Target += 997) {
+    DocIterator->advanceTo(Target);
+    ASSERT_FALSE(DocIterator->reachedEnd());
+    EXPECT_EQ(DocIterator->peek(),
+              *std::lower_bound(Docs.begin(), Docs.end(), Target));
+  }
+  DocIterator->advanceTo(Docs.back() + 1);
+  EXPECT_TRUE(DocIterator->reachedEnd());
+}
+
 TEST(DexIterators, AndTwoLists) {
   Corpus C{10000};
   const PostingList L0({0, 5, 7, 10, 42, 320, 9000});
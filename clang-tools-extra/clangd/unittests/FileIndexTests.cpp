@@ -122,6 +122,30 @@ TEST(FileSymbolsTest, MergeOverlap) {
             AllOf(QName("x"), DeclURI("file:///x1"), DefURI("file:///x2"))));
 }
 
+TEST(FileSymbolsTest, ChangedSince) {
+  FileSymbols FS;
+  FS.update("f1", numSlab(1, 3), nullptr, nullptr, false);
+  unsigned Version = 0;
+  FS.buildIndex(IndexType::Light, DuplicateHandling::PickOne,
+                /*ChangedSince=*/0, &Version);
+
+  FS.update("f2", numSlab(4, 5), nullptr, nullptr, false);
+  EXPECT_THAT(runFuzzyFind(*FS.buildIndex(IndexType::Light,
+                                          DuplicateHandling::PickOne, Version),
+                           ""),
+              UnorderedElementsAre(QName("4"), QName("5")));
+
+  FS.update("f1", numSlab(1, 2), nullptr, nullptr, false);
+  EXPECT_THAT(runFuzzyFind(*FS.buildIndex(IndexType::Light,
+                                          DuplicateHandling::PickOne, Version),
+                           ""),
+              UnorderedElementsAre(QName("1"), QName("2"), QName("4"),
+                                   QName("5")));
+  EXPECT_THAT(runFuzzyFind(*FS.buildIndex(IndexType::Light), ""),
+              UnorderedElementsAre(QName("1"), QName("2"), QName("4"),
+                                   QName("5")));
+}
+
 TEST(FileSymbolsTest, SnapshotAliveAfterRemove) {
   FileSymbols FS;
 
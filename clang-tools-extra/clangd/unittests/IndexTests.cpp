@@ -127,6 +127,45 @@ TEST(SwapIndexTest, OldIndexRecycled) {
   EXPECT_TRUE(WeakToken.expired());       // So the token is too.
 }
 
+TEST(IndexRequestTest, JSONRoundTrip) {
+  auto RoundTrip = [](const auto &Request) {
+    std::decay_t<decltype(Request)> Result;
+    EXPECT_TRUE(fromJSON(toJSON(Request), Result));
+    return Result;
+  };
+
+  FuzzyFindRequest Find;
+  Find.Query = "foo";
+  Find.Scopes = {"ns::"};
+  EXPECT_EQ(Find, RoundTrip(Find));
+  Find.Limit = 10;
+  EXPECT_EQ(Find, RoundTrip(Find));
+
+  LookupRequest Lookup;
+  Lookup.IDs = {SymbolID("X"), SymbolID("Y")};
+  EXPECT_EQ(Lookup.IDs, RoundTrip(Lookup).IDs);
+
+  RefsRequest Refs;
+  Refs.IDs = {SymbolID("X")};
+  Refs.Filter = RefKind::Definition;
+  RefsRequest RefsResult = RoundTrip(Refs);
+  EXPECT_EQ(Refs.IDs, RefsResult.IDs);
+  EXPECT_EQ(RefKind::Definition, RefsResult.Filter);
+  EXPECT_EQ(llvm::None, RefsResult.Limit);
+  Refs.Limit = 5;
+  EXPECT_EQ(5u, RoundTrip(Refs).Limit);
+
+  RelationsRequest Relations;
+  Relations.Subjects = {SymbolID("X")};
+  Relations.Predicate = index::SymbolRole::RelationBaseOf;
+  RelationsRequest RelationsResult = RoundTrip(Relations);
+  EXPECT_EQ(Relations.Subjects, RelationsResult.Subjects);
+  EXPECT_EQ(index::SymbolRole::RelationBaseOf, RelationsResult.Predicate);
+
+  Lookup = LookupRequest();
+  EXPECT_FALSE(fromJSON(llvm::json::Object{{"IDs", {"not an ID"}}}, Lookup));
+}
+
 TEST(MemIndexTest, MemIndexDeduplicate) {
   std::vector<Symbol> Symbols = {symbol("1"), symbol("2"), symbol("3"),
                                  symbol("2") /* duplicate */};
@@ -496,6 +496,27 @@ TEST_F(TUSchedulerTests, EvictedAST) {
               UnorderedElementsAre(Foo, AnyOf(Bar, Baz)));
 }
 
+TEST_F(TUSchedulerTests, EvictedASTBySize) {
+  ASTRetentionPolicy Policy;
+  // Any AST is over this limit, so only the most recently used one is kept.
+  Policy.MaxRetainedBytes = 1;
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/1, /*StorePreambleInMemory=*/true,
+                /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                Policy);
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  S.update(Foo, getInputs(Foo, "int a;"), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  ASSERT_THAT(S.getFilesWithCachedAST(), ElementsAre(Foo));
+
+  S.update(Bar, getInputs(Bar, "int b;"), WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Bar));
+}
+
 TEST_F(TUSchedulerTests, EmptyPreamble) {
   TUScheduler S(CDB,
                 /*AsyncThreadsCount=*/4, /*StorePreambleInMemory=*/true,
@@ -661,6 +682,81 @@ TEST_F(TUSchedulerTests, NoChangeDiags) {
   ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
 }
 
+TEST_F(TUSchedulerTests, ReopenReusesPreamble) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, /*ASTCallbacks=*/nullptr,
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+
+  auto Foo = testPath("foo.cpp");
+  auto Header = testPath("foo.h");
+  Files[Header] = "int a;";
+  Timestamps[Header] = time_t(0);
+  auto Contents = R"cpp(
+    #include "foo.h"
+    int b = a;
+  )cpp";
+
+  auto GetPreamble = [&]() {
+    const PreambleData *Result = nullptr;
+    S.runWithPreamble("GetPreamble", Foo, TUScheduler::Stale,
+                      [&](Expected<InputsAndPreamble> IP) {
+                        Result = cantFail(std::move(IP)).Preamble;
+                      });
+    EXPECT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+    return Result;
+  };
+
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::No);
+  const PreambleData *Preamble = GetPreamble();
+  ASSERT_NE(Preamble, nullptr);
+
+  // Reopening the file reuses the preamble it had when it was closed.
+  S.remove(Foo);
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::No);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_EQ(GetPreamble(), Preamble);
+
+  // But not if the headers changed in the meantime.
+  S.remove(Foo);
+  Timestamps[Header] = time_t(1);
+  S.update(Foo, getInputs(Foo, Contents), WantDiagnostics::No);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_NE(GetPreamble(), Preamble);
+}
+
+TEST_F(TUSchedulerTests, DiagsFromStalePreamble) {
+  TUScheduler S(CDB,
+                /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
+                /*StorePreambleInMemory=*/true, captureDiags(),
+                /*UpdateDebounce=*/std::chrono::steady_clock::duration::zero(),
+                ASTRetentionPolicy());
+
+  auto Source = testPath("foo.cpp");
+  auto Header = testPath("foo.h");
+  Files[Header] = "int a;";
+  Timestamps[Header] = time_t(0);
+
+  updateWithDiags(S, Source, "#include \"foo.h\"\nint x = a;",
+                  WantDiagnostics::Yes, [](std::vector<Diag> Diags) {
+                    EXPECT_THAT(Diags, ElementsAre());
+                  });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+
+  // A change to the header first publishes the diagnostics from the old
+  // preamble, which doesn't declare b, then the ones from the new preamble.
+  Files[Header] = "int b;";
+  Timestamps[Header] = time_t(1);
+  std::vector<size_t> DiagCounts;
+  updateWithDiags(S, Source, "#include \"foo.h\"\nint x = b;",
+                  WantDiagnostics::Yes, [&](std::vector<Diag> Diags) {
+                    DiagCounts.push_back(Diags.size());
+                  });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(DiagCounts, ElementsAre(1u, 0u));
+}
+
 TEST_F(TUSchedulerTests, Run) {
   TUScheduler S(CDB, /*AsyncThreadsCount=*/getDefaultAsyncThreadsCount(),
                 /*StorePreambleInMemory=*/true, /*ASTCallbacks=*/nullptr,
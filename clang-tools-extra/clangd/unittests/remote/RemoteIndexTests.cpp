@@ -0,0 +1,176 @@
+//===-- RemoteIndexTests.cpp ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestIndex.h"
+#include "index/MemIndex.h"
+#include "index/remote/Client.h"
+#include "index/remote/Marshalling.h"
+#include "index/remote/Server.h"
+#include "index/remote/Socket.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+namespace clang {
+namespace clangd {
+namespace remote {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+std::unique_ptr<SymbolIndex> testIndex() {
+  SymbolSlab::Builder Symbols;
+  Symbols.insert(symbol("ns::Base"));
+  Symbols.insert(symbol("ns::Derived"));
+  Symbols.insert(symbol("ns::Other"));
+
+  RefSlab::Builder Refs;
+  Ref R;
+  R.Location.FileURI = "unittest:///base.cc";
+  R.Location.Start.setLine(3);
+  R.Kind = RefKind::Reference;
+  Refs.insert(SymbolID("ns::Base"), R);
+  R.Location.Start.setLine(7);
+  R.Kind = RefKind::Definition;
+  Refs.insert(SymbolID("ns::Base"), R);
+
+  RelationSlab::Builder Relations;
+  Relations.insert(Relation{SymbolID("ns::Base"),
+                            index::SymbolRole::RelationBaseOf,
+                            SymbolID("ns::Derived")});
+
+  return MemIndex::build(std::move(Symbols).build(), std::move(Refs).build(),
+                         std::move(Relations).build());
+}
+
+// Serves an index on a loopback port to one client.
+class RemoteIndexTest : public ::testing::Test {
+protected:
+  RemoteIndexTest() : Index(testIndex()) {}
+
+  void SetUp() override {
+    auto L = Listener::listen("127.0.0.1:0");
+    ASSERT_THAT_EXPECTED(L, llvm::Succeeded());
+    Server = std::move(*L);
+    Address = "127.0.0.1:" + std::to_string(Server->getPort());
+    ServerThread = std::thread([this] {
+      auto Conn = Server->accept();
+      if (Conn)
+        serveConnection(**Conn, *Index);
+      else
+        llvm::consumeError(Conn.takeError());
+    });
+    Client = getClient(Address);
+  }
+
+  void TearDown() override {
+    if (!ServerThread.joinable())
+      return;
+    // Closing the client's connection ends serveConnection(). If the client
+    // never connected, this connection ends it instead.
+    Client.reset();
+    llvm::consumeError(connect(Address).takeError());
+    ServerThread.join();
+  }
+
+  std::unique_ptr<SymbolIndex> Index;
+  std::unique_ptr<Listener> Server;
+  std::string Address;
+  std::thread ServerThread;
+  std::unique_ptr<SymbolIndex> Client;
+};
+
+TEST_F(RemoteIndexTest, FuzzyFind) {
+  FuzzyFindRequest Req;
+  Req.Scopes = {"ns::"};
+  bool Incomplete;
+  EXPECT_THAT(match(*Client, Req, &Incomplete),
+              UnorderedElementsAre("ns::Base", "ns::Derived", "ns::Other"));
+  EXPECT_FALSE(Incomplete);
+
+  Req.Query = "Der";
+  EXPECT_THAT(match(*Client, Req), ElementsAre("ns::Derived"));
+
+  Req.Query = "";
+  Req.Limit = 1;
+  EXPECT_EQ(1u, match(*Client, Req, &Incomplete).size());
+  EXPECT_TRUE(Incomplete);
+}
+
+TEST_F(RemoteIndexTest, Lookup) {
+  EXPECT_THAT(lookup(*Client, {SymbolID("ns::Base"), SymbolID("ns::Gone")}),
+              ElementsAre("ns::Base"));
+}
+
+TEST_F(RemoteIndexTest, Refs) {
+  RefsRequest Req;
+  Req.IDs.insert(SymbolID("ns::Base"));
+  std::vector<std::pair<std::string, int>> Results;
+  auto Collect = [&](const Ref &R) {
+    Results.emplace_back(R.Location.FileURI, R.Location.Start.line());
+  };
+  Client->refs(Req, Collect);
+  EXPECT_THAT(Results,
+              UnorderedElementsAre(std::make_pair("unittest:///base.cc", 3),
+                                   std::make_pair("unittest:///base.cc", 7)));
+
+  Results.clear();
+  Req.Filter = RefKind::Definition;
+  Client->refs(Req, Collect);
+  EXPECT_THAT(Results, ElementsAre(std::make_pair("unittest:///base.cc", 7)));
+
+  Results.clear();
+  Req.Filter = RefKind::All;
+  Req.Limit = 1;
+  Client->refs(Req, Collect);
+  EXPECT_EQ(1u, Results.size());
+}
+
+TEST_F(RemoteIndexTest, Relations) {
+  RelationsRequest Req;
+  Req.Subjects.insert(SymbolID("ns::Base"));
+  Req.Predicate = index::SymbolRole::RelationBaseOf;
+  std::vector<std::pair<SymbolID, std::string>> Results;
+  Client->relations(Req, [&](const SymbolID &Subject, const Symbol &Object) {
+    Results.emplace_back(Subject, getQualifiedName(Object));
+  });
+  EXPECT_THAT(Results,
+              ElementsAre(std::make_pair(SymbolID("ns::Base"), "ns::Derived")));
+}
+
+TEST(RemoteIndexServerTest, BadRequests) {
+  auto Index = testIndex();
+  EXPECT_THAT_EXPECTED(parseResponse(handleRequest(*Index, "not json")),
+                       llvm::Failed());
+  EXPECT_THAT_EXPECTED(
+      parseResponse(handleRequest(*Index, serializeRequest("drop", nullptr))),
+      llvm::Failed());
+  EXPECT_THAT_EXPECTED(parseResponse(handleRequest(
+                           *Index, serializeRequest("lookup", "no IDs"))),
+                       llvm::Failed());
+  EXPECT_THAT_EXPECTED(parseResponse(""), llvm::Failed());
+}
+
+TEST(RemoteIndexClientTest, NoServer) {
+  std::string Address;
+  {
+    auto L = Listener::listen("127.0.0.1:0");
+    ASSERT_THAT_EXPECTED(L, llvm::Succeeded());
+    Address = "127.0.0.1:" + std::to_string((*L)->getPort());
+  }
+  auto Client = getClient(Address);
+  EXPECT_THAT(lookup(*Client, {SymbolID("ns::Base")}), ElementsAre());
+  EXPECT_THAT(match(*Client, FuzzyFindRequest()), ElementsAre());
+}
+
+} // namespace
+} // namespace remote
+} // namespace clangd
+} // namespace clang
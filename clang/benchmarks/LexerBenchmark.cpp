@@ -0,0 +1,58 @@
+#include "benchmark/benchmark.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Token.h"
+#include <string>
+
+using namespace clang;
+
+enum { NumDecls = 20000 };
+
+// Text shaped like a large library header: documentation comments, indented
+// declarations with long identifiers, and string and character literals.
+static std::string makeHeaderText() {
+  std::string Text = "#ifndef LARGE_HEADER_H\n#define LARGE_HEADER_H\n\n";
+  for (unsigned I = 0; I != NumDecls; ++I) {
+    std::string N = std::to_string(I);
+    Text += "/// Returns the configuration value number " + N +
+            " for the current\n"
+            "/// translation unit, or the default if it was never set.\n"
+            "namespace detail_namespace_" + N + " {\n"
+            "    // Keep this in sync with the table in the implementation.\n"
+            "    static const char *const ConfigurationValueName_" + N +
+            " = \"configuration value with a reasonably long name " + N +
+            "\";\n"
+            "    inline unsigned getConfigurationValueForTranslationUnit_" +
+            N + "(const char Separator = ':', unsigned DefaultValue = " + N +
+            ") {\n"
+            "        return lookupConfigurationValue(ConfigurationValueName_" +
+            N + ", Separator, DefaultValue);\n"
+            "    }\n"
+            "} // end namespace detail_namespace_" + N + "\n\n";
+  }
+  Text += "#endif // LARGE_HEADER_H\n";
+  return Text;
+}
+
+static void BM_RawLexHeader(benchmark::State &State) {
+  std::string Text = makeHeaderText();
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = true;
+  LangOpts.CPlusPlus11 = true;
+  LangOpts.LineComment = true;
+
+  for (auto _ : State) {
+    Lexer L(SourceLocation(), LangOpts, Text.data(), Text.data(),
+            Text.data() + Text.size());
+    Token Tok;
+    unsigned NumTokens = 0;
+    while (!L.LexFromRawLexer(Tok))
+      ++NumTokens;
+    benchmark::DoNotOptimize(NumTokens);
+  }
+  State.SetBytesProcessed(State.iterations() * Text.size());
+}
+BENCHMARK(BM_RawLexHeader)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
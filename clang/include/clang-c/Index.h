@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 59
+#define CINDEX_VERSION_MINOR 60
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -6664,6 +6664,45 @@ CINDEX_LINKAGE int clang_indexSourceFileFullArgv(
     int num_command_line_args, struct CXUnsavedFile *unsaved_files,
     unsigned num_unsaved_files, CXTranslationUnit *out_TU, unsigned TU_options);
 
+/**
+ * Index several source files in parallel, on a pool of \p num_threads worker
+ * threads.
+ *
+ * File \c i is indexed as if by #clang_indexSourceFileFullArgv with
+ * \c client_data[i], \c source_filenames[i] (or NULL if \p source_filenames
+ * is NULL) and the \c num_command_line_args[i] arguments in
+ * \c command_line_args[i], and its result is stored in \c results[i]. The
+ * unsaved files apply to every file. No translation units are returned.
+ *
+ * Files are indexed concurrently, so the callbacks in \p index_callbacks can
+ * be invoked from several threads at once, each call passing the client data
+ * of the file being indexed; they must be safe to call concurrently. When
+ * \c CXIndexOpt_SkipParsedBodiesInSession is set, function bodies parsed for
+ * one file are skipped in all files of the session, as with sequential calls.
+ *
+ * Each worker parses its file with its own file and source managers. A
+ * precompiled header named with -include-pch can be used by all files; it is
+ * read, not written, while indexing.
+ *
+ * Elsewhere in libclang, a translation unit must not be used from two threads
+ * at the same time, but different translation units, even of the same
+ * CXIndex, can be parsed and reparsed concurrently.
+ *
+ * \param num_threads the number of worker threads; 0 uses one thread per
+ * core.
+ *
+ * \returns 0 if all files were indexed, possibly with errors reported in
+ * \p results, or an error code if the arguments are invalid.
+ */
+CINDEX_LINKAGE int clang_indexSourceFilesFullArgv(
+    CXIndexAction, CXClientData *client_data, IndexerCallbacks *index_callbacks,
+    unsigned index_callbacks_size, unsigned index_options,
+    unsigned num_source_files, const char *const *source_filenames,
+    const char *const *const *command_line_args,
+    const int *num_command_line_args, struct CXUnsavedFile *unsaved_files,
+    unsigned num_unsaved_files, unsigned TU_options, unsigned num_threads,
+    int *results);
+
 /**
  * Index the given translation unit via callbacks implemented through
  * #IndexerCallbacks.
@@ -89,6 +89,7 @@ class AtomicExpr;
 class BlockExpr;
 class BuiltinTemplateDecl;
 class CharUnits;
+class ConstexprInterpreter;
 class CXXABI;
 class CXXConstructorDecl;
 class CXXMethodDecl;
@@ -2242,6 +2243,10 @@ public:
 
   VTableContextBase *getVTableContext();
 
+  /// Get the bytecode interpreter that constant evaluation uses under
+  /// -fexperimental-new-constant-interpreter.
+  ConstexprInterpreter &getConstexprInterpreter();
+
   /// If \p T is null pointer, assume the target in ASTContext.
   MangleContext *createMangleContext(const TargetInfo *T = nullptr);
 
@@ -2988,6 +2993,8 @@ private:
 
   std::unique_ptr<VTableContextBase> VTContext;
 
+  std::unique_ptr<ConstexprInterpreter> ConstexprInterp;
+
   void ReleaseDeclContextMaps();
 
 public:
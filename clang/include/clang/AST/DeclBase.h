@@ -1000,6 +1000,10 @@ public:
   static void EnableStatistics();
   static void PrintStats();
 
+  /// The size of a declaration of kind \p K, not counting the objects
+  /// allocated past its end.
+  static size_t getNodeSize(Kind K);
+
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
   bool isTemplateParameter() const;
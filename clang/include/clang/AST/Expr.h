@@ -1125,6 +1125,11 @@ public:
 /// they apply in order to conserve memory. These are laid out past the end of
 /// the object, and flags in the DeclRefExprBitfield track whether they exist:
 ///
+///   DeclRefExprBits.HasNameLoc:
+///       Specifies when this declaration reference expression has source
+///       location information for its declaration name beyond the name's own
+///       location, which is only the case for names of operators, literal
+///       operators, constructors, destructors and conversion functions.
 ///   DeclRefExprBits.HasQualifier:
 ///       Specifies when this declaration reference expression has a C++
 ///       nested-name-specifier.
@@ -1140,8 +1145,9 @@ public:
 ///       refers to an enclosed local or a captured variable.
 class DeclRefExpr final
     : public Expr,
-      private llvm::TrailingObjects<DeclRefExpr, NestedNameSpecifierLoc,
-                                    NamedDecl *, ASTTemplateKWAndArgsInfo,
+      private llvm::TrailingObjects<DeclRefExpr, DeclarationNameLoc,
+                                    NestedNameSpecifierLoc, NamedDecl *,
+                                    ASTTemplateKWAndArgsInfo,
                                     TemplateArgumentLoc> {
   friend class ASTStmtReader;
   friend class ASTStmtWriter;
@@ -1150,9 +1156,9 @@ class DeclRefExpr final
   /// The declaration that we are referencing.
   ValueDecl *D;
 
-  /// Provides source/type location info for the declaration name
-  /// embedded in D.
-  DeclarationNameLoc DNLoc;
+  size_t numTrailingObjects(OverloadToken<DeclarationNameLoc>) const {
+    return hasNameLoc();
+  }
 
   size_t numTrailingObjects(OverloadToken<NestedNameSpecifierLoc>) const {
     return hasQualifier();
@@ -1170,6 +1176,10 @@ class DeclRefExpr final
   /// this DRE.
   bool hasFoundDecl() const { return DeclRefExprBits.HasFoundDecl; }
 
+  /// Test whether source/type location info for the declaration name is
+  /// attached to the end of this DRE.
+  bool hasNameLoc() const { return DeclRefExprBits.HasNameLoc; }
+
   DeclRefExpr(const ASTContext &Ctx, NestedNameSpecifierLoc QualifierLoc,
               SourceLocation TemplateKWLoc, ValueDecl *D,
               bool RefersToEnlosingVariableOrCapture,
@@ -1185,10 +1195,11 @@ class DeclRefExpr final
   void computeDependence(const ASTContext &Ctx);
 
 public:
+  /// Construct a reference with no location info for the declaration name
+  /// other than \p L. Use \c Create for the names that need more.
   DeclRefExpr(const ASTContext &Ctx, ValueDecl *D,
               bool RefersToEnclosingVariableOrCapture, QualType T,
               ExprValueKind VK, SourceLocation L,
-              const DeclarationNameLoc &LocInfo = DeclarationNameLoc(),
               NonOdrUseReason NOUR = NOUR_None);
 
   static DeclRefExpr *
@@ -1209,8 +1220,8 @@ public:
          NonOdrUseReason NOUR = NOUR_None);
 
   /// Construct an empty declaration reference expression.
-  static DeclRefExpr *CreateEmpty(const ASTContext &Context, bool HasQualifier,
-                                  bool HasFoundDecl,
+  static DeclRefExpr *CreateEmpty(const ASTContext &Context, bool HasNameLoc,
+                                  bool HasQualifier, bool HasFoundDecl,
                                   bool HasTemplateKWAndArgsInfo,
                                   unsigned NumTemplateArgs);
 
@@ -1219,7 +1230,10 @@ public:
   void setDecl(ValueDecl *NewD) { D = NewD; }
 
   DeclarationNameInfo getNameInfo() const {
-    return DeclarationNameInfo(getDecl()->getDeclName(), getLocation(), DNLoc);
+    return DeclarationNameInfo(getDecl()->getDeclName(), getLocation(),
+                               hasNameLoc()
+                                   ? *getTrailingObjects<DeclarationNameLoc>()
+                                   : DeclarationNameLoc());
   }
 
   SourceLocation getLocation() const { return DeclRefExprBits.Loc; }
@@ -376,6 +376,7 @@ protected:
     unsigned HasQualifier : 1;
     unsigned HasTemplateKWAndArgsInfo : 1;
     unsigned HasFoundDecl : 1;
+    unsigned HasNameLoc : 1;
     unsigned HadMultipleCandidates : 1;
     unsigned RefersToEnclosingVariableOrCapture : 1;
     unsigned NonOdrUseReason : 2;
@@ -1107,6 +1108,10 @@ public:
   static void EnableStatistics();
   static void PrintStats();
 
+  /// The size of a statement of class \p SC, not counting the objects
+  /// allocated past its end.
+  static size_t getNodeSize(StmtClass SC);
+
   /// Dumps the specified AST fragment and all subtrees to
   /// \c llvm::errs().
   void dump() const;
@@ -126,6 +126,15 @@ public:
 
       /// Per bucket timing information.
       llvm::StringMap<llvm::TimeRecord> &Records;
+
+      /// Time each matcher in its own bucket instead of one bucket per
+      /// callback.
+      ///
+      /// The bucket of a matcher is named after the ID of its callback, the
+      /// kind of node it matches and its position among the matchers of that
+      /// callback, as in "<ID>/CallExpr#0". The start and end of translation
+      /// unit callbacks are still timed in the "<ID>" bucket.
+      bool PerMatcher = false;
     };
 
     /// Enables per-check timers.
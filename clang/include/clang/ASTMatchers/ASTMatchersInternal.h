@@ -426,6 +426,12 @@ public:
     return SupportedKind;
   }
 
+  /// Returns the kind of the nodes this matcher can match.
+  ///
+  /// \c matches() always returns false for nodes that are not of this kind or
+  /// of a kind derived from it.
+  ast_type_traits::ASTNodeKind getRestrictKind() const { return RestrictKind; }
+
   /// Returns \c true if the passed \c DynTypedMatcher can be converted
   ///   to a \c Matcher<T>.
   ///
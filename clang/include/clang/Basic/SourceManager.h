@@ -124,15 +124,23 @@ namespace SrcMgr {
 
     /// A bump pointer allocated array of offsets for each source line.
     ///
-    /// This is lazily computed.  This is owned by the SourceManager
+    /// This is lazily computed, a chunk of the buffer at a time, as far as
+    /// line queries need it.  This is owned by the SourceManager
     /// BumpPointerAllocator object.
     unsigned *SourceLineCache = nullptr;
 
-    /// The number of lines in this ContentCache.
+    /// The number of lines in SourceLineCache.
     ///
-    /// This is only valid if SourceLineCache is non-null.
+    /// This is the number of lines in this ContentCache once
+    /// LineTableComplete is set.
     unsigned NumLines = 0;
 
+    /// The number of offsets SourceLineCache has room for.
+    unsigned LineCacheCapacity = 0;
+
+    /// The offset in the buffer up to which lines have been computed.
+    unsigned LineScanOffset = 0;
+
     /// Indicates whether the buffer itself was provided to override
     /// the actual file contents.
     ///
@@ -149,18 +157,22 @@ namespace SrcMgr {
     /// after serialization and deserialization.
     unsigned IsTransient : 1;
 
+    /// True if SourceLineCache covers the whole buffer.
+    unsigned LineTableComplete : 1;
+
     ContentCache(const FileEntry *Ent = nullptr) : ContentCache(Ent, Ent) {}
 
     ContentCache(const FileEntry *Ent, const FileEntry *contentEnt)
       : Buffer(nullptr, false), OrigEntry(Ent), ContentsEntry(contentEnt),
-        BufferOverridden(false), IsSystemFile(false), IsTransient(false) {}
+        BufferOverridden(false), IsSystemFile(false), IsTransient(false),
+        LineTableComplete(false) {}
 
     /// The copy ctor does not allow copies where source object has either
     /// a non-NULL Buffer or SourceLineCache.  Ownership of allocated memory
     /// is not transferred, so this is a logical error.
     ContentCache(const ContentCache &RHS)
       : Buffer(nullptr, false), BufferOverridden(false), IsSystemFile(false),
-        IsTransient(false) {
+        IsTransient(false), LineTableComplete(false) {
       OrigEntry = RHS.OrigEntry;
       ContentsEntry = RHS.ContentsEntry;
 
@@ -175,6 +187,16 @@ namespace SrcMgr {
 
     ~ContentCache();
 
+    /// Discard the line table computed so far, e.g. because the contents of
+    /// the buffer have changed.
+    void invalidateLineTable() {
+      SourceLineCache = nullptr;
+      NumLines = 0;
+      LineCacheCapacity = 0;
+      LineScanOffset = 0;
+      LineTableComplete = false;
+    }
+
     /// Returns the memory buffer for the associated content.
     ///
     /// \param Diag Object through which diagnostics will be emitted if the
@@ -191,6 +191,9 @@ private:
   const T *findDefInDeclContext(const DeclContext *DC,
                                 StringRef LookupName);
   template <typename T>
+  const T *findDefByName(const T *D, const ASTContext &FromCtx,
+                         StringRef LookupName);
+  template <typename T>
   llvm::Expected<const T *> importDefinitionImpl(const T *D, ASTUnit *Unit);
 
   using ImporterMapTy =
@@ -222,11 +225,14 @@ private:
   /// Maintain number of AST loads and check for reaching the load limit.
   class ASTLoadGuard {
   public:
-    ASTLoadGuard(unsigned Limit) : Limit(Limit) {}
+    ASTLoadGuard(unsigned Limit, unsigned MemoryLimitMB)
+        : Limit(Limit), MemoryLimit(size_t(MemoryLimitMB) << 20) {}
 
-    /// Indicates, whether a new load operation is permitted, it is within the
-    /// threshold.
-    operator bool() const { return Count < Limit; }
+    /// Indicates, whether a new load operation is permitted, when the ASTs
+    /// loaded so far take \p LoadedBytes of memory.
+    bool canLoad(size_t LoadedBytes) const {
+      return Count < Limit && (!MemoryLimit || LoadedBytes < MemoryLimit);
+    }
 
     /// Tell that a new AST was loaded successfully.
     void indicateLoadSuccess() { ++Count; }
@@ -236,6 +242,9 @@ private:
     unsigned Count{0u};
     /// The limit (threshold) value for number of loaded ASTs.
     const unsigned Limit;
+    /// The limit for the memory taken by the loaded ASTs, in bytes, or 0 if
+    /// there is none.
+    const size_t MemoryLimit;
   };
 
   /// Storage and load of ASTUnits, cached access, and providing searchability
@@ -276,6 +285,8 @@ private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
                                                 bool DisplayCTUProgress);
+    /// The memory allocated by the ASTContexts of the loaded ASTUnits.
+    size_t getLoadedMemory() const;
 
     template <typename... T> using BaseMapTy = llvm::StringMap<T...>;
     using OwningMapTy = BaseMapTy<std::unique_ptr<clang::ASTUnit>>;
@@ -22,6 +22,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -124,6 +125,10 @@ class Compilation {
   /// Whether to keep temporary files regardless of -save-temps.
   bool ForceKeepTempFiles = false;
 
+  /// Serializes printing commands and reporting their failures when jobs run
+  /// in parallel.
+  mutable std::mutex OutputMutex;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -280,12 +285,24 @@ public:
 
   /// ExecuteJob - Execute a single job.
   ///
+  /// With -parallel-jobs=N, up to N jobs whose inputs are ready run at the
+  /// same time. Otherwise the jobs run one after the other, in order.
+  ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
   /// failing commands and their associated result code.
   void ExecuteJobs(
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
 
+private:
+  /// Execute the jobs on up to \p NumParallelJobs threads, starting each one
+  /// once the jobs that produce its inputs have finished.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands,
+      unsigned NumParallelJobs) const;
+
+public:
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
@@ -165,6 +165,10 @@ public:
   /// The file to log CC_LOG_DIAGNOSTICS output to, if enabled.
   const char *CCLogDiagnosticsFilename;
 
+  /// The socket of the clang -cc1server to run -cc1 jobs on, taken from
+  /// CLANG_CC1_SERVER, or null to run them in processes of their own.
+  const char *CC1ServerSocket;
+
   /// A list of inputs and their types for the given arguments.
   typedef SmallVector<std::pair<types::ID, const llvm::opt::Arg *>, 16>
       InputList;
@@ -0,0 +1,55 @@
+//===- IncludeGuardCache.h - Include guards shared between TUs --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the IncludeGuardCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+#define LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace clang {
+
+/// The controlling macros of the headers seen by several preprocessors,
+/// keyed by the contents of the headers.
+///
+/// Whether a file is wrapped in an include guard only depends on its
+/// contents, so a preprocessor can use the guard found by another one to skip
+/// a header whose guard macro is already defined without lexing it, even the
+/// first time the header is included, and even if it is a copy of the header
+/// at a different path. All the methods are thread-safe.
+class IncludeGuardCache {
+public:
+  /// Returns the controlling macro of a file with contents \p Contents, or an
+  /// empty string if none is known.
+  std::string getControllingMacro(StringRef Contents) const;
+
+  /// Record that \p Macro controls a file with contents \p Contents.
+  void setControllingMacro(StringRef Contents, StringRef Macro);
+
+private:
+  using ContentsKey = std::pair<uint64_t, uint64_t>;
+
+  static ContentsKey getKey(StringRef Contents);
+
+  mutable std::mutex Lock;
+  llvm::DenseMap<ContentsKey, std::string> ControllingMacros;
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
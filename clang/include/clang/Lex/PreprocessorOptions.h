@@ -26,6 +26,8 @@ class MemoryBuffer;
 
 namespace clang {
 
+class IncludeGuardCache;
+
 /// Enumerate the kinds of standard library that
 enum ObjCXXARCStandardLibraryKind {
   ARCXX_nolib,
@@ -169,6 +171,12 @@ public:
   /// build it again.
   std::shared_ptr<FailedModulesSet> FailedModules;
 
+  /// The include guards learned by other preprocessors, if any.
+  ///
+  /// Preprocessors sharing this cache skip headers whose guard macro is
+  /// already defined without lexing them, even on their first inclusion.
+  std::shared_ptr<IncludeGuardCache> IncludeGuards;
+
 public:
   PreprocessorOptions() : PrecompiledPreambleBytes(0, false) {}
 
@@ -55,6 +55,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -7655,6 +7656,15 @@ public:
     SuppressedDiagnosticsMap;
   SuppressedDiagnosticsMap SuppressedDiagnostics;
 
+  /// The substitutions of deduced template arguments into function templates
+  /// that failed, keyed by the template and the arguments, with the
+  /// diagnostic explaining the failure if there was one.
+  ///
+  /// Only used with -fcache-failed-template-deductions, which assumes that
+  /// such a substitution fails at every point of the translation unit.
+  std::map<llvm::FoldingSetNodeID, Optional<PartialDiagnosticAt>>
+      FailedDeductionSubstitutions;
+
   /// A stack object to be created when performing template
   /// instantiation.
   ///
@@ -481,6 +481,14 @@ private:
 
   unsigned TypeExtQualAbbrev = 0;
   unsigned TypeFunctionProtoAbbrev = 0;
+  unsigned TypePointerAbbrev = 0;
+  unsigned TypeLValueReferenceAbbrev = 0;
+  unsigned TypeRValueReferenceAbbrev = 0;
+  unsigned TypeTypedefAbbrev = 0;
+  unsigned TypeRecordAbbrev = 0;
+  unsigned TypeEnumAbbrev = 0;
+  unsigned TypeParenAbbrev = 0;
+  unsigned TypeElaboratedAbbrev = 0;
   void WriteTypeAbbrevs();
   void WriteType(QualType T);
 
@@ -23,6 +23,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
@@ -79,6 +80,10 @@ class ModuleManager {
   llvm::DenseMap<const FileEntry *, std::unique_ptr<llvm::MemoryBuffer>>
       InMemoryBuffers;
 
+  /// Module files that were read from disk by prefetchModuleFiles() and have
+  /// not been loaded yet, indexed by file name.
+  llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> PrefetchedBuffers;
+
   /// The visitation order.
   SmallVector<ModuleFile *, 4> VisitOrder;
 
@@ -191,6 +196,11 @@ public:
   /// Returns the in-memory (virtual file) buffer with the given name
   std::unique_ptr<llvm::MemoryBuffer> lookupBuffer(StringRef Name);
 
+  /// Returns the prefetched buffer for the given module file, if there is one
+  /// and it still has the expected size.
+  std::unique_ptr<llvm::MemoryBuffer> takePrefetchedBuffer(StringRef FileName,
+                                                           off_t Size);
+
   /// Number of modules loaded
   unsigned size() const { return Chain.size(); }
 
@@ -263,6 +273,19 @@ public:
   void addInMemoryBuffer(StringRef FileName,
                          std::unique_ptr<llvm::MemoryBuffer> Buffer);
 
+  /// Read the given module files from disk in parallel, so that adding them
+  /// afterwards doesn't have to wait for each of them in turn.
+  ///
+  /// Files that are already in the module cache are skipped. This does
+  /// nothing unless the file manager uses the real file system, which is the
+  /// only one that's known to be safe to use from several threads.
+  void prefetchModuleFiles(ArrayRef<StringRef> FileNames);
+
+  /// Drop the prefetched buffers of the given module files that were not
+  /// loaded. They must not outlive the import that requested them, since the
+  /// files might be rebuilt afterwards.
+  void dropPrefetchedModuleFiles(ArrayRef<StringRef> FileNames);
+
   /// Set the global module index.
   void setGlobalIndex(GlobalModuleIndex *Index);
 
@@ -16,6 +16,7 @@
 #ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PROGRAMSTATETRAIT_H
 #define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PROGRAMSTATETRAIT_H
 
+#include "llvm/ADT/ImmutableHashMap.h"
 #include "llvm/ADT/ImmutableList.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/ADT/ImmutableSet.h"
@@ -85,6 +86,21 @@ namespace ento {
     REGISTER_TRAIT_WITH_PROGRAMSTATE(Name, \
                                      CLANG_ENTO_PROGRAMSTATE_MAP(Key, Value))
 
+  /// Helper for registering a hash map trait, see CLANG_ENTO_PROGRAMSTATE_MAP.
+  #define CLANG_ENTO_PROGRAMSTATE_HASHMAP(Key, Value) \
+    llvm::ImmutableHashMap<Key, Value>
+
+  /// Declares an immutable map of type \p NameTy like
+  /// REGISTER_MAP_WITH_PROGRAMSTATE, implemented using llvm::ImmutableHashMap.
+  /// This suits maps with many entries that are mostly looked up rather than
+  /// iterated in key order.
+  ///
+  /// The macro should not be used inside namespaces, or for traits that must
+  /// be accessible from more than one translation unit.
+  #define REGISTER_HASHMAP_WITH_PROGRAMSTATE(Name, Key, Value) \
+    REGISTER_TRAIT_WITH_PROGRAMSTATE( \
+        Name, CLANG_ENTO_PROGRAMSTATE_HASHMAP(Key, Value))
+
   /// Declares an immutable map type \p Name and registers the factory
   /// for such maps in the program state, but does not add the map itself
   /// to the program state. Useful for managing lifetime of maps that are used
@@ -189,6 +205,54 @@ namespace ento {
     }
   };
 
+  // Partial-specialization for ImmutableHashMap.
+  template <typename Key, typename Data, typename Info>
+  struct ProgramStatePartialTrait<llvm::ImmutableHashMap<Key, Data, Info>> {
+    using data_type = llvm::ImmutableHashMap<Key, Data, Info>;
+    using context_type = typename data_type::Factory &;
+    using key_type = Key;
+    using value_type = Data;
+    using lookup_type = const value_type *;
+
+    static data_type MakeData(void *const *p) {
+      return p ? data_type((const typename data_type::NodeTy *) *p)
+               : data_type(nullptr);
+    }
+
+    static void *MakeVoidPtr(data_type B) {
+      return const_cast<typename data_type::NodeTy *>(B.getRoot());
+    }
+
+    static lookup_type Lookup(data_type B, key_type K) {
+      return B.lookup(K);
+    }
+
+    static data_type Set(data_type B, key_type K, value_type E,
+                         context_type F) {
+      return F.add(B, K, E);
+    }
+
+    static data_type Remove(data_type B, key_type K, context_type F) {
+      return F.remove(B, K);
+    }
+
+    static bool Contains(data_type B, key_type K) {
+      return B.contains(K);
+    }
+
+    static context_type MakeContext(void *p) {
+      return *((typename data_type::Factory *) p);
+    }
+
+    static void *CreateContext(llvm::BumpPtrAllocator &Alloc) {
+      return new typename data_type::Factory(Alloc);
+    }
+
+    static void DeleteContext(void *Ctx) {
+      delete (typename data_type::Factory *) Ctx;
+    }
+  };
+
   // Partial-specialization for ImmutableSet.
   template <typename Key, typename Info>
   struct ProgramStatePartialTrait<llvm::ImmutableSet<Key, Info>> {
@@ -15,6 +15,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include <atomic>
 #include <mutex>
 
 namespace clang {
@@ -76,6 +77,11 @@ public:
     return MaybeStat->getName();
   }
 
+  /// \returns True if \p Stat, a fresh result of stat'ing this entry's path
+  /// on the underlying file system, describes the same file that the entry
+  /// was created from.
+  bool isUpToDate(const llvm::ErrorOr<llvm::vfs::Status> &Stat) const;
+
   CachedFileSystemEntry(CachedFileSystemEntry &&) = default;
   CachedFileSystemEntry &operator=(CachedFileSystemEntry &&) = default;
 
@@ -89,6 +95,9 @@ private:
   // Note: small size of 1 allows us to store an empty string with an implicit
   // null terminator without any allocations.
   llvm::SmallString<1> Contents;
+  /// The size of the file on disk, which differs from the size in MaybeStat
+  /// when the contents were minimized.
+  uint64_t OriginalSize = 0;
 };
 
 /// This class is a shared cache, that caches the 'stat' and 'open' calls to the
@@ -101,6 +110,9 @@ public:
   struct SharedFileSystemEntry {
     std::mutex ValueLock;
     CachedFileSystemEntry Value;
+    /// The generation of the cache in which the value was last known to match
+    /// the underlying file system.
+    unsigned Generation = 0;
   };
 
   DependencyScanningFilesystemSharedCache();
@@ -111,6 +123,16 @@ public:
   /// thread safe call.
   SharedFileSystemEntry &get(StringRef Key);
 
+  /// Start a new generation of the cache.
+  ///
+  /// Entries cached in an earlier generation are stat'ed again the first time
+  /// they are used in the new one, and recomputed if the file changed on disk.
+  /// This lets a long-lived service keep the cache across builds. Must not be
+  /// called while any worker is scanning.
+  void startNewGeneration() { ++Generation; }
+
+  unsigned getGeneration() const { return Generation; }
+
 private:
   struct CacheShard {
     std::mutex CacheLock;
@@ -118,6 +140,7 @@ private:
   };
   std::unique_ptr<CacheShard[]> CacheShards;
   unsigned NumShards;
+  std::atomic<unsigned> Generation{0};
 };
 
 /// A virtual file system optimized for the dependency discovery.
@@ -134,7 +157,8 @@ public:
   DependencyScanningWorkerFilesystem(
       DependencyScanningFilesystemSharedCache &SharedCache,
       IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
-      : ProxyFileSystem(std::move(FS)), SharedCache(SharedCache) {}
+      : ProxyFileSystem(std::move(FS)), SharedCache(SharedCache),
+        Generation(SharedCache.getGeneration()) {}
 
   llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override;
   llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
@@ -151,14 +175,32 @@ private:
   }
 
   const CachedFileSystemEntry *getCachedEntry(StringRef Filename) {
+    // Entries from an earlier generation of the shared cache might be stale.
+    unsigned SharedGeneration = SharedCache.getGeneration();
+    if (Generation != SharedGeneration) {
+      Cache.clear();
+      Generation = SharedGeneration;
+      return nullptr;
+    }
     auto It = Cache.find(Filename);
     return It == Cache.end() ? nullptr : It->getValue();
   }
 
+  /// Returns the shared cache entry for the given file, which is either
+  /// uninitialized or up to date in the current generation of the cache.
+  ///
+  /// The caller must hold the entry's ValueLock.
+  CachedFileSystemEntry &
+  getValidatedSharedEntry(StringRef Filename,
+                          DependencyScanningFilesystemSharedCache::
+                              SharedFileSystemEntry &SharedCacheEntry);
+
   DependencyScanningFilesystemSharedCache &SharedCache;
   /// The local cache is used by the worker thread to cache file system queries
   /// locally instead of querying the global cache every time.
   llvm::StringMap<const CachedFileSystemEntry *, llvm::BumpPtrAllocator> Cache;
+  /// The generation of the shared cache that the local cache belongs to.
+  unsigned Generation;
 };
 
 } // end namespace dependencies
@@ -9,7 +9,9 @@
 #ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_SERVICE_H
 #define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_SERVICE_H
 
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
+#include <memory>
 
 namespace clang {
 namespace tooling {
@@ -42,10 +44,16 @@ public:
     return SharedCache;
   }
 
+  const std::shared_ptr<IncludeGuardCache> &getIncludeGuards() const {
+    return IncludeGuards;
+  }
+
 private:
   const ScanningMode Mode;
   /// The global file system cache.
   DependencyScanningFilesystemSharedCache SharedCache;
+  /// The include guards found by all the workers.
+  std::shared_ptr<IncludeGuardCache> IncludeGuards;
 };
 
 } // end namespace dependencies
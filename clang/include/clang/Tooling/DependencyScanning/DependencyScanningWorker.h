@@ -14,17 +14,43 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include <string>
 
 namespace clang {
+
+class IncludeGuardCache;
+
 namespace tooling {
 namespace dependencies {
 
 class DependencyScanningService;
 class DependencyScanningWorkerFilesystem;
 
+/// Receives the dependencies of a translation unit from
+/// \c DependencyScanningWorker::computeDependencies.
+class DependencyConsumer {
+public:
+  virtual ~DependencyConsumer() {}
+
+  /// Called for every file the translation unit depends on that isn't part of
+  /// an imported module.
+  virtual void handleFileDependency(StringRef Filename) = 0;
+
+  /// Called for every module the translation unit directly imports.
+  virtual void handleDirectModuleDependency(StringRef ModuleName) = 0;
+
+  /// Called once for every module the translation unit depends on, directly
+  /// or transitively.
+  virtual void handleModuleDependency(ModuleDeps MD) = 0;
+
+  /// Called with the context hash shared by all of the modules that are
+  /// reported for the translation unit.
+  virtual void handleContextHash(std::string Hash) = 0;
+};
+
 /// An individual dependency scanning worker that is able to run on its own
 /// thread.
 ///
@@ -45,7 +71,31 @@ public:
                                                 StringRef WorkingDirectory,
                                                 const CompilationDatabase &CDB);
 
+  /// Compute the file and Clang module dependencies of the given input and
+  /// report them to \p Consumer.
+  ///
+  /// Modules are discovered by building them implicitly, so the input's
+  /// command line has to enable modules for any to be reported.
+  ///
+  /// \returns A \c StringError with the diagnostic output if clang errors
+  /// occurred, success otherwise.
+  llvm::Error computeDependencies(const std::string &Input,
+                                  StringRef WorkingDirectory,
+                                  const CompilationDatabase &CDB,
+                                  DependencyConsumer &Consumer);
+
 private:
+  /// Creates the collector that receives the dependencies of a compiler
+  /// invocation. It takes ownership of the invocation's dependency output
+  /// options, so that the compiler doesn't write any '.d' files itself.
+  using CreateCollectorFn = llvm::function_ref<std::shared_ptr<
+      DependencyCollector>(CompilerInstance &Compiler,
+                           std::unique_ptr<DependencyOutputOptions> Opts)>;
+
+  llvm::Error runScan(const std::string &Input, StringRef WorkingDirectory,
+                      const CompilationDatabase &CDB,
+                      CreateCollectorFn CreateCollector);
+
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
 
@@ -54,6 +104,8 @@ private:
   /// dependencies. This filesystem persists accross multiple compiler
   /// invocations.
   llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS;
+  /// The include guards shared by all the workers of the service.
+  std::shared_ptr<IncludeGuardCache> IncludeGuards;
 };
 
 } // end namespace dependencies
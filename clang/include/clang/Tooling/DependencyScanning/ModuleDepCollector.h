@@ -0,0 +1,115 @@
+//===- ModuleDepCollector.h - Callbacks to collect deps ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
+#define LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Frontend/Utils.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include <set>
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class CompilerInstance;
+class Module;
+
+namespace tooling {
+namespace dependencies {
+
+class DependencyConsumer;
+
+/// The dependencies of a single Clang module, as discovered while scanning a
+/// translation unit that imports it.
+struct ModuleDeps {
+  /// The full name of the module.
+  std::string ModuleName;
+
+  /// The hash of the compiler options that affect the contents of the PCM.
+  ///
+  /// Modules with the same name and context hash are interchangeable, so a
+  /// build system only needs to build each such pair once.
+  std::string ContextHash;
+
+  /// The module map file that defines the module.
+  std::string ClangModuleMapFile;
+
+  /// The PCM that was built implicitly for the module during the scan.
+  std::string ImplicitModulePCMPath;
+
+  /// The language the module map is parsed in, as accepted by -x (without the
+  /// "-module-map" suffix).
+  std::string ModuleMapLanguage;
+
+  /// The files the module was built from, including module maps.
+  std::set<std::string> FileDeps;
+
+  /// The names of the modules this module imports directly. They share this
+  /// module's context hash.
+  std::set<std::string> ClangModuleDeps;
+
+  /// Returns the -cc1 arguments that build this module explicitly.
+  ///
+  /// They are meant to be appended to the -cc1 command line of a translation
+  /// unit that imports the module, after its input, output and implicit module
+  /// options have been removed.
+  ///
+  /// \param OutputPath    The PCM file to write.
+  /// \param LookupPCMPath Returns the PCM file of a module in ClangModuleDeps.
+  std::vector<std::string> getCC1CommandLine(
+      StringRef OutputPath,
+      llvm::function_ref<std::string(StringRef ModuleName)> LookupPCMPath)
+      const;
+};
+
+/// Collects the file and module dependencies of a translation unit and reports
+/// them to a \c DependencyConsumer once the main file has been preprocessed.
+///
+/// Files that are part of an imported module are reported as dependencies of
+/// that module rather than of the translation unit.
+class ModuleDepCollector final : public DependencyCollector {
+public:
+  ModuleDepCollector(CompilerInstance &Instance, DependencyConsumer &Consumer);
+
+  void attachToPreprocessor(Preprocessor &PP) override;
+
+  bool needSystemDependencies() override { return true; }
+
+  bool sawDependency(StringRef Filename, bool FromModule, bool IsSystem,
+                     bool IsModuleFile, bool IsMissing) override;
+
+  void finishedMainFile(DiagnosticsEngine &Diags) override;
+
+  /// Record that the translation unit imports \p M, directly or through an
+  /// include that was translated into an import.
+  void addDirectImport(const Module *M);
+
+private:
+  /// Report the dependencies of the top-level module \p M and, recursively,
+  /// of the modules it imports.
+  void handleTopLevelModule(const Module *M);
+
+  /// Add the modules imported by \p M and its submodules to \p MD.
+  void addModuleImports(const Module *M, ModuleDeps &MD);
+
+  CompilerInstance &Instance;
+  DependencyConsumer &Consumer;
+  std::string ContextHash;
+  llvm::SetVector<const Module *> DirectModules;
+  llvm::DenseSet<const Module *> ReportedModules;
+};
+
+} // end namespace dependencies
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_DEPENDENCY_SCANNING_MODULE_DEP_COLLECTOR_H
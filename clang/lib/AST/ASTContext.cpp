@@ -12,6 +12,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "CXXABI.h"
+#include "ConstexprInterpreter.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/ASTTypeTraits.h"
@@ -91,6 +92,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 using namespace clang;
 
@@ -962,6 +964,75 @@ ASTContext::setExternalSource(IntrusiveRefCntPtr<ExternalASTSource> Source) {
   ExternalSource = std::move(Source);
 }
 
+namespace {
+
+/// Adds up the size of the declarations and statements in the AST by the
+/// file they were written in, so that the headers that take up the most AST
+/// memory stand out.
+class NodeBytesByFile : public RecursiveASTVisitor<NodeBytesByFile> {
+public:
+  struct FileBytes {
+    size_t Bytes = 0;
+    unsigned NumDecls = 0;
+    unsigned NumStmts = 0;
+  };
+
+  explicit NodeBytesByFile(const SourceManager &SM) : SM(SM) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool VisitDecl(Decl *D) {
+    FileBytes &Entry = getEntry(D->getLocation());
+    Entry.Bytes += Decl::getNodeSize(D->getKind());
+    ++Entry.NumDecls;
+    return true;
+  }
+
+  bool VisitStmt(Stmt *S) {
+    FileBytes &Entry = getEntry(S->getBeginLoc());
+    Entry.Bytes += Stmt::getNodeSize(S->getStmtClass());
+    ++Entry.NumStmts;
+    return true;
+  }
+
+  llvm::DenseMap<FileID, FileBytes> Files;
+
+private:
+  const SourceManager &SM;
+
+  FileBytes &getEntry(SourceLocation Loc) {
+    return Files[Loc.isValid() ? SM.getFileID(SM.getExpansionLoc(Loc))
+                               : FileID()];
+  }
+};
+
+} // namespace
+
+/// Print the AST node bytes by file, largest first.
+static void PrintNodeBytesByFile(const ASTContext &Ctx) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  NodeBytesByFile Collector(SM);
+  Collector.TraverseDecl(Ctx.getTranslationUnitDecl());
+
+  using FileEntryBytes = std::pair<FileID, NodeBytesByFile::FileBytes>;
+  std::vector<FileEntryBytes> Files(Collector.Files.begin(),
+                                    Collector.Files.end());
+  llvm::sort(Files, [](const FileEntryBytes &A, const FileEntryBytes &B) {
+    return A.second.Bytes > B.second.Bytes;
+  });
+
+  llvm::errs() << "\n*** AST Node Bytes by File:\n";
+  for (const FileEntryBytes &F : Files) {
+    const FileEntry *FE = F.first.isValid() ? SM.getFileEntryForID(F.first)
+                                            : nullptr;
+    llvm::errs() << "  " << F.second.Bytes << " bytes, "
+                 << F.second.NumDecls << " decls, " << F.second.NumStmts
+                 << " stmts: " << (FE ? FE->getName() : "<built-in>")
+                 << "\n";
+  }
+}
+
 void ASTContext::PrintStats() const {
   llvm::errs() << "\n*** AST Context Stats:\n";
   llvm::errs() << "  " << Types.size() << " types total.\n";
@@ -1020,6 +1091,8 @@ void ASTContext::PrintStats() const {
     ExternalSource->PrintStats();
   }
 
+  PrintNodeBytesByFile(*this);
+
   BumpAlloc.PrintStats();
 }
 
@@ -10136,6 +10209,12 @@ VTableContextBase *ASTContext::getVTableContext() {
   return VTContext.get();
 }
 
+ConstexprInterpreter &ASTContext::getConstexprInterpreter() {
+  if (!ConstexprInterp)
+    ConstexprInterp.reset(new ConstexprInterpreter(*this));
+  return *ConstexprInterp;
+}
+
 MangleContext *ASTContext::createMangleContext(const TargetInfo *T) {
   if (!T)
     T = Target;
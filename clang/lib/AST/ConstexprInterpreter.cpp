@@ -0,0 +1,972 @@
+//===--- ConstexprInterpreter.cpp - Bytecode constexpr evaluation ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the bytecode interpreter for integer constexpr
+// functions. A function is compiled on its first call to instructions for a
+// stack machine whose values are 64-bit integers, each stored sign- or
+// zero-extended from the width of its type.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprInterpreter.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
+#include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+/// The integer type an instruction operates on.
+struct IntType {
+  unsigned Width = 64;
+  bool Signed = true;
+};
+
+enum class Opcode : uint8_t {
+  /// Steps the evaluation, as the tree-walking evaluator does for each
+  /// statement.
+  Step,
+  Const,
+  GetLocal,
+  SetLocal,
+  /// Marks a local as not initialized.
+  KillLocal,
+  Pop,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Rem,
+  Shl,
+  Shr,
+  And,
+  Or,
+  Xor,
+  LT,
+  GT,
+  LE,
+  GE,
+  EQ,
+  NE,
+  Neg,
+  Not,
+  LNot,
+  Inc,
+  Dec,
+  Cast,
+  ToBool,
+  Jmp,
+  JmpIfFalse,
+  JmpIfTrue,
+  Call,
+  Ret,
+  /// Reached when control flows off the end of the function.
+  Fail,
+};
+
+struct Instr {
+  Opcode Op;
+  IntType Ty;
+  /// The constant, local, jump target or callee of the instruction. For
+  /// shifts, whether the shift amount is signed; for increments and
+  /// decrements, whether they can overflow.
+  int64_t Arg;
+};
+} // end anonymous namespace
+
+struct ConstexprInterpreter::Function {
+  unsigned NumParams = 0;
+  unsigned NumLocals = 0;
+  IntType ReturnType;
+  std::vector<Instr> Code;
+  std::vector<const FunctionDecl *> Callees;
+};
+
+struct ConstexprInterpreter::State {
+  unsigned Steps;
+  unsigned MaxDepth;
+};
+
+/// Truncate \p V to the type \p T, and extend it back.
+static int64_t normalize(int64_t V, IntType T) {
+  if (T.Width == 64)
+    return V;
+  if (T.Signed)
+    return llvm::SignExtend64(V, T.Width);
+  return static_cast<uint64_t>(V) & llvm::maskTrailingOnes<uint64_t>(T.Width);
+}
+
+/// Get the type the interpreter uses for values of type \p T.
+static bool getIntType(const ASTContext &Ctx, QualType T, IntType &Ty) {
+  if (!T->isIntegralOrEnumerationType() || T.isVolatileQualified())
+    return false;
+  Ty.Width = Ctx.getIntWidth(T);
+  Ty.Signed = !T->isUnsignedIntegerOrEnumerationType();
+  return Ty.Width <= 64;
+}
+
+namespace {
+/// Compiles the body of a function to bytecode. Any construct it does not
+/// handle makes the whole function unsupported.
+class FunctionCompiler {
+public:
+  FunctionCompiler(const ASTContext &Ctx, ConstexprInterpreter::Function &F)
+      : Ctx(Ctx), F(F) {}
+
+  bool compileFunction(const FunctionDecl *FD, const Stmt *Body);
+
+private:
+  struct LoopLabels {
+    SmallVector<size_t, 4> Breaks;
+    SmallVector<size_t, 4> Continues;
+  };
+
+  size_t emit(Opcode Op, IntType Ty = IntType(), int64_t Arg = 0) {
+    F.Code.push_back({Op, Ty, Arg});
+    return F.Code.size() - 1;
+  }
+  size_t here() const { return F.Code.size(); }
+  void patch(size_t Jump, size_t Target) { F.Code[Jump].Arg = Target; }
+  void patch(ArrayRef<size_t> Jumps, size_t Target) {
+    for (size_t Jump : Jumps)
+      patch(Jump, Target);
+  }
+
+  bool addLocal(const VarDecl *VD, unsigned &Slot);
+  bool compileStmt(const Stmt *S);
+  bool compileLoopBody(const Stmt *Body, LoopLabels &Labels);
+  bool compileInit(const Expr *Init);
+  bool compileExpr(const Expr *E);
+  bool compileLValue(const Expr *E, unsigned &Slot);
+  bool compileDiscarded(const Expr *E);
+  bool compileCast(const CastExpr *E, IntType Ty);
+  bool compileBinOp(const BinaryOperator *E, IntType Ty);
+  bool compileCall(const CallExpr *E);
+  bool emitArith(BinaryOperatorKind Opc, IntType Ty, const Expr *RHS);
+  bool emitConversion(QualType To);
+
+  const ASTContext &Ctx;
+  ConstexprInterpreter::Function &F;
+  llvm::DenseMap<const VarDecl *, unsigned> Locals;
+  SmallVector<LoopLabels *, 4> Loops;
+};
+} // end anonymous namespace
+
+bool FunctionCompiler::compileFunction(const FunctionDecl *FD,
+                                       const Stmt *Body) {
+  if (!FD->isConstexpr() || FD->isInvalidDecl() || FD->isVariadic())
+    return false;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (MD->isInstance())
+      return false;
+  if (!getIntType(Ctx, FD->getReturnType(), F.ReturnType))
+    return false;
+
+  for (const ParmVarDecl *Param : FD->parameters()) {
+    unsigned Slot;
+    if (!addLocal(Param, Slot))
+      return false;
+  }
+  F.NumParams = FD->getNumParams();
+
+  if (!compileStmt(Body))
+    return false;
+  emit(Opcode::Fail);
+  return true;
+}
+
+bool FunctionCompiler::addLocal(const VarDecl *VD, unsigned &Slot) {
+  IntType Ty;
+  if (!VD->hasLocalStorage() || !getIntType(Ctx, VD->getType(), Ty))
+    return false;
+  Slot = F.NumLocals++;
+  Locals[VD] = Slot;
+  return true;
+}
+
+bool FunctionCompiler::compileStmt(const Stmt *S) {
+  emit(Opcode::Step);
+
+  if (const auto *E = dyn_cast<Expr>(S))
+    return compileDiscarded(E);
+
+  switch (S->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::CompoundStmtClass:
+    for (const Stmt *Child : cast<CompoundStmt>(S)->body())
+      if (!compileStmt(Child))
+        return false;
+    return true;
+
+  case Stmt::DeclStmtClass:
+    for (const Decl *D : cast<DeclStmt>(S)->decls()) {
+      // Other declarations do not evaluate anything.
+      const auto *VD = dyn_cast<VarDecl>(D);
+      if (!VD)
+        continue;
+      unsigned Slot;
+      if (!addLocal(VD, Slot))
+        return false;
+      // Each iteration of a loop declares a fresh variable.
+      emit(Opcode::KillLocal, IntType(), Slot);
+      if (const Expr *Init = VD->getInit()) {
+        if (!compileInit(Init))
+          return false;
+        emit(Opcode::SetLocal, IntType(), Slot);
+      }
+    }
+    return true;
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetValue = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetValue || !compileExpr(RetValue))
+      return false;
+    emit(Opcode::Ret);
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const auto *IS = cast<IfStmt>(S);
+    if (IS->getConditionVariable())
+      return false;
+    if (IS->getInit() && !compileStmt(IS->getInit()))
+      return false;
+    if (!compileExpr(IS->getCond()))
+      return false;
+    size_t ToElse = emit(Opcode::JmpIfFalse);
+    if (!compileStmt(IS->getThen()))
+      return false;
+    if (!IS->getElse()) {
+      patch(ToElse, here());
+      return true;
+    }
+    size_t ToEnd = emit(Opcode::Jmp);
+    patch(ToElse, here());
+    if (!compileStmt(IS->getElse()))
+      return false;
+    patch(ToEnd, here());
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const auto *WS = cast<WhileStmt>(S);
+    if (WS->getConditionVariable())
+      return false;
+    size_t Top = here();
+    if (!compileExpr(WS->getCond()))
+      return false;
+    size_t ToEnd = emit(Opcode::JmpIfFalse);
+    LoopLabels Labels;
+    if (!compileLoopBody(WS->getBody(), Labels))
+      return false;
+    emit(Opcode::Jmp, IntType(), Top);
+    patch(ToEnd, here());
+    patch(Labels.Breaks, here());
+    patch(Labels.Continues, Top);
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const auto *DS = cast<DoStmt>(S);
+    size_t Top = here();
+    LoopLabels Labels;
+    if (!compileLoopBody(DS->getBody(), Labels))
+      return false;
+    patch(Labels.Continues, here());
+    if (!compileExpr(DS->getCond()))
+      return false;
+    emit(Opcode::JmpIfTrue, IntType(), Top);
+    patch(Labels.Breaks, here());
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const auto *FS = cast<ForStmt>(S);
+    if (FS->getConditionVariable())
+      return false;
+    if (FS->getInit() && !compileStmt(FS->getInit()))
+      return false;
+    size_t Top = here();
+    Optional<size_t> ToEnd;
+    if (FS->getCond()) {
+      if (!compileExpr(FS->getCond()))
+        return false;
+      ToEnd = emit(Opcode::JmpIfFalse);
+    }
+    LoopLabels Labels;
+    if (!compileLoopBody(FS->getBody(), Labels))
+      return false;
+    patch(Labels.Continues, here());
+    if (FS->getInc() && !compileDiscarded(FS->getInc()))
+      return false;
+    emit(Opcode::Jmp, IntType(), Top);
+    if (ToEnd)
+      patch(*ToEnd, here());
+    patch(Labels.Breaks, here());
+    return true;
+  }
+
+  case Stmt::BreakStmtClass:
+    // Without switch statements, a break always leaves a loop.
+    if (Loops.empty())
+      return false;
+    Loops.back()->Breaks.push_back(emit(Opcode::Jmp));
+    return true;
+
+  case Stmt::ContinueStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back()->Continues.push_back(emit(Opcode::Jmp));
+    return true;
+  }
+}
+
+bool FunctionCompiler::compileLoopBody(const Stmt *Body, LoopLabels &Labels) {
+  Loops.push_back(&Labels);
+  bool Success = compileStmt(Body);
+  Loops.pop_back();
+  return Success;
+}
+
+bool FunctionCompiler::compileInit(const Expr *Init) {
+  if (const auto *ILE = dyn_cast<InitListExpr>(Init)) {
+    if (ILE->getNumInits() > 1)
+      return false;
+    if (ILE->getNumInits() == 1)
+      return compileExpr(ILE->getInit(0));
+    emit(Opcode::Const, IntType(), 0);
+    return true;
+  }
+  if (isa<ImplicitValueInitExpr>(Init)) {
+    emit(Opcode::Const, IntType(), 0);
+    return true;
+  }
+  return compileExpr(Init);
+}
+
+bool FunctionCompiler::compileDiscarded(const Expr *E) {
+  if (E->isGLValue()) {
+    unsigned Slot;
+    return compileLValue(E, Slot);
+  }
+  if (!compileExpr(E))
+    return false;
+  emit(Opcode::Pop);
+  return true;
+}
+
+bool FunctionCompiler::emitConversion(QualType To) {
+  IntType Ty;
+  if (!getIntType(Ctx, To, Ty))
+    return false;
+  // Conversions to bool compare with zero rather than truncate.
+  emit(To->isBooleanType() ? Opcode::ToBool : Opcode::Cast, Ty);
+  return true;
+}
+
+bool FunctionCompiler::compileLValue(const Expr *E, unsigned &Slot) {
+  IntType Ty;
+  if (!getIntType(Ctx, E->getType(), Ty))
+    return false;
+
+  if (const auto *PE = dyn_cast<ParenExpr>(E))
+    return compileLValue(PE->getSubExpr(), Slot);
+
+  if (const auto *DRE = dyn_cast<DeclRefExpr>(E)) {
+    const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+    if (!VD || DRE->refersToEnclosingVariableOrCapture())
+      return false;
+    auto It = Locals.find(VD);
+    if (It == Locals.end())
+      return false;
+    Slot = It->second;
+    return true;
+  }
+
+  if (const auto *ICE = dyn_cast<ImplicitCastExpr>(E)) {
+    if (ICE->getCastKind() != CK_NoOp)
+      return false;
+    return compileLValue(ICE->getSubExpr(), Slot);
+  }
+
+  if (const auto *UO = dyn_cast<UnaryOperator>(E)) {
+    if (!UO->isIncrementDecrementOp() || UO->isPostfix() ||
+        E->getType()->isBooleanType())
+      return false;
+    if (!compileLValue(UO->getSubExpr(), Slot))
+      return false;
+    emit(Opcode::GetLocal, IntType(), Slot);
+    emit(UO->isIncrementOp() ? Opcode::Inc : Opcode::Dec, Ty,
+         UO->canOverflow());
+    emit(Opcode::SetLocal, IntType(), Slot);
+    return true;
+  }
+
+  const auto *BO = dyn_cast<BinaryOperator>(E);
+  if (!BO)
+    return false;
+
+  if (BO->getOpcode() == BO_Comma)
+    return compileDiscarded(BO->getLHS()) && compileLValue(BO->getRHS(), Slot);
+
+  if (BO->getOpcode() == BO_Assign) {
+    if (!compileLValue(BO->getLHS(), Slot) || !compileExpr(BO->getRHS()))
+      return false;
+    emit(Opcode::SetLocal, IntType(), Slot);
+    return true;
+  }
+
+  const auto *CAO = dyn_cast<CompoundAssignOperator>(BO);
+  if (!CAO)
+    return false;
+  // The value of the left-hand side is converted to the computation type,
+  // combined with the right-hand side, and converted back.
+  IntType ComputationTy;
+  if (!compileLValue(CAO->getLHS(), Slot) ||
+      !getIntType(Ctx, CAO->getComputationLHSType(), ComputationTy))
+    return false;
+  emit(Opcode::GetLocal, IntType(), Slot);
+  emit(Opcode::Cast, ComputationTy);
+  if (!compileExpr(CAO->getRHS()) ||
+      !emitArith(BinaryOperator::getOpForCompoundAssignment(CAO->getOpcode()),
+                 ComputationTy, CAO->getRHS()) ||
+      !emitConversion(CAO->getLHS()->getType()))
+    return false;
+  emit(Opcode::SetLocal, IntType(), Slot);
+  return true;
+}
+
+bool FunctionCompiler::compileExpr(const Expr *E) {
+  IntType Ty;
+  if (!E->isRValue() || !getIntType(Ctx, E->getType(), Ty))
+    return false;
+
+  switch (E->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::ParenExprClass:
+    return compileExpr(cast<ParenExpr>(E)->getSubExpr());
+  case Stmt::ConstantExprClass:
+  case Stmt::ExprWithCleanupsClass:
+    return compileExpr(cast<FullExpr>(E)->getSubExpr());
+  case Stmt::CXXDefaultArgExprClass:
+    return compileExpr(cast<CXXDefaultArgExpr>(E)->getExpr());
+  case Stmt::SubstNonTypeTemplateParmExprClass:
+    return compileExpr(cast<SubstNonTypeTemplateParmExpr>(E)->getReplacement());
+
+  case Stmt::IntegerLiteralClass: {
+    const llvm::APInt &Value = cast<IntegerLiteral>(E)->getValue();
+    if (Value.getBitWidth() > 64)
+      return false;
+    emit(Opcode::Const, IntType(), normalize(Value.getZExtValue(), Ty));
+    return true;
+  }
+  case Stmt::CharacterLiteralClass:
+    emit(Opcode::Const, IntType(),
+         normalize(cast<CharacterLiteral>(E)->getValue(), Ty));
+    return true;
+  case Stmt::CXXBoolLiteralExprClass:
+    emit(Opcode::Const, IntType(), cast<CXXBoolLiteralExpr>(E)->getValue());
+    return true;
+
+  case Stmt::DeclRefExprClass: {
+    const auto *ECD =
+        dyn_cast<EnumConstantDecl>(cast<DeclRefExpr>(E)->getDecl());
+    if (!ECD || ECD->getInitVal().getMinSignedBits() > 64)
+      return false;
+    emit(Opcode::Const, IntType(),
+         normalize(ECD->getInitVal().getExtValue(), Ty));
+    return true;
+  }
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::CXXStaticCastExprClass:
+    return compileCast(cast<CastExpr>(E), Ty);
+
+  case Stmt::UnaryOperatorClass: {
+    const auto *UO = cast<UnaryOperator>(E);
+    if (UO->isIncrementDecrementOp()) {
+      // A postfix increment or decrement yields the old value.
+      unsigned Slot;
+      if (!UO->isPostfix() || E->getType()->isBooleanType() ||
+          !compileLValue(UO->getSubExpr(), Slot))
+        return false;
+      emit(Opcode::GetLocal, IntType(), Slot);
+      emit(Opcode::GetLocal, IntType(), Slot);
+      emit(UO->isIncrementOp() ? Opcode::Inc : Opcode::Dec, Ty,
+           UO->canOverflow());
+      emit(Opcode::SetLocal, IntType(), Slot);
+      return true;
+    }
+    switch (UO->getOpcode()) {
+    case UO_Plus:
+      return compileExpr(UO->getSubExpr());
+    case UO_Minus:
+      if (!compileExpr(UO->getSubExpr()))
+        return false;
+      emit(Opcode::Neg, Ty);
+      return true;
+    case UO_Not:
+      if (!compileExpr(UO->getSubExpr()))
+        return false;
+      emit(Opcode::Not, Ty);
+      return true;
+    case UO_LNot:
+      if (!compileExpr(UO->getSubExpr()))
+        return false;
+      emit(Opcode::LNot, Ty);
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  case Stmt::BinaryOperatorClass:
+    return compileBinOp(cast<BinaryOperator>(E), Ty);
+
+  case Stmt::ConditionalOperatorClass: {
+    const auto *CO = cast<ConditionalOperator>(E);
+    if (!compileExpr(CO->getCond()))
+      return false;
+    size_t ToFalse = emit(Opcode::JmpIfFalse);
+    if (!compileExpr(CO->getTrueExpr()))
+      return false;
+    size_t ToEnd = emit(Opcode::Jmp);
+    patch(ToFalse, here());
+    if (!compileExpr(CO->getFalseExpr()))
+      return false;
+    patch(ToEnd, here());
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+    return compileCall(cast<CallExpr>(E));
+  }
+}
+
+bool FunctionCompiler::compileCast(const CastExpr *E, IntType Ty) {
+  const Expr *SubExpr = E->getSubExpr();
+  switch (E->getCastKind()) {
+  default:
+    return false;
+
+  case CK_LValueToRValue: {
+    // Constants declared outside of the function have a known value.
+    if (const auto *DRE = dyn_cast<DeclRefExpr>(SubExpr->IgnoreParens())) {
+      const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+      if (VD && !VD->hasLocalStorage()) {
+        IntType VarTy;
+        if (!VD->isConstexpr() || !getIntType(Ctx, VD->getType(), VarTy))
+          return false;
+        const APValue *Value = VD->evaluateValue();
+        if (!Value || !Value->isInt())
+          return false;
+        const llvm::APSInt &Int = Value->getInt();
+        emit(Opcode::Const, IntType(),
+             Int.isSigned() ? Int.getSExtValue() : Int.getZExtValue());
+        return true;
+      }
+    }
+    unsigned Slot;
+    if (!compileLValue(SubExpr, Slot))
+      return false;
+    emit(Opcode::GetLocal, IntType(), Slot);
+    return true;
+  }
+
+  case CK_NoOp:
+    return SubExpr->isRValue() && compileExpr(SubExpr);
+
+  case CK_IntegralCast:
+    if (!compileExpr(SubExpr))
+      return false;
+    emit(Opcode::Cast, Ty);
+    return true;
+
+  case CK_IntegralToBoolean:
+    if (!compileExpr(SubExpr))
+      return false;
+    emit(Opcode::ToBool, Ty);
+    return true;
+  }
+}
+
+bool FunctionCompiler::compileBinOp(const BinaryOperator *E, IntType Ty) {
+  const Expr *LHS = E->getLHS();
+  const Expr *RHS = E->getRHS();
+  switch (E->getOpcode()) {
+  case BO_Comma:
+    return compileDiscarded(LHS) && compileExpr(RHS);
+
+  case BO_LAnd:
+  case BO_LOr: {
+    // Evaluate the right-hand side only if it decides the result.
+    bool IsAnd = E->getOpcode() == BO_LAnd;
+    if (!compileExpr(LHS))
+      return false;
+    size_t ToShortCircuit =
+        emit(IsAnd ? Opcode::JmpIfFalse : Opcode::JmpIfTrue);
+    if (!compileExpr(RHS))
+      return false;
+    size_t ToEnd = emit(Opcode::Jmp);
+    patch(ToShortCircuit, here());
+    emit(Opcode::Const, IntType(), IsAnd ? 0 : 1);
+    patch(ToEnd, here());
+    return true;
+  }
+
+  case BO_LT:
+  case BO_GT:
+  case BO_LE:
+  case BO_GE:
+  case BO_EQ:
+  case BO_NE: {
+    IntType OperandTy;
+    if (!getIntType(Ctx, LHS->getType(), OperandTy) || !compileExpr(LHS) ||
+        !compileExpr(RHS))
+      return false;
+    Opcode Op;
+    switch (E->getOpcode()) {
+    case BO_LT: Op = Opcode::LT; break;
+    case BO_GT: Op = Opcode::GT; break;
+    case BO_LE: Op = Opcode::LE; break;
+    case BO_GE: Op = Opcode::GE; break;
+    case BO_EQ: Op = Opcode::EQ; break;
+    default:    Op = Opcode::NE; break;
+    }
+    emit(Op, OperandTy);
+    return true;
+  }
+
+  default:
+    // The operands of the arithmetic operators have already been converted
+    // to the type of the result, except for the right-hand side of shifts.
+    return compileExpr(LHS) && compileExpr(RHS) &&
+           emitArith(E->getOpcode(), Ty, RHS);
+  }
+}
+
+bool FunctionCompiler::emitArith(BinaryOperatorKind Opc, IntType Ty,
+                                 const Expr *RHS) {
+  Opcode Op;
+  switch (Opc) {
+  case BO_Mul: Op = Opcode::Mul; break;
+  case BO_Div: Op = Opcode::Div; break;
+  case BO_Rem: Op = Opcode::Rem; break;
+  case BO_Add: Op = Opcode::Add; break;
+  case BO_Sub: Op = Opcode::Sub; break;
+  case BO_And: Op = Opcode::And; break;
+  case BO_Xor: Op = Opcode::Xor; break;
+  case BO_Or:  Op = Opcode::Or; break;
+  case BO_Shl:
+  case BO_Shr: {
+    IntType RHSTy;
+    if (!getIntType(Ctx, RHS->getType(), RHSTy))
+      return false;
+    emit(Opc == BO_Shl ? Opcode::Shl : Opcode::Shr, Ty, RHSTy.Signed);
+    return true;
+  }
+  default:
+    return false;
+  }
+  emit(Op, Ty);
+  return true;
+}
+
+bool FunctionCompiler::compileCall(const CallExpr *E) {
+  const FunctionDecl *Callee = E->getDirectCallee();
+  if (!Callee || Callee->getBuiltinID() ||
+      E->getNumArgs() != Callee->getNumParams())
+    return false;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(Callee))
+    if (MD->isInstance())
+      return false;
+
+  for (const Expr *Arg : E->arguments())
+    if (!compileExpr(Arg))
+      return false;
+  F.Callees.push_back(Callee);
+  emit(Opcode::Call, IntType(), F.Callees.size() - 1);
+  return true;
+}
+
+ConstexprInterpreter::ConstexprInterpreter(ASTContext &Ctx) : Ctx(Ctx) {}
+
+ConstexprInterpreter::~ConstexprInterpreter() = default;
+
+const ConstexprInterpreter::Function *
+ConstexprInterpreter::getFunction(const FunctionDecl *Callee) {
+  const FunctionDecl *Definition = nullptr;
+  const Stmt *Body = Callee->getBody(Definition);
+  // The definition may still come later in the translation unit.
+  if (!Body)
+    return nullptr;
+
+  auto It = Functions.find(Definition);
+  if (It != Functions.end())
+    return It->second.get();
+
+  auto F = std::make_unique<Function>();
+  if (!FunctionCompiler(Ctx, *F).compileFunction(Definition, Body))
+    F.reset();
+  // Compiling may have evaluated constants that called the same function.
+  return Functions.try_emplace(Definition, std::move(F))
+      .first->second.get();
+}
+
+bool ConstexprInterpreter::call(const FunctionDecl *FD,
+                                ArrayRef<APValue> Args, unsigned &Steps,
+                                unsigned MaxDepth, APValue &Result) {
+  const Function *F = getFunction(FD);
+  if (!F || Args.size() != F->NumParams)
+    return false;
+
+  SmallVector<int64_t, 8> ArgValues;
+  for (const APValue &Arg : Args) {
+    if (!Arg.isInt() || Arg.getInt().getBitWidth() > 64)
+      return false;
+    const llvm::APSInt &Int = Arg.getInt();
+    ArgValues.push_back(Int.isSigned() ? Int.getSExtValue()
+                                       : Int.getZExtValue());
+  }
+
+  State S = {Steps, MaxDepth};
+  int64_t Value;
+  if (!execute(*F, ArgValues, 0, S, Value))
+    return false;
+
+  Steps = S.Steps;
+  IntType Ty = F->ReturnType;
+  Result = APValue(llvm::APSInt(
+      llvm::APInt(Ty.Width, static_cast<uint64_t>(Value), Ty.Signed),
+      !Ty.Signed));
+  return true;
+}
+
+/// The smallest value of the signed type \p T.
+static int64_t getMinSigned(IntType T) {
+  return std::numeric_limits<int64_t>::min() >> (64 - T.Width);
+}
+
+/// Perform the arithmetic instruction \p Op. Fails on overflow and on the
+/// other operations that have no defined result.
+static bool evaluateArith(Opcode Op, IntType Ty, int64_t Aux, int64_t LHS,
+                          int64_t RHS, int64_t &Result) {
+  uint64_t ULHS = LHS, URHS = RHS;
+  switch (Op) {
+  case Opcode::Add:
+  case Opcode::Sub:
+  case Opcode::Mul:
+    if (!Ty.Signed) {
+      Result = normalize(Op == Opcode::Add   ? ULHS + URHS
+                         : Op == Opcode::Sub ? ULHS - URHS
+                                             : ULHS * URHS,
+                         Ty);
+      return true;
+    }
+    if (Op == Opcode::Add ? llvm::AddOverflow(LHS, RHS, Result)
+        : Op == Opcode::Sub ? llvm::SubOverflow(LHS, RHS, Result)
+                            : llvm::MulOverflow(LHS, RHS, Result))
+      return false;
+    return normalize(Result, Ty) == Result;
+
+  case Opcode::Div:
+  case Opcode::Rem:
+    if (RHS == 0 || (Ty.Signed && LHS == getMinSigned(Ty) && RHS == -1))
+      return false;
+    if (Ty.Signed)
+      Result = Op == Opcode::Div ? LHS / RHS : LHS % RHS;
+    else
+      Result = Op == Opcode::Div ? ULHS / URHS : ULHS % URHS;
+    return true;
+
+  case Opcode::Shl:
+  case Opcode::Shr: {
+    // The shift amount must be non-negative and less than the width, and a
+    // signed left shift must not shift out set bits.
+    bool SignedAmount = Aux;
+    if ((SignedAmount && RHS < 0) || URHS >= Ty.Width)
+      return false;
+    if (Op == Opcode::Shr) {
+      Result = Ty.Signed ? LHS >> URHS : static_cast<int64_t>(ULHS >> URHS);
+      return true;
+    }
+    if (Ty.Signed &&
+        (LHS < 0 ||
+         llvm::countLeadingZeros(ULHS) - (64 - Ty.Width) < URHS))
+      return false;
+    Result = normalize(ULHS << URHS, Ty);
+    return true;
+  }
+
+  case Opcode::And: Result = LHS & RHS; return true;
+  case Opcode::Or:  Result = LHS | RHS; return true;
+  case Opcode::Xor: Result = LHS ^ RHS; return true;
+
+  case Opcode::LT: Result = Ty.Signed ? LHS < RHS : ULHS < URHS; return true;
+  case Opcode::GT: Result = Ty.Signed ? LHS > RHS : ULHS > URHS; return true;
+  case Opcode::LE: Result = Ty.Signed ? LHS <= RHS : ULHS <= URHS; return true;
+  case Opcode::GE: Result = Ty.Signed ? LHS >= RHS : ULHS >= URHS; return true;
+  case Opcode::EQ: Result = LHS == RHS; return true;
+  case Opcode::NE: Result = LHS != RHS; return true;
+
+  default:
+    llvm_unreachable("not an arithmetic instruction");
+  }
+}
+
+bool ConstexprInterpreter::execute(const Function &F, ArrayRef<int64_t> Args,
+                                   unsigned Depth, State &S,
+                                   int64_t &Result) {
+  SmallVector<int64_t, 16> Locals(F.NumLocals);
+  SmallVector<bool, 16> Initialized(F.NumLocals);
+  std::copy(Args.begin(), Args.end(), Locals.begin());
+  std::fill_n(Initialized.begin(), Args.size(), true);
+  SmallVector<int64_t, 16> Stack;
+
+  auto Pop = [&Stack] { return Stack.pop_back_val(); };
+
+  for (size_t PC = 0;;) {
+    const Instr &I = F.Code[PC++];
+    switch (I.Op) {
+    case Opcode::Step:
+      if (!S.Steps)
+        return false;
+      --S.Steps;
+      break;
+    case Opcode::Const:
+      Stack.push_back(I.Arg);
+      break;
+    case Opcode::GetLocal:
+      // Reading an uninitialized variable is not a constant expression.
+      if (!Initialized[I.Arg])
+        return false;
+      Stack.push_back(Locals[I.Arg]);
+      break;
+    case Opcode::SetLocal:
+      Locals[I.Arg] = Pop();
+      Initialized[I.Arg] = true;
+      break;
+    case Opcode::KillLocal:
+      Initialized[I.Arg] = false;
+      break;
+    case Opcode::Pop:
+      Stack.pop_back();
+      break;
+
+    case Opcode::Add:
+    case Opcode::Sub:
+    case Opcode::Mul:
+    case Opcode::Div:
+    case Opcode::Rem:
+    case Opcode::Shl:
+    case Opcode::Shr:
+    case Opcode::And:
+    case Opcode::Or:
+    case Opcode::Xor:
+    case Opcode::LT:
+    case Opcode::GT:
+    case Opcode::LE:
+    case Opcode::GE:
+    case Opcode::EQ:
+    case Opcode::NE: {
+      int64_t RHS = Pop();
+      int64_t LHS = Pop();
+      int64_t Value;
+      if (!evaluateArith(I.Op, I.Ty, I.Arg, LHS, RHS, Value))
+        return false;
+      Stack.push_back(Value);
+      break;
+    }
+
+    case Opcode::Neg: {
+      int64_t Value = Pop();
+      if (I.Ty.Signed && Value == getMinSigned(I.Ty))
+        return false;
+      Stack.push_back(normalize(0 - static_cast<uint64_t>(Value), I.Ty));
+      break;
+    }
+    case Opcode::Not:
+      Stack.push_back(normalize(~Pop(), I.Ty));
+      break;
+    case Opcode::LNot:
+      Stack.push_back(Pop() == 0);
+      break;
+    case Opcode::Inc:
+    case Opcode::Dec: {
+      // Wrapping is only an overflow for types that are not promoted first.
+      int64_t Old = Pop();
+      bool IsInc = I.Op == Opcode::Inc;
+      int64_t New = normalize(static_cast<uint64_t>(Old) + (IsInc ? 1 : -1),
+                              I.Ty);
+      if (I.Ty.Signed && I.Arg && (IsInc ? New < Old : New > Old))
+        return false;
+      Stack.push_back(New);
+      break;
+    }
+    case Opcode::Cast:
+      Stack.push_back(normalize(Pop(), I.Ty));
+      break;
+    case Opcode::ToBool:
+      Stack.push_back(Pop() != 0);
+      break;
+
+    case Opcode::Jmp:
+      PC = I.Arg;
+      break;
+    case Opcode::JmpIfFalse:
+      if (!Pop())
+        PC = I.Arg;
+      break;
+    case Opcode::JmpIfTrue:
+      if (Pop())
+        PC = I.Arg;
+      break;
+
+    case Opcode::Call: {
+      if (Depth >= S.MaxDepth)
+        return false;
+      const Function *Callee = getFunction(F.Callees[I.Arg]);
+      if (!Callee)
+        return false;
+      ArrayRef<int64_t> CallArgs =
+          makeArrayRef(Stack).take_back(Callee->NumParams);
+      int64_t Value;
+      if (!execute(*Callee, CallArgs, Depth + 1, S, Value))
+        return false;
+      Stack.resize(Stack.size() - Callee->NumParams);
+      Stack.push_back(Value);
+      break;
+    }
+    case Opcode::Ret:
+      Result = Pop();
+      return true;
+    case Opcode::Fail:
+      return false;
+    }
+  }
+}
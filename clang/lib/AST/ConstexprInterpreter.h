@@ -0,0 +1,76 @@
+//===--- ConstexprInterpreter.h - Bytecode constexpr evaluation -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This provides a bytecode interpreter for calls to constexpr functions that
+// only compute on integers, used by the constant evaluator under
+// -fexperimental-new-constant-interpreter.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
+#define LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include <cstdint>
+#include <memory>
+
+namespace clang {
+
+class APValue;
+class ASTContext;
+class FunctionDecl;
+
+/// Evaluates calls to constexpr functions whose parameters, locals and
+/// return value are all integers, by compiling each function once to
+/// bytecode for a small stack machine.
+///
+/// Walking the AST again on every call makes loops and deep recursion in
+/// such functions expensive. The interpreter only ever produces the value
+/// that the tree-walking evaluator would: as soon as it meets a construct it
+/// does not support, or an evaluation that is not a constant expression, it
+/// gives up, and the tree-walking evaluator redoes the call and diagnoses the
+/// problem as usual.
+class ConstexprInterpreter {
+public:
+  explicit ConstexprInterpreter(ASTContext &Ctx);
+  ~ConstexprInterpreter();
+
+  /// Evaluate a call to the definition \p FD with the arguments \p Args.
+  ///
+  /// \param Steps The number of evaluation steps left, counted as the
+  /// tree-walking evaluator does, and reduced by the steps the call takes.
+  /// \param MaxDepth The number of nested calls the call may make.
+  ///
+  /// \returns true and sets \p Result if the call was evaluated. Otherwise
+  /// \p Steps is left as it was.
+  bool call(const FunctionDecl *FD, ArrayRef<APValue> Args, unsigned &Steps,
+            unsigned MaxDepth, APValue &Result);
+
+  struct Function;
+
+private:
+  struct State;
+
+  /// Get the bytecode of \p Callee, compiling it on first use. Returns null
+  /// if the function cannot run on the interpreter.
+  const Function *getFunction(const FunctionDecl *Callee);
+
+  bool execute(const Function &F, ArrayRef<int64_t> Args, unsigned Depth,
+               State &S, int64_t &Result);
+
+  ASTContext &Ctx;
+
+  /// The compiled definitions, or null for those that are not supported.
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<Function>> Functions;
+};
+
+} // end namespace clang
+
+#endif
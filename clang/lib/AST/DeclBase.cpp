@@ -189,6 +189,15 @@ void Decl::PrintStats() {
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
 }
 
+size_t Decl::getNodeSize(Kind K) {
+  switch (K) {
+#define DECL(DERIVED, BASE) case DERIVED: return sizeof(DERIVED##Decl);
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  }
+  llvm_unreachable("Declaration not in DeclNodes.inc!");
+}
+
 void Decl::add(Kind k) {
   switch (k) {
 #define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
@@ -468,16 +468,30 @@ void DeclRefExpr::computeDependence(const ASTContext &Ctx) {
     ExprBits.ContainsUnexpandedParameterPack = true;
 }
 
+/// Whether the DeclarationNameLoc of \p Name holds any information.
+static bool needsNameLoc(DeclarationName Name) {
+  switch (Name.getNameKind()) {
+  case DeclarationName::CXXConstructorName:
+  case DeclarationName::CXXDestructorName:
+  case DeclarationName::CXXConversionFunctionName:
+  case DeclarationName::CXXOperatorName:
+  case DeclarationName::CXXLiteralOperatorName:
+    return true;
+  default:
+    return false;
+  }
+}
+
 DeclRefExpr::DeclRefExpr(const ASTContext &Ctx, ValueDecl *D,
                          bool RefersToEnclosingVariableOrCapture, QualType T,
                          ExprValueKind VK, SourceLocation L,
-                         const DeclarationNameLoc &LocInfo,
                          NonOdrUseReason NOUR)
     : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-      D(D), DNLoc(LocInfo) {
+      D(D) {
   DeclRefExprBits.HasQualifier = false;
   DeclRefExprBits.HasTemplateKWAndArgsInfo = false;
   DeclRefExprBits.HasFoundDecl = false;
+  DeclRefExprBits.HasNameLoc = false;
   DeclRefExprBits.HadMultipleCandidates = false;
   DeclRefExprBits.RefersToEnclosingVariableOrCapture =
       RefersToEnclosingVariableOrCapture;
@@ -494,8 +508,12 @@ DeclRefExpr::DeclRefExpr(const ASTContext &Ctx,
                          const TemplateArgumentListInfo *TemplateArgs,
                          QualType T, ExprValueKind VK, NonOdrUseReason NOUR)
     : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-      D(D), DNLoc(NameInfo.getInfo()) {
+      D(D) {
   DeclRefExprBits.Loc = NameInfo.getLoc();
+  DeclRefExprBits.HasNameLoc = needsNameLoc(NameInfo.getName());
+  if (hasNameLoc())
+    new (getTrailingObjects<DeclarationNameLoc>())
+        DeclarationNameLoc(NameInfo.getInfo());
   DeclRefExprBits.HasQualifier = QualifierLoc ? 1 : 0;
   if (QualifierLoc) {
     new (getTrailingObjects<NestedNameSpecifierLoc>())
@@ -562,9 +580,10 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
 
   bool HasTemplateKWAndArgsInfo = TemplateArgs || TemplateKWLoc.isValid();
   std::size_t Size =
-      totalSizeToAlloc<NestedNameSpecifierLoc, NamedDecl *,
+      totalSizeToAlloc<DeclarationNameLoc, NestedNameSpecifierLoc, NamedDecl *,
                        ASTTemplateKWAndArgsInfo, TemplateArgumentLoc>(
-          QualifierLoc ? 1 : 0, FoundD ? 1 : 0,
+          needsNameLoc(NameInfo.getName()), QualifierLoc ? 1 : 0,
+          FoundD ? 1 : 0,
           HasTemplateKWAndArgsInfo ? 1 : 0,
           TemplateArgs ? TemplateArgs->size() : 0);
 
@@ -575,16 +594,17 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
 }
 
 DeclRefExpr *DeclRefExpr::CreateEmpty(const ASTContext &Context,
+                                      bool HasNameLoc,
                                       bool HasQualifier,
                                       bool HasFoundDecl,
                                       bool HasTemplateKWAndArgsInfo,
                                       unsigned NumTemplateArgs) {
   assert(NumTemplateArgs == 0 || HasTemplateKWAndArgsInfo);
   std::size_t Size =
-      totalSizeToAlloc<NestedNameSpecifierLoc, NamedDecl *,
+      totalSizeToAlloc<DeclarationNameLoc, NestedNameSpecifierLoc, NamedDecl *,
                        ASTTemplateKWAndArgsInfo, TemplateArgumentLoc>(
-          HasQualifier ? 1 : 0, HasFoundDecl ? 1 : 0, HasTemplateKWAndArgsInfo,
-          NumTemplateArgs);
+          HasNameLoc, HasQualifier ? 1 : 0, HasFoundDecl ? 1 : 0,
+          HasTemplateKWAndArgsInfo, NumTemplateArgs);
   void *Mem = Context.Allocate(Size, alignof(DeclRefExpr));
   return new (Mem) DeclRefExpr(EmptyShell());
 }
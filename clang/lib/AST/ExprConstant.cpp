@@ -32,6 +32,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ConstexprInterpreter.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -5149,6 +5150,17 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
+  // Calls that only compute on integers can run on the bytecode interpreter,
+  // which leaves any call it cannot finish to the evaluation below, so that
+  // the call is diagnosed as usual.
+  if (!This && Info.getLangOpts().EnableNewConstInterp &&
+      !Info.checkingPotentialConstantExpression() &&
+      Info.Ctx.getConstexprInterpreter().call(
+          Callee, ArgValues, Info.StepsLeft,
+          Info.getLangOpts().ConstexprCallDepth - Info.CallStackDepth,
+          Result))
+    return true;
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -108,6 +108,10 @@ void Stmt::PrintStats() {
   llvm::errs() << "Total bytes = " << sum << "\n";
 }
 
+size_t Stmt::getNodeSize(StmtClass SC) {
+  return getStmtInfoTableEntry(SC).Size;
+}
+
 void Stmt::addStmtClass(StmtClass s) {
   ++getStmtInfoTableEntry(s).Counter;
 }
@@ -304,7 +304,17 @@ class MatchASTVisitor : public RecursiveASTVisitor<MatchASTVisitor>,
 public:
   MatchASTVisitor(const MatchFinder::MatchersByType *Matchers,
                   const MatchFinder::MatchFinderOptions &Options)
-      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr) {}
+      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr) {
+    if (Options.CheckProfiling) {
+      llvm::DenseMap<MatchCallback *, unsigned> MatcherCounts;
+      addBuckets(Matchers->DeclOrStmt, MatcherCounts);
+      addBuckets(Matchers->Type, MatcherCounts);
+      addBuckets(Matchers->NestedNameSpecifier, MatcherCounts);
+      addBuckets(Matchers->NestedNameSpecifierLoc, MatcherCounts);
+      addBuckets(Matchers->TypeLoc, MatcherCounts);
+      addBuckets(Matchers->CtorInit, MatcherCounts);
+    }
+  }
 
   ~MatchASTVisitor() override {
     if (Options.CheckProfiling) {
@@ -541,6 +551,31 @@ private:
     llvm::TimeRecord *Bucket;
   };
 
+  /// Creates the profiling buckets of the matchers in \p Matchers, counting
+  /// the matchers of each callback in \p MatcherCounts.
+  template <typename MC>
+  void addBuckets(const MC &Matchers,
+                  llvm::DenseMap<MatchCallback *, unsigned> &MatcherCounts) {
+    for (const auto &MP : Matchers) {
+      StringRef ID = MP.second->getID();
+      unsigned Index = MatcherCounts[MP.second]++;
+      llvm::TimeRecord *Bucket;
+      if (Options.CheckProfiling->PerMatcher) {
+        StringRef Kind = MP.first.getID().first.asStringRef();
+        Bucket = &TimeByBucket[(ID + "/" + Kind + "#" + Twine(Index)).str()];
+      } else {
+        Bucket = &TimeByBucket[ID];
+      }
+      BucketByMatcher[&MP] = Bucket;
+    }
+  }
+
+  /// Returns the profiling bucket of the entry \p MP of a \c Matchers list.
+  template <typename T> llvm::TimeRecord *getBucket(const T &MP) {
+    assert(BucketByMatcher.count(&MP) && "Matcher without a bucket.");
+    return BucketByMatcher.lookup(&MP);
+  }
+
   /// Runs all the \p Matchers on \p Node.
   ///
   /// Used by \c matchDispatch() below.
@@ -550,7 +585,7 @@ private:
     TimeBucketRegion Timer;
     for (const auto &MP : Matchers) {
       if (EnableCheckProfiling)
-        Timer.setBucket(&TimeByBucket[MP.second->getID()]);
+        Timer.setBucket(getBucket(MP));
       BoundNodesTreeBuilder Builder;
       if (MP.first.matches(Node, this, &Builder)) {
         MatchVisitor Visitor(ActiveASTContext, MP.second);
@@ -574,7 +609,7 @@ private:
     for (unsigned short I : Filter) {
       auto &MP = Matchers[I];
       if (EnableCheckProfiling)
-        Timer.setBucket(&TimeByBucket[MP.second->getID()]);
+        Timer.setBucket(getBucket(MP));
       BoundNodesTreeBuilder Builder;
       if (MP.first.matchesNoKindCheck(DynNode, this, &Builder)) {
         MatchVisitor Visitor(ActiveASTContext, MP.second);
@@ -796,6 +831,12 @@ private:
   /// Used to get the appropriate bucket for each matcher.
   llvm::StringMap<llvm::TimeRecord> TimeByBucket;
 
+  /// The bucket in \c TimeByBucket of each entry of the \c Matchers lists.
+  ///
+  /// Looked up by the address of the entry, so that timing a matcher does not
+  /// need to hash the ID of its callback on every node.
+  llvm::DenseMap<const void *, llvm::TimeRecord *> BucketByMatcher;
+
   const MatchFinder::MatchersByType *Matchers;
 
   /// Filtered list of matcher indices for each matcher kind.
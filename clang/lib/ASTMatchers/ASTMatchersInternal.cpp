@@ -138,6 +138,22 @@ public:
 
 static llvm::ManagedStatic<TrueMatcherImpl> TrueMatcherInstance;
 
+/// Returns the narrowest kind that covers the restrict kinds of all of
+/// \p InnerMatchers, or \p SupportedKind if that is not derived from it.
+///
+/// anyOf() and eachOf() only match a node if one of their inner matchers does,
+/// so they can never match a node outside of this kind. Restricting them to it
+/// lets \c MatchFinder skip them on nodes none of the alternatives can match.
+static ast_type_traits::ASTNodeKind
+getCommonRestrictKind(ast_type_traits::ASTNodeKind SupportedKind,
+                      ArrayRef<DynTypedMatcher> InnerMatchers) {
+  auto Common = InnerMatchers.front().getRestrictKind();
+  for (const auto &IM : InnerMatchers.drop_front())
+    Common = ast_type_traits::ASTNodeKind::getMostDerivedCommonAncestor(
+        Common, IM.getRestrictKind());
+  return SupportedKind.isBaseOf(Common) ? Common : SupportedKind;
+}
+
 DynTypedMatcher DynTypedMatcher::constructVariadic(
     DynTypedMatcher::VariadicOperator Op,
     ast_type_traits::ASTNodeKind SupportedKind,
@@ -170,11 +186,13 @@ DynTypedMatcher DynTypedMatcher::constructVariadic(
         new VariadicMatcher<AllOfVariadicOperator>(std::move(InnerMatchers)));
 
   case VO_AnyOf:
+    RestrictKind = getCommonRestrictKind(SupportedKind, InnerMatchers);
     return DynTypedMatcher(
         SupportedKind, RestrictKind,
         new VariadicMatcher<AnyOfVariadicOperator>(std::move(InnerMatchers)));
 
   case VO_EachOf:
+    RestrictKind = getCommonRestrictKind(SupportedKind, InnerMatchers);
     return DynTypedMatcher(
         SupportedKind, RestrictKind,
         new VariadicMatcher<EachOfVariadicOperator>(std::move(InnerMatchers)));
@@ -1219,13 +1219,60 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
 #include <emmintrin.h>
 #endif
 
-static LLVM_ATTRIBUTE_NOINLINE void
-ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
-                   llvm::BumpPtrAllocator &Alloc,
-                   const SourceManager &SM, bool &Invalid);
+/// Line tables are computed this many bytes of the buffer at a time.
+static const unsigned LineTableChunkSize = 64 * 1024;
+
+/// Append the offset of each line that starts after a newline in
+/// [Buf+I, Buf+End) to LineOffsets.  Returns the offset at which scanning
+/// stopped, which is End unless a "\r\n" straddles it.
+static unsigned findLineStarts(const unsigned char *Buf, unsigned I,
+                               unsigned End,
+                               SmallVectorImpl<unsigned> &LineOffsets) {
+  while (I < End) {
+#ifdef __SSE2__
+    // Skip over the contents of the line 16 characters at a time.
+    const __m128i LFs = _mm_set1_epi8('\n');
+    const __m128i CRs = _mm_set1_epi8('\r');
+    while (I + 16 <= End) {
+      __m128i Chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(Buf + I));
+      unsigned Mask = _mm_movemask_epi8(_mm_or_si128(
+          _mm_cmpeq_epi8(Chunk, LFs), _mm_cmpeq_epi8(Chunk, CRs)));
+      if (Mask) {
+        I += llvm::countTrailingZeros(Mask);
+        break;
+      }
+      I += 16;
+    }
+    if (I == End)
+      break;
+#endif
+
+    unsigned char C = Buf[I++];
+    if (C == '\n' || C == '\r') {
+      // If this is \r\n, skip both characters.  Buffers are NUL terminated,
+      // so this may look one past End.
+      if (C == '\r' && Buf[I] == '\n')
+        ++I;
+      LineOffsets.push_back(I);
+    }
+  }
+  return I;
+}
+
+/// Extend the line table of FI, a chunk of the buffer at a time, until
+/// IsCovered returns true or the whole buffer has been scanned.  IsCovered is
+/// given the number of lines found so far and the offset of the last one.
+template <typename CoveredFn>
 static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                                llvm::BumpPtrAllocator &Alloc,
-                               const SourceManager &SM, bool &Invalid) {
+                               const SourceManager &SM, bool &Invalid,
+                               CoveredFn IsCovered) {
+  if (FI->LineTableComplete ||
+      (FI->NumLines &&
+       IsCovered(FI->NumLines, FI->SourceLineCache[FI->NumLines - 1])))
+    return;
+
   // Note that calling 'getBuffer()' may lazily page in the file.
   const MemoryBuffer *Buffer =
       FI->getBuffer(Diag, SM, SourceLocation(), &Invalid);
@@ -1237,33 +1284,43 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   SmallVector<unsigned, 256> LineOffsets;
 
   // Line #1 starts at char 0.
-  LineOffsets.push_back(0);
+  if (!FI->NumLines)
+    LineOffsets.push_back(0);
 
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned I = 0;
+  unsigned Size = Buffer->getBufferSize();
+  unsigned I = FI->LineScanOffset;
   while (true) {
-    // Skip over the contents of the line.
-    while (Buf[I] != '\n' && Buf[I] != '\r' && Buf[I] != '\0')
-      ++I;
-
-    if (Buf[I] == '\n' || Buf[I] == '\r') {
-      // If this is \r\n, skip both characters.
-      if (Buf[I] == '\r' && Buf[I+1] == '\n')
-        ++I;
-      ++I;
-      LineOffsets.push_back(I);
-    } else {
-      // Otherwise, this is a NUL. If end of file, exit.
-      if (Buf+I == End) break;
-      ++I;
-    }
+    I = findLineStarts(Buf, I, std::min(Size, I + LineTableChunkSize),
+                       LineOffsets);
+    if (I >= Size)
+      break;
+    unsigned NumLines = FI->NumLines + LineOffsets.size();
+    unsigned LastLineStart = LineOffsets.empty()
+                                 ? FI->SourceLineCache[FI->NumLines - 1]
+                                 : LineOffsets.back();
+    if (IsCovered(NumLines, LastLineStart))
+      break;
   }
-
-  // Copy the offsets into the FileInfo structure.
-  FI->NumLines = LineOffsets.size();
-  FI->SourceLineCache = Alloc.Allocate<unsigned>(LineOffsets.size());
-  std::copy(LineOffsets.begin(), LineOffsets.end(), FI->SourceLineCache);
+  FI->LineScanOffset = I;
+  FI->LineTableComplete = I >= Size;
+
+  // Copy the offsets into the FileInfo structure, growing the table
+  // geometrically while it is incomplete.
+  unsigned NumLines = FI->NumLines + LineOffsets.size();
+  if (NumLines > FI->LineCacheCapacity) {
+    unsigned Capacity = FI->LineTableComplete
+                            ? NumLines
+                            : std::max(NumLines, 2 * FI->LineCacheCapacity);
+    unsigned *SourceLineCache = Alloc.Allocate<unsigned>(Capacity);
+    std::copy(FI->SourceLineCache, FI->SourceLineCache + FI->NumLines,
+              SourceLineCache);
+    FI->SourceLineCache = SourceLineCache;
+    FI->LineCacheCapacity = Capacity;
+  }
+  std::copy(LineOffsets.begin(), LineOffsets.end(),
+            FI->SourceLineCache + FI->NumLines);
+  FI->NumLines = NumLines;
 }
 
 /// getLineNumber - Given a SourceLocation, return the spelling line number
@@ -1293,17 +1350,17 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
     Content = const_cast<ContentCache*>(Entry.getFile().getContentCache());
   }
 
-  // If this is the first use of line information for this buffer, compute the
-  /// SourceLineCache for it on demand.
-  if (!Content->SourceLineCache) {
-    bool MyInvalid = false;
-    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
-    if (Invalid)
-      *Invalid = MyInvalid;
-    if (MyInvalid)
-      return 1;
-  } else if (Invalid)
-    *Invalid = false;
+  // Compute the SourceLineCache on demand, at least up to the first line
+  // that starts after FilePos.
+  bool MyInvalid = false;
+  ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid,
+                     [FilePos](unsigned, unsigned LastLineStart) {
+                       return LastLineStart > FilePos;
+                     });
+  if (Invalid)
+    *Invalid = MyInvalid;
+  if (MyInvalid)
+    return 1;
 
   // Okay, we know we have a line number table.  Do a binary search to find the
   // line number that this character position lands on.
@@ -1735,14 +1792,14 @@ SourceLocation SourceManager::translateLineCol(FileID FID,
   if (!Content)
     return SourceLocation();
 
-  // If this is the first use of line information for this buffer, compute the
-  // SourceLineCache for it on demand.
-  if (!Content->SourceLineCache) {
-    bool MyInvalid = false;
-    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
-    if (MyInvalid)
-      return SourceLocation();
-  }
+  // Compute the SourceLineCache on demand, at least up to the given line.
+  bool MyInvalid = false;
+  ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid,
+                     [Line](unsigned NumLines, unsigned) {
+                       return NumLines >= Line;
+                     });
+  if (MyInvalid)
+    return SourceLocation();
 
   if (Line > Content->NumLines) {
     unsigned Size = Content->getBuffer(Diag, *this)->getBufferSize();
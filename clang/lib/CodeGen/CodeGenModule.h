@@ -335,8 +335,10 @@ private:
   /// This contains all the decls which have definitions but/ which are deferred
   /// for emission and therefore should only be output if they are actually
   /// used. If a decl is in this, then it is known to have not been referenced
-  /// yet.
-  std::map<StringRef, GlobalDecl> DeferredDecls;
+  /// yet. Every reference to a global looks its mangled name up here, and
+  /// large translation units defer many thousands of inline functions, so
+  /// this is a hash map rather than an ordered one.
+  llvm::DenseMap<StringRef, GlobalDecl> DeferredDecls;
 
   /// This is a list of deferred decls which we have seen that *are* actually
   /// referenced. These get code generated when the module is done.
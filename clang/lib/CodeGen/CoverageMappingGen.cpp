@@ -1388,20 +1388,15 @@ void CoverageMappingModuleGen::emit() {
   std::string FilenamesAndCoverageMappings;
   llvm::raw_string_ostream OS(FilenamesAndCoverageMappings);
   CoverageFilenamesSectionWriter(FilenameRefs).write(OS);
+  size_t FilenamesSize = OS.str().size();
 
-  // Stream the content of CoverageMappings to OS while keeping
-  // memory consumption under control.
-  size_t CoverageMappingSize = 0;
-  for (auto &S : CoverageMappings) {
-    CoverageMappingSize += S.size();
-    OS << S;
-    S.clear();
-    S.shrink_to_fit();
-  }
+  // The mappings of all the functions are compressed together, then released
+  // to keep memory consumption under control.
+  CoverageMappingsSectionWriter(CoverageMappings).write(OS);
   CoverageMappings.clear();
   CoverageMappings.shrink_to_fit();
 
-  size_t FilenamesSize = OS.str().size() - CoverageMappingSize;
+  size_t CoverageMappingSize = OS.str().size() - FilenamesSize;
   // Append extra zeroes if necessary to ensure that the size of the filenames
   // and coverage mappings is a multiple of 8.
   if (size_t Rem = OS.str().size() % 8) {
@@ -226,6 +226,69 @@ CrossTranslationUnitContext::findDefInDeclContext(const DeclContext *DC,
   return nullptr;
 }
 
+/// Looks up the definition with the given USR by the name of \p D and the
+/// names of its enclosing namespaces and classes. Unlike visiting every decl,
+/// this only deserializes the lookup tables on the way to the definition.
+/// Returns null if the definition cannot be found like that.
+template <typename T>
+const T *CrossTranslationUnitContext::findDefByName(const T *D,
+                                                    const ASTContext &FromCtx,
+                                                    StringRef LookupName) {
+  auto GetFromName = [&FromCtx](const NamedDecl *ND) -> DeclarationName {
+    if (!ND->getIdentifier())
+      return DeclarationName();
+    return &FromCtx.Idents.get(ND->getName());
+  };
+
+  SmallVector<const NamedDecl *, 4> Path;
+  for (const DeclContext *DC = D->getDeclContext(); !DC->isTranslationUnit();
+       DC = DC->getParent()) {
+    if (isa<LinkageSpecDecl>(DC))
+      continue;
+    if (const auto *NS = dyn_cast<NamespaceDecl>(DC))
+      Path.push_back(NS);
+    else if (const auto *RD = dyn_cast<RecordDecl>(DC))
+      Path.push_back(RD);
+    else
+      return nullptr;
+  }
+
+  const DeclContext *FromDC = FromCtx.getTranslationUnitDecl();
+  for (const NamedDecl *ND : llvm::reverse(Path)) {
+    DeclarationName Name = GetFromName(ND);
+    if (!Name)
+      return nullptr;
+    const DeclContext *Next = nullptr;
+    for (const NamedDecl *Found : FromDC->lookup(Name)) {
+      if (isa<NamespaceDecl>(ND) && isa<NamespaceDecl>(Found)) {
+        Next = cast<NamespaceDecl>(Found);
+        break;
+      }
+      if (isa<RecordDecl>(ND) && isa<RecordDecl>(Found)) {
+        Next = cast<RecordDecl>(Found)->getDefinition();
+        break;
+      }
+    }
+    if (!Next)
+      return nullptr;
+    FromDC = Next;
+  }
+
+  DeclarationName Name = GetFromName(D);
+  if (!Name)
+    return nullptr;
+  for (const NamedDecl *Found : FromDC->lookup(Name)) {
+    const auto *ND = dyn_cast<T>(Found);
+    const T *ResultDecl;
+    if (!ND || !hasBodyOrInit(ND, ResultDecl))
+      continue;
+    llvm::Optional<std::string> ResultLookupName = getLookupName(ResultDecl);
+    if (ResultLookupName && *ResultLookupName == LookupName)
+      return ResultDecl;
+  }
+  return nullptr;
+}
+
 template <typename T>
 llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
     const T *D, StringRef CrossTUDir, StringRef IndexName,
@@ -294,6 +357,9 @@ llvm::Expected<const T *> CrossTranslationUnitContext::getCrossTUDefinitionImpl(
         index_error_code::lang_dialect_mismatch);
   }
 
+  if (const T *ResultDecl =
+          findDefByName(D, Unit->getASTContext(), *LookupName))
+    return importDefinition(ResultDecl, Unit);
   TranslationUnitDecl *TU = Unit->getASTContext().getTranslationUnitDecl();
   if (const T *ResultDecl = findDefInDeclContext<T>(TU, *LookupName))
     return importDefinition(ResultDecl, Unit);
@@ -360,11 +426,25 @@ CrossTranslationUnitContext::ASTFileLoader::operator()(StringRef ASTFilePath) {
       ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts());
 }
 
+static const AnalyzerOptions &getAnalyzerOpts(const CompilerInstance &CI) {
+  return *const_cast<CompilerInstance &>(CI).getAnalyzerOpts();
+}
+
 CrossTranslationUnitContext::ASTUnitStorage::ASTUnitStorage(
     const CompilerInstance &CI)
-    : FileAccessor(CI), LoadGuard(const_cast<CompilerInstance &>(CI)
-                                      .getAnalyzerOpts()
-                                      ->CTUImportThreshold) {}
+    : FileAccessor(CI), LoadGuard(getAnalyzerOpts(CI).CTUImportThreshold,
+                                  getAnalyzerOpts(CI).CTUMemoryLimit) {}
+
+size_t CrossTranslationUnitContext::ASTUnitStorage::getLoadedMemory() const {
+  size_t Bytes = 0;
+  for (const auto &Entry : FileASTUnitMap) {
+    if (!Entry.second)
+      continue;
+    const ASTContext &Ctx = Entry.second->getASTContext();
+    Bytes += Ctx.getASTAllocatedMemory() + Ctx.getSideTableAllocatedMemory();
+  }
+  return Bytes;
+}
 
 llvm::Expected<ASTUnit *>
 CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
@@ -374,7 +454,7 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
   if (ASTCacheEntry == FileASTUnitMap.end()) {
 
     // Do not load if the limit is reached.
-    if (!LoadGuard) {
+    if (!LoadGuard.canLoad(getLoadedMemory())) {
       ++NumASTLoadThresholdReached;
       return llvm::make_error<IndexError>(
           index_error_code::load_threshold_reached);
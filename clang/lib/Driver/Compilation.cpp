@@ -22,11 +22,16 @@
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptSpecifier.h"
 #include "llvm/Option/Option.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
+#include <condition_variable>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <utility>
 
 using namespace clang;
@@ -152,6 +157,7 @@ int Compilation::ExecuteCommand(const Command &C,
                                 const Command *&FailingCommand) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
+    std::lock_guard<std::mutex> Lock(OutputMutex);
     raw_ostream *OS = &llvm::errs();
     std::unique_ptr<llvm::raw_fd_ostream> OwnedStream;
 
@@ -182,6 +188,7 @@ int Compilation::ExecuteCommand(const Command &C,
   int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
+    std::lock_guard<std::mutex> Lock(OutputMutex);
     getDriver().Diag(diag::err_drv_command_failure) << Error;
   }
 
@@ -220,8 +227,49 @@ static bool InputsOk(const Command &C,
   return !ActionFailed(&C.getSource(), FailingCommands);
 }
 
+/// Collect the jobs whose outputs \p A consumes, directly or through actions
+/// that don't have a job of their own.
+static void
+collectJobDeps(const Action *A,
+               const llvm::DenseMap<const Action *, unsigned> &JobOf,
+               llvm::SmallPtrSetImpl<const Action *> &Visited,
+               SmallVectorImpl<unsigned> &Deps) {
+  for (const Action *Input : A->inputs()) {
+    if (!Visited.insert(Input).second)
+      continue;
+    auto It = JobOf.find(Input);
+    if (It != JobOf.end())
+      Deps.push_back(It->second);
+    else
+      collectJobDeps(Input, JobOf, Visited, Deps);
+  }
+}
+
+/// Get the number of jobs that -parallel-jobs= allows to run at once.
+static unsigned getNumParallelJobs(const Compilation &C) {
+  const llvm::opt::Arg *A =
+      C.getArgs().getLastArg(options::OPT_parallel_jobs_EQ);
+  if (!A)
+    return 1;
+  unsigned N;
+  if (StringRef(A->getValue()).getAsInteger(10, N) || N == 0) {
+    C.getDriver().Diag(diag::err_drv_invalid_int_value)
+        << A->getAsString(C.getArgs()) << A->getValue();
+    return 1;
+  }
+  return N;
+}
+
 void Compilation::ExecuteJobs(const JobList &Jobs,
                               FailingCommandList &FailingCommands) const {
+  unsigned NumParallelJobs = getNumParallelJobs(*this);
+#if LLVM_ENABLE_THREADS
+  if (NumParallelJobs > 1 && Jobs.size() > 1) {
+    ExecuteJobsInParallel(Jobs, FailingCommands, NumParallelJobs);
+    return;
+  }
+#endif
+
   // According to UNIX standard, driver need to continue compiling all the
   // inputs on the command line even one of them failed.
   // In all but CLMode, execute all the jobs unless the necessary inputs for the
@@ -239,6 +287,93 @@ void Compilation::ExecuteJobs(const JobList &Jobs,
   }
 }
 
+void Compilation::ExecuteJobsInParallel(const JobList &Jobs,
+                                        FailingCommandList &FailingCommands,
+                                        unsigned NumParallelJobs) const {
+  std::vector<const Command *> Commands;
+  // The last job created for each action. Jobs sharing an action still run in
+  // order, so each of them also depends on the previous one.
+  llvm::DenseMap<const Action *, unsigned> JobOf;
+  std::vector<Optional<unsigned>> PrevJobOfSource;
+  for (const auto &Job : Jobs) {
+    auto Inserted = JobOf.try_emplace(&Job.getSource(), Commands.size());
+    PrevJobOfSource.push_back(None);
+    if (!Inserted.second) {
+      PrevJobOfSource.back() = Inserted.first->second;
+      Inserted.first->second = Commands.size();
+    }
+    Commands.push_back(&Job);
+  }
+
+  // A job can start once every job producing one of its inputs has finished.
+  // The job list is in execution order, so dependencies always come first.
+  std::vector<unsigned> NumPendingDeps(Commands.size());
+  std::vector<SmallVector<unsigned, 2>> Dependents(Commands.size());
+  for (unsigned I = 0, N = Commands.size(); I != N; ++I) {
+    llvm::SmallPtrSet<const Action *, 16> Visited;
+    SmallVector<unsigned, 4> Deps;
+    if (PrevJobOfSource[I])
+      Deps.push_back(*PrevJobOfSource[I]);
+    collectJobDeps(&Commands[I]->getSource(), JobOf, Visited, Deps);
+    for (unsigned Dep : Deps) {
+      if (Dep == I)
+        continue;
+      Dependents[Dep].push_back(I);
+      ++NumPendingDeps[I];
+    }
+  }
+
+  std::mutex Lock;
+  std::condition_variable Changed;
+  // Ready jobs, started lowest index first to keep the serial order when
+  // possible.
+  std::vector<unsigned> Ready;
+  for (unsigned I = Commands.size(); I-- != 0;)
+    if (NumPendingDeps[I] == 0)
+      Ready.push_back(I);
+  unsigned NumRemaining = Commands.size();
+  bool Stop = false;
+
+  auto Worker = [&]() {
+    std::unique_lock<std::mutex> Guard(Lock);
+    while (true) {
+      Changed.wait(Guard, [&] { return Stop || !Ready.empty() ||
+                                       NumRemaining == 0; });
+      if (Stop || Ready.empty())
+        return;
+      unsigned I = Ready.back();
+      Ready.pop_back();
+
+      // As in the serial case, skip the jobs whose inputs failed.
+      if (InputsOk(*Commands[I], FailingCommands)) {
+        Guard.unlock();
+        const Command *FailingCommand = nullptr;
+        int Res = ExecuteCommand(*Commands[I], FailingCommand);
+        Guard.lock();
+        if (Res) {
+          FailingCommands.push_back(std::make_pair(Res, FailingCommand));
+          // Stop starting new jobs after a failure in cl driver mode.
+          if (TheDriver.IsCLMode())
+            Stop = true;
+        }
+      }
+
+      --NumRemaining;
+      for (unsigned Dependent : Dependents[I])
+        if (--NumPendingDeps[Dependent] == 0)
+          Ready.push_back(Dependent);
+      Changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  unsigned NumThreads = std::min<size_t>(NumParallelJobs, Commands.size());
+  for (unsigned I = 0; I != NumThreads; ++I)
+    Threads.emplace_back(Worker);
+  for (std::thread &T : Threads)
+    T.join();
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
@@ -125,7 +125,8 @@ Driver::Driver(StringRef ClangExecutable, StringRef TargetTriple,
       LTOMode(LTOK_None), ClangExecutable(ClangExecutable),
       SysRoot(DEFAULT_SYSROOT), DriverTitle("clang LLVM compiler"),
       CCPrintOptionsFilename(nullptr), CCPrintHeadersFilename(nullptr),
-      CCLogDiagnosticsFilename(nullptr), CCCPrintBindings(false),
+      CCLogDiagnosticsFilename(nullptr), CC1ServerSocket(nullptr),
+      CCCPrintBindings(false),
       CCPrintOptions(false), CCPrintHeaders(false), CCLogDiagnostics(false),
       CCGenDiagnostics(false), TargetTriple(TargetTriple),
       CCCGenericGCCName(""), Saver(Alloc), CheckInputsExist(true),
@@ -1027,6 +1028,9 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // Ignore -pipe.
   Args.ClaimAllArgs(options::OPT_pipe);
 
+  // -parallel-jobs= is used when the jobs are executed.
+  Args.ClaimAllArgs(options::OPT_parallel_jobs_EQ);
+
   // Extract -ccc args.
   //
   // FIXME: We need to figure out where this behavior should live. Most of it
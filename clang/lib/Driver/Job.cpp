@@ -19,6 +19,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
@@ -28,8 +29,17 @@
 #include <cstddef>
 #include <string>
 #include <system_error>
+#include <tuple>
 #include <utility>
 
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 using namespace clang;
 using namespace driver;
 
@@ -313,6 +323,85 @@ void Command::setEnvironment(llvm::ArrayRef<const char *> NewEnvironment) {
   Environment.push_back(nullptr);
 }
 
+#ifdef LLVM_ON_UNIX
+/// Run the -cc1 job \p Args of \p Executable on the clang -cc1server
+/// listening on \p SocketPath, and print its diagnostics. Returns false if
+/// the server did not run the job, which then has to run in a process of its
+/// own.
+static bool executeOnCC1Server(StringRef SocketPath, const char *Executable,
+                               ArrayRef<const char *> Args, int &ExitCode) {
+  sockaddr_un Addr = {};
+  Addr.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Addr.sun_path))
+    return false;
+  memcpy(Addr.sun_path, SocketPath.data(), SocketPath.size());
+
+  SmallString<256> WorkingDir;
+  if (llvm::sys::fs::current_path(WorkingDir))
+    return false;
+
+  int FD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0)
+    return false;
+  if (::connect(FD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr))) {
+    ::close(FD);
+    return false;
+  }
+
+  // A server that goes away must not take the driver with it.
+#ifdef SO_NOSIGPIPE
+  int On = 1;
+  ::setsockopt(FD, SOL_SOCKET, SO_NOSIGPIPE, &On, sizeof(On));
+#endif
+#ifdef MSG_NOSIGNAL
+  const int SendFlags = MSG_NOSIGNAL;
+#else
+  const int SendFlags = 0;
+#endif
+
+  // Send NUL-terminated strings: the executable, the working directory and
+  // the arguments after -cc1.
+  std::string Request;
+  Request.append(Executable).push_back('\0');
+  Request.append(WorkingDir.begin(), WorkingDir.end()).push_back('\0');
+  for (const char *Arg : Args.drop_front())
+    Request.append(Arg).push_back('\0');
+  StringRef Data = Request;
+  while (!Data.empty()) {
+    ssize_t N = ::send(FD, Data.data(), Data.size(), SendFlags);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0) {
+      ::close(FD);
+      return false;
+    }
+    Data = Data.drop_front(N);
+  }
+  ::shutdown(FD, SHUT_WR);
+
+  std::string Reply;
+  char Buffer[4096];
+  while (true) {
+    ssize_t N = ::read(FD, Buffer, sizeof(Buffer));
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      break;
+    Reply.append(Buffer, N);
+  }
+  ::close(FD);
+
+  // The reply is "exit-status: N" followed by the diagnostics of the job.
+  StringRef Status, Diagnostics;
+  std::tie(Status, Diagnostics) = StringRef(Reply).split('\n');
+  if (!Status.consume_front("exit-status: ") ||
+      Status.getAsInteger(10, ExitCode))
+    return false;
+  llvm::errs() << Diagnostics;
+  return true;
+}
+#endif
+
 int Command::Execute(ArrayRef<llvm::Optional<StringRef>> Redirects,
                      std::string *ErrMsg, bool *ExecutionFailed) const {
   if (PrintInputFilenames) {
@@ -321,6 +410,19 @@ int Command::Execute(ArrayRef<llvm::Optional<StringRef>> Redirects,
     llvm::outs().flush();
   }
 
+#ifdef LLVM_ON_UNIX
+  // Hand -cc1 jobs to the compilation server if there is one. A job that
+  // needs its own environment or redirections always gets its own process.
+  const Driver &D = Creator.getToolChain().getDriver();
+  if (D.CC1ServerSocket && Environment.empty() && Redirects.empty() &&
+      !Arguments.empty() && StringRef(Arguments[0]) == "-cc1") {
+    int ExitCode;
+    if (executeOnCC1Server(D.CC1ServerSocket, Executable, Arguments,
+                           ExitCode))
+      return ExitCode;
+  }
+#endif
+
   SmallVector<const char*, 128> Argv;
 
   Optional<ArrayRef<StringRef>> Env;
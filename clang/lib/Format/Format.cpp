@@ -2261,6 +2261,153 @@ cleanupAroundReplacements(StringRef Code, const tooling::Replacements &Replaces,
   return processReplacements(Cleanup, Code, NewReplaces, Style);
 }
 
+// Returns the part of \p Code around \p Ranges that can be reformatted on its
+// own with the same result as when reformatting all of \p Code, or None if
+// there is no such part smaller than \p Code.
+//
+// The part is made of whole lines and is delimited by boundaries: lines that
+// start in the first column after an empty line, with a declaration that is
+// not nested in anything but namespaces whose content isn't indented. At a
+// boundary, the UnwrappedLineParser is in the same state as at the start of
+// the file, and the WhitespaceManager doesn't align across the empty line.
+// One more declaration is kept before and two more after the ranges, so that
+// the lines at the boundaries of the part are not affected by the ranges.
+//
+// This only needs a raw lexer, so formatting a few lines of a large file only
+// annotates and formats the declarations around them.
+static llvm::Optional<tooling::Range>
+getIndependentRange(const FormatStyle &Style, StringRef Code,
+                    ArrayRef<tooling::Range> Ranges, StringRef FileName) {
+  // These derive options or the header guard from the whole file.
+  if (Ranges.empty() || Style.Language != FormatStyle::LK_Cpp ||
+      Style.DerivePointerAlignment || Style.Standard == FormatStyle::LS_Auto ||
+      Style.ExperimentalAutoDetectBinPacking ||
+      Style.IndentPPDirectives != FormatStyle::PPDIS_None)
+    return None;
+
+  unsigned RangesBegin = Code.size(), RangesEnd = 0;
+  for (const tooling::Range &R : Ranges) {
+    RangesBegin = std::min(RangesBegin, R.getOffset());
+    RangesEnd = std::max(RangesEnd, R.getOffset() + R.getLength());
+  }
+
+  // The two last boundaries before the ranges (the start of the file is one),
+  // and the first three after them.
+  unsigned Before[2] = {0, 0};
+  SmallVector<unsigned, 3> After;
+
+  SourceManagerForFile VirtualSM(FileName, Code);
+  SourceManager &SM = VirtualSM.get();
+  FileID ID = SM.getMainFileID();
+  Lexer Lex(ID, SM.getBuffer(ID), SM, getFormattingLangOpts(Style));
+  Lex.SetCommentRetentionState(true);
+
+  // For each open brace that opens a namespace whose content isn't indented,
+  // the last boundary before the namespace, and None for the other braces.
+  SmallVector<llvm::Optional<unsigned>, 8> Braces;
+  unsigned IndentedBraces = 0;
+  unsigned PPConditionals = 0;
+  bool SawNamespace = false;
+  bool FormattingDisabled = false;
+  // Whether the last token (ignoring comments) ends a declaration.
+  bool AfterDeclaration = true;
+  unsigned PrevEnd = 0;
+  Token Tok;
+  Lex.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof) && After.size() < 3) {
+    unsigned Offset = SM.getFileOffset(Tok.getLocation());
+    StringRef Gap = Code.slice(PrevEnd, Offset);
+    if (AfterDeclaration && IndentedBraces == 0 && PPConditionals == 0 &&
+        !FormattingDisabled && Gap.count('\n') > 1 && Gap.back() == '\n' &&
+        !Gap.contains('\\') &&
+        !Tok.isOneOf(tok::comment, tok::hash, tok::r_brace)) {
+      if (Offset <= RangesBegin) {
+        Before[0] = Before[1];
+        Before[1] = Offset;
+      } else if (Offset > RangesEnd) {
+        After.push_back(Offset);
+      }
+    }
+    PrevEnd = Offset + Tok.getLength();
+
+    if (Tok.is(tok::hash) && Tok.isAtStartOfLine()) {
+      // Skip the directive, only keeping track of the conditionals.
+      Lex.LexFromRawLexer(Tok);
+      if (Tok.is(tok::raw_identifier) && !Tok.isAtStartOfLine()) {
+        StringRef Directive = Tok.getRawIdentifier();
+        if (Directive.startswith("if"))
+          ++PPConditionals;
+        else if (Directive == "endif" && PPConditionals > 0)
+          --PPConditionals;
+      }
+      while (Tok.isNot(tok::eof) && !Tok.isAtStartOfLine()) {
+        PrevEnd = SM.getFileOffset(Tok.getLocation()) + Tok.getLength();
+        Lex.LexFromRawLexer(Tok);
+      }
+      AfterDeclaration = true;
+      continue;
+    }
+
+    if (Tok.is(tok::comment)) {
+      StringRef Text = Code.substr(Offset, Tok.getLength()).rtrim();
+      if (Text.startswith("// clang-format off") ||
+          Text.startswith("/* clang-format off"))
+        FormattingDisabled = true;
+      else if (Text == "// clang-format on" || Text == "/* clang-format on */")
+        FormattingDisabled = false;
+    } else {
+      // Conflict markers are parsed like preprocessor conditionals.
+      if (Offset == 0 || Code[Offset - 1] == '\n') {
+        StringRef Line = Code.substr(Offset);
+        if (Line.startswith("<<<<") || Line.startswith(">>>>") ||
+            Line.startswith("||||") || Line.startswith("===="))
+          return None;
+      }
+      // The namespace must start a declaration for its content to be parsed
+      // like the top level.
+      if (Tok.is(tok::raw_identifier) && Tok.getRawIdentifier() == "namespace")
+        SawNamespace = AfterDeclaration;
+      else if (Tok.is(tok::semi))
+        SawNamespace = false;
+      if (Tok.is(tok::l_brace)) {
+        bool Indented =
+            !SawNamespace || Style.NamespaceIndentation != FormatStyle::NI_None;
+        Braces.push_back(Indented ? llvm::Optional<unsigned>() : Before[1]);
+        IndentedBraces += Indented;
+        SawNamespace = false;
+      } else if (Tok.is(tok::r_brace)) {
+        // Unbalanced braces: don't look for boundaries after them.
+        if (Braces.empty())
+          break;
+        llvm::Optional<unsigned> NamespaceStart = Braces.pop_back_val();
+        if (!NamespaceStart) {
+          --IndentedBraces;
+        } else if (Offset <= RangesBegin) {
+          // The boundaries in the namespace can't start the part anymore.
+          Before[0] = Before[1] = *NamespaceStart;
+        } else {
+          // Keep both braces of the namespace in the part.
+          Before[0] = std::min(Before[0], *NamespaceStart);
+        }
+      }
+      AfterDeclaration = Tok.isOneOf(tok::semi, tok::r_brace);
+    }
+    Lex.LexFromRawLexer(Tok);
+  }
+
+  unsigned Start = Before[0];
+  unsigned End = After.size() == 3 ? After[2] : Code.size();
+  if (Start == 0 && End == Code.size())
+    return None;
+  // The formatter uses the line endings that are the most common in its input.
+  auto UsesCRLF = [](StringRef Text) {
+    return Text.count('\r') * 2 > Text.count('\n');
+  };
+  if (UsesCRLF(Code) != UsesCRLF(Code.slice(Start, End)))
+    return None;
+  return tooling::Range(Start, End - Start);
+}
+
 namespace internal {
 std::pair<tooling::Replacements, unsigned>
 reformat(const FormatStyle &Style, StringRef Code,
@@ -2275,6 +2422,41 @@ reformat(const FormatStyle &Style, StringRef Code,
   if (Expanded.Language == FormatStyle::LK_JavaScript && isMpegTS(Code))
     return {tooling::Replacements(), 0};
 
+  // When only a part of a fragment that is a whole file is reformatted, only
+  // lex, parse and annotate what can affect that part.
+  if (FirstStartColumn == 0 && NextStartColumn == 0 && LastStartColumn == 0) {
+    if (llvm::Optional<tooling::Range> Independent =
+            getIndependentRange(Expanded, Code, Ranges, FileName)) {
+      unsigned Start = Independent->getOffset();
+      // The lexer needs a null-terminated buffer.
+      std::string IndependentCode =
+          Code.substr(Start, Independent->getLength());
+      std::vector<tooling::Range> IndependentRanges;
+      for (const tooling::Range &R : Ranges)
+        IndependentRanges.push_back(
+            tooling::Range(R.getOffset() - Start, R.getLength()));
+      std::pair<tooling::Replacements, unsigned> Result =
+          reformat(Style, IndependentCode, IndependentRanges,
+                   /*FirstStartColumn=*/0, /*NextStartColumn=*/0,
+                   /*LastStartColumn=*/0, FileName, Status);
+      if (Status && !Status->FormatComplete)
+        Status->Line += Code.take_front(Start).count('\n');
+      // Unless the part ends the file, the empty lines at its end are kept as
+      // they are, like the whitespace before the next line when formatting
+      // all of Code.
+      unsigned FormattedEnd = IndependentCode.size();
+      if (Start + IndependentCode.size() < Code.size())
+        FormattedEnd = StringRef(IndependentCode).rtrim().size();
+      tooling::Replacements Fixes;
+      for (const tooling::Replacement &R : Result.first)
+        if (R.getOffset() < FormattedEnd)
+          cantFail(Fixes.add(
+              tooling::Replacement(FileName, R.getOffset() + Start,
+                                   R.getLength(), R.getReplacementText())));
+      return {Fixes, Result.second};
+    }
+  }
+
   typedef std::function<std::pair<tooling::Replacements, unsigned>(
       const Environment &)>
       AnalyzerPass;
@@ -20,9 +20,11 @@
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderMap.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/ModuleMap.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
@@ -1286,6 +1288,19 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
       return false;
   }
 
+  // Before the first inclusion of a file, another preprocessor might already
+  // know the guard of a file with the same contents.
+  IncludeGuardCache *Guards = PP.getPreprocessorOpts().IncludeGuards.get();
+  if (Guards && !ModulesEnabled && !FileInfo.NumIncludes &&
+      !FileInfo.getControllingMacro(ExternalLookup)) {
+    if (const llvm::MemoryBuffer *Buffer =
+            PP.getSourceManager().getMemoryBufferForFile(File)) {
+      std::string Guard = Guards->getControllingMacro(Buffer->getBuffer());
+      if (!Guard.empty())
+        FileInfo.ControllingMacro = PP.getIdentifierInfo(Guard);
+    }
+  }
+
   // Next, check to see if the file is wrapped with #ifndef guards.  If so, and
   // if the macro that guards it is defined, we know the #include has no effect.
   if (const IdentifierInfo *ControllingMacro
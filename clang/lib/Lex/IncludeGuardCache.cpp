@@ -0,0 +1,36 @@
+//===- IncludeGuardCache.cpp - Include guards shared between TUs ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the IncludeGuardCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludeGuardCache.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace clang;
+
+IncludeGuardCache::ContentsKey IncludeGuardCache::getKey(StringRef Contents) {
+  return {llvm::xxHash64(Contents), Contents.size()};
+}
+
+std::string IncludeGuardCache::getControllingMacro(StringRef Contents) const {
+  ContentsKey Key = getKey(Contents);
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  auto It = ControllingMacros.find(Key);
+  if (It == ControllingMacros.end())
+    return std::string();
+  return It->second;
+}
+
+void IncludeGuardCache::setControllingMacro(StringRef Contents,
+                                            StringRef Macro) {
+  ContentsKey Key = getKey(Contents);
+  std::lock_guard<std::mutex> LockGuard(Lock);
+  ControllingMacros[Key] = Macro;
+}
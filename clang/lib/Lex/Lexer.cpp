@@ -47,6 +47,13 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -1625,9 +1632,103 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Vectorized scanning helpers
+//===----------------------------------------------------------------------===//
+
+// Each of these returns the first character at or after Ptr that the caller's
+// scalar loop has to look at. They only ever skip whole 16-byte chunks that
+// lie entirely before End, so callers keep their scalar loops to finish the
+// run and to stop at the right character.
+
+#ifdef __SSE2__
+/// Skip 16-byte chunks as long as StopMask, given a chunk, returns zero. A
+/// non-zero result is a bitmask of the chunk's characters that end the run.
+template <typename StopMaskFn>
+static const char *skipChunks(const char *Ptr, const char *End,
+                              StopMaskFn StopMask) {
+  while (Ptr + 16 <= End) {
+    __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+    if (unsigned Mask = StopMask(Chunk))
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+  return Ptr;
+}
+
+/// Returns a bitmask of the characters of Chunk equal to C.
+static unsigned matchBytes(__m128i Chunk, char C) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8(C)));
+}
+
+/// Selects the characters of Chunk in [Lo, Hi]. Lo and Hi must be ASCII, so
+/// that bytes with the high bit set (negative as signed chars) never match.
+static __m128i inRange(__m128i Chunk, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(Chunk, _mm_set1_epi8(Hi + 1)));
+}
+#endif
+
+/// Skip over [_A-Za-z0-9].
+static const char *skipIdentifierBody(const char *Ptr, const char *End) {
+#ifdef __SSE2__
+  return skipChunks(Ptr, End, [](__m128i Chunk) -> unsigned {
+    __m128i Lower = _mm_or_si128(Chunk, _mm_set1_epi8(0x20));
+    __m128i Ident = _mm_or_si128(
+        _mm_or_si128(inRange(Lower, 'a', 'z'), inRange(Chunk, '0', '9')),
+        _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('_')));
+    return _mm_movemask_epi8(Ident) ^ 0xFFFF;
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skip over [ \t\f\v].
+static const char *skipHorizontalWhitespace(const char *Ptr,
+                                            const char *End) {
+#ifdef __SSE2__
+  return skipChunks(Ptr, End, [](__m128i Chunk) -> unsigned {
+    return (matchBytes(Chunk, ' ') | matchBytes(Chunk, '\t') |
+            matchBytes(Chunk, '\f') | matchBytes(Chunk, '\v')) ^
+           0xFFFF;
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skip over the characters of a line comment that can not end it.
+static const char *skipLineCommentBody(const char *Ptr, const char *End) {
+#ifdef __SSE2__
+  return skipChunks(Ptr, End, [](__m128i Chunk) -> unsigned {
+    return matchBytes(Chunk, '\n') | matchBytes(Chunk, '\r') |
+           matchBytes(Chunk, 0);
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skip over the characters of a quoted literal that getAndAdvanceChar would
+/// return unchanged and that the literal lexing loops don't look at.
+static const char *skipQuotedLiteralBody(const char *Ptr, const char *End,
+                                         char Quote) {
+#ifdef __SSE2__
+  return skipChunks(Ptr, End, [Quote](__m128i Chunk) -> unsigned {
+    return matchBytes(Chunk, Quote) | matchBytes(Chunk, '\\') |
+           matchBytes(Chunk, '?') | matchBytes(Chunk, '\n') |
+           matchBytes(Chunk, '\r') | matchBytes(Chunk, 0);
+  });
+#else
+  return Ptr;
+#endif
+}
+
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -1934,6 +2035,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipQuotedLiteralBody(CurPtr, BufferEnd, '"');
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2062,6 +2164,7 @@ bool Lexer::LexAngledStringLiteral(Token &Result, const char *CurPtr) {
       }
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipQuotedLiteralBody(CurPtr, BufferEnd, '>');
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2151,6 +2254,7 @@ bool Lexer::LexCharConstant(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipQuotedLiteralBody(CurPtr, BufferEnd, '\'');
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2183,6 +2287,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2252,6 +2360,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    CurPtr = skipLineCommentBody(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2459,13 +2568,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
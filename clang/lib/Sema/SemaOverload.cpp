@@ -62,8 +62,10 @@ CreateFunctionRefExpr(Sema &S, FunctionDecl *Fn, NamedDecl *FoundDecl,
     return ExprError();
   if (auto *FPT = Fn->getType()->getAs<FunctionProtoType>())
     S.ResolveExceptionSpec(Loc, FPT);
-  DeclRefExpr *DRE = new (S.Context)
-      DeclRefExpr(S.Context, Fn, false, Fn->getType(), VK_LValue, Loc, LocInfo);
+  DeclRefExpr *DRE = DeclRefExpr::Create(
+      S.Context, NestedNameSpecifierLoc(), SourceLocation(), Fn, false,
+      DeclarationNameInfo(Fn->getDeclName(), Loc, LocInfo), Fn->getType(),
+      VK_LValue);
   if (HadMultipleCandidates)
     DRE->setHadMultipleCandidates(true);
 
@@ -51,6 +51,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <algorithm>
 #include <cassert>
 #include <tuple>
@@ -3307,6 +3308,14 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
     TemplateDeductionInfo &Info,
     SmallVectorImpl<OriginalCallArg> const *OriginalCallArgs,
     bool PartialOverloading, llvm::function_ref<bool()> CheckNonDependent) {
+  llvm::TimeTraceScope TimeScope("DeduceTemplateArguments", [&]() {
+    std::string Name;
+    llvm::raw_string_ostream OS(Name);
+    FunctionTemplate->getNameForDiagnostic(OS, getPrintingPolicy(),
+                                           /*Qualified=*/true);
+    return Name;
+  });
+
   // Unevaluated SFINAE context.
   EnterExpressionEvaluationContext Unevaluated(
       *this, Sema::ExpressionEvaluationContext::Unevaluated);
@@ -3350,6 +3359,33 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
     = TemplateArgumentList::CreateCopy(Context, Builder);
   Info.reset(DeducedArgumentList);
 
+  // Successful substitutions are found again as existing specializations by
+  // SubstDecl; with -fcache-failed-template-deductions, failed ones are not
+  // repeated either.
+  llvm::FoldingSetNodeID FailureID;
+  bool CacheFailure =
+      getLangOpts().CacheFailedTemplateDeductions && !PartialOverloading;
+  if (CacheFailure) {
+    FailureID.AddPointer(FunctionTemplate->getCanonicalDecl());
+    for (const TemplateArgument &Arg : Builder)
+      Arg.Profile(FailureID, Context);
+    auto Known = FailedDeductionSubstitutions.find(FailureID);
+    if (Known != FailedDeductionSubstitutions.end()) {
+      if (Known->second)
+        Info.addSFINAEDiagnostic(Known->second->first, Known->second->second);
+      return TDK_SubstitutionFailure;
+    }
+  }
+  auto SubstitutionFailed = [&]() {
+    if (CacheFailure) {
+      Optional<PartialDiagnosticAt> Diag;
+      if (Info.hasSFINAEDiagnostic())
+        Diag = Info.peekSFINAEDiagnostic();
+      FailedDeductionSubstitutions.emplace(FailureID, std::move(Diag));
+    }
+    return TDK_SubstitutionFailure;
+  };
+
   // Substitute the deduced template arguments into the function template
   // declaration to produce the function template specialization.
   DeclContext *Owner = FunctionTemplate->getDeclContext();
@@ -3359,7 +3395,7 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
   Specialization = cast_or_null<FunctionDecl>(
       SubstDecl(FunctionTemplate->getTemplatedDecl(), Owner, SubstArgs));
   if (!Specialization || Specialization->isInvalidDecl())
-    return TDK_SubstitutionFailure;
+    return SubstitutionFailed();
 
   assert(Specialization->getPrimaryTemplate()->getCanonicalDecl() ==
          FunctionTemplate->getCanonicalDecl());
@@ -3375,7 +3411,7 @@ Sema::TemplateDeductionResult Sema::FinishTemplateArgumentDeduction(
   // failure.
   if (Trap.hasErrorOccurred()) {
     Specialization->setInvalidDecl(true);
-    return TDK_SubstitutionFailure;
+    return SubstitutionFailed();
   }
 
   if (OriginalCallArgs) {
@@ -2716,7 +2716,17 @@ ASTReader::ReadControlBlock(ModuleFile &F,
       if (ASTReadResult Result = readUnhashedControlBlockOnce())
         return Result;
 
-      // Load each of the imported PCH files.
+      // Read information about all of the imported AST files first, so that
+      // the ones that aren't loaded yet can be read from disk in parallel.
+      struct ImportedFileInfo {
+        ModuleKind Kind;
+        SourceLocation ImportLoc;
+        off_t StoredSize;
+        time_t StoredModTime;
+        ASTFileSignature StoredSignature;
+        std::string File;
+      };
+      SmallVector<ImportedFileInfo, 8> Imports;
       unsigned Idx = 0, N = Record.size();
       while (Idx < N) {
         // Read information about the AST file.
@@ -2752,6 +2762,19 @@ ASTReader::ReadControlBlock(ModuleFile &F,
         else
           SkipPath(Record, Idx);
 
+        Imports.push_back({ImportedKind, ImportLoc, StoredSize, StoredModTime,
+                           StoredSignature, std::move(ImportedFile)});
+      }
+
+      // Load each of the imported PCH files.
+      SmallVector<StringRef, 8> ImportedFiles;
+      for (const ImportedFileInfo &Import : Imports)
+        ImportedFiles.push_back(Import.File);
+      ModuleMgr.prefetchModuleFiles(ImportedFiles);
+      auto DropPrefetched = llvm::make_scope_exit(
+          [&] { ModuleMgr.dropPrefetchedModuleFiles(ImportedFiles); });
+
+      for (const ImportedFileInfo &Import : Imports) {
         // If our client can't cope with us being out of date, we can't cope with
         // our dependency being missing.
         unsigned Capabilities = ClientLoadCapabilities;
@@ -2759,9 +2782,10 @@ ASTReader::ReadControlBlock(ModuleFile &F,
           Capabilities &= ~ARR_Missing;
 
         // Load the AST file.
-        auto Result = ReadASTCore(ImportedFile, ImportedKind, ImportLoc, &F,
-                                  Loaded, StoredSize, StoredModTime,
-                                  StoredSignature, Capabilities);
+        auto Result = ReadASTCore(Import.File, Import.Kind, Import.ImportLoc,
+                                  &F, Loaded, Import.StoredSize,
+                                  Import.StoredModTime, Import.StoredSignature,
+                                  Capabilities);
 
         // If we diagnosed a problem, produce a backtrace.
         if (isDiagnosedResult(Result, Capabilities))
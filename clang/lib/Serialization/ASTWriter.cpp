@@ -194,6 +194,7 @@ void ASTTypeWriter::VisitComplexType(const ComplexType *T) {
 void ASTTypeWriter::VisitPointerType(const PointerType *T) {
   Record.AddTypeRef(T->getPointeeType());
   Code = TYPE_POINTER;
+  AbbrevToUse = Writer.TypePointerAbbrev;
 }
 
 void ASTTypeWriter::VisitDecayedType(const DecayedType *T) {
@@ -216,11 +217,13 @@ void ASTTypeWriter::VisitLValueReferenceType(const LValueReferenceType *T) {
   Record.AddTypeRef(T->getPointeeTypeAsWritten());
   Record.push_back(T->isSpelledAsLValue());
   Code = TYPE_LVALUE_REFERENCE;
+  AbbrevToUse = Writer.TypeLValueReferenceAbbrev;
 }
 
 void ASTTypeWriter::VisitRValueReferenceType(const RValueReferenceType *T) {
   Record.AddTypeRef(T->getPointeeTypeAsWritten());
   Code = TYPE_RVALUE_REFERENCE;
+  AbbrevToUse = Writer.TypeRValueReferenceAbbrev;
 }
 
 void ASTTypeWriter::VisitMemberPointerType(const MemberPointerType *T) {
@@ -340,6 +343,7 @@ void ASTTypeWriter::VisitTypedefType(const TypedefType *T) {
   assert(!T->isCanonicalUnqualified() && "Invalid typedef ?");
   Record.AddTypeRef(T->getCanonicalTypeInternal());
   Code = TYPE_TYPEDEF;
+  AbbrevToUse = Writer.TypeTypedefAbbrev;
 }
 
 void ASTTypeWriter::VisitTypeOfExprType(const TypeOfExprType *T) {
@@ -393,11 +397,13 @@ void ASTTypeWriter::VisitTagType(const TagType *T) {
 void ASTTypeWriter::VisitRecordType(const RecordType *T) {
   VisitTagType(T);
   Code = TYPE_RECORD;
+  AbbrevToUse = Writer.TypeRecordAbbrev;
 }
 
 void ASTTypeWriter::VisitEnumType(const EnumType *T) {
   VisitTagType(T);
   Code = TYPE_ENUM;
+  AbbrevToUse = Writer.TypeEnumAbbrev;
 }
 
 void ASTTypeWriter::VisitAttributedType(const AttributedType *T) {
@@ -515,6 +521,7 @@ void ASTTypeWriter::VisitPackExpansionType(const PackExpansionType *T) {
 void ASTTypeWriter::VisitParenType(const ParenType *T) {
   Record.AddTypeRef(T->getInnerType());
   Code = TYPE_PAREN;
+  AbbrevToUse = Writer.TypeParenAbbrev;
 }
 
 void ASTTypeWriter::VisitMacroQualifiedType(const MacroQualifiedType *T) {
@@ -529,6 +536,9 @@ void ASTTypeWriter::VisitElaboratedType(const ElaboratedType *T) {
   Record.AddTypeRef(T->getNamedType());
   Record.AddDeclRef(T->getOwnedTagDecl());
   Code = TYPE_ELABORATED;
+  // The abbreviation only covers types without a qualifier.
+  if (!T->getQualifier())
+    AbbrevToUse = Writer.TypeElaboratedAbbrev;
 }
 
 void ASTTypeWriter::VisitInjectedClassNameType(const InjectedClassNameType *T) {
@@ -909,6 +919,61 @@ void ASTWriter::WriteTypeAbbrevs() {
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Params
   TypeFunctionProtoAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_POINTER
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_POINTER));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // PointeeType
+  TypePointerAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_LVALUE_REFERENCE
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_LVALUE_REFERENCE));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // PointeeType
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // SpelledAsLValue
+  TypeLValueReferenceAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_RVALUE_REFERENCE
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_RVALUE_REFERENCE));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // PointeeType
+  TypeRValueReferenceAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_TYPEDEF
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_TYPEDEF));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Decl
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // CanonicalType
+  TypeTypedefAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_RECORD
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_RECORD));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // IsDependent
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Decl
+  TypeRecordAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_ENUM
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_ENUM));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // IsDependent
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // Decl
+  TypeEnumAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_PAREN
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_PAREN));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // InnerType
+  TypeParenAbbrev = Stream.EmitAbbrev(std::move(Abv));
+
+  // Abbreviation for TYPE_ELABORATED without a qualifier
+  Abv = std::make_shared<BitCodeAbbrev>();
+  Abv->Add(BitCodeAbbrevOp(serialization::TYPE_ELABORATED));
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 3)); // Keyword
+  Abv->Add(BitCodeAbbrevOp(0));                         // Qualifier
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // NamedType
+  Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // OwnedTagDecl
+  TypeElaboratedAbbrev = Stream.EmitAbbrev(std::move(Abv));
 }
 
 //===----------------------------------------------------------------------===//
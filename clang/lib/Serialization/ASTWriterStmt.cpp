@@ -467,17 +467,15 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
   Record.push_back(E->hadMultipleCandidates());
   Record.push_back(E->refersToEnclosingVariableOrCapture());
   Record.push_back(E->isNonOdrUse());
+  Record.push_back(E->hasNameLoc());
 
   if (E->hasTemplateKWAndArgsInfo()) {
     unsigned NumTemplateArgs = E->getNumTemplateArgs();
     Record.push_back(NumTemplateArgs);
   }
 
-  DeclarationName::NameKind nk = (E->getDecl()->getDeclName().getNameKind());
-
   if ((!E->hasTemplateKWAndArgsInfo()) && (!E->hasQualifier()) &&
-      (E->getDecl() == E->getFoundDecl()) &&
-      nk == DeclarationName::Identifier &&
+      (E->getDecl() == E->getFoundDecl()) && !E->hasNameLoc() &&
       !E->refersToEnclosingVariableOrCapture() && !E->isNonOdrUse()) {
     AbbrevToUse = Writer.getDeclRefExprAbbrev();
   }
@@ -494,7 +492,9 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
 
   Record.AddDeclRef(E->getDecl());
   Record.AddSourceLocation(E->getLocation());
-  Record.AddDeclarationNameLoc(E->DNLoc, E->getDecl()->getDeclName());
+  if (E->hasNameLoc())
+    Record.AddDeclarationNameLoc(*E->getTrailingObjects<DeclarationNameLoc>(),
+                                 E->getDecl()->getDeclName());
   Code = serialization::EXPR_DECL_REF;
 }
 
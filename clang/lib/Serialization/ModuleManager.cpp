@@ -23,6 +23,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator.h"
@@ -31,6 +32,9 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <algorithm>
 #include <cassert>
@@ -183,6 +187,11 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
     llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf((std::error_code()));
     if (FileName == "-") {
       Buf = llvm::MemoryBuffer::getSTDIN();
+    } else if (std::unique_ptr<llvm::MemoryBuffer> Prefetched =
+                   takePrefetchedBuffer(FileName, Entry->getSize())) {
+      Buf = std::move(Prefetched);
+      // The descriptor opened while stat()ing the PCM above isn't needed.
+      Entry->closeFile();
     } else {
       // Get a buffer of the file and close the file descriptor when done.
       Buf = FileMgr.getBufferForFile(NewModule->File,
@@ -304,6 +313,75 @@ void ModuleManager::returnVisitState(VisitState *State) {
   FirstVisitState = State;
 }
 
+std::unique_ptr<llvm::MemoryBuffer>
+ModuleManager::takePrefetchedBuffer(StringRef FileName, off_t Size) {
+  auto Known = PrefetchedBuffers.find(FileName);
+  if (Known == PrefetchedBuffers.end())
+    return nullptr;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(Known->second);
+  PrefetchedBuffers.erase(Known);
+  // The file changed after it was prefetched; read it again.
+  if ((off_t)Buffer->getBufferSize() != Size)
+    return nullptr;
+  return Buffer;
+}
+
+void ModuleManager::prefetchModuleFiles(ArrayRef<StringRef> FileNames) {
+#if LLVM_ENABLE_THREADS
+  if (&FileMgr.getVirtualFileSystem() != llvm::vfs::getRealFileSystem().get())
+    return;
+
+  // Pairs of module file names and the paths to read them from.
+  SmallVector<std::pair<StringRef, SmallString<128>>, 8> Files;
+  for (StringRef FileName : FileNames) {
+    if (FileName == "-" || PrefetchedBuffers.count(FileName) ||
+        getModuleCache().lookupPCM(FileName) ||
+        getModuleCache().shouldBuildPCM(FileName))
+      continue;
+    SmallString<128> Path(FileName);
+    FileMgr.FixupRelativePath(Path);
+    Files.emplace_back(FileName, std::move(Path));
+  }
+  // There is nothing to overlap with a single file.
+  if (Files.size() < 2)
+    return;
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> Buffers(Files.size());
+  {
+    llvm::ThreadPool Pool(
+        std::min<unsigned>(Files.size(), llvm::hardware_concurrency()));
+    unsigned PageSize = llvm::sys::Process::getPageSizeEstimate();
+    for (unsigned I = 0, N = Files.size(); I != N; ++I) {
+      Pool.async([&, I] {
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf =
+            llvm::MemoryBuffer::getFile(Files[I].second);
+        if (!Buf)
+          return;
+        // Fault the mapped pages in on this thread, rather than one at a time
+        // while the reader validates the module.
+        volatile char Sink = 0;
+        for (const char *P = (*Buf)->getBufferStart(),
+                        *E = (*Buf)->getBufferEnd();
+             P < E; P += PageSize)
+          Sink = *P;
+        (void)Sink;
+        Buffers[I] = std::move(*Buf);
+      });
+    }
+    Pool.wait();
+  }
+
+  for (unsigned I = 0, N = Files.size(); I != N; ++I)
+    if (Buffers[I])
+      PrefetchedBuffers[Files[I].first] = std::move(Buffers[I]);
+#endif
+}
+
+void ModuleManager::dropPrefetchedModuleFiles(ArrayRef<StringRef> FileNames) {
+  for (StringRef FileName : FileNames)
+    PrefetchedBuffers.erase(FileName);
+}
+
 void ModuleManager::setGlobalIndex(GlobalModuleIndex *Index) {
   GlobalIndex = Index;
   if (!GlobalIndex) {
@@ -401,7 +401,7 @@ public:
     // only determined when they are instantiated.
     if (FD->isThisDeclarationADefinition() &&
         !FD->isDependentContext()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || !Mgr->shouldInlineCall());
       HandleCode(FD, RecVisitorMode);
     }
     return true;
@@ -409,7 +409,7 @@ public:
 
   bool VisitObjCMethodDecl(ObjCMethodDecl *MD) {
     if (MD->isThisDeclarationADefinition()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || !Mgr->shouldInlineCall());
       HandleCode(MD, RecVisitorMode);
     }
     return true;
@@ -417,7 +417,7 @@ public:
 
   bool VisitBlockDecl(BlockDecl *BD) {
     if (BD->hasBody()) {
-      assert(RecVisitorMode == AM_Syntax || Mgr->shouldInlineCall() == false);
+      assert(!(RecVisitorMode & AM_Path) || !Mgr->shouldInlineCall());
       // Since we skip function template definitions, we should skip blocks
       // declared in those functions as well.
       if (!BD->isDependentContext()) {
@@ -531,13 +531,20 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // inlined functions. The topological order allows the "do not reanalyze
   // previously inlined function" performance heuristic to be triggered more
   // often.
+  //
+  // When the analysis is split into shards, each shard only analyzes every
+  // ShardCount'th function in this order. As the shards do not know which
+  // functions the others inlined, a function may be analyzed as top level by
+  // a shard even though the whole analysis would have skipped it; this costs
+  // time but no coverage.
+  const unsigned ShardCount = Mgr->options.ShardCount;
+  const unsigned ShardIndex = Mgr->options.ShardIndex;
+  unsigned FunctionIndex = 0;
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
-    NumFunctionTopLevel++;
-
     CallGraphNode *N = *I;
     Decl *D = N->getDecl();
 
@@ -545,6 +552,12 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Skip the functions analyzed by the other shards.
+    if (ShardCount > 1 && FunctionIndex++ % ShardCount != ShardIndex)
+      continue;
+
+    NumFunctionTopLevel++;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -578,17 +591,24 @@ static bool isBisonFile(ASTContext &C) {
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->stopTimer();
+
+  // Only the first shard runs the checks that are not about a single top level
+  // function, so that merging the reports of all shards does not duplicate
+  // them.
+  const bool IsFirstShard = Mgr->options.ShardIndex == 0;
+  if (IsFirstShard) {
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->startTimer();
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->stopTimer();
+  }
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
   // sensitive analyzes as well.
-  RecVisitorMode = AM_Syntax;
-  if (!Mgr->shouldInlineCall())
+  RecVisitorMode = IsFirstShard ? AM_Syntax : AM_None;
+  if (!Mgr->shouldInlineCall() && IsFirstShard)
     RecVisitorMode |= AM_Path;
   RecVisitorBR = &BR;
 
@@ -607,7 +627,8 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (IsFirstShard)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   RecVisitorBR = nullptr;
 }
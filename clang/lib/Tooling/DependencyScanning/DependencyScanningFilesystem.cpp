@@ -42,6 +42,7 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     // if the minimization failed.
     // FIXME: Propage the diagnostic if desired by the client.
     CachedFileSystemEntry Result;
+    Result.OriginalSize = Stat->getSize();
     Result.MaybeStat = std::move(*Stat);
     Result.Contents.reserve(Buffer->getBufferSize() + 1);
     Result.Contents.append(Buffer->getBufferStart(), Buffer->getBufferEnd());
@@ -52,6 +53,7 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
   }
 
   CachedFileSystemEntry Result;
+  Result.OriginalSize = Stat->getSize();
   size_t Size = MinimizedFileContents.size();
   Result.MaybeStat = llvm::vfs::Status(Stat->getName(), Stat->getUniqueID(),
                                        Stat->getLastModificationTime(),
@@ -76,10 +78,23 @@ CachedFileSystemEntry
 CachedFileSystemEntry::createDirectoryEntry(llvm::vfs::Status &&Stat) {
   assert(Stat.isDirectory() && "not a directory!");
   auto Result = CachedFileSystemEntry();
+  Result.OriginalSize = Stat.getSize();
   Result.MaybeStat = std::move(Stat);
   return Result;
 }
 
+bool CachedFileSystemEntry::isUpToDate(
+    const llvm::ErrorOr<llvm::vfs::Status> &Stat) const {
+  assert(isValid() && "not initialized");
+  if (!MaybeStat || !Stat)
+    return !MaybeStat && !Stat && MaybeStat.getError() == Stat.getError();
+  return MaybeStat->getUniqueID() == Stat->getUniqueID() &&
+         MaybeStat->getType() == Stat->getType() &&
+         MaybeStat->getLastModificationTime() ==
+             Stat->getLastModificationTime() &&
+         OriginalSize == Stat->getSize();
+}
+
 DependencyScanningFilesystemSharedCache::
     DependencyScanningFilesystemSharedCache() {
   // This heuristic was chosen using a empirical testing on a
@@ -103,6 +118,26 @@ DependencyScanningFilesystemSharedCache::get(StringRef Key) {
   return It.first->getValue();
 }
 
+CachedFileSystemEntry &
+DependencyScanningWorkerFilesystem::getValidatedSharedEntry(
+    StringRef Filename,
+    DependencyScanningFilesystemSharedCache::SharedFileSystemEntry
+        &SharedCacheEntry) {
+  CachedFileSystemEntry &CacheEntry = SharedCacheEntry.Value;
+  unsigned CurrentGeneration = SharedCache.getGeneration();
+  if (SharedCacheEntry.Generation == CurrentGeneration)
+    return CacheEntry;
+
+  // The entry was cached by an earlier generation, so the file might have
+  // changed since. No worker from the current generation can be referencing
+  // the old value yet, so it's safe to replace it.
+  if (CacheEntry.isValid() &&
+      !CacheEntry.isUpToDate(getUnderlyingFS().status(Filename)))
+    CacheEntry = CachedFileSystemEntry();
+  SharedCacheEntry.Generation = CurrentGeneration;
+  return CacheEntry;
+}
+
 llvm::ErrorOr<llvm::vfs::Status>
 DependencyScanningWorkerFilesystem::status(const Twine &Path) {
   SmallString<256> OwnedFilename;
@@ -121,7 +156,8 @@ DependencyScanningWorkerFilesystem::status(const Twine &Path) {
   const CachedFileSystemEntry *Result;
   {
     std::unique_lock<std::mutex> LockGuard(SharedCacheEntry.ValueLock);
-    CachedFileSystemEntry &CacheEntry = SharedCacheEntry.Value;
+    CachedFileSystemEntry &CacheEntry =
+        getValidatedSharedEntry(Filename, SharedCacheEntry);
 
     if (!CacheEntry.isValid()) {
       llvm::vfs::FileSystem &FS = getUnderlyingFS();
@@ -202,7 +238,8 @@ DependencyScanningWorkerFilesystem::openFileForRead(const Twine &Path) {
   const CachedFileSystemEntry *Result;
   {
     std::unique_lock<std::mutex> LockGuard(SharedCacheEntry.ValueLock);
-    CachedFileSystemEntry &CacheEntry = SharedCacheEntry.Value;
+    CachedFileSystemEntry &CacheEntry =
+        getValidatedSharedEntry(Filename, SharedCacheEntry);
 
     if (!CacheEntry.isValid()) {
       CacheEntry = CachedFileSystemEntry::createFileEntry(
@@ -13,4 +13,4 @@ using namespace tooling;
 using namespace dependencies;
 
 DependencyScanningService::DependencyScanningService(ScanningMode Mode)
-    : Mode(Mode) {}
+    : Mode(Mode), IncludeGuards(std::make_shared<IncludeGuardCache>()) {}
@@ -12,6 +12,7 @@
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/Tooling.h"
 
@@ -64,12 +65,16 @@ private:
 /// dependency scanning for the given compiler invocation.
 class DependencyScanningAction : public tooling::ToolAction {
 public:
+  using CreateCollectorFn = llvm::function_ref<std::shared_ptr<
+      DependencyCollector>(CompilerInstance &Compiler,
+                           std::unique_ptr<DependencyOutputOptions> Opts)>;
+
   DependencyScanningAction(
-      StringRef WorkingDirectory, std::string &DependencyFileContents,
-      llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS)
-      : WorkingDirectory(WorkingDirectory),
-        DependencyFileContents(DependencyFileContents),
-        DepFS(std::move(DepFS)) {}
+      StringRef WorkingDirectory, CreateCollectorFn CreateCollector,
+      llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS,
+      std::shared_ptr<IncludeGuardCache> IncludeGuards)
+      : WorkingDirectory(WorkingDirectory), CreateCollector(CreateCollector),
+        DepFS(std::move(DepFS)), IncludeGuards(std::move(IncludeGuards)) {}
 
   bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
                      FileManager *FileMgr,
@@ -105,6 +110,9 @@ public:
           CI, Compiler.getDiagnostics(), DepFS));
     }
 
+    // Skip the headers whose guards other scans already found defined.
+    Compiler.getPreprocessorOpts().IncludeGuards = IncludeGuards;
+
     FileMgr->getFileSystemOpts().WorkingDir = WorkingDirectory;
     Compiler.setFileManager(FileMgr);
     Compiler.createSourceManager(*FileMgr);
@@ -121,8 +129,7 @@ public:
     // We need at least one -MT equivalent for the generator to work.
     if (Opts->Targets.empty())
       Opts->Targets = {"clang-scan-deps dependency"};
-    Compiler.addDependencyCollector(std::make_shared<DependencyPrinter>(
-        std::move(Opts), DependencyFileContents));
+    Compiler.addDependencyCollector(CreateCollector(Compiler, std::move(Opts)));
 
     auto Action = std::make_unique<PreprocessOnlyAction>();
     const bool Result = Compiler.ExecuteAction(*Action);
@@ -133,15 +140,16 @@ public:
 
 private:
   StringRef WorkingDirectory;
-  /// The dependency file will be written to this string.
-  std::string &DependencyFileContents;
+  CreateCollectorFn CreateCollector;
   llvm::IntrusiveRefCntPtr<DependencyScanningWorkerFilesystem> DepFS;
+  std::shared_ptr<IncludeGuardCache> IncludeGuards;
 };
 
 } // end anonymous namespace
 
 DependencyScanningWorker::DependencyScanningWorker(
-    DependencyScanningService &Service) {
+    DependencyScanningService &Service)
+    : IncludeGuards(Service.getIncludeGuards()) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
   RealFS = new ProxyFileSystemWithoutChdir(llvm::vfs::getRealFileSystem());
@@ -150,10 +158,11 @@ DependencyScanningWorker::DependencyScanningWorker(
                                                    RealFS);
 }
 
-llvm::Expected<std::string>
-DependencyScanningWorker::getDependencyFile(const std::string &Input,
-                                            StringRef WorkingDirectory,
-                                            const CompilationDatabase &CDB) {
+llvm::Error
+DependencyScanningWorker::runScan(const std::string &Input,
+                                  StringRef WorkingDirectory,
+                                  const CompilationDatabase &CDB,
+                                  CreateCollectorFn CreateCollector) {
   // Capture the emitted diagnostics and report them to the client
   // in the case of a failure.
   std::string DiagnosticOutput;
@@ -169,11 +178,38 @@ DependencyScanningWorker::getDependencyFile(const std::string &Input,
   Tool.setRestoreWorkingDir(false);
   Tool.setPrintErrorMessage(false);
   Tool.setDiagnosticConsumer(&DiagPrinter);
-  std::string Output;
-  DependencyScanningAction Action(WorkingDirectory, Output, DepFS);
+  DependencyScanningAction Action(WorkingDirectory, CreateCollector, DepFS,
+                                  IncludeGuards);
   if (Tool.run(&Action)) {
     return llvm::make_error<llvm::StringError>(DiagnosticsOS.str(),
                                                llvm::inconvertibleErrorCode());
   }
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::string>
+DependencyScanningWorker::getDependencyFile(const std::string &Input,
+                                            StringRef WorkingDirectory,
+                                            const CompilationDatabase &CDB) {
+  std::string Output;
+  if (llvm::Error E = runScan(
+          Input, WorkingDirectory, CDB,
+          [&](CompilerInstance &,
+              std::unique_ptr<DependencyOutputOptions> Opts) {
+            return std::make_shared<DependencyPrinter>(std::move(Opts),
+                                                       Output);
+          }))
+    return std::move(E);
   return Output;
 }
+
+llvm::Error DependencyScanningWorker::computeDependencies(
+    const std::string &Input, StringRef WorkingDirectory,
+    const CompilationDatabase &CDB, DependencyConsumer &Consumer) {
+  return runScan(Input, WorkingDirectory, CDB,
+                 [&](CompilerInstance &Compiler,
+                     std::unique_ptr<DependencyOutputOptions> Opts) {
+                   return std::make_shared<ModuleDepCollector>(Compiler,
+                                                               Consumer);
+                 });
+}
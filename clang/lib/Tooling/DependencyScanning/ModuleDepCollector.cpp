@@ -0,0 +1,153 @@
+//===- ModuleDepCollector.cpp - Callbacks to collect deps -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/DependencyScanning/ModuleDepCollector.h"
+#include "clang/Basic/Module.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Serialization/ASTReader.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
+
+using namespace clang;
+using namespace tooling;
+using namespace dependencies;
+
+std::vector<std::string> ModuleDeps::getCC1CommandLine(
+    StringRef OutputPath,
+    llvm::function_ref<std::string(StringRef ModuleName)> LookupPCMPath)
+    const {
+  std::vector<std::string> Args = {"-emit-module",
+                                   "-fmodule-name=" + ModuleName,
+                                   "-fno-implicit-modules",
+                                   "-fno-implicit-module-maps"};
+  for (const std::string &Dep : ClangModuleDeps)
+    Args.push_back("-fmodule-file=" + LookupPCMPath(Dep));
+  Args.push_back("-x");
+  Args.push_back(ModuleMapLanguage + "-module-map");
+  Args.push_back(ClangModuleMapFile);
+  Args.push_back("-o");
+  Args.push_back(OutputPath);
+  return Args;
+}
+
+namespace {
+
+/// Forwards the imports seen by the preprocessor to the collector.
+class ModuleDepCollectorPP final : public PPCallbacks {
+public:
+  ModuleDepCollectorPP(ModuleDepCollector &MDC) : MDC(MDC) {}
+
+  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
+                          StringRef FileName, bool IsAngled,
+                          CharSourceRange FilenameRange, const FileEntry *File,
+                          StringRef SearchPath, StringRef RelativePath,
+                          const Module *Imported,
+                          SrcMgr::CharacteristicKind FileType) override {
+    if (Imported)
+      MDC.addDirectImport(Imported);
+  }
+
+  void moduleImport(SourceLocation ImportLoc, ModuleIdPath Path,
+                    const Module *Imported) override {
+    if (Imported)
+      MDC.addDirectImport(Imported);
+  }
+
+private:
+  ModuleDepCollector &MDC;
+};
+
+} // end anonymous namespace
+
+/// Returns the language that module maps are parsed in for \p LangOpts.
+static StringRef getModuleMapLanguage(const LangOptions &LangOpts) {
+  if (LangOpts.ObjC)
+    return LangOpts.CPlusPlus ? "objective-c++" : "objective-c";
+  return LangOpts.CPlusPlus ? "c++" : "c";
+}
+
+ModuleDepCollector::ModuleDepCollector(CompilerInstance &Instance,
+                                       DependencyConsumer &Consumer)
+    : Instance(Instance), Consumer(Consumer),
+      ContextHash(Instance.getInvocation().getModuleHash()) {}
+
+void ModuleDepCollector::attachToPreprocessor(Preprocessor &PP) {
+  DependencyCollector::attachToPreprocessor(PP);
+  PP.addPPCallbacks(std::make_unique<ModuleDepCollectorPP>(*this));
+}
+
+bool ModuleDepCollector::sawDependency(StringRef Filename, bool FromModule,
+                                       bool IsSystem, bool IsModuleFile,
+                                       bool IsMissing) {
+  // Files from imported modules are reported with the module itself.
+  if (FromModule || IsModuleFile || IsMissing)
+    return false;
+  return DependencyCollector::sawDependency(Filename, FromModule, IsSystem,
+                                            IsModuleFile, IsMissing);
+}
+
+void ModuleDepCollector::addDirectImport(const Module *M) {
+  DirectModules.insert(M->getTopLevelModule());
+}
+
+void ModuleDepCollector::finishedMainFile(DiagnosticsEngine &Diags) {
+  Consumer.handleContextHash(ContextHash);
+  for (const std::string &Dep : getDependencies())
+    Consumer.handleFileDependency(Dep);
+  for (const Module *M : DirectModules) {
+    handleTopLevelModule(M);
+    Consumer.handleDirectModuleDependency(M->getFullModuleName());
+  }
+}
+
+void ModuleDepCollector::handleTopLevelModule(const Module *M) {
+  assert(M == M->getTopLevelModule() && "expected a top-level module");
+  if (!ReportedModules.insert(M).second)
+    return;
+  // Only modules that were loaded from a PCM have anything to report.
+  const FileEntry *ASTFile = M->getASTFile();
+  IntrusiveRefCntPtr<ASTReader> Reader = Instance.getModuleManager();
+  if (!ASTFile || !Reader)
+    return;
+
+  ModuleDeps MD;
+  MD.ModuleName = M->getFullModuleName();
+  MD.ContextHash = ContextHash;
+  if (const FileEntry *ModuleMap = Instance.getPreprocessor()
+                                       .getHeaderSearchInfo()
+                                       .getModuleMap()
+                                       .getModuleMapFileForUniquing(M))
+    MD.ClangModuleMapFile = ModuleMap->getName();
+  MD.ImplicitModulePCMPath = ASTFile->getName();
+  MD.ModuleMapLanguage = getModuleMapLanguage(Instance.getLangOpts());
+
+  if (serialization::ModuleFile *MF =
+          Reader->getModuleManager().lookup(ASTFile))
+    Reader->visitInputFiles(
+        *MF, /*IncludeSystem=*/true, /*Complain=*/false,
+        [&](const serialization::InputFile &IF, bool IsSystem) {
+          if (const FileEntry *File = IF.getFile())
+            MD.FileDeps.insert(File->getName());
+        });
+
+  addModuleImports(M, MD);
+  Consumer.handleModuleDependency(std::move(MD));
+}
+
+void ModuleDepCollector::addModuleImports(const Module *M, ModuleDeps &MD) {
+  for (const Module *Import : M->Imports) {
+    const Module *TopLevel = Import->getTopLevelModule();
+    if (TopLevel == M->getTopLevelModule())
+      continue;
+    MD.ClangModuleDeps.insert(TopLevel->getFullModuleName());
+    handleTopLevelModule(TopLevel);
+  }
+  for (const Module *SubM : M->submodules())
+    addModuleImports(SubM, MD);
+}
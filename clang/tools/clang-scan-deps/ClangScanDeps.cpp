@@ -11,14 +11,27 @@
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Options.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Threading.h"
+#include <map>
 #include <mutex>
 #include <thread>
 
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 using namespace clang;
 using namespace tooling::dependencies;
 
@@ -38,6 +51,114 @@ private:
   raw_ostream &OS;
 };
 
+/// Collects the dependencies of a single translation unit.
+class FullDependencyConsumer : public DependencyConsumer {
+public:
+  void handleFileDependency(StringRef Filename) override {
+    FileDeps.push_back(Filename.str());
+  }
+
+  void handleDirectModuleDependency(StringRef ModuleName) override {
+    DirectModuleDeps.push_back(ModuleName.str());
+  }
+
+  void handleModuleDependency(ModuleDeps MD) override {
+    Modules.push_back(std::move(MD));
+  }
+
+  void handleContextHash(std::string Hash) override {
+    ContextHash = std::move(Hash);
+  }
+
+  std::vector<std::string> FileDeps;
+  std::vector<std::string> DirectModuleDeps;
+  std::vector<ModuleDeps> Modules;
+  std::string ContextHash;
+};
+
+/// Merges the dependencies of all the scanned translation units into a single
+/// graph, in which every module appears once per context hash, and prints it
+/// as JSON.
+class FullDeps {
+public:
+  void mergeDeps(StringRef Input, FullDependencyConsumer &&TUDeps) {
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    for (ModuleDeps &MD : TUDeps.Modules) {
+      ModuleKey Key(MD.ModuleName, MD.ContextHash);
+      Modules.emplace(std::move(Key), std::move(MD));
+    }
+    TranslationUnits[Input] = std::move(TUDeps);
+  }
+
+  void printFullOutput(raw_ostream &OS) {
+    using namespace llvm::json;
+    Array OutModules;
+    for (const auto &Entry : Modules) {
+      const ModuleDeps &MD = Entry.second;
+      auto LookupPCMPath = [&](StringRef ModuleName) {
+        return lookupPCMPath(ModuleName, MD.ContextHash);
+      };
+      OutModules.push_back(Object{
+          {"name", MD.ModuleName},
+          {"context-hash", MD.ContextHash},
+          {"clang-modulemap-file", MD.ClangModuleMapFile},
+          {"pcm-path", MD.ImplicitModulePCMPath},
+          {"clang-module-deps", toJSONArray(MD.ClangModuleDeps)},
+          {"file-deps", toJSONArray(MD.FileDeps)},
+          {"cc1-command-line",
+           toJSONArray(MD.getCC1CommandLine(MD.ImplicitModulePCMPath,
+                                            LookupPCMPath))},
+      });
+    }
+
+    Array OutTUs;
+    for (const auto &Entry : TranslationUnits) {
+      const FullDependencyConsumer &TU = Entry.second;
+      // The extra arguments that make the translation unit use the explicitly
+      // built modules instead of building them implicitly.
+      std::vector<std::string> CommandLine = {"-fno-implicit-modules",
+                                              "-fno-implicit-module-maps"};
+      for (const std::string &Dep : TU.DirectModuleDeps)
+        CommandLine.push_back("-fmodule-file=" +
+                              lookupPCMPath(Dep, TU.ContextHash));
+      OutTUs.push_back(Object{
+          {"input-file", Entry.first},
+          {"clang-context-hash", TU.ContextHash},
+          {"clang-module-deps", toJSONArray(TU.DirectModuleDeps)},
+          {"file-deps", toJSONArray(TU.FileDeps)},
+          {"command-line", toJSONArray(CommandLine)},
+      });
+    }
+
+    Object Output{{"modules", std::move(OutModules)},
+                  {"translation-units", std::move(OutTUs)}};
+    OS << llvm::formatv("{0:2}\n", Value(std::move(Output)));
+  }
+
+private:
+  using ModuleKey = std::pair<std::string, std::string>;
+
+  template <typename Container>
+  static llvm::json::Array toJSONArray(const Container &Strings) {
+    llvm::json::Array Result;
+    for (const std::string &S : Strings)
+      Result.push_back(S);
+    return Result;
+  }
+
+  std::string lookupPCMPath(StringRef ModuleName, StringRef ContextHash) const {
+    auto It = Modules.find(ModuleKey(ModuleName, ContextHash));
+    return It == Modules.end() ? std::string()
+                               : It->second.ImplicitModulePCMPath;
+  }
+
+  std::mutex Lock;
+  // Both maps are ordered so that the output is deterministic regardless of
+  // the order in which the workers finish.
+  std::map<ModuleKey, ModuleDeps> Modules;
+  std::map<std::string, FullDependencyConsumer> TranslationUnits;
+};
+
 /// The high-level implementation of the dependency discovery tool that runs on
 /// an individual worker thread.
 class DependencyScanningTool {
@@ -46,35 +167,64 @@ public:
   ///
   /// \param Compilations     The reference to the compilation database that's
   /// used by the clang tool.
+  /// \param Full             Receives the module dependency graph instead of
+  /// printing Makefile-style dependencies to \p OS, if not null.
   DependencyScanningTool(DependencyScanningService &Service,
                          const tooling::CompilationDatabase &Compilations,
-                         SharedStream &OS, SharedStream &Errs)
-      : Worker(Service), Compilations(Compilations), OS(OS), Errs(Errs) {}
+                         SharedStream &OS, SharedStream &Errs,
+                         FullDeps *Full = nullptr)
+      : Worker(Service), Compilations(Compilations), OS(OS), Errs(Errs),
+        Full(Full) {}
 
   /// Computes the dependencies for the given file and prints them out.
   ///
   /// \returns True on error.
   bool runOnFile(const std::string &Input, StringRef CWD) {
-    auto MaybeFile = Worker.getDependencyFile(Input, CWD, Compilations);
-    if (!MaybeFile) {
-      llvm::handleAllErrors(
-          MaybeFile.takeError(), [this, &Input](llvm::StringError &Err) {
-            Errs.applyLocked([&](raw_ostream &OS) {
-              OS << "Error while scanning dependencies for " << Input << ":\n";
-              OS << Err.getMessage();
-            });
-          });
-      return true;
+    if (Full) {
+      FullDependencyConsumer Consumer;
+      if (llvm::Error E =
+              Worker.computeDependencies(Input, CWD, Compilations, Consumer))
+        return handleError(std::move(E), Input);
+      Full->mergeDeps(Input, std::move(Consumer));
+      return false;
     }
+
+    auto MaybeFile = Worker.getDependencyFile(Input, CWD, Compilations);
+    if (!MaybeFile)
+      return handleError(MaybeFile.takeError(), Input);
     OS.applyLocked([&](raw_ostream &OS) { OS << *MaybeFile; });
     return false;
   }
 
 private:
+  /// Prints out the diagnostics of a failed scan.
+  ///
+  /// \returns True.
+  bool handleError(llvm::Error E, const std::string &Input) {
+    llvm::handleAllErrors(
+        std::move(E), [this, &Input](llvm::StringError &Err) {
+          Errs.applyLocked([&](raw_ostream &OS) {
+            OS << "Error while scanning dependencies for " << Input << ":\n";
+            OS << Err.getMessage();
+          });
+        });
+    return true;
+  }
+
   DependencyScanningWorker Worker;
   const tooling::CompilationDatabase &Compilations;
   SharedStream &OS;
   SharedStream &Errs;
+  FullDeps *Full;
+};
+
+enum class ScanningOutputFormat {
+  /// Makefile-style dependencies for every translation unit.
+  Make,
+
+  /// A JSON graph of the translation units and the Clang modules they depend
+  /// on, which a build system can use to build the modules explicitly.
+  Full,
 };
 
 llvm::cl::opt<bool> Help("h", llvm::cl::desc("Alias for -help"),
@@ -96,6 +246,17 @@ static llvm::cl::opt<ScanningMode> ScanMode(
                    "unmodified source files")),
     llvm::cl::init(ScanningMode::MinimizedSourcePreprocessing));
 
+static llvm::cl::opt<ScanningOutputFormat> Format(
+    "format", llvm::cl::desc("The output format for the dependencies"),
+    llvm::cl::values(clEnumValN(ScanningOutputFormat::Make, "make",
+                                "Makefile compatible dep file"),
+                     clEnumValN(ScanningOutputFormat::Full, "experimental-full",
+                                "Full dependency graph suitable"
+                                " for explicitly building modules. This format "
+                                "is experimental and will change.")),
+    llvm::cl::init(ScanningOutputFormat::Make),
+    llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<unsigned>
     NumThreads("j", llvm::cl::Optional,
                llvm::cl::desc("Number of worker threads to use (default: use "
@@ -104,33 +265,30 @@ llvm::cl::opt<unsigned>
 
 llvm::cl::opt<std::string>
     CompilationDB("compilation-database",
-                  llvm::cl::desc("Compilation database"), llvm::cl::Required,
+                  llvm::cl::desc("Compilation database"),
                   llvm::cl::cat(DependencyScannerCategory));
 
-} // end anonymous namespace
+llvm::cl::opt<std::string> ServerSocket(
+    "server",
+    llvm::cl::desc("Run as a daemon that listens for scan requests on the "
+                   "given Unix domain socket. A client sends the path of a "
+                   "compilation database followed by a newline and receives "
+                   "the dependencies followed by an 'exit-status: <n>' line. "
+                   "The file system cache is kept between requests and "
+                   "revalidated with stat for every request"),
+    llvm::cl::value_desc("path"), llvm::cl::cat(DependencyScannerCategory));
 
-int main(int argc, const char **argv) {
-  llvm::InitLLVM X(argc, argv);
-  llvm::cl::HideUnrelatedOptions(DependencyScannerCategory);
-  if (!llvm::cl::ParseCommandLineOptions(argc, argv))
-    return 1;
+} // end anonymous namespace
 
-  std::string ErrorMessage;
+/// Load the compilation database at \p Path and rewrite its commands to run
+/// Clang in preprocessor only mode.
+static std::unique_ptr<tooling::CompilationDatabase>
+loadCompilations(StringRef Path, std::string &ErrorMessage) {
   std::unique_ptr<tooling::JSONCompilationDatabase> Compilations =
       tooling::JSONCompilationDatabase::loadFromFile(
-          CompilationDB, ErrorMessage,
-          tooling::JSONCommandLineSyntax::AutoDetect);
-  if (!Compilations) {
-    llvm::errs() << "error: " << ErrorMessage << "\n";
-    return 1;
-  }
-
-  llvm::cl::PrintOptionValues();
-
-  // By default the tool runs on all inputs in the CDB.
-  std::vector<std::pair<std::string, std::string>> Inputs;
-  for (const auto &Command : Compilations->getAllCompileCommands())
-    Inputs.emplace_back(Command.Filename, Command.Directory);
+          Path, ErrorMessage, tooling::JSONCommandLineSyntax::AutoDetect);
+  if (!Compilations)
+    return nullptr;
 
   // The command options are rewritten to run Clang in preprocessor only mode.
   auto AdjustingCompilations =
@@ -148,30 +306,42 @@ int main(int argc, const char **argv) {
         AdjustedArgs.push_back("-Wno-error");
         return AdjustedArgs;
       });
+  return std::move(AdjustingCompilations);
+}
 
-  SharedStream Errs(llvm::errs());
-  // Print out the dependency results to STDOUT by default.
-  SharedStream DependencyOS(llvm::outs());
-
-  DependencyScanningService Service(ScanMode);
+static unsigned getNumWorkers() {
 #if LLVM_ENABLE_THREADS
-  unsigned NumWorkers =
-      NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
+  return NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
 #else
-  unsigned NumWorkers = 1;
+  return 1;
 #endif
+}
+
+/// Scan all of the inputs in the compilation database using \p NumWorkers
+/// workers that share the cache of \p Service.
+///
+/// \returns True on error.
+static bool scanCompilations(DependencyScanningService &Service,
+                             const tooling::CompilationDatabase &Compilations,
+                             unsigned NumWorkers, SharedStream &DependencyOS,
+                             SharedStream &Errs) {
+  // By default the tool runs on all inputs in the CDB.
+  std::vector<std::pair<std::string, std::string>> Inputs;
+  for (const auto &Command : Compilations.getAllCompileCommands())
+    Inputs.emplace_back(Command.Filename, Command.Directory);
+
+  FullDeps Full;
+  FullDeps *FullOrNull = Format == ScanningOutputFormat::Full ? &Full : nullptr;
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < NumWorkers; ++I)
     WorkerTools.push_back(std::make_unique<DependencyScanningTool>(
-        Service, *AdjustingCompilations, DependencyOS, Errs));
+        Service, Compilations, DependencyOS, Errs, FullOrNull));
 
   std::vector<std::thread> WorkerThreads;
   std::atomic<bool> HadErrors(false);
   std::mutex Lock;
   size_t Index = 0;
 
-  llvm::outs() << "Running clang-scan-deps on " << Inputs.size()
-               << " files using " << NumWorkers << " workers\n";
   for (unsigned I = 0; I < NumWorkers; ++I) {
     auto Worker = [I, &Lock, &Index, &Inputs, &HadErrors, &WorkerTools]() {
       while (true) {
@@ -201,5 +371,124 @@ int main(int argc, const char **argv) {
   for (auto &W : WorkerThreads)
     W.join();
 
+  if (FullOrNull)
+    DependencyOS.applyLocked(
+        [&](raw_ostream &OS) { FullOrNull->printFullOutput(OS); });
   return HadErrors;
 }
+
+#ifdef LLVM_ON_UNIX
+/// Serve scan requests on the Unix domain socket at \p SocketPath until the
+/// process is killed.
+///
+/// Requests are handled one at a time, so that each one can start a new
+/// generation of the shared file system cache.
+///
+/// \returns 1 if the socket could not be set up.
+static int runServer(DependencyScanningService &Service, StringRef SocketPath,
+                     unsigned NumWorkers) {
+  sockaddr_un Addr = {};
+  Addr.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Addr.sun_path)) {
+    llvm::errs() << "error: socket path is too long: " << SocketPath << "\n";
+    return 1;
+  }
+  memcpy(Addr.sun_path, SocketPath.data(), SocketPath.size());
+
+  int ListenFD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ListenFD < 0) {
+    llvm::errs() << "error: cannot create socket: " << strerror(errno) << "\n";
+    return 1;
+  }
+  ::unlink(Addr.sun_path);
+  if (::bind(ListenFD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) ||
+      ::listen(ListenFD, SOMAXCONN)) {
+    llvm::errs() << "error: cannot listen on " << SocketPath << ": "
+                 << strerror(errno) << "\n";
+    ::close(ListenFD);
+    return 1;
+  }
+  // A client that goes away mid-reply must not take the daemon with it.
+  ::signal(SIGPIPE, SIG_IGN);
+
+  while (true) {
+    int FD = ::accept(ListenFD, nullptr, nullptr);
+    if (FD < 0) {
+      if (errno == EINTR)
+        continue;
+      llvm::errs() << "error: accept failed: " << strerror(errno) << "\n";
+      ::close(ListenFD);
+      return 1;
+    }
+
+    // Read the path of the compilation database up to the first newline.
+    std::string Request;
+    char C;
+    while (::read(FD, &C, 1) == 1 && C != '\n')
+      Request.push_back(C);
+
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    SharedStream ReplyOS(OS);
+    std::string ErrorMessage;
+    std::unique_ptr<tooling::CompilationDatabase> Compilations =
+        loadCompilations(Request, ErrorMessage);
+    bool HadErrors;
+    if (!Compilations) {
+      OS << "error: " << ErrorMessage << "\n";
+      HadErrors = true;
+    } else {
+      // Files might have changed on disk since the previous request.
+      Service.getSharedCache().startNewGeneration();
+      HadErrors = scanCompilations(Service, *Compilations, NumWorkers, ReplyOS,
+                                   ReplyOS);
+    }
+    OS << "exit-status: " << HadErrors << "\n";
+  }
+}
+#endif
+
+int main(int argc, const char **argv) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::HideUnrelatedOptions(DependencyScannerCategory);
+  if (!llvm::cl::ParseCommandLineOptions(argc, argv))
+    return 1;
+
+  llvm::cl::PrintOptionValues();
+
+  DependencyScanningService Service(ScanMode);
+  unsigned NumWorkers = getNumWorkers();
+
+  if (!ServerSocket.empty()) {
+#ifdef LLVM_ON_UNIX
+    return runServer(Service, ServerSocket, NumWorkers);
+#else
+    llvm::errs() << "error: -server is only supported on Unix\n";
+    return 1;
+#endif
+  }
+
+  if (CompilationDB.empty()) {
+    llvm::errs() << "error: -compilation-database is required\n";
+    return 1;
+  }
+
+  std::string ErrorMessage;
+  std::unique_ptr<tooling::CompilationDatabase> Compilations =
+      loadCompilations(CompilationDB, ErrorMessage);
+  if (!Compilations) {
+    llvm::errs() << "error: " << ErrorMessage << "\n";
+    return 1;
+  }
+
+  SharedStream Errs(llvm::errs());
+  // Print out the dependency results to STDOUT by default.
+  SharedStream DependencyOS(llvm::outs());
+
+  // Keep the full output valid JSON.
+  if (Format == ScanningOutputFormat::Make)
+    llvm::outs() << "Running clang-scan-deps on "
+                 << Compilations->getAllCompileCommands().size()
+                 << " files using " << NumWorkers << " workers\n";
+  return scanCompilations(Service, *Compilations, NumWorkers, DependencyOS,
+                          Errs);
+}
@@ -0,0 +1,314 @@
+//===-- cc1server_main.cpp - Clang -cc1 compilation server ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1server functionality, which runs
+// the -cc1 jobs of drivers started with CLANG_CC1_SERVER set on threads of one
+// long-lived process, so that each job does not pay for process startup and
+// target initialization.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/Stack.h"
+#include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/FrontendTool/Utils.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace clang;
+
+#ifdef LLVM_ON_UNIX
+namespace {
+/// A -cc1 job sent by a driver.
+struct CC1Request {
+  /// The clang executable the driver would have run the job with.
+  std::string Executable;
+  /// The working directory of the driver.
+  std::string WorkingDir;
+  /// The -cc1 arguments, without the leading "-cc1".
+  std::vector<std::string> Args;
+};
+
+/// State shared by all the jobs of the server.
+struct CC1Server {
+  const char *Argv0;
+  void *MainAddr;
+  /// The real path of this executable.
+  SmallString<256> Executable;
+  /// The working directory of the server, which must be the one of every job.
+  SmallString<256> WorkingDir;
+};
+} // end anonymous namespace
+
+static void LLVMErrorHandler(void *UserData, const std::string &Message,
+                             bool GenCrashDiag) {
+  // Abandon the job; the driver runs it again in a process of its own, which
+  // reports the error and exits with the right status.
+  if (llvm::CrashRecoveryContext *CRC =
+          llvm::CrashRecoveryContext::GetCurrent())
+    CRC->HandleCrash();
+
+  llvm::errs() << "error: " << Message << "\n";
+  exit(GenCrashDiag ? 70 : 1);
+}
+
+/// Read a request from \p FD: a sequence of NUL-terminated strings holding
+/// the executable, the working directory and then the -cc1 arguments, ended
+/// by the driver shutting down its side of the connection.
+static bool readRequest(int FD, CC1Request &Request) {
+  std::vector<std::string> Fields(1);
+  char Buffer[4096];
+  while (true) {
+    ssize_t N = ::read(FD, Buffer, sizeof(Buffer));
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N < 0)
+      return false;
+    if (N == 0)
+      break;
+    for (char C : llvm::makeArrayRef(Buffer, N)) {
+      if (C == '\0')
+        Fields.emplace_back();
+      else
+        Fields.back().push_back(C);
+    }
+  }
+
+  // Every field, including the last one, is NUL-terminated.
+  if (Fields.size() < 3 || !Fields.back().empty())
+    return false;
+  Fields.pop_back();
+  Request.Executable = std::move(Fields[0]);
+  Request.WorkingDir = std::move(Fields[1]);
+  Request.Args.assign(std::make_move_iterator(Fields.begin() + 2),
+                      std::make_move_iterator(Fields.end()));
+  return true;
+}
+
+/// Whether the invocation can share this process with other jobs. Options
+/// that change process-wide state, or that make the frontend print straight
+/// to the terminal, are left to a process of their own.
+static bool isServable(CompilerInvocation &Invocation) {
+  const FrontendOptions &FrontendOpts = Invocation.getFrontendOpts();
+  if (!FrontendOpts.LLVMArgs.empty() || !FrontendOpts.Plugins.empty() ||
+      !FrontendOpts.ActionName.empty() ||
+      !FrontendOpts.AddPluginActions.empty())
+    return false;
+  if (FrontendOpts.ShowHelp || FrontendOpts.ShowVersion ||
+      FrontendOpts.ShowStats || FrontendOpts.ShowTimers ||
+      FrontendOpts.TimeTrace || FrontendOpts.PrintSupportedCPUs ||
+      !FrontendOpts.StatsFile.empty())
+    return false;
+  if (FrontendOpts.OutputFile == "-")
+    return false;
+
+  const DependencyOutputOptions &DepOpts =
+      Invocation.getDependencyOutputOpts();
+  if (DepOpts.OutputFile == "-" ||
+      (DepOpts.ShowHeaderIncludes && DepOpts.HeaderIncludeOutputFile.empty()))
+    return false;
+  if (Invocation.getDiagnosticOpts().DiagnosticLogFile == "-")
+    return false;
+  if (Invocation.getHeaderSearchOpts().Verbose)
+    return false;
+
+  const CodeGenOptions &CodeGenOpts = Invocation.getCodeGenOpts();
+  return CodeGenOpts.DebugPass.empty() &&
+         CodeGenOpts.LimitFloatPrecision.empty();
+}
+
+/// Run the job \p Args. Returns None if it has to run in its own process.
+static Optional<int> runJob(const CC1Server &Server,
+                            ArrayRef<std::string> Args,
+                            std::string &DiagText) {
+  std::vector<const char *> Argv;
+  for (const std::string &Arg : Args)
+    Argv.push_back(Arg.c_str());
+
+  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+
+  // Register the support for object-file-wrapped Clang modules.
+  auto PCHOps = Clang->getPCHContainerOperations();
+  PCHOps->registerWriter(std::make_unique<ObjectFilePCHContainerWriter>());
+  PCHOps->registerReader(std::make_unique<ObjectFilePCHContainerReader>());
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  bool Success = CompilerInvocation::CreateFromArgs(
+      Clang->getInvocation(), Argv.data(), Argv.data() + Argv.size(), Diags);
+  if (!isServable(Clang->getInvocation()))
+    return None;
+
+  // The driver asks for -disable-free because its jobs are about to exit;
+  // this process is not.
+  Clang->getFrontendOpts().DisableFree = false;
+
+  // Infer the builtin include path if unspecified.
+  if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
+      Clang->getHeaderSearchOpts().ResourceDir.empty())
+    Clang->getHeaderSearchOpts().ResourceDir =
+        CompilerInvocation::GetResourcesPath(Server.Argv0, Server.MainAddr);
+
+  // Collect the diagnostics to send them back to the driver.
+  llvm::raw_string_ostream DiagOS(DiagText);
+  Clang->createDiagnostics(
+      new TextDiagnosticPrinter(DiagOS, &Clang->getDiagnosticOpts()));
+  if (!Clang->hasDiagnostics())
+    return 1;
+
+  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+  if (Success)
+    Success = ExecuteCompilerInvocation(Clang.get());
+  Clang.reset();
+  DiagOS.flush();
+  return Success ? 0 : 1;
+}
+
+/// Write all of \p Data to \p FD.
+static void writeAll(int FD, StringRef Data) {
+  while (!Data.empty()) {
+    ssize_t N = ::write(FD, Data.data(), Data.size());
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return;
+    Data = Data.drop_front(N);
+  }
+}
+
+/// Run the job sent on \p FD and reply with either "exit-status: N" followed
+/// by the diagnostics, or "unsupported" if the driver has to run the job
+/// itself.
+static void serveConnection(const CC1Server &Server, int FD) {
+  CC1Request Request;
+  if (!readRequest(FD, Request)) {
+    ::close(FD);
+    return;
+  }
+
+  // Relative paths are resolved against the working directory of the
+  // process, and the arguments are only meaningful to the same clang.
+  Optional<int> ExitStatus;
+  std::string DiagText;
+  SmallString<256> Executable;
+  if (Request.WorkingDir == Server.WorkingDir &&
+      !llvm::sys::fs::real_path(Request.Executable, Executable) &&
+      Executable == Server.Executable) {
+    llvm::CrashRecoveryContext CRC;
+    // A crash also sends the job back to the driver, which then produces the
+    // usual crash diagnostics.
+    if (!CRC.RunSafelyOnThread(
+            [&] { ExitStatus = runJob(Server, Request.Args, DiagText); },
+            DesiredStackSize))
+      ExitStatus = None;
+  }
+
+  if (ExitStatus)
+    writeAll(FD, "exit-status: " + std::to_string(*ExitStatus) + "\n" +
+                     DiagText);
+  else
+    writeAll(FD, "unsupported\n");
+  ::close(FD);
+}
+#endif
+
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  if (Argv.size() != 1) {
+    llvm::errs() << "error: usage: clang -cc1server <socket-path>\n";
+    return 1;
+  }
+
+#ifndef LLVM_ON_UNIX
+  llvm::errs() << "error: -cc1server is only supported on Unix\n";
+  return 1;
+#else
+  CC1Server Server;
+  Server.Argv0 = Argv0;
+  Server.MainAddr = MainAddr;
+  std::string MainExecutable =
+      llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  if (llvm::sys::fs::real_path(MainExecutable, Server.Executable) ||
+      llvm::sys::fs::current_path(Server.WorkingDir)) {
+    llvm::errs() << "error: cannot determine the path of the server\n";
+    return 1;
+  }
+
+  StringRef SocketPath = Argv[0];
+  sockaddr_un Addr = {};
+  Addr.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Addr.sun_path)) {
+    llvm::errs() << "error: socket path is too long: " << SocketPath << "\n";
+    return 1;
+  }
+  memcpy(Addr.sun_path, SocketPath.data(), SocketPath.size());
+
+  // This work is what the server saves every job from doing.
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  llvm::CrashRecoveryContext::Enable();
+  llvm::install_fatal_error_handler(LLVMErrorHandler);
+
+  int ListenFD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ListenFD < 0) {
+    llvm::errs() << "error: cannot create socket: " << strerror(errno) << "\n";
+    return 1;
+  }
+  ::unlink(Addr.sun_path);
+  if (::bind(ListenFD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) ||
+      ::listen(ListenFD, SOMAXCONN)) {
+    llvm::errs() << "error: cannot listen on " << SocketPath << ": "
+                 << strerror(errno) << "\n";
+    ::close(ListenFD);
+    return 1;
+  }
+  // A driver that goes away mid-reply must not take the server with it.
+  ::signal(SIGPIPE, SIG_IGN);
+
+  // The build system bounds the number of drivers, and so of jobs, running at
+  // once.
+  while (true) {
+    int FD = ::accept(ListenFD, nullptr, nullptr);
+    if (FD < 0) {
+      if (errno == EINTR)
+        continue;
+      llvm::errs() << "error: accept failed: " << strerror(errno) << "\n";
+      ::close(ListenFD);
+      return 1;
+    }
+    std::thread([&Server, FD] { serveConnection(Server, FD); }).detach();
+  }
+#endif
+}
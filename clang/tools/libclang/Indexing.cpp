@@ -28,6 +28,9 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <algorithm>
 #include <cstdio>
 #include <mutex>
 #include <utility>
@@ -915,6 +918,56 @@ int clang_indexSourceFileFullArgv(
   return result;
 }
 
+int clang_indexSourceFilesFullArgv(
+    CXIndexAction idxAction, CXClientData *client_data,
+    IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
+    unsigned index_options, unsigned num_source_files,
+    const char *const *source_filenames,
+    const char *const *const *command_line_args,
+    const int *num_command_line_args, struct CXUnsavedFile *unsaved_files,
+    unsigned num_unsaved_files, unsigned TU_options, unsigned num_threads,
+    int *results) {
+  LOG_FUNC_SECTION {
+    *Log << num_source_files << " files, " << num_threads << " threads";
+  }
+
+  if (!num_source_files)
+    return CXError_Success;
+  if (!idxAction || !client_data || !command_line_args ||
+      !num_command_line_args || !results)
+    return CXError_InvalidArguments;
+  if (num_unsaved_files && !unsaved_files)
+    return CXError_InvalidArguments;
+
+  if (!num_threads)
+    num_threads = llvm::heavyweight_hardware_concurrency();
+  num_threads = std::min(num_threads, num_source_files);
+
+  // Every file gets its own ASTUnit, and with it its own FileManager and
+  // SourceManager; the action's skip-bodies data is shared and guarded by its
+  // own mutex. clang_indexSourceFileFullArgv recovers from crashes on the
+  // worker thread that hit them.
+  auto IndexOne = [=](unsigned I) {
+    results[I] = clang_indexSourceFileFullArgv(
+        idxAction, client_data[I], index_callbacks, index_callbacks_size,
+        index_options, source_filenames ? source_filenames[I] : nullptr,
+        command_line_args[I], num_command_line_args[I], unsaved_files,
+        num_unsaved_files, /*out_TU=*/nullptr, TU_options);
+  };
+
+  if (num_threads == 1 || !llvm::llvm_is_multithreaded()) {
+    for (unsigned I = 0; I != num_source_files; ++I)
+      IndexOne(I);
+    return CXError_Success;
+  }
+
+  llvm::ThreadPool Pool(num_threads);
+  for (unsigned I = 0; I != num_source_files; ++I)
+    Pool.async(IndexOne, I);
+  Pool.wait();
+  return CXError_Success;
+}
+
 int clang_indexTranslationUnit(CXIndexAction idxAction,
                                CXClientData client_data,
                                IndexerCallbacks *index_callbacks,
@@ -0,0 +1,102 @@
+//===- unittests/AST/ConstexprInterpreterTest.cpp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Tests for the bytecode interpreter of integer constexpr functions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace {
+
+bool compiles(const std::string &Code, std::vector<std::string> Args = {}) {
+  Args.push_back("-std=c++14");
+  Args.push_back("-fexperimental-new-constant-interpreter");
+  return runToolOnCodeWithArgs(new SyntaxOnlyAction, Code, Args);
+}
+
+TEST(ConstexprInterpreter, EvaluatesIntegerFunctions) {
+  EXPECT_TRUE(compiles(
+      "constexpr unsigned long long fib(unsigned N) {"
+      "  unsigned long long A = 0, B = 1;"
+      "  for (unsigned I = 0; I != N; ++I) {"
+      "    unsigned long long T = A + B;"
+      "    A = B;"
+      "    B = T;"
+      "  }"
+      "  return A;"
+      "}"
+      "static_assert(fib(90) == 2880067194370816120ull, \"\");"
+      "constexpr int gcd(int A, int B) { return B ? gcd(B, A % B) : A; }"
+      "static_assert(gcd(1071, 462) == 21, \"\");"
+      "constexpr int Base = 7;"
+      "enum E { Two = 2 };"
+      "constexpr int collatz(long N, int Add = Base - 6) {"
+      "  int Steps = 0;"
+      "  while (N != 1) {"
+      "    N = N % Two ? 3 * N + Add : N / Two;"
+      "    Steps++;"
+      "  }"
+      "  return Steps;"
+      "}"
+      "static_assert(collatz(27) == 111, \"\");"
+      "constexpr unsigned char wrap(unsigned char C) {"
+      "  do { C += 100; } while (C > 50 && C != 44);"
+      "  return C;"
+      "}"
+      "static_assert(wrap(200) == 44, \"\");"
+      "constexpr int bits(unsigned V) {"
+      "  int N = 0;"
+      "  for (; V; V >>= 1) {"
+      "    if (!(V & 1))"
+      "      continue;"
+      "    ++N;"
+      "  }"
+      "  return N;"
+      "}"
+      "static_assert(bits(0xF0F0u) == 8 && bits(-1) == 32, \"\");"));
+}
+
+TEST(ConstexprInterpreter, DiagnosesNonConstantCalls) {
+  // The interpreter leaves these calls to the usual evaluation, which
+  // rejects them.
+  EXPECT_FALSE(compiles("constexpr int twice(int X) { return X * 2; }"
+                        "constexpr int I = twice(0x7fffffff);"));
+  EXPECT_FALSE(compiles("constexpr int div(int X, int Y) { return X / Y; }"
+                        "constexpr int I = div(1, 0);"));
+  EXPECT_FALSE(compiles("constexpr int shl(int X, int Y) { return X << Y; }"
+                        "constexpr int I = shl(1, 32);"));
+  EXPECT_FALSE(compiles("constexpr int uninit(int X) { int Y; return Y; }"
+                        "constexpr int I = uninit(0);"));
+  EXPECT_FALSE(compiles("constexpr int none(int X) { if (X) return 1; }"
+                        "constexpr int I = none(0);"));
+}
+
+TEST(ConstexprInterpreter, HonorsLimits) {
+  const char *Code = "constexpr int loop(int N) {"
+                     "  int Sum = 0;"
+                     "  for (int I = 0; I < N; ++I)"
+                     "    Sum += I;"
+                     "  return Sum;"
+                     "}"
+                     "constexpr int I = loop(1000);"
+                     "constexpr int down(int N) { return N ? down(N - 1) : 0; }"
+                     "constexpr int J = down(100);";
+  EXPECT_TRUE(compiles(Code));
+  EXPECT_FALSE(compiles(Code, {"-fconstexpr-steps=1000"}));
+  EXPECT_FALSE(compiles(Code, {"-fconstexpr-depth=50"}));
+}
+
+} // end anonymous namespace
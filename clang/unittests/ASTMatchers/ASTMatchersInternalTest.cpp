@@ -44,6 +44,28 @@ TEST(ConstructVariadic, MismatchedTypes_Regression) {
                   .convertTo<QualType>()));
 }
 
+TEST(ConstructVariadic, AnyOfRestrictsToCommonKind) {
+  internal::DynTypedMatcher AnyOf = stmt(anyOf(callExpr(), cxxThrowExpr()));
+  EXPECT_TRUE(AnyOf.canMatchNodesOfKind(
+      ast_type_traits::ASTNodeKind::getFromNodeKind<CallExpr>()));
+  EXPECT_TRUE(AnyOf.canMatchNodesOfKind(
+      ast_type_traits::ASTNodeKind::getFromNodeKind<CXXThrowExpr>()));
+  EXPECT_FALSE(AnyOf.canMatchNodesOfKind(
+      ast_type_traits::ASTNodeKind::getFromNodeKind<ForStmt>()));
+
+  internal::DynTypedMatcher EachOf =
+      stmt(eachOf(cxxMemberCallExpr(), cxxOperatorCallExpr()));
+  EXPECT_TRUE(EachOf.canMatchNodesOfKind(
+      ast_type_traits::ASTNodeKind::getFromNodeKind<CXXMemberCallExpr>()));
+  EXPECT_FALSE(EachOf.canMatchNodesOfKind(
+      ast_type_traits::ASTNodeKind::getFromNodeKind<CXXThrowExpr>()));
+
+  EXPECT_TRUE(matches("void f() { throw 1; }",
+                      stmt(anyOf(callExpr(), cxxThrowExpr()))));
+  EXPECT_TRUE(notMatches("void f() { for (;;) {} }",
+                         stmt(anyOf(callExpr(), cxxThrowExpr()))));
+}
+
 // For testing AST_MATCHER_P().
 AST_MATCHER_P(Decl, just, internal::Matcher<Decl>, AMatcher) {
   // Make sure all special variables are used: node, match_finder,
@@ -111,6 +133,29 @@ TEST(MatchFinder, CheckProfiling) {
   EXPECT_EQ("MyID", Records.begin()->getKey());
 }
 
+TEST(MatchFinder, CheckProfilingPerMatcher) {
+  MatchFinder::MatchFinderOptions Options;
+  llvm::StringMap<llvm::TimeRecord> Records;
+  Options.CheckProfiling.emplace(Records);
+  Options.CheckProfiling->PerMatcher = true;
+  MatchFinder Finder(std::move(Options));
+
+  struct NamedCallback : public MatchFinder::MatchCallback {
+    void run(const MatchFinder::MatchResult &Result) override {}
+    StringRef getID() const override { return "MyID"; }
+  } Callback;
+  Finder.addMatcher(decl(), &Callback);
+  Finder.addMatcher(callExpr(), &Callback);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(), "int x;"));
+
+  EXPECT_EQ(3u, Records.size());
+  EXPECT_EQ(1u, Records.count("MyID"));
+  EXPECT_EQ(1u, Records.count("MyID/Decl#0"));
+  EXPECT_EQ(1u, Records.count("MyID/CallExpr#1"));
+}
+
 class VerifyStartOfTranslationUnit : public MatchFinder::MatchCallback {
 public:
   VerifyStartOfTranslationUnit() : Called(false) {}
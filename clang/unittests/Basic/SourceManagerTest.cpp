@@ -152,6 +152,40 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineNumberInLargeBuffer) {
+  // Enough lines that the line table is built over several chunks, with a
+  // mix of line lengths and line endings so that some "\r\n" pairs straddle
+  // the chunk boundaries.
+  std::string Source;
+  std::vector<unsigned> LineStarts = {0};
+  for (unsigned I = 0; I != 40000; ++I) {
+    Source += std::string(I % 23, 'x');
+    Source += I % 3 ? "\n" : "\r\n";
+    LineStarts.push_back(Source.size());
+  }
+  LineStarts.pop_back();
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+
+  // Query near the top first, then near the bottom, then in between.
+  for (unsigned Line : {3u, 39999u, 12345u, 1u, 40000u, 20000u}) {
+    unsigned Offset = LineStarts[Line - 1];
+    bool Invalid = false;
+    EXPECT_EQ(Line, SourceMgr.getLineNumber(MainFileID, Offset, &Invalid));
+    EXPECT_FALSE(Invalid);
+    EXPECT_EQ(Line, SourceMgr.getLineNumber(MainFileID, Offset + 1, &Invalid));
+    unsigned LineEnd =
+        Line == LineStarts.size() ? Source.size() : LineStarts[Line];
+    EXPECT_EQ(Line, SourceMgr.getLineNumber(MainFileID, LineEnd - 1));
+    EXPECT_EQ(SourceMgr.getLocForStartOfFile(MainFileID)
+                  .getLocWithOffset(Offset),
+              SourceMgr.translateLineCol(MainFileID, Line, 1));
+  }
+}
+
 TEST_F(SourceManagerTest, locationPrintTest) {
   const char *header = "#define IDENTITY(x) x\n";
 
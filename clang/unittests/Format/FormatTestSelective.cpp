@@ -583,6 +583,68 @@ TEST_F(FormatTestSelective, StopFormattingWhenLeavingScope) {
              15, 0));
 }
 
+TEST_F(FormatTestSelective, FormatsDeclarationsAroundRange) {
+  // Only the declarations around the range are formatted, the code around
+  // them must be kept as it is.
+  std::string Code = "int  a;\n"
+                     "\n"
+                     "int  b;\n"
+                     "\n"
+                     "namespace n {\n"
+                     "\n"
+                     "int  c;\n"
+                     "\n"
+                     "void f() {\n"
+                     "  int  d;\n"
+                     "}\n"
+                     "\n"
+                     "int  e;\n"
+                     "\n"
+                     "int  f;\n"
+                     "\n"
+                     "} // namespace n\n"
+                     "\n"
+                     "int  g;";
+  EXPECT_EQ("int  a;\n"
+            "\n"
+            "int  b;\n"
+            "\n"
+            "namespace n {\n"
+            "\n"
+            "int  c;\n"
+            "\n"
+            "void f() { int d; }\n"
+            "\n"
+            "int  e;\n"
+            "\n"
+            "int  f;\n"
+            "\n"
+            "} // namespace n\n"
+            "\n"
+            "int  g;",
+            format(Code, 53, 0));
+  EXPECT_EQ("int  a;\n"
+            "\n"
+            "int  b;\n"
+            "\n"
+            "namespace n {\n"
+            "\n"
+            "int  c;\n"
+            "\n"
+            "void f() {\n"
+            "  int  d;\n"
+            "}\n"
+            "\n"
+            "int  e;\n"
+            "\n"
+            "int  f;\n"
+            "\n"
+            "} // namespace n\n"
+            "\n"
+            "int g;",
+            format(Code, 102, 0));
+}
+
 TEST_F(FormatTestSelective, SelectivelyRequoteJavaScript) {
   Style = getGoogleStyle(FormatStyle::LK_JavaScript);
   EXPECT_EQ(
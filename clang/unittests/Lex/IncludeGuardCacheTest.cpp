@@ -0,0 +1,136 @@
+//===- unittests/Lex/IncludeGuardCacheTest.cpp - IncludeGuardCache tests --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludeGuardCache.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+
+// Collects the names of the files whose inclusion was skipped.
+class SkippedFilesCallbacks : public PPCallbacks {
+public:
+  explicit SkippedFilesCallbacks(std::vector<std::string> &Skipped)
+      : Skipped(Skipped) {}
+
+  void FileSkipped(const FileEntry &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override {
+    Skipped.push_back(SkippedFile.getName());
+  }
+
+private:
+  std::vector<std::string> &Skipped;
+};
+
+class IncludeGuardCacheTest : public ::testing::Test {
+protected:
+  IncludeGuardCacheTest()
+      : VFS(new llvm::vfs::InMemoryFileSystem), DiagID(new DiagnosticIDs()),
+        DiagOpts(new DiagnosticOptions()),
+        Diags(DiagID, DiagOpts.get(), new IgnoringDiagConsumer()),
+        TargetOpts(new TargetOptions()) {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+
+    const char *Guarded = "#ifndef GUARD_H\n#define GUARD_H\nint x;\n#endif\n";
+    VFS->addFile("/a/guard.h", 0, llvm::MemoryBuffer::getMemBuffer(Guarded));
+    VFS->addFile("/b/guard.h", 0, llvm::MemoryBuffer::getMemBuffer(Guarded));
+  }
+
+  // Preprocess \p Source as a translation unit of its own, and return the
+  // files whose inclusion was skipped.
+  std::vector<std::string>
+  preprocess(StringRef Source, std::shared_ptr<IncludeGuardCache> Guards) {
+    FileManager FileMgr(FileSystemOptions(), VFS);
+    SourceManager SourceMgr(Diags, FileMgr);
+    SourceMgr.setMainFileID(
+        SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(Source)));
+
+    TrivialModuleLoader ModLoader;
+    HeaderSearch HeaderInfo(std::make_shared<HeaderSearchOptions>(), SourceMgr,
+                            Diags, LangOpts, Target.get());
+    auto PPOpts = std::make_shared<PreprocessorOptions>();
+    PPOpts->IncludeGuards = std::move(Guards);
+    Preprocessor PP(PPOpts, Diags, LangOpts, SourceMgr, HeaderInfo, ModLoader,
+                    /*IILookup =*/nullptr,
+                    /*OwnsHeaderSearch =*/false);
+    PP.Initialize(*Target);
+
+    std::vector<std::string> Skipped;
+    PP.addPPCallbacks(std::make_unique<SkippedFilesCallbacks>(Skipped));
+    PP.EnterMainSourceFile();
+    while (true) {
+      Token Tok;
+      PP.Lex(Tok);
+      if (Tok.is(tok::eof))
+        break;
+    }
+    return Skipped;
+  }
+
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> VFS;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
+  DiagnosticsEngine Diags;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+};
+
+TEST_F(IncludeGuardCacheTest, RecordsGuards) {
+  auto Guards = std::make_shared<IncludeGuardCache>();
+  preprocess("#include \"/a/guard.h\"\n", Guards);
+  EXPECT_EQ("GUARD_H",
+            Guards->getControllingMacro(
+                "#ifndef GUARD_H\n#define GUARD_H\nint x;\n#endif\n"));
+  EXPECT_EQ("", Guards->getControllingMacro("int x;\n"));
+}
+
+TEST_F(IncludeGuardCacheTest, SkipsFirstInclusionAcrossTUs) {
+  const char *Source = "#define GUARD_H\n#include \"/a/guard.h\"\n";
+  EXPECT_TRUE(preprocess(Source, nullptr).empty());
+
+  auto Guards = std::make_shared<IncludeGuardCache>();
+  preprocess("#include \"/b/guard.h\"\n", Guards);
+  std::vector<std::string> Skipped = preprocess(Source, Guards);
+  ASSERT_EQ(1u, Skipped.size());
+  EXPECT_EQ("/a/guard.h", Skipped[0]);
+}
+
+TEST_F(IncludeGuardCacheTest, SkipsCopiesWithinTU) {
+  const char *Source = "#include \"/a/guard.h\"\n#include \"/b/guard.h\"\n";
+  EXPECT_TRUE(preprocess(Source, nullptr).empty());
+
+  std::vector<std::string> Skipped =
+      preprocess(Source, std::make_shared<IncludeGuardCache>());
+  ASSERT_EQ(1u, Skipped.size());
+  EXPECT_EQ("/b/guard.h", Skipped[0]);
+}
+
+TEST_F(IncludeGuardCacheTest, IgnoresUndefinedGuards) {
+  auto Guards = std::make_shared<IncludeGuardCache>();
+  preprocess("#include \"/a/guard.h\"\n", Guards);
+  EXPECT_TRUE(preprocess("#include \"/b/guard.h\"\n", Guards).empty());
+}
+
+} // end anonymous namespace
@@ -535,4 +535,24 @@ TEST_F(LexerTest, CharRangeOffByOne) {
   EXPECT_EQ(Lexer::getSourceText(CR, SourceMgr, LangOpts), "MOO"); // Was "MO".
 }
 
+TEST_F(LexerTest, LongRuns) {
+  // Runs longer than a vector chunk, ending with characters that stop the
+  // fast scanning loops.
+  std::string Ident = std::string(37, 'a') + "_9Z";
+  std::string Str = "\"" + std::string(33, 'y') + "\\\"" +
+                    std::string(20, 'z') + "??!\"";
+  std::string Source = "int " + Ident + ";\n" + std::string(35, ' ') +
+                       "// " + std::string(40, 'x') + " \\\n" +
+                       std::string(18, '\t') + "still a comment\n" +
+                       "const char *s = " + Str + ";\n";
+  std::vector<Token> toks =
+      CheckLex(Source, {tok::kw_int, tok::identifier, tok::semi,
+                        tok::kw_const, tok::kw_char, tok::star,
+                        tok::identifier, tok::equal, tok::string_literal,
+                        tok::semi});
+  ASSERT_EQ(toks.size(), 10u);
+  EXPECT_EQ(getSourceText(toks[1], toks[1]), Ident);
+  EXPECT_EQ(getSourceText(toks[8], toks[8]), Str);
+}
+
 } // anonymous namespace
@@ -502,6 +502,48 @@ TEST_F(LibclangParseTest, EvaluateChildExpression) {
       nullptr);
 }
 
+TEST_F(LibclangParseTest, IndexSourceFilesInParallel) {
+  const unsigned NumFiles = 8;
+  std::vector<std::string> Names;
+  for (unsigned I = 0; I != NumFiles; ++I) {
+    std::string Name = "file" + std::to_string(I) + ".cpp";
+    WriteFile(Name, "int func" + std::to_string(I) + "() { return 0; }\n");
+    Names.push_back(Name);
+  }
+  // Each file collects the names it declares into its own client data.
+  std::vector<std::vector<std::string>> Decls(NumFiles);
+  std::vector<CXClientData> ClientData;
+  std::vector<const char *> Files;
+  std::vector<const char *const *> Args;
+  std::vector<int> NumArgs;
+  const char *Argv[] = {"clang"};
+  for (unsigned I = 0; I != NumFiles; ++I) {
+    ClientData.push_back(&Decls[I]);
+    Files.push_back(Names[I].c_str());
+    Args.push_back(Argv);
+    NumArgs.push_back(1);
+  }
+
+  IndexerCallbacks CB = {};
+  CB.indexDeclaration = [](CXClientData Data, const CXIdxDeclInfo *Info) {
+    static_cast<std::vector<std::string> *>(Data)->push_back(
+        Info->entityInfo->name);
+  };
+  CXIndexAction Action = clang_IndexAction_create(Index);
+  std::vector<int> Results(NumFiles, -1);
+  EXPECT_EQ(CXError_Success,
+            clang_indexSourceFilesFullArgv(
+                Action, ClientData.data(), &CB, sizeof(CB), CXIndexOpt_None,
+                NumFiles, Files.data(), Args.data(), NumArgs.data(), nullptr,
+                0, CXTranslationUnit_None, /*num_threads=*/4, Results.data()));
+  clang_IndexAction_dispose(Action);
+
+  for (unsigned I = 0; I != NumFiles; ++I) {
+    EXPECT_EQ(0, Results[I]);
+    EXPECT_EQ(std::vector<std::string>{"func" + std::to_string(I)}, Decls[I]);
+  }
+}
+
 class LibclangReparseTest : public LibclangParseTest {
 public:
   void DisplayDiagnostics() {
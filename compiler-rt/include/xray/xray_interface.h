@@ -108,6 +108,21 @@ extern XRayPatchingStatus __xray_patch_function(int32_t FuncId);
 /// result values.
 extern XRayPatchingStatus __xray_unpatch_function(int32_t FuncId);
 
+/// This patches all the functions in |FuncIds| (an array of |Count| function
+/// ids, in any order) in one go. The ids are the ones llvm-xray reports, e.g.
+/// in the "funcid" column of `llvm-xray account`. Functions whose sleds share
+/// pages are made writeable together, so patching a group of functions takes
+/// far fewer mprotect(...) calls than patching them one at a time. If any of
+/// the ids is invalid, nothing is patched and we return FAILED. See
+/// XRayPatchingStatus for the other possible result values.
+extern XRayPatchingStatus __xray_patch_functions(const int32_t *FuncIds,
+                                                 size_t Count);
+
+/// This unpatches all the functions in |FuncIds|, the same way
+/// __xray_patch_functions patches them.
+extern XRayPatchingStatus __xray_unpatch_functions(const int32_t *FuncIds,
+                                                   size_t Count);
+
 /// This function returns the address of the function provided a valid function
 /// id. We return 0 if we encounter any error, even if 0 may be a valid function
 /// address.
@@ -83,7 +83,11 @@ struct ChunkHeader {
   // This field is used for small sizes. For large sizes it is equal to
   // SizeClassMap::kMaxSize and the actual size is stored in the
   // SecondaryAllocator's metadata.
-  u32 user_requested_size : 29;
+  u32 user_requested_size : 28;
+  // Whether the chunk is fully checked, see ASAN_OPTIONS=sample_allocations.
+  // Chunks that are not have the minimal redzone, no allocation or
+  // deallocation stack, and are not quarantined.
+  u32 sampled : 1;
   // align < 8 -> 0
   // else      -> log2(min(align, 512)) - 2
   u32 user_requested_alignment_log : 3;
@@ -99,6 +103,7 @@ static const uptr kChunkHeaderSize = sizeof(ChunkHeader);
 static const uptr kChunkHeader2Size = sizeof(ChunkBase) - kChunkHeaderSize;
 COMPILER_CHECK(kChunkHeaderSize == 16);
 COMPILER_CHECK(kChunkHeader2Size <= 16);
+COMPILER_CHECK(SizeClassMap::kMaxSize < (1U << 28));
 
 // Every chunk of memory allocated by this allocator can be in one of 3 states:
 // CHUNK_AVAILABLE: the chunk is in the free list and ready to be allocated.
@@ -356,6 +361,26 @@ struct Allocator {
     return Min(Max(rz_log, RZSize2Log(min_rz)), RZSize2Log(max_rz));
   }
 
+  // Decides whether the next allocation of thread t is fully checked. The
+  // gaps between sampled allocations are random, so that a periodic
+  // allocation pattern doesn't make the same allocation sites always escape.
+  bool ShouldSampleAllocation(AsanThread *t) {
+    const int rate = flags()->sample_allocations;
+    if (LIKELY(rate <= 1) || !t)
+      return true;
+    AsanThreadLocalMallocStorage *ms = &t->malloc_storage();
+    if (ms->allocations_until_sample) {
+      ms->allocations_until_sample--;
+      return false;
+    }
+    if (UNLIKELY(!ms->sample_rand_state))
+      ms->sample_rand_state = static_cast<u32>(NanoTime()) | 1;
+    // On average, rate - 1 allocations are skipped.
+    ms->allocations_until_sample =
+        RandN(&ms->sample_rand_state, 2 * static_cast<u32>(rate) - 1);
+    return true;
+  }
+
   static uptr ComputeUserRequestedAlignmentLog(uptr user_requested_alignment) {
     if (user_requested_alignment < 8)
       return 0;
@@ -421,7 +446,9 @@ struct Allocator {
       size = 1;
     }
     CHECK(IsPowerOfTwo(alignment));
-    uptr rz_log = ComputeRZLog(size);
+    AsanThread *t = GetCurrentThread();
+    const bool sampled = ShouldSampleAllocation(t);
+    uptr rz_log = sampled ? ComputeRZLog(size) : 0;
     uptr rz_size = RZLog2Size(rz_log);
     uptr rounded_size = RoundUpTo(Max(size, kChunkHeader2Size), alignment);
     uptr needed_size = rounded_size + rz_size;
@@ -445,7 +472,6 @@ struct Allocator {
                                  stack);
     }
 
-    AsanThread *t = GetCurrentThread();
     void *allocated;
     if (t) {
       AllocatorCache *cache = GetAllocatorCache(&t->malloc_storage());
@@ -483,6 +509,7 @@ struct Allocator {
     AsanChunk *m = reinterpret_cast<AsanChunk *>(chunk_beg);
     m->alloc_type = alloc_type;
     m->rz_log = rz_log;
+    m->sampled = sampled;
     u32 alloc_tid = t ? t->tid() : 0;
     m->alloc_tid = alloc_tid;
     CHECK_EQ(alloc_tid, m->alloc_tid);  // Does alloc_tid fit into the bitfield?
@@ -506,7 +533,7 @@ struct Allocator {
     }
     m->user_requested_alignment_log = user_requested_alignment_log;
 
-    m->alloc_context_id = StackDepotPut(*stack);
+    m->alloc_context_id = sampled ? StackDepotPut(*stack) : 0;
 
     uptr size_rounded_down_to_granularity =
         RoundDownTo(size, SHADOW_GRANULARITY);
@@ -570,7 +597,7 @@ struct Allocator {
       CHECK_EQ(m->free_tid, kInvalidTid);
     AsanThread *t = GetCurrentThread();
     m->free_tid = t ? t->tid() : 0;
-    m->free_context_id = StackDepotPut(*stack);
+    m->free_context_id = m->sampled ? StackDepotPut(*stack) : 0;
 
     Flags &fl = *flags();
     if (fl.max_free_fill_size > 0) {
@@ -584,25 +611,31 @@ struct Allocator {
     }
 
     // Poison the region.
-    PoisonShadow(m->Beg(),
-                 RoundUpTo(m->UsedSize(), SHADOW_GRANULARITY),
-                 kAsanHeapFreeMagic);
+    if (m->sampled)
+      PoisonShadow(m->Beg(), RoundUpTo(m->UsedSize(), SHADOW_GRANULARITY),
+                   kAsanHeapFreeMagic);
 
     AsanStats &thread_stats = GetCurrentThreadStats();
     thread_stats.frees++;
     thread_stats.freed += m->UsedSize();
 
-    // Push into quarantine.
+    // Push into quarantine, or recycle right away if the chunk isn't sampled.
     if (t) {
       AsanThreadLocalMallocStorage *ms = &t->malloc_storage();
       AllocatorCache *ac = GetAllocatorCache(ms);
-      quarantine.Put(GetQuarantineCache(ms), QuarantineCallback(ac, stack), m,
-                     m->UsedSize());
+      if (!m->sampled)
+        QuarantineCallback(ac, stack).Recycle(m);
+      else
+        quarantine.Put(GetQuarantineCache(ms), QuarantineCallback(ac, stack),
+                       m, m->UsedSize());
     } else {
       SpinMutexLock l(&fallback_mutex);
       AllocatorCache *ac = &fallback_allocator_cache;
-      quarantine.Put(&fallback_quarantine_cache, QuarantineCallback(ac, stack),
-                     m, m->UsedSize());
+      if (!m->sampled)
+        QuarantineCallback(ac, stack).Recycle(m);
+      else
+        quarantine.Put(&fallback_quarantine_cache,
+                       QuarantineCallback(ac, stack), m, m->UsedSize());
     }
   }
 
@@ -194,6 +194,9 @@ using AllocatorCache = AsanAllocator::AllocatorCache;
 struct AsanThreadLocalMallocStorage {
   uptr quarantine_cache[16];
   AllocatorCache allocator_cache;
+  // For ASAN_OPTIONS=sample_allocations.
+  u32 allocations_until_sample;
+  u32 sample_rand_state;
   void CommitBack();
  private:
   // These objects are allocated via mmap() and are zero-initialized.
@@ -159,6 +159,8 @@ void InitializeFlags() {
   CHECK_LE(f->max_redzone, 2048);
   CHECK(IsPowerOfTwo(f->redzone));
   CHECK(IsPowerOfTwo(f->max_redzone));
+  CHECK_GE(f->sample_allocations, 0);
+  CHECK_GE(f->sample_functions, 0);
   if (SANITIZER_RTEMS) {
     CHECK(!f->unmap_shadow_on_exit);
     CHECK(!f->protect_shadow_gap);
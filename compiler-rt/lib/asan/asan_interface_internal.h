@@ -183,6 +183,14 @@ extern "C" {
   SANITIZER_INTERFACE_ATTRIBUTE
   extern int __asan_option_detect_stack_use_after_return;
 
+  // Code compiled with -asan-sample-functions checks the memory accesses of
+  // a function only if the hash of its name, xor the seed, is at most the
+  // threshold. Set from ASAN_OPTIONS=sample_functions.
+  SANITIZER_INTERFACE_ATTRIBUTE
+  extern u32 __asan_function_sample_seed;
+  SANITIZER_INTERFACE_ATTRIBUTE
+  extern u32 __asan_function_sample_threshold;
+
   SANITIZER_INTERFACE_ATTRIBUTE
   extern uptr *__asan_test_only_reported_buggy_pointer;
 
@@ -33,6 +33,9 @@
 
 uptr __asan_shadow_memory_dynamic_address;  // Global interface symbol.
 int __asan_option_detect_stack_use_after_return;  // Global interface symbol.
+// Global interface symbols. Check every function until the runtime is up.
+u32 __asan_function_sample_seed;
+u32 __asan_function_sample_threshold = ~0U;
 uptr *__asan_test_only_reported_buggy_pointer;  // Used only for testing asan.
 
 namespace __asan {
@@ -440,6 +443,14 @@ static void AsanInitInternal() {
   __asan_option_detect_stack_use_after_return =
       flags()->detect_stack_use_after_return;
 
+  if (flags()->sample_functions > 0) {
+    u32 seed;
+    if (!GetRandom(&seed, sizeof(seed), /*blocking=*/false))
+      seed = static_cast<u32>(NanoTime());
+    __asan_function_sample_seed = seed;
+    __asan_function_sample_threshold = ~0U / flags()->sample_functions;
+  }
+
   __sanitizer::InitializePlatformEarly();
 
   // Re-exec ourselves if we need to set additional env or command line args.
@@ -0,0 +1,181 @@
+//===-- int_mem.h - memory routine helpers --------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file is not part of the interface of this library.
+//
+// This file defines the pieces shared by the implementations of memcpy,
+// memmove, memset and memcmp, which are only built for targets without a C
+// library (COMPILER_RT_BUILTINS_ENABLE_MEM_FUNCTIONS).
+//
+// Sizes up to 128 bytes are dispatched by size class to straight-line code
+// with overlapping unaligned 16-byte accesses, which the compiler maps to
+// SSE2 registers on x86-64 and NEON registers on AArch64. Larger sizes run
+// loops of 64-byte blocks. This code must not be compiled into calls to the
+// routines it implements, so it never uses __builtin_memcpy and friends.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef INT_MEM_H
+#define INT_MEM_H
+
+#include "int_lib.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+// Copies and fills of at least this many bytes use `rep movsb` and
+// `rep stosb` on x86-64, which processors with Enhanced REP MOVSB (ERMS) run
+// faster than any loop. Define it to 0 to always use the loops.
+#ifndef CRT_MEM_ERMS_THRESHOLD
+#define CRT_MEM_ERMS_THRESHOLD 2048
+#endif
+
+// Copies and fills of at least this many bytes use non-temporal stores on
+// x86-64 and AArch64, so that they do not evict the rest of the working set
+// from the cache. Define it to 0 to never use them.
+#ifndef CRT_MEM_NONTEMPORAL_THRESHOLD
+#define CRT_MEM_NONTEMPORAL_THRESHOLD (4u << 20)
+#endif
+
+// Unaligned accesses, which may alias anything.
+typedef uint8_t crt_mem_v16 __attribute__((__vector_size__(16), __aligned__(1),
+                                           __may_alias__));
+typedef uint64_t crt_mem_u64 __attribute__((__aligned__(1), __may_alias__));
+typedef uint32_t crt_mem_u32 __attribute__((__aligned__(1), __may_alias__));
+typedef uint16_t crt_mem_u16 __attribute__((__aligned__(1), __may_alias__));
+
+static inline crt_mem_v16 crt_mem_load16(const uint8_t *p) {
+  return *(const crt_mem_v16 *)p;
+}
+
+static inline void crt_mem_store16(uint8_t *p, crt_mem_v16 v) {
+  *(crt_mem_v16 *)p = v;
+}
+
+// Copies n <= 128 bytes. Every load is done before the first store, so the
+// buffers may overlap.
+static inline void crt_mem_copy_small(uint8_t *d, const uint8_t *s,
+                                      size_t n) {
+  if (n <= 16) {
+    if (n >= 8) {
+      uint64_t a = *(const crt_mem_u64 *)s;
+      uint64_t b = *(const crt_mem_u64 *)(s + n - 8);
+      *(crt_mem_u64 *)d = a;
+      *(crt_mem_u64 *)(d + n - 8) = b;
+    } else if (n >= 4) {
+      uint32_t a = *(const crt_mem_u32 *)s;
+      uint32_t b = *(const crt_mem_u32 *)(s + n - 4);
+      *(crt_mem_u32 *)d = a;
+      *(crt_mem_u32 *)(d + n - 4) = b;
+    } else if (n >= 2) {
+      uint16_t a = *(const crt_mem_u16 *)s;
+      uint16_t b = *(const crt_mem_u16 *)(s + n - 2);
+      *(crt_mem_u16 *)d = a;
+      *(crt_mem_u16 *)(d + n - 2) = b;
+    } else if (n == 1) {
+      *d = *s;
+    }
+    return;
+  }
+  if (n <= 32) {
+    crt_mem_v16 a = crt_mem_load16(s);
+    crt_mem_v16 b = crt_mem_load16(s + n - 16);
+    crt_mem_store16(d, a);
+    crt_mem_store16(d + n - 16, b);
+    return;
+  }
+  if (n <= 64) {
+    crt_mem_v16 a = crt_mem_load16(s);
+    crt_mem_v16 b = crt_mem_load16(s + 16);
+    crt_mem_v16 c = crt_mem_load16(s + n - 32);
+    crt_mem_v16 e = crt_mem_load16(s + n - 16);
+    crt_mem_store16(d, a);
+    crt_mem_store16(d + 16, b);
+    crt_mem_store16(d + n - 32, c);
+    crt_mem_store16(d + n - 16, e);
+    return;
+  }
+  crt_mem_v16 v[8];
+  for (int i = 0; i < 4; ++i) {
+    v[i] = crt_mem_load16(s + 16 * i);
+    v[4 + i] = crt_mem_load16(s + n - 64 + 16 * i);
+  }
+  for (int i = 0; i < 4; ++i) {
+    crt_mem_store16(d + 16 * i, v[i]);
+    crt_mem_store16(d + n - 64 + 16 * i, v[4 + i]);
+  }
+}
+
+// Copies n > 64 bytes front to back in 64-byte blocks. Each block is loaded
+// before it is stored, and the last one is loaded first, so d may overlap
+// the buffer after it as long as d <= s.
+static inline void crt_mem_copy_forward(uint8_t *d, const uint8_t *s,
+                                        size_t n) {
+  crt_mem_v16 t[4];
+  for (int i = 0; i < 4; ++i)
+    t[i] = crt_mem_load16(s + n - 64 + 16 * i);
+  uint8_t *last = d + n - 64;
+  for (; n > 64; n -= 64, s += 64, d += 64) {
+    crt_mem_v16 v[4];
+    for (int i = 0; i < 4; ++i)
+      v[i] = crt_mem_load16(s + 16 * i);
+    for (int i = 0; i < 4; ++i)
+      crt_mem_store16(d + 16 * i, v[i]);
+  }
+  for (int i = 0; i < 4; ++i)
+    crt_mem_store16(last + 16 * i, t[i]);
+}
+
+// Copies n > 64 bytes back to front, for d > s within the source buffer.
+static inline void crt_mem_copy_backward(uint8_t *d, const uint8_t *s,
+                                         size_t n) {
+  crt_mem_v16 h[4];
+  for (int i = 0; i < 4; ++i)
+    h[i] = crt_mem_load16(s + 16 * i);
+  uint8_t *first = d;
+  for (d += n, s += n; n > 64; n -= 64) {
+    d -= 64;
+    s -= 64;
+    crt_mem_v16 v[4];
+    for (int i = 0; i < 4; ++i)
+      v[i] = crt_mem_load16(s + 16 * i);
+    for (int i = 0; i < 4; ++i)
+      crt_mem_store16(d + 16 * i, v[i]);
+  }
+  for (int i = 0; i < 4; ++i)
+    crt_mem_store16(first + 16 * i, h[i]);
+}
+
+// Stores v to the 64 bytes at the 16-byte aligned d, bypassing the cache
+// where the target can. Callers end a run of these with crt_mem_nt_fence().
+static inline void crt_mem_store64_nt(uint8_t *d, const crt_mem_v16 v[4]) {
+#if defined(__x86_64__)
+  for (int i = 0; i < 4; ++i)
+    _mm_stream_si128((__m128i *)(d + 16 * i), (__m128i)v[i]);
+#elif defined(__aarch64__)
+  __asm__ volatile("stnp %q1, %q2, [%0]\n\t"
+                   "stnp %q3, %q4, [%0, #32]"
+                   :
+                   : "r"(d), "w"(v[0]), "w"(v[1]), "w"(v[2]), "w"(v[3])
+                   : "memory");
+#else
+  for (int i = 0; i < 4; ++i)
+    crt_mem_store16(d + 16 * i, v[i]);
+#endif
+}
+
+static inline void crt_mem_nt_fence(void) {
+#if defined(__x86_64__)
+  _mm_sfence();
+#endif
+}
+
+#endif // INT_MEM_H
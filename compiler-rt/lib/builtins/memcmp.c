@@ -0,0 +1,54 @@
+//===-- memcmp.c - Implement memcmp ---------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements memcmp for targets without a C library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "int_mem.h"
+
+// Returns the difference of the first bytes that differ among the n <= 8.
+static int compare_bytes(const uint8_t *a, const uint8_t *b, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    if (a[i] != b[i])
+      return a[i] - b[i];
+  return 0;
+}
+
+// Whether the 16 bytes at a and b are all equal.
+static inline int equal16(const uint8_t *a, const uint8_t *b) {
+  crt_mem_v16 x = crt_mem_load16(a) ^ crt_mem_load16(b);
+  uint64_t w[2];
+  w[0] = ((const crt_mem_u64 *)&x)[0];
+  w[1] = ((const crt_mem_u64 *)&x)[1];
+  return (w[0] | w[1]) == 0;
+}
+
+COMPILER_RT_ABI int __compilerrt_memcmp(const void *lhs, const void *rhs,
+                                        size_t n) {
+  const uint8_t *a = (const uint8_t *)lhs;
+  const uint8_t *b = (const uint8_t *)rhs;
+  // Skip 64-byte blocks that are equal, then 8-byte words, comparing the
+  // bytes of the first word that differs.
+  for (; n >= 64; n -= 64, a += 64, b += 64) {
+    crt_mem_v16 x = (crt_mem_load16(a) ^ crt_mem_load16(b)) |
+                    (crt_mem_load16(a + 16) ^ crt_mem_load16(b + 16)) |
+                    (crt_mem_load16(a + 32) ^ crt_mem_load16(b + 32)) |
+                    (crt_mem_load16(a + 48) ^ crt_mem_load16(b + 48));
+    if ((((const crt_mem_u64 *)&x)[0] | ((const crt_mem_u64 *)&x)[1]) != 0)
+      break;
+  }
+  for (; n >= 16 && equal16(a, b); n -= 16, a += 16, b += 16)
+    ;
+  for (; n >= 8; n -= 8, a += 8, b += 8)
+    if (*(const crt_mem_u64 *)a != *(const crt_mem_u64 *)b)
+      return compare_bytes(a, b, 8);
+  return compare_bytes(a, b, n);
+}
+
+COMPILER_RT_ALIAS(__compilerrt_memcmp, memcmp)
@@ -0,0 +1,59 @@
+//===-- memcpy.c - Implement memcpy ---------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements memcpy for targets without a C library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "int_mem.h"
+
+// Copies n > 128 bytes with 16-byte aligned stores, bypassing the cache.
+static void copy_nontemporal(uint8_t *d, const uint8_t *s, size_t n) {
+  crt_mem_v16 t[4];
+  for (int i = 0; i < 4; ++i)
+    t[i] = crt_mem_load16(s + n - 64 + 16 * i);
+  uint8_t *last = d + n - 64;
+  crt_mem_store16(d, crt_mem_load16(s));
+  size_t skew = 16 - ((uintptr_t)d & 15);
+  d += skew;
+  s += skew;
+  n -= skew;
+  for (; n > 64; n -= 64, s += 64, d += 64) {
+    crt_mem_v16 v[4];
+    for (int i = 0; i < 4; ++i)
+      v[i] = crt_mem_load16(s + 16 * i);
+    crt_mem_store64_nt(d, v);
+  }
+  crt_mem_nt_fence();
+  for (int i = 0; i < 4; ++i)
+    crt_mem_store16(last + 16 * i, t[i]);
+}
+
+COMPILER_RT_ABI void *__compilerrt_memcpy(void *dst, const void *src,
+                                          size_t n) {
+  uint8_t *d = (uint8_t *)dst;
+  const uint8_t *s = (const uint8_t *)src;
+  if (n <= 128) {
+    crt_mem_copy_small(d, s, n);
+    return dst;
+  }
+  if (CRT_MEM_NONTEMPORAL_THRESHOLD && n >= CRT_MEM_NONTEMPORAL_THRESHOLD) {
+    copy_nontemporal(d, s, n);
+    return dst;
+  }
+#if defined(__x86_64__)
+  if (CRT_MEM_ERMS_THRESHOLD && n >= CRT_MEM_ERMS_THRESHOLD) {
+    __asm__ volatile("rep movsb" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+    return dst;
+  }
+#endif
+  crt_mem_copy_forward(d, s, n);
+  return dst;
+}
+
+COMPILER_RT_ALIAS(__compilerrt_memcpy, memcpy)
@@ -0,0 +1,31 @@
+//===-- memmove.c - Implement memmove -------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements memmove for targets without a C library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "int_mem.h"
+
+COMPILER_RT_ABI void *__compilerrt_memmove(void *dst, const void *src,
+                                           size_t n) {
+  uint8_t *d = (uint8_t *)dst;
+  const uint8_t *s = (const uint8_t *)src;
+  if (n <= 128) {
+    crt_mem_copy_small(d, s, n);
+    return dst;
+  }
+  // Copying front to back is right unless d lies inside the source.
+  if ((uintptr_t)d - (uintptr_t)s >= n)
+    crt_mem_copy_forward(d, s, n);
+  else
+    crt_mem_copy_backward(d, s, n);
+  return dst;
+}
+
+COMPILER_RT_ALIAS(__compilerrt_memmove, memmove)
@@ -0,0 +1,79 @@
+//===-- memset.c - Implement memset ---------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements memset for targets without a C library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "int_mem.h"
+
+COMPILER_RT_ABI void *__compilerrt_memset(void *dst, int c, size_t n) {
+  uint8_t *d = (uint8_t *)dst;
+  uint64_t b = 0x0101010101010101ULL * (uint8_t)c;
+  if (n <= 16) {
+    if (n >= 8) {
+      *(crt_mem_u64 *)d = b;
+      *(crt_mem_u64 *)(d + n - 8) = b;
+    } else if (n >= 4) {
+      *(crt_mem_u32 *)d = (uint32_t)b;
+      *(crt_mem_u32 *)(d + n - 4) = (uint32_t)b;
+    } else if (n >= 2) {
+      *(crt_mem_u16 *)d = (uint16_t)b;
+      *(crt_mem_u16 *)(d + n - 2) = (uint16_t)b;
+    } else if (n == 1) {
+      *d = (uint8_t)b;
+    }
+    return dst;
+  }
+  crt_mem_v16 v = (crt_mem_v16){0} + (uint8_t)c;
+  if (n <= 32) {
+    crt_mem_store16(d, v);
+    crt_mem_store16(d + n - 16, v);
+    return dst;
+  }
+  if (n <= 64) {
+    crt_mem_store16(d, v);
+    crt_mem_store16(d + 16, v);
+    crt_mem_store16(d + n - 32, v);
+    crt_mem_store16(d + n - 16, v);
+    return dst;
+  }
+#if defined(__x86_64__)
+  if (CRT_MEM_ERMS_THRESHOLD && n >= CRT_MEM_ERMS_THRESHOLD &&
+      !(CRT_MEM_NONTEMPORAL_THRESHOLD && n >= CRT_MEM_NONTEMPORAL_THRESHOLD)) {
+    __asm__ volatile("rep stosb" : "+D"(d), "+c"(n) : "a"(c) : "memory");
+    return dst;
+  }
+#endif
+  // Fill the first and last 64 bytes, then the 16-byte aligned blocks in
+  // between.
+  uint8_t *end = d + n;
+  for (int i = 0; i < 4; ++i) {
+    crt_mem_store16(d + 16 * i, v);
+    crt_mem_store16(end - 64 + 16 * i, v);
+  }
+  d = (uint8_t *)(((uintptr_t)d + 64) & ~(uintptr_t)15);
+  crt_mem_v16 vs[4] = {v, v, v, v};
+  int nontemporal =
+      CRT_MEM_NONTEMPORAL_THRESHOLD && n >= CRT_MEM_NONTEMPORAL_THRESHOLD;
+  for (; d + 64 <= end - 64; d += 64) {
+    if (nontemporal) {
+      crt_mem_store64_nt(d, vs);
+      continue;
+    }
+    for (int i = 0; i < 4; ++i)
+      crt_mem_store16(d + 16 * i, v);
+  }
+  if (nontemporal)
+    crt_mem_nt_fence();
+  for (; d < end - 64; d += 16)
+    crt_mem_store16(d, v);
+  return dst;
+}
+
+COMPILER_RT_ALIAS(__compilerrt_memset, memset)
@@ -41,8 +41,8 @@ struct InputInfo {
 };
 
 class InputCorpus {
-  static const size_t kFeatureSetSize = 1 << 21;
  public:
+  static const size_t kFeatureSetSize = 1 << 21;
   InputCorpus(const std::string &OutputCorpus) : OutputCorpus(OutputCorpus) {
     memset(InputSizesPerFeature, 0, sizeof(InputSizesPerFeature));
     memset(SmallestElementPerFeature, 0, sizeof(SmallestElementPerFeature));
@@ -667,6 +667,9 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
   Options.ReloadIntervalSec = Flags.reload;
   Options.OnlyASCII = Flags.only_ascii;
   Options.DetectLeaks = Flags.detect_leaks;
+  Options.Snapshot = Flags.snapshot;
+  if (Options.Snapshot)
+    Options.DetectLeaks = false;
   Options.PurgeAllocatorIntervalSec = Flags.purge_allocator_interval;
   Options.TraceMalloc = Flags.trace_malloc;
   Options.RssLimitMb = Flags.rss_limit_mb;
@@ -711,6 +714,9 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
   Options.LazyCounters = Flags.lazy_counters;
   if (Flags.stop_file)
     Options.StopFile = Flags.stop_file;
+  if (Flags.fork_shared_corpus)
+    Options.ForkSharedCorpus = Flags.fork_shared_corpus;
+  Options.ForkWorker = Flags.fork_worker;
 
   unsigned Seed = Flags.seed;
   // Initialize Seed.
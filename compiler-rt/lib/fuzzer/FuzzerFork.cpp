@@ -14,6 +14,7 @@
 #include "FuzzerInternal.h"
 #include "FuzzerMerge.h"
 #include "FuzzerSHA1.h"
+#include "FuzzerSharedCorpus.h"
 #include "FuzzerTracePC.h"
 #include "FuzzerUtil.h"
 
@@ -70,6 +71,7 @@ struct FuzzJob {
   std::string SeedListPath;
   std::string CFPath;
   size_t      JobId;
+  size_t      Worker;
 
   int         DftTimeInSeconds = 0;
 
@@ -96,6 +98,8 @@ struct GlobalEnv {
   Set<std::string> FilesWithDFT;
   Vector<std::string> Files;
   Random *Rand;
+  SharedCorpus Shared;
+  std::string SharedCorpusPath;
   std::chrono::system_clock::time_point ProcessStartTime;
   int Verbosity = 0;
 
@@ -114,7 +118,7 @@ struct GlobalEnv {
         .count();
   }
 
-  FuzzJob *CreateNewJob(size_t JobId) {
+  FuzzJob *CreateNewJob(size_t JobId, size_t Worker) {
     Command Cmd(Args);
     Cmd.removeFlag("fork");
     Cmd.removeFlag("runs");
@@ -126,6 +130,10 @@ struct GlobalEnv {
     Cmd.addFlag("print_funcs", "0");  // no need to spend time symbolizing.
     Cmd.addFlag("max_total_time", std::to_string(std::min((size_t)300, JobId)));
     Cmd.addFlag("stop_file", StopFile());
+    if (Shared.IsMapped()) {
+      Cmd.addFlag("fork_shared_corpus", SharedCorpusPath);
+      Cmd.addFlag("fork_worker", std::to_string(Worker));
+    }
     if (!DataFlowBinary.empty()) {
       Cmd.addFlag("data_flow_trace", DFTDir);
       if (!Cmd.hasFlag("focus_function"))
@@ -155,6 +163,7 @@ struct GlobalEnv {
     Job->FeaturesDir = DirPlusFile(TempDir, "F" + std::to_string(JobId));
     Job->CFPath = DirPlusFile(TempDir, std::to_string(JobId) + ".merge");
     Job->JobId = JobId;
+    Job->Worker = Worker;
 
 
     Cmd.addArgument(Job->CorpusDir);
@@ -229,6 +238,15 @@ struct GlobalEnv {
 
   }
 
+  void PrintWorkerStats() {
+    size_t Seconds = std::max((size_t)1, secondsSinceProcessStartUp());
+    for (size_t W = 0; W < Shared.NumWorkers(); W++) {
+      auto S = Shared.GetWorkerStats(W);
+      Printf("INFO: -fork: worker %zd: exec/s: %zd runs: %zd shared: %zd "
+             "received: %zd\n",
+             W, S.Runs / Seconds, S.Runs, S.Published, S.Received);
+    }
+  }
 
   void CollectDFT(const std::string &InputPath) {
     if (DataFlowBinary.empty()) return;
@@ -317,6 +335,13 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
   Printf("INFO: -fork=%d: %zd seed inputs, starting to fuzz in %s\n", NumJobs,
          Env.Files.size(), Env.TempDir.c_str());
 
+  // The jobs still hand their inputs to us through their corpus directories,
+  // but see each other's new inputs right away through shared memory.
+  Env.SharedCorpusPath = DirPlusFile(Env.TempDir, "shared");
+  if (Env.Shared.Create(Env.SharedCorpusPath, NumJobs))
+    for (auto Ft : Env.Features)
+      Env.Shared.AddFeature(Ft);
+
   int ExitCode = 0;
 
   JobQueue FuzzQ, MergeQ;
@@ -325,6 +350,7 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
     for (int i = 0; i < NumJobs; i++)
       FuzzQ.Push(nullptr);
     MergeQ.Push(nullptr);
+    Env.Shared.RequestStop();
     WriteToFile(Unit({1}), Env.StopFile());
   };
 
@@ -332,7 +358,7 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
   Vector<std::thread> Threads;
   for (int t = 0; t < NumJobs; t++) {
     Threads.push_back(std::thread(WorkerThread, &FuzzQ, &MergeQ));
-    FuzzQ.Push(Env.CreateNewJob(JobId++));
+    FuzzQ.Push(Env.CreateNewJob(JobId++, t));
   }
 
   while (true) {
@@ -348,6 +374,8 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
     Fuzzer::MaybeExitGracefully();
 
     Env.RunOneMergeJob(Job.get());
+    if (Env.Verbosity >= 2)
+      Env.PrintWorkerStats();
 
     // Continue if our crash is one of the ignorred ones.
     if (Options.IgnoreTimeouts && ExitCode == Options.TimeoutExitCode)
@@ -390,11 +418,12 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
       break;
     }
 
-    FuzzQ.Push(Env.CreateNewJob(JobId++));
+    FuzzQ.Push(Env.CreateNewJob(JobId++, Job->Worker));
   }
 
   for (auto &T : Threads)
     T.join();
+  Env.PrintWorkerStats();
 
   // The workers have terminated. Don't try to remove the directory before they
   // terminate to avoid a race condition preventing cleanup on Windows.
@@ -17,6 +17,8 @@
 #include "FuzzerInterface.h"
 #include "FuzzerOptions.h"
 #include "FuzzerSHA1.h"
+#include "FuzzerSharedCorpus.h"
+#include "FuzzerSnapshot.h"
 #include "FuzzerValueBitMap.h"
 #include <algorithm>
 #include <atomic>
@@ -39,6 +41,7 @@ public:
   void ReadAndExecuteSeedCorpora(Vector<SizedFile> &CorporaFiles);
   void MinimizeCrashLoop(const Unit &U);
   void RereadOutputCorpus(size_t MaxSize);
+  void ImportSharedUnits(size_t MaxSize);
 
   size_t secondsSinceProcessStartUp() {
     return duration_cast<seconds>(system_clock::now() - ProcessStartTime)
@@ -97,6 +100,7 @@ private:
   void PurgeAllocator();
   void ReportNewCoverage(InputInfo *II, const Unit &U);
   void PrintPulseAndReportSlowInput(const uint8_t *Data, size_t Size);
+  void ResetTargetState();
   void WriteUnitToFileWithPrefix(const Unit &U, const char *Prefix);
   void PrintStats(const char *Where, const char *End = "\n", size_t Units = 0,
                   size_t Features = 0);
@@ -129,6 +133,8 @@ private:
   MutationDispatcher &MD;
   FuzzingOptions Options;
   DataFlowTrace DFT;
+  SharedCorpus Shared;  // Mapped in -fork jobs.
+  MemorySnapshot Snapshot;  // Taken before the first run with -snapshot.
 
   system_clock::time_point ProcessStartTime = system_clock::now();
   system_clock::time_point UnitStartTime, UnitStopTime;
@@ -152,6 +152,10 @@ Fuzzer::Fuzzer(UserCallback CB, InputCorpus &Corpus, MutationDispatcher &MD,
     TPC.PrintModuleInfo();
   if (!Options.OutputCorpus.empty() && Options.ReloadIntervalSec)
     EpochOfLastReadOfOutputCorpus = GetEpoch(Options.OutputCorpus);
+  if (!Options.ForkSharedCorpus.empty() &&
+      !Shared.Attach(Options.ForkSharedCorpus, Options.ForkWorker))
+    Printf("WARNING: could not map the shared corpus %s\n",
+           Options.ForkSharedCorpus.c_str());
   MaxInputLen = MaxMutationLen = Options.MaxLen;
   TmpMaxMutationLen = 0;  // Will be set once we load the corpus.
   AllocateCurrentUnitData();
@@ -431,6 +435,24 @@ void Fuzzer::RereadOutputCorpus(size_t MaxSize) {
     PrintStats("RELOAD");
 }
 
+void Fuzzer::ImportSharedUnits(size_t MaxSize) {
+  Shared.UpdateRuns(TotalNumberOfRuns);
+  Unit U;
+  bool Imported = false;
+  while (Shared.NextNewUnit(&U)) {
+    if (U.size() > MaxSize)
+      U.resize(MaxSize);
+    if (!Corpus.HasUnit(U)) {
+      if (RunOne(U.data(), U.size())) {
+        CheckExitOnSrcPosOrItem();
+        Imported = true;
+      }
+    }
+  }
+  if (Imported)
+    PrintStats("IMPORT");
+}
+
 void Fuzzer::PrintPulseAndReportSlowInput(const uint8_t *Data, size_t Size) {
   auto TimeOfUnit =
       duration_cast<seconds>(UnitStopTime - UnitStartTime).count();
@@ -491,6 +513,7 @@ bool Fuzzer::RunOne(const uint8_t *Data, size_t Size, bool MayDeleteFile,
                                     UniqFeatureSetTmp, DFT, II);
     WriteFeatureSetToFile(Options.FeaturesDir, Sha1ToString(NewII->Sha1),
                           NewII->UniqFeatureSet);
+    Shared.Publish(Data, Size, NewII->UniqFeatureSet);
     return true;
   }
   if (II && FoundUniqFeaturesOfII &&
@@ -548,6 +571,8 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
   {
     ScopedEnableMsanInterceptorChecks S;
     AllocTracer.Start(Options.TraceMalloc);
+    if (Options.Snapshot)
+      ResetTargetState();
     UnitStartTime = system_clock::now();
     TPC.ResetMaps();
     RunningUserCallback = true;
@@ -564,6 +589,27 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
   delete[] DataCopy;
 }
 
+void Fuzzer::ResetTargetState() {
+  if (Snapshot.IsTaken()) {
+    Snapshot.Restore();
+    return;
+  }
+  Vector<uintptr_t> ModulePCs;
+  TPC.ForEachModulePC([&](uintptr_t PC) { ModulePCs.push_back(PC); });
+  Vector<MemorySnapshot::Range> Ranges;
+  MemorySnapshot::FindModuleData(ModulePCs, &Ranges);
+  if (!Snapshot.Take(Ranges)) {
+    Printf("WARNING: -snapshot=1: found no instrumented shared libraries to "
+           "reset; the target's own globals are only reset when it is built "
+           "as a shared library\n");
+    Options.Snapshot = false;
+    return;
+  }
+  Printf("INFO: -snapshot=1: resetting %zd bytes of globals before every run"
+         " (%s)\n", Snapshot.SavedBytes(),
+         Snapshot.TracksDirtyPages() ? "written pages only" : "all of them");
+}
+
 std::string Fuzzer::WriteToOutputCorpus(const Unit &U) {
   if (Options.OnlyASCII)
     assert(IsASCII(U));
@@ -802,9 +848,15 @@ void Fuzzer::Loop(Vector<SizedFile> &CorporaFiles) {
 
   while (true) {
     auto Now = system_clock::now();
-    if (!Options.StopFile.empty() &&
-        !FileToVector(Options.StopFile, 1, false).empty())
+    if (Shared.IsMapped()) {
+      // The shared stop flag saves polling the stop file.
+      if (Shared.StopRequested())
+        break;
+      ImportSharedUnits(MaxInputLen);
+    } else if (!Options.StopFile.empty() &&
+               !FileToVector(Options.StopFile, 1, false).empty()) {
       break;
+    }
     if (duration_cast<seconds>(Now - LastCorpusReload).count() >=
         Options.ReloadIntervalSec) {
       RereadOutputCorpus(MaxInputLen);
@@ -834,6 +886,7 @@ void Fuzzer::Loop(Vector<SizedFile> &CorporaFiles) {
     PurgeAllocator();
   }
 
+  Shared.UpdateRuns(TotalNumberOfRuns);
   PrintStats("DONE  ", "\n");
   MD.PrintRecommendedDictionary();
 }
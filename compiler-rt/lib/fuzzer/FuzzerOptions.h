@@ -54,6 +54,8 @@ struct FuzzingOptions {
   std::string CollectDataFlow;
   std::string FeaturesDir;
   std::string StopFile;
+  std::string ForkSharedCorpus;
+  int ForkWorker = 0;
   bool SaveArtifacts = true;
   bool PrintNEW = true; // Print a status line when new units are found;
   bool PrintNewCovPcs = false;
@@ -76,6 +78,7 @@ struct FuzzingOptions {
   bool HandleUsr1 = false;
   bool HandleUsr2 = false;
   bool LazyCounters = false;
+  bool Snapshot = false;
 };
 
 }  // namespace fuzzer
@@ -0,0 +1,183 @@
+//===- FuzzerSharedCorpus.cpp - corpus shared by -fork jobs ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// Shared memory exchange of inputs between -fork jobs.
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerSharedCorpus.h"
+#include "FuzzerCorpus.h"
+#include "FuzzerIO.h"
+#include "FuzzerUtil.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace fuzzer {
+
+const size_t SharedCorpus::kMaxUnitSize;
+const size_t SharedCorpus::kNumSlots;
+
+static const uint64_t kSharedCorpusMagic = 0x314d454853465a4cULL;
+
+struct SharedCorpus::Counters {
+  std::atomic<uint64_t> Runs;
+  std::atomic<uint64_t> Published;
+  std::atomic<uint64_t> Received;
+  // Keep the counters of different workers on different cache lines.
+  char Padding[64 - 3 * sizeof(uint64_t)];
+};
+
+// The file starts zero-filled, which is a valid empty region. The counters of
+// the workers follow the region.
+struct SharedCorpus::Region {
+  struct Slot {
+    // 2 * Pos + 1 while the input that was published Pos-th is written,
+    // 2 * Pos + 2 once it is complete.
+    std::atomic<uint64_t> Seq;
+    uint32_t Size;
+    uint32_t Worker;
+    uint8_t Data[kMaxUnitSize];
+  };
+
+  uint64_t Magic;
+  uint64_t NumWorkers;
+  std::atomic<uint64_t> Stop;
+  alignas(64) std::atomic<uint64_t> NextPos;
+  alignas(64) std::atomic<uint64_t> Features[InputCorpus::kFeatureSetSize / 64];
+  Slot Slots[kNumSlots];
+};
+
+size_t SharedCorpus::RegionSize(size_t NumWorkers) {
+  return sizeof(Region) + NumWorkers * sizeof(Counters);
+}
+
+SharedCorpus::~SharedCorpus() {
+  if (R)
+    UnmapSharedFile(R, MappedSize);
+}
+
+bool SharedCorpus::Create(const std::string &Path, size_t NumWorkers) {
+  size_t Size = RegionSize(NumWorkers);
+  void *P = MapSharedFile(Path, Size, /*Create=*/true);
+  if (!P)
+    return false;
+  R = static_cast<Region *>(P);
+  MappedSize = Size;
+  R->NumWorkers = NumWorkers;
+  R->Magic = kSharedCorpusMagic;
+  return true;
+}
+
+bool SharedCorpus::Attach(const std::string &Path, size_t Worker) {
+  size_t Size = FileSize(Path);
+  if (Size < sizeof(Region))
+    return false;
+  void *P = MapSharedFile(Path, Size, /*Create=*/false);
+  if (!P)
+    return false;
+  Region *Mapped = static_cast<Region *>(P);
+  if (Mapped->Magic != kSharedCorpusMagic ||
+      Size != RegionSize(Mapped->NumWorkers) || Worker >= Mapped->NumWorkers) {
+    UnmapSharedFile(P, Size);
+    return false;
+  }
+  R = Mapped;
+  MappedSize = Size;
+  this->Worker = Worker;
+  return true;
+}
+
+SharedCorpus::Counters &SharedCorpus::WorkerCounters(size_t Worker) const {
+  return reinterpret_cast<Counters *>(R + 1)[Worker];
+}
+
+bool SharedCorpus::AddFeature(uint32_t Feature) {
+  if (!R)
+    return false;
+  Feature %= InputCorpus::kFeatureSetSize;
+  auto &Word = R->Features[Feature / 64];
+  uint64_t Bit = 1ULL << (Feature % 64);
+  // Most features are old; don't write the shared line for those.
+  if (Word.load(std::memory_order_relaxed) & Bit)
+    return false;
+  return !(Word.fetch_or(Bit, std::memory_order_relaxed) & Bit);
+}
+
+bool SharedCorpus::Publish(const uint8_t *Data, size_t Size,
+                           const Vector<uint32_t> &Features) {
+  if (!R || Size > kMaxUnitSize)
+    return false;
+  bool HasNewFeatures = false;
+  for (auto Feature : Features)
+    HasNewFeatures |= AddFeature(Feature);
+  if (!HasNewFeatures)
+    return false;
+  uint64_t Pos = R->NextPos.fetch_add(1, std::memory_order_relaxed);
+  auto &S = R->Slots[Pos % kNumSlots];
+  S.Seq.store(2 * Pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  S.Size = Size;
+  S.Worker = Worker;
+  memcpy(S.Data, Data, Size);
+  S.Seq.store(2 * Pos + 2, std::memory_order_release);
+  WorkerCounters(Worker).Published.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool SharedCorpus::NextNewUnit(Unit *U) {
+  if (!R)
+    return false;
+  uint64_t End = R->NextPos.load(std::memory_order_acquire);
+  // Skip what has been overwritten already.
+  if (End - ReadPos > kNumSlots)
+    ReadPos = End - kNumSlots;
+  while (ReadPos < End) {
+    uint64_t Pos = ReadPos++;
+    auto &S = R->Slots[Pos % kNumSlots];
+    if (S.Seq.load(std::memory_order_acquire) != 2 * Pos + 2)
+      continue;
+    size_t Size = Min<size_t>(S.Size, kMaxUnitSize);
+    size_t Publisher = S.Worker;
+    U->assign(S.Data, S.Data + Size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Drop the copy if another job started to overwrite the slot meanwhile.
+    if (S.Seq.load(std::memory_order_relaxed) != 2 * Pos + 2 ||
+        Publisher == Worker)
+      continue;
+    WorkerCounters(Worker).Received.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void SharedCorpus::UpdateRuns(size_t TotalNumberOfRuns) {
+  if (!R)
+    return;
+  WorkerCounters(Worker).Runs.fetch_add(
+      TotalNumberOfRuns - LastTotalNumberOfRuns, std::memory_order_relaxed);
+  LastTotalNumberOfRuns = TotalNumberOfRuns;
+}
+
+SharedCorpus::WorkerStats SharedCorpus::GetWorkerStats(size_t Worker) const {
+  auto &C = WorkerCounters(Worker);
+  return {C.Runs.load(std::memory_order_relaxed),
+          C.Published.load(std::memory_order_relaxed),
+          C.Received.load(std::memory_order_relaxed)};
+}
+
+size_t SharedCorpus::NumWorkers() const { return R ? R->NumWorkers : 0; }
+
+void SharedCorpus::RequestStop() {
+  if (R)
+    R->Stop.store(1, std::memory_order_relaxed);
+}
+
+bool SharedCorpus::StopRequested() const {
+  return R && R->Stop.load(std::memory_order_relaxed);
+}
+
+} // namespace fuzzer
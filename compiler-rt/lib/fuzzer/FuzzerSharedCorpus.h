@@ -0,0 +1,88 @@
+//===- FuzzerSharedCorpus.h - corpus shared by -fork jobs -------*- C++ -* ===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// A region of shared memory through which the jobs of -fork=N hand each other
+// new inputs as soon as they find them, rather than only through the corpus
+// directories that the parent merges when a job ends.
+//
+// The region holds:
+//   * one bit per feature, set by the first job that finds the feature;
+//   * a ring of the inputs that set new bits, which every other job runs;
+//   * counters for every worker (the parent's job slots), which the parent
+//     reports;
+//   * a stop flag, which the jobs check instead of polling -stop_file.
+//
+// The ring never blocks. An input that is being written while a job reads
+// its slot, or that is overwritten before a job gets to it, is not run by
+// that job; the parent still merges it from the corpus directory.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_FUZZER_SHARED_CORPUS_H
+#define LLVM_FUZZER_SHARED_CORPUS_H
+
+#include "FuzzerDefs.h"
+
+#include <string>
+
+namespace fuzzer {
+
+class SharedCorpus {
+public:
+  // Inputs larger than this are only exchanged through the file system.
+  static const size_t kMaxUnitSize = 4096;
+  static const size_t kNumSlots = 1024;
+
+  struct WorkerStats {
+    size_t Runs;       // Inputs executed.
+    size_t Published;  // Inputs with new features handed to the other jobs.
+    size_t Received;   // Inputs taken from the other jobs.
+  };
+
+  ~SharedCorpus();
+
+  // Creates the region in a new file at Path with counters for NumWorkers.
+  // Returns false if the platform cannot share memory between processes.
+  bool Create(const std::string &Path, size_t NumWorkers);
+  // Maps the region that the parent created at Path, as worker Worker.
+  bool Attach(const std::string &Path, size_t Worker);
+  bool IsMapped() const { return R != nullptr; }
+
+  // Marks Feature as found. Returns true if no job had found it before.
+  bool AddFeature(uint32_t Feature);
+  // Hands the input to the other jobs if any of its Features is new to all
+  // of them.
+  bool Publish(const uint8_t *Data, size_t Size,
+               const Vector<uint32_t> &Features);
+  // Copies the next input published by another job since the last call into
+  // U. Returns false when there is none.
+  bool NextNewUnit(Unit *U);
+
+  // Adds the runs since the last call to this worker's counters.
+  void UpdateRuns(size_t TotalNumberOfRuns);
+  WorkerStats GetWorkerStats(size_t Worker) const;
+  size_t NumWorkers() const;
+
+  void RequestStop();
+  bool StopRequested() const;
+
+private:
+  struct Region;
+  struct Counters;
+
+  static size_t RegionSize(size_t NumWorkers);
+  Counters &WorkerCounters(size_t Worker) const;
+
+  Region *R = nullptr;
+  size_t MappedSize = 0;
+  size_t Worker = 0;
+  uint64_t ReadPos = 0;
+  size_t LastTotalNumberOfRuns = 0;
+};
+
+} // namespace fuzzer
+
+#endif // LLVM_FUZZER_SHARED_CORPUS_H
@@ -0,0 +1,191 @@
+//===- FuzzerSnapshot.cpp - reset the target's globals --------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// MemorySnapshot, implemented on Linux only.
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerSnapshot.h"
+
+#if LIBFUZZER_LINUX
+#include <fcntl.h>
+#include <link.h>
+#include <unistd.h>
+
+namespace fuzzer {
+
+static const uint64_t kPagemapSoftDirty = 1ULL << 55;
+
+static size_t PageSize() {
+  static const size_t Size = sysconf(_SC_PAGESIZE);
+  return Size;
+}
+
+// Copies memory without calling memcpy. The sanitizers intercept memcpy and
+// would report the redzones around the target's globals.
+static void CopyWords(uint8_t *Dst, const uint8_t *Src, size_t Size) {
+  volatile uint64_t *D = reinterpret_cast<volatile uint64_t *>(Dst);
+  const uint64_t *S = reinterpret_cast<const uint64_t *>(Src);
+  for (size_t i = 0; i < Size / sizeof(uint64_t); i++)
+    D[i] = S[i];
+}
+
+namespace {
+struct FindModuleDataContext {
+  const Vector<uintptr_t> *ModulePCs;
+  uintptr_t OwnPC;
+  Vector<MemorySnapshot::Range> *Ranges;
+};
+} // namespace
+
+static bool IsInCode(const dl_phdr_info *Info, uintptr_t PC) {
+  for (size_t i = 0; i < Info->dlpi_phnum; i++) {
+    const auto &Ph = Info->dlpi_phdr[i];
+    if (Ph.p_type == PT_LOAD && (Ph.p_flags & PF_X) &&
+        PC - (Info->dlpi_addr + Ph.p_vaddr) < Ph.p_memsz)
+      return true;
+  }
+  return false;
+}
+
+static int FindModuleDataCallback(dl_phdr_info *Info, size_t InfoSize,
+                                  void *Data) {
+  auto *Ctx = static_cast<FindModuleDataContext *>(Data);
+  if (IsInCode(Info, Ctx->OwnPC))
+    return 0;
+  bool Instrumented = false;
+  for (auto PC : *Ctx->ModulePCs)
+    Instrumented |= IsInCode(Info, PC);
+  if (!Instrumented)
+    return 0;
+  size_t Page = PageSize();
+  // The dynamic loader makes the start of the data read-only after the
+  // relocations are applied.
+  uintptr_t RelroEnd = 0;
+  for (size_t i = 0; i < Info->dlpi_phnum; i++) {
+    const auto &Ph = Info->dlpi_phdr[i];
+    if (Ph.p_type == PT_GNU_RELRO)
+      RelroEnd = (Info->dlpi_addr + Ph.p_vaddr + Ph.p_memsz) & ~(Page - 1);
+  }
+  for (size_t i = 0; i < Info->dlpi_phnum; i++) {
+    const auto &Ph = Info->dlpi_phdr[i];
+    if (Ph.p_type != PT_LOAD || !(Ph.p_flags & PF_W))
+      continue;
+    uintptr_t Beg = (Info->dlpi_addr + Ph.p_vaddr) & ~(Page - 1);
+    uintptr_t End =
+        (Info->dlpi_addr + Ph.p_vaddr + Ph.p_memsz + Page - 1) & ~(Page - 1);
+    if (Beg < RelroEnd && RelroEnd <= End)
+      Beg = RelroEnd;
+    if (Beg < End)
+      Ctx->Ranges->push_back({reinterpret_cast<uint8_t *>(Beg), End - Beg});
+  }
+  return 0;
+}
+
+void MemorySnapshot::FindModuleData(const Vector<uintptr_t> &ModulePCs,
+                                    Vector<Range> *Ranges) {
+  FindModuleDataContext Ctx = {
+      &ModulePCs, reinterpret_cast<uintptr_t>(&FindModuleDataCallback),
+      Ranges};
+  dl_iterate_phdr(FindModuleDataCallback, &Ctx);
+}
+
+MemorySnapshot::~MemorySnapshot() {
+  if (PagemapFd >= 0)
+    close(PagemapFd);
+  if (ClearRefsFd >= 0)
+    close(ClearRefsFd);
+}
+
+bool MemorySnapshot::Take(const Vector<Range> &NewRanges) {
+  size_t Total = 0;
+  for (auto &R : NewRanges)
+    Total += R.Size;
+  if (!Total)
+    return false;
+  Ranges = NewRanges;
+  Saved.resize(Total);
+  uint8_t *Dst = Saved.data();
+  for (auto &R : Ranges) {
+    CopyWords(Dst, R.Start, R.Size);
+    Dst += R.Size;
+  }
+
+  // Check that the kernel sets soft-dirty bits (CONFIG_MEM_SOFT_DIRTY).
+  PagemapFd = open("/proc/self/pagemap", O_RDONLY);
+  ClearRefsFd = open("/proc/self/clear_refs", O_WRONLY);
+  if (PagemapFd >= 0 && ClearRefsFd >= 0) {
+    ClearDirtyBits();
+    volatile uint8_t *Probe = Ranges[0].Start;
+    *Probe = *Probe;
+    uint64_t Entry = 0;
+    off_t Offset = reinterpret_cast<uintptr_t>(Probe) / PageSize() *
+                   sizeof(Entry);
+    if (pread(PagemapFd, &Entry, sizeof(Entry), Offset) == sizeof(Entry) &&
+        (Entry & kPagemapSoftDirty))
+      return true;
+  }
+  if (PagemapFd >= 0)
+    close(PagemapFd);
+  if (ClearRefsFd >= 0)
+    close(ClearRefsFd);
+  PagemapFd = ClearRefsFd = -1;
+  return true;
+}
+
+void MemorySnapshot::ClearDirtyBits() {
+  // "4" clears the soft-dirty bits of every page of the process.
+  if (write(ClearRefsFd, "4", 1) != 1) {
+    close(PagemapFd);
+    close(ClearRefsFd);
+    PagemapFd = ClearRefsFd = -1;
+  }
+}
+
+void MemorySnapshot::Restore() {
+  size_t Page = PageSize();
+  const uint8_t *Src = Saved.data();
+  for (auto &R : Ranges) {
+    size_t NumPages = R.Size / Page;
+    PagemapEntries.resize(NumPages);
+    size_t Bytes = NumPages * sizeof(PagemapEntries[0]);
+    off_t Offset = reinterpret_cast<uintptr_t>(R.Start) / Page *
+                   sizeof(PagemapEntries[0]);
+    if (PagemapFd < 0 ||
+        pread(PagemapFd, PagemapEntries.data(), Bytes, Offset) !=
+            static_cast<ssize_t>(Bytes)) {
+      CopyWords(R.Start, Src, R.Size);
+    } else {
+      for (size_t i = 0; i < NumPages; i++)
+        if (PagemapEntries[i] & kPagemapSoftDirty)
+          CopyWords(R.Start + i * Page, Src + i * Page, Page);
+    }
+    Src += R.Size;
+  }
+  if (PagemapFd >= 0)
+    ClearDirtyBits();
+}
+
+} // namespace fuzzer
+
+#else
+
+namespace fuzzer {
+
+void MemorySnapshot::FindModuleData(const Vector<uintptr_t> &ModulePCs,
+                                    Vector<Range> *Ranges) {}
+
+MemorySnapshot::~MemorySnapshot() {}
+
+bool MemorySnapshot::Take(const Vector<Range> &NewRanges) { return false; }
+
+void MemorySnapshot::ClearDirtyBits() {}
+
+void MemorySnapshot::Restore() {}
+
+} // namespace fuzzer
+
+#endif // LIBFUZZER_LINUX
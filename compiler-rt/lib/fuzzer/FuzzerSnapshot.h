@@ -0,0 +1,61 @@
+//===- FuzzerSnapshot.h - reset the target's globals ------------*- C++ -* ===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// MemorySnapshot saves writable memory once and puts it back before every
+// run, so that a target with global state behaves as if each input were its
+// first.
+//
+// Only the pages written since the last restore are copied back. On Linux
+// they are found through the soft-dirty bits of /proc/self/pagemap; where the
+// kernel lacks those, all of the saved memory is copied back.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_FUZZER_SNAPSHOT_H
+#define LLVM_FUZZER_SNAPSHOT_H
+
+#include "FuzzerDefs.h"
+
+namespace fuzzer {
+
+class MemorySnapshot {
+public:
+  struct Range {
+    uint8_t *Start;
+    size_t Size;
+  };
+
+  ~MemorySnapshot();
+
+  // Finds the writable segments of the modules whose code contains one of
+  // ModulePCs, other than the module that contains libFuzzer itself. The
+  // state of libFuzzer, the sanitizer runtime and the C library must not be
+  // reset, so only instrumented code in shared libraries qualifies.
+  static void FindModuleData(const Vector<uintptr_t> &ModulePCs,
+                             Vector<Range> *Ranges);
+
+  // Saves the contents of the page-aligned Ranges. Returns false if there is
+  // nothing to save or the platform is not supported.
+  bool Take(const Vector<Range> &Ranges);
+  bool IsTaken() const { return !Saved.empty(); }
+  void Restore();
+
+  size_t SavedBytes() const { return Saved.size(); }
+  bool TracksDirtyPages() const { return PagemapFd >= 0; }
+
+private:
+  void ClearDirtyBits();
+
+  Vector<Range> Ranges;
+  Unit Saved;
+  Vector<uint64_t> PagemapEntries;
+  int PagemapFd = -1;
+  int ClearRefsFd = -1;
+};
+
+} // namespace fuzzer
+
+#endif // LLVM_FUZZER_SNAPSHOT_H
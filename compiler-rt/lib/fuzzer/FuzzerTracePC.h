@@ -99,6 +99,13 @@ class TracePC {
   template<class CallBack>
   void IterateCoveredFunctions(CallBack CB);
 
+  // Calls CB with a PC from every module with a PC table.
+  template <class Callback> void ForEachModulePC(Callback CB) const {
+    for (size_t i = 0; i < NumPCTables; i++)
+      if (ModulePCTable[i].Start < ModulePCTable[i].Stop)
+        CB(ModulePCTable[i].Start->PC);
+  }
+
   void AddValueForMemcmp(void *caller_pc, const void *s1, const void *s2,
                          size_t n, bool StopAtZero);
 
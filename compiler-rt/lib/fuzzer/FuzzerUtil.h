@@ -54,6 +54,13 @@ void SleepSeconds(int Seconds);
 
 bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite);
 
+// Maps the file at Path, shared with every other process that maps it. With
+// Create, first creates the file filled with Size zero bytes. Returns nullptr
+// on failure and where this is not supported.
+void *MapSharedFile(const std::string &Path, size_t Size, bool Create);
+
+void UnmapSharedFile(void *Ptr, size_t Size);
+
 unsigned long GetPid();
 
 size_t GetPeakRSSMb();
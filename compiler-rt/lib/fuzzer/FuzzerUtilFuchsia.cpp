@@ -309,6 +309,12 @@ bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite) {
   return false;  // UNIMPLEMENTED
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size, bool Create) {
+  return nullptr;  // UNIMPLEMENTED
+}
+
+void UnmapSharedFile(void *Ptr, size_t Size) {}
+
 // Platform specific functions.
 void SetSignalHandler(const FuzzingOptions &Options) {
   // Set up alarm handler if needed.
@@ -16,6 +16,7 @@
 #include <chrono>
 #include <cstring>
 #include <errno.h>
+#include <fcntl.h>
 #include <iomanip>
 #include <signal.h>
 #include <stdio.h>
@@ -103,6 +104,23 @@ bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite) {
                        AllowReadWrite ? (PROT_READ | PROT_WRITE) : PROT_NONE);
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size, bool Create) {
+  int Fd = open(Path.c_str(), Create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR,
+                0600);
+  if (Fd < 0)
+    return nullptr;
+  void *Ptr = nullptr;
+  if (!Create || ftruncate(Fd, Size) == 0) {
+    Ptr = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (Ptr == MAP_FAILED)
+      Ptr = nullptr;
+  }
+  close(Fd);
+  return Ptr;
+}
+
+void UnmapSharedFile(void *Ptr, size_t Size) { munmap(Ptr, Size); }
+
 void SetSignalHandler(const FuzzingOptions& Options) {
   if (Options.UnitTimeoutSec > 0)
     SetTimer(Options.UnitTimeoutSec / 2 + 1);
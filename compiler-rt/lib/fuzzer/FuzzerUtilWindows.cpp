@@ -115,6 +115,12 @@ bool Mprotect(void *Ptr, size_t Size, bool AllowReadWrite) {
   return false;  // UNIMPLEMENTED
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size, bool Create) {
+  return nullptr;  // UNIMPLEMENTED
+}
+
+void UnmapSharedFile(void *Ptr, size_t Size) {}
+
 void SetSignalHandler(const FuzzingOptions& Options) {
   HandlerOpt = &Options;
 
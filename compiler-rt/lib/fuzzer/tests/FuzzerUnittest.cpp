@@ -609,6 +609,81 @@ TEST(Corpus, Distribution) {
   }
 }
 
+TEST(SharedCorpus, Exchange) {
+  std::string Path = TempPath(".shared");
+  SharedCorpus Parent, W0, W1;
+  if (!Parent.Create(Path, 2))
+    return;  // Not supported on this platform.
+  EXPECT_TRUE(Parent.AddFeature(1));
+  ASSERT_TRUE(W0.Attach(Path, 0));
+  ASSERT_TRUE(W1.Attach(Path, 1));
+  EXPECT_FALSE(W0.Attach(Path, 2));
+
+  Unit U;
+  uint8_t A[] = {'a'}, B[] = {'b', 'b'};
+  EXPECT_FALSE(W0.Publish(A, sizeof(A), {1}));  // The parent knows 1.
+  EXPECT_TRUE(W0.Publish(A, sizeof(A), {1, 2}));
+  EXPECT_FALSE(W1.Publish(B, sizeof(B), {2}));
+  EXPECT_FALSE(W0.NextNewUnit(&U));  // Own inputs are skipped.
+  EXPECT_TRUE(W1.NextNewUnit(&U));
+  EXPECT_EQ(U, Unit({'a'}));
+  EXPECT_FALSE(W1.NextNewUnit(&U));
+
+  // Readers that fall behind skip what has been overwritten.
+  for (size_t i = 0; i < SharedCorpus::kNumSlots + 3; i++) {
+    uint8_t Data[] = {static_cast<uint8_t>(i)};
+    EXPECT_TRUE(W1.Publish(Data, sizeof(Data), {uint32_t(i + 3)}));
+  }
+  size_t Received = 0;
+  while (W0.NextNewUnit(&U)) {
+    EXPECT_EQ(U, Unit({static_cast<uint8_t>(Received + 3)}));
+    Received++;
+  }
+  EXPECT_EQ(Received, SharedCorpus::kNumSlots);
+
+  W0.UpdateRuns(10);
+  W0.UpdateRuns(15);
+  auto S0 = Parent.GetWorkerStats(0), S1 = Parent.GetWorkerStats(1);
+  EXPECT_EQ(S0.Runs, 15U);
+  EXPECT_EQ(S0.Published, 1U);
+  EXPECT_EQ(S0.Received, SharedCorpus::kNumSlots);
+  EXPECT_EQ(S1.Published, SharedCorpus::kNumSlots + 3);
+  EXPECT_EQ(S1.Received, 1U);
+
+  EXPECT_FALSE(W1.StopRequested());
+  Parent.RequestStop();
+  EXPECT_TRUE(W1.StopRequested());
+  RemoveFile(Path);
+}
+
+TEST(MemorySnapshot, Restore) {
+  const size_t kPage = 4096;
+  alignas(kPage) static uint8_t Buf[4 * kPage];
+  for (size_t i = 0; i < sizeof(Buf); i++)
+    Buf[i] = i % 251;
+  MemorySnapshot S;
+  if (!S.Take({{Buf, sizeof(Buf)}}))
+    return;  // Not supported on this platform.
+  EXPECT_EQ(S.SavedBytes(), sizeof(Buf));
+  for (int Run = 0; Run < 3; Run++) {
+    Buf[kPage + Run] = 0xff;
+    Buf[3 * kPage + 100] = Run;
+    S.Restore();
+    for (size_t i = 0; i < sizeof(Buf); i++)
+      ASSERT_EQ(Buf[i], i % 251);
+  }
+}
+
+TEST(MemorySnapshot, FindModuleData) {
+  Vector<MemorySnapshot::Range> Ranges;
+  MemorySnapshot::FindModuleData({}, &Ranges);
+  EXPECT_TRUE(Ranges.empty());
+  // libFuzzer's own globals are never reset.
+  MemorySnapshot::FindModuleData(
+      {reinterpret_cast<uintptr_t>(&MemorySnapshot::FindModuleData)}, &Ranges);
+  EXPECT_TRUE(Ranges.empty());
+}
+
 TEST(Merge, Bad) {
   const char *kInvalidInputs[] = {
     "",
@@ -286,15 +286,47 @@ const char *GetStackOriginDescr(u32 id, uptr *pc) {
   return StackOriginDescr[id];
 }
 
+bool SampleStoreOrigin() {
+  int rate = flags()->origin_history_sample_rate;
+  if (rate <= 1)
+    return true;
+  MsanThread *t = GetCurrentThread();
+  return !t || t->SampleStoreOrigin(rate);
+}
+
+// Two different stacks are taken to be the same when their 64-bit hashes
+// collide, which is rare enough not to matter for a diagnostic history.
+static u64 HashStoreStack(const StackTrace &stack) {
+  u64 h = stack.size;
+  for (uptr i = 0; i < stack.size; i++) {
+    h = (h ^ stack.trace[i]) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+  }
+  return h;
+}
+
 u32 ChainOrigin(u32 id, StackTrace *stack) {
   MsanThread *t = GetCurrentThread();
   if (t && t->InSignalHandler())
     return id;
+  // Stores that SampleStoreOrigin() skipped come without a stack.
+  if (!stack->size)
+    return id;
 
   Origin o = Origin::FromRawId(id);
   stack->tag = StackTrace::TAG_UNKNOWN;
-  Origin chained = Origin::CreateChainedOrigin(o, stack);
-  return chained.raw_id();
+  if (!t)
+    return Origin::CreateChainedOrigin(o, stack).raw_id();
+
+  // A store in a loop chains the same origin to the same stack over and over;
+  // answer those without going through both depots.
+  u64 stack_hash = HashStoreStack(*stack);
+  u32 chained;
+  if (t->LookupChainedOrigin(stack_hash, id, &chained))
+    return chained;
+  chained = Origin::CreateChainedOrigin(o, stack).raw_id();
+  t->CacheChainedOrigin(stack_hash, id, chained);
+  return chained;
 }
 
 } // namespace __msan
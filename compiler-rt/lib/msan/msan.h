@@ -320,6 +320,7 @@ void UnpoisonThreadLocalState();
 // Returns a "chained" origin id, pointing to the given stack trace followed by
 // the previous origin id.
 u32 ChainOrigin(u32 id, StackTrace *stack);
+bool SampleStoreOrigin();
 
 const int STACK_TRACE_TAG_POISON = StackTrace::TAG_CUSTOM + 1;
 
@@ -334,9 +335,10 @@ const int STACK_TRACE_TAG_POISON = StackTrace::TAG_CUSTOM + 1;
 // size to 1, basically only storing the current pc. We do this because the slow
 // unwinder which is based on libunwind is not async signal safe and causes
 // random freezes in forking applications as well as in signal handlers.
+// Stores that origin_history_sample_rate leaves out are not unwound at all.
 #define GET_STORE_STACK_TRACE_PC_BP(pc, bp)                                    \
   BufferedStackTrace stack;                                                    \
-  if (__msan_get_track_origins() > 1 && msan_inited) {                         \
+  if (__msan_get_track_origins() > 1 && msan_inited && SampleStoreOrigin()) {  \
     int size = flags()->store_context_size;                                    \
     if (!SANITIZER_CAN_FAST_UNWIND)                                            \
       size = Min(size, 1);                                                     \
@@ -48,6 +48,46 @@ void MsanThread::Init() {
   ClearShadowForThreadStackAndTLS();
 }
 
+bool MsanThread::SampleStoreOrigin(u32 rate) {
+  if (store_origin_countdown_) {
+    store_origin_countdown_--;
+    return false;
+  }
+  // The gaps between recorded stores are random so that the recorded stores
+  // do not lock onto the iterations of a loop.
+  u32 x = store_origin_rand_;
+  if (!x)
+    x = (u32)NanoTime() ^ (u32)(uptr)this | 1;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  store_origin_rand_ = x;
+  store_origin_countdown_ = x % (2 * (u64)rate - 1);
+  return true;
+}
+
+static uptr ChainedOriginCacheIndex(u64 stack_hash, u32 prev_id, uptr size) {
+  u64 h = (stack_hash ^ prev_id) * 0x9E3779B97F4A7C15ULL;
+  return (h >> 32) & (size - 1);
+}
+
+bool MsanThread::LookupChainedOrigin(u64 stack_hash, u32 prev_id, u32 *id) {
+  ChainedOriginCacheEntry &e = chained_origin_cache_[ChainedOriginCacheIndex(
+      stack_hash, prev_id, kChainedOriginCacheSize)];
+  if (!e.id || e.stack_hash != stack_hash || e.prev_id != prev_id)
+    return false;
+  *id = e.id;
+  return true;
+}
+
+void MsanThread::CacheChainedOrigin(u64 stack_hash, u32 prev_id, u32 id) {
+  ChainedOriginCacheEntry &e = chained_origin_cache_[ChainedOriginCacheIndex(
+      stack_hash, prev_id, kChainedOriginCacheSize)];
+  e.stack_hash = stack_hash;
+  e.prev_id = prev_id;
+  e.id = id;
+}
+
 void MsanThread::TSDDtor(void *tsd) {
   MsanThread *t = (MsanThread*)tsd;
   t->Destroy();
@@ -43,6 +43,16 @@ class MsanThread {
 
   MsanThreadLocalMallocStorage &malloc_storage() { return malloc_storage_; }
 
+  // Returns whether the next store of an uninitialized value should be
+  // recorded in its origin history. About one store in rate is.
+  bool SampleStoreOrigin(u32 rate);
+
+  // Per-thread cache in front of the chained origin depot, keyed by the hash
+  // of the store stack and the origin that was stored. Both depots only ever
+  // grow, so a cached chained origin stays valid for the life of the process.
+  bool LookupChainedOrigin(u64 stack_hash, u32 prev_id, u32 *id);
+  void CacheChainedOrigin(u64 stack_hash, u32 prev_id, u32 id);
+
   int destructor_iterations_;
 
  private:
@@ -59,6 +69,17 @@ class MsanThread {
 
   unsigned in_signal_handler_;
 
+  struct ChainedOriginCacheEntry {
+    u64 stack_hash;
+    u32 prev_id;
+    u32 id;  // 0 for an empty entry.
+  };
+  static const uptr kChainedOriginCacheSize = 256;
+  ChainedOriginCacheEntry chained_origin_cache_[kChainedOriginCacheSize];
+
+  u32 store_origin_countdown_;
+  u32 store_origin_rand_;
+
   MsanThreadLocalMallocStorage malloc_storage_;
 };
 
@@ -39,6 +39,18 @@ COMPILER_RT_VISIBILITY void __llvm_profile_set_dumped() {
   lprofSetProfileDumped();
 }
 
+static int ContinuousModeEnabled = 0;
+static intptr_t ContinuousModeCountersBias = 0;
+
+COMPILER_RT_VISIBILITY int __llvm_profile_is_continuous_mode_enabled(void) {
+  return ContinuousModeEnabled;
+}
+
+COMPILER_RT_VISIBILITY void lprofEnableContinuousMode(intptr_t CountersBias) {
+  ContinuousModeCountersBias = CountersBias;
+  ContinuousModeEnabled = 1;
+}
+
 /* Return the number of bytes needed to add to SizeInBytes to make it
  *   the result a multiple of 8.
  */
@@ -55,6 +67,12 @@ COMPILER_RT_VISIBILITY void __llvm_profile_reset_counters(void) {
   uint64_t *I = __llvm_profile_begin_counters();
   uint64_t *E = __llvm_profile_end_counters();
 
+  /* In continuous mode the counters in use are the ones in the file. */
+  if (ContinuousModeEnabled) {
+    I = (uint64_t *)((char *)I + ContinuousModeCountersBias);
+    E = (uint64_t *)((char *)E + ContinuousModeCountersBias);
+  }
+
   memset(I, 0, sizeof(uint64_t) * (E - I));
 
   const __llvm_profile_data *DataBegin = __llvm_profile_begin_data();
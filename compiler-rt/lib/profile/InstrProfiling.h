@@ -218,6 +218,14 @@ uint64_t __llvm_profile_get_data_size(const __llvm_profile_data *Begin,
  */
 void __llvm_profile_set_dumped();
 
+/*!
+ * \brief Return non zero value if the profile is in continuous mode.
+ * In continuous mode (the %c specifier in the profile name), the counters
+ * the program updates live in a shared mapping of the profile file, so the
+ * file on disk is always current and nothing needs to be written at exit.
+ */
+int __llvm_profile_is_continuous_mode_enabled(void);
+
 /*!
  * This variable is defined in InstrProfilingRuntime.cpp as a hidden
  * symbol. Its main purpose is to enable profile runtime user to
@@ -84,10 +84,13 @@ typedef struct lprofFilename {
    * can only appear once at the end of the name pattern. */
   unsigned MergePoolSize;
   ProfileNameSpecifier PNS;
+  /* Set by the %c specifier: keep the counters in a mapping of the profile
+   * file instead of writing them out at exit. */
+  unsigned ContinuousMode;
 } lprofFilename;
 
-COMPILER_RT_WEAK lprofFilename lprofCurFilename = {0,   0, 0, 0, {0},
-                                                   {0}, 0, 0, 0, PNS_unknown};
+COMPILER_RT_WEAK lprofFilename lprofCurFilename = {
+    0, 0, 0, 0, {0}, {0}, 0, 0, 0, PNS_unknown, 0};
 
 static int ProfileMergeRequested = 0;
 static int isProfileMergeRequested() { return ProfileMergeRequested; }
@@ -331,6 +334,96 @@ static int writeOrderFile(const char *OutputName) {
   return RetVal;
 }
 
+#if !defined(_WIN32)
+/* Defined by the compiler in code built with runtime counter relocation
+ * (-mllvm -runtime-counter-relocation), and null otherwise. */
+COMPILER_RT_VISIBILITY extern intptr_t
+    INSTR_PROF_PROFILE_COUNTER_BIAS_VAR COMPILER_RT_WEAK;
+#endif
+
+/* Write the profile to the current file once, map the counters part of the
+ * file back into memory and point the instrumented code at the mapping. From
+ * then on every counter update goes straight to the file, which stays current
+ * even if the process is killed, and nothing is left to write at exit.
+ *
+ * Value profile data is written as it is at this point and not updated later.
+ * Processes forked afterwards keep updating the same file. */
+static void initializeProfileForContinuousMode(void) {
+#if defined(_WIN32)
+  PROF_ERR("%s\n", "Continuous mode is not supported on Windows.");
+#else
+  const __llvm_profile_data *DataBegin = __llvm_profile_begin_data();
+  const __llvm_profile_data *DataEnd = __llvm_profile_end_data();
+  const uint64_t *CountersBegin = __llvm_profile_begin_counters();
+  const uint64_t *CountersEnd = __llvm_profile_end_counters();
+  uint64_t DataSize = __llvm_profile_get_data_size(DataBegin, DataEnd);
+  size_t FileOffsetToCounters, MappingSize;
+  const char *Filename;
+  char *FilenameBuf;
+  char *Profile;
+  FILE *File;
+  int Length, MergeDone = 0;
+
+  if (__llvm_profile_is_continuous_mode_enabled())
+    return;
+
+  if (!&INSTR_PROF_PROFILE_COUNTER_BIAS_VAR) {
+    PROF_ERR("%s\n", "Continuous mode needs code built with "
+                     "-mllvm -runtime-counter-relocation.");
+    return;
+  }
+
+  /* Nothing is instrumented, so there is nothing to keep current. */
+  if (!DataSize || CountersBegin == CountersEnd)
+    return;
+
+  Length = getCurFilenameLength();
+  FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
+  Filename = getCurFilename(FilenameBuf, 0);
+  if (!Filename)
+    return;
+
+  /* With %m this also merges in the counters of earlier runs, which then go
+   * on accumulating in the file. */
+  if (doMerging())
+    File = openFileForMerging(Filename, &MergeDone);
+  else {
+    createProfileDir(Filename);
+    File = getProfileFile() ? getProfileFile() : fopen(Filename, "w+b");
+  }
+  if (!File) {
+    PROF_ERR("Failed to open file \"%s\": %s\n", Filename, strerror(errno));
+    return;
+  }
+
+  ProfDataWriter fileWriter;
+  initFileWriter(&fileWriter, File);
+  FileOffsetToCounters =
+      sizeof(__llvm_profile_header) + DataSize * sizeof(__llvm_profile_data);
+  MappingSize =
+      FileOffsetToCounters + (CountersEnd - CountersBegin) * sizeof(uint64_t);
+  Profile = MAP_FAILED;
+  if (!lprofWriteData(&fileWriter, 0, MergeDone) && !fflush(File))
+    Profile = (char *)mmap(NULL, MappingSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fileno(File), 0);
+  if (Profile == MAP_FAILED)
+    PROF_ERR("Failed to map file \"%s\": %s\n", Filename, strerror(errno));
+
+  /* The mapping outlives the file handle. */
+  if (File == getProfileFile()) {
+    if (doMerging())
+      lprofUnlockFileHandle(File);
+  } else
+    fclose(File);
+
+  if (Profile == MAP_FAILED)
+    return;
+  INSTR_PROF_PROFILE_COUNTER_BIAS_VAR =
+      (intptr_t)(Profile + FileOffsetToCounters) - (intptr_t)CountersBegin;
+  lprofEnableContinuousMode(INSTR_PROF_PROFILE_COUNTER_BIAS_VAR);
+#endif
+}
+
 static void truncateCurrentFile(void) {
   const char *Filename;
   char *FilenameBuf;
@@ -435,6 +528,13 @@ static int parseFilenamePattern(const char *FilenamePat,
           lprofCurFilename.MergePoolSize = FilenamePat[I] - '0';
           I++; /* advance to 'm' */
         }
+      } else if (FilenamePat[I] == 'c') {
+        if (lprofCurFilename.ContinuousMode) {
+          PROF_WARN("%%c specifier can only be specified once in %s.\n",
+                    FilenamePat);
+          return -1;
+        }
+        lprofCurFilename.ContinuousMode = 1;
       }
     }
 
@@ -461,6 +561,12 @@ static void parseAndSetFilename(const char *FilenamePat,
     return;
   }
 
+  /* The counters are already mapped from the current file. */
+  if (__llvm_profile_is_continuous_mode_enabled()) {
+    PROF_WARN("%s\n", "Profile file name can't be changed in continuous mode.");
+    return;
+  }
+
   /* When PNS >= OldPNS, the last one wins. */
   if (!FilenamePat || parseFilenamePattern(FilenamePat, CopyFilenamePat))
     resetFilenameToDefault();
@@ -478,6 +584,8 @@ static void parseAndSetFilename(const char *FilenamePat,
   }
 
   truncateCurrentFile();
+  if (lprofCurFilename.ContinuousMode)
+    initializeProfileForContinuousMode();
 }
 
 /* Return buffer length that is required to store the current profile
@@ -490,7 +598,7 @@ static int getCurFilenameLength() {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize))
+        lprofCurFilename.MergePoolSize || lprofCurFilename.ContinuousMode))
     return strlen(lprofCurFilename.FilenamePat);
 
   Len = strlen(lprofCurFilename.FilenamePat) +
@@ -514,7 +622,7 @@ static const char *getCurFilename(char *FilenameBuf, int ForceUseBuf) {
     return 0;
 
   if (!(lprofCurFilename.NumPids || lprofCurFilename.NumHosts ||
-        lprofCurFilename.MergePoolSize)) {
+        lprofCurFilename.MergePoolSize || lprofCurFilename.ContinuousMode)) {
     if (!ForceUseBuf)
       return lprofCurFilename.FilenamePat;
 
@@ -672,6 +780,10 @@ int __llvm_profile_write_file(void) {
     return 0;
   }
 
+  /* In continuous mode the file is always current. */
+  if (__llvm_profile_is_continuous_mode_enabled())
+    return 0;
+
   Length = getCurFilenameLength();
   FilenameBuf = (char *)COMPILER_RT_ALLOCA(Length + 1);
   Filename = getCurFilename(FilenameBuf, 0);
@@ -708,7 +820,7 @@ int __llvm_profile_write_file(void) {
 
 COMPILER_RT_VISIBILITY
 int __llvm_profile_dump(void) {
-  if (!doMerging())
+  if (!doMerging() && !__llvm_profile_is_continuous_mode_enabled())
     PROF_WARN("Later invocation of __llvm_profile_dump can lead to clobbering "
               " of previously dumped profile data : %s. Either use %%m "
               "in profile name or change profile name before dumping.\n",
@@ -177,6 +177,10 @@ uint64_t lprofGetLoadModuleSignature();
 unsigned lprofProfileDumped();
 void lprofSetProfileDumped();
 
+/* Switch to continuous mode: the instrumented code now updates the counters
+ * \p CountersBias bytes past the counters section. */
+void lprofEnableContinuousMode(intptr_t CountersBias);
+
 COMPILER_RT_VISIBILITY extern void (*FreeHook)(void *);
 COMPILER_RT_VISIBILITY extern uint8_t *DynamicBufferIOBuffer;
 COMPILER_RT_VISIBILITY extern uint32_t VPBufferSize;
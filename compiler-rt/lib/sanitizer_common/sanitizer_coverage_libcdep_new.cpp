@@ -5,7 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 //===----------------------------------------------------------------------===//
-// Sanitizer Coverage Controller for Trace PC Guard.
+// Sanitizer Coverage Controllers for Trace PC Guard and Inline 8bit Counters.
 
 #include "sanitizer_platform.h"
 
@@ -26,6 +26,9 @@ namespace {
 static const u64 Magic64 = 0xC0BFFFFFFFFFFF64ULL;
 static const u64 Magic32 = 0xC0BFFFFFFFFFFF32ULL;
 static const u64 Magic = SANITIZER_WORDSIZE == 64 ? Magic64 : Magic32;
+// Sparse files hold the ULEB128-encoded gaps between the sorted module offsets
+// of the covered PCs, the first one counted from 0.
+static const u64 MagicSparse = 0xC0BFFFFFFFFFFFC8ULL;
 
 static fd_t OpenFile(const char* path) {
   error_t err;
@@ -54,6 +57,27 @@ static void WriteModuleCoverage(char* file_path, const char* module_name,
   Printf("SanitizerCoverage: %s: %zd PCs written\n", file_path, len);
 }
 
+static void WriteSparseModuleCoverage(char* file_path, const char* module_name,
+                                      const uptr* offsets, uptr len) {
+  InternalMmapVector<u8> buf(sizeof(MagicSparse));
+  internal_memcpy(buf.data(), &MagicSparse, sizeof(MagicSparse));
+  uptr last = 0;
+  for (uptr i = 0; i < len; ++i) {
+    uptr gap = offsets[i] - last;
+    last = offsets[i];
+    do {
+      u8 byte = gap & 0x7f;
+      gap >>= 7;
+      buf.push_back(gap ? byte | 0x80 : byte);
+    } while (gap);
+  }
+  GetCoverageFilename(file_path, StripModuleName(module_name), "sancov");
+  fd_t fd = OpenFile(file_path);
+  WriteToFile(fd, buf.data(), buf.size());
+  CloseFile(fd);
+  Printf("SanitizerCoverage: %s: %zd PCs written\n", file_path, len);
+}
+
 static void SanitizerDumpCoverage(const uptr* unsorted_pcs, uptr len) {
   if (!len) return;
 
@@ -151,6 +175,80 @@ class TracePcGuardController {
 
 static TracePcGuardController pc_guard_controller;
 
+// Collects inline-8bit-counters coverage of modules that also have a PC table
+// (-fsanitize-coverage=inline-8bit-counters,pc-table). The instrumented code
+// only increments its counters, with no calls into the runtime, and the
+// covered PCs are looked up in the PC tables when the coverage is dumped.
+// Every module gets its own sparse .sancov file.
+// This class relies on zero-initialization.
+class InlineCountersController {
+ public:
+  void InitCounters(u8* start, u8* end) {
+    if (!initialized) {
+      initialized = true;
+      modules.Initialize(0);
+    }
+    // Every instrumented object file of a module passes the same section.
+    for (const Module& m : modules)
+      if (m.counters_beg == start) return;
+    modules.push_back({start, end, nullptr});
+  }
+
+  void InitPcs(const uptr* start, const uptr* end) {
+    // The module constructor passes the PC table right after the counters,
+    // with one {PC, flags} pair per counter.
+    if (!initialized) return;
+    Module& m = modules.back();
+    if (m.pcs || end - start != 2 * (m.counters_end - m.counters_beg)) return;
+    m.pcs = start;
+  }
+
+  void Reset() {
+    for (const Module& m : modules)
+      internal_memset(m.counters_beg, 0, m.counters_end - m.counters_beg);
+  }
+
+  void Dump() {
+    if (!initialized || !common_flags()->coverage) return;
+    char* file_path = static_cast<char*>(InternalAlloc(kMaxPathLength));
+    char* module_name = static_cast<char*>(InternalAlloc(kMaxPathLength));
+    InternalMmapVector<uptr> offsets;
+    for (const Module& m : modules) {
+      if (!m.pcs) continue;
+      // The counters live in the module itself, so this also skips the
+      // modules that were unloaded with dlclose.
+      uptr counters = reinterpret_cast<uptr>(m.counters_beg);
+      uptr offset;
+      if (!__sanitizer_get_module_and_offset_for_pc(counters, module_name,
+                                                    kMaxPathLength, &offset))
+        continue;
+      uptr module_base = counters - offset;
+      offsets.clear();
+      // A counter that wrapped around to 0 reads as not covered.
+      for (uptr i = 0, n = m.counters_end - m.counters_beg; i < n; i++)
+        if (m.counters_beg[i]) offsets.push_back(m.pcs[2 * i] - module_base);
+      if (offsets.empty()) continue;
+      Sort(offsets.data(), offsets.size());
+      WriteSparseModuleCoverage(file_path, module_name, offsets.data(),
+                                offsets.size());
+    }
+    InternalFree(file_path);
+    InternalFree(module_name);
+  }
+
+ private:
+  struct Module {
+    u8* counters_beg;
+    u8* counters_end;
+    const uptr* pcs;
+  };
+
+  bool initialized;
+  InternalMmapVectorNoCtor<Module> modules;
+};
+
+static InlineCountersController inline_counters_controller;
+
 }  // namespace
 }  // namespace __sancov
 
@@ -187,10 +285,26 @@ SANITIZER_INTERFACE_ATTRIBUTE void __sanitizer_dump_trace_pc_guard_coverage() {
 }
 SANITIZER_INTERFACE_ATTRIBUTE void __sanitizer_cov_dump() {
   __sanitizer_dump_trace_pc_guard_coverage();
+  __sancov::inline_counters_controller.Dump();
 }
 SANITIZER_INTERFACE_ATTRIBUTE void __sanitizer_cov_reset() {
   __sancov::pc_guard_controller.Reset();
+  __sancov::inline_counters_controller.Reset();
+}
+
+SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_8bit_counters_init,
+                             char* start, char* end) {
+  if (start == end) return;
+  __sancov::inline_counters_controller.InitCounters(
+      reinterpret_cast<u8*>(start), reinterpret_cast<u8*>(end));
+}
+
+SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_pcs_init, const uptr* start,
+                             const uptr* end) {
+  if (start == end) return;
+  __sancov::inline_counters_controller.InitPcs(start, end);
 }
+
 // Default empty implementations (weak). Users should redefine them.
 SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_trace_cmp, void) {}
 SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_trace_cmp1, void) {}
@@ -206,8 +320,6 @@ SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_trace_div4, void) {}
 SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_trace_div8, void) {}
 SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_trace_gep, void) {}
 SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_trace_pc_indir, void) {}
-SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_8bit_counters_init, void) {}
-SANITIZER_INTERFACE_WEAK_DEF(void, __sanitizer_cov_pcs_init, void) {}
 }  // extern "C"
 // Weak definition for code instrumented with -fsanitize-coverage=stack-depth
 // and later linked with code containing a strong definition.
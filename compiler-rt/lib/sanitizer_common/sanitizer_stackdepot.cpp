@@ -18,13 +18,57 @@
 
 namespace __sanitizer {
 
+// Totals over all stored stacks, for StackDepotPrintStats().
+static atomic_uintptr_t n_frames;
+static atomic_uintptr_t packed_bytes;
+static atomic_uintptr_t unpacked_bytes;
+
+// Stacks are stored packed: each PC as the difference from the previous one
+// (the first from 0), zigzag-encoded and written as a little-endian base-128
+// varint. Frames of one stack mostly lie in the same module, so a PC usually
+// takes 2-4 bytes instead of 8. Stacks are unpacked only when they are
+// retrieved, which is rare (reports, leak checks), into a buffer that the
+// node keeps for later retrievals.
+static uptr PackedPCSize(uptr zigzag) {
+  uptr n = 1;
+  for (; zigzag >= 0x80; zigzag >>= 7) n++;
+  return n;
+}
+
+static uptr ZigZag(uptr pc, uptr prev) {
+  sptr delta = (sptr)(pc - prev);
+  return ((uptr)delta << 1) ^ (uptr)(delta >> (sizeof(sptr) * 8 - 1));
+}
+
+static uptr UnZigZag(uptr zigzag) {
+  return (zigzag >> 1) ^ (uptr)(-(sptr)(zigzag & 1));
+}
+
+static u8 *PackPC(u8 *out, uptr zigzag) {
+  for (; zigzag >= 0x80; zigzag >>= 7) *out++ = (u8)(zigzag | 0x80);
+  *out++ = (u8)zigzag;
+  return out;
+}
+
+static const u8 *UnpackPC(const u8 *in, uptr prev, uptr *pc) {
+  uptr zigzag = 0;
+  for (uptr shift = 0;; shift += 7) {
+    u8 b = *in++;
+    zigzag |= (uptr)(b & 0x7f) << shift;
+    if (!(b & 0x80)) break;
+  }
+  *pc = prev + UnZigZag(zigzag);
+  return in;
+}
+
 struct StackDepotNode {
   StackDepotNode *link;
   u32 id;
   atomic_uint32_t hash_and_use_count; // hash_bits : 12; use_count : 20;
   u32 size;
   u32 tag;
-  uptr stack[1];  // [size]
+  mutable atomic_uintptr_t unpacked;  // uptr[size], filled in by load().
+  u8 packed[sizeof(uptr)];  // PCs packed by PackPC(), any length.
 
   static const u32 kTabSizeLog = SANITIZER_ANDROID ? 16 : 20;
   // Lower kTabSizeLog bits are equal for all items in one bucket.
@@ -40,14 +84,25 @@ struct StackDepotNode {
         atomic_load(&hash_and_use_count, memory_order_relaxed) & kHashMask;
     if ((hash & kHashMask) != hash_bits || args.size != size || args.tag != tag)
       return false;
-    uptr i = 0;
-    for (; i < size; i++) {
-      if (stack[i] != args.trace[i]) return false;
+    const u8 *in = packed;
+    uptr pc = 0;
+    for (uptr i = 0; i < size; i++) {
+      in = UnpackPC(in, pc, &pc);
+      if (pc != args.trace[i]) return false;
     }
     return true;
   }
   static uptr storage_size(const args_type &args) {
-    return sizeof(StackDepotNode) + (args.size - 1) * sizeof(uptr);
+    uptr packed_size = 0;
+    uptr prev = 0;
+    for (uptr i = 0; i < args.size; i++) {
+      packed_size += PackedPCSize(ZigZag(args.trace[i], prev));
+      prev = args.trace[i];
+    }
+    // packed ends the node without padding. Keep the next node allocated
+    // after this one aligned.
+    return RoundUpTo(sizeof(StackDepotNode) - sizeof(packed) + packed_size,
+                     sizeof(uptr));
   }
   static u32 hash(const args_type &args) {
     MurMur2HashBuilder H(args.size * sizeof(uptr));
@@ -61,10 +116,38 @@ struct StackDepotNode {
     atomic_store(&hash_and_use_count, hash & kHashMask, memory_order_relaxed);
     size = args.size;
     tag = args.tag;
-    internal_memcpy(stack, args.trace, size * sizeof(uptr));
+    atomic_store(&unpacked, 0, memory_order_relaxed);
+    u8 *out = packed;
+    uptr prev = 0;
+    for (uptr i = 0; i < size; i++) {
+      out = PackPC(out, ZigZag(args.trace[i], prev));
+      prev = args.trace[i];
+    }
+    atomic_fetch_add(&n_frames, size, memory_order_relaxed);
+    atomic_fetch_add(&packed_bytes, out - packed, memory_order_relaxed);
   }
   args_type load() const {
-    return args_type(&stack[0], size, tag);
+    uptr *stack = (uptr *)atomic_load(&unpacked, memory_order_acquire);
+    if (!stack) {
+      // Threads that race here both unpack the stack; one buffer is wasted.
+      uptr *buf = (uptr *)PersistentAlloc(size * sizeof(uptr));
+      const u8 *in = packed;
+      uptr pc = 0;
+      for (uptr i = 0; i < size; i++) {
+        in = UnpackPC(in, pc, &pc);
+        buf[i] = pc;
+      }
+      uptr cmp = 0;
+      if (atomic_compare_exchange_strong(&unpacked, &cmp, (uptr)buf,
+                                         memory_order_acq_rel)) {
+        atomic_fetch_add(&unpacked_bytes, size * sizeof(uptr),
+                         memory_order_relaxed);
+        stack = buf;
+      } else {
+        stack = (uptr *)cmp;
+      }
+    }
+    return args_type(stack, size, tag);
   }
   StackDepotHandle get_handle() { return StackDepotHandle(this); }
 
@@ -94,6 +177,17 @@ StackDepotStats *StackDepotGetStats() {
   return theDepot.GetStats();
 }
 
+void StackDepotPrintStats() {
+  StackDepotStats *stats = theDepot.GetStats();
+  uptr frames = atomic_load_relaxed(&n_frames);
+  Printf("StackDepot: %zd ids; %zdM allocated; %zd frames in %zdK (%zdK "
+         "before packing); %zdK of retrieved stacks\n",
+         stats->n_uniq_ids, stats->allocated >> 20, frames,
+         atomic_load_relaxed(&packed_bytes) >> 10,
+         (frames * sizeof(uptr)) >> 10,
+         atomic_load_relaxed(&unpacked_bytes) >> 10);
+}
+
 u32 StackDepotPut(StackTrace stack) {
   StackDepotHandle h = theDepot.Put(stack);
   return h.valid() ? h.id() : 0;
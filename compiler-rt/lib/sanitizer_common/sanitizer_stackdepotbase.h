@@ -8,6 +8,11 @@
 //
 // Implementation of a mapping from arbitrary values to unique 32-bit
 // identifiers.
+//
+// Nodes are never removed. Lookups and inserts do not take locks: a new node
+// is pushed onto its bucket list with a compare-and-swap of the list head.
+// LockAll() sets the lsb of every head, which holds off inserts until
+// UnlockAll().
 //===----------------------------------------------------------------------===//
 
 #ifndef SANITIZER_STACKDEPOTBASE_H
@@ -30,13 +35,18 @@ class StackDepotBase {
   // Retrieves a stored stack trace by the id.
   args_type Get(u32 id);
 
-  StackDepotStats *GetStats() { return &stats; }
+  StackDepotStats *GetStats() {
+    stats.n_uniq_ids = atomic_load_relaxed(&n_uniq_ids);
+    stats.allocated = atomic_load_relaxed(&allocated);
+    return &stats;
+  }
 
   void LockAll();
   void UnlockAll();
 
  private:
-  static Node *find(Node *s, args_type args, u32 hash);
+  static Node *find(Node *s, args_type args, u32 hash, Node *stop = nullptr);
+  static void backoff(int i);
   static Node *lock(atomic_uintptr_t *p);
   static void unlock(atomic_uintptr_t *p, Node *s);
 
@@ -51,7 +61,9 @@ class StackDepotBase {
   atomic_uintptr_t tab[kTabSize];   // Hash table of Node's.
   atomic_uint32_t seq[kPartCount];  // Unique id generators.
 
-  StackDepotStats stats;
+  atomic_uintptr_t n_uniq_ids;
+  atomic_uintptr_t allocated;
+  StackDepotStats stats;  // Snapshot of the above for GetStats().
 
   friend class StackDepotReverseMap;
 };
@@ -59,9 +71,10 @@ class StackDepotBase {
 template <class Node, int kReservedBits, int kTabSizeLog>
 Node *StackDepotBase<Node, kReservedBits, kTabSizeLog>::find(Node *s,
                                                              args_type args,
-                                                             u32 hash) {
-  // Searches linked list s for the stack, returns its id.
-  for (; s; s = s->link) {
+                                                             u32 hash,
+                                                             Node *stop) {
+  // Searches linked list s up to stop for the stack, returns its id.
+  for (; s != stop; s = s->link) {
     if (s->eq(hash, args)) {
       return s;
     }
@@ -69,6 +82,14 @@ Node *StackDepotBase<Node, kReservedBits, kTabSizeLog>::find(Node *s,
   return nullptr;
 }
 
+template <class Node, int kReservedBits, int kTabSizeLog>
+void StackDepotBase<Node, kReservedBits, kTabSizeLog>::backoff(int i) {
+  if (i < 10)
+    proc_yield(10);
+  else
+    internal_sched_yield();
+}
+
 template <class Node, int kReservedBits, int kTabSizeLog>
 Node *StackDepotBase<Node, kReservedBits, kTabSizeLog>::lock(
     atomic_uintptr_t *p) {
@@ -78,10 +99,7 @@ Node *StackDepotBase<Node, kReservedBits, kTabSizeLog>::lock(
     if ((cmp & 1) == 0 &&
         atomic_compare_exchange_weak(p, &cmp, cmp | 1, memory_order_acquire))
       return (Node *)cmp;
-    if (i < 10)
-      proc_yield(10);
-    else
-      internal_sched_yield();
+    backoff(i);
   }
 }
 
@@ -105,31 +123,42 @@ StackDepotBase<Node, kReservedBits, kTabSizeLog>::Put(args_type args,
   // First, try to find the existing stack.
   Node *node = find(s, args, h);
   if (node) return node->get_handle();
-  // If failed, lock, retry and insert new.
-  Node *s2 = lock(p);
-  if (s2 != s) {
-    node = find(s2, args, h);
-    if (node) {
-      unlock(p, s2);
-      return node->get_handle();
-    }
-  }
+  // If failed, build a new node and push it onto the list. Whenever the list
+  // head moves under us, search the nodes that were pushed in the meantime.
+  // A thread that loses the race to insert the same stack wastes its node
+  // and id, which is rare enough not to matter.
   uptr part = (h % kTabSize) / kPartSize;
   u32 id = atomic_fetch_add(&seq[part], 1, memory_order_relaxed) + 1;
-  stats.n_uniq_ids++;
   CHECK_LT(id, kMaxId);
   id |= part << kPartShift;
   CHECK_NE(id, 0);
   CHECK_EQ(id & (((u32)-1) >> kReservedBits), id);
   uptr memsz = Node::storage_size(args);
-  s = (Node *)PersistentAlloc(memsz);
-  stats.allocated += memsz;
-  s->id = id;
-  s->store(args, h);
-  s->link = s2;
-  unlock(p, s);
+  node = (Node *)PersistentAlloc(memsz);
+  atomic_fetch_add(&allocated, memsz, memory_order_relaxed);
+  node->id = id;
+  node->store(args, h);
+  for (int i = 0;; i++) {
+    uptr cmp = atomic_load(p, memory_order_consume);
+    if (cmp & 1) {
+      // Held by LockAll().
+      backoff(i);
+      continue;
+    }
+    Node *s2 = (Node *)cmp;
+    if (s2 != s) {
+      Node *other = find(s2, args, h, s);
+      if (other) return other->get_handle();
+      s = s2;
+    }
+    node->link = s;
+    if (atomic_compare_exchange_weak(p, &cmp, (uptr)node,
+                                     memory_order_release))
+      break;
+  }
+  atomic_fetch_add(&n_uniq_ids, 1, memory_order_relaxed);
   if (inserted) *inserted = true;
-  return s->get_handle();
+  return node->get_handle();
 }
 
 template <class Node, int kReservedBits, int kTabSizeLog>
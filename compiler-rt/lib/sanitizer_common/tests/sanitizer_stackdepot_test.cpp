@@ -12,6 +12,7 @@
 #include "sanitizer_common/sanitizer_stackdepot.h"
 #include "sanitizer_common/sanitizer_internal_defs.h"
 #include "sanitizer_common/sanitizer_libc.h"
+#include "sanitizer_pthread_wrappers.h"
 #include "gtest/gtest.h"
 
 namespace __sanitizer {
@@ -64,6 +65,52 @@ TEST(SanitizerCommon, StackDepotSeveral) {
   EXPECT_NE(i1, i2);
 }
 
+TEST(SanitizerCommon, StackDepotLargeDeltas) {
+  // Stacks are stored as differences between neighbouring PCs.
+  uptr array[] = {0,         ~(uptr)0, 1, ~(uptr)0 >> 1, (~(uptr)0 >> 1) + 1,
+                  0x123456,  0x123450, 0, 0x7f,          0x80};
+  StackTrace s1(array, ARRAY_SIZE(array));
+  u32 i1 = StackDepotPut(s1);
+  EXPECT_EQ(i1, StackDepotPut(s1));
+  StackTrace stack = StackDepotGet(i1);
+  EXPECT_NE(stack.trace, (uptr*)0);
+  EXPECT_EQ(ARRAY_SIZE(array), stack.size);
+  EXPECT_EQ(0, internal_memcmp(stack.trace, array, sizeof(array)));
+  // Retrieving the stack again gives the same buffer.
+  EXPECT_EQ(stack.trace, StackDepotGet(i1).trace);
+}
+
+static const int kStackDepotThreads = 8;
+static const uptr kStackDepotThreadStacks = 1000;
+
+static void *StackDepotPutThread(void *arg) {
+  u32 *ids = (u32 *)arg;
+  for (uptr i = 0; i < kStackDepotThreadStacks; i++) {
+    uptr array[] = {0x1000, 0x2000 + i, 0x3000, i};
+    ids[i] = StackDepotPut(StackTrace(array, ARRAY_SIZE(array)));
+  }
+  return nullptr;
+}
+
+TEST(SanitizerCommon, StackDepotConcurrentPut) {
+  pthread_t threads[kStackDepotThreads];
+  static u32 ids[kStackDepotThreads][kStackDepotThreadStacks];
+  for (int t = 0; t < kStackDepotThreads; t++)
+    PTHREAD_CREATE(&threads[t], 0, StackDepotPutThread, ids[t]);
+  for (int t = 0; t < kStackDepotThreads; t++)
+    PTHREAD_JOIN(threads[t], 0);
+  // All threads get the same id for the same stack.
+  for (int t = 1; t < kStackDepotThreads; t++)
+    for (uptr i = 0; i < kStackDepotThreadStacks; i++)
+      EXPECT_EQ(ids[0][i], ids[t][i]);
+  for (uptr i = 0; i < kStackDepotThreadStacks; i++) {
+    StackTrace stack = StackDepotGet(ids[0][i]);
+    EXPECT_EQ(4U, stack.size);
+    EXPECT_EQ(0x2000 + i, stack.trace[1]);
+    EXPECT_EQ(i, stack.trace[3]);
+  }
+}
+
 TEST(SanitizerCommon, StackDepotReverseMap) {
   uptr array1[] = {1, 2, 3, 4, 5};
   uptr array2[] = {7, 1, 3, 0};
@@ -128,6 +128,10 @@ INLINE uptr getPageSizeCached() {
 
 u32 getNumberOfCPUs();
 
+// Returns the CPU the calling thread is running on, or -1 if the platform
+// can't tell cheaply. The thread may have migrated by the time this returns.
+s32 getCurrentCPU();
+
 const char *getEnv(const char *Name);
 
 u64 getMonotonicTime();
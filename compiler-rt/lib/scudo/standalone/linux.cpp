@@ -128,6 +128,10 @@ u32 getNumberOfCPUs() {
   return static_cast<u32>(CPU_COUNT(&CPUs));
 }
 
+// sched_getcpu() is serviced by the vDSO (or by the rseq area with recent
+// C libraries), so it doesn't enter the kernel.
+s32 getCurrentCPU() { return static_cast<s32>(sched_getcpu()); }
+
 // Blocking is possibly unused if the getrandom block is not compiled in.
 bool getRandom(void *Buffer, uptr Length, UNUSED bool Blocking) {
   if (!Buffer || !Length || Length > MaxRandomLength)
@@ -348,13 +348,16 @@ private:
     const uptr N = Sci->Stats.PoppedBlocks - Sci->Stats.PushedBlocks;
     if (N * BlockSize < PageSize)
       return; // No chance to release anything.
-    if ((Sci->Stats.PushedBlocks - Sci->ReleaseInfo.PushedBlocksAtLastRelease) *
-            BlockSize <
-        PageSize) {
+    const uptr BytesPushed =
+        (Sci->Stats.PushedBlocks - Sci->ReleaseInfo.PushedBlocksAtLastRelease) *
+        BlockSize;
+    if (BytesPushed < PageSize)
       return; // Nothing new to release.
-    }
 
     if (!Force) {
+      // See comment in the 64-bit primary about batching releases.
+      if (BytesPushed < Sci->AllocatedUser / 16U)
+        return;
       const s32 IntervalMs = ReleaseToOsIntervalMs;
       if (IntervalMs < 0)
         return;
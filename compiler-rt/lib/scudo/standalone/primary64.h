@@ -345,14 +345,18 @@ private:
     const uptr N = Region->Stats.PoppedBlocks - Region->Stats.PushedBlocks;
     if (N * BlockSize < PageSize)
       return; // No chance to release anything.
-    if ((Region->Stats.PushedBlocks -
-         Region->ReleaseInfo.PushedBlocksAtLastRelease) *
-            BlockSize <
-        PageSize) {
+    const uptr BytesPushed = (Region->Stats.PushedBlocks -
+                              Region->ReleaseInfo.PushedBlocksAtLastRelease) *
+                             BlockSize;
+    if (BytesPushed < PageSize)
       return; // Nothing new to release.
-    }
 
     if (!Force) {
+      // A release walks the whole freelist of the region. Batch the frees up
+      // until they amount to a sizeable part of the region, rather than paying
+      // for a walk whenever a page worth of blocks came back.
+      if (BytesPushed < Region->AllocatedUser / 16U)
+        return;
       const s32 IntervalMs = ReleaseToOsIntervalMs;
       if (IntervalMs < 0)
         return;
@@ -11,6 +11,7 @@
 
 #include "common.h"
 #include "list.h"
+#include "mutex.h"
 
 namespace scudo {
 
@@ -44,6 +45,10 @@ private:
 // by checking isAllocated() result. For the performance sake, none of the
 // accessors check the validity of the arguments, It is assumed that Index is
 // always in [0, N) range and the value is not incremented past MaxValue.
+//
+// Small arrays, which is what most releases need, use a static buffer instead
+// of a fresh mapping, saving a map() and an unmap() per release. Only one
+// array can hold the static buffer at a time; others fall back to map().
 class PackedCounterArray {
 public:
   PackedCounterArray(uptr NumCounters, uptr MaxValue) : N(NumCounters) {
@@ -66,11 +71,20 @@ public:
     BufferSize = (roundUpTo(N, static_cast<uptr>(1U) << PackingRatioLog) >>
                   PackingRatioLog) *
                  sizeof(*Buffer);
-    Buffer = reinterpret_cast<uptr *>(
-        map(nullptr, BufferSize, "scudo:counters", MAP_ALLOWNOMEM));
+    if (BufferSize <= sizeof(StaticBuffer) && StaticBufferMutex.tryLock()) {
+      Buffer = &StaticBuffer[0];
+      memset(Buffer, 0, BufferSize);
+    } else {
+      Buffer = reinterpret_cast<uptr *>(
+          map(nullptr, BufferSize, "scudo:counters", MAP_ALLOWNOMEM));
+    }
   }
   ~PackedCounterArray() {
-    if (isAllocated())
+    if (!isAllocated())
+      return;
+    if (Buffer == &StaticBuffer[0])
+      StaticBufferMutex.unlock();
+    else
       unmap(reinterpret_cast<void *>(Buffer), BufferSize);
   }
 
@@ -101,6 +115,8 @@ public:
 
   uptr getBufferSize() const { return BufferSize; }
 
+  static const uptr StaticBufferCount = 2048U;
+
 private:
   const uptr N;
   uptr CounterSizeBitsLog;
@@ -110,6 +126,9 @@ private:
 
   uptr BufferSize;
   uptr *Buffer;
+
+  static HybridMutex StaticBufferMutex;
+  static uptr StaticBuffer[StaticBufferCount];
 };
 
 template <class ReleaseRecorderT> class FreePagesRangeTracker {
@@ -54,6 +54,33 @@ TEST(ScudoReleaseTest, PackedCounterArray) {
   }
 }
 
+TEST(ScudoReleaseTest, PackedCounterArrayStaticBuffer) {
+  // Arrays that fit in the static buffer, alive at the same time: the first
+  // one gets the static buffer, the second one a mapping. Both start zeroed,
+  // including when the static buffer is reused.
+  const scudo::uptr NumCounters = 1024;
+  for (scudo::uptr Round = 0; Round < 2; Round++) {
+    scudo::PackedCounterArray A(NumCounters, 255);
+    scudo::PackedCounterArray B(NumCounters, 255);
+    ASSERT_TRUE(A.isAllocated());
+    ASSERT_TRUE(B.isAllocated());
+    for (scudo::uptr C = 0; C < NumCounters; C++) {
+      EXPECT_EQ(0UL, A.get(C));
+      EXPECT_EQ(0UL, B.get(C));
+    }
+    A.incRange(0, NumCounters - 1);
+    for (scudo::uptr C = 0; C < NumCounters; C++) {
+      EXPECT_EQ(1UL, A.get(C));
+      EXPECT_EQ(0UL, B.get(C));
+    }
+  }
+  // An array larger than the static buffer is mapped.
+  scudo::PackedCounterArray Large(
+      scudo::PackedCounterArray::StaticBufferCount * SCUDO_WORDSIZE + 1, 1);
+  EXPECT_TRUE(Large.isAllocated());
+  EXPECT_EQ(0UL, Large.get(Large.getCount() - 1));
+}
+
 class StringRangeRecorder {
 public:
   std::string ReportedPages;
@@ -102,13 +102,29 @@ private:
 
   NOINLINE void initThread(Allocator *Instance) {
     initOnceMaybe(Instance);
-    // Initial context assignment is done in a plain round-robin fashion.
-    const u32 Index = atomic_fetch_add(&CurrentIndex, 1U, memory_order_relaxed);
+    // Initial context assignment follows the CPU the thread starts on, so that
+    // threads running on different CPUs start out with different contexts. It
+    // is done in a plain round-robin fashion if the CPU is unknown.
+    const s32 CPU = getCurrentCPU();
+    const u32 Index =
+        CPU >= 0 ? static_cast<u32>(CPU)
+                 : atomic_fetch_add(&CurrentIndex, 1U, memory_order_relaxed);
     setCurrentTSD(&TSDs[Index % NumberOfTSDs]);
   }
 
   NOINLINE TSD<Allocator> *getTSDAndLockSlow(TSD<Allocator> *CurrentTSD) {
     if (MaxTSDCount > 1U && NumberOfTSDs > 1U) {
+      // The thread may have migrated since it got its context. The context of
+      // the CPU it runs on now is the one least likely to be contended, so try
+      // that first.
+      const s32 CPU = getCurrentCPU();
+      if (CPU >= 0) {
+        TSD<Allocator> *CPUTSD = &TSDs[static_cast<u32>(CPU) % NumberOfTSDs];
+        if (CPUTSD != CurrentTSD && CPUTSD->tryLock()) {
+          setCurrentTSD(CPUTSD);
+          return CPUTSD;
+        }
+      }
       // Use the Precedence of the current TSD as our random seed. Since we are
       // in the slow path, it means that tryLock failed, and as a result it's
       // very likely that said Precedence is non-zero.
@@ -156,14 +156,16 @@ void ThreadClock::acquire(ClockCache *c, SyncClock *src) {
     CPP_STAT_INC(StatClockAcquireFull);
     nclk_ = max(nclk_, nclk);
     u64 *dst_pos = &clk_[0];
-    for (ClockElem &src_elem : *src) {
-      u64 epoch = src_elem.epoch;
-      if (*dst_pos < epoch) {
-        *dst_pos = epoch;
-        acquired = true;
+    u64 changed = 0;
+    for (SyncClock::Iter it = src->begin(); it != src->end(); it.NextRange()) {
+      for (ClockElem *ce = it.range_begin(); ce != it.range_end(); ce++) {
+        u64 epoch = max<u64>(*dst_pos, ce->epoch);
+        changed |= epoch ^ *dst_pos;
+        *dst_pos++ = epoch;
       }
-      dst_pos++;
     }
+    if (changed)
+      acquired = true;
 
     // Remember that this thread has acquired this clock.
     if (nclk > tid_)
@@ -213,11 +215,12 @@ void ThreadClock::release(ClockCache *c, SyncClock *dst) {
     CPP_STAT_INC(StatClockReleaseAcquired);
   // Update dst->clk_.
   dst->FlushDirty();
-  uptr i = 0;
-  for (ClockElem &ce : *dst) {
-    ce.epoch = max(ce.epoch, clk_[i]);
-    ce.reused = 0;
-    i++;
+  const u64 *src_pos = &clk_[0];
+  for (SyncClock::Iter it = dst->begin(); it != dst->end(); it.NextRange()) {
+    for (ClockElem *ce = it.range_begin(); ce != it.range_end(); ce++) {
+      ce->epoch = max<u64>(ce->epoch, *src_pos++);
+      ce->reused = 0;
+    }
   }
   // Clear 'acquired' flag in the remaining elements.
   if (nclk_ < dst->size_)
@@ -237,14 +240,27 @@ void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
   DCHECK_LE(dst->size_, kMaxTid);
   CPP_STAT_INC(StatClockStore);
 
+  if (dst->size_ >= nclk_ &&
+      dst->release_store_tid_ == tid_ &&
+      dst->release_store_reused_ == reused_ &&
+      dst->elem(tid_).epoch > last_acquire_) {
+    CPP_STAT_INC(StatClockStoreFast);
+    UpdateCurrentThread(c, dst);
+    return;
+  }
+
+  // All of dst is overwritten below, so rather than unsharing (copying) a
+  // shared clock, drop the reference to it and start from an empty one.
+  if (dst->IsShared())
+    dst->Reset(c);
+
   if (dst->size_ == 0 && cached_idx_ != 0) {
     // Reuse the cached clock.
     // Note: we could reuse/cache the cached clock in more cases:
     // we could update the existing clock and cache it, or replace it with the
-    // currently cached clock and release the old one. And for a shared
-    // existing clock, we could replace it with the currently cached;
-    // or unshare, update and cache. But, for simplicity, we currnetly reuse
-    // cached clock only when the target clock is empty.
+    // currently cached clock and release the old one. But, for simplicity,
+    // we currnetly reuse cached clock only when the target clock is empty
+    // or shared.
     dst->tab_ = ctx->clock_alloc.Map(cached_idx_);
     dst->tab_idx_ = cached_idx_;
     dst->size_ = cached_size_;
@@ -267,24 +283,16 @@ void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
   if (dst->size_ < nclk_)
     dst->Resize(c, nclk_);
 
-  if (dst->release_store_tid_ == tid_ &&
-      dst->release_store_reused_ == reused_ &&
-      dst->elem(tid_).epoch > last_acquire_) {
-    CPP_STAT_INC(StatClockStoreFast);
-    UpdateCurrentThread(c, dst);
-    return;
-  }
-
   // O(N) release-store.
   CPP_STAT_INC(StatClockStoreFull);
-  dst->Unshare(c);
   // Note: dst can be larger than this ThreadClock.
   // This is fine since clk_ beyond size is all zeros.
-  uptr i = 0;
-  for (ClockElem &ce : *dst) {
-    ce.epoch = clk_[i];
-    ce.reused = 0;
-    i++;
+  const u64 *src_pos = &clk_[0];
+  for (SyncClock::Iter it = dst->begin(); it != dst->end(); it.NextRange()) {
+    for (ClockElem *ce = it.range_begin(); ce != it.range_end(); ce++) {
+      ce->epoch = *src_pos++;
+      ce->reused = 0;
+    }
   }
   for (uptr i = 0; i < kDirtyTids; i++)
     dst->dirty_[i].tid = kInvalidTid;
@@ -46,6 +46,13 @@ class SyncClock {
     bool operator!=(const Iter& other);
     ClockElem &operator*();
 
+    // The current continuous range of clock elements. The O(N) operations
+    // process the clock a range at a time, in loops the compiler can
+    // vectorize, and use NextRange() to move to the next one.
+    ClockElem *range_begin() const { return pos_; }
+    ClockElem *range_end() const { return end_; }
+    void NextRange();
+
    private:
     SyncClock *parent_;
     // [pos_, end_) is the current continuous range of clock elements.
@@ -220,6 +227,10 @@ ALWAYS_INLINE bool SyncClock::Iter::operator!=(const SyncClock::Iter& other) {
 ALWAYS_INLINE ClockElem &SyncClock::Iter::operator*() {
   return *pos_;
 }
+
+ALWAYS_INLINE void SyncClock::Iter::NextRange() {
+  Next();
+}
 }  // namespace __tsan
 
 #endif  // TSAN_CLOCK_H
@@ -108,6 +108,42 @@ TEST(Clock, RepeatedAcquire) {
   sync.Reset(&cache);
 }
 
+TEST(Clock, ReleaseStoreShared) {
+  // thr1 caches the clock it release-stores to sync, so sync is shared when
+  // thr2 release-stores to it.
+  ThreadClock thr1(0);
+  thr1.tick();
+  for (unsigned i = 2; i < 150; i++)
+    thr1.set(&cache, i, i);
+  SyncClock sync;
+  thr1.ReleaseStore(&cache, &sync);
+
+  ThreadClock thr2(1);
+  thr2.tick();
+  thr2.acquire(&cache, &sync);
+  thr2.tick();
+  thr2.ReleaseStore(&cache, &sync);
+  ASSERT_EQ(150U, sync.size());
+  ASSERT_EQ(1U, sync.get(0));
+  ASSERT_EQ(2U, sync.get(1));
+  for (unsigned i = 2; i < 150; i++)
+    ASSERT_EQ(i, sync.get(i));
+
+  // The clock cached by thr1 is not affected.
+  SyncClock sync2;
+  thr1.ReleaseStore(&cache, &sync2);
+  ASSERT_EQ(150U, sync2.size());
+  ASSERT_EQ(1U, sync2.get(0));
+  ASSERT_EQ(0U, sync2.get(1));
+  for (unsigned i = 2; i < 150; i++)
+    ASSERT_EQ(i, sync2.get(i));
+
+  sync.Reset(&cache);
+  sync2.Reset(&cache);
+  thr1.ResetCached(&cache);
+  thr2.ResetCached(&cache);
+}
+
 TEST(Clock, ManyThreads) {
   SyncClock chunked;
   for (unsigned i = 0; i < 200; i++) {
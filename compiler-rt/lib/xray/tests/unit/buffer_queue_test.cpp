@@ -230,5 +230,80 @@ TEST(BufferQueueTest, GenerationalSupportAcrossThreads) {
   ASSERT_EQ(Counter.load(std::memory_order_acquire), 0);
 }
 
+TEST(BufferQueueTest, ShardedGetUntilFailed) {
+  bool Success = false;
+  BufferQueue Buffers(kSize, 4, Success, 3);
+  ASSERT_TRUE(Success);
+  ASSERT_EQ(Buffers.shards(), 3u);
+  BufferQueue::Buffer Bufs[4];
+  for (auto &B : Bufs)
+    ASSERT_EQ(Buffers.getBuffer(B), BufferQueue::ErrorCode::Ok);
+  BufferQueue::Buffer Extra;
+  EXPECT_EQ(Buffers.getBuffer(Extra), BufferQueue::ErrorCode::NotEnoughMemory);
+  for (auto &B : Bufs)
+    EXPECT_EQ(Buffers.releaseBuffer(B), BufferQueue::ErrorCode::Ok);
+  auto Count = 0;
+  Buffers.apply([&](const BufferQueue::Buffer &) { ++Count; });
+  EXPECT_EQ(Count, 4);
+
+  // There are never more shards than buffers.
+  ASSERT_EQ(Buffers.finalize(), BufferQueue::ErrorCode::Ok);
+  ASSERT_EQ(Buffers.init(kSize, 2, 8), BufferQueue::ErrorCode::Ok);
+  EXPECT_EQ(Buffers.shards(), 2u);
+}
+
+TEST(BufferQueueTest, ShardedMultiThreaded) {
+  bool Success = false;
+  BufferQueue Buffers(kSize, 8, Success, 4);
+  ASSERT_TRUE(Success);
+  auto F = [&] {
+    for (int I = 0; I < 10000; ++I) {
+      BufferQueue::Buffer B;
+      if (Buffers.getBuffer(B) != BufferQueue::ErrorCode::Ok)
+        continue;
+      // No other thread may hold the same buffer.
+      auto *P = static_cast<std::atomic<int> *>(B.Data);
+      EXPECT_EQ(P->fetch_add(1), 0);
+      P->fetch_sub(1);
+      ASSERT_EQ(Buffers.releaseBuffer(B), BufferQueue::ErrorCode::Ok);
+    }
+  };
+  auto T0 = std::async(std::launch::async, F);
+  auto T1 = std::async(std::launch::async, F);
+  auto T2 = std::async(std::launch::async, F);
+  F();
+  T0.get();
+  T1.get();
+  T2.get();
+}
+
+static int ReleasedBuffers = 0;
+
+TEST(BufferQueueTest, ReleaseCallback) {
+  bool Success = false;
+  BufferQueue Buffers(kSize, 4, Success);
+  ASSERT_TRUE(Success);
+  ReleasedBuffers = 0;
+  Buffers.setReleaseCallback(
+      +[](const BufferQueue::Buffer &) { ++ReleasedBuffers; });
+  BufferQueue::Buffer B;
+  for (int I = 0; I < 3; ++I) {
+    ASSERT_EQ(Buffers.getBuffer(B), BufferQueue::ErrorCode::Ok);
+    ASSERT_EQ(Buffers.releaseBuffer(B), BufferQueue::ErrorCode::Ok);
+  }
+  EXPECT_EQ(ReleasedBuffers, 3);
+
+  // Buffers that went through the callback are not "used" anymore, but the
+  // one still held is.
+  ASSERT_EQ(Buffers.getBuffer(B), BufferQueue::ErrorCode::Ok);
+  auto Count = 0;
+  Buffers.apply([&](const BufferQueue::Buffer &) { ++Count; });
+  EXPECT_EQ(Count, 1);
+
+  Buffers.setReleaseCallback(nullptr);
+  ASSERT_EQ(Buffers.releaseBuffer(B), BufferQueue::ErrorCode::Ok);
+  EXPECT_EQ(ReleasedBuffers, 3);
+}
+
 } // namespace
 } // namespace __xray
@@ -21,6 +21,9 @@
 #include "xray_allocator.h"
 #include "xray_defs.h"
 #include <memory>
+#if SANITIZER_LINUX
+#include <sched.h>
+#endif
 #include <sys/mman.h>
 
 using namespace __xray;
@@ -65,9 +68,62 @@ struct ExtentsPadded {
 
 constexpr size_t kExtentsSize = sizeof(ExtentsPadded);
 
+// Threads start looking for a buffer in the shard of the CPU they run on, which
+// sched_getcpu() reads from the vDSO without entering the kernel. Where that is
+// not available we spread the threads by their IDs instead.
+size_t homeShard(size_t ShardCount) {
+  if (ShardCount == 1)
+    return 0;
+#if SANITIZER_LINUX
+  int CPU = sched_getcpu();
+  if (CPU >= 0)
+    return static_cast<size_t>(CPU) % ShardCount;
+#endif
+  return GetTid() % ShardCount;
+}
+
 } // namespace
 
-BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
+BufferQueue::BufferRep *BufferQueue::Shard::take(uint64_t *Pos) {
+  u64 P = atomic_load(&Head, memory_order_relaxed);
+  while (true) {
+    BufferRep *B = Begin + (P % Count);
+    uint64_t Seq = atomic_load(&B->Sequence, memory_order_acquire);
+    if (Seq == P + 1) {
+      if (atomic_compare_exchange_weak(&Head, &P, P + 1,
+                                       memory_order_relaxed)) {
+        *Pos = P;
+        return B;
+      }
+    } else if (Seq < P + 1) {
+      // The entry still waits for its buffer to be returned.
+      return nullptr;
+    } else {
+      P = atomic_load(&Head, memory_order_relaxed);
+    }
+  }
+}
+
+BufferQueue::BufferRep *BufferQueue::Shard::put(uint64_t *Pos) {
+  u64 P = atomic_load(&Tail, memory_order_relaxed);
+  while (true) {
+    BufferRep *B = Begin + (P % Count);
+    uint64_t Seq = atomic_load(&B->Sequence, memory_order_acquire);
+    if (Seq == P) {
+      if (atomic_compare_exchange_weak(&Tail, &P, P + 1,
+                                       memory_order_relaxed)) {
+        *Pos = P;
+        return B;
+      }
+    } else {
+      // Every buffer comes back to the shard it was taken from, so there is
+      // always an entry to put it in; we only lost a race for it.
+      P = atomic_load(&Tail, memory_order_relaxed);
+    }
+  }
+}
+
+BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC, size_t SC) {
   SpinMutexLock Guard(&Mutex);
 
   if (!finalizing())
@@ -106,6 +162,11 @@ BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
   if (Buffers == nullptr)
     return BufferQueue::ErrorCode::NotEnoughMemory;
 
+  ShardCount = SC == 0 ? 1 : SC > BufferCount ? BufferCount : SC;
+  Shards = initArray<Shard>(ShardCount);
+  if (Shards == nullptr)
+    return BufferQueue::ErrorCode::NotEnoughMemory;
+
   // At this point we increment the generation number to associate the buffers
   // to the new generation.
   atomic_fetch_add(&Generation, 1, memory_order_acq_rel);
@@ -134,16 +195,29 @@ BufferQueue::ErrorCode BufferQueue::init(size_t BS, size_t BC) {
     T.Used = false;
   }
 
-  Next = Buffers;
-  First = Buffers;
-  LiveBuffers = 0;
+  // Each shard starts out full: the entry at position I holds a buffer that
+  // can be handed out, and the first buffer to come back goes to the first
+  // entry again.
+  for (size_t S = 0; S < ShardCount; ++S) {
+    auto &Sh = Shards[S];
+    size_t Begin = BufferCount * S / ShardCount;
+    Sh.Begin = Buffers + Begin;
+    Sh.Count = BufferCount * (S + 1) / ShardCount - Begin;
+    for (size_t I = 0; I < Sh.Count; ++I) {
+      Sh.Begin[I].Buff.Shard = S;
+      atomic_store(&Sh.Begin[I].Sequence, I + 1, memory_order_relaxed);
+    }
+    atomic_store(&Sh.Head, 0, memory_order_relaxed);
+    atomic_store(&Sh.Tail, Sh.Count, memory_order_relaxed);
+  }
+
   atomic_store(&Finalizing, 0, memory_order_release);
   Success = true;
   return BufferQueue::ErrorCode::Ok;
 }
 
-BufferQueue::BufferQueue(size_t B, size_t N,
-                         bool &Success) XRAY_NEVER_INSTRUMENT
+BufferQueue::BufferQueue(size_t B, size_t N, bool &Success,
+                         size_t S) XRAY_NEVER_INSTRUMENT
     : BufferSize(B),
       BufferCount(N),
       Mutex(),
@@ -151,11 +225,11 @@ BufferQueue::BufferQueue(size_t B, size_t N,
       BackingStore(nullptr),
       ExtentsBackingStore(nullptr),
       Buffers(nullptr),
-      Next(Buffers),
-      First(Buffers),
-      LiveBuffers(0),
+      Shards(nullptr),
+      ShardCount(0),
+      OnRelease{0},
       Generation{0} {
-  Success = init(B, N) == BufferQueue::ErrorCode::Ok;
+  Success = init(B, N, S) == BufferQueue::ErrorCode::Ok;
 }
 
 BufferQueue::ErrorCode BufferQueue::getBuffer(Buffer &Buf) {
@@ -163,54 +237,55 @@ BufferQueue::ErrorCode BufferQueue::getBuffer(Buffer &Buf) {
     return ErrorCode::QueueFinalizing;
 
   BufferRep *B = nullptr;
-  {
-    SpinMutexLock Guard(&Mutex);
-    if (LiveBuffers == BufferCount)
-      return ErrorCode::NotEnoughMemory;
-    B = Next++;
-    if (Next == (Buffers + BufferCount))
-      Next = Buffers;
-    ++LiveBuffers;
-  }
+  uint64_t Pos = 0;
+  size_t Home = homeShard(ShardCount);
+  for (size_t I = 0; I < ShardCount && B == nullptr; ++I)
+    B = Shards[(Home + I) % ShardCount].take(&Pos);
+  if (B == nullptr)
+    return ErrorCode::NotEnoughMemory;
 
   incRefCount(BackingStore);
   incRefCount(ExtentsBackingStore);
   Buf = B->Buff;
   Buf.Generation = generation();
   B->Used = true;
+
+  // Only now may the entry take a returned buffer.
+  atomic_store(&B->Sequence, Pos + Shards[Buf.Shard].Count,
+               memory_order_release);
   return ErrorCode::Ok;
 }
 
 BufferQueue::ErrorCode BufferQueue::releaseBuffer(Buffer &Buf) {
+  if (Buf.Generation != generation()) {
+    Buf = {};
+    decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
+    decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
+    return BufferQueue::ErrorCode::Ok;
+  }
+
   // Check whether the buffer being referred to is within the bounds of the
   // backing store's range.
-  BufferRep *B = nullptr;
-  {
-    SpinMutexLock Guard(&Mutex);
-    if (Buf.Generation != generation() || LiveBuffers == 0) {
-      Buf = {};
-      decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
-      decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
-      return BufferQueue::ErrorCode::Ok;
-    }
+  if (Buf.Data < &BackingStore->Data ||
+      Buf.Data > &BackingStore->Data + (BufferCount * BufferSize) ||
+      Buf.Shard >= ShardCount)
+    return BufferQueue::ErrorCode::UnrecognizedBuffer;
 
-    if (Buf.Data < &BackingStore->Data ||
-        Buf.Data > &BackingStore->Data + (BufferCount * BufferSize))
-      return BufferQueue::ErrorCode::UnrecognizedBuffer;
+  auto Fn = reinterpret_cast<ReleaseCallback>(
+      atomic_load(&OnRelease, memory_order_acquire));
+  if (Fn != nullptr)
+    Fn(Buf);
 
-    --LiveBuffers;
-    B = First++;
-    if (First == (Buffers + BufferCount))
-      First = Buffers;
-  }
+  uint64_t Pos = 0;
+  BufferRep *B = Shards[Buf.Shard].put(&Pos);
 
-  // Now that the buffer has been released, we mark it as "used".
+  // Now that the buffer has been released, we mark it as "used", unless the
+  // callback already took care of its contents.
   B->Buff = Buf;
-  B->Used = true;
+  B->Used = Fn == nullptr;
+  atomic_store(&B->Sequence, Pos + 1, memory_order_release);
   decRefCount(Buf.BackingStore, Buf.Size, Buf.Count);
   decRefCount(Buf.ExtentsBackingStore, kExtentsSize, Buf.Count);
-  atomic_store(B->Buff.Extents, atomic_load(Buf.Extents, memory_order_acquire),
-               memory_order_release);
   Buf = {};
   return ErrorCode::Ok;
 }
@@ -225,11 +300,16 @@ void BufferQueue::cleanupBuffers() {
   for (auto B = Buffers, E = Buffers + BufferCount; B != E; ++B)
     B->~BufferRep();
   deallocateBuffer(Buffers, BufferCount);
+  for (auto S = Shards, E = Shards + ShardCount; S != E; ++S)
+    S->~Shard();
+  deallocateBuffer(Shards, ShardCount);
   decRefCount(BackingStore, BufferSize, BufferCount);
   decRefCount(ExtentsBackingStore, kExtentsSize, BufferCount);
   BackingStore = nullptr;
   ExtentsBackingStore = nullptr;
   Buffers = nullptr;
+  Shards = nullptr;
+  ShardCount = 0;
   BufferCount = 0;
   BufferSize = 0;
 }
@@ -28,6 +28,12 @@ namespace __xray {
 /// get from or return buffers to the queue. This is one key component of the
 /// "flight data recorder" (FDR) mode to support ongoing XRay function call
 /// trace collection.
+///
+/// The buffers may be split into shards, each of which is a lock-free bounded
+/// queue. Threads get buffers from the shard of the CPU they are running on,
+/// and only move on to other shards when it runs out, so that threads on
+/// different CPUs do not contend for the same cache lines. A buffer always
+/// returns to the shard it came from.
 class BufferQueue {
 public:
   /// ControlBlock represents the memory layout of how we interpret the backing
@@ -62,6 +68,7 @@ public:
     ControlBlock *BackingStore = nullptr;
     ControlBlock *ExtentsBackingStore = nullptr;
     size_t Count = 0;
+    size_t Shard = 0;
   };
 
   struct BufferRep {
@@ -71,8 +78,17 @@ public:
     // This is true if the buffer has been returned to the available queue, and
     // is considered "used" by another thread.
     bool Used = false;
+
+    // Position in the shard's queue this entry is ready for: P + 1 once it
+    // holds a buffer that can be handed out at position P, and P while it waits
+    // for a buffer to be returned at position P.
+    atomic_uint64_t Sequence{};
   };
 
+  /// Called with each buffer released in the current generation before it can
+  /// be handed out again.
+  using ReleaseCallback = void (*)(const Buffer &);
+
 private:
   // This models a ForwardIterator. |T| Must be either a `Buffer` or `const
   // Buffer`. Note that we only advance to the "used" buffers, when
@@ -131,12 +147,39 @@ private:
     }
   };
 
+  // A contiguous range of the BufferRep array, managed as a lock-free bounded
+  // queue of the buffers that can be handed out. The positions only ever grow;
+  // position P maps to entry P % Count.
+  struct Shard {
+    union {
+      atomic_uint64_t Head;
+      char HeadStorage[kCacheLineSize];
+    };
+    union {
+      atomic_uint64_t Tail;
+      char TailStorage[kCacheLineSize];
+    };
+    BufferRep *Begin;
+    size_t Count;
+
+    Shard() : Head{}, Tail{}, Begin(nullptr), Count(0) {}
+
+    // Returns the entry holding the next buffer to hand out, and its position
+    // in *Pos, or nullptr when the shard is empty.
+    BufferRep *take(uint64_t *Pos);
+
+    // Returns the entry to put a released buffer in, and its position in *Pos.
+    BufferRep *put(uint64_t *Pos);
+  };
+
   // Size of each individual Buffer.
   size_t BufferSize;
 
   // Amount of pre-allocated buffers.
   size_t BufferCount;
 
+  // Serialises initialisation and clean-up; getting and releasing buffers is
+  // lock-free.
   SpinMutex Mutex;
   atomic_uint8_t Finalizing;
 
@@ -149,15 +192,11 @@ private:
   // A dynamically allocated array of BufferRep instances.
   BufferRep *Buffers;
 
-  // Pointer to the next buffer to be handed out.
-  BufferRep *Next;
+  // A dynamically allocated array of the shards splitting up Buffers.
+  Shard *Shards;
+  size_t ShardCount;
 
-  // Pointer to the entry in the array where the next released buffer will be
-  // placed.
-  BufferRep *First;
-
-  // Count of buffers that have been handed out through 'getBuffer'.
-  size_t LiveBuffers;
+  atomic_uintptr_t OnRelease;
 
   // We use a generation number to identify buffers and which generation they're
   // associated with.
@@ -194,9 +233,9 @@ public:
     return "unknown error";
   }
 
-  /// Initialise a queue of size |N| with buffers of size |B|. We report success
-  /// through |Success|.
-  BufferQueue(size_t B, size_t N, bool &Success);
+  /// Initialise a queue of size |N| with buffers of size |B|, split into |S|
+  /// shards. We report success through |Success|.
+  BufferQueue(size_t B, size_t N, bool &Success, size_t S = 1);
 
   /// Updates |Buf| to contain the pointer to an appropriate buffer. Returns an
   /// error in case there are no available buffers to return when we will run
@@ -221,13 +260,22 @@ public:
   ErrorCode releaseBuffer(Buffer &Buf);
 
   /// Initializes the buffer queue, starting a new generation. We can re-set the
-  /// size of buffers with |BS| along with the buffer count with |BC|.
+  /// size of buffers with |BS| along with the buffer count with |BC| and the
+  /// shard count with |SC|. There are never more shards than buffers.
   ///
   /// Returns:
   ///   - ErrorCode::Ok when we successfully initialize the buffer. This
   ///   requires that the buffer queue is previously finalized.
   ///   - ErrorCode::AlreadyInitialized when the buffer queue is not finalized.
-  ErrorCode init(size_t BS, size_t BC);
+  ErrorCode init(size_t BS, size_t BC, size_t SC = 1);
+
+  /// Installs |Fn| to be called with every buffer released in the current
+  /// generation, before the buffer can be handed out again. Such buffers are
+  /// not considered "used" afterwards, so that e.g. a buffer that has already
+  /// been written out is not seen again by apply(...). Pass nullptr to remove.
+  void setReleaseCallback(ReleaseCallback Fn) {
+    atomic_store(&OnRelease, reinterpret_cast<uptr>(Fn), memory_order_release);
+  }
 
   bool finalizing() const {
     return atomic_load(&Finalizing, memory_order_acquire);
@@ -240,6 +288,9 @@ public:
   /// Returns the configured size of the buffers in the buffer queue.
   size_t ConfiguredBufferSize() const { return BufferSize; }
 
+  /// Returns the number of shards the buffers are split into.
+  size_t shards() const { return ShardCount; }
+
   /// Sets the state of the BufferQueue to finalizing, which ensures that:
   ///
   ///   - All subsequent attempts to retrieve a Buffer will fail.
@@ -89,6 +89,12 @@ static atomic_uint64_t TicksPerSec{0};
 static atomic_sint32_t LogFlushStatus = {
     XRayLogFlushStatus::XRAY_LOG_NOT_FLUSHING};
 
+// With streaming=true, the log file is opened when logging is initialized, and
+// threads append their buffers to it as they release them. The mutex keeps the
+// buffers from interleaving and guards the writer's lifetime.
+static BlockingMutex StreamMutex(LINKER_INITIALIZED);
+static LogWriter *StreamWriter = nullptr;
+
 // This function will initialize the thread-local data structure used by the FDR
 // logging implementation and return a reference to it. The implementation
 // details require a bit of care to maintain.
@@ -275,6 +281,35 @@ XRayBuffer fdrIterator(const XRayBuffer B) {
   return Result;
 }
 
+// Starting at version 2 of the FDR logging implementation, we only write the
+// records identified by the extents of the buffer. We use the Extents from the
+// Buffer and write that out as the first record in the buffer. We still use a
+// Metadata record, but fill in the extents instead for the data.
+static void writeBuffer(LogWriter *LW,
+                        const BufferQueue::Buffer &B) XRAY_NEVER_INSTRUMENT {
+  MetadataRecord ExtentsRecord;
+  auto BufferExtents = atomic_load(B.Extents, memory_order_acquire);
+  DCHECK(BufferExtents <= B.Size);
+  ExtentsRecord.Type = uint8_t(RecordType::Metadata);
+  ExtentsRecord.RecordKind =
+      uint8_t(MetadataRecord::RecordKinds::BufferExtents);
+  internal_memcpy(ExtentsRecord.Data, &BufferExtents, sizeof(BufferExtents));
+  if (BufferExtents > 0) {
+    LW->WriteAll(reinterpret_cast<char *>(&ExtentsRecord),
+                 reinterpret_cast<char *>(&ExtentsRecord) +
+                     sizeof(MetadataRecord));
+    LW->WriteAll(reinterpret_cast<char *>(B.Data),
+                 reinterpret_cast<char *>(B.Data) + BufferExtents);
+  }
+}
+
+// Installed as the release callback of the buffer queue with streaming=true.
+static void streamBuffer(const BufferQueue::Buffer &B) XRAY_NEVER_INSTRUMENT {
+  BlockingMutexLock Lock(&StreamMutex);
+  if (StreamWriter != nullptr)
+    writeBuffer(StreamWriter, B);
+}
+
 // Must finalize before flushing.
 XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
   if (atomic_load(&LoggingStatus, memory_order_acquire) !=
@@ -338,6 +373,29 @@ XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
   //      (fixed-sized) and let the tools reading the buffers deal with the data
   //      afterwards.
   //
+  // When streaming, the header and the released buffers are already in the
+  // file, and only the buffers that threads still hold are left to write.
+  bool Streaming;
+  {
+    BlockingMutexLock Lock(&StreamMutex);
+    Streaming = StreamWriter != nullptr;
+  }
+  if (Streaming) {
+    // Releasing the current thread's buffer streams it.
+    auto &TLD = getThreadLocalData();
+    if (TLD.Controller != nullptr)
+      TLD.Controller->flush();
+
+    BlockingMutexLock Lock(&StreamMutex);
+    BQ->apply(
+        [&](const BufferQueue::Buffer &B) { writeBuffer(StreamWriter, B); });
+    LogWriter::Close(StreamWriter);
+    StreamWriter = nullptr;
+    atomic_store(&LogFlushStatus, XRayLogFlushStatus::XRAY_LOG_FLUSHED,
+                 memory_order_release);
+    return XRayLogFlushStatus::XRAY_LOG_FLUSHED;
+  }
+
   LogWriter *LW = LogWriter::Open();
   if (LW == nullptr) {
     auto Result = XRayLogFlushStatus::XRAY_LOG_NOT_FLUSHING;
@@ -357,27 +415,7 @@ XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
   if (TLD.Controller != nullptr)
     TLD.Controller->flush();
 
-  BQ->apply([&](const BufferQueue::Buffer &B) {
-    // Starting at version 2 of the FDR logging implementation, we only write
-    // the records identified by the extents of the buffer. We use the Extents
-    // from the Buffer and write that out as the first record in the buffer.  We
-    // still use a Metadata record, but fill in the extents instead for the
-    // data.
-    MetadataRecord ExtentsRecord;
-    auto BufferExtents = atomic_load(B.Extents, memory_order_acquire);
-    DCHECK(BufferExtents <= B.Size);
-    ExtentsRecord.Type = uint8_t(RecordType::Metadata);
-    ExtentsRecord.RecordKind =
-        uint8_t(MetadataRecord::RecordKinds::BufferExtents);
-    internal_memcpy(ExtentsRecord.Data, &BufferExtents, sizeof(BufferExtents));
-    if (BufferExtents > 0) {
-      LW->WriteAll(reinterpret_cast<char *>(&ExtentsRecord),
-                   reinterpret_cast<char *>(&ExtentsRecord) +
-                       sizeof(MetadataRecord));
-      LW->WriteAll(reinterpret_cast<char *>(B.Data),
-                   reinterpret_cast<char *>(B.Data) + BufferExtents);
-    }
-  });
+  BQ->apply([&](const BufferQueue::Buffer &B) { writeBuffer(LW, B); });
 
   atomic_store(&LogFlushStatus, XRayLogFlushStatus::XRAY_LOG_FLUSHED,
                memory_order_release);
@@ -660,23 +698,42 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
   *fdrFlags() = FDRFlags;
   auto BufferSize = FDRFlags.buffer_size;
   auto BufferMax = FDRFlags.buffer_max;
+  size_t BufferShards = FDRFlags.per_cpu_buffers ? GetNumberOfCPUsCached() : 1;
 
   if (BQ == nullptr) {
     bool Success = false;
     BQ = reinterpret_cast<BufferQueue *>(&BufferQueueStorage);
-    new (BQ) BufferQueue(BufferSize, BufferMax, Success);
+    new (BQ) BufferQueue(BufferSize, BufferMax, Success, BufferShards);
     if (!Success) {
       Report("BufferQueue init failed.\n");
       return XRayLogInitStatus::XRAY_LOG_UNINITIALIZED;
     }
   } else {
-    if (BQ->init(BufferSize, BufferMax) != BufferQueue::ErrorCode::Ok) {
+    if (BQ->init(BufferSize, BufferMax, BufferShards) !=
+        BufferQueue::ErrorCode::Ok) {
       if (Verbosity())
         Report("Failed to re-initialize global buffer queue. Init failed.\n");
       return XRayLogInitStatus::XRAY_LOG_UNINITIALIZED;
     }
   }
 
+  BQ->setReleaseCallback(nullptr);
+  if (FDRFlags.streaming && !FDRFlags.no_file_flush) {
+    BlockingMutexLock Lock(&StreamMutex);
+    if (StreamWriter != nullptr)
+      LogWriter::Close(StreamWriter);
+    StreamWriter = LogWriter::Open();
+    if (StreamWriter == nullptr) {
+      Report("XRay FDR: Failed to open the log file for streaming.\n");
+      return XRayLogInitStatus::XRAY_LOG_UNINITIALIZED;
+    }
+    XRayFileHeader Header = fdrCommonHeaderInfo();
+    Header.FdrData = FdrAdditionalHeaderData{BQ->ConfiguredBufferSize()};
+    StreamWriter->WriteAll(reinterpret_cast<char *>(&Header),
+                           reinterpret_cast<char *>(&Header) + sizeof(Header));
+    BQ->setReleaseCallback(streamBuffer);
+  }
+
   static pthread_once_t OnceInit = PTHREAD_ONCE_INIT;
   pthread_once(
       &OnceInit, +[] {
@@ -359,6 +359,103 @@ XRayPatchingStatus mprotectAndPatchFunction(int32_t FuncId,
   return patchFunction(FuncId, Enable);
 }
 
+// The page-aligned range of text holding the sleds of one function.
+struct FunctionPages {
+  uptr Begin;
+  uptr End;
+  int32_t FuncId;
+};
+
+// controlPatchingFunctions patches or unpatches the sleds of a set of
+// functions at once. The page ranges of the functions are sorted and merged,
+// so that functions sharing pages (or laid out next to each other) only cost
+// a single pair of mprotect(...) calls, instead of one pair per function.
+XRayPatchingStatus
+controlPatchingFunctions(const int32_t *FuncIds, size_t Count,
+                         bool Enable) XRAY_NEVER_INSTRUMENT {
+  if (!atomic_load(&XRayInitialized, memory_order_acquire))
+    return XRayPatchingStatus::NOT_INITIALIZED; // Not initialized.
+
+  uint8_t NotPatching = false;
+  if (!atomic_compare_exchange_strong(&XRayPatching, &NotPatching, true,
+                                      memory_order_acq_rel))
+    return XRayPatchingStatus::ONGOING; // Already patching.
+
+  auto XRayPatchingStatusResetter = at_scope_exit(
+      [] { atomic_store(&XRayPatching, false, memory_order_release); });
+
+  XRaySledMap InstrMap;
+  {
+    SpinMutexLock Guard(&XRayInstrMapMutex);
+    InstrMap = XRayInstrMap;
+  }
+
+  // If we don't have an index, we can't patch individual functions.
+  if (InstrMap.Functions == 0)
+    return XRayPatchingStatus::NOT_INITIALIZED;
+
+  const size_t PageSize = flags()->xray_page_size_override > 0
+                              ? flags()->xray_page_size_override
+                              : GetPageSizeCached();
+  if ((PageSize == 0) || ((PageSize & (PageSize - 1)) != 0)) {
+    Report("Provided page size is not a power of two: %lld\n", PageSize);
+    return XRayPatchingStatus::FAILED;
+  }
+
+  // We validate all the ids before touching any page, so that a bad id leaves
+  // the instrumentation as it was.
+  InternalMmapVector<FunctionPages> Pages;
+  Pages.reserve(Count);
+  for (size_t I = 0; I < Count; ++I) {
+    int32_t FuncId = FuncIds[I];
+    if (FuncId <= 0 || static_cast<size_t>(FuncId) > InstrMap.Functions) {
+      Report("Invalid function id provided: %d\n", FuncId);
+      return XRayPatchingStatus::FAILED;
+    }
+    auto SledRange = InstrMap.SledsIndex[FuncId - 1];
+    uptr MinAddr = SledRange.Begin->Address;
+    uptr MaxAddr = MinAddr;
+    for (auto *S = SledRange.Begin; S != SledRange.End; ++S) {
+      MinAddr = Min<uptr>(MinAddr, S->Address);
+      MaxAddr = Max<uptr>(MaxAddr, S->Address);
+    }
+    Pages.push_back({MinAddr & ~(PageSize - 1),
+                     RoundUpTo(MaxAddr + cSledLength, PageSize), FuncId});
+  }
+  Sort(Pages.data(), Pages.size(),
+       [](const FunctionPages &A, const FunctionPages &B) {
+         return A.Begin < B.Begin;
+       });
+
+  bool SucceedOnce = false;
+  for (size_t I = 0; I < Pages.size();) {
+    // Grow the range for as long as the next function starts within it.
+    uptr Begin = Pages[I].Begin;
+    uptr End = Pages[I].End;
+    size_t Last = I + 1;
+    for (; Last < Pages.size() && Pages[Last].Begin <= End; ++Last)
+      End = Max(End, Pages[Last].End);
+
+    MProtectHelper Protector(reinterpret_cast<void *>(Begin), End - Begin,
+                             PageSize);
+    if (Protector.MakeWriteable() == -1) {
+      Report("Failed mprotect: %d\n", errno);
+      return XRayPatchingStatus::FAILED;
+    }
+    for (; I < Last; ++I) {
+      auto SledRange = InstrMap.SledsIndex[Pages[I].FuncId - 1];
+      for (auto *S = SledRange.Begin; S != SledRange.End; ++S)
+        SucceedOnce |= patchSled(*S, Enable, Pages[I].FuncId);
+    }
+  }
+
+  if (Count != 0 && !SucceedOnce) {
+    Report("Failed patching any sled for %zu functions.\n", Count);
+    return XRayPatchingStatus::FAILED;
+  }
+  return XRayPatchingStatus::SUCCESS;
+}
+
 } // namespace
 
 } // namespace __xray
@@ -445,6 +542,17 @@ __xray_unpatch_function(int32_t FuncId) XRAY_NEVER_INSTRUMENT {
   return mprotectAndPatchFunction(FuncId, false);
 }
 
+XRayPatchingStatus __xray_patch_functions(const int32_t *FuncIds,
+                                          size_t Count) XRAY_NEVER_INSTRUMENT {
+  return controlPatchingFunctions(FuncIds, Count, true);
+}
+
+XRayPatchingStatus
+__xray_unpatch_functions(const int32_t *FuncIds,
+                         size_t Count) XRAY_NEVER_INSTRUMENT {
+  return controlPatchingFunctions(FuncIds, Count, false);
+}
+
 int __xray_set_handler_arg1(void (*entry)(int32_t, XRayEntryType, uint64_t)) {
   if (!atomic_load(&XRayInitialized,
                                 memory_order_acquire))
@@ -0,0 +1,28 @@
+// Test the sample_allocations runtime option.
+
+// RUN: %clangxx_asan -O0 %s -o %t
+// RUN: not %run %t 2>&1 | FileCheck %s --check-prefix=CHECK-ALL
+// RUN: %env_asan_opts=sample_allocations=1 not %run %t 2>&1 | FileCheck %s --check-prefix=CHECK-ALL
+// RUN: %env_asan_opts=sample_allocations=1000000 %run %t 2>&1 | FileCheck %s --check-prefix=CHECK-SAMPLED
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main() {
+  // The first allocation of a thread is always sampled.
+  free(malloc(10));
+  char *volatile p = (char *)malloc(10);
+  free(p);
+  char *volatile q = (char *)malloc(10);
+  // Sampled chunks go through the quarantine. Unsampled ones are reused right
+  // away, and accesses through stale pointers to them go unnoticed.
+  fprintf(stderr, "%s\n", p == q ? "reused" : "quarantined");
+  // CHECK-ALL: quarantined
+  // CHECK-SAMPLED: reused
+  volatile char c = p[5];
+  // CHECK-ALL: heap-use-after-free
+  fprintf(stderr, "done\n");
+  // CHECK-SAMPLED: done
+  free(q);
+  return 0;
+}
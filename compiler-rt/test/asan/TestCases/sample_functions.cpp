@@ -0,0 +1,22 @@
+// Test the sample_functions runtime option.
+
+// RUN: %clangxx_asan -O0 -mllvm -asan-sample-functions %s -o %t
+// RUN: not %run %t 2>&1 | FileCheck %s
+// RUN: %env_asan_opts=sample_functions=1 not %run %t 2>&1 | FileCheck %s
+// RUN: %env_asan_opts=sample_functions=2147483647 %run %t 2>&1 | FileCheck %s --check-prefix=CHECK-UNSAMPLED
+
+#include <stdio.h>
+#include <stdlib.h>
+
+__attribute__((noinline)) int read_at(char *p, int i) { return p[i]; }
+
+int main() {
+  char *p = (char *)malloc(10);
+  volatile int c = read_at(p, 10);
+  // CHECK: heap-buffer-overflow
+  // CHECK: {{#0 .* in read_at}}
+  fprintf(stderr, "done\n");
+  // CHECK-UNSAMPLED: done
+  free(p);
+  return 0;
+}
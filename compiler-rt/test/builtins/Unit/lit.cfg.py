@@ -61,6 +61,9 @@ builtins_is_msvc = get_required_attr(config, "builtins_is_msvc")
 if not builtins_is_msvc:
   config.available_features.add('int128')
 
+if get_required_attr(config, "builtins_has_mem_functions"):
+  config.available_features.add('librt_has_mem_functions')
+
 clang_wrapper = ""
 
 def build_invocation(compile_flags):
@@ -0,0 +1,62 @@
+// REQUIRES: librt_has_mem_functions
+// RUN: %clang_builtins %s %librt -o %t && %run %t
+//===-- memcmp_test.c - Test __compilerrt_memcmp --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file tests __compilerrt_memcmp for the compiler_rt library.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+extern int __compilerrt_memcmp(const void *a, const void *b, size_t n);
+
+#define SIZE 1024
+
+static uint8_t a[SIZE + 16];
+static uint8_t b[SIZE + 16];
+
+static int sign(int x) { return (x > 0) - (x < 0); }
+
+// Compares n bytes that are equal except, if diff < n, at byte diff, where
+// a holds x and b holds y.
+int test__compilerrt_memcmp(size_t n, size_t off, size_t diff, uint8_t x,
+                            uint8_t y) {
+  for (size_t i = 0; i < SIZE; ++i)
+    a[i] = b[i + off] = (uint8_t)(i * 3 + 11);
+  int expected = 0;
+  if (diff < n) {
+    a[diff] = x;
+    b[diff + off] = y;
+    expected = sign(x - y);
+  }
+  int actual = sign(__compilerrt_memcmp(a, b + off, n));
+  if (actual != expected) {
+    printf("error in __compilerrt_memcmp(%zu) with 0x%x and 0x%x at byte %zu: "
+           "got %d, expected %d\n",
+           n, x, y, diff, actual, expected);
+    return 1;
+  }
+  return 0;
+}
+
+int main() {
+  for (size_t n = 0; n <= SIZE; n += n < 200 ? 1 : 37)
+    for (size_t off = 0; off < 16; off += 7) {
+      if (test__compilerrt_memcmp(n, off, n, 0, 0))
+        return 1;
+      // The bytes compare as unsigned char.
+      for (size_t diff = 0; diff < n; diff += 1 + n / 5)
+        if (test__compilerrt_memcmp(n, off, diff, 0x01, 0xFF) ||
+            test__compilerrt_memcmp(n, off, diff, 0x80, 0x7F))
+          return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,56 @@
+// REQUIRES: librt_has_mem_functions
+// RUN: %clang_builtins %s %librt -o %t && %run %t
+//===-- memcpy_test.c - Test __compilerrt_memcpy --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file tests __compilerrt_memcpy for the compiler_rt library.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+extern void *__compilerrt_memcpy(void *dst, const void *src, size_t n);
+
+#define SIZE 9000
+
+static uint8_t src[SIZE + 32];
+static uint8_t dst[SIZE + 32];
+
+int test__compilerrt_memcpy(size_t n, size_t src_off, size_t dst_off) {
+  for (size_t i = 0; i < sizeof(src); ++i) {
+    src[i] = (uint8_t)(i * 7 + 1);
+    dst[i] = 0;
+  }
+  if (__compilerrt_memcpy(dst + dst_off, src + src_off, n) != dst + dst_off) {
+    printf("error in __compilerrt_memcpy(%zu): wrong return value\n", n);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(dst); ++i) {
+    uint8_t expected =
+        i >= dst_off && i < dst_off + n ? src[i - dst_off + src_off] : 0;
+    if (dst[i] != expected) {
+      printf("error in __compilerrt_memcpy(%zu) from offset %zu to offset "
+             "%zu: byte %zu is 0x%x, expected 0x%x\n",
+             n, src_off, dst_off, i, dst[i], expected);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main() {
+  // Every size class, then the loops and the large copy paths.
+  for (size_t n = 0; n <= SIZE; n += n < 300 ? 1 : 211)
+    for (size_t src_off = 0; src_off < 16; src_off += 5)
+      for (size_t dst_off = 0; dst_off < 16; dst_off += 3)
+        if (test__compilerrt_memcpy(n, src_off, dst_off))
+          return 1;
+  return 0;
+}
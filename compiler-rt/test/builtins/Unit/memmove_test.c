@@ -0,0 +1,58 @@
+// REQUIRES: librt_has_mem_functions
+// RUN: %clang_builtins %s %librt -o %t && %run %t
+//===-- memmove_test.c - Test __compilerrt_memmove ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file tests __compilerrt_memmove for the compiler_rt library.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+extern void *__compilerrt_memmove(void *dst, const void *src, size_t n);
+
+#define SIZE 4096
+#define SHIFT 100
+
+static uint8_t buf[SIZE + SHIFT];
+
+static uint8_t initial(size_t i) { return (uint8_t)(i * 13 + 5); }
+
+// Moves n bytes within buf from src_off to dst_off, which may overlap.
+int test__compilerrt_memmove(size_t n, size_t src_off, size_t dst_off) {
+  for (size_t i = 0; i < sizeof(buf); ++i)
+    buf[i] = initial(i);
+  if (__compilerrt_memmove(buf + dst_off, buf + src_off, n) != buf + dst_off) {
+    printf("error in __compilerrt_memmove(%zu): wrong return value\n", n);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(buf); ++i) {
+    uint8_t expected = i >= dst_off && i < dst_off + n
+                           ? initial(i - dst_off + src_off)
+                           : initial(i);
+    if (buf[i] != expected) {
+      printf("error in __compilerrt_memmove(%zu) from offset %zu to offset "
+             "%zu: byte %zu is 0x%x, expected 0x%x\n",
+             n, src_off, dst_off, i, buf[i], expected);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main() {
+  for (size_t n = 0; n <= SIZE; n += n < 300 ? 1 : 97)
+    for (size_t shift = 0; shift <= SHIFT; shift += shift < 20 ? 1 : 40) {
+      if (test__compilerrt_memmove(n, 0, shift) ||
+          test__compilerrt_memmove(n, shift, 0))
+        return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,53 @@
+// REQUIRES: librt_has_mem_functions
+// RUN: %clang_builtins %s %librt -o %t && %run %t
+//===-- memset_test.c - Test __compilerrt_memset --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file tests __compilerrt_memset for the compiler_rt library.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+extern void *__compilerrt_memset(void *dst, int c, size_t n);
+
+#define SIZE 9000
+
+static uint8_t buf[SIZE + 32];
+
+int test__compilerrt_memset(size_t n, size_t off, int c) {
+  for (size_t i = 0; i < sizeof(buf); ++i)
+    buf[i] = 0x5A;
+  if (__compilerrt_memset(buf + off, c, n) != buf + off) {
+    printf("error in __compilerrt_memset(%zu): wrong return value\n", n);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(buf); ++i) {
+    uint8_t expected = i >= off && i < off + n ? (uint8_t)c : 0x5A;
+    if (buf[i] != expected) {
+      printf("error in __compilerrt_memset(%zu, 0x%x) at offset %zu: byte %zu "
+             "is 0x%x, expected 0x%x\n",
+             n, c, off, i, buf[i], expected);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main() {
+  for (size_t n = 0; n <= SIZE; n += n < 300 ? 1 : 211)
+    for (size_t off = 0; off < 16; off += 3) {
+      // Only the low byte of c is stored.
+      if (test__compilerrt_memset(n, off, 0) ||
+          test__compilerrt_memset(n, off, 0x1A5))
+        return 1;
+    }
+  return 0;
+}
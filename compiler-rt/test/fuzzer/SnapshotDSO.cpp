@@ -0,0 +1,13 @@
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// A DSO with global state, for SnapshotTest.
+#include <cstddef>
+#include <cstdint>
+
+static int TimesSeen[256];
+
+int SnapshotDSOParse(const uint8_t *Data, size_t Size) {
+  return ++TimesSeen[Data[0]];
+}
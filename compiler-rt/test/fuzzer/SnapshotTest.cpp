@@ -0,0 +1,20 @@
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Crashes once the DSO sees the same first byte twice, unless -snapshot=1
+// resets its state between runs.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+int SnapshotDSOParse(const uint8_t *Data, size_t Size);
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
+  if (Size && SnapshotDSOParse(Data, Size) > 1) {
+    fprintf(stderr, "STATE LEAKED\n");
+    abort();
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+// Test the origin_history_sample_rate runtime option.
+
+// RUN: %clangxx_msan -fsanitize-memory-track-origins=2 -O0 %s -o %t
+// RUN: not %run %t 2>&1 | FileCheck %s --check-prefix=CHECK --check-prefix=CHECK-ALL
+// RUN: MSAN_OPTIONS=origin_history_sample_rate=1000000 not %run %t 2>&1 | FileCheck %s --check-prefix=CHECK --check-prefix=CHECK-SAMPLED
+
+#include <stdio.h>
+
+volatile int x, y;
+
+__attribute__((noinline)) void store_x(int a) { x = a; }
+
+__attribute__((noinline)) void store_y() { y = x; }
+
+int main(int argc, char *argv[]) {
+  int volatile z;
+  // The first store of a thread is always recorded.
+  store_x(z);
+  store_y();
+  return y;
+}
+
+// CHECK: WARNING: MemorySanitizer: use-of-uninitialized-value
+// CHECK-SAMPLED-NOT: in store_y
+// CHECK-ALL: Uninitialized value was stored to memory at
+// CHECK-ALL: {{#0 .* in store_y}}
+// CHECK: Uninitialized value was stored to memory at
+// CHECK: {{#0 .* in store_x}}
+// CHECK: Uninitialized value was created by an allocation of 'z' in the stack frame of function 'main'
@@ -0,0 +1,37 @@
+// The counters of a process killed before it gets to write its profile out
+// are still in the file in continuous mode.
+//
+// RUN: %clang_profgen -mllvm -runtime-counter-relocation -o %t %s
+// RUN: rm -f %t.profraw
+// RUN: env LLVM_PROFILE_FILE=%t%c.profraw not --crash %run %t 2>&1 | FileCheck %s --check-prefix=RUNTIME
+// RUN: llvm-profdata show --counts --function=foo %t.profraw | FileCheck %s
+//
+// RUN: %clang_profgen -o %t.norelocation %s
+// RUN: env LLVM_PROFILE_FILE=%t%c.profraw not --crash %run %t.norelocation 2>&1 | FileCheck %s --check-prefix=NORELOCATION
+
+// UNSUPPORTED: windows
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int __llvm_profile_is_continuous_mode_enabled(void);
+
+void foo(int N) {
+  if (N)
+    printf("%d\n", N);
+}
+
+int main() {
+  fprintf(stderr, "continuous mode: %d\n",
+          __llvm_profile_is_continuous_mode_enabled());
+  // RUNTIME: continuous mode: 1
+  // NORELOCATION: Continuous mode needs code built with -mllvm -runtime-counter-relocation.
+  // NORELOCATION: continuous mode: 0
+  for (int I = 0; I < 3; ++I)
+    foo(I);
+  abort();
+}
+
+// CHECK: foo:
+// CHECK: Function count: 3
+// CHECK: Block counts: [2]
@@ -0,0 +1,47 @@
+// Tests dumping of -fsanitize-coverage=inline-8bit-counters,pc-table coverage
+// into sparse .sancov files, and merging them with sancov.
+
+// REQUIRES: has_sancovcc,stable-runtime
+// UNSUPPORTED: ubsan,i386-darwin
+// XFAIL: tsan,powerpc64,s390x,mips
+// XFAIL: android && asan
+
+// RUN: DIR=%t_workdir
+// RUN: rm -rf $DIR
+// RUN: mkdir -p $DIR/merged
+// RUN: cd $DIR
+// RUN: %clangxx -O0 -fsanitize-coverage=inline-8bit-counters,pc-table %s -o %t
+// RUN: %env_tool_opts=coverage=1 %t 2>&1 | FileCheck %s
+// RUN: %sancovcc -covered-functions -strip_path_prefix=TestCases/ *.sancov %t 2>&1 | \
+// RUN:   FileCheck --check-prefix=CHECK-SANCOV %s
+// RUN: %env_tool_opts=coverage=1 %t bar 2>&1 | FileCheck %s
+// RUN: %sancovcc -merge-raw *.sancov > merged/sanitizer_coverage_inline8bit_counter_dump.cpp.tmp.0.sancov
+// RUN: %sancovcc -covered-functions -strip_path_prefix=TestCases/ merged/*.sancov %t 2>&1 | \
+// RUN:   FileCheck --check-prefix=CHECK-MERGED %s
+// RUN: %env_tool_opts=coverage=0 %t 2>&1 | FileCheck --check-prefix=CHECK-NOCOV %s
+// RUN: rm -rf $DIR
+
+#include <stdio.h>
+
+__attribute__((noinline)) void foo() { fprintf(stderr, "foo\n"); }
+
+__attribute__((noinline)) void bar() { fprintf(stderr, "bar\n"); }
+
+int main(int argc, char **argv) {
+  foo();
+  if (argc > 1)
+    bar();
+}
+
+// CHECK: foo
+// CHECK: SanitizerCoverage: ./sanitizer_coverage_inline8bit_counter_dump.{{.*}}.sancov: {{[0-9]+}} PCs written
+//
+// CHECK-SANCOV-NOT: bar
+// CHECK-SANCOV: sanitizer_coverage_inline8bit_counter_dump.cpp:{{[0-9]+}} foo
+// CHECK-SANCOV-NEXT: sanitizer_coverage_inline8bit_counter_dump.cpp:{{[0-9]+}} main
+//
+// CHECK-MERGED: sanitizer_coverage_inline8bit_counter_dump.cpp:{{[0-9]+}} bar
+// CHECK-MERGED-NEXT: sanitizer_coverage_inline8bit_counter_dump.cpp:{{[0-9]+}} foo
+// CHECK-MERGED-NEXT: sanitizer_coverage_inline8bit_counter_dump.cpp:{{[0-9]+}} main
+//
+// CHECK-NOCOV-NOT: SanitizerCoverage
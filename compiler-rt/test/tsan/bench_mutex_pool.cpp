@@ -0,0 +1,32 @@
+// RUN: %clangxx_tsan %s -o %t
+// RUN: %run %t 2>&1 | FileCheck %s
+
+// bench.h needs pthread barriers which are not available on OS X
+// UNSUPPORTED: darwin
+
+#include "bench.h"
+
+// A thread pool: the workers take turns running tasks under one mutex, so
+// every lock acquires the clock of a different thread.
+pthread_mutex_t mtx;
+pthread_cond_t cv;
+int turn;
+
+void thread(int tid) {
+  for (int i = 0; i < bench_niter; i++) {
+    pthread_mutex_lock(&mtx);
+    while (turn % bench_nthread != tid)
+      pthread_cond_wait(&cv, &mtx);
+    turn++;
+    pthread_cond_broadcast(&cv);
+    pthread_mutex_unlock(&mtx);
+  }
+}
+
+void bench() {
+  pthread_mutex_init(&mtx, 0);
+  pthread_cond_init(&cv, 0);
+  start_thread_group(bench_nthread, thread);
+}
+
+// CHECK: DONE
@@ -0,0 +1,42 @@
+// Check that with streaming=true, buffers released by threads are written to
+// the log while tracing continues, and are not lost when they are handed out
+// again.
+//
+// RUN: %clangxx_xray -g -std=c++11 %s -o %t
+// RUN: rm -f fdr-streaming-*
+// RUN: XRAY_OPTIONS="verbosity=1 patch_premain=false \
+// RUN:   xray_logfile_base=fdr-streaming-" \
+// RUN:   XRAY_FDR_OPTIONS="func_duration_threshold_us=0 buffer_max=2 \
+// RUN:   streaming=true per_cpu_buffers=true" %run %t 2>&1 | FileCheck %s
+// RUN: %llvm_xray convert --output-format=yaml --symbolize --instr_map=%t \
+// RUN:   "`ls fdr-streaming-* | head -n1`" | FileCheck %s --check-prefix TRACE
+// RUN: rm fdr-streaming-*
+//
+// FIXME: Make llvm-xray work on non-x86_64 as well.
+// REQUIRES: x86_64-target-arch
+// REQUIRES: built-in-llvm-tree
+
+#include "xray/xray_log_interface.h"
+#include <cassert>
+#include <thread>
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) fn() {}
+
+int main(int argc, char *argv[]) {
+  auto status = __xray_log_init_mode("xray-fdr", "");
+  assert(status == XRayLogInitStatus::XRAY_LOG_INITIALIZED);
+  // CHECK: XRay: Log file in '{{.*}}'
+
+  __xray_patch();
+  // Only two buffers exist, so every thread reuses one of an earlier thread.
+  for (int I = 0; I < 8; ++I)
+    std::thread(fn).join();
+  __xray_unpatch();
+  assert(__xray_log_finalize() == XRAY_LOG_FINALIZED);
+  assert(__xray_log_flushLog() == XRAY_LOG_FLUSHED);
+  return 0;
+  // CHECK-NOT: Failed
+}
+
+// TRACE-COUNT-8: function: {{.*fn.*}}, cpu: {{.*}}, thread: {{[0-9]+}}, process: {{[0-9]+}}, kind: function-enter
+// TRACE-NOT: kind: function-enter
@@ -0,0 +1,82 @@
+// Check that we can patch and unpatch a group of functions at once, and that
+// only the functions in the group get patched.
+//
+// RUN: %clangxx_xray -fxray-instrument -std=c++11 %s -o %t
+// RUN: XRAY_OPTIONS="patch_premain=false" %run %t | FileCheck %s
+
+// UNSUPPORTED: target-is-mips64,target-is-mips64el
+
+#include "xray/xray_interface.h"
+
+#include <cstdint>
+#include <cstdio>
+
+bool called = false;
+
+void test_handler(int32_t fid, XRayEntryType type) {
+  printf("called: %d, type=%d\n", fid, static_cast<int32_t>(type));
+  called = true;
+}
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) a() {
+  printf("a\n");
+}
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) b() {
+  printf("b\n");
+}
+
+[[clang::xray_always_instrument]] void __attribute__((noinline)) c() {
+  printf("c\n");
+}
+
+int32_t find_id(void (*fn)()) {
+  for (auto i = __xray_max_function_id(); i != 0; --i)
+    if (__xray_function_address(i) == reinterpret_cast<uintptr_t>(fn))
+      return i;
+  return 0;
+}
+
+int main() {
+  __xray_set_handler(test_handler);
+  int32_t ids[] = {find_id(c), find_id(a)};
+  printf("%d %d %d\n", ids[1], find_id(b), ids[0]);
+  // CHECK: [[A:[0-9]+]] [[B:[0-9]+]] [[C:[0-9]+]]
+
+  auto status = __xray_patch_functions(ids, 2);
+  if (status != XRayPatchingStatus::SUCCESS)
+    printf("patching failed.\n");
+  a();
+  b();
+  c();
+  // CHECK-NEXT: called: [[A]], type=0
+  // CHECK-NEXT: a
+  // CHECK-NEXT: called: [[A]], type=1
+  // CHECK-NEXT: b
+  // CHECK-NEXT: called: [[C]], type=0
+  // CHECK-NEXT: c
+  // CHECK-NEXT: called: [[C]], type=1
+
+  status = __xray_unpatch_functions(ids, 2);
+  if (status != XRayPatchingStatus::SUCCESS)
+    printf("unpatching failed.\n");
+  called = false;
+  a();
+  c();
+  // CHECK-NEXT: a
+  // CHECK-NEXT: c
+  printf("called: %s\n", called ? "true" : "false");
+  // CHECK-NEXT: called: false
+
+  // An invalid id leaves everything as it was.
+  int32_t bad[] = {ids[0], 0};
+  status = __xray_patch_functions(bad, 2);
+  if (status == XRayPatchingStatus::FAILED)
+    printf("invalid id rejected.\n");
+  // CHECK-NEXT: invalid id rejected.
+  c();
+  // CHECK-NEXT: c
+  printf("called: %s\n", called ? "true" : "false");
+  // CHECK-NEXT: called: false
+  __xray_remove_handler();
+}
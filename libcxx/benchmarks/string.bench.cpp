@@ -49,6 +49,46 @@ static void BM_StringFindMatch2(benchmark::State &state) {
 }
 BENCHMARK(BM_StringFindMatch2)->Range(1, MAX_STRING_LEN / 4);
 
+// Benchmark find_first_of when none of the characters in the set occur.
+static void BM_StringFindFirstOfNoMatch(benchmark::State &state) {
+  std::string s1(state.range(0), '-');
+  std::string s2 = "\t\n\r ,;:|";
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s1.find_first_of(s2));
+}
+BENCHMARK(BM_StringFindFirstOfNoMatch)->Range(10, MAX_STRING_LEN);
+
+// Benchmark find_first_not_of skipping a run of characters from the set.
+static void BM_StringFindFirstNotOf(benchmark::State &state) {
+  std::string s1(state.range(0), ' ');
+  s1 += 'x';
+  std::string s2 = "\t\n\r ";
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s1.find_first_not_of(s2));
+}
+BENCHMARK(BM_StringFindFirstNotOf)->Range(10, MAX_STRING_LEN);
+
+// Benchmark find_last_of when the only match is at the front.
+static void BM_StringFindLastOf(benchmark::State &state) {
+  std::string s1 = "/";
+  s1 += std::string(state.range(0), '-');
+  std::string s2 = "/\\";
+  for (auto _ : state)
+    benchmark::DoNotOptimize(s1.find_last_of(s2));
+}
+BENCHMARK(BM_StringFindLastOf)->Range(10, MAX_STRING_LEN);
+
+// Benchmark building a string out of several pieces with operator+.
+static void BM_StringConcatChain(benchmark::State &state) {
+  std::string a(state.range(0), 'a');
+  std::string b(state.range(0), 'b');
+  for (auto _ : state) {
+    std::string r = a + ", " + b + ": " + (a + b);
+    benchmark::DoNotOptimize(r.data());
+  }
+}
+BENCHMARK(BM_StringConcatChain)->Range(1, MAX_STRING_LEN / 4);
+
 static void BM_StringCtorDefault(benchmark::State &state) {
   for (auto _ : state) {
     std::string Default;
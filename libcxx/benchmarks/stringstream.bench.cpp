@@ -37,4 +37,54 @@ static void BM_Istream_numbers(benchmark::State &state) {
 }
 
 BENCHMARK(BM_Istream_numbers)->RangeMultiplier(2)->Range(1024, 4096);
+
+static void BM_Istream_integers(benchmark::State &state) {
+  std::istringstream s;
+  long a1 = 0, a2 = 0, a3 = 0;
+  for (auto _ : state) {
+    s.clear();
+    s.str("-6 5000000 -50000000");
+    s >> a1 >> a2 >> a3;
+    benchmark::DoNotOptimize(a1 + a2 + a3);
+  }
+}
+BENCHMARK(BM_Istream_integers);
+
+static void BM_Ostream_integers(benchmark::State &state) {
+  std::ostringstream s;
+  long i = 0;
+  for (auto _ : state) {
+    s.str(std::string());
+    s << i << ' ' << -5000000 - i << ' ' << static_cast<unsigned>(i) * 7919u;
+    benchmark::DoNotOptimize(s.str());
+    ++i;
+  }
+}
+BENCHMARK(BM_Ostream_integers);
+
+static void BM_Ostream_hex(benchmark::State &state) {
+  std::ostringstream s;
+  s << std::hex << std::showbase;
+  unsigned long i = 0;
+  for (auto _ : state) {
+    s.str(std::string());
+    s << i * 0x9E3779B97F4A7C15ul;
+    benchmark::DoNotOptimize(s.str());
+    ++i;
+  }
+}
+BENCHMARK(BM_Ostream_hex);
+
+static void BM_Ostream_doubles(benchmark::State &state) {
+  std::ostringstream s;
+  double d = 0.5;
+  for (auto _ : state) {
+    s.str(std::string());
+    s << d << ' ' << -2.00005;
+    benchmark::DoNotOptimize(s.str());
+    d += 1.25;
+  }
+}
+BENCHMARK(BM_Ostream_doubles);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,271 @@
+//===------------------------- atomic.cpp ---------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "__config"
+#ifndef _LIBCPP_HAS_NO_THREADS
+
+#include "atomic"
+#include "climits"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#elif defined(_LIBCPP_WIN32API)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#if defined(_LIBCPP_HAS_COMMENT_LIB_PRAGMA)
+#pragma comment(lib, "synchronization")
+#endif
+#endif
+
+#if defined(__unix__) && !defined(__ANDROID__) && defined(__ELF__) && defined(_LIBCPP_HAS_COMMENT_LIB_PRAGMA)
+#pragma comment(lib, "pthread")
+#endif
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+// Blocking on an address. The wait may return spuriously; callers test their
+// condition again. It must not block if *__ptr is no longer __val.
+
+#ifdef __linux__
+
+static void
+__libcpp_platform_wait_on_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  __cxx_contention_t __val)
+{
+    syscall(SYS_futex, __ptr, FUTEX_WAIT_PRIVATE, __val, 0, 0, 0);
+}
+
+static void
+__libcpp_platform_wake_by_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  bool __notify_one)
+{
+    syscall(SYS_futex, __ptr, FUTEX_WAKE_PRIVATE,
+            __notify_one ? 1 : INT_MAX, 0, 0, 0);
+}
+
+#elif defined(__APPLE__)
+
+extern "C" int __ulock_wait(uint32_t __operation, void* __addr,
+                            uint64_t __value, uint32_t __timeout_us);
+extern "C" int __ulock_wake(uint32_t __operation, void* __addr,
+                            uint64_t __wake_value);
+
+#define _LIBCPP_UL_COMPARE_AND_WAIT 1
+#define _LIBCPP_ULF_WAKE_ALL 0x00000100
+
+static void
+__libcpp_platform_wait_on_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  __cxx_contention_t __val)
+{
+    __ulock_wait(_LIBCPP_UL_COMPARE_AND_WAIT,
+                 const_cast<__cxx_atomic_contention_t*>(__ptr),
+                 static_cast<uint32_t>(__val), 0);
+}
+
+static void
+__libcpp_platform_wake_by_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  bool __notify_one)
+{
+    __ulock_wake(_LIBCPP_UL_COMPARE_AND_WAIT |
+                     (__notify_one ? 0 : _LIBCPP_ULF_WAKE_ALL),
+                 const_cast<__cxx_atomic_contention_t*>(__ptr), 0);
+}
+
+#elif defined(_LIBCPP_WIN32API)
+
+static void
+__libcpp_platform_wait_on_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  __cxx_contention_t __val)
+{
+    ::WaitOnAddress(const_cast<__cxx_atomic_contention_t*>(__ptr), &__val,
+                    sizeof(__val), INFINITE);
+}
+
+static void
+__libcpp_platform_wake_by_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  bool __notify_one)
+{
+    void* __addr = const_cast<__cxx_atomic_contention_t*>(__ptr);
+    if (__notify_one)
+        ::WakeByAddressSingle(__addr);
+    else
+        ::WakeByAddressAll(__addr);
+}
+
+#else // <- Add other operating systems here
+
+// Without a way to block on an address, waiters poll with a timed backoff.
+
+struct __libcpp_value_changed {
+    __cxx_atomic_contention_t const volatile* __ptr_;
+    __cxx_contention_t __val_;
+
+    bool operator()() const {
+        return __cxx_atomic_load(__ptr_, memory_order_relaxed) != __val_;
+    }
+};
+
+static void
+__libcpp_platform_wait_on_address(__cxx_atomic_contention_t const volatile* __ptr,
+                                  __cxx_contention_t __val)
+{
+    __libcpp_value_changed __changed = {__ptr, __val};
+    __libcpp_thread_poll_with_backoff(__changed,
+                                      __libcpp_timed_backoff_policy());
+}
+
+static void
+__libcpp_platform_wake_by_address(__cxx_atomic_contention_t const volatile*,
+                                  bool)
+{
+}
+
+#endif // __linux__
+
+// The contention table. Each entry counts the threads that wait on the
+// atomics that hash to it, and holds the counter that waiters for atomics
+// of other sizes than __cxx_contention_t block on.
+
+static const size_t __libcpp_contention_table_size = 1 << 8;
+
+struct alignas(64) __libcpp_contention_table_entry {
+    __cxx_atomic_contention_t __contention_state_;
+    __cxx_atomic_contention_t __platform_state_;
+
+    _LIBCPP_CONSTEXPR __libcpp_contention_table_entry()
+        : __contention_state_(0), __platform_state_(0) {}
+};
+
+static __libcpp_contention_table_entry
+    __libcpp_contention_table[__libcpp_contention_table_size];
+
+static __libcpp_contention_table_entry*
+__libcpp_contention_state(void const volatile* __p)
+{
+    // Fibonacci hashing: neighbouring atomics land in different entries.
+    uint64_t __h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(__p));
+    __h *= 0x9E3779B97F4A7C15ULL;
+    return &__libcpp_contention_table[__h >> 56];
+}
+
+static_assert(__libcpp_contention_table_size == 1 << (64 - 56),
+              "the hash above must produce an index into the table");
+
+// The notifier changes the value it notifies about, then looks for waiters;
+// a waiter counts itself, then blocks while the value is unchanged. The
+// fence orders the notifier's change before its look, so that either it
+// sees the waiter or the waiter sees the change.
+
+static void
+__libcpp_contention_notify(__cxx_atomic_contention_t volatile* __contention_state,
+                           __cxx_atomic_contention_t const volatile* __platform_state,
+                           bool __notify_one)
+{
+    __cxx_atomic_thread_fence(memory_order_seq_cst);
+    if (0 != __cxx_atomic_load(__contention_state, memory_order_seq_cst))
+        __libcpp_platform_wake_by_address(__platform_state, __notify_one);
+}
+
+static __cxx_contention_t
+__libcpp_contention_monitor_for_wait(
+    __cxx_atomic_contention_t const volatile* __platform_state)
+{
+    return __cxx_atomic_load(__platform_state, memory_order_acquire);
+}
+
+static void
+__libcpp_contention_wait(__cxx_atomic_contention_t volatile* __contention_state,
+                         __cxx_atomic_contention_t const volatile* __platform_state,
+                         __cxx_contention_t __old_value)
+{
+    __cxx_atomic_fetch_add(__contention_state, __cxx_contention_t(1),
+                           memory_order_seq_cst);
+    __libcpp_platform_wait_on_address(__platform_state, __old_value);
+    __cxx_atomic_fetch_sub(__contention_state, __cxx_contention_t(1),
+                           memory_order_release);
+}
+
+// Atomics of any other type wait on the counter of their table entry, which
+// every notification bumps. Other atomics may share that counter, so
+// notify_one has to wake all its waiters.
+
+_LIBCPP_FUNC_VIS
+void __cxx_atomic_notify_one(void const volatile* __location)
+{
+    __cxx_atomic_notify_all(__location);
+}
+
+_LIBCPP_FUNC_VIS
+void __cxx_atomic_notify_all(void const volatile* __location)
+{
+    __libcpp_contention_table_entry* __entry =
+        __libcpp_contention_state(__location);
+    __cxx_atomic_fetch_add(&__entry->__platform_state_, __cxx_contention_t(1),
+                           memory_order_release);
+    __libcpp_contention_notify(&__entry->__contention_state_,
+                               &__entry->__platform_state_, false);
+}
+
+_LIBCPP_FUNC_VIS
+__cxx_contention_t __libcpp_atomic_monitor(void const volatile* __location)
+{
+    return __libcpp_contention_monitor_for_wait(
+        &__libcpp_contention_state(__location)->__platform_state_);
+}
+
+_LIBCPP_FUNC_VIS
+void __libcpp_atomic_wait(void const volatile* __location,
+                          __cxx_contention_t __old_value)
+{
+    __libcpp_contention_table_entry* __entry =
+        __libcpp_contention_state(__location);
+    __libcpp_contention_wait(&__entry->__contention_state_,
+                             &__entry->__platform_state_, __old_value);
+}
+
+// Atomics of type __cxx_contention_t are waited on directly, and only use
+// the table to count their waiters.
+
+_LIBCPP_FUNC_VIS
+void __cxx_atomic_notify_one(__cxx_atomic_contention_t const volatile* __location)
+{
+    __libcpp_contention_notify(
+        &__libcpp_contention_state(__location)->__contention_state_,
+        __location, true);
+}
+
+_LIBCPP_FUNC_VIS
+void __cxx_atomic_notify_all(__cxx_atomic_contention_t const volatile* __location)
+{
+    __libcpp_contention_notify(
+        &__libcpp_contention_state(__location)->__contention_state_,
+        __location, false);
+}
+
+_LIBCPP_FUNC_VIS
+__cxx_contention_t
+__libcpp_atomic_monitor(__cxx_atomic_contention_t const volatile* __location)
+{
+    return __libcpp_contention_monitor_for_wait(__location);
+}
+
+_LIBCPP_FUNC_VIS
+void __libcpp_atomic_wait(__cxx_atomic_contention_t const volatile* __location,
+                          __cxx_contention_t __old_value)
+{
+    __libcpp_contention_wait(
+        &__libcpp_contention_state(__location)->__contention_state_,
+        __location, __old_value);
+}
+
+_LIBCPP_END_NAMESPACE_STD
+
+#endif // !_LIBCPP_HAS_NO_THREADS
@@ -7,8 +7,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "charconv"
+#include "locale"
+#include "memory"
+#include <float.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "include/charconv_tables.h"
+
 _LIBCPP_BEGIN_NAMESPACE_STD
 
 namespace __itoa
@@ -157,4 +163,1057 @@ __u64toa(uint64_t value, char* buffer)
 
 }  // namespace __itoa
 
+namespace __floating_point
+{
+namespace
+{
+
+// The binary layout of the IEEE types handled here.
+template <typename _Fp>
+struct traits;
+
+template <>
+struct traits<float>
+{
+    using bits_type = uint32_t;
+    static constexpr int mantissa_bits = 23;
+    static constexpr int exponent_bits = 8;
+    static constexpr int exponent_bias = 127;
+    // The Eisel-Lemire parameters, see from_chars_floating_point below.
+    static constexpr int min_round_to_even = -17;
+    static constexpr int max_round_to_even = 10;
+    static constexpr int smallest_power_of_ten = -65;
+    static constexpr int largest_power_of_ten = 38;
+    static constexpr uint64_t max_exact_integer = uint64_t(1) << 24;
+    static constexpr int max_exact_power_of_ten = 10;
+};
+
+template <>
+struct traits<double>
+{
+    using bits_type = uint64_t;
+    static constexpr int mantissa_bits = 52;
+    static constexpr int exponent_bits = 11;
+    static constexpr int exponent_bias = 1023;
+    static constexpr int min_round_to_even = -4;
+    static constexpr int max_round_to_even = 23;
+    static constexpr int smallest_power_of_ten = -342;
+    static constexpr int largest_power_of_ten = 308;
+    static constexpr uint64_t max_exact_integer = uint64_t(1) << 53;
+    static constexpr int max_exact_power_of_ten = 22;
+};
+
+// A decimal floating-point value, mantissa * 10^exponent.
+struct decimal
+{
+    uint64_t mantissa;
+    int32_t exponent;
+};
+
+struct value128
+{
+    uint64_t high;
+    uint64_t low;
+};
+
+inline value128
+full_multiplication(uint64_t a, uint64_t b)
+{
+#ifndef _LIBCPP_HAS_NO_INT128
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return {static_cast<uint64_t>(r >> 64), static_cast<uint64_t>(r)};
+#else
+    const uint64_t a_lo = static_cast<uint32_t>(a), a_hi = a >> 32;
+    const uint64_t b_lo = static_cast<uint32_t>(b), b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+    return {hi_hi + (hi_lo >> 32) + (cross >> 32),
+            (cross << 32) | static_cast<uint32_t>(lo_lo)};
+#endif
+}
+
+inline int
+leading_zeros(uint64_t v)
+{
+    return __builtin_clzll(v);
+}
+
+// Shortest round-trip decimal digits, after Ulf Adams, "Ryu: Fast
+// Float-to-String Conversion" (PLDI 2018).
+
+// ceil(log2(5^e)) for 0 <= e <= 3528.
+inline int32_t
+pow5bits(int32_t e)
+{
+    return static_cast<int32_t>(
+        ((static_cast<uint32_t>(e) * 1217359) >> 19) + 1);
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650.
+inline uint32_t
+log10_pow2(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// floor(log10(5^e)) for 0 <= e <= 2620.
+inline uint32_t
+log10_pow5(int32_t e)
+{
+    return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+inline uint32_t
+pow5_factor(uint64_t value)
+{
+    uint32_t count = 0;
+    for (; value % 5 == 0; value /= 5)
+        ++count;
+    return count;
+}
+
+inline bool
+multiple_of_pow5(uint64_t value, uint32_t p)
+{
+    return pow5_factor(value) >= p;
+}
+
+inline bool
+multiple_of_pow2(uint64_t value, uint32_t p)
+{
+    return (value & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, where mul is a 128-bit {low, high} pair and 64 < j < 128.
+inline uint64_t
+mul_shift64(uint64_t m, const uint64_t* mul, int32_t j)
+{
+    const value128 b0 = full_multiplication(m, mul[0]);
+    const value128 b2 = full_multiplication(m, mul[1]);
+    const uint64_t low = b0.high + b2.low;
+    const uint64_t high = b2.high + (low < b0.high);
+    const int32_t dist = j - 64;
+    return (high << (64 - dist)) | (low >> dist);
+}
+
+// (m * factor) >> shift, where 32 < shift.
+inline uint32_t
+mul_shift32(uint32_t m, uint64_t factor, int32_t shift)
+{
+    const uint64_t bits0 =
+        static_cast<uint64_t>(m) * static_cast<uint32_t>(factor);
+    const uint64_t bits1 = static_cast<uint64_t>(m) * (factor >> 32);
+    const uint64_t sum = (bits0 >> 32) + bits1;
+    return static_cast<uint32_t>(sum >> (shift - 32));
+}
+
+decimal
+d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - 1023 - 52 - 2;
+        m2 = (uint64_t(1) << 52) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // Step 2: the interval of valid decimal representations, scaled by 4.
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    // Step 3: convert to a decimal power base.
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = 125 + pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = mul_shift64(mv, double_pow5_inv_split[q], i);
+        vp = mul_shift64(mv + 2, double_pow5_inv_split[q], i);
+        vm = mul_shift64(mv - 1 - mm_shift, double_pow5_inv_split[q], i);
+        if (q <= 21)
+        {
+            // Only one of mp, mv, and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0)
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - 125;
+        const int32_t j = static_cast<int32_t>(q) - k;
+        vr = mul_shift64(mv, double_pow5_split[i], j);
+        vp = mul_shift64(mv + 2, double_pow5_split[i], j);
+        vm = mul_shift64(mv - 1 - mm_shift, double_pow5_split[i], j);
+        if (q <= 1)
+        {
+            // mv has at least q trailing zero bits, and so do mm and mp when
+            // the bounds are inclusive.
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 63)
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
+    }
+
+    // Step 4: find the shortest decimal representation in the interval.
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    uint64_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros)
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        // Round half to even when the value is exactly representable.
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        // The common case, where neither bound can have trailing zeros.
+        bool round_up = false;
+        if (vp / 100 > vm / 100)
+        {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    return {output, e10 + removed};
+}
+
+decimal
+f2d(uint32_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = static_cast<int32_t>(ieee_exponent) - 127 - 23 - 2;
+        m2 = (uint32_t(1) << 23) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    uint8_t last_removed_digit = 0;
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = 59 + pow5bits(static_cast<int32_t>(q)) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = mul_shift32(mv, float_pow5_inv_split[q], i);
+        vp = mul_shift32(mp, float_pow5_inv_split[q], i);
+        vm = mul_shift32(mm, float_pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            // The loop below removes no digit, so compute the one that the
+            // rounding depends on here.
+            const int32_t l = 59 + pow5bits(static_cast<int32_t>(q - 1)) - 1;
+            last_removed_digit = static_cast<uint8_t>(
+                mul_shift32(mv, float_pow5_inv_split[q - 1],
+                            -e2 + static_cast<int32_t>(q) - 1 + l) %
+                10);
+        }
+        if (q <= 9)
+        {
+            if (mv % 5 == 0)
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_trailing_zeros = multiple_of_pow5(mm, q);
+            else
+                vp -= multiple_of_pow5(mp, q);
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - 61;
+        int32_t j = static_cast<int32_t>(q) - k;
+        vr = mul_shift32(mv, float_pow5_split[i], j);
+        vp = mul_shift32(mp, float_pow5_split[i], j);
+        vm = mul_shift32(mm, float_pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            j = static_cast<int32_t>(q) - 1 - (pow5bits(i + 1) - 61);
+            last_removed_digit = static_cast<uint8_t>(
+                mul_shift32(mv, float_pow5_split[i + 1], j) % 10);
+        }
+        if (q <= 1)
+        {
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 31)
+            vr_trailing_zeros = multiple_of_pow2(mv, q - 1);
+    }
+
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros)
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        if (vm_trailing_zeros)
+        {
+            for (; vm % 10 == 0; ++removed)
+            {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+            }
+        }
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    }
+    else
+    {
+        for (; vp / 10 > vm / 10; ++removed)
+        {
+            last_removed_digit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+        }
+        output = vr + (vr == vm || last_removed_digit >= 5);
+    }
+    return {output, e10 + removed};
+}
+
+inline decimal
+to_decimal(float, uint32_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    return f2d(ieee_mantissa, ieee_exponent);
+}
+
+inline decimal
+to_decimal(double, uint64_t ieee_mantissa, uint32_t ieee_exponent)
+{
+    return d2d(ieee_mantissa, ieee_exponent);
+}
+
+inline to_chars_result
+copy_to(char* first, char* last, const char* s, size_t n)
+{
+    if (static_cast<size_t>(last - first) < n)
+        return {last, errc::value_too_large};
+    memcpy(first, s, n);
+    return {first + n, errc{}};
+}
+
+// Writes the exact decimal value of m2 * 2^e2, an integer, to buffer.
+char*
+write_exact_integer(char* buffer, uint64_t m2, int32_t e2)
+{
+    // Base 10^9 digits, least significant first. 2^1024 has 35 of them.
+    const uint32_t base = 1000000000;
+    uint32_t limbs[36];
+    int n = 0;
+    for (; m2 != 0; m2 /= base)
+        limbs[n++] = static_cast<uint32_t>(m2 % base);
+    for (; e2 > 0; e2 -= 32)
+    {
+        const int32_t shift = e2 < 32 ? e2 : 32;
+        uint64_t carry = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            const uint64_t t =
+                (static_cast<uint64_t>(limbs[i]) << shift) + carry;
+            limbs[i] = static_cast<uint32_t>(t % base);
+            carry = t / base;
+        }
+        for (; carry != 0; carry /= base)
+            limbs[n++] = static_cast<uint32_t>(carry % base);
+    }
+    buffer = __itoa::__u32toa(limbs[n - 1], buffer);
+    for (int i = n - 2; i >= 0; --i)
+    {
+        char* end = __itoa::__u32toa(limbs[i], buffer);
+        const ptrdiff_t len = end - buffer;
+        memmove(buffer + 9 - len, buffer, len);
+        memset(buffer, '0', 9 - len);
+        buffer += 9;
+    }
+    return buffer;
+}
+
+to_chars_result
+write_scientific(char* first, char* last, const char* digits, int length,
+                 int32_t exponent)
+{
+    char buffer[32];
+    char* p = buffer;
+    *p++ = digits[0];
+    if (length > 1)
+    {
+        *p++ = '.';
+        memcpy(p, digits + 1, length - 1);
+        p += length - 1;
+    }
+    *p++ = 'e';
+    *p++ = exponent < 0 ? '-' : '+';
+    const uint32_t x = exponent < 0 ? -exponent : exponent;
+    if (x < 10)
+        *p++ = '0';
+    p = __itoa::__u32toa(x, p);
+    return copy_to(first, last, buffer, p - buffer);
+}
+
+// Writes length digits with the decimal exponent exponent in fixed notation.
+// The digits must be exact: allocate the integer part otherwise.
+to_chars_result
+write_fixed(char* first, char* last, const char* digits, int length,
+            int32_t exponent)
+{
+    const int32_t x = exponent + length - 1;
+    if (exponent >= 0)
+    {
+        if (last - first < length + exponent)
+            return {last, errc::value_too_large};
+        memcpy(first, digits, length);
+        memset(first + length, '0', exponent);
+        return {first + length + exponent, errc{}};
+    }
+    if (x >= 0)
+    {
+        if (last - first < length + 1)
+            return {last, errc::value_too_large};
+        memcpy(first, digits, x + 1);
+        first[x + 1] = '.';
+        memcpy(first + x + 2, digits + x + 1, length - x - 1);
+        return {first + length + 1, errc{}};
+    }
+    if (last - first < length + 1 - x)
+        return {last, errc::value_too_large};
+    first[0] = '0';
+    first[1] = '.';
+    memset(first + 2, '0', -x - 1);
+    memcpy(first + 1 - x, digits, length);
+    return {first + length + 1 - x, errc{}};
+}
+
+template <typename _Fp>
+to_chars_result
+write_hex(char* first, char* last, typename traits<_Fp>::bits_type mantissa,
+          uint32_t exponent)
+{
+    using T = traits<_Fp>;
+    // Pad the mantissa to a whole number of hexadecimal digits.
+    const int digits = (T::mantissa_bits + 3) / 4;
+    uint64_t fraction = static_cast<uint64_t>(mantissa)
+                        << (digits * 4 - T::mantissa_bits);
+    int32_t e;
+    char buffer[32];
+    char* p = buffer;
+    if (exponent == 0)
+    {
+        *p++ = '0';
+        e = mantissa == 0 ? 0 : 1 - T::exponent_bias;
+    }
+    else
+    {
+        *p++ = '1';
+        e = static_cast<int32_t>(exponent) - T::exponent_bias;
+    }
+    if (fraction != 0)
+    {
+        *p++ = '.';
+        for (int i = digits - 1; i >= 0 && fraction != 0; --i)
+        {
+            *p++ = "0123456789abcdef"[(fraction >> (i * 4)) & 0xf];
+            fraction &= (uint64_t(1) << (i * 4)) - 1;
+        }
+    }
+    *p++ = 'p';
+    *p++ = e < 0 ? '-' : '+';
+    p = __itoa::__u32toa(e < 0 ? -e : e, p);
+    return copy_to(first, last, buffer, p - buffer);
+}
+
+// The shortest representation that round-trips. fmt is zero for the
+// overload without a chars_format.
+template <typename _Fp>
+to_chars_result
+to_chars_shortest(char* first, char* last, _Fp value, chars_format fmt)
+{
+    using T = traits<_Fp>;
+    using bits_type = typename T::bits_type;
+    bits_type bits;
+    memcpy(&bits, &value, sizeof(value));
+    const bits_type mantissa = bits & ((bits_type(1) << T::mantissa_bits) - 1);
+    const uint32_t exponent = static_cast<uint32_t>(
+        (bits >> T::mantissa_bits) & ((1u << T::exponent_bits) - 1));
+
+    if (bits >> (T::mantissa_bits + T::exponent_bits))
+    {
+        if (first == last)
+            return {last, errc::value_too_large};
+        *first++ = '-';
+    }
+    if (exponent == (1u << T::exponent_bits) - 1)
+        return mantissa == 0 ? copy_to(first, last, "inf", 3)
+                             : copy_to(first, last, "nan", 3);
+    if (fmt == chars_format::hex)
+        return write_hex<_Fp>(first, last, mantissa, exponent);
+    if (exponent == 0 && mantissa == 0)
+        return fmt == chars_format::scientific
+                   ? copy_to(first, last, "0e+00", 5)
+                   : copy_to(first, last, "0", 1);
+
+    const decimal v = to_decimal(value, mantissa, exponent);
+    char digits[24];
+    const int length =
+        static_cast<int>(__itoa::__u64toa(v.mantissa, digits) - digits);
+    const int32_t x = v.exponent + length - 1;
+
+    bool fixed;
+    if (fmt == chars_format::fixed)
+        fixed = true;
+    else if (fmt == chars_format::scientific)
+        fixed = false;
+    else if (fmt == chars_format::general)
+        // As by printf's %g with the default precision of 6.
+        fixed = -4 <= x && x < 6;
+    else
+    {
+        // Whichever is shorter, preferring fixed on a tie.
+        const int scientific_length =
+            length + (length > 1) + 2 + (x <= -100 || x >= 100 ? 3 : 2);
+        const int fixed_length = v.exponent >= 0 ? length + v.exponent
+                                 : x >= 0        ? length + 1
+                                                 : length + 1 - x;
+        fixed = fixed_length <= scientific_length;
+    }
+    if (!fixed)
+        return write_scientific(first, last, digits, length, x);
+
+    // An integer too large for the mantissa has more exact digits than the
+    // shortest ones; printing those is closer to the value than zeros.
+    const int32_t e2 = static_cast<int32_t>(exponent) - T::exponent_bias -
+                       T::mantissa_bits;
+    if (v.exponent > 0 && e2 > 0)
+    {
+        char buffer[320];
+        char* end = write_exact_integer(
+            buffer, mantissa | (bits_type(1) << T::mantissa_bits), e2);
+        return copy_to(first, last, buffer, end - buffer);
+    }
+    return write_fixed(first, last, digits, length, v.exponent);
+}
+
+template <typename _Fp>
+to_chars_result
+to_chars_precision(char* first, char* last, _Fp value, chars_format fmt,
+                   int precision)
+{
+    if (precision < 0)
+    {
+        // As with printf, a negative precision is taken as omitted.
+        if (fmt == chars_format::hex)
+            return to_chars_shortest(first, last, value, fmt);
+        precision = 6;
+    }
+
+    const char* spec = fmt == chars_format::scientific ? "%.*e"
+                       : fmt == chars_format::fixed    ? "%.*f"
+                       : fmt == chars_format::hex      ? "%.*a"
+                                                       : "%.*g";
+    const double d = value;
+    char stack_buffer[128];
+    char* buffer = stack_buffer;
+    unique_ptr<char[]> heap_buffer;
+    int n = __libcpp_snprintf_l(buffer, sizeof(stack_buffer),
+                                _LIBCPP_GET_C_LOCALE, spec, precision, d);
+    if (n < 0)
+        return {last, errc::value_too_large};
+    if (static_cast<size_t>(n) >= sizeof(stack_buffer))
+    {
+        heap_buffer.reset(new char[n + 1]);
+        buffer = heap_buffer.get();
+        n = __libcpp_snprintf_l(buffer, n + 1, _LIBCPP_GET_C_LOCALE, spec,
+                                precision, d);
+    }
+
+    const char* s = buffer;
+    if (fmt == chars_format::hex)
+    {
+        // Drop printf's "0x" prefix, after the sign if any.
+        const size_t sign = *s == '-';
+        if (sign && first == last)
+            return {last, errc::value_too_large};
+        if (sign)
+            *first++ = '-';
+        s += sign + 2;
+        n -= static_cast<int>(sign + 2);
+    }
+    return copy_to(first, last, s, n);
+}
+
+// Parses a floating-point number, after Daniel Lemire, "Number Parsing at a
+// Gigabyte per Second" (2021), and strtod when that is not conclusive.
+
+// floor(log2(10^q)) + 63, for -342 <= q <= 308.
+inline int32_t
+power(int32_t q)
+{
+    return (((152170 + 65536) * q) >> 16) + 63;
+}
+
+// The biased exponent and the mantissa of w * 10^q, as the Eisel-Lemire
+// algorithm computes them. A negative power2 means that it could not decide.
+struct adjusted_mantissa
+{
+    uint64_t mantissa;
+    int32_t power2;
+};
+
+template <typename _Fp>
+adjusted_mantissa
+compute_float(int64_t q, uint64_t w)
+{
+    using T = traits<_Fp>;
+    const int32_t infinite_power = (1 << T::exponent_bits) - 1;
+    if (w == 0 || q < T::smallest_power_of_ten)
+        return {0, 0};
+    if (q > T::largest_power_of_ten)
+        return {0, infinite_power};
+
+    const int lz = leading_zeros(w);
+    w <<= lz;
+
+    // A product accurate to at least mantissa_bits + 3 bits.
+    const int bit_precision = T::mantissa_bits + 3;
+    const uint64_t precision_mask = ~uint64_t(0) >> bit_precision;
+    const uint64_t* pow5 = power_of_five_128[q + 342];
+    value128 product = full_multiplication(w, pow5[0]);
+    if ((product.high & precision_mask) == precision_mask)
+    {
+        const value128 second = full_multiplication(w, pow5[1]);
+        product.low += second.high;
+        if (second.high > product.low)
+            ++product.high;
+    }
+    // Beyond these powers the product may not be exact enough.
+    if (product.low == ~uint64_t(0) && (q < -27 || q > 55))
+        return {0, -1};
+
+    const int upperbit = static_cast<int>(product.high >> 63);
+    adjusted_mantissa answer;
+    answer.mantissa = product.high >> (upperbit + 64 - T::mantissa_bits - 3);
+    answer.power2 = power(static_cast<int32_t>(q)) + upperbit - lz -
+                    (-T::exponent_bias);
+    if (answer.power2 <= 0)
+    {
+        // A subnormal, or zero.
+        if (-answer.power2 + 1 >= 64)
+            return {0, 0};
+        answer.mantissa >>= -answer.power2 + 1;
+        answer.mantissa += (answer.mantissa & 1);
+        answer.mantissa >>= 1;
+        answer.power2 =
+            answer.mantissa < (uint64_t(1) << T::mantissa_bits) ? 0 : 1;
+        return answer;
+    }
+
+    // Exactly halfway between two values: round to even.
+    if (product.low <= 1 && q >= T::min_round_to_even &&
+        q <= T::max_round_to_even && (answer.mantissa & 3) == 1)
+    {
+        if ((answer.mantissa << (upperbit + 64 - T::mantissa_bits - 3)) ==
+            product.high)
+            answer.mantissa &= ~uint64_t(1);
+    }
+
+    answer.mantissa += (answer.mantissa & 1);
+    answer.mantissa >>= 1;
+    if (answer.mantissa >= (uint64_t(2) << T::mantissa_bits))
+    {
+        answer.mantissa = uint64_t(1) << T::mantissa_bits;
+        ++answer.power2;
+    }
+    answer.mantissa &= ~(uint64_t(1) << T::mantissa_bits);
+    if (answer.power2 >= infinite_power)
+        return {0, infinite_power};
+    return answer;
+}
+
+template <typename _Fp>
+_Fp
+to_float(bool negative, adjusted_mantissa am)
+{
+    using T = traits<_Fp>;
+    using bits_type = typename T::bits_type;
+    bits_type bits = static_cast<bits_type>(am.mantissa) |
+                     static_cast<bits_type>(am.power2) << T::mantissa_bits |
+                     static_cast<bits_type>(negative)
+                         << (T::mantissa_bits + T::exponent_bits);
+    _Fp value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline float
+parse_with_strtod(const char* s, float*)
+{
+    return strtof(s, nullptr);
+}
+
+inline double
+parse_with_strtod(const char* s, double*)
+{
+    return strtod(s, nullptr);
+}
+
+// Whether [first, last) starts with the lowercase str, ignoring case.
+inline bool
+starts_with(const char* first, const char* last, const char* str)
+{
+    for (; *str; ++first, ++str)
+        if (first == last || (*first | 0x20) != *str)
+            return false;
+    return true;
+}
+
+inline int
+hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+        return (c | 0x20) - 'a' + 10;
+    return -1;
+}
+
+// A digit of the given base, or -1.
+inline int
+digit(char c, bool hex)
+{
+    return hex ? hex_digit(c) : (c >= '0' && c <= '9' ? c - '0' : -1);
+}
+
+template <typename _Fp>
+from_chars_result
+from_chars_floating_point(const char* first, const char* last, _Fp& value,
+                          chars_format fmt)
+{
+    using T = traits<_Fp>;
+    const char* p = first;
+    const bool negative = p != last && *p == '-';
+    p += negative;
+
+    if (p != last && (*p | 0x20) == 'i')
+    {
+        if (!starts_with(p, last, "inf"))
+            return {first, errc::invalid_argument};
+        p += starts_with(p, last, "infinity") ? 8 : 3;
+        value = negative ? -numeric_limits<_Fp>::infinity()
+                         : numeric_limits<_Fp>::infinity();
+        return {p, errc{}};
+    }
+    if (p != last && (*p | 0x20) == 'n')
+    {
+        if (!starts_with(p, last, "nan"))
+            return {first, errc::invalid_argument};
+        p += 3;
+        if (p != last && *p == '(')
+        {
+            const char* q = p + 1;
+            while (q != last && (digit(*q, true) >= 0 || *q == '_' ||
+                                 ((*q | 0x20) >= 'a' && (*q | 0x20) <= 'z')))
+                ++q;
+            if (q != last && *q == ')')
+                p = q + 1;
+        }
+        value = negative ? -numeric_limits<_Fp>::quiet_NaN()
+                         : numeric_limits<_Fp>::quiet_NaN();
+        return {p, errc{}};
+    }
+
+    // The significand: up to 19 significant digits accumulate in w, the rest
+    // only shift the exponent.
+    const bool hex = fmt == chars_format::hex;
+    const int max_digits = hex ? 16 : 19;
+    const char* const int_begin = p;
+    uint64_t w = 0;
+    int64_t exponent = 0;
+    int significant = 0;
+    bool truncated = false;
+    for (int d; p != last && (d = digit(*p, hex)) >= 0; ++p)
+    {
+        if (significant < max_digits)
+        {
+            w = w * (hex ? 16 : 10) + d;
+            significant += w != 0;
+        }
+        else
+        {
+            truncated |= d != 0;
+            ++exponent;
+        }
+    }
+    const char* const int_end = p;
+    const char* frac_begin = p;
+    if (p != last && *p == '.')
+    {
+        frac_begin = ++p;
+        for (int d; p != last && (d = digit(*p, hex)) >= 0; ++p)
+        {
+            if (significant < max_digits)
+            {
+                w = w * (hex ? 16 : 10) + d;
+                significant += w != 0;
+                --exponent;
+            }
+            else
+                truncated |= d != 0;
+        }
+    }
+    const char* const frac_end = p;
+    if (int_begin == int_end && frac_begin == frac_end)
+        return {first, errc::invalid_argument};
+    if (hex)
+        exponent *= 4;
+
+    // The exponent, saturated well beyond the range of any type.
+    const char marker = hex ? 'p' : 'e';
+    const bool exponent_allowed = hex || fmt != chars_format::fixed;
+    bool has_exponent = false;
+    int64_t written_exponent = 0;
+    if (exponent_allowed && p != last && (*p | 0x20) == marker)
+    {
+        const char* q = p + 1;
+        const bool negative_exponent = q != last && *q == '-';
+        q += q != last && (*q == '-' || *q == '+');
+        if (q != last && *q >= '0' && *q <= '9')
+        {
+            int64_t e = 0;
+            for (; q != last && *q >= '0' && *q <= '9'; ++q)
+                if (e < 100000000)
+                    e = e * 10 + (*q - '0');
+            written_exponent = negative_exponent ? -e : e;
+            exponent += written_exponent;
+            has_exponent = true;
+            p = q;
+        }
+    }
+    if (fmt == chars_format::scientific && !has_exponent)
+        return {first, errc::invalid_argument};
+
+    from_chars_result result = {p, errc{}};
+    if (w == 0)
+    {
+        value = negative ? -_Fp(0) : _Fp(0);
+        return result;
+    }
+
+    if (!hex)
+    {
+        // Exact when both w and the power of ten are, and the arithmetic is
+        // done in the precision of _Fp.
+        if (!truncated && FLT_EVAL_METHOD == 0 && w <= T::max_exact_integer &&
+            -T::max_exact_power_of_ten <= exponent &&
+            exponent <= T::max_exact_power_of_ten)
+        {
+            static constexpr double powers_of_ten[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            _Fp r = static_cast<_Fp>(w);
+            if (exponent < 0)
+                r = r / static_cast<_Fp>(powers_of_ten[-exponent]);
+            else
+                r = r * static_cast<_Fp>(powers_of_ten[exponent]);
+            value = negative ? -r : r;
+            return result;
+        }
+
+        adjusted_mantissa am = compute_float<_Fp>(exponent, w);
+        if (truncated && am.power2 >= 0)
+        {
+            // The value lies between w and w + 1 times the power of ten.
+            const adjusted_mantissa upper = compute_float<_Fp>(exponent, w + 1);
+            if (upper.mantissa != am.mantissa || upper.power2 != am.power2)
+                am.power2 = -1;
+        }
+        if (am.power2 >= 0)
+        {
+            const int32_t infinite_power = (1 << T::exponent_bits) - 1;
+            if (am.power2 == infinite_power ||
+                (am.power2 == 0 && am.mantissa == 0))
+                return {p, errc::result_out_of_range};
+            value = to_float<_Fp>(negative, am);
+            return result;
+        }
+    }
+
+    // Let strtod round the digits, normalized so that the current locale's
+    // decimal point does not matter.
+    const size_t digits = (int_end - int_begin) + (frac_end - frac_begin);
+    unique_ptr<char[]> buffer(new char[digits + 32]);
+    char* s = buffer.get();
+    if (hex)
+    {
+        *s++ = '0';
+        *s++ = 'x';
+    }
+    memcpy(s, int_begin, int_end - int_begin);
+    s += int_end - int_begin;
+    memcpy(s, frac_begin, frac_end - frac_begin);
+    s += frac_end - frac_begin;
+    *s++ = marker;
+    const int64_t e = written_exponent - (hex ? 4 : 1) *
+                      static_cast<int64_t>(frac_end - frac_begin);
+    if (e < 0)
+        *s++ = '-';
+    s = __itoa::__u64toa(e < 0 ? -e : e, s);
+    *s = '\0';
+    const _Fp r = parse_with_strtod(buffer.get(), static_cast<_Fp*>(nullptr));
+    if (r == numeric_limits<_Fp>::infinity() || r == 0)
+        return {p, errc::result_out_of_range};
+    value = negative ? -r : r;
+    return result;
+}
+
+}  // namespace
+}  // namespace __floating_point
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value)
+{
+    return __floating_point::to_chars_shortest(__first, __last, __value,
+                                               chars_format{});
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value)
+{
+    return __floating_point::to_chars_shortest(__first, __last, __value,
+                                               chars_format{});
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt)
+{
+    return __floating_point::to_chars_shortest(__first, __last, __value, __fmt);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt)
+{
+    return __floating_point::to_chars_shortest(__first, __last, __value, __fmt);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, float __value, chars_format __fmt,
+         int __precision)
+{
+    return __floating_point::to_chars_precision(__first, __last, __value, __fmt,
+                                                __precision);
+}
+
+to_chars_result
+to_chars(char* __first, char* __last, double __value, chars_format __fmt,
+         int __precision)
+{
+    return __floating_point::to_chars_precision(__first, __last, __value, __fmt,
+                                                __precision);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, float& __value,
+           chars_format __fmt)
+{
+    return __floating_point::from_chars_floating_point(__first, __last, __value,
+                                                       __fmt);
+}
+
+from_chars_result
+from_chars(const char* __first, const char* __last, double& __value,
+           chars_format __fmt)
+{
+    return __floating_point::from_chars_floating_point(__first, __last, __value,
+                                                       __fmt);
+}
+
 _LIBCPP_END_NAMESPACE_STD
@@ -0,0 +1,591 @@
+//===------------------------ memory_resource.cpp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "memory_resource"
+#include "include/atomic_support.h"
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+namespace pmr
+{
+
+// memory_resource
+
+memory_resource::~memory_resource() = default;
+
+// new_delete_resource()
+
+namespace {
+
+// The library itself is built without the aligned allocation language
+// feature, so __libcpp_allocate would ignore __align. Call the aligned
+// operators directly instead.
+class __new_delete_memory_resource_imp
+    : public memory_resource
+{
+    void* do_allocate(size_t __bytes, size_t __align) override
+    {
+#if !defined(_LIBCPP_HAS_NO_LIBRARY_ALIGNED_ALLOCATION)
+        if (__is_overaligned_for_new(__align))
+            return ::operator new(__bytes, static_cast<align_val_t>(__align));
+#endif
+        return _VSTD::__libcpp_allocate(__bytes, __align);
+    }
+
+    void do_deallocate(void* __p, size_t __bytes, size_t __align) override
+    {
+#if !defined(_LIBCPP_HAS_NO_LIBRARY_ALIGNED_ALLOCATION)
+        if (__is_overaligned_for_new(__align))
+            return ::operator delete(__p, static_cast<align_val_t>(__align));
+#endif
+        _VSTD::__libcpp_deallocate(__p, __bytes, __align);
+    }
+
+    bool do_is_equal(const memory_resource& __other) const _NOEXCEPT override
+    {
+        return &__other == this;
+    }
+
+public:
+    ~__new_delete_memory_resource_imp() override = default;
+};
+
+// null_memory_resource()
+
+class __null_memory_resource_imp
+    : public memory_resource
+{
+public:
+    ~__null_memory_resource_imp() override = default;
+
+private:
+    void* do_allocate(size_t, size_t) override
+    {
+        __throw_bad_alloc();
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const memory_resource& __other) const _NOEXCEPT override
+    {
+        return &__other == this;
+    }
+};
+
+// The global resources are never destroyed, so that they can still be used
+// from the destructors of other static objects.
+union __resource_init_helper
+{
+    struct
+    {
+        __new_delete_memory_resource_imp __new_delete_res;
+        __null_memory_resource_imp __null_res;
+    } __resources;
+    char __dummy;
+    _LIBCPP_CONSTEXPR_AFTER_CXX11 __resource_init_helper() : __resources() {}
+    ~__resource_init_helper() {}
+};
+
+// Detect if the init_priority attribute is supported.
+#if (defined(_LIBCPP_COMPILER_GCC) && defined(__APPLE__)) \
+    || defined(_LIBCPP_COMPILER_MSVC)
+// GCC on Apple doesn't support the init priority attribute,
+// and MSVC doesn't support any GCC attributes.
+# define _LIBCPP_INIT_PRIORITY_MAX
+#else
+# define _LIBCPP_INIT_PRIORITY_MAX __attribute__((init_priority(101)))
+#endif
+
+// When compiled in C++14 this initialization should be a constant expression.
+// Only in C++11 is "init_priority" needed to ensure initialization order.
+#if _LIBCPP_STD_VER > 11
+_LIBCPP_SAFE_STATIC
+#endif
+__resource_init_helper __res_init _LIBCPP_INIT_PRIORITY_MAX;
+
+_LIBCPP_SAFE_STATIC memory_resource* __default_res =
+    &__res_init.__resources.__new_delete_res;
+
+} // end namespace
+
+memory_resource* new_delete_resource() _NOEXCEPT
+{
+    return &__res_init.__resources.__new_delete_res;
+}
+
+memory_resource* null_memory_resource() _NOEXCEPT
+{
+    return &__res_init.__resources.__null_res;
+}
+
+// default_memory_resource()
+
+memory_resource* get_default_resource() _NOEXCEPT
+{
+    return __libcpp_atomic_load(&__default_res, _AO_Acquire);
+}
+
+memory_resource* set_default_resource(memory_resource* __new_res) _NOEXCEPT
+{
+    if (__new_res == nullptr)
+        __new_res = new_delete_resource();
+    return __libcpp_atomic_exchange(&__default_res, __new_res, _AO_Acq_Rel);
+}
+
+// 23.12.5, mem.res.pool
+
+static size_t __roundup(size_t __count, size_t __alignment)
+{
+    size_t __mask = __alignment - 1;
+    return (__count + __mask) & ~__mask;
+}
+
+struct unsynchronized_pool_resource::__adhoc_pool::__chunk_footer
+{
+    __chunk_footer* __next_;
+    char* __start_;
+    size_t __align_;
+    size_t __allocation_size()
+    {
+        return (reinterpret_cast<char*>(this) - __start_) + sizeof(*this);
+    }
+};
+
+void unsynchronized_pool_resource::__adhoc_pool::__release_ptr(
+    memory_resource* __upstream)
+{
+    while (__first_ != nullptr)
+    {
+        __chunk_footer* __next = __first_->__next_;
+        __upstream->deallocate(__first_->__start_,
+                               __first_->__allocation_size(),
+                               __first_->__align_);
+        __first_ = __next;
+    }
+}
+
+void* unsynchronized_pool_resource::__adhoc_pool::__do_allocate(
+    memory_resource* __upstream, size_t __bytes, size_t __align)
+{
+    const size_t __footer_size = sizeof(__chunk_footer);
+    const size_t __footer_align = alignof(__chunk_footer);
+
+    if (__align < __footer_align)
+        __align = __footer_align;
+
+    size_t __aligned_capacity =
+        __roundup(__bytes, __footer_align) + __footer_size;
+
+    void* __result = __upstream->allocate(__aligned_capacity, __align);
+
+    __chunk_footer* __h = reinterpret_cast<__chunk_footer*>(
+        static_cast<char*>(__result) + __aligned_capacity - __footer_size);
+    __h->__next_ = __first_;
+    __h->__start_ = static_cast<char*>(__result);
+    __h->__align_ = __align;
+    __first_ = __h;
+    return __result;
+}
+
+void unsynchronized_pool_resource::__adhoc_pool::__do_deallocate(
+    memory_resource* __upstream, void* __p, size_t, size_t)
+{
+    _LIBCPP_ASSERT(__first_ != nullptr,
+                   "deallocating a block that was not allocated with this "
+                   "allocator");
+    if (__first_->__start_ == __p)
+    {
+        __chunk_footer* __next = __first_->__next_;
+        __upstream->deallocate(__p, __first_->__allocation_size(),
+                               __first_->__align_);
+        __first_ = __next;
+        return;
+    }
+    for (__chunk_footer* __h = __first_; __h->__next_ != nullptr;
+         __h = __h->__next_)
+    {
+        if (__h->__next_->__start_ == __p)
+        {
+            __chunk_footer* __next = __h->__next_->__next_;
+            __upstream->deallocate(__p, __h->__next_->__allocation_size(),
+                                   __h->__next_->__align_);
+            __h->__next_ = __next;
+            return;
+        }
+    }
+    _LIBCPP_ASSERT(false,
+                   "deallocating a block that was not allocated with this "
+                   "allocator");
+}
+
+class unsynchronized_pool_resource::__fixed_pool
+{
+    struct __chunk_footer
+    {
+        __chunk_footer* __next_;
+        char* __start_;
+        size_t __align_;
+        size_t __allocation_size()
+        {
+            return (reinterpret_cast<char*>(this) - __start_) + sizeof(*this);
+        }
+    };
+
+    struct __vacancy_header
+    {
+        __vacancy_header* __next_vacancy_;
+    };
+
+    __chunk_footer* __first_chunk_;
+    __vacancy_header* __first_vacancy_;
+
+public:
+    static const size_t __default_alignment = alignof(max_align_t);
+
+    explicit __fixed_pool() : __first_chunk_(nullptr), __first_vacancy_(nullptr)
+    {}
+
+    void __release_ptr(memory_resource* __upstream)
+    {
+        __first_vacancy_ = nullptr;
+        while (__first_chunk_ != nullptr)
+        {
+            __chunk_footer* __next = __first_chunk_->__next_;
+            __upstream->deallocate(__first_chunk_->__start_,
+                                   __first_chunk_->__allocation_size(),
+                                   __first_chunk_->__align_);
+            __first_chunk_ = __next;
+        }
+    }
+
+    void* __try_allocate_from_vacancies()
+    {
+        if (__first_vacancy_ != nullptr)
+        {
+            void* __result = __first_vacancy_;
+            __first_vacancy_ = __first_vacancy_->__next_vacancy_;
+            return __result;
+        }
+        return nullptr;
+    }
+
+    void* __allocate_in_new_chunk(memory_resource* __upstream,
+                                  size_t __block_size, size_t __chunk_size)
+    {
+        _LIBCPP_ASSERT(__chunk_size % __block_size == 0, "");
+        static_assert(__default_alignment >= alignof(max_align_t), "");
+        static_assert(__default_alignment >= alignof(__chunk_footer), "");
+        static_assert(__default_alignment >= alignof(__vacancy_header), "");
+
+        const size_t __footer_size = sizeof(__chunk_footer);
+        const size_t __footer_align = alignof(__chunk_footer);
+
+        size_t __aligned_capacity =
+            __roundup(__chunk_size, __footer_align) + __footer_size;
+
+        void* __result =
+            __upstream->allocate(__aligned_capacity, __default_alignment);
+
+        __chunk_footer* __h = reinterpret_cast<__chunk_footer*>(
+            static_cast<char*>(__result) + __aligned_capacity - __footer_size);
+        __h->__next_ = __first_chunk_;
+        __h->__start_ = static_cast<char*>(__result);
+        __h->__align_ = __default_alignment;
+        __first_chunk_ = __h;
+
+        // The first block is returned; thread the rest onto the free list.
+        if (__chunk_size > __block_size)
+        {
+            __vacancy_header* __last_vh = __first_vacancy_;
+            for (size_t __i = __block_size; __i != __chunk_size;
+                 __i += __block_size)
+            {
+                __vacancy_header* __vh = reinterpret_cast<__vacancy_header*>(
+                    static_cast<char*>(__result) + __i);
+                __vh->__next_vacancy_ = __last_vh;
+                __last_vh = __vh;
+            }
+            __first_vacancy_ = __last_vh;
+        }
+        return __result;
+    }
+
+    void __evacuate(void* __p)
+    {
+        __vacancy_header* __vh = static_cast<__vacancy_header*>(__p);
+        __vh->__next_vacancy_ = __first_vacancy_;
+        __first_vacancy_ = __vh;
+    }
+
+    size_t __previous_chunk_size_in_bytes() const
+    {
+        return __first_chunk_ ? __first_chunk_->__allocation_size() : 0;
+    }
+};
+
+size_t unsynchronized_pool_resource::__pool_block_size(int __i) const
+{
+    return size_t(1) << __log2_pool_block_size(__i);
+}
+
+int unsynchronized_pool_resource::__log2_pool_block_size(int __i) const
+{
+    return __i + __log2_smallest_block_size;
+}
+
+int unsynchronized_pool_resource::__pool_index(size_t __bytes,
+                                               size_t __align) const
+{
+    if (__align > alignof(max_align_t) ||
+        __bytes > __pool_block_size(__num_fixed_pools_ - 1))
+        return __num_fixed_pools_;
+    int __i = 0;
+    __bytes = (__bytes > __align) ? __bytes : __align;
+    __bytes -= 1;
+    __bytes >>= __log2_smallest_block_size;
+    while (__bytes != 0)
+    {
+        __bytes >>= 1;
+        __i += 1;
+    }
+    return __i;
+}
+
+unsynchronized_pool_resource::unsynchronized_pool_resource(
+    const pool_options& __opts, memory_resource* __upstream)
+    : __res_(__upstream), __fixed_pools_(nullptr)
+{
+    size_t __largest_block_size;
+    if (__opts.largest_required_pool_block == 0)
+        __largest_block_size = __default_largest_block_size;
+    else if (__opts.largest_required_pool_block < __smallest_block_size)
+        __largest_block_size = __smallest_block_size;
+    else if (__opts.largest_required_pool_block > __max_largest_block_size)
+        __largest_block_size = __max_largest_block_size;
+    else
+        __largest_block_size = __opts.largest_required_pool_block;
+
+    if (__opts.max_blocks_per_chunk == 0)
+        __options_max_blocks_per_chunk_ = __max_blocks_per_chunk;
+    else if (__opts.max_blocks_per_chunk < __min_blocks_per_chunk)
+        __options_max_blocks_per_chunk_ = __min_blocks_per_chunk;
+    else if (__opts.max_blocks_per_chunk > __max_blocks_per_chunk)
+        __options_max_blocks_per_chunk_ = __max_blocks_per_chunk;
+    else
+        __options_max_blocks_per_chunk_ = __opts.max_blocks_per_chunk;
+
+    __num_fixed_pools_ = 1;
+    size_t __capacity = __smallest_block_size;
+    while (__capacity < __largest_block_size)
+    {
+        __capacity <<= 1;
+        __num_fixed_pools_ += 1;
+    }
+}
+
+pool_options unsynchronized_pool_resource::options() const
+{
+    pool_options __p;
+    __p.max_blocks_per_chunk = __options_max_blocks_per_chunk_;
+    __p.largest_required_pool_block = __pool_block_size(__num_fixed_pools_ - 1);
+    return __p;
+}
+
+void unsynchronized_pool_resource::release()
+{
+    __adhoc_pool_.__release_ptr(__res_);
+    if (__fixed_pools_ != nullptr)
+    {
+        const int __n = __num_fixed_pools_;
+        for (int __i = 0; __i < __n; ++__i)
+            __fixed_pools_[__i].__release_ptr(__res_);
+        __res_->deallocate(__fixed_pools_, __n * sizeof(__fixed_pool),
+                           alignof(__fixed_pool));
+        __fixed_pools_ = nullptr;
+    }
+}
+
+void* unsynchronized_pool_resource::do_allocate(size_t __bytes,
+                                                size_t __align)
+{
+    // If the pool selected for a block of size bytes is unable to satisfy the
+    // memory request from its own internal data structures, it will call
+    // upstream_resource()->allocate() to obtain more memory. If bytes is
+    // larger than that which the largest pool can handle, then memory will be
+    // allocated using upstream_resource()->allocate().
+    int __i = __pool_index(__bytes, __align);
+    if (__i == __num_fixed_pools_)
+        return __adhoc_pool_.__do_allocate(__res_, __bytes, __align);
+
+    if (__fixed_pools_ == nullptr)
+    {
+        __fixed_pools_ = static_cast<__fixed_pool*>(__res_->allocate(
+            __num_fixed_pools_ * sizeof(__fixed_pool), alignof(__fixed_pool)));
+        __fixed_pool* __first = __fixed_pools_;
+        __fixed_pool* __last = __fixed_pools_ + __num_fixed_pools_;
+        for (__fixed_pool* __pool = __first; __pool != __last; ++__pool)
+            ::new (static_cast<void*>(__pool)) __fixed_pool;
+    }
+
+    void* __result = __fixed_pools_[__i].__try_allocate_from_vacancies();
+    if (__result != nullptr)
+        return __result;
+
+    // Each new chunk for a pool is a quarter larger than the last one, up to
+    // the configured maximum number of blocks per chunk.
+    const int __log2_block_size = __log2_pool_block_size(__i);
+    size_t __prev_chunk_size_in_blocks =
+        __fixed_pools_[__i].__previous_chunk_size_in_bytes() >>
+        __log2_block_size;
+
+    size_t __chunk_size_in_blocks;
+    if (__prev_chunk_size_in_blocks == 0)
+    {
+        __chunk_size_in_blocks = __min_bytes_per_chunk >> __log2_block_size;
+        if (__chunk_size_in_blocks < __min_blocks_per_chunk)
+            __chunk_size_in_blocks = __min_blocks_per_chunk;
+    }
+    else
+    {
+        static_assert(__max_bytes_per_chunk <=
+                          numeric_limits<size_t>::max() -
+                              (__max_bytes_per_chunk / 4),
+                      "unsigned overflow is possible");
+        __chunk_size_in_blocks =
+            __prev_chunk_size_in_blocks + (__prev_chunk_size_in_blocks / 4);
+    }
+
+    size_t __max_blocks = __max_bytes_per_chunk >> __log2_block_size;
+    if (__max_blocks > __options_max_blocks_per_chunk_)
+        __max_blocks = __options_max_blocks_per_chunk_;
+    if (__chunk_size_in_blocks > __max_blocks)
+        __chunk_size_in_blocks = __max_blocks;
+
+    return __fixed_pools_[__i].__allocate_in_new_chunk(
+        __res_, __pool_block_size(__i),
+        __chunk_size_in_blocks << __log2_block_size);
+}
+
+void unsynchronized_pool_resource::do_deallocate(void* __p, size_t __bytes,
+                                                 size_t __align)
+{
+    // Returns the memory at p to the pool. It is unspecified if, or under
+    // what circumstances, this operation will result in a call to
+    // upstream_resource()->deallocate().
+    int __i = __pool_index(__bytes, __align);
+    if (__i == __num_fixed_pools_)
+        return __adhoc_pool_.__do_deallocate(__res_, __p, __bytes, __align);
+    _LIBCPP_ASSERT(__fixed_pools_ != nullptr,
+                   "deallocating a block that was not allocated with this "
+                   "allocator");
+    __fixed_pools_[__i].__evacuate(__p);
+}
+
+// 23.12.6, mem.res.monotonic.buffer
+
+// Carves __bytes at __align off the top of [__ptr - __space, __ptr), moving
+// __ptr down to the start of the block, or returns nullptr if it won't fit.
+static void* __align_down(size_t __align, size_t __size, void*& __ptr,
+                          size_t& __space)
+{
+    if (__size > __space)
+        return nullptr;
+
+    char* __p1 = static_cast<char*>(__ptr);
+    char* __new_ptr = reinterpret_cast<char*>(
+        reinterpret_cast<uintptr_t>(__p1 - __size) & ~(__align - 1));
+
+    if (__new_ptr < (__p1 - __space))
+        return nullptr;
+
+    __ptr = __new_ptr;
+    __space -= __p1 - __new_ptr;
+
+    return __ptr;
+}
+
+void* monotonic_buffer_resource::__initial_descriptor::
+    __try_allocate_from_chunk(size_t __bytes, size_t __align)
+{
+    if (!__cur_)
+        return nullptr;
+    void* __new_ptr = static_cast<void*>(__cur_);
+    size_t __new_capacity = (__cur_ - __start_);
+    void* __aligned_ptr =
+        __align_down(__align, __bytes, __new_ptr, __new_capacity);
+    if (__aligned_ptr != nullptr)
+        __cur_ = static_cast<char*>(__new_ptr);
+    return __aligned_ptr;
+}
+
+void* monotonic_buffer_resource::__chunk_footer::__try_allocate_from_chunk(
+    size_t __bytes, size_t __align)
+{
+    void* __new_ptr = static_cast<void*>(__cur_);
+    size_t __new_capacity = (__cur_ - __start_);
+    void* __aligned_ptr =
+        __align_down(__align, __bytes, __new_ptr, __new_capacity);
+    if (__aligned_ptr != nullptr)
+        __cur_ = static_cast<char*>(__new_ptr);
+    return __aligned_ptr;
+}
+
+void* monotonic_buffer_resource::do_allocate(size_t __bytes, size_t __align)
+{
+    const size_t __footer_size = sizeof(__chunk_footer);
+    const size_t __footer_align = alignof(__chunk_footer);
+
+    if (void* __result = __initial_.__try_allocate_from_chunk(__bytes, __align))
+        return __result;
+    if (__chunks_ != nullptr)
+    {
+        if (void* __result =
+                __chunks_->__try_allocate_from_chunk(__bytes, __align))
+            return __result;
+    }
+
+    // Allocate a brand-new chunk, at least twice the size of the last one.
+    size_t __previous_capacity;
+    if (__chunks_ != nullptr)
+        __previous_capacity = __chunks_->__allocation_size();
+    else
+    {
+        size_t __size = __initial_.__start_ != nullptr
+            ? static_cast<size_t>(__initial_.__end_ - __initial_.__start_)
+            : __initial_.__size_;
+        __previous_capacity = __roundup(__size, __footer_align) + __footer_size;
+    }
+
+    if (__align < __footer_align)
+        __align = __footer_align;
+
+    size_t __aligned_capacity =
+        __roundup(__bytes, __footer_align) + __footer_size;
+    if (__aligned_capacity <= __previous_capacity)
+    {
+        size_t __new_size = 2 * (__previous_capacity - __footer_size);
+        __aligned_capacity =
+            __roundup(__new_size, __footer_align) + __footer_size;
+    }
+
+    char* __start =
+        static_cast<char*>(__res_->allocate(__aligned_capacity, __align));
+    char* __end = __start + __aligned_capacity - __footer_size;
+    __chunk_footer* __footer = reinterpret_cast<__chunk_footer*>(__end);
+    __footer->__next_ = __chunks_;
+    __footer->__start_ = __start;
+    __footer->__cur_ = __end;
+    __footer->__align_ = __align;
+    __chunks_ = __footer;
+
+    return __chunks_->__try_allocate_from_chunk(__bytes, __align);
+}
+
+} // namespace pmr
+
+_LIBCPP_END_NAMESPACE_STD
@@ -10,6 +10,9 @@
 #ifndef _LIBCPP_HAS_NO_THREADS
 
 #include "shared_mutex"
+#if defined(_LIBCPP_ABI_SCALABLE_SHARED_MUTEX)
+#include "thread"
+#endif
 #if defined(__unix__) && !defined(__ANDROID__) && defined(__ELF__) && defined(_LIBCPP_HAS_COMMENT_LIB_PRAGMA)
 #pragma comment(lib, "pthread")
 #endif
@@ -102,6 +105,122 @@ __shared_mutex_base::unlock_shared()
     }
 }
 
+#if defined(_LIBCPP_ABI_SCALABLE_SHARED_MUTEX)
+
+// Striped Shared Mutex
+
+// A thread holds shared ownership in the stripe of its own id, so it must
+// release it on the thread that acquired it, as the standard requires.
+static __atomic_base<__cxx_contention_t>&
+__reader_stripe(__shared_mutex_striped& __m)
+{
+    static_assert(__shared_mutex_striped::__n_stripes_ == 16,
+                  "the hash below must produce an index into the stripes");
+    uint64_t __h = hash<__thread_id>()(this_thread::get_id());
+    __h *= 0x9E3779B97F4A7C15ULL;
+    return __m.__stripes_[__h >> 60].__readers_;
+}
+
+// A reader bumps its stripe and then checks __writer_; a writer claims
+// __writer_ and then checks every stripe. All four accesses are seq_cst, so
+// either the reader sees the writer and backs out, or the writer sees the
+// reader and waits for it.
+
+static bool
+__try_enter_stripe(__shared_mutex_striped& __m,
+                   __atomic_base<__cxx_contention_t>& __s)
+{
+    __s.fetch_add(1, memory_order_seq_cst);
+    if (__m.__writer_.load(memory_order_seq_cst) == 0)
+        return true;
+    // Back out; a writer may be waiting for this stripe to drain.
+    if (__s.fetch_sub(1, memory_order_seq_cst) == 1)
+        __s.notify_all();
+    return false;
+}
+
+__shared_mutex_striped::__shared_mutex_striped()
+{
+    __writer_.store(0, memory_order_relaxed);
+    for (size_t __i = 0; __i < __n_stripes_; ++__i)
+        __stripes_[__i].__readers_.store(0, memory_order_relaxed);
+}
+
+// Exclusive ownership
+
+void
+__shared_mutex_striped::lock()
+{
+    __cxx_contention_t __expected = 0;
+    while (!__writer_.compare_exchange_weak(__expected, 1,
+                                            memory_order_seq_cst,
+                                            memory_order_relaxed))
+    {
+        if (__expected != 0)
+            __writer_.wait(__expected, memory_order_relaxed);
+        __expected = 0;
+    }
+    for (size_t __i = 0; __i < __n_stripes_; ++__i)
+    {
+        __atomic_base<__cxx_contention_t>& __s = __stripes_[__i].__readers_;
+        __cxx_contention_t __n;
+        while ((__n = __s.load(memory_order_seq_cst)) != 0)
+            __s.wait(__n, memory_order_relaxed);
+    }
+}
+
+bool
+__shared_mutex_striped::try_lock()
+{
+    __cxx_contention_t __expected = 0;
+    if (!__writer_.compare_exchange_strong(__expected, 1,
+                                           memory_order_seq_cst,
+                                           memory_order_relaxed))
+        return false;
+    for (size_t __i = 0; __i < __n_stripes_; ++__i)
+    {
+        if (__stripes_[__i].__readers_.load(memory_order_seq_cst) != 0)
+        {
+            unlock();
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+__shared_mutex_striped::unlock()
+{
+    __writer_.store(0, memory_order_release);
+    __writer_.notify_all();
+}
+
+// Shared ownership
+
+void
+__shared_mutex_striped::lock_shared()
+{
+    __atomic_base<__cxx_contention_t>& __s = __reader_stripe(*this);
+    while (!__try_enter_stripe(*this, __s))
+        __writer_.wait(1, memory_order_relaxed);
+}
+
+bool
+__shared_mutex_striped::try_lock_shared()
+{
+    return __try_enter_stripe(*this, __reader_stripe(*this));
+}
+
+void
+__shared_mutex_striped::unlock_shared()
+{
+    __atomic_base<__cxx_contention_t>& __s = __reader_stripe(*this);
+    if (__s.fetch_sub(1, memory_order_seq_cst) == 1 &&
+        __writer_.load(memory_order_seq_cst) != 0)
+        __s.notify_all();
+}
+
+#endif // _LIBCPP_ABI_SCALABLE_SHARED_MUTEX
 
 // Shared Timed Mutex
 // These routines are here for ABI stability
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// <execution>
+
+// The parallel algorithms give the results of their sequential counterparts
+// with every policy, on ranges that are split into chunks and on ranges that
+// aren't.
+
+#include <execution>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test_macros.h"
+#include "test_iterators.h"
+
+template <class Policy, class Iter>
+void test_elementwise(const Policy& policy, int n) {
+    std::vector<int> v(n);
+    std::iota(v.begin(), v.end(), 0);
+
+    std::for_each(policy, Iter(v.data()), Iter(v.data() + n), [](int& x) { x *= 2; });
+    for (int i = 0; i < n; ++i)
+        assert(v[i] == 2 * i);
+
+    Iter half = std::for_each_n(policy, Iter(v.data()), n / 2, [](int& x) { x = -x; });
+    assert(half == Iter(v.data() + n / 2));
+    for (int i = 0; i < n; ++i)
+        assert(v[i] == (i < n / 2 ? -2 * i : 2 * i));
+
+    std::vector<int> w(n);
+    Iter end = std::transform(policy, Iter(v.data()), Iter(v.data() + n), Iter(w.data()),
+                              [](int x) { return x + 1; });
+    assert(end == Iter(w.data() + n));
+    for (int i = 0; i < n; ++i)
+        assert(w[i] == v[i] + 1);
+
+    end = std::transform(policy, Iter(v.data()), Iter(v.data() + n), Iter(w.data()), Iter(w.data()),
+                         std::minus<int>());
+    assert(end == Iter(w.data() + n));
+    for (int i = 0; i < n; ++i)
+        assert(w[i] == -1);
+
+    std::fill(policy, Iter(w.data()), Iter(w.data() + n), 7);
+    assert(std::count(w.begin(), w.end(), 7) == n);
+}
+
+template <class Policy, class Iter>
+void test_reductions(const Policy& policy, int n) {
+    std::vector<long long> v(n);
+    std::iota(v.begin(), v.end(), 1);
+    long long sum = static_cast<long long>(n) * (n + 1) / 2;
+
+    assert(std::reduce(policy, Iter(v.data()), Iter(v.data() + n)) == sum);
+    assert(std::reduce(policy, Iter(v.data()), Iter(v.data() + n), 5LL) == sum + 5);
+    assert(std::reduce(policy, Iter(v.data()), Iter(v.data() + n), 0LL,
+                       [](long long a, long long b) { return std::max(a, b); }) == n);
+
+    long long squares = std::transform_reduce(v.begin(), v.end(), v.begin(), 0LL);
+    assert(std::transform_reduce(policy, Iter(v.data()), Iter(v.data() + n), Iter(v.data()), 0LL) ==
+           squares);
+    assert(std::transform_reduce(policy, Iter(v.data()), Iter(v.data() + n), Iter(v.data()), 1LL,
+                                 std::plus<>(), std::multiplies<>()) == squares + 1);
+    assert(std::transform_reduce(policy, Iter(v.data()), Iter(v.data() + n), 0LL, std::plus<>(),
+                                 [](long long x) { return x * x; }) == squares);
+
+    // The order of the elements is kept, even though the grouping is not.
+    std::vector<std::string> words(n, "ab");
+    assert(std::reduce(policy, words.begin(), words.end(), std::string("<")) ==
+           std::accumulate(words.begin(), words.end(), std::string("<")));
+}
+
+template <class Policy>
+void test_sorts(const Policy& policy, int n) {
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i)
+        v[i] = (i * 7919) % 1000;
+    std::vector<int> expected = v;
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<int> sorted = v;
+    std::sort(policy, sorted.begin(), sorted.end());
+    assert(sorted == expected);
+    sorted = v;
+    std::sort(policy, sorted.begin(), sorted.end(), std::greater<int>());
+    assert(std::equal(sorted.begin(), sorted.end(), expected.rbegin()));
+
+    std::vector<std::pair<int, int> > pairs(n);
+    for (int i = 0; i < n; ++i)
+        pairs[i] = std::make_pair(v[i] % 10, i);
+    std::stable_sort(policy, pairs.begin(), pairs.end(),
+                     [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                         return a.first < b.first;
+                     });
+    // Equal keys keep their original order, which is that of .second.
+    assert(std::is_sorted(pairs.begin(), pairs.end()));
+    sorted = v;
+    std::stable_sort(policy, sorted.begin(), sorted.end());
+    assert(sorted == expected);
+}
+
+template <class Policy>
+void test(const Policy& policy) {
+    for (int n : {0, 1, 2, 100, 10000, 100003}) {
+        test_elementwise<Policy, int*>(policy, n);
+        test_elementwise<Policy, random_access_iterator<int*> >(policy, n);
+        test_elementwise<Policy, forward_iterator<int*> >(policy, n);
+        if (n == 0)
+            continue;
+        test_reductions<Policy, long long*>(policy, n);
+        test_reductions<Policy, forward_iterator<long long*> >(policy, n);
+        test_sorts(policy, n);
+    }
+}
+
+int main(int, char**) {
+    static_assert(std::is_execution_policy_v<std::execution::sequenced_policy>, "");
+    static_assert(std::is_execution_policy_v<std::execution::parallel_policy>, "");
+    static_assert(std::is_execution_policy_v<std::execution::parallel_unsequenced_policy>, "");
+    static_assert(!std::is_execution_policy_v<int>, "");
+
+    test(std::execution::seq);
+    test(std::execution::par);
+    test(std::execution::par_unseq);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// <execution>
+
+// Parallel algorithms can be called from the element access functions of
+// other parallel algorithms, and from several threads at once.
+
+#include <execution>
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <vector>
+
+#include "test_macros.h"
+
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <thread>
+#endif
+
+long long nested_sum() {
+    std::vector<std::vector<int> > rows(64, std::vector<int>(5000));
+    for (std::vector<int>& row : rows)
+        std::iota(row.begin(), row.end(), 0);
+    std::vector<long long> sums(rows.size());
+    std::transform(std::execution::par, rows.begin(), rows.end(), sums.begin(),
+                   [](std::vector<int>& row) {
+                       std::sort(std::execution::par, row.begin(), row.end(), std::greater<int>());
+                       return std::reduce(std::execution::par, row.begin(), row.end(), 0LL);
+                   });
+    return std::reduce(std::execution::par, sums.begin(), sums.end());
+}
+
+int main(int, char**) {
+    const long long expected = 64LL * (4999LL * 5000 / 2);
+    assert(nested_sum() == expected);
+
+#ifndef _LIBCPP_HAS_NO_THREADS
+    std::vector<long long> results(4);
+    std::vector<std::thread> threads;
+    for (long long& result : results)
+        threads.emplace_back([&result] { result = nested_sum(); });
+    for (std::thread& t : threads)
+        t.join();
+    for (long long result : results)
+        assert(result == expected);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+#include <ext/flat_hash_map>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "test_macros.h"
+#include "count_new.hpp"
+
+void test_default_does_not_allocate() {
+  DisableAllocationGuard g;
+  ((void)g);
+  __gnu_cxx::flat_hash_map<int, int> m;
+  assert(m.bucket_count() == 0);
+  assert(m.find(1) == m.end());
+  m.clear();
+  assert(m.empty());
+}
+
+void test_against_unordered_map() {
+  __gnu_cxx::flat_hash_map<int, std::string> m;
+  std::unordered_map<int, std::string> expected;
+  unsigned state = 1;
+  for (int i = 0; i < 20000; ++i) {
+    state = state * 1103515245 + 12345;
+    int key = (state >> 16) % 1000;
+    switch (state % 3) {
+    case 0:
+      m[key] += 'a';
+      expected[key] += 'a';
+      break;
+    case 1:
+      assert(m.erase(key) == expected.erase(key));
+      break;
+    default:
+      assert(m.insert_or_assign(key, std::to_string(i)).second ==
+             (expected.count(key) == 0));
+      expected[key] = std::to_string(i);
+      break;
+    }
+    assert(m.size() == expected.size());
+  }
+  for (const auto& kv : expected)
+    assert(m.at(kv.first) == kv.second);
+  for (const auto& kv : m)
+    assert(expected.at(kv.first) == kv.second);
+}
+
+void test_members() {
+  __gnu_cxx::flat_hash_map<std::string, int> m = {{"a", 1}, {"b", 2}};
+  assert(m.size() == 2);
+  assert(m.insert(std::make_pair("a", 10)).second == false);
+  assert(m["a"] == 1);
+  assert(m.try_emplace("c", 3).second);
+  assert(!m.try_emplace("c", 4).second);
+  assert(m.at("c") == 3);
+  assert(m.emplace("d", 4).second);
+  assert(m.count("d") == 1);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    m.at("missing");
+    assert(false);
+  } catch (const std::out_of_range&) {
+  }
+#endif
+
+  const __gnu_cxx::flat_hash_map<std::string, int>& cm = m;
+  assert(cm.find("b")->second == 2);
+  assert(cm.equal_range("b").first == cm.find("b"));
+
+  __gnu_cxx::flat_hash_map<std::string, int> copy(m);
+  assert(copy == m);
+  copy["a"] = 100;
+  assert(copy != m);
+}
+
+void test_move_only_values() {
+  __gnu_cxx::flat_hash_map<int, std::unique_ptr<int> > m;
+  for (int i = 0; i < 100; ++i)
+    m.try_emplace(i, new int(i));
+  for (int i = 0; i < 100; ++i)
+    assert(*m[i] == i);
+  __gnu_cxx::flat_hash_map<int, std::unique_ptr<int> > other(std::move(m));
+  assert(other.size() == 100);
+  assert(*other.at(42) == 42);
+}
+
+int main(int, char**) {
+  test_default_does_not_allocate();
+  test_against_unordered_map();
+  test_members();
+  test_move_only_values();
+
+  return 0;
+}
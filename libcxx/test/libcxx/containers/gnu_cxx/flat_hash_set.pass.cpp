@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+#include <ext/flat_hash_set>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+
+#include "test_macros.h"
+#include "count_new.hpp"
+
+// Sends every key to the same probe sequence.
+struct BadHash {
+  std::size_t operator()(int) const { return 42; }
+};
+
+void test_default_does_not_allocate() {
+  DisableAllocationGuard g;
+  ((void)g);
+  __gnu_cxx::flat_hash_set<int> s;
+  assert(s.bucket_count() == 0);
+  assert(s.begin() == s.end());
+  assert(s.find(1) == s.end());
+  s.clear();
+  assert(s.empty());
+  assert(s.erase(1) == 0);
+}
+
+template <class Set>
+void test_against_unordered_set() {
+  Set s;
+  std::unordered_set<int> expected;
+  unsigned state = 1;
+  for (int i = 0; i < 20000; ++i) {
+    state = state * 1103515245 + 12345;
+    int key = (state >> 16) % 1000;
+    if (state & 1) {
+      assert(s.insert(key).second == expected.insert(key).second);
+    } else {
+      assert(s.erase(key) == expected.erase(key));
+    }
+    assert(s.size() == expected.size());
+  }
+  std::size_t n = 0;
+  for (typename Set::const_iterator it = s.begin(); it != s.end(); ++it, ++n)
+    assert(expected.count(*it) == 1);
+  assert(n == expected.size());
+  for (int key = 0; key < 1000; ++key)
+    assert(s.contains(key) == (expected.count(key) == 1));
+  assert(s.load_factor() <= s.max_load_factor());
+}
+
+void test_erase_during_iteration() {
+  __gnu_cxx::flat_hash_set<int> s;
+  for (int i = 0; i < 1000; ++i)
+    s.insert(i);
+  for (__gnu_cxx::flat_hash_set<int>::iterator it = s.begin(); it != s.end();) {
+    if (*it % 3 == 0)
+      it = s.erase(it);
+    else
+      ++it;
+  }
+  assert(s.size() == 666);
+  for (int i = 0; i < 1000; ++i)
+    assert(s.count(i) == (i % 3 != 0));
+}
+
+void test_copy_move_swap() {
+  __gnu_cxx::flat_hash_set<std::string> a = {"one", "two", "three"};
+  __gnu_cxx::flat_hash_set<std::string> b(a);
+  assert(a == b);
+  b.insert("four");
+  assert(a != b);
+
+  __gnu_cxx::flat_hash_set<std::string> c(std::move(b));
+  assert(b.empty());
+  assert(c.size() == 4 && c.count("four") == 1);
+
+  a.swap(c);
+  assert(a.size() == 4 && c.size() == 3);
+  a = c;
+  assert(a == c);
+  c = std::move(a);
+  assert(a.empty() && c.size() == 3);
+
+  assert(c.emplace("two").second == false);
+  assert(c.emplace(3, 'x').second == true);
+  assert(c.count("xxx") == 1);
+}
+
+void test_reserve_and_rehash() {
+  __gnu_cxx::flat_hash_set<int> s;
+  s.reserve(100);
+  std::size_t buckets = s.bucket_count();
+  assert(buckets >= 100);
+  for (int i = 0; i < 100; ++i)
+    s.insert(i);
+  assert(s.bucket_count() == buckets);
+
+  // Churn leaves tombstones behind; the table must not grow without bound.
+  for (int i = 100; i < 100000; ++i) {
+    s.insert(i);
+    s.erase(i - 100);
+  }
+  assert(s.size() == 100);
+  assert(s.bucket_count() <= 4 * buckets);
+
+  s.clear();
+  s.rehash(0);
+  assert(s.bucket_count() == 0);
+}
+
+int main(int, char**) {
+  test_default_does_not_allocate();
+  test_against_unordered_set<__gnu_cxx::flat_hash_set<int> >();
+  test_against_unordered_set<__gnu_cxx::flat_hash_set<int, BadHash> >();
+  test_erase_during_iteration();
+  test_copy_move_swap();
+  test_reserve_and_rehash();
+
+  return 0;
+}
@@ -26,6 +26,9 @@
 #ifndef _LIBCPP_HAS_NO_THREADS
 #include <atomic>
 #endif
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <barrier>
+#endif
 #include <bit>
 #include <bitset>
 #include <cassert>
@@ -81,6 +84,9 @@
 #include <iostream>
 #include <istream>
 #include <iterator>
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <latch>
+#endif
 #include <limits>
 #include <limits.h>
 #include <list>
@@ -89,6 +95,7 @@
 #include <map>
 #include <math.h>
 #include <memory>
+#include <memory_resource>
 #ifndef _LIBCPP_HAS_NO_THREADS
 #include <mutex>
 #endif
@@ -101,6 +108,9 @@
 #include <ratio>
 #include <regex>
 #include <scoped_allocator>
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <semaphore>
+#endif
 #include <set>
 #include <setjmp.h>
 #ifndef _LIBCPP_HAS_NO_THREADS
@@ -166,6 +176,8 @@
 #endif // __cplusplus >= 201103L
 
 // extended headers
+#include <ext/flat_hash_map>
+#include <ext/flat_hash_set>
 #include <ext/hash_map>
 #include <ext/hash_set>
 
@@ -31,6 +31,10 @@ TEST_MACROS();
 #include <atomic>
 TEST_MACROS();
 #endif
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <barrier>
+TEST_MACROS();
+#endif
 #include <bitset>
 TEST_MACROS();
 #include <cassert>
@@ -131,6 +135,10 @@ TEST_MACROS();
 TEST_MACROS();
 #include <iterator>
 TEST_MACROS();
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <latch>
+TEST_MACROS();
+#endif
 #include <limits>
 TEST_MACROS();
 #include <limits.h>
@@ -147,6 +155,8 @@ TEST_MACROS();
 TEST_MACROS();
 #include <memory>
 TEST_MACROS();
+#include <memory_resource>
+TEST_MACROS();
 #ifndef _LIBCPP_HAS_NO_THREADS
 #include <mutex>
 TEST_MACROS();
@@ -169,6 +179,10 @@ TEST_MACROS();
 TEST_MACROS();
 #include <scoped_allocator>
 TEST_MACROS();
+#ifndef _LIBCPP_HAS_NO_THREADS
+#include <semaphore>
+TEST_MACROS();
+#endif
 #include <set>
 TEST_MACROS();
 #include <setjmp.h>
@@ -277,6 +291,10 @@ TEST_MACROS();
 #endif // __cplusplus >= 201103L
 
 // extended headers
+#include <ext/flat_hash_map>
+TEST_MACROS();
+#include <ext/flat_hash_set>
+TEST_MACROS();
 #include <ext/hash_map>
 TEST_MACROS();
 #include <ext/hash_set>
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+
+// <string>
+
+// basic_string operator+(basic_string&& lhs, basic_string&& rhs);
+
+// When only the right operand has room for the result, its buffer is reused
+// instead of growing the left operand.
+
+#include <string>
+#include <utility>
+#include <cassert>
+
+#include "test_macros.h"
+
+int main(int, char**) {
+  {
+    std::string lhs(30, 'a');
+    lhs.shrink_to_fit();
+    std::string rhs(10, 'b');
+    rhs.reserve(100);
+    const char* buffer = rhs.data();
+    std::string r = std::move(lhs) + std::move(rhs);
+    assert(r == std::string(30, 'a') + std::string(10, 'b'));
+    assert(r.data() == buffer);
+  }
+  {
+    std::string lhs(30, 'a');
+    lhs.reserve(100);
+    std::string rhs(10, 'b');
+    rhs.reserve(100);
+    const char* buffer = lhs.data();
+    std::string r = std::move(lhs) + std::move(rhs);
+    assert(r == std::string(30, 'a') + std::string(10, 'b'));
+    assert(r.data() == buffer);
+  }
+  {
+    std::string lhs("abc");
+    std::string rhs(40, 'b');
+    rhs.reserve(100);
+    std::string r = std::move(lhs) + std::move(rhs);
+    assert(r == "abc" + std::string(40, 'b'));
+  }
+
+  return 0;
+}
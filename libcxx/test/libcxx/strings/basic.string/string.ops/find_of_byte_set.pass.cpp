@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <string>
+
+// The find_*_of members of std::string search through a 256-bit table of the
+// characters in the set. Check them against a naive search for sets and
+// strings that contain embedded nulls and characters with the high bit set.
+
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+
+static bool in_set(const std::string& set, char c) {
+  for (std::size_t i = 0; i < set.size(); ++i)
+    if (set[i] == c)
+      return true;
+  return false;
+}
+
+static void check(const std::string& s, const std::string& set) {
+  for (std::size_t pos = 0; pos <= s.size() + 1; ++pos) {
+    std::size_t first_of = std::string::npos;
+    std::size_t first_not_of = std::string::npos;
+    for (std::size_t i = pos; i < s.size(); ++i) {
+      if (first_of == std::string::npos && in_set(set, s[i]))
+        first_of = i;
+      if (first_not_of == std::string::npos && !in_set(set, s[i]))
+        first_not_of = i;
+    }
+    assert(s.find_first_of(set, pos) == first_of);
+    assert(s.find_first_not_of(set, pos) == first_not_of);
+
+    std::size_t last_of = std::string::npos;
+    std::size_t last_not_of = std::string::npos;
+    for (std::size_t i = 0; i < s.size() && i <= pos; ++i) {
+      if (in_set(set, s[i]))
+        last_of = i;
+      else
+        last_not_of = i;
+    }
+    assert(s.find_last_of(set, pos) == last_of);
+    assert(s.find_last_not_of(set, pos) == last_not_of);
+  }
+}
+
+int main(int, char**) {
+  const std::string s("a\0b\x7f\x80\xff z\x80?", 10);
+  const char* const sets[] = {"", "a", "?z", "\x80\xff", "\x7f\x80", " a\xff"};
+  for (std::size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); ++i)
+    check(s, sets[i]);
+  check(s, std::string("\0", 1));
+  check(s, std::string("\0\xff", 2));
+  check(s, s);
+  check(std::string(), "ab");
+
+  std::string all;
+  for (int c = 0; c < 256; ++c)
+    all += static_cast<char>(c);
+  check(all, std::string(all, 0, 64));
+  check(all, std::string(all, 63, 2));
+  check(all, std::string(all, 127, 3));
+  check(all, std::string(all, 250));
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14, c++17
+
+// <functional>
+
+// move_only_function holds targets of up to six pointers that can be moved
+// without throwing in place, and allocates others.
+
+#include <functional>
+#include <cassert>
+#include <string>
+
+#include "test_macros.h"
+#include "count_new.hpp"
+
+struct Pointers
+{
+    void* p[6];
+    int operator()() const { return 1; }
+};
+
+struct TooBig
+{
+    void* p[7];
+    int operator()() const { return 2; }
+};
+
+struct MayThrow
+{
+    MayThrow() {}
+    MayThrow(MayThrow&&) noexcept(false) {}
+    int operator()() const { return 3; }
+};
+
+int main(int, char**)
+{
+    typedef std::move_only_function<int()> F;
+    globalMemCounter.reset();
+    {
+        F f1(Pointers{});
+        F f2([s = std::string("a string"), i = 1] { return i; });
+        F f3(std::move(f1));
+        F f4(std::move(f2));
+        assert(f3() == 1);
+        assert(f4() == 1);
+        assert(globalMemCounter.checkOutstandingNewEq(0));
+    }
+    {
+        F f1(TooBig{});
+        assert(globalMemCounter.checkOutstandingNewEq(1));
+        F f2(MayThrow{});
+        assert(globalMemCounter.checkOutstandingNewEq(2));
+        F f3(std::move(f1));
+        F f4(std::move(f2));
+        assert(globalMemCounter.checkOutstandingNewEq(2));
+        assert(f3() == 2);
+        assert(f4() == 3);
+    }
+    assert(globalMemCounter.checkOutstandingNewEq(0));
+
+  return 0;
+}
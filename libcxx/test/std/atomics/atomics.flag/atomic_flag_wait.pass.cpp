@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: with_system_cxx_lib
+
+// <atomic>
+
+// struct atomic_flag
+
+// bool test(memory_order = memory_order_seq_cst) const;
+// void wait(bool, memory_order = memory_order_seq_cst) const;
+// void notify_one();
+// void notify_all();
+//
+// bool atomic_flag_test(const atomic_flag*);
+// bool atomic_flag_test_explicit(const atomic_flag*, memory_order);
+// void atomic_flag_wait(const atomic_flag*, bool);
+// void atomic_flag_wait_explicit(const atomic_flag*, bool, memory_order);
+// void atomic_flag_notify_one(atomic_flag*);
+// void atomic_flag_notify_all(atomic_flag*);
+//
+// and the volatile overloads.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cassert>
+
+#include "test_macros.h"
+
+int main(int, char**)
+{
+    {
+        std::atomic_flag f = ATOMIC_FLAG_INIT;
+        assert(!f.test());
+        assert(!std::atomic_flag_test(&f));
+        f.test_and_set();
+        assert(f.test(std::memory_order_acquire));
+        assert(std::atomic_flag_test_explicit(&f, std::memory_order_relaxed));
+        volatile std::atomic_flag vf = ATOMIC_FLAG_INIT;
+        assert(!vf.test());
+        assert(!std::atomic_flag_test(&vf));
+        vf.test_and_set();
+        assert(vf.test());
+        assert(std::atomic_flag_test_explicit(&vf, std::memory_order_acquire));
+    }
+    {
+        // The flag is already set: wait returns at once.
+        std::atomic_flag f = ATOMIC_FLAG_INIT;
+        f.test_and_set();
+        f.wait(false);
+        std::atomic_flag_wait(&f, false);
+        std::atomic_flag_wait_explicit(&f, false, std::memory_order_acquire);
+    }
+    {
+        std::atomic_flag f = ATOMIC_FLAG_INIT;
+        std::thread waiter([&] {
+            std::atomic_flag_wait(&f, false);
+            assert(f.test());
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        f.test_and_set();
+        std::atomic_flag_notify_one(&f);
+        waiter.join();
+    }
+    {
+        volatile std::atomic_flag vf = ATOMIC_FLAG_INIT;
+        vf.test_and_set();
+        std::thread waiters[3] = {
+            std::thread([&] { vf.wait(true); }),
+            std::thread([&] { std::atomic_flag_wait(&vf, true); }),
+            std::thread([&] {
+                std::atomic_flag_wait_explicit(&vf, true,
+                                               std::memory_order_acquire);
+            })};
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        vf.clear();
+        std::atomic_flag_notify_all(&vf);
+        for (std::thread& w : waiters)
+            w.join();
+    }
+
+  return 0;
+}
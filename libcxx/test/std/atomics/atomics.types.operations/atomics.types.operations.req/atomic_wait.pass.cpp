@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: with_system_cxx_lib
+
+// <atomic>
+
+// template <class T>
+//     void
+//     atomic_wait(const volatile atomic<T>* obj,
+//                 typename atomic<T>::value_type old);
+//
+// template <class T>
+//     void
+//     atomic_wait(const atomic<T>* obj, typename atomic<T>::value_type old);
+//
+// template <class T>
+//     void
+//     atomic_wait_explicit(const volatile atomic<T>* obj,
+//                          typename atomic<T>::value_type old,
+//                          memory_order m);
+//
+// template <class T>
+//     void
+//     atomic_wait_explicit(const atomic<T>* obj,
+//                          typename atomic<T>::value_type old,
+//                          memory_order m);
+//
+// template <class T> void atomic_notify_one(volatile atomic<T>* obj);
+// template <class T> void atomic_notify_one(atomic<T>* obj);
+// template <class T> void atomic_notify_all(volatile atomic<T>* obj);
+// template <class T> void atomic_notify_all(atomic<T>* obj);
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <cassert>
+
+#include "test_macros.h"
+#include "atomic_helpers.h"
+
+// Long enough for the waiter to stop spinning and block.
+static void pause() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); }
+
+template <class T>
+struct TestFn {
+  void operator()() const {
+    typedef std::atomic<T> A;
+    {
+      // The value already differs: wait returns at once.
+      A t(T(1));
+      t.wait(T(0));
+      std::atomic_wait(&t, T(0));
+      std::atomic_wait_explicit(&t, T(0), std::memory_order_acquire);
+    }
+    {
+      A t(T(1));
+      std::thread waiter([&] {
+        std::atomic_wait(&t, T(1));
+        assert(t.load() == T(2));
+      });
+      pause();
+      t.store(T(2));
+      std::atomic_notify_one(&t);
+      waiter.join();
+    }
+    {
+      volatile A vt(T(1));
+      std::thread waiter([&] {
+        std::atomic_wait_explicit(&vt, T(1), std::memory_order_acquire);
+        assert(vt.load() == T(2));
+      });
+      pause();
+      vt.store(T(2));
+      std::atomic_notify_one(&vt);
+      waiter.join();
+    }
+    {
+      // notify_all wakes every waiter.
+      A t(T(1));
+      volatile A vt(T(1));
+      std::thread waiters[4] = {
+          std::thread([&] { t.wait(T(1)); }),
+          std::thread([&] { t.wait(T(1), std::memory_order_acquire); }),
+          std::thread([&] { std::atomic_wait(&vt, T(1)); }),
+          std::thread([&] { vt.wait(T(1)); })};
+      pause();
+      t.store(T(2));
+      std::atomic_notify_all(&t);
+      vt.store(T(2));
+      vt.notify_all();
+      for (std::thread& w : waiters)
+        w.join();
+    }
+  }
+};
+
+int main(int, char**)
+{
+    TestEachAtomicType<TestFn>()();
+
+    {
+      // A waiter is woken by each change in turn.
+      std::atomic<int> counter(0);
+      std::thread echo([&] {
+        for (int i = 0; i < 100; i += 2) {
+          counter.wait(i);
+          counter.store(i + 2);
+          counter.notify_one();
+        }
+      });
+      for (int i = 1; i < 100; i += 2) {
+        counter.store(i);
+        counter.notify_one();
+        counter.wait(i);
+      }
+      echo.join();
+      assert(counter.load() == 100);
+    }
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++98, c++03, c++11
+// UNSUPPORTED: with_system_cxx_lib
+
+// <barrier>
+
+// template <class CompletionFunction>
+// class barrier;
+
+#include <barrier>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+static_assert(!std::is_copy_constructible<std::barrier<> >::value, "");
+static_assert(!std::is_copy_assignable<std::barrier<> >::value, "");
+static_assert(std::barrier<>::max() > 0, "");
+
+struct Completion {
+  int* phases;
+  void operator()() noexcept { ++*phases; }
+};
+
+int main(int, char**)
+{
+  {
+    // A single thread completes each phase by itself.
+    int phases = 0;
+    std::barrier<Completion> b(1, Completion{&phases});
+    b.arrive_and_wait();
+    b.arrive_and_wait();
+    auto token = b.arrive();
+    b.wait(std::move(token));
+    assert(phases == 3);
+  }
+  {
+    // Each phase completes once every thread has arrived, and runs the
+    // completion before any thread proceeds.
+    const int n = 4;
+    const int rounds = 50;
+    int phases = 0;
+    std::atomic<int> arrivals(0);
+    std::barrier<Completion> b(n, Completion{&phases});
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n; ++i)
+      workers.push_back(std::thread([&] {
+        for (int r = 0; r < rounds; ++r) {
+          arrivals.fetch_add(1);
+          b.arrive_and_wait();
+          assert(phases == 2 * r + 1);
+          assert(arrivals.load() >= (r + 1) * n);
+          b.arrive_and_wait();
+        }
+      }));
+    for (std::thread& w : workers)
+      w.join();
+    assert(phases == 2 * rounds);
+  }
+  {
+    // arrive and wait separately; one arrival can count for several.
+    std::barrier<> b(3);
+    std::thread helper([&] { b.arrive_and_wait(); });
+    auto token = b.arrive(2);
+    b.wait(std::move(token));
+    helper.join();
+  }
+  {
+    // A dropped thread is no longer expected from the next phase on.
+    std::barrier<> b(2);
+    std::thread leaver([&] { b.arrive_and_drop(); });
+    b.arrive_and_wait();
+    leaver.join();
+    b.arrive_and_wait();
+    b.arrive_and_wait();
+  }
+
+  return 0;
+}
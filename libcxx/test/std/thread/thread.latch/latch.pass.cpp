@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++98, c++03, c++11
+// UNSUPPORTED: with_system_cxx_lib
+
+// <latch>
+
+// class latch;
+
+#include <latch>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+static_assert(!std::is_copy_constructible<std::latch>::value, "");
+static_assert(!std::is_copy_assignable<std::latch>::value, "");
+static_assert(std::latch::max() > 0, "");
+static_assert(noexcept(std::latch::max()), "");
+
+int main(int, char**)
+{
+  {
+    std::latch l(0);
+    assert(l.try_wait());
+    l.wait();
+  }
+  {
+    std::latch l(3);
+    assert(!l.try_wait());
+    l.count_down();
+    assert(!l.try_wait());
+    l.count_down(2);
+    assert(l.try_wait());
+    l.wait();
+  }
+  {
+    // The workers all arrive before any of them leaves.
+    const int n = 4;
+    std::latch l(n);
+    std::atomic<int> arrived(0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n; ++i)
+      workers.push_back(std::thread([&] {
+        arrived.fetch_add(1);
+        l.arrive_and_wait();
+        assert(arrived.load() == n);
+      }));
+    for (std::thread& w : workers)
+      w.join();
+    assert(l.try_wait());
+  }
+  {
+    // A waiter blocks until the last count_down.
+    std::latch l(2);
+    bool done = false;
+    std::thread waiter([&] {
+      l.wait();
+      assert(done);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    l.count_down();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    done = true;
+    l.count_down();
+    waiter.join();
+  }
+
+  return 0;
+}
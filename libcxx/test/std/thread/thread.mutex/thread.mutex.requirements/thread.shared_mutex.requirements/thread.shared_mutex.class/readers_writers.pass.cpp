@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+
+// <shared_mutex>
+
+// class shared_mutex;
+
+// Readers and writers on many threads: writers exclude everyone, readers
+// only exclude writers.
+
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+std::shared_mutex m;
+std::atomic<int> readers(0);
+std::atomic<int> writers(0);
+long first = 0;
+long second = 0;
+
+const int Iterations = 2000;
+
+void reader()
+{
+    for (int i = 0; i < Iterations; ++i)
+    {
+        if (i % 2 == 0)
+            m.lock_shared();
+        else
+            while (!m.try_lock_shared())
+                std::this_thread::yield();
+        ++readers;
+        assert(writers == 0);
+        assert(first == second);
+        --readers;
+        m.unlock_shared();
+    }
+}
+
+void writer()
+{
+    for (int i = 0; i < Iterations / 10; ++i)
+    {
+        if (i % 2 == 0)
+            m.lock();
+        else
+            while (!m.try_lock())
+                std::this_thread::yield();
+        assert(++writers == 1);
+        assert(readers == 0);
+        ++first;
+        ++second;
+        --writers;
+        m.unlock();
+    }
+}
+
+int main(int, char**)
+{
+    std::vector<std::thread> v;
+    for (int i = 0; i < 6; ++i)
+        v.push_back(std::thread(reader));
+    for (int i = 0; i < 2; ++i)
+        v.push_back(std::thread(writer));
+    for (auto& t : v)
+        t.join();
+    assert(first == 2 * (Iterations / 10));
+    assert(second == first);
+
+    // Shared ownership taken on one thread does not stop another reader,
+    // but does stop a writer.
+    m.lock_shared();
+    std::thread([] {
+        assert(m.try_lock_shared());
+        m.unlock_shared();
+        assert(!m.try_lock());
+    }).join();
+    m.unlock_shared();
+    assert(m.try_lock());
+    m.unlock();
+
+  return 0;
+}
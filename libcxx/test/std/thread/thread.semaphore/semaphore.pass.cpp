@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// UNSUPPORTED: libcpp-has-no-threads
+// UNSUPPORTED: c++98, c++03, c++11
+// UNSUPPORTED: with_system_cxx_lib
+
+// <semaphore>
+
+// template<ptrdiff_t least_max_value>
+// class counting_semaphore;
+//
+// using binary_semaphore = counting_semaphore<1>;
+
+#include <semaphore>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <cassert>
+
+#include "test_macros.h"
+
+static_assert(std::binary_semaphore::max() >= 1, "");
+static_assert(std::counting_semaphore<>::max() > 1, "");
+static_assert(std::counting_semaphore<5>::max() >= 5, "");
+static_assert(std::counting_semaphore<std::numeric_limits<std::ptrdiff_t>::max()>::max() ==
+                  std::numeric_limits<std::ptrdiff_t>::max(),
+              "");
+static_assert(!std::is_copy_constructible<std::binary_semaphore>::value, "");
+static_assert(!std::is_convertible<std::ptrdiff_t, std::binary_semaphore>::value,
+              "");
+
+template <class Semaphore>
+void test_counting() {
+  Semaphore s(2);
+  assert(s.try_acquire());
+  s.acquire();
+  assert(!s.try_acquire());
+  s.release(2);
+  assert(s.try_acquire());
+  assert(s.try_acquire());
+  assert(!s.try_acquire());
+
+  // Threads keep passing units back and forth.
+  const int n = 4;
+  const int rounds = 1000;
+  std::atomic<int> inside(0);
+  s.release();
+  std::vector<std::thread> workers;
+  for (int i = 0; i < n; ++i)
+    workers.push_back(std::thread([&] {
+      for (int r = 0; r < rounds; ++r) {
+        s.acquire();
+        assert(inside.fetch_add(1) == 0);
+        inside.fetch_sub(1);
+        s.release();
+      }
+    }));
+  for (std::thread& w : workers)
+    w.join();
+  assert(s.try_acquire());
+  assert(!s.try_acquire());
+}
+
+int main(int, char**)
+{
+  test_counting<std::counting_semaphore<> >();
+  test_counting<std::counting_semaphore<std::numeric_limits<std::ptrdiff_t>::max()> >();
+  {
+    // A blocked thread is woken by release.
+    std::binary_semaphore s(0);
+    std::thread waiter([&] { s.acquire(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    s.release();
+    waiter.join();
+  }
+  {
+    // Units released one at a time reach all blocked threads.
+    std::counting_semaphore<> s(0);
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; ++i)
+      waiters.push_back(std::thread([&] { s.acquire(); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    for (int i = 0; i < 3; ++i)
+      s.release();
+    for (std::thread& w : waiters)
+      w.join();
+    assert(!s.try_acquire());
+  }
+  {
+    std::binary_semaphore s(0);
+    auto const start = std::chrono::steady_clock::now();
+    assert(!s.try_acquire_for(std::chrono::milliseconds(10)));
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(10));
+    assert(!s.try_acquire_for(std::chrono::milliseconds(-1)));
+    assert(!s.try_acquire_until(std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds(10)));
+    assert(!s.try_acquire_until(std::chrono::system_clock::now() -
+                                std::chrono::milliseconds(10)));
+    s.release();
+    assert(s.try_acquire_for(std::chrono::milliseconds(10)));
+    s.release();
+    assert(s.try_acquire_until(std::chrono::steady_clock::now()));
+  }
+  {
+    // try_acquire_for succeeds once another thread releases.
+    std::binary_semaphore s(0);
+    std::thread releaser([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      s.release();
+    });
+    assert(s.try_acquire_for(std::chrono::seconds(30)));
+    releaser.join();
+  }
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// <charconv>
+
+// from_chars_result from_chars(const char* first, const char* last,
+//                              Floating& value,
+//                              chars_format fmt = chars_format::general);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(const char* s, T expected, size_t length,
+          std::chars_format fmt = std::chars_format::general)
+{
+    T value = 0;
+    std::from_chars_result r =
+        std::from_chars(s, s + std::strlen(s), value, fmt);
+    assert(r.ec == std::errc{});
+    assert(r.ptr == s + length);
+    assert(std::memcmp(&value, &expected, sizeof(T)) == 0);
+}
+
+template <typename T>
+void test_error(const char* s, std::errc ec, size_t length,
+                std::chars_format fmt = std::chars_format::general)
+{
+    T value = T(42);
+    std::from_chars_result r =
+        std::from_chars(s, s + std::strlen(s), value, fmt);
+    assert(r.ec == ec);
+    assert(r.ptr == s + length);
+    assert(value == T(42));
+}
+
+int main(int, char**)
+{
+    using std::chars_format;
+    using std::errc;
+
+    test("0", 0.0, 1);
+    test("-0", -0.0, 2);
+    test("1", 1.0, 1);
+    test("0.1", 0.1, 3);
+    test(".5", 0.5, 2);
+    test("1.", 1.0, 2);
+    test("-123.456e-2x", -1.23456, 11);
+    test("1e22", 1e22, 4);
+    test("1E+23", 1e23, 5);
+    test("1e", 1.0, 1);
+    test("000000000000000000000000001.5", 1.5, 29);
+    test("2.2250738585072014e-308", 2.2250738585072014e-308, 23);
+    test("4.9406564584124654e-324", 5e-324, 23);
+    test("1.7976931348623157e308", 1.7976931348623157e308, 22);
+    // Halfway between 1 and the next double; the tie goes to even.
+    test("1.00000000000000011102230246251565404236316680908203125", 1.0, 55);
+    test("1.00000000000000011102230246251565404236316680908203126",
+         1.0000000000000002, 55);
+    test("9007199254740993", 9007199254740992.0, 16);
+    test("0.1f", 0.1f, 3);
+    test("3.4028235e38", 3.4028235e38f, 12);
+    test("1e-45", 1e-45f, 5);
+    test("16777217", 16777216.0f, 8);
+
+    test("inf", std::numeric_limits<double>::infinity(), 3);
+    test("-Infinity", -std::numeric_limits<double>::infinity(), 9);
+    test("infinit", std::numeric_limits<double>::infinity(), 3);
+    {
+        double d = 0;
+        const char* s = "nan(a_1)";
+        std::from_chars_result r = std::from_chars(s, s + 8, d);
+        assert(r.ec == errc{} && r.ptr == s + 8 && std::isnan(d));
+        s = "-nan(";
+        r = std::from_chars(s, s + 5, d);
+        assert(r.ec == errc{} && r.ptr == s + 4 && std::isnan(d));
+    }
+
+    test("1e5", 1.0, 1, chars_format::fixed);
+    test("1.5e5", 150000.0, 5, chars_format::scientific);
+    test("1.5e5", 150000.0, 5, chars_format::general);
+    test("1.8p3", 12.0, 5, chars_format::hex);
+    test("-a.8P-1", -5.25, 7, chars_format::hex);
+    test("1p", 1.0, 1, chars_format::hex);
+    test("1.8p3", 1.8, 3, chars_format::general);
+
+    test_error<double>("", errc::invalid_argument, 0);
+    test_error<double>("-", errc::invalid_argument, 0);
+    test_error<double>("+1", errc::invalid_argument, 0);
+    test_error<double>(".", errc::invalid_argument, 0);
+    test_error<double>("e5", errc::invalid_argument, 0);
+    test_error<double>("in", errc::invalid_argument, 0);
+    test_error<double>("15", errc::invalid_argument, 0,
+                       chars_format::scientific);
+    test_error<double>("1e400", errc::result_out_of_range, 5);
+    test_error<double>("-1e400", errc::result_out_of_range, 6);
+    test_error<double>("1e-400", errc::result_out_of_range, 6);
+    test_error<float>("1e39", errc::result_out_of_range, 4);
+    test_error<float>("1e-46", errc::result_out_of_range, 5);
+
+    // Everything to_chars writes reads back as the same value.
+    const chars_format formats[] = {chars_format::scientific,
+                                    chars_format::fixed, chars_format::general,
+                                    chars_format::hex};
+    for (unsigned long long bits = 1; bits < (0x7FFull << 52);
+         bits += 0x0001234567890ABCull)
+    {
+        double d, back = 0;
+        std::memcpy(&d, &bits, sizeof(d));
+        char buf[400];
+        for (chars_format fmt : formats)
+        {
+            std::to_chars_result r =
+                std::to_chars(buf, buf + sizeof(buf), d, fmt);
+            std::from_chars_result f = std::from_chars(buf, r.ptr, back, fmt);
+            assert(f.ec == errc{} && f.ptr == r.ptr && back == d);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03
+// UNSUPPORTED: !libc++ && c++11
+// UNSUPPORTED: !libc++ && c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// <charconv>
+
+// to_chars_result to_chars(char* first, char* last, float value);
+// to_chars_result to_chars(char* first, char* last, double value);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt, int precision);
+
+#include <charconv>
+#include <cassert>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "test_macros.h"
+
+template <typename T>
+void test(T value, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(r.ec == std::errc{});
+    assert(std::string(buf, r.ptr) == expected);
+
+    // Too small a buffer.
+    r = std::to_chars(buf, buf + std::strlen(expected) - 1, value);
+    assert(r.ec == std::errc::value_too_large);
+    assert(r.ptr == buf + std::strlen(expected) - 1);
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value, fmt);
+    assert(r.ec == std::errc{});
+    assert(std::string(buf, r.ptr) == expected);
+}
+
+template <typename T>
+void test(T value, std::chars_format fmt, int precision, const char* expected)
+{
+    char buf[400];
+    std::to_chars_result r =
+        std::to_chars(buf, buf + sizeof(buf), value, fmt, precision);
+    assert(r.ec == std::errc{});
+    assert(std::string(buf, r.ptr) == expected);
+}
+
+// The shortest representation reads back as the same value.
+template <typename T>
+void test_round_trip(T value)
+{
+    char buf[400];
+    std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(r.ec == std::errc{});
+    *r.ptr = '\0';
+    T back = sizeof(T) == sizeof(float) ? std::strtof(buf, nullptr)
+                                        : std::strtod(buf, nullptr);
+    assert(back == value);
+}
+
+int main(int, char**)
+{
+    using std::chars_format;
+
+    test(0.0, "0");
+    test(-0.0, "-0");
+    test(1.0, "1");
+    test(0.1, "0.1");
+    test(0.3, "0.3");
+    test(1.5, "1.5");
+    test(-123.456, "-123.456");
+    test(1e22, "1e+22");
+    test(1e23, "1e+23");
+    test(100000.0, "1e+05");
+    test(123456.0, "123456");
+    test(0.0001, "1e-04");
+    test(0.00123, "0.00123");
+    test(9007199254740993.0, "9007199254740992");
+    test(123456789012345680000.0, "123456789012345683968");
+    test(5e-324, "5e-324");
+    test(DBL_MIN, "2.2250738585072014e-308");
+    test(DBL_MAX, "1.7976931348623157e+308");
+    test(std::numeric_limits<double>::infinity(), "inf");
+    test(-std::numeric_limits<double>::infinity(), "-inf");
+    test(std::numeric_limits<double>::quiet_NaN(), "nan");
+
+    test(0.1f, "0.1");
+    test(1.2f, "1.2");
+    test(16777216.0f, "16777216");
+    test(1e-45f, "1e-45");
+    test(FLT_MIN, "1.1754944e-38");
+    test(FLT_MAX, "3.4028235e+38");
+
+    test(0.0, chars_format::scientific, "0e+00");
+    test(1.0, chars_format::scientific, "1e+00");
+    test(-123.456, chars_format::scientific, "-1.23456e+02");
+    test(1e-300, chars_format::scientific, "1e-300");
+    test(2.5f, chars_format::scientific, "2.5e+00");
+
+    test(1e22, chars_format::fixed, "10000000000000000000000");
+    test(1e23, chars_format::fixed, "99999999999999991611392");
+    test(0.0001, chars_format::fixed, "0.0001");
+    test(-1.5, chars_format::fixed, "-1.5");
+    test(FLT_MAX, chars_format::fixed,
+         "340282346638528859811704183484516925440");
+
+    test(100000.0, chars_format::general, "100000");
+    test(1234567.0, chars_format::general, "1.234567e+06");
+    test(0.0001, chars_format::general, "0.0001");
+    test(0.00001, chars_format::general, "1e-05");
+
+    test(1.0, chars_format::hex, "1p+0");
+    test(-1.5, chars_format::hex, "-1.8p+0");
+    test(0.0, chars_format::hex, "0p+0");
+    test(5e-324, chars_format::hex, "0.0000000000001p-1022");
+    test(1.5f, chars_format::hex, "1.8p+0");
+    test(0.1f, chars_format::hex, "1.99999ap-4");
+
+    test(3.14159, chars_format::fixed, 2, "3.14");
+    test(3.14159, chars_format::scientific, 3, "3.142e+00");
+    test(0.1f, chars_format::general, 12, "0.10000000149");
+    test(1e300, chars_format::general, -1, "1e+300");
+    test(-1.0, chars_format::hex, 3, "-1.000p+0");
+    test(1.5, chars_format::hex, -1, "1.8p+0");
+
+    for (unsigned long long bits = 1; bits < (0x7FFull << 52);
+         bits += 0x0001234567890ABCull)
+    {
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        test_round_trip(d);
+    }
+    for (unsigned bits = 1; bits < (0xFFu << 23); bits += 0x00012345u)
+    {
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        test_round_trip(f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14, c++17
+
+// <functional>
+
+// template<class R, class... ArgTypes>
+// class move_only_function<R(ArgTypes...) cv ref noexcept(noex)>;
+
+// move_only_function& operator=(move_only_function&&);
+// move_only_function& operator=(nullptr_t) noexcept;
+// template<class F> move_only_function& operator=(F&&);
+// void swap(move_only_function&) noexcept;
+// friend void swap(move_only_function&, move_only_function&) noexcept;
+
+#include <functional>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+#include "test_macros.h"
+
+// Counts live instances. Big is allocated, Small held in place, and
+// Throwing allocated because it may throw on move.
+template <int _Size, bool _NothrowMove>
+struct Counted
+{
+    static int count;
+    int id;
+    char pad[_Size];
+
+    explicit Counted(int i) : id(i) { ++count; }
+    Counted(Counted&& c) noexcept(_NothrowMove) : id(c.id) { ++count; }
+    ~Counted() { --count; }
+
+    int operator()() const { return id; }
+};
+
+template <int _Size, bool _NothrowMove>
+int Counted<_Size, _NothrowMove>::count = 0;
+
+typedef Counted<4, true> Small;
+typedef Counted<256, true> Big;
+typedef Counted<4, false> Throwing;
+
+typedef std::move_only_function<int()> F;
+
+template <class _Tp, class _Up>
+int live()
+{
+    return std::is_same_v<_Tp, _Up> ? _Tp::count : _Tp::count + _Up::count;
+}
+
+template <class _Tp, class _Up>
+void test_swap()
+{
+    {
+        F f1(_Tp(1));
+        F f2(_Up(2));
+        assert((live<_Tp, _Up>() == 2));
+        f1.swap(f2);
+        assert(f1() == 2);
+        assert(f2() == 1);
+        swap(f1, f2);
+        assert(f1() == 1);
+        assert(f2() == 2);
+        f1.swap(f1);
+        assert(f1() == 1);
+        F f3;
+        f3.swap(f1);
+        assert(!f1);
+        assert(f3() == 1);
+        assert((live<_Tp, _Up>() == 2));
+    }
+    assert(_Tp::count == 0);
+    assert(_Up::count == 0);
+}
+
+int main(int, char**)
+{
+    static_assert(std::is_nothrow_move_assignable_v<F>);
+    static_assert(!std::is_copy_assignable_v<F>);
+    {
+        F f1(Small(1));
+        F f2(Big(2));
+        f1 = std::move(f2);
+        assert(Small::count == 0);
+        assert(Big::count == 1);
+        assert(f1() == 2);
+        assert(!f2);
+        f1 = std::move(f1);
+        assert(f1() == 2);
+        f1 = nullptr;
+        assert(!f1);
+        assert(Big::count == 0);
+        f1 = Throwing(3);
+        assert(f1() == 3);
+        f1 = [] { return 4; };
+        assert(f1() == 4);
+        assert(Throwing::count == 0);
+    }
+    test_swap<Small, Small>();
+    test_swap<Small, Big>();
+    test_swap<Big, Throwing>();
+    test_swap<Throwing, Small>();
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14, c++17
+
+// <functional>
+
+// template<class R, class... ArgTypes>
+// class move_only_function<R(ArgTypes...) cv ref noexcept(noex)>;
+
+// R operator()(ArgTypes...) cv ref noexcept(noex);
+
+#include <functional>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "test_macros.h"
+
+enum Called { None, Lvalue, ConstLvalue, Rvalue, ConstRvalue };
+
+struct Q
+{
+    Called operator()() & { return Lvalue; }
+    Called operator()() const& { return ConstLvalue; }
+    Called operator()() && { return Rvalue; }
+    Called operator()() const&& { return ConstRvalue; }
+};
+
+struct NonConst
+{
+    int operator()() { return 1; }
+};
+
+struct Noexcept
+{
+    int operator()() noexcept { return 2; }
+};
+
+int add(std::unique_ptr<int> p, int& r) { r += *p; return r; }
+
+int main(int, char**)
+{
+    {
+        // The target is invoked with the qualifications of the call operator,
+        // and as an lvalue when it has no ref-qualifier.
+        std::move_only_function<Called()> f1(Q{});
+        assert(f1() == Lvalue);
+        std::move_only_function<Called() const> f2(Q{});
+        assert(f2() == ConstLvalue);
+        std::move_only_function<Called() &> f3(Q{});
+        assert(f3() == Lvalue);
+        std::move_only_function<Called() const&> f4(Q{});
+        assert(f4() == ConstLvalue);
+        std::move_only_function<Called() &&> f5(Q{});
+        assert(std::move(f5)() == Rvalue);
+        std::move_only_function<Called() const&&> f6(Q{});
+        assert(std::move(f6)() == ConstRvalue);
+        std::move_only_function<Called() const noexcept> f7;
+        static_assert(!std::is_constructible_v<decltype(f7), Q>);
+    }
+    {
+        static_assert(std::is_constructible_v<
+            std::move_only_function<int()>, NonConst>);
+        static_assert(!std::is_constructible_v<
+            std::move_only_function<int() const>, NonConst>);
+        static_assert(!std::is_constructible_v<
+            std::move_only_function<int() noexcept>, NonConst>);
+        std::move_only_function<int() noexcept> f(Noexcept{});
+        static_assert(noexcept(f()));
+        assert(f() == 2);
+        std::move_only_function<long() noexcept> g(Noexcept{});
+        assert(g() == 2);
+        std::move_only_function<void()> h(Noexcept{});
+        static_assert(std::is_same_v<decltype(h()), void>);
+        h();
+    }
+    {
+        // Arguments are forwarded.
+        std::move_only_function<int(std::unique_ptr<int>, int&)> f(add);
+        int r = 1;
+        assert(f(std::unique_ptr<int>(new int(2)), r) == 3);
+        assert(r == 3);
+    }
+    {
+        // A mutable target keeps its state across calls.
+        std::move_only_function<int()> f([n = 0]() mutable { return ++n; });
+        assert(f() == 1);
+        assert(f() == 2);
+        std::move_only_function<int()> g(std::move(f));
+        assert(g() == 3);
+    }
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14, c++17
+
+// <functional>
+
+// template<class R, class... ArgTypes>
+// class move_only_function<R(ArgTypes...) cv ref noexcept(noex)>;
+
+// move_only_function() noexcept;
+// move_only_function(nullptr_t) noexcept;
+// move_only_function(move_only_function&&) noexcept;
+// template<class F> move_only_function(F&&);
+// template<class T, class... Args>
+//   explicit move_only_function(in_place_type_t<T>, Args&&...);
+// template<class T, class U, class... Args>
+//   explicit move_only_function(in_place_type_t<T>, initializer_list<U>, Args&&...);
+
+#include <functional>
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "test_macros.h"
+
+int f(int i) { return i + 1; }
+
+struct A
+{
+    static int count;
+    int data_[16];
+
+    A() { ++count; }
+    A(std::initializer_list<int> il, int a) {
+        ++count;
+        data_[0] = static_cast<int>(il.size()) + a;
+    }
+    A(const A& a) { ++count; data_[0] = a.data_[0]; }
+    ~A() { --count; }
+
+    int operator()(int i) const { return data_[0] + i; }
+};
+
+int A::count = 0;
+
+struct Small
+{
+    int a;
+    int operator()(int i) const { return a + i; }
+};
+
+typedef std::move_only_function<int(int)> F;
+
+int main(int, char**)
+{
+    static_assert(std::is_nothrow_default_constructible_v<F>);
+    static_assert(std::is_nothrow_constructible_v<F, std::nullptr_t>);
+    static_assert(std::is_nothrow_move_constructible_v<F>);
+    static_assert(!std::is_copy_constructible_v<F>);
+    static_assert(!std::is_constructible_v<F, int>);
+    static_assert(!std::is_constructible_v<F, void (*)()>);
+    {
+        F f1;
+        assert(!f1);
+        assert(f1 == nullptr);
+        F f2(nullptr);
+        assert(!f2);
+    }
+    {
+        F f1(f);
+        assert(f1);
+        assert(f1(1) == 2);
+        int (*fp)(int) = nullptr;
+        F f2(fp);
+        assert(!f2);
+        int (Small::*mp)(int) const = nullptr;
+        std::move_only_function<int(Small&, int)> f3(mp);
+        assert(!f3);
+        std::move_only_function<int(const Small&, int)> f4(&Small::operator());
+        assert(f4(Small{3}, 4) == 7);
+    }
+    {
+        F f1(Small{5});
+        assert(f1(1) == 6);
+        F f2(std::move(f1));
+        assert(!f1);
+        assert(f2(2) == 7);
+    }
+    {
+        // A move-only target.
+        std::unique_ptr<int> p(new int(40));
+        F f1([p = std::move(p)](int i) { return *p + i; });
+        F f2(std::move(f1));
+        assert(f2(2) == 42);
+    }
+    assert(A::count == 0);
+    {
+        F f1(std::in_place_type<A>, {1, 2, 3}, 4);
+        assert(A::count == 1);
+        assert(f1(1) == 8);
+        F f2(std::move(f1));
+        assert(A::count == 1);
+        assert(f2(1) == 8);
+        F f3(std::in_place_type<A>);
+        assert(A::count == 2);
+    }
+    assert(A::count == 0);
+    {
+        // Only a target-less move_only_function gives a target-less result.
+        std::move_only_function<int(int) const> f1;
+        F f2(std::move(f1));
+        assert(!f2);
+        std::move_only_function<int(int) const> f3(Small{1});
+        F f4(std::move(f3));
+        assert(f4);
+        assert(f4(1) == 2);
+    }
+
+  return 0;
+}
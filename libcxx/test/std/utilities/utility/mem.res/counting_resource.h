@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TEST_MEM_RES_COUNTING_RESOURCE_H
+#define TEST_MEM_RES_COUNTING_RESOURCE_H
+
+#include <memory_resource>
+#include <cassert>
+#include <cstddef>
+
+// Forwards to new_delete_resource() and records what was asked of it.
+struct counting_resource : std::pmr::memory_resource {
+  int allocations = 0;
+  int deallocations = 0;
+  std::size_t bytes_outstanding = 0;
+  std::size_t last_size = 0;
+  std::size_t last_align = 0;
+
+  ~counting_resource() { assert(bytes_outstanding == 0); }
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    ++allocations;
+    bytes_outstanding += bytes;
+    last_size = bytes;
+    last_align = align;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    ++deallocations;
+    assert(bytes_outstanding >= bytes);
+    bytes_outstanding -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override {
+    return this == &other;
+  }
+};
+
+#endif // TEST_MEM_RES_COUNTING_RESOURCE_H
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// <memory_resource>
+
+// template <class T> class polymorphic_allocator;
+
+#include <memory_resource>
+#include <cassert>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "test_macros.h"
+#include "../counting_resource.h"
+
+// Records the allocator it was constructed with, using either convention.
+struct LeadingAlloc {
+  typedef std::pmr::polymorphic_allocator<char> allocator_type;
+  std::pmr::memory_resource* res;
+  int value;
+  LeadingAlloc(std::allocator_arg_t, const allocator_type& a, int v = 0)
+      : res(a.resource()), value(v) {}
+};
+
+struct TrailingAlloc {
+  typedef std::pmr::polymorphic_allocator<char> allocator_type;
+  std::pmr::memory_resource* res;
+  int value;
+  TrailingAlloc(int v, const allocator_type& a)
+      : res(a.resource()), value(v) {}
+  explicit TrailingAlloc(const allocator_type& a) : res(a.resource()), value(0) {}
+};
+
+struct NoAlloc {
+  int value;
+  NoAlloc(int v = 0) : value(v) {}
+};
+
+int main(int, char**) {
+  typedef std::pmr::polymorphic_allocator<int> A;
+  static_assert(std::is_same<A::value_type, int>::value, "");
+  static_assert(std::is_nothrow_default_constructible<A>::value, "");
+  static_assert(std::is_nothrow_copy_constructible<A>::value, "");
+  static_assert(!std::is_copy_assignable<A>::value, "");
+  static_assert(std::is_convertible<std::pmr::memory_resource*, A>::value, "");
+
+  counting_resource r;
+  {
+    A a(&r);
+    assert(a.resource() == &r);
+    std::pmr::polymorphic_allocator<double> b(a);
+    assert(b.resource() == &r);
+    assert(a == b);
+    assert(!(a != b));
+    assert(A() != a);
+    assert(a.select_on_container_copy_construction().resource() ==
+           std::pmr::get_default_resource());
+
+    int* p = a.allocate(10);
+    assert(r.allocations == 1);
+    assert(r.last_size == 10 * sizeof(int));
+    assert(r.last_align == alignof(int));
+    a.deallocate(p, 10);
+    assert(r.deallocations == 1);
+  }
+  {
+    std::pmr::polymorphic_allocator<char> a(&r);
+    alignas(LeadingAlloc) char buf[sizeof(LeadingAlloc)];
+    LeadingAlloc* l = reinterpret_cast<LeadingAlloc*>(buf);
+    a.construct(l, 5);
+    assert(l->res == &r && l->value == 5);
+    a.destroy(l);
+
+    alignas(TrailingAlloc) char buf2[sizeof(TrailingAlloc)];
+    TrailingAlloc* t = reinterpret_cast<TrailingAlloc*>(buf2);
+    a.construct(t, 7);
+    assert(t->res == &r && t->value == 7);
+    a.destroy(t);
+
+    alignas(NoAlloc) char buf3[sizeof(NoAlloc)];
+    NoAlloc* n = reinterpret_cast<NoAlloc*>(buf3);
+    a.construct(n, 9);
+    assert(n->value == 9);
+    a.destroy(n);
+  }
+  {
+    typedef std::pair<LeadingAlloc, TrailingAlloc> P;
+    std::pmr::polymorphic_allocator<P> a(&r);
+    alignas(P) char buf[sizeof(P)];
+    P* p = reinterpret_cast<P*>(buf);
+
+    a.construct(p, std::piecewise_construct, std::make_tuple(1),
+                std::make_tuple(2));
+    assert(p->first.res == &r && p->first.value == 1);
+    assert(p->second.res == &r && p->second.value == 2);
+    a.destroy(p);
+
+    a.construct(p);
+    assert(p->first.res == &r && p->second.res == &r);
+    a.destroy(p);
+
+    a.construct(p, 3, 4);
+    assert(p->first.value == 3 && p->second.value == 4);
+    a.destroy(p);
+
+    const std::pair<int, int> src(5, 6);
+    a.construct(p, src);
+    assert(p->first.value == 5 && p->second.value == 6);
+    assert(p->first.res == &r && p->second.res == &r);
+    a.destroy(p);
+
+    a.construct(p, std::pair<int, int>(7, 8));
+    assert(p->first.value == 7 && p->second.value == 8);
+    a.destroy(p);
+  }
+  {
+    // Containers propagate the allocator to allocator-aware elements.
+    std::pmr::vector<std::pmr::string> v(&r);
+    v.emplace_back("a string that is much too long for the small buffer");
+    assert(v.get_allocator().resource() == &r);
+    assert(v[0].get_allocator().resource() == &r);
+  }
+  assert(r.bytes_outstanding == 0);
+
+  return 0;
+}
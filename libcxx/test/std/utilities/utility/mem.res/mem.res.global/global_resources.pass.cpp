@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// <memory_resource>
+
+// memory_resource* new_delete_resource() noexcept;
+// memory_resource* null_memory_resource() noexcept;
+// memory_resource* get_default_resource() noexcept;
+// memory_resource* set_default_resource(memory_resource* r) noexcept;
+
+#include <memory_resource>
+#include <new>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+#include "../counting_resource.h"
+
+int main(int, char**) {
+  std::pmr::memory_resource* nd = std::pmr::new_delete_resource();
+  std::pmr::memory_resource* null = std::pmr::null_memory_resource();
+  ASSERT_NOEXCEPT(std::pmr::new_delete_resource());
+  ASSERT_NOEXCEPT(std::pmr::null_memory_resource());
+  ASSERT_NOEXCEPT(std::pmr::get_default_resource());
+  ASSERT_NOEXCEPT(std::pmr::set_default_resource(nullptr));
+
+  assert(nd != nullptr && null != nullptr);
+  assert(nd == std::pmr::new_delete_resource());
+  assert(*nd == *nd);
+  assert(*nd != *null);
+
+  {
+    void* p = nd->allocate(100);
+    assert(reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t) ==
+           0);
+    nd->deallocate(p, 100);
+    p = nd->allocate(64, 256);
+    assert(reinterpret_cast<std::uintptr_t>(p) % 256 == 0);
+    nd->deallocate(p, 64, 256);
+  }
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    (void)null->allocate(1);
+    assert(false);
+  } catch (const std::bad_alloc&) {
+  }
+#endif
+  null->deallocate(nullptr, 0);
+
+  assert(std::pmr::get_default_resource() == nd);
+  {
+    counting_resource r;
+    assert(std::pmr::set_default_resource(&r) == nd);
+    assert(std::pmr::get_default_resource() == &r);
+    std::pmr::polymorphic_allocator<int> a;
+    assert(a.resource() == &r);
+    assert(std::pmr::set_default_resource(nullptr) == &r);
+  }
+  assert(std::pmr::get_default_resource() == nd);
+
+  return 0;
+}
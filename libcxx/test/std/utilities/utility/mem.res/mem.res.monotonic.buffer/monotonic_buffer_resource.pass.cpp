@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// <memory_resource>
+
+// class monotonic_buffer_resource;
+
+#include <memory_resource>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "test_macros.h"
+#include "../counting_resource.h"
+
+static bool is_aligned(void* p, std::size_t align) {
+  return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+}
+
+int main(int, char**) {
+  static_assert(!std::is_copy_constructible<
+                    std::pmr::monotonic_buffer_resource>::value, "");
+  {
+    // Allocations come out of the initial buffer until it is exhausted.
+    counting_resource r;
+    alignas(std::max_align_t) char buffer[256];
+    std::pmr::monotonic_buffer_resource m(buffer, sizeof(buffer), &r);
+    assert(m.upstream_resource() == &r);
+    for (int i = 0; i < 8; ++i) {
+      char* p = static_cast<char*>(m.allocate(16, 8));
+      assert(p >= buffer && p + 16 <= buffer + sizeof(buffer));
+      assert(is_aligned(p, 8));
+    }
+    assert(r.allocations == 0);
+    m.deallocate(buffer, 16, 8);
+
+    void* big = m.allocate(1000);
+    assert(big != nullptr);
+    assert(r.allocations == 1);
+    assert(r.last_size >= 1000);
+
+    // release() returns the chunks and makes the initial buffer usable again.
+    m.release();
+    assert(r.deallocations == 1);
+    assert(r.bytes_outstanding == 0);
+    char* p = static_cast<char*>(m.allocate(200, 1));
+    assert(p >= buffer && p + 200 <= buffer + sizeof(buffer));
+    assert(r.allocations == 1);
+  }
+  {
+    // Without an initial buffer, chunks grow geometrically.
+    counting_resource r;
+    std::pmr::monotonic_buffer_resource m(100, &r);
+    (void)m.allocate(1);
+    assert(r.allocations == 1);
+    assert(r.last_size >= 100);
+    std::size_t previous = r.last_size;
+    for (int i = 0; i < 10000; ++i)
+      (void)m.allocate(8);
+    assert(r.allocations > 1 && r.allocations < 12);
+    assert(r.last_size >= 2 * previous);
+  }
+  {
+    // Alignment is honoured both inside the buffer and for new chunks.
+    counting_resource r;
+    std::pmr::monotonic_buffer_resource m(&r);
+    for (std::size_t align = 1; align <= 4096; align *= 2) {
+      void* p = m.allocate(3, align);
+      assert(is_aligned(p, align));
+    }
+    void* p = m.allocate(0, 64);
+    assert(is_aligned(p, 64));
+  }
+  {
+    // Containers built on top of the arena never go back to upstream for
+    // deallocation until the resource is released.
+    counting_resource r;
+    {
+      std::pmr::monotonic_buffer_resource m(&r);
+      std::pmr::vector<int> v(&m);
+      for (int i = 0; i < 1000; ++i)
+        v.push_back(i);
+      assert(r.deallocations == 0);
+    }
+    assert(r.deallocations == r.allocations);
+  }
+  {
+    std::pmr::monotonic_buffer_resource a, b;
+    assert(a == a);
+    assert(a != b);
+    assert(a.upstream_resource() == std::pmr::get_default_resource());
+  }
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// <memory_resource>
+
+// struct pool_options;
+// class unsynchronized_pool_resource;
+// class synchronized_pool_resource;
+
+#include <memory_resource>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "test_macros.h"
+#include "../counting_resource.h"
+
+static bool is_aligned(void* p, std::size_t align) {
+  return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+}
+
+template <class Pool>
+void test_pool() {
+  counting_resource r;
+  {
+    std::pmr::pool_options opts;
+    opts.max_blocks_per_chunk = 1;
+    opts.largest_required_pool_block = 300;
+    Pool pool(opts, &r);
+    assert(pool.upstream_resource() == &r);
+    std::pmr::pool_options actual = pool.options();
+    assert(actual.max_blocks_per_chunk >= 1);
+    assert(actual.largest_required_pool_block >= 300);
+
+    // Freed blocks are handed out again without going upstream.
+    void* p = pool.allocate(24, 8);
+    int upstream = r.allocations;
+    pool.deallocate(p, 24, 8);
+    void* q = pool.allocate(24, 8);
+    assert(q == p);
+    assert(r.allocations == upstream);
+    pool.deallocate(q, 24, 8);
+
+    // Blocks of every size are distinct, writable and suitably aligned.
+    std::vector<void*> blocks;
+    std::vector<std::size_t> sizes;
+    for (std::size_t size = 1; size <= 2000; size = size * 3 / 2 + 1) {
+      for (int i = 0; i < 40; ++i) {
+        void* b = pool.allocate(size);
+        assert(is_aligned(b, alignof(std::max_align_t)));
+        std::memset(b, static_cast<int>(blocks.size() & 0xFF), size);
+        blocks.push_back(b);
+        sizes.push_back(size);
+      }
+    }
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+      unsigned char* b = static_cast<unsigned char*>(blocks[i]);
+      assert(b[0] == (i & 0xFF) && b[sizes[i] - 1] == (i & 0xFF));
+    }
+    for (std::size_t i = 0; i < blocks.size(); i += 2)
+      pool.deallocate(blocks[i], sizes[i]);
+
+    // Over-aligned and oversized requests go straight upstream.
+    void* a = pool.allocate(16, 1024);
+    assert(is_aligned(a, 1024));
+    void* big = pool.allocate(1 << 20);
+    pool.deallocate(a, 16, 1024);
+    pool.deallocate(big, 1 << 20);
+
+    pool.release();
+    assert(r.bytes_outstanding == 0);
+    void* again = pool.allocate(8);
+    pool.deallocate(again, 8);
+  }
+  assert(r.bytes_outstanding == 0);
+  {
+    Pool a;
+    Pool b(&r);
+    assert(a == a && a != b);
+    assert(a.upstream_resource() == std::pmr::get_default_resource());
+    std::pmr::pool_options defaults = a.options();
+    assert(defaults.max_blocks_per_chunk > 0);
+    assert(defaults.largest_required_pool_block > 0);
+
+    std::pmr::vector<std::pmr::vector<int> > v(&b);
+    for (int i = 0; i < 100; ++i) {
+      v.emplace_back(i, i);
+      assert(v.back().get_allocator().resource() == &b);
+    }
+  }
+  assert(r.bytes_outstanding == 0);
+}
+
+int main(int, char**) {
+  test_pool<std::pmr::unsynchronized_pool_resource>();
+#ifndef _LIBCPP_HAS_NO_THREADS
+  test_pool<std::pmr::synchronized_pool_resource>();
+#endif
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++98, c++03, c++11, c++14
+// UNSUPPORTED: with_system_cxx_lib
+
+// namespace std::pmr { template <...> using container = ...; }
+
+// Each container header declares its std::pmr alias, which uses a
+// polymorphic_allocator of the right value type.
+
+#include <deque>
+#include <forward_list>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <regex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cassert>
+#include <type_traits>
+
+#include "test_macros.h"
+
+namespace pmr = std::pmr;
+template <class T>
+using PA = pmr::polymorphic_allocator<T>;
+
+static_assert(std::is_same<pmr::vector<int>, std::vector<int, PA<int> > >::value,
+              "");
+static_assert(std::is_same<pmr::deque<int>, std::deque<int, PA<int> > >::value,
+              "");
+static_assert(std::is_same<pmr::list<int>, std::list<int, PA<int> > >::value,
+              "");
+static_assert(std::is_same<pmr::forward_list<int>,
+                           std::forward_list<int, PA<int> > >::value,
+              "");
+static_assert(std::is_same<pmr::map<int, long>,
+                           std::map<int, long, std::less<int>,
+                                    PA<std::pair<const int, long> > > >::value,
+              "");
+static_assert(
+    std::is_same<pmr::multimap<int, long>,
+                 std::multimap<int, long, std::less<int>,
+                               PA<std::pair<const int, long> > > >::value,
+    "");
+static_assert(std::is_same<pmr::set<int>,
+                           std::set<int, std::less<int>, PA<int> > >::value,
+              "");
+static_assert(
+    std::is_same<pmr::multiset<int>,
+                 std::multiset<int, std::less<int>, PA<int> > >::value,
+    "");
+static_assert(
+    std::is_same<pmr::unordered_map<int, long>,
+                 std::unordered_map<int, long, std::hash<int>,
+                                    std::equal_to<int>,
+                                    PA<std::pair<const int, long> > > >::value,
+    "");
+static_assert(
+    std::is_same<
+        pmr::unordered_multimap<int, long>,
+        std::unordered_multimap<int, long, std::hash<int>, std::equal_to<int>,
+                                PA<std::pair<const int, long> > > >::value,
+    "");
+static_assert(
+    std::is_same<pmr::unordered_set<int>,
+                 std::unordered_set<int, std::hash<int>, std::equal_to<int>,
+                                    PA<int> > >::value,
+    "");
+static_assert(
+    std::is_same<pmr::unordered_multiset<int>,
+                 std::unordered_multiset<int, std::hash<int>,
+                                         std::equal_to<int>, PA<int> > >::value,
+    "");
+static_assert(
+    std::is_same<pmr::string,
+                 std::basic_string<char, std::char_traits<char>, PA<char> > >::
+        value,
+    "");
+static_assert(std::is_same<pmr::wstring::allocator_type, PA<wchar_t> >::value,
+              "");
+static_assert(std::is_same<pmr::u16string::allocator_type, PA<char16_t> >::value,
+              "");
+static_assert(std::is_same<pmr::u32string::allocator_type, PA<char32_t> >::value,
+              "");
+static_assert(
+    std::is_same<pmr::cmatch,
+                 std::match_results<const char*,
+                                    PA<std::sub_match<const char*> > > >::value,
+    "");
+static_assert(std::is_same<pmr::smatch::allocator_type,
+                           PA<std::sub_match<pmr::string::const_iterator> > >::
+                  value,
+              "");
+static_assert(std::is_same<pmr::wcmatch::allocator_type,
+                           PA<std::sub_match<const wchar_t*> > >::value,
+              "");
+static_assert(std::is_same<pmr::wsmatch::allocator_type,
+                           PA<std::sub_match<pmr::wstring::const_iterator> > >::
+                  value,
+              "");
+
+int main(int, char**) {
+  pmr::monotonic_buffer_resource arena;
+  pmr::map<pmr::string, pmr::vector<int> > m(&arena);
+  m["a key long enough to need a heap buffer"].push_back(1);
+  assert(m.begin()->first.get_allocator().resource() == &arena);
+  assert(m.begin()->second.get_allocator().resource() == &arena);
+
+  pmr::unordered_map<int, pmr::string> u(&arena);
+  u.emplace(1, "another value long enough to need a heap buffer");
+  assert(u.at(1).get_allocator().resource() == &arena);
+
+  pmr::smatch match(&arena);
+  pmr::string s("abc", &arena);
+  assert(std::regex_search(s, match, std::regex("b")));
+  assert(match.position(0) == 1);
+
+  return 0;
+}
@@ -251,8 +251,17 @@ class BumpPointerAllocator {
 
   alignas(long double) char InitialBuffer[AllocSize];
   BlockMeta* BlockList = nullptr;
+  // Blocks of AllocSize that a reset() freed up, kept for reuse so that a
+  // demangler reused across names stops allocating once it is warm.
+  BlockMeta* FreeList = nullptr;
 
   void grow() {
+    if (FreeList) {
+      BlockMeta* Reused = FreeList;
+      FreeList = FreeList->Next;
+      BlockList = new (Reused) BlockMeta{BlockList, 0};
+      return;
+    }
     char* NewMeta = static_cast<char *>(std::malloc(AllocSize));
     if (NewMeta == nullptr)
       std::terminate();
@@ -264,10 +273,20 @@ class BumpPointerAllocator {
     BlockMeta* NewMeta = reinterpret_cast<BlockMeta*>(std::malloc(NBytes));
     if (NewMeta == nullptr)
       std::terminate();
-    BlockList->Next = new (NewMeta) BlockMeta{BlockList->Next, 0};
+    // Massive blocks are marked by a Current that no AllocSize block
+    // reaches, so that reset() frees them instead of keeping them.
+    BlockList->Next = new (NewMeta) BlockMeta{BlockList->Next, NBytes};
     return static_cast<void*>(NewMeta + 1);
   }
 
+  static void freeBlocks(BlockMeta* List) {
+    while (List) {
+      BlockMeta* Tmp = List;
+      List = List->Next;
+      std::free(Tmp);
+    }
+  }
+
 public:
   BumpPointerAllocator()
       : BlockList(new (InitialBuffer) BlockMeta{nullptr, 0}) {}
@@ -288,13 +307,22 @@ public:
     while (BlockList) {
       BlockMeta* Tmp = BlockList;
       BlockList = BlockList->Next;
-      if (reinterpret_cast<char*>(Tmp) != InitialBuffer)
+      if (reinterpret_cast<char*>(Tmp) == InitialBuffer)
+        continue;
+      if (Tmp->Current > UsableAllocSize) {
         std::free(Tmp);
+        continue;
+      }
+      Tmp->Next = FreeList;
+      FreeList = Tmp;
     }
     BlockList = new (InitialBuffer) BlockMeta{nullptr, 0};
   }
 
-  ~BumpPointerAllocator() { reset(); }
+  ~BumpPointerAllocator() {
+    reset();
+    freeBlocks(FreeList);
+  }
 };
 
 class DefaultAllocator {
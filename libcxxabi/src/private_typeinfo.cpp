@@ -34,8 +34,10 @@
 // _LIBCXX_DYNAMIC_FALLBACK is currently off by default.
 
 
+#include <stdint.h>
 #include <string.h>
 
+#include "include/atomic_support.h"
 
 #ifdef _LIBCXX_DYNAMIC_FALLBACK
 #include "abort_message.h"
@@ -533,6 +535,105 @@ bool __pointer_to_member_type_info::can_catch_nested(
 #pragma clang diagnostic pop
 #endif
 
+// The dynamic_cast result cache
+//
+// The outcome of __dynamic_cast depends only on the layout of the complete
+// object, the static_type subobject cast from within it, and dst_type. The
+// vtable pointer of the static_type subobject identifies the first two: it
+// is a (possibly construction) vtable of one layout, and its offset to top
+// places the subobject in it. Several subobjects at the same address share
+// a vtable only if they are of different types, so static_type completes
+// the key. The value is the distance from static_ptr to the result.
+//
+// Each entry is a sequence lock: writers make the count odd while they fill
+// the entry in, and readers only trust what they read if the count was even
+// and unchanged throughout. A writer that finds an entry busy gives up, so
+// no thread ever waits. The fields are stored with release and loaded with
+// acquire ordering, so that a reader that sees a field being rewritten also
+// sees the count that was made odd first.
+
+namespace
+{
+
+const std::ptrdiff_t no_dst_ptr = PTRDIFF_MIN;
+
+struct dynamic_cast_cache_entry
+{
+    uintptr_t sequence;
+    const void* vtable;
+    const __class_type_info* static_type;
+    const __class_type_info* dst_type;
+    std::ptrdiff_t static2dst_offset;
+};
+
+const size_t dynamic_cast_cache_size = 256;
+
+dynamic_cast_cache_entry dynamic_cast_cache[dynamic_cast_cache_size];
+
+dynamic_cast_cache_entry*
+dynamic_cast_cache_entry_for(const void* vtable,
+                             const __class_type_info* dst_type)
+{
+    // Fibonacci hashing: vtables and type_infos are laid out close together.
+    uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(vtable)) ^
+                 static_cast<uint64_t>(reinterpret_cast<uintptr_t>(dst_type));
+    h *= 0x9E3779B97F4A7C15ULL;
+    return &dynamic_cast_cache[h >> 56];
+}
+
+static_assert(dynamic_cast_cache_size == 1 << (64 - 56),
+              "the hash above must produce an index into the cache");
+
+bool
+dynamic_cast_cache_find(const void* vtable,
+                        const __class_type_info* static_type,
+                        const __class_type_info* dst_type,
+                        std::ptrdiff_t* static2dst_offset)
+{
+    using namespace std;
+    dynamic_cast_cache_entry* e =
+        dynamic_cast_cache_entry_for(vtable, dst_type);
+    uintptr_t sequence = __libcpp_atomic_load(&e->sequence, _AO_Acquire);
+    if (sequence & 1)
+        return false;
+    bool found =
+        __libcpp_atomic_load(&e->vtable, _AO_Acquire) == vtable &&
+        __libcpp_atomic_load(&e->static_type, _AO_Acquire) == static_type &&
+        __libcpp_atomic_load(&e->dst_type, _AO_Acquire) == dst_type;
+    std::ptrdiff_t offset =
+        __libcpp_atomic_load(&e->static2dst_offset, _AO_Acquire);
+    if (!found ||
+        __libcpp_atomic_load(&e->sequence, _AO_Relaxed) != sequence)
+        return false;
+    *static2dst_offset = offset;
+    return true;
+}
+
+void
+dynamic_cast_cache_add(const void* vtable,
+                       const __class_type_info* static_type,
+                       const __class_type_info* dst_type,
+                       std::ptrdiff_t static2dst_offset)
+{
+    using namespace std;
+    dynamic_cast_cache_entry* e =
+        dynamic_cast_cache_entry_for(vtable, dst_type);
+    uintptr_t sequence = __libcpp_atomic_load(&e->sequence, _AO_Relaxed);
+    if ((sequence & 1) ||
+        !__libcpp_atomic_compare_exchange(&e->sequence, &sequence,
+                                          sequence + 1, _AO_Acquire,
+                                          _AO_Relaxed))
+        return;
+    __libcpp_atomic_store(&e->vtable, vtable, _AO_Release);
+    __libcpp_atomic_store(&e->static_type, static_type, _AO_Release);
+    __libcpp_atomic_store(&e->dst_type, dst_type, _AO_Release);
+    __libcpp_atomic_store(&e->static2dst_offset, static2dst_offset,
+                          _AO_Release);
+    __libcpp_atomic_store(&e->sequence, sequence + 2, _AO_Release);
+}
+
+}  // unnamed namespace
+
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wmissing-field-initializers"
@@ -612,19 +713,41 @@ bool __pointer_to_member_type_info::can_catch_nested(
 // If there is a public path from (dynamic_ptr, dynamic_type) to
 //    (static_ptr, static_type), then return dynamic_ptr.
 // Else return nullptr.
+//
+// And if moreover src2dst_offset >= 0, the one public path leads to the
+// static_type at that offset from dynamic_ptr, so no search is needed. Other
+// searches are done once per vtable of the static_type subobject and
+// dst_type; the result cache above remembers their outcome.
 
 extern "C" _LIBCXXABI_FUNC_VIS void *
 __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
                const __class_type_info *dst_type,
                std::ptrdiff_t src2dst_offset) {
-    // Possible future optimization:  Take advantage of src2dst_offset
-
     // Get (dynamic_ptr, dynamic_type) from static_ptr
     void **vtable = *static_cast<void ** const *>(static_ptr);
     ptrdiff_t offset_to_derived = reinterpret_cast<ptrdiff_t>(vtable[-2]);
     const void* dynamic_ptr = static_cast<const char*>(static_ptr) + offset_to_derived;
     const __class_type_info* dynamic_type = static_cast<const __class_type_info*>(vtable[-1]);
 
+    // Casts to the dynamic type from a unique public non-virtual base: only
+    //    the static_type subobject at src2dst_offset has a public path to it.
+    if (src2dst_offset >= 0 && is_equal(dynamic_type, dst_type, false))
+    {
+        if (-offset_to_derived == src2dst_offset)
+            return const_cast<void*>(dynamic_ptr);
+        return 0;
+    }
+
+    std::ptrdiff_t static2dst_offset;
+    if (dynamic_cast_cache_find(vtable, static_type, dst_type,
+                                &static2dst_offset))
+    {
+        if (static2dst_offset == no_dst_ptr)
+            return 0;
+        return const_cast<char*>(static_cast<const char*>(static_ptr)) +
+               static2dst_offset;
+    }
+
     // Initialize answer to nullptr.  This will be changed from the search
     //    results if a non-null answer is found.  Regardless, this is what will
     //    be returned.
@@ -700,6 +823,11 @@ __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
             break;
         }
     }
+    dynamic_cast_cache_add(vtable, static_type, dst_type,
+                           dst_ptr == 0
+                               ? no_dst_ptr
+                               : static_cast<const char*>(dst_ptr) -
+                                     static_cast<const char*>(static_ptr));
     return const_cast<void*>(dst_ptr);
 }
 
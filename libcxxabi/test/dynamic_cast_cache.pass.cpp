@@ -0,0 +1,126 @@
+//===---------------------- dynamic_cast_cache.pass.cpp -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// __dynamic_cast remembers the outcome of the casts it has searched for. Each
+// cast below is done repeatedly, so that both the search and the remembered
+// outcome are checked, from subobjects whose types share a vtable, from
+// objects under construction, and on failures.
+
+#include <cassert>
+
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Winaccessible-base"
+#endif
+
+namespace t1
+{
+
+// A and B share the vtable of C at the start of the object; the casts from
+// each must not be confused.
+struct A { virtual ~A() {} int a; };
+struct B : A { int b; };
+struct C : B { int c; };
+struct X { virtual ~X() {} int x; };
+struct D : C, X { int d; };
+
+void test()
+{
+    D d;
+    for (int i = 0; i < 3; ++i)
+    {
+        A* a = &d;
+        B* b = &d;
+        X* x = &d;
+        assert(dynamic_cast<X*>(a) == x);
+        assert(dynamic_cast<X*>(b) == x);
+        assert(dynamic_cast<D*>(x) == &d);
+        assert(dynamic_cast<C*>(x) == &d);
+        assert(dynamic_cast<A*>(x) == a);
+        assert(dynamic_cast<void*>(x) == &d);
+    }
+    C c;
+    for (int i = 0; i < 3; ++i)
+    {
+        A* a = &c;
+        assert(dynamic_cast<X*>(a) == 0);
+        assert(dynamic_cast<D*>(a) == 0);
+        assert(dynamic_cast<C*>(a) == &c);
+    }
+}
+
+}  // t1
+
+namespace t2
+{
+
+// While B is constructed as part of a D, the cast from its virtual base A
+// to C fails; once D is complete it succeeds.
+struct A { virtual ~A() {} int a; };
+struct C : virtual A { int c; };
+struct B : virtual A { B(); int b; };
+struct D : C, B { int d; };
+
+B::B()
+{
+    A* a = this;
+    assert(dynamic_cast<B*>(a) == this);
+    assert(dynamic_cast<C*>(a) == 0);
+    assert(dynamic_cast<D*>(a) == 0);
+}
+
+void test()
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        D d;
+        A* a = &d;
+        assert(dynamic_cast<C*>(a) == static_cast<C*>(&d));
+        assert(dynamic_cast<B*>(a) == static_cast<B*>(&d));
+        assert(dynamic_cast<D*>(a) == &d);
+        B b;
+        a = &b;
+        assert(dynamic_cast<C*>(a) == 0);
+        assert(dynamic_cast<B*>(a) == &b);
+    }
+}
+
+}  // t2
+
+namespace t3
+{
+
+// Only the public A of D leads to it: the cast succeeds from that one and
+// fails from the private one, although both have type A.
+struct A { virtual ~A() {} int a; };
+struct P : private A { int p; A* base() { return this; } };
+struct Q : A { int q; };
+struct D : P, Q { int d; };
+
+void test()
+{
+    D d;
+    for (int i = 0; i < 3; ++i)
+    {
+        A* pub = static_cast<Q*>(&d);
+        A* priv = static_cast<P&>(d).base();
+        assert(pub != priv);
+        assert(dynamic_cast<D*>(pub) == &d);
+        assert(dynamic_cast<D*>(priv) == 0);
+        assert(dynamic_cast<P*>(pub) == static_cast<P*>(&d));
+        assert(dynamic_cast<P*>(priv) == 0);
+    }
+}
+
+}  // t3
+
+int main()
+{
+    t1::test();
+    t2::test();
+    t3::test();
+}
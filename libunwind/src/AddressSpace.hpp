@@ -149,6 +149,13 @@ extern char __exidx_end;
 #define ElfW(type) Elf_##type
 #endif
 
+// Loaders that count the objects they add and remove let the results of
+// dl_iterate_phdr() walks be cached; see FrameHeaderCache.hpp.
+#if defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND) && !defined(_WIN32) &&            \
+    !defined(__ANDROID__)
+#define _LIBUNWIND_USE_FRAME_HEADER_CACHE 1
+#endif
+
 #endif
 
 namespace libunwind {
@@ -178,6 +185,13 @@ struct UnwindInfoSections {
 #endif
 };
 
+} // namespace libunwind
+
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+#include "FrameHeaderCache.hpp"
+#endif
+
+namespace libunwind {
 
 /// LocalAddressSpace is used as a template parameter to UnwindCursor when
 /// unwinding a thread in the same process.  The wrappers compile away,
@@ -229,6 +243,9 @@ public:
   bool findOtherFDE(pint_t targetAddr, pint_t &fde);
 
   static LocalAddressSpace sThisAddressSpace;
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+  static FrameHeaderCache sFrameHeaderCache;
+#endif
 };
 
 inline uintptr_t LocalAddressSpace::getP(pint_t addr) {
@@ -475,17 +492,29 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
     LocalAddressSpace *addressSpace;
     UnwindInfoSections *sects;
     uintptr_t targetAddr;
+    bool checkedCache;
   };
 
-  dl_iterate_cb_data cb_data = {this, &info, targetAddr};
+  dl_iterate_cb_data cb_data = {this, &info, targetAddr, false};
   int found = dl_iterate_phdr(
-      [](struct dl_phdr_info *pinfo, size_t, void *data) -> int {
+      [](struct dl_phdr_info *pinfo, size_t pinfo_size, void *data) -> int {
         auto cbdata = static_cast<dl_iterate_cb_data *>(data);
         bool found_obj = false;
         bool found_hdr = false;
 
         assert(cbdata);
         assert(cbdata->sects);
+        (void)pinfo_size;
+
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+        // The first callback consults the cache; a hit ends the walk.
+        if (!cbdata->checkedCache) {
+          cbdata->checkedCache = true;
+          if (sFrameHeaderCache.find(pinfo, pinfo_size, cbdata->targetAddr,
+                                     cbdata->sects))
+            return true;
+        }
+#endif
 
         if (cbdata->targetAddr < pinfo->dlpi_addr) {
           return false;
@@ -505,7 +534,7 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
   #if !defined(_LIBUNWIND_SUPPORT_DWARF_INDEX)
    #error "_LIBUNWIND_SUPPORT_DWARF_UNWIND requires _LIBUNWIND_SUPPORT_DWARF_INDEX on this platform."
   #endif
-        size_t object_length;
+        size_t object_length = 0;
 #if defined(__ANDROID__)
         Elf_Addr image_base =
             pinfo->dlpi_phnum
@@ -548,6 +577,11 @@ inline bool LocalAddressSpace::findUnwindSections(pint_t targetAddr,
 
         if (found_obj && found_hdr) {
           cbdata->sects->dwarf_section_length = object_length;
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+          sFrameHeaderCache.add(cbdata->sects->dso_base,
+                                cbdata->sects->dso_base + object_length,
+                                *cbdata->sects);
+#endif
           return true;
         } else {
           return false;
@@ -0,0 +1,107 @@
+//===-------------------------- FrameHeaderCache.hpp ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// Cache of the unwind sections that dl_iterate_phdr() lookups found, so that
+// repeated unwinds through the same objects skip walking the program headers
+// of every loaded object.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __FRAMEHEADER_CACHE_HPP__
+#define __FRAMEHEADER_CACHE_HPP__
+
+#include <link.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+namespace libunwind {
+
+/// Remembers the unwind sections of the objects that the most recent lookups
+/// landed in, most recently used first.
+///
+/// The cache is only used from within dl_iterate_phdr() callbacks, so the
+/// dynamic loader's lock serializes all access to it. The loader counts the
+/// objects it has ever added and removed; when either count changes, an
+/// object may have been unloaded and its addresses reused, so the cache is
+/// emptied.
+class _LIBUNWIND_HIDDEN FrameHeaderCache {
+public:
+  /// Checks the cache from the first callback of a dl_iterate_phdr() walk.
+  /// On a hit, fills in info and returns true, and the walk can stop.
+  bool find(const struct dl_phdr_info *pinfo, size_t pinfo_size,
+            uintptr_t targetAddr, UnwindInfoSections *info);
+
+  /// Records the sections of the object covering [low, high). Must be called
+  /// from within the same dl_iterate_phdr() walk as the preceding find().
+  void add(uintptr_t low, uintptr_t high, const UnwindInfoSections &info);
+
+private:
+  struct entry {
+    uintptr_t low;
+    uintptr_t high;
+    UnwindInfoSections info;
+  };
+
+  static const size_t kEntryCount = 8;
+
+  // Zero-initialized: an empty cache that is not yet valid. There is one
+  // instance per process.
+  entry _entries[kEntryCount];
+  size_t _used;
+  unsigned long long _lastAdds;
+  unsigned long long _lastSubs;
+  bool _valid;
+};
+
+inline bool FrameHeaderCache::find(const struct dl_phdr_info *pinfo,
+                                   size_t pinfo_size, uintptr_t targetAddr,
+                                   UnwindInfoSections *info) {
+  // Loaders that predate the counters pass a shorter dl_phdr_info; without
+  // them there is no way to tell that the cache went stale.
+  if (pinfo_size < offsetof(struct dl_phdr_info, dlpi_subs) +
+                       sizeof(pinfo->dlpi_subs)) {
+    _valid = false;
+    return false;
+  }
+  if (!_valid || pinfo->dlpi_adds != _lastAdds ||
+      pinfo->dlpi_subs != _lastSubs) {
+    _used = 0;
+    _lastAdds = pinfo->dlpi_adds;
+    _lastSubs = pinfo->dlpi_subs;
+    _valid = true;
+    return false;
+  }
+  for (size_t i = 0; i < _used; ++i) {
+    if (_entries[i].low <= targetAddr && targetAddr < _entries[i].high) {
+      entry hit = _entries[i];
+      memmove(&_entries[1], &_entries[0], i * sizeof(entry));
+      _entries[0] = hit;
+      *info = hit.info;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void FrameHeaderCache::add(uintptr_t low, uintptr_t high,
+                                  const UnwindInfoSections &info) {
+  if (!_valid)
+    return;
+  // Evict the least recently used entry when full.
+  size_t moved = _used < kEntryCount ? _used++ : kEntryCount - 1;
+  memmove(&_entries[1], &_entries[0], moved * sizeof(entry));
+  _entries[0].low = low;
+  _entries[0].high = high;
+  _entries[0].info = info;
+}
+
+} // namespace libunwind
+
+#endif // __FRAMEHEADER_CACHE_HPP__
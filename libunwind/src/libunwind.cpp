@@ -26,6 +26,11 @@ using namespace libunwind;
 /// internal object to represent this processes address space
 LocalAddressSpace LocalAddressSpace::sThisAddressSpace;
 
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+/// dl_iterate_phdr() results, shared by every local unwind
+FrameHeaderCache LocalAddressSpace::sFrameHeaderCache;
+#endif
+
 _LIBUNWIND_EXPORT unw_addr_space_t unw_local_addr_space =
     (unw_addr_space_t)&LocalAddressSpace::sThisAddressSpace;
 
@@ -0,0 +1,82 @@
+// -*- C++ -*-
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Checks the cache of dl_iterate_phdr() results: lookups hit the object they
+// fall in, the least recently used object is evicted, and loading or
+// unloading an object empties the cache.
+
+#include "../src/config.h"
+#include "../src/AddressSpace.hpp"
+
+#include <assert.h>
+
+#if defined(_LIBUNWIND_USE_FRAME_HEADER_CACHE)
+
+using namespace libunwind;
+
+static UnwindInfoSections sectionsFor(uintptr_t base) {
+  UnwindInfoSections info;
+  memset(&info, 0, sizeof(info));
+  info.dso_base = base;
+  info.dwarf_section = base + 0x10;
+  info.dwarf_section_length = 0x100;
+  return info;
+}
+
+static void addObject(FrameHeaderCache &cache, uintptr_t base) {
+  cache.add(base, base + 0x100, sectionsFor(base));
+}
+
+int main() {
+  static FrameHeaderCache cache;
+  struct dl_phdr_info pinfo;
+  memset(&pinfo, 0, sizeof(pinfo));
+  UnwindInfoSections info;
+
+  // The first walk only records the loader's counts.
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x1050, &info));
+  addObject(cache, 0x1000);
+  assert(cache.find(&pinfo, sizeof(pinfo), 0x1050, &info));
+  assert(info.dso_base == 0x1000 && info.dwarf_section == 0x1010);
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x1100, &info));
+
+  // Fill the cache, touch the oldest object, then overflow it: the object
+  // evicted is the one used longest ago.
+  for (uintptr_t base = 0x2000; base < 0x9000; base += 0x1000)
+    addObject(cache, base);
+  assert(cache.find(&pinfo, sizeof(pinfo), 0x1000, &info));
+  addObject(cache, 0x9000);
+  assert(cache.find(&pinfo, sizeof(pinfo), 0x1000, &info));
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x2000, &info));
+  assert(cache.find(&pinfo, sizeof(pinfo), 0x9000, &info));
+  assert(info.dso_base == 0x9000);
+
+  // A dlopen() or dlclose() since the last walk empties the cache.
+  pinfo.dlpi_adds = 1;
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x9000, &info));
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x9000, &info));
+  addObject(cache, 0x9000);
+  assert(cache.find(&pinfo, sizeof(pinfo), 0x9000, &info));
+  pinfo.dlpi_subs = 1;
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x9000, &info));
+
+  // A loader without the counters disables the cache.
+  addObject(cache, 0x9000);
+  assert(!cache.find(&pinfo, offsetof(struct dl_phdr_info, dlpi_adds),
+                     0x9000, &info));
+  addObject(cache, 0x9000);
+  assert(!cache.find(&pinfo, sizeof(pinfo), 0x9000, &info));
+  return 0;
+}
+
+#else
+
+int main() { return 0; }
+
+#endif
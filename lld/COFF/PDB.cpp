@@ -101,6 +101,10 @@ public:
   /// Link CodeView from each object file in the symbol table into the PDB.
   void addObjectsToPDB();
 
+  /// Compute global type hashes of object files that don't have .debug$H
+  /// sections. This is done in parallel before type records are merged.
+  void computeGlobalTypeHashes();
+
   /// Link info for each import file in the symbol table into the PDB.
   void addImportFilesToPDB(ArrayRef<OutputSection *> outputSections);
 
@@ -184,6 +188,9 @@ private:
   /// far.
   std::map<uint32_t, CVIndexMap> precompTypeIndexMappings;
 
+  /// Global type hashes computed by computeGlobalTypeHashes().
+  DenseMap<const ObjFile *, std::vector<GloballyHashedType>> ghashes;
+
   // For statistics
   uint64_t globalSymbols = 0;
   uint64_t moduleSymbols = 0;
@@ -393,7 +400,10 @@ PDBLinker::mergeDebugT(ObjFile *file, CVIndexMap *objectIndexMap) {
   if (config->debugGHashes) {
     ArrayRef<GloballyHashedType> hashes;
     std::vector<GloballyHashedType> ownedHashes;
-    if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
+    auto it = ghashes.find(file);
+    if (it != ghashes.end())
+      hashes = it->second;
+    else if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
       hashes = getHashesFromDebugH(*debugH);
     else {
       ownedHashes = GloballyHashedType::hashTypes(types);
@@ -1275,6 +1285,27 @@ static PublicSym32 createPublic(Defined *def) {
   return pub;
 }
 
+void PDBLinker::computeGlobalTypeHashes() {
+  // Objects that use precompiled headers are skipped because their type
+  // streams are rewritten before merging. Type server PDBs have their own
+  // path in maybeMergeTypeServerPDB().
+  std::vector<ObjFile *> files;
+  for (ObjFile *file : ObjFile::instances)
+    if (file->debugTypesObj &&
+        (file->debugTypesObj->kind == TpiSource::Regular ||
+         file->debugTypesObj->kind == TpiSource::PCH) &&
+        !getDebugH(file))
+      files.push_back(file);
+
+  std::vector<std::vector<GloballyHashedType>> hashes(files.size());
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    hashes[i] = GloballyHashedType::hashTypes(*files[i]->debugTypes);
+  });
+
+  for (size_t i = 0; i < files.size(); ++i)
+    ghashes[files[i]] = std::move(hashes[i]);
+}
+
 // Add all object files to the PDB. Merge .debug$T sections into IpiData and
 // TpiData.
 void PDBLinker::addObjectsToPDB() {
@@ -1282,6 +1313,11 @@ void PDBLinker::addObjectsToPDB() {
 
   createModuleDBI(builder);
 
+  // Type merging itself is sequential, but computing hashes is not, so do
+  // it for all files up front.
+  if (config->debugGHashes)
+    computeGlobalTypeHashes();
+
   for (ObjFile *file : ObjFile::instances)
     addObjFile(file);
 
@@ -37,6 +37,9 @@
 ///     a density.
 ///   * If not, then combine the clusters.
 /// * Sort non-empty clusters by density
+/// * Place sections containing cold code (.text.unlikely.* sections, functions
+///   outlined by hot/cold splitting and the cold parts of split functions)
+///   after all other sections
 ///
 //===----------------------------------------------------------------------===//
 
@@ -44,6 +47,8 @@
 #include "OutputSections.h"
 #include "SymbolTable.h"
 #include "Symbols.h"
+#include "lld/Common/ErrorHandler.h"
+#include "llvm/ADT/DenseSet.h"
 
 using namespace llvm;
 using namespace lld;
@@ -82,6 +87,7 @@ private:
   std::vector<const InputSectionBase *> sections;
 
   void groupClusters();
+  void printPageFootprint(const DenseMap<const InputSectionBase *, int> &order);
 };
 
 // Maximum ammount the combined cluster density can be worse than the original
@@ -214,16 +220,94 @@ void CallGraphSort::groupClusters() {
   });
 }
 
+// Returns true if a given section contains code that is expected to be
+// rarely executed.
+static bool isCold(const InputSectionBase *sec) {
+  StringRef name = sec->name;
+  if (name == ".text.unlikely" || name.startswith(".text.unlikely."))
+    return true;
+  // The cold parts of functions split by MachineFunctionSplitter.
+  if (name == ".text.split" || name.startswith(".text.split."))
+    return true;
+  // Functions outlined by HotColdSplitting are named <function>.cold.<N>.
+  return name.endswith(".cold") || name.contains(".cold.");
+}
+
+// Returns the number of pages that sections with samples would touch,
+// assuming that each output section starts at a page boundary and that
+// input sections are laid out in the given order: first sections with
+// orders in ascending order, and then the other sections in the order they
+// appear in inputSections.
+static size_t
+countHotPages(const DenseMap<const InputSectionBase *, int> &order,
+              const DenseSet<const InputSectionBase *> &hot) {
+  DenseSet<const OutputSection *> osecs;
+  for (const InputSectionBase *sec : hot)
+    osecs.insert(sec->getOutputSection());
+
+  std::vector<std::pair<int, const InputSectionBase *>> v;
+  for (InputSectionBase *sec : inputSections)
+    if (sec->isLive() && sec->repl == sec &&
+        osecs.count(sec->getOutputSection()))
+      v.push_back({order.lookup(sec), sec});
+  llvm::stable_sort(v, [](const std::pair<int, const InputSectionBase *> &a,
+                          const std::pair<int, const InputSectionBase *> &b) {
+    if (a.first && b.first)
+      return a.first < b.first;
+    return a.first && !b.first;
+  });
+
+  uint64_t pageSize = config->commonPageSize;
+  DenseMap<const OutputSection *, uint64_t> offsets;
+  DenseSet<std::pair<const OutputSection *, uint64_t>> pages;
+  for (std::pair<int, const InputSectionBase *> &p : v) {
+    const InputSectionBase *sec = p.second;
+    uint64_t &off = offsets[sec->getOutputSection()];
+    off = alignTo(off, sec->alignment);
+    uint64_t size = sec->getSize();
+    if (hot.count(sec) && size)
+      for (uint64_t pg = off / pageSize; pg <= (off + size - 1) / pageSize; ++pg)
+        pages.insert({sec->getOutputSection(), pg});
+    off += size;
+  }
+  return pages.size();
+}
+
+// Logs the estimated number of pages (and thus i-TLB entries) needed to
+// hold sections with samples, with and without reordering.
+void CallGraphSort::printPageFootprint(
+    const DenseMap<const InputSectionBase *, int> &order) {
+  if (!errorHandler().verbose)
+    return;
+
+  DenseSet<const InputSectionBase *> hot;
+  for (size_t i = 0; i < sections.size(); ++i)
+    if (!isCold(sections[i]))
+      hot.insert(sections[i]);
+
+  log("call graph sort: hot sections span " +
+      Twine(countHotPages({}, hot)) + " pages before reordering and " +
+      Twine(countHotPages(order, hot)) + " pages after reordering");
+}
+
 DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
   groupClusters();
 
-  // Generate order.
+  // Generate order. Cold sections go after all the others, so that hot
+  // code is packed into as few pages as possible.
   DenseMap<const InputSectionBase *, int> orderMap;
   ssize_t curOrder = 1;
 
   for (const Cluster &c : clusters)
     for (int secIndex : c.sections)
-      orderMap[sections[secIndex]] = curOrder++;
+      if (!isCold(sections[secIndex]))
+        orderMap[sections[secIndex]] = curOrder++;
+  for (const Cluster &c : clusters)
+    for (int secIndex : c.sections)
+      if (isCold(sections[secIndex]))
+        orderMap[sections[secIndex]] = curOrder++;
+
+  printPageFootprint(orderMap);
 
   if (!config->printSymbolOrder.empty()) {
     std::error_code ec;
@@ -235,15 +319,17 @@ DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
 
     // Print the symbols ordered by C3, in the order of increasing curOrder
     // Instead of sorting all the orderMap, just repeat the loops above.
-    for (const Cluster &c : clusters)
-      for (int secIndex : c.sections)
-        // Search all the symbols in the file of the section
-        // and find out a Defined symbol with name that is within the section.
-        for (Symbol *sym: sections[secIndex]->file->getSymbols())
-          if (!sym->isSection()) // Filter out section-type symbols here.
-            if (auto *d = dyn_cast<Defined>(sym))
-              if (sections[secIndex] == d->section)
-                os << sym->getName() << "\n";
+    for (bool cold : {false, true})
+      for (const Cluster &c : clusters)
+        for (int secIndex : c.sections)
+          if (isCold(sections[secIndex]) == cold)
+            // Search all the symbols in the file of the section and find out
+            // a Defined symbol with name that is within the section.
+            for (Symbol *sym : sections[secIndex]->file->getSymbols())
+              if (!sym->isSection()) // Filter out section-type symbols here.
+                if (auto *d = dyn_cast<Defined>(sym))
+                  if (sections[secIndex] == d->section)
+                    os << sym->getName() << "\n";
   }
 
   return orderMap;
@@ -91,6 +91,7 @@ struct Configuration {
   llvm::StringRef emulation;
   llvm::StringRef fini;
   llvm::StringRef init;
+  llvm::StringRef layoutFile;
   llvm::StringRef ltoAAPipeline;
   llvm::StringRef ltoCSProfileFile;
   llvm::StringRef ltoNewPmPasses;
@@ -107,6 +108,7 @@ struct Configuration {
   llvm::StringRef sysroot;
   llvm::StringRef thinLTOCacheDir;
   llvm::StringRef thinLTOIndexOnlyArg;
+  llvm::StringRef timeTraceFile;
   std::pair<llvm::StringRef, llvm::StringRef> thinLTOObjectSuffixReplace;
   std::pair<llvm::StringRef, llvm::StringRef> thinLTOPrefixReplace;
   std::string rpath;
@@ -159,6 +161,7 @@ struct Configuration {
   bool ltoCSProfileGenerate;
   bool ltoDebugPassManager;
   bool ltoNewPassManager;
+  bool ltoOptimizePartitions;
   bool mergeArmExidx;
   bool mipsN32Abi = false;
   bool nmagic;
@@ -170,19 +173,24 @@ struct Configuration {
   bool pacPlt;
   bool picThunk;
   bool pie;
+  bool prefetchInputs;
   bool printGcSections;
+  bool printMemoryUsage;
   bool printIcfSections;
   bool relocatable;
+  bool releaseInputMemory;
   bool relrPackDynRelocs;
   bool saveTemps;
   bool singleRoRx;
   bool shared;
+  bool streamingOutput;
   bool isStatic = false;
   bool sysvHash = false;
   bool target1Rel;
   bool trace;
   bool thinLTOEmitImportsFiles;
   bool thinLTOIndexOnly;
+  bool timeTraceEnabled;
   bool tocOptimize;
   bool undefinedVersion;
   bool useAndroidRelrTags = false;
@@ -232,6 +240,7 @@ struct Configuration {
   unsigned ltoo;
   unsigned optimize;
   unsigned thinLTOJobs;
+  unsigned timeTraceGranularity;
   int32_t splitStackAdjustSize;
 
   // The following config options do not directly correspond to any
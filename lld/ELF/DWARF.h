@@ -60,6 +60,12 @@ public:
     return gnuPubtypesSection;
   }
 
+  // .debug_aranges is not read by DWARFContext, but --gdb-index reads it
+  // directly, and it needs to use relocations to do that.
+  const LLDDWARFSection &getArangesLLDSection() const {
+    return arangesSection;
+  }
+
   StringRef getFileName() const override { return ""; }
   StringRef getAbbrevSection() const override { return abbrevSection; }
   StringRef getStrSection() const override { return strSection; }
@@ -78,6 +84,7 @@ private:
                                                uint64_t pos,
                                                ArrayRef<RelTy> rels) const;
 
+  LLDDWARFSection arangesSection;
   LLDDWARFSection gnuPubnamesSection;
   LLDDWARFSection gnuPubtypesSection;
   LLDDWARFSection infoSection;
@@ -48,6 +48,8 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/GlobPattern.h"
@@ -55,6 +57,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <utility>
@@ -73,6 +76,7 @@ LinkerDriver *elf::driver;
 
 static void setConfigs(opt::InputArgList &args);
 static void readConfigs(opt::InputArgList &args);
+static void writeTimeTrace();
 
 bool elf::link(ArrayRef<const char *> args, bool canExitEarly,
                raw_ostream &error) {
@@ -179,8 +183,10 @@ std::vector<std::pair<MemoryBufferRef, uint64_t>> static getArchiveMembers(
           toString(std::move(err)));
 
   // Take ownership of memory buffers created for members of thin archives.
-  for (std::unique_ptr<MemoryBuffer> &mb : file->takeThinBuffers())
+  for (std::unique_ptr<MemoryBuffer> &mb : file->takeThinBuffers()) {
+    inputBuffers.push_back(mb.get());
     make<std::unique_ptr<MemoryBuffer>>(std::move(mb));
+  }
 
   return v;
 }
@@ -450,38 +456,63 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
   if (args.hasArg(OPT_version))
     return;
 
-  initLLVM();
-  createFiles(args);
-  if (errorCount())
-    return;
+  if (config->timeTraceEnabled)
+    timeTraceProfilerInitialize(config->timeTraceGranularity, config->progName);
 
-  inferMachineType();
-  setConfigs(args);
-  checkOptions();
-  if (errorCount())
-    return;
+  {
+    llvm::TimeTraceScope timeScope("ExecuteLinker");
 
-  // The Target instance handles target-specific stuff, such as applying
-  // relocations or writing a PLT section. It also contains target-dependent
-  // values such as a default image base address.
-  target = getTarget();
+    initLLVM();
+    createFiles(args);
+    if (errorCount())
+      return;
 
-  switch (config->ekind) {
-  case ELF32LEKind:
-    link<ELF32LE>(args);
-    return;
-  case ELF32BEKind:
-    link<ELF32BE>(args);
-    return;
-  case ELF64LEKind:
-    link<ELF64LE>(args);
-    return;
-  case ELF64BEKind:
-    link<ELF64BE>(args);
-    return;
-  default:
-    llvm_unreachable("unknown Config->EKind");
+    inferMachineType();
+    setConfigs(args);
+    checkOptions();
+    if (errorCount())
+      return;
+
+    // The Target instance handles target-specific stuff, such as applying
+    // relocations or writing a PLT section. It also contains target-dependent
+    // values such as a default image base address.
+    target = getTarget();
+
+    switch (config->ekind) {
+    case ELF32LEKind:
+      link<ELF32LE>(args);
+      break;
+    case ELF32BEKind:
+      link<ELF32BE>(args);
+      break;
+    case ELF64LEKind:
+      link<ELF64LE>(args);
+      break;
+    case ELF64BEKind:
+      link<ELF64BE>(args);
+      break;
+    default:
+      llvm_unreachable("unknown Config->EKind");
+    }
   }
+
+  if (config->timeTraceEnabled)
+    writeTimeTrace();
+}
+
+// For --time-trace. Writes the trace to --time-trace-file, or next to the
+// output file.
+static void writeTimeTrace() {
+  std::string path = config->timeTraceFile.empty()
+                         ? (config->outputFile + ".time-trace").str()
+                         : config->timeTraceFile.str();
+  std::error_code ec;
+  raw_fd_ostream os(path, ec, sys::fs::OF_Text);
+  if (ec)
+    error("cannot open " + path + ": " + ec.message());
+  else
+    timeTraceProfilerWrite(os);
+  timeTraceProfilerCleanup();
 }
 
 static std::string getRpath(opt::InputArgList &args) {
@@ -719,6 +750,54 @@ static void readCallGraph(MemoryBufferRef mb) {
   }
 }
 
+// Adds edges from a function to the functions it calls, as recorded in a
+// sample profile. Call targets in bodies of inlined functions are calls
+// from the function that the bodies were inlined into.
+static void addSampleProfileEdges(
+    const sampleprof::FunctionSamples &fs, InputSectionBase *from,
+    function_ref<InputSectionBase *(StringRef)> findSection) {
+  for (const auto &body : fs.getBodySamples())
+    for (const StringMapEntry<uint64_t> &target :
+         body.second.getCallTargets())
+      if (InputSectionBase *to = findSection(target.getKey()))
+        config->callGraphProfile[std::make_pair(from, to)] +=
+            target.getValue();
+
+  for (const auto &callsite : fs.getCallsiteSamples())
+    for (const auto &inlinee : callsite.second)
+      addSampleProfileEdges(inlinee.second, from, findSection);
+}
+
+static void readCallGraphFromSampleProfile(StringRef path) {
+  LLVMContext ctx;
+  ErrorOr<std::unique_ptr<sampleprof::SampleProfileReader>> readerOrErr =
+      sampleprof::SampleProfileReader::create(path, ctx);
+  if (std::error_code ec = readerOrErr.getError()) {
+    error("cannot open " + path + ": " + ec.message());
+    return;
+  }
+  sampleprof::SampleProfileReader &reader = **readerOrErr;
+  if (std::error_code ec = reader.read()) {
+    error(path + ": " + ec.message());
+    return;
+  }
+
+  // Build a map from symbol name to section. Unlike call graph ordering
+  // files, sample profiles usually mention many functions that are not in
+  // the output, so we don't warn about missing symbols.
+  DenseMap<StringRef, InputSectionBase *> map;
+  for (InputFile *file : objectFiles)
+    for (Symbol *sym : file->getSymbols())
+      if (auto *d = dyn_cast<Defined>(sym))
+        if (auto *sec = dyn_cast_or_null<InputSectionBase>(d->section))
+          map[sym->getName()] = sec;
+
+  auto findSection = [&](StringRef name) { return map.lookup(name); };
+  for (StringMapEntry<sampleprof::FunctionSamples> &ent : reader.getProfiles())
+    if (InputSectionBase *from = findSection(ent.getKey()))
+      addSampleProfileEdges(ent.getValue(), from, findSection);
+}
+
 template <class ELFT> static void readCallGraphsFromObjectFiles() {
   for (auto file : objectFiles) {
     auto *obj = cast<ObjFile<ELFT>>(file);
@@ -841,6 +920,7 @@ static void readConfigs(opt::InputArgList &args) {
   config->ignoreFunctionAddressEquality =
       args.hasArg(OPT_ignore_function_address_equality);
   config->init = args.getLastArgValue(OPT_init, "_init");
+  config->layoutFile = args.getLastArgValue(OPT_layout_file);
   config->ltoAAPipeline = args.getLastArgValue(OPT_lto_aa_pipeline);
   config->ltoCSProfileGenerate = args.hasArg(OPT_lto_cs_profile_generate);
   config->ltoCSProfileFile = args.getLastArgValue(OPT_lto_cs_profile_file);
@@ -849,6 +929,7 @@ static void readConfigs(opt::InputArgList &args) {
   config->ltoNewPmPasses = args.getLastArgValue(OPT_lto_newpm_passes);
   config->ltoo = args::getInteger(args, OPT_lto_O, 2);
   config->ltoObjPath = args.getLastArgValue(OPT_plugin_opt_obj_path_eq);
+  config->ltoOptimizePartitions = args.hasArg(OPT_lto_optimize_partitions);
   config->ltoPartitions = args::getInteger(args, OPT_lto_partitions, 1);
   config->ltoSampleProfile = args.getLastArgValue(OPT_lto_sample_profile);
   config->mapFile = args.getLastArgValue(OPT_Map);
@@ -869,14 +950,19 @@ static void readConfigs(opt::InputArgList &args) {
   config->outputFile = args.getLastArgValue(OPT_o);
   config->pacPlt = args.hasArg(OPT_pac_plt);
   config->pie = args.hasFlag(OPT_pie, OPT_no_pie, false);
+  config->prefetchInputs =
+      args.hasFlag(OPT_prefetch_inputs, OPT_no_prefetch_inputs, false);
   config->printIcfSections =
       args.hasFlag(OPT_print_icf_sections, OPT_no_print_icf_sections, false);
   config->printGcSections =
       args.hasFlag(OPT_print_gc_sections, OPT_no_print_gc_sections, false);
+  config->printMemoryUsage = args.hasArg(OPT_print_memory_usage);
   config->printSymbolOrder =
       args.getLastArgValue(OPT_print_symbol_order);
   config->rpath = getRpath(args);
   config->relocatable = args.hasArg(OPT_relocatable);
+  config->releaseInputMemory = args.hasFlag(
+      OPT_release_input_memory, OPT_no_release_input_memory, false);
   config->saveTemps = args.hasArg(OPT_save_temps);
   config->searchPaths = args::getStrings(args, OPT_library_path);
   config->sectionStartMap = getSectionStartMap(args);
@@ -885,6 +971,8 @@ static void readConfigs(opt::InputArgList &args) {
   config->soName = args.getLastArgValue(OPT_soname);
   config->sortSection = getSortSection(args);
   config->splitStackAdjustSize = args::getInteger(args, OPT_split_stack_adjust_size, 16384);
+  config->streamingOutput =
+      args.hasFlag(OPT_streaming_output, OPT_no_streaming_output, false);
   config->strip = getStrip(args);
   config->sysroot = args.getLastArgValue(OPT_sysroot);
   config->target1Rel = args.hasFlag(OPT_target1_rel, OPT_target1_abs, false);
@@ -904,6 +992,10 @@ static void readConfigs(opt::InputArgList &args) {
       getOldNewOptions(args, OPT_plugin_opt_thinlto_object_suffix_replace_eq);
   config->thinLTOPrefixReplace =
       getOldNewOptions(args, OPT_plugin_opt_thinlto_prefix_replace_eq);
+  config->timeTraceEnabled = args.hasArg(OPT_time_trace);
+  config->timeTraceFile = args.getLastArgValue(OPT_time_trace_file);
+  config->timeTraceGranularity =
+      args::getInteger(args, OPT_time_trace_granularity, 500);
   config->trace = args.hasArg(OPT_trace);
   config->undefined = args::getStrings(args, OPT_undefined);
   config->undefinedVersion =
@@ -1003,6 +1095,9 @@ static void readConfigs(opt::InputArgList &args) {
     if (args.hasArg(OPT_call_graph_ordering_file))
       error("--symbol-ordering-file and --call-graph-order-file "
             "may not be used together");
+    if (args.hasArg(OPT_call_graph_sample_profile))
+      error("--symbol-ordering-file and --call-graph-sample-profile "
+            "may not be used together");
     if (Optional<MemoryBufferRef> buffer = readFile(arg->getValue())){
       config->symbolOrderingFile = getSymbolOrderingFile(*buffer);
       // Also need to disable CallGraphProfileSort to prevent
@@ -1714,8 +1809,17 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // symbols that we need to the symbol table. This process might
   // add files to the link, via autolinking, these files are always
   // appended to the Files vector.
-  for (size_t i = 0; i < files.size(); ++i)
-    parseFile(files[i]);
+  //
+  // Symbol names are hashed in parallel beforehand. Symbols are still
+  // inserted to the symbol table in command line order, so the result is
+  // the same as if we did everything serially.
+  {
+    llvm::TimeTraceScope timeScope("Parse input files");
+    parallelForEach(files, prehashSymbolNames);
+    for (size_t i = 0; i < files.size(); ++i)
+      parseFile(files[i]);
+  }
+  printMemoryUsage("reading input files");
 
   // Now that we have every file, we can decide if we will need a
   // dynamic symbol table.
@@ -1807,9 +1911,14 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   //
   // With this the symbol table should be complete. After this, no new names
   // except a few linker-synthesized ones will be added to the symbol table.
-  compileBitcodeFiles<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("LTO");
+    compileBitcodeFiles<ELFT>();
+  }
   if (errorCount())
     return;
+  if (!bitcodeFiles.empty())
+    printMemoryUsage("LTO");
 
   // If -thinlto-index-only is given, we should create only "index
   // files" and not object files. Index file creation is already done
@@ -1897,23 +2006,30 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
 
   // Do size optimizations: garbage collection, merging of SHF_MERGE sections
   // and identical code folding.
-  splitSections<ELFT>();
-  markLive<ELFT>();
-  demoteSharedSymbols();
-  mergeSections();
-  if (config->icf != ICFLevel::None) {
-    findKeepUniqueSections<ELFT>(args);
-    doIcf<ELFT>();
+  {
+    llvm::TimeTraceScope timeScope("Section optimizations");
+    splitSections<ELFT>();
+    markLive<ELFT>();
+    demoteSharedSymbols();
+    mergeSections();
+    if (config->icf != ICFLevel::None) {
+      findKeepUniqueSections<ELFT>(args);
+      doIcf<ELFT>();
+    }
   }
+  printMemoryUsage("section optimizations");
 
   // Read the callgraph now that we know what was gced or icfed
   if (config->callGraphProfileSort) {
     if (auto *arg = args.getLastArg(OPT_call_graph_ordering_file))
       if (Optional<MemoryBufferRef> buffer = readFile(arg->getValue()))
         readCallGraph(*buffer);
+    if (auto *arg = args.getLastArg(OPT_call_graph_sample_profile))
+      readCallGraphFromSampleProfile(arg->getValue());
     readCallGraphsFromObjectFiles<ELFT>();
   }
 
   // Write the result to the file.
+  llvm::TimeTraceScope timeScope("Write output file");
   writeResult<ELFT>();
 }
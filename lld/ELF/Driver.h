@@ -71,6 +71,8 @@ llvm::Optional<std::string> searchScript(StringRef path);
 llvm::Optional<std::string> searchLibraryBaseName(StringRef path);
 llvm::Optional<std::string> searchLibrary(StringRef path);
 
+void printMemoryUsage(StringRef phase);
+
 } // namespace elf
 } // namespace lld
 
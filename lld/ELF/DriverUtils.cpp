@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Driver.h"
+#include "InputFiles.h"
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Reproduce.h"
@@ -25,6 +26,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/TimeProfiler.h"
 
 using namespace llvm;
 using namespace llvm::sys;
@@ -251,3 +253,22 @@ Optional<std::string> elf::searchScript(StringRef name) {
     return name.str();
   return findFromSearchPaths(name);
 }
+
+// For --print-memory-usage. Reports heap usage and how much of the input files
+// is mapped into the address space. With --time-trace, the heap usage is also
+// recorded as a counter track.
+void elf::printMemoryUsage(StringRef phase) {
+  if (timeTraceProfilerEnabled())
+    timeTraceProfilerCounter("Heap (MiB)", Process::GetMallocUsage() >> 20);
+  if (!config->printMemoryUsage)
+    return;
+
+  uint64_t mapped = 0;
+  for (MemoryBuffer *mb : inputBuffers)
+    if (mb->getBufferKind() == MemoryBuffer::MemoryBuffer_MMap)
+      mapped += mb->getBufferSize();
+
+  message("memory usage after " + phase + ": " +
+          Twine(Process::GetMallocUsage() >> 20) + " MiB allocated, " +
+          Twine(mapped >> 20) + " MiB of input files mapped");
+}
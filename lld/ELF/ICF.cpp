@@ -79,6 +79,7 @@
 #include "SyntheticSections.h"
 #include "Writer.h"
 #include "lld/Common/Threads.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Object/ELF.h"
@@ -120,6 +121,11 @@ private:
 
   std::vector<InputSection *> sections;
 
+  // 64-bit hash values of section contents. They are computed once and let
+  // equalsConstant() reject most non-identical sections of the same size
+  // without comparing their contents.
+  llvm::DenseMap<const InputSection *, uint64_t> contentHashes;
+
   // We repeat the main loop while `Repeat` is true.
   std::atomic<bool> repeat;
 
@@ -300,7 +306,9 @@ bool ICF<ELFT>::constantEq(const InputSection *secA, ArrayRef<RelTy> ra,
 template <class ELFT>
 bool ICF<ELFT>::equalsConstant(const InputSection *a, const InputSection *b) {
   if (a->numRelocations != b->numRelocations || a->flags != b->flags ||
-      a->getSize() != b->getSize() || a->data() != b->data())
+      a->getSize() != b->getSize() ||
+      contentHashes.lookup(a) != contentHashes.lookup(b) ||
+      a->data() != b->data())
     return false;
 
   // If two sections have different output sections, we cannot merge them.
@@ -452,9 +460,14 @@ template <class ELFT> void ICF<ELFT>::run() {
         sections.push_back(s);
 
   // Initially, we use hash values to partition sections.
-  parallelForEach(sections, [&](InputSection *s) {
-    s->eqClass[0] = xxHash64(s->data());
+  std::vector<uint64_t> hashes(sections.size());
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    hashes[i] = xxHash64(sections[i]->data());
+    sections[i]->eqClass[0] = hashes[i];
   });
+  contentHashes.reserve(sections.size());
+  for (size_t i = 0; i < sections.size(); ++i)
+    contentHashes[sections[i]] = hashes[i];
 
   for (unsigned cnt = 0; cnt != 2; ++cnt) {
     parallelForEach(sections, [&](InputSection *s) {
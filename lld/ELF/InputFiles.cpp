@@ -49,6 +49,7 @@ std::vector<InputFile *> elf::objectFiles;
 std::vector<SharedFile *> elf::sharedFiles;
 
 std::unique_ptr<TarWriter> elf::tar;
+std::vector<MemoryBuffer *> elf::inputBuffers;
 
 static ELFKind getELFKind(MemoryBufferRef mb, StringRef archiveName) {
   unsigned char size;
@@ -96,7 +97,13 @@ Optional<MemoryBufferRef> elf::readFile(StringRef path) {
 
   log(path);
 
-  auto mbOrErr = MemoryBuffer::getFile(path, -1, false);
+  // Linking cold inputs is bound by page faults, which --prefetch-inputs
+  // turns into background reads issued as soon as the file is opened.
+  MemoryBufferOpenOptions options;
+  options.RequiresNullTerminator = false;
+  if (config->prefetchInputs)
+    options.Advice = sys::fs::mapped_file_region::willneed;
+  auto mbOrErr = MemoryBuffer::getFile(path, options);
   if (auto ec = mbOrErr.getError()) {
     error("cannot open " + path + ": " + ec.message());
     return None;
@@ -104,6 +111,7 @@ Optional<MemoryBufferRef> elf::readFile(StringRef path) {
 
   std::unique_ptr<MemoryBuffer> &mb = *mbOrErr;
   MemoryBufferRef mbref = mb->getMemBufferRef();
+  inputBuffers.push_back(mb.get());
   make<std::unique_ptr<MemoryBuffer>>(std::move(mb)); // take MB ownership
 
   if (tar)
@@ -207,6 +215,34 @@ void elf::parseFile(InputFile *file) {
   }
 }
 
+template <class ELFT> static void doPrehashSymbolNames(InputFile *file) {
+  if (auto *f = dyn_cast<ObjFile<ELFT>>(file))
+    f->prehashSymbolNames();
+}
+
+void elf::prehashSymbolNames(InputFile *file) {
+  // Files for other targets are diagnosed by parseFile().
+  if (!file->isElf() || file->ekind != config->ekind)
+    return;
+
+  switch (config->ekind) {
+  case ELF32LEKind:
+    doPrehashSymbolNames<ELF32LE>(file);
+    return;
+  case ELF32BEKind:
+    doPrehashSymbolNames<ELF32BE>(file);
+    return;
+  case ELF64LEKind:
+    doPrehashSymbolNames<ELF64LE>(file);
+    return;
+  case ELF64BEKind:
+    doPrehashSymbolNames<ELF64BE>(file);
+    return;
+  default:
+    llvm_unreachable("unknown ELFT");
+  }
+}
+
 // Concatenates arguments to construct a string representing an error location.
 static std::string createFileLineMsg(StringRef path, unsigned line) {
   std::string filename = path::filename(path);
@@ -1046,16 +1082,46 @@ StringRef ObjFile<ELFT>::getSectionName(const Elf_Shdr &sec) {
 
 // Initialize this->Symbols. this->Symbols is a parallel array as
 // its corresponding ELF symbol table.
+template <class ELFT> void ObjFile<ELFT>::prehashSymbolNames() {
+  ArrayRef<Elf_Sym> eSyms = this->getELFSyms<ELFT>();
+  StringRef strtab = this->stringTable;
+  globalNames.resize(eSyms.size() - this->firstGlobal,
+                     CachedHashStringRef(""));
+
+  for (size_t i = this->firstGlobal, end = eSyms.size(); i != end; ++i) {
+    if (eSyms[i].getBinding() == STB_LOCAL)
+      continue;
+
+    // Leave invalid names to initializeSymbols() so that it reports
+    // them exactly as it does without this precomputation.
+    uint32_t offset = eSyms[i].st_name;
+    if (offset >= strtab.size()) {
+      globalNames.clear();
+      return;
+    }
+    globalNames[i - this->firstGlobal] =
+        SymbolTable::getKey(StringRef(strtab.data() + offset));
+  }
+}
+
 template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
   ArrayRef<Elf_Sym> eSyms = this->getELFSyms<ELFT>();
   this->symbols.resize(eSyms.size());
 
   // Our symbol table may have already been partially initialized
   // because of LazyObjFile.
-  for (size_t i = 0, end = eSyms.size(); i != end; ++i)
-    if (!this->symbols[i] && eSyms[i].getBinding() != STB_LOCAL)
+  for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
+    if (this->symbols[i] || eSyms[i].getBinding() == STB_LOCAL)
+      continue;
+    if (i >= this->firstGlobal && !globalNames.empty())
+      this->symbols[i] = symtab->insert(globalNames[i - this->firstGlobal]);
+    else
       this->symbols[i] =
           symtab->insert(CHECK(eSyms[i].getName(this->stringTable), this));
+  }
+
+  // Names are no longer needed once they are in the symbol table.
+  std::vector<CachedHashStringRef>().swap(globalNames);
 
   // Fill this->Symbols. A symbol is either local or global.
   for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
@@ -51,12 +51,19 @@ class Symbol;
 // to this tar archive.
 extern std::unique_ptr<llvm::TarWriter> tar;
 
+// Buffers of all input files opened so far. Used by --release-input-memory.
+extern std::vector<llvm::MemoryBuffer *> inputBuffers;
+
 // Opens a given file.
 llvm::Optional<MemoryBufferRef> readFile(StringRef path);
 
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *file);
 
+// Computes hash values of global symbol names of File so that parseFile()
+// does not have to. Unlike parseFile(), this function is thread-safe.
+void prehashSymbolNames(InputFile *file);
+
 // The root class of input files.
 class InputFile {
 public:
@@ -207,6 +214,10 @@ public:
 
   void parse(bool ignoreComdats = false);
 
+  // Fills globalNames. This does not touch the symbol table, so it is safe
+  // to call for multiple files in parallel.
+  void prehashSymbolNames();
+
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> sections,
                                  const Elf_Shdr &sec);
 
@@ -280,6 +291,12 @@ private:
   // .shstrtab contents.
   StringRef sectionStringTable;
 
+  // Names of global symbols with their hash values, indexed by symbol index
+  // minus firstGlobal. initializeSymbols() uses them instead of hashing the
+  // names again when inserting them into the symbol table. Empty unless
+  // prehashSymbolNames() was called.
+  std::vector<llvm::CachedHashStringRef> globalNames;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
@@ -105,8 +105,11 @@ static lto::Config createConfig() {
 
   c.SampleProfile = config->ltoSampleProfile;
   c.UseNewPM = config->ltoNewPassManager;
+  c.OptimizePartitions = config->ltoOptimizePartitions;
   c.DebugPassManager = config->ltoDebugPassManager;
   c.DwoDir = config->dwoDir;
+  c.TimeTraceEnabled = config->timeTraceEnabled;
+  c.TimeTraceGranularity = config->timeTraceGranularity;
 
   c.CSIRProfile = config->ltoCSProfileFile;
   c.RunCSIRInstr = config->ltoCSProfileGenerate;
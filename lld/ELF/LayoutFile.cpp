@@ -0,0 +1,148 @@
+//===- LayoutFile.cpp -----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the --layout-file option. The layout file is a
+// sidecar file that records where output sections were placed and a digest
+// of each input object file:
+//
+//   # lld layout v1
+//   section .text 201000 1000 15
+//   file 9ae16a3b2f90404f test.o
+//
+// Section lines have an address, a file offset and a size in hexadecimal.
+// If the file already exists when we start writing a new one, we compare
+// its contents with the current link and report input files whose contents
+// changed and output sections whose placement changed. That tells whether
+// a relink only affected a few input files and kept the previous layout.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LayoutFile.h"
+#include "InputFiles.h"
+#include "OutputSections.h"
+#include "lld/Common/ErrorHandler.h"
+#include "lld/Common/Threads.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace llvm;
+
+using namespace lld;
+using namespace lld::elf;
+
+static const char header[] = "# lld layout v1";
+
+namespace {
+struct SectionLayout {
+  uint64_t addr;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct Layout {
+  StringMap<SectionLayout> sections;
+  StringMap<uint64_t> files;
+};
+} // namespace
+
+// Reads a layout file written by a previous link. Returns false if there
+// is no such file or if it is not a layout file.
+static bool readLayoutFile(StringRef path, Layout &layout) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr = MemoryBuffer::getFile(path);
+  if (!mbOrErr)
+    return false;
+
+  StringRef buf = (*mbOrErr)->getBuffer();
+  StringRef line;
+  std::tie(line, buf) = buf.split('\n');
+  if (line != header)
+    return false;
+
+  while (!buf.empty()) {
+    std::tie(line, buf) = buf.split('\n');
+    StringRef kind, rest;
+    std::tie(kind, rest) = line.split(' ');
+
+    if (kind == "section") {
+      SmallVector<StringRef, 4> fields;
+      rest.split(fields, ' ');
+      SectionLayout sec;
+      if (fields.size() != 4 || fields[1].getAsInteger(16, sec.addr) ||
+          fields[2].getAsInteger(16, sec.offset) ||
+          fields[3].getAsInteger(16, sec.size))
+        return false;
+      layout.sections[fields[0]] = sec;
+      continue;
+    }
+
+    if (kind == "file") {
+      StringRef hash, name;
+      std::tie(hash, name) = rest.split(' ');
+      uint64_t val;
+      if (hash.getAsInteger(16, val))
+        return false;
+      layout.files[name] = val;
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
+void elf::writeLayoutFile() {
+  if (config->layoutFile.empty())
+    return;
+
+  // Input files can be large, so hash them in parallel.
+  std::vector<uint64_t> hashes(objectFiles.size());
+  parallelForEachN(0, objectFiles.size(), [&](size_t i) {
+    hashes[i] = xxHash64(objectFiles[i]->mb.getBuffer());
+  });
+
+  Layout prev;
+  if (readLayoutFile(config->layoutFile, prev)) {
+    size_t numChanged = 0;
+    for (size_t i = 0; i < objectFiles.size(); ++i) {
+      std::string name = toString(objectFiles[i]);
+      auto it = prev.files.find(name);
+      if (it != prev.files.end() && it->second == hashes[i])
+        continue;
+      log("layout: " + name + " has changed");
+      ++numChanged;
+    }
+
+    for (OutputSection *sec : outputSections) {
+      auto it = prev.sections.find(sec->name);
+      if (it != prev.sections.end() && it->second.addr == sec->addr &&
+          it->second.offset == sec->offset && it->second.size == sec->size)
+        continue;
+      log("layout: placement of " + sec->name + " has changed");
+    }
+    log("layout: " + Twine(numChanged) + " of " + Twine(objectFiles.size()) +
+        " object files changed since the previous link");
+  }
+
+  std::error_code ec;
+  raw_fd_ostream os(config->layoutFile, ec, sys::fs::OF_None);
+  if (ec) {
+    error("cannot open " + config->layoutFile + ": " + ec.message());
+    return;
+  }
+
+  os << header << '\n';
+  for (OutputSection *sec : outputSections)
+    os << "section " << sec->name << ' ' << format_hex_no_prefix(sec->addr, 1)
+       << ' ' << format_hex_no_prefix(sec->offset, 1) << ' '
+       << format_hex_no_prefix(sec->size, 1) << '\n';
+  for (size_t i = 0; i < objectFiles.size(); ++i)
+    os << "file " << format_hex_no_prefix(hashes[i], 16) << ' '
+       << toString(objectFiles[i]) << '\n';
+}
@@ -0,0 +1,18 @@
+//===- LayoutFile.h ---------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_LAYOUTFILE_H
+#define LLD_ELF_LAYOUTFILE_H
+
+namespace lld {
+namespace elf {
+void writeLayoutFile();
+} // namespace elf
+} // namespace lld
+
+#endif
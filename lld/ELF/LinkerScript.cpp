@@ -368,18 +368,86 @@ static void sortInputSections(MutableArrayRef<InputSection *> vec,
   sortSections(vec, pat.sortOuter);
 }
 
+void LinkerScript::indexInputSections() {
+  sectionsByName.resize(inputSections.size());
+  for (size_t i = 0, e = inputSections.size(); i != e; ++i)
+    sectionsByName[i] = i;
+  parallelSort(sectionsByName, [&](uint32_t a, uint32_t b) {
+    int cmp = inputSections[a]->name.compare(inputSections[b]->name);
+    return cmp < 0 || (cmp == 0 && a < b);
+  });
+}
+
+// Finds the indices of the input sections whose names match pat, in
+// ascending order. Returns false if one of the patterns of pat can't be
+// looked up in sectionsByName, in which case every input section needs to be
+// matched against pat.
+bool LinkerScript::findCandidateSections(const StringMatcher &pat,
+                                         std::vector<uint32_t> &candidates) {
+  assert(sectionsByName.size() == inputSections.size());
+  candidates.clear();
+  auto nameLess = [&](uint32_t i, StringRef name) {
+    return inputSections[i]->name < name;
+  };
+
+  bool sorted = pat.getPatterns().size() == 1;
+  for (const GlobPattern &glob : pat.getPatterns()) {
+    // The sections named exactly like the pattern are in input order.
+    if (Optional<StringRef> exact = glob.getExact()) {
+      auto begin = llvm::lower_bound(sectionsByName, *exact, nameLess);
+      auto end = std::upper_bound(begin, sectionsByName.end(), *exact,
+                                  [&](StringRef name, uint32_t i) {
+                                    return name < inputSections[i]->name;
+                                  });
+      candidates.insert(candidates.end(), begin, end);
+      continue;
+    }
+
+    // A "*" pattern matches every section, so scanning them is cheaper.
+    Optional<StringRef> prefix = glob.getPrefix();
+    if (!prefix || prefix->empty())
+      return false;
+    auto begin = llvm::lower_bound(sectionsByName, *prefix, nameLess);
+    auto end = std::partition_point(
+        begin, sectionsByName.end(),
+        [&](uint32_t i) { return inputSections[i]->name.startswith(*prefix); });
+    candidates.insert(candidates.end(), begin, end);
+    sorted = false;
+  }
+
+  if (!sorted) {
+    parallelSort(candidates, std::less<uint32_t>());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+  }
+  return true;
+}
+
 // Compute and remember which sections the InputSectionDescription matches.
 std::vector<InputSection *>
 LinkerScript::computeInputSections(const InputSectionDescription *cmd) {
   std::vector<InputSection *> ret;
+  std::vector<uint32_t> candidates;
+  std::vector<uint8_t> matches;
 
   // Collects all sections that satisfy constraints of Cmd.
   for (const SectionPattern &pat : cmd->sectionPatterns) {
     size_t sizeBefore = ret.size();
 
-    for (InputSectionBase *sec : inputSections) {
+    // If pat can be looked up, only the candidates can match it.
+    bool indexed = findCandidateSections(pat.sectionPat, candidates);
+    size_t numSections = indexed ? candidates.size() : inputSections.size();
+    auto getSection = [&](size_t i) {
+      return inputSections[indexed ? candidates[i] : i];
+    };
+
+    // Sections are matched in parallel, but they are collected in order below
+    // so that the output doesn't depend on the scheduling.
+    matches.assign(numSections, false);
+    auto match = [&](size_t i) {
+      InputSectionBase *sec = getSection(i);
       if (!sec->isLive() || sec->assigned)
-        continue;
+        return;
 
       // For -emit-relocs we have to ignore entries like
       //   .rela.dyn : { *(.rela.data) }
@@ -388,17 +456,31 @@ LinkerScript::computeInputSections(const InputSectionDescription *cmd) {
       // want to support scripts that do custom layout for them.
       if (auto *isec = dyn_cast<InputSection>(sec))
         if (isec->getRelocatedSection())
-          continue;
+          return;
 
+      if (!indexed && !pat.sectionPat.match(sec->name))
+        return;
       std::string filename = getFilename(sec->file);
       if (!cmd->filePat.match(filename) ||
-          pat.excludedFilePat.match(filename) ||
-          !pat.sectionPat.match(sec->name))
+          pat.excludedFilePat.match(filename))
+        return;
+      matches[i] = true;
+    };
+    // Most patterns only have a few candidates, which aren't worth spawning
+    // tasks for.
+    if (numSections < 1024)
+      for (size_t i = 0; i < numSections; ++i)
+        match(i);
+    else
+      parallelForEachN(0, numSections, match);
+
+    for (size_t i = 0; i < numSections; ++i) {
+      if (!matches[i])
         continue;
-
       // It is safe to assume that Sec is an InputSection
       // because mergeable or EH input sections have already been
       // handled and eliminated.
+      InputSectionBase *sec = getSection(i);
       ret.push_back(cast<InputSection>(sec));
       sec->assigned = true;
     }
@@ -462,6 +544,8 @@ void LinkerScript::processSectionCommands() {
   ctx = deleter.get();
   ctx->outSec = aether;
 
+  indexInputSections();
+
   size_t i = 0;
   // Add input sections to output sections.
   for (BaseCommand *base : sectionCommands) {
@@ -523,6 +607,7 @@ void LinkerScript::processSectionCommands() {
     }
   }
   ctx = nullptr;
+  sectionsByName.clear();
 }
 
 static OutputSection *findByName(ArrayRef<BaseCommand *> vec,
@@ -226,6 +226,9 @@ class LinkerScript final {
   void expandOutputSection(uint64_t size);
   void expandMemoryRegions(uint64_t size);
 
+  void indexInputSections();
+  bool findCandidateSections(const StringMatcher &pat,
+                             std::vector<uint32_t> &candidates);
   std::vector<InputSection *>
   computeInputSections(const InputSectionDescription *);
 
@@ -249,6 +252,11 @@ class LinkerScript final {
   // LinkerScript.
   AddressState *ctx = nullptr;
 
+  // The indices of inputSections sorted by section name, then by index. This
+  // is used by processSectionCommands() to look up the sections a pattern
+  // without wildcards, or with a trailing "*" only, may match.
+  std::vector<uint32_t> sectionsByName;
+
   OutputSection *aether;
 
   uint64_t dot;
@@ -191,10 +191,14 @@ template <class ELFT> void OutputSection::maybeCompress() {
   hdr->ch_size = size;
   hdr->ch_addralign = alignment;
 
-  // Write section contents to a temporary buffer and compress it.
+  // Write section contents to a temporary buffer and compress it. Large
+  // sections are split into blocks that are compressed on multiple threads.
   std::vector<uint8_t> buf(size);
   writeTo<ELFT>(buf.data());
-  if (Error e = zlib::compress(toStringRef(buf), compressedData))
+  Error e = threadsEnabled
+                ? zlib::compressParallel(toStringRef(buf), compressedData)
+                : zlib::compress(toStringRef(buf), compressedData);
+  if (e)
     fatal("compress failed: " + llvm::toString(std::move(e)));
 
   // Update section headers.
@@ -42,6 +42,10 @@ public:
   }
 
   Symbol *insert(StringRef name);
+  Symbol *insert(llvm::CachedHashStringRef name);
+
+  // Returns a symbol table key for a given symbol name. This is thread-safe.
+  static llvm::CachedHashStringRef getKey(StringRef name);
 
   Symbol *addSymbol(const Symbol &newSym);
 
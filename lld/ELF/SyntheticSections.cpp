@@ -36,6 +36,7 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MD5.h"
+#include <atomic>
 #include <cstdlib>
 #include <thread>
 
@@ -2505,6 +2506,72 @@ readAddressAreas(DWARFContext &dwarf, InputSection *sec) {
   return ret;
 }
 
+// Reads address areas from .debug_aranges. This is much faster than
+// readAddressAreas() because we don't need to parse DIEs and range lists.
+// Returns None if the file has no .debug_aranges or if it is in a format
+// that we do not handle, in which case the caller falls back to the slow
+// path.
+template <class ELFT>
+static Optional<std::vector<GdbIndexSection::AddressEntry>>
+readAranges(const LLDDwarfObj<ELFT> &obj, InputSection *sec,
+            const std::vector<GdbIndexSection::CuEntry> &cus) {
+  const LLDDWARFSection &aranges = obj.getArangesLLDSection();
+  if (!aranges.sec)
+    return None;
+
+  std::vector<GdbIndexSection::AddressEntry> ret;
+  ArrayRef<InputSectionBase *> sections = sec->file->getSections();
+  DWARFDataExtractor data(obj, aranges, config->isLE, 0);
+  uint64_t off = 0;
+
+  while (data.isValidOffset(off)) {
+    // Read a set header. We only handle 32-bit DWARF version 2 sets
+    // without segment selectors, which is what compilers emit.
+    uint64_t setOff = off;
+    uint32_t len = data.getU32(&off);
+    uint16_t version = data.getU16(&off);
+    uint32_t cuOffset = data.getU32(&off);
+    uint8_t addrSize = data.getU8(&off);
+    uint8_t segSize = data.getU8(&off);
+    uint64_t end = setOff + 4 + len;
+    if (len >= 0xfffffff0 || version != 2 || segSize != 0 ||
+        (addrSize != 4 && addrSize != 8) ||
+        !data.isValidOffsetForDataOfSize(setOff, 4 + len))
+      return None;
+
+    auto it = llvm::partition_point(cus, [&](GdbIndexSection::CuEntry cu) {
+      return cu.cuOffset < cuOffset;
+    });
+    if (it == cus.end() || it->cuOffset != cuOffset)
+      return None;
+    uint32_t cuIdx = it - cus.begin();
+
+    // Tuples are aligned to twice the address size.
+    off = setOff + alignTo(off - setOff, addrSize * 2);
+    while (off + addrSize * 2 <= end) {
+      uint64_t secIdx;
+      uint64_t lowPC = data.getRelocatedValue(addrSize, &off, &secIdx);
+      uint64_t length = data.getUnsigned(&off, addrSize);
+      if (secIdx == object::SectionedAddress::UndefSection) {
+        if (lowPC == 0 && length == 0)
+          break;
+        continue;
+      }
+      if (length == 0 || secIdx >= sections.size())
+        continue;
+
+      InputSectionBase *s = sections[secIdx];
+      if (!s || s == &InputSection::discarded || !s->isLive())
+        continue;
+      auto *isec = cast<InputSection>(s);
+      uint64_t offset = isec->getOffsetInFile();
+      ret.push_back({isec, lowPC - offset, lowPC + length - offset, cuIdx});
+    }
+    off = end;
+  }
+  return ret;
+}
+
 template <class ELFT>
 static std::vector<GdbIndexSection::NameAttrEntry>
 readPubNamesAndTypes(const LLDDwarfObj<ELFT> &obj,
@@ -2631,12 +2698,16 @@ template <class ELFT> GdbIndexSection *GdbIndexSection::create() {
     ObjFile<ELFT> *file = sections[i]->getFile<ELFT>();
     DWARFContext dwarf(std::make_unique<LLDDwarfObj<ELFT>>(file));
 
+    auto &obj = static_cast<const LLDDwarfObj<ELFT> &>(dwarf.getDWARFObj());
+
     chunks[i].sec = sections[i];
     chunks[i].compilationUnits = readCuList(dwarf);
-    chunks[i].addressAreas = readAddressAreas(dwarf, sections[i]);
-    nameAttrs[i] = readPubNamesAndTypes<ELFT>(
-        static_cast<const LLDDwarfObj<ELFT> &>(dwarf.getDWARFObj()),
-        chunks[i].compilationUnits);
+    if (Optional<std::vector<AddressEntry>> areas =
+            readAranges(obj, sections[i], chunks[i].compilationUnits))
+      chunks[i].addressAreas = std::move(*areas);
+    else
+      chunks[i].addressAreas = readAddressAreas(dwarf, sections[i]);
+    nameAttrs[i] = readPubNamesAndTypes<ELFT>(obj, chunks[i].compilationUnits);
   });
 
   auto *ret = make<GdbIndexSection>();
@@ -2977,61 +3048,132 @@ void MergeTailSection::finalizeContents() {
 }
 
 void MergeNoTailSection::writeTo(uint8_t *buf) {
-  for (size_t i = 0; i < numShards; ++i)
-    shards[i].write(buf + shardOffsets[i]);
+  parallelForEach(uniquePieces, [&](const std::pair<StringRef, uint64_t> &p) {
+    memcpy(buf + p.second, p.first.data(), p.first.size());
+  });
 }
 
+namespace {
+// A lock-free open-addressing hash set of section pieces, used to
+// deduplicate pieces of MergeNoTailSection from multiple threads at once.
+//
+// A piece is identified by (section index, piece index). Each slot holds
+// the smallest identifier of the pieces with the same contents that have
+// been inserted, so the contents of the set do not depend on the order in
+// which threads insert pieces.
+class ConcurrentPieceSet {
+public:
+  ConcurrentPieceSet(ArrayRef<MergeInputSection *> sections, size_t numPieces)
+      : sections(sections), mask(PowerOf2Ceil(numPieces * 2 + 1) - 1),
+        slots(new std::atomic<uint64_t>[mask + 1]) {
+    for (size_t i = 0; i <= mask; ++i)
+      slots[i].store(0, std::memory_order_relaxed);
+  }
+
+  // Inserts a piece and returns the index of the slot it ended up in.
+  size_t insert(uint32_t secIdx, uint32_t pieceIdx) {
+    uint64_t id = getId(secIdx, pieceIdx);
+    CachedHashStringRef s = sections[secIdx]->getData(pieceIdx);
+
+    for (size_t i = s.hash() & mask;; i = (i + 1) & mask) {
+      uint64_t cur = slots[i].load(std::memory_order_acquire);
+      if (cur == 0) {
+        if (slots[i].compare_exchange_strong(cur, id,
+                                             std::memory_order_acq_rel))
+          return i;
+        // Someone else took this slot. Fall through to compare with it.
+      }
+      CachedHashStringRef t = getData(cur);
+      if (t.hash() != s.hash() || t.val() != s.val())
+        continue;
+
+      // Keep the smallest identifier.
+      while (id < cur &&
+             !slots[i].compare_exchange_weak(cur, id, std::memory_order_acq_rel))
+        ;
+      return i;
+    }
+  }
+
+  size_t size() const { return mask + 1; }
+
+  // Returns the identifier in a slot. 0 means the slot is empty.
+  uint64_t get(size_t i) const {
+    return slots[i].load(std::memory_order_relaxed);
+  }
+
+  CachedHashStringRef getData(uint64_t id) const {
+    --id;
+    return sections[id >> 32]->getData(id & 0xffffffff);
+  }
+
+private:
+  static uint64_t getId(uint32_t secIdx, uint32_t pieceIdx) {
+    return (((uint64_t)secIdx << 32) | pieceIdx) + 1;
+  }
+
+  ArrayRef<MergeInputSection *> sections;
+  size_t mask;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots;
+};
+} // namespace
+
 // This function is very hot (i.e. it can take several seconds to finish)
 // because sometimes the number of inputs is in an order of magnitude of
 // millions. So, we use multi-threading.
 //
-// For any strings S and T, we know S is not mergeable with T if S's hash
-// value is different from T's. If that's the case, we can safely put S and
-// T into different string builders without worrying about merge misses.
-// We do it in parallel.
+// All threads insert pieces into one lock-free hash set. The output layout
+// is then computed from the set's contents in a deterministic order, so it
+// does not depend on how threads were scheduled.
 void MergeNoTailSection::finalizeContents() {
-  // Initializes string table builders.
-  for (size_t i = 0; i < numShards; ++i)
-    shards.emplace_back(StringTableBuilder::RAW, alignment);
+  size_t numPieces = 0;
+  for (MergeInputSection *sec : sections)
+    numPieces += sec->pieces.size();
 
-  // Concurrency level. Must be a power of 2 to avoid expensive modulo
-  // operations in the following tight loop.
-  size_t concurrency = 1;
-  if (threadsEnabled)
-    concurrency =
-        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), numShards);
+  // Add live section pieces to the set. For now, each piece's outputOff
+  // holds the index of the slot for its contents.
+  ConcurrentPieceSet set(sections, numPieces);
+  parallelForEachN(0, sections.size(), [&](size_t secIdx) {
+    MergeInputSection *sec = sections[secIdx];
+    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
+      if (sec->pieces[i].live)
+        sec->pieces[i].outputOff = set.insert(secIdx, i);
+  });
 
-  // Add section pieces to the builders.
-  parallelForEachN(0, concurrency, [&](size_t threadId) {
-    for (MergeInputSection *sec : sections) {
-      for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
-        if (!sec->pieces[i].live)
-          continue;
-        size_t shardId = getShardId(sec->pieces[i].hash);
-        if ((shardId & (concurrency - 1)) == threadId)
-          sec->pieces[i].outputOff = shards[shardId].add(sec->getData(i));
-      }
-    }
+  // Sort unique pieces by shard and then by first occurrence. That makes
+  // the output deterministic regardless of the number of threads.
+  struct Entry {
+    uint32_t shardId;
+    uint64_t id;
+    size_t slot;
+  };
+  std::vector<Entry> entries;
+  for (size_t i = 0, e = set.size(); i != e; ++i)
+    if (uint64_t id = set.get(i))
+      entries.push_back({(uint32_t)getShardId(set.getData(id).hash()), id, i});
+  parallelSort(entries, [](const Entry &a, const Entry &b) {
+    return std::tie(a.shardId, a.id) < std::tie(b.shardId, b.id);
   });
 
-  // Compute an in-section offset for each shard.
+  // Assign offsets. offsets[i] is the offset of the contents in slot i.
+  std::vector<uint64_t> offsets(set.size());
   size_t off = 0;
-  for (size_t i = 0; i < numShards; ++i) {
-    shards[i].finalizeInOrder();
-    if (shards[i].getSize() > 0)
-      off = alignTo(off, alignment);
-    shardOffsets[i] = off;
-    off += shards[i].getSize();
+  uniquePieces.reserve(entries.size());
+  for (const Entry &ent : entries) {
+    StringRef s = set.getData(ent.id).val();
+    off = alignTo(off, alignment);
+    offsets[ent.slot] = off;
+    uniquePieces.push_back({s, off});
+    off += s.size();
   }
   size = off;
 
-  // So far, section pieces have offsets from beginning of shards, but
-  // we want offsets from beginning of the whole section. Fix them.
+  // So far, section pieces have slot indices, but we want offsets from
+  // beginning of the whole section. Fix them.
   parallelForEach(sections, [&](MergeInputSection *sec) {
     for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
       if (sec->pieces[i].live)
-        sec->pieces[i].outputOff +=
-            shardOffsets[getShardId(sec->pieces[i].hash)];
+        sec->pieces[i].outputOff = offsets[sec->pieces[i].outputOff];
   });
 }
 
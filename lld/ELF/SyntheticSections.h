@@ -881,10 +881,12 @@ private:
   // Section size
   size_t size;
 
-  // String table contents
+  // Unique pieces are laid out shard by shard. Within a shard, they are in
+  // the order of their first occurrences.
   constexpr static size_t numShards = 32;
-  std::vector<llvm::StringTableBuilder> shards;
-  size_t shardOffsets[numShards];
+
+  // Unique pieces and their offsets in this section, in output order.
+  std::vector<std::pair<StringRef, uint64_t>> uniquePieces;
 };
 
 // .MIPS.abiflags section.
@@ -10,6 +10,8 @@
 #include "AArch64ErrataFix.h"
 #include "CallGraphSort.h"
 #include "Config.h"
+#include "Driver.h"
+#include "LayoutFile.h"
 #include "LinkerScript.h"
 #include "MapFile.h"
 #include "OutputSections.h"
@@ -76,6 +78,7 @@ private:
   void writeSections();
   void writeSectionsBinary();
   void writeBuildId();
+  void flushBuildId();
 
   std::unique_ptr<FileOutputBuffer> &buffer;
 
@@ -109,14 +112,15 @@ StringRef elf::getOutputSectionName(const InputSectionBase *s) {
   }
 
   // This check is for -z keep-text-section-prefix.  This option separates text
-  // sections with prefix ".text.hot", ".text.unlikely", ".text.startup" or
-  // ".text.exit".
+  // sections with prefix ".text.hot", ".text.unlikely", ".text.startup",
+  // ".text.exit" or ".text.split", the last holding the cold parts of split
+  // functions.
   // When enabled, this allows identifying the hot code region (.text.hot) in
   // the final binary which can be selectively mapped to huge pages or mlocked,
   // for instance.
   if (config->zKeepTextSectionPrefix)
-    for (StringRef v :
-         {".text.hot.", ".text.unlikely.", ".text.startup.", ".text.exit."})
+    for (StringRef v : {".text.hot.", ".text.unlikely.", ".text.split.",
+                        ".text.startup.", ".text.exit."})
       if (isSectionPrefix(v, s->name))
         return v.drop_back();
 
@@ -579,6 +583,7 @@ template <class ELFT> void Writer<ELFT>::run() {
   checkExecuteOnly();
   if (errorCount())
     return;
+  printMemoryUsage("finalizing sections");
 
   script->assignAddresses();
 
@@ -632,10 +637,12 @@ template <class ELFT> void Writer<ELFT>::run() {
   writeBuildId();
   if (errorCount())
     return;
+  printMemoryUsage("writing sections");
 
   // Handle -Map and -cref options.
   writeMapFile();
   writeCrossReferenceTable();
+  writeLayoutFile();
   if (errorCount())
     return;
 
@@ -2530,6 +2537,8 @@ template <class ELFT> void Writer<ELFT>::openFile() {
   unsigned flags = 0;
   if (!config->relocatable)
     flags = FileOutputBuffer::F_executable;
+  if (config->streamingOutput)
+    flags |= FileOutputBuffer::F_streaming;
   Expected<std::unique_ptr<FileOutputBuffer>> bufferOrErr =
       FileOutputBuffer::create(config->outputFile, fileSize, flags);
 
@@ -2587,17 +2596,101 @@ template <class ELFT> void Writer<ELFT>::writeTrapInstr() {
 }
 
 // Write section contents to a mmap'ed file.
+namespace {
+// For --release-input-memory. Counts the sections of each input buffer that
+// are yet to be written, and tells the OS that the pages of the buffer are no
+// longer needed once its last section has been written. Pages that are
+// accessed afterwards, e.g. for symbol names, are read back from the file.
+class InputBufferReleaser {
+public:
+  InputBufferReleaser();
+  void written(OutputSection *sec);
+
+private:
+  MemoryBuffer *getBuffer(InputSectionBase *isec);
+  void add(InputSectionBase *isec, int n);
+
+  // Sorted by start address. Members of an archive belong to the buffer of
+  // the archive.
+  std::vector<MemoryBuffer *> buffers;
+  DenseMap<MemoryBuffer *, size_t> pending;
+};
+} // namespace
+
+InputBufferReleaser::InputBufferReleaser() : buffers(inputBuffers) {
+  llvm::sort(buffers, [](MemoryBuffer *a, MemoryBuffer *b) {
+    return a->getBufferStart() < b->getBufferStart();
+  });
+  for (OutputSection *sec : outputSections)
+    for (InputSection *isec : getInputSections(sec))
+      add(isec, 1);
+}
+
+MemoryBuffer *InputBufferReleaser::getBuffer(InputSectionBase *isec) {
+  if (!isec->file)
+    return nullptr;
+  const char *p = isec->file->mb.getBufferStart();
+  auto it = llvm::upper_bound(buffers, p, [](const char *p, MemoryBuffer *mb) {
+    return p < mb->getBufferStart();
+  });
+  if (it == buffers.begin() || p >= (*--it)->getBufferEnd())
+    return nullptr;
+  return *it;
+}
+
+void InputBufferReleaser::add(InputSectionBase *isec, int n) {
+  // Pieces of mergeable sections are read when the synthetic section that
+  // holds them is written.
+  if (auto *ms = dyn_cast<MergeSyntheticSection>(isec)) {
+    for (MergeInputSection *sec : ms->sections)
+      add(sec, n);
+    return;
+  }
+
+  MemoryBuffer *mb = getBuffer(isec);
+  if (!mb)
+    return;
+  if (n > 0) {
+    ++pending[mb];
+    return;
+  }
+  if (--pending[mb] == 0)
+    mb->dontNeedIfMmap();
+}
+
+void InputBufferReleaser::written(OutputSection *sec) {
+  for (InputSection *isec : getInputSections(sec))
+    add(isec, -1);
+}
+
 template <class ELFT> void Writer<ELFT>::writeSections() {
+  Optional<InputBufferReleaser> releaser;
+  if (config->releaseInputMemory)
+    releaser.emplace();
+
   // In -r or -emit-relocs mode, write the relocation sections first as in
   // ELf_Rel targets we might find out that we need to modify the relocated
   // section while doing it.
-  for (OutputSection *sec : outputSections)
-    if (sec->type == SHT_REL || sec->type == SHT_RELA)
+  for (OutputSection *sec : outputSections) {
+    if (sec->type == SHT_REL || sec->type == SHT_RELA) {
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+      if (releaser)
+        releaser->written(sec);
+    }
+  }
 
-  for (OutputSection *sec : outputSections)
-    if (sec->type != SHT_REL && sec->type != SHT_RELA)
+  // With --streaming-output, each section is handed to the output buffer
+  // as soon as it is written, so that it is written to the file while we
+  // are applying relocations to the following sections.
+  for (OutputSection *sec : outputSections) {
+    if (sec->type != SHT_REL && sec->type != SHT_RELA) {
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+      if (sec->type != SHT_NOBITS)
+        buffer->flush(sec->offset, sec->size);
+      if (releaser)
+        releaser->written(sec);
+    }
+  }
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
@@ -2640,6 +2733,7 @@ template <class ELFT> void Writer<ELFT>::writeBuildId() {
   if (config->buildId == BuildIdKind::Hexstring) {
     for (Partition &part : partitions)
       part.buildId->writeBuildId(config->buildIdVector);
+    flushBuildId();
     return;
   }
 
@@ -2673,6 +2767,15 @@ template <class ELFT> void Writer<ELFT>::writeBuildId() {
   }
   for (Partition &part : partitions)
     part.buildId->writeBuildId(buildId);
+  flushBuildId();
+}
+
+// Build IDs are written after their output sections were flushed, so they
+// need to be flushed again.
+template <class ELFT> void Writer<ELFT>::flushBuildId() {
+  for (Partition &part : partitions)
+    buffer->flush(part.buildId->getParent()->offset + part.buildId->outSecOff,
+                  part.buildId->getSize());
 }
 
 template void elf::writeResult<ELF32LE>();
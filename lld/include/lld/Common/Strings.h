@@ -36,6 +36,8 @@ public:
 
   bool match(llvm::StringRef s) const;
 
+  llvm::ArrayRef<llvm::GlobPattern> getPatterns() const { return patterns; }
+
 private:
   std::vector<llvm::GlobPattern> patterns;
 };
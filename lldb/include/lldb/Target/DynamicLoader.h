@@ -17,6 +17,7 @@
 #include "lldb/lldb-forward.h"
 #include "lldb/lldb-private-enumerations.h"
 #include "lldb/lldb-types.h"
+#include "llvm/ADT/ArrayRef.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -210,6 +211,13 @@ public:
     return LLDB_INVALID_ADDRESS;
   }
 
+  /// Creates the modules for \p files that the target doesn't have yet, and
+  /// parses their symbol tables, on several threads. Loading the modules with
+  /// LoadModuleAtAddress() afterwards then finds them already created.
+  /// The name indexes of the symbol tables are only built here if the target
+  /// preloads symbols, otherwise the first lookup in a module builds them.
+  void PrefetchModules(llvm::ArrayRef<lldb_private::FileSpec> files);
+
   /// Locates or creates a module given by \p file and updates/loads the
   /// resulting module at the virtual base address \p base_addr.
   virtual lldb::ModuleSP LoadModuleAtAddress(const lldb_private::FileSpec &file,
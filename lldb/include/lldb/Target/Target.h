@@ -12,6 +12,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -88,6 +89,10 @@ public:
 
   void SetPreloadSymbols(bool b);
 
+  bool GetParallelModuleLoad() const;
+
+  bool GetCacheExpressions() const;
+
   bool GetDisableASLR() const;
 
   void SetDisableASLR(bool b);
@@ -1042,6 +1047,25 @@ public:
                                const EvaluateExpressionOptions &options,
                                ValueObject *ctx_obj, Status &error);
 
+  // Expressions that parsed successfully are kept by UserExpression::Evaluate
+  // under a key made of their text and everything else the parse depends on,
+  // so evaluating the same expression again in the same frame doesn't have to
+  // compile it again. The cache is cleared whenever the modules of the target
+  // or its process change.
+
+  // Returns the expression cached under key if it can run in exe_ctx, else a
+  // null pointer. Either way the key is left reserved without an expression
+  // until CacheUserExpression fills it again, so a cached expression never
+  // runs twice at once, and one that was parsed before the cache was cleared
+  // is not cached.
+  lldb::UserExpressionSP TakeCachedUserExpression(const std::string &key,
+                                                  ExecutionContext &exe_ctx);
+
+  void CacheUserExpression(const std::string &key,
+                           const lldb::UserExpressionSP &expr_sp);
+
+  void ClearUserExpressionCache();
+
   // Creates a FunctionCaller for the given language, the rest of the
   // parameters have the same meaning as for the FunctionCaller constructor.
   // Since a FunctionCaller can't be
@@ -1307,6 +1331,9 @@ protected:
   lldb::ClangASTImporterSP m_ast_importer_sp;
   lldb::ClangModulesDeclVendorUP m_clang_modules_decl_vendor_up;
 
+  std::mutex m_user_expression_cache_mutex;
+  std::map<std::string, lldb::UserExpressionSP> m_user_expression_cache;
+
   lldb::SourceManagerUP m_source_manager_up;
 
   typedef std::map<lldb::user_id_t, StopHookSP> StopHookCollection;
@@ -9,10 +9,12 @@
 #ifndef liblldb_ConstString_h_
 #define liblldb_ConstString_h_
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FormatVariadic.h"
 
 #include <stddef.h>
+#include <vector>
 
 namespace lldb_private {
 class Stream;
@@ -436,6 +438,29 @@ public:
   ///     in memory.
   static size_t StaticMemorySize();
 
+  /// Memory statistics of the global string pool.
+  struct MemoryStats {
+    /// The number of unique strings in the pool.
+    size_t num_strings = 0;
+    /// The bytes allocated for the strings and the pool's hash tables.
+    size_t bytes_total = 0;
+    /// The bytes of the allocations actually used by string entries.
+    size_t bytes_used = 0;
+  };
+
+  static MemoryStats GetMemoryStats();
+
+  /// Add all of \a strings to the string pool at once.
+  ///
+  /// This is equivalent to constructing a ConstString from each of them, but
+  /// each part of the string pool is locked once for the whole batch instead
+  /// of once per string.
+  ///
+  /// \return
+  ///     The ConstString for each of \a strings, in the same order.
+  static std::vector<ConstString>
+  FromStrings(llvm::ArrayRef<llvm::StringRef> strings);
+
 protected:
   // Member variables
   const char *m_string;
@@ -86,6 +86,14 @@ protected:
           stat);
       i += 1;
     }
+    const ConstString::MemoryStats string_stats = ConstString::GetMemoryStats();
+    result.AppendMessageWithFormat(
+        "Strings in the string pool : %" PRIu64 "\n"
+        "Bytes used by the string pool : %" PRIu64 "\n"
+        "Bytes allocated by the string pool : %" PRIu64 "\n",
+        static_cast<uint64_t>(string_stats.num_strings),
+        static_cast<uint64_t>(string_stats.bytes_used),
+        static_cast<uint64_t>(string_stats.bytes_total));
     result.SetStatus(eReturnStatusSuccessFinishResult);
     return true;
   }
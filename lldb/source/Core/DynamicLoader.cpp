@@ -13,8 +13,10 @@
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Target/MemoryRegionInfo.h"
+#include "lldb/Target/Platform.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/Target.h"
 #include "lldb/Utility/ConstString.h"
@@ -149,6 +151,42 @@ DynamicLoader::GetSectionListFromModule(const ModuleSP module) const {
   return sections;
 }
 
+void DynamicLoader::PrefetchModules(llvm::ArrayRef<FileSpec> files) {
+  Target &target = m_process->GetTarget();
+  // Other platforms may have to fetch the files first, which is not safe to
+  // do on several threads.
+  PlatformSP platform_sp = target.GetPlatform();
+  if (!target.GetParallelModuleLoad() || !platform_sp ||
+      !platform_sp->IsHost())
+    return;
+
+  // These are the module specs LoadModuleAtAddress looks the modules up with.
+  std::vector<ModuleSpec> module_specs;
+  for (const FileSpec &file : files) {
+    ModuleSpec module_spec(file, target.GetArchitecture());
+    if (!target.GetImages().FindFirstModule(module_spec))
+      module_specs.push_back(module_spec);
+  }
+  if (module_specs.size() < 2)
+    return;
+
+  const FileSpecList search_paths = target.GetExecutableSearchPaths();
+  const bool preload_symbols = target.GetPreloadSymbols();
+  TaskMapOverInt(0, module_specs.size(), [&](size_t i) {
+    // The module is kept in the shared module list, where the target will
+    // find it.
+    ModuleSP module_sp;
+    ModuleList::GetSharedModule(module_specs[i], module_sp, &search_paths,
+                                nullptr, nullptr);
+    if (!module_sp)
+      return;
+    if (preload_symbols)
+      module_sp->PreloadSymbols();
+    else
+      module_sp->GetSymtab();
+  });
+}
+
 ModuleSP DynamicLoader::LoadModuleAtAddress(const FileSpec &file,
                                             addr_t link_map_addr,
                                             addr_t base_addr,
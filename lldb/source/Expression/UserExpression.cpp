@@ -44,6 +44,8 @@
 #include "lldb/Utility/Log.h"
 #include "lldb/Utility/StreamString.h"
 
+#include "llvm/Support/FormatVariadic.h"
+
 using namespace lldb_private;
 
 UserExpression::UserExpression(ExecutionContextScope &exe_scope,
@@ -219,10 +221,36 @@ lldb::ExpressionResults UserExpression::Evaluate(
       language = frame->GetLanguage();
   }
 
-  lldb::UserExpressionSP user_expression_sp(
-      target->GetUserExpressionForLanguage(expr, full_prefix, language,
-                                           desired_type, options, ctx_obj,
-                                           error));
+  const bool generate_debug_info = options.GetGenerateDebugInfo();
+
+  // Compiling the expression is by far the most expensive part of evaluating
+  // it, so run the result of an earlier parse again when it was made for the
+  // same text in the same frame, the way breakpoint conditions do. Persistent
+  // variables and top-level code change what later expressions see, so these
+  // are always parsed.
+  std::string cache_key;
+  if (target->GetCacheExpressions() && !ctx_obj &&
+      execution_policy != eExecutionPolicyTopLevel &&
+      !options.GetREPLEnabled() && !expr.contains('$') &&
+      !full_prefix.contains('$')) {
+    lldb::addr_t frame_addr = LLDB_INVALID_ADDRESS;
+    if (StackFrame *frame = exe_ctx.GetFramePtr())
+      frame_addr = frame->GetFrameCodeAddress().GetLoadAddress(target);
+    cache_key = llvm::formatv(
+        "{0}:{1}:{2}:{3}:{4:x}:{5}:", static_cast<int>(language),
+        static_cast<int>(desired_type), static_cast<int>(execution_policy),
+        generate_debug_info, frame_addr, full_prefix.size());
+    cache_key += full_prefix;
+    cache_key += expr;
+  }
+
+  lldb::UserExpressionSP user_expression_sp;
+  if (!cache_key.empty())
+    user_expression_sp = target->TakeCachedUserExpression(cache_key, exe_ctx);
+  const bool is_cached = user_expression_sp != nullptr;
+  if (!is_cached)
+    user_expression_sp.reset(target->GetUserExpressionForLanguage(
+        expr, full_prefix, language, desired_type, options, ctx_obj, error));
   if (error.Fail()) {
     if (log)
       LLDB_LOGF(log, "== [UserExpression::Evaluate] Getting expression: %s ==",
@@ -231,11 +259,10 @@ lldb::ExpressionResults UserExpression::Evaluate(
   }
 
   if (log)
-    LLDB_LOGF(log, "== [UserExpression::Evaluate] Parsing expression %s ==",
-              expr.str().c_str());
+    LLDB_LOGF(log, "== [UserExpression::Evaluate] %s expression %s ==",
+              is_cached ? "Reusing parsed" : "Parsing", expr.str().c_str());
 
   const bool keep_expression_in_memory = true;
-  const bool generate_debug_info = options.GetGenerateDebugInfo();
 
   if (options.InvokeCancelCallback(lldb::eExpressionEvaluationParse)) {
     error.SetErrorString("expression interrupted by callback before parse");
@@ -247,6 +274,7 @@ lldb::ExpressionResults UserExpression::Evaluate(
   DiagnosticManager diagnostic_manager;
 
   bool parse_success =
+      is_cached ||
       user_expression_sp->Parse(diagnostic_manager, exe_ctx, execution_policy,
                                 keep_expression_in_memory, generate_debug_info);
 
@@ -259,6 +287,10 @@ lldb::ExpressionResults UserExpression::Evaluate(
   if (fixed_text != nullptr)
     fixed_expression->append(fixed_text);
 
+  // Only the expression parsed from the text the key was made of is cached.
+  if (!parse_success || !fixed_expression->empty())
+    cache_key.clear();
+
   // If there is a fixed expression, try to parse it:
   if (!parse_success) {
     execution_results = lldb::eExpressionParseError;
@@ -319,6 +351,8 @@ lldb::ExpressionResults UserExpression::Evaluate(
         error.SetExpressionError(lldb::eExpressionSetupError,
                                  "expression needed to run but couldn't");
     } else if (execution_policy == eExecutionPolicyTopLevel) {
+      // The new declarations may change what the cached expressions refer to.
+      target->ClearUserExpressionCache();
       error.SetError(UserExpression::kNoResult, lldb::eErrorTypeGeneric);
       return lldb::eExpressionCompleted;
     } else {
@@ -340,6 +374,9 @@ lldb::ExpressionResults UserExpression::Evaluate(
           user_expression_sp->Execute(diagnostic_manager, exe_ctx, options,
                                       user_expression_sp, expr_result);
 
+      if (!cache_key.empty() && execution_results == lldb::eExpressionCompleted)
+        target->CacheUserExpression(cache_key, user_expression_sp);
+
       if (execution_results != lldb::eExpressionCompleted) {
         if (log)
           LLDB_LOGF(log, "== [UserExpression::Evaluate] Execution completed "
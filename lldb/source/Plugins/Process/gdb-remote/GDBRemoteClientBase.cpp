@@ -196,6 +196,7 @@ GDBRemoteClientBase::SendPacketAndReceiveResponseWithOutputSupport(
 GDBRemoteCommunication::PacketResult
 GDBRemoteClientBase::SendPacketAndWaitForResponseNoLock(
     llvm::StringRef payload, StringExtractorGDBRemote &response) {
+  const auto start = std::chrono::steady_clock::now();
   PacketResult packet_result = SendPacketNoLock(payload);
   if (packet_result != PacketResult::Success)
     return packet_result;
@@ -207,8 +208,10 @@ GDBRemoteClientBase::SendPacketAndWaitForResponseNoLock(
     if (packet_result != PacketResult::Success)
       return packet_result;
     // Make sure our response is valid for the payload that was sent
-    if (response.ValidateResponse())
+    if (response.ValidateResponse()) {
+      RecordRoundTrip(payload, std::chrono::steady_clock::now() - start);
       return packet_result;
+    }
     // Response says it wasn't valid
     Log *log = ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PACKETS);
     LLDB_LOGF(
@@ -222,6 +225,45 @@ GDBRemoteClientBase::SendPacketAndWaitForResponseNoLock(
   return packet_result;
 }
 
+// The general query and the extended packets are told apart by their name,
+// all others by their first character.
+static llvm::StringRef GetPacketName(llvm::StringRef payload) {
+  if (payload.empty())
+    return payload;
+  switch (payload[0]) {
+  case 'q':
+  case 'Q':
+  case 'j':
+  case 'v':
+    return payload.take_until(
+        [](char c) { return c == ':' || c == ';' || c == ','; });
+  case '_':
+    return payload.take_front(2);
+  default:
+    return payload.take_front(1);
+  }
+}
+
+void GDBRemoteClientBase::RecordRoundTrip(llvm::StringRef payload,
+                                          std::chrono::nanoseconds duration) {
+  std::lock_guard<std::mutex> guard(m_packet_statistics_mutex);
+  PacketStatistics &stats = m_packet_statistics[GetPacketName(payload).str()];
+  stats.count++;
+  stats.total += duration;
+  stats.max = std::max(stats.max, duration);
+}
+
+std::map<std::string, GDBRemoteClientBase::PacketStatistics>
+GDBRemoteClientBase::GetPacketStatistics() const {
+  std::lock_guard<std::mutex> guard(m_packet_statistics_mutex);
+  return m_packet_statistics;
+}
+
+void GDBRemoteClientBase::ResetPacketStatistics() {
+  std::lock_guard<std::mutex> guard(m_packet_statistics_mutex);
+  m_packet_statistics.clear();
+}
+
 bool GDBRemoteClientBase::SendvContPacket(llvm::StringRef payload,
                                           StringExtractorGDBRemote &response) {
   Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PROCESS));
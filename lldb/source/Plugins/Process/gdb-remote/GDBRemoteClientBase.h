@@ -11,7 +11,9 @@
 
 #include "GDBRemoteCommunication.h"
 
+#include <chrono>
 #include <condition_variable>
+#include <map>
 
 namespace lldb_private {
 namespace process_gdb_remote {
@@ -53,6 +55,19 @@ public:
   bool SendvContPacket(llvm::StringRef payload,
                        StringExtractorGDBRemote &response);
 
+  /// Round-trip times of the packets that were sent and answered.
+  struct PacketStatistics {
+    uint64_t count = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds max{0};
+  };
+
+  /// Return the round-trip statistics by packet name, e.g. "m" or
+  /// "qMemoryRegionInfo".
+  std::map<std::string, PacketStatistics> GetPacketStatistics() const;
+
+  void ResetPacketStatistics();
+
   class Lock {
   public:
     Lock(GDBRemoteClientBase &comm, bool interrupt);
@@ -125,6 +140,12 @@ private:
   /// now they just use a simple mutex.
   std::recursive_mutex m_async_mutex;
 
+  mutable std::mutex m_packet_statistics_mutex;
+  std::map<std::string, PacketStatistics> m_packet_statistics;
+
+  void RecordRoundTrip(llvm::StringRef payload,
+                       std::chrono::nanoseconds duration);
+
   bool ShouldStop(const UnixSignals &signals,
                   StringExtractorGDBRemote &response);
 
@@ -325,6 +325,7 @@ void GDBRemoteCommunicationClient::ResetDiscoverableSettings(bool did_exec) {
   // our inferior process execs
   m_qProcessInfo_is_valid = eLazyBoolCalculate;
   m_process_arch.Clear();
+  ClearMemoryRegionCache();
 }
 
 void GDBRemoteCommunicationClient::GetRemoteQSupported() {
@@ -1360,8 +1361,10 @@ addr_t GDBRemoteCommunicationClient::AllocateMemory(size_t size,
         PacketResult::Success) {
       if (response.IsUnsupportedResponse())
         m_supports_alloc_dealloc_memory = eLazyBoolNo;
-      else if (!response.IsErrorResponse())
+      else if (!response.IsErrorResponse()) {
+        ClearMemoryRegionCache();
         return response.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+      }
     } else {
       m_supports_alloc_dealloc_memory = eLazyBoolNo;
     }
@@ -1382,8 +1385,10 @@ bool GDBRemoteCommunicationClient::DeallocateMemory(addr_t addr) {
         PacketResult::Success) {
       if (response.IsUnsupportedResponse())
         m_supports_alloc_dealloc_memory = eLazyBoolNo;
-      else if (response.IsOKResponse())
+      else if (response.IsOKResponse()) {
+        ClearMemoryRegionCache();
         return true;
+      }
     } else {
       m_supports_alloc_dealloc_memory = eLazyBoolNo;
     }
@@ -1436,6 +1441,21 @@ Status GDBRemoteCommunicationClient::GetMemoryRegionInfo(
   Status error;
   region_info.Clear();
 
+  // The memory map only changes while the inferior runs or when we allocate
+  // memory in it, so answer repeated queries for a stopped process from the
+  // regions the stub has already reported.
+  {
+    std::lock_guard<std::mutex> guard(m_memory_region_cache_mutex);
+    auto pos = m_memory_region_cache.upper_bound(addr);
+    if (pos != m_memory_region_cache.begin()) {
+      --pos;
+      if (pos->second.GetRange().Contains(addr)) {
+        region_info = pos->second;
+        return error;
+      }
+    }
+  }
+
   if (m_supports_memory_region_info != eLazyBoolNo) {
     m_supports_memory_region_info = eLazyBoolYes;
     char packet[64];
@@ -1546,9 +1566,19 @@ Status GDBRemoteCommunicationClient::GetMemoryRegionInfo(
       region_info.SetBlocksize(qXfer_region_info.GetBlocksize());
     }
   }
+
+  if (error.Success() && region_info.GetRange().Contains(addr)) {
+    std::lock_guard<std::mutex> guard(m_memory_region_cache_mutex);
+    m_memory_region_cache[region_info.GetRange().GetRangeBase()] = region_info;
+  }
   return error;
 }
 
+void GDBRemoteCommunicationClient::ClearMemoryRegionCache() {
+  std::lock_guard<std::mutex> guard(m_memory_region_cache_mutex);
+  m_memory_region_cache.clear();
+}
+
 Status GDBRemoteCommunicationClient::GetQXferMemoryMapRegionInfo(
     lldb::addr_t addr, MemoryRegionInfo &region) {
   Status error = LoadQXferMemoryMap();
@@ -3997,4 +4027,5 @@ Status GDBRemoteCommunicationClient::ConfigureRemoteStructuredData(
 void GDBRemoteCommunicationClient::OnRunPacketSent(bool first) {
   GDBRemoteClientBase::OnRunPacketSent(first);
   m_curr_tid = LLDB_INVALID_THREAD_ID;
+  ClearMemoryRegionCache();
 }
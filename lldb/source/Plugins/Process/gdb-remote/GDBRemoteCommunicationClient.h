@@ -565,6 +565,13 @@ protected:
   std::vector<MemoryRegionInfo> m_qXfer_memory_map;
   bool m_qXfer_memory_map_loaded;
 
+  /// Regions reported by qMemoryRegionInfo since the inferior last ran,
+  /// keyed by their start address.
+  std::mutex m_memory_region_cache_mutex;
+  std::map<lldb::addr_t, MemoryRegionInfo> m_memory_region_cache;
+
+  void ClearMemoryRegionCache();
+
   bool GetCurrentProcessInfo(bool allow_lazy_pid = true);
 
   bool GetGDBServerVersion();
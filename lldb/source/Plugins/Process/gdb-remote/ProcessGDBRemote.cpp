@@ -153,6 +153,12 @@ public:
         nullptr, idx,
         g_processgdbremote_properties[idx].default_uint_value != 0);
   }
+
+  uint64_t GetStackPrefetchSize() const {
+    const uint32_t idx = ePropertyStackPrefetchSize;
+    return m_collection_sp->GetPropertyAtIndexAsUInt64(
+        nullptr, idx, g_processgdbremote_properties[idx].default_uint_value);
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> ProcessKDPPropertiesSP;
@@ -2394,6 +2400,8 @@ StateType ProcessGDBRemote::SetThreadStopInfo(StringExtractor &stop_packet) {
         associated_with_dispatch_queue, dispatch_queue_t, queue_name,
         queue_kind, queue_serial_number);
 
+    PrefetchStackMemory(thread_sp);
+
     return eStateStopped;
   } break;
 
@@ -2408,6 +2416,36 @@ StateType ProcessGDBRemote::SetThreadStopInfo(StringExtractor &stop_packet) {
   return eStateInvalid;
 }
 
+void ProcessGDBRemote::PrefetchStackMemory(const ThreadSP &thread_sp) {
+  const uint64_t prefetch_size =
+      GetGlobalPluginProperties()->GetStackPrefetchSize();
+  if (prefetch_size == 0 || !thread_sp)
+    return;
+  RegisterContextSP reg_ctx_sp = thread_sp->GetRegisterContext();
+  if (!reg_ctx_sp)
+    return;
+  const addr_t sp = reg_ctx_sp->GetSP(LLDB_INVALID_ADDRESS);
+  if (sp == LLDB_INVALID_ADDRESS)
+    return;
+
+  // Don't read past the end of the stack mapping, the stub would fail the
+  // whole read.
+  size_t size = prefetch_size;
+  MemoryRegionInfo region_info;
+  if (m_gdb_comm.GetMemoryRegionInfo(sp, region_info).Success()) {
+    if (region_info.GetReadable() != MemoryRegionInfo::eYes)
+      return;
+    size = std::min<addr_t>(size, region_info.GetRange().GetRangeEnd() - sp);
+  }
+
+  DataBufferSP data_buffer_sp(new DataBufferHeap(size, 0));
+  Status error;
+  const size_t bytes_read =
+      DoReadMemory(sp, data_buffer_sp->GetBytes(), size, error);
+  if (error.Success() && bytes_read > 0)
+    m_memory_cache.AddL1CacheData(sp, data_buffer_sp->GetBytes(), bytes_read);
+}
+
 void ProcessGDBRemote::RefreshStateAfterStop() {
   std::lock_guard<std::recursive_mutex> guard(m_thread_list_real.GetMutex());
 
@@ -5252,6 +5290,77 @@ public:
   }
 };
 
+class CommandObjectProcessGDBRemotePacketLatency : public CommandObjectParsed {
+public:
+  CommandObjectProcessGDBRemotePacketLatency(CommandInterpreter &interpreter)
+      : CommandObjectParsed(interpreter, "process plugin packet latency",
+                            "Dumps the number of round trips and the time "
+                            "spent waiting for responses, per packet type. ",
+                            nullptr),
+        m_option_group(),
+        m_reset(LLDB_OPT_SET_1, false, "reset", 'r',
+                "Clear the statistics after dumping them.", false, true) {
+    m_option_group.Append(&m_reset, LLDB_OPT_SET_ALL, LLDB_OPT_SET_1);
+    m_option_group.Finalize();
+  }
+
+  ~CommandObjectProcessGDBRemotePacketLatency() override {}
+
+  Options *GetOptions() override { return &m_option_group; }
+
+  bool DoExecute(Args &command, CommandReturnObject &result) override {
+    const size_t argc = command.GetArgumentCount();
+    if (argc == 0) {
+      ProcessGDBRemote *process =
+          (ProcessGDBRemote *)m_interpreter.GetExecutionContext()
+              .GetProcessPtr();
+      if (process) {
+        GDBRemoteCommunicationClient &gdb_comm = process->GetGDBRemote();
+        using Entry = std::pair<std::string,
+                                GDBRemoteClientBase::PacketStatistics>;
+        auto stats = gdb_comm.GetPacketStatistics();
+        std::vector<Entry> entries(stats.begin(), stats.end());
+        llvm::sort(entries, [](const Entry &lhs, const Entry &rhs) {
+          return lhs.second.total > rhs.second.total;
+        });
+
+        using namespace std::chrono;
+        Stream &strm = result.GetOutputStream();
+        strm.Printf("%-24s %10s %12s %10s %10s\n", "packet", "count",
+                    "total (ms)", "mean (us)", "max (us)");
+        uint64_t total_count = 0;
+        nanoseconds total_time{0};
+        for (const Entry &entry : entries) {
+          const GDBRemoteClientBase::PacketStatistics &s = entry.second;
+          strm.Printf("%-24s %10" PRIu64 " %12.3f %10.1f %10.1f\n",
+                      entry.first.c_str(), s.count,
+                      duration<double, std::milli>(s.total).count(),
+                      duration<double, std::micro>(s.total).count() / s.count,
+                      duration<double, std::micro>(s.max).count());
+          total_count += s.count;
+          total_time += s.total;
+        }
+        strm.Printf("%-24s %10" PRIu64 " %12.3f\n", "all", total_count,
+                    duration<double, std::milli>(total_time).count());
+
+        if (m_reset.GetOptionValue().GetCurrentValue())
+          gdb_comm.ResetPacketStatistics();
+        result.SetStatus(eReturnStatusSuccessFinishResult);
+        return true;
+      }
+    } else {
+      result.AppendErrorWithFormat("'%s' takes no arguments",
+                                   m_cmd_name.c_str());
+    }
+    result.SetStatus(eReturnStatusFailed);
+    return false;
+  }
+
+protected:
+  OptionGroupOptions m_option_group;
+  OptionGroupBoolean m_reset;
+};
+
 class CommandObjectProcessGDBRemotePacketXferSize : public CommandObjectParsed {
 private:
 public:
@@ -5416,6 +5525,10 @@ public:
     LoadSubCommand("speed-test",
                    CommandObjectSP(new CommandObjectProcessGDBRemoteSpeedTest(
                        interpreter)));
+    LoadSubCommand(
+        "latency",
+        CommandObjectSP(
+            new CommandObjectProcessGDBRemotePacketLatency(interpreter)));
   }
 
   ~CommandObjectProcessGDBRemotePacket() override {}
@@ -368,6 +368,11 @@ protected:
                     lldb::addr_t dispatch_queue_t, std::string &queue_name,
                     lldb::QueueKind queue_kind, uint64_t queue_serial);
 
+  /// Read the memory just above the stack pointer of \a thread_sp into the
+  /// memory cache with one packet, as configured by the
+  /// "stack-prefetch-size" setting.
+  void PrefetchStackMemory(const lldb::ThreadSP &thread_sp);
+
   void HandleStopReplySequence();
 
   void ClearThreadIDList();
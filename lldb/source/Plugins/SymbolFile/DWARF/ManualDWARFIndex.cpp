@@ -11,16 +11,29 @@
 #include "Plugins/SymbolFile/DWARF/DWARFDebugInfo.h"
 #include "Plugins/SymbolFile/DWARF/DWARFDeclContext.h"
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
+#include "Plugins/SymbolFile/DWARF/SymbolFileDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Host/FileSystem.h"
 #include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace lldb_private;
 using namespace lldb;
 
+// Identifies index cache files, and the version of their format.
+static const uint32_t g_index_cache_magic = 0x58444c4c; // "LLDX"
+static const uint32_t g_index_cache_version = 1;
+
 void ManualDWARFIndex::Index() {
   if (!m_debug_info)
     return;
@@ -41,6 +54,18 @@ void ManualDWARFIndex::Index() {
   if (units_to_index.empty())
     return;
 
+  std::string cache_key;
+  std::string cache_path = GetCachePath(units_to_index, cache_key);
+  if (!cache_path.empty() && LoadFromCache(cache_path, cache_key))
+    return;
+
+  // Hand out the largest units first, so that the threads are not left
+  // waiting for one of them to finish a big unit at the end.
+  std::stable_sort(units_to_index.begin(), units_to_index.end(),
+                   [](const DWARFUnit *lhs, const DWARFUnit *rhs) {
+                     return lhs->GetDebugInfoSize() > rhs->GetDebugInfoSize();
+                   });
+
   std::vector<IndexSet> sets(units_to_index.size());
 
   // Keep memory down by clearing DIEs for any units if indexing
@@ -85,6 +110,141 @@ void ManualDWARFIndex::Index() {
                      [&]() { finalize_fn(&IndexSet::globals); },
                      [&]() { finalize_fn(&IndexSet::types); },
                      [&]() { finalize_fn(&IndexSet::namespaces); });
+
+  // The key does not cover the .dwo files, so their index is not cached.
+  if (!cache_path.empty() &&
+      llvm::none_of(units_to_index,
+                    [](DWARFUnit *unit) { return unit->GetDwoSymbolFile(); }))
+    SaveToCache(cache_path, cache_key);
+}
+
+std::string ManualDWARFIndex::GetCachePath(llvm::ArrayRef<DWARFUnit *> units,
+                                           std::string &key) {
+  FileSpec directory = SymbolFileDWARF::GetIndexCacheDirectory();
+  if (!directory)
+    return "";
+  // A module that was not read from a file cannot be told apart from other
+  // versions of it.
+  if (m_module.GetModificationTime() == llvm::sys::TimePoint<>())
+    return "";
+
+  // The DWARF may live in a separate symbol file, which can change on its
+  // own.
+  FileSpec debug_file =
+      units.front()->GetSymbolFileDWARF().GetObjectFile()->GetFileSpec();
+  std::vector<dw_offset_t> units_to_avoid(m_units_to_avoid.begin(),
+                                          m_units_to_avoid.end());
+  llvm::sort(units_to_avoid);
+
+  llvm::raw_string_ostream os(key);
+  os << "module=" << m_module.GetFileSpec().GetPath();
+  if (ConstString object_name = m_module.GetObjectName())
+    os << "(" << object_name.GetStringRef() << ")";
+  os << " uuid=" << m_module.GetUUID().GetAsString()
+     << " mtime=" << m_module.GetModificationTime().time_since_epoch().count()
+     << " object-mtime="
+     << m_module.GetObjectModificationTime().time_since_epoch().count()
+     << " debug-file=" << debug_file.GetPath() << " debug-mtime="
+     << FileSystem::Instance()
+            .GetModificationTime(debug_file)
+            .time_since_epoch()
+            .count()
+     << " skip=";
+  for (dw_offset_t offset : units_to_avoid)
+    os << offset << ",";
+  os.flush();
+
+  llvm::MD5 hash;
+  hash.update(key);
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+
+  llvm::SmallString<256> path(directory.GetPath());
+  llvm::sys::path::append(
+      path, m_module.GetFileSpec().GetFilename().GetStringRef() + "-" +
+                result.digest() + ".dwarfindex");
+  return path.str().str();
+}
+
+bool ManualDWARFIndex::LoadFromCache(llvm::StringRef path,
+                                     llvm::StringRef key) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer_or =
+      llvm::MemoryBuffer::getFile(path);
+  if (!buffer_or)
+    return false;
+  llvm::MemoryBuffer &buffer = **buffer_or;
+
+  static Timer::Category func_cat(LLVM_PRETTY_FUNCTION);
+  Timer scoped_timer(func_cat, "%s", path.str().c_str());
+
+  DataExtractor data(buffer.getBufferStart(), buffer.getBufferSize(),
+                     eByteOrderLittle, /*addr_size=*/8);
+  lldb::offset_t offset = 0;
+  if (data.GetU32(&offset) != g_index_cache_magic ||
+      data.GetU32(&offset) != g_index_cache_version)
+    return false;
+  const char *cached_key = data.GetCStr(&offset);
+  if (!cached_key || key != cached_key)
+    return false;
+
+  for (NameToDIE *table : m_set.GetTables()) {
+    if (!table->Decode(data, &offset)) {
+      m_set = IndexSet();
+      return false;
+    }
+  }
+
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+  if (log)
+    m_module.LogMessage(log, "ManualDWARFIndex: loaded the index from %s",
+                        path.str().c_str());
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(llvm::StringRef path,
+                                   llvm::StringRef key) {
+  Log *log = LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS);
+
+  if (std::error_code ec = llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(path))) {
+    LLDB_LOG(log, "Unable to create the DWARF index cache directory: {0}",
+             ec.message());
+    return;
+  }
+
+  // The index is written to a temporary file which is then renamed, so that
+  // concurrent sessions never read a partially written index.
+  llvm::Expected<llvm::sys::fs::TempFile> temp =
+      llvm::sys::fs::TempFile::create(path + "-%%%%%%.tmp");
+  if (!temp) {
+    LLDB_LOG_ERROR(log, temp.takeError(),
+                   "Unable to create a DWARF index cache file: {0}");
+    return;
+  }
+
+  bool written;
+  {
+    llvm::raw_fd_ostream os(temp->FD, /*shouldClose=*/false);
+    llvm::support::endian::write<uint32_t>(os, g_index_cache_magic,
+                                           llvm::support::little);
+    llvm::support::endian::write<uint32_t>(os, g_index_cache_version,
+                                           llvm::support::little);
+    os << key << '\0';
+    for (NameToDIE *table : m_set.GetTables())
+      table->Encode(os);
+    os.flush();
+    written = !os.has_error();
+    os.clear_error();
+  }
+  if (!written) {
+    LLDB_LOG(log, "Unable to write the DWARF index cache file {0}",
+             temp->TmpName);
+    llvm::consumeError(temp->discard());
+    return;
+  }
+  if (llvm::Error error = temp->keep(path))
+    LLDB_LOG_ERROR(log, std::move(error),
+                   "Unable to save the DWARF index cache file: {0}");
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, IndexSet &set) {
@@ -11,7 +11,9 @@
 
 #include "Plugins/SymbolFile/DWARF/DWARFIndex.h"
 #include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
+#include <array>
 
 class DWARFDebugInfo;
 
@@ -54,10 +56,26 @@ private:
     NameToDIE globals;
     NameToDIE types;
     NameToDIE namespaces;
+
+    /// All the tables, in the order they are stored in the index cache.
+    std::array<NameToDIE *, 8> GetTables() {
+      return {{&function_basenames, &function_fullnames, &function_methods,
+               &function_selectors, &objc_class_selectors, &globals, &types,
+               &namespaces}};
+    }
   };
   void Index();
   void IndexUnit(DWARFUnit &unit, IndexSet &set);
 
+  /// Return the path of the index cache file for this module, or an empty
+  /// string if the index should not be cached. \a key is set to the text
+  /// identifying the exact contents of the module the index was built for.
+  std::string GetCachePath(llvm::ArrayRef<DWARFUnit *> units,
+                           std::string &key);
+  /// Fill m_set from the index cache if it has an entry matching \a key.
+  bool LoadFromCache(llvm::StringRef path, llvm::StringRef key);
+  void SaveToCache(llvm::StringRef path, llvm::StringRef key);
+
   static void IndexUnitImpl(DWARFUnit &unit,
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
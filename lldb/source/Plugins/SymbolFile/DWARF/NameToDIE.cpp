@@ -10,9 +10,11 @@
 #include "DWARFUnit.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/ConstString.h"
+#include "lldb/Utility/DataExtractor.h"
 #include "lldb/Utility/RegularExpression.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/StreamString.h"
+#include "llvm/Support/EndianStream.h"
 
 using namespace lldb;
 using namespace lldb_private;
@@ -76,3 +78,87 @@ void NameToDIE::Append(const NameToDIE &other) {
                  other.m_map.GetValueAtIndexUnchecked(i));
   }
 }
+
+// A DIERef is stored as two 32-bit words: the DWO number with its valid bit
+// and the section, and the DIE offset.
+static uint32_t EncodeDIERefLocation(const DIERef &die_ref) {
+  uint32_t bits = die_ref.section() == DIERef::DebugTypes ? 1u << 30 : 0;
+  if (llvm::Optional<uint32_t> dwo_num = die_ref.dwo_num())
+    bits |= 1u << 31 | *dwo_num;
+  return bits;
+}
+
+static DIERef DecodeDIERef(uint32_t bits, dw_offset_t die_offset) {
+  llvm::Optional<uint32_t> dwo_num;
+  if (bits & 1u << 31)
+    dwo_num = bits & ((1u << 30) - 1);
+  return DIERef(dwo_num,
+                bits & 1u << 30 ? DIERef::DebugTypes : DIERef::DebugInfo,
+                die_offset);
+}
+
+void NameToDIE::Encode(llvm::raw_ostream &os) const {
+  // The entries of a sorted map that have the same name are adjacent, so
+  // every name is written once, followed by all of its DIEs.
+  const uint32_t size = m_map.GetSize();
+  uint32_t num_names = 0;
+  for (uint32_t i = 0; i < size; ++i) {
+    if (i == 0 || m_map.GetCStringAtIndexUnchecked(i) !=
+                      m_map.GetCStringAtIndexUnchecked(i - 1))
+      ++num_names;
+  }
+  llvm::support::endian::write<uint32_t>(os, num_names, llvm::support::little);
+
+  for (uint32_t i = 0; i < size;) {
+    ConstString name = m_map.GetCStringAtIndexUnchecked(i);
+    uint32_t end = i + 1;
+    while (end < size && m_map.GetCStringAtIndexUnchecked(end) == name)
+      ++end;
+    os << name.GetStringRef() << '\0';
+    llvm::support::endian::write<uint32_t>(os, end - i, llvm::support::little);
+    for (; i < end; ++i) {
+      const DIERef &die_ref = m_map.GetValueAtIndexUnchecked(i);
+      llvm::support::endian::write<uint32_t>(
+          os, EncodeDIERefLocation(die_ref), llvm::support::little);
+      llvm::support::endian::write<uint32_t>(os, die_ref.die_offset(),
+                                             llvm::support::little);
+    }
+  }
+}
+
+bool NameToDIE::Decode(const DataExtractor &data, lldb::offset_t *offset_ptr) {
+  if (!data.ValidOffsetForDataOfSize(*offset_ptr, 4))
+    return false;
+  const uint32_t num_names = data.GetU32(offset_ptr);
+  // Read all names before adding them to the string pool in one batch.
+  std::vector<llvm::StringRef> names;
+  std::vector<lldb::offset_t> die_offsets;
+  names.reserve(num_names);
+  die_offsets.reserve(num_names);
+  for (uint32_t n = 0; n < num_names; ++n) {
+    const char *cstr = data.GetCStr(offset_ptr);
+    if (!cstr || !data.ValidOffsetForDataOfSize(*offset_ptr, 4))
+      return false;
+    names.push_back(cstr);
+    die_offsets.push_back(*offset_ptr);
+    const uint32_t num_dies = data.GetU32(offset_ptr);
+    if (!data.ValidOffsetForDataOfSize(*offset_ptr, num_dies * 8ull))
+      return false;
+    *offset_ptr += num_dies * 8ull;
+  }
+
+  std::vector<ConstString> const_names = ConstString::FromStrings(names);
+  for (uint32_t n = 0; n < num_names; ++n) {
+    lldb::offset_t offset = die_offsets[n];
+    const uint32_t num_dies = data.GetU32(&offset);
+    for (uint32_t i = 0; i < num_dies; ++i) {
+      const uint32_t bits = data.GetU32(&offset);
+      const dw_offset_t die_offset = data.GetU32(&offset);
+      m_map.Append(const_names[n], DecodeDIERef(bits, die_offset));
+    }
+  }
+  // The order of the map depends on the addresses of the ConstStrings, which
+  // differ between sessions, so it has to be sorted again.
+  Finalize();
+  return true;
+}
@@ -15,9 +15,18 @@
 #include "lldb/Core/UniqueCStringMap.h"
 #include "lldb/Core/dwarf.h"
 #include "lldb/lldb-defines.h"
+#include "lldb/lldb-types.h"
 
 class DWARFUnit;
 
+namespace lldb_private {
+class DataExtractor;
+}
+
+namespace llvm {
+class raw_ostream;
+}
+
 class NameToDIE {
 public:
   NameToDIE() : m_map() {}
@@ -41,6 +50,15 @@ public:
   size_t FindAllEntriesForUnit(const DWARFUnit &unit,
                                DIEArray &info_array) const;
 
+  /// Write the contents of a finalized map to \a os, in the form read back
+  /// by Decode().
+  void Encode(llvm::raw_ostream &os) const;
+
+  /// Append the entries written by Encode() at \a *offset_ptr in \a data
+  /// and finalize the map. Returns false if the data is truncated.
+  bool Decode(const lldb_private::DataExtractor &data,
+              lldb::offset_t *offset_ptr);
+
   void
   ForEach(std::function<bool(lldb_private::ConstString name,
                              const DIERef &die_ref)> const
@@ -73,6 +73,7 @@
 
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 
 #include <algorithm>
 #include <map>
@@ -144,6 +145,18 @@ public:
     return m_collection_sp->GetPropertyAtIndexAsBoolean(
         nullptr, ePropertyIgnoreIndexes, false);
   }
+
+  bool GetEnableIndexCache() const {
+    return m_collection_sp->GetPropertyAtIndexAsBoolean(
+        nullptr, ePropertyEnableIndexCache, false);
+  }
+
+  FileSpec GetIndexCachePath() const {
+    return m_collection_sp
+        ->GetPropertyAtIndexAsOptionValueFileSpec(nullptr, false,
+                                                  ePropertyIndexCachePath)
+        ->GetCurrentValue();
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> SymbolFileDWARFPropertiesSP;
@@ -223,6 +236,19 @@ FileSpecList SymbolFileDWARF::GetSymlinkPaths() {
   return GetGlobalPluginProperties()->GetSymLinkPaths();
 }
 
+FileSpec SymbolFileDWARF::GetIndexCacheDirectory() {
+  if (!GetGlobalPluginProperties()->GetEnableIndexCache())
+    return FileSpec();
+  FileSpec directory = GetGlobalPluginProperties()->GetIndexCachePath();
+  if (directory)
+    return directory;
+  llvm::SmallString<128> path;
+  if (!llvm::sys::path::home_directory(path))
+    return FileSpec();
+  llvm::sys::path::append(path, ".lldb", "index-cache");
+  return FileSpec(path);
+}
+
 void SymbolFileDWARF::Initialize() {
   LogChannelDWARF::Initialize();
   PluginManager::RegisterPlugin(GetPluginNameStatic(),
@@ -83,6 +83,10 @@ public:
 
   static lldb_private::FileSpecList GetSymlinkPaths();
 
+  /// The directory manual DWARF indexes are cached in, or an empty FileSpec
+  /// if the index cache is disabled.
+  static lldb_private::FileSpec GetIndexCacheDirectory();
+
   // Constructors and Destructors
 
   SymbolFileDWARF(lldb::ObjectFileSP objfile_sp,
@@ -188,6 +188,7 @@ void Target::DeleteCurrentProcess() {
 
     m_process_sp.reset();
   }
+  ClearUserExpressionCache();
 }
 
 const lldb::ProcessSP &Target::CreateProcess(ListenerSP listener_sp,
@@ -1377,6 +1378,7 @@ void Target::ClearModules(bool delete_locations) {
   m_images.Clear();
   m_scratch_type_system_map.Clear();
   m_ast_importer_sp.reset();
+  ClearUserExpressionCache();
 }
 
 void Target::DidExec() {
@@ -1616,6 +1618,7 @@ void Target::ModulesDidLoad(ModuleList &module_list) {
     if (m_process_sp) {
       m_process_sp->ModulesDidLoad(module_list);
     }
+    ClearUserExpressionCache();
     BroadcastEvent(eBroadcastBitModulesLoaded,
                    new TargetEventData(this->shared_from_this(), module_list));
   }
@@ -1631,6 +1634,7 @@ void Target::SymbolsDidLoad(ModuleList &module_list) {
 
     m_breakpoint_list.UpdateBreakpoints(module_list, true, false);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, true, false);
+    ClearUserExpressionCache();
     BroadcastEvent(eBroadcastBitSymbolsLoaded,
                    new TargetEventData(this->shared_from_this(), module_list));
   }
@@ -1642,6 +1646,7 @@ void Target::ModulesDidUnload(ModuleList &module_list, bool delete_locations) {
     m_breakpoint_list.UpdateBreakpoints(module_list, false, delete_locations);
     m_internal_breakpoint_list.UpdateBreakpoints(module_list, false,
                                                  delete_locations);
+    ClearUserExpressionCache();
     BroadcastEvent(eBroadcastBitModulesUnloaded,
                    new TargetEventData(this->shared_from_this(), module_list));
   }
@@ -2220,6 +2225,37 @@ UserExpression *Target::GetUserExpressionForLanguage(
   return user_expr;
 }
 
+// Enough for the expressions of the data formatters and breakpoint commands
+// of a session, while bounding the JIT memory kept in the inferior.
+static const size_t g_max_cached_user_expressions = 256;
+
+lldb::UserExpressionSP
+Target::TakeCachedUserExpression(const std::string &key,
+                                 ExecutionContext &exe_ctx) {
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  if (m_user_expression_cache.size() >= g_max_cached_user_expressions &&
+      !m_user_expression_cache.count(key))
+    m_user_expression_cache.erase(m_user_expression_cache.begin());
+  lldb::UserExpressionSP expr_sp;
+  expr_sp.swap(m_user_expression_cache[key]);
+  if (expr_sp && !expr_sp->MatchesContext(exe_ctx))
+    expr_sp.reset();
+  return expr_sp;
+}
+
+void Target::CacheUserExpression(const std::string &key,
+                                 const lldb::UserExpressionSP &expr_sp) {
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  auto pos = m_user_expression_cache.find(key);
+  if (pos != m_user_expression_cache.end())
+    pos->second = expr_sp;
+}
+
+void Target::ClearUserExpressionCache() {
+  std::lock_guard<std::mutex> guard(m_user_expression_cache_mutex);
+  m_user_expression_cache.clear();
+}
+
 FunctionCaller *Target::GetFunctionCallerForLanguage(
     lldb::LanguageType language, const CompilerType &return_type,
     const Address &function_address, const ValueList &arg_value_list,
@@ -3623,6 +3659,18 @@ void TargetProperties::SetPreloadSymbols(bool b) {
   m_collection_sp->SetPropertyAtIndexAsBoolean(nullptr, idx, b);
 }
 
+bool TargetProperties::GetParallelModuleLoad() const {
+  const uint32_t idx = ePropertyParallelModuleLoad;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_target_properties[idx].default_uint_value != 0);
+}
+
+bool TargetProperties::GetCacheExpressions() const {
+  const uint32_t idx = ePropertyCacheExpressions;
+  return m_collection_sp->GetPropertyAtIndexAsBoolean(
+      nullptr, idx, g_target_properties[idx].default_uint_value != 0);
+}
+
 bool TargetProperties::GetDisableASLR() const {
   const uint32_t idx = ePropertyDisableASLR;
   return m_collection_sp->GetPropertyAtIndexAsBoolean(
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <array>
 #include <utility>
+#include <vector>
 
 #include <inttypes.h>
 #include <stdint.h>
@@ -52,8 +53,8 @@ public:
 
   StringPoolValueType GetMangledCounterpart(const char *ccstr) const {
     if (ccstr != nullptr) {
-      const uint8_t h = hash(llvm::StringRef(ccstr));
-      llvm::sys::SmartScopedReader<false> rlock(m_string_pools[h].m_mutex);
+      const PoolEntry &pool = selectPool(hash(llvm::StringRef(ccstr)));
+      llvm::sys::SmartScopedReader<false> rlock(pool.m_mutex);
       return GetStringMapEntryFromKeyData(ccstr).getValue();
     }
     return nullptr;
@@ -73,37 +74,86 @@ public:
 
   const char *GetConstCStringWithStringRef(const llvm::StringRef &string_ref) {
     if (string_ref.data()) {
-      const uint8_t h = hash(string_ref);
-
+      // The string is hashed once, for the thread cache, the pool selection
+      // and the lookups in the pool.
+      const uint32_t h = hash(string_ref);
+      ThreadCacheEntry &cached = GetThreadCacheEntry(h);
+      if (cached.Matches(h, string_ref))
+        return cached.m_cstr;
+
+      PoolEntry &pool = selectPool(h);
+      const char *cstr;
       {
-        llvm::sys::SmartScopedReader<false> rlock(m_string_pools[h].m_mutex);
-        auto it = m_string_pools[h].m_string_map.find(string_ref);
-        if (it != m_string_pools[h].m_string_map.end())
-          return it->getKeyData();
+        llvm::sys::SmartScopedReader<false> rlock(pool.m_mutex);
+        auto it = pool.m_string_map.find(string_ref, h);
+        cstr = it != pool.m_string_map.end() ? it->getKeyData() : nullptr;
       }
-
-      llvm::sys::SmartScopedWriter<false> wlock(m_string_pools[h].m_mutex);
-      StringPoolEntryType &entry =
-          *m_string_pools[h]
-               .m_string_map.insert(std::make_pair(string_ref, nullptr))
-               .first;
-      return entry.getKeyData();
+      if (!cstr) {
+        llvm::sys::SmartScopedWriter<false> wlock(pool.m_mutex);
+        cstr = pool.m_string_map.try_emplace_with_hash(string_ref, h, nullptr)
+                   .first->getKeyData();
+      }
+      cached = {h, cstr};
+      return cstr;
     }
     return nullptr;
   }
 
+  void GetConstCStrings(llvm::ArrayRef<llvm::StringRef> strings,
+                        const char **cstrs) {
+    // Answer what the thread cache can, then visit the pools in order so that
+    // each one is locked once for all of its strings.
+    std::vector<uint32_t> hashes(strings.size());
+    std::vector<uint32_t> pending;
+    pending.reserve(strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+      cstrs[i] = nullptr;
+      if (!strings[i].data())
+        continue;
+      hashes[i] = hash(strings[i]);
+      ThreadCacheEntry &cached = GetThreadCacheEntry(hashes[i]);
+      if (cached.Matches(hashes[i], strings[i]))
+        cstrs[i] = cached.m_cstr;
+      else
+        pending.push_back(i);
+    }
+    std::stable_sort(pending.begin(), pending.end(),
+                     [&](uint32_t lhs, uint32_t rhs) {
+                       return poolIndex(hashes[lhs]) < poolIndex(hashes[rhs]);
+                     });
+
+    for (auto begin = pending.begin(); begin != pending.end();) {
+      const uint8_t index = poolIndex(hashes[*begin]);
+      auto end = std::find_if(begin, pending.end(), [&](uint32_t i) {
+        return poolIndex(hashes[i]) != index;
+      });
+      PoolEntry &pool = m_string_pools[index];
+      llvm::sys::SmartScopedWriter<false> wlock(pool.m_mutex);
+      for (; begin != end; ++begin) {
+        const uint32_t i = *begin;
+        cstrs[i] =
+            pool.m_string_map.try_emplace_with_hash(strings[i], hashes[i],
+                                                    nullptr)
+                .first->getKeyData();
+        GetThreadCacheEntry(hashes[i]) = {hashes[i], cstrs[i]};
+      }
+    }
+  }
+
   const char *
   GetConstCStringAndSetMangledCounterPart(llvm::StringRef demangled,
                                           const char *mangled_ccstr) {
     const char *demangled_ccstr = nullptr;
 
     {
-      const uint8_t h = hash(demangled);
-      llvm::sys::SmartScopedWriter<false> wlock(m_string_pools[h].m_mutex);
+      const uint32_t h = hash(demangled);
+      PoolEntry &pool = selectPool(h);
+      llvm::sys::SmartScopedWriter<false> wlock(pool.m_mutex);
 
       // Make or update string pool entry with the mangled counterpart
-      StringPool &map = m_string_pools[h].m_string_map;
-      StringPoolEntryType &entry = *map.try_emplace(demangled).first;
+      StringPool &map = pool.m_string_map;
+      StringPoolEntryType &entry =
+          *map.try_emplace_with_hash(demangled, h).first;
 
       entry.second = mangled_ccstr;
 
@@ -114,8 +164,8 @@ public:
     {
       // Now assign the demangled const string as the counterpart of the
       // mangled const string...
-      const uint8_t h = hash(llvm::StringRef(mangled_ccstr));
-      llvm::sys::SmartScopedWriter<false> wlock(m_string_pools[h].m_mutex);
+      PoolEntry &pool = selectPool(hash(llvm::StringRef(mangled_ccstr)));
+      llvm::sys::SmartScopedWriter<false> wlock(pool.m_mutex);
       GetStringMapEntryFromKeyData(mangled_ccstr).setValue(demangled_ccstr);
     }
 
@@ -144,9 +194,26 @@ public:
     return mem_size;
   }
 
+  ConstString::MemoryStats GetMemoryStats() const {
+    ConstString::MemoryStats stats;
+    for (const auto &pool : m_string_pools) {
+      llvm::sys::SmartScopedReader<false> rlock(pool.m_mutex);
+      const auto &allocator = pool.m_string_map.getAllocator();
+      stats.num_strings += pool.m_string_map.size();
+      stats.bytes_total += allocator.getTotalMemory() +
+                           pool.m_string_map.getNumBuckets() *
+                               (sizeof(void *) + sizeof(uint32_t));
+      stats.bytes_used += allocator.getBytesAllocated();
+    }
+    return stats;
+  }
+
 protected:
-  uint8_t hash(const llvm::StringRef &s) const {
-    uint32_t h = llvm::djbHash(s);
+  static uint32_t hash(const llvm::StringRef &s) {
+    return StringPool::hash(s);
+  }
+
+  static uint8_t poolIndex(uint32_t h) {
     return ((h >> 24) ^ (h >> 16) ^ (h >> 8) ^ h) & 0xff;
   }
 
@@ -155,6 +222,33 @@ protected:
     StringPool m_string_map;
   };
 
+  PoolEntry &selectPool(uint32_t h) { return m_string_pools[poolIndex(h)]; }
+
+  const PoolEntry &selectPool(uint32_t h) const {
+    return m_string_pools[poolIndex(h)];
+  }
+
+  // Strings are never removed from the pool, so the pointer returned for a
+  // string stays valid forever and every thread can remember the strings it
+  // interned last without any locking. DWARF and symbol table parsing look up
+  // the same type, member and namespace names over and over, and most of
+  // those lookups are answered here instead of contending for a pool's lock.
+  struct ThreadCacheEntry {
+    uint32_t m_hash;
+    const char *m_cstr;
+
+    bool Matches(uint32_t h, llvm::StringRef s) const {
+      return m_cstr && m_hash == h &&
+             GetConstCStringLength(m_cstr) == s.size() &&
+             memcmp(m_cstr, s.data(), s.size()) == 0;
+    }
+  };
+
+  static ThreadCacheEntry &GetThreadCacheEntry(uint32_t h) {
+    static thread_local std::array<ThreadCacheEntry, 1024> g_thread_cache;
+    return g_thread_cache[h % g_thread_cache.size()];
+  }
+
   std::array<PoolEntry, 256> m_string_pools;
 };
 
@@ -305,6 +399,20 @@ size_t ConstString::StaticMemorySize() {
   return StringPool().MemorySize();
 }
 
+ConstString::MemoryStats ConstString::GetMemoryStats() {
+  return StringPool().GetMemoryStats();
+}
+
+std::vector<ConstString>
+ConstString::FromStrings(llvm::ArrayRef<llvm::StringRef> strings) {
+  std::vector<const char *> cstrs(strings.size());
+  StringPool().GetConstCStrings(strings, cstrs.data());
+  std::vector<ConstString> result(strings.size());
+  for (size_t i = 0; i < strings.size(); ++i)
+    result[i].m_string = cstrs[i];
+  return result;
+}
+
 void llvm::format_provider<ConstString>::format(const ConstString &CS,
                                                 llvm::raw_ostream &OS,
                                                 llvm::StringRef Options) {
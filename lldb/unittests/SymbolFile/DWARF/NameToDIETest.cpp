@@ -0,0 +1,84 @@
+//===-- NameToDIETest.cpp ---------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "lldb/Utility/ConstString.h"
+#include "lldb/Utility/DataExtractor.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+static std::string Encode(const NameToDIE &map) {
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  map.Encode(os);
+  return os.str();
+}
+
+static DataExtractor Extractor(const std::string &data) {
+  return DataExtractor(data.data(), data.size(), eByteOrderLittle, 8);
+}
+
+TEST(NameToDIETest, EncodeDecode) {
+  NameToDIE map;
+  const DIERef foo1(llvm::None, DIERef::DebugInfo, 0x10);
+  const DIERef foo2(7, DIERef::DebugInfo, 0x20);
+  const DIERef bar(llvm::None, DIERef::DebugTypes, 0x30);
+  const DIERef baz(3, DIERef::DebugTypes, 0xffffffff);
+  map.Insert(ConstString("foo"), foo1);
+  map.Insert(ConstString("bar"), bar);
+  map.Insert(ConstString("foo"), foo2);
+  map.Insert(ConstString("baz"), baz);
+  map.Finalize();
+
+  std::string data = Encode(map);
+  DataExtractor extractor = Extractor(data);
+  lldb::offset_t offset = 0;
+  NameToDIE decoded;
+  ASSERT_TRUE(decoded.Decode(extractor, &offset));
+  EXPECT_EQ(data.size(), offset);
+
+  using Result =
+      std::vector<std::tuple<llvm::Optional<uint32_t>, int, dw_offset_t>>;
+  auto find = [&](const char *name) {
+    DIEArray dies;
+    decoded.Find(ConstString(name), dies);
+    Result result;
+    for (const DIERef &ref : dies)
+      result.emplace_back(ref.dwo_num(), ref.section(), ref.die_offset());
+    llvm::sort(result);
+    return result;
+  };
+  EXPECT_EQ((Result{{llvm::None, DIERef::DebugInfo, 0x10},
+                    {7u, DIERef::DebugInfo, 0x20}}),
+            find("foo"));
+  EXPECT_EQ((Result{{llvm::None, DIERef::DebugTypes, 0x30}}), find("bar"));
+  EXPECT_EQ((Result{{3u, DIERef::DebugTypes, 0xffffffff}}), find("baz"));
+  EXPECT_EQ(Result(), find("qux"));
+
+  // Encoding the decoded map gives the same data again.
+  EXPECT_EQ(data.size(), Encode(decoded).size());
+}
+
+TEST(NameToDIETest, DecodeTruncated) {
+  NameToDIE map;
+  map.Insert(ConstString("foo"), DIERef(llvm::None, DIERef::DebugInfo, 0x10));
+  map.Insert(ConstString("bar"), DIERef(1, DIERef::DebugInfo, 0x20));
+  map.Finalize();
+
+  std::string data = Encode(map);
+  for (size_t size = 0; size < data.size(); ++size) {
+    std::string truncated = data.substr(0, size);
+    DataExtractor extractor = Extractor(truncated);
+    lldb::offset_t offset = 0;
+    NameToDIE decoded;
+    EXPECT_FALSE(decoded.Decode(extractor, &offset)) << "size " << size;
+  }
+}
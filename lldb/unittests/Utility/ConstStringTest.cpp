@@ -137,3 +137,29 @@ TEST(ConstStringTest, CompareStringRef) {
   EXPECT_TRUE(null == static_cast<const char *>(nullptr));
   EXPECT_TRUE(null != "bar");
 }
+
+TEST(ConstStringTest, FromStrings) {
+  ConstString foo("foo");
+  std::vector<llvm::StringRef> strings = {"foo", "from_strings", "", "foo",
+                                          llvm::StringRef()};
+  std::vector<ConstString> result = ConstString::FromStrings(strings);
+  ASSERT_EQ(strings.size(), result.size());
+  EXPECT_EQ(foo, result[0]);
+  EXPECT_EQ(ConstString("from_strings"), result[1]);
+  EXPECT_EQ(ConstString(""), result[2]);
+  EXPECT_EQ(foo, result[3]);
+  EXPECT_EQ(ConstString(), result[4]);
+
+  EXPECT_TRUE(ConstString::FromStrings({}).empty());
+}
+
+TEST(ConstStringTest, MemoryStats) {
+  ConstString::MemoryStats before = ConstString::GetMemoryStats();
+  ConstString("memory_stats_first");
+  ConstString("memory_stats_second");
+  ConstString("memory_stats_first");
+  ConstString::MemoryStats after = ConstString::GetMemoryStats();
+  EXPECT_EQ(before.num_strings + 2, after.num_strings);
+  EXPECT_LT(before.bytes_used, after.bytes_used);
+  EXPECT_LE(after.bytes_used, after.bytes_total);
+}
@@ -0,0 +1,101 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Random nonzero values of the given bit width. Widths up to 128 bits use the
+// inline representation, wider ones the heap allocated one.
+static std::vector<APInt> makeValues(unsigned BitWidth) {
+  std::mt19937_64 Rand;
+  std::vector<APInt> Values;
+  for (unsigned I = 0; I != 256; ++I) {
+    SmallVector<uint64_t, 16> Words((BitWidth + 63) / 64);
+    for (uint64_t &W : Words)
+      W = Rand();
+    Words[0] |= 1;
+    Values.emplace_back(BitWidth, Words);
+  }
+  return Values;
+}
+
+static void BM_APIntAdd(benchmark::State &State) {
+  std::vector<APInt> Values = makeValues(State.range(0));
+  APInt Acc(State.range(0), 0);
+  for (auto _ : State) {
+    for (const APInt &V : Values)
+      Acc += V;
+    benchmark::DoNotOptimize(Acc);
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntAdd)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+static void BM_APIntCopy(benchmark::State &State) {
+  std::vector<APInt> Values = makeValues(State.range(0));
+  for (auto _ : State) {
+    for (const APInt &V : Values) {
+      APInt Copy(V);
+      benchmark::DoNotOptimize(Copy);
+    }
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntCopy)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+static void BM_APIntMul(benchmark::State &State) {
+  std::vector<APInt> Values = makeValues(State.range(0));
+  APInt Acc(State.range(0), 1);
+  for (auto _ : State) {
+    for (const APInt &V : Values)
+      Acc *= V;
+    benchmark::DoNotOptimize(Acc);
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntMul)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+static void BM_APIntUDiv(benchmark::State &State) {
+  std::vector<APInt> Values = makeValues(State.range(0));
+  std::vector<APInt> Divisors = makeValues(State.range(0));
+  // Divide by values of half the width, as in constant folding of divisions
+  // by small constants.
+  for (APInt &D : Divisors)
+    D.lshrInPlace(State.range(0) / 2);
+  for (auto _ : State) {
+    for (size_t I = 0; I != Values.size(); ++I)
+      benchmark::DoNotOptimize(Values[I].udiv(Divisors[I] | 1));
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntUDiv)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+static void BM_APIntShifts(benchmark::State &State) {
+  std::vector<APInt> Values = makeValues(State.range(0));
+  for (auto _ : State) {
+    for (const APInt &V : Values)
+      benchmark::DoNotOptimize(V.shl(3).lshr(5).ashr(1));
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntShifts)->Arg(32)->Arg(64)->Arg(128)->Arg(1024);
+
+static void BM_APIntToString(benchmark::State &State) {
+  std::vector<APInt> Values = makeValues(State.range(0));
+  SmallString<64> Str;
+  for (auto _ : State) {
+    for (const APInt &V : Values) {
+      Str.clear();
+      V.toStringUnsigned(Str);
+    }
+    benchmark::DoNotOptimize(Str.data());
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntToString)->Arg(64)->Arg(128)->Arg(1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+#include "benchmark/benchmark.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+// A cheap function analysis, so that the benchmarks measure the bookkeeping
+// of the analysis manager rather than the analysis itself.
+struct BlockCountAnalysis : AnalysisInfoMixin<BlockCountAnalysis> {
+  struct Result {
+    size_t NumBlocks;
+  };
+  Result run(Function &F, FunctionAnalysisManager &) { return {F.size()}; }
+  static AnalysisKey Key;
+};
+AnalysisKey BlockCountAnalysis::Key;
+
+// A pass that queries the analysis and preserves everything.
+struct QueryPass : PassInfoMixin<QueryPass> {
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM) {
+    benchmark::DoNotOptimize(FAM.getResult<BlockCountAnalysis>(F).NumBlocks);
+    return PreservedAnalyses::all();
+  }
+};
+
+// A pass that invalidates all analyses, like a transformation that changed
+// the function.
+struct InvalidatePass : PassInfoMixin<InvalidatePass> {
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM) {
+    benchmark::DoNotOptimize(FAM.getResult<BlockCountAnalysis>(F).NumBlocks);
+    return PreservedAnalyses::none();
+  }
+};
+
+struct TestModule {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M = std::make_unique<Module>("bench", Ctx);
+  FunctionAnalysisManager FAM;
+
+  explicit TestModule(unsigned NumFunctions) {
+    FunctionType *FTy = FunctionType::get(Type::getVoidTy(Ctx), false);
+    for (unsigned I = 0; I != NumFunctions; ++I) {
+      Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage,
+                                     "f" + std::to_string(I), *M);
+      ReturnInst::Create(Ctx, BasicBlock::Create(Ctx, "entry", F));
+    }
+    FAM.registerPass([] { return BlockCountAnalysis(); });
+    FAM.registerPass([] { return PassInstrumentationAnalysis(); });
+  }
+};
+} // namespace
+
+static void BM_GetCachedResult(benchmark::State &State) {
+  TestModule T(State.range(0));
+  for (Function &F : *T.M)
+    T.FAM.getResult<BlockCountAnalysis>(F);
+  for (auto _ : State)
+    for (Function &F : *T.M)
+      benchmark::DoNotOptimize(T.FAM.getResult<BlockCountAnalysis>(F));
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_GetCachedResult)->Range(8, 4096);
+
+static void BM_InvalidateAndRecompute(benchmark::State &State) {
+  TestModule T(State.range(0));
+  for (auto _ : State)
+    for (Function &F : *T.M) {
+      T.FAM.invalidate(F, PreservedAnalyses::none());
+      benchmark::DoNotOptimize(T.FAM.getResult<BlockCountAnalysis>(F));
+    }
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_InvalidateAndRecompute)->Range(8, 4096);
+
+// Run a pipeline of eight passes over every function, with and without
+// invalidation between them.
+template <class PassT> static void BM_RunPipeline(benchmark::State &State) {
+  TestModule T(State.range(0));
+  FunctionPassManager FPM;
+  for (unsigned I = 0; I != 8; ++I)
+    FPM.addPass(PassT());
+  for (auto _ : State)
+    for (Function &F : *T.M)
+      FPM.run(F, T.FAM);
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK_TEMPLATE(BM_RunPipeline, QueryPass)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_RunPipeline, InvalidatePass)->Range(8, 4096);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,101 @@
+#include "benchmark/benchmark.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include <string>
+
+using namespace llvm;
+
+enum { NumFunctions = 2000, NumBlocks = 10 };
+
+static const char *TripleName = "x86_64-unknown-linux-gnu";
+
+// Assembly shaped like the output of a JIT or compiler: functions in their own
+// sections made of labels, register moves, memory operands and branches,
+// followed by some data.
+static std::string makeAssemblyText() {
+  std::string Text;
+  for (unsigned F = 0; F != NumFunctions; ++F) {
+    std::string Name = "f" + std::to_string(F);
+    Text += "\t.section\t.text." + Name + ",\"ax\",@progbits\n"
+            "\t.globl\t" + Name + "\n"
+            "\t.p2align\t4, 0x90\n"
+            "\t.type\t" + Name + ",@function\n" +
+            Name + ":\n"
+            "\tpushq\t%rbp\n"
+            "\tmovq\t%rsp, %rbp\n";
+    for (unsigned B = 0; B != NumBlocks; ++B) {
+      std::string Label = ".L" + Name + "_" + std::to_string(B);
+      Text += Label + ":\n"
+              "\tmovl\t8(%rdi,%rsi,4), %eax\n"
+              "\taddl\t$12345, %eax\n"
+              "\timull\t%edx, %eax\n"
+              "\tmovl\t%eax, -4(%rbp)\n"
+              "\tcmpl\t$-42, %eax\n"
+              "\tjl\t" + Label + "\n";
+    }
+    Text += "\tpopq\t%rbp\n"
+            "\tretq\n"
+            ".Lfunc_end" + std::to_string(F) + ":\n"
+            "\t.size\t" + Name + ", .Lfunc_end" + std::to_string(F) + "-" +
+            Name + "\n";
+  }
+  Text += "\t.data\n"
+          "table:\n";
+  for (unsigned F = 0; F != NumFunctions; ++F)
+    Text += "\t.quad\tf" + std::to_string(F) + "\n"
+            "\t.long\t" + std::to_string(F) + "\n"
+            "\t.byte\t1, 2, 3, 4\n";
+  return Text;
+}
+
+static void BM_ParseX86Assembly(benchmark::State &State) {
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllAsmParsers();
+
+  std::string Error;
+  const Target *T = TargetRegistry::lookupTarget(TripleName, Error);
+  if (!T) {
+    State.SkipWithError("X86 target not available");
+    return;
+  }
+  std::unique_ptr<MCRegisterInfo> MRI(T->createMCRegInfo(TripleName));
+  std::unique_ptr<MCAsmInfo> MAI(T->createMCAsmInfo(*MRI, TripleName));
+  std::unique_ptr<MCInstrInfo> MII(T->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      T->createMCSubtargetInfo(TripleName, "", ""));
+  MCTargetOptions Options;
+
+  std::string Text = makeAssemblyText();
+  for (auto _ : State) {
+    SourceMgr SrcMgr;
+    SrcMgr.AddNewSourceBuffer(MemoryBuffer::getMemBuffer(Text), SMLoc());
+    MCObjectFileInfo MOFI;
+    MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+    MOFI.InitMCObjectFileInfo(Triple(TripleName), /*PIC=*/false, Ctx);
+    std::unique_ptr<MCStreamer> Str(createNullStreamer(Ctx));
+    std::unique_ptr<MCAsmParser> Parser(
+        createMCAsmParser(SrcMgr, Ctx, *Str, *MAI));
+    std::unique_ptr<MCTargetAsmParser> TAP(
+        T->createMCAsmParser(*STI, *Parser, *MII, Options));
+    Parser->setTargetParser(*TAP);
+    if (Parser->Run(/*NoInitialTextSection=*/false))
+      State.SkipWithError("invalid assembly");
+  }
+  State.SetBytesProcessed(State.iterations() * Text.size());
+}
+BENCHMARK(BM_ParseX86Assembly)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
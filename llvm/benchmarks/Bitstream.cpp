@@ -0,0 +1,98 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/Bitstream/BitstreamWriter.h"
+#include <memory>
+#include <random>
+
+using namespace llvm;
+
+enum { BlockID = 8, RecordCode = 1, NumRecords = 10000 };
+
+// A block of records shaped like bitcode instruction records: a handful of
+// small operands, either unabbreviated or with a VBR6 array abbreviation.
+static SmallVector<char, 0> makeStream(bool Abbreviate) {
+  std::mt19937 Rand;
+  SmallVector<char, 0> Buffer;
+  BitstreamWriter W(Buffer);
+  W.EnterSubblock(BlockID, 3);
+  unsigned Abbrev = 0;
+  if (Abbreviate) {
+    auto A = std::make_shared<BitCodeAbbrev>();
+    A->Add(BitCodeAbbrevOp(RecordCode));
+    A->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+    A->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+    Abbrev = W.EmitAbbrev(std::move(A));
+  }
+  SmallVector<uint64_t, 8> Vals;
+  for (unsigned I = 0; I != NumRecords; ++I) {
+    Vals.clear();
+    for (unsigned J = 0, E = 1 + Rand() % 6; J != E; ++J)
+      Vals.push_back(Rand() % 200);
+    W.EmitRecord(RecordCode, Vals, Abbrev);
+  }
+  W.ExitBlock();
+  return Buffer;
+}
+
+static void BM_BitstreamWrite(benchmark::State &State) {
+  for (auto _ : State)
+    benchmark::DoNotOptimize(makeStream(State.range(0)));
+  State.SetItemsProcessed(State.iterations() * NumRecords);
+}
+BENCHMARK(BM_BitstreamWrite)->Arg(0)->Arg(1);
+
+static void BM_BitstreamReadRecords(benchmark::State &State) {
+  SmallVector<char, 0> Buffer = makeStream(State.range(0));
+  StringRef Bytes(Buffer.data(), Buffer.size());
+  SmallVector<uint64_t, 8> Vals;
+  for (auto _ : State) {
+    BitstreamCursor Cursor(Bytes);
+    Error Err = Cursor.advance().takeError();
+    if (!Err)
+      Err = Cursor.EnterSubBlock(BlockID);
+    uint64_t Sum = 0;
+    while (!Err) {
+      Expected<BitstreamEntry> Entry = Cursor.advance();
+      if (!Entry) {
+        Err = Entry.takeError();
+        break;
+      }
+      if (Entry->Kind != BitstreamEntry::Record)
+        break;
+      Vals.clear();
+      Expected<unsigned> Code = Cursor.readRecord(Entry->ID, Vals);
+      if (!Code)
+        Err = Code.takeError();
+      Sum += Vals.size();
+    }
+    if (Err) {
+      consumeError(std::move(Err));
+      State.SkipWithError("malformed stream");
+      break;
+    }
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * NumRecords);
+}
+BENCHMARK(BM_BitstreamReadRecords)->Arg(0)->Arg(1);
+
+static void BM_BitstreamSkipBlock(benchmark::State &State) {
+  SmallVector<char, 0> Buffer = makeStream(true);
+  StringRef Bytes(Buffer.data(), Buffer.size());
+  for (auto _ : State) {
+    BitstreamCursor Cursor(Bytes);
+    Error Err = Cursor.advance().takeError();
+    if (!Err)
+      Err = Cursor.SkipBlock();
+    if (Err) {
+      consumeError(std::move(Err));
+      State.SkipWithError("malformed stream");
+      break;
+    }
+    benchmark::DoNotOptimize(Cursor.GetCurrentBitNo());
+  }
+}
+BENCHMARK(BM_BitstreamSkipBlock);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,121 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+// Integer keys, as used for instruction numbering and similar maps.
+static std::vector<unsigned> makeIntKeys(size_t N) {
+  std::mt19937 Rand;
+  std::vector<unsigned> Keys(N);
+  for (unsigned &K : Keys)
+    K = Rand() & 0x7fffffff;
+  return Keys;
+}
+
+// Identifier-like keys, as used for symbol names.
+static std::vector<std::string> makeStringKeys(size_t N) {
+  std::mt19937 Rand;
+  std::vector<std::string> Keys(N);
+  for (std::string &K : Keys)
+    K = "_ZN4llvm" + std::to_string(Rand()) + "Ev";
+  return Keys;
+}
+
+static void BM_DenseMapInsert(benchmark::State &State) {
+  std::vector<unsigned> Keys = makeIntKeys(State.range(0));
+  for (auto _ : State) {
+    DenseMap<unsigned, unsigned> M;
+    for (unsigned K : Keys)
+      M[K] = K;
+    benchmark::DoNotOptimize(M);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_DenseMapInsert)->Range(16, 1 << 18);
+
+static void BM_DenseMapLookup(benchmark::State &State) {
+  std::vector<unsigned> Keys = makeIntKeys(State.range(0));
+  DenseMap<unsigned, unsigned> M;
+  for (unsigned K : Keys)
+    M[K] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (unsigned K : Keys)
+      Sum += M.lookup(K);
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_DenseMapLookup)->Range(16, 1 << 18);
+
+static void BM_DenseMapIterate(benchmark::State &State) {
+  std::vector<unsigned> Keys = makeIntKeys(State.range(0));
+  DenseMap<unsigned, unsigned> M;
+  for (unsigned K : Keys)
+    M[K] = K;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (auto &KV : M)
+      Sum += KV.second;
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_DenseMapIterate)->Range(16, 1 << 18);
+
+static void BM_StringMapInsert(benchmark::State &State) {
+  std::vector<std::string> Keys = makeStringKeys(State.range(0));
+  for (auto _ : State) {
+    StringMap<unsigned> M;
+    for (const std::string &K : Keys)
+      M[K] = 0;
+    benchmark::DoNotOptimize(M);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_StringMapInsert)->Range(16, 1 << 18);
+
+static void BM_StringMapLookup(benchmark::State &State) {
+  std::vector<std::string> Keys = makeStringKeys(State.range(0));
+  StringMap<unsigned> M;
+  for (const std::string &K : Keys)
+    M[K] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (const std::string &K : Keys)
+      Sum += M.lookup(K);
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_StringMapLookup)->Range(16, 1 << 18);
+
+// The common pattern of building a short list in inline storage.
+static void BM_SmallVectorPushBack(benchmark::State &State) {
+  size_t N = State.range(0);
+  for (auto _ : State) {
+    SmallVector<unsigned, 8> V;
+    for (size_t I = 0; I != N; ++I)
+      V.push_back(I);
+    benchmark::DoNotOptimize(V.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_SmallVectorPushBack)->Arg(4)->Arg(8)->Arg(64)->Arg(4096);
+
+static void BM_SmallVectorCopy(benchmark::State &State) {
+  SmallVector<unsigned, 8> V(State.range(0), 1);
+  for (auto _ : State) {
+    SmallVector<unsigned, 8> Copy(V);
+    benchmark::DoNotOptimize(Copy.data());
+  }
+  State.SetItemsProcessed(State.iterations() * V.size());
+}
+BENCHMARK(BM_SmallVectorCopy)->Arg(4)->Arg(8)->Arg(64)->Arg(4096);
+
+BENCHMARK_MAIN();
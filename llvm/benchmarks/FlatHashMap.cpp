@@ -0,0 +1,66 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatHashMap.h"
+#include <random>
+#include <vector>
+
+// Pointer keys, as used by most of LLVM's DenseMaps.
+static std::vector<void *> makeKeys(size_t N) {
+  static std::vector<char> Storage(1 << 24);
+  std::mt19937 Rand;
+  std::vector<void *> Keys(N);
+  for (void *&K : Keys)
+    K = &Storage[(Rand() % (Storage.size() / 16)) * 16];
+  return Keys;
+}
+
+template <class MapT> static void BM_Insert(benchmark::State &State) {
+  std::vector<void *> Keys = makeKeys(State.range(0));
+  for (auto _ : State) {
+    MapT M;
+    for (void *K : Keys)
+      M[K] = 0;
+    benchmark::DoNotOptimize(M);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <class MapT> static void BM_FindHit(benchmark::State &State) {
+  std::vector<void *> Keys = makeKeys(State.range(0));
+  MapT M;
+  for (void *K : Keys)
+    M[K] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (void *K : Keys)
+      Sum += M.find(K)->second;
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <class MapT> static void BM_FindMiss(benchmark::State &State) {
+  std::vector<void *> Keys = makeKeys(State.range(0) * 2);
+  MapT M;
+  for (size_t I = 0; I < Keys.size() / 2; ++I)
+    M[Keys[I]] = 1;
+  for (auto _ : State) {
+    unsigned Count = 0;
+    for (size_t I = Keys.size() / 2; I < Keys.size(); ++I)
+      Count += M.count(Keys[I]);
+    benchmark::DoNotOptimize(Count);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size() / 2);
+}
+
+using DenseMapT = llvm::DenseMap<void *, unsigned>;
+using FlatHashMapT = llvm::FlatHashMap<void *, unsigned>;
+
+BENCHMARK_TEMPLATE(BM_Insert, DenseMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Insert, FlatHashMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindHit, DenseMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindHit, FlatHashMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindMiss, DenseMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindMiss, FlatHashMapT)->Range(64, 1 << 20);
+
+BENCHMARK_MAIN();
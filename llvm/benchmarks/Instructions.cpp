@@ -0,0 +1,106 @@
+#include "benchmark/benchmark.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+// A function "i32 (i32, i32)" with an empty entry block.
+struct TestFunction {
+  LLVMContext Ctx;
+  Module M{"bench", Ctx};
+  Function *F;
+  BasicBlock *BB;
+  Argument *A;
+  Argument *B;
+
+  TestFunction() {
+    Type *I32 = Type::getInt32Ty(Ctx);
+    F = Function::Create(FunctionType::get(I32, {I32, I32}, false),
+                         GlobalValue::ExternalLinkage, "f", M);
+    BB = BasicBlock::Create(Ctx, "entry", F);
+    A = F->getArg(0);
+    B = F->getArg(1);
+  }
+
+  // Append \p N adds that each use A twice.
+  void addUsers(unsigned N) {
+    for (unsigned I = 0; I != N; ++I)
+      BinaryOperator::CreateAdd(A, A, "", BB);
+  }
+};
+} // namespace
+
+static void BM_InstructionCreateErase(benchmark::State &State) {
+  TestFunction T;
+  size_t N = State.range(0);
+  std::vector<Instruction *> Insts(N);
+  for (auto _ : State) {
+    for (size_t I = 0; I != N; ++I)
+      Insts[I] = BinaryOperator::CreateAdd(T.A, T.B, "", T.BB);
+    for (size_t I = N; I != 0; --I)
+      Insts[I - 1]->eraseFromParent();
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_InstructionCreateErase)->Range(64, 1 << 16);
+
+// Named values also go through the symbol table of the function.
+static void BM_InstructionCreateEraseNamed(benchmark::State &State) {
+  TestFunction T;
+  size_t N = State.range(0);
+  std::vector<Instruction *> Insts(N);
+  for (auto _ : State) {
+    for (size_t I = 0; I != N; ++I)
+      Insts[I] = BinaryOperator::CreateAdd(T.A, T.B, "sum", T.BB);
+    for (size_t I = N; I != 0; --I)
+      Insts[I - 1]->eraseFromParent();
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_InstructionCreateEraseNamed)->Range(64, 1 << 16);
+
+static void BM_UseListWalk(benchmark::State &State) {
+  TestFunction T;
+  T.addUsers(State.range(0));
+  for (auto _ : State) {
+    unsigned Count = 0;
+    for (User *U : T.A->users())
+      Count += isa<BinaryOperator>(U);
+    benchmark::DoNotOptimize(Count);
+  }
+  State.SetItemsProcessed(State.iterations() * 2 * State.range(0));
+}
+BENCHMARK(BM_UseListWalk)->Range(64, 1 << 16);
+
+static void BM_ReplaceAllUsesWith(benchmark::State &State) {
+  TestFunction T;
+  T.addUsers(State.range(0));
+  for (auto _ : State) {
+    T.A->replaceAllUsesWith(T.B);
+    T.B->replaceAllUsesWith(T.A);
+  }
+  State.SetItemsProcessed(State.iterations() * 4 * State.range(0));
+}
+BENCHMARK(BM_ReplaceAllUsesWith)->Range(64, 1 << 16);
+
+static void BM_InstructionIterate(benchmark::State &State) {
+  TestFunction T;
+  T.addUsers(State.range(0));
+  for (auto _ : State) {
+    unsigned Count = 0;
+    for (Instruction &I : *T.BB)
+      Count += I.getNumOperands();
+    benchmark::DoNotOptimize(Count);
+  }
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+BENCHMARK(BM_InstructionIterate)->Range(64, 1 << 16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+// Each benchmark writes 1000 items into a reused buffer, like the printers
+// of the assembly writer.
+static const unsigned NumItems = 1000;
+
+static void BM_RawOStreamStrings(benchmark::State &State) {
+  SmallString<16384> Buf;
+  for (auto _ : State) {
+    Buf.clear();
+    raw_svector_ostream OS(Buf);
+    for (unsigned I = 0; I != NumItems; ++I)
+      OS << "  %" << "call" << " = ";
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  State.SetItemsProcessed(State.iterations() * NumItems);
+}
+BENCHMARK(BM_RawOStreamStrings);
+
+static void BM_RawOStreamIntegers(benchmark::State &State) {
+  SmallString<16384> Buf;
+  for (auto _ : State) {
+    Buf.clear();
+    raw_svector_ostream OS(Buf);
+    for (unsigned I = 0; I != NumItems; ++I)
+      OS << I * 7919u << ' ' << -int64_t(I) << '\n';
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  State.SetItemsProcessed(State.iterations() * NumItems);
+}
+BENCHMARK(BM_RawOStreamIntegers);
+
+static void BM_RawOStreamHex(benchmark::State &State) {
+  SmallString<16384> Buf;
+  for (auto _ : State) {
+    Buf.clear();
+    raw_svector_ostream OS(Buf);
+    for (unsigned I = 0; I != NumItems; ++I)
+      OS << format_hex(I * 0x9e3779b9u, 10) << '\n';
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  State.SetItemsProcessed(State.iterations() * NumItems);
+}
+BENCHMARK(BM_RawOStreamHex);
+
+static void BM_RawOStreamFormat(benchmark::State &State) {
+  const char *Name = "symbol";
+  SmallString<32768> Buf;
+  for (auto _ : State) {
+    Buf.clear();
+    raw_svector_ostream OS(Buf);
+    for (unsigned I = 0; I != NumItems; ++I)
+      OS << format("%-10s %8u %6.2f\n", Name, I, I / 3.0);
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  State.SetItemsProcessed(State.iterations() * NumItems);
+}
+BENCHMARK(BM_RawOStreamFormat);
+
+static void BM_RawOStreamFormatv(benchmark::State &State) {
+  SmallString<32768> Buf;
+  for (auto _ : State) {
+    Buf.clear();
+    raw_svector_ostream OS(Buf);
+    for (unsigned I = 0; I != NumItems; ++I)
+      OS << formatv("{0,-10} {1,8} {2:x}\n", "symbol", I, I);
+    benchmark::DoNotOptimize(Buf.data());
+  }
+  State.SetItemsProcessed(State.iterations() * NumItems);
+}
+BENCHMARK(BM_RawOStreamFormatv);
+
+// raw_string_ostream flushes its buffer into a growing std::string, whereas
+// raw_svector_ostream writes straight into the vector.
+static void BM_RawStringOStream(benchmark::State &State) {
+  for (auto _ : State) {
+    std::string S;
+    raw_string_ostream OS(S);
+    for (unsigned I = 0; I != NumItems; ++I)
+      OS << "value " << I << '\n';
+    OS.flush();
+    benchmark::DoNotOptimize(S.data());
+  }
+  State.SetItemsProcessed(State.iterations() * NumItems);
+}
+BENCHMARK(BM_RawStringOStream);
+
+BENCHMARK_MAIN();
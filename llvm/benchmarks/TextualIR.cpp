@@ -0,0 +1,85 @@
+#include "benchmark/benchmark.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+using namespace llvm;
+
+enum { NumFunctions = 200, NumBlocks = 20 };
+
+// A module shaped like optimized code: many functions of straight-line
+// integer arithmetic, loads and stores, calls and branches between blocks.
+static std::string makeModuleText() {
+  std::string Text = "declare i32 @ext(i32, i32*)\n";
+  for (unsigned F = 0; F != NumFunctions; ++F) {
+    Text += "define i32 @f" + std::to_string(F) + "(i32 %a, i32* %p) {\n"
+            "entry:\n"
+            "  br label %bb0\n";
+    for (unsigned B = 0; B != NumBlocks; ++B) {
+      std::string N = std::to_string(B);
+      std::string Next =
+          B + 1 == NumBlocks ? "exit" : "bb" + std::to_string(B + 1);
+      Text += "bb" + N + ":\n"
+              "  %x" + N + " = load i32, i32* %p, align 4\n"
+              "  %y" + N + " = add nsw i32 %x" + N + ", 12345\n"
+              "  %z" + N + " = mul i32 %y" + N + ", %a\n"
+              "  %g" + N + " = getelementptr inbounds i32, i32* %p, i64 " +
+              N + "\n"
+              "  store i32 %z" + N + ", i32* %g" + N + ", align 4\n"
+              "  %c" + N + " = call i32 @ext(i32 %z" + N + ", i32* %g" + N +
+              ")\n"
+              "  %t" + N + " = icmp slt i32 %c" + N + ", -42\n"
+              "  br i1 %t" + N + ", label %" + Next + ", label %exit\n";
+    }
+    Text += "exit:\n"
+            "  ret i32 0\n"
+            "}\n";
+  }
+  return Text;
+}
+
+static void BM_ParseAssembly(benchmark::State &State) {
+  std::string Text = makeModuleText();
+  for (auto _ : State) {
+    LLVMContext Ctx;
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseAssemblyString(Text, Err, Ctx);
+    if (!M)
+      State.SkipWithError("invalid assembly");
+    benchmark::DoNotOptimize(M.get());
+  }
+  State.SetBytesProcessed(State.iterations() * Text.size());
+}
+BENCHMARK(BM_ParseAssembly)->Unit(benchmark::kMillisecond);
+
+// Argument: whether to print functions on multiple threads.
+static void BM_PrintModule(benchmark::State &State) {
+  std::string Text = makeModuleText();
+  LLVMContext Ctx;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(Text, Err, Ctx);
+  if (!M) {
+    State.SkipWithError("invalid assembly");
+    return;
+  }
+
+  auto *Parallel = static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["asm-writer-parallel-functions"]);
+  Parallel->setValue(State.range(0));
+  size_t Bytes = 0;
+  for (auto _ : State) {
+    std::string Out;
+    raw_string_ostream OS(Out);
+    M->print(OS, nullptr);
+    Bytes += OS.str().size();
+  }
+  Parallel->setValue(false);
+  State.SetBytesProcessed(Bytes);
+}
+BENCHMARK(BM_PrintModule)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+#include "benchmark/benchmark.h"
+#include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+// A record shaped like an optimization remark.
+struct Entry {
+  std::string Pass;
+  std::string Name;
+  StringRef Function;
+  unsigned Line;
+  unsigned Column;
+  std::vector<StringRef> Args;
+};
+} // end anonymous namespace
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(Entry)
+
+namespace llvm {
+namespace yaml {
+template <> struct MappingTraits<Entry> {
+  static void mapping(IO &IO, Entry &E) {
+    IO.mapRequired("Pass", E.Pass);
+    IO.mapRequired("Name", E.Name);
+    IO.mapRequired("Function", E.Function);
+    IO.mapRequired("Line", E.Line);
+    IO.mapRequired("Column", E.Column);
+    IO.mapOptional("Args", E.Args);
+  }
+};
+} // end namespace yaml
+} // end namespace llvm
+
+enum { NumEntries = 10000 };
+
+static std::string makeDocument() {
+  std::string Buffer;
+  raw_string_ostream OS(Buffer);
+  for (unsigned I = 0; I != NumEntries; ++I) {
+    OS << "- Pass:            inline\n"
+       << "  Name:            NotInlined\n"
+       << "  Function:        '_ZN4llvm3foo" << I << "Ev'\n"
+       << "  Line:            " << I % 1000 << "\n"
+       << "  Column:          " << I % 80 << "\n"
+       << "  Args:            [ callee, \"_ZN4llvm3bar" << I
+       << "Ev\", 'will not be inlined' ]\n";
+  }
+  return OS.str();
+}
+
+// Only scan and parse the nodes, as the remark parser does.
+static void BM_YAMLParseNodes(benchmark::State &State) {
+  std::string Document = makeDocument();
+  for (auto _ : State) {
+    SourceMgr SM;
+    yaml::Stream Stream(Document, SM);
+    for (yaml::Document &D : Stream)
+      D.skip();
+  }
+  State.SetBytesProcessed(State.iterations() * Document.size());
+}
+BENCHMARK(BM_YAMLParseNodes);
+
+static void BM_YAMLInputMapping(benchmark::State &State) {
+  std::string Document = makeDocument();
+  for (auto _ : State) {
+    std::vector<Entry> Entries;
+    yaml::Input YIn(Document);
+    YIn >> Entries;
+    benchmark::DoNotOptimize(Entries.data());
+  }
+  State.SetBytesProcessed(State.iterations() * Document.size());
+}
+BENCHMARK(BM_YAMLInputMapping);
+
+BENCHMARK_MAIN();
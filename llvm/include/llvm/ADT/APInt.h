@@ -87,11 +87,19 @@ public:
   static const WordType WORDTYPE_MAX = ~WordType(0);
 
 private:
-  /// This union is used to store the integer value. When the
-  /// integer bit-width <= 64, it uses VAL, otherwise it uses pVal.
+  enum : unsigned {
+    /// Values of up to this many words are stored inline.
+    NumInlineWords = 2
+  };
+
+  /// This union is used to store the integer value. When the integer
+  /// bit-width <= 64, it uses VAL, when it is <= 128, Words, and otherwise
+  /// pVal. Keeping 128-bit values inline means that arithmetic on i128 does
+  /// not allocate.
   union {
     uint64_t VAL;   ///< Used to store the <= 64 bits integer value.
-    uint64_t *pVal; ///< Used to store the >64 bits integer value.
+    uint64_t Words[NumInlineWords]; ///< Used to store the <= 128 bits value.
+    uint64_t *pVal; ///< Used to store the >128 bits integer value.
   } U;
 
   unsigned BitWidth; ///< The number of bits in this APInt.
@@ -108,11 +116,44 @@ private:
     U.pVal = val;
   }
 
+  /// Return an APInt of width \p numBits whose value is not initialized.
+  static APInt getUninitialized(unsigned numBits) {
+    APInt Result(nullptr, numBits);
+    Result.allocateWords();
+    return Result;
+  }
+
   /// Determine if this APInt just has one word to store value.
   ///
   /// \returns true if the number of bits <= 64, false otherwise.
   bool isSingleWord() const { return BitWidth <= APINT_BITS_PER_WORD; }
 
+  /// Determine if the words of this APInt are on the heap.
+  ///
+  /// \returns true if the number of bits > 128, false otherwise.
+  bool isHeapAllocated() const {
+    return BitWidth > NumInlineWords * APINT_BITS_PER_WORD;
+  }
+
+  /// Point pVal at new, uninitialized memory if the value is too wide to be
+  /// stored inline.
+  void allocateWords() {
+    if (isHeapAllocated())
+      U.pVal = new uint64_t[getNumWords()];
+  }
+
+  /// Like allocateWords, but also set the value to zero.
+  void allocateClearedWords() {
+    allocateWords();
+    memset(getWords(), 0, getNumWords() * APINT_WORD_SIZE);
+  }
+
+  /// Return the words of the value, wherever they are stored.
+  uint64_t *getWords() { return isHeapAllocated() ? U.pVal : U.Words; }
+  const uint64_t *getWords() const {
+    return isHeapAllocated() ? U.pVal : U.Words;
+  }
+
   /// Determine which word a bit is in.
   ///
   /// \returns the word position for the specified bit position.
@@ -153,14 +194,14 @@ private:
     if (isSingleWord())
       U.VAL &= mask;
     else
-      U.pVal[getNumWords() - 1] &= mask;
+      getWords()[getNumWords() - 1] &= mask;
     return *this;
   }
 
   /// Get the word corresponding to a bit position
   /// \returns the corresponding word for the specified bit position.
   uint64_t getWord(unsigned bitPosition) const {
-    return isSingleWord() ? U.VAL : U.pVal[whichWord(bitPosition)];
+    return isSingleWord() ? U.VAL : getWords()[whichWord(bitPosition)];
   }
 
   /// Utility method to change the bit width of this APInt to new bit width,
@@ -319,10 +360,14 @@ public:
   /// Simply makes *this a copy of that.
   /// Copy Constructor.
   APInt(const APInt &that) : BitWidth(that.BitWidth) {
-    if (isSingleWord())
+    if (isSingleWord()) {
       U.VAL = that.U.VAL;
-    else
+    } else if (!isHeapAllocated()) {
+      U.Words[0] = that.U.Words[0];
+      U.Words[1] = that.U.Words[1];
+    } else {
       initSlowCase(that);
+    }
   }
 
   /// Move Constructor.
@@ -345,7 +390,7 @@ public:
   explicit APInt() : BitWidth(1) { U.VAL = 0; }
 
   /// Returns whether this instance allocated memory.
-  bool needsCleanup() const { return !isSingleWord(); }
+  bool needsCleanup() const { return isHeapAllocated(); }
 
   /// Used to insert APInt objects, or objects that contain APInt objects, into
   ///  FoldingSets.
@@ -674,7 +719,7 @@ public:
   const uint64_t *getRawData() const {
     if (isSingleWord())
       return &U.VAL;
-    return &U.pVal[0];
+    return getWords();
   }
 
   /// @}
@@ -751,7 +796,7 @@ public:
       return *this;
 #endif
     assert(this != &that && "Self-move not supported");
-    if (!isSingleWord())
+    if (needsCleanup())
       delete[] U.pVal;
 
     // Use memcpy so that type based alias analysis sees both VAL and pVal
@@ -776,8 +821,8 @@ public:
       U.VAL = RHS;
       clearUnusedBits();
     } else {
-      U.pVal[0] = RHS;
-      memset(U.pVal+1, 0, (getNumWords() - 1) * APINT_WORD_SIZE);
+      getWords()[0] = RHS;
+      memset(getWords()+1, 0, (getNumWords() - 1) * APINT_WORD_SIZE);
     }
     return *this;
   }
@@ -807,8 +852,8 @@ public:
       U.VAL &= RHS;
       return *this;
     }
-    U.pVal[0] &= RHS;
-    memset(U.pVal+1, 0, (getNumWords() - 1) * APINT_WORD_SIZE);
+    getWords()[0] &= RHS;
+    memset(getWords()+1, 0, (getNumWords() - 1) * APINT_WORD_SIZE);
     return *this;
   }
 
@@ -837,7 +882,7 @@ public:
       U.VAL |= RHS;
       clearUnusedBits();
     } else {
-      U.pVal[0] |= RHS;
+      getWords()[0] |= RHS;
     }
     return *this;
   }
@@ -867,7 +912,7 @@ public:
       U.VAL ^= RHS;
       clearUnusedBits();
     } else {
-      U.pVal[0] ^= RHS;
+      getWords()[0] ^= RHS;
     }
     return *this;
   }
@@ -1391,7 +1436,7 @@ public:
       U.VAL = WORDTYPE_MAX;
     else
       // Set all the bits in all the words.
-      memset(U.pVal, -1, getNumWords() * APINT_WORD_SIZE);
+      memset(getWords(), -1, getNumWords() * APINT_WORD_SIZE);
     // Clear the unused ones
     clearUnusedBits();
   }
@@ -1405,7 +1450,7 @@ public:
     if (isSingleWord())
       U.VAL |= Mask;
     else
-      U.pVal[whichWord(BitPosition)] |= Mask;
+      getWords()[whichWord(BitPosition)] |= Mask;
   }
 
   /// Set the sign bit to 1.
@@ -1426,7 +1471,7 @@ public:
       if (isSingleWord())
         U.VAL |= mask;
       else
-        U.pVal[0] |= mask;
+        getWords()[0] |= mask;
     } else {
       setBitsSlowCase(loBit, hiBit);
     }
@@ -1452,7 +1497,7 @@ public:
     if (isSingleWord())
       U.VAL = 0;
     else
-      memset(U.pVal, 0, getNumWords() * APINT_WORD_SIZE);
+      memset(getWords(), 0, getNumWords() * APINT_WORD_SIZE);
   }
 
   /// Set a given bit to 0.
@@ -1464,7 +1509,7 @@ public:
     if (isSingleWord())
       U.VAL &= Mask;
     else
-      U.pVal[whichWord(BitPosition)] &= Mask;
+      getWords()[whichWord(BitPosition)] &= Mask;
   }
 
   /// Set bottom loBits bits to 0.
@@ -1570,7 +1615,7 @@ public:
     if (isSingleWord())
       return U.VAL;
     assert(getActiveBits() <= 64 && "Too many bits for uint64_t");
-    return U.pVal[0];
+    return getWords()[0];
   }
 
   /// Get sign extended value
@@ -1582,7 +1627,7 @@ public:
     if (isSingleWord())
       return SignExtend64(U.VAL, BitWidth);
     assert(getMinSignedBits() <= 64 && "Too many bits for int64_t");
-    return int64_t(U.pVal[0]);
+    return int64_t(getWords()[0]);
   }
 
   /// Get bits required for string value.
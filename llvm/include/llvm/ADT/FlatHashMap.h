@@ -0,0 +1,598 @@
+//===- llvm/ADT/FlatHashMap.h - Group probed hash table ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the FlatHashMap class, an open addressing hash table in
+// the style of Abseil's "Swiss tables".
+//
+// Like DenseMap, elements are stored inline in a single array of buckets and
+// hashed with DenseMapInfo. Unlike DenseMap, every bucket has a separate
+// control byte that says whether the bucket is empty, deleted, or full, and
+// for full buckets holds 7 bits of the hash. Lookups compare the control bytes
+// of a whole group of buckets at once (16 with SSE2, 8 with portable 64-bit
+// arithmetic otherwise) and only compare keys whose hash bits match. As a
+// consequence, the key type needs no empty or tombstone key; only
+// getHashValue() and isEqual() of the DenseMapInfo are used.
+//
+// FlatHashMap provides the commonly used subset of the DenseMap interface,
+// so most clients can switch between the two by changing the type.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATHASHMAP_H
+#define LLVM_ADT_FLATHASHMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LLVM_FLATHASHMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// Control byte values. Full buckets store the 7 hash bits, which are
+/// non-negative.
+enum FlatHashCtrl : int8_t { FlatHashEmpty = -128, FlatHashDeleted = -2 };
+
+/// The set of buckets of a group that match some condition.
+class FlatHashBitMask {
+  uint64_t Mask;
+  unsigned Shift;
+
+public:
+  FlatHashBitMask(uint64_t Mask, unsigned Shift) : Mask(Mask), Shift(Shift) {}
+
+  explicit operator bool() const { return Mask != 0; }
+
+  unsigned lowest() const { return countTrailingZeros(Mask) >> Shift; }
+
+  void clearLowest() { Mask &= Mask - 1; }
+};
+
+#ifdef LLVM_FLATHASHMAP_SSE2
+/// A group of 16 control bytes, compared with SSE2.
+class FlatHashGroup {
+  __m128i Ctrl;
+
+public:
+  static constexpr unsigned Width = 16;
+
+  explicit FlatHashGroup(const int8_t *P)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(P))) {}
+
+  FlatHashBitMask match(int8_t H2) const {
+    return FlatHashBitMask(
+        static_cast<uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl))),
+        0);
+  }
+
+  FlatHashBitMask matchEmpty() const { return match(FlatHashEmpty); }
+
+  // Empty and deleted are the only negative control bytes.
+  FlatHashBitMask matchEmptyOrDeleted() const {
+    return FlatHashBitMask(static_cast<uint16_t>(_mm_movemask_epi8(Ctrl)), 0);
+  }
+};
+#else
+/// A group of 8 control bytes, compared with 64-bit integer arithmetic.
+class FlatHashGroup {
+  uint64_t Ctrl;
+
+  static constexpr uint64_t LSBs = 0x0101010101010101ULL;
+  static constexpr uint64_t MSBs = 0x8080808080808080ULL;
+
+public:
+  static constexpr unsigned Width = 8;
+
+  explicit FlatHashGroup(const int8_t *P)
+      : Ctrl(support::endian::read64le(P)) {}
+
+  // This may report a false positive for a byte that follows a real match.
+  // That is harmless because matching buckets have their keys compared.
+  FlatHashBitMask match(int8_t H2) const {
+    uint64_t X = Ctrl ^ (LSBs * static_cast<uint8_t>(H2));
+    return FlatHashBitMask((X - LSBs) & ~X & MSBs, 3);
+  }
+
+  // Empty is the only value with the high bit set and bit 1 clear.
+  FlatHashBitMask matchEmpty() const {
+    return FlatHashBitMask(Ctrl & ~(Ctrl << 6) & MSBs, 3);
+  }
+
+  // Empty and deleted are the only values with the high bit set.
+  FlatHashBitMask matchEmptyOrDeleted() const {
+    return FlatHashBitMask(Ctrl & MSBs, 3);
+  }
+};
+#endif
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class FlatHashMapIterator;
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = detail::DenseMapPair<KeyT, ValueT>>
+class FlatHashMap {
+  using Group = detail::FlatHashGroup;
+  static constexpr unsigned GroupWidth = Group::Width;
+
+  /// Control bytes. There are NumBuckets + GroupWidth of them; the last
+  /// GroupWidth bytes mirror the first ones so that a group can be loaded
+  /// starting at any bucket without wrapping around.
+  int8_t *Ctrl = nullptr;
+  BucketT *Buckets = nullptr;
+  unsigned NumBuckets = 0;
+  unsigned NumEntries = 0;
+  /// The number of empty buckets that may still be filled before the table
+  /// has to be rehashed.
+  unsigned GrowthLeft = 0;
+
+public:
+  using size_type = unsigned;
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = BucketT;
+
+  using iterator =
+      detail::FlatHashMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+  using const_iterator =
+      detail::FlatHashMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+
+  /// Create a FlatHashMap that can hold \p InitialReserve entries without
+  /// growing.
+  explicit FlatHashMap(unsigned InitialReserve = 0) { reserve(InitialReserve); }
+
+  FlatHashMap(const FlatHashMap &Other) { copyFrom(Other); }
+
+  FlatHashMap(FlatHashMap &&Other) { swap(Other); }
+
+  template <typename InputIt> FlatHashMap(const InputIt &I, const InputIt &E) {
+    reserve(std::distance(I, E));
+    insert(I, E);
+  }
+
+  FlatHashMap(std::initializer_list<BucketT> Vals) {
+    reserve(Vals.size());
+    insert(Vals.begin(), Vals.end());
+  }
+
+  ~FlatHashMap() { destroyAll(); }
+
+  FlatHashMap &operator=(const FlatHashMap &Other) {
+    if (&Other != this) {
+      destroyAll();
+      init();
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  FlatHashMap &operator=(FlatHashMap &&Other) {
+    destroyAll();
+    init();
+    swap(Other);
+    return *this;
+  }
+
+  void swap(FlatHashMap &RHS) {
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  inline iterator begin() { return iterator(Ctrl, Buckets, Ctrl + NumBuckets); }
+  inline iterator end() {
+    return iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                    Ctrl + NumBuckets);
+  }
+  inline const_iterator begin() const {
+    return const_iterator(Ctrl, Buckets, Ctrl + NumBuckets);
+  }
+  inline const_iterator end() const {
+    return const_iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                          Ctrl + NumBuckets);
+  }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can hold \p Size entries without growing
+  /// again.
+  void reserve(size_type Size) {
+    if (Size > maxEntriesFor(NumBuckets))
+      rehash(bucketsFor(Size));
+  }
+
+  void clear() {
+    if (NumEntries == 0 && GrowthLeft == maxEntriesFor(NumBuckets))
+      return;
+    destroyBuckets();
+    if (NumBuckets)
+      std::memset(Ctrl, detail::FlatHashEmpty, NumBuckets + GroupWidth);
+    NumEntries = 0;
+    GrowthLeft = maxEntriesFor(NumBuckets);
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const KeyT &Val) const { return findIndex(Val) != ~0U; }
+
+  iterator find(const KeyT &Val) {
+    unsigned I = findIndex(Val);
+    if (I == ~0U)
+      return end();
+    return iterator(Ctrl + I, Buckets + I, Ctrl + NumBuckets);
+  }
+  const_iterator find(const KeyT &Val) const {
+    unsigned I = findIndex(Val);
+    if (I == ~0U)
+      return end();
+    return const_iterator(Ctrl + I, Buckets + I, Ctrl + NumBuckets);
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    unsigned I = findIndex(Val);
+    if (I == ~0U)
+      return ValueT();
+    return Buckets[I].getSecond();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  /// insert - Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    std::pair<unsigned, bool> R = findOrPrepareInsert(Key);
+    BucketT *B = Buckets + R.first;
+    if (R.second) {
+      ::new (&B->getFirst()) KeyT(std::move(Key));
+      ::new (&B->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    }
+    return std::make_pair(iterator(Ctrl + R.first, B, Ctrl + NumBuckets),
+                          R.second);
+  }
+
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    std::pair<unsigned, bool> R = findOrPrepareInsert(Key);
+    BucketT *B = Buckets + R.first;
+    if (R.second) {
+      ::new (&B->getFirst()) KeyT(Key);
+      ::new (&B->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    }
+    return std::make_pair(iterator(Ctrl + R.first, B, Ctrl + NumBuckets),
+                          R.second);
+  }
+
+  ValueT &operator[](const KeyT &Key) { return try_emplace(Key).first->second; }
+
+  ValueT &operator[](KeyT &&Key) {
+    return try_emplace(std::move(Key)).first->second;
+  }
+
+  bool erase(const KeyT &Val) {
+    unsigned I = findIndex(Val);
+    if (I == ~0U)
+      return false;
+    eraseIndex(I);
+    return true;
+  }
+
+  void erase(iterator I) { eraseIndex(I.Bucket - Buckets); }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by FlatHashMap.
+  size_t getMemorySize() const {
+    if (!NumBuckets)
+      return 0;
+    return NumBuckets * sizeof(BucketT) + NumBuckets + GroupWidth;
+  }
+
+private:
+  // Up to 7/8 of the buckets may be full, which guarantees that every probe
+  // sequence finds an empty bucket.
+  static unsigned maxEntriesFor(unsigned Buckets) {
+    return Buckets - Buckets / 8;
+  }
+
+  static unsigned bucketsFor(unsigned Entries) {
+    if (Entries == 0)
+      return 0;
+    return std::max<unsigned>(GroupWidth,
+                              NextPowerOf2(Entries * 8 / 7 + 1));
+  }
+
+  /// Split the hash into the position of the first group to probe and the
+  /// 7 bits stored in the control byte. DenseMapInfo hashes are often weak
+  /// in their low bits, so mix them first.
+  static void splitHash(unsigned Hash, size_t &H1, int8_t &H2) {
+    uint64_t H = uint64_t(Hash) * 0x9E3779B97F4A7C15ULL;
+    H1 = H >> 32;
+    H2 = (H >> 25) & 0x7F;
+  }
+
+  void setCtrl(unsigned I, int8_t C) {
+    Ctrl[I] = C;
+    if (I < GroupWidth)
+      Ctrl[NumBuckets + I] = C;
+  }
+
+  unsigned findIndex(const KeyT &Val) const {
+    if (NumBuckets == 0)
+      return ~0U;
+    size_t H1;
+    int8_t H2;
+    splitHash(KeyInfoT::getHashValue(Val), H1, H2);
+    unsigned Mask = NumBuckets - 1;
+    size_t Pos = H1 & Mask;
+    for (unsigned Step = GroupWidth;; Step += GroupWidth) {
+      Group G(Ctrl + Pos);
+      for (detail::FlatHashBitMask M = G.match(H2); M; M.clearLowest()) {
+        unsigned I = (Pos + M.lowest()) & Mask;
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[I].getFirst())))
+          return I;
+      }
+      if (G.matchEmpty())
+        return ~0U;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Return the first empty or deleted bucket in the probe sequence of H1.
+  unsigned findFirstNonFull(size_t H1) const {
+    unsigned Mask = NumBuckets - 1;
+    size_t Pos = H1 & Mask;
+    for (unsigned Step = GroupWidth;; Step += GroupWidth) {
+      detail::FlatHashBitMask M = Group(Ctrl + Pos).matchEmptyOrDeleted();
+      if (M)
+        return (Pos + M.lowest()) & Mask;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Return the index of the bucket holding \p Key and false, or the index of
+  /// a bucket that was reserved for it and true. The caller must construct
+  /// the key and value of a reserved bucket.
+  std::pair<unsigned, bool> findOrPrepareInsert(const KeyT &Key) {
+    unsigned I = findIndex(Key);
+    if (I != ~0U)
+      return std::make_pair(I, false);
+
+    size_t H1;
+    int8_t H2;
+    splitHash(KeyInfoT::getHashValue(Key), H1, H2);
+    if (NumBuckets)
+      I = findFirstNonFull(H1);
+    if (NumBuckets == 0 ||
+        (GrowthLeft == 0 && Ctrl[I] == detail::FlatHashEmpty)) {
+      // Drop deleted buckets if that frees enough space, otherwise grow.
+      if (NumEntries * 2 < maxEntriesFor(NumBuckets))
+        rehash(NumBuckets);
+      else
+        rehash(std::max<unsigned>(GroupWidth, NumBuckets * 2));
+      I = findFirstNonFull(H1);
+    }
+
+    if (Ctrl[I] == detail::FlatHashEmpty)
+      --GrowthLeft;
+    ++NumEntries;
+    setCtrl(I, H2);
+    return std::make_pair(I, true);
+  }
+
+  void eraseIndex(unsigned I) {
+    assert(Ctrl[I] >= 0 && "Erasing an empty bucket");
+    Buckets[I].getSecond().~ValueT();
+    Buckets[I].getFirst().~KeyT();
+    --NumEntries;
+    // Lookups of other keys may have probed past this bucket, so it cannot
+    // become empty again. Deleted buckets are reused by insertions and
+    // dropped when the table is rehashed.
+    setCtrl(I, detail::FlatHashDeleted);
+  }
+
+  void rehash(unsigned NewNumBuckets) {
+    int8_t *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+
+    allocate(NewNumBuckets);
+    if (!OldCtrl)
+      return;
+
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &B = OldBuckets[I];
+      size_t H1;
+      int8_t H2;
+      splitHash(KeyInfoT::getHashValue(B.getFirst()), H1, H2);
+      unsigned J = findFirstNonFull(H1);
+      setCtrl(J, H2);
+      ::new (&Buckets[J].getFirst()) KeyT(std::move(B.getFirst()));
+      ::new (&Buckets[J].getSecond()) ValueT(std::move(B.getSecond()));
+      B.getSecond().~ValueT();
+      B.getFirst().~KeyT();
+      ++NumEntries;
+      --GrowthLeft;
+    }
+    operator delete(OldCtrl);
+    operator delete(OldBuckets);
+  }
+
+  void allocate(unsigned N) {
+    NumBuckets = N;
+    NumEntries = 0;
+    GrowthLeft = maxEntriesFor(N);
+    if (N == 0) {
+      Ctrl = nullptr;
+      Buckets = nullptr;
+      return;
+    }
+    assert(isPowerOf2_32(N) && N >= GroupWidth);
+    Ctrl = static_cast<int8_t *>(operator new(N + GroupWidth));
+    std::memset(Ctrl, detail::FlatHashEmpty, N + GroupWidth);
+    Buckets = static_cast<BucketT *>(operator new(sizeof(BucketT) * N));
+  }
+
+  void init() {
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumBuckets = NumEntries = GrowthLeft = 0;
+  }
+
+  void destroyBuckets() {
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] >= 0) {
+        Buckets[I].getSecond().~ValueT();
+        Buckets[I].getFirst().~KeyT();
+      }
+    }
+  }
+
+  void destroyAll() {
+    if (!NumBuckets)
+      return;
+    destroyBuckets();
+    operator delete(Ctrl);
+    operator delete(Buckets);
+  }
+
+  void copyFrom(const FlatHashMap &Other) {
+    allocate(Other.NumBuckets);
+    if (!NumBuckets)
+      return;
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets + GroupWidth);
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] >= 0) {
+        ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+        ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+      }
+    }
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+};
+
+namespace detail {
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class FlatHashMapIterator {
+  friend class FlatHashMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+  friend class FlatHashMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+  friend class FlatHashMap<KeyT, ValueT, KeyInfoT, BucketT>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type =
+      typename std::conditional<IsConst, const BucketT, BucketT>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  const int8_t *Ctrl = nullptr;
+  pointer Bucket = nullptr;
+  const int8_t *End = nullptr;
+
+public:
+  FlatHashMapIterator() = default;
+
+  FlatHashMapIterator(const int8_t *Ctrl, pointer Bucket, const int8_t *End)
+      : Ctrl(Ctrl), Bucket(Bucket), End(End) {
+    skipNonFull();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  FlatHashMapIterator(
+      const FlatHashMapIterator<KeyT, ValueT, KeyInfoT, BucketT, IsConstSrc> &I)
+      : Ctrl(I.Ctrl), Bucket(I.Bucket), End(I.End) {}
+
+  reference operator*() const { return *Bucket; }
+  pointer operator->() const { return Bucket; }
+
+  friend bool operator==(const FlatHashMapIterator &LHS,
+                         const FlatHashMapIterator &RHS) {
+    return LHS.Bucket == RHS.Bucket;
+  }
+  friend bool operator!=(const FlatHashMapIterator &LHS,
+                         const FlatHashMapIterator &RHS) {
+    return LHS.Bucket != RHS.Bucket;
+  }
+
+  inline FlatHashMapIterator &operator++() { // Preincrement
+    ++Ctrl;
+    ++Bucket;
+    skipNonFull();
+    return *this;
+  }
+  FlatHashMapIterator operator++(int) { // Postincrement
+    FlatHashMapIterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+
+private:
+  void skipNonFull() {
+    while (Ctrl != End && *Ctrl < 0) {
+      ++Ctrl;
+      ++Bucket;
+    }
+  }
+};
+
+} // end namespace detail
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_FLATHASHMAP_H
@@ -0,0 +1,452 @@
+//===--- ImmutableHashMap.h - Immutable hash array mapped trie --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ImmutableHashMap class, an immutable (functional) map
+// implemented as a hash array mapped trie.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_IMMUTABLEHASHMAP_H
+#define LLVM_ADT_IMMUTABLEHASHMAP_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/ImmutableMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace llvm {
+
+/// A node of an ImmutableHashMap.
+///
+/// A leaf holds the entries whose keys share a single hash, sorted by key.
+/// An inner node has a child for each value of the next 5 bits of the hash
+/// that one of its keys has. Nodes are uniqued by their factory, and the shape
+/// of the trie only depends on its entries, so equal maps share their root.
+template <typename ValInfo> class ImutHAMTNode : public FoldingSetNode {
+public:
+  using entry_type = typename std::remove_const<
+      typename ValInfo::value_type>::type;
+
+  bool isLeaf() const { return IsLeaf; }
+
+  /// The number of entries of a leaf or children of an inner node.
+  unsigned size() const { return NumElements; }
+
+  /// The hash shared by the keys of a leaf.
+  uint32_t getHash() const {
+    assert(IsLeaf && "Not a leaf");
+    return Bits;
+  }
+
+  ArrayRef<entry_type> entries() const {
+    assert(IsLeaf && "Not a leaf");
+    return makeArrayRef(getEntries(), NumElements);
+  }
+
+  /// The bits of the hash for which an inner node has children.
+  uint32_t getBitmap() const {
+    assert(!IsLeaf && "Not an inner node");
+    return Bits;
+  }
+
+  ArrayRef<ImutHAMTNode *> children() const {
+    assert(!IsLeaf && "Not an inner node");
+    return makeArrayRef(getChildren(), NumElements);
+  }
+
+  /// The child of an inner node for the 5-bit hash fragment \p Bit, or null.
+  ImutHAMTNode *getChild(unsigned Bit) const {
+    uint32_t Mask = uint32_t(1) << Bit;
+    if (!(getBitmap() & Mask))
+      return nullptr;
+    return getChildren()[countPopulation(getBitmap() & (Mask - 1))];
+  }
+
+  void Profile(FoldingSetNodeID &ID) const {
+    if (IsLeaf)
+      ProfileLeaf(ID, Bits, entries());
+    else
+      ProfileInner(ID, Bits, children());
+  }
+
+  static void ProfileLeaf(FoldingSetNodeID &ID, uint32_t Hash,
+                          ArrayRef<entry_type> Entries) {
+    ID.AddBoolean(true);
+    ID.AddInteger(Hash);
+    for (const entry_type &E : Entries)
+      ValInfo::Profile(ID, E);
+  }
+
+  static void ProfileInner(FoldingSetNodeID &ID, uint32_t Bitmap,
+                           ArrayRef<ImutHAMTNode *> Children) {
+    ID.AddBoolean(false);
+    ID.AddInteger(Bitmap);
+    for (const ImutHAMTNode *Child : Children)
+      ID.AddPointer(Child);
+  }
+
+  static ImutHAMTNode *createLeaf(BumpPtrAllocator &Allocator, uint32_t Hash,
+                                  ArrayRef<entry_type> Entries) {
+    void *Mem = Allocator.Allocate(
+        getEntriesOffset() + Entries.size() * sizeof(entry_type),
+        std::max(alignof(ImutHAMTNode), alignof(entry_type)));
+    auto *N = new (Mem) ImutHAMTNode(true, Hash, Entries.size());
+    std::uninitialized_copy(Entries.begin(), Entries.end(), N->getEntries());
+    return N;
+  }
+
+  static ImutHAMTNode *createInner(BumpPtrAllocator &Allocator,
+                                   uint32_t Bitmap,
+                                   ArrayRef<ImutHAMTNode *> Children) {
+    assert(countPopulation(Bitmap) == Children.size() && "Bad bitmap");
+    void *Mem = Allocator.Allocate(sizeof(ImutHAMTNode) +
+                                       Children.size() * sizeof(ImutHAMTNode *),
+                                   alignof(ImutHAMTNode));
+    auto *N = new (Mem) ImutHAMTNode(false, Bitmap, Children.size());
+    std::copy(Children.begin(), Children.end(), N->getChildren());
+    return N;
+  }
+
+private:
+  ImutHAMTNode(bool IsLeaf, uint32_t Bits, unsigned NumElements)
+      : IsLeaf(IsLeaf), Bits(Bits), NumElements(NumElements) {}
+
+  static size_t getEntriesOffset() {
+    return alignTo(sizeof(ImutHAMTNode), alignof(entry_type));
+  }
+
+  entry_type *getEntries() const {
+    return reinterpret_cast<entry_type *>(
+        reinterpret_cast<char *>(const_cast<ImutHAMTNode *>(this)) +
+        getEntriesOffset());
+  }
+
+  ImutHAMTNode **getChildren() const {
+    return reinterpret_cast<ImutHAMTNode **>(
+        const_cast<ImutHAMTNode *>(this + 1));
+  }
+
+  bool IsLeaf;
+  uint32_t Bits;
+  unsigned NumElements;
+};
+
+/// An immutable map with the interface of ImmutableMap, implemented as a
+/// hash array mapped trie.
+///
+/// Lookups and updates walk at most 7 nodes of up to 32 children rather than a
+/// balanced binary tree, and an update copies at most that many nodes. The
+/// entries are iterated in the order of the hashes of their keys. Unlike the
+/// nodes of ImmutableMap, nodes are not reference counted: they live as long
+/// as the factory that created them, and the entries they hold are never
+/// destroyed. As nodes are uniqued by their profile, unequal keys and data
+/// must have different profiles.
+template <typename KeyT, typename ValT,
+          typename ValInfo = ImutKeyValueInfo<KeyT, ValT>>
+class ImmutableHashMap {
+public:
+  using value_type = typename ValInfo::value_type;
+  using value_type_ref = typename ValInfo::value_type_ref;
+  using key_type = typename ValInfo::key_type;
+  using key_type_ref = typename ValInfo::key_type_ref;
+  using data_type = typename ValInfo::data_type;
+  using data_type_ref = typename ValInfo::data_type_ref;
+  using NodeTy = ImutHAMTNode<ValInfo>;
+  using entry_type = typename NodeTy::entry_type;
+
+private:
+  const NodeTy *Root;
+
+  static uint32_t getHash(key_type_ref K) {
+    FoldingSetNodeID ID;
+    ImutContainerInfo<KeyT>::Profile(ID, K);
+    return ID.ComputeHash();
+  }
+
+  static unsigned getFragment(uint32_t Hash, unsigned Shift) {
+    assert(Shift < 32 && "Ran out of hash bits");
+    return (Hash >> Shift) & 31;
+  }
+
+public:
+  /// Constructs a map from a pointer to a trie root. In general one should
+  /// use a Factory object to create maps instead.
+  explicit ImmutableHashMap(const NodeTy *R) : Root(R) {}
+
+  class Factory {
+    std::unique_ptr<BumpPtrAllocator> OwnedAllocator;
+    BumpPtrAllocator &Allocator;
+    FoldingSet<NodeTy> Cache;
+
+  public:
+    Factory()
+        : OwnedAllocator(new BumpPtrAllocator), Allocator(*OwnedAllocator) {}
+    Factory(BumpPtrAllocator &Alloc) : Allocator(Alloc) {}
+
+    Factory(const Factory &) = delete;
+    Factory &operator=(const Factory &) = delete;
+
+    ImmutableHashMap getEmptyMap() { return ImmutableHashMap(nullptr); }
+
+    LLVM_NODISCARD ImmutableHashMap add(ImmutableHashMap Old, key_type_ref K,
+                                        data_type_ref D) {
+      return ImmutableHashMap(
+          add(Old.Root, getHash(K), 0, entry_type(K, D)));
+    }
+
+    LLVM_NODISCARD ImmutableHashMap remove(ImmutableHashMap Old,
+                                           key_type_ref K) {
+      return ImmutableHashMap(remove(Old.Root, getHash(K), 0, K));
+    }
+
+  private:
+    const NodeTy *getLeaf(uint32_t Hash, ArrayRef<entry_type> Entries) {
+      FoldingSetNodeID ID;
+      NodeTy::ProfileLeaf(ID, Hash, Entries);
+      void *InsertPos;
+      if (NodeTy *N = Cache.FindNodeOrInsertPos(ID, InsertPos))
+        return N;
+      NodeTy *N = NodeTy::createLeaf(Allocator, Hash, Entries);
+      Cache.InsertNode(N, InsertPos);
+      return N;
+    }
+
+    const NodeTy *getInner(uint32_t Bitmap, ArrayRef<NodeTy *> Children) {
+      FoldingSetNodeID ID;
+      NodeTy::ProfileInner(ID, Bitmap, Children);
+      void *InsertPos;
+      if (NodeTy *N = Cache.FindNodeOrInsertPos(ID, InsertPos))
+        return N;
+      NodeTy *N = NodeTy::createInner(Allocator, Bitmap, Children);
+      Cache.InsertNode(N, InsertPos);
+      return N;
+    }
+
+    /// Returns \p N with the child for \p Bit replaced by \p Child, which may
+    /// be null to remove it.
+    const NodeTy *setChild(const NodeTy *N, unsigned Bit,
+                           const NodeTy *Child) {
+      uint32_t Mask = uint32_t(1) << Bit;
+      uint32_t Bitmap = N->getBitmap();
+      unsigned Index = countPopulation(Bitmap & (Mask - 1));
+      SmallVector<NodeTy *, 8> Children(N->children().begin(),
+                                        N->children().end());
+      if (!(Bitmap & Mask)) {
+        assert(Child && "Removing a missing child");
+        Children.insert(Children.begin() + Index, const_cast<NodeTy *>(Child));
+        Bitmap |= Mask;
+      } else if (Child) {
+        Children[Index] = const_cast<NodeTy *>(Child);
+      } else {
+        Children.erase(Children.begin() + Index);
+        Bitmap &= ~Mask;
+      }
+
+      // An inner node whose keys all share a hash is replaced by their leaf,
+      // which keeps the shape of the trie canonical.
+      if (Children.empty())
+        return nullptr;
+      if (Children.size() == 1 && Children[0]->isLeaf())
+        return Children[0];
+      return getInner(Bitmap, Children);
+    }
+
+    /// Returns an inner node holding the leaves \p A and \p B, whose hashes
+    /// are different but agree on the bits below \p Shift.
+    const NodeTy *mergeLeaves(const NodeTy *A, const NodeTy *B,
+                              unsigned Shift) {
+      unsigned BitA = getFragment(A->getHash(), Shift);
+      unsigned BitB = getFragment(B->getHash(), Shift);
+      if (BitA == BitB) {
+        NodeTy *Child = const_cast<NodeTy *>(mergeLeaves(A, B, Shift + 5));
+        return getInner(uint32_t(1) << BitA, Child);
+      }
+      if (BitA > BitB) {
+        std::swap(A, B);
+        std::swap(BitA, BitB);
+      }
+      NodeTy *Children[] = {const_cast<NodeTy *>(A), const_cast<NodeTy *>(B)};
+      return getInner((uint32_t(1) << BitA) | (uint32_t(1) << BitB),
+                      Children);
+    }
+
+    static entry_type *findEntry(MutableArrayRef<entry_type> Entries,
+                                 key_type_ref K) {
+      return std::lower_bound(Entries.begin(), Entries.end(), K,
+                              [](const entry_type &E, key_type_ref K) {
+                                return ValInfo::isLess(ValInfo::KeyOfValue(E),
+                                                       K);
+                              });
+    }
+
+    const NodeTy *add(const NodeTy *N, uint32_t Hash, unsigned Shift,
+                      const entry_type &V) {
+      if (!N)
+        return getLeaf(Hash, V);
+
+      if (!N->isLeaf()) {
+        unsigned Bit = getFragment(Hash, Shift);
+        const NodeTy *Child = N->getChild(Bit);
+        const NodeTy *NewChild = add(Child, Hash, Shift + 5, V);
+        return NewChild == Child ? N : setChild(N, Bit, NewChild);
+      }
+
+      if (N->getHash() != Hash)
+        return mergeLeaves(N, getLeaf(Hash, V), Shift);
+
+      key_type_ref K = ValInfo::KeyOfValue(V);
+      SmallVector<entry_type, 4> Entries(N->entries().begin(),
+                                         N->entries().end());
+      entry_type *I = findEntry(Entries, K);
+      if (I != Entries.end() && ValInfo::isEqual(ValInfo::KeyOfValue(*I), K)) {
+        if (ValInfo::isDataEqual(ValInfo::DataOfValue(*I),
+                                 ValInfo::DataOfValue(V)))
+          return N;
+        *I = V;
+      } else {
+        Entries.insert(I, V);
+      }
+      return getLeaf(Hash, Entries);
+    }
+
+    const NodeTy *remove(const NodeTy *N, uint32_t Hash, unsigned Shift,
+                         key_type_ref K) {
+      if (!N)
+        return nullptr;
+
+      if (!N->isLeaf()) {
+        unsigned Bit = getFragment(Hash, Shift);
+        const NodeTy *Child = N->getChild(Bit);
+        if (!Child)
+          return N;
+        const NodeTy *NewChild = remove(Child, Hash, Shift + 5, K);
+        return NewChild == Child ? N : setChild(N, Bit, NewChild);
+      }
+
+      if (N->getHash() != Hash)
+        return N;
+      SmallVector<entry_type, 4> Entries(N->entries().begin(),
+                                         N->entries().end());
+      entry_type *I = findEntry(Entries, K);
+      if (I == Entries.end() || !ValInfo::isEqual(ValInfo::KeyOfValue(*I), K))
+        return N;
+      if (Entries.size() == 1)
+        return nullptr;
+      Entries.erase(I);
+      return getLeaf(Hash, Entries);
+    }
+  };
+
+  const data_type *lookup(key_type_ref K) const {
+    uint32_t Hash = getHash(K);
+    const NodeTy *N = Root;
+    for (unsigned Shift = 0; N && !N->isLeaf(); Shift += 5)
+      N = N->getChild(getFragment(Hash, Shift));
+    if (!N || N->getHash() != Hash)
+      return nullptr;
+    for (const entry_type &E : N->entries())
+      if (ValInfo::isEqual(ValInfo::KeyOfValue(E), K))
+        return &ValInfo::DataOfValue(E);
+    return nullptr;
+  }
+
+  bool contains(key_type_ref K) const { return lookup(K); }
+
+  /// Maps from the same factory are equal exactly when their roots are.
+  bool operator==(const ImmutableHashMap &RHS) const {
+    return Root == RHS.Root;
+  }
+
+  bool operator!=(const ImmutableHashMap &RHS) const {
+    return Root != RHS.Root;
+  }
+
+  const NodeTy *getRoot() const { return Root; }
+
+  bool isEmpty() const { return !Root; }
+
+  class iterator {
+    /// The nodes from the root to the current leaf, with the index of the
+    /// current child or entry in each.
+    SmallVector<std::pair<const NodeTy *, unsigned>, 8> Path;
+
+    void descendToLeaf() {
+      while (!Path.back().first->isLeaf()) {
+        const auto &Top = Path.back();
+        Path.push_back({Top.first->children()[Top.second], 0});
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename ImmutableHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+
+    iterator() = default;
+    explicit iterator(const NodeTy *Root) {
+      if (Root) {
+        Path.push_back({Root, 0});
+        descendToLeaf();
+      }
+    }
+
+    reference operator*() const {
+      return Path.back().first->entries()[Path.back().second];
+    }
+    pointer operator->() const { return &**this; }
+
+    key_type_ref getKey() const { return ValInfo::KeyOfValue(**this); }
+    data_type_ref getData() const { return ValInfo::DataOfValue(**this); }
+
+    iterator &operator++() {
+      ++Path.back().second;
+      while (Path.back().second == Path.back().first->size()) {
+        Path.pop_back();
+        if (Path.empty())
+          return *this;
+        ++Path.back().second;
+      }
+      descendToLeaf();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator Tmp = *this;
+      ++*this;
+      return Tmp;
+    }
+
+    bool operator==(const iterator &RHS) const { return Path == RHS.Path; }
+    bool operator!=(const iterator &RHS) const { return Path != RHS.Path; }
+  };
+
+  iterator begin() const { return iterator(Root); }
+  iterator end() const { return iterator(); }
+
+  static void Profile(FoldingSetNodeID &ID, const ImmutableHashMap &M) {
+    ID.AddPointer(M.Root);
+  }
+
+  void Profile(FoldingSetNodeID &ID) const { Profile(ID, *this); }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_IMMUTABLEHASHMAP_H
@@ -17,6 +17,7 @@
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/DJB.h"
 #include "llvm/Support/PointerLikeTypeTraits.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <algorithm>
@@ -78,12 +79,27 @@ protected:
   /// specified bucket will be non-null.  Otherwise, it will be null.  In either
   /// case, the FullHashValue field of the bucket will be set to the hash value
   /// of the string.
-  unsigned LookupBucketFor(StringRef Key);
+  unsigned LookupBucketFor(StringRef Key) {
+    return LookupBucketFor(Key, hash(Key));
+  }
+
+  /// Overload that explicitly takes precomputed hash(Key).
+  unsigned LookupBucketFor(StringRef Key, uint32_t FullHashValue);
 
   /// FindKey - Look up the bucket that contains the specified key. If it exists
   /// in the map, return the bucket number of the key.  Otherwise return -1.
   /// This does not modify the map.
-  int FindKey(StringRef Key) const;
+  int FindKey(StringRef Key) const { return FindKey(Key, hash(Key)); }
+
+  /// Overload that explicitly takes precomputed hash(Key).
+  int FindKey(StringRef Key, uint32_t FullHashValue) const;
+
+  /// FindKeys - Look up the buckets of the NumKeys keys at once, and store the
+  /// result of FindKey(Keys[I], Hashes[I]) in Buckets[I]. The buckets of all
+  /// keys are prefetched before any of them is probed, so that the cache
+  /// misses of a large table overlap rather than add up.
+  void FindKeys(const StringRef *Keys, const uint32_t *Hashes, int *Buckets,
+                size_t NumKeys) const;
 
   /// RemoveKey - Remove the specified StringMapEntry from the table, but do not
   /// delete it.  This aborts if the value isn't in the table.
@@ -98,6 +114,12 @@ protected:
   void init(unsigned Size);
 
 public:
+  /// Returns the hash value that the map uses for \p Key. Clients that look up
+  /// the same key in several maps, or that already store it, may compute it
+  /// once and pass it to the overloads of find(), count() and
+  /// try_emplace_with_hash() that take a precomputed hash.
+  static uint32_t hash(StringRef Key) { return djbHash(Key, 0); }
+
   static StringMapEntryBase *getTombstoneVal() {
     uintptr_t Val = static_cast<uintptr_t>(-1);
     Val <<= PointerLikeTypeTraits<StringMapEntryBase *>::NumLowBitsAvailable;
@@ -329,18 +351,49 @@ public:
                       StringMapKeyIterator<ValueTy>(end()));
   }
 
-  iterator find(StringRef Key) {
-    int Bucket = FindKey(Key);
+  iterator find(StringRef Key) { return find(Key, hash(Key)); }
+
+  /// Overload that takes the precomputed \p FullHashValue, which must be
+  /// hash(Key).
+  iterator find(StringRef Key, uint32_t FullHashValue) {
+    int Bucket = FindKey(Key, FullHashValue);
     if (Bucket == -1) return end();
     return iterator(TheTable+Bucket, true);
   }
 
-  const_iterator find(StringRef Key) const {
-    int Bucket = FindKey(Key);
+  const_iterator find(StringRef Key) const { return find(Key, hash(Key)); }
+
+  const_iterator find(StringRef Key, uint32_t FullHashValue) const {
+    int Bucket = FindKey(Key, FullHashValue);
     if (Bucket == -1) return end();
     return const_iterator(TheTable+Bucket, true);
   }
 
+  /// Look up all of the StringRefs in the range \p Keys and write find(Key)
+  /// for each of them to \p Results. This is faster than calling find() in a
+  /// loop when the map is too large to stay in cache, because the buckets of
+  /// a group of keys are loaded in parallel.
+  template <typename RangeTy, typename OutputIt>
+  OutputIt find_batch(const RangeTy &Keys, OutputIt Results) {
+    const unsigned GroupSize = 16;
+    StringRef Group[GroupSize];
+    uint32_t Hashes[GroupSize];
+    int Buckets[GroupSize];
+    auto I = std::begin(Keys), E = std::end(Keys);
+    while (I != E) {
+      unsigned N = 0;
+      for (; N != GroupSize && I != E; ++N, ++I) {
+        Group[N] = *I;
+        Hashes[N] = hash(Group[N]);
+      }
+      FindKeys(Group, Hashes, Buckets, N);
+      for (unsigned J = 0; J != N; ++J, ++Results)
+        *Results =
+            Buckets[J] == -1 ? end() : iterator(TheTable + Buckets[J], true);
+    }
+    return Results;
+  }
+
   /// lookup - Return the entry for the specified key, or a default
   /// constructed value if no such entry exists.
   ValueTy lookup(StringRef Key) const {
@@ -359,6 +412,10 @@ public:
     return find(Key) == end() ? 0 : 1;
   }
 
+  size_type count(StringRef Key, uint32_t FullHashValue) const {
+    return find(Key, FullHashValue) == end() ? 0 : 1;
+  }
+
   template <typename InputTy>
   size_type count(const StringMapEntry<InputTy> &MapEntry) const {
     return count(MapEntry.getKey());
@@ -397,7 +454,16 @@ public:
   /// the pair points to the element with key equivalent to the key of the pair.
   template <typename... ArgsTy>
   std::pair<iterator, bool> try_emplace(StringRef Key, ArgsTy &&... Args) {
-    unsigned BucketNo = LookupBucketFor(Key);
+    return try_emplace_with_hash(Key, hash(Key), std::forward<ArgsTy>(Args)...);
+  }
+
+  /// Like try_emplace(), but takes the precomputed \p FullHashValue, which
+  /// must be hash(Key).
+  template <typename... ArgsTy>
+  std::pair<iterator, bool> try_emplace_with_hash(StringRef Key,
+                                                  uint32_t FullHashValue,
+                                                  ArgsTy &&... Args) {
+    unsigned BucketNo = LookupBucketFor(Key, FullHashValue);
     StringMapEntryBase *&Bucket = TheTable[BucketNo];
     if (Bucket && Bucket != getTombstoneVal())
       return std::make_pair(iterator(TheTable + BucketNo, false),
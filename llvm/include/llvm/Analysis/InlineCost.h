@@ -13,6 +13,9 @@
 #ifndef LLVM_ANALYSIS_INLINECOST_H
 #define LLVM_ANALYSIS_INLINECOST_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
@@ -180,6 +183,43 @@ struct InlineParams {
   Optional<bool> ComputeFullInlineCost;
 };
 
+/// Caches the inline cost analysis of a callee across its call sites.
+///
+/// The walk over the callee depends on the call site only through a few of
+/// its properties: the threshold and bonuses computed for it, which arguments
+/// are constants, which pointer arguments are at constant offsets from a
+/// common base, and a few properties of the caller. Call sites that agree on
+/// all of them share one analysis. The cache doesn't observe the IR, so its
+/// owner has to invalidate any function whose body or attributes change, and
+/// should not keep it across passes.
+class InlineCostCache {
+public:
+  /// The signature of a call site as seen by the analysis and the result of
+  /// analyzing the callee for it.
+  struct Entry {
+    SmallVector<uint64_t, 16> Signature;
+    /// The reason for not inlining, or null if the call site can be inlined.
+    const char *Message;
+    int Cost;
+    int Threshold;
+  };
+
+  /// Returns the entry for a call site of \p Callee with \p Signature, or null.
+  const Entry *lookup(const Function *Callee,
+                      ArrayRef<uint64_t> Signature) const;
+
+  /// Records the analysis of a call site of \p Callee.
+  void insert(const Function *Callee, Entry E);
+
+  /// Forgets everything known about call sites of \p F.
+  void invalidate(const Function *F) { Entries.erase(F); }
+
+  void clear() { Entries.clear(); }
+
+private:
+  DenseMap<const Function *, SmallVector<Entry, 2>> Entries;
+};
+
 /// Generate the parameters to tune the inline cost analysis based only on the
 /// commandline options.
 InlineParams getInlineParams();
@@ -211,12 +251,15 @@ int getCallsiteCost(CallBase &Call, const DataLayout &DL);
 /// sufficiently low to warrant inlining.
 ///
 /// Also note that calling this function *dynamically* computes the cost of
-/// inlining the callsite. It is an expensive, heavyweight call.
+/// inlining the callsite. It is an expensive, heavyweight call, unless a
+/// \p Cache is given that already holds the analysis of an equivalent call
+/// site. The cache is not used when remarks are requested through \p ORE.
 InlineCost getInlineCost(
     CallBase &Call, const InlineParams &Params, TargetTransformInfo &CalleeTTI,
     std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
     Optional<function_ref<BlockFrequencyInfo &(Function &)>> GetBFI,
-    ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE = nullptr);
+    ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE = nullptr,
+    InlineCostCache *Cache = nullptr);
 
 /// Get an InlineCost with the callee explicitly specified.
 /// This allows you to calculate the cost of inlining a function via a
@@ -228,7 +271,8 @@ getInlineCost(CallBase &Call, Function *Callee, const InlineParams &Params,
               TargetTransformInfo &CalleeTTI,
               std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
               Optional<function_ref<BlockFrequencyInfo &(Function &)>> GetBFI,
-              ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE);
+              ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE,
+              InlineCostCache *Cache = nullptr);
 
 /// Minimal filter to detect invalid constructs for inlining.
 InlineResult isInlineViable(Function &Callee);
@@ -818,7 +818,10 @@ public:
   ///
   /// We don't have a way to invalidate per-loop dispositions. Clear and
   /// recompute is simpler.
-  void forgetLoopDispositions(const Loop *L) { LoopDispositions.clear(); }
+  void forgetLoopDispositions(const Loop *L) {
+    LoopDispositions.clear();
+    KnownPredicates.clear();
+  }
 
   /// Determine the minimum number of zero bits that S is guaranteed to end in
   /// (at every loop iteration).  It is, at the same time, the minimum number
@@ -1429,6 +1432,24 @@ private:
   /// Memoized results from getRange
   DenseMap<const SCEV *, ConstantRange> SignedRanges;
 
+  /// Memoized results from isKnownPredicate for a pair of operands. Bit
+  /// Pred - FIRST_ICMP_PREDICATE of Computed is set once the result for Pred
+  /// is known, and the same bit of Known holds it.
+  struct KnownPredicateResults {
+    uint16_t Computed = 0;
+    uint16_t Known = 0;
+  };
+  static_assert(CmpInst::LAST_ICMP_PREDICATE - CmpInst::FIRST_ICMP_PREDICATE <
+                    16,
+                "KnownPredicateResults is too small");
+
+  /// Memoized results from isKnownPredicate, only used with
+  /// -scalar-evolution-memoize-predicates. The results may depend on any
+  /// expression, so the whole cache is dropped whenever anything is
+  /// forgotten.
+  DenseMap<std::pair<const SCEV *, const SCEV *>, KnownPredicateResults>
+      KnownPredicates;
+
   /// Used to parameterize getRange
   enum RangeSignHint { HINT_RANGE_UNSIGNED, HINT_RANGE_SIGNED };
 
@@ -1678,6 +1699,10 @@ private:
                               const SCEV *FoundLHS, const SCEV *FoundRHS,
                               unsigned Depth = 0);
 
+  /// Uncached implementation of isKnownPredicate.
+  bool isKnownPredicateImpl(ICmpInst::Predicate Pred, const SCEV *LHS,
+                            const SCEV *RHS);
+
   /// Test whether the condition described by Pred, LHS, and RHS is true.
   /// Use only simple non-recursive types of checks, such as range analysis etc.
   bool isKnownViaNonRecursiveReasoning(ICmpInst::Predicate Pred,
@@ -109,6 +109,15 @@ class Module;
     /// Parse the specified bitcode buffer, returning the module summary index.
     Expected<std::unique_ptr<ModuleSummaryIndex>> getSummary();
 
+    /// Parse the specified bitcode buffer, returning a module summary index
+    /// that holds the summaries of the given GUIDs and of the aliasees of
+    /// those that are aliases, in all modules. Combined indexes written by
+    /// this version of LLVM have a table that lets the reader jump to these
+    /// summaries directly, without decoding the others; all summaries are
+    /// read from other indexes.
+    Expected<std::unique_ptr<ModuleSummaryIndex>>
+    getSummary(ArrayRef<GlobalValue::GUID> GUIDs);
+
     /// Parse the specified bitcode buffer and merge its module summary index
     /// into CombinedIndex.
     Error readSummary(ModuleSummaryIndex &CombinedIndex, StringRef ModulePath,
@@ -173,6 +182,13 @@ class Module;
   Expected<std::unique_ptr<ModuleSummaryIndex>>
   getModuleSummaryIndex(MemoryBufferRef Buffer);
 
+  /// Parse the specified bitcode buffer, returning a module summary index
+  /// that holds at least the summaries of the given GUIDs. See
+  /// BitcodeModule::getSummary(ArrayRef<GlobalValue::GUID>).
+  Expected<std::unique_ptr<ModuleSummaryIndex>>
+  getModuleSummaryIndex(MemoryBufferRef Buffer,
+                        ArrayRef<GlobalValue::GUID> GUIDs);
+
   /// Parse the specified bitcode buffer and merge the index into CombinedIndex.
   Error readModuleSummaryIndex(MemoryBufferRef Buffer,
                                ModuleSummaryIndex &CombinedIndex,
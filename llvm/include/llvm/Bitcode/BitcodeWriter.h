@@ -26,6 +26,7 @@ namespace llvm {
 
 class BitstreamWriter;
 class Module;
+class raw_mmap_ostream;
 class raw_ostream;
 
   class BitcodeWriter {
@@ -41,12 +42,20 @@ class raw_ostream;
     bool WroteStrtab = false, WroteSymtab = false;
 
     void writeBlob(unsigned Block, unsigned Record, StringRef Blob);
+    void writeBlob(unsigned Block, unsigned Record, size_t Size,
+                   function_ref<void(char *)> Fill);
 
     std::vector<Module *> Mods;
 
   public:
     /// Create a BitcodeWriter that writes to Buffer.
-    BitcodeWriter(SmallVectorImpl<char> &Buffer);
+    ///
+    /// If \p FS is not null, completed function blocks are moved from Buffer
+    /// to \p FS as Buffer grows, so that Buffer does not have to hold the
+    /// whole bitcode file. The caller must write what is left in Buffer to
+    /// \p FS after writing the string table.
+    BitcodeWriter(SmallVectorImpl<char> &Buffer,
+                  raw_mmap_ostream *FS = nullptr);
 
     ~BitcodeWriter();
 
@@ -131,6 +140,20 @@ class raw_ostream;
                           bool GenerateHash = false,
                           ModuleHash *ModHash = nullptr);
 
+  /// Write the specified module to the specified mapped output file.
+  ///
+  /// Unlike the raw_ostream overload, this does not keep the whole bitstream
+  /// in memory before writing it out: completed function blocks are moved to
+  /// \p Out while the rest of the module is being written, and placeholders
+  /// are backpatched in place in the mapped file. This is not done for Darwin
+  /// targets, whose wrapper header must be computed over the whole bitstream,
+  /// or if \p GenerateHash is set.
+  void WriteBitcodeToFile(const Module &M, raw_mmap_ostream &Out,
+                          bool ShouldPreserveUseListOrder = false,
+                          const ModuleSummaryIndex *Index = nullptr,
+                          bool GenerateHash = false,
+                          ModuleHash *ModHash = nullptr);
+
   /// Write the specified thin link bitcode file (i.e., the minimized bitcode
   /// file) to the given raw output stream, where it will be written in a new
   /// bitcode block. The thin link bitcode file is used for thin link, and it
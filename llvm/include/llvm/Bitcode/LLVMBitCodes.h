@@ -288,6 +288,18 @@ enum GlobalValueSummarySymtabCodes {
   //                                        numrefs, numrefs x valueid,
   //                                        n x (valueid, offset)]
   FS_PERMODULE_VTABLE_GLOBALVAR_INIT_REFS = 23,
+  // The bit offsets, relative to the start of the combined summary block, of
+  // the FS_GUID_TABLE record, of the first summary record and of the records
+  // following the summaries. Each offset is written as two 32-bit halves.
+  // GUID_TABLE_OFFSET: [table offset, summaries offset, tail offset]
+  FS_GUID_TABLE_OFFSET = 24,
+  // A table that allows readers to decode just the summaries of some GUIDs.
+  // The blob holds one (guid, offset, aliasee guid) triple of little-endian
+  // 64-bit values per summary, sorted by GUID. The offset is the bit offset,
+  // relative to the start of the block, of the first record of the summary;
+  // the aliasee GUID is zero unless the summary is an alias.
+  // GUID_TABLE: [blob]
+  FS_GUID_TABLE = 25,
 };
 
 enum MetadataCodes {
@@ -17,16 +17,35 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitstream/BitCodes.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_mmap_ostream.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace llvm {
 
 class BitstreamWriter {
+  /// Out - The buffer that keeps unflushed bytes.
   SmallVectorImpl<char> &Out;
 
+  /// FS - The file stream that Out flushes to. If FS is nullptr, the whole
+  /// stream is kept in Out.
+  raw_mmap_ostream *FS;
+
+  /// FlushThreshold - If FS is valid, this is the number of bytes Out must
+  /// hold before FlushToFile() moves them to FS.
+  const uint64_t FlushThreshold;
+
+  /// FSStartOffset - The offset in FS at which this stream starts.
+  const uint64_t FSStartOffset;
+
+  /// NumFlushedBytes - The number of bytes already moved from Out to FS.
+  uint64_t NumFlushedBytes = 0;
+
   /// CurBit - Always between 0 and 31 inclusive, specifies the next bit to use.
   unsigned CurBit;
 
@@ -72,7 +91,7 @@ class BitstreamWriter {
                reinterpret_cast<const char *>(&Value + 1));
   }
 
-  size_t GetBufferOffset() const { return Out.size(); }
+  uint64_t GetBufferOffset() const { return NumFlushedBytes + Out.size(); }
 
   size_t GetWordIndex() const {
     size_t Offset = GetBufferOffset();
@@ -81,8 +100,18 @@ class BitstreamWriter {
   }
 
 public:
-  explicit BitstreamWriter(SmallVectorImpl<char> &O)
-    : Out(O), CurBit(0), CurValue(0), CurCodeSize(2) {}
+  /// Create a BitstreamWriter that writes to Buffer \p O.
+  ///
+  /// If \p FS is not nullptr, FlushToFile() moves the contents of \p O to
+  /// \p FS once it holds at least \p FlushThreshold bytes, so that \p O
+  /// never has to hold the whole stream. The caller remains responsible for
+  /// writing whatever is left in \p O to \p FS at the end.
+  explicit BitstreamWriter(SmallVectorImpl<char> &O,
+                           raw_mmap_ostream *FS = nullptr,
+                           uint64_t FlushThreshold = 16 * 1024 * 1024)
+      : Out(O), FS(FS), FlushThreshold(FlushThreshold),
+        FSStartOffset(FS ? FS->tell() : 0), CurBit(0), CurValue(0),
+        CurCodeSize(2) {}
 
   ~BitstreamWriter() {
     assert(CurBit == 0 && "Unflushed data remaining");
@@ -103,12 +132,45 @@ public:
   /// with the specified value.
   void BackpatchWord(uint64_t BitNo, unsigned NewWord) {
     using namespace llvm::support;
-    unsigned ByteNo = BitNo / 8;
+    uint64_t ByteNo = BitNo / 8;
+    uint64_t StartBit = BitNo & 7;
+
+    if (ByteNo >= NumFlushedBytes) {
+      char *Ptr = &Out[ByteNo - NumFlushedBytes];
+      assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
+                 Ptr, StartBit)) &&
+             "Expected to be patching over 0-value placeholders");
+      endian::writeAtBitAlignment<uint32_t, little, unaligned>(Ptr, NewWord,
+                                                               StartBit);
+      return;
+    }
+
+    // The word has been flushed, possibly only in part, so patch it in place
+    // in the mapped file. Gather the bytes it touches into a temporary.
+    MutableArrayRef<char> Flushed = FS->getWrittenData();
+    if (Flushed.empty())
+      return; // The stream is in an error state; the output is lost anyway.
+    Flushed = Flushed.drop_front(FSStartOffset);
+
+    char Bytes[8];
+    size_t NumBytes = StartBit ? 8 : 4;
+    size_t NumFromFile =
+        std::min<uint64_t>(NumBytes, NumFlushedBytes - ByteNo);
+    size_t NumFromBuffer = std::min<size_t>(NumBytes - NumFromFile, Out.size());
+    memset(Bytes, 0, sizeof(Bytes));
+    memcpy(Bytes, &Flushed[ByteNo], NumFromFile);
+    if (NumFromBuffer)
+      memcpy(Bytes + NumFromFile, Out.data(), NumFromBuffer);
+
     assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
-               &Out[ByteNo], BitNo & 7)) &&
+               Bytes, StartBit)) &&
            "Expected to be patching over 0-value placeholders");
-    endian::writeAtBitAlignment<uint32_t, little, unaligned>(
-        &Out[ByteNo], NewWord, BitNo & 7);
+    endian::writeAtBitAlignment<uint32_t, little, unaligned>(Bytes, NewWord,
+                                                             StartBit);
+
+    memcpy(&Flushed[ByteNo], Bytes, NumFromFile);
+    if (NumFromBuffer)
+      memcpy(Out.data(), Bytes + NumFromFile, NumFromBuffer);
   }
 
   void BackpatchWord64(uint64_t BitNo, uint64_t Val) {
@@ -135,6 +197,18 @@ public:
     CurBit = (CurBit+NumBits) & 31;
   }
 
+  /// Move the buffered bytes to the file stream given at construction time,
+  /// if there is one and the buffer has grown past the flush threshold. Must
+  /// only be called when nothing written since the last call will need to be
+  /// read back from the buffer, e.g. between function blocks.
+  void FlushToFile() {
+    if (!FS || Out.size() < FlushThreshold)
+      return;
+    FS->write(Out.data(), Out.size());
+    NumFlushedBytes += Out.size();
+    Out.clear();
+  }
+
   void FlushToWord() {
     if (CurBit) {
       WriteWord(CurValue);
@@ -400,8 +474,24 @@ public:
       WriteByte(0);
   }
   void emitBlob(StringRef Bytes, bool ShouldEmitSize = true) {
-    emitBlob(makeArrayRef((const uint8_t *)Bytes.data(), Bytes.size()),
-             ShouldEmitSize);
+    emitBlob(Bytes.size(), [&](char *Buf) {
+      if (!Bytes.empty())
+        memcpy(Buf, Bytes.data(), Bytes.size());
+    }, ShouldEmitSize);
+  }
+  /// Emit a blob of \p Size bytes, which \p Fill writes straight into the
+  /// output buffer. This avoids building the blob in a temporary first.
+  void emitBlob(size_t Size, function_ref<void(char *)> Fill,
+                bool ShouldEmitSize = true) {
+    if (ShouldEmitSize)
+      EmitVBR(static_cast<uint32_t>(Size), 6);
+
+    FlushToWord();
+
+    // Reserve the blob and its tail padding at once, zeroing the padding.
+    size_t Start = Out.size();
+    Out.resize(Start + alignTo(Size, 4), 0);
+    Fill(Out.data() + Start);
   }
 
   /// EmitRecord - Emit the specified record to the stream, using an abbrev if
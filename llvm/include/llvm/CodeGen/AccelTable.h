@@ -14,6 +14,7 @@
 #define LLVM_CODEGEN_DWARFACCELTABLE_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
@@ -200,20 +201,22 @@ public:
   AccelTable() : AccelTableBase(DataT::hash) {}
 
   template <typename... Types>
-  void addName(DwarfStringPoolEntryRef Name, Types &&... Args);
+  DataT &addName(DwarfStringPoolEntryRef Name, Types &&... Args);
 };
 
 template <typename AccelTableDataT>
 template <typename... Types>
-void AccelTable<AccelTableDataT>::addName(DwarfStringPoolEntryRef Name,
-                                          Types &&... Args) {
+AccelTableDataT &
+AccelTable<AccelTableDataT>::addName(DwarfStringPoolEntryRef Name,
+                                     Types &&... Args) {
   assert(Buckets.empty() && "Already finalized!");
   // If the string is in the list already then add this die to the list
   // otherwise add a new one.
   auto Iter = Entries.try_emplace(Name.getString(), Name, Hash).first;
   assert(Iter->second.Name == Name);
-  Iter->second.Values.push_back(
-      new (Allocator) AccelTableDataT(std::forward<Types>(Args)...));
+  auto *Data = new (Allocator) AccelTableDataT(std::forward<Types>(Args)...);
+  Iter->second.Values.push_back(Data);
+  return *Data;
 }
 
 /// A base class for different implementations of Data classes for Apple
@@ -253,20 +256,49 @@ class DWARF5AccelTableData : public AccelTableData {
 public:
   static uint32_t hash(StringRef Name) { return caseFoldingDjbHash(Name); }
 
-  DWARF5AccelTableData(const DIE &Die) : Die(Die) {}
+  DWARF5AccelTableData(const DIE &Die) : Die(&Die), DieTag(Die.getTag()) {}
 
 #ifndef NDEBUG
   void print(raw_ostream &OS) const override;
 #endif
 
-  const DIE &getDie() const { return Die; }
-  uint64_t getDieOffset() const { return Die.getOffset(); }
-  unsigned getDieTag() const { return Die.getTag(); }
+  const DIE &getDie() const {
+    assert(Die && "Entry no longer refers to a DIE");
+    return *Die;
+  }
+  uint64_t getDieOffset() const { return Die ? Die->getOffset() : DieOffset; }
+  unsigned getDieTag() const { return DieTag; }
+
+  /// Type units are destroyed as soon as they are emitted, so entries for
+  /// their DIEs remember the offset of the DIE, the index of the type unit in
+  /// the name index and the unique ID of the compile unit that the type unit
+  /// was built for instead.
+  void convertToTypeUnitEntry(unsigned TUIndex, unsigned CUID) {
+    DieOffset = getDieOffset();
+    Die = nullptr;
+    TypeUnitIndex = TUIndex;
+    TypeUnitCUID = CUID;
+  }
+
+  /// Drop the entry of a DIE in a type unit that was discarded.
+  void discard() {
+    Die = nullptr;
+    Discarded = true;
+  }
+
+  bool isDiscarded() const { return Discarded; }
+  Optional<unsigned> getTypeUnitIndex() const { return TypeUnitIndex; }
+  unsigned getTypeUnitCUID() const { return TypeUnitCUID; }
 
 protected:
-  const DIE &Die;
+  const DIE *Die;
+  uint64_t DieOffset = 0;
+  unsigned DieTag;
+  Optional<unsigned> TypeUnitIndex;
+  unsigned TypeUnitCUID = 0;
+  bool Discarded = false;
 
-  uint64_t order() const override { return Die.getOffset(); }
+  uint64_t order() const override { return getDieOffset(); }
 };
 
 class DWARF5AccelTableStaticData : public AccelTableData {
@@ -284,6 +316,8 @@ public:
   uint64_t getDieOffset() const { return DieOffset; }
   unsigned getDieTag() const { return DieTag; }
   unsigned getCUIndex() const { return CUIndex; }
+  bool isDiscarded() const { return false; }
+  Optional<unsigned> getTypeUnitIndex() const { return None; }
 
 protected:
   uint64_t DieOffset;
@@ -307,10 +341,16 @@ void emitAppleAccelTable(AsmPrinter *Asm, AccelTable<DataT> &Contents,
   emitAppleAccelTableImpl(Asm, Contents, Prefix, SecBegin, DataT::Atoms);
 }
 
+/// Emit a DWARF v5 name index for the given compile units. Entries for DIEs of
+/// type units refer to \p LocalTUs, the labels at the start of type units in
+/// this object file, followed by \p ForeignTUs, the signatures of type units
+/// in split DWARF files.
 void emitDWARF5AccelTable(AsmPrinter *Asm,
                           AccelTable<DWARF5AccelTableData> &Contents,
                           const DwarfDebug &DD,
-                          ArrayRef<std::unique_ptr<DwarfCompileUnit>> CUs);
+                          ArrayRef<std::unique_ptr<DwarfCompileUnit>> CUs,
+                          ArrayRef<MCSymbol *> LocalTUs = None,
+                          ArrayRef<uint64_t> ForeignTUs = None);
 
 void emitDWARF5AccelTable(
     AsmPrinter *Asm, AccelTable<DWARF5AccelTableStaticData> &Contents,
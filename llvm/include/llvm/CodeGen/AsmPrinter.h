@@ -126,6 +126,11 @@ private:
   MCSymbol *CurrentFnEnd = nullptr;
   MCSymbol *CurExceptionSym = nullptr;
 
+  /// The start of the cold part of the current function and the end of its
+  /// hot part, if MachineFunctionSplitter moved some blocks out of it.
+  MCSymbol *CurrentFnColdBegin = nullptr;
+  MCSymbol *CurrentFnHotEnd = nullptr;
+
   // The garbage collection metadata printer table.
   void *GCMetadataPrinters = nullptr; // Really a DenseMap.
 
@@ -209,6 +214,12 @@ public:
   MCSymbol *getFunctionEnd() const { return CurrentFnEnd; }
   MCSymbol *getCurExceptionSym();
 
+  /// Return the start of the cold part of the current function, or null if
+  /// the function was not split. The hot part ends at getFunctionHotEnd() and
+  /// the cold part at getFunctionEnd().
+  MCSymbol *getFunctionColdBegin() const { return CurrentFnColdBegin; }
+  MCSymbol *getFunctionHotEnd() const { return CurrentFnHotEnd; }
+
   /// Return information about object file lowering.
   const TargetLoweringObjectFile &getObjFileLowering() const;
 
@@ -645,6 +656,10 @@ private:
   /// This method emits the header for the current function.
   virtual void EmitFunctionHeader();
 
+  /// End the hot part of the current function and start its cold part, of
+  /// which \p MBB is the first block.
+  void EmitColdSectionStart(const MachineBasicBlock &MBB);
+
   /// Emit a blob of inline asm to the output streamer.
   void
   EmitInlineAsm(StringRef Str, const MCSubtargetInfo &STI,
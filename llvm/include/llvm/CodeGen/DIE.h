@@ -153,6 +153,18 @@ public:
   /// owned by this class.
   DIEAbbrev &uniqueAbbreviation(DIE &Die);
 
+  /// Unique an abbreviation declaration that isn't attached to a DIE, e.g.
+  /// one that was collected in a different abbreviation set.
+  ///
+  /// \returns A reference to the uniqued abbreviation declaration that is
+  /// owned by this class.
+  DIEAbbrev &uniqueAbbreviation(const DIEAbbrev &Abbrev);
+
+  /// Get the unique abbreviations in the order they were numbered in.
+  const std::vector<DIEAbbrev *> &getAbbreviations() const {
+    return Abbreviations;
+  }
+
   /// Print all abbreviations using the specified asm printer.
   void Emit(const AsmPrinter *AP, MCSection *Section) const;
 };
@@ -15,6 +15,7 @@
 
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 #include <functional>
 
@@ -32,7 +33,7 @@ class raw_pwrite_stream;
 /// have been code generated from M.
 ///
 /// Writes bitcode for individual partitions into output streams in BCOSs, if
-/// BCOSs is not empty.
+/// BCOSs is not empty. Mode selects how SplitModule partitions M.
 ///
 /// \returns M if OSs.size() == 1, otherwise returns std::unique_ptr<Module>().
 std::unique_ptr<Module>
@@ -40,7 +41,8 @@ splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_pwrite_stream *> OSs,
              ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
              const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
              TargetMachine::CodeGenFileType FileType = TargetMachine::CGFT_ObjectFile,
-             bool PreserveLocals = false);
+             bool PreserveLocals = false,
+             SplitModuleMode Mode = SplitModuleMode::Hash);
 
 } // namespace llvm
 
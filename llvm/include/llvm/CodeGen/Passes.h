@@ -249,6 +249,10 @@ namespace llvm {
   /// information.
   extern char &MachineBlockPlacementStatsID;
 
+  /// MachineFunctionSplitter - This pass moves the cold basic blocks of
+  /// functions with profile data to a separate section.
+  extern char &MachineFunctionSplitterID;
+
   /// GCLowering Pass - Used by gc.root to perform its default lowering
   /// operations.
   FunctionPass *createGCLoweringPass();
@@ -181,6 +181,8 @@ struct DIDumpOptions {
   bool SummarizeTypes = false;
   bool Verbose = false;
   bool DisplayRawContents = false;
+  /// Number of threads verification may use to check units in parallel.
+  unsigned NumThreads = 1;
 
   /// Return default option set for printing a single DIE without children.
   static DIDumpOptions getForSingleDIE() {
@@ -205,7 +207,8 @@ class DIContext {
 public:
   enum DIContextKind {
     CK_DWARF,
-    CK_PDB
+    CK_PDB,
+    CK_GSYM
   };
 
   DIContext(DIContextKind K) : Kind(K) {}
@@ -13,6 +13,7 @@
 #include "llvm/Support/DataExtractor.h"
 #include <cstdint>
 #include <map>
+#include <mutex>
 #include <vector>
 
 namespace llvm {
@@ -58,6 +59,9 @@ class DWARFDebugAbbrev {
   mutable DWARFAbbreviationDeclarationSetMap AbbrDeclSets;
   mutable DWARFAbbreviationDeclarationSetMap::const_iterator PrevAbbrOffsetPos;
   mutable Optional<DataExtractor> Data;
+  /// Guards the lazy parsing above, so that units of the same context can be
+  /// extracted from several threads.
+  mutable std::mutex Mutex;
 
 public:
   DWARFDebugAbbrev();
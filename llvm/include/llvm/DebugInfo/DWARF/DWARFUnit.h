@@ -25,11 +25,13 @@
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
 #include "llvm/Support/DataExtractor.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -220,10 +222,17 @@ class DWARFUnit {
   /// A table of range lists (DWARF v5 and later).
   Optional<DWARFDebugRnglistTable> RngListTable;
 
-  mutable const DWARFAbbreviationDeclarationSet *Abbrevs;
+  mutable std::atomic<const DWARFAbbreviationDeclarationSet *> Abbrevs;
   llvm::Optional<object::SectionedAddress> BaseAddr;
   /// The compile unit debug information entry items.
   std::vector<DWARFDebugInfoEntry> DieArray;
+  /// Serializes the extraction of DieArray, so that threads sharing the unit
+  /// extract its DIEs only once.
+  std::mutex ExtractDIEsMutex;
+  /// Whether the unit DIE, respectively all the DIEs, are in DieArray. These
+  /// let extractDIEsIfNeeded return without taking the mutex.
+  std::atomic<bool> UnitDIEExtracted{false};
+  std::atomic<bool> AllDIEsExtracted{false};
 
   /// Map from range's start address to end address and corresponding DIE.
   /// IntervalMap does not support range removal, as a result, we use the
@@ -505,7 +514,7 @@ private:
   }
 
   /// extractDIEsIfNeeded - Parses a compile unit and indexes its DIEs if it
-  /// hasn't already been done
+  /// hasn't already been done. This is safe to call from several threads.
   void extractDIEsIfNeeded(bool CUDieOnly);
 
   /// extractDIEsToVector - Appends all parsed DIEs to a vector.
@@ -9,6 +9,7 @@
 #ifndef LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 #define LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFAddressRange.h"
@@ -158,6 +159,15 @@ private:
   /// \returns The number of errors that occurred during verification.
   unsigned verifyUnitContents(DWARFUnit &Unit);
 
+  /// Verifies the contents of \p Units on DumpOpts.NumThreads threads.
+  ///
+  /// Every unit is checked by its own verifier writing to its own buffer. The
+  /// buffers are then printed and the references merged in unit order, so the
+  /// report doesn't depend on scheduling.
+  ///
+  /// \returns The number of errors that occurred during verification.
+  unsigned verifyUnitContentsInParallel(ArrayRef<DWARFUnit *> Units);
+
   /// Verifies the unit headers and contents in a .debug_info or .debug_types
   /// section.
   ///
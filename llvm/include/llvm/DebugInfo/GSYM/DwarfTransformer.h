@@ -0,0 +1,65 @@
+//===- DwarfTransformer.h ---------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_GSYM_DWARFTRANSFORMER_H
+#define LLVM_DEBUGINFO_GSYM_DWARFTRANSFORMER_H
+
+#include "llvm/Support/Error.h"
+
+namespace llvm {
+
+class raw_ostream;
+class DWARFContext;
+
+namespace gsym {
+
+class GsymCreator;
+
+/// A DWARF transformer converts DWARF to GSYM files.
+///
+/// Every DW_TAG_subprogram with address ranges becomes a FunctionInfo for each
+/// of its ranges. The rows of the line table that fall in a range become the
+/// FunctionInfo's line table and the DW_TAG_inlined_subroutine children
+/// become its inline information, so lookups in the resulting GSYM data
+/// produce the same inline call stacks as DWARF does.
+class DwarfTransformer {
+public:
+  /// Create a DWARF transformer.
+  ///
+  /// \param D The DWARF to use when converting to GSYM.
+  ///
+  /// \param OS The stream to log warnings and non fatal issues to.
+  ///
+  /// \param G The GSYM creator to populate with the function information
+  /// from the debug info.
+  DwarfTransformer(DWARFContext &D, raw_ostream &OS, GsymCreator &G)
+      : DICtx(D), Log(OS), Gsym(G) {}
+
+  /// Extract the DWARF from the supplied object file and convert it into the
+  /// Gsym format in the GsymCreator object that is passed in. Returns an
+  /// error if something fatal is encountered.
+  ///
+  /// \param NumThreads The number of threads that compile units can be
+  /// converted on. The line tables are parsed up front so that the units can
+  /// be converted independently; warnings are still logged in unit order.
+  ///
+  /// \returns An error indicating any fatal issues that happen when parsing
+  /// the DWARF, or Error::success() if all goes well.
+  llvm::Error convert(uint32_t NumThreads = 1);
+
+private:
+  DWARFContext &DICtx;
+  raw_ostream &Log;
+  GsymCreator &Gsym;
+};
+
+} // namespace gsym
+} // namespace llvm
+
+#endif // #ifndef LLVM_DEBUGINFO_GSYM_DWARFTRANSFORMER_H
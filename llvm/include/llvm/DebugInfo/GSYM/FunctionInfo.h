@@ -12,15 +12,20 @@
 
 #include "llvm/DebugInfo/GSYM/InlineInfo.h"
 #include "llvm/DebugInfo/GSYM/LineEntry.h"
+#include "llvm/DebugInfo/GSYM/LookupResult.h"
 #include "llvm/DebugInfo/GSYM/Range.h"
 #include "llvm/DebugInfo/GSYM/StringTable.h"
+#include "llvm/Support/Error.h"
 #include <tuple>
 #include <vector>
 
 namespace llvm {
+class DataExtractor;
 class raw_ostream;
 namespace gsym {
 
+class GsymReader;
+
 /// Function information in GSYM files encodes information for one
 /// contiguous address range. The name of the function is encoded as
 /// a string table offset and allows multiple functions with the same
@@ -30,6 +35,13 @@ namespace gsym {
 /// range, it will be split into two gsym::FunctionInfo objects. If the
 /// function has inline functions, the information will be encoded in
 /// the "Inline" member, see gsym::InlineInfo for more information.
+///
+/// When encoded in a GSYM file, a FunctionInfo starts with the 32 bit size of
+/// the function and the 32 bit string table offset of its name. Optional
+/// information follows as a list of (uint32_t InfoType, uint32_t Length)
+/// prefixed records that is terminated by an EndOfList record. Unknown
+/// records can be skipped using their length, which allows new kinds of
+/// information to be added without breaking existing readers.
 struct FunctionInfo {
   AddressRange Range;
   uint32_t Name; ///< String table offset in the string table.
@@ -69,6 +81,56 @@ struct FunctionInfo {
     Lines.clear();
     Inline.clear();
   }
+
+  /// Decode an object from a binary data stream.
+  ///
+  /// \param Data The binary stream to read the data from. This object must
+  /// have the data for the object starting at offset zero. The data
+  /// can contain more data than needed.
+  ///
+  /// \param BaseAddr The FunctionInfo's start address and will be used as the
+  /// base address when decoding any contained information like the line table
+  /// and the inline info.
+  ///
+  /// \returns An FunctionInfo or an error describing the issue that was
+  /// encountered during decoding.
+  static llvm::Expected<FunctionInfo> decode(DataExtractor &Data,
+                                             uint64_t BaseAddr);
+
+  /// Encode this object into FileWriter stream.
+  ///
+  /// \param O The binary stream to write the data to at the current file
+  /// position.
+  ///
+  /// \returns An error object that indicates failure or the offset of the
+  /// function info that was successfully written into the stream.
+  llvm::Expected<uint64_t> encode(FileWriter &O) const;
+
+  /// Lookup an address within the FunctionInfo object's data stream.
+  ///
+  /// Instead of decoding an entire FunctionInfo object when doing lookups,
+  /// we can decode only the information we need from the FunctionInfo's data
+  /// for the specific address. The lookup result information is returned as
+  /// a LookupResult.
+  ///
+  /// \param Data The binary stream to read the data from. This object must
+  /// have the data for the object starting at offset zero. The data
+  /// can contain more data than needed.
+  ///
+  /// \param GR The GSYM reader that contains the string and file table that
+  /// will be used to fill in information in the returned result.
+  ///
+  /// \param FuncAddr The function start address decoded from the GsymReader.
+  ///
+  /// \param Addr The address to lookup.
+  ///
+  /// \returns An LookupResult or an error describing the issue that was
+  /// encountered during decoding. An error should only be returned if the
+  /// address is not contained in the FunctionInfo or if the data is corrupted.
+  static llvm::Expected<LookupResult> lookup(DataExtractor &Data,
+                                             const GsymReader &GR,
+                                             uint64_t FuncAddr,
+                                             uint64_t Addr);
 };
 
 inline bool operator==(const FunctionInfo &LHS, const FunctionInfo &RHS) {
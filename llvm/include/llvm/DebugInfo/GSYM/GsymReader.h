@@ -0,0 +1,173 @@
+//===- GsymReader.h ---------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_GSYM_GSYMREADER_H
+#define LLVM_DEBUGINFO_GSYM_GSYMREADER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/DebugInfo/GSYM/FileEntry.h"
+#include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/Header.h"
+#include "llvm/DebugInfo/GSYM/LookupResult.h"
+#include "llvm/DebugInfo/GSYM/StringTable.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/ErrorOr.h"
+
+#include <inttypes.h>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+class raw_ostream;
+
+namespace gsym {
+
+/// GsymReader is used to read GSYM data from a file or buffer.
+///
+/// A GSYM file is laid out as follows:
+///   - a gsym::Header
+///   - the address offsets table: Header.NumAddresses sorted function start
+///     addresses stored as Header.AddrOffSize byte offsets from
+///     Header.BaseAddress and aligned to Header.AddrOffSize
+///   - the address info offsets table: one 4 byte aligned uint32_t file
+///     offset of the encoded FunctionInfo for each address
+///   - the file table: a 4 byte aligned uint32_t file count followed by the
+///     (Dir, Base) string table offsets of each gsym::FileEntry. Entry zero
+///     is always empty so that file index zero can mean "no file".
+///   - the string table of Header.StrtabSize bytes at Header.StrtabOffset
+///   - the 4 byte aligned encoded FunctionInfo objects
+///
+/// The reader never copies or byte swaps any of these tables. Files are
+/// memory mapped and each lookup binary searches the address offsets table in
+/// place before decoding only the FunctionInfo that contains the address, so
+/// opening a file is cheap and a lookup is O(log n) in the number of
+/// functions.
+class GsymReader {
+  GsymReader(std::unique_ptr<MemoryBuffer> Buffer);
+  llvm::Error parse();
+
+  std::unique_ptr<MemoryBuffer> MemBuffer;
+  StringRef GsymBytes;
+  llvm::support::endianness Endian;
+  Header Hdr;
+  ArrayRef<uint8_t> AddrOffsets;
+  ArrayRef<uint8_t> AddrInfoOffsets;
+  ArrayRef<uint8_t> Files;
+  uint32_t NumFiles = 0;
+  StringTable StrTab;
+
+public:
+  GsymReader(GsymReader &&RHS);
+  ~GsymReader();
+
+  /// Construct a GsymReader from a file on disk.
+  ///
+  /// The file is memory mapped when possible.
+  ///
+  /// \param Path The file path the GSYM file to read.
+  /// \returns An expected GsymReader that contains the object or an error
+  /// object that indicates reason for failing to read the GSYM.
+  static llvm::Expected<GsymReader> openFile(StringRef Path);
+
+  /// Construct a GsymReader from a buffer.
+  ///
+  /// \param Bytes A set of bytes that will be copied and owned by the
+  /// returned object on success.
+  /// \returns An expected GsymReader that contains the object or an error
+  /// object that indicates reason for failing to read the GSYM.
+  static llvm::Expected<GsymReader> copyBuffer(StringRef Bytes);
+
+  /// Access the GSYM header.
+  /// \returns A native endian version of the GSYM header.
+  const Header &getHeader() const { return Hdr; }
+
+  /// Get the full function info for an address.
+  ///
+  /// This should be called when a client will store a copy of the complete
+  /// FunctionInfo for a given address. For one off lookups, use the lookup()
+  /// function below.
+  ///
+  /// \param Addr A virtual address from the orignal object file to lookup.
+  /// \returns An expected FunctionInfo that contains the function info object
+  /// or an error object that indicates reason for failing to lookup the
+  /// address.
+  llvm::Expected<FunctionInfo> getFunctionInfo(uint64_t Addr) const;
+
+  /// Lookup an address in the a GSYM.
+  ///
+  /// Lookup just the information needed for a specific address \a Addr. This
+  /// function is faster that calling getFunctionInfo() as it will only return
+  /// information that pertains to \a Addr and allows the FunctionInfo to be
+  /// decoded as it is traversed.
+  ///
+  /// \param Addr A virtual address from the orignal object file to lookup.
+  /// \returns An expected LookupResult that contains only the information
+  /// needed for the current address, or an error object that indicates reason
+  /// for failing to lookup the address.
+  llvm::Expected<LookupResult> lookup(uint64_t Addr) const;
+
+  /// Get a string from the string table.
+  ///
+  /// \param Offset The string table offset for the string to retrieve.
+  /// \returns The string from the strin table.
+  StringRef getString(uint32_t Offset) const { return StrTab[Offset]; }
+
+  /// Get the a file entry for the suppplied file index.
+  ///
+  /// Used to convert any file indexes in the FunctionInfo data back into
+  /// files. This function can be used for iteration, but is more commonly used
+  /// for random access when doing lookups.
+  ///
+  /// \param Index An index into the file table.
+  /// \returns An optional FileInfo that will be valid if the file index is
+  /// valid, or llvm::None if the file index is out of bounds,
+  Optional<FileEntry> getFile(uint32_t Index) const;
+
+  /// Get the number of addresses in this Gsym file.
+  uint32_t getNumAddresses() const { return Hdr.NumAddresses; }
+
+  /// Gets an address from the address table.
+  ///
+  /// Addresses are stored as offsets frm the gsym::Header::BaseAddress.
+  ///
+  /// \param Index A index into the address table.
+  /// \returns A resolved virtual address for adddress in the address table
+  /// or llvm::None if Index is out of bounds.
+  Optional<uint64_t> getAddress(size_t Index) const;
+
+  /// Dump the header, address table, file table and string table of this
+  /// GSYM file.
+  void dump(raw_ostream &OS) const;
+
+private:
+  /// Get the address offset at \p Index in the address offsets table.
+  uint64_t getAddrOffset(size_t Index) const;
+
+  /// Given an address, find the index of the address table entry of the
+  /// function that contains it.
+  ///
+  /// \param Addr A virtual address that to lookup within the GSYM data.
+  /// \returns An index into the address table of the last function that
+  /// starts at or before \a Addr, or an error if \a Addr precedes all
+  /// functions.
+  llvm::Expected<uint64_t> getAddressIndex(const uint64_t Addr) const;
+
+  /// Get the encoded FunctionInfo data for the address table entry at
+  /// \p Index.
+  llvm::Expected<DataExtractor> getFunctionInfoData(uint64_t Index) const;
+};
+
+} // namespace gsym
+} // namespace llvm
+
+#endif // #ifndef LLVM_DEBUGINFO_GSYM_GSYMREADER_H
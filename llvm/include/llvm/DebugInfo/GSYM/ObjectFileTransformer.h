@@ -0,0 +1,53 @@
+//===- ObjectFileTransformer.h ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_GSYM_OBJECTFILETRANSFORMER_H
+#define LLVM_DEBUGINFO_GSYM_OBJECTFILETRANSFORMER_H
+
+#include "llvm/Support/Error.h"
+
+namespace llvm {
+
+class raw_ostream;
+
+namespace object {
+class ObjectFile;
+}
+
+namespace gsym {
+
+class GsymCreator;
+
+class ObjectFileTransformer {
+public:
+  /// Extract any object file data that is needed by the GsymCreator.
+  ///
+  /// The extracted information includes the UUID of the binary and the
+  /// symbol table. Functions from the symbol table only have a name and an
+  /// address range, which is enough to symbolize code that has no debug info.
+  /// GsymCreator::finalize() prefers functions from the debug info when both
+  /// describe the same function.
+  ///
+  /// \param Obj The object file that contains the symbol table to parse.
+  ///
+  /// \param Log The stream to log warnings and non fatal issues to.
+  ///
+  /// \param Gsym The GSYM creator to populate with the function information
+  /// from the symbol table.
+  ///
+  /// \returns An error indicating any fatal issues that happen when parsing
+  /// the object file, or Error::success() if all goes well.
+  static llvm::Error convert(const object::ObjectFile &Obj, raw_ostream &Log,
+                             GsymCreator &Gsym);
+};
+
+} // namespace gsym
+} // namespace llvm
+
+#endif // #ifndef LLVM_DEBUGINFO_GSYM_OBJECTFILETRANSFORMER_H
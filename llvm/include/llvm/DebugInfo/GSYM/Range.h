@@ -21,10 +21,13 @@
 #define HEX64(v) llvm::format_hex(v, 18)
 
 namespace llvm {
+class DataExtractor;
 class raw_ostream;
 
 namespace gsym {
 
+class FileWriter;
+
 /// A class that represents an address range. The range is specified using
 /// a start and an end address.
 struct AddressRange {
@@ -47,6 +50,30 @@ struct AddressRange {
   bool operator<(const AddressRange &R) const {
     return std::make_pair(Start, End) < std::make_pair(R.Start, R.End);
   }
+
+  /// AddressRange objects are encoded and decoded to be relative to a base
+  /// address. This will be the FunctionInfo's start address if the
+  /// AddressRange is directly contained in a FunctionInfo, or a base address
+  /// of the containing parent AddressRange or AddressRanges. This allows
+  /// address ranges to be efficiently encoded using ULEB128 encodings as we
+  /// encode the offset and size of each range instead of full addresses. This
+  /// also makes any encoded addresses easy to relocate as we just need to
+  /// relocate the FunctionInfo's start address.
+  ///
+  /// \param O The binary stream to write the data to at the current file
+  /// position.
+  ///
+  /// \param BaseAddr The base address that the start address of this range
+  /// is relative to. The start address must be greater than or equal to it.
+  void encode(FileWriter &O, uint64_t BaseAddr) const;
+  void decode(DataExtractor &Data, uint64_t BaseAddr, uint64_t &Offset);
+  /// Skip an address range object in the specified data at the specified
+  /// offset.
+  ///
+  /// \param Data The binary stream to read the data from.
+  ///
+  /// \param Offset The byte offset within \a Data.
+  static void skip(DataExtractor &Data, uint64_t &Offset);
 };
 
 raw_ostream &operator<<(raw_ostream &OS, const AddressRange &R);
@@ -77,6 +104,22 @@ public:
   }
   Collection::const_iterator begin() const { return Ranges.begin(); }
   Collection::const_iterator end() const { return Ranges.end(); }
+
+  /// Address ranges are decoded and encoded to be relative to a base address.
+  /// See the AddressRange comments for the encode and decode methods for full
+  /// details.
+  void encode(FileWriter &O, uint64_t BaseAddr) const;
+  void decode(DataExtractor &Data, uint64_t BaseAddr, uint64_t &Offset);
+
+  /// Skip an address range object in the specified data a the specified
+  /// offset.
+  ///
+  /// \param Data The binary stream to read the data from.
+  ///
+  /// \param Offset The byte offset within \a Data.
+  ///
+  /// \returns The number of address ranges that were skipped.
+  static uint64_t skip(DataExtractor &Data, uint64_t &Offset);
 };
 
 raw_ostream &operator<<(raw_ostream &OS, const AddressRanges &AR);
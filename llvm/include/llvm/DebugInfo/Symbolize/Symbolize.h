@@ -44,6 +44,9 @@ public:
     std::vector<std::string> DsymHints;
     std::string FallbackDebugPath;
     std::string DWPName;
+    /// Use the GSYM file next to a binary, "<binary>.gsym", for line tables
+    /// and inline information when there is one.
+    bool UseGsym = false;
   };
 
   LLVMSymbolizer() = default;
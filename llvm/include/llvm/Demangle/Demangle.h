@@ -61,6 +61,19 @@ struct ItaniumPartialDemangler {
   /// second and third parameters to itaniumDemangle.
   char *finishDemangle(char *Buf, size_t *N) const;
 
+  /// Demangle the MangledLength characters at MangledName, which need not be
+  /// null-terminated, and print the result into Buf. Buf and N behave like
+  /// the second and third parameters to itaniumDemangle. The AST is built
+  /// in an arena that this object keeps across calls, so a caller that
+  /// passes the buffer of its previous call back in stops allocating once
+  /// the buffer and the arena fit the names it demangles. The AST is then
+  /// available to the rest of the member functions, as after
+  /// partialDemangle.
+  /// \return the demangled name, or nullptr if it is not a valid mangled
+  /// name, in which case Buf is left as it was
+  char *demangle(const char *MangledName, size_t MangledLength, char *Buf,
+                 size_t *N);
+
   /// Get the base name of a function. This doesn't include trailing template
   /// arguments, ie for "a::b<int>" this function returns "b".
   char *getFunctionBaseName(char *Buf, size_t *N) const;
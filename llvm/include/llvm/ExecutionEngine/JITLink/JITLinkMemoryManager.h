@@ -18,6 +18,8 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Memory.h"
 #include <cstdint>
+#include <map>
+#include <mutex>
 
 namespace llvm {
 namespace jitlink {
@@ -93,6 +95,40 @@ public:
   allocate(const SegmentsRequestMap &Request) override;
 };
 
+/// A JITLinkMemoryManager that carves in-process allocations out of a single
+/// slab of memory reserved up front.
+///
+/// Every allocation lies within the slab, so code and data from different
+/// links can reach each other with 32-bit PC-relative fixups (as required by
+/// the small code model) as long as the slab is at most 2Gb. Each link costs
+/// one mprotect per segment rather than an mmap/munmap per segment.
+class InProcessSlabMemoryManager : public JITLinkMemoryManager {
+public:
+  /// Reserve a slab of at least SlabSize bytes. SlabSize is rounded up to the
+  /// page size and must not exceed 2Gb.
+  static Expected<std::unique_ptr<InProcessSlabMemoryManager>>
+  Create(uint64_t SlabSize);
+
+  ~InProcessSlabMemoryManager() override;
+
+  Expected<std::unique_ptr<Allocation>>
+  allocate(const SegmentsRequestMap &Request) override;
+
+private:
+  class SlabAllocation;
+
+  InProcessSlabMemoryManager(sys::MemoryBlock Slab);
+
+  Expected<sys::MemoryBlock> reserve(uint64_t Size);
+  Error release(sys::MemoryBlock Block);
+
+  sys::MemoryBlock Slab;
+  std::mutex FreeRangesMutex;
+  // Free ranges of the slab, keyed by start address. Adjacent ranges are
+  // always coalesced.
+  std::map<char *, uint64_t> FreeRanges;
+};
+
 } // end namespace jitlink
 } // end namespace llvm
 
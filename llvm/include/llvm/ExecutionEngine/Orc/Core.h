@@ -118,6 +118,12 @@ using RegisterDependenciesFunction =
 /// are no dependants to register with.
 extern RegisterDependenciesFunction NoDependenciesToRegister;
 
+/// The priority of the materializations a lookup triggers. Dispatchers that
+/// queue work should run OnDemand materializations, which some thread is
+/// blocked on, before Speculative ones, which are only started in case their
+/// symbols are needed later.
+enum class MaterializationPriority : uint8_t { Speculative, OnDemand };
+
 /// Used to notify a JITDylib that the given set of symbols failed to
 /// materialize.
 class FailedToMaterialize : public ErrorInfo<FailedToMaterialize> {
@@ -752,6 +758,11 @@ public:
   using DispatchMaterializationFunction = std::function<void(
       JITDylib &JD, std::unique_ptr<MaterializationUnit> MU)>;
 
+  /// For dispatching MaterializationUnit::materialize calls in priority order.
+  using PrioritizedDispatchMaterializationFunction =
+      std::function<void(JITDylib &JD, std::unique_ptr<MaterializationUnit> MU,
+                         MaterializationPriority Priority)>;
+
   /// Construct an ExecutionSession.
   ///
   /// SymbolStringPools may be shared between ExecutionSessions.
@@ -760,6 +771,15 @@ public:
   /// Add a symbol name to the SymbolStringPool and return a pointer to it.
   SymbolStringPtr intern(StringRef SymName) { return SSP->intern(SymName); }
 
+  /// Add all of the given symbol names to the SymbolStringPool and return the
+  /// set of pointers to them.
+  template <typename RangeT> SymbolNameSet internAll(const RangeT &SymNames) {
+    auto Interned = SSP->internAll(SymNames);
+    SymbolNameSet Result(Interned.size());
+    Result.insert(Interned.begin(), Interned.end());
+    return Result;
+  }
+
   /// Returns a shared_ptr to the SymbolStringPool for this ExecutionSession.
   std::shared_ptr<SymbolStringPool> getSymbolStringPool() const { return SSP; }
 
@@ -810,6 +830,19 @@ public:
   /// Set the materialization dispatch function.
   ExecutionSession &setDispatchMaterialization(
       DispatchMaterializationFunction DispatchMaterialization) {
+    this->DispatchMaterialization =
+        [DispatchMaterialization](JITDylib &JD,
+                                  std::unique_ptr<MaterializationUnit> MU,
+                                  MaterializationPriority) {
+          DispatchMaterialization(JD, std::move(MU));
+        };
+    return *this;
+  }
+
+  /// Set a materialization dispatch function that is told the priority of
+  /// each materialization.
+  ExecutionSession &setPrioritizedDispatchMaterialization(
+      PrioritizedDispatchMaterializationFunction DispatchMaterialization) {
     this->DispatchMaterialization = std::move(DispatchMaterialization);
     return *this;
   }
@@ -845,9 +878,15 @@ public:
   /// dependenant symbols for this query (e.g. it is being made by a top level
   /// client to get an address to call) then the value NoDependenciesToRegister
   /// can be used.
+  ///
+  /// The materializations this lookup triggers are dispatched with the given
+  /// Priority. Lookups made ahead of need, e.g. by a speculator, should pass
+  /// MaterializationPriority::Speculative.
   void lookup(const JITDylibSearchList &SearchOrder, SymbolNameSet Symbols,
               SymbolState RequiredState, SymbolsResolvedCallback NotifyComplete,
-              RegisterDependenciesFunction RegisterDependencies);
+              RegisterDependenciesFunction RegisterDependencies,
+              MaterializationPriority Priority =
+                  MaterializationPriority::OnDemand);
 
   /// Blocking version of lookup above. Returns the resolved symbol map.
   /// If WaitUntilReady is true (the default), will not return until all
@@ -881,14 +920,19 @@ public:
                                       StringRef Symbol);
 
   /// Materialize the given unit.
-  void dispatchMaterialization(JITDylib &JD,
-                               std::unique_ptr<MaterializationUnit> MU) {
+  void dispatchMaterialization(
+      JITDylib &JD, std::unique_ptr<MaterializationUnit> MU,
+      MaterializationPriority Priority = MaterializationPriority::OnDemand) {
     LLVM_DEBUG({
       runSessionLocked([&]() {
-        dbgs() << "Dispatching " << *MU << " for " << JD.getName() << "\n";
+        dbgs() << "Dispatching " << *MU << " for " << JD.getName()
+               << (Priority == MaterializationPriority::Speculative
+                       ? " (speculative)"
+                       : "")
+               << "\n";
       });
     });
-    DispatchMaterialization(JD, std::move(MU));
+    DispatchMaterialization(JD, std::move(MU), Priority);
   }
 
   /// Dump the state of all the JITDylibs in this session.
@@ -901,7 +945,8 @@ private:
 
   static void
   materializeOnCurrentThread(JITDylib &JD,
-                             std::unique_ptr<MaterializationUnit> MU) {
+                             std::unique_ptr<MaterializationUnit> MU,
+                             MaterializationPriority Priority) {
     MU->doMaterialize(JD);
   }
 
@@ -911,16 +956,20 @@ private:
   std::shared_ptr<SymbolStringPool> SSP;
   VModuleKey LastKey = 0;
   ErrorReporter ReportError = logErrorsToStdErr;
-  DispatchMaterializationFunction DispatchMaterialization =
+  PrioritizedDispatchMaterializationFunction DispatchMaterialization =
       materializeOnCurrentThread;
 
   std::vector<std::unique_ptr<JITDylib>> JDs;
 
   // FIXME: Remove this (and runOutstandingMUs) once the linking layer works
   //        with callbacks from asynchronous queries.
+  struct OutstandingMU {
+    JITDylib *JD;
+    std::unique_ptr<MaterializationUnit> MU;
+    MaterializationPriority Priority;
+  };
   mutable std::recursive_mutex OutstandingMUsMutex;
-  std::vector<std::pair<JITDylib *, std::unique_ptr<MaterializationUnit>>>
-      OutstandingMUs;
+  std::vector<OutstandingMU> OutstandingMUs;
 };
 
 template <typename GeneratorT>
@@ -22,6 +22,8 @@
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/Support/ThreadPool.h"
+#include <deque>
+#include <mutex>
 
 namespace llvm {
 namespace orc {
@@ -133,12 +135,27 @@ protected:
 
   void recordCtorDtors(Module &M);
 
+  /// Queue a materialization to run on the compile threads.
+  void dispatchToCompileThreads(JITDylib &JD,
+                                std::unique_ptr<MaterializationUnit> MU,
+                                MaterializationPriority Priority);
+
+  /// Run the oldest of the highest priority queued materializations.
+  void runQueuedMaterialization();
+
   std::unique_ptr<ExecutionSession> ES;
   JITDylib &Main;
 
   DataLayout DL;
   std::unique_ptr<ThreadPool> CompileThreads;
 
+  /// The materializations waiting for a compile thread, one queue for each
+  /// MaterializationPriority. A compile thread picks the next one to run when
+  /// it becomes free, so on-demand work overtakes queued speculative work.
+  std::mutex QueuedMUsMutex;
+  std::deque<std::pair<JITDylib *, std::unique_ptr<MaterializationUnit>>>
+      QueuedMUs[2];
+
   std::unique_ptr<ObjectLayer> ObjLinkingLayer;
   std::unique_ptr<IRCompileLayer> CompileLayer;
 
@@ -195,6 +212,7 @@ public:
   Optional<JITTargetMachineBuilder> JTMB;
   ObjectLinkingLayerCreator CreateObjectLinkingLayer;
   CompileFunctionCreator CreateCompileFunction;
+  ObjectCache *ObjCache = nullptr;
   unsigned NumCompileThreads = 0;
 
   /// Called prior to JIT class construcion to fix up defaults.
@@ -241,6 +259,15 @@ public:
     return impl();
   }
 
+  /// Set an ObjectCache for the default compile function to use.
+  ///
+  /// The cache must outlive the JIT instance. It is ignored if a custom
+  /// CompileFunctionCreator is set.
+  SetterImpl &setObjectCache(ObjectCache *ObjCache) {
+    impl().ObjCache = ObjCache;
+    return impl();
+  }
+
   /// Set the number of compile threads to use.
   ///
   /// If set to zero, compilation will be performed on the execution thread when
@@ -0,0 +1,74 @@
+//===- PersistentObjectCache.h - On-disk object cache for ORC ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that stores the objects compiled by the JIT in a directory,
+// so that they can be reused by later processes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+class JITTargetMachineBuilder;
+
+/// An ObjectCache that keeps compiled objects in a directory on disk.
+///
+/// Objects are keyed by a hash of the LLVM version, the target configuration
+/// of the JIT and the bitcode of the module as it reaches the compiler, i.e.
+/// after any IR transforms. A module seen again, in this or a later process,
+/// is loaded from the cache instead of being compiled. The directory is kept
+/// within the bounds of a CachePruningPolicy as objects are added.
+///
+/// The cache is thread safe and can be shared by concurrent compilers.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Create a cache in CacheDir, creating the directory if needed, for the
+  /// objects compiled by TargetMachines that JTMB creates.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(StringRef CacheDir, const JITTargetMachineBuilder &JTMB,
+         CachePruningPolicy Policy = CachePruningPolicy());
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  /// Prune the cache directory according to the policy.
+  void prune();
+
+private:
+  PersistentObjectCache(std::string CacheDir, std::string TargetKey,
+                        CachePruningPolicy Policy);
+
+  std::string getEntryPath(const Module &M) const;
+
+  std::string CacheDir;
+  std::string TargetKey;
+  CachePruningPolicy Policy;
+
+  // The entry path computed when a module was looked up, reused when the
+  // object for the module is compiled to avoid hashing the module twice.
+  std::mutex PendingEntriesMutex;
+  DenseMap<const Module *, std::string> PendingEntries;
+
+  std::mutex PruneMutex;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
@@ -96,13 +96,16 @@ private:
         continue;
       const auto &ImplSymbolName = ImplSymbol.getPointer()->first;
       auto *ImplJD = ImplSymbol.getPointer()->second;
+      // Nothing waits for these compiles, so let the dispatcher run them
+      // after the materializations that lookups are blocked on.
       ES.lookup(JITDylibSearchList({{ImplJD, true}}),
                 SymbolNameSet({ImplSymbolName}), SymbolState::Ready,
                 [this](Expected<SymbolMap> Result) {
                   if (auto Err = Result.takeError())
                     ES.reportError(std::move(Err));
                 },
-                NoDependenciesToRegister);
+                NoDependenciesToRegister,
+                MaterializationPriority::Speculative);
     }
   }
 
@@ -14,9 +14,13 @@
 #define LLVM_EXECUTIONENGINE_ORC_SYMBOLSTRINGPOOL_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include <atomic>
 #include <mutex>
+#include <vector>
 
 namespace llvm {
 namespace orc {
@@ -33,6 +37,12 @@ public:
   /// Create a symbol string pointer from the given string.
   SymbolStringPtr intern(StringRef S);
 
+  /// Create symbol string pointers for each string in the given range, in the
+  /// same order. Each shard of the pool is locked at most once, which makes
+  /// this cheaper than interning the strings one at a time.
+  template <typename RangeT>
+  std::vector<SymbolStringPtr> internAll(const RangeT &Strings);
+
   /// Remove from the pool any entries that are no longer referenced.
   void clearDeadEntries();
 
@@ -42,8 +52,23 @@ private:
   using RefCountType = std::atomic<size_t>;
   using PoolMap = StringMap<RefCountType>;
   using PoolMapEntry = StringMapEntry<RefCountType>;
-  mutable std::mutex PoolMutex;
-  PoolMap Pool;
+
+  // The pool is split into independently locked shards so that threads
+  // interning different strings rarely contend with one another.
+  struct Shard {
+    mutable std::mutex Mutex;
+    PoolMap Map;
+  };
+
+  static constexpr unsigned NumShards = 16;
+
+  // Uses a different hash than StringMap so that the strings in a shard still
+  // spread over all of its buckets.
+  static unsigned getShardIndex(StringRef S) {
+    return hash_value(S) % NumShards;
+  }
+
+  Shard Shards[NumShards];
 };
 
 /// Pointer to a pooled string representing a symbol name.
@@ -143,30 +168,60 @@ private:
 inline SymbolStringPool::~SymbolStringPool() {
 #ifndef NDEBUG
   clearDeadEntries();
-  assert(Pool.empty() && "Dangling references at pool destruction time");
+  assert(empty() && "Dangling references at pool destruction time");
 #endif // NDEBUG
 }
 
 inline SymbolStringPtr SymbolStringPool::intern(StringRef S) {
-  std::lock_guard<std::mutex> Lock(PoolMutex);
+  auto &Shard = Shards[getShardIndex(S)];
+  std::lock_guard<std::mutex> Lock(Shard.Mutex);
   PoolMap::iterator I;
   bool Added;
-  std::tie(I, Added) = Pool.try_emplace(S, 0);
+  std::tie(I, Added) = Shard.Map.try_emplace(S, 0);
   return SymbolStringPtr(&*I);
 }
 
+template <typename RangeT>
+std::vector<SymbolStringPtr>
+SymbolStringPool::internAll(const RangeT &Strings) {
+  SmallVector<StringRef, 16> Strs;
+  SmallVector<std::pair<unsigned, size_t>, 16> ShardAndIndex;
+  for (StringRef S : Strings) {
+    ShardAndIndex.push_back(std::make_pair(getShardIndex(S), Strs.size()));
+    Strs.push_back(S);
+  }
+  llvm::sort(ShardAndIndex);
+
+  std::vector<SymbolStringPtr> Result(Strs.size());
+  for (auto I = ShardAndIndex.begin(), E = ShardAndIndex.end(); I != E;) {
+    unsigned ShardIdx = I->first;
+    auto &Shard = Shards[ShardIdx];
+    std::lock_guard<std::mutex> Lock(Shard.Mutex);
+    for (; I != E && I->first == ShardIdx; ++I)
+      Result[I->second] =
+          SymbolStringPtr(&*Shard.Map.try_emplace(Strs[I->second], 0).first);
+  }
+  return Result;
+}
+
 inline void SymbolStringPool::clearDeadEntries() {
-  std::lock_guard<std::mutex> Lock(PoolMutex);
-  for (auto I = Pool.begin(), E = Pool.end(); I != E;) {
-    auto Tmp = I++;
-    if (Tmp->second == 0)
-      Pool.erase(Tmp);
+  for (auto &Shard : Shards) {
+    std::lock_guard<std::mutex> Lock(Shard.Mutex);
+    for (auto I = Shard.Map.begin(), E = Shard.Map.end(); I != E;) {
+      auto Tmp = I++;
+      if (Tmp->second == 0)
+        Shard.Map.erase(Tmp);
+    }
   }
 }
 
 inline bool SymbolStringPool::empty() const {
-  std::lock_guard<std::mutex> Lock(PoolMutex);
-  return Pool.empty();
+  for (auto &Shard : Shards) {
+    std::lock_guard<std::mutex> Lock(Shard.Mutex);
+    if (!Shard.Map.empty())
+      return false;
+  }
+  return true;
 }
 
 } // end namespace orc
@@ -0,0 +1,119 @@
+//===- TieredCompileLayer.h - Recompile hot functions -----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// JIT layer that emits functions quickly first and recompiles the ones that
+// turn out to be hot through a second, optimizing layer.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
+#define LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
+
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/Support/ThreadPool.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class Function;
+
+namespace orc {
+
+/// Tiered compilation layer.
+///
+///   Each function definition in a module added to this layer is reached
+/// through an indirect stub. The stub initially points at a "tier-0" copy of
+/// the function emitted by BaseLayer (typically an unoptimized compile), whose
+/// entry block is instrumented with a call counter. Once a function has been
+/// called HotCallThreshold times it is cloned out of a pristine copy of its
+/// module and handed to OptimizingLayer on a background thread. When the
+/// optimized "tier-1" body is ready the stub's pointer is atomically updated to
+/// reach it; calls already running in the tier-0 body complete there.
+///
+///   The counters call back into the layer directly, so this layer only
+/// supports in-process JITs. OptimizingLayer must outlive this layer.
+class TieredCompileLayer : public IRLayer {
+public:
+  /// Builder for IndirectStubsManagers.
+  using IndirectStubsManagerBuilder =
+      std::function<std::unique_ptr<IndirectStubsManager>()>;
+
+  /// Construct a TieredCompileLayer.
+  TieredCompileLayer(ExecutionSession &ES, IRLayer &BaseLayer,
+                     IRLayer &OptimizingLayer,
+                     IndirectStubsManagerBuilder BuildIndirectStubsManager,
+                     uint64_t HotCallThreshold = 1000);
+
+  /// Block until every recompilation scheduled so far has completed.
+  void waitForRecompilations() { RecompileThreads.wait(); }
+
+  /// Emits the given module. This should not be called by clients: it will be
+  /// called by the JIT when a definition added via the add method is requested.
+  void emit(MaterializationResponsibility R, ThreadSafeModule TSM) override;
+
+private:
+  struct PerDylibResources {
+  public:
+    PerDylibResources(JITDylib &Tier0D, JITDylib &Tier1D,
+                      std::unique_ptr<IndirectStubsManager> ISMgr)
+        : Tier0D(Tier0D), Tier1D(Tier1D), ISMgr(std::move(ISMgr)) {}
+    JITDylib &getTier0Dylib() { return Tier0D; }
+    JITDylib &getTier1Dylib() { return Tier1D; }
+    IndirectStubsManager &getISManager() { return *ISMgr; }
+
+  private:
+    JITDylib &Tier0D;
+    JITDylib &Tier1D;
+    std::unique_ptr<IndirectStubsManager> ISMgr;
+  };
+
+  /// A function whose tier-0 body is counting calls.
+  struct TieredFunction {
+    PerDylibResources *PDR;
+    SymbolStringPtr Name;
+    std::string IRName;
+    std::shared_ptr<ThreadSafeModule> Source;
+  };
+
+  using PerDylibResourcesMap = std::map<const JITDylib *, PerDylibResources>;
+
+  PerDylibResources &getPerDylibResources(JITDylib &TargetD);
+
+  void instrumentFunction(Function &F, uint64_t Id);
+
+  static void notifyHotFunction(void *Ctx, uint64_t Id);
+
+  void recompile(uint64_t Id);
+
+  mutable std::mutex TieredLayerMutex;
+
+  IRLayer &BaseLayer;
+  IRLayer &OptimizingLayer;
+  IndirectStubsManagerBuilder BuildIndirectStubsManager;
+  uint64_t HotCallThreshold;
+  PerDylibResourcesMap DylibResources;
+  std::vector<TieredFunction> TieredFunctions;
+  SymbolLinkagePromoter PromoteSymbols;
+
+  // Declared last so that pending recompilations finish before the state
+  // they use is destroyed.
+  ThreadPool RecompileThreads{1};
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
@@ -61,6 +61,13 @@ enum {
 /// infrastructure, including the type and constant uniquing tables.
 /// LLVMContext itself provides no locking guarantees, so you should be careful
 /// to have one context per thread.
+///
+/// Locking the uniquing tables would not be enough to let several threads
+/// create IR in one context: the use lists of the constants, globals and
+/// metadata they share are updated by every instruction that refers to them.
+/// To use several threads on one module, split it into partitions and move
+/// each into a context of its own, as parallel code generation (splitCodeGen)
+/// and ParallelFunctionPipelinePass do.
 class LLVMContext {
 public:
   LLVMContextImpl *const pImpl;
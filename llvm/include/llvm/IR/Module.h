@@ -795,6 +795,13 @@ public:
   /// be called where all uses of the LLVMContext are understood.
   void dropTriviallyDeadConstantArrays();
 
+  /// Like dropTriviallyDeadConstantArrays(), but does nothing unless the number
+  /// of ConstantArrays in the LLVMContext has doubled since they were last
+  /// dropped. Calling this after each of many modules is linked keeps the
+  /// total cost linear, while the number of dead arrays stays bounded by the
+  /// number of arrays left by the last drop.
+  void dropTriviallyDeadConstantArraysIfGrown();
+
 /// @name Utility functions for printing and dumping Module objects
 /// @{
 
@@ -897,6 +897,7 @@ public:
 
     // Now erase the results that were marked above as invalidated.
     if (!IsResultInvalidated.empty()) {
+      PassInstrumentation PI = getCachedInstrumentation(IR);
       for (auto I = ResultsList.begin(), E = ResultsList.end(); I != E;) {
         AnalysisKey *ID = I->first;
         if (!IsResultInvalidated.lookup(ID)) {
@@ -907,6 +908,7 @@ public:
         if (DebugLogging)
           dbgs() << "Invalidating analysis: " << this->lookUpPass(ID).name()
                  << " on " << IR.getName() << "\n";
+        PI.runAnalysisInvalidated(this->lookUpPass(ID), IR);
 
         I = ResultsList.erase(I);
         AnalysisResults.erase({ID, &IR});
@@ -918,6 +920,17 @@ public:
   }
 
 private:
+  /// Get the instrumentation cached for \p IR, or one that does nothing if
+  /// there is none.
+  PassInstrumentation getCachedInstrumentation(IRUnitT &IR) const {
+    if (!AnalysisPasses.count(PassInstrumentationAnalysis::ID()))
+      return PassInstrumentation();
+    if (PassInstrumentation *PI =
+            getCachedResult<PassInstrumentationAnalysis>(IR))
+      return *PI;
+    return PassInstrumentation();
+  }
+
   /// Look up a registered analysis pass.
   PassConceptT &lookUpPass(AnalysisKey *ID) {
     typename AnalysisPassMapT::iterator PI = AnalysisPasses.find(ID);
@@ -989,6 +1002,8 @@ private:
     if (DebugLogging)
       dbgs() << "Invalidating analysis: " << this->lookUpPass(ID).name()
              << " on " << IR.getName() << "\n";
+    getCachedInstrumentation(IR).runAnalysisInvalidated(this->lookUpPass(ID),
+                                                        IR);
     AnalysisResultLists[&IR].erase(RI->second);
     AnalysisResults.erase(RI);
   }
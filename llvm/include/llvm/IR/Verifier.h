@@ -133,11 +133,23 @@ bool verifyModule(bool &BrokenDebugInfo, const Module &M, raw_ostream *OS);
 ///
 /// Note that this creates a pass suitable for the legacy pass manager. It has
 /// nothing to do with \c VerifierPass.
+///
+/// When run on a module with \p Incremental set, each function is verified
+/// through the cached function \c VerifierAnalysis, so only functions whose
+/// result was invalidated since the last run are checked again. The
+/// module-level checks always run, but those that correlate several functions
+/// (such as a subprogram attached to two functions) only see the functions
+/// verified in this run, and a pass that changes a function while claiming to
+/// preserve all analyses goes unnoticed. The dominator tree is always
+/// recomputed rather than taken from the analysis manager, so that a stale
+/// tree cannot hide a dominance violation.
 class VerifierPass : public PassInfoMixin<VerifierPass> {
   bool FatalErrors;
+  bool Incremental;
 
 public:
-  explicit VerifierPass(bool FatalErrors = true) : FatalErrors(FatalErrors) {}
+  explicit VerifierPass(bool FatalErrors = true, bool Incremental = false)
+      : FatalErrors(FatalErrors), Incremental(Incremental) {}
 
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
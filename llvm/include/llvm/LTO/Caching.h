@@ -30,9 +30,34 @@ using AddBufferFn =
 /// Create a local file system cache which uses the given cache directory and
 /// file callback. This function also creates the cache directory if it does not
 /// already exist.
+///
+/// New entries are written to a temporary file in the cache directory and
+/// renamed into place, so the directory may be shared by several machines,
+/// e.g. on NFS. Each use of an entry is recorded in the pruning index of the
+/// directory (see recordCacheFileUse() in llvm/Support/CachePruning.h).
 Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
                                        AddBufferFn AddBuffer);
 
+/// A key/value store for cached native objects, such as a remote caching
+/// service. Implementations must be thread safe.
+class CacheStorage {
+public:
+  virtual ~CacheStorage();
+
+  /// Look up the object for \p Key. Return nullptr if there is none. Errors
+  /// are treated like misses.
+  virtual Expected<std::unique_ptr<MemoryBuffer>> get(StringRef Key) = 0;
+
+  /// Store \p Object for \p Key. Errors are ignored, since the object is
+  /// still used for the link.
+  virtual Error put(StringRef Key, MemoryBufferRef Object) = 0;
+};
+
+/// Create a cache which keeps its entries in \p Storage, and passes the
+/// objects found in it to \p AddBuffer.
+NativeObjectCache storageCache(std::shared_ptr<CacheStorage> Storage,
+                               AddBufferFn AddBuffer);
+
 } // namespace lto
 } // namespace llvm
 
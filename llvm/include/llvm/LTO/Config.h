@@ -55,6 +55,12 @@ struct Config {
   /// Disable entirely the optimizer, including importing for ThinLTO
   bool CodeGenOnly = false;
 
+  /// With parallel code generation for regular LTO, run the optimization
+  /// pipeline on each partition, in parallel, instead of on the merged module
+  /// before it is split. Ignored if the merged module uses type metadata,
+  /// which whole-program devirtualization and CFI need to see at once.
+  bool OptimizePartitions = false;
+
   /// Run PGO context sensitive IR instrumentation.
   bool RunCSIRInstr = false;
 
@@ -117,6 +123,13 @@ struct Config {
   /// Statistics output file path.
   std::string StatsFile;
 
+  /// Whether the backend threads should record a time trace. The client must
+  /// have initialized the time trace profiler on the calling thread.
+  bool TimeTraceEnabled = false;
+
+  /// Time trace granularity (in microseconds) of the backend threads.
+  unsigned TimeTraceGranularity = 500;
+
   bool ShouldDiscardValueNames = true;
   DiagnosticHandlerFunction DiagHandler;
 
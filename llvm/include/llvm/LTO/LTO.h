@@ -224,7 +224,9 @@ using ThinBackend = std::function<std::unique_ptr<ThinBackendProc>(
     StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     AddStreamFn AddStream, NativeObjectCache Cache)>;
 
-/// This ThinBackend runs the individual backend jobs in-process.
+/// This ThinBackend runs the individual backend jobs in-process. The jobs are
+/// started once all of them are known, in order of decreasing cost as
+/// estimated from the instruction counts in the combined summary index.
 ThinBackend createInProcessThinBackend(unsigned ParallelismLevel);
 
 /// This ThinBackend writes individual module indexes to files, instead of
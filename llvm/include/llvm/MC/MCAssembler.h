@@ -123,6 +123,10 @@ private:
 
   MCDwarfLineTableParams LTParams;
 
+  /// The fragments of each section, indexed by section ordinal, that may
+  /// still change size during relaxation. Only valid during layout.
+  std::vector<std::vector<MCFragment *>> RelaxationWorklists;
+
   /// The set of function symbols for which a .thumb_func directive has
   /// been seen.
   //
@@ -183,13 +187,18 @@ private:
                                const MCAsmLayout &Layout) const;
 
   /// Perform one layout iteration and return true if any offsets
-  /// were adjusted.
-  bool layoutOnce(MCAsmLayout &Layout);
+  /// were adjusted. \p FirstStableSection is the index of the last section
+  /// that was relaxed in the previous iteration, and is updated for the next
+  /// one. Sections after it are skipped unless an earlier one changes.
+  bool layoutOnce(MCAsmLayout &Layout, unsigned &FirstStableSection);
 
   /// Perform one layout iteration of the given section and return true
   /// if any offsets were adjusted.
   bool layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec);
 
+  /// Return true if relaxation may still change the size of \p F.
+  bool isRelaxationCandidate(const MCFragment &F) const;
+
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
   bool relaxPaddingFragment(MCAsmLayout &Layout, MCPaddingFragment &PF);
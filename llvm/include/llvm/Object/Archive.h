@@ -175,6 +175,8 @@ public:
   using child_iterator = fallible_iterator<ChildFallibleIterator>;
 
   class Symbol {
+    friend class ArchiveSymbolIndex;
+
     const Archive *Parent;
     uint32_t SymbolIndex;
     uint32_t StringIndex; // Extra index to the string.
@@ -253,7 +255,8 @@ public:
     return v->isArchive();
   }
 
-  // check if a symbol is in the archive
+  // check if a symbol is in the archive. This walks the symbol table, use an
+  // ArchiveSymbolIndex to look up many symbols.
   Expected<Optional<Child>> findSym(StringRef name) const;
 
   bool isEmpty() const;
@@ -279,6 +282,34 @@ private:
   mutable std::vector<std::unique_ptr<MemoryBuffer>> ThinBuffers;
 };
 
+/// A hash table over the symbol table of an archive. Building it walks the
+/// symbol table once; each lookup then takes constant time instead of the
+/// linear walk of Archive::findSym, so that a linker can look up only the
+/// symbols it needs in a large archive instead of registering all of them.
+/// The table only holds indices into the symbol table of the archive, which
+/// must outlive it.
+class ArchiveSymbolIndex {
+public:
+  explicit ArchiveSymbolIndex(const Archive &A);
+
+  /// Return the first symbol named \p Name in the symbol table, if any.
+  Optional<Archive::Symbol> lookup(StringRef Name) const;
+
+  /// Return the number of distinct symbol names in the index.
+  size_t size() const { return NumEntries; }
+
+private:
+  struct Bucket {
+    uint32_t Hash = 0;
+    uint32_t SymbolIndex = UINT32_MAX;
+    uint32_t StringIndex = 0;
+  };
+
+  const Archive &Parent;
+  std::vector<Bucket> Buckets;
+  size_t NumEntries = 0;
+};
+
 } // end namespace object
 } // end namespace llvm
 
@@ -15,12 +15,16 @@
 #ifndef LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 #define LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/PassInstrumentation.h"
 #include "llvm/IR/PassTimingInfo.h"
 
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -53,11 +57,97 @@ private:
   bool StoreModuleDesc = false;
 };
 
+/// Instrumentation to find the passes that cause analyses to be computed
+/// again, enabled with -audit-analysis-invalidation.
+///
+/// When the result of an analysis is invalidated, the pass that ran last is
+/// taken as the cause. When the analysis is next computed for the same IR
+/// unit, its time, without that of the analyses it requires, is charged to
+/// that pass. The totals are printed, largest first, on destruction.
+class AnalysisInvalidationAudit {
+public:
+  AnalysisInvalidationAudit() = default;
+  ~AnalysisInvalidationAudit() { print(); }
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Print the totals and reset them.
+  void print();
+
+private:
+  void analysisInvalidated(StringRef AnalysisID, Any IR);
+  void beforeAnalysis();
+  void afterAnalysis(StringRef AnalysisID, Any IR);
+
+  /// An analysis on an IR unit.
+  using ResultKey = std::pair<const void *, StringRef>;
+
+  struct Recomputations {
+    unsigned Count = 0;
+    double Seconds = 0;
+  };
+
+  /// The pass that finished last.
+  StringRef LastPassID;
+  /// The results that were computed at least once.
+  DenseSet<ResultKey> Computed;
+  /// The pass that invalidated each result that has not been recomputed yet.
+  DenseMap<ResultKey, StringRef> InvalidatedBy;
+  /// The start time, and the time of the nested analyses, of each analysis
+  /// that is running.
+  SmallVector<std::pair<double, double>, 4> RunningAnalyses;
+  /// The recomputations of each analysis caused by each pass.
+  DenseMap<std::pair<StringRef, StringRef>, Recomputations> Totals;
+};
+
+/// Instrumentation that records each run of a pass, enabled with
+/// -pass-telemetry-file=<file>.
+///
+/// For every pass run on every IR unit it records the wall time, the number of
+/// instructions in the unit before and after, and the change in the memory
+/// allocated with malloc. On destruction the records are appended to the file
+/// as JSON, one object per line, so that the compilations of a whole build can
+/// share one file. With -ftime-trace, every pass run is added to the trace as
+/// well.
+class PassTelemetry {
+public:
+  PassTelemetry() = default;
+  ~PassTelemetry() { write(); }
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Append the records to the telemetry file and clear them.
+  void write();
+
+private:
+  void beforePass(StringRef PassID, Any IR);
+  void afterPass(StringRef PassID, Optional<Any> IR);
+
+  struct Run {
+    StringRef PassID;
+    std::string ModuleID;
+    std::string IRName;
+    double Seconds;
+    int64_t InstructionsBefore;
+    // -1 if the IR unit was invalidated by the pass.
+    int64_t InstructionsAfter;
+    int64_t MallocDelta;
+  };
+
+  bool Record = false;
+  bool TimeTrace = false;
+  /// The passes that are running, with their start time and malloc usage.
+  SmallVector<std::pair<Run, size_t>, 4> Running;
+  std::vector<Run> Runs;
+};
+
 /// This class provides an interface to register all the standard pass
 /// instrumentations and manages their state (if any).
 class StandardInstrumentations {
   PrintIRInstrumentation PrintIR;
   TimePassesHandler TimePasses;
+  AnalysisInvalidationAudit InvalidationAudit;
+  PassTelemetry Telemetry;
 
 public:
   StandardInstrumentations() = default;
@@ -19,6 +19,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/None.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/iterator.h"
@@ -54,7 +55,8 @@ enum class coveragemap_error {
   no_data_found,
   unsupported_version,
   truncated,
-  malformed
+  malformed,
+  decompression_failed
 };
 
 const std::error_category &coveragemap_category();
@@ -508,6 +510,7 @@ public:
 class CoverageMapping {
   DenseMap<size_t, DenseSet<size_t>> RecordProvenance;
   std::vector<FunctionRecord> Functions;
+  DenseMap<size_t, SmallVector<unsigned, 0>> FilenameHash2RecordIndices;
   std::vector<std::pair<std::string, uint64_t>> FuncHashMismatches;
 
   CoverageMapping() = default;
@@ -516,20 +519,44 @@ class CoverageMapping {
   Error loadFunctionRecord(const CoverageMappingRecord &Record,
                            IndexedInstrProfReader &ProfileReader);
 
+  /// Add the function records of the \p NumRecords records of
+  /// \p CoverageReader, decoding them on \p NumThreads threads. The records
+  /// are added in the same order as loadFunctionRecord() would add them.
+  Error
+  loadFunctionRecordsInParallel(const CoverageMappingReader &CoverageReader,
+                                size_t NumRecords,
+                                IndexedInstrProfReader &ProfileReader,
+                                unsigned NumThreads);
+
+  /// Add \p Function, unless a record for the same function and files was
+  /// already added.
+  void addFunctionRecord(FunctionRecord &&Function);
+
+  /// Look up the indices for function records which are at least partially
+  /// defined in the specified file. This is guaranteed to return a superset of
+  /// such records: extra records not in the file may be included if there is
+  /// a hash collision on the filename. Clients must be robust to collisions.
+  ArrayRef<unsigned>
+  getImpreciseRecordIndicesForFilename(StringRef Filename) const;
+
 public:
   CoverageMapping(const CoverageMapping &) = delete;
   CoverageMapping &operator=(const CoverageMapping &) = delete;
 
   /// Load the coverage mapping using the given readers.
+  ///
+  /// The records of the readers which support random access are decoded on
+  /// \p NumThreads threads, or on as many threads as the hardware supports if
+  /// \p NumThreads is 0. The result doesn't depend on the number of threads.
   static Expected<std::unique_ptr<CoverageMapping>>
   load(ArrayRef<std::unique_ptr<CoverageMappingReader>> CoverageReaders,
-       IndexedInstrProfReader &ProfileReader);
+       IndexedInstrProfReader &ProfileReader, unsigned NumThreads = 1);
 
   /// Load the coverage mapping from the given object files and profile. If
   /// \p Arches is non-empty, it must specify an architecture for each object.
   static Expected<std::unique_ptr<CoverageMapping>>
   load(ArrayRef<StringRef> ObjectFilenames, StringRef ProfileFilename,
-       ArrayRef<StringRef> Arches = None);
+       ArrayRef<StringRef> Arches = None, unsigned NumThreads = 1);
 
   /// The number of functions that couldn't have their profiles mapped.
   ///
@@ -767,7 +794,11 @@ enum CovMapVersion {
   // A new interpretation of the columnEnd field is added in order to mark
   // regions as gap areas.
   Version3 = 2,
-  // The current version is Version3
+  // The filenames and the coverage mappings of a translation unit are each
+  // preceded by their uncompressed and compressed sizes, and are stored
+  // zlib-compressed when that makes them smaller.
+  Version4 = 3,
+  // The current version is Version4
   CurrentVersion = INSTR_PROF_COVMAP_VERSION
 };
 
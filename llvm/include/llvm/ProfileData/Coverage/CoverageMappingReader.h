@@ -15,6 +15,8 @@
 #define LLVM_PROFILEDATA_COVERAGE_COVERAGEMAPPINGREADER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/InstrProf.h"
@@ -40,6 +42,18 @@ struct CoverageMappingRecord {
   ArrayRef<CounterMappingRegion> MappingRegions;
 };
 
+/// Storage for the arrays a decoded CoverageMappingRecord refers to.
+struct CoverageMappingRecordBuffers {
+  std::vector<StringRef> Filenames;
+  std::vector<CounterExpression> Expressions;
+  std::vector<CounterMappingRegion> MappingRegions;
+};
+
+/// Owner of the buffers holding decompressed coverage mapping data, which the
+/// decoded filenames and mappings refer to.
+using DecompressedCoverageData =
+    std::vector<std::unique_ptr<SmallVector<char, 0>>>;
+
 /// A file format agnostic iterator over coverage mapping data.
 class CoverageMappingIterator
     : public std::iterator<std::input_iterator_tag, CoverageMappingRecord> {
@@ -96,6 +110,20 @@ public:
   virtual ~CoverageMappingReader() = default;
 
   virtual Error readNextRecord(CoverageMappingRecord &Record) = 0;
+
+  /// Return the number of records if they can be decoded in any order with
+  /// readRecord(), or None if they can only be read sequentially.
+  virtual Optional<size_t> getNumRecords() const { return None; }
+
+  /// Decode the record at \p Index into \p Record, whose arrays are stored in
+  /// \p Buffers. Unlike readNextRecord(), this doesn't change the state of the
+  /// reader, so several threads can decode records at once as long as they use
+  /// different buffers.
+  virtual Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                           CoverageMappingRecordBuffers &Buffers) const {
+    llvm_unreachable("Reader does not support random access");
+  }
+
   CoverageMappingIterator begin() { return CoverageMappingIterator(this); }
   CoverageMappingIterator end() { return CoverageMappingIterator(); }
 };
@@ -111,12 +139,19 @@ protected:
   Error readIntMax(uint64_t &Result, uint64_t MaxPlus1);
   Error readSize(uint64_t &Result);
   Error readString(StringRef &Result);
+  /// Read data that may be compressed, as written by the Version4 writers.
+  /// If it was compressed, \p Result refers to a buffer added to
+  /// \p Decompressed.
+  Error readCompressible(StringRef &Result,
+                         DecompressedCoverageData &Decompressed);
 };
 
 /// Reader for the raw coverage filenames.
 class RawCoverageFilenamesReader : public RawCoverageReader {
   std::vector<StringRef> &Filenames;
 
+  Error readUncompressed(uint64_t NumFilenames);
+
 public:
   RawCoverageFilenamesReader(StringRef Data, std::vector<StringRef> &Filenames)
       : RawCoverageReader(Data), Filenames(Filenames) {}
@@ -124,7 +159,9 @@ public:
   RawCoverageFilenamesReader &
   operator=(const RawCoverageFilenamesReader &) = delete;
 
-  Error read();
+  /// Read the filenames encoded in the format of \p Version. Decompressed
+  /// filenames refer to buffers added to \p Decompressed.
+  Error read(CovMapVersion Version, DecompressedCoverageData &Decompressed);
 };
 
 /// Checks if the given coverage mapping data is exported for
@@ -192,10 +229,9 @@ private:
   std::vector<StringRef> Filenames;
   std::vector<ProfileMappingRecord> MappingRecords;
   InstrProfSymtab ProfileNames;
+  DecompressedCoverageData Decompressed;
   size_t CurrentRecord = 0;
-  std::vector<StringRef> FunctionsFilenames;
-  std::vector<CounterExpression> Expressions;
-  std::vector<CounterMappingRegion> MappingRegions;
+  CoverageMappingRecordBuffers CurrentBuffers;
 
   BinaryCoverageReader() = default;
 
@@ -214,6 +250,13 @@ public:
                                  support::endianness Endian);
 
   Error readNextRecord(CoverageMappingRecord &Record) override;
+
+  Optional<size_t> getNumRecords() const override {
+    return MappingRecords.size();
+  }
+
+  Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                   CoverageMappingRecordBuffers &Buffers) const override;
 };
 
 } // end namespace coverage
@@ -17,6 +17,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
+#include <string>
 
 namespace llvm {
 
@@ -33,8 +34,23 @@ public:
   CoverageFilenamesSectionWriter(ArrayRef<StringRef> Filenames)
       : Filenames(Filenames) {}
 
-  /// Write encoded filenames to the given output stream.
-  void write(raw_ostream &OS);
+  /// Write encoded filenames to the given output stream. If \p Compress is
+  /// true and zlib is available, the filenames are compressed.
+  void write(raw_ostream &OS, bool Compress = true);
+};
+
+/// Writer of the coverage mappings of the functions of a translation unit,
+/// which follow its filenames in the coverage mapping section.
+class CoverageMappingsSectionWriter {
+  ArrayRef<std::string> Mappings;
+
+public:
+  CoverageMappingsSectionWriter(ArrayRef<std::string> Mappings)
+      : Mappings(Mappings) {}
+
+  /// Write the concatenated mappings to the given output stream. If
+  /// \p Compress is true and zlib is available, the mappings are compressed.
+  void write(raw_ostream &OS, bool Compress = true);
 };
 
 /// Writer for instrumentation based coverage mapping data.
@@ -355,6 +355,8 @@ struct InstrProfReaderIndexBase {
   virtual bool isIRLevelProfile() const = 0;
   virtual bool hasCSIRLevelProfile() const = 0;
   virtual Error populateSymtab(InstrProfSymtab &) = 0;
+  // Fault in the hash table entries of the given functions ahead of lookups.
+  virtual void prefetchRecords(ArrayRef<StringRef> FuncNames) = 0;
 };
 
 using OnDiskHashTableImplV3 =
@@ -405,6 +407,8 @@ public:
   Error populateSymtab(InstrProfSymtab &Symtab) override {
     return Symtab.create(HashTable->keys());
   }
+
+  void prefetchRecords(ArrayRef<StringRef> FuncNames) override;
 };
 
 /// Name matcher supporting fuzzy matching of symbol names to names in profiles.
@@ -468,6 +472,23 @@ public:
   Expected<InstrProfRecord> getInstrProfRecord(StringRef FuncName,
                                                uint64_t FuncHash);
 
+  /// Like getInstrProfRecord, but return a reference to the record decoded by
+  /// the reader instead of a copy. The reference is only valid until the next
+  /// lookup or read from this reader.
+  Expected<const NamedInstrProfRecord &>
+  getInstrProfRecordRef(StringRef FuncName, uint64_t FuncHash);
+
+  /// Touch the on-disk hash table entries of \p FuncNames in file order.
+  ///
+  /// Lookups jump around the profile at random, which for a large memory
+  /// mapped profile means one page fault per function. Calling this with all
+  /// the functions that are about to be looked up instead reads the profile
+  /// front to back, which read-ahead handles much better. Names are used as
+  /// is, without applying the remapping file.
+  void prefetchRecords(ArrayRef<StringRef> FuncNames) {
+    Index->prefetchRecords(FuncNames);
+  }
+
   /// Fill Counts with the profile data for the given function name.
   Error getFunctionCounts(StringRef FuncName, uint64_t FuncHash,
                           std::vector<uint64_t> &Counts);
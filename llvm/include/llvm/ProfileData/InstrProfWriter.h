@@ -56,7 +56,9 @@ public:
     addRecord(std::move(I), 1, Warn);
   }
 
-  /// Merge existing function counts from the given writer.
+  /// Merge existing function counts from the given writer. The profile kind
+  /// of \p IPW is merged too, and mixing FE and IR level profiles is reported
+  /// through \p Warn.
   void mergeRecordsFromWriter(InstrProfWriter &&IPW,
                               function_ref<void(Error)> Warn);
 
@@ -97,6 +99,10 @@ public:
     return Error::success();
   }
 
+  /// Return the kind of the profiles added so far, or PF_Unknown if no
+  /// profile has been added.
+  ProfKind getProfileKind() const { return ProfileKind; }
+
   // Internal interface for testing purpose only.
   void setValueProfDataEndianness(support::endianness Endianness);
   void setOutputSparse(bool Sparse);
@@ -49,7 +49,10 @@ enum class sampleprof_error {
   truncated_name_table,
   not_implemented,
   counter_overflow,
-  ostream_seek_unsupported
+  ostream_seek_unsupported,
+  compress_failed,
+  uncompress_failed,
+  zlib_unavailable
 };
 
 inline std::error_code make_error_code(sampleprof_error E) {
@@ -83,6 +86,7 @@ enum SampleProfileFormat {
   SPF_Text = 0x1,
   SPF_Compact_Binary = 0x2,
   SPF_GCC = 0x3,
+  SPF_Ext_Binary = 0x4,
   SPF_Binary = 0xff
 };
 
@@ -105,6 +109,33 @@ static inline StringRef getRepInFormat(StringRef Name,
 
 static inline uint64_t SPVersion() { return 103; }
 
+/// Types of the sections of the extensible binary format. The numbers are
+/// part of the format, new section types must be added at the end.
+enum SecType {
+  SecInValid = 0,
+  SecProfSummary = 1,
+  SecNameTable = 2,
+  SecLBRProfile = 3,
+  SecFuncOffsetTable = 4
+};
+
+/// Flags of a section of the extensible binary format.
+enum SecFlags : uint64_t {
+  SecFlagInValid = 0,
+  /// The section is compressed with zlib.
+  SecFlagCompress = (1 << 0)
+};
+
+/// An entry of the section header table of the extensible binary format.
+struct SecHdrTableEntry {
+  SecType Type;
+  uint64_t Flags;
+  /// Offset of the section from the start of the profile.
+  uint64_t Offset;
+  /// Size of the section as stored in the profile.
+  uint64_t Size;
+};
+
 /// Represents the relative location of an instruction.
 ///
 /// Instruction locations are specified by the line offset from the
@@ -203,6 +203,26 @@
 //          in the text format documentation above).
 //        FUNCTION BODY
 //          A FUNCTION BODY entry describing the inlined function.
+//
+// EXTENSIBLE BINARY FORMAT
+//
+// The extensible binary format stores the same data as the binary format in
+// sections, which can be individually compressed:
+//
+// MAGIC NUMBER, VERSION
+//    Like the binary format, with the SPF_Ext_Binary magic number.
+// SECTION HEADER TABLE
+//    NUM_SECTIONS (uint64_t)
+//    SECTION HEADERS
+//      A list of NUM_SECTIONS entries of four fixed size 64-bit numbers each:
+//        TYPE, FLAGS, OFFSET (from the start of the profile) and SIZE.
+// SECTIONS
+//    The profile summary, the name table, the function bodies and a table
+//    mapping the name index of every function to the offset of its body
+//    from the start of the function body section. The reader uses the
+//    offset table to only decode the functions of the current module.
+//    A compressed section is made of its uncompressed size (uint64_t), its
+//    compressed size (uint64_t) and the zlib compressed data.
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_PROFILEDATA_SAMPLEPROFREADER_H
@@ -410,6 +430,9 @@ protected:
   /// Return true if we've reached the end of file.
   bool at_eof() const { return Data >= End; }
 
+  /// Read the magic number and the version of the profile.
+  std::error_code readMagicIdent();
+
   /// Read the next function profile instance.
   std::error_code readFuncProfile();
 
@@ -422,13 +445,13 @@ protected:
   /// Points to the end of the buffer.
   const uint8_t *End = nullptr;
 
+  /// Read profile summary.
+  std::error_code readSummary();
+
 private:
   std::error_code readSummaryEntry(std::vector<ProfileSummaryEntry> &Entries);
   virtual std::error_code verifySPMagic(uint64_t Magic) = 0;
 
-  /// Read profile summary.
-  std::error_code readSummary();
-
   /// Read the whole name table.
   virtual std::error_code readNameTable() = 0;
 
@@ -486,6 +509,49 @@ public:
   void collectFuncsToUse(const Module &M) override;
 };
 
+class SampleProfileReaderExtBinary : public SampleProfileReaderBinary {
+private:
+  /// The section header table, in the order the sections are read.
+  std::vector<SecHdrTableEntry> SecHdrTable;
+  /// Buffers holding the decompressed sections. The name table and the
+  /// profiles may reference them.
+  std::vector<std::unique_ptr<WritableMemoryBuffer>> DecompressedBuffers;
+  /// Function name table.
+  std::vector<StringRef> NameTable;
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards the start of the function profile section.
+  DenseMap<StringRef, uint64_t> FuncOffsetTable;
+  /// The set containing the functions to use when compiling a module.
+  DenseSet<StringRef> FuncsToUse;
+  /// Use all functions from the input profile.
+  bool UseAllFuncs = true;
+  virtual std::error_code verifySPMagic(uint64_t Magic) override;
+  virtual std::error_code readNameTable() override;
+  /// Read a string indirectly via the name table.
+  virtual ErrorOr<StringRef> readStringFromTable() override;
+  std::error_code readSecHdrTable();
+  std::error_code readOneSection(const SecHdrTableEntry &Entry);
+  std::error_code decompressSection();
+  std::error_code readFuncOffsetTable();
+  std::error_code readFuncProfiles();
+
+public:
+  SampleProfileReaderExtBinary(std::unique_ptr<MemoryBuffer> B, LLVMContext &C)
+      : SampleProfileReaderBinary(std::move(B), C, SPF_Ext_Binary) {}
+
+  /// \brief Return true if \p Buffer is in the format supported by this class.
+  static bool hasFormat(const MemoryBuffer &Buffer);
+
+  /// Read and validate the file header.
+  virtual std::error_code readHeader() override;
+
+  /// Read the sections, decoding only the profiles of the functions to use.
+  std::error_code read() override;
+
+  /// Collect functions to be used when compiling Module \p M.
+  void collectFuncsToUse(const Module &M) override;
+};
+
 using InlineCallStack = SmallVector<FunctionSamples *, 10>;
 
 // Supported histogram types in GCC.  Currently, we only need support for
@@ -13,6 +13,7 @@
 #define LLVM_PROFILEDATA_SAMPLEPROFWRITER_H
 
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/ProfileSummary.h"
@@ -45,6 +46,10 @@ public:
 
   raw_ostream &getOutputStream() { return *OutputStream; }
 
+  /// Compress every section of the profile. This only has an effect for
+  /// formats that are made of sections.
+  virtual void setToCompressAllSections() {}
+
   /// Profile writer factory.
   ///
   /// Create a new file writer based on the value of \p Format.
@@ -64,6 +69,10 @@ protected:
   virtual std::error_code
   writeHeader(const StringMap<FunctionSamples> &ProfileMap) = 0;
 
+  /// Write all the function profiles in \p ProfileMap, hottest first.
+  std::error_code
+  writeFuncProfiles(const StringMap<FunctionSamples> &ProfileMap);
+
   /// Output stream where to emit the profile to.
   std::unique_ptr<raw_ostream> OutputStream;
 
@@ -107,7 +116,7 @@ public:
       : SampleProfileWriter(OS) {}
 
 protected:
-  virtual std::error_code writeNameTable() = 0;
+  virtual std::error_code writeNameTable();
   virtual std::error_code writeMagicIdent() = 0;
   virtual std::error_code
   writeHeader(const StringMap<FunctionSamples> &ProfileMap) override;
@@ -116,11 +125,12 @@ protected:
   std::error_code writeBody(const FunctionSamples &S);
   inline void stablizeNameTable(std::set<StringRef> &V);
 
+  void addName(StringRef FName);
+  void addNames(const FunctionSamples &S);
+
   MapVector<StringRef, uint32_t> NameTable;
 
 private:
-  void addName(StringRef FName);
-  void addNames(const FunctionSamples &S);
 
   friend ErrorOr<std::unique_ptr<SampleProfileWriter>>
   SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
@@ -131,10 +141,76 @@ class SampleProfileWriterRawBinary : public SampleProfileWriterBinary {
   using SampleProfileWriterBinary::SampleProfileWriterBinary;
 
 protected:
-  virtual std::error_code writeNameTable() override;
   virtual std::error_code writeMagicIdent() override;
 };
 
+// ExtBinary is a binary format made of sections, so that a reader only needs
+// to decode the parts of the profile it uses. Its layout is as follows:
+//
+//    Part1: Magic number and version, like the Binary format.
+//    Part2: Section header table: the number of sections, then the type,
+//           flags, offset and size of every section. These are fixed size
+//           numbers so they can be filled in after the sections are written.
+//    Part3: The sections:
+//             SecProfSummary: the profile summary.
+//             SecNameTable: the name table, encoded like the Binary format.
+//             SecLBRProfile: the function profiles.
+//             SecFuncOffsetTable: maps the name index of every function to
+//                                 the offset of its profile from the start
+//                                 of SecLBRProfile.
+//
+// SecFuncOffsetTable is written after SecLBRProfile because the offsets are
+// only known once the profiles are written. Its entry in the section header
+// table comes before the one of SecLBRProfile, so a reader that goes through
+// the table in order has the offsets at hand when it gets to the profiles.
+//
+// Any section can be compressed with zlib. A compressed section starts with
+// its uncompressed and compressed sizes, followed by the compressed data.
+class SampleProfileWriterExtBinary : public SampleProfileWriterBinary {
+  using SampleProfileWriterBinary::SampleProfileWriterBinary;
+
+public:
+  virtual std::error_code write(const FunctionSamples &S) override;
+  virtual std::error_code
+  write(const StringMap<FunctionSamples> &ProfileMap) override;
+
+  void setToCompressAllSections() override;
+  void setToCompressSection(SecType Type);
+
+protected:
+  virtual std::error_code writeMagicIdent() override;
+  virtual std::error_code
+  writeHeader(const StringMap<FunctionSamples> &ProfileMap) override;
+
+private:
+  /// Start writing section \p Type at position \p LayoutIndex of the
+  /// section header table.
+  void startSection(SecType Type, unsigned LayoutIndex);
+  /// Finish the current section, compressing it if requested.
+  std::error_code endSection();
+  std::error_code writeFuncOffsetTable();
+  std::error_code writeSecHdrTable();
+
+  /// The sections in the order of the section header table.
+  SmallVector<SecHdrTableEntry, 4> SecHdrTable;
+  /// The offset of the section header table towards profile start.
+  uint64_t SecHdrTableOffset = 0;
+  /// The section header table index of the section being written.
+  unsigned CurrentLayoutIndex = 0;
+  /// The offset of the data of the section being written, in the stream it
+  /// is written to.
+  uint64_t SecDataStart = 0;
+  /// The sections to compress.
+  SmallVector<SecType, 4> SectionsToCompress;
+  /// While a compressed section is written, OutputStream points to a buffer
+  /// and the real output stream is kept here.
+  std::unique_ptr<raw_ostream> SavedOutputStream;
+  std::string SectionBuffer;
+  /// The table mapping from function name to the offset of its FunctionSample
+  /// towards the start of SecLBRProfile.
+  MapVector<StringRef, uint64_t> FuncOffsetTable;
+};
+
 // CompactBinary is a compact format of binary profile which both reduces
 // the profile size and the load time needed when compiling. It has two
 // major difference with Binary format.
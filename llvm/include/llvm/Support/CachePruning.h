@@ -14,7 +14,9 @@
 #ifndef LLVM_SUPPORT_CACHE_PRUNING_H
 #define LLVM_SUPPORT_CACHE_PRUNING_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Chrono.h"
 #include <chrono>
 
 namespace llvm {
@@ -57,6 +59,15 @@ struct CachePruningPolicy {
   /// 4096 and large_dir disabled), there is a per-directory entry limit of
   /// 508*510*floor(4096/(40+8))~=20M for average filename length of 40.
   uint64_t MaxSizeFiles = 1000000;
+
+  /// If set, pruning finds the cache files from the index that caches record
+  /// their files in with recordCacheFileUse(), rather than by listing and
+  /// stat()ing the whole directory, which is slow for large or remote caches.
+  /// The directory is still listed once per FullScanInterval, to pick up
+  /// files missing from the index. The times recorded in the index also
+  /// stand in for access times on file systems that do not maintain them,
+  /// such as shared network file systems mounted with noatime.
+  llvm::Optional<std::chrono::seconds> FullScanInterval;
 };
 
 /// Parse the given string as a cache pruning policy. Defaults are taken from a
@@ -66,6 +77,13 @@ struct CachePruningPolicy {
 /// and maximum cache size of 50% of available disk space.
 Expected<CachePruningPolicy> parseCachePruningPolicy(StringRef PolicyStr);
 
+/// Record in the pruning index of the cache directory \p Path that the cache
+/// file \p Name, which is \p Size bytes large, was created or used at \p Time.
+/// This is safe to call concurrently from several processes. Failures are
+/// ignored, as the index is only a hint for pruning.
+void recordCacheFileUse(StringRef Path, StringRef Name, uint64_t Size,
+                        sys::TimePoint<> Time = std::chrono::system_clock::now());
+
 /// Peform pruning using the supplied policy, returns true if pruning
 /// occurred, i.e. if Policy.Interval was expired.
 ///
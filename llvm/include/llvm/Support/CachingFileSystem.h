@@ -0,0 +1,91 @@
+//===- CachingFileSystem.h - Thread-safe shared file system cache -*- C++ -*-=//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines a cache of file statuses and contents that several file systems,
+/// possibly used from different threads, can share.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_CACHINGFILESYSTEM_H
+#define LLVM_SUPPORT_CACHINGFILESYSTEM_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace llvm {
+namespace vfs {
+
+/// The statuses and contents of the files read through the file systems
+/// created by \c createCachingFileSystem.
+///
+/// The first file system to look at a path fills in its entry, and every file
+/// system sharing the cache reuses it, including the fact that a file does not
+/// exist. Files with identical contents share a single buffer.
+///
+/// Nothing is ever invalidated: the cache suits tools that look at a tree that
+/// does not change while they run. The cache must outlive the file systems
+/// using it and the buffers they hand out.
+class SharedFileSystemCache {
+public:
+  /// The cached state of a single absolute path.
+  struct Entry {
+    std::mutex Lock;
+    bool HasStatus = false;
+    ErrorOr<Status> Stat = std::error_code();
+    bool HasContents = false;
+    std::error_code OpenError;
+    const MemoryBuffer *Contents = nullptr;
+  };
+
+  SharedFileSystemCache();
+
+  /// Returns the entry of \p Path, creating an empty one if needed. This is a
+  /// thread-safe call.
+  Entry &get(StringRef Path);
+
+  /// Returns a buffer with the same contents as \p Buffer that lives as long
+  /// as the cache, reusing an earlier buffer with the same contents if there
+  /// is one. This is a thread-safe call.
+  const MemoryBuffer *getUniqueContents(std::unique_ptr<MemoryBuffer> Buffer);
+
+private:
+  struct CacheShard {
+    std::mutex CacheLock;
+    StringMap<Entry, BumpPtrAllocator> Cache;
+  };
+  std::unique_ptr<CacheShard[]> CacheShards;
+  unsigned NumShards;
+
+  std::mutex ContentsLock;
+  /// The buffers owned by the cache, by the hash of their contents.
+  DenseMap<uint64_t, SmallVector<std::unique_ptr<MemoryBuffer>, 1>> Contents;
+};
+
+/// Create a file system that reads \p FS through \p Cache.
+///
+/// Each file system created this way has its own working directory, so
+/// several of them can share one cache from different threads, as long as
+/// each of them is used by a single thread at a time. The paths given to
+/// \p FS are always absolute.
+IntrusiveRefCntPtr<FileSystem>
+createCachingFileSystem(SharedFileSystemCache &Cache,
+                        IntrusiveRefCntPtr<FileSystem> FS);
+
+} // end namespace vfs
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_CACHINGFILESYSTEM_H
@@ -32,6 +32,17 @@ bool isAvailable();
 Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                int Level = DefaultCompression);
 
+/// Compress InputBuffer like compress(), but split it into blocks of
+/// BlockSize bytes that are compressed independently on multiple threads. The
+/// blocks are concatenated into a single zlib stream that uncompress()
+/// accepts. The output does not depend on the number of threads, and is
+/// slightly larger than that of compress() because no block refers back to
+/// the data of the previous one.
+Error compressParallel(StringRef InputBuffer,
+                       SmallVectorImpl<char> &CompressedBuffer,
+                       int Level = DefaultCompression,
+                       size_t BlockSize = 1024 * 1024);
+
 Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                  size_t &UncompressedSize);
 
@@ -32,6 +32,10 @@ public:
   enum {
     /// set the 'x' bit on the resulting file
     F_executable = 1,
+
+    /// Keep the buffer in memory and write ranges passed to flush() to the
+    /// file in the background. Ignored if the output is not a regular file.
+    F_streaming = 2,
   };
 
   /// Factory method to create an OutputBuffer object which manages a read/write
@@ -65,6 +69,12 @@ public:
   /// initially requested.
   virtual Error commit() = 0;
 
+  /// Tells that the given range of the buffer is complete. A buffer created
+  /// with F_streaming starts writing the range to the file in the background,
+  /// so that it does not have to be written on commit(). The range may be
+  /// flushed again if it is modified later. Other buffers ignore this.
+  virtual void flush(size_t Offset, size_t Size) {}
+
   /// If this object was previously committed, the destructor just deletes
   /// this object.  If this object was not committed, the destructor
   /// deallocates the buffer and the target file is never written.
@@ -1167,6 +1167,13 @@ public:
     priv ///< May modify via data, but changes are lost on destruction.
   };
 
+  /// Hints about how the pages of a mapping are going to be accessed.
+  enum advice {
+    normal,     ///< No particular access pattern.
+    sequential, ///< Pages are accessed in order; read ahead aggressively.
+    willneed    ///< All pages are needed soon; start reading them now.
+  };
+
 private:
   /// Platform-specific mapping state.
   size_t Size;
@@ -1196,6 +1203,19 @@ public:
   /// behavior.
   const char *const_data() const;
 
+  /// Tell the OS that the pages of a read-only mapping are not needed for
+  /// now. They are read back from the file if they are accessed again.
+  void dontNeed();
+
+  /// Tell the OS how the pages of the mapping are going to be accessed. This
+  /// is only a hint, and does nothing where it is not supported.
+  void advise(advice A);
+
+  /// Ask for the mapping to be backed by transparent huge pages, which
+  /// reduces the number of page faults and TLB misses for large files. This
+  /// is only a hint, and does nothing where it is not supported.
+  void adviseHugePages();
+
   /// \returns The minimum alignment offset must be.
   static int alignment();
 };
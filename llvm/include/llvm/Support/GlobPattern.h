@@ -31,6 +31,13 @@ public:
   static Expected<GlobPattern> create(StringRef Pat);
   bool match(StringRef S) const;
 
+  /// Return the only string this pattern matches, if it has no
+  /// metacharacters.
+  Optional<StringRef> getExact() const { return Exact; }
+  /// Return the prefix of the strings this pattern matches, if it is a string
+  /// without metacharacters followed by "*".
+  Optional<StringRef> getPrefix() const { return Prefix; }
+
 private:
   bool matchOne(ArrayRef<BitVector> Pat, StringRef S) const;
 
@@ -28,6 +28,25 @@ namespace llvm {
 
 class MemoryBufferRef;
 
+/// Options for opening a file with MemoryBuffer::getFile. The access hints
+/// only apply if the file ends up memory mapped.
+struct MemoryBufferOpenOptions {
+  /// The size of the file, if the client knows it, or -1.
+  int64_t FileSize = -1;
+
+  bool RequiresNullTerminator = true;
+
+  /// The contents of the file can change outside the user's control.
+  bool IsVolatile = false;
+
+  /// How the contents of the file are going to be accessed.
+  sys::fs::mapped_file_region::advice Advice =
+      sys::fs::mapped_file_region::normal;
+
+  /// Ask for transparent huge pages for the mapping.
+  bool HugePages = false;
+};
+
 /// This interface provides simple read-only access to a block of memory, and
 /// provides simple methods for reading files and standard input into a memory
 /// buffer.  In addition to basic access to the characters in the file, this
@@ -68,6 +87,10 @@ public:
   /// from.
   virtual StringRef getBufferIdentifier() const { return "Unknown buffer"; }
 
+  /// For read-only MemoryBuffer_MMap, tell the OS that the pages of the
+  /// buffer are not needed for now. Does nothing for other kinds of buffers.
+  virtual void dontNeedIfMmap() {}
+
   /// Open the specified file as a MemoryBuffer, returning a new MemoryBuffer
   /// if successful, otherwise returning null. If FileSize is specified, this
   /// means that the client knows that the file exists and that it has the
@@ -80,6 +103,10 @@ public:
   getFile(const Twine &Filename, int64_t FileSize = -1,
           bool RequiresNullTerminator = true, bool IsVolatile = false);
 
+  /// Open the specified file as a MemoryBuffer with the given options.
+  static ErrorOr<std::unique_ptr<MemoryBuffer>>
+  getFile(const Twine &Filename, const MemoryBufferOpenOptions &Options);
+
   /// Read all of the specified file into a MemoryBuffer as a stream
   /// (i.e. until EOF reached). This is useful for special files that
   /// look like a regular file but have 0 size (e.g. /proc/cpuinfo on Linux).
@@ -126,6 +153,10 @@ public:
   getFileOrSTDIN(const Twine &Filename, int64_t FileSize = -1,
                  bool RequiresNullTerminator = true);
 
+  static ErrorOr<std::unique_ptr<MemoryBuffer>>
+  getFileOrSTDIN(const Twine &Filename,
+                 const MemoryBufferOpenOptions &Options);
+
   /// Map a subrange of the specified file as a MemoryBuffer.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileSlice(const Twine &Filename, uint64_t MapSize, uint64_t Offset,
@@ -17,6 +17,7 @@
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <vector>
 
 #if defined(_MSC_VER) && LLVM_ENABLE_THREADS
 #pragma warning(push)
@@ -41,6 +42,19 @@ struct is_execution_policy
 constexpr sequential_execution_policy seq{};
 constexpr parallel_execution_policy par{};
 
+#if LLVM_ENABLE_THREADS && !defined(_MSC_VER)
+/// Returns the index of the calling thread among the worker threads that run
+/// parallel algorithms, or ~0U if the calling thread is not one of them.
+unsigned getThreadIndex();
+
+/// Returns the number of worker threads that run parallel algorithms. Thread
+/// indices are less than this number.
+unsigned getThreadCount();
+#else
+inline unsigned getThreadIndex() { return ~0U; }
+inline unsigned getThreadCount() { return 0; }
+#endif
+
 namespace detail {
 
 #if LLVM_ENABLE_THREADS
@@ -59,10 +73,18 @@ public:
     ++Count;
   }
 
-  void dec() {
+  /// Returns true if this brought the count to zero.
+  bool dec() {
     std::lock_guard<std::mutex> lock(Mutex);
-    if (--Count == 0)
-      Cond.notify_all();
+    if (--Count != 0)
+      return false;
+    Cond.notify_all();
+    return true;
+  }
+
+  bool isDone() const {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Count == 0;
   }
 
   void sync() const {
@@ -73,7 +95,9 @@ public:
 
 class TaskGroup {
   Latch L;
+#if defined(_MSC_VER)
   bool Parallel;
+#endif
 
 public:
   TaskGroup();
@@ -81,7 +105,9 @@ public:
 
   void spawn(std::function<void()> f);
 
-  void sync() const { L.sync(); }
+  /// Waits for all spawned tasks. The calling thread runs pending tasks
+  /// while it waits, so TaskGroups can be nested.
+  void sync() const;
 };
 
 #if defined(_MSC_VER)
@@ -100,6 +126,15 @@ void parallel_for_each_n(IndexTy Begin, IndexTy End, FuncTy Fn) {
   concurrency::parallel_for(Begin, End, Fn);
 }
 
+template <class IterTy, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallel_transform_reduce(IterTy Begin, IterTy End, ResultTy Init,
+                                   ReduceFuncTy Reduce,
+                                   TransformFuncTy Transform) {
+  return concurrency::parallel_transform_reduce(Begin, End, Init, Reduce,
+                                                Transform);
+}
+
 #else
 const ptrdiff_t MinParallelSize = 1024;
 
@@ -186,6 +221,43 @@ void parallel_for_each_n(IndexTy Begin, IndexTy End, FuncTy Fn) {
     Fn(J);
 }
 
+template <class IterTy, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallel_transform_reduce(IterTy Begin, IterTy End, ResultTy Init,
+                                   ReduceFuncTy Reduce,
+                                   TransformFuncTy Transform) {
+  // Like parallel_for_each, create up to 1024 tasks. Each of them reduces
+  // its own slice of the input, and the partial results are then reduced
+  // sequentially in order, so Reduce only needs to be associative.
+  size_t NumInputs = std::distance(Begin, End);
+  if (NumInputs == 0)
+    return Init;
+  size_t NumTasks = std::min<size_t>(1024, NumInputs);
+  std::vector<ResultTy> Results(NumTasks, Init);
+  {
+    // Each task processes either TaskSize or TaskSize + 1 inputs.
+    TaskGroup TG;
+    size_t TaskSize = NumInputs / NumTasks;
+    size_t Remaining = NumInputs % NumTasks;
+    IterTy TBegin = Begin;
+    for (size_t TaskId = 0; TaskId < NumTasks; ++TaskId) {
+      IterTy TEnd = TBegin + TaskSize + (TaskId < Remaining ? 1 : 0);
+      TG.spawn([=, &Transform, &Reduce, &Results] {
+        ResultTy R = Init;
+        for (IterTy It = TBegin; It != TEnd; ++It)
+          R = Reduce(R, Transform(*It));
+        Results[TaskId] = std::move(R);
+      });
+      TBegin = TEnd;
+    }
+  }
+
+  ResultTy Result = std::move(Results.front());
+  for (size_t I = 1; I < NumTasks; ++I)
+    Result = Reduce(Result, std::move(Results[I]));
+  return Result;
+}
+
 #endif
 
 #endif
@@ -221,6 +293,18 @@ void for_each_n(Policy policy, IndexTy Begin, IndexTy End, FuncTy Fn) {
     Fn(I);
 }
 
+template <class Policy, class IterTy, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy transform_reduce(Policy policy, IterTy Begin, IterTy End,
+                          ResultTy Init, ReduceFuncTy Reduce,
+                          TransformFuncTy Transform) {
+  static_assert(is_execution_policy<Policy>::value,
+                "Invalid execution policy!");
+  for (IterTy I = Begin; I != End; ++I)
+    Init = Reduce(std::move(Init), Transform(*I));
+  return Init;
+}
+
 // Parallel algorithm implementations, only available when LLVM_ENABLE_THREADS
 // is true.
 #if LLVM_ENABLE_THREADS
@@ -242,6 +326,15 @@ void for_each_n(parallel_execution_policy policy, IndexTy Begin, IndexTy End,
                 FuncTy Fn) {
   detail::parallel_for_each_n(Begin, End, Fn);
 }
+
+template <class IterTy, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy transform_reduce(parallel_execution_policy policy, IterTy Begin,
+                          IterTy End, ResultTy Init, ReduceFuncTy Reduce,
+                          TransformFuncTy Transform) {
+  return detail::parallel_transform_reduce(Begin, End, Init, Reduce,
+                                           Transform);
+}
 #endif
 
 } // namespace parallel
@@ -77,7 +77,6 @@ private:
   uint32_t HashResult[HASH_LENGTH / 4];
 
   // Helper
-  void writebyte(uint8_t data);
   void hashBlock();
   void addUncounted(uint8_t data);
   void pad();
@@ -51,6 +51,7 @@
 #ifndef LLVM_SUPPORT_SPECIALCASELIST_H
 #define LLVM_SUPPORT_SPECIALCASELIST_H
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Regex.h"
@@ -113,7 +114,10 @@ protected:
   /// Represents a set of regular expressions.  Regular expressions which are
   /// "literal" (i.e. no regex metacharacters) are stored in Strings.  The
   /// reason for doing so is efficiency; StringMap is much faster at matching
-  /// literal strings than Regex.
+  /// literal strings than Regex.  For the same reason, wildcards that only
+  /// use '*' and '.' are matched without Regex, and are indexed by the
+  /// literal prefix or suffix they have, so that a query is only matched
+  /// against the few of them that can match it.
   class Matcher {
   public:
     bool insert(std::string Regexp, unsigned LineNumber, std::string &REError);
@@ -122,9 +126,36 @@ protected:
     unsigned match(StringRef Query) const;
 
   private:
+    // A rule that isn't a literal. Order is the position of the rule among
+    // those, the first rule that matches a query is the one reported.
+    struct Glob {
+      std::string Pattern;
+      unsigned LineNumber;
+      unsigned Order;
+    };
+    struct RegEx {
+      std::unique_ptr<Regex> RE;
+      unsigned LineNumber;
+      unsigned Order;
+    };
+
+    // Indexes of Globs by the literal prefix or suffix of their pattern, and
+    // the lengths of those, from the shortest to the longest.
+    struct GlobIndex {
+      StringMap<SmallVector<unsigned, 1>> Globs;
+      SmallVector<size_t, 8> Lengths;
+
+      void insert(StringRef Literal, unsigned Glob);
+    };
+
     StringMap<unsigned> Strings;
     TrigramIndex Trigrams;
-    std::vector<std::pair<std::unique_ptr<Regex>, unsigned>> RegExes;
+    std::vector<Glob> Globs;
+    GlobIndex GlobsByPrefix;
+    GlobIndex GlobsBySuffix;
+    // The globs that start and end with a wildcard.
+    std::vector<unsigned> OtherGlobs;
+    std::vector<RegEx> RegExes;
   };
 
   using SectionEntries = StringMap<StringMap<Matcher>>;
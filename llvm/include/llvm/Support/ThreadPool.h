@@ -13,6 +13,8 @@
 #ifndef LLVM_SUPPORT_THREAD_POOL_H
 #define LLVM_SUPPORT_THREAD_POOL_H
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/thread.h"
 
@@ -28,11 +30,17 @@
 
 namespace llvm {
 
+class ThreadPoolTaskGroup;
+
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
 /// The pool keeps a vector of threads alive, waiting on a condition variable
 /// for some work to become available.
+///
+/// Tasks may be submitted as part of a ThreadPoolTaskGroup, which allows
+/// waiting for the tasks of that group only. This lets several independent
+/// clients share one pool.
 class ThreadPool {
 public:
   using TaskTy = std::function<void()>;
@@ -42,8 +50,12 @@ public:
   /// hardware_concurrency().
   ThreadPool();
 
-  /// Construct a pool of \p ThreadCount threads
-  ThreadPool(unsigned ThreadCount);
+  /// Construct a pool of \p ThreadCount threads. If \p MaxQueuedTasks is not
+  /// zero, at most that many tasks wait for execution at any time: async()
+  /// blocks until there is room in the queue, and tryAsync() fails. Tasks
+  /// submitted by the pool's own threads are never blocked, as that could
+  /// deadlock the pool.
+  ThreadPool(unsigned ThreadCount, size_t MaxQueuedTasks = 0);
 
   /// Blocking destructor: the pool will wait for all the threads to complete.
   ~ThreadPool();
@@ -54,34 +66,74 @@ public:
   inline std::shared_future<void> async(Function &&F, Args &&... ArgList) {
     auto Task =
         std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
-    return asyncImpl(std::move(Task));
+    return asyncImpl(std::move(Task), nullptr);
   }
 
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   template <typename Function>
   inline std::shared_future<void> async(Function &&F) {
-    return asyncImpl(std::forward<Function>(F));
+    return asyncImpl(std::forward<Function>(F), nullptr);
+  }
+
+  /// Like async(), but the task is added to \p Group.
+  template <typename Function>
+  inline std::shared_future<void> async(ThreadPoolTaskGroup &Group,
+                                        Function &&F) {
+    return asyncImpl(std::forward<Function>(F), &Group);
+  }
+
+  /// Like async(), but returns None instead of blocking if the queue is full.
+  template <typename Function>
+  inline Optional<std::shared_future<void>> tryAsync(Function &&F) {
+    return tryAsyncImpl(std::forward<Function>(F), nullptr);
+  }
+
+  /// Like tryAsync(), but the task is added to \p Group.
+  template <typename Function>
+  inline Optional<std::shared_future<void>> tryAsync(ThreadPoolTaskGroup &Group,
+                                                     Function &&F) {
+    return tryAsyncImpl(std::forward<Function>(F), &Group);
   }
 
   /// Blocking wait for all the threads to complete and the queue to be empty.
   /// It is an error to try to add new tasks while blocking on this call.
   void wait();
 
+  /// Blocking wait for all the tasks of \p Group to complete. Tasks of other
+  /// groups may still be queued or running when this returns. Must not be
+  /// called from one of the pool's threads.
+  void wait(ThreadPoolTaskGroup &Group);
+
 private:
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<void> asyncImpl(TaskTy F);
+  std::shared_future<void> asyncImpl(TaskTy F, ThreadPoolTaskGroup *Group);
+
+  /// Same as asyncImpl(), but returns None if the queue is full.
+  Optional<std::shared_future<void>> tryAsyncImpl(TaskTy F,
+                                                  ThreadPoolTaskGroup *Group);
+
+  /// Adds \p Task to the queue. If the queue is full, waits for room if
+  /// \p Block is true and returns false otherwise.
+  bool enqueue(PackagedTaskTy &Task, ThreadPoolTaskGroup *Group, bool Block);
+
+  /// Returns true if the calling thread is one of this pool's threads.
+  bool isWorkerThread() const;
 
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks waiting for execution in the pool, with the group they belong to.
+  std::queue<std::pair<PackagedTaskTy, ThreadPoolTaskGroup *>> Tasks;
+
+  /// Maximum size of the Tasks queue, or zero if it is unbounded.
+  size_t MaxQueuedTasks;
 
   /// Locking and signaling for accessing the Tasks queue.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
+  std::condition_variable QueueNotFullCondition;
 
   /// Locking and signaling for job completion
   std::mutex CompletionLock;
@@ -90,11 +142,49 @@ private:
   /// Keep track of the number of thread actually busy
   std::atomic<unsigned> ActiveThreads;
 
+  /// Number of queued or running tasks of each group. Guarded by
+  /// CompletionLock.
+  DenseMap<ThreadPoolTaskGroup *, unsigned> ActiveGroups;
+
 #if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag;
 #endif
 };
+
+/// A group of tasks submitted to a ThreadPool, which can be waited for
+/// independently of the other tasks of the pool.
+///
+/// The group must outlive its tasks, so either call wait() or let the
+/// destructor do it.
+class ThreadPoolTaskGroup {
+public:
+  explicit ThreadPoolTaskGroup(ThreadPool &Pool) : Pool(Pool) {}
+
+  /// Blocking destructor: waits for all the tasks of the group.
+  ~ThreadPoolTaskGroup() { wait(); }
+
+  ThreadPoolTaskGroup(const ThreadPoolTaskGroup &) = delete;
+  ThreadPoolTaskGroup &operator=(const ThreadPoolTaskGroup &) = delete;
+
+  /// Calls ThreadPool::async() for this group.
+  template <typename Function>
+  inline std::shared_future<void> async(Function &&F) {
+    return Pool.async(*this, std::forward<Function>(F));
+  }
+
+  /// Calls ThreadPool::tryAsync() for this group.
+  template <typename Function>
+  inline Optional<std::shared_future<void>> tryAsync(Function &&F) {
+    return Pool.tryAsync(*this, std::forward<Function>(F));
+  }
+
+  /// Calls ThreadPool::wait() for this group.
+  void wait() { Pool.wait(*this); }
+
+private:
+  ThreadPool &Pool;
+};
 }
 
 #endif // LLVM_SUPPORT_THREAD_POOL_H
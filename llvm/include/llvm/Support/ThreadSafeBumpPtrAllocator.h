@@ -0,0 +1,129 @@
+//===- ThreadSafeBumpPtrAllocator.h - Concurrent bump allocator -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines ThreadSafeBumpPtrAllocator, a bump pointer allocator that
+// may be used concurrently from the threads that run the parallel algorithms
+// of llvm/Support/Parallel.h.
+//
+// Each of those threads allocates from its own BumpPtrAllocator, so no
+// locking is needed on the fast path and threads do not contend for cache
+// lines. Allocations from any other thread, such as the main thread, go to a
+// shared BumpPtrAllocator guarded by a mutex.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_THREADSAFEBUMPPTRALLOCATOR_H
+#define LLVM_SUPPORT_THREADSAFEBUMPPTRALLOCATOR_H
+
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class ThreadSafeBumpPtrAllocator
+    : public AllocatorBase<ThreadSafeBumpPtrAllocator> {
+  struct Arena {
+    BumpPtrAllocator Alloc;
+    // Keep the allocation pointers of different threads in different cache
+    // lines.
+    char Padding[64];
+  };
+
+public:
+  ThreadSafeBumpPtrAllocator() : Arenas(parallel::getThreadCount()) {}
+
+  ThreadSafeBumpPtrAllocator(const ThreadSafeBumpPtrAllocator &) = delete;
+  ThreadSafeBumpPtrAllocator &
+  operator=(const ThreadSafeBumpPtrAllocator &) = delete;
+
+  /// Allocate space from the arena of the calling thread.
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    unsigned I = parallel::getThreadIndex();
+    if (I < Arenas.size())
+      return Arenas[I].Alloc.Allocate(Size, Alignment);
+    std::lock_guard<std::mutex> Lock(SharedMutex);
+    return Shared.Alloc.Allocate(Size, Alignment);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<ThreadSafeBumpPtrAllocator>::Allocate;
+
+  void Deallocate(const void *Ptr, size_t Size) {}
+
+  // Pull in base class overloads.
+  using AllocatorBase<ThreadSafeBumpPtrAllocator>::Deallocate;
+
+  /// Deallocate all memory of all arenas. Must not be called while other
+  /// threads are allocating.
+  void Reset() {
+    for (Arena &A : Arenas)
+      A.Alloc.Reset();
+    Shared.Alloc.Reset();
+  }
+
+  /// Returns the number of arenas. Arena I, for I < getNumArenas() - 1,
+  /// belongs to the thread with parallel::getThreadIndex() == I; the last one
+  /// is the shared arena.
+  size_t getNumArenas() const { return Arenas.size() + 1; }
+
+  const BumpPtrAllocator &getArena(size_t I) const {
+    return I < Arenas.size() ? Arenas[I].Alloc : Shared.Alloc;
+  }
+
+  size_t GetNumSlabs() const {
+    size_t N = 0;
+    for (size_t I = 0, E = getNumArenas(); I != E; ++I)
+      N += getArena(I).GetNumSlabs();
+    return N;
+  }
+
+  size_t getTotalMemory() const {
+    size_t N = 0;
+    for (size_t I = 0, E = getNumArenas(); I != E; ++I)
+      N += getArena(I).getTotalMemory();
+    return N;
+  }
+
+  size_t getBytesAllocated() const {
+    size_t N = 0;
+    for (size_t I = 0, E = getNumArenas(); I != E; ++I)
+      N += getArena(I).getBytesAllocated();
+    return N;
+  }
+
+  /// Print the combined statistics of all arenas, followed by those of each
+  /// arena that was used.
+  void PrintStats() const {
+    detail::printBumpPtrAllocatorStats(GetNumSlabs(), getBytesAllocated(),
+                                       getTotalMemory());
+    for (size_t I = 0, E = getNumArenas(); I != E; ++I) {
+      const BumpPtrAllocator &A = getArena(I);
+      if (A.getTotalMemory() == 0)
+        continue;
+      errs() << "\nArena " << (I + 1 == E ? "shared" : std::to_string(I))
+             << ':';
+      A.PrintStats();
+    }
+  }
+
+private:
+  std::vector<Arena> Arenas;
+  Arena Shared;
+  std::mutex SharedMutex;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_THREADSAFEBUMPPTRALLOCATOR_H
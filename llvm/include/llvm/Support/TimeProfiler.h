@@ -9,21 +9,32 @@
 #ifndef LLVM_SUPPORT_TIME_PROFILER_H
 #define LLVM_SUPPORT_TIME_PROFILER_H
 
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
 
 struct TimeTraceProfiler;
-extern TimeTraceProfiler *TimeTraceProfilerInstance;
+extern LLVM_THREAD_LOCAL TimeTraceProfiler *TimeTraceProfilerInstance;
 
 /// Initialize the time trace profiler.
-/// This sets up the global \p TimeTraceProfilerInstance
-/// variable to be the profiler instance.
-void timeTraceProfilerInitialize(unsigned TimeTraceGranularity);
+/// This sets up the thread-local \p TimeTraceProfilerInstance
+/// variable to be the profiler instance of the calling thread. Each thread
+/// records its own events without any locking; a worker thread must call
+/// timeTraceProfilerFinishThread() before it exits, and the thread that calls
+/// timeTraceProfilerWrite() writes the events of all threads.
+/// \p ProcName is the process name shown in the trace.
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                 StringRef ProcName = "clang");
 
-/// Cleanup the time trace profiler, if it was initialized.
+/// Cleanup the time trace profiler of the calling thread and of all finished
+/// worker threads, if it was initialized.
 void timeTraceProfilerCleanup();
 
+/// Finish the time trace profiler of a worker thread. Its events are kept
+/// until timeTraceProfilerWrite() is called on the main thread.
+void timeTraceProfilerFinishThread();
+
 /// Is the time trace profiler enabled, i.e. initialized?
 inline bool timeTraceProfilerEnabled() {
   return TimeTraceProfilerInstance != nullptr;
@@ -45,6 +56,11 @@ void timeTraceProfilerBegin(StringRef Name,
 /// Manually end the last time section.
 void timeTraceProfilerEnd();
 
+/// Record the current value of the counter \p Name, which is shown as a
+/// counter track next to the time sections, e.g. to follow memory usage or
+/// the length of a work queue over time.
+void timeTraceProfilerCounter(StringRef Name, int64_t Value);
+
 /// The TimeTraceScope is a helper class to call the begin and end functions
 /// of the time trace profiler.  When the object is constructed, it begins
 /// the section; and when it is destroyed, it stops it. If the time profiler
@@ -57,6 +73,10 @@ struct TimeTraceScope {
   TimeTraceScope(TimeTraceScope &&) = delete;
   TimeTraceScope &operator=(TimeTraceScope &&) = delete;
 
+  TimeTraceScope(StringRef Name) {
+    if (TimeTraceProfilerInstance != nullptr)
+      timeTraceProfilerBegin(Name, StringRef(""));
+  }
   TimeTraceScope(StringRef Name, StringRef Detail) {
     if (TimeTraceProfilerInstance != nullptr)
       timeTraceProfilerBegin(Name, Detail);
@@ -0,0 +1,85 @@
+//===- raw_mmap_ostream.h - raw_ostream writing to a mapped file -*- C++ -*-==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the raw_mmap_ostream class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_RAW_MMAP_OSTREAM_H
+#define LLVM_SUPPORT_RAW_MMAP_OSTREAM_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+
+namespace llvm {
+
+/// A raw_pwrite_stream that writes to a memory-mapped temporary file next to
+/// the output file, growing the file and the mapping as needed.
+///
+/// The stream buffer is the mapping itself, so data written with operator<<
+/// lands in the page cache without being copied again by write(2). Like
+/// FileOutputBuffer, the temporary file atomically replaces the output file
+/// on commit(), and is deleted if the stream is destroyed without commit().
+class raw_mmap_ostream : public raw_pwrite_stream {
+public:
+  enum {
+    /// set the 'x' bit on the resulting file
+    F_executable = 1,
+  };
+
+  /// Create a stream that will write to \p Path. \p SizeHint is the expected
+  /// size of the output; the file grows past it if needed. Fails if \p Path is
+  /// not a regular file, or if the file cannot be mapped, in which case
+  /// callers should fall back to raw_fd_ostream.
+  static Expected<std::unique_ptr<raw_mmap_ostream>>
+  create(StringRef Path, uint64_t SizeHint = 0, unsigned Flags = 0);
+
+  ~raw_mmap_ostream() override;
+
+  /// Truncate the file to the bytes written and move it to the output path.
+  /// Nothing may be written after this.
+  Error commit();
+
+  /// Flush the stream and return the bytes written so far, which may be
+  /// modified in place. The result is invalidated by the next write, and is
+  /// empty if the stream is in an error state.
+  MutableArrayRef<char> getWrittenData();
+
+  /// Return any error encountered while growing the file.
+  std::error_code error() const { return EC; }
+
+private:
+  raw_mmap_ostream(StringRef Path, sys::fs::TempFile Temp);
+
+  /// See raw_ostream::write_impl.
+  void write_impl(const char *Ptr, size_t Size) override;
+
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
+
+  uint64_t current_pos() const override { return Pos; }
+
+  /// Make sure that the mapping covers at least \p Size bytes.
+  bool reserve(uint64_t Size);
+
+  /// Make the unused rest of the mapping the stream buffer.
+  void resetBuffer();
+
+  std::string FinalPath;
+  sys::fs::TempFile Temp;
+  std::unique_ptr<sys::fs::mapped_file_region> Region;
+  uint64_t Capacity = 0;
+  uint64_t Pos = 0;
+  std::error_code EC;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_RAW_MMAP_OSTREAM_H
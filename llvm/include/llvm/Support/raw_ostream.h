@@ -316,6 +316,19 @@ private:
   /// \invariant { Size > 0 }
   virtual void write_impl(const char *Ptr, size_t Size) = 0;
 
+  /// Write the \p Size1 bytes at \p Ptr1, which are the contents of the
+  /// buffer, followed by the \p Size2 bytes at \p Ptr2. This is called
+  /// instead of copying a string that is at least as large as the buffer into
+  /// it piece by piece. Subclasses that can write both in one operation, such
+  /// as with writev(2), may override it; by default it calls write_impl twice.
+  ///
+  /// \invariant { Size1 > 0 && Size2 > 0 }
+  virtual void writev_impl(const char *Ptr1, size_t Size1, const char *Ptr2,
+                           size_t Size2) {
+    write_impl(Ptr1, Size1);
+    write_impl(Ptr2, Size2);
+  }
+
   /// Return the current position within the stream, not counting the bytes
   /// currently in the buffer.
   virtual uint64_t current_pos() const = 0;
@@ -400,6 +413,10 @@ class raw_fd_ostream : public raw_pwrite_stream {
   /// See raw_ostream::write_impl.
   void write_impl(const char *Ptr, size_t Size) override;
 
+  /// See raw_ostream::writev_impl.
+  void writev_impl(const char *Ptr1, size_t Size1, const char *Ptr2,
+                   size_t Size2) override;
+
   void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
 
   /// Return the current position within the stream, not counting the bytes
@@ -13,6 +13,10 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include <functional>
+#include <string>
+
 namespace llvm {
 
 class raw_ostream;
@@ -22,7 +26,18 @@ class RecordKeeper;
 /// Returns true on error, false otherwise.
 using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn);
+/// An output written in addition to the -o file: the file name and the
+/// function producing its contents.
+struct TableGenExtraOutput {
+  std::string Filename;
+  std::function<TableGenMainFn> MainFn;
+};
+
+/// Parse the input file, run \p MainFn for the -o output, then run the
+/// function of each of \p ExtraOutputs for its own file. The records are
+/// parsed only once, so the functions must leave them as they found them.
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 ArrayRef<TableGenExtraOutput> ExtraOutputs = None);
 
 } // end namespace llvm
 
@@ -119,6 +119,14 @@ public:
   virtual bool shouldPutJumpTableInFunctionSection(bool UsesLabelDifference,
                                                    const Function &F) const;
 
+  /// Return the section for the cold blocks of \p F that
+  /// MachineFunctionSplitter moved out of its body, or null if the object
+  /// file format can't describe a function in two parts.
+  virtual MCSection *getSectionForColdPart(const Function &F,
+                                           const TargetMachine &TM) const {
+    return nullptr;
+  }
+
   /// Targets should implement this method to assign a section to globals with
   /// an explicit section specfied. The implementation of this method can
   /// assume that GO->hasSection() is true.
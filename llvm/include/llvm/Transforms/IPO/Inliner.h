@@ -75,6 +75,9 @@ protected:
   AssumptionCacheTracker *ACT;
   ProfileSummaryInfo *PSI;
   ImportedFunctionsInliningStatistics ImportedFunctionsStats;
+  /// Inline cost analyses shared between the call sites of a callee while
+  /// inlining into one SCC, to be passed to llvm::getInlineCost.
+  InlineCostCache CostCache;
 };
 
 /// The inliner pass for the new pass manager.
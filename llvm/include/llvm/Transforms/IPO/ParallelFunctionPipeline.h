@@ -0,0 +1,64 @@
+//===- ParallelFunctionPipeline.h - Parallel function passes ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides a module pass that runs a function pass pipeline on
+// partitions of the module in parallel.
+//
+// An LLVMContext may only be used by one thread at a time: constants, types
+// and metadata are uniqued in it, and even creating an instruction adds a use
+// to the constants it refers to. So rather than running the function passes
+// concurrently on the functions of one module, the module is split with
+// SplitModule, each partition is optimized in its own LLVMContext on its own
+// thread, and the partitions are linked back together.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_PARALLELFUNCTIONPIPELINE_H
+#define LLVM_TRANSFORMS_IPO_PARALLELFUNCTIONPIPELINE_H
+
+#include "llvm/IR/PassManager.h"
+#include <functional>
+
+namespace llvm {
+
+class Module;
+
+/// A pass that runs a function pass pipeline on \p NumPartitions partitions of
+/// the module in parallel.
+///
+/// The pipeline is run by the \p RunPipeline callback, which is called
+/// concurrently from several threads, each time with a partition in a
+/// separate LLVMContext. It must therefore build its own analysis managers,
+/// pass managers and, if needed, TargetMachine on every call. The pipeline may
+/// only change the bodies and attributes of the functions defined in the
+/// partition and add new globals; the other globals of a partition are
+/// declarations. Module analyses of the original module are not available to
+/// it.
+///
+/// Locals are kept in the partition of their users, so all linkages are
+/// preserved. Debug info compile units are duplicated across the partitions,
+/// as they are in parallel code generation.
+class ParallelFunctionPipelinePass
+    : public PassInfoMixin<ParallelFunctionPipelinePass> {
+public:
+  using RunPipelineFn = std::function<void(Module &)>;
+
+  ParallelFunctionPipelinePass(unsigned NumPartitions,
+                               RunPipelineFn RunPipeline)
+      : NumPartitions(NumPartitions), RunPipeline(std::move(RunPipeline)) {}
+
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
+
+private:
+  unsigned NumPartitions;
+  RunPipelineFn RunPipeline;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_IPO_PARALLELFUNCTIONPIPELINE_H
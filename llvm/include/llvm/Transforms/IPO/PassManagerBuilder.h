@@ -205,6 +205,7 @@ private:
   void addPGOInstrPasses(legacy::PassManagerBase &MPM, bool IsCS);
   void addFunctionSimplificationPasses(legacy::PassManagerBase &MPM);
   void addInstructionCombiningPass(legacy::PassManagerBase &MPM) const;
+  bool shouldSplitColdCode() const;
 
 public:
   /// populateFunctionPassManager - This fills in the function pass manager,
@@ -74,6 +74,10 @@ private:
 
   int64_t TotalCountersPromoted = 0;
 
+  // The load of the counter bias in the entry block of each function, when
+  // the counters are relocated at runtime.
+  DenseMap<const Function *, LoadInst *> FunctionToProfileBiasMap;
+
   /// Lower instrumentation intrinsics in the function. Returns true if there
   /// any lowering.
   bool lowerIntrinsics(Function *F);
@@ -84,6 +88,9 @@ private:
   /// Returns true if profile counter update register promotion is enabled.
   bool isCounterPromotionEnabled() const;
 
+  /// Check if the counters are updated at an offset set by the runtime.
+  bool isRuntimeCounterRelocationEnabled() const;
+
   /// Count the number of instrumented value sites for the function.
   void computeNumValueSiteCounts(InstrProfValueProfileInst *Ins);
 
@@ -9,8 +9,8 @@
 // This file implements a trivial dead store elimination that only considers
 // basic-block local redundant stores.
 //
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// With -enable-dse-memoryssa, a MemorySSA based implementation that also
+// removes stores overwritten in other blocks is used instead.
 //
 //===----------------------------------------------------------------------===//
 
@@ -46,6 +46,9 @@ class FunctionPass;
 class IntrinsicInst;
 class LoadInst;
 class LoopInfo;
+class MemoryAccess;
+class MemorySSA;
+class MemorySSAUpdater;
 class OptimizationRemarkEmitter;
 class PHINode;
 class TargetLibraryInfo;
@@ -153,6 +156,8 @@ private:
   friend struct DenseMapInfo<Expression>;
 
   MemoryDependenceResults *MD;
+  MemorySSA *MSSA;
+  MemorySSAUpdater *MSSAU;
   DominatorTree *DT;
   const TargetLibraryInfo *TLI;
   AssumptionCache *AC;
@@ -195,7 +200,7 @@ private:
   bool runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
                const TargetLibraryInfo &RunTLI, AAResults &RunAA,
                MemoryDependenceResults *RunMD, LoopInfo *LI,
-               OptimizationRemarkEmitter *ORE);
+               OptimizationRemarkEmitter *ORE, MemorySSA *MSSA = nullptr);
 
   /// Push a new Value to the LeaderTable onto the list for its value number.
   void addToLeaderTable(uint32_t N, Value *V, const BasicBlock *BB) {
@@ -250,6 +255,20 @@ private:
   bool processNonLocalLoad(LoadInst *L);
   bool processAssumeIntrinsic(IntrinsicInst *II);
 
+  /// Compute the dependence of \p L on the instructions of its block from
+  /// MemorySSA, in the form MemoryDependenceResults::getDependency would.
+  MemDepResult getMemorySSADependency(LoadInst *L);
+
+  /// Compute the non-local dependencies of \p L from MemorySSA, in the form
+  /// MemoryDependenceResults::getNonLocalPointerDependency would.  Returns
+  /// false if they could not be determined within the MaxNumDeps budget.
+  bool getMemorySSANonLocalDependencies(LoadInst *L, LoadDepVect &Deps);
+
+  /// Return the access that clobbers \p Loc at \p MA, walking upwards from
+  /// \p MA itself.
+  MemoryAccess *getClobberingAccessFrom(MemoryAccess *MA,
+                                        const MemoryLocation &Loc);
+
   /// Given a local dependency (Def or Clobber) determine if a value is
   /// available for the load.  Returns true if an value is known to be
   /// available and populates Res.  Returns false otherwise.
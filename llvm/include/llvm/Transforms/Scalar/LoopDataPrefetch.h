@@ -15,9 +15,14 @@
 
 #include "llvm/IR/Function.h"
 #include "llvm/IR/PassManager.h"
+#include <memory>
 
 namespace llvm {
 
+namespace sampleprof {
+class SampleProfileReader;
+} // end namespace sampleprof
+
 /// An optimization pass inserting data prefetches in loops.
 class LoopDataPrefetchPass : public PassInfoMixin<LoopDataPrefetchPass> {
 public:
@@ -25,6 +30,10 @@ public:
 
   /// Run the pass over the function.
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+
+private:
+  /// The cache miss profile, read on the first run.
+  std::shared_ptr<sampleprof::SampleProfileReader> Reader;
 };
 
 } // end namespace llvm
@@ -0,0 +1,34 @@
+//===- LoopTiling.h - Loop tiling pass --------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides the interface for the Loop Tiling pass. The pass
+// strip-mines the innermost loop of a perfect two-deep loop nest and moves the
+// resulting tile loop outside the nest, so that the data touched by one tile of
+// the inner loop stays in cache across the iterations of the outer loop. It
+// uses LoopCacheAnalysis to decide whether tiling is profitable and the cache
+// parameters of TargetTransformInfo to size the tiles.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
+#define LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
+
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class Function;
+
+class LoopTilingPass : public PassInfoMixin<LoopTilingPass> {
+public:
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
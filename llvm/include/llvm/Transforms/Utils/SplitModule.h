@@ -22,6 +22,18 @@ namespace llvm {
 
 class Module;
 
+/// How SplitModule assigns global value definitions to partitions.
+enum class SplitModuleMode {
+  /// Keep the globals that must stay together in clusters balanced by their
+  /// number of members, and assign every other global by the hash of its
+  /// name.
+  Hash,
+  /// Balance the estimated code generation cost of the partitions, placing
+  /// each global in the partition that it references most as long as that
+  /// partition does not grow too far past its share of the cost.
+  CostBalanced,
+};
+
 /// Splits the module M into N linkable partitions. The function ModuleCallback
 /// is called N times passing each individual partition as the MPart argument.
 ///
@@ -35,7 +47,15 @@ class Module;
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, SplitModuleMode Mode = SplitModuleMode::Hash);
+
+/// Like the above, but leaves M to the caller. M may still be modified: its
+/// unnamed entities are given names, and its locals externalized unless
+/// PreserveLocals is set.
+void SplitModule(
+    Module &M, unsigned N,
+    function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
+    bool PreserveLocals = false, SplitModuleMode Mode = SplitModuleMode::Hash);
 
 } // end namespace llvm
 
@@ -44,6 +44,8 @@ using namespace llvm;
 #define DEBUG_TYPE "inline-cost"
 
 STATISTIC(NumCallsAnalyzed, "Number of call sites analyzed");
+STATISTIC(NumCallsAnalysisReused,
+          "Number of call sites analyzed from a cached analysis");
 
 static cl::opt<int> InlineThreshold(
     "inline-threshold", cl::Hidden, cl::init(225), cl::ZeroOrMore,
@@ -91,6 +93,12 @@ static cl::opt<bool> OptComputeFullInlineCost(
     cl::desc("Compute the full inline cost of a call site even when the cost "
              "exceeds the threshold."));
 
+static cl::opt<unsigned> InlineCostCacheEntries(
+    "inline-cost-cache-entries", cl::Hidden, cl::init(8), cl::ZeroOrMore,
+    cl::desc("Maximum number of distinct call site analyses kept for each "
+             "callee when the inline cost analysis is cached (0 = disable "
+             "the cache)"));
+
 namespace {
 
 class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
@@ -126,6 +134,9 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   /// Tunable parameters that control the analysis.
   const InlineParams &Params;
 
+  /// The cache of analyses of equivalent call sites, if any.
+  InlineCostCache *CostCache;
+
   /// Upper bound for the inlining cost. Bonuses are being applied to account
   /// for speculative "expected profit" of the inlining decision.
   int Threshold;
@@ -243,6 +254,15 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   InlineResult analyzeBlock(BasicBlock *BB,
                             SmallPtrSetImpl<const Value *> &EphValues);
 
+  /// Walk the body of the callee once the simplifications known from the
+  /// arguments of \p Call are in place.
+  InlineResult analyzeCallee(CallBase &Call);
+
+  /// Describe everything about \p Call that the walk over the callee depends
+  /// on. Returns false if that can't be done.
+  bool getCallSiteSignature(CallBase &Call,
+                            SmallVectorImpl<uint64_t> &Signature);
+
   /// Handle a capped 'int' increment for Cost.
   void addCost(int64_t Inc, int64_t UpperBound = INT_MAX) {
     assert(UpperBound > 0 && UpperBound <= INT_MAX && "invalid upper bound");
@@ -294,10 +314,12 @@ public:
                std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
                Optional<function_ref<BlockFrequencyInfo &(Function &)>> &GetBFI,
                ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE,
-               Function &Callee, CallBase &Call, const InlineParams &Params)
+               Function &Callee, CallBase &Call, const InlineParams &Params,
+               InlineCostCache *CostCache = nullptr)
       : TTI(TTI), GetAssumptionCache(GetAssumptionCache), GetBFI(GetBFI),
         PSI(PSI), F(Callee), DL(F.getParent()->getDataLayout()), ORE(ORE),
-        CandidateCall(Call), Params(Params), Threshold(Params.DefaultThreshold),
+        CandidateCall(Call), Params(Params), CostCache(CostCache),
+        Threshold(Params.DefaultThreshold),
         ComputeFullInlineCost(OptComputeFullInlineCost ||
                               Params.ComputeFullInlineCost || ORE),
         EnableLoadElimination(true) {}
@@ -1817,6 +1839,70 @@ InlineResult CallAnalyzer::analyzeCall(CallBase &Call) {
   NumConstantOffsetPtrArgs = ConstantOffsetPtrs.size();
   NumAllocaArgs = SROAArgValues.size();
 
+  // Remarks are emitted while walking the callee, so they need a fresh walk.
+  SmallVector<uint64_t, 16> Signature;
+  if (!CostCache || ORE || InlineCostCacheEntries == 0 ||
+      !getCallSiteSignature(Call, Signature))
+    return analyzeCallee(Call);
+
+  if (const InlineCostCache::Entry *E = CostCache->lookup(&F, Signature)) {
+    ++NumCallsAnalysisReused;
+    Cost = E->Cost;
+    Threshold = E->Threshold;
+    return E->Message;
+  }
+
+  InlineResult Result = analyzeCallee(Call);
+  CostCache->insert(&F, {std::move(Signature), Result.message, Cost,
+                         Threshold});
+  return Result;
+}
+
+bool CallAnalyzer::getCallSiteSignature(CallBase &Call,
+                                        SmallVectorImpl<uint64_t> &Signature) {
+  // The threshold and the cost so far account for everything updateThreshold
+  // and the call site cost derived from the caller and the call site.
+  Signature.push_back(static_cast<int64_t>(Threshold));
+  Signature.push_back(static_cast<int64_t>(SingleBBBonus));
+  Signature.push_back(static_cast<int64_t>(VectorBonus));
+  Signature.push_back(static_cast<int64_t>(Cost));
+
+  Function *Caller = Call.getFunction();
+  bool OnlyOneCallAndLocalLinkage =
+      F.hasLocalLinkage() && F.hasOneUse() && &F == Call.getCalledFunction();
+  Signature.push_back(IsCallerRecursive | Caller->hasMinSize() << 1 |
+                      OnlyOneCallAndLocalLinkage << 2);
+
+  // Only the arguments' simplifications are visible to the walk: constant
+  // values, and pointers at a constant offset from a base shared with other
+  // arguments. Bases are identified by the first argument they appear in.
+  SmallVector<Value *, 8> Bases;
+  for (Argument &A : F.args()) {
+    Signature.push_back(
+        reinterpret_cast<uintptr_t>(SimplifiedValues.lookup(&A)));
+    Signature.push_back(paramHasAttr(&A, Attribute::NonNull));
+
+    auto It = ConstantOffsetPtrs.find(&A);
+    if (It == ConstantOffsetPtrs.end()) {
+      Bases.push_back(nullptr);
+      Signature.push_back(0);
+      continue;
+    }
+    Value *Base = It->second.first;
+    const APInt &Offset = It->second.second;
+    if (Offset.getBitWidth() > 64)
+      return false;
+    Bases.push_back(Base);
+    Signature.push_back(find(Bases, Base) - Bases.begin() + 1);
+    Signature.push_back(Offset.getZExtValue());
+    Signature.push_back(SROAArgValues.count(&A));
+  }
+  return true;
+}
+
+InlineResult CallAnalyzer::analyzeCallee(CallBase &Call) {
+  Function *Caller = Call.getFunction();
+
   // FIXME: If a caller has multiple calls to a callee, we end up recomputing
   // the ephemeral values multiple times (and they're completely determined by
   // the callee, so this is purely duplicate work).
@@ -2015,9 +2101,10 @@ InlineCost llvm::getInlineCost(
     CallBase &Call, const InlineParams &Params, TargetTransformInfo &CalleeTTI,
     std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
     Optional<function_ref<BlockFrequencyInfo &(Function &)>> GetBFI,
-    ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE) {
+    ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE,
+    InlineCostCache *Cache) {
   return getInlineCost(Call, Call.getCalledFunction(), Params, CalleeTTI,
-                       GetAssumptionCache, GetBFI, PSI, ORE);
+                       GetAssumptionCache, GetBFI, PSI, ORE, Cache);
 }
 
 InlineCost llvm::getInlineCost(
@@ -2025,7 +2112,8 @@ InlineCost llvm::getInlineCost(
     TargetTransformInfo &CalleeTTI,
     std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
     Optional<function_ref<BlockFrequencyInfo &(Function &)>> GetBFI,
-    ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE) {
+    ProfileSummaryInfo *PSI, OptimizationRemarkEmitter *ORE,
+    InlineCostCache *Cache) {
 
   // Cannot inline indirect calls.
   if (!Callee)
@@ -2085,7 +2173,7 @@ InlineCost llvm::getInlineCost(
                           << "... (caller:" << Caller->getName() << ")\n");
 
   CallAnalyzer CA(CalleeTTI, GetAssumptionCache, GetBFI, PSI, ORE, *Callee,
-                  Call, Params);
+                  Call, Params, Cache);
   InlineResult ShouldInline = CA.analyzeCall(Call);
 
   LLVM_DEBUG(CA.dump());
@@ -2099,6 +2187,24 @@ InlineCost llvm::getInlineCost(
   return llvm::InlineCost::get(CA.getCost(), CA.getThreshold());
 }
 
+const InlineCostCache::Entry *
+InlineCostCache::lookup(const Function *Callee,
+                        ArrayRef<uint64_t> Signature) const {
+  auto It = Entries.find(Callee);
+  if (It == Entries.end())
+    return nullptr;
+  for (const Entry &E : It->second)
+    if (ArrayRef<uint64_t>(E.Signature) == Signature)
+      return &E;
+  return nullptr;
+}
+
+void InlineCostCache::insert(const Function *Callee, Entry E) {
+  SmallVectorImpl<Entry> &CalleeEntries = Entries[Callee];
+  if (CalleeEntries.size() < InlineCostCacheEntries)
+    CalleeEntries.push_back(std::move(E));
+}
+
 InlineResult llvm::isInlineViable(Function &F) {
   bool ReturnsTwice = F.hasFnAttribute(Attribute::ReturnsTwice);
   for (Function::iterator BI = F.begin(), BE = F.end(); BI != BE; ++BI) {
@@ -145,6 +145,14 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumValuesOverBudget,
+          "Number of values left unanalyzed because of the expression budget");
+STATISTIC(NumRangeCacheHits, "Number of getRange queries answered from cache");
+STATISTIC(NumRangeCacheMisses, "Number of getRange queries computed");
+STATISTIC(NumKnownPredicateCacheHits,
+          "Number of isKnownPredicate queries answered from cache");
+STATISTIC(NumKnownPredicateCacheMisses,
+          "Number of isKnownPredicate queries computed");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -216,6 +224,17 @@ static cl::opt<unsigned>
                   cl::desc("Size of the expression which is considered huge"),
                   cl::init(4096));
 
+static cl::opt<unsigned> MaxSCEVExprs(
+    "scalar-evolution-max-exprs", cl::Hidden,
+    cl::desc("Maximum number of expressions created for a function before "
+             "new values are treated as opaque (0 means no limit)"),
+    cl::init(0));
+
+static cl::opt<bool> MemoizeKnownPredicates(
+    "scalar-evolution-memoize-predicates", cl::Hidden,
+    cl::desc("Remember the results of isKnownPredicate queries"),
+    cl::init(false));
+
 //===----------------------------------------------------------------------===//
 //                           SCEV class definitions
 //===----------------------------------------------------------------------===//
@@ -5541,8 +5560,11 @@ ScalarEvolution::getRangeRef(const SCEV *S,
 
   // See if we've computed this range already.
   DenseMap<const SCEV *, ConstantRange>::iterator I = Cache.find(S);
-  if (I != Cache.end())
+  if (I != Cache.end()) {
+    ++NumRangeCacheHits;
     return I->second;
+  }
+  ++NumRangeCacheMisses;
 
   if (const SCEVConstant *C = dyn_cast<SCEVConstant>(S))
     return setRange(C, SignHint, ConstantRange(C->getAPInt()));
@@ -6131,6 +6153,13 @@ const SCEV *ScalarEvolution::createSCEV(Value *V) {
   else if (!isa<ConstantExpr>(V))
     return getUnknown(V);
 
+  // Once a function has created too many expressions, stop looking through
+  // operations; the expressions built so far stay usable.
+  if (MaxSCEVExprs && UniqueSCEVs.size() >= MaxSCEVExprs) {
+    ++NumValuesOverBudget;
+    return getUnknown(V);
+  }
+
   Operator *U = cast<Operator>(V);
   if (auto BO = MatchBinaryOp(U, DT)) {
     switch (BO->Opcode) {
@@ -6753,6 +6782,7 @@ void ScalarEvolution::forgetAllLoops() {
   BlockDispositions.clear();
   UnsignedRanges.clear();
   SignedRanges.clear();
+  KnownPredicates.clear();
   ExprValueMap.clear();
   HasRecMap.clear();
   MinTrailingZerosCache.clear();
@@ -6760,6 +6790,9 @@ void ScalarEvolution::forgetAllLoops() {
 }
 
 void ScalarEvolution::forgetLoop(const Loop *L) {
+  // Predicates may have been proven using the trip counts.
+  KnownPredicates.clear();
+
   // Drop any stored trip count value.
   auto RemoveLoopFromBackedgeMap =
       [](DenseMap<const Loop *, BackedgeTakenInfo> &Map, const Loop *L) {
@@ -9134,6 +9167,35 @@ bool ScalarEvolution::isKnownViaInduction(ICmpInst::Predicate Pred,
 
 bool ScalarEvolution::isKnownPredicate(ICmpInst::Predicate Pred,
                                        const SCEV *LHS, const SCEV *RHS) {
+  if (!MemoizeKnownPredicates)
+    return isKnownPredicateImpl(Pred, LHS, RHS);
+
+  assert(ICmpInst::isIntPredicate(Pred) && "Not an integer predicate!");
+  uint16_t Bit = 1u << (Pred - CmpInst::FIRST_ICMP_PREDICATE);
+  auto I = KnownPredicates.find({LHS, RHS});
+  if (I != KnownPredicates.end() && (I->second.Computed & Bit)) {
+    ++NumKnownPredicateCacheHits;
+    return I->second.Known & Bit;
+  }
+  ++NumKnownPredicateCacheMisses;
+
+  // Queries made while proving another predicate may give up early to break
+  // cycles, so only remember the answers to outermost queries.
+  bool IsOutermost = PendingLoopPredicates.empty() &&
+                     PendingPhiRanges.empty() && PendingMerges.empty() &&
+                     !WalkingBEDominatingConds && !ProvingSplitPredicate;
+  bool Result = isKnownPredicateImpl(Pred, LHS, RHS);
+  if (IsOutermost) {
+    KnownPredicateResults &Entry = KnownPredicates[{LHS, RHS}];
+    Entry.Computed |= Bit;
+    if (Result)
+      Entry.Known |= Bit;
+  }
+  return Result;
+}
+
+bool ScalarEvolution::isKnownPredicateImpl(ICmpInst::Predicate Pred,
+                                           const SCEV *LHS, const SCEV *RHS) {
   // Canonicalize the inputs first.
   (void)SimplifyICmpOperands(Pred, LHS, RHS);
 
@@ -11367,6 +11429,7 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
       BlockDispositions(std::move(Arg.BlockDispositions)),
       UnsignedRanges(std::move(Arg.UnsignedRanges)),
       SignedRanges(std::move(Arg.SignedRanges)),
+      KnownPredicates(std::move(Arg.KnownPredicates)),
       UniqueSCEVs(std::move(Arg.UniqueSCEVs)),
       UniquePreds(std::move(Arg.UniquePreds)),
       SCEVAllocator(std::move(Arg.SCEVAllocator)),
@@ -11792,6 +11855,8 @@ ScalarEvolution::forgetMemoizedResults(const SCEV *S) {
   ExprValueMap.erase(S);
   HasRecMap.erase(S);
   MinTrailingZerosCache.erase(S);
+  // A predicate on any expression may have been proven using facts about S.
+  KnownPredicates.clear();
 
   for (auto I = PredicatedSCEVRewrites.begin();
        I != PredicatedSCEVRewrites.end();) {
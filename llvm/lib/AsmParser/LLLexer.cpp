@@ -14,6 +14,7 @@
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Instruction.h"
@@ -444,58 +445,26 @@ lltok::Kind LLLexer::LexHash() {
   return LexUIntID(lltok::AttrGrpID);
 }
 
-/// Lex a label, integer type, keyword, or hexadecimal integer constant.
-///    Label           [-a-zA-Z$._0-9]+:
-///    IntegerType     i[0-9]+
-///    Keyword         sdiv, float, ...
-///    HexIntConstant  [us]0x[0-9A-Fa-f]+
-lltok::Kind LLLexer::LexIdentifier() {
-  const char *StartChar = CurPtr;
-  const char *IntEnd = CurPtr[-1] == 'i' ? nullptr : StartChar;
-  const char *KeywordEnd = nullptr;
+namespace {
 
-  for (; isLabelChar(*CurPtr); ++CurPtr) {
-    // If we decide this is an integer, remember the end of the sequence.
-    if (!IntEnd && !isdigit(static_cast<unsigned char>(*CurPtr)))
-      IntEnd = CurPtr;
-    if (!KeywordEnd && !isalnum(static_cast<unsigned char>(*CurPtr)) &&
-        *CurPtr != '_')
-      KeywordEnd = CurPtr;
-  }
+/// What a keyword lexes to. Type keywords also set TyVal, and instruction
+/// keywords set UIntVal to their opcode.
+struct KeywordInfo {
+  lltok::Kind Kind;
+  unsigned Opcode;
+  Type *(*GetType)(LLVMContext &);
 
-  // If we stopped due to a colon, unless we were directed to ignore it,
-  // this really is a label.
-  if (!IgnoreColonInIdentifiers && *CurPtr == ':') {
-    StrVal.assign(StartChar-1, CurPtr++);
-    return lltok::LabelStr;
-  }
+  KeywordInfo(lltok::Kind Kind, unsigned Opcode,
+              Type *(*GetType)(LLVMContext &))
+      : Kind(Kind), Opcode(Opcode), GetType(GetType) {}
+};
 
-  // Otherwise, this wasn't a label.  If this was valid as an integer type,
-  // return it.
-  if (!IntEnd) IntEnd = CurPtr;
-  if (IntEnd != StartChar) {
-    CurPtr = IntEnd;
-    uint64_t NumBits = atoull(StartChar, CurPtr);
-    if (NumBits < IntegerType::MIN_INT_BITS ||
-        NumBits > IntegerType::MAX_INT_BITS) {
-      Error("bitwidth for integer type out of range!");
-      return lltok::Error;
-    }
-    TyVal = IntegerType::get(Context, NumBits);
-    return lltok::Type;
-  }
+} // end anonymous namespace
 
-  // Otherwise, this was a letter sequence.  See which keyword this is.
-  if (!KeywordEnd) KeywordEnd = CurPtr;
-  CurPtr = KeywordEnd;
-  --StartChar;
-  StringRef Keyword(StartChar, CurPtr - StartChar);
+static StringMap<KeywordInfo> buildKeywordTable() {
+  StringMap<KeywordInfo> Table;
 
-#define KEYWORD(STR)                                                           \
-  do {                                                                         \
-    if (Keyword == #STR)                                                       \
-      return lltok::kw_##STR;                                                  \
-  } while (false)
+#define KEYWORD(STR) Table.try_emplace(#STR, lltok::kw_##STR, 0, nullptr)
 
   KEYWORD(true);    KEYWORD(false);
   KEYWORD(declare); KEYWORD(define);
@@ -804,35 +773,25 @@ lltok::Kind LLLexer::LexIdentifier() {
 
   // Keywords for types.
 #define TYPEKEYWORD(STR, LLVMTY)                                               \
-  do {                                                                         \
-    if (Keyword == STR) {                                                      \
-      TyVal = LLVMTY;                                                          \
-      return lltok::Type;                                                      \
-    }                                                                          \
-  } while (false)
-
-  TYPEKEYWORD("void",      Type::getVoidTy(Context));
-  TYPEKEYWORD("half",      Type::getHalfTy(Context));
-  TYPEKEYWORD("float",     Type::getFloatTy(Context));
-  TYPEKEYWORD("double",    Type::getDoubleTy(Context));
-  TYPEKEYWORD("x86_fp80",  Type::getX86_FP80Ty(Context));
-  TYPEKEYWORD("fp128",     Type::getFP128Ty(Context));
-  TYPEKEYWORD("ppc_fp128", Type::getPPC_FP128Ty(Context));
-  TYPEKEYWORD("label",     Type::getLabelTy(Context));
-  TYPEKEYWORD("metadata",  Type::getMetadataTy(Context));
-  TYPEKEYWORD("x86_mmx",   Type::getX86_MMXTy(Context));
-  TYPEKEYWORD("token",     Type::getTokenTy(Context));
+  Table.try_emplace(STR, lltok::Type, 0, &Type::LLVMTY)
+
+  TYPEKEYWORD("void",      getVoidTy);
+  TYPEKEYWORD("half",      getHalfTy);
+  TYPEKEYWORD("float",     getFloatTy);
+  TYPEKEYWORD("double",    getDoubleTy);
+  TYPEKEYWORD("x86_fp80",  getX86_FP80Ty);
+  TYPEKEYWORD("fp128",     getFP128Ty);
+  TYPEKEYWORD("ppc_fp128", getPPC_FP128Ty);
+  TYPEKEYWORD("label",     getLabelTy);
+  TYPEKEYWORD("metadata",  getMetadataTy);
+  TYPEKEYWORD("x86_mmx",   getX86_MMXTy);
+  TYPEKEYWORD("token",     getTokenTy);
 
 #undef TYPEKEYWORD
 
   // Keywords for instructions.
 #define INSTKEYWORD(STR, Enum)                                                 \
-  do {                                                                         \
-    if (Keyword == #STR) {                                                     \
-      UIntVal = Instruction::Enum;                                             \
-      return lltok::kw_##STR;                                                  \
-    }                                                                          \
-  } while (false)
+  Table.try_emplace(#STR, lltok::kw_##STR, Instruction::Enum, nullptr)
 
   INSTKEYWORD(fneg,  FNeg);
 
@@ -893,6 +852,76 @@ lltok::Kind LLLexer::LexIdentifier() {
 
 #undef INSTKEYWORD
 
+  return Table;
+}
+
+/// Return the table of the keywords with a fixed spelling, built on first use.
+/// Looking a keyword up in it is much cheaper than comparing it against each
+/// of the several hundred keywords in turn.
+static const StringMap<KeywordInfo> &getKeywordTable() {
+  static const StringMap<KeywordInfo> Keywords = buildKeywordTable();
+  return Keywords;
+}
+
+/// Lex a label, integer type, keyword, or hexadecimal integer constant.
+///    Label           [-a-zA-Z$._0-9]+:
+///    IntegerType     i[0-9]+
+///    Keyword         sdiv, float, ...
+///    HexIntConstant  [us]0x[0-9A-Fa-f]+
+lltok::Kind LLLexer::LexIdentifier() {
+  const char *StartChar = CurPtr;
+  const char *IntEnd = CurPtr[-1] == 'i' ? nullptr : StartChar;
+  const char *KeywordEnd = nullptr;
+
+  for (; isLabelChar(*CurPtr); ++CurPtr) {
+    // If we decide this is an integer, remember the end of the sequence.
+    if (!IntEnd && !isdigit(static_cast<unsigned char>(*CurPtr)))
+      IntEnd = CurPtr;
+    if (!KeywordEnd && !isalnum(static_cast<unsigned char>(*CurPtr)) &&
+        *CurPtr != '_')
+      KeywordEnd = CurPtr;
+  }
+
+  // If we stopped due to a colon, unless we were directed to ignore it,
+  // this really is a label.
+  if (!IgnoreColonInIdentifiers && *CurPtr == ':') {
+    StrVal.assign(StartChar-1, CurPtr++);
+    return lltok::LabelStr;
+  }
+
+  // Otherwise, this wasn't a label.  If this was valid as an integer type,
+  // return it.
+  if (!IntEnd) IntEnd = CurPtr;
+  if (IntEnd != StartChar) {
+    CurPtr = IntEnd;
+    uint64_t NumBits = atoull(StartChar, CurPtr);
+    if (NumBits < IntegerType::MIN_INT_BITS ||
+        NumBits > IntegerType::MAX_INT_BITS) {
+      Error("bitwidth for integer type out of range!");
+      return lltok::Error;
+    }
+    TyVal = IntegerType::get(Context, NumBits);
+    return lltok::Type;
+  }
+
+  // Otherwise, this was a letter sequence.  See which keyword this is.
+  if (!KeywordEnd) KeywordEnd = CurPtr;
+  CurPtr = KeywordEnd;
+  --StartChar;
+  StringRef Keyword(StartChar, CurPtr - StartChar);
+
+  const StringMap<KeywordInfo> &Keywords = getKeywordTable();
+  auto KI = Keywords.find(Keyword);
+  if (KI != Keywords.end()) {
+    const KeywordInfo &Info = KI->second;
+    if (Info.GetType)
+      TyVal = Info.GetType(Context);
+    // No instruction has opcode 0.
+    if (Info.Opcode)
+      UIntVal = Info.Opcode;
+    return Info.Kind;
+  }
+
 #define DWKEYWORD(TYPE, TOKEN)                                                 \
   do {                                                                         \
     if (Keyword.startswith("DW_" #TYPE "_")) {                                 \
@@ -70,6 +70,7 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -92,6 +93,11 @@ static cl::opt<bool> PrintSummaryGUIDs(
     cl::desc(
         "Print the global id for each value when reading the module summary"));
 
+static cl::opt<bool> ParallelFunctionDecoding(
+    "bitcode-parallel-function-decoding", cl::init(false), cl::Hidden,
+    cl::desc("Decode the records of function bodies on multiple threads when "
+             "materializing a whole module"));
+
 namespace {
 
 enum {
@@ -480,6 +486,115 @@ BitcodeReaderBase::readNameFromStrtab(ArrayRef<uint64_t> Record) {
 
 namespace {
 
+/// The top-level records of a function block, decoded ahead of its
+/// materialization, possibly on another thread. Nested blocks are only
+/// located: parsing them creates constants and metadata in the LLVMContext,
+/// so it is left to the main stream when the function is materialized.
+class PredecodedFunctionBlock {
+  struct Entry {
+    decltype(BitstreamEntry::Kind) Kind;
+    /// The block ID of a nested block, or the code of a record.
+    unsigned ID;
+    /// The number of operands of a record.
+    unsigned NumOps;
+    /// For a nested block, the position after its block ID. For the end of
+    /// the block, the position before the END_BLOCK code.
+    uint64_t BitNo;
+  };
+  std::vector<Entry> Entries;
+  std::vector<uint64_t> Ops;
+  size_t NextEntry = 0;
+  size_t NextOp = 0;
+
+public:
+  /// Decode the function block at \p BitNo of \p Stream. Returns false if the
+  /// block is malformed, leaving it to the regular parser to diagnose.
+  bool decode(BitstreamCursor &Stream, uint64_t BitNo);
+
+  /// Return the next entry of the block like BitstreamCursor::advance().
+  /// Moves \p Stream to the start of a nested block before returning it, and
+  /// past the end of the block before returning the block end.
+  Expected<BitstreamEntry> advance(BitstreamCursor &Stream);
+
+  /// Read the record returned by the last call to advance(), like
+  /// BitstreamCursor::readRecord().
+  unsigned readRecord(SmallVectorImpl<uint64_t> &Record);
+};
+
+} // end anonymous namespace
+
+bool PredecodedFunctionBlock::decode(BitstreamCursor &Stream, uint64_t BitNo) {
+  auto Fail = [](Error Err) {
+    consumeError(std::move(Err));
+    return false;
+  };
+  if (Error Err = Stream.JumpToBit(BitNo))
+    return Fail(std::move(Err));
+  if (Error Err = Stream.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
+    return Fail(std::move(Err));
+
+  SmallVector<uint64_t, 64> Record;
+  while (true) {
+    uint64_t EntryBitNo = Stream.GetCurrentBitNo();
+    Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+    if (!MaybeEntry)
+      return Fail(MaybeEntry.takeError());
+    BitstreamEntry Entry = MaybeEntry.get();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return false;
+    case BitstreamEntry::EndBlock:
+      Entries.push_back({Entry.Kind, 0, 0, EntryBitNo});
+      return true;
+    case BitstreamEntry::SubBlock:
+      Entries.push_back({Entry.Kind, Entry.ID, 0, Stream.GetCurrentBitNo()});
+      if (Error Err = Stream.SkipBlock())
+        return Fail(std::move(Err));
+      break;
+    case BitstreamEntry::Record: {
+      Record.clear();
+      Expected<unsigned> MaybeCode = Stream.readRecord(Entry.ID, Record);
+      if (!MaybeCode)
+        return Fail(MaybeCode.takeError());
+      Entries.push_back(
+          {Entry.Kind, MaybeCode.get(), unsigned(Record.size()), 0});
+      Ops.insert(Ops.end(), Record.begin(), Record.end());
+      break;
+    }
+    }
+  }
+}
+
+Expected<BitstreamEntry>
+PredecodedFunctionBlock::advance(BitstreamCursor &Stream) {
+  assert(NextEntry < Entries.size() && "Read past the end of the block");
+  const Entry &E = Entries[NextEntry++];
+  switch (E.Kind) {
+  case BitstreamEntry::SubBlock:
+    if (Error Err = Stream.JumpToBit(E.BitNo))
+      return std::move(Err);
+    return BitstreamEntry::getSubBlock(E.ID);
+  case BitstreamEntry::EndBlock:
+    // Let the stream read the end of the block, which pops the block scope.
+    if (Error Err = Stream.JumpToBit(E.BitNo))
+      return std::move(Err);
+    return Stream.advance();
+  default:
+    return BitstreamEntry::getRecord(0);
+  }
+}
+
+unsigned PredecodedFunctionBlock::readRecord(SmallVectorImpl<uint64_t> &Record) {
+  const Entry &E = Entries[NextEntry - 1];
+  assert(E.Kind == BitstreamEntry::Record && "Not at a record");
+  Record.append(Ops.begin() + NextOp, Ops.begin() + NextOp + E.NumOps);
+  NextOp += E.NumOps;
+  return E.ID;
+}
+
+namespace {
+
 class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   LLVMContext &Context;
   Module *TheModule = nullptr;
@@ -537,6 +652,11 @@ class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   /// where to find deferred function body in the stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
 
+  /// Function bodies whose records have been decoded ahead of time by
+  /// predecodeFunctionBodies().
+  DenseMap<Function *, std::unique_ptr<PredecodedFunctionBlock>>
+      PredecodedBodies;
+
   /// When Metadata block is initially scanned when parsing the module, we may
   /// choose to defer parsing of the metadata. This vector contains info about
   /// which Metadata blocks are deferred.
@@ -572,6 +692,10 @@ public:
 
   Error materializeForwardReferencedFunctions();
 
+  /// Decode the records of the bodies of \p Fns in parallel, for use by the
+  /// following calls to parseFunctionBody().
+  void predecodeFunctionBodies(ArrayRef<Function *> Fns);
+
   Error materialize(GlobalValue *GV) override;
   Error materializeModule() override;
   std::vector<StructType *> getIdentifiedStructTypes() const override;
@@ -807,10 +931,15 @@ class ModuleSummaryIndexBitcodeReader : public BitcodeReaderBase {
   /// this module by the client.
   unsigned ModuleId;
 
+  /// If set, only the summaries of these GUIDs, and of the aliasees of those
+  /// that are aliases, are read from a combined index that has a GUID table.
+  Optional<ArrayRef<GlobalValue::GUID>> GUIDsToRead;
+
 public:
-  ModuleSummaryIndexBitcodeReader(BitstreamCursor Stream, StringRef Strtab,
-                                  ModuleSummaryIndex &TheIndex,
-                                  StringRef ModulePath, unsigned ModuleId);
+  ModuleSummaryIndexBitcodeReader(
+      BitstreamCursor Stream, StringRef Strtab, ModuleSummaryIndex &TheIndex,
+      StringRef ModulePath, unsigned ModuleId,
+      Optional<ArrayRef<GlobalValue::GUID>> GUIDsToRead = None);
 
   Error parseModule();
 
@@ -822,6 +951,7 @@ private:
       uint64_t Offset,
       DenseMap<unsigned, GlobalValue::LinkageTypes> &ValueIdToLinkageMap);
   std::vector<ValueInfo> makeRefList(ArrayRef<uint64_t> Record);
+  Error readGUIDTable(uint64_t Offset, std::vector<uint64_t> &SummaryOffsets);
   std::vector<FunctionSummary::EdgeTy> makeCallList(ArrayRef<uint64_t> Record,
                                                     bool IsOldProfileFormat,
                                                     bool HasProfile,
@@ -2930,7 +3060,12 @@ Error BitcodeReader::materializeMetadata() {
   return Error::success();
 }
 
-void BitcodeReader::setStripDebugInfo() { StripDebugInfo = true; }
+void BitcodeReader::setStripDebugInfo() {
+  StripDebugInfo = true;
+  // Metadata that hasn't been read yet doesn't need to be.
+  if (MDLoader)
+    MDLoader->setStripDebugInfo();
+}
 
 /// When we see the block for a function body, remember where it is and then
 /// skip it.  This lets us lazily deserialize the functions.
@@ -3652,7 +3787,10 @@ Error BitcodeReader::parseModule(uint64_t ResumeBit,
 Error BitcodeReader::parseBitcodeInto(Module *M, bool ShouldLazyLoadMetadata,
                                       bool IsImporting) {
   TheModule = M;
+  // Lazily loaded metadata is also loaded on demand, so that the debug info of
+  // functions that are never materialized is never read.
   MDLoader = MetadataLoader(Stream, *M, ValueList, IsImporting,
+                            /*LoadOnDemand=*/ShouldLazyLoadMetadata,
                             [&](unsigned ID) { return getTypeByID(ID); });
   return parseModule(0, ShouldLazyLoadMetadata);
 }
@@ -3688,6 +3826,14 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
   if (Error Err = Stream.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
     return Err;
 
+  // Use the records decoded ahead of time, if there are any.
+  std::unique_ptr<PredecodedFunctionBlock> Predecoded;
+  auto PI = PredecodedBodies.find(F);
+  if (PI != PredecodedBodies.end()) {
+    Predecoded = std::move(PI->second);
+    PredecodedBodies.erase(PI);
+  }
+
   // Unexpected unresolved metadata when parsing function.
   if (MDLoader->hasFwdRefs())
     return error("Invalid function metadata: incoming forward references");
@@ -3724,7 +3870,8 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
   SmallVector<uint64_t, 64> Record;
 
   while (true) {
-    Expected<llvm::BitstreamEntry> MaybeEntry = Stream.advance();
+    Expected<llvm::BitstreamEntry> MaybeEntry =
+        Predecoded ? Predecoded->advance(Stream) : Stream.advance();
     if (!MaybeEntry)
       return MaybeEntry.takeError();
     llvm::BitstreamEntry Entry = MaybeEntry.get();
@@ -3776,7 +3923,9 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
     Record.clear();
     Instruction *I = nullptr;
     Type *FullTy = nullptr;
-    Expected<unsigned> MaybeBitCode = Stream.readRecord(Entry.ID, Record);
+    Expected<unsigned> MaybeBitCode = Predecoded
+                                          ? Predecoded->readRecord(Record)
+                                          : Stream.readRecord(Entry.ID, Record);
     if (!MaybeBitCode)
       return MaybeBitCode.takeError();
     switch (unsigned BitCode = MaybeBitCode.get()) {
@@ -3833,6 +3982,12 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
       if (!I || Record.size() < 4)
         return error("Invalid record");
 
+      // Don't load the scope of a location that would be stripped anyway.
+      if (StripDebugInfo) {
+        I = nullptr;
+        continue;
+      }
+
       unsigned Line = Record[0], Col = Record[1];
       unsigned ScopeID = Record[2], IAID = Record[3];
       bool isImplicitCode = Record.size() == 5 && Record[4];
@@ -5006,12 +5161,31 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
       if (Record.size() < FTy->getNumParams() + OpNum)
         return error("Insufficient operands to call");
 
+      // Debug info intrinsics are erased when stripping debug info, so don't
+      // load the variables and expressions they reference.
+      bool IsStrippedDbgCall = false;
+      if (StripDebugInfo)
+        if (auto *CalleeF = dyn_cast<Function>(Callee))
+          switch (CalleeF->getIntrinsicID()) {
+          case Intrinsic::dbg_declare:
+          case Intrinsic::dbg_value:
+          case Intrinsic::dbg_addr:
+          case Intrinsic::dbg_label:
+            IsStrippedDbgCall = true;
+            break;
+          default:
+            break;
+          }
+
       SmallVector<Value*, 16> Args;
       SmallVector<Type*, 16> ArgsFullTys;
       // Read the fixed params.
       for (unsigned i = 0, e = FTy->getNumParams(); i != e; ++i, ++OpNum) {
         if (FTy->getParamType(i)->isLabelTy())
           Args.push_back(getBasicBlock(Record[OpNum]));
+        else if (IsStrippedDbgCall && FTy->getParamType(i)->isMetadataTy())
+          Args.push_back(
+              MetadataAsValue::get(Context, MDNode::get(Context, {})));
         else
           Args.push_back(getValue(Record, OpNum, NextValueNo,
                                   FTy->getParamType(i)));
@@ -5260,6 +5434,26 @@ Error BitcodeReader::materialize(GlobalValue *GV) {
   return materializeForwardReferencedFunctions();
 }
 
+void BitcodeReader::predecodeFunctionBodies(ArrayRef<Function *> Fns) {
+  std::vector<std::unique_ptr<PredecodedFunctionBlock>> Blocks(Fns.size());
+  auto Decode = [&](size_t I) {
+    // The cursors share the bitcode and the block info, which are only read.
+    BitstreamCursor Cursor(Stream.getBitcodeBytes());
+    Cursor.setBlockInfo(&BlockInfo);
+    auto Block = std::make_unique<PredecodedFunctionBlock>();
+    if (Block->decode(Cursor, DeferredFunctionInfo[Fns[I]]))
+      Blocks[I] = std::move(Block);
+  };
+#if LLVM_ENABLE_THREADS
+  parallel::for_each_n(parallel::par, size_t(0), Fns.size(), Decode);
+#else
+  parallel::for_each_n(parallel::seq, size_t(0), Fns.size(), Decode);
+#endif
+  for (size_t I = 0, E = Fns.size(); I != E; ++I)
+    if (Blocks[I])
+      PredecodedBodies[Fns[I]] = std::move(Blocks[I]);
+}
+
 Error BitcodeReader::materializeModule() {
   if (Error Err = materializeMetadata())
     return Err;
@@ -5268,11 +5462,31 @@ Error BitcodeReader::materializeModule() {
   WillMaterializeAllForwardRefs = true;
 
   // Iterate over the module, deserializing any functions that are still on
-  // disk.
-  for (Function &F : *TheModule) {
-    if (Error Err = materialize(&F))
-      return Err;
+  // disk. With -bitcode-parallel-function-decoding, the records of the
+  // function bodies are decoded in parallel ahead of the serial construction
+  // of the IR, in batches to bound the memory used by the decoded records.
+  // Bodies whose position is not known yet are left to the serial path.
+  const size_t BatchSize = 256;
+  std::vector<Function *> Batch;
+  auto I = TheModule->begin(), E = TheModule->end();
+  while (I != E) {
+    auto BatchEnd = I;
+    if (ParallelFunctionDecoding) {
+      Batch.clear();
+      for (; BatchEnd != E && Batch.size() < BatchSize; ++BatchEnd) {
+        Function &F = *BatchEnd;
+        if (F.isMaterializable() && DeferredFunctionInfo.lookup(&F) != 0)
+          Batch.push_back(&F);
+      }
+      predecodeFunctionBodies(Batch);
+    } else {
+      BatchEnd = E;
+    }
+    for (; I != BatchEnd; ++I)
+      if (Error Err = materialize(&*I))
+        return Err;
   }
+  PredecodedBodies.clear();
   // At this point, if there are any function bodies, parse the rest of
   // the bits in the module past the last function block we have recorded
   // through either lazy scanning or the VST.
@@ -5323,9 +5537,10 @@ std::vector<StructType *> BitcodeReader::getIdentifiedStructTypes() const {
 
 ModuleSummaryIndexBitcodeReader::ModuleSummaryIndexBitcodeReader(
     BitstreamCursor Cursor, StringRef Strtab, ModuleSummaryIndex &TheIndex,
-    StringRef ModulePath, unsigned ModuleId)
+    StringRef ModulePath, unsigned ModuleId,
+    Optional<ArrayRef<GlobalValue::GUID>> GUIDsToRead)
     : BitcodeReaderBase(std::move(Cursor), Strtab), TheIndex(TheIndex),
-      ModulePath(ModulePath), ModuleId(ModuleId) {}
+      ModulePath(ModulePath), ModuleId(ModuleId), GUIDsToRead(GUIDsToRead) {}
 
 void ModuleSummaryIndexBitcodeReader::addThisModule() {
   TheIndex.addModule(ModulePath, ModuleId);
@@ -5338,11 +5553,72 @@ ModuleSummaryIndexBitcodeReader::getThisModule() {
 
 std::pair<ValueInfo, GlobalValue::GUID>
 ModuleSummaryIndexBitcodeReader::getValueInfoFromValueId(unsigned ValueId) {
-  auto VGI = ValueIdToValueInfoMap[ValueId];
+  auto &VGI = ValueIdToValueInfoMap[ValueId];
+  // When only some summaries are read, value infos are created on first use,
+  // so that the index only holds the values that are referenced.
+  if (!VGI.first && GUIDsToRead)
+    VGI.first = TheIndex.getOrInsertValueInfo(VGI.second);
   assert(VGI.first);
   return VGI;
 }
 
+/// Read the GUID table at \p Offset in the current block, and fill
+/// \p SummaryOffsets with the sorted offsets of the summaries to read.
+Error ModuleSummaryIndexBitcodeReader::readGUIDTable(
+    uint64_t Offset, std::vector<uint64_t> &SummaryOffsets) {
+  if (Error JumpFailed = Stream.JumpToBit(Offset))
+    return JumpFailed;
+  Expected<BitstreamEntry> MaybeEntry = Stream.advanceSkippingSubblocks();
+  if (!MaybeEntry)
+    return MaybeEntry.takeError();
+  if (MaybeEntry->Kind != BitstreamEntry::Record)
+    return error("Invalid GUID table offset");
+  SmallVector<uint64_t, 1> Record;
+  StringRef Blob;
+  Expected<unsigned> MaybeCode =
+      Stream.readRecord(MaybeEntry->ID, Record, &Blob);
+  if (!MaybeCode)
+    return MaybeCode.takeError();
+  if (MaybeCode.get() != bitc::FS_GUID_TABLE || Blob.size() % 24)
+    return error("Invalid GUID table");
+
+  // The table is searched where it is, without decoding it first.
+  using namespace support;
+  const char *Table = Blob.data();
+  size_t NumEntries = Blob.size() / 24;
+  auto GUIDAt = [&](size_t I) { return endian::read64le(Table + I * 24); };
+  std::vector<GlobalValue::GUID> Aliasees;
+  auto ReadGUID = [&](GlobalValue::GUID GUID) {
+    size_t Lo = 0, Hi = NumEntries;
+    while (Lo < Hi) {
+      size_t Mid = Lo + (Hi - Lo) / 2;
+      if (GUIDAt(Mid) < GUID)
+        Lo = Mid + 1;
+      else
+        Hi = Mid;
+    }
+    for (size_t I = Lo; I != NumEntries && GUIDAt(I) == GUID; ++I) {
+      SummaryOffsets.push_back(endian::read64le(Table + I * 24 + 8));
+      // The aliasee must be read for the reader to resolve the alias.
+      if (GlobalValue::GUID Aliasee = endian::read64le(Table + I * 24 + 16))
+        Aliasees.push_back(Aliasee);
+    }
+  };
+  for (GlobalValue::GUID GUID : *GUIDsToRead)
+    ReadGUID(GUID);
+  // Aliasees are never aliases themselves.
+  for (size_t I = 0, E = Aliasees.size(); I != E; ++I)
+    ReadGUID(Aliasees[I]);
+
+  // Read the summaries in the order in which they were written, so that
+  // aliasees are read before their aliases.
+  llvm::sort(SummaryOffsets);
+  SummaryOffsets.erase(std::unique(SummaryOffsets.begin(),
+                                   SummaryOffsets.end()),
+                       SummaryOffsets.end());
+  return Error::success();
+}
+
 void ModuleSummaryIndexBitcodeReader::setValueGUID(
     uint64_t ValueID, StringRef ValueName, GlobalValue::LinkageTypes Linkage,
     StringRef SourceFileName) {
@@ -5722,6 +5998,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(unsigned ID) {
   if (Error Err = Stream.EnterSubBlock(ID))
     return Err;
   SmallVector<uint64_t, 64> Record;
+  uint64_t BlockStartBit = Stream.GetCurrentBitNo();
 
   // Parse version
   {
@@ -5759,7 +6036,58 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(unsigned ID) {
   std::vector<FunctionSummary::ConstVCall> PendingTypeTestAssumeConstVCalls,
       PendingTypeCheckedLoadConstVCalls;
 
+  // When only some summaries are read from a combined index with a GUID
+  // table, the reader jumps from one summary to read to the next, starting at
+  // SummariesBit, and then to TailBit for the records after the summaries.
+  // The table is read on reaching SummariesBit, once the abbreviations it
+  // uses are defined.
+  std::vector<uint64_t> SummaryOffsets;
+  size_t NextSummary = 0;
+  Optional<uint64_t> SummariesBit;
+  uint64_t TableBit = 0, TailBit = 0;
+  bool SkippingSummaries = false, JumpAfterSummary = false;
+  auto JumpToNextSummary = [&]() -> Error {
+    if (NextSummary != SummaryOffsets.size())
+      return Stream.JumpToBit(BlockStartBit + SummaryOffsets[NextSummary++]);
+    SkippingSummaries = false;
+    return Stream.JumpToBit(BlockStartBit + TailBit);
+  };
+
   while (true) {
+    if (SummariesBit && *SummariesBit == Stream.GetCurrentBitNo()) {
+      SummariesBit.reset();
+      SkippingSummaries = true;
+      if (Error Err = readGUIDTable(TableBit, SummaryOffsets))
+        return Err;
+      if (Error Err = JumpToNextSummary())
+        return Err;
+    }
+
+    if (JumpAfterSummary) {
+      JumpAfterSummary = false;
+      // Attach the original name that may follow the summary record, then
+      // skip the summaries that are not read.
+      Expected<BitstreamEntry> MaybeEntry = Stream.advanceSkippingSubblocks();
+      if (!MaybeEntry)
+        return MaybeEntry.takeError();
+      if (MaybeEntry->Kind == BitstreamEntry::Record) {
+        Record.clear();
+        Expected<unsigned> MaybeBitCode =
+            Stream.readRecord(MaybeEntry->ID, Record);
+        if (!MaybeBitCode)
+          return MaybeBitCode.takeError();
+        if (MaybeBitCode.get() == bitc::FS_COMBINED_ORIGINAL_NAME) {
+          LastSeenSummary->setOriginalName(Record[0]);
+          TheIndex.addOriginalName(LastSeenGUID, Record[0]);
+        }
+      }
+      LastSeenSummary = nullptr;
+      LastSeenGUID = 0;
+      if (Error Err = JumpToNextSummary())
+        return Err;
+      continue;
+    }
+
     Expected<BitstreamEntry> MaybeEntry = Stream.advanceSkippingSubblocks();
     if (!MaybeEntry)
       return MaybeEntry.takeError();
@@ -5821,8 +6149,20 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(unsigned ID) {
     case bitc::FS_VALUE_GUID: { // [valueid, refguid]
       uint64_t ValueID = Record[0];
       GlobalValue::GUID RefGUID = Record[1];
-      ValueIdToValueInfoMap[ValueID] =
-          std::make_pair(TheIndex.getOrInsertValueInfo(RefGUID), RefGUID);
+      ValueIdToValueInfoMap[ValueID] = std::make_pair(
+          GUIDsToRead ? ValueInfo() : TheIndex.getOrInsertValueInfo(RefGUID),
+          RefGUID);
+      break;
+    }
+    // FS_GUID_TABLE_OFFSET: [table offset, summaries offset, tail offset]
+    case bitc::FS_GUID_TABLE_OFFSET: {
+      if (!GUIDsToRead)
+        break;
+      if (Record.size() != 6)
+        return error("Invalid GUID table offset record");
+      TableBit = BlockStartBit + (Record[0] | Record[1] << 32);
+      SummariesBit = BlockStartBit + (Record[2] | Record[3] << 32);
+      TailBit = Record[4] | Record[5] << 32;
       break;
     }
     // FS_PERMODULE: [valueid, flags, instcount, fflags, numrefs,
@@ -6035,6 +6375,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(unsigned ID) {
       LastSeenGUID = VI.getGUID();
       FS->setModulePath(ModuleIdMap[ModuleId]);
       TheIndex.addGlobalValueSummary(VI, std::move(FS));
+      JumpAfterSummary = SkippingSummaries;
       break;
     }
     // FS_COMBINED_ALIAS: [valueid, modid, flags, valueid]
@@ -6057,6 +6398,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(unsigned ID) {
       ValueInfo VI = getValueInfoFromValueId(ValueID).first;
       LastSeenGUID = VI.getGUID();
       TheIndex.addGlobalValueSummary(VI, std::move(AS));
+      JumpAfterSummary = SkippingSummaries;
       break;
     }
     // FS_COMBINED_GLOBALVAR_INIT_REFS: [valueid, modid, flags, n x valueid]
@@ -6081,6 +6423,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(unsigned ID) {
       ValueInfo VI = getValueInfoFromValueId(ValueID).first;
       LastSeenGUID = VI.getGUID();
       TheIndex.addGlobalValueSummary(VI, std::move(FS));
+      JumpAfterSummary = SkippingSummaries;
       break;
     }
     // FS_COMBINED_ORIGINAL_NAME: [original_name]
@@ -6495,6 +6838,22 @@ Expected<std::unique_ptr<ModuleSummaryIndex>> BitcodeModule::getSummary() {
   return std::move(Index);
 }
 
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+BitcodeModule::getSummary(ArrayRef<GlobalValue::GUID> GUIDs) {
+  BitstreamCursor Stream(Buffer);
+  if (Error JumpFailed = Stream.JumpToBit(ModuleBit))
+    return std::move(JumpFailed);
+
+  auto Index = std::make_unique<ModuleSummaryIndex>(/*HaveGVs=*/false);
+  ModuleSummaryIndexBitcodeReader R(std::move(Stream), Strtab, *Index,
+                                    ModuleIdentifier, 0, GUIDs);
+
+  if (Error Err = R.parseModule())
+    return std::move(Err);
+
+  return std::move(Index);
+}
+
 static Expected<bool> getEnableSplitLTOUnitFlag(BitstreamCursor &Stream,
                                                 unsigned ID) {
   if (Error Err = Stream.EnterSubBlock(ID))
@@ -6685,6 +7044,16 @@ llvm::getModuleSummaryIndex(MemoryBufferRef Buffer) {
   return BM->getSummary();
 }
 
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+llvm::getModuleSummaryIndex(MemoryBufferRef Buffer,
+                            ArrayRef<GlobalValue::GUID> GUIDs) {
+  Expected<BitcodeModule> BM = getSingleModule(Buffer);
+  if (!BM)
+    return BM.takeError();
+
+  return BM->getSummary(GUIDs);
+}
+
 Expected<BitcodeLTOInfo> llvm::getBitcodeLTOInfo(MemoryBufferRef Buffer) {
   Expected<BitcodeModule> BM = getSingleModule(Buffer);
   if (!BM)
@@ -99,7 +99,7 @@ static cl::opt<bool> ImportFullTypeDefinitions(
 static cl::opt<bool> DisableLazyLoading(
     "disable-ondemand-mds-loading", cl::init(false), cl::Hidden,
     cl::desc("Force disable the lazy-loading on-demand of metadata when "
-             "loading bitcode for importing."));
+             "loading bitcode for importing or with lazy metadata."));
 
 namespace {
 
@@ -450,6 +450,29 @@ class MetadataLoader::MetadataLoaderImpl {
   /// populated.
   void lazyLoadOneMetadata(unsigned Idx, PlaceholderQueue &Placeholders);
 
+  /// Cursor with the abbreviations of the function-level metadata block that
+  /// was last indexed by lazyLoadFunctionMetadataBlock().
+  BitstreamCursor FunctionIndexCursor;
+
+  /// Position and abbreviation ID of the records of that block, for the
+  /// metadata IDs starting at FunctionMetadataBase. The entries for strings,
+  /// which are loaded eagerly, are empty.
+  std::vector<std::pair<uint64_t, unsigned>> FunctionMetadataBitPosIndex;
+  unsigned FunctionMetadataBase = 0;
+
+  /// Populate the index above for the function-level metadata block, without
+  /// loading anything but its strings. Only used when stripping debug info,
+  /// where most of the metadata of a function is never referenced.
+  Error lazyLoadFunctionMetadataBlock();
+
+  /// Return true if \p ID can be loaded using one of the indexes above.
+  bool isLazyLoadable(unsigned ID) const {
+    if (ID < MDStringRef.size() + GlobalMetadataBitPosIndex.size())
+      return true;
+    return ID >= FunctionMetadataBase &&
+           ID - FunctionMetadataBase < FunctionMetadataBitPosIndex.size();
+  }
+
   // Keep mapping of seens pair of old-style CU <-> SP, and update pointers to
   // point from SP to CU after a block is completly parsed.
   std::vector<std::pair<DICompileUnit *, Metadata *>> CUSubprograms;
@@ -462,6 +485,7 @@ class MetadataLoader::MetadataLoaderImpl {
   DenseMap<unsigned, unsigned> MDKindMap;
 
   bool StripTBAA = false;
+  bool StripDebugInfo = false;
   bool HasSeenOldLoopTags = false;
   bool NeedUpgradeToDIGlobalVariableExpression = false;
   bool NeedDeclareExpressionUpgrade = false;
@@ -469,6 +493,10 @@ class MetadataLoader::MetadataLoaderImpl {
   /// True if metadata is being parsed for a module being ThinLTO imported.
   bool IsImporting = false;
 
+  /// True if module-level metadata should be loaded on demand through the
+  /// metadata index, instead of all at once. Always true when importing.
+  bool LoadOnDemand = false;
+
   Error parseOneMetadata(SmallVectorImpl<uint64_t> &Record, unsigned Code,
                          PlaceholderQueue &Placeholders, StringRef Blob,
                          unsigned &NextMetadataNo);
@@ -635,11 +663,11 @@ public:
   MetadataLoaderImpl(BitstreamCursor &Stream, Module &TheModule,
                      BitcodeReaderValueList &ValueList,
                      std::function<Type *(unsigned)> getTypeByID,
-                     bool IsImporting)
+                     bool IsImporting, bool LoadOnDemand)
       : MetadataList(TheModule.getContext(), Stream.SizeInBytes()),
         ValueList(ValueList), Stream(Stream), Context(TheModule.getContext()),
         TheModule(TheModule), getTypeByID(std::move(getTypeByID)),
-        IsImporting(IsImporting) {}
+        IsImporting(IsImporting), LoadOnDemand(IsImporting || LoadOnDemand) {}
 
   Error parseMetadata(bool ModuleLevel);
 
@@ -652,7 +680,7 @@ public:
       return MD;
     // If lazy-loading is enabled, we try recursively to load the operand
     // instead of creating a temporary.
-    if (ID < (MDStringRef.size() + GlobalMetadataBitPosIndex.size())) {
+    if (isLazyLoadable(ID)) {
       PlaceholderQueue Placeholders;
       lazyLoadOneMetadata(ID, Placeholders);
       resolveForwardRefsAndPlaceholders(Placeholders);
@@ -675,8 +703,20 @@ public:
   void setStripTBAA(bool Value) { StripTBAA = Value; }
   bool isStrippingTBAA() { return StripTBAA; }
 
+  void setStripDebugInfo(bool Value) { StripDebugInfo = Value; }
+
+  /// Return true if \p Name is named metadata dropped when stripping debug
+  /// info, matching StripDebugInfo().
+  bool isStrippedNamedMetadata(StringRef Name) const {
+    return StripDebugInfo &&
+           (Name.startswith("llvm.dbg.") || Name == "llvm.gcov");
+  }
+
   unsigned size() const { return MetadataList.size(); }
-  void shrinkTo(unsigned N) { MetadataList.shrinkTo(N); }
+  void shrinkTo(unsigned N) {
+    MetadataList.shrinkTo(N);
+    FunctionMetadataBitPosIndex.clear();
+  }
   void upgradeDebugIntrinsics(Function &F) { upgradeDeclareExpressions(F); }
 };
 
@@ -805,6 +845,11 @@ MetadataLoader::MetadataLoaderImpl::lazyLoadModuleMetadataBlock() {
         else
           return MaybeNextBitCode.takeError();
 
+        // Skip named metadata that would be stripped without loading the
+        // nodes it references.
+        if (isStrippedNamedMetadata(Name))
+          break;
+
         // Read named metadata elements.
         unsigned Size = Record.size();
         NamedMDNode *NMD = TheModule.getOrInsertNamedMetadata(Name);
@@ -905,7 +950,7 @@ Error MetadataLoader::MetadataLoaderImpl::parseMetadata(bool ModuleLevel) {
 
   // We lazy-load module-level metadata: we build an index for each record, and
   // then load individual record as needed, starting with the named metadata.
-  if (ModuleLevel && IsImporting && MetadataList.empty() &&
+  if (ModuleLevel && LoadOnDemand && MetadataList.empty() &&
       !DisableLazyLoading) {
     auto SuccessOrErr = lazyLoadModuleMetadataBlock();
     if (!SuccessOrErr)
@@ -936,6 +981,9 @@ Error MetadataLoader::MetadataLoaderImpl::parseMetadata(bool ModuleLevel) {
     // Couldn't load an index, fallback to loading all the block "old-style".
   }
 
+  if (!ModuleLevel && StripDebugInfo && !DisableLazyLoading)
+    return lazyLoadFunctionMetadataBlock();
+
   unsigned NextMetadataNo = MetadataList.size();
 
   // Read all the records.
@@ -972,6 +1020,95 @@ Error MetadataLoader::MetadataLoaderImpl::parseMetadata(bool ModuleLevel) {
   }
 }
 
+Error MetadataLoader::MetadataLoaderImpl::lazyLoadFunctionMetadataBlock() {
+  FunctionMetadataBase = MetadataList.size();
+  FunctionMetadataBitPosIndex.clear();
+  unsigned NextMetadataNo = FunctionMetadataBase;
+  SmallVector<uint64_t, 64> Record;
+  PlaceholderQueue Placeholders;
+
+  while (true) {
+    Expected<BitstreamEntry> MaybeEntry = Stream.advanceSkippingSubblocks(
+        BitstreamCursor::AF_DontPopBlockAtEnd);
+    if (!MaybeEntry)
+      return MaybeEntry.takeError();
+    BitstreamEntry Entry = MaybeEntry.get();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      // Keep the abbreviations of the block around to read records later.
+      FunctionIndexCursor = Stream;
+      Stream.ReadBlockEnd(); // Pop the abbrev block context.
+      MetadataList.resize(NextMetadataNo);
+      resolveForwardRefsAndPlaceholders(Placeholders);
+      return Error::success();
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    uint64_t CurrentPos = Stream.GetCurrentBitNo();
+    Expected<unsigned> MaybeCode = Stream.skipRecord(Entry.ID);
+    if (!MaybeCode)
+      return MaybeCode.takeError();
+    switch (MaybeCode.get()) {
+    case bitc::METADATA_VALUE:
+    case bitc::METADATA_DISTINCT_NODE:
+    case bitc::METADATA_NODE:
+    case bitc::METADATA_LOCATION:
+    case bitc::METADATA_GENERIC_DEBUG:
+    case bitc::METADATA_SUBRANGE:
+    case bitc::METADATA_ENUMERATOR:
+    case bitc::METADATA_BASIC_TYPE:
+    case bitc::METADATA_DERIVED_TYPE:
+    case bitc::METADATA_COMPOSITE_TYPE:
+    case bitc::METADATA_SUBROUTINE_TYPE:
+    case bitc::METADATA_MODULE:
+    case bitc::METADATA_FILE:
+    case bitc::METADATA_SUBPROGRAM:
+    case bitc::METADATA_LEXICAL_BLOCK:
+    case bitc::METADATA_LEXICAL_BLOCK_FILE:
+    case bitc::METADATA_NAMESPACE:
+    case bitc::METADATA_COMMON_BLOCK:
+    case bitc::METADATA_MACRO:
+    case bitc::METADATA_MACRO_FILE:
+    case bitc::METADATA_TEMPLATE_TYPE:
+    case bitc::METADATA_TEMPLATE_VALUE:
+    case bitc::METADATA_GLOBAL_VAR:
+    case bitc::METADATA_LOCAL_VAR:
+    case bitc::METADATA_LABEL:
+    case bitc::METADATA_EXPRESSION:
+    case bitc::METADATA_OBJC_PROPERTY:
+    case bitc::METADATA_IMPORTED_ENTITY:
+    case bitc::METADATA_GLOBAL_VAR_EXPR:
+      // Each of these defines the next metadata ID; remember where it is.
+      FunctionMetadataBitPosIndex.emplace_back(CurrentPos, Entry.ID);
+      ++NextMetadataNo;
+      break;
+    default: {
+      // Anything else, and in particular the strings, is read right away.
+      if (Error Err = Stream.JumpToBit(CurrentPos))
+        return Err;
+      Record.clear();
+      StringRef Blob;
+      ++NumMDRecordLoaded;
+      if (Expected<unsigned> MaybeCode =
+              Stream.readRecord(Entry.ID, Record, &Blob)) {
+        if (Error Err = parseOneMetadata(Record, MaybeCode.get(), Placeholders,
+                                         Blob, NextMetadataNo))
+          return Err;
+      } else
+        return MaybeCode.takeError();
+      FunctionMetadataBitPosIndex.resize(NextMetadataNo - FunctionMetadataBase);
+      break;
+    }
+    }
+  }
+}
+
 MDString *MetadataLoader::MetadataLoaderImpl::lazyLoadOneMDString(unsigned ID) {
   ++NumMDStringLoaded;
   if (Metadata *MD = MetadataList.lookup(ID))
@@ -983,7 +1120,7 @@ MDString *MetadataLoader::MetadataLoaderImpl::lazyLoadOneMDString(unsigned ID) {
 
 void MetadataLoader::MetadataLoaderImpl::lazyLoadOneMetadata(
     unsigned ID, PlaceholderQueue &Placeholders) {
-  assert(ID < (MDStringRef.size()) + GlobalMetadataBitPosIndex.size());
+  assert(isLazyLoadable(ID) && "Unexpected lazy-loading");
   assert(ID >= MDStringRef.size() && "Unexpected lazy-loading of MDString");
   // Lookup first if the metadata hasn't already been loaded.
   if (auto *MD = MetadataList.lookup(ID)) {
@@ -993,6 +1130,24 @@ void MetadataLoader::MetadataLoaderImpl::lazyLoadOneMetadata(
   }
   SmallVector<uint64_t, 64> Record;
   StringRef Blob;
+  if (ID >= FunctionMetadataBase &&
+      ID - FunctionMetadataBase < FunctionMetadataBitPosIndex.size()) {
+    auto Pos = FunctionMetadataBitPosIndex[ID - FunctionMetadataBase];
+    if (Error Err = FunctionIndexCursor.JumpToBit(Pos.first))
+      report_fatal_error("lazyLoadOneMetadata failed jumping: " +
+                         toString(std::move(Err)));
+    ++NumMDRecordLoaded;
+    if (Expected<unsigned> MaybeCode =
+            FunctionIndexCursor.readRecord(Pos.second, Record, &Blob)) {
+      if (Error Err = parseOneMetadata(Record, MaybeCode.get(), Placeholders,
+                                       Blob, ID))
+        report_fatal_error("Can't lazyload MD, parseOneMetadata: " +
+                           toString(std::move(Err)));
+    } else
+      report_fatal_error("Can't lazyload MD: " +
+                         toString(MaybeCode.takeError()));
+    return;
+  }
   if (Error Err = IndexCursor.JumpToBit(
           GlobalMetadataBitPosIndex[ID - MDStringRef.size()]))
     report_fatal_error("lazyLoadOneMetadata failed jumping: " +
@@ -1061,7 +1216,7 @@ Error MetadataLoader::MetadataLoaderImpl::parseOneMetadata(
         return MD;
       // If lazy-loading is enabled, we try recursively to load the operand
       // instead of creating a temporary.
-      if (ID < (MDStringRef.size() + GlobalMetadataBitPosIndex.size())) {
+      if (isLazyLoadable(ID)) {
         // Create a temporary for the node that is referencing the operand we
         // will lazy-load. It is needed before recursing in case there are
         // uniquing cycles.
@@ -1120,6 +1275,9 @@ Error MetadataLoader::MetadataLoaderImpl::parseOneMetadata(
     } else
       return MaybeNextBitCode.takeError();
 
+    if (isStrippedNamedMetadata(Name))
+      break;
+
     // Read named metadata elements.
     unsigned Size = Record.size();
     NamedMDNode *NMD = TheModule.getOrInsertNamedMetadata(Name);
@@ -1965,6 +2123,8 @@ Error MetadataLoader::MetadataLoaderImpl::parseGlobalObjectAttachment(
     auto K = MDKindMap.find(Record[I]);
     if (K == MDKindMap.end())
       return error("Invalid ID");
+    if (K->second == LLVMContext::MD_dbg && StripDebugInfo)
+      continue;
     MDNode *MD = MetadataList.getMDNodeFwdRefOrNull(Record[I + 1]);
     if (!MD)
       return error("Invalid metadata attachment: expect fwd ref to MDNode");
@@ -2031,8 +2191,7 @@ Error MetadataLoader::MetadataLoaderImpl::parseMetadataAttachment(
           continue;
 
         auto Idx = Record[i + 1];
-        if (Idx < (MDStringRef.size() + GlobalMetadataBitPosIndex.size()) &&
-            !MetadataList.lookup(Idx)) {
+        if (isLazyLoadable(Idx) && !MetadataList.lookup(Idx)) {
           // Load the attachment if it is in the lazy-loadable range and hasn't
           // been loaded yet.
           lazyLoadOneMetadata(Idx, Placeholders);
@@ -2131,10 +2290,11 @@ MetadataLoader::MetadataLoader(MetadataLoader &&RHS)
 MetadataLoader::~MetadataLoader() = default;
 MetadataLoader::MetadataLoader(BitstreamCursor &Stream, Module &TheModule,
                                BitcodeReaderValueList &ValueList,
-                               bool IsImporting,
+                               bool IsImporting, bool LoadOnDemand,
                                std::function<Type *(unsigned)> getTypeByID)
     : Pimpl(std::make_unique<MetadataLoaderImpl>(
-          Stream, TheModule, ValueList, std::move(getTypeByID), IsImporting)) {}
+          Stream, TheModule, ValueList, std::move(getTypeByID), IsImporting,
+          LoadOnDemand)) {}
 
 Error MetadataLoader::parseMetadata(bool ModuleLevel) {
   return Pimpl->parseMetadata(ModuleLevel);
@@ -2167,6 +2327,10 @@ void MetadataLoader::setStripTBAA(bool StripTBAA) {
 
 bool MetadataLoader::isStrippingTBAA() { return Pimpl->isStrippingTBAA(); }
 
+void MetadataLoader::setStripDebugInfo(bool StripDebugInfo) {
+  return Pimpl->setStripDebugInfo(StripDebugInfo);
+}
+
 unsigned MetadataLoader::size() const { return Pimpl->size(); }
 void MetadataLoader::shrinkTo(unsigned N) { return Pimpl->shrinkTo(N); }
 
@@ -41,6 +41,7 @@ public:
   ~MetadataLoader();
   MetadataLoader(BitstreamCursor &Stream, Module &TheModule,
                  BitcodeReaderValueList &ValueList, bool IsImporting,
+                 bool LoadOnDemand,
                  std::function<Type *(unsigned)> getTypeByID);
   MetadataLoader &operator=(MetadataLoader &&);
   MetadataLoader(MetadataLoader &&);
@@ -57,6 +58,11 @@ public:
   /// Return true if the Loader is stripping TBAA metadata.
   bool isStrippingTBAA();
 
+  /// Set the mode to drop debug info metadata on load: llvm.dbg.* named
+  /// metadata and !dbg attachments of globals and functions are skipped, so
+  /// that the debug info records they reference are never loaded.
+  void setStripDebugInfo(bool StripDebugInfo = true);
+
   // Return true there are remaining unresolved forward references.
   bool hasFwdRefs() const;
 
@@ -67,8 +67,10 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/raw_mmap_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -86,6 +88,11 @@ static cl::opt<unsigned>
                    cl::desc("Number of metadatas above which we emit an index "
                             "to enable lazy-loading"));
 
+static cl::opt<unsigned>
+    FlushThreshold("bitcode-flush-threshold", cl::Hidden, cl::init(16),
+                   cl::desc("The size (in MiB) of buffered bitcode above "
+                            "which it is moved to a mapped output file"));
+
 cl::opt<bool> WriteRelBFToSummary(
     "write-relbf-to-summary", cl::Hidden, cl::init(false),
     cl::desc("Write relative block frequency to function summary "));
@@ -3879,7 +3886,10 @@ void ModuleBitcodeWriterBase::writePerModuleGlobalValueSummary() {
 
 /// Emit the combined summary section into the combined index file.
 void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
-  Stream.EnterSubblock(bitc::GLOBALVAL_SUMMARY_BLOCK_ID, 3);
+  Stream.EnterSubblock(bitc::GLOBALVAL_SUMMARY_BLOCK_ID, 4);
+  // The offsets recorded in the block are relative to this position, which is
+  // where a reader is after entering the block.
+  uint64_t BlockStartBitPos = Stream.GetCurrentBitNo();
   Stream.EmitRecord(bitc::FS_VERSION, ArrayRef<uint64_t>{INDEX_VERSION});
 
   // Write the index flags.
@@ -3896,13 +3906,21 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
     Flags |= 0x10;
   Stream.EmitRecord(bitc::FS_FLAGS, ArrayRef<uint64_t>{Flags});
 
-  for (const auto &GVI : valueIds()) {
-    Stream.EmitRecord(bitc::FS_VALUE_GUID,
-                      ArrayRef<uint64_t>{GVI.second, GVI.first});
-  }
+  // Write a placeholder for the offsets of the GUID table, which is written
+  // after the summaries so that it can include the offset of each of them,
+  // and of the summaries. The placeholder is updated after all records are
+  // emitted.
+  auto Abbv = std::make_shared<BitCodeAbbrev>();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FS_GUID_TABLE_OFFSET));
+  for (unsigned I = 0; I != 6; ++I)
+    Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  unsigned OffsetAbbrev = Stream.EmitAbbrev(std::move(Abbv));
+  uint64_t OffsetVals[6] = {0, 0, 0, 0, 0, 0};
+  Stream.EmitRecord(bitc::FS_GUID_TABLE_OFFSET, OffsetVals, OffsetAbbrev);
+  uint64_t OffsetRecordBitPos = Stream.GetCurrentBitNo();
 
   // Abbrev for FS_COMBINED.
-  auto Abbv = std::make_shared<BitCodeAbbrev>();
+  Abbv = std::make_shared<BitCodeAbbrev>();
   Abbv->Add(BitCodeAbbrevOp(bitc::FS_COMBINED));
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // valueid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // modid
@@ -3954,9 +3972,26 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // valueid
   unsigned FSAliasAbbrev = Stream.EmitAbbrev(std::move(Abbv));
 
+  Abbv = std::make_shared<BitCodeAbbrev>();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FS_GUID_TABLE));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned GUIDTableAbbrev = Stream.EmitAbbrev(std::move(Abbv));
+
+  // The value GUIDs follow the abbrevs, so that the summaries start right
+  // after the last of them.
+  for (const auto &GVI : valueIds()) {
+    Stream.EmitRecord(bitc::FS_VALUE_GUID,
+                      ArrayRef<uint64_t>{GVI.second, GVI.first});
+  }
+
+  // The GUID table entries: GUID, offset of the summary and aliasee GUID.
+  std::vector<std::array<uint64_t, 3>> GUIDTable;
+  uint64_t SummariesBitPos = Stream.GetCurrentBitNo() - BlockStartBitPos;
+
   // The aliases are emitted as a post-pass, and will point to the value
   // id of the aliasee. Save them in a vector for post-processing.
   SmallVector<AliasSummary *, 64> Aliases;
+  SmallVector<GlobalValue::GUID, 64> AliasGUIDs;
 
   // Save the value id for each summary for alias emission.
   DenseMap<const GlobalValueSummary *, unsigned> SummaryToValueIdMap;
@@ -3999,9 +4034,13 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
       // Will process aliases as a post-pass because the reader wants all
       // global to be loaded first.
       Aliases.push_back(AS);
+      AliasGUIDs.push_back(I.first);
       return;
     }
 
+    GUIDTable.push_back(
+        {I.first, Stream.GetCurrentBitNo() - BlockStartBitPos, 0});
+
     if (auto *VS = dyn_cast<GlobalVarSummary>(S)) {
       NameVals.push_back(*ValueId);
       NameVals.push_back(Index.getModuleId(VS->modulePath()));
@@ -4107,9 +4146,13 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
     MaybeEmitOriginalName(*S);
   });
 
-  for (auto *AS : Aliases) {
+  for (size_t I = 0, E = Aliases.size(); I != E; ++I) {
+    AliasSummary *AS = Aliases[I];
     auto AliasValueId = SummaryToValueIdMap[AS];
     assert(AliasValueId);
+    GUIDTable.push_back({AliasGUIDs[I],
+                         Stream.GetCurrentBitNo() - BlockStartBitPos,
+                         AS->getAliaseeGUID()});
     NameVals.push_back(AliasValueId);
     NameVals.push_back(Index.getModuleId(AS->modulePath()));
     NameVals.push_back(getEncodedGVSummaryFlags(AS->flags()));
@@ -4125,6 +4168,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
     if (auto *FS = dyn_cast<FunctionSummary>(&AS->getAliasee()))
       getReferencedTypeIds(FS, ReferencedTypeIds);
   }
+  uint64_t TailBitPos = Stream.GetCurrentBitNo() - BlockStartBitPos;
 
   if (!Index.cfiFunctionDefs().empty()) {
     for (auto &S : Index.cfiFunctionDefs()) {
@@ -4166,6 +4210,22 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
     }
   }
 
+  // Write the GUID table, then patch its offset and the offsets of the
+  // summaries into the placeholder.
+  llvm::sort(GUIDTable);
+  uint64_t TableBitPos = Stream.GetCurrentBitNo() - BlockStartBitPos;
+  Stream.EmitCode(GUIDTableAbbrev);
+  Stream.emitBlob(GUIDTable.size() * 3 * sizeof(uint64_t), [&](char *Buf) {
+    for (const auto &Entry : GUIDTable)
+      for (uint64_t V : Entry) {
+        support::endian::write64le(Buf, V);
+        Buf += sizeof(uint64_t);
+      }
+  });
+  uint64_t Offsets[] = {TableBitPos, SummariesBitPos, TailBitPos};
+  for (unsigned I = 0; I != 3; ++I)
+    Stream.BackpatchWord64(OffsetRecordBitPos - (3 - I) * 64, Offsets[I]);
+
   Stream.ExitBlock();
 }
 
@@ -4259,8 +4319,14 @@ void ModuleBitcodeWriter::write() {
   // Emit function bodies.
   DenseMap<const Function *, uint64_t> FunctionToBitcodeIndex;
   for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F)
-    if (!F->isDeclaration())
+    if (!F->isDeclaration()) {
       writeFunction(*F, FunctionToBitcodeIndex);
+      // Hand completed function blocks to the output file, if any, so that
+      // the buffer does not have to hold the whole module. The hash is
+      // computed over the buffer, so keep everything in it in that case.
+      if (!GenerateHash)
+        Stream.FlushToFile();
+    }
 
   // Need to write after the above call to WriteFunction which populates
   // the summary information in the index.
@@ -4350,8 +4416,10 @@ static void writeBitcodeHeader(BitstreamWriter &Stream) {
   Stream.Emit(0xD, 4);
 }
 
-BitcodeWriter::BitcodeWriter(SmallVectorImpl<char> &Buffer)
-    : Buffer(Buffer), Stream(new BitstreamWriter(Buffer)) {
+BitcodeWriter::BitcodeWriter(SmallVectorImpl<char> &Buffer,
+                             raw_mmap_ostream *FS)
+    : Buffer(Buffer),
+      Stream(new BitstreamWriter(Buffer, FS, uint64_t(FlushThreshold) << 20)) {
   writeBitcodeHeader(*Stream);
 }
 
@@ -4370,6 +4438,23 @@ void BitcodeWriter::writeBlob(unsigned Block, unsigned Record, StringRef Blob) {
   Stream->ExitBlock();
 }
 
+void BitcodeWriter::writeBlob(unsigned Block, unsigned Record, size_t Size,
+                              function_ref<void(char *)> Fill) {
+  Stream->EnterSubblock(Block, 3);
+
+  auto Abbv = std::make_shared<BitCodeAbbrev>();
+  Abbv->Add(BitCodeAbbrevOp(Record));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  auto AbbrevNo = Stream->EmitAbbrev(std::move(Abbv));
+
+  // The record code is a literal in the abbreviation, so the record consists
+  // of the abbreviation ID and the blob alone.
+  Stream->EmitCode(AbbrevNo);
+  Stream->emitBlob(Size, Fill);
+
+  Stream->ExitBlock();
+}
+
 void BitcodeWriter::writeSymtab() {
   assert(!WroteStrtab && !WroteSymtab);
 
@@ -4405,13 +4490,11 @@ void BitcodeWriter::writeSymtab() {
 void BitcodeWriter::writeStrtab() {
   assert(!WroteStrtab);
 
-  std::vector<char> Strtab;
+  // Write the string table straight into the stream buffer rather than
+  // building it in a temporary first.
   StrtabBuilder.finalizeInOrder();
-  Strtab.resize(StrtabBuilder.getSize());
-  StrtabBuilder.write((uint8_t *)Strtab.data());
-
-  writeBlob(bitc::STRTAB_BLOCK_ID, bitc::STRTAB_BLOB,
-            {Strtab.data(), Strtab.size()});
+  writeBlob(bitc::STRTAB_BLOCK_ID, bitc::STRTAB_BLOB, StrtabBuilder.getSize(),
+            [&](char *Buf) { StrtabBuilder.write((uint8_t *)Buf); });
 
   WroteStrtab = true;
 }
@@ -4448,21 +4531,24 @@ void BitcodeWriter::writeIndex(
   IndexWriter.write();
 }
 
-/// Write the specified module to the specified output stream.
-void llvm::WriteBitcodeToFile(const Module &M, raw_ostream &Out,
-                              bool ShouldPreserveUseListOrder,
-                              const ModuleSummaryIndex *Index,
-                              bool GenerateHash, ModuleHash *ModHash) {
+static void writeBitcodeToStream(const Module &M, raw_ostream &Out,
+                                 raw_mmap_ostream *FS,
+                                 bool ShouldPreserveUseListOrder,
+                                 const ModuleSummaryIndex *Index,
+                                 bool GenerateHash, ModuleHash *ModHash) {
   SmallVector<char, 0> Buffer;
   Buffer.reserve(256*1024);
 
   // If this is darwin or another generic macho target, reserve space for the
-  // header.
+  // header. The header describes the whole bitstream, so it must be kept in
+  // the buffer.
   Triple TT(M.getTargetTriple());
-  if (TT.isOSDarwin() || TT.isOSBinFormatMachO())
+  if (TT.isOSDarwin() || TT.isOSBinFormatMachO()) {
     Buffer.insert(Buffer.begin(), BWH_HeaderSize, 0);
+    FS = nullptr;
+  }
 
-  BitcodeWriter Writer(Buffer);
+  BitcodeWriter Writer(Buffer, FS);
   Writer.writeModule(M, ShouldPreserveUseListOrder, Index, GenerateHash,
                      ModHash);
   Writer.writeSymtab();
@@ -4471,8 +4557,25 @@ void llvm::WriteBitcodeToFile(const Module &M, raw_ostream &Out,
   if (TT.isOSDarwin() || TT.isOSBinFormatMachO())
     emitDarwinBCHeaderAndTrailer(Buffer, TT);
 
-  // Write the generated bitstream to "Out".
-  Out.write((char*)&Buffer.front(), Buffer.size());
+  // Write the rest of the generated bitstream to "Out".
+  Out.write(Buffer.data(), Buffer.size());
+}
+
+/// Write the specified module to the specified output stream.
+void llvm::WriteBitcodeToFile(const Module &M, raw_ostream &Out,
+                              bool ShouldPreserveUseListOrder,
+                              const ModuleSummaryIndex *Index,
+                              bool GenerateHash, ModuleHash *ModHash) {
+  writeBitcodeToStream(M, Out, /*FS=*/nullptr, ShouldPreserveUseListOrder,
+                       Index, GenerateHash, ModHash);
+}
+
+void llvm::WriteBitcodeToFile(const Module &M, raw_mmap_ostream &Out,
+                              bool ShouldPreserveUseListOrder,
+                              const ModuleSummaryIndex *Index,
+                              bool GenerateHash, ModuleHash *ModHash) {
+  writeBitcodeToStream(M, Out, &Out, ShouldPreserveUseListOrder, Index,
+                       GenerateHash, ModHash);
 }
 
 void IndexBitcodeWriter::write() {
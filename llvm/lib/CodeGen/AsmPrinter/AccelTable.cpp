@@ -214,8 +214,10 @@ class Dwarf5AccelTableWriter : public AccelTableWriter {
   };
 
   Header Header;
-  DenseMap<uint32_t, SmallVector<AttributeEncoding, 2>> Abbreviations;
+  DenseMap<uint32_t, SmallVector<AttributeEncoding, 3>> Abbreviations;
   ArrayRef<MCSymbol *> CompUnits;
+  ArrayRef<MCSymbol *> LocalTypeUnits;
+  ArrayRef<uint64_t> ForeignTypeUnits;
   llvm::function_ref<unsigned(const DataT &)> getCUIndexForEntry;
   MCSymbol *ContributionStart = Asm->createTempSymbol("names_start");
   MCSymbol *ContributionEnd = Asm->createTempSymbol("names_end");
@@ -223,12 +225,25 @@ class Dwarf5AccelTableWriter : public AccelTableWriter {
   MCSymbol *AbbrevEnd = Asm->createTempSymbol("names_abbrev_end");
   MCSymbol *EntryPool = Asm->createTempSymbol("names_entries");
 
-  DenseSet<uint32_t> getUniqueTags() const;
+  // Entries of DIEs in type units use a different abbreviation than entries
+  // with the same tag in compile units. Tags fit in 16 bits, so the
+  // abbreviation code is the tag with an extra bit for entries in type units.
+  static uint32_t getAbbrevCode(const DataT &Entry) {
+    return Entry.getDieTag() | (Entry.getTypeUnitIndex() ? 1u << 16 : 0);
+  }
+  static dwarf::Tag getAbbrevTag(uint32_t Code) {
+    return static_cast<dwarf::Tag>(Code & 0xffff);
+  }
+  static bool isTypeUnitAbbrev(uint32_t Code) { return Code >> 16; }
 
-  // Right now, we emit uniform attributes for all tags.
-  SmallVector<AttributeEncoding, 2> getUniformAttributes() const;
+  DenseSet<uint32_t> getUniqueAbbrevCodes() const;
+
+  // Right now, we emit uniform attributes for all tags of compile units and
+  // for all tags of type units.
+  SmallVector<AttributeEncoding, 3> getUniformAttributes(bool InTypeUnit) const;
 
   void emitCUList() const;
+  void emitTUList() const;
   void emitBuckets() const;
   void emitStringOffsets() const;
   void emitAbbrevs() const;
@@ -239,7 +254,9 @@ public:
   Dwarf5AccelTableWriter(
       AsmPrinter *Asm, const AccelTableBase &Contents,
       ArrayRef<MCSymbol *> CompUnits,
-      llvm::function_ref<unsigned(const DataT &)> GetCUIndexForEntry);
+      llvm::function_ref<unsigned(const DataT &)> GetCUIndexForEntry,
+      ArrayRef<MCSymbol *> LocalTypeUnits = None,
+      ArrayRef<uint64_t> ForeignTypeUnits = None);
 
   void emit() const;
 };
@@ -395,28 +412,36 @@ void Dwarf5AccelTableWriter<DataT>::Header::emit(
 }
 
 template <typename DataT>
-DenseSet<uint32_t> Dwarf5AccelTableWriter<DataT>::getUniqueTags() const {
-  DenseSet<uint32_t> UniqueTags;
+DenseSet<uint32_t> Dwarf5AccelTableWriter<DataT>::getUniqueAbbrevCodes() const {
+  DenseSet<uint32_t> UniqueCodes;
   for (auto &Bucket : Contents.getBuckets()) {
     for (auto *Hash : Bucket) {
       for (auto *Value : Hash->Values) {
-        unsigned Tag = static_cast<const DataT *>(Value)->getDieTag();
-        UniqueTags.insert(Tag);
+        const auto &Entry = *static_cast<const DataT *>(Value);
+        if (!Entry.isDiscarded())
+          UniqueCodes.insert(getAbbrevCode(Entry));
       }
     }
   }
-  return UniqueTags;
+  return UniqueCodes;
 }
 
 template <typename DataT>
-SmallVector<typename Dwarf5AccelTableWriter<DataT>::AttributeEncoding, 2>
-Dwarf5AccelTableWriter<DataT>::getUniformAttributes() const {
-  SmallVector<AttributeEncoding, 2> UA;
-  if (CompUnits.size() > 1) {
+SmallVector<typename Dwarf5AccelTableWriter<DataT>::AttributeEncoding, 3>
+Dwarf5AccelTableWriter<DataT>::getUniformAttributes(bool InTypeUnit) const {
+  SmallVector<AttributeEncoding, 3> UA;
+  // Entries of local type units don't need a compile unit, entries of foreign
+  // type units name the skeleton compile unit of the split DWARF file.
+  if (CompUnits.size() > 1 && (!InTypeUnit || !ForeignTypeUnits.empty())) {
     size_t LargestCUIndex = CompUnits.size() - 1;
     dwarf::Form Form = DIEInteger::BestForm(/*IsSigned*/ false, LargestCUIndex);
     UA.push_back({dwarf::DW_IDX_compile_unit, Form});
   }
+  if (InTypeUnit) {
+    size_t LargestTUIndex = LocalTypeUnits.size() + ForeignTypeUnits.size() - 1;
+    dwarf::Form Form = DIEInteger::BestForm(/*IsSigned*/ false, LargestTUIndex);
+    UA.push_back({dwarf::DW_IDX_type_unit, Form});
+  }
   UA.push_back({dwarf::DW_IDX_die_offset, dwarf::DW_FORM_ref4});
   return UA;
 }
@@ -429,6 +454,19 @@ void Dwarf5AccelTableWriter<DataT>::emitCUList() const {
   }
 }
 
+template <typename DataT>
+void Dwarf5AccelTableWriter<DataT>::emitTUList() const {
+  for (const auto &TU : enumerate(LocalTypeUnits)) {
+    Asm->OutStreamer->AddComment("Type unit " + Twine(TU.index()));
+    Asm->emitDwarfSymbolReference(TU.value());
+  }
+  for (const auto &TU : enumerate(ForeignTypeUnits)) {
+    Asm->OutStreamer->AddComment("Type unit " +
+                                 Twine(LocalTypeUnits.size() + TU.index()));
+    Asm->OutStreamer->EmitIntValue(TU.value(), sizeof(uint64_t));
+  }
+}
+
 template <typename DataT>
 void Dwarf5AccelTableWriter<DataT>::emitBuckets() const {
   uint32_t Index = 1;
@@ -458,8 +496,9 @@ void Dwarf5AccelTableWriter<DataT>::emitAbbrevs() const {
     Asm->OutStreamer->AddComment("Abbrev code");
     assert(Abbrev.first != 0);
     Asm->EmitULEB128(Abbrev.first);
-    Asm->OutStreamer->AddComment(dwarf::TagString(Abbrev.first));
-    Asm->EmitULEB128(Abbrev.first);
+    dwarf::Tag Tag = getAbbrevTag(Abbrev.first);
+    Asm->OutStreamer->AddComment(dwarf::TagString(Tag));
+    Asm->EmitULEB128(Tag);
     for (const auto &AttrEnc : Abbrev.second) {
       Asm->EmitULEB128(AttrEnc.Index, dwarf::IndexString(AttrEnc.Index).data());
       Asm->EmitULEB128(AttrEnc.Form,
@@ -474,7 +513,7 @@ void Dwarf5AccelTableWriter<DataT>::emitAbbrevs() const {
 
 template <typename DataT>
 void Dwarf5AccelTableWriter<DataT>::emitEntry(const DataT &Entry) const {
-  auto AbbrevIt = Abbreviations.find(Entry.getDieTag());
+  auto AbbrevIt = Abbreviations.find(getAbbrevCode(Entry));
   assert(AbbrevIt != Abbreviations.end() &&
          "Why wasn't this abbrev generated?");
 
@@ -487,6 +526,11 @@ void Dwarf5AccelTableWriter<DataT>::emitEntry(const DataT &Entry) const {
       ID.EmitValue(Asm, AttrEnc.Form);
       break;
     }
+    case dwarf::DW_IDX_type_unit: {
+      DIEInteger ID(*Entry.getTypeUnitIndex());
+      ID.EmitValue(Asm, AttrEnc.Form);
+      break;
+    }
     case dwarf::DW_IDX_die_offset:
       assert(AttrEnc.Form == dwarf::DW_FORM_ref4);
       Asm->emitInt32(Entry.getDieOffset());
@@ -503,8 +547,11 @@ template <typename DataT> void Dwarf5AccelTableWriter<DataT>::emitData() const {
     for (auto *Hash : Bucket) {
       // Remember to emit the label for our offset.
       Asm->OutStreamer->EmitLabel(Hash->Sym);
-      for (const auto *Value : Hash->Values)
-        emitEntry(*static_cast<const DataT *>(Value));
+      for (const auto *Value : Hash->Values) {
+        const auto &Entry = *static_cast<const DataT *>(Value);
+        if (!Entry.isDiscarded())
+          emitEntry(Entry);
+      }
       Asm->OutStreamer->AddComment("End of list: " + Hash->Name.getString());
       Asm->emitInt32(0);
     }
@@ -515,22 +562,28 @@ template <typename DataT>
 Dwarf5AccelTableWriter<DataT>::Dwarf5AccelTableWriter(
     AsmPrinter *Asm, const AccelTableBase &Contents,
     ArrayRef<MCSymbol *> CompUnits,
-    llvm::function_ref<unsigned(const DataT &)> getCUIndexForEntry)
+    llvm::function_ref<unsigned(const DataT &)> getCUIndexForEntry,
+    ArrayRef<MCSymbol *> LocalTypeUnits, ArrayRef<uint64_t> ForeignTypeUnits)
     : AccelTableWriter(Asm, Contents, false),
       Header(CompUnits.size(), Contents.getBucketCount(),
              Contents.getUniqueNameCount()),
-      CompUnits(CompUnits), getCUIndexForEntry(std::move(getCUIndexForEntry)) {
-  DenseSet<uint32_t> UniqueTags = getUniqueTags();
-  SmallVector<AttributeEncoding, 2> UniformAttributes = getUniformAttributes();
+      CompUnits(CompUnits), LocalTypeUnits(LocalTypeUnits),
+      ForeignTypeUnits(ForeignTypeUnits),
+      getCUIndexForEntry(std::move(getCUIndexForEntry)) {
+  Header.LocalTypeUnitCount = LocalTypeUnits.size();
+  Header.ForeignTypeUnitCount = ForeignTypeUnits.size();
 
-  Abbreviations.reserve(UniqueTags.size());
-  for (uint32_t Tag : UniqueTags)
-    Abbreviations.try_emplace(Tag, UniformAttributes);
+  DenseSet<uint32_t> UniqueCodes = getUniqueAbbrevCodes();
+  Abbreviations.reserve(UniqueCodes.size());
+  for (uint32_t Code : UniqueCodes)
+    Abbreviations.try_emplace(Code,
+                              getUniformAttributes(isTypeUnitAbbrev(Code)));
 }
 
 template <typename DataT> void Dwarf5AccelTableWriter<DataT>::emit() const {
   Header.emit(*this);
   emitCUList();
+  emitTUList();
   emitBuckets();
   emitHashes();
   emitStringOffsets();
@@ -550,7 +603,8 @@ void llvm::emitAppleAccelTableImpl(AsmPrinter *Asm, AccelTableBase &Contents,
 
 void llvm::emitDWARF5AccelTable(
     AsmPrinter *Asm, AccelTable<DWARF5AccelTableData> &Contents,
-    const DwarfDebug &DD, ArrayRef<std::unique_ptr<DwarfCompileUnit>> CUs) {
+    const DwarfDebug &DD, ArrayRef<std::unique_ptr<DwarfCompileUnit>> CUs,
+    ArrayRef<MCSymbol *> LocalTUs, ArrayRef<uint64_t> ForeignTUs) {
   std::vector<MCSymbol *> CompUnits;
   SmallVector<unsigned, 1> CUIndex(CUs.size());
   int Count = 0;
@@ -575,9 +629,12 @@ void llvm::emitDWARF5AccelTable(
   Dwarf5AccelTableWriter<DWARF5AccelTableData>(
       Asm, Contents, CompUnits,
       [&](const DWARF5AccelTableData &Entry) {
+        if (Entry.getTypeUnitIndex())
+          return CUIndex[Entry.getTypeUnitCUID()];
         const DIE *CUDie = Entry.getDie().getUnitDie();
         return CUIndex[DD.lookupCU(CUDie)->getUniqueID()];
-      })
+      },
+      LocalTUs, ForeignTUs)
       .emit();
 }
 
@@ -1011,6 +1011,37 @@ static bool needFuncLabelsForEHOrDebugInfo(const MachineFunction &MF,
       classifyEHPersonality(MF.getFunction().getPersonalityFn()));
 }
 
+void AsmPrinter::EmitColdSectionStart(const MachineBasicBlock &MBB) {
+  CurrentFnHotEnd = createTempSymbol("func_hot_end");
+  OutStreamer->EmitLabel(CurrentFnHotEnd);
+
+  // The cold part is a separate fragment of the function as far as unwinding
+  // is concerned. MachineFunctionSplitter copied the prologue CFI to the
+  // start of MBB, so the new FDE describes the same frame.
+  for (const HandlerInfo &HI : Handlers) {
+    NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
+                       HI.TimerGroupDescription, TimePassesIsEnabled);
+    HI.Handler->endFragment();
+  }
+
+  const Function &F = MF->getFunction();
+  OutStreamer->SwitchSection(getObjFileLowering().getSectionForColdPart(F, TM));
+  EmitAlignment(MF->getAlignment(), &F);
+  CurrentFnColdBegin =
+      OutContext.getOrCreateSymbol(CurrentFnSym->getName() + ".cold");
+  if (MAI->hasDotTypeDotSizeDirective())
+    OutStreamer->EmitSymbolAttribute(CurrentFnColdBegin, MCSA_ELF_TypeFunction);
+  OutStreamer->EmitLabel(CurrentFnColdBegin);
+
+  for (const HandlerInfo &HI : Handlers) {
+    NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
+                       HI.TimerGroupDescription, TimePassesIsEnabled);
+    HI.Handler->beginFragment(&MBB, [](AsmPrinter *AP) {
+      return AP->getCurExceptionSym();
+    });
+  }
+}
+
 /// EmitFunctionBody - This method emits the body and trailer for a
 /// function.
 void AsmPrinter::EmitFunctionBody() {
@@ -1042,7 +1073,14 @@ void AsmPrinter::EmitFunctionBody() {
   // Print out code for the function.
   bool HasAnyRealCode = false;
   int NumInstsInFunction = 0;
+  MCSection *HotSection = OutStreamer->getCurrentSectionOnly();
   for (auto &MBB : *MF) {
+    // The cold blocks are at the end of the function, in their own section.
+    if (MBB.isColdSection() && !CurrentFnColdBegin)
+      EmitColdSectionStart(MBB);
+    assert((!CurrentFnColdBegin || MBB.isColdSection()) &&
+           "Hot block after the cold part of the function");
+
     // Print a label for the basic block.
     EmitBasicBlockStart(MBB);
     for (auto &MI : MBB) {
@@ -1180,11 +1218,18 @@ void AsmPrinter::EmitFunctionBody() {
   // it.
   if (MAI->hasDotTypeDotSizeDirective()) {
     // We can get the size as difference between the function label and the
-    // temp label.
+    // temp label. A split function gets a size for each of its parts.
+    MCSymbol *HotEnd = CurrentFnColdBegin ? CurrentFnHotEnd : CurrentFnEnd;
     const MCExpr *SizeExp = MCBinaryExpr::createSub(
-        MCSymbolRefExpr::create(CurrentFnEnd, OutContext),
+        MCSymbolRefExpr::create(HotEnd, OutContext),
         MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
     OutStreamer->emitELFSize(CurrentFnSym, SizeExp);
+    if (CurrentFnColdBegin) {
+      const MCExpr *ColdSizeExp = MCBinaryExpr::createSub(
+          MCSymbolRefExpr::create(CurrentFnEnd, OutContext),
+          MCSymbolRefExpr::create(CurrentFnColdBegin, OutContext), OutContext);
+      OutStreamer->emitELFSize(CurrentFnColdBegin, ColdSizeExp);
+    }
   }
 
   for (const HandlerInfo &HI : Handlers) {
@@ -1193,6 +1238,10 @@ void AsmPrinter::EmitFunctionBody() {
     HI.Handler->markFunctionEnd();
   }
 
+  // Whatever follows the body belongs with its hot part.
+  if (CurrentFnColdBegin)
+    OutStreamer->SwitchSection(HotSection);
+
   // Print out jump tables referenced by the function.
   EmitJumpTableInfo();
 
@@ -1649,6 +1698,8 @@ void AsmPrinter::SetupMachineFunction(MachineFunction &MF) {
   CurrentFnSymForSize = CurrentFnSym;
   CurrentFnBegin = nullptr;
   CurExceptionSym = nullptr;
+  CurrentFnColdBegin = nullptr;
+  CurrentFnHotEnd = nullptr;
   bool NeedsLocalForSize = MAI->needsLocalForSize();
   if (needFuncLabelsForEHOrDebugInfo(MF, MMI) || NeedsLocalForSize ||
       MF.getTarget().Options.EmitStackSizeSection) {
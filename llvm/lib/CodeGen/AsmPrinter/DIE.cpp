@@ -144,23 +144,34 @@ DIEAbbrevSet::~DIEAbbrevSet() {
 }
 
 DIEAbbrev &DIEAbbrevSet::uniqueAbbreviation(DIE &Die) {
+  DIEAbbrev &Abbrev = uniqueAbbreviation(Die.generateAbbrev());
+  Die.setAbbrevNumber(Abbrev.getNumber());
+  return Abbrev;
+}
+
+DIEAbbrev &DIEAbbrevSet::uniqueAbbreviation(const DIEAbbrev &Abbrev) {
 
   FoldingSetNodeID ID;
-  DIEAbbrev Abbrev = Die.generateAbbrev();
   Abbrev.Profile(ID);
 
   void *InsertPos;
   if (DIEAbbrev *Existing =
-          AbbreviationsSet.FindNodeOrInsertPos(ID, InsertPos)) {
-    Die.setAbbrevNumber(Existing->getNumber());
+          AbbreviationsSet.FindNodeOrInsertPos(ID, InsertPos))
     return *Existing;
-  }
 
-  // Move the abbreviation to the heap and assign a number.
-  DIEAbbrev *New = new (Alloc) DIEAbbrev(std::move(Abbrev));
+  // Copy the abbreviation to the heap and assign a number. The copy is built
+  // from scratch so it doesn't inherit the folding set link of an abbreviation
+  // owned by another set.
+  DIEAbbrev *New = new (Alloc) DIEAbbrev(Abbrev.getTag(), Abbrev.hasChildren());
+  for (const DIEAbbrevData &AttrData : Abbrev.getData()) {
+    if (AttrData.getForm() == dwarf::DW_FORM_implicit_const)
+      New->AddImplicitConstAttribute(AttrData.getAttribute(),
+                                     AttrData.getValue());
+    else
+      New->AddAttribute(AttrData.getAttribute(), AttrData.getForm());
+  }
   Abbreviations.push_back(New);
   New->setNumber(Abbreviations.size());
-  Die.setAbbrevNumber(Abbreviations.size());
 
   // Store it for lookup.
   AbbreviationsSet.InsertNode(New, InsertPos);
@@ -384,7 +384,12 @@ void DwarfCompileUnit::attachLowHighPC(DIE &D, const MCSymbol *Begin,
 DIE &DwarfCompileUnit::updateSubprogramScopeDIE(const DISubprogram *SP) {
   DIE *SPDie = getOrCreateSubprogramDIE(SP, includeMinimalInlineScopes());
 
-  attachLowHighPC(*SPDie, Asm->getFunctionBegin(), Asm->getFunctionEnd());
+  if (MCSymbol *ColdBegin = Asm->getFunctionColdBegin())
+    attachRangesOrLowHighPC(
+        *SPDie, {RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionHotEnd()),
+                 RangeSpan(ColdBegin, Asm->getFunctionEnd())});
+  else
+    attachLowHighPC(*SPDie, Asm->getFunctionBegin(), Asm->getFunctionEnd());
   if (DD->useAppleExtensionAttributes() &&
       !DD->getCurrentFunction()->getTarget().Options.DisableFramePointerElim(
           *DD->getCurrentFunction()))
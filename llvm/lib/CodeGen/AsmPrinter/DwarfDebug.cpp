@@ -345,8 +345,8 @@ static AccelTableKind computeAccelTableKind(unsigned DwarfVersion,
   if (AccelTables != AccelTableKind::Default)
     return AccelTables;
 
-  // Accelerator tables with type units are currently not supported.
-  if (GenerateTypeUnits)
+  // Only DWARF v5 name indexes can refer to type units.
+  if (GenerateTypeUnits && DwarfVersion < 5)
     return AccelTableKind::None;
 
   // Accelerator tables get emitted if targetting DWARF v5 or LLDB.  DWARF v5
@@ -1488,6 +1488,21 @@ bool DwarfDebug::buildLocationList(SmallVectorImpl<DebugLocEntry> &DebugLoc,
       DebugLoc.pop_back();
   }
 
+  // An entry can't span the hot and the cold part of a split function, the
+  // distance between them isn't known. Split those at the section boundary.
+  if (MCSymbol *ColdBegin = Asm->getFunctionColdBegin()) {
+    for (unsigned I = 0; I != DebugLoc.size(); ++I) {
+      DebugLocEntry &Entry = DebugLoc[I];
+      if (&Entry.getBeginSym()->getSection() ==
+          &Entry.getEndSym()->getSection())
+        continue;
+      DebugLocEntry ColdPart(ColdBegin, Entry.getEndSym(), Entry.getValues());
+      DebugLoc[I] = DebugLocEntry(Entry.getBeginSym(),
+                                  Asm->getFunctionHotEnd(), Entry.getValues());
+      DebugLoc.insert(DebugLoc.begin() + ++I, ColdPart);
+    }
+  }
+
   return DebugLoc.size() == 1 && isSafeForSingleLocation &&
          validThroughout(LScopes, StartDebugMI, EndMI);
 }
@@ -1840,8 +1855,17 @@ void DwarfDebug::endFunctionImpl(const MachineFunction *MF) {
   DenseSet<InlinedEntity> Processed;
   collectEntityInfo(TheCU, SP, Processed);
 
-  // Add the range of this function to the list of ranges for the CU.
-  TheCU.addRange(RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionEnd()));
+  // Add the range of this function to the list of ranges for the CU. A split
+  // function has one range per part, in different sections.
+  if (MCSymbol *ColdBegin = Asm->getFunctionColdBegin()) {
+    TheCU.addRange(
+        RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionHotEnd()));
+    TheCU.addRange(RangeSpan(ColdBegin, Asm->getFunctionEnd()));
+    addArangeLabel(SymbolCU(&TheCU, Asm->getFunctionBegin()));
+    addArangeLabel(SymbolCU(&TheCU, ColdBegin));
+  } else {
+    TheCU.addRange(RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionEnd()));
+  }
 
   // Under -gmlt, skip building the subprogram if there are no inlined
   // subroutines inside it. But with -fdebug-info-for-profiling, the subprogram
@@ -1948,7 +1972,8 @@ void DwarfDebug::emitAccelDebugNames() {
   if (getUnits().empty())
     return;
 
-  emitDWARF5AccelTable(Asm, AccelDebugNames, *this, getUnits());
+  emitDWARF5AccelTable(Asm, AccelDebugNames, *this, getUnits(),
+                       NameIndexLocalTypeUnits, NameIndexForeignTypeUnits);
 }
 
 // Emit visible names into a hashed accelerator table section.
@@ -2973,6 +2998,9 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
       // the type that used an address.
       for (const auto &TU : TypeUnitsToAdd)
         TypeSignatures.erase(TU.second);
+      for (DWARF5AccelTableData *Entry : TypeUnitNameEntries)
+        Entry->discard();
+      TypeUnitNameEntries.clear();
 
       // Construct this type in the CU directly.
       // This is inefficient because all the dependent types will be rebuilt
@@ -2984,23 +3012,59 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
 
     // If the type wasn't dependent on fission addresses, finish adding the type
     // and all its dependent types.
+    DenseMap<const DIE *, unsigned> NameIndexTypeUnits;
     for (auto &TU : TypeUnitsToAdd) {
       InfoHolder.computeSizeAndOffsetsForUnit(TU.first.get());
       InfoHolder.emitUnit(TU.first.get(), useSplitDwarf());
+      if (indexesTypeUnits(CU))
+        NameIndexTypeUnits[&TU.first->getUnitDie()] =
+            addTypeUnitToNameIndex(*TU.first);
+    }
+
+    // The type units are destroyed once they go out of scope, so their name
+    // index entries can't refer to their DIEs anymore.
+    for (DWARF5AccelTableData *Entry : TypeUnitNameEntries) {
+      auto I = NameIndexTypeUnits.find(Entry->getDie().getUnitDie());
+      if (I != NameIndexTypeUnits.end())
+        Entry->convertToTypeUnitEntry(I->second, CU.getUniqueID());
     }
+    TypeUnitNameEntries.clear();
   }
   CU.addDIETypeSignature(RefDie, Signature);
 }
 
+bool DwarfDebug::indexesTypeUnits(const DwarfCompileUnit &CU) const {
+  return getAccelTableKind() == AccelTableKind::Dwarf &&
+         getDwarfVersion() >= 5 &&
+         CU.getCUNode()->getNameTableKind() ==
+             DICompileUnit::DebugNameTableKind::Default;
+}
+
+unsigned DwarfDebug::addTypeUnitToNameIndex(DwarfTypeUnit &TU) {
+  // A module either has type units in split DWARF files or in this object
+  // file, so the index is also valid for the local type units followed by the
+  // foreign ones.
+  unsigned Index =
+      NameIndexLocalTypeUnits.size() + NameIndexForeignTypeUnits.size();
+  if (useSplitDwarf())
+    NameIndexForeignTypeUnits.push_back(TU.getTypeSignature());
+  else
+    NameIndexLocalTypeUnits.push_back(TU.getSection()->getBeginSymbol());
+  return Index;
+}
+
 DwarfDebug::NonTypeUnitContext::NonTypeUnitContext(DwarfDebug *DD)
     : DD(DD),
-      TypeUnitsUnderConstruction(std::move(DD->TypeUnitsUnderConstruction)) {
+      TypeUnitsUnderConstruction(std::move(DD->TypeUnitsUnderConstruction)),
+      TypeUnitNameEntries(std::move(DD->TypeUnitNameEntries)) {
   DD->TypeUnitsUnderConstruction.clear();
+  DD->TypeUnitNameEntries.clear();
   assert(TypeUnitsUnderConstruction.empty() || !DD->AddrPool.hasBeenUsed());
 }
 
 DwarfDebug::NonTypeUnitContext::~NonTypeUnitContext() {
   DD->TypeUnitsUnderConstruction = std::move(TypeUnitsUnderConstruction);
+  DD->TypeUnitNameEntries = std::move(TypeUnitNameEntries);
   DD->AddrPool.resetUsedFlag();
 }
 
@@ -3030,9 +3094,18 @@ void DwarfDebug::addAccelNameImpl(const DICompileUnit &CU,
   case AccelTableKind::Apple:
     AppleAccel.addName(Ref, Die);
     break;
-  case AccelTableKind::Dwarf:
-    AccelDebugNames.addName(Ref, Die);
+  case AccelTableKind::Dwarf: {
+    if (TypeUnitsUnderConstruction.empty()) {
+      AccelDebugNames.addName(Ref, Die);
+      break;
+    }
+    // Entries of DIEs in type units become dangling after the type units are
+    // emitted; remember them so they can be converted. Lower DWARF versions
+    // have no way to name type units.
+    if (getDwarfVersion() >= 5)
+      TypeUnitNameEntries.push_back(&AccelDebugNames.addName(Ref, Die));
     break;
+  }
   case AccelTableKind::Default:
     llvm_unreachable("Default should have already been resolved.");
   case AccelTableKind::None:
@@ -345,6 +345,16 @@ class DwarfDebug : public DebugHandlerBase {
       std::pair<std::unique_ptr<DwarfTypeUnit>, const DICompositeType *>, 1>
       TypeUnitsUnderConstruction;
 
+  /// Name index entries for DIEs of the type units under construction. They
+  /// are made independent of the DIEs once the type units are emitted, or
+  /// discarded with the type units.
+  SmallVector<DWARF5AccelTableData *, 8> TypeUnitNameEntries;
+
+  /// The type units the name index refers to: labels of type units in this
+  /// object file and signatures of type units in split DWARF files.
+  SmallVector<MCSymbol *, 8> NameIndexLocalTypeUnits;
+  SmallVector<uint64_t, 8> NameIndexForeignTypeUnits;
+
   /// Whether to use the GNU TLS opcode (instead of the standard opcode).
   bool UseGNUTLSOpcode;
 
@@ -621,10 +631,18 @@ public:
   void addDwarfTypeUnitType(DwarfCompileUnit &CU, StringRef Identifier,
                             DIE &Die, const DICompositeType *CTy);
 
+  /// Whether the name index lists type units built for \p CU.
+  bool indexesTypeUnits(const DwarfCompileUnit &CU) const;
+
+  /// Add a type unit that was emitted to the name index. Returns the index of
+  /// the type unit in the name index.
+  unsigned addTypeUnitToNameIndex(DwarfTypeUnit &TU);
+
   friend class NonTypeUnitContext;
   class NonTypeUnitContext {
     DwarfDebug *DD;
     decltype(DwarfDebug::TypeUnitsUnderConstruction) TypeUnitsUnderConstruction;
+    decltype(DwarfDebug::TypeUnitNameEntries) TypeUnitNameEntries;
     friend class DwarfDebug;
     NonTypeUnitContext(DwarfDebug *DD);
   public:
@@ -15,11 +15,19 @@
 #include "llvm/CodeGen/DIE.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <cstdint>
 
 using namespace llvm;
 
+static cl::opt<unsigned> DwarfLayoutThreads(
+    "dwarf-layout-threads", cl::Hidden, cl::init(1),
+    cl::desc("Number of threads used to compute the abbreviations and sizes "
+             "of the DIEs of different compile units (default = 1)"));
+
 DwarfFile::DwarfFile(AsmPrinter *AP, StringRef Pref, BumpPtrAllocator &DA)
     : Asm(AP), Abbrevs(AbbrevAllocator), StrPool(DA, *Asm, Pref) {}
 
@@ -61,8 +69,8 @@ void DwarfFile::computeSizeAndOffsets() {
   // Offset from the first CU in the debug info section is 0 initially.
   unsigned SecOffset = 0;
 
-  // Iterate over each compile unit and set the size and offsets for each
-  // DIE within each compile unit. All offsets are CU relative.
+  // Collect the units that are laid out, in section order.
+  SmallVector<DwarfUnit *, 8> Units;
   for (const auto &TheU : CUs) {
     if (TheU->getCUNode()->isDebugDirectivesOnly())
       continue;
@@ -70,10 +78,96 @@ void DwarfFile::computeSizeAndOffsets() {
     // Skip CUs that ended up not being needed (split CUs that were abandoned
     // because they added no information beyond the non-split CU)
     if (llvm::empty(TheU->getUnitDie().values()))
-      return;
+      break;
+
+    Units.push_back(TheU.get());
+  }
+
+  if (DwarfLayoutThreads > 1 && Units.size() > 1) {
+    computeSizeAndOffsetsInParallel(Units);
+    return;
+  }
+
+  // Iterate over each compile unit and set the size and offsets for each
+  // DIE within each compile unit. All offsets are CU relative.
+  for (DwarfUnit *TheU : Units) {
+    TheU->setDebugSectionOffset(SecOffset);
+    SecOffset += computeSizeAndOffsetsForUnit(TheU);
+  }
+}
+
+// Unique the abbreviations of a DIE tree into a unit local set, and remember
+// the size of the attribute values of each DIE in its size field. This only
+// reads state that is owned by the unit, so it can run concurrently for
+// different units.
+static void collectLocalAbbrevs(const AsmPrinter *AP, DIE &Die,
+                                DIEAbbrevSet &LocalAbbrevs) {
+  LocalAbbrevs.uniqueAbbreviation(Die);
+
+  unsigned ValuesSize = 0;
+  for (const auto &V : Die.values())
+    ValuesSize += V.SizeOf(AP);
+  Die.setSize(ValuesSize);
+
+  for (auto &Child : Die.children())
+    collectLocalAbbrevs(AP, Child, LocalAbbrevs);
+}
+
+// Replace the unit local abbreviation numbers with the numbers in the file
+// wide set and compute offsets and sizes from the values sizes collected by
+// collectLocalAbbrevs. Returns the offset after laying out the DIE.
+static unsigned assignOffsets(DIE &Die, ArrayRef<unsigned> GlobalNumbers,
+                              unsigned Offset) {
+  unsigned ValuesSize = Die.getSize();
+  Die.setAbbrevNumber(GlobalNumbers[Die.getAbbrevNumber() - 1]);
+  Die.setOffset(Offset);
+  Offset += getULEB128Size(Die.getAbbrevNumber()) + ValuesSize;
+
+  if (Die.hasChildren()) {
+    for (auto &Child : Die.children())
+      Offset = assignOffsets(Child, GlobalNumbers, Offset);
+
+    // End of children marker.
+    Offset += sizeof(int8_t);
+  }
+
+  Die.setSize(Offset - Die.getOffset());
+  return Offset;
+}
+
+void DwarfFile::computeSizeAndOffsetsInParallel(ArrayRef<DwarfUnit *> Units) {
+  // Generating the abbreviation of every DIE and summing up the sizes of its
+  // values dominates the layout of large units, and is independent between
+  // units. Do it per unit on a thread pool with unit local abbreviation sets.
+  std::vector<BumpPtrAllocator> LocalAllocs(Units.size());
+  std::vector<std::unique_ptr<DIEAbbrevSet>> LocalAbbrevs;
+  for (BumpPtrAllocator &Alloc : LocalAllocs)
+    LocalAbbrevs.push_back(std::make_unique<DIEAbbrevSet>(Alloc));
+  {
+    ThreadPool Pool(DwarfLayoutThreads);
+    for (unsigned I = 0, E = Units.size(); I != E; ++I)
+      Pool.async([this, &Units, &LocalAbbrevs, I] {
+        collectLocalAbbrevs(Asm, Units[I]->getUnitDie(), *LocalAbbrevs[I]);
+      });
+    Pool.wait();
+  }
+
+  // Merge the local sets in unit order. The abbreviations of a unit are
+  // numbered in the order of their first use in a preorder walk, the same
+  // order the serial layout uniques them in, so the resulting numbering and
+  // therefore the output doesn't depend on the number of threads.
+  unsigned SecOffset = 0;
+  SmallVector<unsigned, 64> GlobalNumbers;
+  for (unsigned I = 0, E = Units.size(); I != E; ++I) {
+    GlobalNumbers.clear();
+    for (const DIEAbbrev *Abbrev : LocalAbbrevs[I]->getAbbreviations())
+      GlobalNumbers.push_back(Abbrevs.uniqueAbbreviation(*Abbrev).getNumber());
 
+    DwarfUnit *TheU = Units[I];
     TheU->setDebugSectionOffset(SecOffset);
-    SecOffset += computeSizeAndOffsetsForUnit(TheU.get());
+    unsigned Offset = sizeof(int32_t) +      // Length of Unit Info
+                      TheU->getHeaderSize(); // Unit-specific headers
+    SecOffset += assignOffsets(TheU->getUnitDie(), GlobalNumbers, Offset);
   }
 }
 
@@ -10,6 +10,7 @@
 #define LLVM_LIB_CODEGEN_ASMPRINTER_DWARFFILE_H
 
 #include "DwarfStringPool.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -134,6 +135,10 @@ public:
   /// Compute the size and offset of all the DIEs.
   void computeSizeAndOffsets();
 
+  /// Compute the size and offset of all the DIEs in the given units, building
+  /// the abbreviations of different units concurrently.
+  void computeSizeAndOffsetsInParallel(ArrayRef<DwarfUnit *> Units);
+
   /// Compute the size and offset of all the DIEs in the given unit.
   /// \returns The size of the root DIE.
   unsigned computeSizeAndOffsetsForUnit(DwarfUnit *TheU);
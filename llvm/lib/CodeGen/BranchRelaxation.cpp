@@ -214,6 +214,7 @@ MachineBasicBlock *BranchRelaxation::createNewBlockAfter(MachineBasicBlock &BB)
   MachineBasicBlock *NewBB =
       MF->CreateMachineBasicBlock(BB.getBasicBlock());
   MF->insert(++BB.getIterator(), NewBB);
+  NewBB->setIsColdSection(BB.isColdSection());
 
   // Insert an entry into BlockInfo to align it properly with the block numbers.
   BlockInfo.insert(BlockInfo.begin() + NewBB->getNumber(), BasicBlockInfo());
@@ -232,6 +233,7 @@ MachineBasicBlock *BranchRelaxation::splitBlockBeforeInstr(MachineInstr &MI,
   MachineBasicBlock *NewBB =
       MF->CreateMachineBasicBlock(OrigBB->getBasicBlock());
   MF->insert(++OrigBB->getIterator(), NewBB);
+  NewBB->setIsColdSection(OrigBB->isColdSection());
 
   // Splice the instructions starting with MI over to NewBB.
   NewBB->splice(NewBB->end(), OrigBB, MI.getIterator(), OrigBB->end());
@@ -281,6 +283,12 @@ MachineBasicBlock *BranchRelaxation::splitBlockBeforeInstr(MachineInstr &MI,
 /// specific BB can fit in MI's displacement field.
 bool BranchRelaxation::isBlockInRange(
   const MachineInstr &MI, const MachineBasicBlock &DestBB) const {
+  // The distance to a block in the other section of the function is only
+  // known after linking. Relax conditional branches so that only unconditional
+  // ones cross sections, as the linker can extend their range with thunks.
+  if (MI.getParent()->isColdSection() != DestBB.isColdSection())
+    return MI.isUnconditionalBranch();
+
   int64_t BrOffset = getInstrOffset(MI);
   int64_t DestOffset = BlockInfo[DestBB.getNumber()].Offset;
 
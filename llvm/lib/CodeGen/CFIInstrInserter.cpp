@@ -253,6 +253,17 @@ bool CFIInstrInserter::insertCFIInstrs(MachineFunction &MF) {
 
     const MBBCFAInfo &MBBInfo = MBBVector[MBB.getNumber()];
     auto MBBI = MBBInfo.MBB->begin();
+
+    // The first block of the cold part of a split function starts a new FDE.
+    // The prologue CFI that MachineFunctionSplitter copied to its start leave
+    // the frame as the entry block does, so compare with that instead and
+    // insert the corrections after them.
+    if (MBB.isColdSection() != PrevMBBInfo->MBB->isColdSection()) {
+      PrevMBBInfo = &MBBVector[MF.front().getNumber()];
+      while (MBBI != MBB.end() && MBBI->isCFIInstruction() &&
+             MBBI->getFlag(MachineInstr::FrameSetup))
+        ++MBBI;
+    }
     DebugLoc DL = MBBInfo.MBB->findDebugLoc(MBBI);
 
     if (PrevMBBInfo->OutgoingCFAOffset != MBBInfo.IncomingCFAOffset) {
@@ -258,14 +258,20 @@ void LexicalScopes::assignInstructionRanges(
     SmallVectorImpl<InsnRange> &MIRanges,
     DenseMap<const MachineInstr *, LexicalScope *> &MI2ScopeMap) {
   LexicalScope *PrevLexicalScope = nullptr;
+  const MachineInstr *PrevRangeEnd = nullptr;
   for (const auto &R : MIRanges) {
     LexicalScope *S = MI2ScopeMap.lookup(R.first);
     assert(S && "Lost LexicalScope for a machine instruction!");
-    if (PrevLexicalScope && !PrevLexicalScope->dominates(S))
+    // No range may span the hot and the cold part of a split function.
+    if (PrevLexicalScope && R.first->getParent()->isColdSection() !=
+                                PrevRangeEnd->getParent()->isColdSection())
+      PrevLexicalScope->closeInsnRange();
+    else if (PrevLexicalScope && !PrevLexicalScope->dominates(S))
       PrevLexicalScope->closeInsnRange(S);
     S->openInsnRange(R.first);
     S->extendInsnRange(R.second);
     PrevLexicalScope = S;
+    PrevRangeEnd = R.second;
   }
 
   if (PrevLexicalScope)
@@ -113,6 +113,7 @@ struct MIToken {
     kw_liveout,
     kw_address_taken,
     kw_landing_pad,
+    kw_cold_section,
     kw_liveins,
     kw_successors,
     kw_floatpred,
@@ -633,6 +633,11 @@ void MIPrinter::print(const MachineBasicBlock &MBB) {
     OS << "align " << MBB.getAlignment();
     HasAttributes = true;
   }
+  if (MBB.isColdSection()) {
+    OS << (HasAttributes ? ", " : " (");
+    OS << "cold-section";
+    HasAttributes = true;
+  }
   if (HasAttributes)
     OS << ")";
   OS << ":\n";
@@ -325,6 +325,11 @@ void MachineBasicBlock::print(raw_ostream &OS, ModuleSlotTracker &MST,
     OS << "align " << getAlignment();
     HasAttributes = true;
   }
+  if (isColdSection()) {
+    OS << (HasAttributes ? ", " : " (");
+    OS << "cold-section";
+    HasAttributes = true;
+  }
   if (HasAttributes)
     OS << ")";
   OS << ":\n";
@@ -819,7 +824,10 @@ bool MachineBasicBlock::isSuccessor(const MachineBasicBlock *MBB) const {
 
 bool MachineBasicBlock::isLayoutSuccessor(const MachineBasicBlock *MBB) const {
   MachineFunction::const_iterator I(this);
-  return std::next(I) == MachineFunction::const_iterator(MBB);
+  // A block in the other section of the function isn't emitted after this one
+  // even if it is next in the list.
+  return std::next(I) == MachineFunction::const_iterator(MBB) &&
+         MBB->isColdSection() == isColdSection();
 }
 
 MachineBasicBlock *MachineBasicBlock::getFallThrough() {
@@ -829,6 +837,10 @@ MachineBasicBlock *MachineBasicBlock::getFallThrough() {
   if (Fallthrough == getParent()->end())
     return nullptr;
 
+  // Control can't fall through into the other section of the function.
+  if (Fallthrough->isColdSection() != isColdSection())
+    return nullptr;
+
   // If FallthroughBlock isn't a successor, no fallthrough is possible.
   if (!isSuccessor(&*Fallthrough))
     return nullptr;
@@ -0,0 +1,236 @@
+//===- MachineFunctionSplitter.cpp - Split cold blocks out of functions ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass moves the basic blocks of a function that the profile says are
+// cold to the end of the function and marks them, so that the AsmPrinter emits
+// them in a separate section (.text.split. on ELF). Unlike HotColdSplitting,
+// which extracts cold regions of the IR into functions of their own, the cold
+// blocks stay part of the function: nothing has to be passed across a call
+// and no optimization is hindered by a function boundary, but the hot text of
+// the program gets denser once the linker places the cold sections apart.
+//
+// The pass runs after MachineBlockPlacement. It keeps the order placement
+// chose within the hot and the cold part, and only fixes up the branches that
+// fell through from one part into the other.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetSubtargetInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetLoweringObjectFile.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-function-splitter"
+
+STATISTIC(NumSplitFunctions, "Number of functions split");
+STATISTIC(NumColdBlocks, "Number of blocks moved to the cold section");
+
+static cl::opt<unsigned> ColdCountThreshold(
+    "mfs-count-threshold", cl::Hidden, cl::init(1),
+    cl::desc("Blocks with a profile count below this threshold are cold"));
+
+static cl::opt<unsigned> PercentileCutoff(
+    "mfs-psi-cutoff", cl::Hidden, cl::init(0),
+    cl::desc("If non-zero, blocks whose profile count is cold at this "
+             "percentile of the profile summary, in parts per million, are "
+             "cold as well"));
+
+namespace {
+
+class MachineFunctionSplitter : public MachineFunctionPass {
+public:
+  static char ID;
+
+  MachineFunctionSplitter() : MachineFunctionPass(ID) {
+    initializeMachineFunctionSplitterPass(*PassRegistry::getPassRegistry());
+  }
+
+  StringRef getPassName() const override { return "Machine Function Splitter"; }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+private:
+  bool isColdBlock(const MachineBasicBlock &MBB);
+
+  MachineBlockFrequencyInfo *MBFI = nullptr;
+  ProfileSummaryInfo *PSI = nullptr;
+};
+
+} // end anonymous namespace
+
+char MachineFunctionSplitter::ID = 0;
+char &llvm::MachineFunctionSplitterID = MachineFunctionSplitter::ID;
+
+INITIALIZE_PASS_BEGIN(MachineFunctionSplitter, DEBUG_TYPE,
+                      "Split cold blocks out of machine functions", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(MachineFunctionSplitter, DEBUG_TYPE,
+                    "Split cold blocks out of machine functions", false, false)
+
+/// Return true if the cold part of \p MF can be emitted separately.
+static bool canSplitFunction(const MachineFunction &MF) {
+  const TargetMachine &TM = MF.getTarget();
+  if (!TM.getObjFileLowering()->getSectionForColdPart(MF.getFunction(), TM))
+    return false;
+
+  // Branches between the two parts have to reach any distance, either by
+  // themselves or through the linker's range extension thunks.
+  const Triple &TT = TM.getTargetTriple();
+  if (TT.getArch() != Triple::x86 && TT.getArch() != Triple::x86_64 &&
+      !TT.isAArch64())
+    return false;
+
+  // The cold part would need call site entries in an LSDA of its own.
+  if (MF.getFunction().hasPersonalityFn() || !MF.getLandingPads().empty())
+    return false;
+
+  // The cold part describes its frame with a copy of the prologue CFI, which
+  // is only right if the prologue is in the entry block.
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  if (MFI.getSavePoint() && MFI.getSavePoint() != &MF.front())
+    return false;
+
+  return true;
+}
+
+bool MachineFunctionSplitter::isColdBlock(const MachineBasicBlock &MBB) {
+  Optional<uint64_t> Count = MBFI->getBlockProfileCount(&MBB);
+  if (!Count)
+    return false;
+  if (PercentileCutoff > 0 &&
+      PSI->isColdCountNthPercentile(PercentileCutoff, *Count))
+    return true;
+  return *Count < ColdCountThreshold;
+}
+
+/// Copy the CFI instructions of the prologue of \p MF to the start of
+/// \p ColdEntry, the first block of the cold part. The copies are marked as
+/// frame setup, which is how CFIInstrInserter tells them apart.
+static void copyPrologueCFI(MachineFunction &MF,
+                            MachineBasicBlock &ColdEntry) {
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  MachineBasicBlock::iterator InsertPt = ColdEntry.begin();
+  for (const MachineInstr &MI : MF.front()) {
+    if (MI.isCFIInstruction()) {
+      BuildMI(ColdEntry, InsertPt, DebugLoc(),
+              TII->get(TargetOpcode::CFI_INSTRUCTION))
+          .addCFIIndex(MI.getOperand(0).getCFIIndex())
+          .setMIFlag(MachineInstr::FrameSetup);
+      continue;
+    }
+    if (!MI.getFlag(MachineInstr::FrameSetup) && !MI.isMetaInstruction())
+      break;
+  }
+}
+
+bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()) || !MF.getFunction().hasProfileData() ||
+      MF.size() < 2 || !canSplitFunction(MF))
+    return false;
+
+  MBFI = &getAnalysis<MachineBlockFrequencyInfo>();
+  PSI = &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+
+  // Blocks that are reached other than by a branch stay in the hot part.
+  SmallPtrSet<const MachineBasicBlock *, 8> Pinned;
+  if (const MachineJumpTableInfo *MJTI = MF.getJumpTableInfo())
+    for (const MachineJumpTableEntry &JTE : MJTI->getJumpTables())
+      Pinned.insert(JTE.MBBs.begin(), JTE.MBBs.end());
+
+  SmallPtrSet<const MachineBasicBlock *, 16> Cold;
+  for (MachineBasicBlock &MBB : MF) {
+    if (&MBB == &MF.front() || MBB.isEHPad() || MBB.hasAddressTaken() ||
+        Pinned.count(&MBB))
+      continue;
+    if (isColdBlock(MBB))
+      Cold.insert(&MBB);
+  }
+  if (Cold.empty())
+    return false;
+
+  // A fallthrough from one part into the other has to become a branch, which
+  // needs the terminators to be analyzable. Keep both ends of the other ones
+  // in the hot part.
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  SmallVector<std::pair<MachineBasicBlock *, MachineBasicBlock *>, 8>
+      FixedFallthroughs;
+  for (MachineBasicBlock &MBB : MF) {
+    MachineBasicBlock *FT = MBB.getFallThrough();
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (FT && TII->analyzeBranch(MBB, TBB, FBB, Cond))
+      FixedFallthroughs.push_back({&MBB, FT});
+  }
+  bool Changed;
+  do {
+    Changed = false;
+    for (auto &FT : FixedFallthroughs)
+      if (Cold.count(FT.first) != Cold.count(FT.second)) {
+        Cold.erase(FT.first);
+        Cold.erase(FT.second);
+        Changed = true;
+      }
+  } while (Changed);
+  if (Cold.empty())
+    return false;
+
+  LLVM_DEBUG(dbgs() << "Splitting " << Cold.size() << " cold blocks out of "
+                    << MF.getName() << "\n");
+
+  // Move the cold blocks to the end of the function, keeping their order.
+  SmallVector<MachineBasicBlock *, 16> ColdBlocks;
+  for (MachineBasicBlock &MBB : MF)
+    if (Cold.count(&MBB))
+      ColdBlocks.push_back(&MBB);
+  for (MachineBasicBlock *MBB : ColdBlocks) {
+    MBB->moveAfter(&MF.back());
+    MBB->setIsColdSection();
+  }
+
+  // Layout successors across the two parts are not fallthroughs anymore; fix
+  // up the terminators, which also drops the branches that became redundant.
+  for (MachineBasicBlock &MBB : MF) {
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (!TII->analyzeBranch(MBB, TBB, FBB, Cond))
+      MBB.updateTerminator();
+  }
+
+  copyPrologueCFI(MF, *ColdBlocks.front());
+
+  ++NumSplitFunctions;
+  NumColdBlocks += ColdBlocks.size();
+  return true;
+}
@@ -57,6 +57,7 @@
 #include "llvm/CodeGen/MachineOutliner.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
@@ -71,6 +72,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 #include <tuple>
@@ -84,6 +86,8 @@ using namespace outliner;
 
 STATISTIC(NumOutlined, "Number of candidates outlined");
 STATISTIC(FunctionsCreated, "Number of functions created");
+STATISTIC(LinkOnceODRFunctionsCreated,
+          "Number of functions created with linkonce_odr linkage");
 
 // Set to true if the user wants the outliner to run on linkonceodr linkage
 // functions. This is false by default because the linker can dedupe linkonceodr
@@ -96,6 +100,17 @@ static cl::opt<bool> EnableLinkOnceODROutlining(
     cl::desc("Enable the machine outliner on linkonceodr functions"),
     cl::init(false));
 
+// Set to true if outlined functions should be named after their contents and
+// given linkonce_odr linkage. Each ThinLTO backend (or each module of a
+// non-LTO build) outlines on its own, so the same sequences are typically
+// outlined in many modules. Naming the outlined functions after what they
+// contain lets the linker keep a single copy of each of them.
+static cl::opt<bool> EnableLinkOnceODROutlinedFunctions(
+    "enable-linkonceodr-outlined-functions", cl::Hidden,
+    cl::desc("Give functions created by the machine outliner linkonce_odr "
+             "linkage so that the linker can dedupe them across modules"),
+    cl::init(false));
+
 namespace {
 
 /// Represents an undefined index in the suffix tree.
@@ -890,6 +905,12 @@ struct MachineOutliner : public ModulePass {
   bool outline(Module &M, std::vector<OutlinedFunction> &FunctionList,
                InstructionMapper &Mapper);
 
+  /// Name \p F after the contents of its machine function \p MF and give it
+  /// linkonce_odr linkage. Return false if the body of \p MF refers to
+  /// anything local to the module, in which case it is left alone.
+  bool makeLinkOnceODR(Module &M, Function &F, MachineFunction &MF,
+                       OutlinedFunction &OF);
+
   /// Creates a function for \p OF and inserts it into the module.
   MachineFunction *createOutlinedFunction(Module &M, OutlinedFunction &OF,
                                           InstructionMapper &Mapper,
@@ -1153,6 +1174,10 @@ MachineOutliner::createOutlinedFunction(Module &M, OutlinedFunction &OF,
   MF.getProperties().reset(MachineFunctionProperties::Property::TracksLiveness);
   MF.getRegInfo().freezeReservedRegs(MF);
 
+  // This has to happen before emitting debug info, which records the name.
+  if (EnableLinkOnceODROutlinedFunctions && makeLinkOnceODR(M, *F, MF, OF))
+    LinkOnceODRFunctionsCreated++;
+
   // If there's a DISubprogram associated with this outlined function, then
   // emit debug info for the outlined function.
   if (DISubprogram *SP = getSubprogramOrNull(OF)) {
@@ -1188,6 +1213,71 @@ MachineOutliner::createOutlinedFunction(Module &M, OutlinedFunction &OF,
   return &MF;
 }
 
+/// Returns true if \p MO means the same thing in every module it appears in.
+static bool isModuleIndependent(const MachineOperand &MO) {
+  switch (MO.getType()) {
+  case MachineOperand::MO_Register:
+  case MachineOperand::MO_Immediate:
+  case MachineOperand::MO_CImmediate:
+  case MachineOperand::MO_FPImmediate:
+  case MachineOperand::MO_ExternalSymbol:
+  case MachineOperand::MO_RegisterMask:
+  case MachineOperand::MO_RegisterLiveOut:
+  case MachineOperand::MO_CFIIndex:
+  case MachineOperand::MO_IntrinsicID:
+  case MachineOperand::MO_Predicate:
+    return true;
+  case MachineOperand::MO_GlobalAddress:
+    // Two modules may define unrelated local symbols with the same name.
+    return !MO.getGlobal()->hasLocalLinkage();
+  default:
+    // Basic blocks, frame indices, constant pool and jump table entries, and
+    // symbols all refer to something private to the function or module.
+    return false;
+  }
+}
+
+bool MachineOutliner::makeLinkOnceODR(Module &M, Function &F,
+                                      MachineFunction &MF,
+                                      OutlinedFunction &OF) {
+  // The name has to identify the code of the function completely: two modules
+  // outlining the same sequence must agree on the name, and two modules
+  // outlining different sequences must not.
+  std::string Body;
+  raw_string_ostream OS(Body);
+  OS << OF.FrameConstructionID << '\n'
+     << F.getAttributes().getAsString(AttributeList::FunctionIndex) << '\n';
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  for (const MachineBasicBlock &MBB : MF) {
+    for (const MachineInstr &MI : MBB) {
+      if (!all_of(MI.operands(), isModuleIndependent))
+        return false;
+      MI.print(OS, /* IsStandalone */ true, /* SkipOpers */ false,
+               /* SkipDebugLoc */ true, /* AddNewLine */ true, TII);
+    }
+  }
+
+  MD5 Hash;
+  Hash.update(OS.str());
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  std::string Name = (Twine("OUTLINED_FUNCTION_") + Result.digest()).str();
+
+  // If the module already has an identical outlined function, keep this one
+  // internal rather than clash with it.
+  if (M.getNamedValue(Name))
+    return false;
+
+  F.setName(Name);
+  F.setLinkage(GlobalValue::LinkOnceODRLinkage);
+  F.setVisibility(GlobalValue::HiddenVisibility);
+  // Without a comdat, ELF and COFF linkers pick one definition of the symbol
+  // but keep the code of every copy.
+  if (Triple(M.getTargetTriple()).supportsCOMDAT())
+    F.setComdat(M.getOrInsertComdat(Name));
+  return true;
+}
+
 bool MachineOutliner::outline(Module &M,
                               std::vector<OutlinedFunction> &FunctionList,
                               InstructionMapper &Mapper) {
@@ -84,6 +84,12 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumBudgetedFunctions,
+          "Number of functions allocated with a compile-time budget");
+STATISTIC(NumSkippedRegionSplits,
+          "Number of region splits skipped because the budget was exhausted");
+STATISTIC(NumSkippedEvictions,
+          "Number of evictions skipped because the budget was exhausted");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -130,6 +136,25 @@ static cl::opt<unsigned>
                               "high compile time cost in global splitting."),
                      cl::init(5000));
 
+static cl::opt<unsigned> BudgetMinVirtRegs(
+    "greedy-budget-min-vregs", cl::Hidden,
+    cl::desc("Allocate functions with at least this many virtual registers "
+             "with a compile-time budget for eviction and region splitting "
+             "(0 = never)"),
+    cl::init(100000));
+
+static cl::opt<unsigned> RegionSplitBudget(
+    "greedy-region-split-budget", cl::Hidden,
+    cl::desc("Maximum number of region split candidates evaluated in a "
+             "budgeted function before falling back to block splitting"),
+    cl::init(2000000));
+
+static cl::opt<unsigned> EvictionBudget(
+    "greedy-eviction-budget", cl::Hidden,
+    cl::desc("Maximum number of eviction candidates evaluated in a budgeted "
+             "function before giving up on eviction"),
+    cl::init(4000000));
+
 // FIXME: Find a good default for this flag and remove the flag.
 static cl::opt<unsigned>
 CSRFirstTimeCost("regalloc-csr-first-time-cost",
@@ -411,6 +436,16 @@ class RAGreedy : public MachineFunctionPass,
   /// Set of broken hints that may be reconciled later because of eviction.
   SmallSetVector<LiveInterval *, 8> SetOfBrokenHints;
 
+  /// True if the current function is large enough that eviction and region
+  /// splitting are limited by RegionSplitBudget and EvictionBudget.
+  bool UseBudget;
+
+  /// Number of region split candidates evaluated so far.
+  unsigned RegionSplitWork;
+
+  /// Number of eviction candidates evaluated so far.
+  unsigned EvictionWork;
+
 public:
   RAGreedy();
 
@@ -553,6 +588,17 @@ private:
                                    FoldedSpills);
     }
   }
+
+  bool isRegionSplitBudgetExhausted() const {
+    return UseBudget && RegionSplitWork >= RegionSplitBudget;
+  }
+  bool isEvictionBudgetExhausted() const {
+    return UseBudget && EvictionWork >= EvictionBudget;
+  }
+
+  /// Report how much eviction and region splitting work a budgeted function
+  /// needed, and which of the two ran out of budget.
+  void reportBudget();
 };
 
 } // end anonymous namespace
@@ -1117,6 +1163,11 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
   unsigned BestPhys = 0;
   unsigned OrderLimit = Order.getOrder().size();
 
+  if (isEvictionBudgetExhausted()) {
+    ++NumSkippedEvictions;
+    return 0;
+  }
+
   // When we are just looking for a reduced cost per use, don't break any
   // hints, and only evict smaller spill weights.
   if (CostPerUseLimit < ~0u) {
@@ -1155,6 +1206,8 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
       continue;
     }
 
+    if (UseBudget)
+      ++EvictionWork;
     if (!canEvictInterference(VirtReg, PhysReg, false, BestCost,
                               FixedRegisters))
       continue;
@@ -1830,6 +1883,12 @@ unsigned RAGreedy::tryRegionSplit(LiveInterval &VirtReg, AllocationOrder &Order,
                                   SmallVectorImpl<unsigned> &NewVRegs) {
   if (!isSplitBenefitWorthCost(VirtReg))
     return 0;
+  // Block splitting is much cheaper than the global analysis below, and still
+  // makes progress.
+  if (isRegionSplitBudgetExhausted()) {
+    ++NumSkippedRegionSplits;
+    return 0;
+  }
   unsigned NumCands = 0;
   BlockFrequency SpillCost = calcSpillCost();
   BlockFrequency BestCost;
@@ -1880,6 +1939,9 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
     if (IgnoreCSR && isUnusedCalleeSavedReg(PhysReg))
       continue;
 
+    if (UseBudget)
+      ++RegionSplitWork;
+
     // Discard bad candidates before we run out of interference cache cursors.
     // This will only affect register classes with a lot of registers (>32).
     if (NumCands == IntfCache.getMaxCursors()) {
@@ -3207,6 +3269,28 @@ void RAGreedy::reportNumberOfSplillsReloads(MachineLoop *L, unsigned &Reloads,
   }
 }
 
+void RAGreedy::reportBudget() {
+  if (!isRegionSplitBudgetExhausted() && !isEvictionBudgetExhausted())
+    return;
+
+  using namespace ore;
+
+  ORE->emit([&]() {
+    MachineOptimizationRemarkAnalysis R(DEBUG_TYPE, "CompileTimeBudget",
+                                        DiagnosticLocation(), &MF->front());
+    R << "register allocation of " << NV("NumVirtRegs", MRI->getNumVirtRegs())
+      << " virtual registers evaluated "
+      << NV("RegionSplitCandidates", RegionSplitWork)
+      << " region split candidates and "
+      << NV("EvictionCandidates", EvictionWork) << " eviction candidates";
+    if (isRegionSplitBudgetExhausted())
+      R << "; fell back to block splitting";
+    if (isEvictionBudgetExhausted())
+      R << "; stopped evicting interference";
+    return R;
+  });
+}
+
 bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   LLVM_DEBUG(dbgs() << "********** GREEDY REGISTER ALLOCATION **********\n"
                     << "********** Function: " << mf.getName() << '\n');
@@ -3255,11 +3339,17 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   GlobalCand.resize(32);  // This will grow as needed.
   SetOfBrokenHints.clear();
   LastEvicted.clear();
+  UseBudget = BudgetMinVirtRegs && MRI->getNumVirtRegs() >= BudgetMinVirtRegs;
+  if (UseBudget)
+    ++NumBudgetedFunctions;
+  RegionSplitWork = 0;
+  EvictionWork = 0;
 
   allocatePhysRegs();
   tryHintsRecoloring();
   postOptimization();
   reportNumberOfSplillsReloads();
+  reportBudget();
 
   releaseMemory();
   return true;
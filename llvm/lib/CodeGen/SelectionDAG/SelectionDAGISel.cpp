@@ -114,6 +114,17 @@ STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
+STATISTIC(NumFastIselFailIntrinsic,
+          "Number of fast isel failures on intrinsic calls");
+STATISTIC(NumFastIselFailCall, "Number of fast isel failures on other calls");
+STATISTIC(NumFastIselFailTerminator,
+          "Number of fast isel failures on terminators");
+STATISTIC(NumFastIselFailVector,
+          "Number of fast isel failures on vector operations");
+STATISTIC(NumFastIselFailWideInteger,
+          "Number of fast isel failures on integers wider than 64 bits");
+STATISTIC(NumFastIselFailOther,
+          "Number of fast isel failures on other instructions");
 
 static cl::opt<int> EnableFastISelAbort(
     "fast-isel-abort", cl::Hidden,
@@ -710,6 +721,50 @@ static void reportFastISelFailure(MachineFunction &MF,
   ORE.emit(R);
 }
 
+/// Return true if \p Ty is, or contains, a vector type or an integer type
+/// wider than 64 bits, depending on \p Vector.
+static bool hasTypeKind(Type *Ty, bool Vector) {
+  if (Vector)
+    return Ty->isVectorTy();
+  return Ty->getScalarType()->isIntegerTy() &&
+         Ty->getScalarSizeInBits() > 64;
+}
+
+/// Classify why fast isel failed to select \p Inst, so that the fallbacks to
+/// SelectionDAG can be broken down by kind with -stats.
+static StringRef countFastISelFailure(const Instruction *Inst) {
+  auto InvolvesType = [&](bool Vector) {
+    if (hasTypeKind(Inst->getType(), Vector))
+      return true;
+    return llvm::any_of(Inst->operands(), [&](const Use &U) {
+      return hasTypeKind(U->getType(), Vector);
+    });
+  };
+
+  if (isa<IntrinsicInst>(Inst)) {
+    ++NumFastIselFailIntrinsic;
+    return "intrinsic";
+  }
+  if (InvolvesType(/*Vector=*/true)) {
+    ++NumFastIselFailVector;
+    return "vector";
+  }
+  if (InvolvesType(/*Vector=*/false)) {
+    ++NumFastIselFailWideInteger;
+    return "wide integer";
+  }
+  if (isa<CallBase>(Inst)) {
+    ++NumFastIselFailCall;
+    return "call";
+  }
+  if (Inst->isTerminator()) {
+    ++NumFastIselFailTerminator;
+    return "terminator";
+  }
+  ++NumFastIselFailOther;
+  return "other";
+}
+
 void SelectionDAGISel::SelectBasicBlock(BasicBlock::const_iterator Begin,
                                         BasicBlock::const_iterator End,
                                         bool &HadTailCall) {
@@ -1487,6 +1542,10 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         }
 
         FastISelFailed = true;
+        StringRef FailureKind = countFastISelFailure(Inst);
+        (void)FailureKind;
+        LLVM_DEBUG(dbgs() << "FastISel fallback (" << FailureKind
+                          << "): " << *Inst << "\n");
 
         // Then handle certain instructions as single-LLVM-Instruction blocks.
         // We cannot separate out GCrelocates to their own blocks since we need
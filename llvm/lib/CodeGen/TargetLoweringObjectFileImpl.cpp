@@ -728,6 +728,34 @@ bool TargetLoweringObjectFileELF::shouldPutJumpTableInFunctionSection(
   return false;
 }
 
+MCSection *TargetLoweringObjectFileELF::getSectionForColdPart(
+    const Function &F, const TargetMachine &TM) const {
+  // The cold parts of all functions share one section unless the function is
+  // in a section of its own, which the cold part has to follow so that the
+  // linker can remove or deduplicate them together. The .text.split. prefix
+  // lets the linker place them all away from the hot code.
+  unsigned Flags = ELF::SHF_ALLOC | ELF::SHF_EXECINSTR;
+  StringRef Group = "";
+  if (const Comdat *C = getELFComdat(&F)) {
+    Flags |= ELF::SHF_GROUP;
+    Group = C->getName();
+  }
+
+  SmallString<128> Name(".text.split");
+  unsigned UniqueID = MCContext::GenericSectionID;
+  if (TM.getFunctionSections() || F.hasComdat()) {
+    if (TM.getUniqueSectionNames()) {
+      Name.push_back('.');
+      TM.getNameWithPrefix(Name, &F, getMangler(),
+                           true /*MayAlwaysUsePrivate*/);
+    } else {
+      UniqueID = NextUniqueID++;
+    }
+  }
+  return getContext().getELFSection(Name, ELF::SHT_PROGBITS, Flags,
+                                    /*EntrySize=*/0, Group, UniqueID);
+}
+
 /// Given a mergeable constant with the specified size and relocation
 /// information, return a section that it should be placed in.
 MCSection *TargetLoweringObjectFileELF::getSectionForConstant(
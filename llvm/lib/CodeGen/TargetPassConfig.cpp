@@ -64,6 +64,9 @@ static cl::opt<bool> DisableBlockPlacement("disable-block-placement",
     cl::Hidden, cl::desc("Disable probability-driven block placement"));
 static cl::opt<bool> EnableBlockPlacementStats("enable-block-placement-stats",
     cl::Hidden, cl::desc("Collect probability-driven block placement stats"));
+static cl::opt<bool> EnableMachineFunctionSplitter("split-machine-functions",
+    cl::Hidden, cl::desc("Move the cold basic blocks of functions with "
+                         "profile data to a separate section"));
 static cl::opt<bool> DisableSSC("disable-ssc", cl::Hidden,
     cl::desc("Disable Stack Slot Coloring"));
 static cl::opt<bool> DisableMachineDCE("disable-machine-dce", cl::Hidden,
@@ -1213,6 +1216,11 @@ void TargetPassConfig::addBlockPlacement() {
     if (EnableBlockPlacementStats)
       addPass(&MachineBlockPlacementStatsID);
   }
+  // Splitting only moves blocks after placement chose the layout of each
+  // section, so it has to run after it.
+  if (TM->Options.EnableMachineFunctionSplitter ||
+      EnableMachineFunctionSplitter)
+    addPass(&MachineFunctionSplitterID);
 }
 
 //===---------------------------------------------------------------------===//
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/DWARF/DWARFUnit.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/DebugInfo/DWARF/DWARFAbbreviationDeclaration.h"
@@ -407,12 +408,29 @@ void DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
 }
 
 Error DWARFUnit::tryExtractDIEsIfNeeded(bool CUDieOnly) {
+  if (AllDIEsExtracted || (CUDieOnly && UnitDIEExtracted))
+    return Error::success(); // Already parsed.
+
+  std::lock_guard<std::mutex> Lock(ExtractDIEsMutex);
   if ((CUDieOnly && !DieArray.empty()) ||
       DieArray.size() > 1)
     return Error::success(); // Already parsed.
 
+  // Only publish the DIEs once the unit state derived from them below is set
+  // up, as threads seeing the flags don't synchronize on the mutex.
+  auto PublishDIEs = make_scope_exit([&]() {
+    UnitDIEExtracted = !DieArray.empty();
+    if (!CUDieOnly)
+      AllDIEsExtracted = true;
+  });
+
   bool HasCUDie = !DieArray.empty();
   extractDIEsToVector(!HasCUDie, !CUDieOnly, DieArray);
+  // The reservation made for the DIEs is an estimate based on the unit size.
+  // The array lives as long as the unit, so give back what it overshot.
+  if (!CUDieOnly &&
+      DieArray.capacity() - DieArray.size() > DieArray.size() / 4)
+    DieArray.shrink_to_fit();
 
   if (DieArray.empty())
     return Error::success();
@@ -542,10 +560,13 @@ bool DWARFUnit::parseDWO() {
 }
 
 void DWARFUnit::clearDIEs(bool KeepCUDie) {
+  std::lock_guard<std::mutex> Lock(ExtractDIEsMutex);
   if (DieArray.size() > (unsigned)KeepCUDie) {
     DieArray.resize((unsigned)KeepCUDie);
     DieArray.shrink_to_fit();
   }
+  UnitDIEExtracted = !DieArray.empty();
+  AllDIEsExtracted = false;
 }
 
 Expected<DWARFAddressRangesVector>
@@ -16,6 +16,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -202,6 +203,50 @@ unsigned DWARFVerifier::verifyUnitContents(DWARFUnit &Unit) {
   return NumUnitErrors;
 }
 
+unsigned
+DWARFVerifier::verifyUnitContentsInParallel(ArrayRef<DWARFUnit *> Units) {
+  if (Units.empty())
+    return 0;
+
+  // Everything that is shared between the units is parsed lazily, so set it
+  // up before starting any thread. Units may refer to DIEs of other units, so
+  // all the DIEs have to be extracted before any unit is checked.
+  DCtx.getDebugLoc();
+  for (DWARFUnit *Unit : Units)
+    Unit->getAbbreviations();
+  ThreadPool Pool(std::min<size_t>(DumpOpts.NumThreads, Units.size()));
+  for (DWARFUnit *Unit : Units)
+    Pool.async([Unit]() { Unit->getUnitDIE(/*ExtractUnitDIEOnly=*/false); });
+  Pool.wait();
+  // Dumping a DIE in an error message may look up file names in its line
+  // table.
+  for (DWARFUnit *Unit : Units)
+    DCtx.getLineTableForUnit(Unit);
+
+  std::vector<std::string> Reports(Units.size());
+  std::vector<unsigned> NumErrors(Units.size());
+  std::vector<std::map<uint64_t, std::set<uint64_t>>> References(
+      Units.size());
+  for (size_t I = 0, E = Units.size(); I != E; ++I)
+    Pool.async([&, I]() {
+      raw_string_ostream Report(Reports[I]);
+      DWARFVerifier Verifier(Report, DCtx, DumpOpts);
+      NumErrors[I] = Verifier.verifyUnitContents(*Units[I]);
+      References[I] = std::move(Verifier.ReferenceToDIEOffsets);
+    });
+  Pool.wait();
+
+  unsigned NumUnitErrors = 0;
+  for (size_t I = 0, E = Units.size(); I != E; ++I) {
+    OS << Reports[I];
+    NumUnitErrors += NumErrors[I];
+    for (const auto &Pair : References[I])
+      ReferenceToDIEOffsets[Pair.first].insert(Pair.second.begin(),
+                                               Pair.second.end());
+  }
+  return NumUnitErrors;
+}
+
 unsigned DWARFVerifier::verifyDebugInfoCallSite(const DWARFDie &Die) {
   if (Die.getTag() != DW_TAG_call_site)
     return 0;
@@ -280,6 +325,7 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector TypeUnitVector;
   DWARFUnitVector CompileUnitVector;
+  SmallVector<DWARFUnit *, 16> DeferredUnits;
   while (hasDIE) {
     OffsetStart = Offset;
     if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
@@ -318,7 +364,10 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
       }
       default: { llvm_unreachable("Invalid UnitType."); }
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit);
+      if (DumpOpts.NumThreads > 1)
+        DeferredUnits.push_back(Unit);
+      else
+        NumDebugInfoErrors += verifyUnitContents(*Unit);
     }
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
@@ -329,6 +378,7 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   }
   if (!isHeaderChainValid)
     ++NumDebugInfoErrors;
+  NumDebugInfoErrors += verifyUnitContentsInParallel(DeferredUnits);
   NumDebugInfoErrors += verifyDebugInfoReferences();
   return NumDebugInfoErrors;
 }
@@ -0,0 +1,229 @@
+//===- DwarfTransformer.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/DwarfTransformer.h"
+#include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/InlineInfo.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace gsym;
+
+namespace {
+
+/// The per compile unit state needed to convert its DIEs: the line table and
+/// a cache that maps the unit's DWARF file indexes to GSYM file indexes.
+struct CUInfo {
+  const DWARFDebugLine::LineTable *LineTable;
+  const char *CompDir;
+  std::vector<uint32_t> FileCache;
+
+  CUInfo(DWARFContext &DICtx, DWARFUnit *CU) {
+    LineTable = DICtx.getLineTableForUnit(CU);
+    CompDir = CU->getCompilationDir();
+    // DWARF 5 file indexes are 0 based and earlier versions are 1 based, so
+    // leave room for both.
+    if (LineTable)
+      FileCache.assign(LineTable->Prologue.FileNames.size() + 1, UINT32_MAX);
+  }
+
+  /// Convert a DWARF compile unit file index into a GSYM global file index.
+  ///
+  /// Each compile unit in DWARF has its own file table in the line table
+  /// prologue. GSYM has a single large file table that applies to all files
+  /// from all of the info in a GSYM file. This function converts between the
+  /// two and caches and DWARF CU file index that has already been converted so
+  /// the first client that asks for a compile unit file index will end up
+  /// doing the conversion, and subsequent clients will get the cached GSYM
+  /// index.
+  uint32_t DWARFToGSYMFileIndex(GsymCreator &Gsym, uint64_t DwarfFileIdx) {
+    if (!LineTable || DwarfFileIdx >= FileCache.size())
+      return 0;
+    uint32_t &GsymFileIdx = FileCache[DwarfFileIdx];
+    if (GsymFileIdx != UINT32_MAX)
+      return GsymFileIdx;
+    std::string File;
+    if (LineTable->getFileNameByIndex(
+            DwarfFileIdx, CompDir,
+            DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath, File))
+      GsymFileIdx = Gsym.insertFile(File);
+    else
+      GsymFileIdx = 0;
+    return GsymFileIdx;
+  }
+};
+
+} // end anonymous namespace
+
+static void parseInlineInfo(GsymCreator &Gsym, CUInfo &CUI, DWARFDie Die,
+                            InlineInfo &Parent) {
+  switch (Die.getTag()) {
+  case dwarf::DW_TAG_inlined_subroutine: {
+    Expected<DWARFAddressRangesVector> RangesOrError = Die.getAddressRanges();
+    if (!RangesOrError) {
+      consumeError(RangesOrError.takeError());
+      return;
+    }
+    const char *Name = Die.getSubroutineName(DINameKind::LinkageName);
+    if (!Name)
+      return;
+    InlineInfo II;
+    // Only keep the ranges that are contained in the parent so that lookups
+    // can always descend from the concrete function to the deepest inlined
+    // function.
+    for (const DWARFAddressRange &Range : *RangesOrError)
+      if (Range.LowPC < Range.HighPC && Parent.Ranges.contains(Range.LowPC) &&
+          Parent.Ranges.contains(Range.HighPC - 1))
+        II.Ranges.insert(AddressRange(Range.LowPC, Range.HighPC));
+    if (II.Ranges.empty())
+      return;
+    II.Name = Gsym.insertString(Name);
+    uint32_t CallFile = 0, CallLine = 0, CallColumn = 0, CallDiscriminator = 0;
+    Die.getCallerFrame(CallFile, CallLine, CallColumn, CallDiscriminator);
+    II.CallFile = CUI.DWARFToGSYMFileIndex(Gsym, CallFile);
+    II.CallLine = CallLine;
+    for (DWARFDie ChildDie : Die.children())
+      parseInlineInfo(Gsym, CUI, ChildDie, II);
+    Parent.Children.emplace_back(std::move(II));
+    return;
+  }
+  case dwarf::DW_TAG_lexical_block:
+    // Lexical blocks don't show up in call stacks, but they can contain
+    // inlined functions.
+    for (DWARFDie ChildDie : Die.children())
+      parseInlineInfo(Gsym, CUI, ChildDie, Parent);
+    return;
+  default:
+    return;
+  }
+}
+
+static void convertFunctionLineTable(GsymCreator &Gsym, CUInfo &CUI,
+                                     DWARFDie Die, uint64_t SectionIndex,
+                                     FunctionInfo &FI) {
+  std::vector<uint32_t> RowVector;
+  const uint64_t StartAddress = FI.startAddress();
+  const uint64_t EndAddress = FI.endAddress();
+  const object::SectionedAddress SecAddress{StartAddress, SectionIndex};
+  if (!CUI.LineTable->lookupAddressRange(SecAddress, FI.size(), RowVector)) {
+    // If we have a DW_TAG_subprogram but no line entries, fall back to using
+    // the DW_AT_decl_file and DW_AT_decl_line if we have both attributes.
+    if (auto FileIdx =
+            dwarf::toUnsigned(Die.findRecursively({dwarf::DW_AT_decl_file})))
+      if (auto Line =
+              dwarf::toUnsigned(Die.findRecursively({dwarf::DW_AT_decl_line})))
+        FI.Lines.push_back(LineEntry(
+            StartAddress, CUI.DWARFToGSYMFileIndex(Gsym, *FileIdx), *Line));
+    return;
+  }
+
+  for (uint32_t RowIndex : RowVector) {
+    const DWARFDebugLine::Row &Row = CUI.LineTable->Rows[RowIndex];
+    if (Row.EndSequence || Row.Address.Address >= EndAddress)
+      continue;
+    // The first row can start before the function when the function doesn't
+    // begin a new row.
+    LineEntry LE(std::max(Row.Address.Address, StartAddress),
+                 CUI.DWARFToGSYMFileIndex(Gsym, Row.File), Row.Line);
+    if (!FI.Lines.empty()) {
+      LineEntry &Prev = FI.Lines.back();
+      // Several rows for one address only leave the last one visible.
+      if (Prev.Addr == LE.Addr) {
+        Prev = LE;
+        continue;
+      }
+      // Rows that don't change the file or line don't change lookup results,
+      // leave them out to keep the line table small.
+      if (Prev.File == LE.File && Prev.Line == LE.Line)
+        continue;
+    }
+    FI.Lines.push_back(LE);
+  }
+}
+
+static void handleDie(raw_ostream &OS, GsymCreator &Gsym, CUInfo &CUI,
+                      DWARFDie Die) {
+  if (Die.getTag() == dwarf::DW_TAG_subprogram) {
+    Expected<DWARFAddressRangesVector> RangesOrError = Die.getAddressRanges();
+    if (!RangesOrError) {
+      consumeError(RangesOrError.takeError());
+    } else if (!RangesOrError->empty()) {
+      const char *Name = Die.getSubroutineName(DINameKind::LinkageName);
+      if (!Name) {
+        OS << "warning: DIE has an address range but no name: ";
+        Die.dump(OS, 0, DIDumpOptions::getForSingleDIE());
+      } else {
+        for (const DWARFAddressRange &Range : *RangesOrError) {
+          // Skip empty and invalid ranges.
+          if (Range.LowPC >= Range.HighPC)
+            continue;
+          FunctionInfo FI;
+          FI.setStartAddress(Range.LowPC);
+          FI.setEndAddress(Range.HighPC);
+          FI.Name = Gsym.insertString(Name);
+          if (CUI.LineTable)
+            convertFunctionLineTable(Gsym, CUI, Die, Range.SectionIndex, FI);
+          // The root of the inline tree describes the concrete function and
+          // has no name.
+          FI.Inline.Ranges.insert(FI.Range);
+          for (DWARFDie ChildDie : Die.children())
+            parseInlineInfo(Gsym, CUI, ChildDie, FI.Inline);
+          if (FI.Inline.Children.empty())
+            FI.Inline.clear();
+          Gsym.addFunctionInfo(std::move(FI));
+        }
+      }
+    }
+  }
+  for (DWARFDie ChildDie : Die.children())
+    handleDie(OS, Gsym, CUI, ChildDie);
+}
+
+llvm::Error DwarfTransformer::convert(uint32_t NumThreads) {
+  size_t NumBefore = Gsym.getNumFunctionInfos();
+  std::vector<DWARFUnit *> Units;
+  for (const auto &CU : DICtx.compile_units())
+    Units.push_back(CU.get());
+
+  if (NumThreads <= 1 || Units.size() <= 1) {
+    for (DWARFUnit *CU : Units) {
+      CUInfo CUI(DICtx, CU);
+      handleDie(Log, Gsym, CUI, CU->getUnitDIE(false));
+    }
+  } else {
+    // The line tables are cached by the DWARFContext, which isn't safe to do
+    // from several threads, so parse them before converting the units in
+    // parallel. Extracting the DIEs of a unit is thread safe.
+    std::vector<std::unique_ptr<CUInfo>> CUInfos;
+    for (DWARFUnit *CU : Units)
+      CUInfos.push_back(std::make_unique<CUInfo>(DICtx, CU));
+    std::vector<std::string> Logs(Units.size());
+    ThreadPool Pool(std::min<size_t>(NumThreads, Units.size()));
+    for (size_t I = 0, E = Units.size(); I != E; ++I)
+      Pool.async([&, I] {
+        raw_string_ostream OS(Logs[I]);
+        handleDie(OS, Gsym, *CUInfos[I], Units[I]->getUnitDIE(false));
+      });
+    Pool.wait();
+    for (const std::string &UnitLog : Logs)
+      Log << UnitLog;
+  }
+  Log << "Loaded " << Gsym.getNumFunctionInfos() - NumBefore
+      << " functions from DWARF.\n";
+  return Error::success();
+}
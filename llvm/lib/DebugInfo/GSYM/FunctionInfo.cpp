@@ -8,10 +8,22 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/FileWriter.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include "llvm/Support/DataExtractor.h"
+#include <inttypes.h>
 
 using namespace llvm;
 using namespace gsym;
 
+/// FunctionInfo information type that is used to encode the optional data
+/// that is associated with a FunctionInfo object.
+enum class InfoType : uint32_t {
+  EndOfList = 0u,
+  LineTableInfo = 1u,
+  InlineInfo = 2u
+};
+
 raw_ostream &llvm::gsym::operator<<(raw_ostream &OS, const FunctionInfo &FI) {
   OS << '[' << HEX64(FI.Range.Start) << '-' << HEX64(FI.Range.End) << "): "
      << "Name=" << HEX32(FI.Name) << '\n';
@@ -20,3 +32,297 @@ raw_ostream &llvm::gsym::operator<<(raw_ostream &OS, const FunctionInfo &FI) {
   OS << FI.Inline;
   return OS;
 }
+
+/// Encode the line table of a function.
+///
+/// Each row is encoded as the ULEB128 address delta from the previous row (or
+/// from the function start for the first row), the ULEB128 file index and the
+/// SLEB128 line delta from the previous row. Rows must be sorted by address
+/// and can't start before the function.
+static llvm::Error encodeLineTable(FileWriter &O, uint64_t BaseAddr,
+                                   ArrayRef<LineEntry> Lines) {
+  O.writeULEB(Lines.size());
+  uint64_t PrevAddr = BaseAddr;
+  int64_t PrevLine = 0;
+  for (const auto &Line : Lines) {
+    if (Line.Addr < PrevAddr)
+      return createStringError(std::errc::invalid_argument,
+                               "line table entry 0x%8.8" PRIx64
+                               " is not sorted or precedes its function",
+                               Line.Addr);
+    O.writeULEB(Line.Addr - PrevAddr);
+    O.writeULEB(Line.File);
+    O.writeSLEB((int64_t)Line.Line - PrevLine);
+    PrevAddr = Line.Addr;
+    PrevLine = Line.Line;
+  }
+  return Error::success();
+}
+
+/// Decode the line table of a function, calling \p Callback for each row.
+///
+/// Decoding stops early when \p Callback returns false, which lets lookups
+/// stop at the first row past the address they are looking for.
+template <typename CallbackT>
+static llvm::Error decodeLineTable(DataExtractor &Data, uint64_t &Offset,
+                                   uint64_t BaseAddr, CallbackT Callback) {
+  if (!Data.isValidOffset(Offset))
+    return createStringError(std::errc::io_error,
+        "0x%8.8" PRIx64 ": missing line table row count", Offset);
+  const uint64_t NumRows = Data.getULEB128(&Offset);
+  uint64_t Addr = BaseAddr;
+  int64_t Line = 0;
+  for (uint64_t I = 0; I < NumRows; ++I) {
+    if (!Data.isValidOffset(Offset))
+      return createStringError(std::errc::io_error,
+          "0x%8.8" PRIx64 ": line table row %" PRIu64 " is truncated",
+          Offset, I);
+    Addr += Data.getULEB128(&Offset);
+    const uint32_t File = (uint32_t)Data.getULEB128(&Offset);
+    Line += Data.getSLEB128(&Offset);
+    if (!Callback(LineEntry(Addr, File, (uint32_t)Line)))
+      break;
+  }
+  return Error::success();
+}
+
+llvm::Expected<FunctionInfo> FunctionInfo::decode(DataExtractor &Data,
+                                                  uint64_t BaseAddr) {
+  FunctionInfo FI;
+  FI.Range.Start = BaseAddr;
+  uint64_t Offset = 0;
+  if (!Data.isValidOffsetForDataOfSize(Offset, 4))
+    return createStringError(std::errc::io_error,
+        "0x%8.8" PRIx64 ": missing FunctionInfo Size", Offset);
+  FI.Range.End = FI.Range.Start + Data.getU32(&Offset);
+  if (!Data.isValidOffsetForDataOfSize(Offset, 4))
+    return createStringError(std::errc::io_error,
+        "0x%8.8" PRIx64 ": missing FunctionInfo Name", Offset);
+  FI.Name = Data.getU32(&Offset);
+  if (FI.Name == 0)
+    return createStringError(std::errc::io_error,
+        "0x%8.8" PRIx64 ": invalid FunctionInfo Name value 0x%8.8x",
+        Offset - 4, FI.Name);
+  bool Done = false;
+  while (!Done) {
+    if (!Data.isValidOffsetForDataOfSize(Offset, 4))
+      return createStringError(std::errc::io_error,
+          "0x%8.8" PRIx64 ": missing FunctionInfo InfoType value", Offset);
+    const uint32_t IT = Data.getU32(&Offset);
+    if (!Data.isValidOffsetForDataOfSize(Offset, 4))
+      return createStringError(std::errc::io_error,
+          "0x%8.8" PRIx64 ": missing FunctionInfo InfoType length", Offset);
+    const uint32_t InfoLength = Data.getU32(&Offset);
+    if (!Data.isValidOffsetForDataOfSize(Offset, InfoLength))
+      return createStringError(std::errc::io_error,
+          "0x%8.8" PRIx64 ": missing FunctionInfo data for InfoType %u",
+          Offset, IT);
+    DataExtractor InfoData(Data.getData().substr(Offset, InfoLength),
+                           Data.isLittleEndian(),
+                           Data.getAddressSize());
+    switch (InfoType(IT)) {
+    case InfoType::EndOfList:
+      Done = true;
+      break;
+
+    case InfoType::LineTableInfo: {
+      uint64_t InfoOffset = 0;
+      if (llvm::Error Err = decodeLineTable(
+              InfoData, InfoOffset, BaseAddr, [&](const LineEntry &Row) {
+                FI.Lines.push_back(Row);
+                return true;
+              }))
+        return std::move(Err);
+      break;
+    }
+
+    case InfoType::InlineInfo:
+      if (Expected<gsym::InlineInfo> II =
+              gsym::InlineInfo::decode(InfoData, BaseAddr))
+        FI.Inline = std::move(II.get());
+      else
+        return II.takeError();
+      break;
+
+    default:
+      // Skip information we don't know about so newer files can still be
+      // read.
+      break;
+    }
+    Offset += InfoLength;
+  }
+  return std::move(FI);
+}
+
+/// Write a (uint32_t InfoType, uint32_t Length) prefixed record, fixing up
+/// its length once \p EncodeData has written the record data.
+template <typename EncodeT>
+static llvm::Error encodeInfo(FileWriter &O, InfoType IT,
+                              EncodeT EncodeData) {
+  O.writeU32(static_cast<uint32_t>(IT));
+  const uint64_t LengthOffset = O.tell();
+  // Write a fake length for now that we will fix up once we know how long
+  // the data is.
+  O.writeU32(0);
+  const uint64_t StartOffset = O.tell();
+  if (llvm::Error Err = EncodeData())
+    return Err;
+  const uint64_t Length = O.tell() - StartOffset;
+  if (Length > UINT32_MAX)
+    return createStringError(std::errc::invalid_argument,
+                             "InfoType %u data too large (%" PRIu64 " bytes)",
+                             static_cast<uint32_t>(IT), Length);
+  O.fixup32((uint32_t)Length, LengthOffset);
+  return Error::success();
+}
+
+llvm::Expected<uint64_t> FunctionInfo::encode(FileWriter &O) const {
+  if (!isValid())
+    return createStringError(std::errc::invalid_argument,
+        "attempted to encode invalid FunctionInfo object");
+  if (size() > UINT32_MAX)
+    return createStringError(std::errc::invalid_argument,
+        "FunctionInfo at 0x%8.8" PRIx64 " is too large to encode",
+        startAddress());
+  // Align FunctionInfo data to a 4 byte alignment.
+  O.alignTo(4);
+  const uint64_t FuncInfoOffset = O.tell();
+  // Write the size in bytes of this function as a uint32_t. This can be zero
+  // if we just have a symbol from a symbol table and that symbol has no size.
+  O.writeU32(size());
+  // Write the name of this function as a uint32_t string table offset.
+  O.writeU32(Name);
+
+  if (!Lines.empty()) {
+    if (llvm::Error Err = encodeInfo(O, InfoType::LineTableInfo, [&] {
+          return encodeLineTable(O, startAddress(), Lines);
+        }))
+      return std::move(Err);
+  }
+
+  if (Inline.isValid()) {
+    if (llvm::Error Err = encodeInfo(O, InfoType::InlineInfo, [&] {
+          return Inline.encode(O, startAddress());
+        }))
+      return std::move(Err);
+  }
+
+  // Terminate the data chunks with and end of list with zero size
+  O.writeU32(static_cast<uint32_t>(InfoType::EndOfList));
+  O.writeU32(0);
+  return FuncInfoOffset;
+}
+
+llvm::Expected<LookupResult> FunctionInfo::lookup(DataExtractor &Data,
+                                                  const GsymReader &GR,
+                                                  uint64_t FuncAddr,
+                                                  uint64_t Addr) {
+  LookupResult LR;
+  LR.LookupAddr = Addr;
+  LR.FuncRange.Start = FuncAddr;
+  uint64_t Offset = 0;
+  if (!Data.isValidOffsetForDataOfSize(Offset, 8))
+    return createStringError(std::errc::io_error,
+                             "FunctionInfo data is truncated");
+  LR.FuncRange.End = FuncAddr + Data.getU32(&Offset);
+  const uint32_t NameOffset = Data.getU32(&Offset);
+  // The "lookup" functions doesn't report errors as accurately as the "decode"
+  // function as it is meant to be fast. For more accurate errors we could call
+  // "decode" and then call "lookup" after successfully decoding the
+  // FunctionInfo object.
+  if (NameOffset == 0)
+    return createStringError(std::errc::io_error,
+                             "0x%8.8" PRIx64 ": invalid FunctionInfo Name",
+                             Offset - 4);
+  LR.FuncName = GR.getString(NameOffset);
+  // Functions from symbol tables may not have a size, in which case they
+  // cover everything up to the next address in the address table.
+  if (LR.FuncRange.size() > 0 && !LR.FuncRange.contains(Addr))
+    return createStringError(std::errc::io_error,
+                             "address 0x%" PRIx64 " is not in GSYM", Addr);
+  bool Done = false;
+  Optional<gsym::LineEntry> LE;
+  Optional<gsym::InlineInfo> Inline;
+  while (!Done) {
+    if (!Data.isValidOffsetForDataOfSize(Offset, 8))
+      return createStringError(std::errc::io_error,
+          "FunctionInfo data is truncated");
+    const uint32_t IT = Data.getU32(&Offset);
+    const uint32_t InfoLength = Data.getU32(&Offset);
+    const StringRef InfoBytes = Data.getData().substr(Offset, InfoLength);
+    if (InfoLength != InfoBytes.size())
+      return createStringError(std::errc::io_error,
+          "FunctionInfo data is truncated");
+    DataExtractor InfoData(InfoBytes, Data.isLittleEndian(),
+                           Data.getAddressSize());
+    switch (InfoType(IT)) {
+    case InfoType::EndOfList:
+      Done = true;
+      break;
+
+    case InfoType::LineTableInfo: {
+      // Rows are sorted by address, so the row for Addr is the last one
+      // that starts at or before it.
+      uint64_t InfoOffset = 0;
+      if (llvm::Error Err = decodeLineTable(
+              InfoData, InfoOffset, FuncAddr, [&](const LineEntry &Row) {
+                if (Row.Addr > Addr)
+                  return false;
+                LE = Row;
+                return true;
+              }))
+        return std::move(Err);
+      break;
+    }
+
+    case InfoType::InlineInfo:
+      if (Expected<gsym::InlineInfo> II =
+              gsym::InlineInfo::decode(InfoData, FuncAddr))
+        Inline = std::move(II.get());
+      else
+        return II.takeError();
+      break;
+
+    default:
+      break;
+    }
+    Offset += InfoLength;
+  }
+
+  // Without a line table we only know the function name.
+  if (!LE)
+    return LR;
+
+  auto getLocation = [&](StringRef Name, uint32_t File, uint32_t Line) {
+    SourceLocation SrcLoc;
+    SrcLoc.Name = Name;
+    SrcLoc.Line = Line;
+    if (Optional<FileEntry> FE = GR.getFile(File)) {
+      SrcLoc.Dir = GR.getString(FE->Dir);
+      SrcLoc.Base = GR.getString(FE->Base);
+    }
+    return SrcLoc;
+  };
+
+  Optional<gsym::InlineInfo::InlineArray> InlineStack;
+  if (Inline)
+    InlineStack = Inline->getInlineStack(Addr);
+  if (!InlineStack) {
+    LR.Locations.push_back(
+        getLocation(LR.FuncName, LE->File, LE->Line));
+    return LR;
+  }
+
+  // The line table row describes the deepest inlined function. Each inlined
+  // function then provides the call site of the next one and the outermost
+  // one the location in the concrete function.
+  uint32_t File = LE->File;
+  uint32_t Line = LE->Line;
+  for (const gsym::InlineInfo *II : *InlineStack) {
+    LR.Locations.push_back(getLocation(GR.getString(II->Name), File, Line));
+    File = II->CallFile;
+    Line = II->CallLine;
+  }
+  LR.Locations.push_back(getLocation(LR.FuncName, File, Line));
+  return LR;
+}
@@ -0,0 +1,121 @@
+//===- GsymContext.cpp ------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+
+using namespace llvm;
+using namespace llvm::gsym;
+
+GsymContext::GsymContext(std::unique_ptr<GsymReader> Reader)
+    : DIContext(CK_GSYM), Reader(std::move(Reader)) {}
+
+GsymContext::~GsymContext() = default;
+
+void GsymContext::dump(raw_ostream &OS, DIDumpOptions DumpOpts) {
+  Reader->dump(OS);
+}
+
+static void fillLineInfoFromLocation(const LookupResult &Result,
+                                     uint32_t Index,
+                                     DILineInfoSpecifier Specifier,
+                                     DILineInfo &LineInfo) {
+  using FileLineInfoKind = DILineInfoSpecifier::FileLineInfoKind;
+  const SourceLocation &Location = Result.Locations[Index];
+  // GSYM only stores one name per function, which is the linkage name when
+  // the producer found one.
+  if (Specifier.FNKind != DINameKind::None)
+    LineInfo.FunctionName = Location.Name.str();
+  // The DWARF producer stores absolute paths, so both kinds of file name get
+  // the same path.
+  if (Specifier.FLIKind != FileLineInfoKind::None) {
+    std::string File = Result.getSourceFile(Index);
+    if (!File.empty())
+      LineInfo.FileName = File;
+  }
+  LineInfo.Line = Location.Line;
+}
+
+DILineInfo
+GsymContext::getLineInfoForAddress(object::SectionedAddress Address,
+                                   DILineInfoSpecifier Specifier) {
+  DILineInfo LineInfo;
+  Expected<LookupResult> ResultOrErr = Reader->lookup(Address.Address);
+  if (!ResultOrErr) {
+    consumeError(ResultOrErr.takeError());
+    return LineInfo;
+  }
+  // Like DWARF, report the location in the deepest inlined function.
+  if (!ResultOrErr->Locations.empty())
+    fillLineInfoFromLocation(*ResultOrErr, 0, Specifier, LineInfo);
+  else if (Specifier.FNKind != DINameKind::None)
+    LineInfo.FunctionName = ResultOrErr->FuncName.str();
+  return LineInfo;
+}
+
+DILineInfoTable
+GsymContext::getLineInfoForAddressRange(object::SectionedAddress Address,
+                                        uint64_t Size,
+                                        DILineInfoSpecifier Specifier) {
+  DILineInfoTable Table;
+  const uint64_t EndAddr = Address.Address + Size;
+  uint64_t Addr = Address.Address;
+  while (Addr < EndAddr) {
+    Expected<FunctionInfo> FI = Reader->getFunctionInfo(Addr);
+    if (!FI) {
+      consumeError(FI.takeError());
+      break;
+    }
+    for (const LineEntry &LE : FI->Lines) {
+      if (LE.Addr < Address.Address || LE.Addr >= EndAddr)
+        continue;
+      object::SectionedAddress RowAddress = {LE.Addr, Address.SectionIndex};
+      Table.push_back(std::make_pair(
+          LE.Addr, getLineInfoForAddress(RowAddress, Specifier)));
+    }
+    // Functions without a size extend up to the next function, which we can't
+    // find from here.
+    if (FI->size() == 0)
+      break;
+    Addr = FI->endAddress();
+  }
+  return Table;
+}
+
+DIInliningInfo
+GsymContext::getInliningInfoForAddress(object::SectionedAddress Address,
+                                       DILineInfoSpecifier Specifier) {
+  DIInliningInfo InlineInfo;
+  Expected<LookupResult> ResultOrErr = Reader->lookup(Address.Address);
+  if (!ResultOrErr) {
+    consumeError(ResultOrErr.takeError());
+    return InlineInfo;
+  }
+  const LookupResult &Result = *ResultOrErr;
+  if (Result.Locations.empty()) {
+    DILineInfo LineInfo;
+    if (Specifier.FNKind != DINameKind::None)
+      LineInfo.FunctionName = Result.FuncName.str();
+    InlineInfo.addFrame(LineInfo);
+    return InlineInfo;
+  }
+  // Locations are ordered from the deepest inlined function to the concrete
+  // function, which is the frame order DIInliningInfo uses.
+  for (uint32_t I = 0, E = Result.Locations.size(); I != E; ++I) {
+    DILineInfo LineInfo;
+    fillLineInfoFromLocation(Result, I, Specifier, LineInfo);
+    InlineInfo.addFrame(LineInfo);
+  }
+  return InlineInfo;
+}
+
+std::vector<DILocal>
+GsymContext::getLocalsForAddress(object::SectionedAddress Address) {
+  return std::vector<DILocal>();
+}
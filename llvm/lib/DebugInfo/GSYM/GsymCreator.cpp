@@ -0,0 +1,227 @@
+//===- GsymCreator.cpp ----------------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/DebugInfo/GSYM/FileWriter.h"
+#include "llvm/DebugInfo/GSYM/Header.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+
+using namespace llvm;
+using namespace gsym;
+
+GsymCreator::GsymCreator() {
+  // The string table starts with the empty string and file index zero is an
+  // empty entry so that a zero offset or index means "no string" or "no
+  // file".
+  insertString("");
+  insertFile(StringRef());
+}
+
+uint32_t GsymCreator::insertFile(StringRef Path,
+                                 llvm::sys::path::Style Style) {
+  llvm::StringRef Directory = llvm::sys::path::parent_path(Path, Style);
+  llvm::StringRef Filename = llvm::sys::path::filename(Path, Style);
+  FileEntry FE(insertString(Directory), insertString(Filename));
+
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  const auto NextIndex = Files.size();
+  // Find FE in hash map and insert if not present.
+  auto R = FileEntryToIndex.insert(std::make_pair(FE, NextIndex));
+  if (R.second)
+    Files.emplace_back(FE);
+  return R.first->second;
+}
+
+llvm::Error GsymCreator::save(StringRef Path,
+                              llvm::support::endianness ByteOrder) const {
+  std::error_code EC;
+  raw_fd_ostream OutStrm(Path, EC);
+  if (EC)
+    return llvm::errorCodeToError(EC);
+  FileWriter O(OutStrm, ByteOrder);
+  return encode(O);
+}
+
+llvm::Error GsymCreator::encode(FileWriter &O) const {
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  if (Funcs.empty())
+    return createStringError(std::errc::invalid_argument,
+                             "no functions to encode");
+  if (!Finalized)
+    return createStringError(std::errc::invalid_argument,
+                             "GsymCreator wasn't finalized prior to encoding");
+  if (Funcs.size() > UINT32_MAX)
+    return createStringError(std::errc::invalid_argument,
+                             "too many FunctionInfos");
+  if (UUID.size() > GSYM_MAX_UUID_SIZE)
+    return createStringError(std::errc::invalid_argument,
+                             "invalid UUID size %u", (uint32_t)UUID.size());
+
+  // All offsets in the GSYM data are relative to the start of the header,
+  // which is expected to be 8 byte aligned like the start of a file or a
+  // section is.
+  const uint64_t HeaderOffset = O.tell();
+  const uint64_t MinAddr = Funcs.front().startAddress();
+  const uint64_t MaxAddr = Funcs.back().startAddress();
+  const uint64_t AddrDelta = MaxAddr - MinAddr;
+  Header Hdr;
+  Hdr.Magic = GSYM_MAGIC;
+  Hdr.Version = GSYM_VERSION;
+  Hdr.AddrOffSize = 0;
+  Hdr.UUIDSize = static_cast<uint8_t>(UUID.size());
+  Hdr.BaseAddress = MinAddr;
+  Hdr.NumAddresses = static_cast<uint32_t>(Funcs.size());
+  Hdr.StrtabOffset = 0; // We will fix this up later.
+  Hdr.StrtabSize = 0; // We will fix this up later.
+  memset(Hdr.UUID, 0, sizeof(Hdr.UUID));
+  if (!UUID.empty())
+    memcpy(Hdr.UUID, UUID.data(), UUID.size());
+  // Use the smallest address offset size that can represent all addresses.
+  if (AddrDelta <= UINT8_MAX)
+    Hdr.AddrOffSize = 1;
+  else if (AddrDelta <= UINT16_MAX)
+    Hdr.AddrOffSize = 2;
+  else if (AddrDelta <= UINT32_MAX)
+    Hdr.AddrOffSize = 4;
+  else
+    Hdr.AddrOffSize = 8;
+  // Write out the header.
+  llvm::Error Err = Hdr.encode(O);
+  if (Err)
+    return Err;
+
+  // Write out the address offsets.
+  O.alignTo(Hdr.AddrOffSize);
+  for (const auto &FuncInfo : Funcs) {
+    uint64_t AddrOffset = FuncInfo.startAddress() - Hdr.BaseAddress;
+    switch (Hdr.AddrOffSize) {
+    case 1: O.writeU8(static_cast<uint8_t>(AddrOffset)); break;
+    case 2: O.writeU16(static_cast<uint16_t>(AddrOffset)); break;
+    case 4: O.writeU32(static_cast<uint32_t>(AddrOffset)); break;
+    case 8: O.writeU64(AddrOffset); break;
+    }
+  }
+
+  // Write out all zeros for the AddrInfoOffsets.
+  O.alignTo(4);
+  const uint64_t AddrInfoOffsetsOffset = O.tell();
+  for (size_t I = 0, N = Funcs.size(); I < N; ++I)
+    O.writeU32(0);
+
+  // Write out the file table
+  O.alignTo(4);
+  assert(!Files.empty());
+  assert(Files[0].Dir == 0);
+  assert(Files[0].Base == 0);
+  size_t NumFiles = Files.size();
+  if (NumFiles > UINT32_MAX)
+    return createStringError(std::errc::invalid_argument,
+                             "too many files");
+  O.writeU32(static_cast<uint32_t>(NumFiles));
+  for (auto File : Files) {
+    O.writeU32(File.Dir);
+    O.writeU32(File.Base);
+  }
+
+  // Write out the sting table.
+  const uint64_t StrtabOffset = O.tell() - HeaderOffset;
+  if (StrtabOffset + StrTab.size() > UINT32_MAX)
+    return createStringError(std::errc::invalid_argument,
+                             "string table doesn't fit in a 32 bit offset");
+  O.writeData(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(StrTab.data()), StrTab.size()));
+  O.fixup32(uint32_t(StrtabOffset),
+            HeaderOffset + offsetof(Header, StrtabOffset));
+  O.fixup32(uint32_t(StrTab.size()),
+            HeaderOffset + offsetof(Header, StrtabSize));
+
+  // Write out the address infos for each function info.
+  for (size_t I = 0, N = Funcs.size(); I < N; ++I) {
+    Expected<uint64_t> OffsetOrErr = Funcs[I].encode(O);
+    if (!OffsetOrErr)
+      return OffsetOrErr.takeError();
+    const uint64_t Offset = *OffsetOrErr - HeaderOffset;
+    if (Offset > UINT32_MAX)
+      return createStringError(std::errc::invalid_argument,
+                               "FunctionInfo doesn't fit in a 32 bit offset");
+    O.fixup32(static_cast<uint32_t>(Offset), AddrInfoOffsetsOffset + I * 4);
+  }
+  return Error::success();
+}
+
+llvm::Error GsymCreator::finalize(llvm::raw_ostream &OS) {
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  if (Finalized)
+    return createStringError(std::errc::invalid_argument,
+                             "already finalized");
+  Finalized = true;
+
+  // Sort function infos so we can emit sorted functions.
+  llvm::sort(Funcs);
+
+  // Symbol tables and debug info often describe the same function, so we can
+  // have many FunctionInfo objects that start at the same address. Keep the
+  // one from the debug info with a line table and inline information if we
+  // have one, otherwise the biggest one.
+  auto Better = [](const FunctionInfo &LHS, const FunctionInfo &RHS) {
+    return std::make_tuple(LHS.hasRichInfo(), LHS.size(), LHS.Lines.size()) >
+           std::make_tuple(RHS.hasRichInfo(), RHS.size(), RHS.Lines.size());
+  };
+  size_t NumBefore = Funcs.size();
+  std::vector<FunctionInfo> FinalizedFuncs;
+  FinalizedFuncs.reserve(NumBefore);
+  for (auto &FI : Funcs) {
+    if (!FinalizedFuncs.empty()) {
+      FunctionInfo &Prev = FinalizedFuncs.back();
+      if (Prev.startAddress() == FI.startAddress()) {
+        if (Better(FI, Prev))
+          Prev = std::move(FI);
+        continue;
+      }
+      if (Prev.Range.intersects(FI.Range))
+        OS << "warning: function " << Prev.Range << " \""
+           << StringRef(StrTab.data() + Prev.Name) << "\" overlaps "
+           << FI.Range << " \"" << StringRef(StrTab.data() + FI.Name)
+           << "\"\n";
+    }
+    FinalizedFuncs.emplace_back(std::move(FI));
+  }
+  Funcs.swap(FinalizedFuncs);
+  OS << "Pruned " << NumBefore - Funcs.size() << " functions, ended with "
+     << Funcs.size() << " total\n";
+  return Error::success();
+}
+
+uint32_t GsymCreator::insertString(StringRef S) {
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  auto R = StringOffsets.insert(
+      std::make_pair(S, static_cast<uint32_t>(StrTab.size())));
+  if (R.second) {
+    StrTab.append(S.begin(), S.end());
+    StrTab.push_back('\0');
+  }
+  return R.first->second;
+}
+
+void GsymCreator::addFunctionInfo(FunctionInfo &&FI) {
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  Funcs.emplace_back(std::move(FI));
+}
+
+size_t GsymCreator::getNumFunctionInfos() const {
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  return Funcs.size();
+}
@@ -0,0 +1,240 @@
+//===- GsymReader.cpp -------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <inttypes.h>
+
+using namespace llvm;
+using namespace gsym;
+
+GsymReader::GsymReader(std::unique_ptr<MemoryBuffer> Buffer)
+    : MemBuffer(std::move(Buffer)),
+      Endian(support::endian::system_endianness()) {}
+
+GsymReader::GsymReader(GsymReader &&RHS) = default;
+
+GsymReader::~GsymReader() = default;
+
+llvm::Expected<GsymReader> GsymReader::openFile(StringRef Filename) {
+  // Don't require a null terminator so that large files get memory mapped.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BuffOrErr =
+      MemoryBuffer::getFile(Filename, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+  if (!BuffOrErr)
+    return createFileError(Filename, errorCodeToError(BuffOrErr.getError()));
+  GsymReader GR(std::move(*BuffOrErr));
+  if (llvm::Error Err = GR.parse())
+    return createFileError(Filename, std::move(Err));
+  return std::move(GR);
+}
+
+llvm::Expected<GsymReader> GsymReader::copyBuffer(StringRef Bytes) {
+  GsymReader GR(MemoryBuffer::getMemBufferCopy(Bytes, "GSYM bytes"));
+  if (llvm::Error Err = GR.parse())
+    return std::move(Err);
+  return std::move(GR);
+}
+
+llvm::Error GsymReader::parse() {
+  GsymBytes = MemBuffer->getBuffer();
+  if (GsymBytes.size() < sizeof(Header))
+    return createStringError(std::errc::invalid_argument,
+                             "not enough data for a GSYM header");
+
+  // The magic value tells us the byte order of the whole file.
+  const uint32_t Magic =
+      support::endian::read<uint32_t, support::unaligned>(GsymBytes.data(),
+                                                          support::little);
+  if (Magic == GSYM_MAGIC)
+    Endian = support::little;
+  else if (Magic == GSYM_CIGAM)
+    Endian = support::big;
+  else
+    return createStringError(std::errc::invalid_argument,
+                             "not a GSYM file");
+
+  DataExtractor Data(GsymBytes, Endian == support::little, 4);
+  Expected<Header> ExpectedHdr = Header::decode(Data);
+  if (!ExpectedHdr)
+    return ExpectedHdr.takeError();
+  Hdr = *ExpectedHdr;
+
+  // Slice the tables out of the buffer without copying them. Every entry is
+  // read with the byte order of the file on access.
+  auto getTable = [&](uint64_t &Offset, uint64_t Align, uint64_t Size,
+                      StringRef Name, ArrayRef<uint8_t> &Table) -> Error {
+    Offset = alignTo(Offset, Align);
+    if (Offset > GsymBytes.size() || Size > GsymBytes.size() - Offset)
+      return createStringError(std::errc::invalid_argument,
+                               "failed to read %s", Name.data());
+    Table = arrayRefFromStringRef(GsymBytes.substr(Offset, Size));
+    Offset += Size;
+    return Error::success();
+  };
+
+  uint64_t Offset = sizeof(Header);
+  if (Error Err = getTable(Offset, Hdr.AddrOffSize,
+                           (uint64_t)Hdr.NumAddresses * Hdr.AddrOffSize,
+                           "address table", AddrOffsets))
+    return Err;
+  if (Error Err = getTable(Offset, 4, (uint64_t)Hdr.NumAddresses * 4,
+                           "address info offsets table", AddrInfoOffsets))
+    return Err;
+  Offset = alignTo(Offset, 4);
+  if (!Data.isValidOffsetForDataOfSize(Offset, 4))
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read file table");
+  NumFiles = Data.getU32(&Offset);
+  if (Error Err = getTable(Offset, 4, (uint64_t)NumFiles * 8, "file table",
+                           Files))
+    return Err;
+
+  if ((uint64_t)Hdr.StrtabOffset + Hdr.StrtabSize > GsymBytes.size())
+    return createStringError(std::errc::invalid_argument,
+                             "failed to read string table");
+  StrTab.Data = GsymBytes.substr(Hdr.StrtabOffset, Hdr.StrtabSize);
+  return Error::success();
+}
+
+uint64_t GsymReader::getAddrOffset(size_t Index) const {
+  const uint8_t *Ptr = AddrOffsets.data() + Index * Hdr.AddrOffSize;
+  switch (Hdr.AddrOffSize) {
+  case 1:
+    return *Ptr;
+  case 2:
+    return support::endian::read<uint16_t, support::unaligned>(Ptr, Endian);
+  case 4:
+    return support::endian::read<uint32_t, support::unaligned>(Ptr, Endian);
+  case 8:
+    return support::endian::read<uint64_t, support::unaligned>(Ptr, Endian);
+  }
+  llvm_unreachable("the header was checked for a valid address offset size");
+}
+
+Optional<uint64_t> GsymReader::getAddress(size_t Index) const {
+  if (Index >= Hdr.NumAddresses)
+    return llvm::None;
+  return Hdr.BaseAddress + getAddrOffset(Index);
+}
+
+Optional<FileEntry> GsymReader::getFile(uint32_t Index) const {
+  if (Index >= NumFiles)
+    return llvm::None;
+  const uint8_t *Ptr = Files.data() + Index * 8;
+  return FileEntry(
+      support::endian::read<uint32_t, support::unaligned>(Ptr, Endian),
+      support::endian::read<uint32_t, support::unaligned>(Ptr + 4, Endian));
+}
+
+llvm::Expected<uint64_t>
+GsymReader::getAddressIndex(const uint64_t Addr) const {
+  if (Addr >= Hdr.BaseAddress) {
+    const uint64_t AddrOffset = Addr - Hdr.BaseAddress;
+    // Find the first function that starts after the address; the one before
+    // it is the only one that can contain the address.
+    size_t Lo = 0;
+    size_t Hi = Hdr.NumAddresses;
+    while (Lo < Hi) {
+      const size_t Mid = Lo + (Hi - Lo) / 2;
+      if (getAddrOffset(Mid) <= AddrOffset)
+        Lo = Mid + 1;
+      else
+        Hi = Mid;
+    }
+    if (Lo > 0)
+      return Lo - 1;
+  }
+  return createStringError(std::errc::invalid_argument,
+                           "address 0x%" PRIx64 " is not in GSYM", Addr);
+}
+
+llvm::Expected<DataExtractor>
+GsymReader::getFunctionInfoData(uint64_t Index) const {
+  const uint32_t InfoOffset =
+      support::endian::read<uint32_t, support::unaligned>(
+          AddrInfoOffsets.data() + Index * 4, Endian);
+  if (InfoOffset >= GsymBytes.size())
+    return createStringError(std::errc::invalid_argument,
+                             "invalid address info offset 0x%8.8x",
+                             InfoOffset);
+  return DataExtractor(GsymBytes.substr(InfoOffset),
+                       Endian == support::little, 4);
+}
+
+llvm::Expected<FunctionInfo> GsymReader::getFunctionInfo(uint64_t Addr) const {
+  Expected<uint64_t> AddressIndex = getAddressIndex(Addr);
+  if (!AddressIndex)
+    return AddressIndex.takeError();
+  Expected<DataExtractor> Data = getFunctionInfoData(*AddressIndex);
+  if (!Data)
+    return Data.takeError();
+  const uint64_t FuncAddr = Hdr.BaseAddress + getAddrOffset(*AddressIndex);
+  Expected<FunctionInfo> FI = FunctionInfo::decode(*Data, FuncAddr);
+  if (!FI)
+    return FI.takeError();
+  // Functions without a size cover everything up to the next function.
+  if (FI->size() > 0 && !FI->Range.contains(Addr))
+    return createStringError(std::errc::invalid_argument,
+                             "address 0x%" PRIx64 " is not in GSYM", Addr);
+  return FI;
+}
+
+llvm::Expected<LookupResult> GsymReader::lookup(uint64_t Addr) const {
+  Expected<uint64_t> AddressIndex = getAddressIndex(Addr);
+  if (!AddressIndex)
+    return AddressIndex.takeError();
+  Expected<DataExtractor> Data = getFunctionInfoData(*AddressIndex);
+  if (!Data)
+    return Data.takeError();
+  const uint64_t FuncAddr = Hdr.BaseAddress + getAddrOffset(*AddressIndex);
+  return FunctionInfo::lookup(*Data, *this, FuncAddr, Addr);
+}
+
+void GsymReader::dump(raw_ostream &OS) const {
+  OS << Hdr << '\n';
+  OS << "Address Table:\n";
+  OS << "INDEX  OFFSET";
+  switch (Hdr.AddrOffSize) {
+  case 1: OS << "8 "; break;
+  case 2: OS << "16"; break;
+  case 4: OS << "32"; break;
+  case 8: OS << "64"; break;
+  }
+  OS << " (ADDRESS)\n";
+  OS << "====== =============================== \n";
+  for (uint32_t I = 0; I < Hdr.NumAddresses; ++I) {
+    const uint64_t AddrOffset = getAddrOffset(I);
+    OS << format("[%4u] ", I) << format_hex(AddrOffset, 2 + 2 * Hdr.AddrOffSize)
+       << " (" << HEX64(Hdr.BaseAddress + AddrOffset) << ")\n";
+  }
+  OS << "\nAddress Info Offsets:\n";
+  OS << "INDEX  Offset\n";
+  OS << "====== ==========\n";
+  for (uint32_t I = 0; I < Hdr.NumAddresses; ++I) {
+    uint32_t Offset = support::endian::read<uint32_t, support::unaligned>(
+        AddrInfoOffsets.data() + I * 4, Endian);
+    OS << format("[%4u] ", I) << HEX32(Offset) << '\n';
+  }
+  OS << "\nFiles:\n";
+  OS << "INDEX  DIRECTORY  BASENAME   PATH\n";
+  OS << "====== ========== ========== ==============================\n";
+  for (uint32_t I = 0; I < NumFiles; ++I) {
+    const FileEntry FE = *getFile(I);
+    OS << format("[%4u] ", I) << HEX32(FE.Dir) << ' ' << HEX32(FE.Base) << ' ';
+    StringRef Dir = getString(FE.Dir);
+    if (!Dir.empty())
+      OS << Dir << '/';
+    OS << getString(FE.Base) << '\n';
+  }
+  OS << '\n' << StrTab << '\n';
+}
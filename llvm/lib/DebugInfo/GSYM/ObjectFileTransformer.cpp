@@ -0,0 +1,121 @@
+//===- ObjectFileTransformer.cpp --------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/GSYM/ObjectFileTransformer.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/Header.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/MachO.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace gsym;
+
+constexpr uint32_t NT_GNU_BUILD_ID_TAG = 0x03;
+
+static std::vector<uint8_t> getUUID(const object::ObjectFile &Obj) {
+  // Extract the UUID from the object file
+  std::vector<uint8_t> UUID;
+  if (auto *MachO = dyn_cast<object::MachOObjectFile>(&Obj)) {
+    const ArrayRef<uint8_t> MachUUID = MachO->getUuid();
+    if (!MachUUID.empty())
+      UUID.assign(MachUUID.data(), MachUUID.data() + MachUUID.size());
+  } else if (isa<object::ELFObjectFileBase>(&Obj)) {
+    const StringRef GNUBuildID(".note.gnu.build-id");
+    for (const object::SectionRef &Sect : Obj.sections()) {
+      Expected<StringRef> SectNameOrErr = Sect.getName();
+      if (!SectNameOrErr) {
+        consumeError(SectNameOrErr.takeError());
+        continue;
+      }
+      StringRef SectName(*SectNameOrErr);
+      if (SectName != GNUBuildID)
+        continue;
+      StringRef BuildIDData;
+      Expected<StringRef> E = Sect.getContents();
+      if (E)
+        BuildIDData = *E;
+      else {
+        consumeError(E.takeError());
+        continue;
+      }
+      DataExtractor Decoder(BuildIDData, Obj.isLittleEndian(), 8);
+      uint64_t Offset = 0;
+      const uint32_t NameSize = Decoder.getU32(&Offset);
+      const uint32_t PayloadSize = Decoder.getU32(&Offset);
+      const uint32_t PayloadType = Decoder.getU32(&Offset);
+      StringRef Name = BuildIDData.substr(Offset, NameSize).rtrim('\0');
+      Offset = alignTo(Offset + NameSize, 4);
+      if (Name == "GNU" && PayloadType == NT_GNU_BUILD_ID_TAG &&
+          Decoder.isValidOffsetForDataOfSize(Offset, PayloadSize)) {
+        ArrayRef<uint8_t> UUIDBytes =
+            arrayRefFromStringRef(BuildIDData.substr(Offset, PayloadSize));
+        UUID.assign(UUIDBytes.begin(), UUIDBytes.end());
+      }
+    }
+  }
+  return UUID;
+}
+
+llvm::Error ObjectFileTransformer::convert(const object::ObjectFile &Obj,
+                                           raw_ostream &Log,
+                                           GsymCreator &Gsym) {
+  size_t NumBefore = Gsym.getNumFunctionInfos();
+  const bool IsMachO = isa<object::MachOObjectFile>(&Obj);
+  for (const auto &SymAndSize : object::computeSymbolSizes(Obj)) {
+    const object::SymbolRef &Sym = SymAndSize.first;
+    Expected<object::SymbolRef::Type> SymType = Sym.getType();
+    if (!SymType) {
+      consumeError(SymType.takeError());
+      continue;
+    }
+    if (*SymType != object::SymbolRef::Type::ST_Function)
+      continue;
+    // Undefined symbols and symbols outside of code can't be the function
+    // that contains an address we need to symbolize.
+    Expected<object::section_iterator> Sect = Sym.getSection();
+    if (!Sect) {
+      consumeError(Sect.takeError());
+      continue;
+    }
+    if (*Sect == Obj.section_end() || !(*Sect)->isText())
+      continue;
+    Expected<uint64_t> AddrOrErr = Sym.getAddress();
+    if (!AddrOrErr)
+      return AddrOrErr.takeError();
+    Expected<StringRef> Name = Sym.getName();
+    if (!Name) {
+      logAllUnhandledErrors(Name.takeError(), Log,
+                            "ObjectFileTransformer: ");
+      continue;
+    }
+    StringRef SymName = *Name;
+    // The debug info doesn't have the leading underscore that mach-o adds to
+    // the names in its symbol table.
+    if (IsMachO)
+      SymName.consume_front("_");
+    if (SymName.empty())
+      continue;
+    Gsym.addFunctionInfo(FunctionInfo(*AddrOrErr, SymAndSize.second,
+                                      Gsym.insertString(SymName)));
+  }
+  Log << "Loaded " << Gsym.getNumFunctionInfos() - NumBefore
+      << " functions from symbol table.\n";
+  std::vector<uint8_t> UUID = getUUID(Obj);
+  if (UUID.size() > GSYM_MAX_UUID_SIZE)
+    Log << "warning: ignoring UUID of " << UUID.size() << " bytes\n";
+  else if (!UUID.empty())
+    Gsym.setUUID(UUID);
+  return Error::success();
+}
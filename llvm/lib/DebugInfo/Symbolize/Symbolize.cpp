@@ -17,6 +17,8 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/GsymContext.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
 #include "llvm/DebugInfo/PDB/PDB.h"
 #include "llvm/DebugInfo/PDB/PDBContext.h"
 #include "llvm/Demangle/Demangle.h"
@@ -461,9 +463,24 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   ObjectPair Objects = ObjectsOrErr.get();
 
   std::unique_ptr<DIContext> Context;
+  // If there is a GSYM file for this binary, symbolize from it without
+  // parsing the debug info.
+  if (Opts.UseGsym) {
+    std::string GsymPath = BinaryName + ".gsym";
+    if (sys::fs::exists(GsymPath)) {
+      auto ReaderOrErr = gsym::GsymReader::openFile(GsymPath);
+      if (!ReaderOrErr) {
+        Modules.emplace(ModuleName, std::unique_ptr<SymbolizableModule>());
+        return ReaderOrErr.takeError();
+      }
+      Context = std::make_unique<gsym::GsymContext>(
+          std::make_unique<gsym::GsymReader>(std::move(*ReaderOrErr)));
+    }
+  }
   // If this is a COFF object containing PDB info, use a PDBContext to
   // symbolize. Otherwise, use DWARF.
-  if (auto CoffObject = dyn_cast<COFFObjectFile>(Objects.first)) {
+  auto CoffObject = dyn_cast<COFFObjectFile>(Objects.first);
+  if (!Context && CoffObject) {
     const codeview::DebugInfo *DebugInfo;
     StringRef PDBFileName;
     auto EC = CoffObject->getDebugPDBInfo(DebugInfo, PDBFileName);
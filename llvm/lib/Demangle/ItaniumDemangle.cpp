@@ -254,8 +254,17 @@ class BumpPointerAllocator {
 
   alignas(long double) char InitialBuffer[AllocSize];
   BlockMeta* BlockList = nullptr;
+  // Blocks of AllocSize that a reset() freed up, kept for reuse so that a
+  // demangler reused across names stops allocating once it is warm.
+  BlockMeta* FreeList = nullptr;
 
   void grow() {
+    if (FreeList) {
+      BlockMeta* Reused = FreeList;
+      FreeList = FreeList->Next;
+      BlockList = new (Reused) BlockMeta{BlockList, 0};
+      return;
+    }
     char* NewMeta = static_cast<char *>(std::malloc(AllocSize));
     if (NewMeta == nullptr)
       std::terminate();
@@ -267,10 +276,20 @@ class BumpPointerAllocator {
     BlockMeta* NewMeta = reinterpret_cast<BlockMeta*>(std::malloc(NBytes));
     if (NewMeta == nullptr)
       std::terminate();
-    BlockList->Next = new (NewMeta) BlockMeta{BlockList->Next, 0};
+    // Massive blocks are marked by a Current that no AllocSize block
+    // reaches, so that reset() frees them instead of keeping them.
+    BlockList->Next = new (NewMeta) BlockMeta{BlockList->Next, NBytes};
     return static_cast<void*>(NewMeta + 1);
   }
 
+  static void freeBlocks(BlockMeta* List) {
+    while (List) {
+      BlockMeta* Tmp = List;
+      List = List->Next;
+      std::free(Tmp);
+    }
+  }
+
 public:
   BumpPointerAllocator()
       : BlockList(new (InitialBuffer) BlockMeta{nullptr, 0}) {}
@@ -291,13 +310,22 @@ public:
     while (BlockList) {
       BlockMeta* Tmp = BlockList;
       BlockList = BlockList->Next;
-      if (reinterpret_cast<char*>(Tmp) != InitialBuffer)
+      if (reinterpret_cast<char*>(Tmp) == InitialBuffer)
+        continue;
+      if (Tmp->Current > UsableAllocSize) {
         std::free(Tmp);
+        continue;
+      }
+      Tmp->Next = FreeList;
+      FreeList = Tmp;
     }
     BlockList = new (InitialBuffer) BlockMeta{nullptr, 0};
   }
 
-  ~BumpPointerAllocator() { reset(); }
+  ~BumpPointerAllocator() {
+    reset();
+    freeBlocks(FreeList);
+  }
 };
 
 class DefaultAllocator {
@@ -520,6 +548,17 @@ char *ItaniumPartialDemangler::finishDemangle(char *Buf, size_t *N) const {
   return printNode(static_cast<Node *>(RootNode), Buf, N);
 }
 
+char *ItaniumPartialDemangler::demangle(const char *MangledName,
+                                        size_t MangledLength, char *Buf,
+                                        size_t *N) {
+  Demangler *Parser = static_cast<Demangler *>(Context);
+  Parser->reset(MangledName, MangledName + MangledLength);
+  RootNode = Parser->parse();
+  if (RootNode == nullptr)
+    return nullptr;
+  return printNode(static_cast<Node *>(RootNode), Buf, N);
+}
+
 bool ItaniumPartialDemangler::hasFunctionQualifiers() const {
   assert(RootNode != nullptr && "must call partialDemangle()");
   if (!isFunction())
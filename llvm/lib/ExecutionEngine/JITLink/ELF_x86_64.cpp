@@ -0,0 +1,688 @@
+//===----- ELF_x86_64.cpp - JIT linker implementation for ELF/x86-64 ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF/x86-64 jit-link implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+
+#include "BasicGOTAndStubsBuilder.h"
+#include "JITLinkGeneric.h"
+
+#include "llvm/Object/ELF.h"
+
+#define DEBUG_TYPE "jitlink"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+/// Builds an AtomGraph from an ELF/x86-64 relocatable object.
+///
+/// Relocatable ELF sections don't have addresses, so each allocatable section
+/// is given a distinct synthetic address range. Sections are split into atoms
+/// at each symbol definition, and the atoms of a section are chained with
+/// layout-next edges. This keeps every section contiguous, which relocations
+/// against section symbols and local labels rely on.
+class ELFAtomGraphBuilder_x86_64 {
+public:
+  using ELFT = object::ELF64LE;
+
+  ELFAtomGraphBuilder_x86_64(StringRef FileName,
+                             const object::ELFFile<ELFT> &Obj)
+      : Obj(Obj),
+        G(std::make_unique<AtomGraph>(FileName.str(), 8, support::little)) {}
+
+  Expected<std::unique_ptr<AtomGraph>> buildGraph() {
+    if (auto Err = parseSections())
+      return std::move(Err);
+
+    if (auto Err = addAtoms())
+      return std::move(Err);
+
+    if (auto Err = addRelocations())
+      return std::move(Err);
+
+    return std::move(G);
+  }
+
+private:
+  struct ELFSection {
+    Section *GenericSection = nullptr;
+    JITTargetAddress Address = 0;
+    uint64_t Size = 0;
+    uint32_t Alignment = 1;
+    StringRef Content;
+    // The atoms of this section, keyed by section offset.
+    std::map<uint64_t, DefinedAtom *> Atoms;
+  };
+
+  /// The atom that a symbol refers to, and the offset of the symbol within
+  /// it.
+  struct SymbolTarget {
+    Atom *A = nullptr;
+    uint64_t Offset = 0;
+  };
+
+  static Expected<ELFX86RelocationKind> getRelocationKind(uint32_t Type) {
+    switch (Type) {
+    case ELF::R_X86_64_64:
+      return Pointer64;
+    case ELF::R_X86_64_32:
+      return Pointer32;
+    case ELF::R_X86_64_32S:
+      return Pointer32Signed;
+    case ELF::R_X86_64_PC32:
+      return PCRel32;
+    case ELF::R_X86_64_PLT32:
+      return Branch32;
+    case ELF::R_X86_64_GOTPCREL:
+    case ELF::R_X86_64_GOTPCRELX:
+    case ELF::R_X86_64_REX_GOTPCRELX:
+      return PCRel32GOTLoad;
+    case ELF::R_X86_64_PC64:
+      return Delta64;
+    }
+    return make_error<JITLinkError>(
+        "Unsupported x86-64 relocation: " +
+        object::getELFRelocationTypeName(ELF::EM_X86_64, Type));
+  }
+
+  static uint32_t getFixupSize(ELFX86RelocationKind Kind) {
+    return (Kind == Pointer64 || Kind == Delta64) ? 8 : 4;
+  }
+
+  /// Returns the alignment to use for an atom at the given section offset:
+  /// the largest power of two that keeps the atom at its original position
+  /// relative to the section start.
+  static uint32_t getAtomAlignment(const ELFSection &S, uint64_t Offset) {
+    return MinAlign(S.Alignment, Offset);
+  }
+
+  /// Returns the atom in S that covers Offset. An offset at the very end of
+  /// the section is treated as the end of the last atom.
+  static DefinedAtom *findAtomCovering(const ELFSection &S, uint64_t Offset,
+                                       uint64_t &AtomOffset) {
+    auto I = S.Atoms.upper_bound(Offset);
+    if (I == S.Atoms.begin() || Offset > S.Size)
+      return nullptr;
+    --I;
+    AtomOffset = I->first;
+    return I->second;
+  }
+
+  bool hasAtomNamed(StringRef Name) {
+    auto A = G->findAtomByName(Name);
+    if (A)
+      return true;
+    consumeError(A.takeError());
+    return false;
+  }
+
+  Section &getCommonSection() {
+    if (!CommonSection) {
+      auto Prot = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+      CommonSection = &G->createSection("<common>", 1, Prot, true);
+    }
+    return *CommonSection;
+  }
+
+  Error parseSections() {
+    auto Secs = Obj.sections();
+    if (!Secs)
+      return Secs.takeError();
+
+    JITTargetAddress NextAddress = 0;
+    for (unsigned SecIndex = 0; SecIndex != Secs->size(); ++SecIndex) {
+      const ELFT::Shdr &Sec = (*Secs)[SecIndex];
+
+      if (Sec.sh_type == ELF::SHT_SYMTAB) {
+        if (SymTab)
+          return make_error<JITLinkError>("Multiple symbol tables in ELF");
+        SymTab = &Sec;
+        continue;
+      }
+
+      if (Sec.sh_type == ELF::SHT_SYMTAB_SHNDX) {
+        auto Table = Obj.getSHNDXTable(Sec);
+        if (!Table)
+          return Table.takeError();
+        ShndxTable = *Table;
+        continue;
+      }
+
+      if (Sec.sh_type == ELF::SHT_REL || Sec.sh_type == ELF::SHT_RELA) {
+        RelocationSections.push_back(&Sec);
+        continue;
+      }
+
+      if (!(Sec.sh_flags & ELF::SHF_ALLOC) || Sec.sh_size == 0)
+        continue;
+
+      auto Name = Obj.getSectionName(&Sec);
+      if (!Name)
+        return Name.takeError();
+
+      // FIXME: Register .eh_frame once EHFrameSupport can consume CFI with
+      // relocated (rather than pre-computed) pointers.
+      if (*Name == ".eh_frame")
+        continue;
+
+      if (Sec.sh_flags & ELF::SHF_TLS)
+        return make_error<JITLinkError>("Thread-local section " + *Name +
+                                        " is not supported");
+
+      uint64_t Align = std::max<uint64_t>(Sec.sh_addralign, 1);
+      if (!isPowerOf2_64(Align) || Align > std::numeric_limits<uint32_t>::max())
+        return make_error<JITLinkError>("Section " + *Name +
+                                        " has invalid alignment");
+
+      sys::Memory::ProtectionFlags Prot;
+      if (Sec.sh_flags & ELF::SHF_EXECINSTR)
+        Prot = static_cast<sys::Memory::ProtectionFlags>(sys::Memory::MF_READ |
+                                                         sys::Memory::MF_EXEC);
+      else if (Sec.sh_flags & ELF::SHF_WRITE)
+        Prot = static_cast<sys::Memory::ProtectionFlags>(sys::Memory::MF_READ |
+                                                         sys::Memory::MF_WRITE);
+      else
+        Prot = sys::Memory::MF_READ;
+
+      bool IsZeroFill = Sec.sh_type == ELF::SHT_NOBITS;
+      NextAddress = alignTo(NextAddress, Align);
+
+      LLVM_DEBUG({
+        dbgs() << "Adding section " << *Name << ": "
+               << format("0x%016" PRIx64, NextAddress) << ", align: " << Align
+               << "\n";
+      });
+
+      auto &S = Sections[SecIndex];
+      S.GenericSection = &G->createSection(*Name, Align, Prot, IsZeroFill);
+      S.Address = NextAddress;
+      S.Size = Sec.sh_size;
+      S.Alignment = Align;
+      if (!IsZeroFill) {
+        auto Content = Obj.getSectionContents(&Sec);
+        if (!Content)
+          return Content.takeError();
+        if (Content->size() != Sec.sh_size)
+          return make_error<JITLinkError>("Section content size does not "
+                                          "match declared size for " +
+                                          *Name);
+        S.Content = toStringRef(*Content);
+      }
+
+      NextAddress += Sec.sh_size;
+    }
+
+    return Error::success();
+  }
+
+  Error addSymbol(const ELFT::Sym &Sym, unsigned SymIndex, StringRef StrTab,
+                  ELFT::SymRange Syms) {
+    if (Sym.getType() == ELF::STT_FILE)
+      return Error::success();
+
+    auto Name = Sym.getName(StrTab);
+    if (!Name)
+      return Name.takeError();
+
+    bool IsLocal = Sym.getBinding() == ELF::STB_LOCAL;
+
+    if (Sym.isUndefined()) {
+      if (Name->empty())
+        return Error::success();
+      if (IsLocal)
+        return make_error<JITLinkError>("Undefined local symbol " + *Name);
+      LLVM_DEBUG(dbgs() << "Adding undef atom \"" << *Name << "\"\n");
+      auto &A = G->addExternalAtom(*Name);
+      A.setWeak(Sym.getBinding() == ELF::STB_WEAK);
+      SymbolTargets[SymIndex].A = &A;
+      return Error::success();
+    }
+
+    if (Sym.isAbsolute()) {
+      if (Name->empty())
+        return Error::success();
+      LLVM_DEBUG({
+        dbgs() << "Adding absolute \"" << *Name << "\" addr: "
+               << format("0x%016" PRIx64, uint64_t(Sym.st_value)) << "\n";
+      });
+      auto &A = G->addAbsoluteAtom(*Name, Sym.st_value);
+      A.setGlobal(!IsLocal);
+      A.setExported(!IsLocal && Sym.getVisibility() != ELF::STV_HIDDEN);
+      A.setWeak(Sym.getBinding() == ELF::STB_WEAK);
+      SymbolTargets[SymIndex].A = &A;
+      return Error::success();
+    }
+
+    if (Sym.isCommon()) {
+      uint32_t Align = std::max<uint64_t>(Sym.st_value, 1);
+      if (!isPowerOf2_32(Align))
+        return make_error<JITLinkError>("Common symbol " + *Name +
+                                        " has invalid alignment");
+      LLVM_DEBUG(dbgs() << "Adding common \"" << *Name << "\"\n");
+      auto &A = G->addCommonAtom(getCommonSection(), *Name, 0, Align,
+                                 Sym.st_size);
+      A.setGlobal(true);
+      A.setExported(Sym.getVisibility() != ELF::STV_HIDDEN);
+      SymbolTargets[SymIndex].A = &A;
+      return Error::success();
+    }
+
+    auto SecIndex = Obj.getSectionIndex(&Sym, Syms, ShndxTable);
+    if (!SecIndex)
+      return SecIndex.takeError();
+
+    // Symbols in sections that aren't linked (debug info, .eh_frame, ...) are
+    // not given atoms.
+    auto SecI = Sections.find(*SecIndex);
+    if (SecI == Sections.end())
+      return Error::success();
+    auto &S = SecI->second;
+
+    uint64_t Offset = Sym.st_value;
+    if (Offset > S.Size)
+      return make_error<JITLinkError>("Symbol " + *Name +
+                                      " is outside its section");
+
+    // Section symbols, and symbols at the end of their section, refer into
+    // atoms defined by other symbols. They are resolved once all atoms exist.
+    PendingSymbols.push_back({SymIndex, {&S, Offset}});
+    if (Sym.getType() == ELF::STT_SECTION || Offset == S.Size)
+      return Error::success();
+
+    if (S.Atoms.count(Offset)) {
+      // Locals may share an atom with another definition. Globals can't:
+      // each named atom must have its own address.
+      // FIXME: Support aliases (e.g. C++ constructor aliases).
+      if (!IsLocal)
+        return make_error<JITLinkError>("Symbol " + *Name +
+                                        " aliases another definition");
+      return Error::success();
+    }
+
+    JITTargetAddress Addr = S.Address + Offset;
+    uint32_t Align = getAtomAlignment(S, Offset);
+
+    // Locals keep their names where that doesn't clash with another symbol,
+    // so that GOT and stub entries (which are keyed by name) can refer to
+    // them.
+    if (!IsLocal && hasAtomNamed(*Name))
+      return make_error<JITLinkError>("Duplicate definition within object: " +
+                                      *Name);
+    DefinedAtom *DA = nullptr;
+    if (!Name->empty() && !hasAtomNamed(*Name))
+      DA = &G->addDefinedAtom(*S.GenericSection, *Name, Addr, Align);
+    else
+      DA = &G->addAnonymousAtom(*S.GenericSection, Addr, Align);
+
+    DA->setGlobal(!IsLocal);
+    DA->setExported(!IsLocal && Sym.getVisibility() != ELF::STV_HIDDEN &&
+                    Sym.getVisibility() != ELF::STV_INTERNAL);
+    DA->setWeak(Sym.getBinding() == ELF::STB_WEAK);
+    DA->setCallable(Sym.getType() == ELF::STT_FUNC);
+
+    LLVM_DEBUG({
+      dbgs() << "  Added " << *DA << " addr: " << format("0x%016" PRIx64, Addr)
+             << ", align: " << Align
+             << ", section: " << S.GenericSection->getName() << "\n";
+    });
+
+    S.Atoms[Offset] = DA;
+    return Error::success();
+  }
+
+  Error addAtoms() {
+    if (SymTab) {
+      auto Syms = Obj.symbols(SymTab);
+      if (!Syms)
+        return Syms.takeError();
+      auto StrTab = Obj.getStringTableForSymtab(*SymTab);
+      if (!StrTab)
+        return StrTab.takeError();
+
+      SymbolTargets.resize(Syms->size());
+
+      // Add non-local symbols first so that their names take precedence over
+      // those of locals. Symbol zero is always the null symbol.
+      for (bool Locals : {false, true})
+        for (unsigned SymIndex = 1; SymIndex < Syms->size(); ++SymIndex) {
+          auto &Sym = (*Syms)[SymIndex];
+          if ((Sym.getBinding() == ELF::STB_LOCAL) != Locals)
+            continue;
+          if (auto Err = addSymbol(Sym, SymIndex, *StrTab, *Syms))
+            return Err;
+        }
+    }
+
+    for (auto &KV : Sections) {
+      auto &S = KV.second;
+
+      // Cover the start of the section (and so the whole section) with an
+      // anonymous atom if no symbol is defined there.
+      if (!S.Atoms.count(0))
+        S.Atoms[0] = &G->addAnonymousAtom(*S.GenericSection, S.Address,
+                                          S.Alignment);
+
+      // Set atom contents, then chain the atoms in address order.
+      uint64_t End = S.Size;
+      DefinedAtom *Next = nullptr;
+      for (auto I = S.Atoms.rbegin(), E = S.Atoms.rend(); I != E; ++I) {
+        auto &A = *I->second;
+        if (S.GenericSection->isZeroFill())
+          A.setZeroFill(End - I->first);
+        else
+          A.setContent(S.Content.substr(I->first, End - I->first));
+        if (Next)
+          A.setLayoutNext(*Next);
+        Next = &A;
+        End = I->first;
+      }
+    }
+
+    for (auto &P : PendingSymbols) {
+      auto &Target = SymbolTargets[P.first];
+      uint64_t AtomOffset = 0;
+      Target.A = findAtomCovering(*P.second.first, P.second.second, AtomOffset);
+      assert(Target.A && "Every section offset should be covered by an atom");
+      Target.Offset = P.second.second - AtomOffset;
+    }
+
+    return Error::success();
+  }
+
+  Error addRelocations() {
+    for (auto *RelSec : RelocationSections) {
+      auto SecI = Sections.find(RelSec->sh_info);
+      if (SecI == Sections.end())
+        continue;
+      auto &S = SecI->second;
+
+      if (RelSec->sh_type == ELF::SHT_REL)
+        return make_error<JITLinkError>(
+            "SHT_REL relocations are not supported on x86-64");
+
+      if (S.GenericSection->isZeroFill())
+        return make_error<JITLinkError>("Relocations in zero-fill section " +
+                                        S.GenericSection->getName());
+
+      auto Relas = Obj.relas(RelSec);
+      if (!Relas)
+        return Relas.takeError();
+
+      for (const ELFT::Rela &R : *Relas) {
+        uint32_t Type = R.getType(false);
+        if (Type == ELF::R_X86_64_NONE)
+          continue;
+
+        auto Kind = getRelocationKind(Type);
+        if (!Kind)
+          return Kind.takeError();
+
+        if (R.r_offset + getFixupSize(*Kind) > S.Size)
+          return make_error<JITLinkError>(
+              "Relocation content extends past end of section");
+
+        uint64_t AtomOffset = 0;
+        DefinedAtom *AtomToFix = findAtomCovering(S, R.r_offset, AtomOffset);
+        assert(AtomToFix && "Relocation is not covered by an atom");
+
+        uint32_t SymIndex = R.getSymbol(false);
+        if (SymIndex >= SymbolTargets.size() || !SymbolTargets[SymIndex].A)
+          return make_error<JITLinkError>(
+              "Relocation at " + formatv("{0:x8}", R.r_offset) + " in " +
+              S.GenericSection->getName() +
+              " refers to a symbol outside linked sections");
+        auto &Target = SymbolTargets[SymIndex];
+
+        // GOT entries are created per symbol, so GOT references need the
+        // symbol's own named atom.
+        if (*Kind == PCRel32GOTLoad &&
+            (!Target.A->hasName() || Target.Offset != 0))
+          return make_error<JITLinkError>(
+              "GOT reference to an anonymous symbol is not supported");
+
+        int64_t Addend = R.r_addend + Target.Offset;
+        Edge::OffsetT EdgeOffset = R.r_offset - AtomOffset;
+
+        LLVM_DEBUG({
+          Edge GE(*Kind, EdgeOffset, *Target.A, Addend);
+          printEdge(dbgs(), *AtomToFix, GE,
+                    getELFX86RelocationKindName(*Kind));
+          dbgs() << "\n";
+        });
+        AtomToFix->addEdge(*Kind, EdgeOffset, *Target.A, Addend);
+      }
+    }
+    return Error::success();
+  }
+
+  const object::ELFFile<ELFT> &Obj;
+  std::unique_ptr<AtomGraph> G;
+  const ELFT::Shdr *SymTab = nullptr;
+  ArrayRef<ELFT::Word> ShndxTable;
+  std::vector<const ELFT::Shdr *> RelocationSections;
+  std::map<unsigned, ELFSection> Sections;
+  Section *CommonSection = nullptr;
+  std::vector<SymbolTarget> SymbolTargets;
+  std::vector<std::pair<unsigned, std::pair<ELFSection *, uint64_t>>>
+      PendingSymbols;
+};
+
+class ELF_x86_64_GOTAndStubsBuilder
+    : public BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder> {
+public:
+  ELF_x86_64_GOTAndStubsBuilder(AtomGraph &G)
+      : BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder>(G) {}
+
+  bool isGOTEdge(Edge &E) const { return E.getKind() == PCRel32GOTLoad; }
+
+  DefinedAtom &createGOTEntry(Atom &Target) {
+    auto &GOTEntryAtom = G.addAnonymousAtom(getGOTSection(), 0x0, 8);
+    GOTEntryAtom.setContent(
+        StringRef(reinterpret_cast<const char *>(NullGOTEntryContent), 8));
+    GOTEntryAtom.addEdge(Pointer64, 0, Target, 0);
+    return GOTEntryAtom;
+  }
+
+  void fixGOTEdge(Edge &E, Atom &GOTEntry) {
+    assert(E.getKind() == PCRel32GOTLoad && "Not a GOT edge?");
+    E.setKind(PCRel32);
+    E.setTarget(GOTEntry);
+    // Leave the edge addend as-is.
+  }
+
+  bool isExternalBranchEdge(Edge &E) {
+    return E.getKind() == Branch32 && !E.getTarget().isDefined();
+  }
+
+  DefinedAtom &createStub(Atom &Target) {
+    auto &StubAtom = G.addAnonymousAtom(getStubsSection(), 0x0, 2);
+    StubAtom.setContent(
+        StringRef(reinterpret_cast<const char *>(StubContent), 6));
+
+    // Re-use GOT entries for stub targets. The jmp's displacement is relative
+    // to the end of the instruction, 4 bytes past the fixup.
+    auto &GOTEntryAtom = getGOTEntryAtom(Target);
+    StubAtom.addEdge(PCRel32, 2, GOTEntryAtom, -4);
+
+    return StubAtom;
+  }
+
+  void fixExternalBranchEdge(Edge &E, Atom &Stub) {
+    assert(E.getKind() == Branch32 && "Not a Branch32 edge?");
+    E.setTarget(Stub);
+  }
+
+private:
+  Section &getGOTSection() {
+    if (!GOTSection)
+      GOTSection = &G.createSection("$__GOT", 8, sys::Memory::MF_READ, false);
+    return *GOTSection;
+  }
+
+  Section &getStubsSection() {
+    if (!StubsSection) {
+      auto StubsProt = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+      StubsSection = &G.createSection("$__STUBS", 8, StubsProt, false);
+    }
+    return *StubsSection;
+  }
+
+  static const uint8_t NullGOTEntryContent[8];
+  static const uint8_t StubContent[6];
+  Section *GOTSection = nullptr;
+  Section *StubsSection = nullptr;
+};
+
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::NullGOTEntryContent[8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::StubContent[6] = {
+    0xFF, 0x25, 0x00, 0x00, 0x00, 0x00};
+} // namespace
+
+namespace llvm {
+namespace jitlink {
+
+class ELFJITLinker_x86_64 : public JITLinker<ELFJITLinker_x86_64> {
+  friend class JITLinker<ELFJITLinker_x86_64>;
+
+public:
+  ELFJITLinker_x86_64(std::unique_ptr<JITLinkContext> Ctx,
+                      PassConfiguration PassConfig)
+      : JITLinker(std::move(Ctx), std::move(PassConfig)) {}
+
+private:
+  StringRef getEdgeKindName(Edge::Kind R) const override {
+    return getELFX86RelocationKindName(R);
+  }
+
+  Expected<std::unique_ptr<AtomGraph>>
+  buildGraph(MemoryBufferRef ObjBuffer) override {
+    auto ELFObj =
+        object::ELFFile<object::ELF64LE>::create(ObjBuffer.getBuffer());
+    if (!ELFObj)
+      return ELFObj.takeError();
+    return ELFAtomGraphBuilder_x86_64(ObjBuffer.getBufferIdentifier(), *ELFObj)
+        .buildGraph();
+  }
+
+  static Error targetOutOfRangeError(const Atom &A, const Edge &E) {
+    std::string ErrMsg;
+    {
+      raw_string_ostream ErrStream(ErrMsg);
+      ErrStream << "Relocation target out of range: ";
+      printEdge(ErrStream, A, E, getELFX86RelocationKindName(E.getKind()));
+      ErrStream << "\n";
+    }
+    return make_error<JITLinkError>(std::move(ErrMsg));
+  }
+
+  Error applyFixup(DefinedAtom &A, const Edge &E, char *AtomWorkingMem) const {
+    using namespace support;
+
+    char *FixupPtr = AtomWorkingMem + E.getOffset();
+    JITTargetAddress FixupAddress = A.getAddress() + E.getOffset();
+
+    switch (E.getKind()) {
+    case Branch32:
+    case PCRel32: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(A, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer64: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      *(ulittle64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value > std::numeric_limits<uint32_t>::max())
+        return targetOutOfRangeError(A, E);
+      *(ulittle32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32Signed: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(A, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case Delta64: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      *(little64_t *)FixupPtr = Value;
+      break;
+    }
+    default:
+      llvm_unreachable("Unrecognized edge kind");
+    }
+
+    return Error::success();
+  }
+};
+
+void jitLink_ELF_x86_64(std::unique_ptr<JITLinkContext> Ctx) {
+  PassConfiguration Config;
+  Triple TT("x86_64-unknown-linux");
+
+  if (Ctx->shouldAddDefaultTargetPasses(TT)) {
+    // Add a mark-live pass.
+    if (auto MarkLive = Ctx->getMarkLivePass(TT))
+      Config.PrePrunePasses.push_back(std::move(MarkLive));
+    else
+      Config.PrePrunePasses.push_back(markAllAtomsLive);
+
+    // Add an in-place GOT/Stubs pass.
+    Config.PostPrunePasses.push_back([](AtomGraph &G) -> Error {
+      ELF_x86_64_GOTAndStubsBuilder(G).run();
+      return Error::success();
+    });
+  }
+
+  if (auto Err = Ctx->modifyPassConfig(TT, Config))
+    return Ctx->notifyFailed(std::move(Err));
+
+  // Construct a JITLinker and run the link function.
+  ELFJITLinker_x86_64::link(std::move(Ctx), std::move(Config));
+}
+
+StringRef getELFX86RelocationKindName(Edge::Kind R) {
+  switch (R) {
+  case Branch32:
+    return "Branch32";
+  case Pointer32:
+    return "Pointer32";
+  case Pointer32Signed:
+    return "Pointer32Signed";
+  case Pointer64:
+    return "Pointer64";
+  case PCRel32:
+    return "PCRel32";
+  case PCRel32GOTLoad:
+    return "PCRel32GOTLoad";
+  case Delta64:
+    return "Delta64";
+  default:
+    return getGenericEdgeKindName(static_cast<Edge::Kind>(R));
+  }
+}
+
+} // end namespace jitlink
+} // end namespace llvm
@@ -101,5 +101,178 @@ InProcessMemoryManager::allocate(const SegmentsRequestMap &Request) {
       new IPMMAlloc(std::move(Blocks)));
 }
 
+class InProcessSlabMemoryManager::SlabAllocation : public Allocation {
+public:
+  using SegmentMap = DenseMap<unsigned, sys::MemoryBlock>;
+
+  SlabAllocation(InProcessSlabMemoryManager &Parent, sys::MemoryBlock Block,
+                 SegmentMap SegBlocks)
+      : Parent(Parent), Block(Block), SegBlocks(std::move(SegBlocks)) {}
+
+  MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+    assert(SegBlocks.count(Seg) && "No allocation for segment");
+    return {static_cast<char *>(SegBlocks[Seg].base()),
+            SegBlocks[Seg].allocatedSize()};
+  }
+
+  JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+    assert(SegBlocks.count(Seg) && "No allocation for segment");
+    return reinterpret_cast<JITTargetAddress>(SegBlocks[Seg].base());
+  }
+
+  void finalizeAsync(FinalizeContinuation OnFinalize) override {
+    OnFinalize(applyProtections());
+  }
+
+  Error deallocate() override { return Parent.release(Block); }
+
+private:
+  Error applyProtections() {
+    for (auto &KV : SegBlocks) {
+      auto Prot = static_cast<sys::Memory::ProtectionFlags>(KV.first);
+      auto &SegBlock = KV.second;
+      if (auto EC = sys::Memory::protectMappedMemory(SegBlock, Prot))
+        return errorCodeToError(EC);
+      if (Prot & sys::Memory::MF_EXEC)
+        sys::Memory::InvalidateInstructionCache(SegBlock.base(),
+                                                SegBlock.allocatedSize());
+    }
+    return Error::success();
+  }
+
+  InProcessSlabMemoryManager &Parent;
+  sys::MemoryBlock Block;
+  SegmentMap SegBlocks;
+};
+
+Expected<std::unique_ptr<InProcessSlabMemoryManager>>
+InProcessSlabMemoryManager::Create(uint64_t SlabSize) {
+  SlabSize = alignTo(SlabSize, sys::Process::getPageSizeEstimate());
+  if (SlabSize > (1ULL << 31))
+    return make_error<StringError>("Slab size exceeds 2Gb",
+                                   inconvertibleErrorCode());
+
+  std::error_code EC;
+  auto Slab = sys::Memory::allocateMappedMemory(
+      SlabSize, nullptr, sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC)
+    return errorCodeToError(EC);
+
+  return std::unique_ptr<InProcessSlabMemoryManager>(
+      new InProcessSlabMemoryManager(Slab));
+}
+
+InProcessSlabMemoryManager::InProcessSlabMemoryManager(sys::MemoryBlock Slab)
+    : Slab(Slab) {
+  FreeRanges[static_cast<char *>(Slab.base())] = Slab.allocatedSize();
+}
+
+InProcessSlabMemoryManager::~InProcessSlabMemoryManager() {
+  sys::Memory::releaseMappedMemory(Slab);
+}
+
+Expected<std::unique_ptr<JITLinkMemoryManager::Allocation>>
+InProcessSlabMemoryManager::allocate(const SegmentsRequestMap &Request) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+
+  // Lay the segments out back to back, each starting on a page boundary so
+  // that it can be given its own protections, and reserve them as one block.
+  DenseMap<unsigned, std::pair<uint64_t, uint64_t>> SegOffsets;
+  uint64_t TotalSize = 0;
+  for (auto &KV : Request) {
+    auto &Seg = KV.second;
+
+    if (Seg.getContentAlignment() > PageSize)
+      return make_error<StringError>("Cannot request higher than page "
+                                     "alignment",
+                                     inconvertibleErrorCode());
+
+    if (PageSize % Seg.getContentAlignment() != 0)
+      return make_error<StringError>("Page size is not a multiple of "
+                                     "alignment",
+                                     inconvertibleErrorCode());
+
+    uint64_t ZeroFillStart =
+        alignTo(Seg.getContentSize(), Seg.getZeroFillAlignment());
+    uint64_t SegmentSize = ZeroFillStart + Seg.getZeroFillSize();
+    SegOffsets[KV.first] = {TotalSize, SegmentSize};
+    TotalSize += alignTo(SegmentSize, PageSize);
+  }
+
+  auto Block = reserve(TotalSize);
+  if (!Block)
+    return Block.takeError();
+
+  SlabAllocation::SegmentMap SegBlocks;
+  char *Base = static_cast<char *>(Block->base());
+  for (auto &KV : Request) {
+    auto &Seg = KV.second;
+    uint64_t Offset = SegOffsets[KV.first].first;
+    uint64_t SegmentSize = SegOffsets[KV.first].second;
+
+    // Memory in the slab may have been used by an earlier allocation, so the
+    // zero-fill part has to be cleared explicitly.
+    uint64_t ZeroFillStart =
+        alignTo(Seg.getContentSize(), Seg.getZeroFillAlignment());
+    memset(Base + Offset + ZeroFillStart, 0, Seg.getZeroFillSize());
+
+    SegBlocks[KV.first] = sys::MemoryBlock(Base + Offset, SegmentSize);
+  }
+
+  return std::unique_ptr<JITLinkMemoryManager::Allocation>(
+      new SlabAllocation(*this, *Block, std::move(SegBlocks)));
+}
+
+Expected<sys::MemoryBlock> InProcessSlabMemoryManager::reserve(uint64_t Size) {
+  std::lock_guard<std::mutex> Lock(FreeRangesMutex);
+
+  // First fit: allocations are usually short-lived or few, so this keeps
+  // the slab compact without any size classes.
+  for (auto I = FreeRanges.begin(), E = FreeRanges.end(); I != E; ++I) {
+    if (I->second < Size)
+      continue;
+    char *Start = I->first;
+    uint64_t Remaining = I->second - Size;
+    FreeRanges.erase(I);
+    if (Remaining)
+      FreeRanges[Start + Size] = Remaining;
+    return sys::MemoryBlock(Start, Size);
+  }
+
+  return make_error<StringError>("Slab memory exhausted",
+                                 inconvertibleErrorCode());
+}
+
+Error InProcessSlabMemoryManager::release(sys::MemoryBlock Block) {
+  // Make the range writable again so that the next allocation using it can
+  // fill it in.
+  if (auto EC = sys::Memory::protectMappedMemory(
+          Block, sys::Memory::MF_READ | sys::Memory::MF_WRITE))
+    return errorCodeToError(EC);
+
+  std::lock_guard<std::mutex> Lock(FreeRangesMutex);
+  char *Start = static_cast<char *>(Block.base());
+  uint64_t Size = Block.allocatedSize();
+
+  // Coalesce with the following free range.
+  auto Next = FreeRanges.lower_bound(Start);
+  if (Next != FreeRanges.end() && Next->first == Start + Size) {
+    Size += Next->second;
+    Next = FreeRanges.erase(Next);
+  }
+
+  // Coalesce with the preceding free range.
+  if (Next != FreeRanges.begin()) {
+    auto Prev = std::prev(Next);
+    if (Prev->first + Prev->second == Start) {
+      Prev->second += Size;
+      return Error::success();
+    }
+  }
+
+  FreeRanges[Start] = Size;
+  return Error::success();
+}
+
 } // end namespace jitlink
 } // end namespace llvm
@@ -1366,7 +1366,8 @@ JITDylib::legacyLookup(std::shared_ptr<AsynchronousSymbolQuery> Q,
   {
     std::lock_guard<std::recursive_mutex> Lock(ES.OutstandingMUsMutex);
     for (auto &MU : MUs)
-      ES.OutstandingMUs.push_back(make_pair(this, std::move(MU)));
+      ES.OutstandingMUs.push_back(
+          {this, std::move(MU), MaterializationPriority::OnDemand});
   }
   ES.runOutstandingMUs();
 
@@ -1738,7 +1739,8 @@ Expected<SymbolMap> ExecutionSession::legacyLookup(
 void ExecutionSession::lookup(
     const JITDylibSearchList &SearchOrder, SymbolNameSet Symbols,
     SymbolState RequiredState, SymbolsResolvedCallback NotifyComplete,
-    RegisterDependenciesFunction RegisterDependencies) {
+    RegisterDependenciesFunction RegisterDependencies,
+    MaterializationPriority Priority) {
 
   LLVM_DEBUG({
     runSessionLocked([&]() {
@@ -1820,7 +1822,7 @@ void ExecutionSession::lookup(
 
     for (auto &KV : CollectedMUsMap)
       for (auto &MU : KV.second)
-        OutstandingMUs.push_back(std::make_pair(KV.first, std::move(MU)));
+        OutstandingMUs.push_back({KV.first, std::move(MU), Priority});
   }
 
   runOutstandingMUs();
@@ -1921,20 +1923,27 @@ void ExecutionSession::dump(raw_ostream &OS) {
 
 void ExecutionSession::runOutstandingMUs() {
   while (1) {
-    std::pair<JITDylib *, std::unique_ptr<MaterializationUnit>> JITDylibAndMU;
+    OutstandingMU Next = {nullptr, nullptr, MaterializationPriority::OnDemand};
 
     {
       std::lock_guard<std::recursive_mutex> Lock(OutstandingMUsMutex);
       if (!OutstandingMUs.empty()) {
-        JITDylibAndMU = std::move(OutstandingMUs.back());
-        OutstandingMUs.pop_back();
+        // Dispatch the most recent on-demand MU first, then speculative ones.
+        auto I = std::find_if(OutstandingMUs.rbegin(), OutstandingMUs.rend(),
+                              [](const OutstandingMU &O) {
+                                return O.Priority ==
+                                       MaterializationPriority::OnDemand;
+                              });
+        auto Pos = I == OutstandingMUs.rend() ? std::prev(OutstandingMUs.end())
+                                              : std::prev(I.base());
+        Next = std::move(*Pos);
+        OutstandingMUs.erase(Pos);
       }
     }
 
-    if (JITDylibAndMU.first) {
-      assert(JITDylibAndMU.second && "JITDylib, but no MU?");
-      dispatchMaterialization(*JITDylibAndMU.first,
-                              std::move(JITDylibAndMU.second));
+    if (Next.JD) {
+      assert(Next.MU && "JITDylib, but no MU?");
+      dispatchMaterialization(*Next.JD, std::move(Next.MU), Next.Priority);
     } else
       break;
   }
@@ -92,13 +92,13 @@ LLJIT::createCompileFunction(LLJITBuilderState &S,
   // Otherwise default to creating a SimpleCompiler, or ConcurrentIRCompiler,
   // depending on the number of threads requested.
   if (S.NumCompileThreads > 0)
-    return ConcurrentIRCompiler(std::move(JTMB));
+    return ConcurrentIRCompiler(std::move(JTMB), S.ObjCache);
 
   auto TM = JTMB.createTargetMachine();
   if (!TM)
     return TM.takeError();
 
-  return TMOwningSimpleCompiler(std::move(*TM));
+  return TMOwningSimpleCompiler(std::move(*TM), S.ObjCache);
 }
 
 LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
@@ -130,16 +130,44 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
   if (S.NumCompileThreads > 0) {
     CompileLayer->setCloneToNewContextOnEmit(true);
     CompileThreads = std::make_unique<ThreadPool>(S.NumCompileThreads);
-    ES->setDispatchMaterialization(
-        [this](JITDylib &JD, std::unique_ptr<MaterializationUnit> MU) {
-          // FIXME: Switch to move capture once we have c++14.
-          auto SharedMU = std::shared_ptr<MaterializationUnit>(std::move(MU));
-          auto Work = [SharedMU, &JD]() { SharedMU->doMaterialize(JD); };
-          CompileThreads->async(std::move(Work));
+    ES->setPrioritizedDispatchMaterialization(
+        [this](JITDylib &JD, std::unique_ptr<MaterializationUnit> MU,
+               MaterializationPriority Priority) {
+          dispatchToCompileThreads(JD, std::move(MU), Priority);
         });
   }
 }
 
+void LLJIT::dispatchToCompileThreads(JITDylib &JD,
+                                     std::unique_ptr<MaterializationUnit> MU,
+                                     MaterializationPriority Priority) {
+  {
+    std::lock_guard<std::mutex> Lock(QueuedMUsMutex);
+    QueuedMUs[static_cast<unsigned>(Priority)].emplace_back(&JD,
+                                                            std::move(MU));
+  }
+  // Every task runs whichever materialization is most urgent when it starts,
+  // not necessarily the one queued along with it.
+  CompileThreads->async([this]() { runQueuedMaterialization(); });
+}
+
+void LLJIT::runQueuedMaterialization() {
+  std::pair<JITDylib *, std::unique_ptr<MaterializationUnit>> Next;
+  {
+    std::lock_guard<std::mutex> Lock(QueuedMUsMutex);
+    // The queues are indexed by priority, so look at the most urgent first.
+    for (auto &Queue : llvm::reverse(QueuedMUs)) {
+      if (Queue.empty())
+        continue;
+      Next = std::move(Queue.front());
+      Queue.pop_front();
+      break;
+    }
+  }
+  assert(Next.first && "More compile tasks than queued materializations");
+  Next.second->doMaterialize(*Next.first);
+}
+
 std::string LLJIT::mangle(StringRef UnmangledName) {
   std::string MangledName;
   {
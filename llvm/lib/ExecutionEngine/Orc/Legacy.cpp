@@ -19,9 +19,7 @@ JITSymbolResolverAdapter::JITSymbolResolverAdapter(
 
 void JITSymbolResolverAdapter::lookup(const LookupSet &Symbols,
                                       OnResolvedFunction OnResolved) {
-  SymbolNameSet InternedSymbols;
-  for (auto &S : Symbols)
-    InternedSymbols.insert(ES.intern(S));
+  SymbolNameSet InternedSymbols = ES.internAll(Symbols);
 
   auto OnResolvedWithUnwrap = [OnResolved](Expected<SymbolMap> InternedResult) {
     if (!InternedResult) {
@@ -48,9 +46,7 @@ void JITSymbolResolverAdapter::lookup(const LookupSet &Symbols,
 
 Expected<JITSymbolResolverAdapter::LookupSet>
 JITSymbolResolverAdapter::getResponsibilitySet(const LookupSet &Symbols) {
-  SymbolNameSet InternedSymbols;
-  for (auto &S : Symbols)
-    InternedSymbols.insert(ES.intern(S));
+  SymbolNameSet InternedSymbols = ES.internAll(Symbols);
 
   auto InternedResult = R.getResponsibilitySet(InternedSymbols);
   LookupSet Result;
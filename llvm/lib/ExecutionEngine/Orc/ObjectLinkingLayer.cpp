@@ -49,9 +49,7 @@ public:
 
     auto &ES = Layer.getExecutionSession();
 
-    SymbolNameSet InternedSymbols;
-    for (auto &S : Symbols)
-      InternedSymbols.insert(ES.intern(S));
+    SymbolNameSet InternedSymbols = ES.internAll(Symbols);
 
     // OnResolve -- De-intern the symbols and pass the result to the linker.
     // FIXME: Capture LookupContinuation by move once we have c++14.
@@ -0,0 +1,155 @@
+//===- PersistentObjectCache.cpp - On-disk object cache for ORC -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/VCSRevision.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace orc {
+
+// Describe everything in JTMB that affects the generated code.
+static std::string computeTargetKey(const JITTargetMachineBuilder &JTMB) {
+  std::string Key;
+  raw_string_ostream OS(Key);
+  OS << JTMB.getTargetTriple().str() << '\0' << JTMB.getCPU() << '\0'
+     << JTMB.getFeatures().getString() << '\0';
+  OS << (JTMB.getRelocationModel() ? int(*JTMB.getRelocationModel()) : -1)
+     << ',' << (JTMB.getCodeModel() ? int(*JTMB.getCodeModel()) : -1) << ','
+     << int(JTMB.getCodeGenOptLevel()) << '\0';
+  // FIXME: Hash more of Options. Like the LTO cache, this covers the options
+  // that JIT clients are known to change.
+  const TargetOptions &Options = JTMB.getOptions();
+  OS << Options.RelaxELFRelocations << Options.FunctionSections
+     << Options.DataSections << Options.EmulatedTLS
+     << Options.ExplicitEmulatedTLS
+     << int(Options.DebuggerTuning) << int(Options.ExceptionModel)
+     << int(Options.FloatABIType) << int(Options.AllowFPOpFusion)
+     << Options.UnsafeFPMath << Options.NoInfsFPMath << Options.NoNaNsFPMath
+     << Options.NoSignedZerosFPMath << Options.NoTrappingFPMath;
+  return OS.str();
+}
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(StringRef CacheDir,
+                              const JITTargetMachineBuilder &JTMB,
+                              CachePruningPolicy Policy) {
+  if (std::error_code EC = sys::fs::create_directories(CacheDir))
+    return createFileError(CacheDir, EC);
+  std::unique_ptr<PersistentObjectCache> Cache(new PersistentObjectCache(
+      CacheDir.str(), computeTargetKey(JTMB), std::move(Policy)));
+  Cache->prune();
+  return std::move(Cache);
+}
+
+PersistentObjectCache::PersistentObjectCache(std::string CacheDir,
+                                             std::string TargetKey,
+                                             CachePruningPolicy Policy)
+    : CacheDir(std::move(CacheDir)), TargetKey(std::move(TargetKey)),
+      Policy(std::move(Policy)) {}
+
+std::string PersistentObjectCache::getEntryPath(const Module &M) const {
+  SHA1 Hasher;
+  Hasher.update(LLVM_VERSION_STRING);
+#ifdef LLVM_REVISION
+  Hasher.update(LLVM_REVISION);
+#endif
+  Hasher.update(TargetKey);
+
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+  }
+  Hasher.update(
+      ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(Bitcode.data()),
+                        Bitcode.size()));
+
+  // pruneCache() only considers the files named llvmcache-*.
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, "llvmcache-" + toHex(Hasher.result()));
+  return Path.str();
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getEntryPath(*M);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(EntryPath, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+
+  std::lock_guard<std::mutex> Lock(PendingEntriesMutex);
+  if (BufOrErr) {
+    PendingEntries.erase(M);
+    return std::move(*BufOrErr);
+  }
+  // A miss is followed by a compile and a call to notifyObjectCompiled.
+  PendingEntries[M] = std::move(EntryPath);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string EntryPath;
+  {
+    std::lock_guard<std::mutex> Lock(PendingEntriesMutex);
+    auto I = PendingEntries.find(M);
+    if (I != PendingEntries.end()) {
+      EntryPath = std::move(I->second);
+      PendingEntries.erase(I);
+    }
+  }
+  if (EntryPath.empty())
+    EntryPath = getEntryPath(*M);
+
+  // The cache is best effort: failing to store an object only costs a compile
+  // in a later process. Write to a temporary and rename it into place so that
+  // concurrent processes never see a partial entry.
+  SmallString<128> TempModel(CacheDir);
+  sys::path::append(TempModel, "llvm-obj-%%%%%%.tmp");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(TempModel);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Obj.getBuffer();
+    OS.flush();
+    if (OS.has_error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return;
+    }
+  }
+  if (Error E = Temp->keep(EntryPath)) {
+    consumeError(std::move(E));
+    return;
+  }
+  prune();
+}
+
+void PersistentObjectCache::prune() {
+  // pruneCache() returns early unless Policy.Interval has passed since the
+  // last prune, so it's cheap to call after every new entry.
+  std::lock_guard<std::mutex> Lock(PruneMutex);
+  pruneCache(CacheDir, Policy);
+}
+
+} // end namespace orc
+} // end namespace llvm
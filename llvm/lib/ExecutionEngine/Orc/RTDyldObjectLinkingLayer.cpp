@@ -19,11 +19,9 @@ public:
 
   void lookup(const LookupSet &Symbols, OnResolvedFunction OnResolved) {
     auto &ES = MR.getTargetJITDylib().getExecutionSession();
-    SymbolNameSet InternedSymbols;
 
     // Intern the requested symbols: lookup takes interned strings.
-    for (auto &S : Symbols)
-      InternedSymbols.insert(ES.intern(S));
+    SymbolNameSet InternedSymbols = ES.internAll(Symbols);
 
     // Build an OnResolve callback to unwrap the interned strings and pass them
     // to the OnResolved callback.
@@ -0,0 +1,320 @@
+//===--- TieredCompileLayer.cpp - Recompile hot functions -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompileLayer.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Module.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+/// Returns true if F's body can be moved out into a tier-0 function.
+static bool isTierable(const Function &F) {
+  if (F.isDeclaration() || F.hasFnAttribute(Attribute::Naked))
+    return false;
+  // Block addresses can not follow the blocks into a new function.
+  for (auto &BB : F)
+    if (BB.hasAddressTaken())
+      return false;
+  return true;
+}
+
+/// Moves the body of F into a new hidden function and leaves F behind as a
+/// declaration, so that every call to F in the module (including recursive
+/// ones) goes through F's stub.
+static Function *splitOffBody(Function &F) {
+  auto *Body =
+      Function::Create(F.getFunctionType(), GlobalValue::ExternalLinkage,
+                       F.getAddressSpace(), F.getName() + "$tier0",
+                       F.getParent());
+  Body->copyAttributesFrom(&F);
+  Body->setLinkage(GlobalValue::ExternalLinkage);
+  Body->setVisibility(GlobalValue::HiddenVisibility);
+  Body->setComdat(nullptr);
+
+  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+  F.getAllMetadata(MDs);
+  for (auto &MD : MDs)
+    Body->setMetadata(MD.first, MD.second);
+  F.clearMetadata();
+
+  Body->getBasicBlockList().splice(Body->end(), F.getBasicBlockList());
+  for (auto ArgI = F.arg_begin(), ArgE = F.arg_end(),
+            BodyArgI = Body->arg_begin();
+       ArgI != ArgE; ++ArgI, ++BodyArgI) {
+    BodyArgI->takeName(&*ArgI);
+    ArgI->replaceAllUsesWith(&*BodyArgI);
+  }
+
+  F.setLinkage(GlobalValue::ExternalLinkage);
+  F.setComdat(nullptr);
+  F.setPersonalityFn(nullptr);
+  F.setPrefixData(nullptr);
+  F.setPrologueData(nullptr);
+  return Body;
+}
+
+TieredCompileLayer::TieredCompileLayer(
+    ExecutionSession &ES, IRLayer &BaseLayer, IRLayer &OptimizingLayer,
+    IndirectStubsManagerBuilder BuildIndirectStubsManager,
+    uint64_t HotCallThreshold)
+    : IRLayer(ES), BaseLayer(BaseLayer), OptimizingLayer(OptimizingLayer),
+      BuildIndirectStubsManager(std::move(BuildIndirectStubsManager)),
+      HotCallThreshold(HotCallThreshold) {
+  assert(HotCallThreshold > 0 && "Hot call threshold must be non-zero");
+}
+
+void TieredCompileLayer::emit(MaterializationResponsibility R,
+                              ThreadSafeModule TSM) {
+  assert(TSM && "Null module");
+
+  auto &ES = getExecutionSession();
+  PerDylibResources *PDR;
+  {
+    std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+    PDR = &getPerDylibResources(R.getTargetJITDylib());
+  }
+
+  TSM.withModuleDo([&](Module &M) {
+    for (auto &F : M.functions())
+      if (F.hasAvailableExternallyLinkage()) {
+        F.deleteBody();
+        F.setPersonalityFn(nullptr);
+      }
+    // Tier-1 bodies are compiled in modules of their own, so anything they
+    // may reference has to be visible across modules.
+    PromoteSymbols(M);
+  });
+
+  // Keep an uninstrumented copy of the module to clone hot functions from.
+  auto Source = std::make_shared<ThreadSafeModule>(cloneToNewContext(TSM));
+
+  // Move every tierable function body out into an instrumented tier-0
+  // function. Maps each tier-0 body's name to the stub that should reach it.
+  SymbolFlagsMap Tiered;
+  std::map<SymbolStringPtr, SymbolStringPtr> Tier0ToStub;
+  TSM.withModuleDo([&](Module &M) {
+    MangleAndInterner Mangle(ES, M.getDataLayout());
+    const auto &Symbols = R.getSymbols();
+
+    std::vector<Function *> Worklist;
+    for (auto &F : M.functions()) {
+      auto I = Symbols.find(Mangle(F.getName()));
+      if (I != Symbols.end() && I->second.isCallable() && isTierable(F))
+        Worklist.push_back(&F);
+    }
+
+    std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+    for (auto *F : Worklist) {
+      auto Name = Mangle(F->getName());
+      uint64_t Id = TieredFunctions.size();
+      TieredFunctions.push_back({PDR, Name, F->getName(), Source});
+
+      auto *Body = splitOffBody(*F);
+      instrumentFunction(*Body, Id);
+
+      Tiered[Name] = Symbols.find(Name)->second;
+      Tier0ToStub[Mangle(Body->getName())] = Name;
+    }
+  });
+
+  if (auto Err = BaseLayer.add(PDR->getTier0Dylib(), std::move(TSM),
+                               R.getVModuleKey())) {
+    ES.reportError(std::move(Err));
+    R.failMaterialization();
+    return;
+  }
+
+  // Everything we did not split off keeps its definition in the tier-0 dylib.
+  SymbolAliasMap ReExported;
+  for (auto &KV : R.getSymbols())
+    if (!Tiered.count(KV.first))
+      ReExported[KV.first] = SymbolAliasMapEntry(KV.first, KV.second);
+  if (!ReExported.empty())
+    R.replace(reexports(PDR->getTier0Dylib(), std::move(ReExported), true));
+
+  if (Tiered.empty())
+    return;
+
+  // Create the stubs with null targets and resolve R's symbols to them right
+  // away: the tier-0 module refers to these symbols itself, so it can not be
+  // linked until they have addresses. Nothing can call through the stubs
+  // before R is emitted, which happens once they point at the tier-0 bodies.
+  auto &ISMgr = PDR->getISManager();
+  IndirectStubsManager::StubInitsMap StubInits;
+  for (auto &KV : Tiered)
+    StubInits[*KV.first] = std::make_pair(0, KV.second);
+  if (auto Err = ISMgr.createStubs(StubInits)) {
+    ES.reportError(std::move(Err));
+    R.failMaterialization();
+    return;
+  }
+
+  SymbolMap Stubs;
+  for (auto &KV : Tiered)
+    Stubs[KV.first] = ISMgr.findStub(*KV.first, false);
+  R.notifyResolved(Stubs);
+
+  SymbolNameSet Tier0Names;
+  for (auto &KV : Tier0ToStub)
+    Tier0Names.insert(KV.first);
+
+  auto SharedR = std::make_shared<MaterializationResponsibility>(std::move(R));
+  auto OnResolved = [SharedR, &ISMgr, Tier0ToStub](
+                        Expected<SymbolMap> Result) {
+    auto &ES = SharedR->getTargetJITDylib().getExecutionSession();
+    if (!Result) {
+      ES.reportError(Result.takeError());
+      SharedR->failMaterialization();
+      return;
+    }
+    for (auto &KV : *Result) {
+      if (auto Err = ISMgr.updatePointer(*Tier0ToStub.find(KV.first)->second,
+                                         KV.second.getAddress())) {
+        ES.reportError(std::move(Err));
+        SharedR->failMaterialization();
+        return;
+      }
+    }
+    SharedR->notifyEmitted();
+  };
+
+  auto RegisterDependencies = [SharedR](const SymbolDependenceMap &Deps) {
+    SharedR->addDependenciesForAll(Deps);
+  };
+
+  ES.lookup(JITDylibSearchList({{&PDR->getTier0Dylib(), true}}),
+            std::move(Tier0Names), SymbolState::Resolved,
+            std::move(OnResolved), std::move(RegisterDependencies));
+}
+
+TieredCompileLayer::PerDylibResources &
+TieredCompileLayer::getPerDylibResources(JITDylib &TargetD) {
+  auto I = DylibResources.find(&TargetD);
+  if (I == DylibResources.end()) {
+    auto &ES = getExecutionSession();
+    auto &Tier0D = ES.createJITDylib(TargetD.getName() + ".tier0", false);
+    auto &Tier1D = ES.createJITDylib(TargetD.getName() + ".tier1", false);
+    TargetD.withSearchOrderDo([&](const JITDylibSearchList &TargetSearchOrder) {
+      auto NewSearchOrder = TargetSearchOrder;
+      assert(!NewSearchOrder.empty() &&
+             NewSearchOrder.front().first == &TargetD &&
+             NewSearchOrder.front().second == true &&
+             "TargetD must be at the front of its own search order and match "
+             "non-exported symbol");
+      // Both tiers reach functions through TargetD's stubs, and every other
+      // symbol through the tier-0 dylib.
+      NewSearchOrder.insert(std::next(NewSearchOrder.begin()), {&Tier0D, true});
+      Tier0D.setSearchOrder(NewSearchOrder, false);
+      NewSearchOrder.insert(std::next(NewSearchOrder.begin()), {&Tier1D, true});
+      Tier1D.setSearchOrder(std::move(NewSearchOrder), false);
+    });
+    PerDylibResources PDR(Tier0D, Tier1D, BuildIndirectStubsManager());
+    I = DylibResources.insert(std::make_pair(&TargetD, std::move(PDR))).first;
+  }
+
+  return I->second;
+}
+
+void TieredCompileLayer::instrumentFunction(Function &F, uint64_t Id) {
+  auto &Ctx = F.getContext();
+  auto &M = *F.getParent();
+  auto *Int8PtrTy = Type::getInt8PtrTy(Ctx);
+  auto *Int64Ty = Type::getInt64Ty(Ctx);
+  auto *IntPtrTy = M.getDataLayout().getIntPtrType(Ctx);
+  auto *CallbackTy =
+      FunctionType::get(Type::getVoidTy(Ctx), {Int8PtrTy, Int64Ty}, false);
+
+  auto *Counter = new GlobalVariable(M, Int64Ty, false,
+                                     GlobalValue::PrivateLinkage,
+                                     ConstantInt::get(Int64Ty, 0),
+                                     F.getName() + ".calls");
+
+  // Static allocas must stay in the entry block, so collect them before it
+  // stops being one.
+  BasicBlock &OrigEntry = F.getEntryBlock();
+  SmallVector<AllocaInst *, 8> StaticAllocas;
+  for (auto &I : OrigEntry)
+    if (auto *AI = dyn_cast<AllocaInst>(&I))
+      if (AI->isStaticAlloca())
+        StaticAllocas.push_back(AI);
+
+  auto *Entry = BasicBlock::Create(Ctx, "tier0.entry", &F, &OrigEntry);
+  auto *TierUp = BasicBlock::Create(Ctx, "tier0.tierup", &F, &OrigEntry);
+
+  // The counter only ever equals the threshold once, so the callback runs at
+  // most once per tier-0 body however many threads are calling it.
+  IRBuilder<> B(Entry);
+  auto *Calls = B.CreateAtomicRMW(AtomicRMWInst::Add, Counter,
+                                  ConstantInt::get(Int64Ty, 1),
+                                  AtomicOrdering::Monotonic);
+  auto *IsHot =
+      B.CreateICmpEQ(Calls, ConstantInt::get(Int64Ty, HotCallThreshold - 1));
+  uint32_t ColdWeight = std::min<uint64_t>(HotCallThreshold, UINT32_MAX);
+  B.CreateCondBr(IsHot, TierUp, &OrigEntry,
+                 MDBuilder(Ctx).createBranchWeights(1, ColdWeight));
+
+  B.SetInsertPoint(TierUp);
+  auto *Callback = ConstantExpr::getIntToPtr(
+      ConstantInt::get(IntPtrTy, pointerToJITTargetAddress(&notifyHotFunction)),
+      CallbackTy->getPointerTo());
+  auto *Layer = ConstantExpr::getIntToPtr(
+      ConstantInt::get(IntPtrTy, pointerToJITTargetAddress(this)), Int8PtrTy);
+  B.CreateCall(CallbackTy, Callback, {Layer, ConstantInt::get(Int64Ty, Id)});
+  B.CreateBr(&OrigEntry);
+
+  for (auto *AI : StaticAllocas)
+    AI->moveBefore(Calls);
+}
+
+void TieredCompileLayer::notifyHotFunction(void *Ctx, uint64_t Id) {
+  auto &Layer = *static_cast<TieredCompileLayer *>(Ctx);
+  Layer.RecompileThreads.async([&Layer, Id]() { Layer.recompile(Id); });
+}
+
+void TieredCompileLayer::recompile(uint64_t Id) {
+  PerDylibResources *PDR;
+  SymbolStringPtr Name;
+  std::string IRName;
+  std::shared_ptr<ThreadSafeModule> Source;
+  {
+    std::lock_guard<std::mutex> Lock(TieredLayerMutex);
+    auto &TF = TieredFunctions[Id];
+    PDR = TF.PDR;
+    Name = TF.Name;
+    IRName = TF.IRName;
+    Source = TF.Source;
+  }
+
+  // Everything but the hot function becomes a declaration, which the tier-1
+  // dylib's search order resolves to the stubs and the tier-0 definitions.
+  auto TSM = cloneToNewContext(*Source, [&](const GlobalValue &GV) {
+    return GV.getName() == IRName;
+  });
+  TSM.withModuleDo([&](Module &M) {
+    M.setModuleIdentifier(M.getModuleIdentifier() + ".tier1." + IRName);
+  });
+
+  auto &ES = getExecutionSession();
+  auto &Tier1D = PDR->getTier1Dylib();
+  if (auto Err = OptimizingLayer.add(Tier1D, std::move(TSM))) {
+    ES.reportError(std::move(Err));
+    return;
+  }
+
+  auto Sym = ES.lookup(JITDylibSearchList({{&Tier1D, true}}), Name);
+  if (!Sym) {
+    ES.reportError(Sym.takeError());
+    return;
+  }
+
+  if (auto Err = PDR->getISManager().updatePointer(*Name, Sym->getAddress()))
+    ES.reportError(std::move(Err));
+}
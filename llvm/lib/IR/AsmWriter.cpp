@@ -68,11 +68,13 @@
 #include "llvm/IR/Value.h"
 #include "llvm/Support/AtomicOrdering.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -88,6 +90,11 @@
 
 using namespace llvm;
 
+static cl::opt<bool> ParallelFunctionPrinting(
+    "asm-writer-parallel-functions", cl::init(false), cl::Hidden,
+    cl::desc("Print the functions of a module on multiple threads when "
+             "printing a whole module"));
+
 // Make virtual table appear in this compilation unit.
 AssemblyAnnotationWriter::~AssemblyAnnotationWriter() = default;
 
@@ -478,6 +485,10 @@ public:
 
   void printStructBody(StructType *Ty, raw_ostream &OS);
 
+  /// Number unnamed types like \p Other, which must have processed its module
+  /// already, without looking at the module again.
+  void copyNumbering(const TypePrinting &Other);
+
 private:
   void incorporateTypes();
 
@@ -550,6 +561,12 @@ void TypePrinting::incorporateTypes() {
   NamedTypes.erase(NextToUse, NamedTypes.end());
 }
 
+void TypePrinting::copyNumbering(const TypePrinting &Other) {
+  assert(!Other.DeferredM && "Types not numbered yet!");
+  DeferredM = nullptr;
+  Type2Number = Other.Type2Number;
+}
+
 /// Write the specified type to the specified raw_ostream, making use of type
 /// names or up references to shorten the type name where possible.
 void TypePrinting::print(Type *Ty, raw_ostream &OS) {
@@ -682,6 +699,10 @@ private:
   /// The summary index for which we are holding slot numbers.
   const ModuleSummaryIndex *TheIndex = nullptr;
 
+  /// The tracker to forward module-level queries to, if this one only holds
+  /// the function-level slots.
+  SlotTracker *ModuleSlots = nullptr;
+
   /// mMap - The slot map for the module level data.
   ValueMap mMap;
   unsigned mNext = 0;
@@ -730,6 +751,13 @@ public:
   /// Construct from a module summary index.
   explicit SlotTracker(const ModuleSummaryIndex *Index);
 
+  /// Construct a tracker for the function-level slots only, which looks up
+  /// module-level slots in \p ModuleSlots. \p ModuleSlots must have been
+  /// through numberAllFunctionModuleSlots(), and must not have a function
+  /// incorporated. Queries of such trackers do not modify \p ModuleSlots, so
+  /// functions may be printed concurrently with one tracker per thread.
+  explicit SlotTracker(SlotTracker *ModuleSlots);
+
   SlotTracker(const SlotTracker &) = delete;
   SlotTracker &operator=(const SlotTracker &) = delete;
 
@@ -757,6 +785,10 @@ public:
   /// will reset the state of the machine back to just the module contents.
   void purgeFunction();
 
+  /// Create the module-level slots that incorporating each function of the
+  /// module in turn would create, in the same order.
+  void numberAllFunctionModuleSlots(const Module &M);
+
   /// MDNode map iterators.
   using mdn_iterator = DenseMap<const MDNode*, unsigned>::iterator;
 
@@ -905,6 +937,12 @@ SlotTracker::SlotTracker(const Function *F, bool ShouldInitializeAllMetadata)
 SlotTracker::SlotTracker(const ModuleSummaryIndex *Index)
     : TheModule(nullptr), ShouldInitializeAllMetadata(false), TheIndex(Index) {}
 
+// Function-level only constructor. The metadata of the functions is already
+// in ModuleSlots, so act as if it had been initialized.
+SlotTracker::SlotTracker(SlotTracker *ModuleSlots)
+    : TheModule(nullptr), ShouldInitializeAllMetadata(true),
+      ModuleSlots(ModuleSlots) {}
+
 inline void SlotTracker::initializeIfNeeded() {
   if (TheModule) {
     processModule();
@@ -997,6 +1035,10 @@ void SlotTracker::processFunction() {
       if (!I.getType()->isVoidTy() && !I.hasName())
         CreateFunctionSlot(&I);
 
+      // The attribute slots are in ModuleSlots already.
+      if (ModuleSlots)
+        continue;
+
       // We allow direct calls to any llvm.foo function here, because the
       // target may not be linked into the optimizer.
       if (const auto *Call = dyn_cast<CallBase>(&I)) {
@@ -1089,8 +1131,29 @@ void SlotTracker::purgeFunction() {
   ST_DEBUG("end purgeFunction!\n");
 }
 
+void SlotTracker::numberAllFunctionModuleSlots(const Module &M) {
+  assert(!TheFunction && "A function is incorporated!");
+  initializeIfNeeded();
+
+  // Follow processFunction: first the metadata, then the call attributes.
+  for (const Function &F : M) {
+    if (!ShouldInitializeAllMetadata)
+      processFunctionMetadata(F);
+    for (const BasicBlock &BB : F)
+      for (const Instruction &I : BB)
+        if (const auto *Call = dyn_cast<CallBase>(&I)) {
+          AttributeSet Attrs = Call->getAttributes().getFnAttributes();
+          if (Attrs.hasAttributes())
+            CreateAttributeSetSlot(Attrs);
+        }
+  }
+}
+
 /// getGlobalSlot - Get the slot number of a global value.
 int SlotTracker::getGlobalSlot(const GlobalValue *V) {
+  if (ModuleSlots)
+    return ModuleSlots->getGlobalSlot(V);
+
   // Check for uninitialized state and do lazy initialization.
   initializeIfNeeded();
 
@@ -1101,6 +1164,9 @@ int SlotTracker::getGlobalSlot(const GlobalValue *V) {
 
 /// getMetadataSlot - Get the slot number of a MDNode.
 int SlotTracker::getMetadataSlot(const MDNode *N) {
+  if (ModuleSlots)
+    return ModuleSlots->getMetadataSlot(N);
+
   // Check for uninitialized state and do lazy initialization.
   initializeIfNeeded();
 
@@ -1121,6 +1187,9 @@ int SlotTracker::getLocalSlot(const Value *V) {
 }
 
 int SlotTracker::getAttributeGroupSlot(AttributeSet AS) {
+  if (ModuleSlots)
+    return ModuleSlots->getAttributeGroupSlot(AS);
+
   // Check for uninitialized state and do lazy initialization.
   initializeIfNeeded();
 
@@ -2401,6 +2470,7 @@ public:
   void printIndirectSymbol(const GlobalIndirectSymbol *GIS);
   void printComdat(const Comdat *C);
   void printFunction(const Function *F);
+  void printFunctionsInParallel(const Module *M);
   void printArgument(const Argument *FA, AttributeSet Attrs);
   void printBasicBlock(const BasicBlock *BB);
   void printInstructionLine(const Instruction &I);
@@ -2641,9 +2711,14 @@ void AssemblyWriter::printModule(const Module *M) {
   // Output global use-lists.
   printUseLists(nullptr);
 
-  // Output all of the functions.
-  for (const Function &F : *M)
-    printFunction(&F);
+  // Output all of the functions. Use-list orders are printed in order from a
+  // single stack, and annotation writers may not be thread safe.
+  if (ParallelFunctionPrinting && !ShouldPreserveUseListOrder &&
+      !AnnotationWriter)
+    printFunctionsInParallel(M);
+  else
+    for (const Function &F : *M)
+      printFunction(&F);
   assert(UseListOrders.empty() && "All use-lists should have been consumed");
 
   // Output all attribute groups.
@@ -2665,6 +2740,54 @@ void AssemblyWriter::printModule(const Module *M) {
   }
 }
 
+/// Print the functions of \p M as printFunction would, on multiple threads.
+void AssemblyWriter::printFunctionsInParallel(const Module *M) {
+  // Create the module-level slots that printing the functions in order would
+  // create, so that the tasks below only need to number local values.
+  Machine.numberAllFunctionModuleSlots(*M);
+
+  // Each task prints a run of adjacent functions into its own buffer, with
+  // its own function-level slot tracker. A batch of runs is printed, then
+  // written out in order, so that only one batch of text is held in memory.
+  const size_t MinRunSize = 4096;
+  const size_t NumRunsPerBatch = 4 * std::max(parallel::getThreadCount(), 1U);
+  std::vector<std::pair<Module::const_iterator, Module::const_iterator>> Runs;
+  std::vector<std::string> Texts;
+  auto PrintRun = [&](size_t I) {
+    SlotTracker Slots(&Machine);
+    raw_string_ostream OS(Texts[I]);
+    formatted_raw_ostream FOS(OS);
+    AssemblyWriter W(FOS, Slots, M, nullptr, IsForDebug);
+    W.TypePrinter.copyNumbering(TypePrinter);
+    for (const Function &F : make_range(Runs[I].first, Runs[I].second))
+      W.printFunction(&F);
+  };
+  auto PrintBatch = [&] {
+    Texts.assign(Runs.size(), std::string());
+#if LLVM_ENABLE_THREADS
+    parallel::for_each_n(parallel::par, size_t(0), Runs.size(), PrintRun);
+#else
+    parallel::for_each_n(parallel::seq, size_t(0), Runs.size(), PrintRun);
+#endif
+    for (const std::string &Text : Texts)
+      Out << Text;
+    Runs.clear();
+  };
+
+  size_t RunSize = 0;
+  Module::const_iterator RunBegin = M->begin();
+  for (auto I = M->begin(), E = M->end(); I != E;) {
+    RunSize += I->getInstructionCount() + 1;
+    if (++I != E && RunSize < MinRunSize)
+      continue;
+    Runs.push_back({RunBegin, I});
+    RunBegin = I;
+    RunSize = 0;
+    if (Runs.size() == NumRunsPerBatch || I == E)
+      PrintBatch();
+  }
+}
+
 void AssemblyWriter::printModuleSummaryIndex() {
   assert(TheIndex);
   Machine.initializeIndexIfNeeded();
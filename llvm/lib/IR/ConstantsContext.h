@@ -625,6 +625,7 @@ private:
 public:
   typename MapTy::iterator begin() { return Map.begin(); }
   typename MapTy::iterator end() { return Map.end(); }
+  size_t size() const { return Map.size(); }
 
   void freeConstants() {
     for (auto &I : Map)
@@ -361,6 +361,11 @@ void Function::dropAllReferences() {
   for (BasicBlock &BB : *this)
     BB.dropAllReferences();
 
+  // Delete the instructions first, so that the BasicBlock destructor does not
+  // walk their operands again to drop references that are already gone.
+  for (BasicBlock &BB : *this)
+    BB.getInstList().clear();
+
   // Delete all basic blocks. They are now unused, except possibly by
   // blockaddresses, but BasicBlock's destructor takes care of those.
   while (!BasicBlocks.empty())
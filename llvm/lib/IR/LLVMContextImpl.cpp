@@ -141,7 +141,10 @@ LLVMContextImpl::~LLVMContextImpl() {
     delete Pair.second;
 }
 
-void LLVMContextImpl::dropTriviallyDeadConstantArrays() {
+void LLVMContextImpl::dropTriviallyDeadConstantArrays(bool OnlyIfGrown) {
+  if (OnlyIfGrown && ArrayConstants.size() < 2 * NumArrayConstantsAfterDrop)
+    return;
+
   bool Changed;
   do {
     Changed = false;
@@ -154,12 +157,17 @@ void LLVMContextImpl::dropTriviallyDeadConstantArrays() {
       }
     }
   } while (Changed);
+  NumArrayConstantsAfterDrop = ArrayConstants.size();
 }
 
 void Module::dropTriviallyDeadConstantArrays() {
   Context.pImpl->dropTriviallyDeadConstantArrays();
 }
 
+void Module::dropTriviallyDeadConstantArraysIfGrown() {
+  Context.pImpl->dropTriviallyDeadConstantArrays(/*OnlyIfGrown=*/true);
+}
+
 namespace llvm {
 
 /// Make MDOperand transparent for hashing.
@@ -1405,8 +1405,12 @@ public:
   LLVMContextImpl(LLVMContext &C);
   ~LLVMContextImpl();
 
-  /// Destroy the ConstantArrays if they are not used.
-  void dropTriviallyDeadConstantArrays();
+  /// Destroy the ConstantArrays if they are not used. With \p OnlyIfGrown, do
+  /// nothing unless their number has doubled since the last time.
+  void dropTriviallyDeadConstantArrays(bool OnlyIfGrown = false);
+
+  /// The number of ConstantArrays left after they were last dropped.
+  size_t NumArrayConstantsAfterDrop = 0;
 
   mutable OptPassGate *OPG = nullptr;
 
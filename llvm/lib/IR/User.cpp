@@ -7,9 +7,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/User.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/GlobalValue.h"
 
+#define DEBUG_TYPE "user"
+
+// Uses are a large part of the memory of the IR. Count them, including the
+// ones copied when a growable operand list is reallocated.
+STATISTIC(NumFixedUses, "Number of Uses allocated with their User");
+STATISTIC(NumHungOffUses, "Number of hung-off Uses allocated");
+STATISTIC(NumHungOffUsesReallocated,
+          "Number of hung-off Uses copied to grow an operand list");
+
 namespace llvm {
 class BasicBlock;
 
@@ -46,6 +56,7 @@ void User::allocHungoffUses(unsigned N, bool IsPhi) {
 
   // Allocate the array of Uses, followed by a pointer (with bottom bit set) to
   // the User.
+  NumHungOffUses += N;
   size_t size = N * sizeof(Use) + sizeof(Use::UserRef);
   if (IsPhi)
     size += N * sizeof(BasicBlock *);
@@ -64,6 +75,7 @@ void User::growHungoffUses(unsigned NewNumUses, bool IsPhi) {
   // space to copy the old uses in to the new space.
   assert(NewNumUses > OldNumUses && "realloc must grow num uses");
 
+  NumHungOffUsesReallocated += OldNumUses;
   Use *OldOps = getOperandList();
   allocHungoffUses(NewNumUses, IsPhi);
   Use *NewOps = getOperandList();
@@ -120,6 +132,7 @@ void *User::allocateFixedOperandUser(size_t Size, unsigned Us,
   assert(DescBytesToAllocate % sizeof(void *) == 0 &&
          "We need this to satisfy alignment constraints for Uses");
 
+  NumFixedUses += Us;
   uint8_t *Storage = static_cast<uint8_t *>(
       ::operator new(Size + sizeof(Use) * Us + DescBytesToAllocate));
   Use *Start = reinterpret_cast<Use *>(Storage + DescBytesToAllocate);
@@ -5466,7 +5466,19 @@ VerifierAnalysis::Result VerifierAnalysis::run(Function &F,
 }
 
 PreservedAnalyses VerifierPass::run(Module &M, ModuleAnalysisManager &AM) {
-  auto Res = AM.getResult<VerifierAnalysis>(M);
+  VerifierAnalysis::Result Res;
+  if (Incremental) {
+    auto &FAM =
+        AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+    for (Function &F : M)
+      Res.IRBroken |= FAM.getResult<VerifierAnalysis>(F).IRBroken;
+
+    Verifier V(&dbgs(), /*ShouldTreatBrokenDebugInfoAsError=*/false, M);
+    Res.IRBroken |= !V.verify();
+    Res.DebugInfoBroken = V.hasBrokenDebugInfo();
+  } else {
+    Res = AM.getResult<VerifierAnalysis>(M);
+  }
   if (FatalErrors && (Res.IRBroken || Res.DebugInfoBroken))
     report_fatal_error("Broken module found, compilation aborted!");
 
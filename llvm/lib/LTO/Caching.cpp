@@ -12,10 +12,12 @@
 
 #include "llvm/LTO/Caching.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -49,6 +51,8 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                                     /*RequiresNullTerminator=*/false);
       sys::fs::closeFile(*FDOrErr);
       if (MBOrErr) {
+        recordCacheFileUse(CacheDirectoryPath, sys::path::filename(EntryPath),
+                           (*MBOrErr)->getBufferSize());
         AddBuffer(Task, std::move(*MBOrErr));
         return AddStreamFn();
       }
@@ -126,6 +130,9 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                              TempFile.TmpName + " to " + EntryPath + ": " +
                              toString(std::move(E)) + "\n");
 
+        recordCacheFileUse(sys::path::parent_path(EntryPath),
+                           sys::path::filename(EntryPath),
+                           (*MBOrErr)->getBufferSize());
         AddBuffer(Task, std::move(*MBOrErr));
       }
     };
@@ -148,3 +155,48 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
     };
   };
 }
+
+CacheStorage::~CacheStorage() = default;
+
+NativeObjectCache lto::storageCache(std::shared_ptr<CacheStorage> Storage,
+                                    AddBufferFn AddBuffer) {
+  return [=](unsigned Task, StringRef Key) -> AddStreamFn {
+    Expected<std::unique_ptr<MemoryBuffer>> MBOrErr = Storage->get(Key);
+    if (!MBOrErr)
+      consumeError(MBOrErr.takeError());
+    else if (*MBOrErr) {
+      AddBuffer(Task, std::move(*MBOrErr));
+      return AddStreamFn();
+    }
+
+    // This native object stream collects the object in memory, then stores
+    // it and calls AddBuffer to add it to the link.
+    struct StorageStream : NativeObjectStream {
+      std::shared_ptr<CacheStorage> Storage;
+      AddBufferFn AddBuffer;
+      std::string Key;
+      unsigned Task;
+      SmallVector<char, 0> Object;
+
+      StorageStream(std::shared_ptr<CacheStorage> Storage,
+                    AddBufferFn AddBuffer, std::string Key, unsigned Task)
+          : NativeObjectStream(nullptr), Storage(std::move(Storage)),
+            AddBuffer(std::move(AddBuffer)), Key(std::move(Key)), Task(Task) {
+        OS = std::make_unique<raw_svector_ostream>(Object);
+      }
+
+      ~StorageStream() {
+        OS.reset();
+        auto MB = std::make_unique<SmallVectorMemoryBuffer>(std::move(Object),
+                                                            "<cache>");
+        consumeError(Storage->put(Key, MB->getMemBufferRef()));
+        AddBuffer(Task, std::move(MB));
+      }
+    };
+
+    std::string KeyStr = Key;
+    return [=](size_t Task) -> std::unique_ptr<NativeObjectStream> {
+      return std::make_unique<StorageStream>(Storage, AddBuffer, KeyStr, Task);
+    };
+  };
+}
@@ -38,6 +38,7 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/VCSRevision.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -48,6 +49,7 @@
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
 
+#include <queue>
 #include <set>
 
 using namespace llvm;
@@ -61,6 +63,22 @@ static cl::opt<bool>
                    cl::desc("Dump the SCCs in the ThinLTO index's callgraph"));
 
 /// Enable global value internalization in LTO.
+static cl::opt<bool> ThinLTOScheduleByCost(
+    "thinlto-schedule-by-cost", cl::init(true), cl::Hidden,
+    cl::desc("Start the in-process ThinLTO backend jobs in order of decreasing "
+             "estimated cost"));
+
+static cl::opt<unsigned> ThinLTOGroupCostThreshold(
+    "thinlto-group-cost-threshold", cl::init(0), cl::Hidden,
+    cl::desc("Group in-process ThinLTO backend jobs whose estimated cost, in "
+             "instructions, is below this threshold into jobs of about this "
+             "cost (0 = no grouping)"));
+
+static cl::opt<bool> ThinLTOReportSchedule(
+    "thinlto-report-schedule", cl::init(false), cl::Hidden,
+    cl::desc("Report the estimated critical path of the in-process ThinLTO "
+             "backend jobs"));
+
 cl::opt<bool> EnableLTOInternalization(
     "enable-lto-internalization", cl::init(true), cl::Hidden,
     cl::desc("Enable global value internalization in LTO"));
@@ -944,6 +962,10 @@ Error LTO::run(AddStreamFn AddStream, NativeObjectCache Cache) {
 }
 
 Error LTO::runRegularLTO(AddStreamFn AddStream) {
+  // Drop the constant arrays that linking the inputs left dead, which the
+  // IRMover only does once enough of them have accumulated.
+  RegularLTO.CombinedModule->dropTriviallyDeadConstantArrays();
+
   // Make sure commons have the right size/alignment: we kept the largest from
   // all the prevailing when adding the inputs, and we apply it here.
   const DataLayout &DL = RegularLTO.CombinedModule->getDataLayout();
@@ -1031,11 +1053,26 @@ public:
 namespace {
 class InProcessThinBackend : public ThinBackendProc {
   ThreadPool BackendThreadPool;
+  unsigned ThreadCount;
   AddStreamFn AddStream;
   NativeObjectCache Cache;
   std::set<GlobalValue::GUID> CfiFunctionDefs;
   std::set<GlobalValue::GUID> CfiFunctionDecls;
 
+  /// A backend job for one module, which is queued by start() and run once
+  /// all jobs are known, so that they can be scheduled by estimated cost.
+  struct BackendJob {
+    unsigned Task;
+    BitcodeModule BM;
+    const FunctionImporter::ImportMapTy *ImportList;
+    const FunctionImporter::ExportSetTy *ExportList;
+    const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> *ResolvedODR;
+    const GVSummaryMapTy *DefinedGlobals;
+    MapVector<StringRef, BitcodeModule> *ModuleMap;
+    uint64_t Cost;
+  };
+  std::vector<BackendJob> Jobs;
+
   Optional<Error> Err;
   std::mutex ErrMu;
 
@@ -1047,6 +1084,7 @@ public:
       AddStreamFn AddStream, NativeObjectCache Cache)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
         BackendThreadPool(ThinLTOParallelismLevel),
+        ThreadCount(std::max(ThinLTOParallelismLevel, 1u)),
         AddStream(std::move(AddStream)), Cache(std::move(Cache)) {
     for (auto &Name : CombinedIndex.cfiFunctionDefs())
       CfiFunctionDefs.insert(
@@ -1066,7 +1104,10 @@ public:
       MapVector<StringRef, BitcodeModule> &ModuleMap) {
     auto RunThinBackend = [&](AddStreamFn AddStream) {
       LTOLLVMContext BackendContext(Conf);
-      Expected<std::unique_ptr<Module>> MOrErr = BM.parseModule(BackendContext);
+      // thinBackend materializes the module once dead symbols are dropped.
+      Expected<std::unique_ptr<Module>> MOrErr =
+          BM.getLazyModule(BackendContext, /*ShouldLazyLoadMetadata=*/true,
+                           /*IsImporting=*/false);
       if (!MOrErr)
         return MOrErr.takeError();
 
@@ -1094,6 +1135,112 @@ public:
     return Error::success();
   }
 
+  /// Estimate the cost of the backend job for a module as the number of
+  /// instructions in the functions that it defines or imports.
+  uint64_t estimateCost(const FunctionImporter::ImportMapTy &ImportList,
+                        const GVSummaryMapTy &DefinedGlobals) {
+    auto InstCount = [](const GlobalValueSummary *S) -> uint64_t {
+      if (!S)
+        return 0;
+      if (auto *FS = dyn_cast<FunctionSummary>(S->getBaseObject()))
+        return FS->instCount();
+      return 0;
+    };
+    // Every job has a fixed overhead, so that empty modules are not free.
+    uint64_t Cost = 1;
+    for (auto &Def : DefinedGlobals)
+      Cost += InstCount(Def.second);
+    for (auto &FromModule : ImportList)
+      for (GlobalValue::GUID GUID : FromModule.second)
+        Cost += InstCount(
+            CombinedIndex.findSummaryInModule(GUID, FromModule.first()));
+    return Cost;
+  }
+
+  void runJob(const BackendJob &J) {
+    // Each backend job records into a profiler of its own, which is merged
+    // into the trace of the client when the job is done.
+    if (Conf.TimeTraceEnabled)
+      timeTraceProfilerInitialize(Conf.TimeTraceGranularity, "thin backend");
+    Error E = [&] {
+      TimeTraceScope TimeScope("ThinLTO backend", J.BM.getModuleIdentifier());
+      return runThinLTOBackendThread(AddStream, Cache, J.Task, J.BM,
+                                     CombinedIndex, *J.ImportList,
+                                     *J.ExportList, *J.ResolvedODR,
+                                     *J.DefinedGlobals, *J.ModuleMap);
+    }();
+    if (Conf.TimeTraceEnabled)
+      timeTraceProfilerFinishThread();
+    if (E) {
+      std::unique_lock<std::mutex> L(ErrMu);
+      if (Err)
+        Err = joinErrors(std::move(*Err), std::move(E));
+      else
+        Err = std::move(E);
+    }
+  }
+
+  /// Submit the queued jobs to the thread pool.
+  ///
+  /// Jobs are started largest first, so that a huge module does not start
+  /// last and form a long tail while the other threads are idle. Jobs below
+  /// the grouping threshold are run back to back in a single task, to save
+  /// the per-task overhead. Task numbers are assigned by start(), so the
+  /// order in which jobs run does not affect the output.
+  void scheduleJobs() {
+    if (ThinLTOScheduleByCost)
+      llvm::stable_sort(Jobs, [](const BackendJob &A, const BackendJob &B) {
+        return A.Cost > B.Cost;
+      });
+
+    // Partition the jobs into groups, each of which becomes one task.
+    std::vector<std::pair<size_t, size_t>> Groups;
+    std::vector<uint64_t> GroupCosts;
+    for (size_t I = 0, E = Jobs.size(); I != E;) {
+      size_t Begin = I;
+      uint64_t Cost = Jobs[I++].Cost;
+      while (I != E && Cost < ThinLTOGroupCostThreshold &&
+             Jobs[I].Cost < ThinLTOGroupCostThreshold)
+        Cost += Jobs[I++].Cost;
+      Groups.push_back({Begin, I});
+      GroupCosts.push_back(Cost);
+    }
+
+    if (ThinLTOReportSchedule)
+      reportSchedule(GroupCosts);
+
+    for (auto &G : Groups)
+      BackendThreadPool.async([this, G] {
+        for (size_t I = G.first; I != G.second; ++I)
+          runJob(Jobs[I]);
+      });
+  }
+
+  /// Print the estimated critical path of the schedule, found by simulating
+  /// the threads picking up the tasks in submission order.
+  void reportSchedule(ArrayRef<uint64_t> GroupCosts) {
+    std::priority_queue<uint64_t, std::vector<uint64_t>,
+                        std::greater<uint64_t>>
+        ThreadEnd;
+    for (unsigned I = 0; I != ThreadCount; ++I)
+      ThreadEnd.push(0);
+    uint64_t Total = 0, Largest = 0, CriticalPath = 0;
+    for (uint64_t Cost : GroupCosts) {
+      uint64_t End = ThreadEnd.top() + Cost;
+      ThreadEnd.pop();
+      ThreadEnd.push(End);
+      Total += Cost;
+      Largest = std::max(Largest, Cost);
+      CriticalPath = std::max(CriticalPath, End);
+    }
+    uint64_t Ideal = std::max(Largest, divideCeil(Total, ThreadCount));
+    errs() << "ThinLTO schedule: " << Jobs.size() << " modules in "
+           << GroupCosts.size() << " jobs on " << ThreadCount
+           << " threads; total cost " << Total << ", largest job " << Largest
+           << ", estimated critical path " << CriticalPath << " (lower bound "
+           << Ideal << ")\n";
+  }
+
   Error start(
       unsigned Task, BitcodeModule BM,
       const FunctionImporter::ImportMapTy &ImportList,
@@ -1104,31 +1251,14 @@ public:
     assert(ModuleToDefinedGVSummaries.count(ModulePath));
     const GVSummaryMapTy &DefinedGlobals =
         ModuleToDefinedGVSummaries.find(ModulePath)->second;
-    BackendThreadPool.async(
-        [=](BitcodeModule BM, ModuleSummaryIndex &CombinedIndex,
-            const FunctionImporter::ImportMapTy &ImportList,
-            const FunctionImporter::ExportSetTy &ExportList,
-            const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes>
-                &ResolvedODR,
-            const GVSummaryMapTy &DefinedGlobals,
-            MapVector<StringRef, BitcodeModule> &ModuleMap) {
-          Error E = runThinLTOBackendThread(
-              AddStream, Cache, Task, BM, CombinedIndex, ImportList, ExportList,
-              ResolvedODR, DefinedGlobals, ModuleMap);
-          if (E) {
-            std::unique_lock<std::mutex> L(ErrMu);
-            if (Err)
-              Err = joinErrors(std::move(*Err), std::move(E));
-            else
-              Err = std::move(E);
-          }
-        },
-        BM, std::ref(CombinedIndex), std::ref(ImportList), std::ref(ExportList),
-        std::ref(ResolvedODR), std::ref(DefinedGlobals), std::ref(ModuleMap));
+    Jobs.push_back({Task, BM, &ImportList, &ExportList, &ResolvedODR,
+                    &DefinedGlobals, &ModuleMap,
+                    estimateCost(ImportList, DefinedGlobals)});
     return Error::success();
   }
 
   Error wait() override {
+    scheduleJobs();
     BackendThreadPool.wait();
     if (Err)
       return std::move(*Err);
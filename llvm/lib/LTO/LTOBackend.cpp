@@ -20,6 +20,7 @@
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/RemarkStreamer.h"
@@ -29,6 +30,7 @@
 #include "llvm/Object/ModuleSymbolTable.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -47,6 +49,11 @@
 using namespace llvm;
 using namespace lto;
 
+static cl::opt<bool> PartitionByCost(
+    "lto-partition-by-cost", cl::init(true), cl::Hidden,
+    cl::desc("Balance the estimated code generation cost of the partitions "
+             "of parallel code generation for regular LTO"));
+
 LLVM_ATTRIBUTE_NORETURN static void reportOpenError(StringRef Path, Twine Msg) {
   errs() << "failed to open " << Path << ": " << Msg << '\n';
   errs().flush();
@@ -352,7 +359,7 @@ void codegen(Config &Conf, TargetMachine *TM, AddStreamFn AddStream,
 
 void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
                   unsigned ParallelCodeGenParallelismLevel,
-                  std::unique_ptr<Module> Mod) {
+                  std::unique_ptr<Module> Mod, bool OptimizePartitions) {
   ThreadPool CodegenThreadPool(ParallelCodeGenParallelismLevel);
   unsigned ThreadCount = 0;
   const Target *T = &TM->getTarget();
@@ -384,13 +391,19 @@ void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
               std::unique_ptr<TargetMachine> TM =
                   createTargetMachine(C, T, *MPartInCtx);
 
+              if (OptimizePartitions &&
+                  !opt(C, TM.get(), ThreadId, *MPartInCtx, /*IsThinLTO=*/false,
+                       /*ExportSummary=*/nullptr, /*ImportSummary=*/nullptr))
+                return;
+
               codegen(C, TM.get(), AddStream, ThreadId, *MPartInCtx);
             },
             // Pass BC using std::move to ensure that it get moved rather than
             // copied into the thread's context.
             std::move(BC), ThreadCount++);
       },
-      false);
+      false,
+      PartitionByCost ? SplitModuleMode::CostBalanced : SplitModuleMode::Hash);
 
   // Because the inner lambda (which runs in a worker thread) captures our local
   // variables, we need to wait for the worker threads to terminate before we
@@ -413,6 +426,16 @@ Expected<const Target *> initAndLookupTarget(Config &C, Module &Mod) {
 
 }
 
+// Returns whether M uses type metadata, which the whole-program passes of the
+// optimization pipeline must see in the merged module.
+static bool usesTypeMetadata(const Module &M) {
+  for (Intrinsic::ID ID : {Intrinsic::type_test, Intrinsic::type_checked_load})
+    if (const Function *F = M.getFunction(Intrinsic::getName(ID)))
+      if (!F->use_empty())
+        return true;
+  return false;
+}
+
 static Error
 finalizeOptimizationRemarks(std::unique_ptr<ToolOutputFile> DiagOutputFile) {
   // Make sure we flush the diagnostic remarks file in case the linker doesn't
@@ -442,7 +465,13 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     return DiagFileOrErr.takeError();
   auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
 
-  if (!C.CodeGenOnly) {
+  // The partitions are optimized separately, so the combined index is not
+  // updated by the optimization pipeline; it is only exported to from the
+  // type metadata, which rules that out.
+  bool OptimizePartitions = C.OptimizePartitions && !C.CodeGenOnly &&
+                            ParallelCodeGenParallelismLevel > 1 &&
+                            !usesTypeMetadata(*Mod);
+  if (!C.CodeGenOnly && !OptimizePartitions) {
     if (!opt(C, TM.get(), 0, *Mod, /*IsThinLTO=*/false,
              /*ExportSummary=*/&CombinedIndex, /*ImportSummary=*/nullptr))
       return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
@@ -452,7 +481,7 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     codegen(C, TM.get(), AddStream, 0, *Mod);
   } else {
     splitCodeGen(C, TM.get(), AddStream, ParallelCodeGenParallelismLevel,
-                 std::move(Mod));
+                 std::move(Mod), OptimizePartitions);
   }
   return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
 }
@@ -497,6 +526,13 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
     return DiagFileOrErr.takeError();
   auto DiagnosticOutputFile = std::move(*DiagFileOrErr);
 
+  // The module may have been read lazily. It is fully materialized before any
+  // hook sees it, but otherwise only after dead symbols are dropped, so that
+  // the bodies and debug info of dead functions are never read.
+  if (Conf.CodeGenOnly || Conf.PreOptModuleHook)
+    if (Error Err = Mod.materializeAll())
+      return Err;
+
   if (Conf.CodeGenOnly) {
     codegen(Conf, TM.get(), AddStream, Task, Mod);
     return finalizeOptimizationRemarks(std::move(DiagnosticOutputFile));
@@ -509,6 +545,9 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
 
   dropDeadSymbols(Mod, DefinedGlobals, CombinedIndex);
 
+  if (Error Err = Mod.materializeAll())
+    return Err;
+
   thinLTOResolvePrevailingInModule(Mod, DefinedGlobals);
 
   if (Conf.PostPromoteModuleHook && !Conf.PostPromoteModuleHook(Task, Mod))
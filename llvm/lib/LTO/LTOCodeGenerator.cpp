@@ -603,7 +603,8 @@ bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   // MergedModule.
   MergedModule = splitCodeGen(std::move(MergedModule), Out, {},
                               [&]() { return createTargetMachine(); }, FileType,
-                              ShouldRestoreGlobalsLinkage);
+                              ShouldRestoreGlobalsLinkage,
+                              SplitModuleMode::CostBalanced);
 
   // If statistics were requested, save them to the specified file or
   // print them out after codegen.
@@ -357,9 +357,17 @@ public:
     ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr = MemoryBuffer::getOpenFile(
         *FDOrErr, EntryPath, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
     sys::fs::closeFile(*FDOrErr);
+    if (MBOrErr)
+      recordUse((*MBOrErr)->getBufferSize());
     return MBOrErr;
   }
 
+  // Record a use of this entry in the pruning index of the cache.
+  void recordUse(uint64_t Size) {
+    recordCacheFileUse(sys::path::parent_path(EntryPath),
+                       sys::path::filename(EntryPath), Size);
+  }
+
   // Cache the Produced object file
   void write(const MemoryBuffer &OutputBuffer) {
     if (EntryPath.empty())
@@ -385,6 +393,8 @@ public:
     EC = sys::fs::rename(TempFilename, EntryPath);
     if (EC)
       sys::fs::remove(TempFilename);
+    else
+      recordUse(OutputBuffer.getBufferSize());
   }
 };
 
@@ -16,12 +16,18 @@
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/GVMaterializer.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/PassTimingInfo.h"
 #include "llvm/IR/TypeFinder.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include <utility>
 using namespace llvm;
 
+// The phases of linking a module are timed with -time-passes.
+static const char *const TimerGroupName = "irlink";
+static const char *const TimerGroupDescription = "IR Linking";
+
 //===----------------------------------------------------------------------===//
 // TypeMap implementation.
 //===----------------------------------------------------------------------===//
@@ -1406,31 +1412,40 @@ Error IRLinker::run() {
   if (!IsPerformingImport && !SrcM->getModuleInlineAsm().empty()) {
     std::string SrcModuleInlineAsm = adjustInlineAsm(SrcM->getModuleInlineAsm(),
                                                      SrcTriple);
+    // Append rather than rebuild the string, which would be quadratic in the
+    // number of modules with inline asm.
     if (DstM.getModuleInlineAsm().empty())
       DstM.setModuleInlineAsm(SrcModuleInlineAsm);
     else
-      DstM.setModuleInlineAsm(DstM.getModuleInlineAsm() + "\n" +
-                              SrcModuleInlineAsm);
+      DstM.appendModuleInlineAsm("\n" + SrcModuleInlineAsm);
   }
 
   // Loop over all of the linked values to compute type mappings.
-  computeTypeMapping();
-
-  std::reverse(Worklist.begin(), Worklist.end());
-  while (!Worklist.empty()) {
-    GlobalValue *GV = Worklist.back();
-    Worklist.pop_back();
+  {
+    NamedRegionTimer T("types", "Type Mapping", TimerGroupName,
+                       TimerGroupDescription, TimePassesIsEnabled);
+    computeTypeMapping();
+  }
 
-    // Already mapped.
-    if (ValueMap.find(GV) != ValueMap.end() ||
-        IndirectSymbolValueMap.find(GV) != IndirectSymbolValueMap.end())
-      continue;
+  {
+    NamedRegionTimer T("values", "Global Value Linking", TimerGroupName,
+                       TimerGroupDescription, TimePassesIsEnabled);
+    std::reverse(Worklist.begin(), Worklist.end());
+    while (!Worklist.empty()) {
+      GlobalValue *GV = Worklist.back();
+      Worklist.pop_back();
+
+      // Already mapped.
+      if (ValueMap.find(GV) != ValueMap.end() ||
+          IndirectSymbolValueMap.find(GV) != IndirectSymbolValueMap.end())
+        continue;
 
-    assert(!GV->isDeclaration());
-    Mapper.mapValue(*GV);
-    if (FoundError)
-      return std::move(*FoundError);
-    flushRAUWWorklist();
+      assert(!GV->isDeclaration());
+      Mapper.mapValue(*GV);
+      if (FoundError)
+        return std::move(*FoundError);
+      flushRAUWWorklist();
+    }
   }
 
   // Note that we are done linking global value bodies. This prevents
@@ -1438,6 +1453,8 @@ Error IRLinker::run() {
   DoneLinkingBodies = true;
   Mapper.addFlags(RF_NullMapMissingGlobalValues);
 
+  NamedRegionTimer T("metadata", "Metadata Linking", TimerGroupName,
+                     TimerGroupDescription, TimePassesIsEnabled);
   // Remap all of the named MDNodes in Src into the DstM module. We do this
   // after linking GlobalValues so that MDNodes that reference GlobalValues
   // are properly remapped.
@@ -1550,6 +1567,11 @@ Error IRMover::move(
                        std::move(Src), ValuesToLink, std::move(AddLazyFor),
                        IsPerformingImport);
   Error E = TheIRLinker.run();
-  Composite.dropTriviallyDeadConstantArrays();
+  // Walking all constant arrays of the context after each of many modules
+  // would make merging them quadratic, so the arrays left dead are only
+  // dropped once there are enough of them.
+  NamedRegionTimer T("constants", "Dead Constant Dropping", TimerGroupName,
+                     TimerGroupDescription, TimePassesIsEnabled);
+  Composite.dropTriviallyDeadConstantArraysIfGrown();
   return E;
 }
@@ -67,6 +67,13 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SectionRelaxationSteps,
+          "Number of layout and relaxation steps of single sections");
+STATISTIC(VisitedRelaxationCandidates,
+          "Number of fragments visited during relaxation");
+STATISTIC(SkippedSectionLayouts,
+          "Number of section layouts skipped because nothing they depend on "
+          "changed");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
@@ -102,6 +109,7 @@ void MCAssembler::reset() {
   DataRegions.clear();
   LinkerOptions.clear();
   FileNames.clear();
+  RelaxationWorklists.clear();
   ThumbFuncs.clear();
   BundleAlignSize = 0;
   RelaxAll = false;
@@ -771,21 +779,32 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
     Sec.setOrdinal(SectionIndex++);
   }
 
-  // Assign layout order indices to sections and fragments.
+  // Assign layout order indices to sections and fragments, and collect the
+  // fragments that relaxation has to look at.
+  RelaxationWorklists.clear();
+  RelaxationWorklists.resize(SectionIndex);
   for (unsigned i = 0, e = Layout.getSectionOrder().size(); i != e; ++i) {
     MCSection *Sec = Layout.getSectionOrder()[i];
     Sec->setLayoutOrder(i);
 
+    std::vector<MCFragment *> &Worklist =
+        RelaxationWorklists[Sec->getOrdinal()];
     unsigned FragmentIndex = 0;
-    for (MCFragment &Frag : *Sec)
+    for (MCFragment &Frag : *Sec) {
       Frag.setLayoutOrder(FragmentIndex++);
+      if (isRelaxationCandidate(Frag))
+        Worklist.push_back(&Frag);
+    }
   }
 
   // Layout until everything fits.
-  while (layoutOnce(Layout))
+  unsigned FirstStableSection = ~0u;
+  while (layoutOnce(Layout, FirstStableSection))
     if (getContext().hadError())
       return;
 
+  RelaxationWorklists.clear();
+
   DEBUG_WITH_TYPE("mc-dump", {
       errs() << "assembler backend - post-relaxation\n--\n";
       dump(); });
@@ -1053,15 +1072,43 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
   return OldSize != F.getContents().size();
 }
 
+bool MCAssembler::isRelaxationCandidate(const MCFragment &F) const {
+  switch (F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Relaxable: {
+    // Relaxation only ever grows instructions, so once an instruction has its
+    // final form there is no need to look at it again.
+    auto &RF = cast<MCRelaxableFragment>(F);
+    return getBackend().mayNeedRelaxation(RF.getInst(),
+                                          *RF.getSubtargetInfo());
+  }
+  case MCFragment::FT_Dwarf:
+  case MCFragment::FT_DwarfFrame:
+  case MCFragment::FT_LEB:
+  case MCFragment::FT_Padding:
+  case MCFragment::FT_CVInlineLines:
+  case MCFragment::FT_CVDefRange:
+    return true;
+  }
+}
+
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
+  ++stats::SectionRelaxationSteps;
+
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
+  // Attempt to relax all the fragments in the section that may still change.
+  // The worklist is kept in layout order, and fragments that reached their
+  // final form are dropped from it.
+  std::vector<MCFragment *> &Worklist = RelaxationWorklists[Sec.getOrdinal()];
+  auto Out = Worklist.begin();
+  for (MCFragment *I : Worklist) {
+    ++stats::VisitedRelaxationCandidates;
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
     switch(I->getKind()) {
@@ -1096,8 +1143,12 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
       break;
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+      FirstRelaxedFragment = I;
+    if (!RelaxedFrag || isRelaxationCandidate(*I))
+      *Out++ = I;
   }
+  Worklist.erase(Out, Worklist.end());
+
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -1105,14 +1156,27 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   return false;
 }
 
-bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
+bool MCAssembler::layoutOnce(MCAsmLayout &Layout,
+                             unsigned &FirstStableSection) {
   ++stats::RelaxationSteps;
 
+  unsigned PrevFirstStableSection = FirstStableSection;
   bool WasRelaxed = false;
-  for (iterator it = begin(), ie = end(); it != ie; ++it) {
+  unsigned Index = 0;
+  for (iterator it = begin(), ie = end(); it != ie; ++it, ++Index) {
+    // Every section was relaxed until it didn't change anymore in the previous
+    // iteration. Sections after the last one that was relaxed then only have
+    // to be visited again if a section was relaxed in this iteration.
+    if (!WasRelaxed && Index >= PrevFirstStableSection) {
+      ++stats::SkippedSectionLayouts;
+      continue;
+    }
+
     MCSection &Sec = *it;
-    while (layoutSectionOnce(Layout, Sec))
+    while (layoutSectionOnce(Layout, Sec)) {
       WasRelaxed = true;
+      FirstStableSection = Index;
+    }
   }
 
   return WasRelaxed;
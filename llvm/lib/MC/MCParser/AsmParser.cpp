@@ -143,6 +143,11 @@ private:
   /// addDirectiveHandler.
   StringMap<ExtensionDirectiveHandler> ExtensionDirectiveMap;
 
+  /// True if a parser extension registered a handler for a directive that is
+  /// also in DirectiveKindMap. Otherwise ExtensionDirectiveMap doesn't have to
+  /// be searched for directives this class knows about.
+  bool ExtensionOverridesGenericDirective = false;
+
   /// Stack of active macro instantiations.
   std::vector<MacroInstantiation*> ActiveMacros;
 
@@ -198,10 +203,14 @@ public:
   void addDirectiveHandler(StringRef Directive,
                            ExtensionDirectiveHandler Handler) override {
     ExtensionDirectiveMap[Directive] = Handler;
+    if (DirectiveKindMap.count(Directive))
+      ExtensionOverridesGenericDirective = true;
   }
 
   void addAliasForDirective(StringRef Directive, StringRef Alias) override {
     DirectiveKindMap[Directive] = DirectiveKindMap[Alias];
+    if (ExtensionDirectiveMap.count(Directive))
+      ExtensionOverridesGenericDirective = true;
   }
 
   /// @name MCAsmParser Interface
@@ -1751,13 +1760,15 @@ bool AsmParser::parseStatement(ParseStatementInfo &Info,
 
   // Handle conditional assembly here before checking for skipping.  We
   // have to do this so that .endif isn't skipped in a ".if 0" block for
-  // example.
-  StringMap<DirectiveKind>::const_iterator DirKindIt =
-      DirectiveKindMap.find(IDVal);
-  DirectiveKind DirKind = (DirKindIt == DirectiveKindMap.end())
-
-                              ? DK_NO_DIRECTIVE
-                              : DirKindIt->getValue();
+  // example. All the directives in DirectiveKindMap start with '.', so
+  // instructions don't need the lookup.
+  DirectiveKind DirKind = DK_NO_DIRECTIVE;
+  if (IDVal.startswith(".")) {
+    StringMap<DirectiveKind>::const_iterator DirKindIt =
+        DirectiveKindMap.find(IDVal);
+    if (DirKindIt != DirectiveKindMap.end())
+      DirKind = DirKindIt->getValue();
+  }
   switch (DirKind) {
   default:
     break;
@@ -1923,10 +1934,12 @@ bool AsmParser::parseStatement(ParseStatementInfo &Info,
 
     // Next, check the extension directive map to see if any extension has
     // registered itself to parse this directive.
-    std::pair<MCAsmParserExtension *, DirectiveHandler> Handler =
-        ExtensionDirectiveMap.lookup(IDVal);
-    if (Handler.first)
-      return (*Handler.second)(Handler.first, IDVal, IDLoc);
+    if (DirKind == DK_NO_DIRECTIVE || ExtensionOverridesGenericDirective) {
+      std::pair<MCAsmParserExtension *, DirectiveHandler> Handler =
+          ExtensionDirectiveMap.lookup(IDVal);
+      if (Handler.first)
+        return (*Handler.second)(Handler.first, IDVal, IDLoc);
+    }
 
     // Finally, if no one else is interested in this directive, it must be
     // generic and familiar to this class.
@@ -5470,6 +5483,11 @@ void AsmParser::initializeDirectiveKindMap() {
   DirectiveKindMap[".print"] = DK_PRINT;
   DirectiveKindMap[".addrsig"] = DK_ADDRSIG;
   DirectiveKindMap[".addrsig_sym"] = DK_ADDRSIG_SYM;
+
+  // The platform parser has already registered its directives.
+  for (const auto &Entry : ExtensionDirectiveMap)
+    if (DirectiveKindMap.count(Entry.getKey()))
+      ExtensionOverridesGenericDirective = true;
 }
 
 MCAsmMacro *AsmParser::parseMacroLikeBody(SMLoc DirectiveLoc) {
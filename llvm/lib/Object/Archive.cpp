@@ -18,10 +18,12 @@
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/Error.h"
 #include "llvm/Support/Chrono.h"
+#include "llvm/Support/DJB.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -989,6 +991,49 @@ Expected<Optional<Archive::Child>> Archive::findSym(StringRef name) const {
   return Optional<Child>();
 }
 
+ArchiveSymbolIndex::ArchiveSymbolIndex(const Archive &A) : Parent(A) {
+  uint32_t NumSymbols = A.getNumberOfSymbols();
+  if (NumSymbols == 0)
+    return;
+  // Keep the load factor at or below one half.
+  Buckets.resize(PowerOf2Ceil(uint64_t(NumSymbols) * 2));
+  size_t Mask = Buckets.size() - 1;
+  for (const Archive::Symbol &S : A.symbols()) {
+    StringRef Name = S.getName();
+    uint32_t Hash = djbHash(Name);
+    for (size_t I = Hash & Mask;; I = (I + 1) & Mask) {
+      Bucket &B = Buckets[I];
+      if (B.SymbolIndex == UINT32_MAX) {
+        B = {Hash, S.SymbolIndex, S.StringIndex};
+        ++NumEntries;
+        break;
+      }
+      // Like findSym, resolve a duplicate name to its first definition.
+      if (B.Hash == Hash &&
+          Archive::Symbol(&Parent, B.SymbolIndex, B.StringIndex).getName() ==
+              Name)
+        break;
+    }
+  }
+}
+
+Optional<Archive::Symbol> ArchiveSymbolIndex::lookup(StringRef Name) const {
+  if (Buckets.empty())
+    return None;
+  uint32_t Hash = djbHash(Name);
+  size_t Mask = Buckets.size() - 1;
+  for (size_t I = Hash & Mask;; I = (I + 1) & Mask) {
+    const Bucket &B = Buckets[I];
+    if (B.SymbolIndex == UINT32_MAX)
+      return None;
+    if (B.Hash != Hash)
+      continue;
+    Archive::Symbol S(&Parent, B.SymbolIndex, B.StringIndex);
+    if (S.getName() == Name)
+      return S;
+  }
+}
+
 // Returns true if archive file contains no member file.
 bool Archive::isEmpty() const { return Data.getBufferSize() == 8; }
 
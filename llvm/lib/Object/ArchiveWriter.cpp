@@ -23,6 +23,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -384,10 +385,50 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   return Ret;
 }
 
+namespace {
+/// The symbols of one member, computed independently of the other members.
+struct MemberSymbols {
+  /// The offsets of the symbol names in Names.
+  std::vector<unsigned> Offsets;
+  std::string Names;
+  bool HasObject = false;
+  Error Err = Error::success();
+};
+} // namespace
+
+/// Read the symbols of the members that don't already know them. Opening a
+/// member as a SymbolicFile is the expensive part of writing an archive,
+/// bitcode members in particular, so the members are read in parallel.
+static std::vector<MemberSymbols>
+computeMemberSymbols(ArrayRef<NewArchiveMember> NewMembers) {
+  std::vector<MemberSymbols> Ret(NewMembers.size());
+  auto ComputeSymbols = [&](size_t I) {
+    if (NewMembers[I].Symbols)
+      return;
+    MemberSymbols &Syms = Ret[I];
+    raw_string_ostream Names(Syms.Names);
+    Expected<std::vector<unsigned>> OffsetsOrErr =
+        getSymbols(NewMembers[I].Buf->getMemBufferRef(), Names, Syms.HasObject);
+    Names.flush();
+    if (OffsetsOrErr)
+      Syms.Offsets = std::move(*OffsetsOrErr);
+    else
+      Syms.Err = OffsetsOrErr.takeError();
+  };
+#if LLVM_ENABLE_THREADS
+  parallel::for_each_n(parallel::par, size_t(0), NewMembers.size(),
+                       ComputeSymbols);
+#else
+  parallel::for_each_n(parallel::seq, size_t(0), NewMembers.size(),
+                       ComputeSymbols);
+#endif
+  return Ret;
+}
+
 static Expected<std::vector<MemberData>>
 computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                   object::Archive::Kind Kind, bool Thin, bool Deterministic,
-                  ArrayRef<NewArchiveMember> NewMembers) {
+                  bool NeedSymbols, ArrayRef<NewArchiveMember> NewMembers) {
   static char PaddingData[8] = {'\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n'};
 
   // This ignores the symbol table, but we only need the value mod 8 and the
@@ -452,7 +493,22 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
-  for (const NewArchiveMember &M : NewMembers) {
+  std::vector<MemberSymbols> Symbols;
+  if (NeedSymbols)
+    Symbols = computeMemberSymbols(NewMembers);
+  // Report the first error in member order, as reading the members serially
+  // would.
+  for (size_t I = 0, E = Symbols.size(); I != E; ++I) {
+    if (!Symbols[I].Err)
+      continue;
+    Error Err = std::move(Symbols[I].Err);
+    for (++I; I != E; ++I)
+      consumeError(std::move(Symbols[I].Err));
+    return std::move(Err);
+  }
+
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -487,13 +543,30 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Size);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    // Lay out the symbol names in member order, so that the symbol table
+    // doesn't depend on the order the members were read in.
+    std::vector<unsigned> SymOffsets;
+    if (NeedSymbols && M.Symbols) {
+      for (StringRef Name : *M.Symbols) {
+        SymOffsets.push_back(SymNames.tell());
+        SymNames << Name << '\0';
+      }
+      HasObject |= !M.Symbols->empty();
+    } else if (NeedSymbols) {
+      MemberSymbols &Syms = Symbols[I];
+      unsigned Base = SymNames.tell();
+      SymNames << Syms.Names;
+      for (unsigned Offset : Syms.Offsets)
+        SymOffsets.push_back(Base + Offset);
+      HasObject |= Syms.HasObject;
+      // Release the names now rather than holding every member's copy
+      // until the archive is written.
+      Syms.Names.clear();
+      Syms.Names.shrink_to_fit();
+    }
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({std::move(SymOffsets), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
@@ -558,7 +631,8 @@ Error writeArchive(StringRef ArcName, ArrayRef<NewArchiveMember> NewMembers,
   raw_svector_ostream StringTable(StringTableBuf);
 
   Expected<std::vector<MemberData>> DataOrErr = computeMemberData(
-      StringTable, SymNames, Kind, Thin, Deterministic, NewMembers);
+      StringTable, SymNames, Kind, Thin, Deterministic, WriteSymtab,
+      NewMembers);
   if (Error E = DataOrErr.takeError())
     return E;
   std::vector<MemberData> &Data = *DataOrErr;
@@ -137,6 +137,7 @@
 #include "llvm/Transforms/Scalar/LoopSimplifyCFG.h"
 #include "llvm/Transforms/Scalar/LoopSink.h"
 #include "llvm/Transforms/Scalar/LoopStrengthReduce.h"
+#include "llvm/Transforms/Scalar/LoopTiling.h"
 #include "llvm/Transforms/Scalar/LoopUnrollAndJamPass.h"
 #include "llvm/Transforms/Scalar/LoopUnrollPass.h"
 #include "llvm/Transforms/Scalar/LowerAtomic.h"
@@ -203,11 +204,20 @@ static cl::opt<bool> EnableUnrollAndJam(
     "enable-npm-unroll-and-jam", cl::init(false), cl::Hidden,
     cl::desc("Enable the Unroll and Jam pass for the new PM (default = off)"));
 
+static cl::opt<bool> EnableLoopTiling(
+    "enable-npm-loop-tiling", cl::init(false), cl::Hidden,
+    cl::desc("Enable the Loop Tiling pass for the new PM (default = off)"));
+
 static cl::opt<bool> EnableSyntheticCounts(
     "enable-npm-synthetic-counts", cl::init(false), cl::Hidden, cl::ZeroOrMore,
     cl::desc("Run synthetic function entry count generation "
              "pass"));
 
+static cl::opt<bool> VerifyEachIncremental(
+    "verify-each-incremental", cl::init(false), cl::Hidden,
+    cl::desc("When verifying after each module pass, only re-verify the "
+             "functions whose verifier result was invalidated"));
+
 static Regex DefaultAliasRegex(
     "^(default|thinlto-pre-link|thinlto|lto-pre-link|lto)<(O[0123sz])>$");
 
@@ -228,6 +238,7 @@ PipelineTuningOptions::PipelineTuningOptions() {
 }
 
 extern cl::opt<bool> EnableHotColdSplit;
+extern cl::opt<bool> EnableHotColdSplitWithSampleProfile;
 extern cl::opt<bool> EnableOrderFileInstrumentation;
 
 extern cl::opt<bool> FlattenedProfileUsed;
@@ -247,6 +258,14 @@ static bool isOptimizingForSize(PassBuilder::OptimizationLevel Level) {
   llvm_unreachable("Invalid optimization level!");
 }
 
+/// Hot/cold splitting is run on request, and by default when optimizing with
+/// a sample profile (\ref PassManagerBuilder::shouldSplitColdCode).
+static bool shouldSplitColdCode(const Optional<PGOOptions> &PGOOpt) {
+  return EnableHotColdSplit ||
+         (EnableHotColdSplitWithSampleProfile && PGOOpt &&
+          PGOOpt->Action == PGOOptions::SampleUse);
+}
+
 namespace {
 
 /// No-op module pass which does nothing.
@@ -725,6 +744,9 @@ PassBuilder::buildModuleSimplificationPipeline(OptimizationLevel Level,
   // they may target at run-time. This should follow IPSCCP.
   MPM.addPass(CalledValuePropagationPass());
 
+  // Infer attributes on declarations, call sites, arguments, etc.
+  MPM.addPass(AttributorPass());
+
   // Optimize globals to try and fold them into constants.
   MPM.addPass(GlobalOptPass());
 
@@ -941,6 +963,10 @@ ModulePassManager PassBuilder::buildModuleOptimizationPipeline(
   // FIXME: It would be really good to use a loop-integrated instruction
   // combiner for cleanup here so that the unrolling and LICM can be pipelined
   // across the loop nests.
+  // Tile loop nests before unrolling so that the unroller sees the final
+  // inner loops.
+  if (EnableLoopTiling)
+    OptimizePM.addPass(LoopTilingPass());
   // We do UnrollAndJam in a separate LPM to ensure it happens before unroll
   if (EnableUnrollAndJam) {
     OptimizePM.addPass(
@@ -963,7 +989,7 @@ ModulePassManager PassBuilder::buildModuleOptimizationPipeline(
   // Split out cold code. Splitting is done late to avoid hiding context from
   // other optimizations and inadvertently regressing performance. The tradeoff
   // is that this has a higher code size cost than splitting early.
-  if (EnableHotColdSplit && !LTOPreLink)
+  if (shouldSplitColdCode(PGOOpt) && !LTOPreLink)
     MPM.addPass(HotColdSplittingPass());
 
   // LoopSink pass sinks instructions hoisted by LICM, which serves as a
@@ -1176,6 +1202,9 @@ PassBuilder::buildLTODefaultPipeline(OptimizationLevel Level, bool DebugLogging,
    // Attach metadata to indirect call sites indicating the set of functions
    // they may target at run-time. This should follow IPSCCP.
    MPM.addPass(CalledValuePropagationPass());
+
+   // Infer attributes on declarations, call sites, arguments, etc.
+   MPM.addPass(AttributorPass());
   }
 
   // Now deduce any function attributes based in the current code.
@@ -1329,7 +1358,7 @@ PassBuilder::buildLTODefaultPipeline(OptimizationLevel Level, bool DebugLogging,
 
   // Enable splitting late in the FullLTO post-link pipeline. This is done in
   // the same stage in the old pass manager (\ref addLateLTOOptimizationPasses).
-  if (EnableHotColdSplit)
+  if (shouldSplitColdCode(PGOOpt))
     MPM.addPass(HotColdSplittingPass());
 
   // Add late LTO optimization passes.
@@ -2206,7 +2235,7 @@ Error PassBuilder::parseModulePassPipeline(ModulePassManager &MPM,
     if (auto Err = parseModulePass(MPM, Element, VerifyEachPass, DebugLogging))
       return Err;
     if (VerifyEachPass)
-      MPM.addPass(VerifierPass());
+      MPM.addPass(VerifierPass(/*FatalErrors=*/true, VerifyEachIncremental));
   }
   return Error::success();
 }
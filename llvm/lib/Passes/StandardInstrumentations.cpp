@@ -14,6 +14,7 @@
 
 #include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Analysis/LazyCallGraph.h"
 #include "llvm/Analysis/LoopInfo.h"
@@ -21,12 +22,30 @@
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace llvm;
 
+static cl::opt<bool> AuditAnalysisInvalidation(
+    "audit-analysis-invalidation", cl::Hidden,
+    cl::desc("Report the passes that cause analyses to be recomputed, and the "
+             "time spent recomputing them (new pass manager only)"));
+
+static cl::opt<std::string> PassTelemetryFile(
+    "pass-telemetry-file", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Append the time, instruction count change and malloc usage "
+             "change of each pass run to this file as JSON lines (new pass "
+             "manager only)"));
+
 namespace {
 
 /// Extracting Module out of \p IR unit. Also fills a textual description
@@ -235,8 +254,230 @@ void PrintIRInstrumentation::registerCallbacks(
   }
 }
 
+/// Returns the IR unit wrapped in \p IR.
+static const void *getIRUnit(Any IR) {
+  if (any_isa<const Module *>(IR))
+    return any_cast<const Module *>(IR);
+  if (any_isa<const Function *>(IR))
+    return any_cast<const Function *>(IR);
+  if (any_isa<const LazyCallGraph::SCC *>(IR))
+    return any_cast<const LazyCallGraph::SCC *>(IR);
+  if (any_isa<const Loop *>(IR))
+    return any_cast<const Loop *>(IR);
+  llvm_unreachable("Unknown IR unit");
+}
+
+static double getCurrentWallTime() {
+  return TimeRecord::getCurrentTime(/*Start=*/false).getWallTime();
+}
+
+void AnalysisInvalidationAudit::analysisInvalidated(StringRef AnalysisID,
+                                                    Any IR) {
+  InvalidatedBy[{getIRUnit(IR), AnalysisID}] = LastPassID;
+}
+
+void AnalysisInvalidationAudit::beforeAnalysis() {
+  RunningAnalyses.push_back({getCurrentWallTime(), 0.0});
+}
+
+void AnalysisInvalidationAudit::afterAnalysis(StringRef AnalysisID, Any IR) {
+  double Start, Nested;
+  std::tie(Start, Nested) = RunningAnalyses.pop_back_val();
+  double Elapsed = getCurrentWallTime() - Start;
+  if (!RunningAnalyses.empty())
+    RunningAnalyses.back().second += Elapsed;
+
+  ResultKey Key(getIRUnit(IR), AnalysisID);
+  if (Computed.insert(Key).second)
+    return;
+  // Results can also be thrown away wholesale, for example when a proxy to an
+  // outer analysis manager is invalidated.
+  StringRef Cause = "<cleared>";
+  auto It = InvalidatedBy.find(Key);
+  if (It != InvalidatedBy.end()) {
+    Cause = It->second;
+    InvalidatedBy.erase(It);
+  }
+  Recomputations &R = Totals[{AnalysisID, Cause}];
+  ++R.Count;
+  R.Seconds += Elapsed - Nested;
+}
+
+void AnalysisInvalidationAudit::print() {
+  if (Totals.empty())
+    return;
+
+  using Entry = std::pair<std::pair<StringRef, StringRef>, Recomputations>;
+  std::vector<Entry> Entries(Totals.begin(), Totals.end());
+  llvm::sort(Entries, [](const Entry &A, const Entry &B) {
+    return A.second.Seconds > B.second.Seconds;
+  });
+
+  std::unique_ptr<raw_ostream> OS = CreateInfoOutputFile();
+  *OS << "===" << std::string(73, '-') << "===\n"
+      << "                      Analysis recomputation report\n"
+      << "===" << std::string(73, '-') << "===\n"
+      << "  Wall Time   Count  Analysis (invalidated by)\n";
+  for (const Entry &E : Entries)
+    *OS << formatv("  {0,9:f4} {1,7}  {2} ({3})\n", E.second.Seconds,
+                   E.second.Count, E.first.first, E.first.second);
+  OS->flush();
+  Totals.clear();
+}
+
+void AnalysisInvalidationAudit::registerCallbacks(
+    PassInstrumentationCallbacks &PIC) {
+  if (!AuditAnalysisInvalidation)
+    return;
+
+  auto SetLastPass = [this](StringRef P) {
+    // Pass managers and adaptors only forward the invalidation done by the
+    // passes they run.
+    if (!P.startswith("PassManager<") && !P.contains("PassAdaptor<"))
+      LastPassID = P;
+  };
+  PIC.registerAfterPassCallback(
+      [SetLastPass](StringRef P, Any) { SetLastPass(P); });
+  PIC.registerAfterPassInvalidatedCallback(SetLastPass);
+  PIC.registerAnalysisInvalidatedCallback(
+      [this](StringRef A, Any IR) { analysisInvalidated(A, IR); });
+  PIC.registerBeforeAnalysisCallback(
+      [this](StringRef, Any) { beforeAnalysis(); });
+  PIC.registerAfterAnalysisCallback(
+      [this](StringRef A, Any IR) { afterAnalysis(A, IR); });
+}
+
+/// Returns the module identifier, the name and the number of instructions of
+/// the IR unit wrapped in \p IR.
+static std::tuple<std::string, std::string, int64_t> describeIRUnit(Any IR) {
+  if (any_isa<const Module *>(IR)) {
+    auto *M = const_cast<Module *>(any_cast<const Module *>(IR));
+    return std::make_tuple(M->getModuleIdentifier(), M->getName().str(),
+                           M->getInstructionCount());
+  }
+  if (any_isa<const Function *>(IR)) {
+    const Function *F = any_cast<const Function *>(IR);
+    return std::make_tuple(F->getParent()->getModuleIdentifier(),
+                           F->getName().str(), F->getInstructionCount());
+  }
+  if (any_isa<const LazyCallGraph::SCC *>(IR)) {
+    const LazyCallGraph::SCC *C = any_cast<const LazyCallGraph::SCC *>(IR);
+    std::string ModuleID;
+    int64_t Count = 0;
+    for (const LazyCallGraph::Node &N : *C) {
+      ModuleID = N.getFunction().getParent()->getModuleIdentifier();
+      Count += N.getFunction().getInstructionCount();
+    }
+    return std::make_tuple(ModuleID, C->getName(), Count);
+  }
+  if (any_isa<const Loop *>(IR)) {
+    const Loop *L = any_cast<const Loop *>(IR);
+    int64_t Count = 0;
+    for (const BasicBlock *BB : L->blocks())
+      Count += BB->size();
+    std::string Name;
+    raw_string_ostream OS(Name);
+    L->getHeader()->printAsOperand(OS, false);
+    return std::make_tuple(
+        L->getHeader()->getParent()->getParent()->getModuleIdentifier(),
+        OS.str(), Count);
+  }
+  llvm_unreachable("Unknown IR unit");
+}
+
+void PassTelemetry::beforePass(StringRef PassID, Any IR) {
+  Run R;
+  R.PassID = PassID;
+  std::tie(R.ModuleID, R.IRName, R.InstructionsBefore) = describeIRUnit(IR);
+  if (TimeTrace)
+    timeTraceProfilerBegin(PassID, StringRef(R.IRName));
+  R.Seconds = getCurrentWallTime();
+  Running.push_back({std::move(R), sys::Process::GetMallocUsage()});
+}
+
+void PassTelemetry::afterPass(StringRef PassID, Optional<Any> IR) {
+  // A pass that another instrumentation skipped does not get an AfterPass
+  // callback, so drop the passes that were started but not finished.
+  while (!Running.empty() && Running.back().first.PassID != PassID) {
+    Running.pop_back();
+    if (TimeTrace)
+      timeTraceProfilerEnd();
+  }
+  if (Running.empty())
+    return;
+
+  Run R = std::move(Running.back().first);
+  size_t MallocBefore = Running.back().second;
+  Running.pop_back();
+  R.Seconds = getCurrentWallTime() - R.Seconds;
+  R.MallocDelta = int64_t(sys::Process::GetMallocUsage()) - MallocBefore;
+  R.InstructionsAfter = IR ? std::get<2>(describeIRUnit(*IR)) : -1;
+  if (TimeTrace)
+    timeTraceProfilerEnd();
+  if (Record)
+    Runs.push_back(std::move(R));
+}
+
+void PassTelemetry::write() {
+  if (Runs.empty())
+    return;
+
+  std::error_code EC;
+  raw_fd_ostream OS(PassTelemetryFile, EC, sys::fs::OF_Append);
+  if (EC) {
+    errs() << "Could not open pass telemetry file '" << PassTelemetryFile
+           << "': " << EC.message() << "\n";
+    Runs.clear();
+    return;
+  }
+  for (const Run &R : Runs) {
+    json::OStream J(OS);
+    J.object([&] {
+      J.attribute("module", R.ModuleID);
+      J.attribute("pass", R.PassID);
+      J.attribute("ir", R.IRName);
+      J.attribute("wall_us", int64_t(R.Seconds * 1e6));
+      J.attribute("instrs_before", R.InstructionsBefore);
+      if (R.InstructionsAfter >= 0)
+        J.attribute("instrs_after", R.InstructionsAfter);
+      else
+        J.attribute("invalidated", true);
+      J.attribute("malloc_delta", R.MallocDelta);
+    });
+    OS << '\n';
+  }
+  Runs.clear();
+}
+
+void PassTelemetry::registerCallbacks(PassInstrumentationCallbacks &PIC) {
+  Record = !PassTelemetryFile.empty();
+  TimeTrace = timeTraceProfilerEnabled();
+  if (!Record && !TimeTrace)
+    return;
+
+  // Pass managers and adaptors only add up the passes they run.
+  auto IsContainer = [](StringRef P) {
+    return P.startswith("PassManager<") || P.contains("PassAdaptor<");
+  };
+  PIC.registerBeforePassCallback([this, IsContainer](StringRef P, Any IR) {
+    if (!IsContainer(P))
+      beforePass(P, IR);
+    return true;
+  });
+  PIC.registerAfterPassCallback([this, IsContainer](StringRef P, Any IR) {
+    if (!IsContainer(P))
+      afterPass(P, IR);
+  });
+  PIC.registerAfterPassInvalidatedCallback([this, IsContainer](StringRef P) {
+    if (!IsContainer(P))
+      afterPass(P, None);
+  });
+}
+
 void StandardInstrumentations::registerCallbacks(
     PassInstrumentationCallbacks &PIC) {
   PrintIR.registerCallbacks(PIC);
   TimePasses.registerCallbacks(PIC);
+  InvalidationAudit.registerCallbacks(PIC);
+  Telemetry.registerCallbacks(PIC);
 }
@@ -27,6 +27,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -34,6 +36,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -194,9 +197,17 @@ void FunctionRecordIterator::skipOtherFiles() {
     *this = FunctionRecordIterator();
 }
 
-Error CoverageMapping::loadFunctionRecord(
-    const CoverageMappingRecord &Record,
-    IndexedInstrProfReader &ProfileReader) {
+/// Evaluate the regions of \p Record with the counts \p ProfileReader has for
+/// it. On success, \p Function holds the resulting record unless the record
+/// should be ignored, and \p HashMismatch tells whether that is because the
+/// profile is out of date. If \p ProfileLock is set, it is held while
+/// accessing \p ProfileReader.
+static Error buildFunctionRecord(const CoverageMappingRecord &Record,
+                                 IndexedInstrProfReader &ProfileReader,
+                                 std::mutex *ProfileLock,
+                                 Optional<FunctionRecord> &Function,
+                                 bool &HashMismatch) {
+  HashMismatch = false;
   StringRef OrigFuncName = Record.FunctionName;
   if (OrigFuncName.empty())
     return make_error<CoverageMapError>(coveragemap_error::malformed);
@@ -209,11 +220,17 @@ Error CoverageMapping::loadFunctionRecord(
   CounterMappingContext Ctx(Record.Expressions);
 
   std::vector<uint64_t> Counts;
-  if (Error E = ProfileReader.getFunctionCounts(Record.FunctionName,
-                                                Record.FunctionHash, Counts)) {
-    instrprof_error IPE = InstrProfError::take(std::move(E));
+  Error CountsErr = [&] {
+    std::unique_lock<std::mutex> Lock;
+    if (ProfileLock)
+      Lock = std::unique_lock<std::mutex>(*ProfileLock);
+    return ProfileReader.getFunctionCounts(Record.FunctionName,
+                                           Record.FunctionHash, Counts);
+  }();
+  if (CountsErr) {
+    instrprof_error IPE = InstrProfError::take(std::move(CountsErr));
     if (IPE == instrprof_error::hash_mismatch) {
-      FuncHashMismatches.emplace_back(Record.FunctionName, Record.FunctionHash);
+      HashMismatch = true;
       return Error::success();
     } else if (IPE != instrprof_error::unknown_function)
       return make_error<InstrProfError>(IPE);
@@ -232,32 +249,137 @@ Error CoverageMapping::loadFunctionRecord(
       Record.MappingRegions[0].Count.isZero() && Counts[0] > 0)
     return Error::success();
 
-  FunctionRecord Function(OrigFuncName, Record.Filenames);
+  FunctionRecord Result(OrigFuncName, Record.Filenames);
   for (const auto &Region : Record.MappingRegions) {
     Expected<int64_t> ExecutionCount = Ctx.evaluate(Region.Count);
     if (auto E = ExecutionCount.takeError()) {
       consumeError(std::move(E));
       return Error::success();
     }
-    Function.pushRegion(Region, *ExecutionCount);
+    Result.pushRegion(Region, *ExecutionCount);
   }
+  Function = std::move(Result);
+  return Error::success();
+}
 
+void CoverageMapping::addFunctionRecord(FunctionRecord &&Function) {
   // Don't create records for (filenames, function) pairs we've already seen.
-  auto FilenamesHash = hash_combine_range(Record.Filenames.begin(),
-                                          Record.Filenames.end());
-  if (!RecordProvenance[FilenamesHash].insert(hash_value(OrigFuncName)).second)
-    return Error::success();
+  auto FilenamesHash = hash_combine_range(Function.Filenames.begin(),
+                                          Function.Filenames.end());
+  if (!RecordProvenance[FilenamesHash].insert(hash_value(Function.Name)).second)
+    return;
+
+  // Index the record by the files it references, so that the per-file queries
+  // don't have to look at every function.
+  unsigned RecordIndex = Functions.size();
+  for (StringRef Filename : Function.Filenames) {
+    auto &RecordIndices = FilenameHash2RecordIndices[hash_value(Filename)];
+    if (RecordIndices.empty() || RecordIndices.back() != RecordIndex)
+      RecordIndices.push_back(RecordIndex);
+  }
 
   Functions.push_back(std::move(Function));
+}
+
+Error CoverageMapping::loadFunctionRecord(
+    const CoverageMappingRecord &Record,
+    IndexedInstrProfReader &ProfileReader) {
+  Optional<FunctionRecord> Function;
+  bool HashMismatch;
+  if (Error E = buildFunctionRecord(Record, ProfileReader,
+                                    /*ProfileLock=*/nullptr, Function,
+                                    HashMismatch))
+    return E;
+  if (HashMismatch)
+    FuncHashMismatches.emplace_back(Record.FunctionName, Record.FunctionHash);
+  else if (Function)
+    addFunctionRecord(std::move(*Function));
+  return Error::success();
+}
+
+Error CoverageMapping::loadFunctionRecordsInParallel(
+    const CoverageMappingReader &CoverageReader, size_t NumRecords,
+    IndexedInstrProfReader &ProfileReader, unsigned NumThreads) {
+  struct LoadedRecord {
+    Optional<FunctionRecord> Function;
+    bool HashMismatch = false;
+    StringRef FunctionName;
+    uint64_t FunctionHash = 0;
+  };
+  std::vector<LoadedRecord> Loaded(NumRecords);
+
+  // The profile reader isn't thread safe, so the lookups are serialized. The
+  // decoding and the evaluation of the regions, which is where the time goes,
+  // run in parallel.
+  std::mutex ProfileLock;
+  std::mutex ErrorLock;
+  size_t ErrorIndex = NumRecords;
+  Error FirstError = Error::success();
+  auto LoadRange = [&](size_t Begin, size_t End) {
+    CoverageMappingRecord Record;
+    CoverageMappingRecordBuffers Buffers;
+    for (size_t I = Begin; I != End; ++I) {
+      LoadedRecord &R = Loaded[I];
+      Error E = CoverageReader.readRecord(I, Record, Buffers);
+      if (!E)
+        E = buildFunctionRecord(Record, ProfileReader, &ProfileLock,
+                                R.Function, R.HashMismatch);
+      if (E) {
+        // Only report the first error in record order, like the serial
+        // loader does.
+        std::lock_guard<std::mutex> Lock(ErrorLock);
+        if (I < ErrorIndex) {
+          consumeError(std::move(FirstError));
+          FirstError = std::move(E);
+          ErrorIndex = I;
+        } else {
+          consumeError(std::move(E));
+        }
+        return;
+      }
+      R.FunctionName = Record.FunctionName;
+      R.FunctionHash = Record.FunctionHash;
+    }
+  };
+
+  // Use several chunks per thread to even out the load.
+  size_t ChunkSize = std::max<size_t>(1, NumRecords / (NumThreads * 8));
+  {
+    ThreadPool Pool(NumThreads);
+    for (size_t Begin = 0; Begin < NumRecords; Begin += ChunkSize)
+      Pool.async(LoadRange, Begin, std::min(NumRecords, Begin + ChunkSize));
+    Pool.wait();
+  }
+  if (FirstError)
+    return FirstError;
+
+  for (LoadedRecord &R : Loaded) {
+    if (R.HashMismatch)
+      FuncHashMismatches.emplace_back(R.FunctionName, R.FunctionHash);
+    else if (R.Function)
+      addFunctionRecord(std::move(*R.Function));
+  }
   return Error::success();
 }
 
 Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
     ArrayRef<std::unique_ptr<CoverageMappingReader>> CoverageReaders,
-    IndexedInstrProfReader &ProfileReader) {
+    IndexedInstrProfReader &ProfileReader, unsigned NumThreads) {
   auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
 
+  if (NumThreads == 0)
+    NumThreads = heavyweight_hardware_concurrency();
+
   for (const auto &CoverageReader : CoverageReaders) {
+    Optional<size_t> NumRecords = CoverageReader->getNumRecords();
+    if (NumThreads > 1 && NumRecords && *NumRecords > 1) {
+      if (Error E = Coverage->loadFunctionRecordsInParallel(
+              *CoverageReader, *NumRecords, ProfileReader,
+              std::min<size_t>(NumThreads, *NumRecords)))
+        return std::move(E);
+      continue;
+    }
+
     for (auto RecordOrErr : *CoverageReader) {
       if (Error E = RecordOrErr.takeError())
         return std::move(E);
@@ -272,7 +394,8 @@ Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
 
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
-                      StringRef ProfileFilename, ArrayRef<StringRef> Arches) {
+                      StringRef ProfileFilename, ArrayRef<StringRef> Arches,
+                      unsigned NumThreads) {
   auto ProfileReaderOrErr = IndexedInstrProfReader::create(ProfileFilename);
   if (Error E = ProfileReaderOrErr.takeError())
     return std::move(E);
@@ -295,7 +418,7 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
       Readers.push_back(std::move(Reader));
     Buffers.push_back(std::move(CovMappingBufOrErr.get()));
   }
-  return load(Readers, *ProfileReader);
+  return load(Readers, *ProfileReader, NumThreads);
 }
 
 namespace {
@@ -568,6 +691,15 @@ std::vector<StringRef> CoverageMapping::getUniqueSourceFiles() const {
   return Filenames;
 }
 
+ArrayRef<unsigned> CoverageMapping::getImpreciseRecordIndicesForFilename(
+    StringRef Filename) const {
+  size_t FilenameHash = hash_value(Filename);
+  auto RecordIt = FilenameHash2RecordIndices.find(FilenameHash);
+  if (RecordIt == FilenameHash2RecordIndices.end())
+    return {};
+  return RecordIt->second;
+}
+
 static SmallBitVector gatherFileIDs(StringRef SourceFile,
                                     const FunctionRecord &Function) {
   SmallBitVector FilenameEquivalence(Function.Filenames.size(), false);
@@ -607,7 +739,8 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
   CoverageData FileCoverage(Filename);
   std::vector<CountedRegion> Regions;
 
-  for (const auto &Function : Functions) {
+  for (unsigned RecordIndex : getImpreciseRecordIndicesForFilename(Filename)) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     auto FileIDs = gatherFileIDs(Filename, Function);
     for (const auto &CR : Function.CountedRegions)
@@ -627,7 +760,8 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
 std::vector<InstantiationGroup>
 CoverageMapping::getInstantiationGroups(StringRef Filename) const {
   FunctionInstantiationSetCollector InstantiationSetCollector;
-  for (const auto &Function : Functions) {
+  for (unsigned RecordIndex : getImpreciseRecordIndicesForFilename(Filename)) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     if (!MainFileID)
       continue;
@@ -752,6 +886,8 @@ static std::string getCoverageMapErrString(coveragemap_error Err) {
     return "Truncated coverage data";
   case coveragemap_error::malformed:
     return "Malformed coverage data";
+  case coveragemap_error::decompression_failed:
+    return "Failed to decompress coverage data (zlib)";
   }
   llvm_unreachable("A value of coveragemap_error has no message.");
 }
@@ -25,6 +25,7 @@
 #include "llvm/Object/COFF.h"
 #include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -92,10 +93,63 @@ Error RawCoverageReader::readString(StringRef &Result) {
   return Error::success();
 }
 
-Error RawCoverageFilenamesReader::read() {
+Error RawCoverageReader::readCompressible(
+    StringRef &Result, DecompressedCoverageData &Decompressed) {
+  uint64_t UncompressedLen;
+  if (auto Err = readULEB128(UncompressedLen))
+    return Err;
+  uint64_t CompressedLen;
+  if (auto Err = readSize(CompressedLen))
+    return Err;
+
+  if (CompressedLen == 0) {
+    if (UncompressedLen > Data.size())
+      return make_error<CoverageMapError>(coveragemap_error::malformed);
+    Result = Data.substr(0, UncompressedLen);
+    Data = Data.substr(UncompressedLen);
+    return Error::success();
+  }
+
+  if (!zlib::isAvailable())
+    return make_error<CoverageMapError>(
+        coveragemap_error::decompression_failed);
+
+  auto Storage = std::make_unique<SmallVector<char, 0>>();
+  if (Error E = zlib::uncompress(Data.substr(0, CompressedLen), *Storage,
+                                 UncompressedLen)) {
+    consumeError(std::move(E));
+    return make_error<CoverageMapError>(
+        coveragemap_error::decompression_failed);
+  }
+  Result = StringRef(Storage->data(), Storage->size());
+  Data = Data.substr(CompressedLen);
+  Decompressed.push_back(std::move(Storage));
+  return Error::success();
+}
+
+Error RawCoverageFilenamesReader::read(CovMapVersion Version,
+                                       DecompressedCoverageData &Decompressed) {
   uint64_t NumFilenames;
-  if (auto Err = readSize(NumFilenames))
+  if (Version < CovMapVersion::Version4) {
+    if (auto Err = readSize(NumFilenames))
+      return Err;
+    return readUncompressed(NumFilenames);
+  }
+
+  // The compressed filenames may be smaller than their number, so only the
+  // uncompressed data can sanity check it.
+  if (auto Err = readULEB128(NumFilenames))
+    return Err;
+  StringRef FilenamesData;
+  if (auto Err = readCompressible(FilenamesData, Decompressed))
     return Err;
+  RawCoverageFilenamesReader Delegate(FilenamesData, Filenames);
+  return Delegate.readUncompressed(NumFilenames);
+}
+
+Error RawCoverageFilenamesReader::readUncompressed(uint64_t NumFilenames) {
+  if (NumFilenames > Data.size())
+    return make_error<CoverageMapError>(coveragemap_error::malformed);
   for (size_t I = 0; I < NumFilenames; ++I) {
     StringRef Filename;
     if (auto Err = readString(Filename))
@@ -382,6 +436,16 @@ static Expected<bool> isCoverageMappingDummy(uint64_t Hash, StringRef Mapping) {
 
 namespace {
 
+/// Reader of the possibly compressed coverage mappings of a translation unit.
+class CompressedMappingsReader : public RawCoverageReader {
+public:
+  CompressedMappingsReader(StringRef Data) : RawCoverageReader(Data) {}
+
+  Error read(StringRef &Mappings, DecompressedCoverageData &Decompressed) {
+    return readCompressible(Mappings, Decompressed);
+  }
+};
+
 struct CovMapFuncRecordReader {
   virtual ~CovMapFuncRecordReader() = default;
 
@@ -399,7 +463,7 @@ struct CovMapFuncRecordReader {
   static Expected<std::unique_ptr<CovMapFuncRecordReader>>
   get(CovMapVersion Version, InstrProfSymtab &P,
       std::vector<BinaryCoverageReader::ProfileMappingRecord> &R,
-      std::vector<StringRef> &F);
+      std::vector<StringRef> &F, DecompressedCoverageData &D);
 };
 
 // A class for reading coverage mapping function records for a module.
@@ -415,6 +479,7 @@ class VersionedCovMapFuncRecordReader : public CovMapFuncRecordReader {
   InstrProfSymtab &ProfileNames;
   std::vector<StringRef> &Filenames;
   std::vector<BinaryCoverageReader::ProfileMappingRecord> &Records;
+  DecompressedCoverageData &Decompressed;
 
   // Add the record to the collection if we don't already have a record that
   // points to the same function name. This is useful to ignore the redundant
@@ -465,8 +530,8 @@ public:
   VersionedCovMapFuncRecordReader(
       InstrProfSymtab &P,
       std::vector<BinaryCoverageReader::ProfileMappingRecord> &R,
-      std::vector<StringRef> &F)
-      : ProfileNames(P), Filenames(F), Records(R) {}
+      std::vector<StringRef> &F, DecompressedCoverageData &D)
+      : ProfileNames(P), Filenames(F), Records(R), Decompressed(D) {}
 
   ~VersionedCovMapFuncRecordReader() override = default;
 
@@ -493,7 +558,7 @@ public:
       return make_error<CoverageMapError>(coveragemap_error::malformed);
     size_t FilenamesBegin = Filenames.size();
     RawCoverageFilenamesReader Reader(StringRef(Buf, FilenamesSize), Filenames);
-    if (auto Err = Reader.read())
+    if (auto Err = Reader.read(Version, Decompressed))
       return std::move(Err);
     Buf += FilenamesSize;
 
@@ -508,6 +573,17 @@ public:
     // before reading the next map.
     Buf += alignmentAdjustment(Buf, 8);
 
+    // Since Version4, the mappings may be compressed as a whole.
+    if (Version >= CovMapVersion::Version4) {
+      StringRef Mappings;
+      CompressedMappingsReader MappingsReader(
+          StringRef(CovBuf, CovEnd - CovBuf));
+      if (Error Err = MappingsReader.read(Mappings, Decompressed))
+        return std::move(Err);
+      CovBuf = Mappings.begin();
+      CovEnd = Mappings.end();
+    }
+
     auto CFR = reinterpret_cast<const FuncRecordType *>(FunBuf);
     while ((const char *)CFR < FunEnd) {
       // Read the function information
@@ -534,24 +610,28 @@ template <class IntPtrT, support::endianness Endian>
 Expected<std::unique_ptr<CovMapFuncRecordReader>> CovMapFuncRecordReader::get(
     CovMapVersion Version, InstrProfSymtab &P,
     std::vector<BinaryCoverageReader::ProfileMappingRecord> &R,
-    std::vector<StringRef> &F) {
+    std::vector<StringRef> &F, DecompressedCoverageData &D) {
   using namespace coverage;
 
   switch (Version) {
   case CovMapVersion::Version1:
     return std::make_unique<VersionedCovMapFuncRecordReader<
-        CovMapVersion::Version1, IntPtrT, Endian>>(P, R, F);
+        CovMapVersion::Version1, IntPtrT, Endian>>(P, R, F, D);
   case CovMapVersion::Version2:
   case CovMapVersion::Version3:
+  case CovMapVersion::Version4:
     // Decompress the name data.
     if (Error E = P.create(P.getNameData()))
       return std::move(E);
     if (Version == CovMapVersion::Version2)
       return std::make_unique<VersionedCovMapFuncRecordReader<
-          CovMapVersion::Version2, IntPtrT, Endian>>(P, R, F);
+          CovMapVersion::Version2, IntPtrT, Endian>>(P, R, F, D);
+    else if (Version == CovMapVersion::Version3)
+      return std::make_unique<VersionedCovMapFuncRecordReader<
+          CovMapVersion::Version3, IntPtrT, Endian>>(P, R, F, D);
     else
       return std::make_unique<VersionedCovMapFuncRecordReader<
-          CovMapVersion::Version3, IntPtrT, Endian>>(P, R, F);
+          CovMapVersion::Version4, IntPtrT, Endian>>(P, R, F, D);
   }
   llvm_unreachable("Unsupported version");
 }
@@ -560,7 +640,7 @@ template <typename T, support::endianness Endian>
 static Error readCoverageMappingData(
     InstrProfSymtab &ProfileNames, StringRef Data,
     std::vector<BinaryCoverageReader::ProfileMappingRecord> &Records,
-    std::vector<StringRef> &Filenames) {
+    std::vector<StringRef> &Filenames, DecompressedCoverageData &Decompressed) {
   using namespace coverage;
 
   // Read the records in the coverage data section.
@@ -571,7 +651,7 @@ static Error readCoverageMappingData(
     return make_error<CoverageMapError>(coveragemap_error::unsupported_version);
   Expected<std::unique_ptr<CovMapFuncRecordReader>> ReaderExpected =
       CovMapFuncRecordReader::get<T, Endian>(Version, ProfileNames, Records,
-                                             Filenames);
+                                             Filenames, Decompressed);
   if (Error E = ReaderExpected.takeError())
     return E;
   auto Reader = std::move(ReaderExpected.get());
@@ -596,23 +676,23 @@ BinaryCoverageReader::createCoverageReaderFromBuffer(
     if (Error E =
             readCoverageMappingData<uint32_t, support::endianness::little>(
                 Reader->ProfileNames, Coverage, Reader->MappingRecords,
-                Reader->Filenames))
+                Reader->Filenames, Reader->Decompressed))
       return std::move(E);
   } else if (BytesInAddress == 4 && Endian == support::endianness::big) {
     if (Error E = readCoverageMappingData<uint32_t, support::endianness::big>(
             Reader->ProfileNames, Coverage, Reader->MappingRecords,
-            Reader->Filenames))
+            Reader->Filenames, Reader->Decompressed))
       return std::move(E);
   } else if (BytesInAddress == 8 && Endian == support::endianness::little) {
     if (Error E =
             readCoverageMappingData<uint64_t, support::endianness::little>(
                 Reader->ProfileNames, Coverage, Reader->MappingRecords,
-                Reader->Filenames))
+                Reader->Filenames, Reader->Decompressed))
       return std::move(E);
   } else if (BytesInAddress == 8 && Endian == support::endianness::big) {
     if (Error E = readCoverageMappingData<uint64_t, support::endianness::big>(
             Reader->ProfileNames, Coverage, Reader->MappingRecords,
-            Reader->Filenames))
+            Reader->Filenames, Reader->Decompressed))
       return std::move(E);
   } else
     return make_error<CoverageMapError>(coveragemap_error::malformed);
@@ -809,23 +889,32 @@ Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
   if (CurrentRecord >= MappingRecords.size())
     return make_error<CoverageMapError>(coveragemap_error::eof);
 
-  FunctionsFilenames.clear();
-  Expressions.clear();
-  MappingRegions.clear();
-  auto &R = MappingRecords[CurrentRecord];
+  if (auto Err = readRecord(CurrentRecord, Record, CurrentBuffers))
+    return Err;
+
+  ++CurrentRecord;
+  return Error::success();
+}
+
+Error BinaryCoverageReader::readRecord(
+    size_t Index, CoverageMappingRecord &Record,
+    CoverageMappingRecordBuffers &Buffers) const {
+  assert(Index < MappingRecords.size() && "Record index out of range");
+  Buffers.Filenames.clear();
+  Buffers.Expressions.clear();
+  Buffers.MappingRegions.clear();
+  auto &R = MappingRecords[Index];
   RawCoverageMappingReader Reader(
       R.CoverageMapping,
       makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize),
-      FunctionsFilenames, Expressions, MappingRegions);
+      Buffers.Filenames, Buffers.Expressions, Buffers.MappingRegions);
   if (auto Err = Reader.read())
     return Err;
 
   Record.FunctionName = R.FunctionName;
   Record.FunctionHash = R.FunctionHash;
-  Record.Filenames = FunctionsFilenames;
-  Record.Expressions = Expressions;
-  Record.MappingRegions = MappingRegions;
-
-  ++CurrentRecord;
+  Record.Filenames = Buffers.Filenames;
+  Record.Expressions = Buffers.Expressions;
+  Record.MappingRegions = Buffers.MappingRegions;
   return Error::success();
 }
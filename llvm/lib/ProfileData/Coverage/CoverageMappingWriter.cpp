@@ -13,7 +13,10 @@
 
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -24,12 +27,55 @@
 using namespace llvm;
 using namespace coverage;
 
-void CoverageFilenamesSectionWriter::write(raw_ostream &OS) {
-  encodeULEB128(Filenames.size(), OS);
-  for (const auto &Filename : Filenames) {
-    encodeULEB128(Filename.size(), OS);
-    OS << Filename;
+/// Write \p Data preceded by its size and by its compressed size, which is
+/// zero if the data is stored uncompressed. The data is only compressed if
+/// \p Compress is true and compression makes it smaller.
+static void writeCompressible(StringRef Data, raw_ostream &OS, bool Compress) {
+  SmallString<128> CompressedData;
+  bool DoCompression = Compress && zlib::isAvailable() && !Data.empty();
+  if (DoCompression) {
+    if (Error E = zlib::compress(Data, CompressedData,
+                                 zlib::BestSizeCompression)) {
+      consumeError(std::move(E));
+      DoCompression = false;
+    } else if (CompressedData.size() >= Data.size()) {
+      DoCompression = false;
+    }
   }
+
+  // ::= <uncompressed-len> <compressed-len-or-zero>
+  //     (<compressed-data> | <uncompressed-data>)
+  encodeULEB128(Data.size(), OS);
+  encodeULEB128(DoCompression ? CompressedData.size() : 0U, OS);
+  OS << (DoCompression ? StringRef(CompressedData) : Data);
+}
+
+void CoverageFilenamesSectionWriter::write(raw_ostream &OS, bool Compress) {
+  std::string FilenamesStr;
+  {
+    raw_string_ostream FilenamesOS{FilenamesStr};
+    for (const auto &Filename : Filenames) {
+      encodeULEB128(Filename.size(), FilenamesOS);
+      FilenamesOS << Filename;
+    }
+  }
+
+  // ::= <num-filenames> <compressible-filenames>
+  encodeULEB128(Filenames.size(), OS);
+  writeCompressible(FilenamesStr, OS, Compress);
+}
+
+void CoverageMappingsSectionWriter::write(raw_ostream &OS, bool Compress) {
+  std::string MappingsStr;
+  size_t Size = 0;
+  for (const std::string &Mapping : Mappings)
+    Size += Mapping.size();
+  MappingsStr.reserve(Size);
+  for (const std::string &Mapping : Mappings)
+    MappingsStr += Mapping;
+
+  // ::= <compressible-mappings>
+  writeCompressible(MappingsStr, OS, Compress);
 }
 
 namespace {
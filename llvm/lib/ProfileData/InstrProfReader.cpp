@@ -593,6 +593,37 @@ Error InstrProfReaderIndex<HashTableImpl>::getRecords(
   return Error::success();
 }
 
+template <typename HashTableImpl>
+void InstrProfReaderIndex<HashTableImpl>::prefetchRecords(
+    ArrayRef<StringRef> FuncNames) {
+  using namespace support;
+  using BucketOffset = typename HashTableImpl::offset_type;
+
+  // Find the item chains of every name the same way find() does, without
+  // decoding anything.
+  auto &InfoObj = HashTable->getInfoObj();
+  const uint64_t NumBuckets = HashTable->getNumBuckets();
+  std::vector<const unsigned char *> Chains;
+  Chains.reserve(FuncNames.size());
+  for (StringRef Name : FuncNames) {
+    uint64_t Idx = InfoObj.ComputeHash(Name) & (NumBuckets - 1);
+    const unsigned char *Bucket =
+        HashTable->getBuckets() + sizeof(BucketOffset) * Idx;
+    BucketOffset Offset = endian::read<BucketOffset, little, aligned>(Bucket);
+    if (Offset != 0)
+      Chains.push_back(HashTable->getBase() + Offset);
+  }
+
+  // Chains are laid out in bucket order, so reading them sorted by address
+  // walks the file sequentially.
+  llvm::sort(Chains);
+  Chains.erase(std::unique(Chains.begin(), Chains.end()), Chains.end());
+  volatile unsigned char Sink = 0;
+  for (const unsigned char *Chain : Chains)
+    Sink = Sink + *Chain;
+  (void)Sink;
+}
+
 template <typename HashTableImpl>
 InstrProfReaderIndex<HashTableImpl>::InstrProfReaderIndex(
     const unsigned char *Buckets, const unsigned char *const Payload,
@@ -858,23 +889,30 @@ InstrProfSymtab &IndexedInstrProfReader::getSymtab() {
   return *Symtab.get();
 }
 
-Expected<InstrProfRecord>
-IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
-                                           uint64_t FuncHash) {
+Expected<const NamedInstrProfRecord &>
+IndexedInstrProfReader::getInstrProfRecordRef(StringRef FuncName,
+                                              uint64_t FuncHash) {
   ArrayRef<NamedInstrProfRecord> Data;
   Error Err = Remapper->getRecords(FuncName, Data);
   if (Err)
     return std::move(Err);
   // Found it. Look for counters with the right hash.
-  for (unsigned I = 0, E = Data.size(); I < E; ++I) {
-    // Check for a match and fill the vector if there is one.
-    if (Data[I].Hash == FuncHash) {
-      return std::move(Data[I]);
-    }
-  }
+  for (const NamedInstrProfRecord &Record : Data)
+    if (Record.Hash == FuncHash)
+      return Record;
   return error(instrprof_error::hash_mismatch);
 }
 
+Expected<InstrProfRecord>
+IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
+                                           uint64_t FuncHash) {
+  Expected<const NamedInstrProfRecord &> Record =
+      getInstrProfRecordRef(FuncName, FuncHash);
+  if (Error E = Record.takeError())
+    return std::move(E);
+  return InstrProfRecord(*Record);
+}
+
 Error IndexedInstrProfReader::getFunctionCounts(StringRef FuncName,
                                                 uint64_t FuncHash,
                                                 std::vector<uint64_t> &Counts) {
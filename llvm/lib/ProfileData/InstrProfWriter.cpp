@@ -251,6 +251,10 @@ void InstrProfWriter::addRecord(StringRef Name, uint64_t Hash,
 
 void InstrProfWriter::mergeRecordsFromWriter(InstrProfWriter &&IPW,
                                              function_ref<void(Error)> Warn) {
+  if (IPW.ProfileKind != PF_Unknown)
+    if (Error E = setIsIRLevelProfile(IPW.ProfileKind != PF_FE,
+                                      IPW.ProfileKind == PF_IRLevelWithCS))
+      Warn(std::move(E));
   for (auto &I : IPW.FunctionData)
     for (auto &Func : I.getValue())
       addRecord(I.getKey(), Func.first, std::move(Func.second), 1, Warn);
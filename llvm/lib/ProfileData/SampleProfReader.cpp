@@ -26,6 +26,7 @@
 #include "llvm/IR/ProfileSummary.h"
 #include "llvm/ProfileData/ProfileCommon.h"
 #include "llvm/ProfileData/SampleProf.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/LineIterator.h"
@@ -353,6 +354,14 @@ ErrorOr<StringRef> SampleProfileReaderRawBinary::readStringFromTable() {
   return NameTable[*Idx];
 }
 
+ErrorOr<StringRef> SampleProfileReaderExtBinary::readStringFromTable() {
+  auto Idx = readStringIndex(NameTable);
+  if (std::error_code EC = Idx.getError())
+    return EC;
+
+  return NameTable[*Idx];
+}
+
 ErrorOr<StringRef> SampleProfileReaderCompactBinary::readStringFromTable() {
   auto Idx = readStringIndex(NameTable);
   if (std::error_code EC = Idx.getError())
@@ -467,6 +476,123 @@ std::error_code SampleProfileReaderBinary::read() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::read() {
+  // The section header table lists the function offset table before the
+  // function profiles, so reading the sections in that order lets us skip
+  // the profiles of the functions that aren't used.
+  for (const SecHdrTableEntry &Entry : SecHdrTable)
+    if (std::error_code EC = readOneSection(Entry))
+      return EC;
+  return sampleprof_error::success;
+}
+
+std::error_code
+SampleProfileReaderExtBinary::readOneSection(const SecHdrTableEntry &Entry) {
+  if (Entry.Offset > Buffer->getBufferSize() ||
+      Entry.Size > Buffer->getBufferSize() - Entry.Offset)
+    return sampleprof_error::truncated;
+  Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart()) +
+         Entry.Offset;
+  End = Data + Entry.Size;
+  if (Entry.Flags & SecFlagCompress)
+    if (std::error_code EC = decompressSection())
+      return EC;
+
+  switch (Entry.Type) {
+  case SecProfSummary:
+    return readSummary();
+  case SecNameTable:
+    return readNameTable();
+  case SecFuncOffsetTable:
+    return readFuncOffsetTable();
+  case SecLBRProfile:
+    return readFuncProfiles();
+  default:
+    // Skip the sections we don't know about.
+    return sampleprof_error::success;
+  }
+}
+
+std::error_code SampleProfileReaderExtBinary::decompressSection() {
+  auto DecompressSize = readNumber<uint64_t>();
+  if (std::error_code EC = DecompressSize.getError())
+    return EC;
+
+  auto CompressSize = readNumber<uint64_t>();
+  if (std::error_code EC = CompressSize.getError())
+    return EC;
+
+  if (!zlib::isAvailable())
+    return sampleprof_error::zlib_unavailable;
+
+  if (*CompressSize > uint64_t(End - Data))
+    return sampleprof_error::truncated;
+
+  std::unique_ptr<WritableMemoryBuffer> Decompressed =
+      WritableMemoryBuffer::getNewUninitMemBuffer(*DecompressSize);
+  if (!Decompressed)
+    return sampleprof_error::uncompress_failed;
+
+  StringRef CompressedStrings(reinterpret_cast<const char *>(Data),
+                              *CompressSize);
+  size_t UCSize = *DecompressSize;
+  if (Error E = zlib::uncompress(CompressedStrings,
+                                 Decompressed->getBufferStart(), UCSize)) {
+    consumeError(std::move(E));
+    return sampleprof_error::uncompress_failed;
+  }
+
+  Data = reinterpret_cast<const uint8_t *>(Decompressed->getBufferStart());
+  End = Data + UCSize;
+  DecompressedBuffers.push_back(std::move(Decompressed));
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderExtBinary::readFuncOffsetTable() {
+  auto Size = readNumber<uint64_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+
+  FuncOffsetTable.reserve(*Size);
+  for (uint64_t I = 0; I < *Size; ++I) {
+    auto FName(readStringFromTable());
+    if (std::error_code EC = FName.getError())
+      return EC;
+
+    auto Offset = readNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+
+    FuncOffsetTable[*FName] = *Offset;
+  }
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderExtBinary::readFuncProfiles() {
+  // Without an offset table, or when all the functions are used, decode the
+  // whole section.
+  if (UseAllFuncs || FuncOffsetTable.empty()) {
+    while (!at_eof()) {
+      if (std::error_code EC = readFuncProfile())
+        return EC;
+    }
+    return sampleprof_error::success;
+  }
+
+  const uint8_t *Start = Data;
+  for (auto Name : FuncsToUse) {
+    auto Iter = FuncOffsetTable.find(Name);
+    if (Iter == FuncOffsetTable.end())
+      continue;
+    if (Iter->second >= uint64_t(End - Start))
+      return sampleprof_error::malformed;
+    Data = Start + Iter->second;
+    if (std::error_code EC = readFuncProfile())
+      return EC;
+  }
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileReaderCompactBinary::read() {
   std::vector<uint64_t> OffsetsToUse;
   if (UseAllFuncs) {
@@ -501,6 +627,12 @@ std::error_code SampleProfileReaderRawBinary::verifySPMagic(uint64_t Magic) {
   return sampleprof_error::bad_magic;
 }
 
+std::error_code SampleProfileReaderExtBinary::verifySPMagic(uint64_t Magic) {
+  if (Magic == SPMagic(SPF_Ext_Binary))
+    return sampleprof_error::success;
+  return sampleprof_error::bad_magic;
+}
+
 std::error_code
 SampleProfileReaderCompactBinary::verifySPMagic(uint64_t Magic) {
   if (Magic == SPMagic(SPF_Compact_Binary))
@@ -523,6 +655,21 @@ std::error_code SampleProfileReaderRawBinary::readNameTable() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::readNameTable() {
+  auto Size = readNumber<uint32_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+  NameTable.reserve(*Size);
+  for (uint32_t I = 0; I < *Size; ++I) {
+    auto Name(readString());
+    if (std::error_code EC = Name.getError())
+      return EC;
+    NameTable.push_back(*Name);
+  }
+
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileReaderCompactBinary::readNameTable() {
   auto Size = readNumber<uint64_t>();
   if (std::error_code EC = Size.getError())
@@ -537,7 +684,7 @@ std::error_code SampleProfileReaderCompactBinary::readNameTable() {
   return sampleprof_error::success;
 }
 
-std::error_code SampleProfileReaderBinary::readHeader() {
+std::error_code SampleProfileReaderBinary::readMagicIdent() {
   Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart());
   End = Data + Buffer->getBufferSize();
 
@@ -554,6 +701,12 @@ std::error_code SampleProfileReaderBinary::readHeader() {
     return EC;
   else if (*Version != SPVersion())
     return sampleprof_error::unsupported_version;
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderBinary::readHeader() {
+  if (std::error_code EC = readMagicIdent())
+    return EC;
 
   if (std::error_code EC = readSummary())
     return EC;
@@ -563,6 +716,44 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderExtBinary::readHeader() {
+  if (std::error_code EC = readMagicIdent())
+    return EC;
+  return readSecHdrTable();
+}
+
+std::error_code SampleProfileReaderExtBinary::readSecHdrTable() {
+  auto NumEntries = readNumber<uint64_t>();
+  if (std::error_code EC = NumEntries.getError())
+    return EC;
+
+  for (uint64_t I = 0; I < *NumEntries; ++I) {
+    SecHdrTableEntry Entry;
+    auto Type = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Type.getError())
+      return EC;
+    Entry.Type = static_cast<SecType>(*Type);
+
+    auto Flags = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Flags.getError())
+      return EC;
+    Entry.Flags = *Flags;
+
+    auto Offset = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+    Entry.Offset = *Offset;
+
+    auto Size = readUnencodedNumber<uint64_t>();
+    if (std::error_code EC = Size.getError())
+      return EC;
+    Entry.Size = *Size;
+
+    SecHdrTable.push_back(Entry);
+  }
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileReaderCompactBinary::readHeader() {
   SampleProfileReaderBinary::readHeader();
   if (std::error_code EC = readFuncOffsetTable())
@@ -602,6 +793,13 @@ std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
+void SampleProfileReaderExtBinary::collectFuncsToUse(const Module &M) {
+  UseAllFuncs = false;
+  FuncsToUse.clear();
+  for (auto &F : M)
+    FuncsToUse.insert(FunctionSamples::getCanonicalFnName(F));
+}
+
 void SampleProfileReaderCompactBinary::collectFuncsToUse(const Module &M) {
   UseAllFuncs = false;
   FuncsToUse.clear();
@@ -674,6 +872,13 @@ bool SampleProfileReaderRawBinary::hasFormat(const MemoryBuffer &Buffer) {
   return Magic == SPMagic();
 }
 
+bool SampleProfileReaderExtBinary::hasFormat(const MemoryBuffer &Buffer) {
+  const uint8_t *Data =
+      reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
+  uint64_t Magic = decodeULEB128(Data);
+  return Magic == SPMagic(SPF_Ext_Binary);
+}
+
 bool SampleProfileReaderCompactBinary::hasFormat(const MemoryBuffer &Buffer) {
   const uint8_t *Data =
       reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
@@ -1023,6 +1228,8 @@ SampleProfileReader::create(std::unique_ptr<MemoryBuffer> &B, LLVMContext &C) {
   std::unique_ptr<SampleProfileReader> Reader;
   if (SampleProfileReaderRawBinary::hasFormat(*B))
     Reader.reset(new SampleProfileReaderRawBinary(std::move(B), C));
+  else if (SampleProfileReaderExtBinary::hasFormat(*B))
+    Reader.reset(new SampleProfileReaderExtBinary(std::move(B), C));
   else if (SampleProfileReaderCompactBinary::hasFormat(*B))
     Reader.reset(new SampleProfileReaderCompactBinary(std::move(B), C));
   else if (SampleProfileReaderGCC::hasFormat(*B))
@@ -18,9 +18,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ProfileData/SampleProfWriter.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ProfileData/ProfileCommon.h"
 #include "llvm/ProfileData/SampleProf.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorOr.h"
@@ -43,7 +45,11 @@ std::error_code
 SampleProfileWriter::write(const StringMap<FunctionSamples> &ProfileMap) {
   if (std::error_code EC = writeHeader(ProfileMap))
     return EC;
+  return writeFuncProfiles(ProfileMap);
+}
 
+std::error_code SampleProfileWriter::writeFuncProfiles(
+    const StringMap<FunctionSamples> &ProfileMap) {
   // Sort the ProfileMap by total samples.
   typedef std::pair<StringRef, const FunctionSamples *> NameFunctionSamples;
   std::vector<NameFunctionSamples> V;
@@ -64,6 +70,86 @@ SampleProfileWriter::write(const StringMap<FunctionSamples> &ProfileMap) {
   return sampleprof_error::success;
 }
 
+void SampleProfileWriterExtBinary::setToCompressAllSections() {
+  SectionsToCompress = {SecProfSummary, SecNameTable, SecLBRProfile,
+                        SecFuncOffsetTable};
+}
+
+void SampleProfileWriterExtBinary::setToCompressSection(SecType Type) {
+  if (!is_contained(SectionsToCompress, Type))
+    SectionsToCompress.push_back(Type);
+}
+
+void SampleProfileWriterExtBinary::startSection(SecType Type,
+                                                unsigned LayoutIndex) {
+  assert(LayoutIndex < SecHdrTable.size() && "Unexpected section layout");
+  uint64_t Flags = SecFlagInValid;
+  if (is_contained(SectionsToCompress, Type)) {
+    Flags |= SecFlagCompress;
+    SectionBuffer.clear();
+    SavedOutputStream = std::move(OutputStream);
+    OutputStream = std::make_unique<raw_string_ostream>(SectionBuffer);
+  }
+  CurrentLayoutIndex = LayoutIndex;
+  SecHdrTable[LayoutIndex] = {Type, Flags, 0, 0};
+  SecDataStart = OutputStream->tell();
+  // The offset is the one in the profile, not in the section buffer.
+  SecHdrTable[LayoutIndex].Offset =
+      SavedOutputStream ? SavedOutputStream->tell() : SecDataStart;
+}
+
+std::error_code SampleProfileWriterExtBinary::endSection() {
+  SecHdrTableEntry &Entry = SecHdrTable[CurrentLayoutIndex];
+  if (Entry.Flags & SecFlagCompress) {
+    OutputStream->flush();
+    OutputStream = std::move(SavedOutputStream);
+    if (!zlib::isAvailable())
+      return sampleprof_error::zlib_unavailable;
+    SmallString<128> CompressedBuffer;
+    if (Error E = zlib::compress(SectionBuffer, CompressedBuffer)) {
+      consumeError(std::move(E));
+      return sampleprof_error::compress_failed;
+    }
+    encodeULEB128(SectionBuffer.size(), *OutputStream);
+    encodeULEB128(CompressedBuffer.size(), *OutputStream);
+    *OutputStream << CompressedBuffer;
+  }
+  Entry.Size = OutputStream->tell() - Entry.Offset;
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileWriterExtBinary::write(
+    const StringMap<FunctionSamples> &ProfileMap) {
+  if (std::error_code EC = writeHeader(ProfileMap))
+    return EC;
+
+  startSection(SecProfSummary, 0);
+  if (std::error_code EC = writeSummary())
+    return EC;
+  if (std::error_code EC = endSection())
+    return EC;
+
+  startSection(SecNameTable, 1);
+  if (std::error_code EC = writeNameTable())
+    return EC;
+  if (std::error_code EC = endSection())
+    return EC;
+
+  startSection(SecLBRProfile, 3);
+  if (std::error_code EC = writeFuncProfiles(ProfileMap))
+    return EC;
+  if (std::error_code EC = endSection())
+    return EC;
+
+  startSection(SecFuncOffsetTable, 2);
+  if (std::error_code EC = writeFuncOffsetTable())
+    return EC;
+  if (std::error_code EC = endSection())
+    return EC;
+
+  return writeSecHdrTable();
+}
+
 std::error_code SampleProfileWriterCompactBinary::write(
     const StringMap<FunctionSamples> &ProfileMap) {
   if (std::error_code EC = SampleProfileWriter::write(ProfileMap))
@@ -163,7 +249,7 @@ void SampleProfileWriterBinary::stablizeNameTable(std::set<StringRef> &V) {
     NameTable[N] = i++;
 }
 
-std::error_code SampleProfileWriterRawBinary::writeNameTable() {
+std::error_code SampleProfileWriterBinary::writeNameTable() {
   auto &OS = *OutputStream;
   std::set<StringRef> V;
   stablizeNameTable(V);
@@ -201,6 +287,40 @@ std::error_code SampleProfileWriterCompactBinary::writeFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::writeFuncOffsetTable() {
+  auto &OS = *OutputStream;
+
+  // Write out the table size.
+  encodeULEB128(FuncOffsetTable.size(), OS);
+
+  // Write out FuncOffsetTable.
+  for (auto Entry : FuncOffsetTable) {
+    if (std::error_code EC = writeNameIdx(Entry.first))
+      return EC;
+    encodeULEB128(Entry.second, OS);
+  }
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileWriterExtBinary::writeSecHdrTable() {
+  auto &OFS = static_cast<raw_fd_ostream &>(*OutputStream);
+  uint64_t End = OFS.tell();
+  if (OFS.seek(SecHdrTableOffset) == (uint64_t)-1)
+    return sampleprof_error::ostream_seek_unsupported;
+
+  support::endian::Writer Writer(OFS, support::little);
+  for (const SecHdrTableEntry &Entry : SecHdrTable) {
+    Writer.write(static_cast<uint64_t>(Entry.Type));
+    Writer.write(Entry.Flags);
+    Writer.write(Entry.Offset);
+    Writer.write(Entry.Size);
+  }
+
+  if (OFS.seek(End) == (uint64_t)-1)
+    return sampleprof_error::ostream_seek_unsupported;
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::writeNameTable() {
   auto &OS = *OutputStream;
   std::set<StringRef> V;
@@ -222,6 +342,14 @@ std::error_code SampleProfileWriterRawBinary::writeMagicIdent() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::writeMagicIdent() {
+  auto &OS = *OutputStream;
+  // Write file magic identifier.
+  encodeULEB128(SPMagic(SPF_Ext_Binary), OS);
+  encodeULEB128(SPVersion(), OS);
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::writeMagicIdent() {
   auto &OS = *OutputStream;
   // Write file magic identifier.
@@ -248,6 +376,29 @@ std::error_code SampleProfileWriterBinary::writeHeader(
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileWriterExtBinary::writeHeader(
+    const StringMap<FunctionSamples> &ProfileMap) {
+  writeMagicIdent();
+
+  computeSummary(ProfileMap);
+
+  // Generate the name table for all the functions referenced in the profile.
+  for (const auto &I : ProfileMap) {
+    addName(I.first());
+    addNames(I.second);
+  }
+
+  // Reserve the section header table. It is filled in once all the sections
+  // have been written.
+  SecHdrTable.assign(4, {SecInValid, SecFlagInValid, 0, 0});
+  encodeULEB128(SecHdrTable.size(), *OutputStream);
+  SecHdrTableOffset = OutputStream->tell();
+  support::endian::Writer Writer(*OutputStream, support::little);
+  for (unsigned I = 0; I < SecHdrTable.size() * 4; ++I)
+    Writer.write(static_cast<uint64_t>(0));
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileWriterCompactBinary::writeHeader(
     const StringMap<FunctionSamples> &ProfileMap) {
   support::endian::Writer Writer(*OutputStream, support::little);
@@ -329,6 +480,13 @@ std::error_code SampleProfileWriterBinary::write(const FunctionSamples &S) {
   return writeBody(S);
 }
 
+std::error_code
+SampleProfileWriterExtBinary::write(const FunctionSamples &S) {
+  FuncOffsetTable[S.getName()] = OutputStream->tell() - SecDataStart;
+  encodeULEB128(S.getHeadSamples(), *OutputStream);
+  return writeBody(S);
+}
+
 std::error_code
 SampleProfileWriterCompactBinary::write(const FunctionSamples &S) {
   uint64_t Offset = OutputStream->tell();
@@ -349,7 +507,8 @@ ErrorOr<std::unique_ptr<SampleProfileWriter>>
 SampleProfileWriter::create(StringRef Filename, SampleProfileFormat Format) {
   std::error_code EC;
   std::unique_ptr<raw_ostream> OS;
-  if (Format == SPF_Binary || Format == SPF_Compact_Binary)
+  if (Format == SPF_Binary || Format == SPF_Compact_Binary ||
+      Format == SPF_Ext_Binary)
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::OF_None));
   else
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::OF_Text));
@@ -376,6 +535,8 @@ SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
     Writer.reset(new SampleProfileWriterRawBinary(OS));
   else if (Format == SPF_Compact_Binary)
     Writer.reset(new SampleProfileWriterCompactBinary(OS));
+  else if (Format == SPF_Ext_Binary)
+    Writer.reset(new SampleProfileWriterExtBinary(OS));
   else if (Format == SPF_Text)
     Writer.reset(new SampleProfileWriterText(OS));
   else if (Format == SPF_GCC)
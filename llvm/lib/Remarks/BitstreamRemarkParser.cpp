@@ -0,0 +1,359 @@
+//===- BitstreamRemarkParser.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides utility methods used by clients that want to use the
+// parser for remark diagnostics in LLVM, using LLVM's bitstream reader.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BitstreamRemarkParser.h"
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+static Error malformed(const char *Message) {
+  return createStringError(
+      std::make_error_code(std::errc::illegal_byte_sequence), "%s", Message);
+}
+
+static Error parseMagic(BitstreamCursor &Stream) {
+  char Magic[4];
+  for (char &C : Magic) {
+    Expected<SimpleBitstreamCursor::word_t> MaybeC = Stream.Read(8);
+    if (!MaybeC)
+      return MaybeC.takeError();
+    C = static_cast<char>(*MaybeC);
+  }
+  if (StringRef(Magic, 4) != ContainerMagic)
+    return createStringError(
+        std::make_error_code(std::errc::illegal_byte_sequence),
+        "Unknown magic number: expecting %s, got %.4s.",
+        ContainerMagic.data(), static_cast<const char *>(Magic));
+  return Error::success();
+}
+
+static Error parseBlockInfoBlock(BitstreamCursor &Stream,
+                                 BitstreamBlockInfo &BlockInfo) {
+  Expected<BitstreamEntry> Next = Stream.advance();
+  if (!Next)
+    return Next.takeError();
+  if (Next->Kind != BitstreamEntry::SubBlock ||
+      Next->ID != bitc::BLOCKINFO_BLOCK_ID)
+    return malformed("Error while parsing BLOCKINFO_BLOCK: expecting "
+                     "[ENTER_SUBBLOCK, BLOCKINFO_BLOCK, ...].");
+
+  Expected<Optional<BitstreamBlockInfo>> MaybeBlockInfo =
+      Stream.ReadBlockInfoBlock();
+  if (!MaybeBlockInfo)
+    return MaybeBlockInfo.takeError();
+  if (!*MaybeBlockInfo)
+    return malformed("Error while parsing BLOCKINFO_BLOCK.");
+
+  BlockInfo = std::move(**MaybeBlockInfo);
+  Stream.setBlockInfo(&BlockInfo);
+  return Error::success();
+}
+
+/// Enter the block \p BlockID and call \p Handler with each of its records,
+/// until the end of the block.
+template <typename HandlerT>
+static Error parseBlock(BitstreamCursor &Stream, unsigned BlockID,
+                        const char *BlockName,
+                        SmallVectorImpl<uint64_t> &Record, HandlerT Handler) {
+  Expected<BitstreamEntry> Next = Stream.advance();
+  if (!Next)
+    return Next.takeError();
+  if (Next->Kind != BitstreamEntry::SubBlock || Next->ID != BlockID)
+    return createStringError(
+        std::make_error_code(std::errc::illegal_byte_sequence),
+        "Error while parsing %s: expecting [ENTER_SUBBLOCK, %s, ...].",
+        BlockName, BlockName);
+  if (Error E = Stream.EnterSubBlock(BlockID))
+    return E;
+
+  while (true) {
+    Next = Stream.advanceSkippingSubblocks();
+    if (!Next)
+      return Next.takeError();
+    switch (Next->Kind) {
+    case BitstreamEntry::EndBlock:
+      return Error::success();
+    case BitstreamEntry::Error:
+    case BitstreamEntry::SubBlock:
+      return createStringError(
+          std::make_error_code(std::errc::illegal_byte_sequence),
+          "Error while parsing %s: expecting records.", BlockName);
+    case BitstreamEntry::Record: {
+      StringRef Blob;
+      Record.clear();
+      Expected<unsigned> RecordID = Stream.readRecord(Next->ID, Record, &Blob);
+      if (!RecordID)
+        return RecordID.takeError();
+      if (Error E = Handler(*RecordID, Record, Blob))
+        return E;
+      break;
+    }
+    }
+  }
+}
+
+/// The metadata block of a container.
+struct MetaBlock {
+  Optional<uint64_t> ContainerVersion;
+  Optional<uint64_t> ContainerType;
+  Optional<uint64_t> RemarkVersion;
+  Optional<StringRef> StrTabBuf;
+  Optional<StringRef> ExternalFilePath;
+};
+
+static Error parseMetaBlock(BitstreamCursor &Stream,
+                            SmallVectorImpl<uint64_t> &Record,
+                            MetaBlock &Meta) {
+  return parseBlock(
+      Stream, META_BLOCK_ID, "META_BLOCK", Record,
+      [&](unsigned RecordID, ArrayRef<uint64_t> Values,
+          StringRef Blob) -> Error {
+        switch (RecordID) {
+        case RECORD_META_CONTAINER_INFO:
+          if (Values.size() != 2)
+            return malformed("Error while parsing META_BLOCK: malformed "
+                             "container info record.");
+          Meta.ContainerVersion = Values[0];
+          Meta.ContainerType = Values[1];
+          break;
+        case RECORD_META_REMARK_VERSION:
+          if (Values.size() != 1)
+            return malformed("Error while parsing META_BLOCK: malformed "
+                             "remark version record.");
+          Meta.RemarkVersion = Values[0];
+          break;
+        case RECORD_META_STRTAB:
+          Meta.StrTabBuf = Blob;
+          break;
+        case RECORD_META_EXTERNAL_FILE:
+          Meta.ExternalFilePath = Blob;
+          break;
+        default:
+          return malformed("Error while parsing META_BLOCK: unknown record.");
+        }
+        return Error::success();
+      });
+}
+
+BitstreamRemarkParser::BitstreamRemarkParser(StringRef Buf)
+    : RemarkParser(Format::Bitstream), Stream(Buf) {}
+
+BitstreamRemarkParser::BitstreamRemarkParser(StringRef Buf,
+                                             ParsedStringTable StrTab)
+    : RemarkParser(Format::Bitstream), Stream(Buf), StrTab(std::move(StrTab)) {
+}
+
+Error BitstreamRemarkParser::parseMeta() {
+  if (Error E = parseMagic(Stream))
+    return E;
+  if (Error E = parseBlockInfoBlock(Stream, BlockInfo))
+    return E;
+
+  MetaBlock Meta;
+  if (Error E = parseMetaBlock(Stream, Record, Meta))
+    return E;
+
+  if (!Meta.ContainerVersion || !Meta.ContainerType)
+    return malformed(
+        "Error while parsing META_BLOCK: missing container info.");
+  if (*Meta.ContainerVersion != CurrentContainerVersion)
+    return createStringError(
+        std::make_error_code(std::errc::illegal_byte_sequence),
+        "Error while parsing META_BLOCK: mismatching container version: "
+        "expecting %" PRIu64 " got %" PRIu64 ".",
+        CurrentContainerVersion, *Meta.ContainerVersion);
+  if (*Meta.ContainerType >
+      static_cast<uint64_t>(BitstreamRemarkContainerType::Last))
+    return malformed(
+        "Error while parsing META_BLOCK: invalid container type.");
+  ContainerType =
+      static_cast<BitstreamRemarkContainerType>(*Meta.ContainerType);
+
+  if (Meta.StrTabBuf) {
+    if (StrTab)
+      return malformed("String table already provided.");
+    StrTab.emplace(*Meta.StrTabBuf);
+  }
+  ExternalFilePath = Meta.ExternalFilePath;
+
+  // The metadata of separate remarks only points to the remarks file.
+  if (ContainerType == BitstreamRemarkContainerType::SeparateRemarksMeta) {
+    if (!ExternalFilePath)
+      return malformed(
+          "Error while parsing META_BLOCK: missing external file path.");
+    if (!StrTab)
+      return malformed(
+          "Error while parsing META_BLOCK: missing string table.");
+  } else {
+    if (!Meta.RemarkVersion)
+      return malformed(
+          "Error while parsing META_BLOCK: missing remark version.");
+    RemarkVersion = *Meta.RemarkVersion;
+    if (RemarkVersion != CurrentRemarkVersion)
+      return createStringError(
+          std::make_error_code(std::errc::illegal_byte_sequence),
+          "Error while parsing META_BLOCK: mismatching remark version: "
+          "expecting %" PRIu64 " got %" PRIu64 ".",
+          CurrentRemarkVersion, RemarkVersion);
+    if (!StrTab)
+      return malformed("Error while parsing remarks: a string table is "
+                       "needed to parse bitstream remarks.");
+  }
+
+  ReadyToParseRemarks = true;
+  return Error::success();
+}
+
+Expected<StringRef> BitstreamRemarkParser::getString(uint64_t Index) {
+  return (*StrTab)[Index];
+}
+
+Expected<std::unique_ptr<Remark>> BitstreamRemarkParser::next() {
+  if (!ReadyToParseRemarks) {
+    if (Error E = parseMeta())
+      return std::move(E);
+    if (ContainerType == BitstreamRemarkContainerType::SeparateRemarksMeta)
+      return malformed("Error while parsing remarks: the remarks are in the "
+                       "separate file they were emitted to.");
+  }
+
+  if (Stream.AtEndOfStream())
+    return make_error<EndOfFileError>();
+
+  return parseRemark();
+}
+
+Expected<std::unique_ptr<Remark>> BitstreamRemarkParser::parseRemark() {
+  auto Result = std::make_unique<Remark>();
+  Remark &R = *Result;
+  bool HasHeader = false;
+
+  Error E = parseBlock(
+      Stream, REMARK_BLOCK_ID, "REMARK_BLOCK", Record,
+      [&](unsigned RecordID, ArrayRef<uint64_t> Values,
+          StringRef Blob) -> Error {
+        switch (RecordID) {
+        case RECORD_REMARK_HEADER: {
+          if (Values.size() != 4)
+            return malformed("Error while parsing REMARK_BLOCK: malformed "
+                             "remark header record.");
+          if (Values[0] > static_cast<uint64_t>(Type::Last))
+            return malformed(
+                "Error while parsing REMARK_BLOCK: unknown remark type.");
+          R.RemarkType = static_cast<Type>(Values[0]);
+          Expected<StringRef> RemarkName = getString(Values[1]);
+          if (!RemarkName)
+            return RemarkName.takeError();
+          R.RemarkName = *RemarkName;
+          Expected<StringRef> PassName = getString(Values[2]);
+          if (!PassName)
+            return PassName.takeError();
+          R.PassName = *PassName;
+          Expected<StringRef> FunctionName = getString(Values[3]);
+          if (!FunctionName)
+            return FunctionName.takeError();
+          R.FunctionName = *FunctionName;
+          HasHeader = true;
+          break;
+        }
+        case RECORD_REMARK_DEBUG_LOC: {
+          if (Values.size() != 3)
+            return malformed("Error while parsing REMARK_BLOCK: malformed "
+                             "remark debug location record.");
+          Expected<StringRef> File = getString(Values[0]);
+          if (!File)
+            return File.takeError();
+          R.Loc = RemarkLocation{*File, static_cast<unsigned>(Values[1]),
+                                 static_cast<unsigned>(Values[2])};
+          break;
+        }
+        case RECORD_REMARK_HOTNESS:
+          if (Values.size() != 1)
+            return malformed("Error while parsing REMARK_BLOCK: malformed "
+                             "remark hotness record.");
+          R.Hotness = Values[0];
+          break;
+        case RECORD_REMARK_ARG_WITH_DEBUGLOC:
+        case RECORD_REMARK_ARG_WITHOUT_DEBUGLOC: {
+          bool HasDebugLoc = RecordID == RECORD_REMARK_ARG_WITH_DEBUGLOC;
+          if (Values.size() != (HasDebugLoc ? 5u : 2u))
+            return malformed("Error while parsing REMARK_BLOCK: malformed "
+                             "argument record.");
+          Argument Arg;
+          Expected<StringRef> Key = getString(Values[0]);
+          if (!Key)
+            return Key.takeError();
+          Arg.Key = *Key;
+          Expected<StringRef> Val = getString(Values[1]);
+          if (!Val)
+            return Val.takeError();
+          Arg.Val = *Val;
+          if (HasDebugLoc) {
+            Expected<StringRef> File = getString(Values[2]);
+            if (!File)
+              return File.takeError();
+            Arg.Loc = RemarkLocation{*File, static_cast<unsigned>(Values[3]),
+                                     static_cast<unsigned>(Values[4])};
+          }
+          R.Args.push_back(Arg);
+          break;
+        }
+        default:
+          return malformed(
+              "Error while parsing REMARK_BLOCK: unknown record.");
+        }
+        return Error::success();
+      });
+  if (E)
+    return std::move(E);
+
+  if (!HasHeader)
+    return malformed(
+        "Error while parsing REMARK_BLOCK: missing remark header.");
+  return std::move(Result);
+}
+
+Expected<std::unique_ptr<BitstreamRemarkParser>>
+remarks::createBitstreamParserFromMeta(StringRef Buf,
+                                       Optional<ParsedStringTable> StrTab) {
+  auto MetaParser = StrTab ? std::make_unique<BitstreamRemarkParser>(
+                                 Buf, std::move(*StrTab))
+                           : std::make_unique<BitstreamRemarkParser>(Buf);
+  if (Error E = MetaParser->parseMeta())
+    return std::move(E);
+
+  // Everything is in Buf: continue parsing after the metadata.
+  if (MetaParser->ContainerType !=
+      BitstreamRemarkContainerType::SeparateRemarksMeta)
+    return std::move(MetaParser);
+
+  // Otherwise, the metadata points to the file with the remarks, which has
+  // its own metadata but uses the string table from here.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFile(*MetaParser->ExternalFilePath);
+  if (std::error_code EC = BufferOrErr.getError())
+    return errorCodeToError(EC);
+  std::unique_ptr<MemoryBuffer> SeparateBuf = std::move(*BufferOrErr);
+
+  auto Parser = std::make_unique<BitstreamRemarkParser>(
+      SeparateBuf->getBuffer(), std::move(*MetaParser->StrTab));
+  // Keep the buffer alive.
+  Parser->SeparateBuf = std::move(SeparateBuf);
+  if (Error E = Parser->parseMeta())
+    return std::move(E);
+  if (Parser->ContainerType !=
+      BitstreamRemarkContainerType::SeparateRemarksFile)
+    return malformed("Error while parsing external file's BLOCK_META: wrong "
+                     "container type.");
+  return std::move(Parser);
+}
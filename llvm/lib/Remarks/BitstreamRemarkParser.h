@@ -0,0 +1,87 @@
+//===-- BitstreamRemarkParser.h - Parser for Bitstream remarks --*- C++/-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides the impementation of the Bitstream remark parser.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_REMARKS_BITSTREAM_REMARK_PARSER_H
+#define LLVM_LIB_REMARKS_BITSTREAM_REMARK_PARSER_H
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/Bitstream/BitstreamReader.h"
+#include "llvm/Remarks/BitstreamRemarkContainer.h"
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkParser.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace llvm {
+namespace remarks {
+
+/// Parse bitstream remarks, as emitted by BitstreamRemarkSerializer.
+///
+/// The block info block and the metadata block are parsed on the first call
+/// to next(); every call after that parses one remark block.
+struct BitstreamRemarkParser : public RemarkParser {
+  /// The cursor over the remark blocks.
+  BitstreamCursor Stream;
+  /// The abbreviations read from the block info block. Stream points to it.
+  BitstreamBlockInfo BlockInfo;
+  /// The string table used for parsing strings.
+  Optional<ParsedStringTable> StrTab;
+  /// If the remarks are in a separate file, the buffer holding that file.
+  std::unique_ptr<MemoryBuffer> SeparateBuf;
+  /// The type of the container, read from the metadata block.
+  BitstreamRemarkContainerType ContainerType =
+      BitstreamRemarkContainerType::Standalone;
+  /// The version of the remarks, read from the metadata block.
+  uint64_t RemarkVersion = 0;
+  /// The path of the remarks file, if the metadata points to one.
+  Optional<StringRef> ExternalFilePath;
+  /// Set once the block info and metadata blocks were read.
+  bool ReadyToParseRemarks = false;
+  /// Buffer used to read records.
+  SmallVector<uint64_t, 8> Record;
+
+  /// Create a parser that expects a string table in the metadata block.
+  explicit BitstreamRemarkParser(StringRef Buf);
+  /// Create a parser that uses the string table \p StrTab.
+  BitstreamRemarkParser(StringRef Buf, ParsedStringTable StrTab);
+
+  // The cursor points to BlockInfo.
+  BitstreamRemarkParser(const BitstreamRemarkParser &) = delete;
+  BitstreamRemarkParser &operator=(const BitstreamRemarkParser &) = delete;
+
+  Expected<std::unique_ptr<Remark>> next() override;
+
+  static bool classof(const RemarkParser *P) {
+    return P->ParserFormat == Format::Bitstream;
+  }
+
+  /// Parse the magic number, the block info block and the metadata block.
+  /// This is done by next() if it wasn't done before.
+  Error parseMeta();
+
+private:
+  /// Parse one remark block.
+  Expected<std::unique_ptr<Remark>> parseRemark();
+  /// Look up the string with the index \p Index in the string table.
+  Expected<StringRef> getString(uint64_t Index);
+};
+
+/// Create a bitstream remark parser from the metadata in \p Buf, which may be
+/// a full remark file or point to a separate one.
+Expected<std::unique_ptr<BitstreamRemarkParser>>
+createBitstreamParserFromMeta(StringRef Buf,
+                              Optional<ParsedStringTable> StrTab = None);
+
+} // end namespace remarks
+} // end namespace llvm
+
+#endif /* LLVM_LIB_REMARKS_BITSTREAM_REMARK_PARSER_H */
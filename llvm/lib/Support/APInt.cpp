@@ -32,20 +32,6 @@ using namespace llvm;
 
 #define DEBUG_TYPE "apint"
 
-/// A utility function for allocating memory, checking for allocation failures,
-/// and ensuring the contents are zeroed.
-inline static uint64_t* getClearedMemory(unsigned numWords) {
-  uint64_t *result = new uint64_t[numWords];
-  memset(result, 0, numWords * sizeof(uint64_t));
-  return result;
-}
-
-/// A utility function for allocating memory and checking for allocation
-/// failure.  The content is not zeroed.
-inline static uint64_t* getMemory(unsigned numWords) {
-  return new uint64_t[numWords];
-}
-
 /// A utility function that converts a character to a digit.
 inline static unsigned getDigit(char cdigit, uint8_t radix) {
   unsigned r;
@@ -75,17 +61,17 @@ inline static unsigned getDigit(char cdigit, uint8_t radix) {
 
 
 void APInt::initSlowCase(uint64_t val, bool isSigned) {
-  U.pVal = getClearedMemory(getNumWords());
-  U.pVal[0] = val;
+  allocateClearedWords();
+  getWords()[0] = val;
   if (isSigned && int64_t(val) < 0)
     for (unsigned i = 1; i < getNumWords(); ++i)
-      U.pVal[i] = WORDTYPE_MAX;
+      getWords()[i] = WORDTYPE_MAX;
   clearUnusedBits();
 }
 
 void APInt::initSlowCase(const APInt& that) {
-  U.pVal = getMemory(getNumWords());
-  memcpy(U.pVal, that.U.pVal, getNumWords() * APINT_WORD_SIZE);
+  allocateWords();
+  memcpy(getWords(), that.getWords(), getNumWords() * APINT_WORD_SIZE);
 }
 
 void APInt::initFromArray(ArrayRef<uint64_t> bigVal) {
@@ -95,11 +81,11 @@ void APInt::initFromArray(ArrayRef<uint64_t> bigVal) {
     U.VAL = bigVal[0];
   else {
     // Get memory, cleared to 0
-    U.pVal = getClearedMemory(getNumWords());
+    allocateClearedWords();
     // Calculate the number of words to copy
     unsigned words = std::min<unsigned>(bigVal.size(), getNumWords());
     // Copy the words from bigVal to pVal
-    memcpy(U.pVal, bigVal.data(), words * APINT_WORD_SIZE);
+    memcpy(getWords(), bigVal.data(), words * APINT_WORD_SIZE);
   }
   // Make sure unused high bits are cleared
   clearUnusedBits();
@@ -129,15 +115,14 @@ void APInt::reallocate(unsigned NewBitWidth) {
   }
 
   // If we have an allocation, delete it.
-  if (!isSingleWord())
+  if (isHeapAllocated())
     delete [] U.pVal;
 
   // Update BitWidth.
   BitWidth = NewBitWidth;
 
   // If we are supposed to have an allocation, create it.
-  if (!isSingleWord())
-    U.pVal = getMemory(getNumWords());
+  allocateWords();
 }
 
 void APInt::AssignSlowCase(const APInt& RHS) {
@@ -152,7 +137,7 @@ void APInt::AssignSlowCase(const APInt& RHS) {
   if (isSingleWord())
     U.VAL = RHS.U.VAL;
   else
-    memcpy(U.pVal, RHS.U.pVal, getNumWords() * APINT_WORD_SIZE);
+    memcpy(getWords(), RHS.getWords(), getNumWords() * APINT_WORD_SIZE);
 }
 
 /// This method 'profiles' an APInt for use with FoldingSet.
@@ -166,7 +151,7 @@ void APInt::Profile(FoldingSetNodeID& ID) const {
 
   unsigned NumWords = getNumWords();
   for (unsigned i = 0; i < NumWords; ++i)
-    ID.AddInteger(U.pVal[i]);
+    ID.AddInteger(getWords()[i]);
 }
 
 /// Prefix increment operator. Increments the APInt by one.
@@ -174,7 +159,7 @@ APInt& APInt::operator++() {
   if (isSingleWord())
     ++U.VAL;
   else
-    tcIncrement(U.pVal, getNumWords());
+    tcIncrement(getWords(), getNumWords());
   return clearUnusedBits();
 }
 
@@ -183,7 +168,7 @@ APInt& APInt::operator--() {
   if (isSingleWord())
     --U.VAL;
   else
-    tcDecrement(U.pVal, getNumWords());
+    tcDecrement(getWords(), getNumWords());
   return clearUnusedBits();
 }
 
@@ -195,7 +180,7 @@ APInt& APInt::operator+=(const APInt& RHS) {
   if (isSingleWord())
     U.VAL += RHS.U.VAL;
   else
-    tcAdd(U.pVal, RHS.U.pVal, 0, getNumWords());
+    tcAdd(getWords(), RHS.getWords(), 0, getNumWords());
   return clearUnusedBits();
 }
 
@@ -203,7 +188,7 @@ APInt& APInt::operator+=(uint64_t RHS) {
   if (isSingleWord())
     U.VAL += RHS;
   else
-    tcAddPart(U.pVal, RHS, getNumWords());
+    tcAddPart(getWords(), RHS, getNumWords());
   return clearUnusedBits();
 }
 
@@ -215,7 +200,7 @@ APInt& APInt::operator-=(const APInt& RHS) {
   if (isSingleWord())
     U.VAL -= RHS.U.VAL;
   else
-    tcSubtract(U.pVal, RHS.U.pVal, 0, getNumWords());
+    tcSubtract(getWords(), RHS.getWords(), 0, getNumWords());
   return clearUnusedBits();
 }
 
@@ -223,7 +208,7 @@ APInt& APInt::operator-=(uint64_t RHS) {
   if (isSingleWord())
     U.VAL -= RHS;
   else
-    tcSubtractPart(U.pVal, RHS, getNumWords());
+    tcSubtractPart(getWords(), RHS, getNumWords());
   return clearUnusedBits();
 }
 
@@ -232,24 +217,24 @@ APInt APInt::operator*(const APInt& RHS) const {
   if (isSingleWord())
     return APInt(BitWidth, U.VAL * RHS.U.VAL);
 
-  APInt Result(getMemory(getNumWords()), getBitWidth());
+  APInt Result = getUninitialized(getBitWidth());
 
-  tcMultiply(Result.U.pVal, U.pVal, RHS.U.pVal, getNumWords());
+  tcMultiply(Result.getWords(), getWords(), RHS.getWords(), getNumWords());
 
   Result.clearUnusedBits();
   return Result;
 }
 
 void APInt::AndAssignSlowCase(const APInt& RHS) {
-  tcAnd(U.pVal, RHS.U.pVal, getNumWords());
+  tcAnd(getWords(), RHS.getWords(), getNumWords());
 }
 
 void APInt::OrAssignSlowCase(const APInt& RHS) {
-  tcOr(U.pVal, RHS.U.pVal, getNumWords());
+  tcOr(getWords(), RHS.getWords(), getNumWords());
 }
 
 void APInt::XorAssignSlowCase(const APInt& RHS) {
-  tcXor(U.pVal, RHS.U.pVal, getNumWords());
+  tcXor(getWords(), RHS.getWords(), getNumWords());
 }
 
 APInt& APInt::operator*=(const APInt& RHS) {
@@ -263,13 +248,13 @@ APInt& APInt::operator*=(uint64_t RHS) {
     U.VAL *= RHS;
   } else {
     unsigned NumWords = getNumWords();
-    tcMultiplyPart(U.pVal, U.pVal, RHS, 0, NumWords, NumWords, false);
+    tcMultiplyPart(getWords(), getWords(), RHS, 0, NumWords, NumWords, false);
   }
   return clearUnusedBits();
 }
 
 bool APInt::EqualSlowCase(const APInt& RHS) const {
-  return std::equal(U.pVal, U.pVal + getNumWords(), RHS.U.pVal);
+  return std::equal(getWords(), getWords() + getNumWords(), RHS.getWords());
 }
 
 int APInt::compare(const APInt& RHS) const {
@@ -277,7 +262,7 @@ int APInt::compare(const APInt& RHS) const {
   if (isSingleWord())
     return U.VAL < RHS.U.VAL ? -1 : U.VAL > RHS.U.VAL;
 
-  return tcCompare(U.pVal, RHS.U.pVal, getNumWords());
+  return tcCompare(getWords(), RHS.getWords(), getNumWords());
 }
 
 int APInt::compareSigned(const APInt& RHS) const {
@@ -297,7 +282,7 @@ int APInt::compareSigned(const APInt& RHS) const {
 
   // Otherwise we can just use an unsigned comparison, because even negative
   // numbers compare correctly this way if both have the same signed-ness.
-  return tcCompare(U.pVal, RHS.U.pVal, getNumWords());
+  return tcCompare(getWords(), RHS.getWords(), getNumWords());
 }
 
 void APInt::setBitsSlowCase(unsigned loBit, unsigned hiBit) {
@@ -317,19 +302,19 @@ void APInt::setBitsSlowCase(unsigned loBit, unsigned hiBit) {
     if (hiWord == loWord)
       loMask &= hiMask;
     else
-      U.pVal[hiWord] |= hiMask;
+      getWords()[hiWord] |= hiMask;
   }
   // Apply the mask to the low word.
-  U.pVal[loWord] |= loMask;
+  getWords()[loWord] |= loMask;
 
   // Fill any words between loWord and hiWord with all ones.
   for (unsigned word = loWord + 1; word < hiWord; ++word)
-    U.pVal[word] = WORDTYPE_MAX;
+    getWords()[word] = WORDTYPE_MAX;
 }
 
 /// Toggle every bit to its opposite value.
 void APInt::flipAllBitsSlowCase() {
-  tcComplement(U.pVal, getNumWords());
+  tcComplement(getWords(), getNumWords());
   clearUnusedBits();
 }
 
@@ -368,8 +353,8 @@ void APInt::insertBits(const APInt &subBits, unsigned bitPosition) {
   // Insertion within a single word can be done as a direct bitmask.
   if (loWord == hi1Word) {
     uint64_t mask = WORDTYPE_MAX >> (APINT_BITS_PER_WORD - subBitWidth);
-    U.pVal[loWord] &= ~(mask << loBit);
-    U.pVal[loWord] |= (subBits.U.VAL << loBit);
+    getWords()[loWord] &= ~(mask << loBit);
+    getWords()[loWord] |= (subBits.U.VAL << loBit);
     return;
   }
 
@@ -377,15 +362,15 @@ void APInt::insertBits(const APInt &subBits, unsigned bitPosition) {
   if (loBit == 0) {
     // Direct copy whole words.
     unsigned numWholeSubWords = subBitWidth / APINT_BITS_PER_WORD;
-    memcpy(U.pVal + loWord, subBits.getRawData(),
+    memcpy(getWords() + loWord, subBits.getRawData(),
            numWholeSubWords * APINT_WORD_SIZE);
 
     // Mask+insert remaining bits.
     unsigned remainingBits = subBitWidth % APINT_BITS_PER_WORD;
     if (remainingBits != 0) {
       uint64_t mask = WORDTYPE_MAX >> (APINT_BITS_PER_WORD - remainingBits);
-      U.pVal[hi1Word] &= ~mask;
-      U.pVal[hi1Word] |= subBits.getWord(subBitWidth - 1);
+      getWords()[hi1Word] &= ~mask;
+      getWords()[hi1Word] |= subBits.getWord(subBitWidth - 1);
     }
     return;
   }
@@ -415,23 +400,24 @@ APInt APInt::extractBits(unsigned numBits, unsigned bitPosition) const {
 
   // Single word result extracting bits from a single word source.
   if (loWord == hiWord)
-    return APInt(numBits, U.pVal[loWord] >> loBit);
+    return APInt(numBits, getWords()[loWord] >> loBit);
 
   // Extracting bits that start on a source word boundary can be done
   // as a fast memory copy.
   if (loBit == 0)
-    return APInt(numBits, makeArrayRef(U.pVal + loWord, 1 + hiWord - loWord));
+    return APInt(numBits,
+                 makeArrayRef(getWords() + loWord, 1 + hiWord - loWord));
 
   // General case - shift + copy source words directly into place.
   APInt Result(numBits, 0);
   unsigned NumSrcWords = getNumWords();
   unsigned NumDstWords = Result.getNumWords();
 
-  uint64_t *DestPtr = Result.isSingleWord() ? &Result.U.VAL : Result.U.pVal;
+  uint64_t *DestPtr = Result.isSingleWord() ? &Result.U.VAL : Result.getWords();
   for (unsigned word = 0; word < NumDstWords; ++word) {
-    uint64_t w0 = U.pVal[loWord + word];
+    uint64_t w0 = getWords()[loWord + word];
     uint64_t w1 =
-        (loWord + word + 1) < NumSrcWords ? U.pVal[loWord + word + 1] : 0;
+        (loWord + word + 1) < NumSrcWords ? getWords()[loWord + word + 1] : 0;
     DestPtr[word] = (w0 >> loBit) | (w1 << (APINT_BITS_PER_WORD - loBit));
   }
 
@@ -498,7 +484,7 @@ hash_code llvm::hash_value(const APInt &Arg) {
   if (Arg.isSingleWord())
     return hash_combine(Arg.U.VAL);
 
-  return hash_combine_range(Arg.U.pVal, Arg.U.pVal + Arg.getNumWords());
+  return hash_combine_range(Arg.getWords(), Arg.getWords() + Arg.getNumWords());
 }
 
 bool APInt::isSplat(unsigned SplatSizeInBits) const {
@@ -535,7 +521,7 @@ APInt APInt::getSplat(unsigned NewLen, const APInt &V) {
 unsigned APInt::countLeadingZerosSlowCase() const {
   unsigned Count = 0;
   for (int i = getNumWords()-1; i >= 0; --i) {
-    uint64_t V = U.pVal[i];
+    uint64_t V = getWords()[i];
     if (V == 0)
       Count += APINT_BITS_PER_WORD;
     else {
@@ -559,13 +545,13 @@ unsigned APInt::countLeadingOnesSlowCase() const {
     shift = APINT_BITS_PER_WORD - highWordBits;
   }
   int i = getNumWords() - 1;
-  unsigned Count = llvm::countLeadingOnes(U.pVal[i] << shift);
+  unsigned Count = llvm::countLeadingOnes(getWords()[i] << shift);
   if (Count == highWordBits) {
     for (i--; i >= 0; --i) {
-      if (U.pVal[i] == WORDTYPE_MAX)
+      if (getWords()[i] == WORDTYPE_MAX)
         Count += APINT_BITS_PER_WORD;
       else {
-        Count += llvm::countLeadingOnes(U.pVal[i]);
+        Count += llvm::countLeadingOnes(getWords()[i]);
         break;
       }
     }
@@ -576,20 +562,20 @@ unsigned APInt::countLeadingOnesSlowCase() const {
 unsigned APInt::countTrailingZerosSlowCase() const {
   unsigned Count = 0;
   unsigned i = 0;
-  for (; i < getNumWords() && U.pVal[i] == 0; ++i)
+  for (; i < getNumWords() && getWords()[i] == 0; ++i)
     Count += APINT_BITS_PER_WORD;
   if (i < getNumWords())
-    Count += llvm::countTrailingZeros(U.pVal[i]);
+    Count += llvm::countTrailingZeros(getWords()[i]);
   return std::min(Count, BitWidth);
 }
 
 unsigned APInt::countTrailingOnesSlowCase() const {
   unsigned Count = 0;
   unsigned i = 0;
-  for (; i < getNumWords() && U.pVal[i] == WORDTYPE_MAX; ++i)
+  for (; i < getNumWords() && getWords()[i] == WORDTYPE_MAX; ++i)
     Count += APINT_BITS_PER_WORD;
   if (i < getNumWords())
-    Count += llvm::countTrailingOnes(U.pVal[i]);
+    Count += llvm::countTrailingOnes(getWords()[i]);
   assert(Count <= BitWidth);
   return Count;
 }
@@ -597,13 +583,13 @@ unsigned APInt::countTrailingOnesSlowCase() const {
 unsigned APInt::countPopulationSlowCase() const {
   unsigned Count = 0;
   for (unsigned i = 0; i < getNumWords(); ++i)
-    Count += llvm::countPopulation(U.pVal[i]);
+    Count += llvm::countPopulation(getWords()[i]);
   return Count;
 }
 
 bool APInt::intersectsSlowCase(const APInt &RHS) const {
   for (unsigned i = 0, e = getNumWords(); i != e; ++i)
-    if ((U.pVal[i] & RHS.U.pVal[i]) != 0)
+    if ((getWords()[i] & RHS.getWords()[i]) != 0)
       return true;
 
   return false;
@@ -611,7 +597,7 @@ bool APInt::intersectsSlowCase(const APInt &RHS) const {
 
 bool APInt::isSubsetOfSlowCase(const APInt &RHS) const {
   for (unsigned i = 0, e = getNumWords(); i != e; ++i)
-    if ((U.pVal[i] & ~RHS.U.pVal[i]) != 0)
+    if ((getWords()[i] & ~RHS.getWords()[i]) != 0)
       return false;
 
   return true;
@@ -635,7 +621,7 @@ APInt APInt::byteSwap() const {
 
   APInt Result(getNumWords() * APINT_BITS_PER_WORD, 0);
   for (unsigned I = 0, N = getNumWords(); I != N; ++I)
-    Result.U.pVal[I] = ByteSwap_64(U.pVal[N - I - 1]);
+    Result.getWords()[I] = ByteSwap_64(getWords()[N - I - 1]);
   if (Result.BitWidth != BitWidth) {
     Result.lshrInPlace(Result.BitWidth - BitWidth);
     Result.BitWidth = BitWidth;
@@ -793,13 +779,14 @@ double APInt::roundToDouble(bool isSigned) const {
   uint64_t mantissa;
   unsigned hiWord = whichWord(n-1);
   if (hiWord == 0) {
-    mantissa = Tmp.U.pVal[0];
+    mantissa = Tmp.getWords()[0];
     if (n > 52)
       mantissa >>= n - 52; // shift down, we want the top 52 bits.
   } else {
     assert(hiWord > 0 && "huh?");
-    uint64_t hibits = Tmp.U.pVal[hiWord] << (52 - n % APINT_BITS_PER_WORD);
-    uint64_t lobits = Tmp.U.pVal[hiWord-1] >> (11 + n % APINT_BITS_PER_WORD);
+    uint64_t hibits = Tmp.getWords()[hiWord] << (52 - n % APINT_BITS_PER_WORD);
+    uint64_t lobits =
+        Tmp.getWords()[hiWord - 1] >> (11 + n % APINT_BITS_PER_WORD);
     mantissa = hibits | lobits;
   }
 
@@ -817,17 +804,17 @@ APInt APInt::trunc(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, getRawData()[0]);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result = getUninitialized(width);
 
   // Copy full words.
   unsigned i;
   for (i = 0; i != width / APINT_BITS_PER_WORD; i++)
-    Result.U.pVal[i] = U.pVal[i];
+    Result.getWords()[i] = getWords()[i];
 
   // Truncate and copy any partial word.
   unsigned bits = (0 - width) % APINT_BITS_PER_WORD;
   if (bits != 0)
-    Result.U.pVal[i] = U.pVal[i] << bits >> bits;
+    Result.getWords()[i] = getWords()[i] << bits >> bits;
 
   return Result;
 }
@@ -839,18 +826,18 @@ APInt APInt::sext(unsigned Width) const {
   if (Width <= APINT_BITS_PER_WORD)
     return APInt(Width, SignExtend64(U.VAL, BitWidth));
 
-  APInt Result(getMemory(getNumWords(Width)), Width);
+  APInt Result = getUninitialized(Width);
 
   // Copy words.
-  std::memcpy(Result.U.pVal, getRawData(), getNumWords() * APINT_WORD_SIZE);
+  std::memcpy(Result.getWords(), getRawData(), getNumWords() * APINT_WORD_SIZE);
 
   // Sign extend the last word since there may be unused bits in the input.
-  Result.U.pVal[getNumWords() - 1] =
-      SignExtend64(Result.U.pVal[getNumWords() - 1],
+  Result.getWords()[getNumWords() - 1] =
+      SignExtend64(Result.getWords()[getNumWords() - 1],
                    ((BitWidth - 1) % APINT_BITS_PER_WORD) + 1);
 
   // Fill with sign bits.
-  std::memset(Result.U.pVal + getNumWords(), isNegative() ? -1 : 0,
+  std::memset(Result.getWords() + getNumWords(), isNegative() ? -1 : 0,
               (Result.getNumWords() - getNumWords()) * APINT_WORD_SIZE);
   Result.clearUnusedBits();
   return Result;
@@ -863,13 +850,13 @@ APInt APInt::zext(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, U.VAL);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result = getUninitialized(width);
 
   // Copy words.
-  std::memcpy(Result.U.pVal, getRawData(), getNumWords() * APINT_WORD_SIZE);
+  std::memcpy(Result.getWords(), getRawData(), getNumWords() * APINT_WORD_SIZE);
 
   // Zero remaining words.
-  std::memset(Result.U.pVal + getNumWords(), 0,
+  std::memset(Result.getWords() + getNumWords(), 0,
               (Result.getNumWords() - getNumWords()) * APINT_WORD_SIZE);
 
   return Result;
@@ -926,28 +913,33 @@ void APInt::ashrSlowCase(unsigned ShiftAmt) {
   unsigned WordsToMove = getNumWords() - WordShift;
   if (WordsToMove != 0) {
     // Sign extend the last word to fill in the unused bits.
-    U.pVal[getNumWords() - 1] = SignExtend64(
-        U.pVal[getNumWords() - 1], ((BitWidth - 1) % APINT_BITS_PER_WORD) + 1);
+    getWords()[getNumWords() - 1] =
+        SignExtend64(getWords()[getNumWords() - 1],
+                     ((BitWidth - 1) % APINT_BITS_PER_WORD) + 1);
 
     // Fastpath for moving by whole words.
     if (BitShift == 0) {
-      std::memmove(U.pVal, U.pVal + WordShift, WordsToMove * APINT_WORD_SIZE);
+      std::memmove(getWords(), getWords() + WordShift,
+                   WordsToMove * APINT_WORD_SIZE);
     } else {
       // Move the words containing significant bits.
       for (unsigned i = 0; i != WordsToMove - 1; ++i)
-        U.pVal[i] = (U.pVal[i + WordShift] >> BitShift) |
-                    (U.pVal[i + WordShift + 1] << (APINT_BITS_PER_WORD - BitShift));
+        getWords()[i] =
+            (getWords()[i + WordShift] >> BitShift) |
+            (getWords()[i + WordShift + 1] << (APINT_BITS_PER_WORD - BitShift));
 
       // Handle the last word which has no high bits to copy.
-      U.pVal[WordsToMove - 1] = U.pVal[WordShift + WordsToMove - 1] >> BitShift;
+      getWords()[WordsToMove - 1] =
+          getWords()[WordShift + WordsToMove - 1] >> BitShift;
       // Sign extend one more time.
-      U.pVal[WordsToMove - 1] =
-          SignExtend64(U.pVal[WordsToMove - 1], APINT_BITS_PER_WORD - BitShift);
+      getWords()[WordsToMove - 1] =
+          SignExtend64(getWords()[WordsToMove - 1],
+                       APINT_BITS_PER_WORD - BitShift);
     }
   }
 
   // Fill in the remainder based on the original sign.
-  std::memset(U.pVal + WordsToMove, Negative ? -1 : 0,
+  std::memset(getWords() + WordsToMove, Negative ? -1 : 0,
               WordShift * APINT_WORD_SIZE);
   clearUnusedBits();
 }
@@ -961,7 +953,7 @@ void APInt::lshrInPlace(const APInt &shiftAmt) {
 /// Logical right-shift this APInt by shiftAmt.
 /// Logical right-shift function.
 void APInt::lshrSlowCase(unsigned ShiftAmt) {
-  tcShiftRight(U.pVal, getNumWords(), ShiftAmt);
+  tcShiftRight(getWords(), getNumWords(), ShiftAmt);
 }
 
 /// Left-shift this APInt by shiftAmt.
@@ -973,7 +965,7 @@ APInt &APInt::operator<<=(const APInt &shiftAmt) {
 }
 
 void APInt::shlSlowCase(unsigned ShiftAmt) {
-  tcShiftLeft(U.pVal, getNumWords(), ShiftAmt);
+  tcShiftLeft(getWords(), getNumWords(), ShiftAmt);
   clearUnusedBits();
 }
 
@@ -1036,7 +1028,7 @@ APInt APInt::sqrt() const {
       /* 21-30 */ 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
       /*    31 */ 6
     };
-    return APInt(BitWidth, results[ (isSingleWord() ? U.VAL : U.pVal[0]) ]);
+    return APInt(BitWidth, results[ (isSingleWord() ? U.VAL : getWords()[0]) ]);
   }
 
   // If the magnitude of the value fits in less than 52 bits (the precision of
@@ -1044,9 +1036,8 @@ APInt APInt::sqrt() const {
   // libc sqrt function which will probably use a hardware sqrt computation.
   // This should be faster than the algorithm below.
   if (magnitude < 52) {
-    return APInt(BitWidth,
-                 uint64_t(::round(::sqrt(double(isSingleWord() ? U.VAL
-                                                               : U.pVal[0])))));
+    return APInt(BitWidth, uint64_t(::round(::sqrt(double(
+                               isSingleWord() ? U.VAL : getWords()[0])))));
   }
 
   // Okay, all the short cuts are exhausted. We must compute it. The following
@@ -1551,11 +1542,12 @@ APInt APInt::udiv(const APInt &RHS) const {
     return APInt(BitWidth, 1);
   if (lhsWords == 1) // rhsWords is 1 if lhsWords is 1.
     // All high words are zero, just use native divide
-    return APInt(BitWidth, this->U.pVal[0] / RHS.U.pVal[0]);
+    return APInt(BitWidth, this->getWords()[0] / RHS.getWords()[0]);
 
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
   APInt Quotient(BitWidth, 0); // to hold result.
-  divide(U.pVal, lhsWords, RHS.U.pVal, rhsWords, Quotient.U.pVal, nullptr);
+  divide(getWords(), lhsWords, RHS.getWords(), rhsWords, Quotient.getWords(),
+         nullptr);
   return Quotient;
 }
 
@@ -1584,11 +1576,11 @@ APInt APInt::udiv(uint64_t RHS) const {
     return APInt(BitWidth, 1);
   if (lhsWords == 1) // rhsWords is 1 if lhsWords is 1.
     // All high words are zero, just use native divide
-    return APInt(BitWidth, this->U.pVal[0] / RHS);
+    return APInt(BitWidth, this->getWords()[0] / RHS);
 
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
   APInt Quotient(BitWidth, 0); // to hold result.
-  divide(U.pVal, lhsWords, &RHS, 1, Quotient.U.pVal, nullptr);
+  divide(getWords(), lhsWords, &RHS, 1, Quotient.getWords(), nullptr);
   return Quotient;
 }
 
@@ -1644,11 +1636,12 @@ APInt APInt::urem(const APInt &RHS) const {
     return APInt(BitWidth, 0);
   if (lhsWords == 1)
     // All high words are zero, just use native remainder
-    return APInt(BitWidth, U.pVal[0] % RHS.U.pVal[0]);
+    return APInt(BitWidth, getWords()[0] % RHS.getWords()[0]);
 
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
   APInt Remainder(BitWidth, 0);
-  divide(U.pVal, lhsWords, RHS.U.pVal, rhsWords, nullptr, Remainder.U.pVal);
+  divide(getWords(), lhsWords, RHS.getWords(), rhsWords, nullptr,
+         Remainder.getWords());
   return Remainder;
 }
 
@@ -1676,11 +1669,11 @@ uint64_t APInt::urem(uint64_t RHS) const {
     return 0;
   if (lhsWords == 1)
     // All high words are zero, just use native remainder
-    return U.pVal[0] % RHS;
+    return getWords()[0] % RHS;
 
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
   uint64_t Remainder;
-  divide(U.pVal, lhsWords, &RHS, 1, nullptr, &Remainder);
+  divide(getWords(), lhsWords, &RHS, 1, nullptr, &Remainder);
   return Remainder;
 }
 
@@ -1760,20 +1753,20 @@ void APInt::udivrem(const APInt &LHS, const APInt &RHS,
 
   if (lhsWords == 1) { // rhsWords is 1 if lhsWords is 1.
     // There is only one word to consider so use the native versions.
-    uint64_t lhsValue = LHS.U.pVal[0];
-    uint64_t rhsValue = RHS.U.pVal[0];
+    uint64_t lhsValue = LHS.getWords()[0];
+    uint64_t rhsValue = RHS.getWords()[0];
     Quotient = lhsValue / rhsValue;
     Remainder = lhsValue % rhsValue;
     return;
   }
 
   // Okay, lets do it the long way
-  divide(LHS.U.pVal, lhsWords, RHS.U.pVal, rhsWords, Quotient.U.pVal,
-         Remainder.U.pVal);
+  divide(LHS.getWords(), lhsWords, RHS.getWords(), rhsWords,
+         Quotient.getWords(), Remainder.getWords());
   // Clear the rest of the Quotient and Remainder.
-  std::memset(Quotient.U.pVal + lhsWords, 0,
+  std::memset(Quotient.getWords() + lhsWords, 0,
               (getNumWords(BitWidth) - lhsWords) * APINT_WORD_SIZE);
-  std::memset(Remainder.U.pVal + rhsWords, 0,
+  std::memset(Remainder.getWords() + rhsWords, 0,
               (getNumWords(BitWidth) - rhsWords) * APINT_WORD_SIZE);
 }
 
@@ -1825,16 +1818,16 @@ void APInt::udivrem(const APInt &LHS, uint64_t RHS, APInt &Quotient,
 
   if (lhsWords == 1) { // rhsWords is 1 if lhsWords is 1.
     // There is only one word to consider so use the native versions.
-    uint64_t lhsValue = LHS.U.pVal[0];
+    uint64_t lhsValue = LHS.getWords()[0];
     Quotient = lhsValue / RHS;
     Remainder = lhsValue % RHS;
     return;
   }
 
   // Okay, lets do it the long way
-  divide(LHS.U.pVal, lhsWords, &RHS, 1, Quotient.U.pVal, &Remainder);
+  divide(LHS.getWords(), lhsWords, &RHS, 1, Quotient.getWords(), &Remainder);
   // Clear the rest of the Quotient.
-  std::memset(Quotient.U.pVal + lhsWords, 0,
+  std::memset(Quotient.getWords() + lhsWords, 0,
               (getNumWords(BitWidth) - lhsWords) * APINT_WORD_SIZE);
 }
 
@@ -2022,7 +2015,7 @@ void APInt::fromString(unsigned numbits, StringRef str, uint8_t radix) {
   if (isSingleWord())
     U.VAL = 0;
   else
-    U.pVal = getClearedMemory(getNumWords());
+    allocateClearedWords();
 
   // Figure out if we can shift instead of multiply
   unsigned shift = (radix == 16 ? 4 : radix == 8 ? 3 : radix == 2 ? 1 : 0);
@@ -22,7 +22,23 @@ APSInt::APSInt(StringRef Str) {
 
   // (Over-)estimate the required number of bits.
   unsigned NumBits = ((Str.size() * 64) / 19) + 2;
-  APInt Tmp(NumBits, Str, /*radix=*/10);
+  APInt Tmp;
+  if (Str.size() <= 18) {
+    // Any number of up to 18 characters fits in 62 bits, so skip the
+    // arbitrary precision arithmetic of parsing into an APInt.
+    StringRef Digits = Str;
+    bool IsNegative = Digits.consume_front("-");
+    if (!IsNegative)
+      Digits.consume_front("+");
+    uint64_t Val = 0;
+    for (char C : Digits) {
+      assert(C >= '0' && C <= '9' && "Invalid character in digit string");
+      Val = Val * 10 + (C - '0');
+    }
+    Tmp = APInt(NumBits, IsNegative ? -Val : Val, /*isSigned=*/IsNegative);
+  } else {
+    Tmp = APInt(NumBits, Str, /*radix=*/10);
+  }
   if (Str[0] == '-') {
     unsigned MinBits = Tmp.getMinSignedBits();
     if (MinBits > 0 && MinBits < NumBits)
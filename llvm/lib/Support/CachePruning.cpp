@@ -12,10 +12,12 @@
 
 #include "llvm/Support/CachePruning.h"
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -39,8 +41,67 @@ struct FileInfo {
            std::tie(Other.Time, Size, Other.Path);
   }
 };
+
+/// The latest use of a cache file recorded in the pruning index.
+struct IndexEntry {
+  sys::TimePoint<> Time;
+  uint64_t Size;
+};
 } // anonymous namespace
 
+/// The name of the pruning index within the cache directory. Each line of the
+/// index records a use of a cache file as "<time_t> <size> <file name>".
+static const char IndexFileName[] = "llvmcache.index";
+
+/// The name of the timestamp file of the last full directory scan.
+static const char FullScanTimestampFileName[] = "llvmcache.fullscan";
+
+void llvm::recordCacheFileUse(StringRef Path, StringRef Name, uint64_t Size,
+                              sys::TimePoint<> Time) {
+  SmallString<128> IndexFile(Path);
+  sys::path::append(IndexFile, IndexFileName);
+  int FD;
+  if (sys::fs::openFileForWrite(IndexFile, FD, sys::fs::CD_OpenAlways,
+                                sys::fs::OF_Append))
+    return;
+  // The line fits in the stream buffer, so it is appended with a single
+  // write, which keeps concurrent writers from interleaving their lines.
+  raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << sys::toTimeT(Time) << ' ' << Size << ' ' << Name << '\n';
+}
+
+/// Add the uses recorded in the pruning index \p IndexFile to \p Entries,
+/// keeping the latest use of each file. Malformed lines, which may be left
+/// by concurrent writers on file systems without atomic appends, are
+/// ignored.
+static void readIndexFile(StringRef IndexFile,
+                          StringMap<IndexEntry> &Entries) {
+  // The index may be appended to while it is read, so do not map it.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(IndexFile, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false,
+                            /*IsVolatile=*/true);
+  if (!MBOrErr)
+    return;
+  StringRef Rest = (*MBOrErr)->getBuffer();
+  while (!Rest.empty()) {
+    StringRef Line;
+    std::tie(Line, Rest) = Rest.split('\n');
+    StringRef TimeStr, SizeStr, Name;
+    std::tie(TimeStr, Line) = Line.split(' ');
+    std::tie(SizeStr, Name) = Line.split(' ');
+    std::time_t Time;
+    uint64_t Size;
+    if (TimeStr.getAsInteger(10, Time) || SizeStr.getAsInteger(10, Size) ||
+        !Name.startswith("llvmcache-") ||
+        Name.find_first_of("/\\ ") != StringRef::npos)
+      continue;
+    IndexEntry &E = Entries[Name];
+    if (E.Time <= sys::toTimePoint(Time))
+      E = {sys::toTimePoint(Time), Size};
+  }
+}
+
 /// Write a new timestamp file with the given path. This is used for the pruning
 /// interval option.
 static void writeTimestampFile(StringRef TimestampFile) {
@@ -127,6 +188,11 @@ llvm::parseCachePruningPolicy(StringRef PolicyStr) {
         return make_error<StringError>("'" + Value + "' not an integer",
                                        inconvertibleErrorCode());
       Policy.MaxSizeBytes = Size * Mult;
+    } else if (Key == "full_scan_interval") {
+      auto DurationOrErr = parseDuration(Value);
+      if (!DurationOrErr)
+        return DurationOrErr.takeError();
+      Policy.FullScanInterval = *DurationOrErr;
     } else if (Key == "cache_size_files") {
       if (Value.getAsInteger(0, Policy.MaxSizeFiles))
         return make_error<StringError>("'" + Value + "' not an integer",
@@ -199,47 +265,103 @@ bool llvm::pruneCache(StringRef Path, CachePruningPolicy Policy) {
     writeTimestampFile(TimestampFile);
   }
 
+  // Read the pruning index, if it is used. It is renamed before it is read,
+  // so that concurrent pruners do not both process it, and uses recorded from
+  // now on go to a new index. Those are read as well, so that files that were
+  // used just now are not pruned.
+  bool UseIndex = Policy.FullScanInterval.hasValue();
+  bool FullScan = true;
+  StringMap<IndexEntry> IndexEntries;
+  SmallString<128> IndexFile(Path);
+  sys::path::append(IndexFile, IndexFileName);
+  if (UseIndex) {
+    SmallString<128> ClaimedIndexFile;
+    sys::fs::createUniquePath(IndexFile + ".%%%%%%", ClaimedIndexFile,
+                              /*MakeAbsolute=*/false);
+    if (!sys::fs::rename(IndexFile, ClaimedIndexFile)) {
+      readIndexFile(ClaimedIndexFile, IndexEntries);
+      sys::fs::remove(ClaimedIndexFile);
+      readIndexFile(IndexFile, IndexEntries);
+
+      // Only list the directory if the last full scan is old enough.
+      SmallString<128> FullScanTimestampFile(Path);
+      sys::path::append(FullScanTimestampFile, FullScanTimestampFileName);
+      sys::fs::file_status FullScanStatus;
+      if (!sys::fs::status(FullScanTimestampFile, FullScanStatus))
+        FullScan = CurrentTime - FullScanStatus.getLastModificationTime() >
+                   *Policy.FullScanInterval;
+    }
+    LLVM_DEBUG(dbgs() << "Read " << IndexEntries.size()
+                      << " entries from the pruning index, "
+                      << (FullScan ? "" : "do not ") << "scan directory\n");
+  }
+
   // Keep track of files to delete to get below the size limit.
   // Order by time of last use so that recently used files are preserved.
   std::set<FileInfo> FileInfos;
   uint64_t TotalSize = 0;
 
-  // Walk the entire directory cache, looking for unused files.
-  std::error_code EC;
-  SmallString<128> CachePathNative;
-  sys::path::native(Path, CachePathNative);
-  // Walk all of the files within this directory.
-  for (sys::fs::directory_iterator File(CachePathNative, EC), FileEnd;
-       File != FileEnd && !EC; File.increment(EC)) {
-    // Ignore any files not beginning with the string "llvmcache-". This
-    // includes the timestamp file as well as any files created by the user.
-    // This acts as a safeguard against data loss if the user specifies the
-    // wrong directory as their cache directory.
-    if (!sys::path::filename(File->path()).startswith("llvmcache-"))
-      continue;
-
-    // Look at this file. If we can't stat it, there's nothing interesting
-    // there.
-    ErrorOr<sys::fs::basic_file_status> StatusOrErr = File->status();
-    if (!StatusOrErr) {
-      LLVM_DEBUG(dbgs() << "Ignore " << File->path() << " (can't stat)\n");
-      continue;
-    }
-
+  auto AddCacheFile = [&](StringRef FilePath, sys::TimePoint<> FileAccessTime,
+                          uint64_t FileSize) {
     // If the file hasn't been used recently enough, delete it
-    const auto FileAccessTime = StatusOrErr->getLastAccessedTime();
     auto FileAge = CurrentTime - FileAccessTime;
     if (Policy.Expiration != seconds(0) && FileAge > Policy.Expiration) {
-      LLVM_DEBUG(dbgs() << "Remove " << File->path() << " ("
+      LLVM_DEBUG(dbgs() << "Remove " << FilePath << " ("
                         << duration_cast<seconds>(FileAge).count()
                         << "s old)\n");
-      sys::fs::remove(File->path());
-      continue;
+      sys::fs::remove(FilePath);
+      return;
     }
 
     // Leave it here for now, but add it to the list of size-based pruning.
-    TotalSize += StatusOrErr->getSize();
-    FileInfos.insert({FileAccessTime, StatusOrErr->getSize(), File->path()});
+    TotalSize += FileSize;
+    FileInfos.insert({FileAccessTime, FileSize, FilePath});
+  };
+
+  if (FullScan) {
+    // Walk the entire directory cache, looking for unused files.
+    std::error_code EC;
+    SmallString<128> CachePathNative;
+    sys::path::native(Path, CachePathNative);
+    // Walk all of the files within this directory.
+    for (sys::fs::directory_iterator File(CachePathNative, EC), FileEnd;
+         File != FileEnd && !EC; File.increment(EC)) {
+      // Ignore any files not beginning with the string "llvmcache-". This
+      // includes the timestamp file as well as any files created by the user.
+      // This acts as a safeguard against data loss if the user specifies the
+      // wrong directory as their cache directory.
+      StringRef FileName = sys::path::filename(File->path());
+      if (!FileName.startswith("llvmcache-"))
+        continue;
+
+      // Look at this file. If we can't stat it, there's nothing interesting
+      // there.
+      ErrorOr<sys::fs::basic_file_status> StatusOrErr = File->status();
+      if (!StatusOrErr) {
+        LLVM_DEBUG(dbgs() << "Ignore " << File->path() << " (can't stat)\n");
+        continue;
+      }
+
+      // Trust the index over the file system for the time of last use.
+      sys::TimePoint<> FileAccessTime = StatusOrErr->getLastAccessedTime();
+      auto It = IndexEntries.find(FileName);
+      if (It != IndexEntries.end())
+        FileAccessTime = std::max(FileAccessTime, It->second.Time);
+      AddCacheFile(File->path(), FileAccessTime, StatusOrErr->getSize());
+    }
+    if (UseIndex) {
+      SmallString<128> FullScanTimestampFile(Path);
+      sys::path::append(FullScanTimestampFile, FullScanTimestampFileName);
+      writeTimestampFile(FullScanTimestampFile);
+    }
+  } else {
+    // Files that have been removed by somebody else stay in the index until
+    // the next full scan, but removing them again is harmless.
+    for (auto &E : IndexEntries) {
+      SmallString<128> FilePath(Path);
+      sys::path::append(FilePath, E.first());
+      AddCacheFile(FilePath, E.second.Time, E.second.Size);
+    }
   }
 
   auto FileInfo = FileInfos.begin();
@@ -288,5 +410,22 @@ bool llvm::pruneCache(StringRef Path, CachePruningPolicy Policy) {
     while (TotalSize > TotalSizeTarget && FileInfo != FileInfos.end())
       RemoveCacheFile();
   }
+
+  // Record the remaining files in the new index. They are appended with a
+  // single write, like the uses recorded by the cache.
+  if (UseIndex) {
+    std::string Entries;
+    raw_string_ostream OS(Entries);
+    for (auto I = FileInfo, E = FileInfos.end(); I != E; ++I)
+      OS << sys::toTimeT(I->Time) << ' ' << I->Size << ' '
+         << sys::path::filename(I->Path) << '\n';
+    OS.flush();
+    int FD;
+    if (!sys::fs::openFileForWrite(IndexFile, FD, sys::fs::CD_OpenAlways,
+                                   sys::fs::OF_Append)) {
+      raw_fd_ostream IndexOS(FD, /*shouldClose=*/true, /*unbuffered=*/true);
+      IndexOS << Entries;
+    }
+  }
   return true;
 }
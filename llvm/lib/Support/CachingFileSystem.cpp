@@ -0,0 +1,184 @@
+//===- CachingFileSystem.cpp - Thread-safe shared file system cache -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CachingFileSystem.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/xxhash.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace llvm::vfs;
+
+SharedFileSystemCache::SharedFileSystemCache() {
+  // Sharding reduces the lock contention between threads looking up
+  // different paths.
+  NumShards = std::max(2u, llvm::hardware_concurrency() / 4);
+  CacheShards = std::make_unique<CacheShard[]>(NumShards);
+}
+
+SharedFileSystemCache::Entry &SharedFileSystemCache::get(StringRef Path) {
+  CacheShard &Shard = CacheShards[llvm::hash_value(Path) % NumShards];
+  std::unique_lock<std::mutex> LockGuard(Shard.CacheLock);
+  return Shard.Cache.try_emplace(Path).first->getValue();
+}
+
+const MemoryBuffer *
+SharedFileSystemCache::getUniqueContents(std::unique_ptr<MemoryBuffer> Buffer) {
+  uint64_t Hash = xxHash64(Buffer->getBuffer());
+  std::unique_lock<std::mutex> LockGuard(ContentsLock);
+  auto &Buffers = Contents[Hash];
+  for (const std::unique_ptr<MemoryBuffer> &Existing : Buffers)
+    if (Existing->getBuffer() == Buffer->getBuffer())
+      return Existing.get();
+  Buffers.push_back(std::move(Buffer));
+  return Buffers.back().get();
+}
+
+namespace {
+
+/// A file whose contents live in a SharedFileSystemCache.
+class CachedFile : public File {
+public:
+  CachedFile(Status Stat, const MemoryBuffer &Contents)
+      : Stat(std::move(Stat)), Contents(Contents) {}
+
+  ErrorOr<Status> status() override { return Stat; }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return MemoryBuffer::getMemBuffer(Contents.getBuffer(), Name.str(),
+                                      RequiresNullTerminator);
+  }
+
+  std::error_code close() override { return {}; }
+
+private:
+  Status Stat;
+  const MemoryBuffer &Contents;
+};
+
+/// A file system that fills and reuses the entries of a
+/// SharedFileSystemCache, with a working directory of its own.
+class CachingFileSystem : public FileSystem {
+public:
+  CachingFileSystem(SharedFileSystemCache &Cache,
+                    IntrusiveRefCntPtr<FileSystem> FS)
+      : Cache(Cache), FS(std::move(FS)) {
+    if (auto CWD = this->FS->getCurrentWorkingDirectory())
+      WorkingDirectory = *CWD;
+  }
+
+  ErrorOr<Status> status(const Twine &Path) override;
+  ErrorOr<std::unique_ptr<File>> openFileForRead(const Twine &Path) override;
+
+  directory_iterator dir_begin(const Twine &Dir, std::error_code &EC) override {
+    SmallString<256> AbsDir;
+    Dir.toVector(AbsDir);
+    makeAbsolute(AbsDir);
+    return FS->dir_begin(AbsDir, EC);
+  }
+
+  ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return WorkingDirectory;
+  }
+
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    SmallString<256> AbsPath;
+    Path.toVector(AbsPath);
+    makeAbsolute(AbsPath);
+    ErrorOr<Status> Stat = status(AbsPath);
+    if (!Stat)
+      return Stat.getError();
+    if (!Stat->isDirectory())
+      return make_error_code(errc::not_a_directory);
+    WorkingDirectory = AbsPath.str();
+    return {};
+  }
+
+  std::error_code getRealPath(const Twine &Path,
+                              SmallVectorImpl<char> &Output) const override {
+    SmallString<256> AbsPath;
+    Path.toVector(AbsPath);
+    makeAbsolute(AbsPath);
+    return FS->getRealPath(AbsPath, Output);
+  }
+
+  std::error_code isLocal(const Twine &Path, bool &Result) override {
+    SmallString<256> AbsPath;
+    Path.toVector(AbsPath);
+    makeAbsolute(AbsPath);
+    return FS->isLocal(AbsPath, Result);
+  }
+
+private:
+  SharedFileSystemCache &Cache;
+  IntrusiveRefCntPtr<FileSystem> FS;
+  std::string WorkingDirectory;
+};
+
+} // end anonymous namespace
+
+ErrorOr<Status> CachingFileSystem::status(const Twine &Path) {
+  SmallString<256> AbsPath;
+  Path.toVector(AbsPath);
+  makeAbsolute(AbsPath);
+
+  SharedFileSystemCache::Entry &Entry = Cache.get(AbsPath);
+  std::unique_lock<std::mutex> LockGuard(Entry.Lock);
+  if (!Entry.HasStatus) {
+    Entry.Stat = FS->status(AbsPath);
+    Entry.HasStatus = true;
+  }
+  if (!Entry.Stat)
+    return Entry.Stat.getError();
+  return Status::copyWithNewName(*Entry.Stat, Path);
+}
+
+ErrorOr<std::unique_ptr<File>>
+CachingFileSystem::openFileForRead(const Twine &Path) {
+  SmallString<256> AbsPath;
+  Path.toVector(AbsPath);
+  makeAbsolute(AbsPath);
+
+  SharedFileSystemCache::Entry &Entry = Cache.get(AbsPath);
+  std::unique_lock<std::mutex> LockGuard(Entry.Lock);
+  if (!Entry.HasContents) {
+    Entry.HasContents = true;
+    ErrorOr<std::unique_ptr<File>> F = FS->openFileForRead(AbsPath);
+    if (!F) {
+      Entry.OpenError = F.getError();
+    } else if (ErrorOr<Status> Stat = (*F)->status()) {
+      ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+          (*F)->getBuffer(AbsPath, Stat->getSize());
+      if (Buffer) {
+        Entry.Contents = Cache.getUniqueContents(std::move(*Buffer));
+        // The status of the opened file is the one that matches its contents.
+        Entry.Stat = std::move(*Stat);
+        Entry.HasStatus = true;
+      } else {
+        Entry.OpenError = Buffer.getError();
+      }
+    } else {
+      Entry.OpenError = Stat.getError();
+    }
+  }
+  if (Entry.OpenError)
+    return Entry.OpenError;
+  return std::unique_ptr<File>(std::make_unique<CachedFile>(
+      Status::copyWithNewName(*Entry.Stat, Path), *Entry.Contents));
+}
+
+IntrusiveRefCntPtr<FileSystem>
+vfs::createCachingFileSystem(SharedFileSystemCache &Cache,
+                             IntrusiveRefCntPtr<FileSystem> FS) {
+  return new CachingFileSystem(Cache, std::move(FS));
+}
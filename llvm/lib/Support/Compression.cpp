@@ -17,6 +17,9 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Parallel.h"
+#include <algorithm>
+#include <vector>
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -60,6 +63,99 @@ Error zlib::compress(StringRef InputBuffer,
   return Res ? createError(convertZlibCodeToString(Res)) : Error::success();
 }
 
+// Compress Block as raw deflate data. Unless it is the last block of the
+// stream, the data ends with a sync flush rather than a final block, so that
+// the next block can be appended to it.
+static int compressBlock(StringRef Block, bool IsLast, int Level,
+                         std::vector<char> &Out) {
+  z_stream Stream = {};
+  int Res = deflateInit2(&Stream, Level, Z_DEFLATED, /*windowBits=*/-15,
+                         /*memLevel=*/8, Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return Res;
+
+  // Leave room for the sync flush marker on top of the worst case size.
+  Out.resize(deflateBound(&Stream, Block.size()) + 16);
+  Stream.next_in = (Bytef *)Block.data();
+  Stream.avail_in = Block.size();
+  Stream.next_out = (Bytef *)Out.data();
+  Stream.avail_out = Out.size();
+  Res = deflate(&Stream, IsLast ? Z_FINISH : Z_SYNC_FLUSH);
+  Out.resize(Stream.total_out);
+  deflateEnd(&Stream);
+  if (Res == (IsLast ? Z_STREAM_END : Z_OK) && Stream.avail_in == 0)
+    return Z_OK;
+  return Res == Z_OK || Res == Z_STREAM_END ? Z_BUF_ERROR : Res;
+}
+
+// Returns the FLEVEL field of the zlib header that deflate() writes for
+// Level.
+static uint8_t getLevelClass(int Level) {
+  if (Level == Z_DEFAULT_COMPRESSION)
+    Level = 6;
+  if (Level < 2)
+    return 0;
+  if (Level < 6)
+    return 1;
+  if (Level == 6)
+    return 2;
+  return 3;
+}
+
+Error zlib::compressParallel(StringRef InputBuffer,
+                             SmallVectorImpl<char> &CompressedBuffer,
+                             int Level, size_t BlockSize) {
+  assert(BlockSize > 0 && "Invalid block size");
+  size_t NumBlocks = (InputBuffer.size() + BlockSize - 1) / BlockSize;
+  if (NumBlocks <= 1)
+    return compress(InputBuffer, CompressedBuffer, Level);
+
+  std::vector<std::vector<char>> Blocks(NumBlocks);
+  std::vector<uLong> Checksums(NumBlocks);
+  std::vector<int> Results(NumBlocks);
+  auto CompressOne = [&](size_t I) {
+    StringRef Block = InputBuffer.substr(I * BlockSize, BlockSize);
+    Results[I] = compressBlock(Block, I == NumBlocks - 1, Level, Blocks[I]);
+    Checksums[I] = adler32(adler32(0, nullptr, 0), (const Bytef *)Block.data(),
+                           Block.size());
+  };
+#if LLVM_ENABLE_THREADS
+  parallel::for_each_n(parallel::par, size_t(0), NumBlocks, CompressOne);
+#else
+  parallel::for_each_n(parallel::seq, size_t(0), NumBlocks, CompressOne);
+#endif
+  for (int Res : Results)
+    if (Res != Z_OK)
+      return createError(convertZlibCodeToString(Res));
+
+  // The zlib header (RFC 1950): deflate with a 32K window, the level class
+  // that deflate() would record, and a check value that makes the header a
+  // multiple of 31.
+  uint8_t CMF = 0x78;
+  uint8_t FLG = getLevelClass(Level) << 6;
+  FLG |= 31 - (CMF * 256 + FLG) % 31;
+
+  // Blocks other than the last one are all BlockSize bytes long.
+  uLong Checksum = Checksums[0];
+  size_t Size = 2 + Blocks[0].size() + 4;
+  for (size_t I = 1; I != NumBlocks; ++I) {
+    size_t Len = std::min(BlockSize, InputBuffer.size() - I * BlockSize);
+    Checksum = adler32_combine(Checksum, Checksums[I], Len);
+    Size += Blocks[I].size();
+  }
+
+  CompressedBuffer.clear();
+  CompressedBuffer.reserve(Size);
+  CompressedBuffer.push_back(CMF);
+  CompressedBuffer.push_back(FLG);
+  for (std::vector<char> &Block : Blocks)
+    CompressedBuffer.append(Block.begin(), Block.end());
+  // The Adler-32 checksum of the uncompressed data, in big-endian order.
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back((Checksum >> Shift) & 0xff);
+  return Error::success();
+}
+
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   int Res =
@@ -91,6 +187,11 @@ Error zlib::compress(StringRef InputBuffer,
                      SmallVectorImpl<char> &CompressedBuffer, int Level) {
   llvm_unreachable("zlib::compress is unavailable");
 }
+Error zlib::compressParallel(StringRef InputBuffer,
+                             SmallVectorImpl<char> &CompressedBuffer,
+                             int Level, size_t BlockSize) {
+  llvm_unreachable("zlib::compressParallel is unavailable");
+}
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   llvm_unreachable("zlib::uncompress is unavailable");
@@ -16,6 +16,8 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Memory.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -112,6 +114,90 @@ private:
   size_t BufferSize;
   unsigned Mode;
 };
+
+// A FileOutputBuffer which keeps data in memory like InMemoryBuffer but
+// writes flushed ranges to a temporary file using a background thread, so
+// that the caller can keep filling the buffer while ranges that are already
+// complete are being written. The temporary file atomically replaces the
+// final output file on commit(), as in OnDiskBuffer.
+class StreamingBuffer : public FileOutputBuffer {
+public:
+  StreamingBuffer(StringRef Path, fs::TempFile Temp, MemoryBlock Buf,
+                  std::size_t BufSize)
+      : FileOutputBuffer(Path), Buffer(Buf), BufferSize(BufSize),
+        Temp(std::move(Temp)), OS(this->Temp.FD, /*shouldClose=*/false,
+                                  /*unbuffered=*/true),
+        Writer(1) {}
+
+  uint8_t *getBufferStart() const override { return (uint8_t *)Buffer.base(); }
+
+  uint8_t *getBufferEnd() const override {
+    return (uint8_t *)Buffer.base() + BufferSize;
+  }
+
+  size_t getBufferSize() const override { return BufferSize; }
+
+  void flush(size_t Offset, size_t Size) override {
+    assert(Offset + Size <= BufferSize && "range out of bounds");
+    if (Size == 0)
+      return;
+    Flushed.emplace_back(Offset, Size);
+    write(Offset, Size);
+  }
+
+  Error commit() override {
+    // Write everything that has not been flushed yet.
+    llvm::sort(Flushed);
+    size_t Pos = 0;
+    for (std::pair<size_t, size_t> &R : Flushed) {
+      if (Pos < R.first)
+        write(Pos, R.first - Pos);
+      Pos = std::max(Pos, R.first + R.second);
+    }
+    if (Pos < BufferSize)
+      write(Pos, BufferSize - Pos);
+    Writer.wait();
+
+    if (std::error_code EC = OS.error()) {
+      OS.clear_error();
+      return errorCodeToError(EC);
+    }
+
+    // Atomically replace the existing file with the new one.
+    return Temp.keep(FinalPath);
+  }
+
+  ~StreamingBuffer() override {
+    Writer.wait();
+    OS.clear_error();
+    consumeError(Temp.discard());
+  }
+
+  void discard() override {
+    Writer.wait();
+    OS.clear_error();
+    consumeError(Temp.discard());
+  }
+
+private:
+  // The writer has only one thread, so writes are done in the order they
+  // are requested. A range that is flushed twice ends up with its last
+  // contents.
+  void write(size_t Offset, size_t Size) {
+    const char *Start = (const char *)Buffer.base() + Offset;
+    Writer.async([=] {
+      OS.seek(Offset);
+      OS.write(Start, Size);
+    });
+  }
+
+  OwningMemoryBlock Buffer;
+  size_t BufferSize;
+  fs::TempFile Temp;
+  raw_fd_ostream OS;
+  ThreadPool Writer;
+  std::vector<std::pair<size_t, size_t>> Flushed;
+};
 } // namespace
 
 static Expected<std::unique_ptr<InMemoryBuffer>>
@@ -161,6 +247,29 @@ createOnDiskBuffer(StringRef Path, size_t Size, unsigned Mode) {
                                          std::move(MappedFile));
 }
 
+static Expected<std::unique_ptr<FileOutputBuffer>>
+createStreamingBuffer(StringRef Path, size_t Size, unsigned Mode) {
+  Expected<fs::TempFile> FileOrErr =
+      fs::TempFile::create(Path + ".tmp%%%%%%%", Mode);
+  if (!FileOrErr)
+    return FileOrErr.takeError();
+  fs::TempFile File = std::move(*FileOrErr);
+
+  if (auto EC = fs::resize_file(File.FD, Size)) {
+    consumeError(File.discard());
+    return errorCodeToError(EC);
+  }
+
+  std::error_code EC;
+  MemoryBlock MB = Memory::allocateMappedMemory(
+      Size, nullptr, sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC) {
+    consumeError(File.discard());
+    return errorCodeToError(EC);
+  }
+  return std::make_unique<StreamingBuffer>(Path, std::move(File), MB, Size);
+}
+
 // Create an instance of FileOutputBuffer.
 Expected<std::unique_ptr<FileOutputBuffer>>
 FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
@@ -189,6 +298,8 @@ FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
   case fs::file_type::regular_file:
   case fs::file_type::file_not_found:
   case fs::file_type::status_error:
+    if (Flags & F_streaming)
+      return createStreamingBuffer(Path, Size, Mode);
     return createOnDiskBuffer(Path, Size, Mode);
   default:
     return createInMemoryBuffer(Path, Size, Mode);
@@ -106,7 +106,10 @@ public:
 template <typename MB>
 static ErrorOr<std::unique_ptr<MB>>
 getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize,
-           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatile);
+           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatile,
+           sys::fs::mapped_file_region::advice Advice =
+               sys::fs::mapped_file_region::normal,
+           bool HugePages = false);
 
 std::unique_ptr<MemoryBuffer>
 MemoryBuffer::getMemBuffer(StringRef InputData, StringRef BufferName,
@@ -150,6 +153,17 @@ MemoryBuffer::getFileOrSTDIN(const Twine &Filename, int64_t FileSize,
   return getFile(Filename, FileSize, RequiresNullTerminator);
 }
 
+ErrorOr<std::unique_ptr<MemoryBuffer>>
+MemoryBuffer::getFileOrSTDIN(const Twine &Filename,
+                             const MemoryBufferOpenOptions &Options) {
+  SmallString<256> NameBuf;
+  StringRef NameRef = Filename.toStringRef(NameBuf);
+
+  if (NameRef == "-")
+    return getSTDIN();
+  return getFile(Filename, Options);
+}
+
 ErrorOr<std::unique_ptr<MemoryBuffer>>
 MemoryBuffer::getFileSlice(const Twine &FilePath, uint64_t MapSize,
                            uint64_t Offset, bool IsVolatile) {
@@ -183,12 +197,20 @@ class MemoryBufferMMapFile : public MB {
 
 public:
   MemoryBufferMMapFile(bool RequiresNullTerminator, sys::fs::file_t FD, uint64_t Len,
-                       uint64_t Offset, std::error_code &EC)
+                       uint64_t Offset, std::error_code &EC,
+                       sys::fs::mapped_file_region::advice Advice =
+                           sys::fs::mapped_file_region::normal,
+                       bool HugePages = false)
       : MFR(FD, MB::Mapmode, getLegalMapSize(Len, Offset),
             getLegalMapOffset(Offset), EC) {
     if (!EC) {
       const char *Start = getStart(Len, Offset);
       MemoryBuffer::init(Start, Start + Len, RequiresNullTerminator);
+      // Ask for huge pages first, so that read-ahead fills them.
+      if (HugePages)
+        MFR.adviseHugePages();
+      if (Advice != sys::fs::mapped_file_region::normal)
+        MFR.advise(Advice);
     }
   }
 
@@ -204,6 +226,11 @@ public:
   MemoryBuffer::BufferKind getBufferKind() const override {
     return MemoryBuffer::MemoryBuffer_MMap;
   }
+
+  void dontNeedIfMmap() override {
+    if (MB::Mapmode == sys::fs::mapped_file_region::readonly)
+      MFR.dontNeed();
+  }
 };
 }
 
@@ -232,23 +259,37 @@ MemoryBuffer::getFile(const Twine &Filename, int64_t FileSize,
                                   RequiresNullTerminator, IsVolatile);
 }
 
+ErrorOr<std::unique_ptr<MemoryBuffer>>
+MemoryBuffer::getFile(const Twine &Filename,
+                      const MemoryBufferOpenOptions &Options) {
+  return getFileAux<MemoryBuffer>(
+      Filename, Options.FileSize, Options.FileSize, 0,
+      Options.RequiresNullTerminator, Options.IsVolatile, Options.Advice,
+      Options.HugePages);
+}
+
 template <typename MB>
 static ErrorOr<std::unique_ptr<MB>>
 getOpenFileImpl(sys::fs::file_t FD, const Twine &Filename, uint64_t FileSize,
                 uint64_t MapSize, int64_t Offset, bool RequiresNullTerminator,
-                bool IsVolatile);
+                bool IsVolatile,
+                sys::fs::mapped_file_region::advice Advice =
+                    sys::fs::mapped_file_region::normal,
+                bool HugePages = false);
 
 template <typename MB>
 static ErrorOr<std::unique_ptr<MB>>
 getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize,
-           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatile) {
+           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatile,
+           sys::fs::mapped_file_region::advice Advice, bool HugePages) {
   Expected<sys::fs::file_t> FDOrErr =
       sys::fs::openNativeFileForRead(Filename, sys::fs::OF_None);
   if (!FDOrErr)
     return errorToErrorCode(FDOrErr.takeError());
   sys::fs::file_t FD = *FDOrErr;
   auto Ret = getOpenFileImpl<MB>(FD, Filename, FileSize, MapSize, Offset,
-                                 RequiresNullTerminator, IsVolatile);
+                                 RequiresNullTerminator, IsVolatile, Advice,
+                                 HugePages);
   sys::fs::closeFile(FD);
   return Ret;
 }
@@ -415,7 +456,8 @@ template <typename MB>
 static ErrorOr<std::unique_ptr<MB>>
 getOpenFileImpl(sys::fs::file_t FD, const Twine &Filename, uint64_t FileSize,
                 uint64_t MapSize, int64_t Offset, bool RequiresNullTerminator,
-                bool IsVolatile) {
+                bool IsVolatile, sys::fs::mapped_file_region::advice Advice,
+                bool HugePages) {
   static int PageSize = sys::Process::getPageSizeEstimate();
 
   // Default is to map the full file.
@@ -446,7 +488,8 @@ getOpenFileImpl(sys::fs::file_t FD, const Twine &Filename, uint64_t FileSize,
     std::error_code EC;
     std::unique_ptr<MB> Result(
         new (NamedBufferAlloc(Filename)) MemoryBufferMMapFile<MB>(
-            RequiresNullTerminator, FD, MapSize, Offset, EC));
+            RequiresNullTerminator, FD, MapSize, Offset, EC, Advice,
+            HugePages));
     if (!EC)
       return std::move(Result);
   }
@@ -11,11 +11,14 @@
 
 #if LLVM_ENABLE_THREADS
 
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Threading.h"
 
 #include <atomic>
-#include <stack>
+#include <deque>
+#include <memory>
 #include <thread>
+#include <vector>
 
 namespace llvm {
 namespace parallel {
@@ -60,66 +63,169 @@ Executor *Executor::getDefaultExecutor() {
 }
 
 #else
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+/// The index of the current thread in the default executor, or ~0U if the
+/// current thread is not one of its workers.
+static LLVM_THREAD_LOCAL unsigned WorkerIndex = ~0U;
+
+/// An implementation of an Executor that runs closures on a thread pool.
+///
+/// Each worker has its own queue. Workers run the tasks they spawned
+/// themselves in lifo order, and steal the oldest tasks of other workers when
+/// their own queue is empty. Tasks added by threads outside of the pool are
+/// distributed over the queues round-robin.
 class ThreadPoolExecutor : public Executor {
+  struct WorkQueue {
+    std::mutex Mutex;
+    std::deque<std::function<void()>> Tasks;
+  };
+
 public:
   explicit ThreadPoolExecutor(unsigned ThreadCount = hardware_concurrency())
-      : Done(ThreadCount) {
+      : Queues(ThreadCount), Done(ThreadCount) {
+    for (std::unique_ptr<WorkQueue> &Q : Queues)
+      Q = std::make_unique<WorkQueue>();
+
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
     std::thread([&, ThreadCount] {
-      for (size_t i = 1; i < ThreadCount; ++i) {
-        std::thread([=] { work(); }).detach();
+      for (unsigned I = 1; I < ThreadCount; ++I) {
+        std::thread([=] { work(I); }).detach();
       }
-      work();
+      work(0);
     }).detach();
   }
 
   ~ThreadPoolExecutor() override {
-    std::unique_lock<std::mutex> Lock(Mutex);
+    std::unique_lock<std::mutex> Lock(SleepMutex);
     Stop = true;
     Lock.unlock();
-    Cond.notify_all();
+    SleepCond.notify_all();
     // Wait for ~Latch.
   }
 
+  unsigned getThreadCount() const { return Queues.size(); }
+
   void add(std::function<void()> F) override {
-    std::unique_lock<std::mutex> Lock(Mutex);
-    WorkStack.push(F);
-    Lock.unlock();
-    Cond.notify_one();
+    unsigned I = WorkerIndex;
+    if (I >= Queues.size())
+      I = NextQueue++ % Queues.size();
+    {
+      std::lock_guard<std::mutex> Lock(Queues[I]->Mutex);
+      Queues[I]->Tasks.push_back(std::move(F));
+    }
+    ++Pending;
+    wake(/*All=*/false);
+  }
+
+  /// Runs queued tasks on the calling thread until \p IsDone returns true.
+  /// This lets a thread that waits for a TaskGroup make progress on the tasks
+  /// of that group, which makes nested parallelism deadlock-free.
+  void helpUntil(function_ref<bool()> IsDone) {
+    while (!IsDone()) {
+      if (runOne())
+        continue;
+      std::unique_lock<std::mutex> Lock(SleepMutex);
+      ++Sleepers;
+      SleepCond.wait(Lock, [&] { return Pending > 0 || IsDone(); });
+      --Sleepers;
+    }
+  }
+
+  /// Wakes up threads sleeping in work() or helpUntil().
+  void wake(bool All) {
+    if (Sleepers == 0)
+      return;
+    std::lock_guard<std::mutex> Lock(SleepMutex);
+    if (All)
+      SleepCond.notify_all();
+    else
+      SleepCond.notify_one();
   }
 
 private:
-  void work() {
+  bool pop(std::function<void()> &Task) {
+    unsigned Self = WorkerIndex;
+    if (Self < Queues.size()) {
+      WorkQueue &Q = *Queues[Self];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.back());
+        Q.Tasks.pop_back();
+        return true;
+      }
+    }
+
+    size_t Start = Self < Queues.size() ? Self + 1 : 0;
+    for (size_t I = 0, E = Queues.size(); I != E; ++I) {
+      WorkQueue &Q = *Queues[(Start + I) % E];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.front());
+        Q.Tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool runOne() {
+    if (Pending == 0)
+      return false;
+    std::function<void()> Task;
+    if (!pop(Task))
+      return false;
+    --Pending;
+    Task();
+    return true;
+  }
+
+  void work(unsigned Index) {
+    WorkerIndex = Index;
     while (true) {
-      std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
+      if (runOne())
+        continue;
+      std::unique_lock<std::mutex> Lock(SleepMutex);
+      ++Sleepers;
+      SleepCond.wait(Lock, [&] { return Stop || Pending > 0; });
+      --Sleepers;
       if (Stop)
         break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
     }
     Done.dec();
   }
 
-  std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
-  std::mutex Mutex;
-  std::condition_variable Cond;
+  std::vector<std::unique_ptr<WorkQueue>> Queues;
+  std::atomic<unsigned> NextQueue{0};
+  std::atomic<size_t> Pending{0};
+  std::atomic<unsigned> Sleepers{0};
+  bool Stop = false;
+  std::mutex SleepMutex;
+  std::condition_variable SleepCond;
   parallel::detail::Latch Done;
 };
 
-Executor *Executor::getDefaultExecutor() {
+static ThreadPoolExecutor *getThreadPoolExecutor() {
   static ThreadPoolExecutor exec;
   return &exec;
 }
+
+Executor *Executor::getDefaultExecutor() { return getThreadPoolExecutor(); }
 #endif
 }
 
+#if !defined(_MSC_VER)
+} // namespace detail
+
+unsigned getThreadIndex() { return detail::WorkerIndex; }
+
+unsigned getThreadCount() {
+  return detail::getThreadPoolExecutor()->getThreadCount();
+}
+
+namespace detail {
+#endif
+
+#if defined(_MSC_VER)
 static std::atomic<int> TaskGroupInstances;
 
 // Latch::sync() called by the dtor may cause one thread to block. If is a dead
@@ -127,7 +233,10 @@ static std::atomic<int> TaskGroupInstances;
 // lock, only allow the first TaskGroup to run tasks parallelly. In the scenario
 // of nested parallel_for_each(), only the outermost one runs parallelly.
 TaskGroup::TaskGroup() : Parallel(TaskGroupInstances++ == 0) {}
-TaskGroup::~TaskGroup() { --TaskGroupInstances; }
+TaskGroup::~TaskGroup() {
+  L.sync();
+  --TaskGroupInstances;
+}
 
 void TaskGroup::spawn(std::function<void()> F) {
   if (Parallel) {
@@ -141,6 +250,29 @@ void TaskGroup::spawn(std::function<void()> F) {
   }
 }
 
+void TaskGroup::sync() const { L.sync(); }
+#else
+// A thread waiting for a TaskGroup runs queued tasks in the meantime, so
+// nested TaskGroups can run their tasks in parallel as well.
+TaskGroup::TaskGroup() {}
+TaskGroup::~TaskGroup() { sync(); }
+
+void TaskGroup::spawn(std::function<void()> F) {
+  L.inc();
+  getThreadPoolExecutor()->add([&, F] {
+    F();
+    // Do not touch this TaskGroup after the last task is done, as the
+    // waiting thread may destroy it as soon as it observes that.
+    if (L.dec())
+      getThreadPoolExecutor()->wake(/*All=*/true);
+  });
+}
+
+void TaskGroup::sync() const {
+  getThreadPoolExecutor()->helpUntil([&] { return L.isDone(); });
+}
+#endif
+
 } // namespace detail
 } // namespace parallel
 } // namespace llvm
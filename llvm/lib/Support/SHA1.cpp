@@ -16,12 +16,23 @@
 
 #include "llvm/Support/SHA1.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Host.h"
 using namespace llvm;
 
+#include <algorithm>
 #include <stdint.h>
 #include <string.h>
 
+// Use the SHA extensions of x86 processors that have them. The instructions
+// are only used after checking CPUID, so that the library still runs on any
+// x86 processor.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA1_X86_SHA
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #if defined(BYTE_ORDER) && defined(BIG_ENDIAN) && BYTE_ORDER == BIG_ENDIAN
 #define SHA_BIG_ENDIAN
 #endif
@@ -91,103 +102,223 @@ void SHA1::init() {
   InternalState.BufferOffset = 0;
 }
 
-void SHA1::hashBlock() {
-  uint32_t A = InternalState.State[0];
-  uint32_t B = InternalState.State[1];
-  uint32_t C = InternalState.State[2];
-  uint32_t D = InternalState.State[3];
-  uint32_t E = InternalState.State[4];
+// Run the compression function on the 16 words of a block, which have
+// already been converted to host byte order.
+static void hashBlockWords(uint32_t *State, uint32_t *Buf) {
+  uint32_t A = State[0];
+  uint32_t B = State[1];
+  uint32_t C = State[2];
+  uint32_t D = State[3];
+  uint32_t E = State[4];
 
   // 4 rounds of 20 operations each. Loop unrolled.
-  r0(A, B, C, D, E, 0, InternalState.Buffer.L);
-  r0(E, A, B, C, D, 1, InternalState.Buffer.L);
-  r0(D, E, A, B, C, 2, InternalState.Buffer.L);
-  r0(C, D, E, A, B, 3, InternalState.Buffer.L);
-  r0(B, C, D, E, A, 4, InternalState.Buffer.L);
-  r0(A, B, C, D, E, 5, InternalState.Buffer.L);
-  r0(E, A, B, C, D, 6, InternalState.Buffer.L);
-  r0(D, E, A, B, C, 7, InternalState.Buffer.L);
-  r0(C, D, E, A, B, 8, InternalState.Buffer.L);
-  r0(B, C, D, E, A, 9, InternalState.Buffer.L);
-  r0(A, B, C, D, E, 10, InternalState.Buffer.L);
-  r0(E, A, B, C, D, 11, InternalState.Buffer.L);
-  r0(D, E, A, B, C, 12, InternalState.Buffer.L);
-  r0(C, D, E, A, B, 13, InternalState.Buffer.L);
-  r0(B, C, D, E, A, 14, InternalState.Buffer.L);
-  r0(A, B, C, D, E, 15, InternalState.Buffer.L);
-  r1(E, A, B, C, D, 16, InternalState.Buffer.L);
-  r1(D, E, A, B, C, 17, InternalState.Buffer.L);
-  r1(C, D, E, A, B, 18, InternalState.Buffer.L);
-  r1(B, C, D, E, A, 19, InternalState.Buffer.L);
-
-  r2(A, B, C, D, E, 20, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 21, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 22, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 23, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 24, InternalState.Buffer.L);
-  r2(A, B, C, D, E, 25, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 26, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 27, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 28, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 29, InternalState.Buffer.L);
-  r2(A, B, C, D, E, 30, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 31, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 32, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 33, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 34, InternalState.Buffer.L);
-  r2(A, B, C, D, E, 35, InternalState.Buffer.L);
-  r2(E, A, B, C, D, 36, InternalState.Buffer.L);
-  r2(D, E, A, B, C, 37, InternalState.Buffer.L);
-  r2(C, D, E, A, B, 38, InternalState.Buffer.L);
-  r2(B, C, D, E, A, 39, InternalState.Buffer.L);
-
-  r3(A, B, C, D, E, 40, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 41, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 42, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 43, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 44, InternalState.Buffer.L);
-  r3(A, B, C, D, E, 45, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 46, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 47, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 48, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 49, InternalState.Buffer.L);
-  r3(A, B, C, D, E, 50, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 51, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 52, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 53, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 54, InternalState.Buffer.L);
-  r3(A, B, C, D, E, 55, InternalState.Buffer.L);
-  r3(E, A, B, C, D, 56, InternalState.Buffer.L);
-  r3(D, E, A, B, C, 57, InternalState.Buffer.L);
-  r3(C, D, E, A, B, 58, InternalState.Buffer.L);
-  r3(B, C, D, E, A, 59, InternalState.Buffer.L);
-
-  r4(A, B, C, D, E, 60, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 61, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 62, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 63, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 64, InternalState.Buffer.L);
-  r4(A, B, C, D, E, 65, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 66, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 67, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 68, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 69, InternalState.Buffer.L);
-  r4(A, B, C, D, E, 70, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 71, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 72, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 73, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 74, InternalState.Buffer.L);
-  r4(A, B, C, D, E, 75, InternalState.Buffer.L);
-  r4(E, A, B, C, D, 76, InternalState.Buffer.L);
-  r4(D, E, A, B, C, 77, InternalState.Buffer.L);
-  r4(C, D, E, A, B, 78, InternalState.Buffer.L);
-  r4(B, C, D, E, A, 79, InternalState.Buffer.L);
-
-  InternalState.State[0] += A;
-  InternalState.State[1] += B;
-  InternalState.State[2] += C;
-  InternalState.State[3] += D;
-  InternalState.State[4] += E;
+  r0(A, B, C, D, E, 0, Buf);
+  r0(E, A, B, C, D, 1, Buf);
+  r0(D, E, A, B, C, 2, Buf);
+  r0(C, D, E, A, B, 3, Buf);
+  r0(B, C, D, E, A, 4, Buf);
+  r0(A, B, C, D, E, 5, Buf);
+  r0(E, A, B, C, D, 6, Buf);
+  r0(D, E, A, B, C, 7, Buf);
+  r0(C, D, E, A, B, 8, Buf);
+  r0(B, C, D, E, A, 9, Buf);
+  r0(A, B, C, D, E, 10, Buf);
+  r0(E, A, B, C, D, 11, Buf);
+  r0(D, E, A, B, C, 12, Buf);
+  r0(C, D, E, A, B, 13, Buf);
+  r0(B, C, D, E, A, 14, Buf);
+  r0(A, B, C, D, E, 15, Buf);
+  r1(E, A, B, C, D, 16, Buf);
+  r1(D, E, A, B, C, 17, Buf);
+  r1(C, D, E, A, B, 18, Buf);
+  r1(B, C, D, E, A, 19, Buf);
+
+  r2(A, B, C, D, E, 20, Buf);
+  r2(E, A, B, C, D, 21, Buf);
+  r2(D, E, A, B, C, 22, Buf);
+  r2(C, D, E, A, B, 23, Buf);
+  r2(B, C, D, E, A, 24, Buf);
+  r2(A, B, C, D, E, 25, Buf);
+  r2(E, A, B, C, D, 26, Buf);
+  r2(D, E, A, B, C, 27, Buf);
+  r2(C, D, E, A, B, 28, Buf);
+  r2(B, C, D, E, A, 29, Buf);
+  r2(A, B, C, D, E, 30, Buf);
+  r2(E, A, B, C, D, 31, Buf);
+  r2(D, E, A, B, C, 32, Buf);
+  r2(C, D, E, A, B, 33, Buf);
+  r2(B, C, D, E, A, 34, Buf);
+  r2(A, B, C, D, E, 35, Buf);
+  r2(E, A, B, C, D, 36, Buf);
+  r2(D, E, A, B, C, 37, Buf);
+  r2(C, D, E, A, B, 38, Buf);
+  r2(B, C, D, E, A, 39, Buf);
+
+  r3(A, B, C, D, E, 40, Buf);
+  r3(E, A, B, C, D, 41, Buf);
+  r3(D, E, A, B, C, 42, Buf);
+  r3(C, D, E, A, B, 43, Buf);
+  r3(B, C, D, E, A, 44, Buf);
+  r3(A, B, C, D, E, 45, Buf);
+  r3(E, A, B, C, D, 46, Buf);
+  r3(D, E, A, B, C, 47, Buf);
+  r3(C, D, E, A, B, 48, Buf);
+  r3(B, C, D, E, A, 49, Buf);
+  r3(A, B, C, D, E, 50, Buf);
+  r3(E, A, B, C, D, 51, Buf);
+  r3(D, E, A, B, C, 52, Buf);
+  r3(C, D, E, A, B, 53, Buf);
+  r3(B, C, D, E, A, 54, Buf);
+  r3(A, B, C, D, E, 55, Buf);
+  r3(E, A, B, C, D, 56, Buf);
+  r3(D, E, A, B, C, 57, Buf);
+  r3(C, D, E, A, B, 58, Buf);
+  r3(B, C, D, E, A, 59, Buf);
+
+  r4(A, B, C, D, E, 60, Buf);
+  r4(E, A, B, C, D, 61, Buf);
+  r4(D, E, A, B, C, 62, Buf);
+  r4(C, D, E, A, B, 63, Buf);
+  r4(B, C, D, E, A, 64, Buf);
+  r4(A, B, C, D, E, 65, Buf);
+  r4(E, A, B, C, D, 66, Buf);
+  r4(D, E, A, B, C, 67, Buf);
+  r4(C, D, E, A, B, 68, Buf);
+  r4(B, C, D, E, A, 69, Buf);
+  r4(A, B, C, D, E, 70, Buf);
+  r4(E, A, B, C, D, 71, Buf);
+  r4(D, E, A, B, C, 72, Buf);
+  r4(C, D, E, A, B, 73, Buf);
+  r4(B, C, D, E, A, 74, Buf);
+  r4(A, B, C, D, E, 75, Buf);
+  r4(E, A, B, C, D, 76, Buf);
+  r4(D, E, A, B, C, 77, Buf);
+  r4(C, D, E, A, B, 78, Buf);
+  r4(B, C, D, E, A, 79, Buf);
+
+  State[0] += A;
+  State[1] += B;
+  State[2] += C;
+  State[3] += D;
+  State[4] += E;
+}
+
+#ifdef SHA1_X86_SHA
+static bool hasSHAExtensions() {
+  static const bool Supported = [] {
+    unsigned EAX, EBX, ECX, EDX;
+    if (!__get_cpuid(1, &EAX, &EBX, &ECX, &EDX) || !(ECX & bit_SSSE3) ||
+        !(ECX & bit_SSE4_1))
+      return false;
+    if (__get_cpuid_max(0, nullptr) < 7)
+      return false;
+    __cpuid_count(7, 0, EAX, EBX, ECX, EDX);
+    return (EBX & (1 << 29)) != 0;
+  }();
+  return Supported;
+}
+
+// Four rounds of SHA-1, plus the message schedule for the following rounds.
+// M0 holds the words for these rounds, and M1 to M3 the next ones.
+template <int Func>
+__attribute__((target("sha,sse4.1"), always_inline)) static inline void
+sha4Rounds(__m128i &ABCD, __m128i &E, __m128i &ENext, __m128i &M0,
+           __m128i &M1, __m128i &M2, __m128i &M3) {
+  E = _mm_sha1nexte_epu32(E, M0);
+  ENext = ABCD;
+  M1 = _mm_sha1msg2_epu32(M1, M0);
+  ABCD = _mm_sha1rnds4_epu32(ABCD, E, Func);
+  M3 = _mm_sha1msg1_epu32(M3, M0);
+  M2 = _mm_xor_si128(M2, M0);
+}
+
+__attribute__((target("sha,sse4.1"))) static void
+hashBlocksSHA(uint32_t *State, const uint8_t *Data, size_t NumBlocks) {
+  // Reverses the bytes of the 16-byte message, which turns its big-endian
+  // words into host order and puts the first word in the top lane.
+  const __m128i Mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  __m128i ABCD = _mm_loadu_si128((const __m128i *)State);
+  ABCD = _mm_shuffle_epi32(ABCD, 0x1B);
+  __m128i E0 = _mm_set_epi32(State[4], 0, 0, 0);
+  __m128i E1;
+
+  for (; NumBlocks != 0; --NumBlocks, Data += 64) {
+    __m128i ABCDSave = ABCD;
+    __m128i E0Save = E0;
+
+    __m128i M0 = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *)(Data + 0)), Mask);
+    __m128i M1 = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *)(Data + 16)), Mask);
+    __m128i M2 = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *)(Data + 32)), Mask);
+    __m128i M3 = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *)(Data + 48)), Mask);
+
+    // Rounds 0-11, where the message schedule is only being started.
+    E0 = _mm_add_epi32(E0, M0);
+    E1 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+
+    E1 = _mm_sha1nexte_epu32(E1, M1);
+    E0 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 0);
+    M0 = _mm_sha1msg1_epu32(M0, M1);
+
+    E0 = _mm_sha1nexte_epu32(E0, M2);
+    E1 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+    M1 = _mm_sha1msg1_epu32(M1, M2);
+    M0 = _mm_xor_si128(M0, M2);
+
+    // Rounds 12-79. The round function changes every 20 rounds.
+    sha4Rounds<0>(ABCD, E1, E0, M3, M0, M1, M2); // 12-15
+    sha4Rounds<0>(ABCD, E0, E1, M0, M1, M2, M3); // 16-19
+    sha4Rounds<1>(ABCD, E1, E0, M1, M2, M3, M0); // 20-23
+    sha4Rounds<1>(ABCD, E0, E1, M2, M3, M0, M1); // 24-27
+    sha4Rounds<1>(ABCD, E1, E0, M3, M0, M1, M2); // 28-31
+    sha4Rounds<1>(ABCD, E0, E1, M0, M1, M2, M3); // 32-35
+    sha4Rounds<1>(ABCD, E1, E0, M1, M2, M3, M0); // 36-39
+    sha4Rounds<2>(ABCD, E0, E1, M2, M3, M0, M1); // 40-43
+    sha4Rounds<2>(ABCD, E1, E0, M3, M0, M1, M2); // 44-47
+    sha4Rounds<2>(ABCD, E0, E1, M0, M1, M2, M3); // 48-51
+    sha4Rounds<2>(ABCD, E1, E0, M1, M2, M3, M0); // 52-55
+    sha4Rounds<2>(ABCD, E0, E1, M2, M3, M0, M1); // 56-59
+    sha4Rounds<3>(ABCD, E1, E0, M3, M0, M1, M2); // 60-63
+    sha4Rounds<3>(ABCD, E0, E1, M0, M1, M2, M3); // 64-67
+    sha4Rounds<3>(ABCD, E1, E0, M1, M2, M3, M0); // 68-71
+    sha4Rounds<3>(ABCD, E0, E1, M2, M3, M0, M1); // 72-75
+    sha4Rounds<3>(ABCD, E1, E0, M3, M0, M1, M2); // 76-79
+
+    E0 = _mm_sha1nexte_epu32(E0, E0Save);
+    ABCD = _mm_add_epi32(ABCD, ABCDSave);
+  }
+
+  ABCD = _mm_shuffle_epi32(ABCD, 0x1B);
+  _mm_storeu_si128((__m128i *)State, ABCD);
+  State[4] = _mm_extract_epi32(E0, 3);
+}
+#endif
+
+// Hash NumBlocks whole blocks of input, bypassing the block buffer.
+static void hashBlocks(uint32_t *State, const uint8_t *Data,
+                       size_t NumBlocks) {
+#ifdef SHA1_X86_SHA
+  if (hasSHAExtensions())
+    return hashBlocksSHA(State, Data, NumBlocks);
+#endif
+  uint32_t Buf[16];
+  for (; NumBlocks != 0; --NumBlocks, Data += 64) {
+    for (int I = 0; I != 16; ++I)
+      Buf[I] = support::endian::read32be(Data + I * 4);
+    hashBlockWords(State, Buf);
+  }
+}
+
+void SHA1::hashBlock() {
+  hashBlockWords(InternalState.State, InternalState.Buffer.L);
 }
 
 void SHA1::addUncounted(uint8_t Data) {
@@ -204,14 +335,27 @@ void SHA1::addUncounted(uint8_t Data) {
   }
 }
 
-void SHA1::writebyte(uint8_t Data) {
-  ++InternalState.ByteCount;
-  addUncounted(Data);
-}
-
 void SHA1::update(ArrayRef<uint8_t> Data) {
-  for (auto &C : Data)
-    writebyte(C);
+  InternalState.ByteCount += Data.size();
+
+  // Finish the block that is being buffered.
+  if (InternalState.BufferOffset != 0) {
+    size_t N = std::min<size_t>(Data.size(),
+                                BLOCK_LENGTH - InternalState.BufferOffset);
+    for (uint8_t C : Data.take_front(N))
+      addUncounted(C);
+    Data = Data.drop_front(N);
+  }
+
+  // Hash whole blocks directly from the input.
+  size_t NumBlocks = Data.size() / BLOCK_LENGTH;
+  if (NumBlocks != 0) {
+    hashBlocks(InternalState.State, Data.data(), NumBlocks);
+    Data = Data.drop_front(NumBlocks * BLOCK_LENGTH);
+  }
+
+  for (uint8_t C : Data)
+    addUncounted(C);
 }
 
 void SHA1::pad() {
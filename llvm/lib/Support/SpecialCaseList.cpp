@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Regex.h"
+#include <algorithm>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -25,6 +26,40 @@
 #include <stdio.h>
 namespace llvm {
 
+// Returns true if Query matches Pattern as a whole, where '*' matches any
+// sequence of characters and '.' any character.
+static bool matchGlob(StringRef Pattern, StringRef Query) {
+  size_t P = 0, Q = 0;
+  // Where to resume after the last '*' when a mismatch is found.
+  size_t StarP = StringRef::npos, StarQ = 0;
+  while (Q < Query.size()) {
+    if (P < Pattern.size() && Pattern[P] == '*') {
+      StarP = ++P;
+      StarQ = Q;
+    } else if (P < Pattern.size() &&
+               (Pattern[P] == '.' || Pattern[P] == Query[Q])) {
+      ++P;
+      ++Q;
+    } else if (StarP != StringRef::npos) {
+      P = StarP;
+      Q = ++StarQ;
+    } else {
+      return false;
+    }
+  }
+  while (P < Pattern.size() && Pattern[P] == '*')
+    ++P;
+  return P == Pattern.size();
+}
+
+void SpecialCaseList::Matcher::GlobIndex::insert(StringRef Literal,
+                                                 unsigned Glob) {
+  Globs[Literal].push_back(Glob);
+  auto It = std::lower_bound(Lengths.begin(), Lengths.end(), Literal.size());
+  if (It == Lengths.end() || *It != Literal.size())
+    Lengths.insert(It, Literal.size());
+}
+
 bool SpecialCaseList::Matcher::insert(std::string Regexp,
                                       unsigned LineNumber,
                                       std::string &REError) {
@@ -38,6 +73,26 @@ bool SpecialCaseList::Matcher::insert(std::string Regexp,
     return true;
   }
   Trigrams.insert(Regexp);
+  unsigned Order = Globs.size() + RegExes.size();
+
+  // Wildcards without other metacharacters than '*' and '.' don't need a
+  // Regex.
+  if (StringRef(Regexp).find_first_of("()^$|+?[]\\{}") == StringRef::npos) {
+    StringRef Pattern = Regexp;
+    StringRef Prefix = Pattern.take_until([](char C) {
+      return C == '*' || C == '.';
+    });
+    StringRef Suffix = Pattern.substr(Pattern.find_last_of("*.") + 1);
+    unsigned Index = Globs.size();
+    if (!Prefix.empty())
+      GlobsByPrefix.insert(Prefix, Index);
+    else if (!Suffix.empty())
+      GlobsBySuffix.insert(Suffix, Index);
+    else
+      OtherGlobs.push_back(Index);
+    Globs.push_back({std::move(Regexp), LineNumber, Order});
+    return true;
+  }
 
   // Replace * with .*
   for (size_t pos = 0; (pos = Regexp.find('*', pos)) != std::string::npos;
@@ -52,8 +107,8 @@ bool SpecialCaseList::Matcher::insert(std::string Regexp,
   if (!CheckRE.isValid(REError))
     return false;
 
-  RegExes.emplace_back(
-      std::make_pair(std::make_unique<Regex>(std::move(CheckRE)), LineNumber));
+  RegExes.push_back(
+      {std::make_unique<Regex>(std::move(CheckRE)), LineNumber, Order});
   return true;
 }
 
@@ -63,10 +118,43 @@ unsigned SpecialCaseList::Matcher::match(StringRef Query) const {
     return It->second;
   if (Trigrams.isDefinitelyOut(Query))
     return false;
-  for (auto& RegExKV : RegExes)
-    if (RegExKV.first->match(Query))
-      return RegExKV.second;
-  return 0;
+
+  // The first rule that matches, in the order they were inserted.
+  const Glob *Best = nullptr;
+  auto MatchGlob = [&](unsigned Index) {
+    const Glob &G = Globs[Index];
+    if ((!Best || G.Order < Best->Order) && matchGlob(G.Pattern, Query))
+      Best = &G;
+  };
+  for (size_t Length : GlobsByPrefix.Lengths) {
+    if (Length > Query.size())
+      break;
+    auto Candidates = GlobsByPrefix.Globs.find(Query.take_front(Length));
+    if (Candidates != GlobsByPrefix.Globs.end())
+      for (unsigned Index : Candidates->second)
+        MatchGlob(Index);
+  }
+  for (size_t Length : GlobsBySuffix.Lengths) {
+    if (Length > Query.size())
+      break;
+    auto Candidates = GlobsBySuffix.Globs.find(Query.take_back(Length));
+    if (Candidates != GlobsBySuffix.Globs.end())
+      for (unsigned Index : Candidates->second)
+        MatchGlob(Index);
+  }
+  for (unsigned Index : OtherGlobs) {
+    if (Best && Globs[Index].Order > Best->Order)
+      break;
+    MatchGlob(Index);
+  }
+
+  for (const RegEx &R : RegExes) {
+    if (Best && R.Order > Best->Order)
+      break;
+    if (R.RE->match(Query))
+      return R.LineNumber;
+  }
+  return Best ? Best->LineNumber : 0;
 }
 
 std::unique_ptr<SpecialCaseList>
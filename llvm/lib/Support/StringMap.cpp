@@ -74,13 +74,16 @@ void StringMapImpl::init(unsigned InitSize) {
 /// specified bucket will be non-null.  Otherwise, it will be null.  In either
 /// case, the FullHashValue field of the bucket will be set to the hash value
 /// of the string.
-unsigned StringMapImpl::LookupBucketFor(StringRef Name) {
+unsigned StringMapImpl::LookupBucketFor(StringRef Name,
+                                        uint32_t FullHashValue) {
+#ifdef EXPENSIVE_CHECKS
+  assert(FullHashValue == hash(Name) && "Wrong precomputed hash");
+#endif
   unsigned HTSize = NumBuckets;
   if (HTSize == 0) {  // Hash table unallocated so far?
     init(16);
     HTSize = NumBuckets;
   }
-  unsigned FullHashValue = djbHash(Name, 0);
   unsigned BucketNo = FullHashValue & (HTSize-1);
   unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
@@ -131,10 +134,12 @@ unsigned StringMapImpl::LookupBucketFor(StringRef Name) {
 /// FindKey - Look up the bucket that contains the specified key. If it exists
 /// in the map, return the bucket number of the key.  Otherwise return -1.
 /// This does not modify the map.
-int StringMapImpl::FindKey(StringRef Key) const {
+int StringMapImpl::FindKey(StringRef Key, uint32_t FullHashValue) const {
+#ifdef EXPENSIVE_CHECKS
+  assert(FullHashValue == hash(Key) && "Wrong precomputed hash");
+#endif
   unsigned HTSize = NumBuckets;
   if (HTSize == 0) return -1;  // Really empty table?
-  unsigned FullHashValue = djbHash(Key, 0);
   unsigned BucketNo = FullHashValue & (HTSize-1);
   unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
@@ -171,6 +176,30 @@ int StringMapImpl::FindKey(StringRef Key) const {
   }
 }
 
+/// FindKeys - Look up the buckets of several keys at once. The first bucket
+/// that each key probes, both its entry pointer and its hash value, is
+/// prefetched before any key is compared.
+void StringMapImpl::FindKeys(const StringRef *Keys, const uint32_t *Hashes,
+                             int *Buckets, size_t NumKeys) const {
+  unsigned HTSize = NumBuckets;
+  if (HTSize == 0) {
+    std::fill(Buckets, Buckets + NumKeys, -1);
+    return;
+  }
+
+#if defined(__GNUC__)
+  unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
+  for (size_t I = 0; I != NumKeys; ++I) {
+    unsigned BucketNo = Hashes[I] & (HTSize-1);
+    __builtin_prefetch(&TheTable[BucketNo]);
+    __builtin_prefetch(&HashTable[BucketNo]);
+  }
+#endif
+
+  for (size_t I = 0; I != NumKeys; ++I)
+    Buckets[I] = FindKey(Keys[I], Hashes[I]);
+}
+
 /// RemoveKey - Remove the specified StringMapEntry from the table, but do not
 /// delete it.  This aborts if the value isn't in the table.
 void StringMapImpl::RemoveKey(StringMapEntryBase *V) {
@@ -13,6 +13,7 @@
 #include "llvm/Support/ThreadPool.h"
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -20,18 +21,23 @@ using namespace llvm;
 
 #if LLVM_ENABLE_THREADS
 
+/// The pool the current thread belongs to, if any.
+static LLVM_THREAD_LOCAL const ThreadPool *CurrentThreadPool = nullptr;
+
 // Default to hardware_concurrency
 ThreadPool::ThreadPool() : ThreadPool(hardware_concurrency()) {}
 
-ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0), EnableFlag(true) {
+ThreadPool::ThreadPool(unsigned ThreadCount, size_t MaxQueuedTasks)
+    : MaxQueuedTasks(MaxQueuedTasks), ActiveThreads(0), EnableFlag(true) {
   // Create ThreadCount threads that will loop forever, wait on QueueCondition
   // for tasks to be queued or the Pool to be destroyed.
   Threads.reserve(ThreadCount);
   for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
     Threads.emplace_back([&] {
+      CurrentThreadPool = this;
       while (true) {
         PackagedTaskTy Task;
+        ThreadPoolTaskGroup *Group;
         {
           std::unique_lock<std::mutex> LockGuard(QueueLock);
           // Wait for tasks to be pushed in the queue
@@ -49,9 +55,14 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
             std::unique_lock<std::mutex> LockGuard(CompletionLock);
             ++ActiveThreads;
           }
-          Task = std::move(Tasks.front());
+          Task = std::move(Tasks.front().first);
+          Group = Tasks.front().second;
           Tasks.pop();
         }
+        // Let a submitter blocked on a full queue proceed.
+        if (MaxQueuedTasks)
+          QueueNotFullCondition.notify_one();
+
         // Run the task we just grabbed
         Task();
 
@@ -59,6 +70,11 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
           // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
           std::unique_lock<std::mutex> LockGuard(CompletionLock);
           --ActiveThreads;
+          if (Group) {
+            auto It = ActiveGroups.find(Group);
+            if (--It->second == 0)
+              ActiveGroups.erase(It);
+          }
         }
 
         // Notify task completion, in case someone waits on ThreadPool::wait()
@@ -68,6 +84,8 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
   }
 }
 
+bool ThreadPool::isWorkerThread() const { return CurrentThreadPool == this; }
+
 void ThreadPool::wait() {
   // Wait for all threads to complete and the queue to be empty
   std::unique_lock<std::mutex> LockGuard(CompletionLock);
@@ -78,10 +96,17 @@ void ThreadPool::wait() {
                            [&] { return !ActiveThreads && Tasks.empty(); });
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
-  /// Wrap the Task in a packaged_task to return a future object.
-  PackagedTaskTy PackagedTask(std::move(Task));
-  auto Future = PackagedTask.get_future();
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  // The tasks of the group might be queued behind the calling task, so
+  // waiting for them from a worker could deadlock.
+  assert(!isWorkerThread() && "Waiting for a task group from a pool thread");
+  std::unique_lock<std::mutex> LockGuard(CompletionLock);
+  CompletionCondition.wait(LockGuard,
+                           [&] { return !ActiveGroups.count(&Group); });
+}
+
+bool ThreadPool::enqueue(PackagedTaskTy &Task, ThreadPoolTaskGroup *Group,
+                         bool Block) {
   {
     // Lock the queue and push the new task
     std::unique_lock<std::mutex> LockGuard(QueueLock);
@@ -89,9 +114,38 @@ std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
     // Don't allow enqueueing after disabling the pool
     assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
 
-    Tasks.push(std::move(PackagedTask));
+    if (MaxQueuedTasks && !isWorkerThread()) {
+      auto HasRoom = [&] { return Tasks.size() < MaxQueuedTasks; };
+      if (!Block && !HasRoom())
+        return false;
+      QueueNotFullCondition.wait(LockGuard, HasRoom);
+    }
+
+    if (Group) {
+      std::unique_lock<std::mutex> LockGuard(CompletionLock);
+      ++ActiveGroups[Group];
+    }
+    Tasks.push(std::make_pair(std::move(Task), Group));
   }
   QueueCondition.notify_one();
+  return true;
+}
+
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task,
+                                               ThreadPoolTaskGroup *Group) {
+  /// Wrap the Task in a packaged_task to return a future object.
+  PackagedTaskTy PackagedTask(std::move(Task));
+  auto Future = PackagedTask.get_future();
+  enqueue(PackagedTask, Group, /*Block=*/true);
+  return Future.share();
+}
+
+Optional<std::shared_future<void>>
+ThreadPool::tryAsyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
+  PackagedTaskTy PackagedTask(std::move(Task));
+  auto Future = PackagedTask.get_future();
+  if (!enqueue(PackagedTask, Group, /*Block=*/false))
+    return None;
   return Future.share();
 }
 
@@ -111,33 +165,52 @@ ThreadPool::~ThreadPool() {
 ThreadPool::ThreadPool() : ThreadPool(0) {}
 
 // No threads are launched, issue a warning if ThreadCount is not 0
-ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0) {
+ThreadPool::ThreadPool(unsigned ThreadCount, size_t MaxQueuedTasks)
+    : MaxQueuedTasks(MaxQueuedTasks), ActiveThreads(0) {
   if (ThreadCount) {
     errs() << "Warning: request a ThreadPool with " << ThreadCount
            << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
   }
 }
 
+bool ThreadPool::isWorkerThread() const { return false; }
+
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
   while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
+    auto Task = std::move(Tasks.front().first);
     Tasks.pop();
     Task();
   }
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
+// Tasks of all groups are run in submission order, which in particular
+// completes the tasks of Group.
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) { wait(); }
+
+bool ThreadPool::enqueue(PackagedTaskTy &Task, ThreadPoolTaskGroup *Group,
+                         bool Block) {
+  // The queue is never full, as tasks are only run by wait().
+  Tasks.push(std::make_pair(std::move(Task), Group));
+  return true;
+}
+
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task,
+                                               ThreadPoolTaskGroup *Group) {
   // Get a Future with launch::deferred execution using std::async
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
   // Wrap the future so that both ThreadPool::wait() can operate and the
   // returned future can be sync'ed on.
   PackagedTaskTy PackagedTask([Future]() { Future.get(); });
-  Tasks.push(std::move(PackagedTask));
+  enqueue(PackagedTask, Group, /*Block=*/true);
   return Future;
 }
 
+Optional<std::shared_future<void>>
+ThreadPool::tryAsyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
+  return asyncImpl(std::move(Task), Group);
+}
+
 ThreadPool::~ThreadPool() {
   wait();
 }
@@ -11,12 +11,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/TimeProfiler.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Threading.h"
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -24,7 +29,13 @@ using namespace std::chrono;
 
 namespace llvm {
 
-TimeTraceProfiler *TimeTraceProfilerInstance = nullptr;
+// Each thread records into its own profiler, so that begin() and end() never
+// take a lock. Profilers of finished worker threads are handed over to the
+// list below and written out together with the one of the main thread.
+LLVM_THREAD_LOCAL TimeTraceProfiler *TimeTraceProfilerInstance = nullptr;
+
+static ManagedStatic<std::vector<TimeTraceProfiler *>> FinishedInstances;
+static ManagedStatic<std::mutex> FinishedInstancesMutex;
 
 typedef duration<steady_clock::rep, steady_clock::period> DurationType;
 typedef std::pair<size_t, DurationType> CountAndDurationType;
@@ -43,9 +54,16 @@ struct Entry {
         Detail(std::move(Dt)){};
 };
 
+struct CounterEntry {
+  time_point<steady_clock> Time;
+  std::string Name;
+  int64_t Value;
+};
+
 struct TimeTraceProfiler {
-  TimeTraceProfiler() {
-    StartTime = steady_clock::now();
+  TimeTraceProfiler(unsigned TimeTraceGranularity, StringRef ProcName)
+      : StartTime(steady_clock::now()), ProcName(ProcName),
+        Tid(llvm::get_threadid()), TimeTraceGranularity(TimeTraceGranularity) {
   }
 
   void begin(std::string Name, llvm::function_ref<std::string()> Detail) {
@@ -78,36 +96,75 @@ struct TimeTraceProfiler {
     Stack.pop_back();
   }
 
+  void counter(StringRef Name, int64_t Value) {
+    Counters.push_back({steady_clock::now(), Name, Value});
+  }
+
+  // Write the events of this profiler and of all finished worker threads.
   void Write(raw_pwrite_stream &OS) {
     assert(Stack.empty() &&
            "All profiler sections should be ended when calling Write");
+    std::lock_guard<std::mutex> Lock(*FinishedInstancesMutex);
+    std::vector<const TimeTraceProfiler *> Instances = {this};
+    Instances.insert(Instances.end(), FinishedInstances->begin(),
+                     FinishedInstances->end());
+
     json::OStream J(OS);
     J.objectBegin();
     J.attributeBegin("traceEvents");
     J.arrayBegin();
 
-    // Emit all events for the main flame graph.
-    for (const auto &E : Entries) {
-      auto StartUs = duration_cast<microseconds>(E.Start - StartTime).count();
-      auto DurUs = duration_cast<microseconds>(E.Duration).count();
+    // Emit all events for the main flame graph, one track per thread. All
+    // times are relative to the start of this profiler.
+    for (const TimeTraceProfiler *TTP : Instances) {
+      for (const auto &E : TTP->Entries) {
+        auto StartUs =
+            duration_cast<microseconds>(E.Start - StartTime).count();
+        auto DurUs = duration_cast<microseconds>(E.Duration).count();
 
-      J.object([&]{
-        J.attribute("pid", 1);
-        J.attribute("tid", 0);
-        J.attribute("ph", "X");
-        J.attribute("ts", StartUs);
-        J.attribute("dur", DurUs);
-        J.attribute("name", E.Name);
-        J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
-      });
+        J.object([&] {
+          J.attribute("pid", 1);
+          J.attribute("tid", int64_t(TTP->Tid));
+          J.attribute("ph", "X");
+          J.attribute("ts", StartUs);
+          J.attribute("dur", DurUs);
+          J.attribute("name", E.Name);
+          J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
+        });
+      }
+
+      for (const auto &C : TTP->Counters) {
+        auto TimeUs = duration_cast<microseconds>(C.Time - StartTime).count();
+
+        J.object([&] {
+          J.attribute("pid", 1);
+          J.attribute("tid", int64_t(TTP->Tid));
+          J.attribute("ph", "C");
+          J.attribute("ts", TimeUs);
+          J.attribute("name", C.Name);
+          J.attributeObject("args", [&] { J.attribute(C.Name, C.Value); });
+        });
+      }
     }
 
     // Emit totals by section name as additional "thread" events, sorted from
-    // longest one.
-    int Tid = 1;
+    // longest one. They use thread ids past the ones of the real threads, and
+    // add up the time of all threads.
+    uint64_t MaxTid = 0;
+    StringMap<CountAndDurationType> AllCountAndTotalPerName;
+    for (const TimeTraceProfiler *TTP : Instances) {
+      MaxTid = std::max(MaxTid, TTP->Tid);
+      for (const auto &E : TTP->CountAndTotalPerName) {
+        auto &CountAndTotal = AllCountAndTotalPerName[E.getKey()];
+        CountAndTotal.first += E.getValue().first;
+        CountAndTotal.second += E.getValue().second;
+      }
+    }
+
+    uint64_t Tid = MaxTid + 1;
     std::vector<NameAndCountAndDurationType> SortedTotals;
-    SortedTotals.reserve(CountAndTotalPerName.size());
-    for (const auto &E : CountAndTotalPerName)
+    SortedTotals.reserve(AllCountAndTotalPerName.size());
+    for (const auto &E : AllCountAndTotalPerName)
       SortedTotals.emplace_back(E.getKey(), E.getValue());
 
     llvm::sort(SortedTotals.begin(), SortedTotals.end(),
@@ -117,11 +174,11 @@ struct TimeTraceProfiler {
                });
     for (const auto &E : SortedTotals) {
       auto DurUs = duration_cast<microseconds>(E.second.second).count();
-      auto Count = CountAndTotalPerName[E.first].first;
+      auto Count = E.second.first;
 
       J.object([&]{
         J.attribute("pid", 1);
-        J.attribute("tid", Tid);
+        J.attribute("tid", int64_t(Tid));
         J.attribute("ph", "X");
         J.attribute("ts", 0);
         J.attribute("dur", DurUs);
@@ -143,9 +200,28 @@ struct TimeTraceProfiler {
       J.attribute("ts", 0);
       J.attribute("ph", "M");
       J.attribute("name", "process_name");
-      J.attributeObject("args", [&] { J.attribute("name", "clang"); });
+      J.attributeObject("args", [&] { J.attribute("name", ProcName); });
     });
 
+    // Emit metadata events naming the thread tracks. Pooled threads may have
+    // finished several profilers, so name each thread once.
+    DenseSet<uint64_t> NamedTids;
+    for (const TimeTraceProfiler *TTP : Instances) {
+      if (!NamedTids.insert(TTP->Tid).second)
+        continue;
+      J.object([&] {
+        J.attribute("cat", "");
+        J.attribute("pid", 1);
+        J.attribute("tid", int64_t(TTP->Tid));
+        J.attribute("ts", 0);
+        J.attribute("ph", "M");
+        J.attribute("name", "thread_name");
+        std::string Name =
+            TTP == this ? "main" : "thread " + std::to_string(TTP->Tid);
+        J.attributeObject("args", [&] { J.attribute("name", Name); });
+      });
+    }
+
     J.arrayEnd();
     J.attributeEnd();
     J.objectEnd();
@@ -153,23 +229,39 @@ struct TimeTraceProfiler {
 
   SmallVector<Entry, 16> Stack;
   SmallVector<Entry, 128> Entries;
+  SmallVector<CounterEntry, 16> Counters;
   StringMap<CountAndDurationType> CountAndTotalPerName;
-  time_point<steady_clock> StartTime;
+  const time_point<steady_clock> StartTime;
+  const std::string ProcName;
+  const uint64_t Tid;
 
   // Minimum time granularity (in microseconds)
-  unsigned TimeTraceGranularity;
+  const unsigned TimeTraceGranularity;
 };
 
-void timeTraceProfilerInitialize(unsigned TimeTraceGranularity) {
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                 StringRef ProcName) {
   assert(TimeTraceProfilerInstance == nullptr &&
          "Profiler should not be initialized");
-  TimeTraceProfilerInstance = new TimeTraceProfiler();
-  TimeTraceProfilerInstance->TimeTraceGranularity = TimeTraceGranularity;
+  TimeTraceProfilerInstance =
+      new TimeTraceProfiler(TimeTraceGranularity, ProcName);
 }
 
 void timeTraceProfilerCleanup() {
   delete TimeTraceProfilerInstance;
   TimeTraceProfilerInstance = nullptr;
+  std::lock_guard<std::mutex> Lock(*FinishedInstancesMutex);
+  for (TimeTraceProfiler *TTP : *FinishedInstances)
+    delete TTP;
+  FinishedInstances->clear();
+}
+
+void timeTraceProfilerFinishThread() {
+  if (TimeTraceProfilerInstance == nullptr)
+    return;
+  std::lock_guard<std::mutex> Lock(*FinishedInstancesMutex);
+  FinishedInstances->push_back(TimeTraceProfilerInstance);
+  TimeTraceProfilerInstance = nullptr;
 }
 
 void timeTraceProfilerWrite(raw_pwrite_stream &OS) {
@@ -194,4 +286,9 @@ void timeTraceProfilerEnd() {
     TimeTraceProfilerInstance->end();
 }
 
+void timeTraceProfilerCounter(StringRef Name, int64_t Value) {
+  if (TimeTraceProfilerInstance != nullptr)
+    TimeTraceProfilerInstance->counter(Name, Value);
+}
+
 } // namespace llvm
@@ -555,6 +555,10 @@ private:
   /// Potential simple keys.
   SmallVector<SimpleKey, 4> SimpleKeys;
 
+  /// True if peekNext() already made sure that the token at the front of
+  /// TokenQueue isn't a potential simple key. Only getNext() changes that.
+  bool IsFrontChecked;
+
   std::error_code *EC;
 };
 
@@ -775,6 +779,7 @@ void Scanner::init(MemoryBufferRef Buffer) {
   FlowLevel = 0;
   IsStartOfStream = true;
   IsSimpleKeyAllowed = true;
+  IsFrontChecked = false;
   Failed = false;
   std::unique_ptr<MemoryBuffer> InputBufferOwner =
       MemoryBuffer::getMemBuffer(Buffer);
@@ -782,6 +787,10 @@ void Scanner::init(MemoryBufferRef Buffer) {
 }
 
 Token &Scanner::peekNext() {
+  // The parser peeks at each token several times before consuming it.
+  if (IsFrontChecked)
+    return TokenQueue.front();
+
   // If the current token is a possible simple key, keep parsing until we
   // can confirm.
   bool NeedMore = false;
@@ -804,6 +813,7 @@ Token &Scanner::peekNext() {
     else
       NeedMore = true;
   }
+  IsFrontChecked = true;
   return TokenQueue.front();
 }
 
@@ -812,6 +822,7 @@ Token Scanner::getNext() {
   // TokenQueue can be empty if there was an error getting the next token.
   if (!TokenQueue.empty())
     TokenQueue.pop_front();
+  IsFrontChecked = false;
 
   // There cannot be any referenced Token's if the TokenQueue is empty. So do a
   // quick deallocation of them all.
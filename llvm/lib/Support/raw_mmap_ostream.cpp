@@ -0,0 +1,143 @@
+//===- raw_mmap_ostream.cpp - raw_ostream writing to a mapped file --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_mmap_ostream.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::sys;
+
+// The file grows in multiples of this size.
+static const uint64_t Granularity = 1024 * 1024;
+
+Expected<std::unique_ptr<raw_mmap_ostream>>
+raw_mmap_ostream::create(StringRef Path, uint64_t SizeHint, unsigned Flags) {
+  fs::file_status Stat;
+  fs::status(Path, Stat);
+  switch (Stat.type()) {
+  case fs::file_type::directory_file:
+    return errorCodeToError(errc::is_a_directory);
+  case fs::file_type::regular_file:
+  case fs::file_type::file_not_found:
+  case fs::file_type::status_error:
+    break;
+  default:
+    return errorCodeToError(errc::not_supported);
+  }
+
+  unsigned Mode = fs::all_read | fs::all_write;
+  if (Flags & F_executable)
+    Mode |= fs::all_exe;
+
+  Expected<fs::TempFile> FileOrErr =
+      fs::TempFile::create(Path + ".tmp%%%%%%%", Mode);
+  if (!FileOrErr)
+    return FileOrErr.takeError();
+
+  std::unique_ptr<raw_mmap_ostream> OS(
+      new raw_mmap_ostream(Path, std::move(*FileOrErr)));
+  if (!OS->reserve(std::max<uint64_t>(SizeHint, 1)))
+    return errorCodeToError(OS->EC);
+  OS->resetBuffer();
+  return std::move(OS);
+}
+
+raw_mmap_ostream::raw_mmap_ostream(StringRef Path, fs::TempFile Temp)
+    : FinalPath(Path), Temp(std::move(Temp)) {}
+
+raw_mmap_ostream::~raw_mmap_ostream() {
+  // Close the mapping before deleting the temp file, so that the removal
+  // succeeds.
+  SetUnbuffered();
+  Region.reset();
+  consumeError(Temp.discard());
+}
+
+bool raw_mmap_ostream::reserve(uint64_t Size) {
+  if (EC)
+    return false;
+  if (Size <= Capacity)
+    return true;
+
+  // Grow geometrically so that the cost of remapping is amortized.
+  uint64_t NewCapacity = std::max(Capacity * 2, alignTo(Size, Granularity));
+  Region.reset();
+  EC = fs::resize_file(Temp.FD, NewCapacity);
+  if (!EC)
+    Region = std::make_unique<fs::mapped_file_region>(
+        fs::convertFDToNativeFile(Temp.FD), fs::mapped_file_region::readwrite,
+        NewCapacity, 0, EC);
+  if (EC) {
+    Region.reset();
+    Capacity = 0;
+    return false;
+  }
+  Capacity = NewCapacity;
+  return true;
+}
+
+void raw_mmap_ostream::resetBuffer() {
+  // The buffer must never be empty, so grow the file if it is full.
+  if (reserve(Pos + 1))
+    SetBuffer(Region->data() + Pos, Capacity - Pos);
+  else
+    SetUnbuffered();
+}
+
+void raw_mmap_ostream::write_impl(const char *Ptr, size_t Size) {
+  assert((Region || EC) && "Write after commit");
+  // Bytes written through the buffer are already in place; anything else is
+  // copied in.
+  if (!Region || Ptr != Region->data() + Pos) {
+    if (!reserve(Pos + Size)) {
+      // Drop the data, but keep the position so that tell() stays right.
+      Pos += Size;
+      SetUnbuffered();
+      return;
+    }
+    memcpy(Region->data() + Pos, Ptr, Size);
+  }
+  Pos += Size;
+  resetBuffer();
+}
+
+void raw_mmap_ostream::pwrite_impl(const char *Ptr, size_t Size,
+                                   uint64_t Offset) {
+  if (!Region)
+    return;
+  assert(Offset + Size <= Capacity && "pwrite past the end of the stream");
+  memcpy(Region->data() + Offset, Ptr, Size);
+}
+
+MutableArrayRef<char> raw_mmap_ostream::getWrittenData() {
+  flush();
+  if (!Region)
+    return {};
+  return MutableArrayRef<char>(Region->data(), Pos);
+}
+
+Error raw_mmap_ostream::commit() {
+  flush();
+  SetUnbuffered();
+  // Unmap the file, letting the OS flush dirty pages to disk, and cut off the
+  // unused capacity.
+  Region.reset();
+  Capacity = 0;
+  if (!EC)
+    EC = fs::resize_file(Temp.FD, Pos);
+  if (EC) {
+    consumeError(Temp.discard());
+    return errorCodeToError(EC);
+  }
+
+  // Atomically replace the existing file with the new one.
+  return Temp.keep(FinalPath);
+}
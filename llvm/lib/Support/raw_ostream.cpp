@@ -41,6 +41,10 @@
 # include <unistd.h>
 #endif
 
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
+
 #if defined(__CYGWIN__)
 #include <io.h>
 #endif
@@ -270,6 +274,16 @@ raw_ostream &raw_ostream::write(const char *Ptr, size_t Size) {
       return *this;
     }
 
+    // If the string is at least as large as the whole buffer, write it
+    // together with the buffered bytes rather than copying it through the
+    // buffer.
+    if (Size >= size_t(OutBufEnd - OutBufStart)) {
+      size_t Length = OutBufCur - OutBufStart;
+      OutBufCur = OutBufStart;
+      writev_impl(OutBufStart, Length, Ptr, Size);
+      return *this;
+    }
+
     // We don't have enough space in the buffer to fit the string in. Insert as
     // much as possible, flush and start over with the remainder.
     copy_to_buffer(Ptr, NumBytes);
@@ -684,6 +698,19 @@ static bool write_console_impl(int FD, StringRef Data) {
 }
 #endif
 
+static size_t getMaxWriteSize() {
+#if defined(__linux__)
+  // It is observed that Linux returns EINVAL for a very large write (>2G).
+  // Make it a reasonably small value.
+  return 1024 * 1024 * 1024;
+#else
+  // The maximum write size is limited to INT32_MAX. A write
+  // greater than SSIZE_MAX is implementation-defined in POSIX,
+  // and Windows _write requires 32 bit input.
+  return INT32_MAX;
+#endif
+}
+
 void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
   assert(FD >= 0 && "File already closed.");
   pos += Size;
@@ -696,16 +723,7 @@ void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
       return;
 #endif
 
-  // The maximum write size is limited to INT32_MAX. A write
-  // greater than SSIZE_MAX is implementation-defined in POSIX,
-  // and Windows _write requires 32 bit input.
-  size_t MaxWriteSize = INT32_MAX;
-
-#if defined(__linux__)
-  // It is observed that Linux returns EINVAL for a very large write (>2G).
-  // Make it a reasonably small value.
-  MaxWriteSize = 1024 * 1024 * 1024;
-#endif
+  size_t MaxWriteSize = getMaxWriteSize();
 
   do {
     size_t ChunkSize = std::min(Size, MaxWriteSize);
@@ -740,6 +758,60 @@ void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
   } while (Size > 0);
 }
 
+void raw_fd_ostream::writev_impl(const char *Ptr1, size_t Size1,
+                                 const char *Ptr2, size_t Size2) {
+#if defined(_WIN32)
+  write_impl(Ptr1, Size1);
+  write_impl(Ptr2, Size2);
+#else
+  assert(FD >= 0 && "File already closed.");
+  if (Size1 + Size2 > getMaxWriteSize()) {
+    write_impl(Ptr1, Size1);
+    write_impl(Ptr2, Size2);
+    return;
+  }
+  pos += Size1 + Size2;
+
+  struct iovec IOV[2];
+  IOV[0].iov_base = const_cast<char *>(Ptr1);
+  IOV[0].iov_len = Size1;
+  IOV[1].iov_base = const_cast<char *>(Ptr2);
+  IOV[1].iov_len = Size2;
+  struct iovec *Vec = IOV;
+  int NumVecs = 2;
+
+  do {
+    ssize_t ret = ::writev(FD, Vec, NumVecs);
+
+    if (ret < 0) {
+      // Retry recoverable errors, as write_impl does.
+      if (errno == EINTR || errno == EAGAIN
+#ifdef EWOULDBLOCK
+          || errno == EWOULDBLOCK
+#endif
+          )
+        continue;
+
+      error_detected(std::error_code(errno, std::generic_category()));
+      break;
+    }
+
+    // Skip over what has been written, which may end in the middle of either
+    // buffer.
+    size_t Written = ret;
+    while (NumVecs > 0 && Written >= Vec->iov_len) {
+      Written -= Vec->iov_len;
+      ++Vec;
+      --NumVecs;
+    }
+    if (NumVecs > 0) {
+      Vec->iov_base = static_cast<char *>(Vec->iov_base) + Written;
+      Vec->iov_len -= Written;
+    }
+  } while (NumVecs > 0);
+#endif
+}
+
 void raw_fd_ostream::close() {
   assert(ShouldClose);
   ShouldClose = false;
@@ -77,7 +77,34 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+/// Write \p Contents to \p Filename, unless the file already holds exactly
+/// that.
+static int writeOutputFile(const char *argv0, StringRef Filename,
+                           StringRef Contents) {
+  // Only updates the real output file if there are any differences.
+  // This prevents recompilation of all the files depending on it if there
+  // aren't any.
+  if (auto ExistingOrErr = MemoryBuffer::getFile(Filename))
+    if (std::move(ExistingOrErr.get())->getBuffer() == Contents)
+      return 0;
+
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::OF_Text);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ":" +
+                                  EC.message() + "\n");
+  OutFile.os() << Contents;
+
+  if (ErrorsPrinted > 0)
+    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+
+  // Declare success.
+  OutFile.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                       ArrayRef<TableGenExtraOutput> ExtraOutputs) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -114,24 +141,19 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
       return Ret;
   }
 
-  // Only updates the real output file if there are any differences.
-  // This prevents recompilation of all the files depending on it if there
-  // aren't any.
-  if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
-    if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-      return 0;
-
-  std::error_code EC;
-  ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_Text);
-  if (EC)
-    return reportError(argv0, "error opening " + OutputFilename + ":" +
-                                  EC.message() + "\n");
-  OutFile.os() << Out.str();
-
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
-
-  // Declare success.
-  OutFile.keep();
+  if (int Ret = writeOutputFile(argv0, OutputFilename, Out.str()))
+    return Ret;
+
+  // The extra outputs reuse the parsed records, which is what saves running
+  // one tablegen process per output. They depend on the same input files, so
+  // the depfile of the -o output covers them too.
+  for (const TableGenExtraOutput &Extra : ExtraOutputs) {
+    std::string ExtraString;
+    raw_string_ostream ExtraOut(ExtraString);
+    if (Extra.MainFn(ExtraOut, Records))
+      return 1;
+    if (int Ret = writeOutputFile(argv0, Extra.Filename, ExtraOut.str()))
+      return Ret;
+  }
   return 0;
 }
@@ -136,6 +136,8 @@ private:
   bool X86SelectUIToFP(const Instruction *I);
   bool X86SelectIntToFP(const Instruction *I, bool IsSigned);
 
+  bool X86SelectExtractElement(const Instruction *I);
+
   const X86InstrInfo *getInstrInfo() const {
     return Subtarget->getInstrInfo();
   }
@@ -2462,6 +2464,60 @@ bool X86FastISel::X86SelectUIToFP(const Instruction *I) {
   return X86SelectIntToFP(I, /*IsSigned*/false);
 }
 
+// Select extracts of the lowest element of a 128-bit vector, which either is
+// a plain copy into a scalar FP register or a single movd/movq.
+bool X86FastISel::X86SelectExtractElement(const Instruction *I) {
+  if (!Subtarget->hasSSE2())
+    return false;
+
+  auto *Idx = dyn_cast<ConstantInt>(I->getOperand(1));
+  if (!Idx || !Idx->isZero())
+    return false;
+
+  MVT SrcVT, VT;
+  if (!isTypeLegal(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeLegal(I->getType(), VT) || !SrcVT.is128BitVector())
+    return false;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (SrcReg == 0)
+    return false;
+  bool SrcIsKill = hasTrivialKill(I->getOperand(0));
+
+  const TargetRegisterClass *RC = TLI.getRegClassFor(VT);
+  if (VT == MVT::f32 || VT == MVT::f64) {
+    unsigned ResultReg = createResultReg(RC);
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ResultReg)
+        .addReg(SrcReg, getKillRegState(SrcIsKill));
+    updateValueMap(I, ResultReg);
+    return true;
+  }
+
+  static const uint16_t MovOpc[3][2] = {
+    { X86::MOVPDI2DIrr,   X86::MOVPQIto64rr },
+    { X86::VMOVPDI2DIrr,  X86::VMOVPQIto64rr },
+    { X86::VMOVPDI2DIZrr, X86::VMOVPQIto64Zrr },
+  };
+  unsigned AVXLevel = Subtarget->hasAVX512() ? 2 :
+                      Subtarget->hasAVX()    ? 1 :
+                                               0;
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default: return false;
+  case MVT::i32: Opc = MovOpc[AVXLevel][0]; break;
+  case MVT::i64:
+    if (!Subtarget->is64Bit())
+      return false;
+    Opc = MovOpc[AVXLevel][1];
+    break;
+  }
+
+  unsigned ResultReg = fastEmitInst_r(Opc, RC, SrcReg, SrcIsKill);
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
 // Helper method used by X86SelectFPExt and X86SelectFPTrunc.
 bool X86FastISel::X86SelectFPExtOrFPTrunc(const Instruction *I,
                                           unsigned TargetOpc,
@@ -2798,6 +2854,26 @@ bool X86FastISel::fastLowerIntrinsicCall(const IntrinsicInst *II) {
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(X86::TRAP));
     return true;
   }
+  case Intrinsic::bswap:
+  case Intrinsic::ctpop: {
+    MVT VT;
+    if (!isTypeLegal(II->getType(), VT) || !VT.isInteger() || VT.isVector())
+      return false;
+
+    const Value *Op = II->getArgOperand(0);
+    unsigned OpReg = getRegForValue(Op);
+    if (OpReg == 0)
+      return false;
+
+    unsigned ISDOpc = II->getIntrinsicID() == Intrinsic::bswap ? ISD::BSWAP
+                                                               : ISD::CTPOP;
+    unsigned ResultReg = fastEmit_r(VT, VT, ISDOpc, OpReg, hasTrivialKill(Op));
+    if (ResultReg == 0)
+      return false;
+
+    updateValueMap(II, ResultReg);
+    return true;
+  }
   case Intrinsic::sqrt: {
     if (!Subtarget->hasSSE1())
       return false;
@@ -3632,6 +3708,8 @@ X86FastISel::fastSelectInstruction(const Instruction *I)  {
     return X86SelectSIToFP(I);
   case Instruction::UIToFP:
     return X86SelectUIToFP(I);
+  case Instruction::ExtractElement:
+    return X86SelectExtractElement(I);
   case Instruction::IntToPtr: // Deliberate fall-through.
   case Instruction::PtrToInt: {
     EVT SrcVT = TLI.getValueType(DL, I->getOperand(0)->getType());
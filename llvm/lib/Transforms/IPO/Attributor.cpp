@@ -21,6 +21,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/EHPersonalities.h"
 #include "llvm/Analysis/GlobalsModRef.h"
@@ -49,6 +50,8 @@ STATISTIC(NumFnWithoutExactDefinition,
           "Number of function without exact definitions");
 STATISTIC(NumAttributesTimedOut,
           "Number of abstract attributes timed out before fixpoint");
+STATISTIC(NumFixpointUpdates,
+          "Number of abstract attribute updates during the fixpoint iteration");
 STATISTIC(NumAttributesValidFixpoint,
           "Number of abstract attributes in a valid fixpoint state");
 STATISTIC(NumAttributesManifested,
@@ -107,10 +110,16 @@ static cl::opt<unsigned>
                           cl::desc("Maximal number of fixpoint iterations."),
                           cl::init(32));
 
+static cl::opt<unsigned> MaxUpdatesPerAttribute(
+    "attributor-max-updates-per-aa", cl::Hidden,
+    cl::desc("Maximal average number of updates per abstract attribute before "
+             "the fixpoint iteration is stopped (0 = unlimited)."),
+    cl::init(8));
+
 static cl::opt<bool> DisableAttributor(
     "attributor-disable", cl::Hidden,
     cl::desc("Disable the attributor inter-procedural deduction pass."),
-    cl::init(true));
+    cl::init(false));
 
 static cl::opt<bool> VerifyAttributor(
     "attributor-verify", cl::Hidden,
@@ -1321,6 +1330,116 @@ ChangeStatus AANoAliasReturned::updateImpl(Attributor &A) {
   return ChangeStatus::UNCHANGED;
 }
 
+/// Return true if \p V is passed as argument \p ArgNo of \p ICS and the callee
+/// can only reach the underlying object through that argument. This is the
+/// case if \p V is a fresh allocation or a noalias argument of the caller, it
+/// is not captured by the caller or the callee, and it is not passed twice. If
+/// \p V is an argument, it is only noalias at the call site if it is noalias in
+/// the caller as well.
+static bool isUniqueCallSiteArgument(const Value &V, ImmutableCallSite ICS,
+                                     unsigned ArgNo) {
+  if (!isa<AllocaInst>(V) && !isa<Argument>(V) && !isNoAliasCall(&V))
+    return false;
+
+  // A callee that captures the pointer could access the object through the
+  // captured copy in a later execution of the same call.
+  if (!ICS.doesNotCapture(ArgNo))
+    return false;
+
+  for (const Use &U : V.uses()) {
+    const User *Usr = U.getUser();
+    if (Usr == ICS.getInstruction()) {
+      if (!ICS.isArgOperand(&U) || ICS.getArgumentNo(&U) != ArgNo)
+        return false;
+      continue;
+    }
+    // Accesses through the pointer itself do not create another pointer to
+    // the object.
+    if (isa<LoadInst>(Usr))
+      continue;
+    if (isa<StoreInst>(Usr) && U.getOperandNo() == 1)
+      continue;
+    if (auto *II = dyn_cast<IntrinsicInst>(Usr))
+      if (II->getIntrinsicID() == Intrinsic::lifetime_start ||
+          II->getIntrinsicID() == Intrinsic::lifetime_end)
+        continue;
+    return false;
+  }
+  return true;
+}
+
+/// NoAlias attribute for function argument.
+struct AANoAliasArgument final : AANoAliasImpl {
+  AANoAliasArgument(const IRPosition &IRP) : AANoAliasImpl(IRP) {}
+
+  /// See AbstractAttribute::initialize(...).
+  void initialize(Attributor &A) override {
+    if (hasAttr({Attribute::NoAlias}))
+      indicateOptimisticFixpoint();
+  }
+
+  /// See AbstractAttribute::updateImpl(...).
+  ChangeStatus updateImpl(Attributor &A) override;
+
+  /// See AbstractAttribute::trackStatistics()
+  void trackStatistics() const override { STATS_DECLTRACK_ARG_ATTR(noalias) }
+};
+
+ChangeStatus AANoAliasArgument::updateImpl(Attributor &A) {
+  unsigned ArgNo = getArgNo();
+
+  std::function<bool(CallSite)> CallSiteCheck = [&](CallSite CS) {
+    IRPosition CSArgPos = IRPosition::callsite_argument(CS, ArgNo);
+    if (CSArgPos.hasAttr({Attribute::NoAlias}))
+      return true;
+
+    // Make sure we got the call site argument and not this attribute through
+    // the subsuming positions.
+    if (auto *NoAliasAA = A.getAAFor<AANoAliasImpl>(*this, CSArgPos)) {
+      ImmutableCallSite ICS(&NoAliasAA->getAnchorValue());
+      if (ICS && CS.getInstruction() == ICS.getInstruction())
+        return NoAliasAA->isAssumedNoAlias();
+    }
+    return false;
+  };
+  if (!A.checkForAllCallSites(CallSiteCheck, *this, true))
+    return indicatePessimisticFixpoint();
+  return ChangeStatus::UNCHANGED;
+}
+
+/// NoAlias attribute for a call site argument.
+struct AANoAliasCallSiteArgument final : AANoAliasImpl {
+  AANoAliasCallSiteArgument(const IRPosition &IRP) : AANoAliasImpl(IRP) {}
+
+  /// See AbstractAttribute::initialize(...).
+  void initialize(Attributor &A) override {
+    ImmutableCallSite ICS(&getAnchorValue());
+    if (ICS.paramHasAttr(getArgNo(), Attribute::NoAlias))
+      indicateOptimisticFixpoint();
+    else if (!isUniqueCallSiteArgument(getAssociatedValue(), ICS, getArgNo()))
+      indicatePessimisticFixpoint();
+  }
+
+  /// See AbstractAttribute::updateImpl(Attributor &A).
+  ChangeStatus updateImpl(Attributor &A) override {
+    // NOTE: Never look at the argument of the callee in this method.
+    //       If we do this, "noalias" is always deduced because of the
+    //       assumption.
+    auto *Arg = dyn_cast<Argument>(&getAssociatedValue());
+    if (!Arg || Arg->hasNoAliasAttr())
+      return ChangeStatus::UNCHANGED;
+
+    auto *NoAliasAA =
+        A.getAAFor<AANoAliasImpl>(*this, IRPosition::argument(*Arg));
+    if (!NoAliasAA || !NoAliasAA->isAssumedNoAlias())
+      return indicatePessimisticFixpoint();
+    return ChangeStatus::UNCHANGED;
+  }
+
+  /// See AbstractAttribute::trackStatistics()
+  void trackStatistics() const override { STATS_DECLTRACK_CSARG_ATTR(noalias) }
+};
+
 /// -------------------AAIsDead Function Attribute-----------------------
 
 struct AAIsDeadImpl : public AAIsDead {
@@ -2274,6 +2393,15 @@ ChangeStatus Attributor::run() {
 
   unsigned IterationCounter = 1;
 
+  // The compile-time budget of the fixpoint iteration. It scales with the
+  // number of abstract attributes so that large modules are not penalized
+  // while pathological dependence chains cannot trigger a quadratic number of
+  // updates.
+  uint64_t UpdateBudget =
+      uint64_t(MaxUpdatesPerAttribute) * AllAbstractAttributes.size();
+  uint64_t NumUpdates = 0;
+  bool BudgetExhausted = false;
+
   SmallVector<AbstractAttribute *, 64> ChangedAAs;
   SetVector<AbstractAttribute *> Worklist;
   Worklist.insert(AllAbstractAttributes.begin(), AllAbstractAttributes.end());
@@ -2294,21 +2422,36 @@ ChangeStatus Attributor::run() {
 
     // Update all abstract attribute in the work list and record the ones that
     // changed.
-    for (AbstractAttribute *AA : Worklist)
-      if (!isAssumedDead(*AA, nullptr))
+    for (unsigned Idx = 0, E = Worklist.size(); Idx != E; ++Idx) {
+      AbstractAttribute *AA = Worklist[Idx];
+      if (MaxUpdatesPerAttribute && NumUpdates >= UpdateBudget) {
+        // The remaining abstract attributes might depend on ones that changed
+        // and were not revisited. Treat them as changed so they are reverted to
+        // a pessimistic state below.
+        ChangedAAs.append(Worklist.begin() + Idx, Worklist.end());
+        BudgetExhausted = true;
+        break;
+      }
+      if (!isAssumedDead(*AA, nullptr)) {
+        ++NumUpdates;
         if (AA->update(*this) == ChangeStatus::CHANGED)
           ChangedAAs.push_back(AA);
+      }
+    }
 
     // Reset the work list and repopulate with the changed abstract attributes.
     // Note that dependent ones are added above.
     Worklist.clear();
     Worklist.insert(ChangedAAs.begin(), ChangedAAs.end());
 
-  } while (!Worklist.empty() && ++IterationCounter < MaxFixpointIterations);
+  } while (!BudgetExhausted && !Worklist.empty() &&
+           ++IterationCounter < MaxFixpointIterations);
 
+  NumFixpointUpdates += NumUpdates;
   LLVM_DEBUG(dbgs() << "\n[Attributor] Fixpoint iteration done after: "
                     << IterationCounter << "/" << MaxFixpointIterations
-                    << " iterations\n");
+                    << " iterations and " << NumUpdates << "/" << UpdateBudget
+                    << " updates\n");
 
   bool FinishedAtFixpoint = Worklist.empty();
 
@@ -2474,6 +2617,9 @@ void Attributor::identifyDefaultAbstractAttributes(
       // Every argument with pointer type might be marked nonnull.
       checkAndRegisterAA<AANonNullArgument>(ArgPos, *this, Whitelist);
 
+      // Every argument with pointer type might be marked noalias.
+      checkAndRegisterAA<AANoAliasArgument>(ArgPos, *this, Whitelist);
+
       // Every argument with pointer type might be marked dereferenceable.
       checkAndRegisterAA<AADereferenceableArgument>(ArgPos, *this, Whitelist);
 
@@ -2527,6 +2673,10 @@ void Attributor::identifyDefaultAbstractAttributes(
         checkAndRegisterAA<AANonNullCallSiteArgument>(CSArgPos, *this,
                                                       Whitelist);
 
+        // Call site argument attribute "no-alias".
+        checkAndRegisterAA<AANoAliasCallSiteArgument>(CSArgPos, *this,
+                                                      Whitelist);
+
         // Call site argument attribute "dereferenceable".
         checkAndRegisterAA<AADereferenceableCallSiteArgument>(CSArgPos, *this,
                                                               Whitelist);
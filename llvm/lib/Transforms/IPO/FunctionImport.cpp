@@ -12,6 +12,8 @@
 
 #include "llvm/Transforms/IPO/FunctionImport.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
@@ -41,6 +43,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/Internalize.h"
@@ -67,6 +70,16 @@ STATISTIC(NumImportedCriticalFunctionsThinLink,
           "Number of critical functions thin link decided to import");
 STATISTIC(NumImportedGlobalVarsThinLink,
           "Number of global variables thin link decided to import");
+STATISTIC(NumImportingModulesThinLink,
+          "Number of modules thin link decided to import into");
+STATISTIC(MaxImportSourceModulesThinLink,
+          "Maximum number of modules thin link decided to import one module "
+          "from");
+STATISTIC(MaxImportedValuesThinLink,
+          "Maximum number of values thin link decided to import into one "
+          "module");
+STATISTIC(NumIdenticalImportListsThinLink,
+          "Number of modules with the same import list as another module");
 STATISTIC(NumImportedFunctions, "Number of functions imported in backend");
 STATISTIC(NumImportedGlobalVars,
           "Number of global variables imported in backend");
@@ -112,6 +125,11 @@ static cl::opt<float> ImportColdMultiplier(
     "import-cold-multiplier", cl::init(0), cl::Hidden, cl::value_desc("N"),
     cl::desc("Multiply the `import-instr-limit` threshold for cold callsites"));
 
+static cl::opt<bool> ParallelImportComputation(
+    "parallel-import-computation", cl::init(true), cl::Hidden,
+    cl::desc("Compute the import lists of the modules of a thin link in "
+             "parallel"));
+
 static cl::opt<bool> PrintImports("print-imports", cl::init(false), cl::Hidden,
                                   cl::desc("Print imported functions"));
 
@@ -512,7 +530,10 @@ static void computeImportForFunction(
 
     const auto AdjThreshold = GetAdjustedThreshold(Threshold, IsHotCallsite);
 
-    ImportCount++;
+    // Only count with -import-cutoff, the import lists of several modules may
+    // be computed at the same time otherwise.
+    if (ImportCutoff >= 0)
+      ImportCount++;
 
     // Insert the newly imported function to the worklist.
     Worklist.emplace_back(ResolvedCalleeSummary, AdjThreshold, VI.getGUID());
@@ -614,38 +635,98 @@ static unsigned numGlobalVarSummaries(const ModuleSummaryIndex &Index,
 }
 #endif
 
+/// Update the fan-out statistics with the import lists of all modules.
+static void
+updateImportStatistics(const StringMap<FunctionImporter::ImportMapTy> &Lists) {
+  DenseSet<hash_code> ListHashes;
+  for (auto &ModuleImports : Lists) {
+    const FunctionImporter::ImportMapTy &ImportList = ModuleImports.second;
+    if (ImportList.empty())
+      continue;
+    ++NumImportingModulesThinLink;
+    MaxImportSourceModulesThinLink.updateMax(ImportList.size());
+
+    // Hash the list independently of the iteration order of its containers.
+    std::vector<hash_code> EntryHashes;
+    for (auto &Src : ImportList)
+      for (GlobalValue::GUID GUID : Src.second)
+        EntryHashes.push_back(hash_combine(Src.first(), GUID));
+    MaxImportedValuesThinLink.updateMax(EntryHashes.size());
+    llvm::sort(EntryHashes);
+    if (!ListHashes.insert(hash_combine_range(EntryHashes.begin(),
+                                              EntryHashes.end())).second)
+      ++NumIdenticalImportListsThinLink;
+  }
+}
+
 /// Compute all the import and export for every module using the Index.
 void llvm::ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
     StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
+  // The import list of each module only depends on the index, which is not
+  // modified, so the lists are computed in parallel. The exports that the
+  // imports of a module cause are collected per module and merged below.
+  // Debug output, -print-import-failures and the global -import-cutoff count
+  // need the modules to be processed one after the other.
+  struct ModuleImportInfo {
+    const StringMapEntry<GVSummaryMapTy> *DefinedGVSummaries;
+    FunctionImporter::ImportMapTy *ImportList;
+    StringMap<FunctionImporter::ExportSetTy> ExportLists;
+  };
+  std::vector<ModuleImportInfo> Modules;
+  Modules.reserve(ModuleToDefinedGVSummaries.size());
   // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
+  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries)
+    Modules.push_back({&DefinedGVSummaries,
+                       &ImportLists[DefinedGVSummaries.first()],
+                       StringMap<FunctionImporter::ExportSetTy>()});
+
+  auto ComputeImports = [&](size_t I) {
+    ModuleImportInfo &Info = Modules[I];
     LLVM_DEBUG(dbgs() << "Computing import for Module '"
-                      << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index,
-                           DefinedGVSummaries.first(), ImportList,
-                           &ExportLists);
-  }
+                      << Info.DefinedGVSummaries->first() << "'\n");
+    ComputeImportForModule(Info.DefinedGVSummaries->second, Index,
+                           Info.DefinedGVSummaries->first(), *Info.ImportList,
+                           &Info.ExportLists);
+  };
+  bool Parallel =
+      ParallelImportComputation && !PrintImportFailures && ImportCutoff < 0;
+#ifndef NDEBUG
+  Parallel &= !DebugFlag;
+#endif
+#if LLVM_ENABLE_THREADS
+  if (Parallel)
+    parallel::for_each_n(parallel::par, size_t(0), Modules.size(),
+                         ComputeImports);
+  else
+#endif
+    parallel::for_each_n(parallel::seq, size_t(0), Modules.size(),
+                         ComputeImports);
 
   // When computing imports we added all GUIDs referenced by anything
-  // imported from the module to its ExportList. Now we prune each ExportList
-  // of any not defined in that module. This is more efficient than checking
-  // while computing imports because some of the summary lists may be long
-  // due to linkonce (comdat) copies.
-  for (auto &ELI : ExportLists) {
-    const auto &DefinedGVSummaries =
-        ModuleToDefinedGVSummaries.lookup(ELI.first());
-    for (auto EI = ELI.second.begin(); EI != ELI.second.end();) {
-      if (!DefinedGVSummaries.count(*EI))
-        EI = ELI.second.erase(EI);
-      else
-        ++EI;
+  // imported from the module to its ExportList. Now we merge the export lists
+  // and prune them of any GUID not defined in the exporting module. This is
+  // more efficient than checking while computing imports because some of the
+  // summary lists may be long due to linkonce (comdat) copies.
+  for (ModuleImportInfo &Info : Modules) {
+    for (auto &ELI : Info.ExportLists) {
+      auto &ExportList = ExportLists[ELI.first()];
+      auto DefinedGVSummaries = ModuleToDefinedGVSummaries.find(ELI.first());
+      if (DefinedGVSummaries == ModuleToDefinedGVSummaries.end())
+        continue;
+      for (GlobalValue::GUID GUID : ELI.second)
+        if (DefinedGVSummaries->second.count(GUID))
+          ExportList.insert(GUID);
     }
+    // Release the unpruned lists early, they may be large.
+    Info.ExportLists.clear();
   }
 
+  if (AreStatisticsEnabled())
+    updateImportStatistics(ImportLists);
+
 #ifndef NDEBUG
   LLVM_DEBUG(dbgs() << "Import/Export lists for " << ImportLists.size()
                     << " modules:\n");
@@ -73,6 +73,9 @@
 
 STATISTIC(NumColdRegionsFound, "Number of cold regions found.");
 STATISTIC(NumColdRegionsOutlined, "Number of cold regions outlined.");
+STATISTIC(ColdCodeSizeOutlined,
+          "Estimated size of the code moved out of hot functions (as a "
+          "multiple of TCC_Basic).");
 
 using namespace llvm;
 
@@ -84,6 +87,13 @@ static cl::opt<int>
                        cl::desc("Base penalty for splitting cold code (as a "
                                 "multiple of TCC_Basic)"));
 
+static cl::opt<int> ColdCountPercentileCutoff(
+    "hotcoldsplit-cold-percentile", cl::init(0), cl::Hidden,
+    cl::desc("With a profile, treat a block as cold if its count is not "
+             "above the minimum count needed to reach this percentile of the "
+             "total count, in parts per million (0 uses "
+             "-profile-summary-cutoff-cold)"));
+
 namespace {
 
 /// A sequence of basic blocks.
@@ -181,6 +191,7 @@ public:
 
 private:
   bool isFunctionCold(const Function &F) const;
+  bool isColdBlock(const BasicBlock *BB, BlockFrequencyInfo *BFI) const;
   bool shouldOutlineFrom(const Function &F) const;
   bool outlineColdRegions(Function &F, bool HasProfileSummary);
   Function *extractColdRegion(const BlockSequence &Region, DominatorTree &DT,
@@ -361,13 +372,22 @@ Function *HotColdSplitting::extractColdRegion(const BlockSequence &Region,
     CI->setIsNoInline();
 
     markFunctionCold(*OutF, BFI != nullptr);
+    // Place the split function in the unlikely text section, away from the
+    // hot code it was taken out of. This doesn't depend on profile data, as
+    // CodeGenPrepare would only do it for functions with a zero entry count.
+    OutF->setSectionPrefix(".unlikely");
+
+    // The call left in the original function is accounted for by the penalty.
+    int SizeReduction = OutliningBenefit - OutliningPenalty;
+    ColdCodeSizeOutlined += SizeReduction;
 
     LLVM_DEBUG(llvm::dbgs() << "Outlined Region: " << *OutF);
     ORE.emit([&]() {
       return OptimizationRemark(DEBUG_TYPE, "HotColdSplit",
                                 &*Region[0]->begin())
              << ore::NV("Original", OrigF) << " split cold code into "
-             << ore::NV("Split", OutF);
+             << ore::NV("Split", OutF) << " (estimated size reduction: "
+             << ore::NV("SizeReduction", SizeReduction) << ")";
     });
     return OutF;
   }
@@ -561,6 +581,14 @@ public:
 };
 } // namespace
 
+/// Returns true if the profile count of \p BB makes it a splitting candidate.
+bool HotColdSplitting::isColdBlock(const BasicBlock *BB,
+                                   BlockFrequencyInfo *BFI) const {
+  if (ColdCountPercentileCutoff > 0)
+    return PSI->isColdBlockNthPercentile(ColdCountPercentileCutoff, BB, BFI);
+  return PSI->isColdBlock(BB, BFI);
+}
+
 bool HotColdSplitting::outlineColdRegions(Function &F, bool HasProfileSummary) {
   bool Changed = false;
 
@@ -596,7 +624,7 @@ bool HotColdSplitting::outlineColdRegions(Function &F, bool HasProfileSummary) {
     if (ColdBlocks.count(BB))
       continue;
 
-    bool Cold = (BFI && PSI->isColdBlock(BB, BFI)) ||
+    bool Cold = (BFI && isColdBlock(BB, BFI)) ||
                 (EnableStaticAnalyis && unlikelyExecuted(*BB));
     if (!Cold)
       continue;
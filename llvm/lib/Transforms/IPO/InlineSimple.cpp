@@ -70,7 +70,7 @@ public:
     };
     return llvm::getInlineCost(
         cast<CallBase>(*CS.getInstruction()), Params, TTI, GetAssumptionCache,
-        /*GetBFI=*/None, PSI, RemarksEnabled ? &ORE : nullptr);
+        /*GetBFI=*/None, PSI, RemarksEnabled ? &ORE : nullptr, &CostCache);
   }
 
   bool runOnSCC(CallGraphSCC &SCC) override;
@@ -531,7 +531,8 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
                 bool InsertLifetime,
                 function_ref<InlineCost(CallSite CS)> GetInlineCost,
                 function_ref<AAResults &(Function &)> AARGetter,
-                ImportedFunctionsInliningStatistics &ImportedFunctionsStats) {
+                ImportedFunctionsInliningStatistics &ImportedFunctionsStats,
+                InlineCostCache &CostCache) {
   SmallPtrSet<Function *, 8> SCCFunctions;
   LLVM_DEBUG(dbgs() << "Inliner visiting SCC:");
   for (CallGraphNode *Node : SCC) {
@@ -673,6 +674,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         setInlineRemark(CS, "trivially dead");
         CG[Caller]->removeCallEdgeFor(*cast<CallBase>(CS.getInstruction()));
         Instr->eraseFromParent();
+        CostCache.invalidate(Caller);
         ++NumCallsDeleted;
       } else {
         // Get DebugLoc to report. CS will be invalid after Inliner.
@@ -696,6 +698,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
           continue;
         }
         ++NumInlined;
+        CostCache.invalidate(Caller);
 
         emit_inlined_into(ORE, DLoc, Block, *Callee, *Caller, *OIC);
 
@@ -729,6 +732,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         CalleeNode->removeAllCalledFunctions();
 
         // Removing the node for callee from the call graph and delete it.
+        CostCache.invalidate(Callee);
         delete CG.removeFunctionFromModule(CalleeNode);
         ++NumDeleted;
       }
@@ -761,9 +765,15 @@ bool LegacyInlinerBase::inlineCalls(CallGraphSCC &SCC) {
   auto GetAssumptionCache = [&](Function &F) -> AssumptionCache & {
     return ACT->getAssumptionCache(F);
   };
-  return inlineCallsImpl(SCC, CG, GetAssumptionCache, PSI, TLI, InsertLifetime,
-                         [this](CallSite CS) { return getInlineCost(CS); },
-                         LegacyAARGetter(*this), ImportedFunctionsStats);
+  // Analyses cached for one SCC may be stale by the time the next one is
+  // visited, since the function passes in between change callees.
+  CostCache.clear();
+  bool Changed = inlineCallsImpl(
+      SCC, CG, GetAssumptionCache, PSI, TLI, InsertLifetime,
+      [this](CallSite CS) { return getInlineCost(CS); }, LegacyAARGetter(*this),
+      ImportedFunctionsStats, CostCache);
+  CostCache.clear();
+  return Changed;
 }
 
 /// Remove now-dead linkonce functions at the end of
@@ -962,6 +972,10 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
   // defer deleting these to make it easier to handle the call graph updates.
   SmallVector<Function *, 4> DeadFunctions;
 
+  // Share the inline cost analysis of a callee between its call sites. The
+  // only functions changed here are the callers we inline into.
+  InlineCostCache CostCache;
+
   // Loop forward over all of the calls. Note that we cannot cache the size as
   // inlining can introduce new calls that need to be processed.
   for (int i = 0; i < (int)Calls.size(); ++i) {
@@ -1010,7 +1024,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
               DEBUG_TYPE);
       return getInlineCost(cast<CallBase>(*CS.getInstruction()), Params,
                            CalleeTTI, GetAssumptionCache, {GetBFI}, PSI,
-                           RemarksEnabled ? &ORE : nullptr);
+                           RemarksEnabled ? &ORE : nullptr, &CostCache);
     };
 
     // Now process as many calls as we have within this caller in the sequnece.
@@ -1082,6 +1096,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
       }
       DidInline = true;
       InlinedCallees.insert(&Callee);
+      CostCache.invalidate(&F);
 
       ++NumInlined;
 
@@ -1123,6 +1138,7 @@ PreservedAnalyses InlinerPass::run(LazyCallGraph::SCC &InitialC,
           // Note that after this point, it is an error to do anything other
           // than use the callee's address or delete it.
           Callee.dropAllReferences();
+          CostCache.invalidate(&Callee);
           assert(find(DeadFunctions, &Callee) == DeadFunctions.end() &&
                  "Cannot put cause a function to become dead twice!");
           DeadFunctions.push_back(&Callee);
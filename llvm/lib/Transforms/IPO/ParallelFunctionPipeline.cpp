@@ -0,0 +1,142 @@
+//===- ParallelFunctionPipeline.cpp - Run function passes in parallel -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ParallelFunctionPipelinePass, which runs a function
+// pass pipeline on partitions of a module in parallel.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/ParallelFunctionPipeline.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/IRMover.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
+
+using namespace llvm;
+
+// The name given to unnamed globals while the module is split, so that the
+// partitions can refer to them.
+static const char *const UnnamedPrefix = "__llvmpfp_unnamed";
+
+/// Delete all global values, named metadata and comdats of \p M, and its
+/// inline asm.
+static void clearModule(Module &M) {
+  for (Function &F : M)
+    F.dropAllReferences();
+  for (GlobalVariable &GV : M.globals())
+    GV.dropAllReferences();
+  for (GlobalAlias &GA : M.aliases())
+    GA.dropAllReferences();
+  for (GlobalIFunc &GIF : M.ifuncs())
+    GIF.dropAllReferences();
+  // Constant expressions that referred to the globals are dead now.
+  for (GlobalValue &GV : M.global_values())
+    GV.removeDeadConstantUsers();
+
+  while (!M.empty())
+    M.begin()->eraseFromParent();
+  while (!M.global_empty())
+    M.global_begin()->eraseFromParent();
+  while (!M.alias_empty())
+    M.alias_begin()->eraseFromParent();
+  while (!M.ifunc_empty())
+    M.ifunc_begin()->eraseFromParent();
+  while (!M.named_metadata_empty())
+    M.eraseNamedMetadata(&*M.named_metadata_begin());
+  M.getComdatSymbolTable().clear();
+  M.setModuleInlineAsm("");
+}
+
+PreservedAnalyses ParallelFunctionPipelinePass::run(Module &M,
+                                                    ModuleAnalysisManager &) {
+  if (NumPartitions <= 1) {
+    RunPipeline(M);
+    return PreservedAnalyses::none();
+  }
+
+  SmallVector<std::string, 0> UnnamedNames;
+  for (GlobalValue &GV : M.global_values()) {
+    if (GV.hasName())
+      continue;
+    GV.setName(UnnamedPrefix);
+    UnnamedNames.push_back(GV.getName());
+  }
+
+  // Serialize the partitions on this thread, and read each of them into its
+  // own context on the thread that optimizes it.
+  SmallVector<SmallString<0>, 8> Parts;
+  SplitModule(
+      M, NumPartitions,
+      [&](std::unique_ptr<Module> MPart) {
+        // Named metadata other than the compile units, which the debug info of
+        // the functions refers to, would be duplicated by linking.
+        if (!Parts.empty()) {
+          SmallVector<NamedMDNode *, 4> ToErase;
+          for (NamedMDNode &NMD : MPart->named_metadata())
+            if (NMD.getName() != "llvm.dbg.cu" &&
+                NMD.getName() != "llvm.module.flags")
+              ToErase.push_back(&NMD);
+          for (NamedMDNode *NMD : ToErase)
+            MPart->eraseNamedMetadata(NMD);
+        }
+        Parts.emplace_back();
+        raw_svector_ostream OS(Parts.back());
+        WriteBitcodeToFile(*MPart, OS);
+      },
+      /*PreserveLocals=*/true, SplitModuleMode::CostBalanced);
+
+  // Create ThreadPool in nested scope so that threads will be joined
+  // on destruction.
+  {
+    ThreadPool Pool(Parts.size());
+    for (SmallString<0> &BC : Parts)
+      Pool.async([this, &BC]() {
+        LLVMContext Ctx;
+        Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+            MemoryBufferRef(StringRef(BC.data(), BC.size()), "<split-module>"),
+            Ctx);
+        if (!MOrErr)
+          report_fatal_error("Failed to read bitcode");
+        RunPipeline(**MOrErr);
+        BC.clear();
+        raw_svector_ostream OS(BC);
+        WriteBitcodeToFile(**MOrErr, OS);
+      });
+  }
+
+  clearModule(M);
+  IRMover Mover(M);
+  for (SmallString<0> &BC : Parts) {
+    Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+        MemoryBufferRef(StringRef(BC.data(), BC.size()), "<split-module>"),
+        M.getContext());
+    if (!MOrErr)
+      report_fatal_error("Failed to read bitcode");
+    std::vector<GlobalValue *> ValuesToLink;
+    for (GlobalValue &GV : (*MOrErr)->global_values())
+      if (!GV.isDeclaration())
+        ValuesToLink.push_back(&GV);
+    if (Error E = Mover.move(std::move(*MOrErr), ValuesToLink,
+                             [](GlobalValue &, IRMover::ValueAdder) {},
+                             /*IsPerformingImport=*/false))
+      report_fatal_error("Failed to link partition: " + toString(std::move(E)));
+    BC.clear();
+  }
+  M.dropTriviallyDeadConstantArrays();
+
+  for (StringRef Name : UnnamedNames)
+    if (GlobalValue *GV = M.getNamedValue(Name))
+      GV->setName("");
+
+  return PreservedAnalyses::none();
+}
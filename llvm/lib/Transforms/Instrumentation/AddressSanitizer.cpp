@@ -68,6 +68,7 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include "llvm/Transforms/Instrumentation.h"
 #include "llvm/Transforms/Utils/ASanStackFrameLayout.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
@@ -174,6 +175,11 @@ static const char *const kAsanOptionDetectUseAfterReturn =
 static const char *const kAsanShadowMemoryDynamicAddress =
     "__asan_shadow_memory_dynamic_address";
 
+static const char *const kAsanFunctionSampleSeed =
+    "__asan_function_sample_seed";
+static const char *const kAsanFunctionSampleThreshold =
+    "__asan_function_sample_threshold";
+
 static const char *const kAsanAllocaPoison = "__asan_alloca_poison";
 static const char *const kAsanAllocasUnpoison = "__asan_allocas_unpoison";
 
@@ -290,6 +296,12 @@ static cl::opt<unsigned> ClRealignStack(
     cl::desc("Realign stack to the value of this flag (power of two)"),
     cl::Hidden, cl::init(32));
 
+static cl::opt<bool> ClSampleFunctions(
+    "asan-sample-functions",
+    cl::desc("Check the memory accesses of a function only if the run-time "
+             "samples it (see ASAN_OPTIONS=sample_functions)"),
+    cl::Hidden, cl::init(false));
+
 static cl::opt<int> ClInstrumentationWithCallsThreshold(
     "asan-instrumentation-with-call-threshold",
     cl::desc(
@@ -636,6 +648,7 @@ struct AddressSanitizer {
   bool instrumentFunction(Function &F, const TargetLibraryInfo *TLI);
   bool maybeInsertAsanInitAtFunctionEntry(Function &F);
   void maybeInsertDynamicShadowAtFunctionEntry(Function &F);
+  void insertFunctionSampledAtFunctionEntry(Function &F);
   void markEscapedLocalAllocas(Function &F);
 
 private:
@@ -656,10 +669,12 @@ private:
       assert(Pass->ProcessedAllocas.empty() &&
              "last pass forgot to clear cache");
       assert(!Pass->LocalDynamicShadow);
+      assert(!Pass->LocalFunctionSampled);
     }
 
     ~FunctionStateRAII() {
       Pass->LocalDynamicShadow = nullptr;
+      Pass->LocalFunctionSampled = nullptr;
       Pass->ProcessedAllocas.clear();
     }
   };
@@ -687,6 +702,7 @@ private:
   FunctionCallee AsanMemmove, AsanMemcpy, AsanMemset;
   InlineAsm *EmptyAsm;
   Value *LocalDynamicShadow = nullptr;
+  Value *LocalFunctionSampled = nullptr;
   GlobalsMetadata GlobalsMD;
   DenseMap<const AllocaInst *, bool> ProcessedAllocas;
 };
@@ -1503,6 +1519,7 @@ static void doInstrumentAddress(AddressSanitizer *Pass, Instruction *I,
 static void instrumentMaskedLoadOrStore(AddressSanitizer *Pass,
                                         const DataLayout &DL, Type *IntptrTy,
                                         Value *Mask, Instruction *I,
+                                        Instruction *CheckInsertBefore,
                                         Value *Addr, unsigned Alignment,
                                         unsigned Granularity, uint32_t TypeSize,
                                         bool IsWrite, Value *SizeArgument,
@@ -1513,7 +1530,7 @@ static void instrumentMaskedLoadOrStore(AddressSanitizer *Pass,
   auto Zero = ConstantInt::get(IntptrTy, 0);
   for (unsigned Idx = 0; Idx < Num; ++Idx) {
     Value *InstrumentedAddress = nullptr;
-    Instruction *InsertBefore = I;
+    Instruction *InsertBefore = CheckInsertBefore;
     if (auto *Vector = dyn_cast<ConstantVector>(Mask)) {
       // dyn_cast as we might get UndefValue
       if (auto *Masked = dyn_cast<ConstantInt>(Vector->getOperand(Idx))) {
@@ -1521,12 +1538,13 @@ static void instrumentMaskedLoadOrStore(AddressSanitizer *Pass,
           // Mask is constant false, so no instrumentation needed.
           continue;
         // If we have a true or undef value, fall through to doInstrumentAddress
-        // with InsertBefore == I
+        // with InsertBefore == CheckInsertBefore
       }
     } else {
-      IRBuilder<> IRB(I);
+      IRBuilder<> IRB(CheckInsertBefore);
       Value *MaskElem = IRB.CreateExtractElement(Mask, Idx);
-      Instruction *ThenTerm = SplitBlockAndInsertIfThen(MaskElem, I, false);
+      Instruction *ThenTerm =
+          SplitBlockAndInsertIfThen(MaskElem, CheckInsertBefore, false);
       InsertBefore = ThenTerm;
     }
 
@@ -1588,14 +1606,19 @@ void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
   else
     NumInstrumentedReads++;
 
+  // In a sampled function, the checks only run if the run-time picked it.
+  Instruction *InsertBefore = I;
+  if (LocalFunctionSampled)
+    InsertBefore = SplitBlockAndInsertIfThen(LocalFunctionSampled, I, false);
+
   unsigned Granularity = 1 << Mapping.Scale;
   if (MaybeMask) {
-    instrumentMaskedLoadOrStore(this, DL, IntptrTy, MaybeMask, I, Addr,
-                                Alignment, Granularity, TypeSize, IsWrite,
+    instrumentMaskedLoadOrStore(this, DL, IntptrTy, MaybeMask, I, InsertBefore,
+                                Addr, Alignment, Granularity, TypeSize, IsWrite,
                                 nullptr, UseCalls, Exp);
   } else {
-    doInstrumentAddress(this, I, I, Addr, Alignment, Granularity, TypeSize,
-                        IsWrite, nullptr, UseCalls, Exp);
+    doInstrumentAddress(this, I, InsertBefore, Addr, Alignment, Granularity,
+                        TypeSize, IsWrite, nullptr, UseCalls, Exp);
   }
 }
 
@@ -2575,6 +2598,24 @@ void AddressSanitizer::maybeInsertDynamicShadowAtFunctionEntry(Function &F) {
   }
 }
 
+void AddressSanitizer::insertFunctionSampledAtFunctionEntry(Function &F) {
+  // The run-time picks the functions to check by comparing a hash of their
+  // name, mixed with a per-process seed, with a threshold. Both are loaded
+  // once per call, which keeps the cost of a function that isn't checked to a
+  // branch on a register per memory access.
+  IRBuilder<> IRB(&F.front().front());
+  Module &M = *F.getParent();
+  Type *Int32Ty = IRB.getInt32Ty();
+  Value *Seed = IRB.CreateLoad(
+      Int32Ty, M.getOrInsertGlobal(kAsanFunctionSampleSeed, Int32Ty));
+  Value *Threshold = IRB.CreateLoad(
+      Int32Ty, M.getOrInsertGlobal(kAsanFunctionSampleThreshold, Int32Ty));
+  Value *Hash = ConstantInt::get(
+      Int32Ty, static_cast<uint32_t>(xxHash64(F.getName())));
+  LocalFunctionSampled = IRB.CreateICmpULE(IRB.CreateXor(Seed, Hash),
+                                           Threshold, ".asan.sampled");
+}
+
 void AddressSanitizer::markEscapedLocalAllocas(Function &F) {
   // Find the one possible call to llvm.localescape and pre-mark allocas passed
   // to it as uninteresting. This assumes we haven't started processing allocas
@@ -2693,6 +2734,9 @@ bool AddressSanitizer::instrumentFunction(Function &F,
     }
   }
 
+  if (ClSampleFunctions && !CompileKernel && !ToInstrument.empty())
+    insertFunctionSampledAtFunctionEntry(F);
+
   bool UseCalls =
       (ClInstrumentationWithCallsThreshold >= 0 &&
        ToInstrument.size() > (unsigned)ClInstrumentationWithCallsThreshold);
@@ -102,6 +102,12 @@ cl::opt<bool> AtomicCounterUpdateAll(
     cl::desc("Make all profile counter updates atomic (for testing only)"),
     cl::init(false));
 
+cl::opt<bool> RuntimeCounterRelocation(
+    "runtime-counter-relocation", cl::ZeroOrMore,
+    cl::desc("Update the counters at an offset the runtime can change, which "
+             "the profile runtime's continuous mode needs"),
+    cl::init(false));
+
 cl::opt<bool> AtomicCounterUpdatePromoted(
     "atomic-counter-update-promoted", cl::ZeroOrMore,
     cl::desc("Do counter update using atomic fetch add "
@@ -423,6 +429,10 @@ bool InstrProfiling::lowerIntrinsics(Function *F) {
   return true;
 }
 
+bool InstrProfiling::isRuntimeCounterRelocationEnabled() const {
+  return RuntimeCounterRelocation;
+}
+
 bool InstrProfiling::isCounterPromotionEnabled() const {
   if (DoCounterPromotion.getNumOccurrences() > 0)
     return DoCounterPromotion;
@@ -488,6 +498,7 @@ bool InstrProfiling::run(Module &M, const TargetLibraryInfo &TLI) {
   NamesVar = nullptr;
   NamesSize = 0;
   ProfileDataMap.clear();
+  FunctionToProfileBiasMap.clear();
   UsedVars.clear();
   getMemOPSizeRangeFromOption(MemOPSizeRange, MemOPSizeRangeStart,
                               MemOPSizeRangeLast);
@@ -631,6 +642,32 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters->getValueType(),
                                                    Counters, 0, Index);
 
+  if (isRuntimeCounterRelocationEnabled()) {
+    // The counters actually updated are at Addr + bias, where the bias is set
+    // by the runtime, e.g. to point into a mapping of the profile file. The
+    // bias is loaded once, in the entry block.
+    Type *IntPtrTy = M->getDataLayout().getIntPtrType(M->getContext());
+    Function *Fn = Inc->getParent()->getParent();
+    LoadInst *&BiasLI = FunctionToProfileBiasMap[Fn];
+    if (!BiasLI) {
+      IRBuilder<> EntryBuilder(&Fn->getEntryBlock().front());
+      auto *Bias = M->getGlobalVariable(getInstrProfCounterBiasVarName());
+      if (!Bias) {
+        Bias = new GlobalVariable(*M, IntPtrTy, false,
+                                  GlobalValue::LinkOnceODRLinkage,
+                                  Constant::getNullValue(IntPtrTy),
+                                  getInstrProfCounterBiasVarName());
+        Bias->setVisibility(GlobalVariable::HiddenVisibility);
+        if (TT.supportsCOMDAT())
+          Bias->setComdat(M->getOrInsertComdat(Bias->getName()));
+      }
+      BiasLI = EntryBuilder.CreateLoad(IntPtrTy, Bias);
+    }
+    Value *Add =
+        Builder.CreateAdd(Builder.CreatePtrToInt(Addr, IntPtrTy), BiasLI);
+    Addr = Builder.CreateIntToPtr(Add, Addr->getType());
+  }
+
   if (Options.Atomic || AtomicCounterUpdateAll) {
     Builder.CreateAtomicRMW(AtomicRMWInst::Add, Addr, Inc->getStep(),
                             AtomicOrdering::Monotonic);
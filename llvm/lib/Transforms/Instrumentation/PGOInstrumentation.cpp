@@ -1174,8 +1174,9 @@ void PGOUseFunc::setEdgeCount(DirectEdges &Edges, uint64_t Value) {
 // Return true if the profile are successfully read, and false on errors.
 bool PGOUseFunc::readCounters(IndexedInstrProfReader *PGOReader, bool &AllZeros) {
   auto &Ctx = M->getContext();
-  Expected<InstrProfRecord> Result =
-      PGOReader->getInstrProfRecord(FuncInfo.FuncName, FuncInfo.FunctionHash);
+  Expected<const NamedInstrProfRecord &> Result =
+      PGOReader->getInstrProfRecordRef(FuncInfo.FuncName,
+                                       FuncInfo.FunctionHash);
   if (Error E = Result.takeError()) {
     handleAllErrors(std::move(E), [&](const InstrProfError &IPE) {
       auto Err = IPE.get();
@@ -1210,7 +1211,8 @@ bool PGOUseFunc::readCounters(IndexedInstrProfReader *PGOReader, bool &AllZeros)
     });
     return false;
   }
-  ProfileRecord = std::move(Result.get());
+  // Copy the record out of the reader, it is overwritten by the next lookup.
+  ProfileRecord = *Result;
   std::vector<uint64_t> &CountFromProfile = ProfileRecord.Counts;
 
   IsCS ? NumOfCSPGOFunc++ : NumOfPGOFunc++;
@@ -1626,6 +1628,15 @@ static bool annotateAllFunctions(
     return false;
   }
 
+  // Fault in the profile records of all the functions in file order before
+  // looking them up one at a time.
+  std::vector<std::string> FuncNames;
+  for (auto &F : M)
+    if (!F.isDeclaration())
+      FuncNames.push_back(getPGOFuncName(F));
+  PGOReader->prefetchRecords(
+      std::vector<StringRef>(FuncNames.begin(), FuncNames.end()));
+
   std::unordered_multimap<Comdat *, GlobalValue *> ComdatMembers;
   collectComdatMembers(M, ComdatMembers);
   std::vector<Function *> HotFunctions;
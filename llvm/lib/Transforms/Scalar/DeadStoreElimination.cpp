@@ -9,8 +9,10 @@
 // This file implements a trivial dead store elimination that only considers
 // basic-block local redundant stores.
 //
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// With -enable-dse-memoryssa, a MemorySSA based implementation is used
+// instead. It walks up the MemorySSA def chain of every store to find earlier
+// stores it completely overwrites, wherever they are in the function, and
+// uses post-dominance to make sure the overwrite happens on all paths.
 //
 //===----------------------------------------------------------------------===//
 
@@ -28,7 +30,10 @@
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OrderedBasicBlock.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Argument.h"
@@ -74,6 +79,9 @@ STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther, "Number of other instrs removed");
 STATISTIC(NumCompletePartials, "Number of stores dead by later partials");
 STATISTIC(NumModifiedStores, "Number of stores modified");
+STATISTIC(NumCrossBlockStores, "Number of stores deleted across blocks");
+STATISTIC(NumScanLimitReached,
+          "Number of MemorySSA walks cut off by the scan limits");
 
 static cl::opt<bool>
 EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
@@ -85,6 +93,21 @@ EnablePartialStoreMerging("enable-dse-partial-store-merging",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial store merging in DSE"));
 
+static cl::opt<bool>
+EnableMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+  cl::desc("Use the MemorySSA based DSE"));
+
+static cl::opt<unsigned>
+MemorySSAScanLimit("dse-memoryssa-scanlimit", cl::init(100), cl::Hidden,
+  cl::desc("The number of earlier MemoryDefs to consider as dead store "
+           "candidates for each store (MemorySSA DSE)"));
+
+static cl::opt<unsigned>
+MemorySSAUseScanLimit("dse-memoryssa-use-scanlimit", cl::init(150),
+  cl::Hidden,
+  cl::desc("The number of memory accesses to check for reads between a dead "
+           "store candidate and the store overwriting it (MemorySSA DSE)"));
+
 //===----------------------------------------------------------------------===//
 // Helper functions
 //===----------------------------------------------------------------------===//
@@ -1322,15 +1345,270 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
   return MadeChange;
 }
 
+//===----------------------------------------------------------------------===//
+// MemorySSA backed DSE
+//===----------------------------------------------------------------------===//
+namespace {
+
+struct DSEState {
+  Function &F;
+  AliasAnalysis &AA;
+  MemorySSA &MSSA;
+  MemorySSAUpdater Updater;
+  DominatorTree &DT;
+  PostDominatorTree &PDT;
+  const TargetLibraryInfo &TLI;
+  const DataLayout &DL;
+
+  /// The MemoryDefs of all analyzable writes, in program order. These are
+  /// the candidates for killing earlier stores.
+  SmallVector<MemoryDef *, 64> MemDefs;
+  /// MemoryDefs that were deleted, so must be skipped in MemDefs.
+  SmallPtrSet<MemoryAccess *, 16> SkipStores;
+  /// Blocks with instructions that may throw.
+  SmallPtrSet<BasicBlock *, 16> ThrowingBlocks;
+  /// Objects that cannot be accessed by the caller once the function
+  /// returns or unwinds.
+  SmallPtrSet<const Value *, 16> InvisibleToCaller;
+
+  DSEState(Function &F, AliasAnalysis &AA, MemorySSA &MSSA, DominatorTree &DT,
+           PostDominatorTree &PDT, const TargetLibraryInfo &TLI)
+      : F(F), AA(AA), MSSA(MSSA), Updater(&MSSA), DT(DT), PDT(PDT), TLI(TLI),
+        DL(F.getParent()->getDataLayout()) {
+    for (BasicBlock &BB : F) {
+      // Unreachable blocks have no MemorySSA accesses.
+      if (!DT.isReachableFromEntry(&BB))
+        continue;
+      for (Instruction &I : BB) {
+        if (I.mayThrow())
+          ThrowingBlocks.insert(&BB);
+        if (isa<AllocaInst>(&I) ||
+            (isAllocLikeFn(&I, &TLI) &&
+             !PointerMayBeCaptured(&I, /*ReturnCaptures=*/true,
+                                   /*StoreCaptures=*/true)))
+          InvisibleToCaller.insert(&I);
+        auto *MD = dyn_cast_or_null<MemoryDef>(MSSA.getMemoryAccess(&I));
+        if (MD && hasAnalyzableMemoryWrite(&I, TLI) && getLocForWrite(&I).Ptr)
+          MemDefs.push_back(MD);
+      }
+    }
+  }
+
+  /// Returns true if an instruction between DeadI and KillingI may throw and
+  /// the caller could observe the store of DeadI on the unwind path.
+  bool mayThrowBetween(Instruction *DeadI, Instruction *KillingI,
+                       const Value *DeadUO) {
+    if (InvisibleToCaller.count(DeadUO))
+      return false;
+    if (DeadI->getParent() == KillingI->getParent()) {
+      for (Instruction *I = DeadI->getNextNode(); I != KillingI;
+           I = I->getNextNode())
+        if (I->mayThrow())
+          return true;
+      return false;
+    }
+    // Do not bother finding the blocks on the paths between the two.
+    return !ThrowingBlocks.empty();
+  }
+
+  /// Returns true if DeadLoc, as written by DeadDef, may be read before it is
+  /// overwritten by KillingDef. If KillingDef is null, checks whether DeadLoc
+  /// may be read anywhere before the function returns. Conservatively
+  /// returns true if the walk gets too long.
+  bool isReadBeforeOverwrite(MemoryDef *DeadDef, const MemoryLocation &DeadLoc,
+                             MemoryDef *KillingDef) {
+    SmallVector<MemoryAccess *, 32> WorkList;
+    SmallPtrSet<MemoryAccess *, 32> Visited;
+    auto PushMemUses = [&](MemoryAccess *Acc) {
+      for (Use &U : Acc->uses())
+        if (Visited.insert(cast<MemoryAccess>(U.getUser())).second)
+          WorkList.push_back(cast<MemoryAccess>(U.getUser()));
+    };
+    PushMemUses(DeadDef);
+
+    unsigned Steps = 0;
+    while (!WorkList.empty()) {
+      if (++Steps > MemorySSAUseScanLimit) {
+        ++NumScanLimitReached;
+        return true;
+      }
+      MemoryAccess *UseAccess = WorkList.pop_back_val();
+      if (UseAccess == KillingDef)
+        continue;
+      // If DeadDef can execute again before KillingDef, its pointer may not
+      // refer to the same location the second time around, so the
+      // overwrite cannot be reasoned about.
+      if (KillingDef && UseAccess == DeadDef)
+        return true;
+      if (isa<MemoryPhi>(UseAccess)) {
+        PushMemUses(UseAccess);
+        continue;
+      }
+
+      Instruction *UseInst = cast<MemoryUseOrDef>(UseAccess)->getMemoryInst();
+      if (isRefSet(AA.getModRefInfo(UseInst, DeadLoc)))
+        return true;
+      if (isa<MemoryDef>(UseAccess))
+        PushMemUses(UseAccess);
+    }
+    return false;
+  }
+
+  /// Delete DeadI and any instructions that become trivially dead, keeping
+  /// MemorySSA up to date.
+  void deleteDeadInstruction(Instruction *DeadI) {
+    SmallVector<Instruction *, 32> NowDeadInsts;
+    NowDeadInsts.push_back(DeadI);
+    --NumFastOther;
+
+    while (!NowDeadInsts.empty()) {
+      Instruction *I = NowDeadInsts.pop_back_val();
+      ++NumFastOther;
+
+      // Try to preserve debug information attached to the dead instruction.
+      salvageDebugInfo(*I);
+
+      if (MemoryAccess *MA = MSSA.getMemoryAccess(I)) {
+        SkipStores.insert(MA);
+        Updater.removeMemoryAccess(MA);
+      }
+
+      for (Use &Op : I->operands()) {
+        Value *V = Op.get();
+        Op.set(nullptr);
+        if (!V->use_empty())
+          continue;
+        if (Instruction *OpI = dyn_cast<Instruction>(V))
+          if (isInstructionTriviallyDead(OpI, &TLI))
+            NowDeadInsts.push_back(OpI);
+      }
+      InvisibleToCaller.erase(I);
+      I->eraseFromParent();
+    }
+  }
+
+  /// Try to eliminate the stores that KillingDef completely overwrites.
+  bool eliminateStoresKilledBy(MemoryDef *KillingDef) {
+    Instruction *KillingI = KillingDef->getMemoryInst();
+    MemoryLocation KillingLoc = getLocForWrite(KillingI);
+    bool MadeChange = false;
+
+    MemoryAccess *Current = KillingDef->getDefiningAccess();
+    for (unsigned ScanLimit = MemorySSAScanLimit;; --ScanLimit) {
+      // Only look through MemoryDefs. At a MemoryPhi the other incoming
+      // paths may store something else.
+      if (MSSA.isLiveOnEntryDef(Current) || !isa<MemoryDef>(Current))
+        break;
+      if (ScanLimit == 0) {
+        ++NumScanLimitReached;
+        break;
+      }
+      auto *DeadDef = cast<MemoryDef>(Current);
+      Current = DeadDef->getDefiningAccess();
+
+      Instruction *DeadI = DeadDef->getMemoryInst();
+      if (!hasAnalyzableMemoryWrite(DeadI, TLI) || !isRemovable(DeadI))
+        continue;
+      MemoryLocation DeadLoc = getLocForWrite(DeadI);
+      if (!DeadLoc.Ptr)
+        continue;
+
+      // KillingI must execute whenever DeadI does.
+      if (!PDT.dominates(KillingI->getParent(), DeadI->getParent()))
+        continue;
+
+      const Value *DeadUO = GetUnderlyingObject(DeadLoc.Ptr, DL);
+      if (mayThrowBetween(DeadI, KillingI, DeadUO))
+        break;
+
+      if (isPossibleSelfRead(KillingI, KillingLoc, DeadI, TLI, AA))
+        continue;
+      InstOverlapIntervalsTy IOL;
+      int64_t KillingOffset, DeadOffset;
+      if (isOverwrite(KillingLoc, DeadLoc, DL, TLI, DeadOffset, KillingOffset,
+                      DeadI, IOL, AA, &F) != OW_Complete)
+        continue;
+      if (isReadBeforeOverwrite(DeadDef, DeadLoc, KillingDef))
+        continue;
+
+      LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *DeadI
+                        << "\n  KILLER: " << *KillingI << '\n');
+      if (DeadI->getParent() != KillingI->getParent())
+        ++NumCrossBlockStores;
+      ++NumFastStores;
+      deleteDeadInstruction(DeadI);
+      MadeChange = true;
+    }
+    return MadeChange;
+  }
+
+  /// Eliminate DeadDef if it stores to an object that is never read again
+  /// before the function returns.
+  bool eliminateUnreadStore(MemoryDef *DeadDef) {
+    Instruction *DeadI = DeadDef->getMemoryInst();
+    if (!isRemovable(DeadI))
+      return false;
+    MemoryLocation DeadLoc = getLocForWrite(DeadI);
+    const Value *DeadUO = GetUnderlyingObject(DeadLoc.Ptr, DL);
+    if (!InvisibleToCaller.count(DeadUO))
+      return false;
+    if (isReadBeforeOverwrite(DeadDef, DeadLoc, /*KillingDef=*/nullptr))
+      return false;
+
+    LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *DeadI
+                      << "\n  OBJECT: " << *DeadUO << '\n');
+    ++NumFastStores;
+    deleteDeadInstruction(DeadI);
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+static bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
+                                         MemorySSA &MSSA, DominatorTree &DT,
+                                         PostDominatorTree &PDT,
+                                         const TargetLibraryInfo &TLI) {
+  DSEState State(F, AA, MSSA, DT, PDT, TLI);
+  bool MadeChange = false;
+
+  for (unsigned I = 0; I < State.MemDefs.size(); ++I) {
+    MemoryDef *KillingDef = State.MemDefs[I];
+    if (!State.SkipStores.count(KillingDef))
+      MadeChange |= State.eliminateStoresKilledBy(KillingDef);
+  }
+
+  // Visit the stores backwards, so that the walks of earlier stores do not
+  // have to look at later ones that are dead themselves.
+  for (MemoryDef *DeadDef : reverse(State.MemDefs))
+    if (!State.SkipStores.count(DeadDef))
+      MadeChange |= State.eliminateUnreadStore(DeadDef);
+
+  return MadeChange;
+}
+
 //===----------------------------------------------------------------------===//
 // DSE Pass
 //===----------------------------------------------------------------------===//
 PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   AliasAnalysis *AA = &AM.getResult<AAManager>(F);
   DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
-  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
 
+  if (EnableMemorySSA) {
+    MemorySSA &MSSA = AM.getResult<MemorySSAAnalysis>(F).getMSSA();
+    PostDominatorTree &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
+    if (!eliminateDeadStoresMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI))
+      return PreservedAnalyses::all();
+
+    PreservedAnalyses PA;
+    PA.preserveSet<CFGAnalyses>();
+    PA.preserve<GlobalsAA>();
+    PA.preserve<MemorySSAAnalysis>();
+    return PA;
+  }
+
+  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   if (!eliminateDeadStores(F, AA, MD, DT, TLI))
     return PreservedAnalyses::all();
 
@@ -1358,11 +1636,18 @@ public:
 
     DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     AliasAnalysis *AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-    MemoryDependenceResults *MD =
-        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
 
+    if (EnableMemorySSA) {
+      MemorySSA &MSSA = getAnalysis<MemorySSAWrapperPass>().getMSSA();
+      PostDominatorTree &PDT =
+          getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+      return eliminateDeadStoresMemorySSA(F, *AA, MSSA, *DT, PDT, *TLI);
+    }
+
+    MemoryDependenceResults *MD =
+        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     return eliminateDeadStores(F, AA, MD, DT, TLI);
   }
 
@@ -1370,11 +1655,18 @@ public:
     AU.setPreservesCFG();
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
-    AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
-    AU.addPreserved<MemoryDependenceWrapperPass>();
+    if (EnableMemorySSA) {
+      AU.addRequired<PostDominatorTreeWrapperPass>();
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addPreserved<PostDominatorTreeWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+    } else {
+      AU.addRequired<MemoryDependenceWrapperPass>();
+      AU.addPreserved<MemoryDependenceWrapperPass>();
+    }
   }
 };
 
@@ -1388,6 +1680,8 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
@@ -12,6 +12,9 @@
 // Note that this pass does the value numbering itself; it does not use the
 // ValueNumbering analysis passes.
 //
+// The dependencies of loads are found with MemoryDependenceAnalysis, or with
+// MemorySSA under -enable-gvn-memoryssa, which is then kept up to date.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Scalar/GVN.h"
@@ -35,6 +38,8 @@
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Analysis/PHITransAddr.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
@@ -100,6 +105,10 @@ static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
 static cl::opt<bool> EnableMemDep("enable-gvn-memdep", cl::init(true));
+static cl::opt<bool> EnableMemorySSA(
+    "enable-gvn-memoryssa", cl::init(false), cl::Hidden,
+    cl::desc("Find the dependencies of loads with MemorySSA instead of "
+             "MemoryDependenceAnalysis"));
 
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
@@ -620,7 +629,9 @@ PreservedAnalyses GVN::run(Function &F, FunctionAnalysisManager &AM) {
   auto &MemDep = AM.getResult<MemoryDependenceAnalysis>(F);
   auto *LI = AM.getCachedResult<LoopAnalysis>(F);
   auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
-  bool Changed = runImpl(F, AC, DT, TLI, AA, &MemDep, LI, &ORE);
+  MemorySSA *MSSA =
+      EnableMemorySSA ? &AM.getResult<MemorySSAAnalysis>(F).getMSSA() : nullptr;
+  bool Changed = runImpl(F, AC, DT, TLI, AA, &MemDep, LI, &ORE, MSSA);
   if (!Changed)
     return PreservedAnalyses::all();
   PreservedAnalyses PA;
@@ -629,6 +640,8 @@ PreservedAnalyses GVN::run(Function &F, FunctionAnalysisManager &AM) {
   PA.preserve<TargetLibraryAnalysis>();
   if (LI)
     PA.preserve<LoopAnalysis>();
+  if (MSSA)
+    PA.preserve<MemorySSAAnalysis>();
   return PA;
 }
 
@@ -1251,6 +1264,11 @@ bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock,
     ValuesPerBlock.push_back(AvailableValueInBlock::get(UnavailablePred,
                                                         NewLoad));
     MD->invalidateCachedPointerInfo(LoadPtr);
+    if (MSSAU) {
+      MemoryAccess *NewAccess = MSSAU->createMemoryAccessInBB(
+          NewLoad, nullptr, UnavailablePred, MemorySSA::End);
+      MSSAU->insertUse(cast<MemoryUse>(NewAccess));
+    }
     LLVM_DEBUG(dbgs() << "GVN INSERTED " << *NewLoad << '\n');
   }
 
@@ -1284,6 +1302,190 @@ static void reportLoadElim(LoadInst *LI, Value *AvailableValue,
   });
 }
 
+/// Describe \p Clobber, the MemorySSA access clobbering the load \p L of
+/// \p Ptr, as the MemDepResult MemoryDependenceAnalysis would report for it.
+static MemDepResult getMemorySSADepResult(LoadInst *L, Value *Ptr,
+                                          MemoryAccess *Clobber,
+                                          MemorySSA &MSSA, AAResults &AA,
+                                          const TargetLibraryInfo &TLI) {
+  const DataLayout &DL = L->getModule()->getDataLayout();
+  MemoryLocation Loc = MemoryLocation::get(L).getWithNewPtr(Ptr);
+  if (MSSA.isLiveOnEntryDef(Clobber)) {
+    // Nothing has stored to a static alloca whose memory is live on entry.
+    if (auto *AI = dyn_cast<AllocaInst>(GetUnderlyingObject(Ptr, DL)))
+      if (AI->isStaticAlloca())
+        return MemDepResult::getDef(AI);
+    return MemDepResult::getNonFuncLocal();
+  }
+  if (isa<MemoryPhi>(Clobber))
+    return MemDepResult::getUnknown();
+
+  // Like MemoryDependenceAnalysis, only report a def for writes that produce
+  // the whole loaded value, and leave everything else to the clobber analysis
+  // of AnalyzeLoadAvailability.  Loads are never reported as clobbers, so
+  // MaterializeAdjustedValue never needs to widen one.
+  Instruction *DepInst = cast<MemoryDef>(Clobber)->getMemoryInst();
+  if (auto *SI = dyn_cast<StoreInst>(DepInst)) {
+    if (AA.alias(MemoryLocation::get(SI), Loc) == MustAlias)
+      return MemDepResult::getDef(DepInst);
+  } else if (isLifetimeStart(DepInst)) {
+    MemoryLocation ArgLoc =
+        MemoryLocation::getForArgument(cast<CallBase>(DepInst), 1, TLI);
+    if (AA.isMustAlias(ArgLoc, Loc))
+      return MemDepResult::getDef(DepInst);
+  } else if (isNoAliasFn(DepInst, &TLI)) {
+    if (GetUnderlyingObject(Ptr, DL) == DepInst)
+      return MemDepResult::getDef(DepInst);
+  }
+  if (isa<LoadInst>(DepInst))
+    return MemDepResult::getUnknown();
+  return MemDepResult::getClobber(DepInst);
+}
+
+/// Find a load of \p Ptr that reads the memory state \p Clobber.  If that is
+/// the state clobbering the location of \p L, the load has the value \p L
+/// would read wherever it dominates: at the end of \p BB, or, if \p BB is
+/// null, in front of \p L in its block.
+static LoadInst *findAvailableLoad(Value *Ptr, LoadInst *L,
+                                   MemoryAccess *Clobber, const BasicBlock *BB,
+                                   MemorySSA &MSSA, DominatorTree &DT) {
+  MemoryAccess *LAccess = MSSA.getMemoryAccess(L);
+  LoadInst *Best = nullptr;
+  for (User *U : Ptr->users()) {
+    auto *Cand = dyn_cast<LoadInst>(U);
+    if (!Cand || Cand == L)
+      continue;
+    auto *CandAccess = dyn_cast_or_null<MemoryUse>(MSSA.getMemoryAccess(Cand));
+    if (!CandAccess || CandAccess->getDefiningAccess() != Clobber)
+      continue;
+    if (BB ? !DT.dominates(Cand->getParent(), BB)
+           : Cand->getParent() != L->getParent() ||
+                 !MSSA.locallyDominates(CandAccess, LAccess))
+      continue;
+    // Prefer the closest load, to keep live ranges short.
+    if (!Best || DT.dominates(Best, Cand))
+      Best = Cand;
+  }
+  return Best;
+}
+
+MemoryAccess *GVN::getClobberingAccessFrom(MemoryAccess *MA,
+                                           const MemoryLocation &Loc) {
+  while (auto *Def = dyn_cast<MemoryDef>(MA)) {
+    if (MSSA->isLiveOnEntryDef(Def))
+      break;
+    // The walker answers queries starting at a call in terms of the memory
+    // that call accesses rather than Loc, so step over calls here.
+    Instruction *I = Def->getMemoryInst();
+    if (!isa<CallBase>(I))
+      return MSSA->getWalker()->getClobberingMemoryAccess(Def, Loc);
+    if (isModSet(getAliasAnalysis()->getModRefInfo(I, Loc)))
+      return Def;
+    MA = Def->getDefiningAccess();
+  }
+  return MA;
+}
+
+MemDepResult GVN::getMemorySSADependency(LoadInst *L) {
+  MemoryAccess *Clobber = MSSA->getWalker()->getClobberingMemoryAccess(L);
+  if (LoadInst *Avail = findAvailableLoad(L->getPointerOperand(), L, Clobber,
+                                          nullptr, *MSSA, *DT))
+    return MemDepResult::getDef(Avail);
+  if (isa<MemoryPhi>(Clobber) || Clobber->getBlock() != L->getParent())
+    return MemDepResult::getNonLocal();
+  return getMemorySSADepResult(L, L->getPointerOperand(), Clobber, *MSSA,
+                               *getAliasAnalysis(), *TLI);
+}
+
+bool GVN::getMemorySSANonLocalDependencies(LoadInst *L, LoadDepVect &Deps) {
+  const DataLayout &DL = L->getModule()->getDataLayout();
+  MemoryLocation Loc = MemoryLocation::get(L);
+  DomTreeNode *IDom = DT->getNode(L->getParent())->getIDom();
+  if (!IDom)
+    return false;
+
+  // A memory state reaching the load, the block at whose end that state is
+  // current, and the address of the load translated into that block.
+  struct PathState {
+    MemoryAccess *Clobber;
+    BasicBlock *BB;
+    PHITransAddr Address;
+  };
+  SmallVector<PathState, 8> Worklist;
+  DenseMap<MemoryPhi *, Value *> VisitedPhis;
+  DenseMap<BasicBlock *, std::pair<MemDepResult, Value *>> DepsByBlock;
+
+  // Record the dependency of the load in DepBB.  Paths meeting in a block
+  // must agree on it.
+  auto AddDep = [&](BasicBlock *DepBB, MemDepResult Dep, Value *Ptr) {
+    auto Inserted = DepsByBlock.insert({DepBB, {Dep, Ptr}});
+    if (!Inserted.second)
+      return Inserted.first->second == std::make_pair(Dep, Ptr);
+    Deps.push_back(NonLocalDepResult(DepBB, Dep, Ptr));
+    return Deps.size() <= MaxNumDeps;
+  };
+
+  // The clobber of the load itself is current at the end of the immediate
+  // dominator of its block, which is where a load reading it must be.
+  Worklist.push_back({MSSA->getWalker()->getClobberingMemoryAccess(L),
+                      IDom->getBlock(),
+                      PHITransAddr(L->getPointerOperand(), DL, AC)});
+  while (!Worklist.empty()) {
+    PathState S = Worklist.pop_back_val();
+    Value *Ptr = S.Address.getAddr();
+    if (LoadInst *Avail =
+            findAvailableLoad(Ptr, L, S.Clobber, S.BB, *MSSA, *DT)) {
+      if (!AddDep(Avail->getParent(), MemDepResult::getDef(Avail), Ptr))
+        return false;
+      continue;
+    }
+
+    auto *Phi = dyn_cast<MemoryPhi>(S.Clobber);
+    if (!Phi) {
+      if (!AddDep(S.Clobber->getBlock(),
+                  getMemorySSADepResult(L, Ptr, S.Clobber, *MSSA,
+                                        *getAliasAnalysis(), *TLI),
+                  Ptr))
+        return false;
+      continue;
+    }
+
+    // Each address reaching a phi must be the same.
+    auto Visited = VisitedPhis.insert({Phi, Ptr});
+    if (!Visited.second) {
+      if (Visited.first->second != Ptr)
+        return false;
+      continue;
+    }
+    if (VisitedPhis.size() > MaxNumDeps)
+      return false;
+
+    // Past the phi, the address can only be followed by phi translation, so
+    // it must not be computed below the phi's block: in a loop, that would
+    // mistake the address of an earlier iteration for the current one.
+    BasicBlock *PhiBB = Phi->getBlock();
+    if (auto *PtrInst = dyn_cast<Instruction>(Ptr))
+      if (!DT->dominates(PtrInst->getParent(), PhiBB))
+        return false;
+
+    for (unsigned I = 0, E = Phi->getNumIncomingValues(); I != E; ++I) {
+      BasicBlock *Pred = Phi->getIncomingBlock(I);
+      PHITransAddr PredAddress = S.Address;
+      if (PredAddress.PHITranslateValue(PhiBB, Pred, DT,
+                                        /*MustDominate=*/true)) {
+        if (!AddDep(Pred, MemDepResult::getUnknown(), nullptr))
+          return false;
+        continue;
+      }
+      MemoryAccess *PredClobber =
+          getClobberingAccessFrom(Phi->getIncomingValue(I),
+                                  Loc.getWithNewPtr(PredAddress.getAddr()));
+      Worklist.push_back({PredClobber, Pred, PredAddress});
+    }
+  }
+  return true;
+}
+
 /// Attempt to eliminate a load whose dependencies are
 /// non-local by performing PHI construction.
 bool GVN::processNonLocalLoad(LoadInst *LI) {
@@ -1296,7 +1498,10 @@ bool GVN::processNonLocalLoad(LoadInst *LI) {
 
   // Step 1: Find the non-local dependencies of the load.
   LoadDepVect Deps;
-  MD->getNonLocalPointerDependency(LI, Deps);
+  if (!MSSA)
+    MD->getNonLocalPointerDependency(LI, Deps);
+  else if (!getMemorySSANonLocalDependencies(LI, Deps))
+    return false;
 
   // If we had to process more than one hundred blocks to find the
   // dependencies, this load isn't worth worrying about.  Optimizing
@@ -1379,9 +1584,24 @@ bool GVN::processAssumeIntrinsic(IntrinsicInst *IntrinsicI) {
       // Insert a new store to null instruction before the load to indicate that
       // this code is not reachable.  FIXME: We could insert unreachable
       // instruction directly because we can modify the CFG.
-      new StoreInst(UndefValue::get(Int8Ty),
-                    Constant::getNullValue(Int8Ty->getPointerTo()),
-                    IntrinsicI);
+      auto *NewStore =
+          new StoreInst(UndefValue::get(Int8Ty),
+                        Constant::getNullValue(Int8Ty->getPointerTo()),
+                        IntrinsicI);
+      if (MSSAU) {
+        // The store is placed in front of the first access from the assume
+        // on, or at the end of the block if there is none.
+        MemoryUseOrDef *InsertPt = nullptr;
+        for (Instruction *I = IntrinsicI; I && !InsertPt; I = I->getNextNode())
+          InsertPt = MSSA->getMemoryAccess(I);
+        MemoryAccess *NewDef =
+            InsertPt ? MSSAU->createMemoryAccessBefore(NewStore, nullptr,
+                                                       InsertPt)
+                     : MSSAU->createMemoryAccessInBB(
+                           NewStore, nullptr, NewStore->getParent(),
+                           MemorySSA::End);
+        MSSAU->insertDef(cast<MemoryDef>(NewDef));
+      }
     }
     markInstructionForDeletion(IntrinsicI);
     return false;
@@ -1452,7 +1672,7 @@ bool GVN::processLoad(LoadInst *L) {
   }
 
   // ... to a pointer that has been loaded from before...
-  MemDepResult Dep = MD->getDependency(L);
+  MemDepResult Dep = MSSA ? getMemorySSADependency(L) : MD->getDependency(L);
 
   // If it is defined in another block, try harder.
   if (Dep.isNonLocal())
@@ -1970,7 +2190,7 @@ bool GVN::processInstruction(Instruction *I) {
 bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
                   const TargetLibraryInfo &RunTLI, AAResults &RunAA,
                   MemoryDependenceResults *RunMD, LoopInfo *LI,
-                  OptimizationRemarkEmitter *RunORE) {
+                  OptimizationRemarkEmitter *RunORE, MemorySSA *RunMSSA) {
   AC = &RunAC;
   DT = &RunDT;
   VN.setDomTree(DT);
@@ -1982,6 +2202,11 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   this->LI = LI;
   VN.setMemDep(MD);
   ORE = RunORE;
+  MSSA = RunMSSA;
+  std::unique_ptr<MemorySSAUpdater> Updater;
+  if (MSSA)
+    Updater = std::make_unique<MemorySSAUpdater>(MSSA);
+  MSSAU = Updater.get();
   InvalidBlockRPONumbers = true;
 
   bool Changed = false;
@@ -1993,7 +2218,7 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   for (Function::iterator FI = F.begin(), FE = F.end(); FI != FE; ) {
     BasicBlock *BB = &*FI++;
 
-    bool removedBlock = MergeBlockIntoPredecessor(BB, &DTU, LI, nullptr, MD);
+    bool removedBlock = MergeBlockIntoPredecessor(BB, &DTU, LI, MSSAU, MD);
     if (removedBlock)
       ++NumGVNBlocks;
 
@@ -2068,6 +2293,8 @@ bool GVN::processBlock(BasicBlock *BB) {
       LLVM_DEBUG(dbgs() << "GVN removed: " << *I << '\n');
       salvageDebugInfo(*I);
       if (MD) MD->removeInstruction(I);
+      if (MSSAU)
+        MSSAU->removeMemoryAccess(I);
       LLVM_DEBUG(verifyRemoved(I));
       ICF->removeInstruction(I);
       I->eraseFromParent();
@@ -2338,8 +2565,8 @@ bool GVN::performPRE(Function &F) {
 /// Split the critical edge connecting the given two blocks, and return
 /// the block inserted to the critical edge.
 BasicBlock *GVN::splitCriticalEdges(BasicBlock *Pred, BasicBlock *Succ) {
-  BasicBlock *BB =
-      SplitCriticalEdge(Pred, Succ, CriticalEdgeSplittingOptions(DT, LI));
+  BasicBlock *BB = SplitCriticalEdge(
+      Pred, Succ, CriticalEdgeSplittingOptions(DT, LI, MSSAU));
   if (MD)
     MD->invalidateCachedPredecessors();
   InvalidBlockRPONumbers = true;
@@ -2354,7 +2581,7 @@ bool GVN::splitCriticalEdges() {
   do {
     std::pair<Instruction *, unsigned> Edge = toSplit.pop_back_val();
     SplitCriticalEdge(Edge.first, Edge.second,
-                      CriticalEdgeSplittingOptions(DT, LI));
+                      CriticalEdgeSplittingOptions(DT, LI, MSSAU));
   } while (!toSplit.empty());
   if (MD) MD->invalidateCachedPredecessors();
   InvalidBlockRPONumbers = true;
@@ -2561,7 +2788,9 @@ public:
         NoMemDepAnalysis ? nullptr
                 : &getAnalysis<MemoryDependenceWrapperPass>().getMemDep(),
         LIWP ? &LIWP->getLoopInfo() : nullptr,
-        &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE());
+        &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE(),
+        EnableMemorySSA ? &getAnalysis<MemorySSAWrapperPass>().getMSSA()
+                        : nullptr);
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
@@ -2572,6 +2801,10 @@ public:
     if (!NoMemDepAnalysis)
       AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
+    if (EnableMemorySSA) {
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+    }
 
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
@@ -2591,6 +2824,7 @@ char GVNLegacyPass::ID = 0;
 INITIALIZE_PASS_BEGIN(GVNLegacyPass, "gvn", "Global Value Numbering", false, false)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
@@ -8,6 +8,17 @@
 //
 // This file implements a Loop Data Prefetching Pass.
 //
+// Without a profile, every strided access of an inner-most loop is prefetched
+// a target-defined distance ahead. With -loop-prefetch-miss-profile, only the
+// accesses the profile marks as missing the cache are prefetched, at a
+// distance derived from their measured latency. The profile is encoded in afdo
+// format (text or binary), as collected from load latency samples (e.g. PEBS
+// or SPE). The body samples of a location count the cache misses sampled for
+// the loads at that location, and its optional "__latency" call target
+// records their average latency in cycles. Missing loads whose address is
+// computed from a strided load, such as lookups through an array of indices
+// or pointers, are prefetched by loading that index ahead of time.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Scalar/LoopDataPrefetch.h"
@@ -23,16 +34,22 @@
 #include "llvm/Analysis/ScalarEvolutionExpander.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
+#include "llvm/ProfileData/SampleProf.h"
+#include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 using namespace llvm;
+using namespace sampleprof;
 
 // By default, we limit this to creating 16 PHIs (which is a little over half
 // of the allocatable register set).
@@ -53,7 +70,31 @@ static cl::opt<unsigned> MaxPrefetchIterationsAhead(
     "max-prefetch-iters-ahead",
     cl::desc("Max number of iterations to prefetch ahead"), cl::Hidden);
 
+static cl::opt<std::string> MissProfileFile(
+    "loop-prefetch-miss-profile",
+    cl::desc("Path to the cache miss profile selecting the accesses to "
+             "prefetch"),
+    cl::Hidden);
+
+static cl::opt<unsigned> MinPrefetchMisses(
+    "min-prefetch-misses", cl::init(1),
+    cl::desc("Min number of profiled cache misses to prefetch an access"),
+    cl::Hidden);
+
+static cl::opt<unsigned> MissLatency(
+    "prefetch-miss-latency", cl::init(200),
+    cl::desc("Latency in cycles of the profiled cache misses that don't "
+             "record one, if the target doesn't set a prefetch distance"),
+    cl::Hidden);
+
+static cl::opt<unsigned> MaxIndirectPrefetchInsts(
+    "max-indirect-prefetch-insts", cl::init(16),
+    cl::desc("Max number of instructions to duplicate to compute the address "
+             "of an indirect prefetch"),
+    cl::Hidden);
+
 STATISTIC(NumPrefetches, "Number of prefetches inserted");
+STATISTIC(NumIndirectPrefetches, "Number of indirect prefetches inserted");
 
 namespace {
 
@@ -62,14 +103,46 @@ class LoopDataPrefetch {
 public:
   LoopDataPrefetch(AssumptionCache *AC, LoopInfo *LI, ScalarEvolution *SE,
                    const TargetTransformInfo *TTI,
-                   OptimizationRemarkEmitter *ORE)
-      : AC(AC), LI(LI), SE(SE), TTI(TTI), ORE(ORE) {}
+                   OptimizationRemarkEmitter *ORE,
+                   const FunctionSamples *Samples = nullptr)
+      : AC(AC), LI(LI), SE(SE), TTI(TTI), ORE(ORE), Samples(Samples) {}
 
   bool run();
 
 private:
+  /// A missing load whose address is computed from a strided load, the index.
+  struct IndirectPrefetch {
+    LoadInst *MemI;
+    LoadInst *IndexLoad;
+    /// The instructions computing the address of MemI from IndexLoad, in
+    /// def-use order.
+    SmallVector<Instruction *, 8> Chain;
+    /// The address of the index ItersAhead iterations ahead.
+    const SCEV *NextIndexPtr;
+  };
+
   bool runOnLoop(Loop *L);
 
+  /// Return the number of iterations ahead to prefetch \p MemI, or 0 if it
+  /// shouldn't be prefetched.
+  unsigned getItersAhead(Instruction *MemI, unsigned LoopSize,
+                         unsigned MaxItersAhead);
+
+  /// Find the strided load of \p L that the address \p V is computed from,
+  /// through speculatable instructions of \p L and loop invariants only.
+  /// These instructions are added to \p Chain in def-use order.
+  bool collectIndirectAddress(Loop *L, Value *V, LoadInst *&IndexLoad,
+                              SmallPtrSetImpl<Instruction *> &Visited,
+                              SmallVectorImpl<Instruction *> &Chain);
+
+  /// Check if \p MemI can be prefetched \p ItersAhead iterations ahead by
+  /// loading its index that far ahead, and fill in \p P if so.
+  bool analyzeIndirectPrefetch(Loop *L, LoadInst *MemI, unsigned ItersAhead,
+                               IndirectPrefetch &P);
+
+  /// Insert the prefetch of \p PrefPtrValue before \p MemI.
+  void insertPrefetch(Instruction *MemI, Value *PrefPtrValue);
+
   /// Check if the stride of the accesses is large enough to
   /// warrant a prefetch.
   bool isStrideLargeEnough(const SCEVAddRecExpr *AR);
@@ -92,11 +165,20 @@ private:
     return TTI->getMaxPrefetchIterationsAhead();
   }
 
+  unsigned getCacheLineSize() {
+    if (unsigned CacheLineSize = TTI->getCacheLineSize())
+      return CacheLineSize;
+    // Targets only need to set it to prefetch without a miss profile.
+    return 64;
+  }
+
   AssumptionCache *AC;
   LoopInfo *LI;
   ScalarEvolution *SE;
   const TargetTransformInfo *TTI;
   OptimizationRemarkEmitter *ORE;
+  /// The cache miss profile of the function, if there is one.
+  const FunctionSamples *Samples;
 };
 
 /// Legacy class for inserting loop data prefetches.
@@ -118,8 +200,12 @@ public:
     AU.addRequired<TargetTransformInfoWrapperPass>();
   }
 
+  bool doInitialization(Module &M) override;
   bool runOnFunction(Function &F) override;
-  };
+
+private:
+  std::unique_ptr<SampleProfileReader> Reader;
+};
 }
 
 char LoopDataPrefetchLegacyPass::ID = 0;
@@ -137,6 +223,29 @@ FunctionPass *llvm::createLoopDataPrefetchPass() {
   return new LoopDataPrefetchLegacyPass();
 }
 
+/// Read the profile given by -loop-prefetch-miss-profile, if any.
+static std::unique_ptr<SampleProfileReader> readMissProfile(LLVMContext &Ctx) {
+  if (MissProfileFile.empty())
+    return nullptr;
+
+  ErrorOr<std::unique_ptr<SampleProfileReader>> ReaderOrErr =
+      SampleProfileReader::create(MissProfileFile, Ctx);
+  if (std::error_code EC = ReaderOrErr.getError()) {
+    std::string Msg = "Could not open profile: " + EC.message();
+    Ctx.diagnose(DiagnosticInfoSampleProfile(MissProfileFile, Msg,
+                                             DiagnosticSeverity::DS_Warning));
+    return nullptr;
+  }
+  std::unique_ptr<SampleProfileReader> Reader = std::move(ReaderOrErr.get());
+  if (std::error_code EC = Reader->read()) {
+    std::string Msg = "Could not read profile: " + EC.message();
+    Ctx.diagnose(DiagnosticInfoSampleProfile(MissProfileFile, Msg,
+                                             DiagnosticSeverity::DS_Warning));
+    return nullptr;
+  }
+  return Reader;
+}
+
 bool LoopDataPrefetch::isStrideLargeEnough(const SCEVAddRecExpr *AR) {
   unsigned TargetMinStride = getMinPrefetchStride();
   // No need to check if any stride goes.
@@ -162,7 +271,16 @@ PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
       &AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
   const TargetTransformInfo *TTI = &AM.getResult<TargetIRAnalysis>(F);
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  if (!Reader && !MissProfileFile.empty())
+    Reader = readMissProfile(F.getContext());
+  const FunctionSamples *Samples = nullptr;
+  if (Reader) {
+    Samples = Reader->getSamplesFor(F);
+    if (!Samples)
+      return PreservedAnalyses::all();
+  }
+
+  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE, Samples);
   bool Changed = LDP.run();
 
   if (Changed) {
@@ -175,10 +293,22 @@ PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
   return PreservedAnalyses::all();
 }
 
+bool LoopDataPrefetchLegacyPass::doInitialization(Module &M) {
+  Reader = readMissProfile(M.getContext());
+  return false;
+}
+
 bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   if (skipFunction(F))
     return false;
 
+  const FunctionSamples *Samples = nullptr;
+  if (Reader) {
+    Samples = Reader->getSamplesFor(F);
+    if (!Samples)
+      return false;
+  }
+
   LoopInfo *LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
   ScalarEvolution *SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
   AssumptionCache *AC =
@@ -188,17 +318,18 @@ bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   const TargetTransformInfo *TTI =
       &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE, Samples);
   return LDP.run();
 }
 
 bool LoopDataPrefetch::run() {
-  // If PrefetchDistance is not set, don't run the pass.  This gives an
-  // opportunity for targets to run this pass for selected subtargets only
-  // (whose TTI sets PrefetchDistance).
-  if (getPrefetchDistance() == 0)
+  // If PrefetchDistance is not set, don't run the pass unless there is a miss
+  // profile.  This gives an opportunity for targets to run this pass for
+  // selected subtargets only (whose TTI sets PrefetchDistance).
+  if (!Samples && getPrefetchDistance() == 0)
     return false;
-  assert(TTI->getCacheLineSize() && "Cache line size is not set for target");
+  assert((Samples || TTI->getCacheLineSize()) &&
+         "Cache line size is not set for target");
 
   bool MadeChange = false;
 
@@ -209,6 +340,121 @@ bool LoopDataPrefetch::run() {
   return MadeChange;
 }
 
+unsigned LoopDataPrefetch::getItersAhead(Instruction *MemI, unsigned LoopSize,
+                                         unsigned MaxItersAhead) {
+  unsigned Latency = getPrefetchDistance();
+  if (Samples) {
+    // Only prefetch the accesses that miss the cache often enough.
+    const DILocation *Loc = MemI->getDebugLoc();
+    if (!Loc)
+      return 0;
+    const FunctionSamples *LocSamples = Samples->findFunctionSamples(Loc);
+    if (!LocSamples)
+      return 0;
+    unsigned Offset = FunctionSamples::getOffset(Loc);
+    unsigned Discriminator = Loc->getBaseDiscriminator();
+    ErrorOr<uint64_t> Misses = LocSamples->findSamplesAt(Offset, Discriminator);
+    if (!Misses || *Misses < MinPrefetchMisses)
+      return 0;
+
+    if (!Latency)
+      Latency = MissLatency;
+    ErrorOr<SampleRecord::CallTargetMap> Targets =
+        LocSamples->findCallTargetMapAt(Offset, Discriminator);
+    if (Targets) {
+      auto It = Targets->find("__latency");
+      if (It != Targets->end())
+        Latency = It->second;
+    }
+  }
+
+  // Assume one instruction per cycle to cover the latency.
+  unsigned ItersAhead = Latency / LoopSize;
+  if (!ItersAhead)
+    ItersAhead = 1;
+
+  if (ItersAhead > MaxItersAhead)
+    return 0;
+  return ItersAhead;
+}
+
+bool LoopDataPrefetch::collectIndirectAddress(
+    Loop *L, Value *V, LoadInst *&IndexLoad,
+    SmallPtrSetImpl<Instruction *> &Visited,
+    SmallVectorImpl<Instruction *> &Chain) {
+  auto *I = dyn_cast<Instruction>(V);
+  if (!I || !L->contains(I) || !Visited.insert(I).second)
+    return true;
+
+  if (auto *Load = dyn_cast<LoadInst>(I)) {
+    if (IndexLoad || !Load->isSimple())
+      return false;
+    // The index is loaded ahead of time, which is only safe if the loop is
+    // going to load it anyway.
+    auto *IndexAddRec =
+        dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Load->getPointerOperand()));
+    if (!IndexAddRec || IndexAddRec->getLoop() != L ||
+        !IndexAddRec->isAffine() ||
+        !isGuaranteedToExecuteForEveryIteration(Load, L))
+      return false;
+    IndexLoad = Load;
+    return true;
+  }
+
+  // The address must not depend on the current iteration other than through
+  // the index.
+  if (isa<PHINode>(I) || !isSafeToSpeculativelyExecute(I) ||
+      Chain.size() >= MaxIndirectPrefetchInsts)
+    return false;
+  for (Value *Op : I->operands())
+    if (!collectIndirectAddress(L, Op, IndexLoad, Visited, Chain))
+      return false;
+  Chain.push_back(I);
+  return true;
+}
+
+bool LoopDataPrefetch::analyzeIndirectPrefetch(Loop *L, LoadInst *MemI,
+                                               unsigned ItersAhead,
+                                               IndirectPrefetch &P) {
+  SmallPtrSet<Instruction *, 8> Visited;
+  P.MemI = MemI;
+  P.IndexLoad = nullptr;
+  P.Chain.clear();
+  if (!collectIndirectAddress(L, MemI->getPointerOperand(), P.IndexLoad,
+                              Visited, P.Chain) ||
+      !P.IndexLoad)
+    return false;
+
+  // Don't load the index past the last iteration: load the one of iteration
+  // umin(i + ItersAhead, BackedgeTakenCount) instead.
+  const SCEV *BackedgeTakenCount = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BackedgeTakenCount))
+    return false;
+  Type *IterTy = BackedgeTakenCount->getType();
+  const SCEV *NextIter = SE->getUMinExpr(
+      SE->getAddRecExpr(SE->getConstant(IterTy, ItersAhead),
+                        SE->getOne(IterTy), L, SCEV::FlagAnyWrap),
+      BackedgeTakenCount);
+  const auto *IndexAddRec =
+      cast<SCEVAddRecExpr>(SE->getSCEV(P.IndexLoad->getPointerOperand()));
+  P.NextIndexPtr = IndexAddRec->evaluateAtIteration(NextIter, *SE);
+  return isSafeToExpand(P.NextIndexPtr, *SE);
+}
+
+void LoopDataPrefetch::insertPrefetch(Instruction *MemI, Value *PrefPtrValue) {
+  IRBuilder<> Builder(MemI);
+  Module *M = MemI->getModule();
+  Type *I32 = Type::getInt32Ty(MemI->getContext());
+  Function *PrefetchFunc = Intrinsic::getDeclaration(
+      M, Intrinsic::prefetch, PrefPtrValue->getType());
+  Builder.CreateCall(
+      PrefetchFunc,
+      {PrefPtrValue,
+       ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
+       ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
+  ++NumPrefetches;
+}
+
 bool LoopDataPrefetch::runOnLoop(Loop *L) {
   bool MadeChange = false;
 
@@ -236,17 +482,46 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
   if (!LoopSize)
     LoopSize = 1;
 
-  unsigned ItersAhead = getPrefetchDistance() / LoopSize;
-  if (!ItersAhead)
-    ItersAhead = 1;
-
-  if (ItersAhead > getMaxPrefetchIterationsAhead())
+  unsigned MaxItersAhead = getMaxPrefetchIterationsAhead();
+  // With a miss profile, don't prefetch past the last iteration of the loop.
+  if (Samples)
+    if (unsigned TripCount = SE->getSmallConstantMaxTripCount(L))
+      MaxItersAhead = std::min(MaxItersAhead, TripCount - 1);
+  if (!MaxItersAhead)
     return MadeChange;
 
-  LLVM_DEBUG(dbgs() << "Prefetching " << ItersAhead
-                    << " iterations ahead (loop size: " << LoopSize << ") in "
+  LLVM_DEBUG(dbgs() << "Prefetching (loop size: " << LoopSize << ") in "
                     << L->getHeader()->getParent()->getName() << ": " << *L);
 
+  // Find the missing loads to prefetch through their index. The index itself
+  // is prefetched twice as far ahead, so that it is in the cache by the time
+  // it is loaded ahead of the loop.
+  SmallVector<IndirectPrefetch, 4> IndirectPrefetches;
+  SmallDenseMap<Instruction *, unsigned, 4> IndexItersAhead;
+  if (Samples) {
+    for (const auto BB : L->blocks()) {
+      for (auto &I : *BB) {
+        LoadInst *LMemI = dyn_cast<LoadInst>(&I);
+        if (!LMemI || LMemI->getPointerAddressSpace() ||
+            L->isLoopInvariant(LMemI->getPointerOperand()) ||
+            isa<SCEVAddRecExpr>(SE->getSCEV(LMemI->getPointerOperand())))
+          continue;
+
+        unsigned ItersAhead = getItersAhead(LMemI, LoopSize, MaxItersAhead);
+        if (!ItersAhead)
+          continue;
+        IndirectPrefetch P;
+        if (!analyzeIndirectPrefetch(L, LMemI, ItersAhead, P))
+          continue;
+        if (2 * ItersAhead <= MaxItersAhead) {
+          unsigned &IndexIters = IndexItersAhead[P.IndexLoad];
+          IndexIters = std::max(IndexIters, 2 * ItersAhead);
+        }
+        IndirectPrefetches.push_back(std::move(P));
+      }
+    }
+  }
+
   SmallVector<std::pair<Instruction *, const SCEVAddRecExpr *>, 16> PrefLoads;
   for (const auto BB : L->blocks()) {
     for (auto &I : *BB) {
@@ -274,6 +549,12 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       if (!LSCEVAddRec)
         continue;
 
+      unsigned ItersAhead =
+          std::max(IndexItersAhead.lookup(MemI),
+                   getItersAhead(MemI, LoopSize, MaxItersAhead));
+      if (!ItersAhead)
+        continue;
+
       // Check if the stride of the accesses is large enough to warrant a
       // prefetch.
       if (!isStrideLargeEnough(LSCEVAddRec))
@@ -288,7 +569,7 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
         if (const SCEVConstant *ConstPtrDiff =
             dyn_cast<SCEVConstant>(PtrDiff)) {
           int64_t PD = std::abs(ConstPtrDiff->getValue()->getSExtValue());
-          if (PD < (int64_t) TTI->getCacheLineSize()) {
+          if (PD < (int64_t) getCacheLineSize()) {
             DupPref = true;
             break;
           }
@@ -308,20 +589,9 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       Type *I8Ptr = Type::getInt8PtrTy(BB->getContext(), PtrAddrSpace);
       SCEVExpander SCEVE(*SE, I.getModule()->getDataLayout(), "prefaddr");
       Value *PrefPtrValue = SCEVE.expandCodeFor(NextLSCEV, I8Ptr, MemI);
-
-      IRBuilder<> Builder(MemI);
-      Module *M = BB->getParent()->getParent();
-      Type *I32 = Type::getInt32Ty(BB->getContext());
-      Function *PrefetchFunc = Intrinsic::getDeclaration(
-          M, Intrinsic::prefetch, PrefPtrValue->getType());
-      Builder.CreateCall(
-          PrefetchFunc,
-          {PrefPtrValue,
-           ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
-           ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
-      ++NumPrefetches;
+      insertPrefetch(MemI, PrefPtrValue);
       LLVM_DEBUG(dbgs() << "  Access: " << *PtrValue << ", SCEV: " << *LSCEV
-                        << "\n");
+                        << ", " << ItersAhead << " iterations ahead\n");
       ORE->emit([&]() {
         return OptimizationRemark(DEBUG_TYPE, "Prefetched", MemI)
                << "prefetched memory access";
@@ -331,5 +601,44 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
     }
   }
 
+  for (IndirectPrefetch &P : IndirectPrefetches) {
+    LoadInst *MemI = P.MemI;
+    SCEVExpander SCEVE(*SE, MemI->getModule()->getDataLayout(), "prefaddr");
+    Value *NextIndexPtr = SCEVE.expandCodeFor(
+        P.NextIndexPtr, P.IndexLoad->getPointerOperandType(), MemI);
+
+    // Compute the address of MemI from the index loaded ahead of time.
+    IRBuilder<> Builder(MemI);
+    Value *PrefPtrValue =
+        Builder.CreateAlignedLoad(P.IndexLoad->getType(), NextIndexPtr,
+                                  P.IndexLoad->getAlignment(), "prefidx");
+    ValueToValueMapTy VMap;
+    VMap[P.IndexLoad] = PrefPtrValue;
+    for (Instruction *I : P.Chain) {
+      Instruction *Clone = I->clone();
+      // The flags and metadata of I only hold for the addresses the loop
+      // accesses.
+      Clone->dropPoisonGeneratingFlags();
+      Clone->dropUnknownNonDebugMetadata();
+      Builder.Insert(Clone, I->getName() + ".pref");
+      RemapInstruction(Clone, VMap,
+                       RF_NoModuleLevelChanges | RF_IgnoreMissingLocals);
+      VMap[I] = Clone;
+      PrefPtrValue = Clone;
+    }
+
+    Type *I8Ptr = Type::getInt8PtrTy(MemI->getContext());
+    insertPrefetch(MemI, Builder.CreateBitCast(PrefPtrValue, I8Ptr));
+    ++NumIndirectPrefetches;
+    LLVM_DEBUG(dbgs() << "  Indirect access: " << *MemI->getPointerOperand()
+                      << ", index: " << *P.IndexLoad << "\n");
+    ORE->emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "PrefetchedIndirect", MemI)
+             << "prefetched indirect memory access";
+    });
+
+    MadeChange = true;
+  }
+
   return MadeChange;
 }
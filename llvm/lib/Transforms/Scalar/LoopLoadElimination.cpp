@@ -712,6 +712,10 @@ PreservedAnalyses LoopLoadEliminationPass::run(Function &F,
   if (!Changed)
     return PreservedAnalyses::all();
 
+  // Loop versioning keeps the loop info and dominator tree up to date.
   PreservedAnalyses PA;
+  PA.preserve<LoopAnalysis>();
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<GlobalsAA>();
   return PA;
 }
@@ -0,0 +1,484 @@
+//===- LoopTiling.cpp - Loop tiling pass ----------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass tiles perfect two-deep loop nests of the form
+//
+//   for (i = ...)
+//     for (j = lb; j < ub; ++j)
+//       body(i, j);
+//
+// into
+//
+//   for (jj = lb; jj != ub; jj += len)
+//     for (i = ...)
+//       for (j = jj; j < jj + len; ++j)    // len = min(ub - jj, TileSize)
+//         body(i, j);
+//
+// The data touched by one tile of the inner loop is then reused by all the
+// iterations of the outer loop while it is still in cache. The transformation
+// is the combination of strip-mining the inner loop and interchanging the
+// resulting tile loop with the outer loop, so it is legal if no dependence
+// carried by the outer loop goes backwards in the inner loop.
+//
+// LoopCacheAnalysis decides whether the nest benefits from tiling, and the
+// tile size is derived from the cache line size and the L1 data cache size
+// reported by TargetTransformInfo.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopCacheAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-tile"
+
+STATISTIC(NumLoopNestsTiled, "Number of loop nests tiled");
+
+static cl::opt<unsigned> ForcedTileSize(
+    "loop-tile-size", cl::init(0), cl::Hidden,
+    cl::desc("Tile the inner loop by this number of iterations instead of "
+             "deriving a tile size from the target's cache parameters. This "
+             "also bypasses the cache cost profitability check"));
+
+static cl::opt<unsigned> TileCacheSize(
+    "loop-tile-cache-size", cl::init(0), cl::Hidden,
+    cl::desc("Size in bytes of the data cache to tile for (default = the "
+             "target's L1 data cache size)"));
+
+static cl::opt<unsigned> MaxMemInstrs(
+    "loop-tile-max-mem-instrs", cl::init(64), cl::Hidden,
+    cl::desc("Maximum number of memory accesses in a loop nest considered "
+             "for tiling"));
+
+namespace {
+
+/// A perfect loop nest that has the shape required for tiling.
+struct TileCandidate {
+  Loop *Outer = nullptr;
+  Loop *Inner = nullptr;
+  /// The induction variable of the inner loop.
+  PHINode *IndVar = nullptr;
+  /// The latch compare of the inner loop and the operand index of its bound.
+  ICmpInst *LatchCmp = nullptr;
+  unsigned BoundIdx = 0;
+  /// The start and end values of the inner induction variable. They are
+  /// invariant in the outer loop.
+  Value *Start = nullptr;
+  Value *End = nullptr;
+  /// The memory accesses of the nest, all in the inner loop.
+  SmallVector<Instruction *, 16> MemInstrs;
+};
+
+class LoopTiler {
+public:
+  LoopTiler(LoopInfo &LI, DominatorTree &DT, ScalarEvolution &SE,
+            DependenceInfo &DI, AliasAnalysis &AA, TargetTransformInfo &TTI,
+            OptimizationRemarkEmitter &ORE)
+      : LI(LI), DT(DT), SE(SE), DI(DI), AA(AA), TTI(TTI), ORE(ORE) {}
+
+  bool run() {
+    bool Changed = false;
+    // Tiling replaces top-level loops, so iterate over a copy.
+    SmallVector<Loop *, 8> TopLevelLoops(LI.begin(), LI.end());
+    for (Loop *L : TopLevelLoops) {
+      TileCandidate C;
+      if (!analyzeNest(*L, C) || !isLegal(C))
+        continue;
+      unsigned TileSize = chooseTileSize(C);
+      if (!TileSize)
+        continue;
+      tile(C, TileSize);
+      Changed = true;
+    }
+    return Changed;
+  }
+
+private:
+  bool analyzeNest(Loop &Outer, TileCandidate &C);
+  bool isLegal(const TileCandidate &C);
+  unsigned chooseTileSize(const TileCandidate &C);
+  void tile(TileCandidate &C, unsigned TileSize);
+
+  LoopInfo &LI;
+  DominatorTree &DT;
+  ScalarEvolution &SE;
+  DependenceInfo &DI;
+  AliasAnalysis &AA;
+  TargetTransformInfo &TTI;
+  OptimizationRemarkEmitter &ORE;
+};
+
+} // end anonymous namespace
+
+/// Return true if \p L is in the canonical form that the transformation relies
+/// on: simplified, in LCSSA form, exiting only from its latch, and with a
+/// single header PHI.
+static bool hasTileableShape(Loop &L, DominatorTree &DT) {
+  if (!L.isLoopSimplifyForm() || !L.isLCSSAForm(DT))
+    return false;
+  if (!L.getExitBlock() || L.getExitingBlock() != L.getLoopLatch())
+    return false;
+  auto PHIs = L.getHeader()->phis();
+  return std::distance(PHIs.begin(), PHIs.end()) == 1;
+}
+
+bool LoopTiler::analyzeNest(Loop &Outer, TileCandidate &C) {
+  if (Outer.getSubLoops().size() != 1)
+    return false;
+  Loop *Inner = Outer.getSubLoops().front();
+  if (!Inner->getSubLoops().empty())
+    return false;
+
+  if (!hasTileableShape(Outer, DT) || !hasTileableShape(*Inner, DT)) {
+    LLVM_DEBUG(dbgs() << "LoopTiling: Loop nest is not in canonical form\n");
+    return false;
+  }
+
+  // The only PHI of the outer loop must be its induction variable. Any other
+  // recurrence would be restarted by every tile.
+  PHINode *OuterIndVar = Outer.getInductionVariable(SE);
+  if (!OuterIndVar || &*Outer.getHeader()->phis().begin() != OuterIndVar)
+    return false;
+
+  // Values of the inner loop must not flow into the rest of the outer loop,
+  // and no value of the nest may be used after it: after tiling the nest runs
+  // once per tile and those values would only reflect the last tile.
+  if (!empty(Inner->getExitBlock()->phis()) ||
+      !empty(Outer.getExitBlock()->phis()))
+    return false;
+  for (BasicBlock *BB : Outer.blocks())
+    for (Instruction &I : *BB) {
+      for (User *U : I.users())
+        if (!Outer.contains(cast<Instruction>(U)))
+          return false;
+      if (I.mayReadOrWriteMemory() || I.mayHaveSideEffects()) {
+        // The nest must be perfect.
+        if (!Inner->contains(BB))
+          return false;
+        if (auto *Ld = dyn_cast<LoadInst>(&I)) {
+          if (!Ld->isSimple())
+            return false;
+        } else if (auto *St = dyn_cast<StoreInst>(&I)) {
+          if (!St->isSimple())
+            return false;
+        } else {
+          return false;
+        }
+        C.MemInstrs.push_back(&I);
+      }
+    }
+  if (C.MemInstrs.empty() || C.MemInstrs.size() > MaxMemInstrs)
+    return false;
+
+  PHINode *IndVar = Inner->getInductionVariable(SE);
+  Optional<Loop::LoopBounds> Bounds = Inner->getBounds(SE);
+  if (!IndVar || !Bounds)
+    return false;
+  auto *Step = dyn_cast_or_null<ConstantInt>(Bounds->getStepValue());
+  if (!Step || !Step->isOne())
+    return false;
+  ICmpInst::Predicate Pred = Bounds->getCanonicalPredicate();
+  if (Pred != ICmpInst::ICMP_NE && Pred != ICmpInst::ICMP_ULT &&
+      Pred != ICmpInst::ICMP_SLT)
+    return false;
+
+  // The latch compare has to test the incremented induction variable against
+  // the bound, which is the operand that gets rewritten to the tile bound.
+  auto *LatchBr = cast<BranchInst>(Inner->getLoopLatch()->getTerminator());
+  auto *LatchCmp = dyn_cast<ICmpInst>(LatchBr->getCondition());
+  if (!LatchCmp)
+    return false;
+  Value *Start = &Bounds->getInitialIVValue();
+  Value *End = &Bounds->getFinalIVValue();
+  unsigned BoundIdx;
+  if (LatchCmp->getOperand(0) == &Bounds->getStepInst() &&
+      LatchCmp->getOperand(1) == End)
+    BoundIdx = 1;
+  else if (LatchCmp->getOperand(1) == &Bounds->getStepInst() &&
+           LatchCmp->getOperand(0) == End)
+    BoundIdx = 0;
+  else
+    return false;
+
+  if (!Outer.isLoopInvariant(Start) || !Outer.isLoopInvariant(End))
+    return false;
+
+  // Every tile runs at least one iteration of the inner loop, so the inner
+  // loop must not be able to run zero times.
+  const SCEV *StartS = SE.getSCEV(Start);
+  const SCEV *EndS = SE.getSCEV(End);
+  bool NonEmpty =
+      Pred == ICmpInst::ICMP_NE
+          ? SE.isKnownPredicate(ICmpInst::ICMP_ULT, StartS, EndS) ||
+                SE.isKnownPredicate(ICmpInst::ICMP_SLT, StartS, EndS)
+          : SE.isKnownPredicate(Pred, StartS, EndS);
+  if (!NonEmpty) {
+    LLVM_DEBUG(dbgs() << "LoopTiling: Cannot prove that the inner loop runs "
+                         "at least once\n");
+    return false;
+  }
+
+  C.Outer = &Outer;
+  C.Inner = Inner;
+  C.IndVar = IndVar;
+  C.LatchCmp = LatchCmp;
+  C.BoundIdx = BoundIdx;
+  C.Start = Start;
+  C.End = End;
+  return true;
+}
+
+bool LoopTiler::isLegal(const TileCandidate &C) {
+  // Tiling moves the tile loop of the inner loop outside the outer loop. This
+  // reverses a dependence exactly when it is carried forward by one loop and
+  // backward by the other.
+  for (unsigned I = 0, E = C.MemInstrs.size(); I != E; ++I)
+    for (unsigned J = I; J != E; ++J) {
+      Instruction *Src = C.MemInstrs[I];
+      Instruction *Dst = C.MemInstrs[J];
+      if (isa<LoadInst>(Src) && isa<LoadInst>(Dst))
+        continue;
+      auto D = DI.depends(Src, Dst, true);
+      if (!D)
+        continue;
+      if (D->isConfused() || D->getLevels() < 2) {
+        LLVM_DEBUG(dbgs() << "LoopTiling: Unknown dependence between "
+                          << *Src << " and " << *Dst << "\n");
+        return false;
+      }
+      unsigned OuterDir = D->getDirection(1);
+      unsigned InnerDir = D->getDirection(2);
+      if (((OuterDir & Dependence::DVEntry::LT) &&
+           (InnerDir & Dependence::DVEntry::GT)) ||
+          ((OuterDir & Dependence::DVEntry::GT) &&
+           (InnerDir & Dependence::DVEntry::LT))) {
+        LLVM_DEBUG(dbgs() << "LoopTiling: Tiling would reverse the dependence "
+                             "between "
+                          << *Src << " and " << *Dst << "\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+unsigned LoopTiler::chooseTileSize(const TileCandidate &C) {
+  unsigned TileSize = ForcedTileSize;
+  if (!TileSize) {
+    unsigned CLS = TTI.getCacheLineSize();
+    Optional<unsigned> CacheSize =
+        TileCacheSize ? Optional<unsigned>(TileCacheSize)
+                      : TTI.getCacheSize(TargetTransformInfo::CacheLevel::L1D);
+    if (!CLS || !CacheSize) {
+      LLVM_DEBUG(dbgs() << "LoopTiling: Target has no cache information\n");
+      return 0;
+    }
+
+    // If the inner loop is the one that uses the fewest cache lines when
+    // innermost, the nest already accesses memory (close to) contiguously and
+    // tiling only adds overhead.
+    LoopVectorTy Loops = {C.Outer, C.Inner};
+    CacheCost CC(Loops, LI, SE, TTI, AA, DI);
+    CacheCostTy OuterCost = CC.getLoopCost(*C.Outer);
+    CacheCostTy InnerCost = CC.getLoopCost(*C.Inner);
+    LLVM_DEBUG(dbgs() << "LoopTiling: Cache cost of outer loop " << OuterCost
+                      << ", inner loop " << InnerCost << "\n");
+    if (OuterCost == CacheCost::InvalidCost ||
+        InnerCost == CacheCost::InvalidCost || InnerCost < OuterCost)
+      return 0;
+
+    // In the worst case every access of the inner loop touches its own cache
+    // line in each iteration. Keep the lines of one tile within half of the
+    // cache so that they survive conflict misses until the next iteration of
+    // the outer loop reuses them.
+    TileSize = PowerOf2Floor(*CacheSize / (2 * CLS * C.MemInstrs.size()));
+    if (TileSize < 2)
+      return 0;
+  }
+
+  // An inner loop that fits in a single tile does not benefit.
+  unsigned TripCount = SE.getSmallConstantTripCount(C.Inner);
+  if (TripCount && TripCount <= TileSize)
+    return 0;
+  return TileSize;
+}
+
+void LoopTiler::tile(TileCandidate &C, unsigned TileSize) {
+  Loop *Outer = C.Outer;
+  BasicBlock *Preheader = Outer->getLoopPreheader();
+  BasicBlock *Header = Outer->getHeader();
+  BasicBlock *Latch = Outer->getLoopLatch();
+  BasicBlock *Exit = Outer->getExitBlock();
+  Function *F = Header->getParent();
+  LLVMContext &Ctx = F->getContext();
+  Type *Ty = C.IndVar->getType();
+
+  LLVM_DEBUG(dbgs() << "LoopTiling: Tiling " << *Outer << " by " << TileSize
+                    << "\n");
+  SE.forgetLoop(Outer);
+
+  // Create the header of the tile loop between the preheader and the header
+  // of the outer loop. It computes the bound of the current tile,
+  // jj + min(ub - jj, TileSize), which cannot overflow since jj < ub.
+  BasicBlock *TileHeader =
+      BasicBlock::Create(Ctx, Header->getName() + ".tile", F, Header);
+  IRBuilder<> B(TileHeader);
+  PHINode *TileIV = B.CreatePHI(Ty, 2, C.IndVar->getName() + ".tile");
+  TileIV->addIncoming(C.Start, Preheader);
+  Value *Remaining = B.CreateSub(C.End, TileIV, "tile.remaining");
+  Constant *Size = ConstantInt::get(Ty, TileSize);
+  Value *IsLast = B.CreateICmpULT(Remaining, Size, "tile.islast");
+  Value *Len = B.CreateSelect(IsLast, Remaining, Size, "tile.len");
+  Value *TileEnd = B.CreateAdd(TileIV, Len, "tile.end");
+  B.CreateBr(Header);
+  Preheader->getTerminator()->replaceUsesOfWith(Header, TileHeader);
+  for (PHINode &PN : Header->phis())
+    PN.replaceIncomingBlockWith(Preheader, TileHeader);
+
+  // Create the latch of the tile loop on the exit edge of the outer loop.
+  BasicBlock *TileLatch =
+      BasicBlock::Create(Ctx, Latch->getName() + ".tile", F, Exit);
+  B.SetInsertPoint(TileLatch);
+  Value *More = B.CreateICmpNE(TileEnd, C.End, "tile.more");
+  B.CreateCondBr(More, TileHeader, Exit);
+  TileIV->addIncoming(TileEnd, TileLatch);
+  Latch->getTerminator()->replaceUsesOfWith(Exit, TileLatch);
+
+  // Restrict the inner loop to the current tile.
+  C.IndVar->setIncomingValueForBlock(C.Inner->getLoopPreheader(), TileIV);
+  C.LatchCmp->setOperand(C.BoundIdx, TileEnd);
+
+  DT.addNewBlock(TileHeader, Preheader);
+  DT.changeImmediateDominator(Header, TileHeader);
+  DT.addNewBlock(TileLatch, Latch);
+  DT.changeImmediateDominator(Exit, TileLatch);
+
+  // The tile loop becomes the new top-level loop of the nest.
+  Loop *TileLoop = LI.AllocateLoop();
+  LI.changeTopLevelLoop(Outer, TileLoop);
+  TileLoop->addChildLoop(Outer);
+  TileLoop->addBlockEntry(TileHeader);
+  LI.changeLoopFor(TileHeader, TileLoop);
+  for (BasicBlock *BB : Outer->blocks())
+    TileLoop->addBlockEntry(BB);
+  TileLoop->addBlockEntry(TileLatch);
+  LI.changeLoopFor(TileLatch, TileLoop);
+
+  assert(DT.verify(DominatorTree::VerificationLevel::Fast) &&
+         "Dominator tree not updated correctly");
+  assert(TileLoop->isLoopSimplifyForm() &&
+         TileLoop->isRecursivelyLCSSAForm(DT, LI) &&
+         "Tiled loop nest is not in canonical form");
+
+  ++NumLoopNestsTiled;
+  ORE.emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "Tiled", Outer->getStartLoc(),
+                              Header)
+           << "tiled loop nest with tile size "
+           << ore::NV("TileSize", TileSize);
+  });
+}
+
+namespace {
+
+struct LoopTilingLegacyPass : public FunctionPass {
+  static char ID;
+
+  LoopTilingLegacyPass() : FunctionPass(ID) {
+    initializeLoopTilingLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addRequired<AAResultsWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addPreserved<ScalarEvolutionWrapperPass>();
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipFunction(F))
+      return false;
+    auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    auto &DI = getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+    auto &AA = getAnalysis<AAResultsWrapperPass>().getAAResults();
+    auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+    auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+    return LoopTiler(LI, DT, SE, DI, AA, TTI, ORE).run();
+  }
+};
+
+} // end anonymous namespace
+
+PreservedAnalyses LoopTilingPass::run(Function &F,
+                                      FunctionAnalysisManager &AM) {
+  auto &LI = AM.getResult<LoopAnalysis>(F);
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &SE = AM.getResult<ScalarEvolutionAnalysis>(F);
+  auto &DI = AM.getResult<DependenceAnalysis>(F);
+  auto &AA = AM.getResult<AAManager>(F);
+  auto &TTI = AM.getResult<TargetIRAnalysis>(F);
+  auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+
+  if (!LoopTiler(LI, DT, SE, DI, AA, TTI, ORE).run())
+    return PreservedAnalyses::all();
+
+  PreservedAnalyses PA;
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<LoopAnalysis>();
+  PA.preserve<ScalarEvolutionAnalysis>();
+  return PA;
+}
+
+char LoopTilingLegacyPass::ID = 0;
+
+INITIALIZE_PASS_BEGIN(LoopTilingLegacyPass, "loop-tile", "Loop Tiling", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LCSSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_END(LoopTilingLegacyPass, "loop-tile", "Loop Tiling", false,
+                    false)
+
+FunctionPass *llvm::createLoopTilingPass() { return new LoopTilingLegacyPass(); }
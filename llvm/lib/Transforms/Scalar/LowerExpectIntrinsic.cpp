@@ -349,10 +349,13 @@ static bool lowerExpectIntrinsic(Function &F) {
 
 PreservedAnalyses LowerExpectIntrinsicPass::run(Function &F,
                                                 FunctionAnalysisManager &) {
-  if (lowerExpectIntrinsic(F))
-    return PreservedAnalyses::none();
+  if (!lowerExpectIntrinsic(F))
+    return PreservedAnalyses::all();
 
-  return PreservedAnalyses::all();
+  // Only branch weights and the intrinsic calls change.
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
 }
 
 namespace {
@@ -271,6 +271,9 @@ PreservedAnalyses AddDiscriminatorsPass::run(Function &F,
   if (!addDiscriminators(F))
     return PreservedAnalyses::all();
 
+  // Only debug locations change.
   // FIXME: should be all()
-  return PreservedAnalyses::none();
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
 }
@@ -91,6 +91,48 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
   }
 }
 
+// Puts GV in the same cluster as the globals that it must not be separated
+// from.
+static void recordGVCluster(ClusterMapType &GVtoClusterMap,
+                            ComdatMembersType &ComdatMembers, GlobalValue &GV) {
+  if (GV.isDeclaration())
+    return;
+
+  if (!GV.hasName())
+    GV.setName("__llvmsplit_unnamed");
+
+  // Comdat groups must not be partitioned. For comdat groups that contain
+  // locals, record all their members here so we can keep them together.
+  // Comdat groups that only contain external globals are already handled by
+  // the MD5-based partitioning.
+  if (const Comdat *C = GV.getComdat()) {
+    auto &Member = ComdatMembers[C];
+    if (Member)
+      GVtoClusterMap.unionSets(Member, &GV);
+    else
+      Member = &GV;
+  }
+
+  // For aliases we should not separate them from their aliasees regardless
+  // of linkage.
+  if (auto *GIS = dyn_cast<GlobalIndirectSymbol>(&GV)) {
+    if (const GlobalObject *Base = GIS->getBaseObject())
+      GVtoClusterMap.unionSets(&GV, Base);
+  }
+
+  if (const Function *F = dyn_cast<Function>(&GV)) {
+    for (const BasicBlock &BB : *F) {
+      BlockAddress *BA = BlockAddress::lookup(&BB);
+      if (!BA || !BA->isConstantUsed())
+        continue;
+      addAllGlobalValueUsers(GVtoClusterMap, F, BA);
+    }
+  }
+
+  if (GV.hasLocalLinkage())
+    addAllGlobalValueUsers(GVtoClusterMap, &GV, &GV);
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
@@ -106,42 +148,7 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   ComdatMembersType ComdatMembers;
 
   auto recordGVSet = [&GVtoClusterMap, &ComdatMembers](GlobalValue &GV) {
-    if (GV.isDeclaration())
-      return;
-
-    if (!GV.hasName())
-      GV.setName("__llvmsplit_unnamed");
-
-    // Comdat groups must not be partitioned. For comdat groups that contain
-    // locals, record all their members here so we can keep them together.
-    // Comdat groups that only contain external globals are already handled by
-    // the MD5-based partitioning.
-    if (const Comdat *C = GV.getComdat()) {
-      auto &Member = ComdatMembers[C];
-      if (Member)
-        GVtoClusterMap.unionSets(Member, &GV);
-      else
-        Member = &GV;
-    }
-
-    // For aliases we should not separate them from their aliasees regardless
-    // of linkage.
-    if (auto *GIS = dyn_cast<GlobalIndirectSymbol>(&GV)) {
-      if (const GlobalObject *Base = GIS->getBaseObject())
-        GVtoClusterMap.unionSets(&GV, Base);
-    }
-
-    if (const Function *F = dyn_cast<Function>(&GV)) {
-      for (const BasicBlock &BB : *F) {
-        BlockAddress *BA = BlockAddress::lookup(&BB);
-        if (!BA || !BA->isConstantUsed())
-          continue;
-        addAllGlobalValueUsers(GVtoClusterMap, F, BA);
-      }
-    }
-
-    if (GV.hasLocalLinkage())
-      addAllGlobalValueUsers(GVtoClusterMap, &GV, &GV);
+    recordGVCluster(GVtoClusterMap, ComdatMembers, GV);
   };
 
   llvm::for_each(M->functions(), recordGVSet);
@@ -212,6 +219,148 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   }
 }
 
+// Returns the estimated cost of generating code for GV.
+static uint64_t getCodeGenCost(const GlobalValue &GV) {
+  if (const Function *F = dyn_cast<Function>(&GV))
+    return F->getInstructionCount() + 1;
+  return 1;
+}
+
+// Calls Fn with each global value that User references, directly or through
+// constants.
+static void
+forEachReferencedGlobal(const User &User, SmallPtrSetImpl<const Constant *> &Seen,
+                        function_ref<void(const GlobalValue &)> Fn) {
+  SmallVector<const Value *, 16> Worklist(User.op_begin(), User.op_end());
+  while (!Worklist.empty()) {
+    const Value *V = Worklist.pop_back_val();
+    if (auto *GV = dyn_cast<GlobalValue>(V)) {
+      Fn(*GV);
+      continue;
+    }
+    auto *C = dyn_cast<Constant>(V);
+    if (C && !isa<BlockAddress>(C) && Seen.insert(C).second)
+      Worklist.append(C->op_begin(), C->op_end());
+  }
+}
+
+// Find partitions for the module that balance the estimated code generation
+// cost of the partitions and keep globals that reference each other together
+// where possible. The globals that must stay together form clusters, which are
+// placed from the most to the least costly. Each one goes to the partition
+// that its placed neighbours are in, with the most references, among those
+// that stay within the allowed imbalance; otherwise it goes to the least
+// costly partition.
+static void findCostBalancedPartitions(Module &M, ClusterIDMapType &ClusterIDMap,
+                                       unsigned N) {
+  ClusterMapType GVtoClusterMap;
+  ComdatMembersType ComdatMembers;
+  std::vector<GlobalValue *> Defs;
+  for (GlobalValue &GV : M.global_values()) {
+    if (GV.isDeclaration())
+      continue;
+    GVtoClusterMap.insert(&GV);
+    recordGVCluster(GVtoClusterMap, ComdatMembers, GV);
+    Defs.push_back(&GV);
+  }
+
+  // Number the clusters in module order, so that the result does not depend
+  // on the order of the members in memory.
+  struct Cluster {
+    uint64_t Cost = 0;
+    std::vector<const GlobalValue *> Members;
+    DenseMap<unsigned, unsigned> Refs;
+  };
+  std::vector<Cluster> Clusters;
+  DenseMap<const GlobalValue *, unsigned> LeaderToCluster;
+  DenseMap<const GlobalValue *, unsigned> GVToCluster;
+  for (GlobalValue *GV : Defs) {
+    auto Ins = LeaderToCluster.insert(
+        {GVtoClusterMap.getLeaderValue(GV), Clusters.size()});
+    if (Ins.second)
+      Clusters.emplace_back();
+    Cluster &C = Clusters[Ins.first->second];
+    C.Cost += getCodeGenCost(*GV);
+    C.Members.push_back(GV);
+    GVToCluster[GV] = Ins.first->second;
+  }
+
+  // Count the references between clusters in both directions.
+  uint64_t TotalCost = 0;
+  for (unsigned I = 0, E = Clusters.size(); I != E; ++I) {
+    TotalCost += Clusters[I].Cost;
+    SmallPtrSet<const Constant *, 32> Seen;
+    auto AddRef = [&](const GlobalValue &Target) {
+      auto It = GVToCluster.find(&Target);
+      if (It == GVToCluster.end() || It->second == I)
+        return;
+      ++Clusters[I].Refs[It->second];
+      ++Clusters[It->second].Refs[I];
+    };
+    for (const GlobalValue *GV : Clusters[I].Members) {
+      if (auto *F = dyn_cast<Function>(GV)) {
+        for (const BasicBlock &BB : *F)
+          for (const Instruction &Inst : BB)
+            forEachReferencedGlobal(Inst, Seen, AddRef);
+      } else if (auto *GVar = dyn_cast<GlobalVariable>(GV)) {
+        if (GVar->hasInitializer())
+          forEachReferencedGlobal(*GVar, Seen, AddRef);
+      }
+    }
+  }
+
+  std::vector<unsigned> Order(Clusters.size());
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return Clusters[A].Cost > Clusters[B].Cost;
+  });
+
+  // A partition may exceed its share of the cost by this fraction to keep a
+  // cluster with the globals that it references.
+  const uint64_t Limit = TotalCost / N + TotalCost / N / 8;
+  std::vector<uint64_t> PartitionCost(N);
+  DenseMap<unsigned, unsigned> ClusterToPartition;
+  unsigned CrossRefs = 0;
+  for (unsigned CI : Order) {
+    const Cluster &C = Clusters[CI];
+    std::vector<unsigned> Affinity(N);
+    for (auto &Ref : C.Refs) {
+      auto It = ClusterToPartition.find(Ref.first);
+      if (It != ClusterToPartition.end())
+        Affinity[It->second] += Ref.second;
+    }
+    unsigned Best = 0;
+    for (unsigned P = 1; P != N; ++P)
+      if (PartitionCost[P] < PartitionCost[Best])
+        Best = P;
+    unsigned BestAffinity = 0;
+    for (unsigned P = 0; P != N; ++P) {
+      if (Affinity[P] <= BestAffinity || PartitionCost[P] + C.Cost > Limit)
+        continue;
+      Best = P;
+      BestAffinity = Affinity[P];
+    }
+    for (unsigned P = 0; P != N; ++P)
+      if (P != Best)
+        CrossRefs += Affinity[P];
+
+    ClusterToPartition[CI] = Best;
+    PartitionCost[Best] += C.Cost;
+    for (const GlobalValue *GV : C.Members)
+      ClusterIDMap[GV] = Best;
+  }
+
+  LLVM_DEBUG({
+    dbgs() << "Partitioned " << Clusters.size() << " clusters of cost "
+           << TotalCost << " with " << CrossRefs
+           << " cross-partition references:";
+    for (uint64_t Cost : PartitionCost)
+      dbgs() << ' ' << Cost;
+    dbgs() << '\n';
+  });
+}
+
 static void externalize(GlobalValue *GV) {
   if (GV->hasLocalLinkage()) {
     GV->setLinkage(GlobalValue::ExternalLinkage);
@@ -249,29 +398,39 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, SplitModuleMode Mode) {
+  SplitModule(*M, N, ModuleCallback, PreserveLocals, Mode);
+}
+
+void llvm::SplitModule(
+    Module &M, unsigned N,
+    function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
+    bool PreserveLocals, SplitModuleMode Mode) {
   if (!PreserveLocals) {
-    for (Function &F : *M)
+    for (Function &F : M)
       externalize(&F);
-    for (GlobalVariable &GV : M->globals())
+    for (GlobalVariable &GV : M.globals())
       externalize(&GV);
-    for (GlobalAlias &GA : M->aliases())
+    for (GlobalAlias &GA : M.aliases())
       externalize(&GA);
-    for (GlobalIFunc &GIF : M->ifuncs())
+    for (GlobalIFunc &GIF : M.ifuncs())
       externalize(&GIF);
   }
 
   // This performs splitting without a need for externalization, which might not
   // always be possible.
   ClusterIDMapType ClusterIDMap;
-  findPartitions(M.get(), ClusterIDMap, N);
+  if (Mode == SplitModuleMode::CostBalanced)
+    findCostBalancedPartitions(M, ClusterIDMap, N);
+  else
+    findPartitions(&M, ClusterIDMap, N);
 
   // FIXME: We should be able to reuse M as the last partition instead of
   // cloning it.
   for (unsigned I = 0; I < N; ++I) {
     ValueToValueMapTy VMap;
     std::unique_ptr<Module> MPart(
-        CloneModule(*M, VMap, [&](const GlobalValue *GV) {
+        CloneModule(M, VMap, [&](const GlobalValue *GV) {
           if (ClusterIDMap.count(GV))
             return (ClusterIDMap[GV] == I);
           else
@@ -953,6 +953,12 @@ public:
   /// possible.
   VectorizationFactor selectVectorizationFactor(unsigned MaxVF);
 
+  /// \return The most profitable vectorization factor of at most \p MaxVF for
+  /// the outer loop in the VPlan-native path, and the cost of that VF. Outer
+  /// loops are only vectorized when forced, so the scalar loop is not a
+  /// candidate.
+  VectorizationFactor selectOuterLoopVectorizationFactor(unsigned MaxVF);
+
   /// Setup cost-based decisions for user vectorization factor.
   void selectUserVectorizationFactor(unsigned UserVF) {
     collectUniformsAndScalars(UserVF);
@@ -1100,10 +1106,10 @@ public:
   InstWidening getWideningDecision(Instruction *I, unsigned VF) {
     assert(VF >= 2 && "Expected VF >=2");
 
-    // Cost model is not run in the VPlan-native path - return conservative
-    // result until this changes.
+    // The regular cost model is not run in the VPlan-native path; accesses
+    // are widened based on their stride along the outer loop instead.
     if (EnableVPlanNativePath)
-      return CM_GatherScatter;
+      return getOuterLoopWideningDecision(I, VF);
 
     std::pair<Instruction *, unsigned> InstOnVF = std::make_pair(I, VF);
     auto Itr = WideningDecisions.find(InstOnVF);
@@ -1293,6 +1299,20 @@ private:
   /// the factor width.
   VectorizationCostTy expectedCost(unsigned VF);
 
+  /// Returns the expected execution cost of the outer loop in the VPlan-native
+  /// path, where every instruction is widened and all control flow is
+  /// uniform. Like expectedCost, the cost is not normalized by \p VF.
+  unsigned expectedOuterLoopCost(unsigned VF);
+
+  /// Returns the cost of widening \p I in the VPlan-native path.
+  unsigned getOuterLoopInstructionCost(Instruction *I, unsigned VF);
+
+  /// Returns how the memory instruction \p I of the outer loop is widened in
+  /// the VPlan-native path: with a wide load or store if its address moves by
+  /// one element per iteration of the outer loop, and with a gather or
+  /// scatter otherwise.
+  InstWidening getOuterLoopWideningDecision(Instruction *I, unsigned VF);
+
   /// Returns the execution time cost of an instruction for a given vector
   /// width. Vector width of one means scalar.
   VectorizationCostTy getInstructionCost(Instruction *I, unsigned VF);
@@ -1513,14 +1533,6 @@ static bool isExplicitVecOuterLoop(Loop *OuterLp,
     return false;
   }
 
-  if (Hints.getInterleave() > 1) {
-    // TODO: Interleave support is future work.
-    LLVM_DEBUG(dbgs() << "LV: Not vectorizing: Interleave is not supported for "
-                         "outer loops.\n");
-    Hints.emitRemarkWithHints();
-    return false;
-  }
-
   return true;
 }
 
@@ -3866,36 +3878,39 @@ void InnerLoopVectorizer::sinkScalarOperands(Instruction *PredInst) {
 
 void InnerLoopVectorizer::fixNonInductionPHIs() {
   for (PHINode *OrigPhi : OrigPHIsToFix) {
-    PHINode *NewPhi =
-        cast<PHINode>(VectorLoopValueMap.getVectorValue(OrigPhi, 0));
     unsigned NumIncomingValues = OrigPhi->getNumIncomingValues();
-
     SmallVector<BasicBlock *, 2> ScalarBBPredecessors(
         predecessors(OrigPhi->getParent()));
-    SmallVector<BasicBlock *, 2> VectorBBPredecessors(
-        predecessors(NewPhi->getParent()));
-    assert(ScalarBBPredecessors.size() == VectorBBPredecessors.size() &&
-           "Scalar and Vector BB should have the same number of predecessors");
-
-    // The insertion point in Builder may be invalidated by the time we get
-    // here. Force the Builder insertion point to something valid so that we do
-    // not run into issues during insertion point restore in
-    // getOrCreateVectorValue calls below.
-    Builder.SetInsertPoint(NewPhi);
-
-    // The predecessor order is preserved and we can rely on mapping between
-    // scalar and vector block predecessors.
-    for (unsigned i = 0; i < NumIncomingValues; ++i) {
-      BasicBlock *NewPredBB = VectorBBPredecessors[i];
-
-      // When looking up the new scalar/vector values to fix up, use incoming
-      // values from original phi.
-      Value *ScIncV =
-          OrigPhi->getIncomingValueForBlock(ScalarBBPredecessors[i]);
-
-      // Scalar incoming value may need a broadcast
-      Value *NewIncV = getOrCreateVectorValue(ScIncV, 0);
-      NewPhi->addIncoming(NewIncV, NewPredBB);
+
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      PHINode *NewPhi =
+          cast<PHINode>(VectorLoopValueMap.getVectorValue(OrigPhi, Part));
+      SmallVector<BasicBlock *, 2> VectorBBPredecessors(
+          predecessors(NewPhi->getParent()));
+      assert(
+          ScalarBBPredecessors.size() == VectorBBPredecessors.size() &&
+          "Scalar and Vector BB should have the same number of predecessors");
+
+      // The insertion point in Builder may be invalidated by the time we get
+      // here. Force the Builder insertion point to something valid so that we
+      // do not run into issues during insertion point restore in
+      // getOrCreateVectorValue calls below.
+      Builder.SetInsertPoint(NewPhi);
+
+      // The predecessor order is preserved and we can rely on mapping between
+      // scalar and vector block predecessors.
+      for (unsigned i = 0; i < NumIncomingValues; ++i) {
+        BasicBlock *NewPredBB = VectorBBPredecessors[i];
+
+        // When looking up the new scalar/vector values to fix up, use incoming
+        // values from original phi.
+        Value *ScIncV =
+            OrigPhi->getIncomingValueForBlock(ScalarBBPredecessors[i]);
+
+        // Scalar incoming value may need a broadcast
+        Value *NewIncV = getOrCreateVectorValue(ScIncV, Part);
+        NewPhi->addIncoming(NewIncV, NewPredBB);
+      }
     }
   }
 }
@@ -3910,8 +3925,11 @@ void InnerLoopVectorizer::widenPHIInstruction(Instruction *PN, unsigned UF,
     // set at the end of vector code generation.
     Type *VecTy =
         (VF == 1) ? PN->getType() : VectorType::get(PN->getType(), VF);
-    Value *VecPhi = Builder.CreatePHI(VecTy, PN->getNumOperands(), "vec.phi");
-    VectorLoopValueMap.setVectorValue(P, 0, VecPhi);
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      Value *VecPhi =
+          Builder.CreatePHI(VecTy, PN->getNumOperands(), "vec.phi");
+      VectorLoopValueMap.setVectorValue(P, Part, VecPhi);
+    }
     OrigPHIsToFix.push_back(P);
 
     return;
@@ -6255,6 +6273,142 @@ void LoopVectorizationCostModel::collectValuesToIgnore() {
   }
 }
 
+LoopVectorizationCostModel::InstWidening
+LoopVectorizationCostModel::getOuterLoopWideningDecision(Instruction *I,
+                                                         unsigned VF) {
+  const DataLayout &DL = TheFunction->getParent()->getDataLayout();
+  Type *ValTy = getMemInstValueType(I);
+  if (hasIrregularType(ValTy, DL, VF))
+    return CM_GatherScatter;
+
+  // Look through the recurrences of loops nested in the outer loop. All lanes
+  // run an inner loop in lock step, so a step that is the same in every
+  // iteration of the outer loop moves all lanes alike and does not change the
+  // distance between them.
+  ScalarEvolution *SE = PSE.getSE();
+  const SCEV *S = SE->getSCEV(getLoadStorePointerOperand(I));
+  while (auto *AR = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (AR->getLoop() == TheLoop)
+      break;
+    if (!TheLoop->contains(AR->getLoop()) ||
+        !SE->isLoopInvariant(AR->getStepRecurrence(*SE), TheLoop))
+      return CM_GatherScatter;
+    S = AR->getStart();
+  }
+
+  auto *AR = dyn_cast<SCEVAddRecExpr>(S);
+  if (!AR || !AR->isAffine())
+    return CM_GatherScatter;
+  auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  if (!Step)
+    return CM_GatherScatter;
+
+  int64_t Size = DL.getTypeAllocSize(ValTy);
+  int64_t Stride = Step->getAPInt().getSExtValue();
+  if (Stride == Size)
+    return CM_Widen;
+  if (Stride == -Size)
+    return CM_Widen_Reverse;
+  return CM_GatherScatter;
+}
+
+unsigned LoopVectorizationCostModel::getOuterLoopInstructionCost(Instruction *I,
+                                                                 unsigned VF) {
+  Type *VectorTy = ToVectorTy(I->getType(), VF);
+  switch (I->getOpcode()) {
+  case Instruction::PHI:
+  case Instruction::GetElementPtr:
+    return 0;
+  case Instruction::Br: {
+    // Control flow is uniform, so branches stay scalar and use the condition
+    // of the first lane.
+    unsigned Cost = TTI.getCFInstrCost(Instruction::Br);
+    auto *BI = cast<BranchInst>(I);
+    if (VF > 1 && BI->isConditional())
+      Cost += TTI.getVectorInstrCost(
+          Instruction::ExtractElement,
+          ToVectorTy(BI->getCondition()->getType(), VF), 0);
+    return Cost;
+  }
+  case Instruction::Load:
+  case Instruction::Store: {
+    Type *ValTy = ToVectorTy(getMemInstValueType(I), VF);
+    unsigned Alignment = getLoadStoreAlignment(I);
+    unsigned AS = getLoadStoreAddressSpace(I);
+    if (VF == 1)
+      return TTI.getMemoryOpCost(I->getOpcode(), ValTy, Alignment, AS, I);
+
+    switch (getOuterLoopWideningDecision(I, VF)) {
+    case CM_Widen:
+      return TTI.getMemoryOpCost(I->getOpcode(), ValTy, Alignment, AS);
+    case CM_Widen_Reverse:
+      return TTI.getMemoryOpCost(I->getOpcode(), ValTy, Alignment, AS) +
+             TTI.getShuffleCost(TargetTransformInfo::SK_Reverse, ValTy, 0);
+    default:
+      return getGatherScatterCost(I, VF);
+    }
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp:
+    return TTI.getCmpSelInstrCost(I->getOpcode(),
+                                  ToVectorTy(I->getOperand(0)->getType(), VF));
+  case Instruction::Select:
+    return TTI.getCmpSelInstrCost(
+        I->getOpcode(), VectorTy,
+        ToVectorTy(I->getOperand(0)->getType(), VF));
+  default:
+    if (I->isBinaryOp() || I->isUnaryOp())
+      return TTI.getArithmeticInstrCost(I->getOpcode(), VectorTy);
+    if (auto *CI = dyn_cast<CastInst>(I))
+      return TTI.getCastInstrCost(CI->getOpcode(), VectorTy,
+                                  ToVectorTy(CI->getSrcTy(), VF));
+    // Assume anything else is scalarized.
+    return VF * TTI.getInstructionCost(I,
+                                       TargetTransformInfo::TCK_RecipThroughput);
+  }
+}
+
+/// The trip count assumed for inner loops whose trip count is not a small
+/// constant, when weighing their blocks in the outer loop cost.
+static const unsigned InnerLoopTripCountEstimate = 8;
+
+unsigned LoopVectorizationCostModel::expectedOuterLoopCost(unsigned VF) {
+  unsigned Cost = 0;
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    unsigned BlockCost = 0;
+    for (Instruction &I : BB->instructionsWithoutDebug())
+      BlockCost += getOuterLoopInstructionCost(&I, VF);
+
+    // The blocks of an inner loop run once per inner iteration for all lanes
+    // together.
+    for (Loop *L = LI->getLoopFor(BB); L != TheLoop; L = L->getParentLoop()) {
+      unsigned TC = PSE.getSE()->getSmallConstantTripCount(L);
+      BlockCost *= TC ? TC : InnerLoopTripCountEstimate;
+    }
+    Cost += BlockCost;
+  }
+  return Cost;
+}
+
+VectorizationFactor
+LoopVectorizationCostModel::selectOuterLoopVectorizationFactor(unsigned MaxVF) {
+  LLVM_DEBUG(dbgs() << "LV: Scalar outer loop costs: "
+                    << expectedOuterLoopCost(1) << ".\n");
+  unsigned Width = MaxVF;
+  float Cost = std::numeric_limits<float>::max();
+  for (unsigned VF = 2; VF <= MaxVF; VF *= 2) {
+    float VectorCost = expectedOuterLoopCost(VF) / (float)VF;
+    LLVM_DEBUG(dbgs() << "LV: Vector outer loop of width " << VF
+                      << " costs: " << (int)VectorCost << ".\n");
+    if (VectorCost < Cost) {
+      Cost = VectorCost;
+      Width = VF;
+    }
+  }
+  LLVM_DEBUG(dbgs() << "LV: Selecting VF: " << Width << ".\n");
+  return {Width, (unsigned)(Width * Cost)};
+}
+
 // TODO: we could return a pair of values that specify the max VF and
 // min VF, to be used in `buildVPlans(MinVF, MaxVF)` instead of
 // `buildVPlans(VF, VF)`. We cannot do it because VPLAN at the moment
@@ -6275,8 +6429,9 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
   // Since we cannot modify the incoming IR, we need to build VPlan upfront in
   // the vectorization pipeline.
   if (!OrigLoop->empty()) {
-    // If the user doesn't provide a vectorization factor, determine a
-    // reasonable one.
+    // If the user doesn't provide a vectorization factor, pick the cheapest
+    // one that fits the widest vector register.
+    unsigned Cost = 0;
     if (!UserVF) {
       VF = determineVPlanVF(TTI->getRegisterBitWidth(true /* Vector*/), CM);
       LLVM_DEBUG(dbgs() << "LV: VPlan computed VF " << VF << ".\n");
@@ -6286,6 +6441,14 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
         LLVM_DEBUG(dbgs() << "LV: VPlan stress testing: "
                           << "overriding computed VF.\n");
         VF = 4;
+      } else if (VF < 2) {
+        LLVM_DEBUG(dbgs() << "LV: Not vectorizing: the target has no vector "
+                             "registers wide enough.\n");
+        return VectorizationFactor::Disabled();
+      } else if (!VPlanBuildStressTest) {
+        VectorizationFactor Best = CM.selectOuterLoopVectorizationFactor(VF);
+        VF = Best.Width;
+        Cost = Best.Cost;
       }
     }
     assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
@@ -6298,7 +6461,7 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
     if (VPlanBuildStressTest)
       return VectorizationFactor::Disabled();
 
-    return {VF, 0};
+    return {VF, Cost};
   }
 
   LLVM_DEBUG(
@@ -7330,9 +7493,8 @@ static bool processLoopInVPlanNativePath(
 
   LoopVectorizationCostModel CM(SEL, L, PSE, LI, LVL, *TTI, TLI, DB, AC, ORE, F,
                                 &Hints, IAI);
-  // Use the planner for outer loop vectorization.
-  // TODO: CM is not used at this point inside the planner. Turn CM into an
-  // optional argument if we don't need it in the future.
+  // Use the planner for outer loop vectorization. CM only picks the VF and the
+  // way memory accesses are widened.
   LoopVectorizationPlanner LVP(L, LI, TLI, TTI, LVL, CM);
 
   // Get user vectorization factor.
@@ -7348,9 +7510,11 @@ static bool processLoopInVPlanNativePath(
       VectorizationFactor::Disabled() == VF)
     return false;
 
-  LVP.setBestPlan(VF.Width, 1);
+  // Interleave only as far as the user asked for.
+  const unsigned IC = std::max(1u, Hints.getInterleave());
+  LVP.setBestPlan(VF.Width, IC);
 
-  InnerLoopVectorizer LB(L, PSE, LI, DT, TLI, TTI, AC, ORE, VF.Width, 1, LVL,
+  InnerLoopVectorizer LB(L, PSE, LI, DT, TLI, TTI, AC, ORE, VF.Width, IC, LVL,
                          &CM);
   LLVM_DEBUG(dbgs() << "Vectorizing outer loop in \""
                     << L->getHeader()->getParent()->getName() << "\"\n");
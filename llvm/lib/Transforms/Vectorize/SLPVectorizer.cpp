@@ -83,6 +83,7 @@
 #include "llvm/Support/KnownBits.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
 #include "llvm/Transforms/Vectorize.h"
 #include <algorithm>
@@ -123,6 +124,11 @@ static cl::opt<bool> ShouldStartVectorizeHorAtStore(
     cl::desc(
         "Attempt to vectorize horizontal reductions feeding into a store"));
 
+static cl::opt<bool> ShouldVectorizeStraightLineBlocks(
+    "slp-vectorize-straight-line-blocks", cl::init(false), cl::Hidden,
+    cl::desc("Attempt to vectorize across blocks that are only entered through "
+             "an unconditional branch from their single predecessor"));
+
 static cl::opt<int>
 MaxVectorRegSizeOption("slp-max-reg-size", cl::init(128), cl::Hidden,
     cl::desc("Attempt to vectorize for this register size in bits"));
@@ -5030,6 +5036,47 @@ PreservedAnalyses SLPVectorizerPass::run(Function &F, FunctionAnalysisManager &A
   return PA;
 }
 
+/// Move the instructions of each block that is only entered through an
+/// unconditional branch from its single predecessor up into that predecessor.
+/// Both blocks always execute together, so this only lengthens the
+/// straight-line code that trees and store chains are built from. The CFG
+/// itself is left alone.
+static bool hoistStraightLineBlocks(Function &F) {
+  bool Changed = false;
+  // The block whose instructions were already hoisted the furthest up.
+  DenseMap<BasicBlock *, BasicBlock *> HoistedInto;
+  for (BasicBlock *BB : ReversePostOrderTraversal<Function *>(&F)) {
+    BasicBlock *Pred = BB->getSinglePredecessor();
+    if (!Pred || Pred == BB || BB->isEHPad())
+      continue;
+    auto *Br = dyn_cast<BranchInst>(Pred->getTerminator());
+    if (!Br || !Br->isUnconditional())
+      continue;
+    // A musttail call has to stay right before its return.
+    if (llvm::any_of(*BB, [](Instruction &I) {
+          auto *CI = dyn_cast<CallInst>(&I);
+          return CI && CI->isMustTailCall();
+        }))
+      continue;
+
+    BasicBlock *Dest = HoistedInto.lookup(Pred);
+    if (!Dest)
+      Dest = Pred;
+    HoistedInto[BB] = Dest;
+    if (isa<PHINode>(BB->front())) {
+      FoldSingleEntryPHINodes(BB);
+      Changed = true;
+    }
+    if (&BB->front() == BB->getTerminator())
+      continue;
+    Dest->getInstList().splice(Dest->getTerminator()->getIterator(),
+                               BB->getInstList(), BB->begin(),
+                               BB->getTerminator()->getIterator());
+    Changed = true;
+  }
+  return Changed;
+}
+
 bool SLPVectorizerPass::runImpl(Function &F, ScalarEvolution *SE_,
                                 TargetTransformInfo *TTI_,
                                 TargetLibraryInfo *TLI_, AliasAnalysis *AA_,
@@ -5061,6 +5108,9 @@ bool SLPVectorizerPass::runImpl(Function &F, ScalarEvolution *SE_,
 
   LLVM_DEBUG(dbgs() << "SLP: Analyzing blocks in " << F.getName() << ".\n");
 
+  if (ShouldVectorizeStraightLineBlocks)
+    Changed |= hoistStraightLineBlocks(F);
+
   // Use the bottom up slp vectorizer to construct chains that start with
   // store instructions.
   BoUpSLP R(&F, SE, TTI, TLI, AA, LI, DT, AC, DB, DL, ORE_);
@@ -6057,6 +6107,19 @@ public:
     ReducedValueData.clear();
     ReductionRoot = B;
 
+    // The reduced values may mix two binary operators (or two casts); the
+    // tree over them is then vectorized as an alternate-opcode bundle.
+    Instruction *ReducedValueInst = nullptr;
+    Instruction *AltReducedValueInst = nullptr;
+    auto IsAlternateReducedValue = [&](Instruction *I) {
+      if (!ReducedValueInst)
+        return false;
+      SmallVector<Value *, 3> VL = {ReducedValueInst, I};
+      if (AltReducedValueInst)
+        VL.push_back(AltReducedValueInst);
+      return getSameOpcode(VL).getOpcode() != 0;
+    };
+
     // Post order traverse the reduction tree starting at B. We only handle true
     // trees containing only binary operators.
     SmallVector<std::pair<Instruction *, unsigned>, 32> Stack;
@@ -6104,7 +6167,7 @@ public:
         // the first met operation != reduction operation is considered as the
         // reduced value class.
         if (I && (!ReducedValueData || OpData == ReducedValueData ||
-                  OpData == ReductionData)) {
+                  OpData == ReductionData || IsAlternateReducedValue(I))) {
           const bool IsReductionOperation = OpData == ReductionData;
           // Only handle trees in the current basic block.
           if (!ReductionData.hasSameParent(I, B->getParent(),
@@ -6131,15 +6194,20 @@ public:
               markExtraArg(Stack.back(), I);
               continue;
             }
-          } else if (ReducedValueData &&
-                     ReducedValueData != OpData) {
+          } else if (ReducedValueData && ReducedValueData != OpData) {
             // Make sure that the opcodes of the operations that we are going to
-            // reduce match.
-            // I is an extra argument for TreeN (its parent operation).
-            markExtraArg(Stack.back(), I);
-            continue;
-          } else if (!ReducedValueData)
+            // reduce match, or are alternates of each other.
+            if (!IsAlternateReducedValue(I)) {
+              // I is an extra argument for TreeN (its parent operation).
+              markExtraArg(Stack.back(), I);
+              continue;
+            }
+            if (!AltReducedValueInst)
+              AltReducedValueInst = I;
+          } else if (!ReducedValueData) {
             ReducedValueData = OpData;
+            ReducedValueInst = I;
+          }
 
           Stack.push_back(std::make_pair(I, OpData.getFirstOperandIndex()));
           continue;
@@ -6399,6 +6467,9 @@ private:
 ///  %rd = insertelement <4 x float> %rc, float %s3, i32 3
 ///  starting from the last insertelement instruction.
 ///
+/// The chain may also start from an existing vector instead of undef, which
+/// is how partially vectorized code fills in its remaining lanes.
+///
 /// Returns true if it matches
 static bool findBuildVector(InsertElementInst *LastInsertElem,
                             TargetTransformInfo *TTI,
@@ -6416,9 +6487,15 @@ static bool findBuildVector(InsertElementInst *LastInsertElem,
     V = LastInsertElem->getOperand(0);
     if (isa<UndefValue>(V))
       break;
-    LastInsertElem = dyn_cast<InsertElementInst>(V);
-    if (!LastInsertElem || !LastInsertElem->hasOneUse())
-      return false;
+    auto *PrevInsertElem = dyn_cast<InsertElementInst>(V);
+    if (!PrevInsertElem || !PrevInsertElem->hasOneUse()) {
+      // Once vectorized, the inserts into the existing vector become a
+      // shuffle blending the new lanes in.
+      UserCost -= TTI->getShuffleCost(TargetTransformInfo::SK_PermuteTwoSrc,
+                                      V->getType());
+      break;
+    }
+    LastInsertElem = PrevInsertElem;
   } while (true);
   std::reverse(BuildVectorOpds.begin(), BuildVectorOpds.end());
   return true;
@@ -2583,6 +2583,22 @@ bool DwarfLinker::link(const DebugMap &Map) {
       Options.TheAccelTableKind = AccelTableKind::Apple;
   }
 
+  // Extracting the input DIEs only touches the DWARFContext of the object
+  // they come from, so when we have threads to spare do it for all the objects
+  // in parallel instead of lazily in the serial loop below.
+  if (Options.Threads > 1 && NumObjects > 1) {
+    ThreadPool Pool(std::min<unsigned>(Options.Threads, NumObjects));
+    for (LinkContext &LinkContext : ObjectContexts) {
+      if (!LinkContext.DwarfContext)
+        continue;
+      Pool.async([&LinkContext]() {
+        for (const auto &CU : LinkContext.DwarfContext->compile_units())
+          CU->getUnitDIE(/*ExtractUnitDIEOnly=*/false);
+      });
+    }
+    Pool.wait();
+  }
+
   for (LinkContext &LinkContext : ObjectContexts) {
     if (Options.Verbose)
       outs() << "DEBUG MAP OBJECT: " << LinkContext.DMO.getObjectFilename()
@@ -21,6 +21,7 @@
 #include "llvm/CodeGen/MIRParser/MIRParser.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/AutoUpgrade.h"
@@ -77,6 +78,11 @@ TimeCompilations("time-compilations", cl::Hidden, cl::init(1u),
                  cl::value_desc("N"),
                  cl::desc("Repeat compilation N times for timing"));
 
+static cl::opt<unsigned> SplitCodeGenThreads(
+    "split-codegen-threads", cl::init(1u), cl::value_desc("N"),
+    cl::desc("Split the module into N partitions that are compiled in "
+             "parallel. Partition I > 0 is written to <output>.I"));
+
 static cl::opt<bool>
 NoIntegratedAssembler("no-integrated-as", cl::Hidden,
                       cl::desc("Disable integrated assembler"));
@@ -184,6 +190,37 @@ static cl::opt<RunPassOption, true, cl::parser<std::string>> RunPass(
 
 static int compileModule(char **, LLVMContext &);
 
+/// Generate code for \p M with SplitCodeGenThreads threads. The first
+/// partition is written to \p Out, the others next to it.
+static int splitCompileModule(
+    std::unique_ptr<Module> M, const char *argv0, ToolOutputFile &Out,
+    const std::function<std::unique_ptr<TargetMachine>()> &TMFactory) {
+  bool Binary = FileType != TargetMachine::CGFT_AssemblyFile;
+  std::vector<std::unique_ptr<ToolOutputFile>> PartOuts;
+  SmallVector<raw_pwrite_stream *, 8> OSs = {&Out.os()};
+  for (unsigned I = 1; I != SplitCodeGenThreads; ++I) {
+    std::error_code EC;
+    PartOuts.push_back(std::make_unique<ToolOutputFile>(
+        (Twine(OutputFilename) + "." + Twine(I)).str(), EC,
+        Binary ? sys::fs::OF_None : sys::fs::OF_Text));
+    if (EC) {
+      WithColor::error(errs(), argv0) << EC.message() << '\n';
+      return 1;
+    }
+    OSs.push_back(&PartOuts.back()->os());
+  }
+
+  // Before executing passes, print the final values of the LLVM options.
+  cl::PrintOptionValues();
+
+  splitCodeGen(std::move(M), OSs, {}, TMFactory, FileType);
+
+  Out.keep();
+  for (auto &PartOut : PartOuts)
+    PartOut->keep();
+  return 0;
+}
+
 static std::unique_ptr<ToolOutputFile> GetOutputStream(const char *TargetName,
                                                        Triple::OSType OS,
                                                        const char *ProgName) {
@@ -518,6 +555,23 @@ static int compileModule(char **argv, LLVMContext &Context) {
   // flags.
   setFunctionAttributes(CPUStr, FeaturesStr, *M);
 
+  if (SplitCodeGenThreads > 1) {
+    if (MIR || !RunPassNames->empty() || CompileTwice || DwoOut ||
+        OutputFilename == "-") {
+      WithColor::error(errs(), argv[0])
+          << "-split-codegen-threads requires IR input and a named output "
+             "file, and cannot be combined with -run-pass, -compile-twice or "
+             "-split-dwarf-output\n";
+      return 1;
+    }
+    auto TMFactory = [&]() {
+      return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+          TheTriple.getTriple(), CPUStr, FeaturesStr, Options,
+          getRelocModel(), getCodeModel(), OLvl));
+    };
+    return splitCompileModule(std::move(M), argv[0], *Out, TMFactory);
+  }
+
   if (RelaxAll.getNumOccurrences() > 0 &&
       FileType != TargetMachine::CGFT_ObjectFile)
     WithColor::warning(errs(), argv[0])
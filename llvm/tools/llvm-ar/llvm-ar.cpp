@@ -11,6 +11,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/LLVMContext.h"
@@ -628,6 +629,58 @@ static void addChildMember(std::vector<NewArchiveMember> &Members,
   Members.push_back(std::move(*NMOrErr));
 }
 
+// Map the offset of each member of Archive to the names the archive symbol
+// table lists for it. Only the GNU format is trusted to list the symbols in
+// the order writeArchive would.
+static DenseMap<uint64_t, std::vector<StringRef>>
+getOldMemberSymbols(const object::Archive &Archive) {
+  DenseMap<uint64_t, std::vector<StringRef>> Ret;
+  if (!Archive.hasSymbolTable() ||
+      (Archive.kind() != object::Archive::K_GNU &&
+       Archive.kind() != object::Archive::K_GNU64))
+    return Ret;
+  for (const object::Archive::Symbol &S : Archive.symbols()) {
+    Expected<object::Archive::Child> ChildOrErr = S.getMember();
+    if (!ChildOrErr) {
+      // Fall back to reading every member.
+      consumeError(ChildOrErr.takeError());
+      return {};
+    }
+    Ret[ChildOrErr->getChildOffset()].push_back(S.getName());
+  }
+  return Ret;
+}
+
+// Add an unmodified member of the old archive. Its symbols are taken from the
+// old symbol table, so that updating one member of a large archive doesn't
+// read all the others again. For thin archives the member may have changed on
+// disk since, so the symbols are only reused if its size still matches.
+static void
+addOldMember(std::vector<NewArchiveMember> &Members,
+             const object::Archive::Child &M,
+             const DenseMap<uint64_t, std::vector<StringRef>> &OldSymbols) {
+  size_t NumMembers = Members.size();
+  addChildMember(Members, M, /*FlattenArchive=*/Thin);
+  auto It = OldSymbols.find(M.getChildOffset());
+  if (It == OldSymbols.end() || Members.size() != NumMembers + 1)
+    return;
+
+  Expected<MemoryBufferRef> BufOrErr = M.getMemoryBufferRef();
+  Expected<uint64_t> SizeOrErr = M.getSize();
+  if (!BufOrErr || !SizeOrErr) {
+    consumeError(BufOrErr.takeError());
+    consumeError(SizeOrErr.takeError());
+    return;
+  }
+  // Nothing to reuse if the member was replaced by the flattened contents of
+  // a nested archive.
+  NewArchiveMember &NM = Members.back();
+  if (NM.Buf->getBufferStart() != BufOrErr->getBufferStart() ||
+      NM.Buf->getBufferSize() != *SizeOrErr)
+    return;
+  NM.Symbols = It->second;
+}
+
 static void addMember(std::vector<NewArchiveMember> &Members,
                       StringRef FileName, bool FlattenArchive = false) {
   Expected<NewArchiveMember> NMOrErr =
@@ -736,6 +789,8 @@ computeNewArchiveMembers(ArchiveOperation Operation,
     std::string PosName = normalizePath(RelPos);
     Error Err = Error::success();
     StringMap<int> MemberCount;
+    DenseMap<uint64_t, std::vector<StringRef>> OldSymbols =
+        getOldMemberSymbols(*OldArchive);
     for (auto &Child : OldArchive->children(Err)) {
       int Pos = Ret.size();
       Expected<StringRef> NameOrErr = Child.getName();
@@ -754,7 +809,7 @@ computeNewArchiveMembers(ArchiveOperation Operation,
           computeInsertAction(Operation, Child, Name, MemberI, MemberCount);
       switch (Action) {
       case IA_AddOldMember:
-        addChildMember(Ret, Child, /*FlattenArchive=*/Thin);
+        addOldMember(Ret, Child, OldSymbols);
         break;
       case IA_AddNewMember:
         addMember(Ret, *MemberI);
@@ -762,7 +817,7 @@ computeNewArchiveMembers(ArchiveOperation Operation,
       case IA_Delete:
         break;
       case IA_MoveOldMember:
-        addChildMember(Moved, Child, /*FlattenArchive=*/Thin);
+        addOldMember(Moved, Child, OldSymbols);
         break;
       case IA_MoveNewMember:
         addMember(Moved, *MemberI);
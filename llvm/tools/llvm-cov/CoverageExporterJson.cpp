@@ -48,7 +48,7 @@
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
 #include <algorithm>
-#include <mutex>
+#include <numeric>
 #include <utility>
 
 /// The semantic version combined as a string.
@@ -148,44 +148,53 @@ json::Object renderFile(const coverage::CoverageMapping &Coverage,
   return File;
 }
 
-json::Array renderFiles(const coverage::CoverageMapping &Coverage,
-                        ArrayRef<std::string> SourceFiles,
-                        ArrayRef<FileCoverageSummary> FileReports,
-                        const CoverageViewOptions &Options) {
+void renderFiles(json::OStream &JOS, const coverage::CoverageMapping &Coverage,
+                 ArrayRef<std::string> SourceFiles,
+                 ArrayRef<FileCoverageSummary> FileReports,
+                 const CoverageViewOptions &Options) {
   auto NumThreads = Options.NumThreads;
   if (NumThreads == 0) {
     NumThreads = std::max(1U, std::min(llvm::heavyweight_hardware_concurrency(),
                                        unsigned(SourceFiles.size())));
   }
+
+  // Files are emitted in order of their names.
+  std::vector<unsigned> Order(SourceFiles.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return SourceFiles[A] < SourceFiles[B];
+  });
+
+  // Render the files a window at a time and write each window out as soon as
+  // it is complete, so that only a few files per thread are held in memory.
   ThreadPool Pool(NumThreads);
-  json::Array FileArray;
-  std::mutex FileArrayMutex;
-
-  for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I) {
-    auto &SourceFile = SourceFiles[I];
-    auto &FileReport = FileReports[I];
-    Pool.async([&] {
-      auto File = renderFile(Coverage, SourceFile, FileReport, Options);
-      {
-        std::lock_guard<std::mutex> Lock(FileArrayMutex);
-        FileArray.push_back(std::move(File));
-      }
-    });
+  size_t WindowSize = 4 * NumThreads;
+  std::vector<json::Object> Window;
+  for (size_t Begin = 0, E = Order.size(); Begin < E; Begin += WindowSize) {
+    size_t End = std::min(E, Begin + WindowSize);
+    Window.clear();
+    Window.resize(End - Begin);
+    for (size_t I = Begin; I < End; ++I) {
+      Pool.async([&, I, Begin] {
+        unsigned FileIndex = Order[I];
+        Window[I - Begin] = renderFile(Coverage, SourceFiles[FileIndex],
+                                       FileReports[FileIndex], Options);
+      });
+    }
+    Pool.wait();
+    for (json::Object &File : Window)
+      JOS.value(std::move(File));
   }
-  Pool.wait();
-  return FileArray;
 }
 
-json::Array renderFunctions(
+void renderFunctions(
+    json::OStream &JOS,
     const iterator_range<coverage::FunctionRecordIterator> &Functions) {
-  json::Array FunctionArray;
   for (const auto &F : Functions)
-    FunctionArray.push_back(
-        json::Object({{"name", F.Name},
-                      {"count", int64_t(F.ExecutionCount)},
-                      {"regions", renderRegions(F.CountedRegions)},
-                      {"filenames", json::Array(F.Filenames)}}));
-  return FunctionArray;
+    JOS.value(json::Object({{"name", F.Name},
+                            {"count", int64_t(F.ExecutionCount)},
+                            {"regions", renderRegions(F.CountedRegions)},
+                            {"filenames", json::Array(F.Filenames)}}));
 }
 
 } // end anonymous namespace
@@ -203,27 +212,26 @@ void CoverageExporterJson::renderRoot(ArrayRef<std::string> SourceFiles) {
   FileCoverageSummary Totals = FileCoverageSummary("Totals");
   auto FileReports = CoverageReport::prepareFileReports(Coverage, Totals,
                                                         SourceFiles, Options);
-  auto Files = renderFiles(Coverage, SourceFiles, FileReports, Options);
-  // Sort files in order of their names.
-  std::sort(Files.begin(), Files.end(),
-    [](const json::Value &A, const json::Value &B) {
-      const json::Object *ObjA = A.getAsObject();
-      const json::Object *ObjB = B.getAsObject();
-      assert(ObjA != nullptr && "Value A was not an Object");
-      assert(ObjB != nullptr && "Value B was not an Object");
-      const StringRef FilenameA = ObjA->getString("filename").getValue();
-      const StringRef FilenameB = ObjB->getString("filename").getValue();
-      return FilenameA.compare(FilenameB) < 0;
-    });
-  auto Export = json::Object(
-      {{"files", std::move(Files)}, {"totals", renderSummary(Totals)}});
-  // Skip functions-level information  if necessary.
-  if (!Options.ExportSummaryOnly && !Options.SkipFunctions)
-    Export["functions"] = renderFunctions(Coverage.getCoveredFunctions());
 
-  auto ExportArray = json::Array({std::move(Export)});
-
-  OS << json::Object({{"version", LLVM_COVERAGE_EXPORT_JSON_STR},
-                      {"type", LLVM_COVERAGE_EXPORT_JSON_TYPE_STR},
-                      {"data", std::move(ExportArray)}});
+  // Stream the export instead of building it as a single JSON value, as it
+  // can be much larger than the coverage mapping itself. The attributes are
+  // written in sorted order, which is the order json::Object prints them in.
+  json::OStream JOS(OS);
+  JOS.object([&] {
+    JOS.attributeArray("data", [&] {
+      JOS.object([&] {
+        JOS.attributeArray("files", [&] {
+          renderFiles(JOS, Coverage, SourceFiles, FileReports, Options);
+        });
+        // Skip functions-level information if necessary.
+        if (!Options.ExportSummaryOnly && !Options.SkipFunctions)
+          JOS.attributeArray("functions", [&] {
+            renderFunctions(JOS, Coverage.getCoveredFunctions());
+          });
+        JOS.attribute("totals", renderSummary(Totals));
+      });
+    });
+    JOS.attribute("type", LLVM_COVERAGE_EXPORT_JSON_TYPE_STR);
+    JOS.attribute("version", LLVM_COVERAGE_EXPORT_JSON_STR);
+  });
 }
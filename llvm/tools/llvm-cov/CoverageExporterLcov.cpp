@@ -37,6 +37,9 @@
 
 #include "CoverageExporterLcov.h"
 #include "CoverageReport.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <algorithm>
 
 using namespace llvm;
 
@@ -99,9 +102,41 @@ void renderFile(raw_ostream &OS, const coverage::CoverageMapping &Coverage,
 void renderFiles(raw_ostream &OS, const coverage::CoverageMapping &Coverage,
                  ArrayRef<std::string> SourceFiles,
                  ArrayRef<FileCoverageSummary> FileReports,
-                 bool ExportSummaryOnly) {
-  for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I)
-    renderFile(OS, Coverage, SourceFiles[I], FileReports[I], ExportSummaryOnly);
+                 const CoverageViewOptions &Options) {
+  auto NumThreads = Options.NumThreads;
+  if (NumThreads == 0) {
+    NumThreads = std::max(1U, std::min(llvm::heavyweight_hardware_concurrency(),
+                                       unsigned(SourceFiles.size())));
+  }
+  if (NumThreads == 1) {
+    for (unsigned I = 0, E = SourceFiles.size(); I < E; ++I)
+      renderFile(OS, Coverage, SourceFiles[I], FileReports[I],
+                 Options.ExportSummaryOnly);
+    return;
+  }
+
+  // Render the records of a window of files in parallel and write them out in
+  // order once the window is complete, so that only a few records per thread
+  // are held in memory.
+  ThreadPool Pool(NumThreads);
+  size_t WindowSize = 4 * NumThreads;
+  std::vector<std::string> Window;
+  for (size_t Begin = 0, E = SourceFiles.size(); Begin < E;
+       Begin += WindowSize) {
+    size_t End = std::min(E, Begin + WindowSize);
+    Window.clear();
+    Window.resize(End - Begin);
+    for (size_t I = Begin; I < End; ++I) {
+      Pool.async([&, I, Begin] {
+        raw_string_ostream FileOS(Window[I - Begin]);
+        renderFile(FileOS, Coverage, SourceFiles[I], FileReports[I],
+                   Options.ExportSummaryOnly);
+      });
+    }
+    Pool.wait();
+    for (const std::string &File : Window)
+      OS << File;
+  }
 }
 
 } // end anonymous namespace
@@ -119,6 +154,5 @@ void CoverageExporterLcov::renderRoot(ArrayRef<std::string> SourceFiles) {
   FileCoverageSummary Totals = FileCoverageSummary("Totals");
   auto FileReports = CoverageReport::prepareFileReports(Coverage, Totals,
                                                         SourceFiles, Options);
-  renderFiles(OS, Coverage, SourceFiles, FileReports,
-              Options.ExportSummaryOnly);
+  renderFiles(OS, Coverage, SourceFiles, FileReports, Options);
 }
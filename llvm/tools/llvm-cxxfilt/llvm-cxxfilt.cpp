@@ -49,6 +49,13 @@ static cl::opt<bool>
 static cl::alias TypesShort("t", cl::desc("alias for --types"),
                             cl::aliasopt(Types));
 
+static cl::opt<bool>
+    Batch("batch",
+          cl::desc("when reading names from standard input, reuse one "
+                   "demangler for all of them and only flush the output "
+                   "when it is full"),
+          cl::init(false));
+
 static cl::list<std::string>
 Decorated(cl::Positional, cl::desc("<mangled>"), cl::ZeroOrMore);
 
@@ -132,12 +139,80 @@ static void demangleLine(llvm::raw_ostream &OS, StringRef Mangled, bool Split) {
   OS.flush();
 }
 
+namespace {
+/// Demangles the words of many lines with one demangler and one output
+/// buffer, so that a long stream of names costs no allocation per name.
+class BatchDemangler {
+  ItaniumPartialDemangler Demangler;
+  char *Buf = nullptr;
+  size_t BufSize = 0;
+
+  bool tryDemangle(raw_ostream &OS, StringRef Mangled) {
+    size_t N = BufSize;
+    char *Result = Demangler.demangle(Mangled.data(), Mangled.size(), Buf, &N);
+    if (!Result)
+      return false;
+    // The printer grows the buffer with realloc and N is then the size of
+    // the name and its terminator.
+    Buf = Result;
+    BufSize = std::max(BufSize, N);
+    OS.write(Result, N - 1);
+    return true;
+  }
+
+public:
+  BatchDemangler() = default;
+  BatchDemangler(const BatchDemangler &) = delete;
+  BatchDemangler &operator=(const BatchDemangler &) = delete;
+  ~BatchDemangler() { std::free(Buf); }
+
+  /// Writes the demangling of Mangled to OS, or Mangled itself if it is not
+  /// a mangled name, like demangle() above.
+  void demangle(raw_ostream &OS, StringRef Mangled) {
+    StringRef DecoratedStr = Mangled;
+    if (StripUnderscore)
+      DecoratedStr.consume_front("_");
+
+    if ((Types || DecoratedStr.startswith("_Z") ||
+         DecoratedStr.startswith("___Z")) &&
+        tryDemangle(OS, DecoratedStr))
+      return;
+
+    if (DecoratedStr.size() > 6 && DecoratedStr.startswith("__imp_")) {
+      OS << "import thunk for ";
+      if (tryDemangle(OS, DecoratedStr.drop_front(6)))
+        return;
+    }
+    OS << Mangled;
+  }
+
+  /// Demangles the words of Line separately, like demangleLine() above.
+  void demangleLine(raw_ostream &OS, StringRef Line) {
+    Words.clear();
+    SplitStringDelims(Line, Words, IsLegalItaniumChar);
+    for (const auto &Word : Words) {
+      demangle(OS, Word.first);
+      OS << Word.second;
+    }
+    OS << '\n';
+  }
+
+private:
+  SmallVector<std::pair<StringRef, StringRef>, 16> Words;
+};
+} // namespace
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
   cl::ParseCommandLineOptions(argc, argv, "llvm symbol undecoration tool\n");
 
-  if (Decorated.empty())
+  if (Decorated.empty() && Batch) {
+    std::ios_base::sync_with_stdio(false);
+    BatchDemangler Demangler;
+    for (std::string Mangled; std::getline(std::cin, Mangled);)
+      Demangler.demangleLine(llvm::outs(), Mangled);
+  } else if (Decorated.empty())
     for (std::string Mangled; std::getline(std::cin, Mangled);)
       demangleLine(llvm::outs(), Mangled, true);
   else
@@ -5,6 +5,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugLoc.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/ThreadPool.h"
 
 #define DEBUG_TYPE "dwarfdump"
 using namespace llvm;
@@ -306,6 +307,86 @@ static void collectStatsRecursive(DWARFDie Die, std::string FnPrefix,
   }
 }
 
+/// Add the statistics of \p From to \p Into.
+static void mergeStats(PerFunctionStats &Into, const PerFunctionStats &From) {
+  Into.NumFnInlined += From.NumFnInlined;
+  Into.NumAbstractOrigins += From.NumAbstractOrigins;
+  Into.TotalVarWithLoc += From.TotalVarWithLoc;
+  Into.ConstantMembers += From.ConstantMembers;
+  for (const auto &Var : From.VarsInFunction)
+    Into.VarsInFunction.insert(Var.getKey());
+  Into.IsFunction |= From.IsFunction;
+  Into.HasPCAddresses |= From.HasPCAddresses;
+  Into.HasSourceLocation |= From.HasSourceLocation;
+  Into.NumParams += From.NumParams;
+  Into.NumParamSourceLocations += From.NumParamSourceLocations;
+  Into.NumParamTypes += From.NumParamTypes;
+  Into.NumParamLocations += From.NumParamLocations;
+  Into.NumVars += From.NumVars;
+  Into.NumVarSourceLocations += From.NumVarSourceLocations;
+  Into.NumVarTypes += From.NumVarTypes;
+  Into.NumVarLocations += From.NumVarLocations;
+}
+
+static void mergeStats(GlobalStats &Into, const GlobalStats &From) {
+  Into.ScopeBytesCovered += From.ScopeBytesCovered;
+  Into.ScopeBytesFromFirstDefinition += From.ScopeBytesFromFirstDefinition;
+  Into.CallSiteEntries += From.CallSiteEntries;
+  Into.CallSiteDIEs += From.CallSiteDIEs;
+  Into.CallSiteParamDIEs += From.CallSiteParamDIEs;
+  Into.FunctionSize += From.FunctionSize;
+  Into.InlineFunctionSize += From.InlineFunctionSize;
+}
+
+/// Collect the statistics of every compile unit on \p NumThreads threads.
+/// Each unit gets its own maps, which are merged in unit order afterwards.
+/// Returns false, without collecting anything, if the units can't be walked
+/// concurrently.
+static bool collectStatsInParallel(DWARFContext &DICtx, unsigned NumThreads,
+                                   StringMap<PerFunctionStats> &FnStatMap,
+                                   GlobalStats &GlobalStats) {
+  // Split units pull in state of their skeleton and of the .dwo context
+  // lazily, so leave them to the serial walk.
+  SmallVector<DWARFUnit *, 16> Units;
+  for (const auto &CU : DICtx.compile_units()) {
+    DWARFDie CUDie = CU->getNonSkeletonUnitDIE();
+    if (!CUDie)
+      continue;
+    if (CUDie.getDwarfUnit() != CU.get())
+      return false;
+    Units.push_back(CU.get());
+  }
+  if (Units.empty())
+    return true;
+
+  // Everything shared between the units is parsed lazily, so set it up before
+  // starting any thread. DIEs may refer to DIEs of other units, so all of them
+  // are extracted before any unit is walked.
+  DICtx.getDebugLoc();
+  for (DWARFUnit *Unit : Units)
+    Unit->getAbbreviations();
+  ThreadPool Pool(std::min<size_t>(NumThreads, Units.size()));
+  for (DWARFUnit *Unit : Units)
+    Pool.async([Unit]() { Unit->getUnitDIE(/*ExtractUnitDIEOnly=*/false); });
+  Pool.wait();
+
+  std::vector<StringMap<PerFunctionStats>> UnitFnStats(Units.size());
+  std::vector<struct GlobalStats> UnitGlobalStats(Units.size());
+  for (size_t I = 0, E = Units.size(); I != E; ++I)
+    Pool.async([&, I]() {
+      collectStatsRecursive(Units[I]->getUnitDIE(), "/", "g", 0, 0, 0,
+                            UnitFnStats[I], UnitGlobalStats[I]);
+    });
+  Pool.wait();
+
+  for (size_t I = 0, E = Units.size(); I != E; ++I) {
+    for (const auto &Entry : UnitFnStats[I])
+      mergeStats(FnStatMap[Entry.getKey()], Entry.getValue());
+    mergeStats(GlobalStats, UnitGlobalStats[I]);
+  }
+  return true;
+}
+
 /// Print machine-readable output.
 /// The machine-readable format is single-line JSON output.
 /// \{
@@ -327,14 +408,21 @@ static void printDatum(raw_ostream &OS, const char *Key, uint64_t Value) {
 /// of particular optimizations. The raw numbers themselves are not particularly
 /// useful, only the delta between compiling the same program with different
 /// compilers is.
+///
+/// With \p NumThreads greater than one the compile units are walked in
+/// parallel. The result is the same as with a serial walk.
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS) {
+                               Twine Filename, raw_ostream &OS,
+                               unsigned NumThreads) {
   StringRef FormatName = Obj.getFileFormatName();
   GlobalStats GlobalStats;
   StringMap<PerFunctionStats> Statistics;
-  for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
-    if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(false))
-      collectStatsRecursive(CUDie, "/", "g", 0, 0, 0, Statistics, GlobalStats);
+  if (NumThreads <= 1 ||
+      !collectStatsInParallel(DICtx, NumThreads, Statistics, GlobalStats))
+    for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
+      if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(false))
+        collectStatsRecursive(CUDie, "/", "g", 0, 0, 0, Statistics,
+                              GlobalStats);
 
   /// The version number should be increased every time the algorithm is changed
   /// (including bug fixes). New metrics may be added without increasing the
@@ -39,6 +39,8 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
@@ -61,6 +63,12 @@ static cl::opt<std::string> OutputFilename(cl::Required, "o",
                                            cl::value_desc("filename"),
                                            cl::cat(DwpCategory));
 
+static cl::opt<unsigned> NumThreads(
+    "j", cl::init(0),
+    cl::desc("Number of threads used to read the input files "
+             "(0 = number of hardware threads)"),
+    cl::value_desc("threads"), cl::cat(DwpCategory));
+
 static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
                                    MCSection *StrOffsetSection,
                                    StringRef CurStrSection,
@@ -389,36 +397,57 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
-  if (Section.isBSS())
-    return Error::success();
+/// The sections of one input file, read in and decompressed ahead of the merge.
+struct LoadedInput {
+  OwningBinary<object::ObjectFile> Obj;
+  std::deque<SmallString<32>> UncompressedSections;
+  /// The name and contents of every section with contents.
+  std::vector<std::pair<StringRef, StringRef>> Sections;
+};
 
-  if (Section.isVirtual())
-    return Error::success();
+static Expected<std::unique_ptr<LoadedInput>> loadInput(StringRef Input) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+
+  auto In = std::make_unique<LoadedInput>();
+  In->Obj = std::move(*ErrOrObj);
+  for (const auto &Section : In->Obj.getBinary()->sections()) {
+    if (Section.isBSS())
+      continue;
+
+    if (Section.isVirtual())
+      continue;
 
-  Expected<StringRef> NameOrErr = Section.getName();
-  if (!NameOrErr)
-    return NameOrErr.takeError();
-  StringRef Name = *NameOrErr;
+    Expected<StringRef> NameOrErr = Section.getName();
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    StringRef Name = *NameOrErr;
 
-  Expected<StringRef> ContentsOrErr = Section.getContents();
-  if (!ContentsOrErr)
-    return ContentsOrErr.takeError();
-  StringRef Contents = *ContentsOrErr;
+    Expected<StringRef> ContentsOrErr = Section.getContents();
+    if (!ContentsOrErr)
+      return ContentsOrErr.takeError();
+    StringRef Contents = *ContentsOrErr;
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
-    return Err;
+    if (auto Err =
+            handleCompressedSection(In->UncompressedSections, Name, Contents))
+      return std::move(Err);
 
+    In->Sections.emplace_back(Name, Contents);
+  }
+  return std::move(In);
+}
+
+static Error handleSection(
+    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
+    const MCSection *StrSection, const MCSection *StrOffsetSection,
+    const MCSection *TypesSection, const MCSection *CUIndexSection,
+    const MCSection *TUIndexSection, StringRef Name, StringRef Contents,
+    MCStreamer &Out, uint32_t (&ContributionOffsets)[8],
+    UnitIndexEntry &CurEntry, StringRef &CurStrSection,
+    StringRef &CurStrOffsetSection, std::vector<StringRef> &CurTypesSection,
+    StringRef &InfoSection, StringRef &AbbrevSection,
+    StringRef &CurCUIndexSection, StringRef &CurTUIndexSection) {
   Name = Name.substr(Name.find_first_not_of("._"));
 
   auto SectionPair = KnownSections.find(Name);
@@ -527,18 +556,8 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
-
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
-
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+  auto MergeInput = [&](StringRef Input, const LoadedInput &In) -> Error {
+    const ObjectFile &Obj = *In.Obj.getBinary();
 
     UnitIndexEntry CurEntry = {};
 
@@ -550,17 +569,17 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
+    for (const auto &Section : In.Sections)
       if (auto Err = handleSection(
               KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
+              CUIndexSection, TUIndexSection, Section.first, Section.second,
+              Out, ContributionOffsets, CurEntry, CurStrSection,
+              CurStrOffsetSection, CurTypesSection, InfoSection, AbbrevSection,
+              CurCUIndexSection, CurTUIndexSection))
         return Err;
 
     if (InfoSection.empty())
-      continue;
+      return Error::success();
 
     writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
                            CurStrOffsetSection);
@@ -578,7 +597,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
       P.first->second.DWOName = ID.DWOName;
       addAllTypes(Out, TypeIndexEntries, TypesSection, CurTypesSection,
                   CurEntry, ContributionOffsets[DW_SECT_TYPES - DW_SECT_INFO]);
-      continue;
+      return Error::success();
     }
 
     DWARFUnitIndex CUIndex(DW_SECT_INFO);
@@ -624,6 +643,47 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
                          CurTypesSection.front(), CurEntry,
                          ContributionOffsets[DW_SECT_TYPES - DW_SECT_INFO]);
     }
+    return Error::success();
+  };
+
+  // Reading and decompressing the inputs doesn't depend on the merge, so a
+  // thread pool works a bounded number of inputs ahead of it. Each input is
+  // released once it has been merged, so only the inputs in flight are kept in
+  // memory.
+  unsigned Threads =
+      NumThreads ? NumThreads : llvm::thread::hardware_concurrency();
+  size_t Window = 2 * Threads;
+  ThreadPool Pool(Threads);
+  std::vector<Optional<Expected<std::unique_ptr<LoadedInput>>>> Loaded(
+      Inputs.size());
+  std::vector<std::shared_future<void>> Futures(Inputs.size());
+  auto ScheduleLoad = [&](size_t I) {
+    if (I < Inputs.size())
+      Futures[I] =
+          Pool.async([&, I]() { Loaded[I].emplace(loadInput(Inputs[I])); });
+  };
+  auto Abandon = [&]() {
+    Pool.wait();
+    for (auto &L : Loaded)
+      if (L && !*L)
+        consumeError(L->takeError());
+  };
+
+  for (size_t I = 0; I != Window; ++I)
+    ScheduleLoad(I);
+  for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+    Futures[I].wait();
+    Expected<std::unique_ptr<LoadedInput>> In = std::move(*Loaded[I]);
+    Loaded[I].reset();
+    if (!In) {
+      Abandon();
+      return In.takeError();
+    }
+    if (auto Err = MergeInput(Inputs[I], **In)) {
+      Abandon();
+      return Err;
+    }
+    ScheduleLoad(I + Window);
   }
 
   // Lie about there being no info contributions so the TU index only includes
@@ -11,6 +11,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Support/FormatVariadic.h"
+#include <cmath>
 #include <limits>
 #include <unordered_set>
 #include <vector>
@@ -161,11 +162,14 @@ Analysis::Analysis(const llvm::Target &Target,
                    std::unique_ptr<llvm::MCInstrInfo> InstrInfo,
                    const InstructionBenchmarkClustering &Clustering,
                    double AnalysisInconsistencyEpsilon,
-                   bool AnalysisDisplayUnstableOpcodes)
+                   bool AnalysisDisplayUnstableOpcodes,
+                   llvm::StringRef AnalysisSchedModelName)
     : Clustering_(Clustering), InstrInfo_(std::move(InstrInfo)),
+      AnalysisInconsistencyEpsilon_(AnalysisInconsistencyEpsilon),
       AnalysisInconsistencyEpsilonSquared_(AnalysisInconsistencyEpsilon *
                                            AnalysisInconsistencyEpsilon),
-      AnalysisDisplayUnstableOpcodes_(AnalysisDisplayUnstableOpcodes) {
+      AnalysisDisplayUnstableOpcodes_(AnalysisDisplayUnstableOpcodes),
+      AnalysisSchedModelName_(AnalysisSchedModelName) {
   if (Clustering.getPoints().empty())
     return;
 
@@ -250,6 +254,37 @@ Analysis::makePointsPerSchedClass() const {
   return Entries;
 }
 
+std::vector<Analysis::SchedClassCluster> Analysis::makeSchedClassClusters(
+    const ResolvedSchedClassAndPoints &RSCAndPoints, bool Unstable) const {
+  std::vector<SchedClassCluster> SchedClassClusters;
+  for (const size_t PointId : RSCAndPoints.PointIds) {
+    const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
+    if (!ClusterId.isValid())
+      continue; // Ignore noise and errors. FIXME: take noise into account ?
+    if (ClusterId.isUnstable() ^ Unstable)
+      continue; // Either keep stable or unstable clusters only.
+    auto SchedClassClusterIt =
+        std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
+                     [ClusterId](const SchedClassCluster &C) {
+                       return C.id() == ClusterId;
+                     });
+    if (SchedClassClusterIt == SchedClassClusters.end()) {
+      SchedClassClusters.emplace_back();
+      SchedClassClusterIt = std::prev(SchedClassClusters.end());
+    }
+    SchedClassClusterIt->addPoint(PointId, Clustering_);
+  }
+  return SchedClassClusters;
+}
+
+bool Analysis::allClustersMatch(const std::vector<SchedClassCluster> &Clusters,
+                                const ResolvedSchedClass &RSC) const {
+  return llvm::all_of(Clusters, [this, &RSC](const SchedClassCluster &C) {
+    return C.measurementsMatch(*SubtargetInfo_, RSC, Clustering_,
+                               AnalysisInconsistencyEpsilonSquared_);
+  });
+}
+
 // Uops repeat the same opcode over again. Just show this opcode and show the
 // whole snippet only on hover.
 static void writeUopsSnippetHtml(llvm::raw_ostream &OS,
@@ -515,33 +550,12 @@ llvm::Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
     if (!RSCAndPoints.RSC.SCDesc)
       continue;
     // Bucket sched class points into sched class clusters.
-    std::vector<SchedClassCluster> SchedClassClusters;
-    for (const size_t PointId : RSCAndPoints.PointIds) {
-      const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
-      if (!ClusterId.isValid())
-        continue; // Ignore noise and errors. FIXME: take noise into account ?
-      if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
-        continue; // Either display stable or unstable clusters only.
-      auto SchedClassClusterIt =
-          std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
-                       [ClusterId](const SchedClassCluster &C) {
-                         return C.id() == ClusterId;
-                       });
-      if (SchedClassClusterIt == SchedClassClusters.end()) {
-        SchedClassClusters.emplace_back();
-        SchedClassClusterIt = std::prev(SchedClassClusters.end());
-      }
-      SchedClassClusterIt->addPoint(PointId, Clustering_);
-    }
+    const std::vector<SchedClassCluster> SchedClassClusters =
+        makeSchedClassClusters(RSCAndPoints, AnalysisDisplayUnstableOpcodes_);
 
     // Print any scheduling class that has at least one cluster that does not
     // match the checked-in data.
-    if (llvm::all_of(SchedClassClusters,
-                     [this, &RSCAndPoints](const SchedClassCluster &C) {
-                       return C.measurementsMatch(
-                           *SubtargetInfo_, RSCAndPoints.RSC, Clustering_,
-                           AnalysisInconsistencyEpsilonSquared_);
-                     }))
+    if (allClustersMatch(SchedClassClusters, RSCAndPoints.RSC))
       continue; // Nothing weird.
 
     OS << "<div class=\"inconsistency\"><p>Sched Class <span "
@@ -563,5 +577,141 @@ llvm::Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   return llvm::Error::success();
 }
 
+// Returns the largest spread (max - min) of the measurements of a cluster,
+// relative to their average.
+static double getRelativeSpread(const SchedClassClusterCentroid &Centroid) {
+  double Spread = 0.0;
+  for (const PerInstructionStats &Stats : Centroid.getStats())
+    if (Stats.avg() > 0.0)
+      Spread = std::max(Spread, (Stats.max() - Stats.min()) / Stats.avg());
+  return Spread;
+}
+
+void Analysis::printSchedModelPatchGroup(const SchedClassCluster &Cluster,
+                                         const ResolvedSchedClass &RSC,
+                                         unsigned GroupId,
+                                         llvm::raw_ostream &OS) const {
+  const auto &Points = Clustering_.getPoints();
+  const auto &SM = SubtargetInfo_->getSchedModel();
+  const InstructionBenchmark::ModeE Mode = Points[0].Mode;
+  const SchedClassClusterCentroid &Centroid = Cluster.getCentroid();
+
+  std::set<llvm::StringRef> Opcodes;
+  for (const size_t PointId : Cluster.getPointIds())
+    Opcodes.insert(
+        InstrInfo_->getName(Points[PointId].keyInstruction().getOpcode()));
+
+  // The confidence in a proposal depends on how consistent the measurements
+  // within the cluster are and on how many measurements there are.
+  const size_t NumPoints = Cluster.getPointIds().size();
+  const double Spread = getRelativeSpread(Centroid);
+  const char *Confidence = Spread > AnalysisInconsistencyEpsilon_
+                               ? "low"
+                               : NumPoints >= 3 ? "high" : "medium";
+  OS << "// Cluster " << Cluster.id().getId() << ": " << NumPoints
+     << " points, relative spread "
+     << llvm::formatv("{0:P}", Spread) << ", confidence " << Confidence
+     << ".\n";
+  for (const PerInstructionStats &Stats : Centroid.getStats())
+    OS << "//   " << Stats.key() << ": "
+       << llvm::formatv("{0:F} [{1:F}; {2:F}]", Stats.avg(), Stats.min(),
+                        Stats.max())
+       << "\n";
+
+  // Start from the current scheduling information and replace what was
+  // measured.
+  long Latency = 0;
+  for (unsigned I = 0; I < RSC.SCDesc->NumWriteLatencyEntries; ++I)
+    Latency = std::max<long>(
+        Latency, SubtargetInfo_->getWriteLatencyEntry(RSC.SCDesc, I)->Cycles);
+  long NumMicroOps = RSC.SCDesc->NumMicroOps;
+  switch (Mode) {
+  case InstructionBenchmark::Latency:
+    Latency = std::lround(Centroid.getStats()[0].avg());
+    break;
+  case InstructionBenchmark::Uops:
+    for (const PerInstructionStats &Stats : Centroid.getStats())
+      if (Stats.key() == "NumMicroOps")
+        NumMicroOps = std::lround(Stats.avg());
+    break;
+  case InstructionBenchmark::InverseThroughput:
+    OS << "// The inverse throughput follows from the resource cycles, adjust "
+          "them by hand\n// (the model has "
+       << llvm::formatv("{0:F}", MCSchedModel::getReciprocalThroughput(
+                                     *SubtargetInfo_, *RSC.SCDesc))
+       << ").\n";
+    break;
+  default:
+    llvm_unreachable("invalid mode");
+  }
+
+  const std::string Name = ("ExegesisWriteResGroup" + Twine(GroupId)).str();
+  SmallVector<std::string, 8> Resources, ResourceCycles;
+  for (const auto &WPR : RSC.NonRedundantWriteProcRes) {
+    Resources.push_back(SM.getProcResource(WPR.ProcResourceIdx)->Name);
+    ResourceCycles.push_back(std::to_string(WPR.Cycles));
+  }
+  OS << "def " << Name << " : SchedWriteRes<[" << llvm::join(Resources, ", ")
+     << "]> {\n";
+  OS << "  let Latency = " << Latency << ";\n";
+  OS << "  let NumMicroOps = " << NumMicroOps << ";\n";
+  OS << "  let ResourceCycles = [" << llvm::join(ResourceCycles, ", ")
+     << "];\n";
+  OS << "}\n";
+  OS << "def : InstRW<[" << Name << "], (instrs "
+     << llvm::join(Opcodes.begin(), Opcodes.end(), ", ") << ")>;\n\n";
+}
+
+template <>
+llvm::Error
+Analysis::run<Analysis::PrintSchedModelPatch>(llvm::raw_ostream &OS) const {
+  if (Clustering_.getPoints().empty())
+    return llvm::Error::success();
+
+  const auto &FirstPoint = Clustering_.getPoints()[0];
+  OS << "// Scheduling model changes proposed by llvm-exegesis for "
+     << FirstPoint.CpuName << " (" << FirstPoint.LLVMTriple << ") from "
+     << Clustering_.getPoints().size() << " benchmark points.\n";
+  OS << "// Review before applying: only stable clusters whose measurements "
+        "don't match\n// the scheduling model are listed.\n\n";
+  OS << "let SchedModel = "
+     << (AnalysisSchedModelName_.empty() ? "<SchedModel>"
+                                         : AnalysisSchedModelName_)
+     << " in {\n\n";
+
+  unsigned GroupId = 0;
+  for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
+    if (!RSCAndPoints.RSC.SCDesc || !RSCAndPoints.RSC.SCDesc->isValid())
+      continue;
+    // Unstable opcodes don't have a single set of measurements to propose.
+    const std::vector<SchedClassCluster> SchedClassClusters =
+        makeSchedClassClusters(RSCAndPoints, /*Unstable=*/false);
+    if (allClustersMatch(SchedClassClusters, RSCAndPoints.RSC))
+      continue;
+
+    OS << "// Sched class ";
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+    OS << RSCAndPoints.RSC.SCDesc->Name;
+#else
+    OS << RSCAndPoints.RSC.SchedClassId;
+#endif
+    OS << ".\n";
+    // Overriding an instruction drops the predicates of variant sched
+    // classes, so these have to be fixed by hand.
+    if (RSCAndPoints.RSC.WasVariant) {
+      OS << "// Skipped: the sched class is variant.\n\n";
+      continue;
+    }
+    for (const SchedClassCluster &Cluster : SchedClassClusters)
+      if (!Cluster.measurementsMatch(*SubtargetInfo_, RSCAndPoints.RSC,
+                                     Clustering_,
+                                     AnalysisInconsistencyEpsilonSquared_))
+        printSchedModelPatchGroup(Cluster, RSCAndPoints.RSC, GroupId++, OS);
+  }
+
+  OS << "} // SchedModel\n";
+  return llvm::Error::success();
+}
+
 } // namespace exegesis
 } // namespace llvm
@@ -40,12 +40,16 @@ public:
            std::unique_ptr<llvm::MCInstrInfo> InstrInfo,
            const InstructionBenchmarkClustering &Clustering,
            double AnalysisInconsistencyEpsilon,
-           bool AnalysisDisplayUnstableOpcodes);
+           bool AnalysisDisplayUnstableOpcodes,
+           llvm::StringRef AnalysisSchedModelName = "");
 
   // Prints a csv of instructions for each cluster.
   struct PrintClusters {};
   // Find potential errors in the scheduling information given measurements.
   struct PrintSchedClassInconsistencies {};
+  // Propose TableGen overrides for the scheduling classes whose measurements
+  // don't match the scheduling information.
+  struct PrintSchedModelPatch {};
 
   template <typename Pass> llvm::Error run(llvm::raw_ostream &OS) const;
 
@@ -102,6 +106,22 @@ private:
   // Builds a list of ResolvedSchedClassAndPoints.
   std::vector<ResolvedSchedClassAndPoints> makePointsPerSchedClass() const;
 
+  // Buckets the valid points of a sched class into sched class clusters,
+  // keeping either only stable or only unstable clusters.
+  std::vector<SchedClassCluster>
+  makeSchedClassClusters(const ResolvedSchedClassAndPoints &RSCAndPoints,
+                         bool Unstable) const;
+
+  // Returns true if all the clusters match the scheduling information.
+  bool allClustersMatch(const std::vector<SchedClassCluster> &Clusters,
+                        const ResolvedSchedClass &RSC) const;
+
+  // Prints a SchedWriteRes/InstRW pair overriding the scheduling information
+  // of the opcodes in Cluster with its measurements.
+  void printSchedModelPatchGroup(const SchedClassCluster &Cluster,
+                                 const ResolvedSchedClass &RSC,
+                                 unsigned GroupId, llvm::raw_ostream &OS) const;
+
   template <typename EscapeTag, EscapeTag Tag>
   void writeSnippet(llvm::raw_ostream &OS, llvm::ArrayRef<uint8_t> Bytes,
                     const char *Separator) const;
@@ -115,8 +135,10 @@ private:
   std::unique_ptr<llvm::MCAsmInfo> AsmInfo_;
   std::unique_ptr<llvm::MCInstPrinter> InstPrinter_;
   std::unique_ptr<llvm::MCDisassembler> Disasm_;
+  const double AnalysisInconsistencyEpsilon_;
   const double AnalysisInconsistencyEpsilonSquared_;
   const bool AnalysisDisplayUnstableOpcodes_;
+  const std::string AnalysisSchedModelName_;
 };
 
 } // namespace exegesis
@@ -123,6 +123,17 @@ static cl::opt<std::string>
     AnalysisInconsistenciesOutputFile("analysis-inconsistencies-output-file",
                                       cl::desc(""), cl::cat(AnalysisOptions),
                                       cl::init(""));
+static cl::opt<std::string> AnalysisSchedModelPatchOutputFile(
+    "analysis-sched-model-patch-output-file",
+    cl::desc("write TableGen overrides (SchedWriteRes/InstRW) for the "
+             "scheduling classes that don't match the measurements to this "
+             "file"),
+    cl::cat(AnalysisOptions), cl::init(""));
+static cl::opt<std::string> AnalysisSchedModelName(
+    "analysis-sched-model-name",
+    cl::desc("the TableGen SchedMachineModel the proposed overrides are for, "
+             "e.g. SKXModel"),
+    cl::cat(AnalysisOptions), cl::init(""));
 
 static cl::opt<bool> AnalysisDisplayUnstableOpcodes(
     "analysis-display-unstable-clusters",
@@ -444,10 +455,12 @@ static void analysisMain() {
     llvm::report_fatal_error("--benchmarks-file must be set.");
 
   if (AnalysisClustersOutputFile.empty() &&
-      AnalysisInconsistenciesOutputFile.empty()) {
+      AnalysisInconsistenciesOutputFile.empty() &&
+      AnalysisSchedModelPatchOutputFile.empty()) {
     llvm::report_fatal_error(
-        "At least one of --analysis-clusters-output-file and "
-        "--analysis-inconsistencies-output-file must be specified.");
+        "At least one of --analysis-clusters-output-file, "
+        "--analysis-inconsistencies-output-file and "
+        "--analysis-sched-model-patch-output-file must be specified.");
   }
 
   llvm::InitializeNativeTarget();
@@ -481,13 +494,16 @@ static void analysisMain() {
 
   const Analysis Analyzer(*TheTarget, std::move(InstrInfo), Clustering,
                           AnalysisInconsistencyEpsilon,
-                          AnalysisDisplayUnstableOpcodes);
+                          AnalysisDisplayUnstableOpcodes,
+                          AnalysisSchedModelName);
 
   maybeRunAnalysis<Analysis::PrintClusters>(Analyzer, "analysis clusters",
                                             AnalysisClustersOutputFile);
   maybeRunAnalysis<Analysis::PrintSchedClassInconsistencies>(
       Analyzer, "sched class consistency analysis",
       AnalysisInconsistenciesOutputFile);
+  maybeRunAnalysis<Analysis::PrintSchedModelPatch>(
+      Analyzer, "sched model patch", AnalysisSchedModelPatchOutputFile);
 }
 
 } // namespace exegesis
@@ -0,0 +1,158 @@
+//===-- llvm-gsymutil.cpp - GSYM dumping and creation utility for llvm ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This program creates GSYM files from the DWARF and symbol tables of object
+// files, and dumps GSYM files or looks up addresses in them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/BinaryFormat/Magic.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/DwarfTransformer.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include "llvm/DebugInfo/GSYM/ObjectFileTransformer.h"
+#include "llvm/Object/Binary.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/thread.h"
+
+using namespace llvm;
+using namespace gsym;
+using namespace object;
+
+namespace {
+cl::OptionCategory GsymCat("Specific Options");
+
+static cl::list<std::string>
+    InputFilenames(cl::Positional, cl::desc("<input object or GSYM files>"),
+                   cl::ZeroOrMore, cl::cat(GsymCat));
+
+static cl::opt<std::string>
+    OutputFilename("out-file",
+                   cl::desc("Path of the GSYM file created from an object "
+                            "file (default: <input>.gsym)"),
+                   cl::value_desc("path"), cl::cat(GsymCat));
+static cl::alias OutputFilenameAlias("o", cl::desc("Alias for -out-file"),
+                                     cl::aliasopt(OutputFilename));
+
+static cl::list<std::string>
+    LookupAddresses("address",
+                    cl::desc("Look up an address in the GSYM input files "
+                             "instead of dumping them"),
+                    cl::value_desc("addr"), cl::ZeroOrMore, cl::cat(GsymCat));
+
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of threads to use when converting DWARF. "
+                        "0 means to use as many threads as the machine has "
+                        "cores"),
+               cl::init(0), cl::cat(GsymCat));
+static cl::alias NumThreadsAlias("j", cl::desc("Alias for -num-threads"),
+                                 cl::aliasopt(NumThreads));
+
+static cl::opt<bool> Verbose("verbose",
+                             cl::desc("Print the conversion log"),
+                             cl::cat(GsymCat));
+} // namespace
+
+static void error(StringRef Prefix, llvm::Error Err) {
+  if (!Err)
+    return;
+  WithColor::error() << Prefix << ": " << toString(std::move(Err)) << "\n";
+  exit(1);
+}
+
+static unsigned getNumThreads() {
+  return NumThreads ? NumThreads : llvm::thread::hardware_concurrency();
+}
+
+static llvm::Error convertObjectFile(StringRef InputFile) {
+  Expected<OwningBinary<Binary>> BinOrErr = createBinary(InputFile);
+  if (!BinOrErr)
+    return BinOrErr.takeError();
+  auto *Obj = dyn_cast<ObjectFile>(BinOrErr->getBinary());
+  if (!Obj)
+    return createStringError(std::errc::invalid_argument,
+                             "unsupported file format");
+
+  raw_ostream &Log = Verbose ? outs() : nulls();
+  GsymCreator Gsym;
+  if (llvm::Error Err = ObjectFileTransformer::convert(*Obj, Log, Gsym))
+    return Err;
+  std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(*Obj);
+  DwarfTransformer DT(*DICtx, Log, Gsym);
+  if (llvm::Error Err = DT.convert(getNumThreads()))
+    return Err;
+  if (llvm::Error Err = Gsym.finalize(Log))
+    return Err;
+
+  std::string OutFile =
+      OutputFilename.empty() ? (InputFile + ".gsym").str() : OutputFilename;
+  const auto ByteOrder = Obj->isLittleEndian() ? support::little
+                                               : support::big;
+  return Gsym.save(OutFile, ByteOrder);
+}
+
+static llvm::Error handleGsymFile(StringRef InputFile) {
+  Expected<GsymReader> ReaderOrErr = GsymReader::openFile(InputFile);
+  if (!ReaderOrErr)
+    return ReaderOrErr.takeError();
+  const GsymReader &Reader = *ReaderOrErr;
+  if (LookupAddresses.empty()) {
+    Reader.dump(outs());
+    return Error::success();
+  }
+  for (StringRef AddrStr : LookupAddresses) {
+    uint64_t Addr;
+    if (AddrStr.getAsInteger(0, Addr))
+      return createStringError(std::errc::invalid_argument,
+                               "invalid address '%s'", AddrStr.str().c_str());
+    if (Expected<LookupResult> Result = Reader.lookup(Addr))
+      outs() << *Result;
+    else
+      outs() << HEX64(Addr) << ": " << toString(Result.takeError()) << '\n';
+  }
+  return Error::success();
+}
+
+int main(int argc, char const *argv[]) {
+  InitLLVM X(argc, argv);
+
+  cl::HideUnrelatedOptions({&GsymCat});
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "Convert the DWARF and symbol tables of object files into GSYM files, "
+      "or dump GSYM files and look up addresses in them.\n");
+
+  if (InputFilenames.empty()) {
+    WithColor::error() << "no input files\n";
+    return 1;
+  }
+  if (!OutputFilename.empty() && InputFilenames.size() > 1) {
+    WithColor::error() << "-out-file can only be used with a single input\n";
+    return 1;
+  }
+
+  for (StringRef InputFile : InputFilenames) {
+    file_magic Magic;
+    if (std::error_code EC = identify_magic(InputFile, Magic))
+      error(InputFile, errorCodeToError(EC));
+    // GSYM files aren't one of the formats llvm::identify_magic knows about.
+    if (Magic == file_magic::unknown)
+      error(InputFile, handleGsymFile(InputFile));
+    else
+      error(InputFile, convertObjectFile(InputFile));
+  }
+  return 0;
+}
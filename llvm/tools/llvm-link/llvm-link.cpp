@@ -31,6 +31,7 @@
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_mmap_ostream.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
@@ -380,6 +381,32 @@ int main(int argc, char **argv) {
   if (DumpAsm)
     errs() << "Here's the assembly:\n" << *Composite;
 
+  if (verifyModule(*Composite, &errs())) {
+    errs() << argv[0] << ": ";
+    WithColor::error() << "linked module is broken!\n";
+    return 1;
+  }
+
+  // Write bitcode files through a mapping of the output file, so that the
+  // linked module does not have to be buffered in memory in its entirety
+  // before being written out.
+  if (!OutputAssembly && OutputFilename != "-") {
+    Expected<std::unique_ptr<raw_mmap_ostream>> OSOrErr =
+        raw_mmap_ostream::create(OutputFilename);
+    if (OSOrErr) {
+      if (Verbose)
+        errs() << "Writing bitcode...\n";
+      WriteBitcodeToFile(*Composite, **OSOrErr, PreserveBitcodeUseListOrder);
+      if (Error E = (*OSOrErr)->commit()) {
+        WithColor::error() << toString(std::move(E)) << '\n';
+        return 1;
+      }
+      return 0;
+    }
+    // Fall back to a regular file stream below.
+    consumeError(OSOrErr.takeError());
+  }
+
   std::error_code EC;
   ToolOutputFile Out(OutputFilename, EC, sys::fs::OF_None);
   if (EC) {
@@ -387,12 +414,6 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  if (verifyModule(*Composite, &errs())) {
-    errs() << argv[0] << ": ";
-    WithColor::error() << "linked module is broken!\n";
-    return 1;
-  }
-
   if (Verbose)
     errs() << "Writing bitcode...\n";
   if (OutputAssembly) {
@@ -25,6 +25,11 @@
 /// description; internally, regions are described by a range of source
 /// locations (SMLoc objects).
 ///
+/// A region description may end with `weight=<N>`, the relative execution
+/// frequency of the region (for example the profile count of the basic block
+/// the region was taken from). Weights are used to combine the results of
+/// several regions into a function summary.
+///
 /// An instruction (a MCInst) is added to a region R only if its location is in
 /// range [R.RangeStart, R.RangeEnd].
 //
@@ -50,6 +55,9 @@ namespace mca {
 class CodeRegion {
   // An optional descriptor for this region.
   llvm::StringRef Description;
+  // The relative execution frequency of this region, e.g. the profile count of
+  // the basic block it was extracted from.
+  uint64_t Weight;
   // Instructions that form this region.
   llvm::SmallVector<llvm::MCInst, 8> Instructions;
   // Source location range.
@@ -60,8 +68,8 @@ class CodeRegion {
   CodeRegion &operator=(const CodeRegion &) = delete;
 
 public:
-  CodeRegion(llvm::StringRef Desc, llvm::SMLoc Start)
-      : Description(Desc), RangeStart(Start), RangeEnd() {}
+  CodeRegion(llvm::StringRef Desc, llvm::SMLoc Start, uint64_t Weight = 1)
+      : Description(Desc), Weight(Weight), RangeStart(Start), RangeEnd() {}
 
   void addInstruction(const llvm::MCInst &Instruction) {
     Instructions.emplace_back(Instruction);
@@ -77,6 +85,7 @@ public:
   llvm::ArrayRef<llvm::MCInst> getInstructions() const { return Instructions; }
 
   llvm::StringRef getDescription() const { return Description; }
+  uint64_t getWeight() const { return Weight; }
 };
 
 class CodeRegionParseError final : public Error {};
@@ -104,7 +113,8 @@ public:
   const_iterator begin() const { return Regions.cbegin(); }
   const_iterator end() const { return Regions.cend(); }
 
-  void beginRegion(llvm::StringRef Description, llvm::SMLoc Loc);
+  void beginRegion(llvm::StringRef Description, llvm::SMLoc Loc,
+                   uint64_t Weight = 1);
   void endRegion(llvm::StringRef Description, llvm::SMLoc Loc);
   void addInstruction(const llvm::MCInst &Instruction);
   llvm::SourceMgr &getSourceMgr() const { return SM; }
@@ -102,8 +102,24 @@ void MCACommentConsumer::HandleComment(SMLoc Loc, StringRef CommentText) {
   Position = Comment.find_first_not_of(" \t");
   if (Position < Comment.size())
     Comment = Comment.drop_front(Position);
+
+  // An optional trailing `weight=<N>` sets the relative execution frequency of
+  // the region, which is used by the function summary.
+  const StringRef WeightPrefix = "weight=";
+  uint64_t Weight = 1;
+  StringRef Trimmed = Comment.rtrim(" \t");
+  size_t WeightPos = Trimmed.rfind(WeightPrefix);
+  if (WeightPos != StringRef::npos &&
+      (WeightPos == 0 || Trimmed[WeightPos - 1] == ' ' ||
+       Trimmed[WeightPos - 1] == '\t') &&
+      !Trimmed.drop_front(WeightPos + WeightPrefix.size())
+           .getAsInteger(10, Weight))
+    Comment = Trimmed.take_front(WeightPos).rtrim(" \t");
+  else
+    Weight = 1;
+
   // Use the rest of the string as a descriptor for this code snippet.
-  Regions.beginRegion(Comment, Loc);
+  Regions.beginRegion(Comment, Loc, Weight);
 }
 
 Expected<const CodeRegions &> AsmCodeRegionGenerator::parseCodeRegions() {
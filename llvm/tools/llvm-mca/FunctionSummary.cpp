@@ -0,0 +1,62 @@
+//===--------------------- FunctionSummary.cpp -----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file implements methods from the FunctionSummary interface.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FunctionSummary.h"
+#include "llvm/Support/Format.h"
+
+namespace llvm {
+namespace mca {
+
+void FunctionSummary::addRegion(unsigned Index, StringRef Description,
+                                uint64_t Weight, unsigned TotalCycles,
+                                unsigned Iterations, StringRef Bottleneck) {
+  double CyclesPerIteration =
+      Iterations ? (double)TotalCycles / Iterations : 0.0;
+  Regions.push_back(
+      {Index, Description, Weight, CyclesPerIteration, Bottleneck});
+}
+
+void FunctionSummary::print(raw_ostream &OS) const {
+  uint64_t TotalWeight = 0;
+  double WeightedCycles = 0.0;
+  for (const RegionResult &R : Regions) {
+    TotalWeight += R.Weight;
+    WeightedCycles += R.Weight * R.CyclesPerIteration;
+  }
+
+  OS << "\n\nFunction Summary";
+  OS << "\nRegions:                    " << Regions.size();
+  OS << "\nTotal Weight:               " << TotalWeight;
+  OS << "\nWeighted Cycles/Iteration:  "
+     << format("%.2f", TotalWeight ? WeightedCycles / TotalWeight : 0.0);
+
+  OS << "\n\n[Region]  Weight  Cycles/Iter  Share    Bottleneck\n";
+  for (const RegionResult &R : Regions) {
+    double Share =
+        WeightedCycles ? R.Weight * R.CyclesPerIteration * 100 / WeightedCycles
+                       : 0.0;
+    std::string Index = "[" + std::to_string(R.Index) + "]";
+    std::string SharePercent;
+    raw_string_ostream(SharePercent) << format("%.2f%%", Share);
+    OS << format("%-10s%-8s%-13.2f%-9s", Index.c_str(),
+                 std::to_string(R.Weight).c_str(), R.CyclesPerIteration,
+                 SharePercent.c_str())
+       << left_justify(R.Bottleneck.empty() ? "-" : R.Bottleneck, 19);
+    if (!R.Description.empty())
+      OS << "- " << R.Description;
+    OS << '\n';
+  }
+}
+
+} // namespace mca
+} // namespace llvm
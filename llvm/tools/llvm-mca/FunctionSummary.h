@@ -0,0 +1,68 @@
+//===----------------------- FunctionSummary.h -----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file implements class FunctionSummary.
+///
+/// A FunctionSummary combines the simulation results of several code regions,
+/// typically the loops and basic blocks of a single function, into one report.
+/// Each region contributes its simulated cycles per iteration, scaled by the
+/// region weight (see CodeRegion). Below is an example of a function summary:
+///
+///
+/// Function Summary
+/// Regions:                    2
+/// Total Weight:               1100
+/// Weighted Cycles/Iteration:  3.82
+///
+/// [Region]  Weight  Cycles/Iter  Share    Bottleneck
+/// [0]       1000    4.00         95.24%   Resource Pressure  - loop
+/// [1]       100     2.00         4.76%    None               - exit
+///
+///
+/// The share is the fraction of all the weighted cycles that are spent in a
+/// region, which points at the region to look at first.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_MCA_FUNCTIONSUMMARY_H
+#define LLVM_TOOLS_LLVM_MCA_FUNCTIONSUMMARY_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace mca {
+
+class FunctionSummary {
+  struct RegionResult {
+    unsigned Index;
+    StringRef Description;
+    uint64_t Weight;
+    double CyclesPerIteration;
+    StringRef Bottleneck;
+  };
+  SmallVector<RegionResult, 8> Regions;
+
+public:
+  /// Record the simulation result of region \p Index. \p Bottleneck is empty
+  /// if bottleneck analysis is disabled.
+  void addRegion(unsigned Index, StringRef Description, uint64_t Weight,
+                 unsigned TotalCycles, unsigned Iterations,
+                 StringRef Bottleneck);
+
+  bool empty() const { return Regions.empty(); }
+
+  void print(raw_ostream &OS) const;
+};
+
+} // namespace mca
+} // namespace llvm
+
+#endif
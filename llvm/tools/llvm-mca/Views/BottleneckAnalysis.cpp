@@ -563,6 +563,17 @@ void BottleneckAnalysis::onCycleEnd() {
   PressureIncreasedBecauseOfMemoryDependencies = false;
 }
 
+StringRef BottleneckAnalysis::getMainBottleneck() const {
+  if (!SeenStallCycles || !BPI.PressureIncreaseCycles)
+    return "None";
+  if (BPI.ResourcePressureCycles >= BPI.RegisterDependencyCycles &&
+      BPI.ResourcePressureCycles >= BPI.MemoryDependencyCycles)
+    return "Resource Pressure";
+  if (BPI.RegisterDependencyCycles >= BPI.MemoryDependencyCycles)
+    return "Register Dependencies";
+  return "Memory Dependencies";
+}
+
 void BottleneckAnalysis::printBottleneckHints(raw_ostream &OS) const {
   if (!SeenStallCycles || !BPI.PressureIncreaseCycles) {
     OS << "\n\nNo resource or data dependency bottlenecks discovered.\n";
@@ -330,6 +330,10 @@ public:
 
   void printView(raw_ostream &OS) const override;
 
+  /// Returns a short description of the most frequent cause of backend
+  /// pressure increases, or "None" if no bottleneck was discovered.
+  StringRef getMainBottleneck() const;
+
 #ifndef NDEBUG
   void dump(raw_ostream &OS, MCInstPrinter &MCIP) const { DG.dump(OS, MCIP); }
 #endif
@@ -22,6 +22,7 @@
 
 #include "CodeRegion.h"
 #include "CodeRegionGenerator.h"
+#include "FunctionSummary.h"
 #include "PipelinePrinter.h"
 #include "Views/BottleneckAnalysis.h"
 #include "Views/DispatchStatistics.h"
@@ -203,6 +204,12 @@ static cl::opt<bool> EnableBottleneckAnalysis(
     cl::desc("Enable bottleneck analysis (disabled by default)"),
     cl::cat(ViewOptions), cl::init(false));
 
+static cl::opt<bool> PrintFunctionSummary(
+    "function-summary",
+    cl::desc("Combine the results of all code regions into a function "
+             "summary, weighting each region by its `weight=` annotation"),
+    cl::cat(ViewOptions), cl::init(false));
+
 static cl::opt<bool> ShowEncoding(
     "show-encoding",
     cl::desc("Print encoding information in the instruction info view"),
@@ -269,13 +276,15 @@ static void processViewOptions() {
 }
 
 // Returns true on success.
-static bool runPipeline(mca::Pipeline &P) {
+static bool runPipeline(mca::Pipeline &P, unsigned *TotalCycles = nullptr) {
   // Handle pipeline errors here.
   Expected<unsigned> Cycles = P.run();
   if (!Cycles) {
     WithColor::error() << toString(Cycles.takeError());
     return false;
   }
+  if (TotalCycles)
+    *TotalCycles = *Cycles;
   return true;
 }
 
@@ -432,6 +441,9 @@ int main(int argc, char **argv) {
   // Number each region in the sequence.
   unsigned RegionIdx = 0;
 
+  // Results of all the regions, if a function summary was requested.
+  mca::FunctionSummary Summary;
+
   std::unique_ptr<MCCodeEmitter> MCE(
       TheTarget->createMCCodeEmitter(*MCII, *MRI, Ctx));
 
@@ -445,6 +457,7 @@ int main(int argc, char **argv) {
 
     // Don't print the header of this region if it is the default region, and
     // it doesn't have an end location.
+    unsigned CurrentRegionIdx = RegionIdx;
     if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
       TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
       StringRef Desc = Region->getDescription();
@@ -513,9 +526,12 @@ int main(int argc, char **argv) {
       Printer.addView(
           std::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
 
+    mca::BottleneckAnalysis *Bottlenecks = nullptr;
     if (EnableBottleneckAnalysis) {
-      Printer.addView(std::make_unique<mca::BottleneckAnalysis>(
-          *STI, *IP, Insts, S.getNumIterations()));
+      auto BA = std::make_unique<mca::BottleneckAnalysis>(
+          *STI, *IP, Insts, S.getNumIterations());
+      Bottlenecks = BA.get();
+      Printer.addView(std::move(BA));
     }
 
     if (PrintInstructionInfoView)
@@ -546,15 +562,24 @@ int main(int argc, char **argv) {
           TimelineMaxCycles));
     }
 
-    if (!runPipeline(*P))
+    unsigned TotalCycles;
+    if (!runPipeline(*P, &TotalCycles))
       return 1;
 
     Printer.printReport(TOF->os());
 
+    if (PrintFunctionSummary)
+      Summary.addRegion(CurrentRegionIdx, Region->getDescription(),
+                        Region->getWeight(), TotalCycles, S.getNumIterations(),
+                        Bottlenecks ? Bottlenecks->getMainBottleneck() : "");
+
     // Clear the InstrBuilder internal state in preparation for another round.
     IB.clear();
   }
 
+  if (!Summary.empty())
+    Summary.print(TOF->os());
+
   TOF->keep();
   return 0;
 }
@@ -7,10 +7,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "Buffer.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
 #include <memory>
 
 namespace llvm {
@@ -18,6 +20,10 @@ namespace objcopy {
 
 Buffer::~Buffer() {}
 
+void Buffer::writeData(uint64_t Offset, ArrayRef<uint8_t> Data) {
+  llvm::copy(Data, getBufferStart() + Offset);
+}
+
 static Error createEmptyFile(StringRef FileName) {
   // Create an empty tempfile and atomically swap it in place with the desired
   // output file.
@@ -60,6 +66,85 @@ uint8_t *FileBuffer::getBufferStart() {
   return reinterpret_cast<uint8_t *>(Buf->getBufferStart());
 }
 
+Error StreamedFileBuffer::allocate(size_t Size) {
+  this->Size = Size;
+  // As for FileBuffer, a 0-sized file is only created on commit().
+  if (Size == 0)
+    return Error::success();
+
+  // Anonymous memory reads as zeroes and costs nothing until it is touched,
+  // so the deferred ranges never occupy any memory.
+  std::error_code EC;
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(
+      Size, nullptr, sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC)
+    return createFileError(getName(), EC);
+  Mem = sys::OwningMemoryBlock(MB);
+  return Error::success();
+}
+
+uint8_t *StreamedFileBuffer::getBufferStart() {
+  return reinterpret_cast<uint8_t *>(Mem.base());
+}
+
+void StreamedFileBuffer::writeData(uint64_t Offset, ArrayRef<uint8_t> Data) {
+  assert(Offset + Data.size() <= Size && "write past the end of the buffer");
+  if (Data.empty())
+    return;
+
+  // The last write to a byte wins, so copy the deferred ranges this one
+  // overlaps into the buffer before deferring it.
+  auto I = Deferred.upper_bound(Offset);
+  if (I != Deferred.begin()) {
+    auto Prev = std::prev(I);
+    if (Prev->first + Prev->second.size() > Offset)
+      I = Prev;
+  }
+  while (I != Deferred.end() && I->first < Offset + Data.size()) {
+    llvm::copy(I->second, getBufferStart() + I->first);
+    I = Deferred.erase(I);
+  }
+  Deferred[Offset] = Data;
+}
+
+Error StreamedFileBuffer::commit() {
+  if (Size == 0)
+    return createEmptyFile(getName());
+
+  // Write to a temporary and rename it over the output, the same way
+  // FileOutputBuffer does, so that the deferred data may come from the file
+  // being replaced.
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      getName() + ".tmp%%%%%%%",
+      sys::fs::all_read | sys::fs::all_write | sys::fs::all_exe);
+  if (!Temp)
+    return createFileError(getName(), Temp.takeError());
+
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    const char *Start = reinterpret_cast<const char *>(getBufferStart());
+    uint64_t Pos = 0;
+    for (const auto &D : Deferred) {
+      OS.write(Start + Pos, D.first - Pos);
+      OS.write(reinterpret_cast<const char *>(D.second.data()),
+               D.second.size());
+      Pos = D.first + D.second.size();
+    }
+    OS.write(Start + Pos, Size - Pos);
+    OS.flush();
+    if (std::error_code EC = OS.error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return createFileError(getName(), EC);
+    }
+  }
+  Deferred.clear();
+
+  if (Error E = Temp->keep(getName()))
+    return createFileError(getName(), std::move(E));
+  return Error::success();
+}
+
 Error MemBuffer::allocate(size_t Size) {
   Buf = WritableMemoryBuffer::getNewMemBuffer(Size, getName());
   return Error::success();
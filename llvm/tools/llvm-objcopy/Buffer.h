@@ -9,9 +9,12 @@
 #ifndef LLVM_TOOLS_OBJCOPY_BUFFER_H
 #define LLVM_TOOLS_OBJCOPY_BUFFER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/Memory.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <map>
 #include <memory>
 
 namespace llvm {
@@ -31,6 +34,11 @@ public:
   virtual uint8_t *getBufferStart() = 0;
   virtual Error commit() = 0;
 
+  // Copy Data to Offset in the buffer. Data must stay alive until commit() is
+  // called, which lets buffers defer the copy and write large unmodified
+  // contents straight from the input when the output is committed.
+  virtual void writeData(uint64_t Offset, ArrayRef<uint8_t> Data);
+
   explicit Buffer(StringRef Name) : Name(Name) {}
   StringRef getName() const { return Name; }
 };
@@ -49,6 +57,29 @@ public:
   explicit FileBuffer(StringRef FileName) : Buffer(FileName) {}
 };
 
+// The class StreamedFileBuffer writes a file with sequential writes instead of
+// through a mapping of the whole output. The data passed to writeData() is
+// not copied into the buffer but written from where it lives when the buffer
+// is committed, so stripping a huge file doesn't copy its unmodified sections
+// twice. Writes through getBufferStart() must not overlap the deferred data.
+// The file is written to a temporary and renamed into place, which makes it
+// safe for the output to be the input.
+class StreamedFileBuffer : public Buffer {
+  sys::OwningMemoryBlock Mem;
+  size_t Size = 0;
+  // The deferred copies, keyed by their offset in the buffer. They never
+  // overlap.
+  std::map<uint64_t, ArrayRef<uint8_t>> Deferred;
+
+public:
+  Error allocate(size_t Size) override;
+  uint8_t *getBufferStart() override;
+  void writeData(uint64_t Offset, ArrayRef<uint8_t> Data) override;
+  Error commit() override;
+
+  explicit StreamedFileBuffer(StringRef FileName) : Buffer(FileName) {}
+};
+
 class MemBuffer : public Buffer {
   std::unique_ptr<WritableMemoryBuffer> Buf;
 
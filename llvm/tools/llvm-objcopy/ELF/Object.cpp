@@ -144,7 +144,7 @@ void BinarySectionWriter::visit(const GroupSection &Sec) {
 
 void SectionWriter::visit(const Section &Sec) {
   if (Sec.Type != SHT_NOBITS)
-    llvm::copy(Sec.Contents, Out.getBufferStart() + Sec.Offset);
+    Out.writeData(Sec.Offset, Sec.Contents);
 }
 
 static bool addressOverflows32bit(uint64_t Addr) {
@@ -504,7 +504,7 @@ CompressedSection::CompressedSection(const SectionBase &Sec,
                                      DebugCompressionType CompressionType)
     : SectionBase(Sec), CompressionType(CompressionType),
       DecompressedSize(Sec.OriginalData.size()), DecompressedAlign(Sec.Align) {
-  if (Error E = zlib::compress(
+  if (Error E = zlib::compressParallel(
           StringRef(reinterpret_cast<const char *>(OriginalData.data()),
                     OriginalData.size()),
           CompressedData))
@@ -243,6 +243,23 @@ static Error restoreStatOnFile(StringRef Filename,
   return Error::success();
 }
 
+/// Create the buffer the output of an object file is written to. ELF output
+/// that goes to a regular file is streamed, which copies the unmodified
+/// sections of the input to the output without going through a mapping of
+/// the output file.
+static std::unique_ptr<Buffer> createOutputBuffer(const CopyConfig &Config) {
+  StringRef Filename = Config.OutputFilename;
+  if (Config.OutputFormat == FileFormat::Unspecified ||
+      Config.OutputFormat == FileFormat::ELF) {
+    sys::fs::file_status Stat;
+    // A missing output file is created as a regular file.
+    if (Filename != "-" && (sys::fs::status(Filename, Stat) ||
+                            Stat.type() == sys::fs::file_type::regular_file))
+      return std::make_unique<StreamedFileBuffer>(Filename);
+  }
+  return std::make_unique<FileBuffer>(Filename);
+}
+
 /// The function executeObjcopy does the higher level dispatch based on the type
 /// of input (raw binary, archive or single object file) and takes care of the
 /// format-agnostic modifications, i.e. preserving dates.
@@ -285,9 +302,9 @@ static Error executeObjcopy(const CopyConfig &Config) {
       if (Error E = executeObjcopyOnArchive(Config, *Ar))
         return E;
     } else {
-      FileBuffer FB(Config.OutputFilename);
-      if (Error E = executeObjcopyOnBinary(Config,
-                                           *BinaryOrErr.get().getBinary(), FB))
+      std::unique_ptr<Buffer> FB = createOutputBuffer(Config);
+      if (Error E = executeObjcopyOnBinary(
+              Config, *BinaryOrErr.get().getBinary(), *FB))
         return E;
     }
   }
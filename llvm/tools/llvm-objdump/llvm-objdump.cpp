@@ -60,9 +60,12 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstring>
 #include <system_error>
@@ -243,6 +246,12 @@ cl::opt<bool> NoLeadingAddr("no-leading-addr",
                             cl::desc("Print no leading address"),
                             cl::cat(ObjdumpCat));
 
+static cl::opt<unsigned> NumThreads(
+    "num-threads", cl::init(1),
+    cl::desc("Number of threads to disassemble with, or 0 to use all the "
+             "cores. The output is printed in address order either way"),
+    cl::cat(ObjdumpCat));
+
 static cl::opt<bool> RawClangAST(
     "raw-clang-ast",
     cl::desc("Dump the raw binary contents of the clang AST section"),
@@ -673,14 +682,14 @@ static bool hasMappingSymbols(const ObjectFile *Obj) {
   return isArmElf(Obj) || isAArch64Elf(Obj);
 }
 
-static void printRelocation(const RelocationRef &Rel, uint64_t Address,
-                            bool Is64Bits) {
+static void printRelocation(raw_ostream &OS, const RelocationRef &Rel,
+                            uint64_t Address, bool Is64Bits) {
   StringRef Fmt = Is64Bits ? "\t\t%016" PRIx64 ":  " : "\t\t\t%08" PRIx64 ":  ";
   SmallString<16> Name;
   SmallString<32> Val;
   Rel.getTypeName(Name);
   error(getRelocationValueString(Rel, Val));
-  outs() << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
+  OS << format(Fmt.data(), Address) << Name << "\t" << Val << "\n";
 }
 
 class PrettyPrinter {
@@ -763,7 +772,7 @@ public:
     auto PrintReloc = [&]() -> void {
       while ((RelCur != RelEnd) && (RelCur->getOffset() <= Address.Address)) {
         if (RelCur->getOffset() == Address.Address) {
-          printRelocation(*RelCur, Address.Address, false);
+          printRelocation(OS, *RelCur, Address.Address, false);
           return;
         }
         ++RelCur;
@@ -1037,40 +1046,40 @@ static char getMappingSymbolKind(ArrayRef<MappingSymbolPair> MappingSymbols,
 }
 
 static uint64_t
-dumpARMELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
-               const ObjectFile *Obj, ArrayRef<uint8_t> Bytes,
+dumpARMELFData(raw_ostream &OS, uint64_t SectionAddr, uint64_t Index,
+               uint64_t End, const ObjectFile *Obj, ArrayRef<uint8_t> Bytes,
                ArrayRef<MappingSymbolPair> MappingSymbols) {
   support::endianness Endian =
       Obj->isLittleEndian() ? support::little : support::big;
   while (Index < End) {
-    outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-    outs() << "\t";
+    OS << format("%8" PRIx64 ":", SectionAddr + Index);
+    OS << "\t";
     if (Index + 4 <= End) {
-      dumpBytes(Bytes.slice(Index, 4), outs());
-      outs() << "\t.word\t"
-             << format_hex(
-                    support::endian::read32(Bytes.data() + Index, Endian), 10);
+      dumpBytes(Bytes.slice(Index, 4), OS);
+      OS << "\t.word\t"
+         << format_hex(support::endian::read32(Bytes.data() + Index, Endian),
+                       10);
       Index += 4;
     } else if (Index + 2 <= End) {
-      dumpBytes(Bytes.slice(Index, 2), outs());
-      outs() << "\t\t.short\t"
-             << format_hex(
-                    support::endian::read16(Bytes.data() + Index, Endian), 6);
+      dumpBytes(Bytes.slice(Index, 2), OS);
+      OS << "\t\t.short\t"
+         << format_hex(support::endian::read16(Bytes.data() + Index, Endian),
+                       6);
       Index += 2;
     } else {
-      dumpBytes(Bytes.slice(Index, 1), outs());
-      outs() << "\t\t.byte\t" << format_hex(Bytes[0], 4);
+      dumpBytes(Bytes.slice(Index, 1), OS);
+      OS << "\t\t.byte\t" << format_hex(Bytes[0], 4);
       ++Index;
     }
-    outs() << "\n";
+    OS << "\n";
     if (getMappingSymbolKind(MappingSymbols, Index) != 'd')
       break;
   }
   return Index;
 }
 
-static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
-                        ArrayRef<uint8_t> Bytes) {
+static void dumpELFData(raw_ostream &OS, uint64_t SectionAddr, uint64_t Index,
+                        uint64_t End, ArrayRef<uint8_t> Bytes) {
   // print out data up to 8 bytes at a time in hex and ascii
   uint8_t AsciiData[9] = {'\0'};
   uint8_t Byte;
@@ -1078,9 +1087,9 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
 
   for (; Index < End; ++Index) {
     if (NumBytes == 0)
-      outs() << format("%8" PRIx64 ":", SectionAddr + Index);
+      OS << format("%8" PRIx64 ":", SectionAddr + Index);
     Byte = Bytes.slice(Index)[0];
-    outs() << format(" %02x", Byte);
+    OS << format(" %02x", Byte);
     AsciiData[NumBytes] = isPrint(Byte) ? Byte : '.';
 
     uint8_t IndentOffset = 0;
@@ -1095,22 +1104,40 @@ static void dumpELFData(uint64_t SectionAddr, uint64_t Index, uint64_t End,
     }
     if (NumBytes == 8) {
       AsciiData[8] = '\0';
-      outs() << std::string(IndentOffset, ' ') << "         ";
-      outs() << reinterpret_cast<char *>(AsciiData);
-      outs() << '\n';
+      OS << std::string(IndentOffset, ' ') << "         ";
+      OS << reinterpret_cast<char *>(AsciiData);
+      OS << '\n';
       NumBytes = 0;
     }
   }
 }
 
-static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
-                              MCContext &Ctx, MCDisassembler *PrimaryDisAsm,
-                              MCDisassembler *SecondaryDisAsm,
-                              const MCInstrAnalysis *MIA, MCInstPrinter *IP,
-                              const MCSubtargetInfo *PrimarySTI,
-                              const MCSubtargetInfo *SecondarySTI,
-                              PrettyPrinter &PIP,
-                              SourcePrinter &SP, bool InlineRelocs) {
+namespace {
+/// A symbol to disassemble and the section offsets it spans.
+struct SymbolRange {
+  unsigned SymbolIndex;
+  uint64_t Start;
+  uint64_t End;
+  std::string Name;
+};
+
+/// The disassembler and instruction printer of a --num-threads worker, with
+/// the context they create expressions in.
+struct DisassemblerJob {
+  MCObjectFileInfo MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+};
+} // namespace
+
+static void disassembleObject(
+    const Target *TheTarget, const ObjectFile *Obj, MCContext &Ctx,
+    MCDisassembler *PrimaryDisAsm, MCDisassembler *SecondaryDisAsm,
+    const MCInstrAnalysis *MIA, MCInstPrinter *IP,
+    const MCSubtargetInfo *PrimarySTI, const MCSubtargetInfo *SecondarySTI,
+    PrettyPrinter &PIP, SourcePrinter &SP, bool InlineRelocs,
+    function_ref<std::unique_ptr<DisassemblerJob>()> CreateJob) {
   const MCSubtargetInfo *STI = PrimarySTI;
   MCDisassembler *DisAsm = PrimaryDisAsm;
   bool PrimaryIsThumb = false;
@@ -1191,6 +1218,13 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     array_pod_sort(SecSyms.second.begin(), SecSyms.second.end());
   array_pod_sort(AbsoluteSymbols.begin(), AbsoluteSymbols.end());
 
+  // The symbol and relocation maps are only read while disassembling, so the
+  // worker threads of --num-threads share them. The threads and their
+  // disassemblers are created for the first section that needs them.
+  const SectionSymbolsTy EmptySymbols;
+  std::vector<std::unique_ptr<DisassemblerJob>> Jobs;
+  std::unique_ptr<ThreadPool> Pool;
+
   for (const SectionRef &Section : ToolSectionFilter(*Obj)) {
     if (FilterSections.empty() && !DisassembleAll &&
         (!Section.isText() || Section.isVirtual()))
@@ -1248,9 +1282,6 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
                           Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     ArrayRef<uint8_t> Bytes = arrayRefFromStringRef(
         unwrapOrError(Section.getContents(), Obj->getFileName()));
 
@@ -1258,13 +1289,8 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
     if (shouldAdjustVA(Section))
       VMAAdjustment = AdjustVMA;
 
-    uint64_t Size;
-    uint64_t Index;
-    bool PrintedSection = false;
-    std::vector<RelocationRef> Rels = RelocMap[Section];
-    std::vector<RelocationRef>::const_iterator RelCur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator RelEnd = Rels.end();
-    // Disassemble symbol by symbol.
+    // Find the symbols to disassemble and the offsets they span.
+    std::vector<SymbolRange> Ranges;
     for (unsigned SI = 0, SE = Symbols.size(); SI != SE; ++SI) {
       std::string SymbolName = std::get<1>(Symbols[SI]).str();
       if (Demangle)
@@ -1291,14 +1317,6 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
       Start -= SectionAddr;
       End -= SectionAddr;
 
-      if (!PrintedSection) {
-        PrintedSection = true;
-        outs() << "\nDisassembly of section ";
-        if (!SegmentName.empty())
-          outs() << SegmentName << ",";
-        outs() << SectionName << ":\n";
-      }
-
       if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
         if (std::get<2>(Symbols[SI]) == ELF::STT_AMDGPU_HSA_KERNEL) {
           // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
@@ -1316,193 +1334,303 @@ static void disassembleObject(const Target *TheTarget, const ObjectFile *Obj,
         }
       }
 
-      outs() << '\n';
-      if (!NoLeadingAddr)
-        outs() << format(Is64Bits ? "%016" PRIx64 " " : "%08" PRIx64 " ",
-                         SectionAddr + Start + VMAAdjustment);
-
-      outs() << SymbolName << ":\n";
+      Ranges.push_back({SI, Start, End, std::move(SymbolName)});
+    }
+    if (Ranges.empty())
+      continue;
 
-      // Don't print raw contents of a virtual section. A virtual section
-      // doesn't have any contents in the file.
-      if (Section.isVirtual()) {
-        outs() << "...\n";
-        continue;
-      }
+    outs() << "\nDisassembly of section ";
+    if (!SegmentName.empty())
+      outs() << SegmentName << ",";
+    outs() << SectionName << ":\n";
+
+    std::vector<RelocationRef> &Rels = RelocMap[Section];
+    using RelIterator = std::vector<RelocationRef>::const_iterator;
+
+    // Disassemble the symbols of SymRanges to OS, with the relocations in
+    // [RelCur, RelEnd). DisAsm is switched between ARM and Thumb mode by the
+    // mapping symbols.
+    auto DisassembleRanges = [&](ArrayRef<SymbolRange> SymRanges,
+                                 raw_ostream &OS, MCDisassembler *&DisAsm,
+                                 MCInstPrinter *IP, RelIterator RelCur,
+                                 RelIterator RelEnd) {
+      SmallString<40> Comments;
+      raw_svector_ostream CommentStream(Comments);
+      uint64_t Size;
+      uint64_t Index;
+      // Disassemble symbol by symbol.
+      for (const SymbolRange &Range : SymRanges) {
+        unsigned SI = Range.SymbolIndex;
+        uint64_t Start = Range.Start;
+        uint64_t End = Range.End;
+        const std::string &SymbolName = Range.Name;
+
+        OS << '\n';
+        if (!NoLeadingAddr)
+          OS << format(Is64Bits ? "%016" PRIx64 " " : "%08" PRIx64 " ",
+                       SectionAddr + Start + VMAAdjustment);
+
+        OS << SymbolName << ":\n";
+
+        // Don't print raw contents of a virtual section. A virtual section
+        // doesn't have any contents in the file.
+        if (Section.isVirtual()) {
+          OS << "...\n";
+          continue;
+        }
 
 #ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+        raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
 #else
-      raw_ostream &DebugOut = nulls();
+        raw_ostream &DebugOut = nulls();
 #endif
 
-      // Some targets (like WebAssembly) have a special prelude at the start
-      // of each symbol.
-      DisAsm->onSymbolStart(SymbolName, Size, Bytes.slice(Start, End - Start),
-                            SectionAddr + Start, DebugOut, CommentStream);
-      Start += Size;
-
-      Index = Start;
-      if (SectionAddr < StartAddress)
-        Index = std::max<uint64_t>(Index, StartAddress - SectionAddr);
-
-      // If there is a data/common symbol inside an ELF text section and we are
-      // only disassembling text (applicable all architectures), we are in a
-      // situation where we must print the data and not disassemble it.
-      if (Obj->isELF() && !DisassembleAll && Section.isText()) {
-        uint8_t SymTy = std::get<2>(Symbols[SI]);
-        if (SymTy == ELF::STT_OBJECT || SymTy == ELF::STT_COMMON) {
-          dumpELFData(SectionAddr, Index, End, Bytes);
-          Index = End;
-        }
-      }
-
-      bool CheckARMELFData = hasMappingSymbols(Obj) &&
-                             std::get<2>(Symbols[SI]) != ELF::STT_OBJECT &&
-                             !DisassembleAll;
-      while (Index < End) {
-        // ARM and AArch64 ELF binaries can interleave data and text in the
-        // same section. We rely on the markers introduced to understand what
-        // we need to dump. If the data marker is within a function, it is
-        // denoted as a word/short etc.
-        if (CheckARMELFData &&
-            getMappingSymbolKind(MappingSymbols, Index) == 'd') {
-          Index = dumpARMELFData(SectionAddr, Index, End, Obj, Bytes,
-                                 MappingSymbols);
-          continue;
+        // Some targets (like WebAssembly) have a special prelude at the start
+        // of each symbol.
+        DisAsm->onSymbolStart(SymbolName, Size,
+                              Bytes.slice(Start, End - Start),
+                              SectionAddr + Start, DebugOut, CommentStream);
+        Start += Size;
+
+        Index = Start;
+        if (SectionAddr < StartAddress)
+          Index = std::max<uint64_t>(Index, StartAddress - SectionAddr);
+
+        // If there is a data/common symbol inside an ELF text section and we
+        // are only disassembling text (applicable all architectures), we are
+        // in a situation where we must print the data and not disassemble it.
+        if (Obj->isELF() && !DisassembleAll && Section.isText()) {
+          uint8_t SymTy = std::get<2>(Symbols[SI]);
+          if (SymTy == ELF::STT_OBJECT || SymTy == ELF::STT_COMMON) {
+            dumpELFData(OS, SectionAddr, Index, End, Bytes);
+            Index = End;
+          }
         }
 
-        // When -z or --disassemble-zeroes are given we always dissasemble
-        // them. Otherwise we might want to skip zero bytes we see.
-        if (!DisassembleZeroes) {
-          uint64_t MaxOffset = End - Index;
-          // For -reloc: print zero blocks patched by relocations, so that
-          // relocations can be shown in the dump.
-          if (RelCur != RelEnd)
-            MaxOffset = RelCur->getOffset() - Index;
-
-          if (size_t N =
-                  countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
-            outs() << "\t\t..." << '\n';
-            Index += N;
+        bool CheckARMELFData = hasMappingSymbols(Obj) &&
+                               std::get<2>(Symbols[SI]) != ELF::STT_OBJECT &&
+                               !DisassembleAll;
+        while (Index < End) {
+          // ARM and AArch64 ELF binaries can interleave data and text in the
+          // same section. We rely on the markers introduced to understand what
+          // we need to dump. If the data marker is within a function, it is
+          // denoted as a word/short etc.
+          if (CheckARMELFData &&
+              getMappingSymbolKind(MappingSymbols, Index) == 'd') {
+            Index = dumpARMELFData(OS, SectionAddr, Index, End, Obj, Bytes,
+                                   MappingSymbols);
             continue;
           }
-        }
 
-        if (SecondarySTI) {
-          if (getMappingSymbolKind(MappingSymbols, Index) == 'a') {
-            STI = PrimaryIsThumb ? SecondarySTI : PrimarySTI;
-            DisAsm = PrimaryIsThumb ? SecondaryDisAsm : PrimaryDisAsm;
-          } else if (getMappingSymbolKind(MappingSymbols, Index) == 't') {
-            STI = PrimaryIsThumb ? PrimarySTI : SecondarySTI;
-            DisAsm = PrimaryIsThumb ? PrimaryDisAsm : SecondaryDisAsm;
+          // When -z or --disassemble-zeroes are given we always dissasemble
+          // them. Otherwise we might want to skip zero bytes we see.
+          if (!DisassembleZeroes) {
+            uint64_t MaxOffset = End - Index;
+            // For -reloc: print zero blocks patched by relocations, so that
+            // relocations can be shown in the dump.
+            if (RelCur != RelEnd)
+              MaxOffset = RelCur->getOffset() - Index;
+
+            if (size_t N =
+                    countSkippableZeroBytes(Bytes.slice(Index, MaxOffset))) {
+              OS << "\t\t..." << '\n';
+              Index += N;
+              continue;
+            }
           }
-        }
 
-        // Disassemble a real instruction or a data when disassemble all is
-        // provided
-        MCInst Inst;
-        bool Disassembled = DisAsm->getInstruction(
-            Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
-            CommentStream);
-        if (Size == 0)
-          Size = 1;
-
-        PIP.printInst(*IP, Disassembled ? &Inst : nullptr,
-                      Bytes.slice(Index, Size),
-                      {SectionAddr + Index + VMAAdjustment, Section.getIndex()},
-                      outs(), "", *STI, &SP, Obj->getFileName(), &Rels);
-        outs() << CommentStream.str();
-        Comments.clear();
-
-        // Try to resolve the target of a call, tail call, etc. to a specific
-        // symbol.
-        if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
-                    MIA->isConditionalBranch(Inst))) {
-          uint64_t Target;
-          if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
-            // In a relocatable object, the target's section must reside in
-            // the same section as the call instruction or it is accessed
-            // through a relocation.
-            //
-            // In a non-relocatable object, the target may be in any section.
-            //
-            // N.B. We don't walk the relocations in the relocatable case yet.
-            auto *TargetSectionSymbols = &Symbols;
-            if (!Obj->isRelocatableObject()) {
-              auto It = partition_point(
-                  SectionAddresses,
-                  [=](const std::pair<uint64_t, SectionRef> &O) {
-                    return O.first <= Target;
-                  });
-              if (It != SectionAddresses.begin()) {
-                --It;
-                TargetSectionSymbols = &AllSymbols[It->second];
-              } else {
-                TargetSectionSymbols = &AbsoluteSymbols;
-              }
+          if (SecondarySTI) {
+            if (getMappingSymbolKind(MappingSymbols, Index) == 'a') {
+              STI = PrimaryIsThumb ? SecondarySTI : PrimarySTI;
+              DisAsm = PrimaryIsThumb ? SecondaryDisAsm : PrimaryDisAsm;
+            } else if (getMappingSymbolKind(MappingSymbols, Index) == 't') {
+              STI = PrimaryIsThumb ? PrimarySTI : SecondarySTI;
+              DisAsm = PrimaryIsThumb ? PrimaryDisAsm : SecondaryDisAsm;
             }
+          }
+
+          // Disassemble a real instruction or a data when disassemble all is
+          // provided
+          MCInst Inst;
+          bool Disassembled = DisAsm->getInstruction(
+              Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
+              CommentStream);
+          if (Size == 0)
+            Size = 1;
+
+          PIP.printInst(
+              *IP, Disassembled ? &Inst : nullptr, Bytes.slice(Index, Size),
+              {SectionAddr + Index + VMAAdjustment, Section.getIndex()},
+              OS, "", *STI, &SP, Obj->getFileName(), &Rels);
+          OS << CommentStream.str();
+          Comments.clear();
+
+          // Try to resolve the target of a call, tail call, etc. to a specific
+          // symbol.
+          if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
+                      MIA->isConditionalBranch(Inst))) {
+            uint64_t Target;
+            if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
+              // In a relocatable object, the target's section must reside in
+              // the same section as the call instruction or it is accessed
+              // through a relocation.
+              //
+              // In a non-relocatable object, the target may be in any section.
+              //
+              // N.B. We don't walk the relocations in the relocatable case yet.
+              const SectionSymbolsTy *TargetSectionSymbols = &Symbols;
+              if (!Obj->isRelocatableObject()) {
+                auto It = partition_point(
+                    SectionAddresses,
+                    [=](const std::pair<uint64_t, SectionRef> &O) {
+                      return O.first <= Target;
+                    });
+                if (It != SectionAddresses.begin()) {
+                  --It;
+                  auto SecSyms = AllSymbols.find(It->second);
+                  TargetSectionSymbols = SecSyms != AllSymbols.end()
+                                             ? &SecSyms->second
+                                             : &EmptySymbols;
+                } else {
+                  TargetSectionSymbols = &AbsoluteSymbols;
+                }
+              }
 
-            // Find the last symbol in the section whose offset is less than
-            // or equal to the target. If there isn't a section that contains
-            // the target, find the nearest preceding absolute symbol.
-            auto TargetSym = partition_point(
-                *TargetSectionSymbols,
-                [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
-                  return std::get<0>(O) <= Target;
-                });
-            if (TargetSym == TargetSectionSymbols->begin()) {
-              TargetSectionSymbols = &AbsoluteSymbols;
-              TargetSym = partition_point(
-                  AbsoluteSymbols,
+              // Find the last symbol in the section whose offset is less than
+              // or equal to the target. If there isn't a section that contains
+              // the target, find the nearest preceding absolute symbol.
+              auto TargetSym = partition_point(
+                  *TargetSectionSymbols,
                   [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
                     return std::get<0>(O) <= Target;
                   });
-            }
-            if (TargetSym != TargetSectionSymbols->begin()) {
-              --TargetSym;
-              uint64_t TargetAddress = std::get<0>(*TargetSym);
-              StringRef TargetName = std::get<1>(*TargetSym);
-              outs() << " <" << TargetName;
-              uint64_t Disp = Target - TargetAddress;
-              if (Disp)
-                outs() << "+0x" << Twine::utohexstr(Disp);
-              outs() << '>';
+              if (TargetSym == TargetSectionSymbols->begin()) {
+                TargetSectionSymbols = &AbsoluteSymbols;
+                TargetSym = partition_point(
+                    AbsoluteSymbols,
+                    [=](const std::tuple<uint64_t, StringRef, uint8_t> &O) {
+                      return std::get<0>(O) <= Target;
+                    });
+              }
+              if (TargetSym != TargetSectionSymbols->begin()) {
+                --TargetSym;
+                uint64_t TargetAddress = std::get<0>(*TargetSym);
+                StringRef TargetName = std::get<1>(*TargetSym);
+                OS << " <" << TargetName;
+                uint64_t Disp = Target - TargetAddress;
+                if (Disp)
+                  OS << "+0x" << Twine::utohexstr(Disp);
+                OS << '>';
+              }
             }
           }
-        }
-        outs() << "\n";
-
-        // Hexagon does this in pretty printer
-        if (Obj->getArch() != Triple::hexagon) {
-          // Print relocation for instruction.
-          while (RelCur != RelEnd) {
-            uint64_t Offset = RelCur->getOffset();
-            // If this relocation is hidden, skip it.
-            if (getHidden(*RelCur) || SectionAddr + Offset < StartAddress) {
-              ++RelCur;
-              continue;
-            }
+          OS << "\n";
+
+          // Hexagon does this in pretty printer
+          if (Obj->getArch() != Triple::hexagon) {
+            // Print relocation for instruction.
+            while (RelCur != RelEnd) {
+              uint64_t Offset = RelCur->getOffset();
+              // If this relocation is hidden, skip it.
+              if (getHidden(*RelCur) || SectionAddr + Offset < StartAddress) {
+                ++RelCur;
+                continue;
+              }
 
-            // Stop when RelCur's offset is past the current instruction.
-            if (Offset >= Index + Size)
-              break;
-
-            // When --adjust-vma is used, update the address printed.
-            if (RelCur->getSymbol() != Obj->symbol_end()) {
-              Expected<section_iterator> SymSI =
-                  RelCur->getSymbol()->getSection();
-              if (SymSI && *SymSI != Obj->section_end() &&
-                  shouldAdjustVA(**SymSI))
-                Offset += AdjustVMA;
-            }
+              // Stop when RelCur's offset is past the current instruction.
+              if (Offset >= Index + Size)
+                break;
+
+              // When --adjust-vma is used, update the address printed.
+              if (RelCur->getSymbol() != Obj->symbol_end()) {
+                Expected<section_iterator> SymSI =
+                    RelCur->getSymbol()->getSection();
+                if (SymSI && *SymSI != Obj->section_end() &&
+                    shouldAdjustVA(**SymSI))
+                  Offset += AdjustVMA;
+              }
 
-            printRelocation(*RelCur, SectionAddr + Offset, Is64Bits);
-            ++RelCur;
+              printRelocation(OS, *RelCur, SectionAddr + Offset, Is64Bits);
+              ++RelCur;
+            }
           }
+
+          Index += Size;
         }
+      }
+    };
+
+    // The source printer keeps the state of the files it reads, the ARM and
+    // Thumb modes of a section have to be followed from its start, and the
+    // AMDGPU symbolizer belongs to the primary disassembler.
+    unsigned Threads = NumThreads ? NumThreads : hardware_concurrency();
+    if (Threads <= 1 || Ranges.size() < 2 || Section.isVirtual() ||
+        PrintSource || PrintLines || SecondarySTI ||
+        Obj->getArch() == Triple::amdgcn) {
+      DisassembleRanges(Ranges, outs(), DisAsm, IP, Rels.begin(), Rels.end());
+      continue;
+    }
 
-        Index += Size;
+    // Split the symbols into chunks of about ChunkBytes bytes. The data dump
+    // of an ELF data symbol leaves its relocations to be printed with the
+    // next instruction, so a chunk never starts right after one.
+    const uint64_t ChunkBytes = 1 << 16;
+    auto IsDataDump = [&](const SymbolRange &Range) {
+      uint8_t SymTy = std::get<2>(Symbols[Range.SymbolIndex]);
+      return Obj->isELF() && !DisassembleAll && Section.isText() &&
+             (SymTy == ELF::STT_OBJECT || SymTy == ELF::STT_COMMON);
+    };
+    SmallVector<size_t, 16> ChunkStarts = {0};
+    for (size_t I = 1, E = Ranges.size(); I != E; ++I)
+      if (Ranges[I].Start - Ranges[ChunkStarts.back()].Start >= ChunkBytes &&
+          !IsDataDump(Ranges[I - 1]))
+        ChunkStarts.push_back(I);
+    ChunkStarts.push_back(Ranges.size());
+    size_t NumChunks = ChunkStarts.size() - 1;
+
+    // Give each chunk the relocations from its start to the next one's.
+    SmallVector<RelIterator, 16> ChunkRels = {Rels.begin()};
+    for (size_t C = 1; C != NumChunks; ++C) {
+      uint64_t ChunkStart = Ranges[ChunkStarts[C]].Start;
+      ChunkRels.push_back(
+          std::partition_point(ChunkRels.back(), RelIterator(Rels.end()),
+                               [=](const RelocationRef &Rel) {
+                                 return Rel.getOffset() < ChunkStart;
+                               }));
+    }
+    ChunkRels.push_back(Rels.end());
+
+    if (!Pool) {
+      Pool = std::make_unique<ThreadPool>(Threads);
+      for (unsigned I = 0; I != Threads; ++I)
+        Jobs.push_back(CreateJob());
+    }
+
+    // Disassemble a window of chunks at a time, so that the output buffered
+    // stays bounded, and print it in address order.
+    size_t WindowSize = Jobs.size() * 4;
+    std::vector<std::string> Outputs(WindowSize);
+    for (size_t WindowStart = 0; WindowStart < NumChunks;
+         WindowStart += WindowSize) {
+      size_t WindowEnd = std::min(WindowStart + WindowSize, NumChunks);
+      std::atomic<size_t> NextChunk(WindowStart);
+      for (std::unique_ptr<DisassemblerJob> &Job : Jobs)
+        Pool->async([&, JobPtr = Job.get()] {
+          MCDisassembler *JobDisAsm = JobPtr->DisAsm.get();
+          for (size_t C = NextChunk++; C < WindowEnd; C = NextChunk++) {
+            raw_string_ostream OS(Outputs[C - WindowStart]);
+            DisassembleRanges(makeArrayRef(Ranges).slice(
+                                  ChunkStarts[C],
+                                  ChunkStarts[C + 1] - ChunkStarts[C]),
+                              OS, JobDisAsm, JobPtr->IP.get(), ChunkRels[C],
+                              ChunkRels[C + 1]);
+          }
+        });
+      Pool->wait();
+      for (size_t C = WindowStart; C != WindowEnd; ++C) {
+        std::string &Output = Outputs[C - WindowStart];
+        outs() << Output;
+        Output.clear();
       }
     }
   }
@@ -1587,9 +1715,24 @@ static void disassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     if (!IP->applyTargetSpecificCLOption(Opt))
       error("Unrecognized disassembler option: " + Opt);
 
+  // Each worker thread of --num-threads disassembles in a context of its own.
+  auto CreateJob = [&]() {
+    auto Job = std::make_unique<DisassemblerJob>();
+    Job->Ctx =
+        std::make_unique<MCContext>(AsmInfo.get(), MRI.get(), &Job->MOFI);
+    Job->MOFI.InitMCObjectFileInfo(Triple(TripleName), false, *Job->Ctx);
+    Job->DisAsm.reset(TheTarget->createMCDisassembler(*STI, *Job->Ctx));
+    Job->IP.reset(TheTarget->createMCInstPrinter(
+        Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
+    Job->IP->setPrintImmHex(PrintImmHex);
+    for (StringRef Opt : DisassemblerOptions)
+      Job->IP->applyTargetSpecificCLOption(Opt);
+    return Job;
+  };
+
   disassembleObject(TheTarget, Obj, Ctx, DisAsm.get(), SecondaryDisAsm.get(),
                     MIA.get(), IP.get(), STI.get(), SecondarySTI.get(), PIP,
-                    SP, InlineRelocs);
+                    SP, InlineRelocs, CreateJob);
 }
 
 void printRelocations(const ObjectFile *Obj) {
@@ -7,9 +7,9 @@
 //===----------------------------------------------------------------------===//
 ///
 /// \file
-/// This file implements a tool that can parse the YAML optimization
-/// records and generate an optimization summary annotated source listing
-/// report.
+/// This file implements a tool that can parse the YAML or bitstream
+/// optimization records and generate an optimization summary annotated source
+/// listing report, or a summary of the hottest missed optimizations.
 ///
 //===----------------------------------------------------------------------===//
 
@@ -27,11 +27,14 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <map>
 #include <set>
+#include <tuple>
 
 using namespace llvm;
 
@@ -40,9 +43,9 @@ using namespace llvm;
 static cl::OptionCategory
     OptReportCategory("llvm-opt-report options");
 
-static cl::opt<std::string>
-  InputFileName(cl::Positional, cl::desc("<input>"), cl::init("-"),
-                cl::cat(OptReportCategory));
+static cl::list<std::string>
+  InputFileNames(cl::Positional, cl::desc("<input>..."), cl::ZeroOrMore,
+                 cl::cat(OptReportCategory));
 
 static cl::opt<std::string>
   OutputFileName("o", cl::desc("Output file"), cl::init("-"),
@@ -65,6 +68,28 @@ static cl::opt<std::string> ParserFormat("format",
                                          cl::init("yaml"),
                                          cl::cat(OptReportCategory));
 
+static cl::opt<unsigned>
+  NumThreads("j", cl::desc("Number of threads used to parse the input files "
+                           "(0 = number of hardware threads)"),
+             cl::init(0), cl::cat(OptReportCategory));
+
+static cl::opt<bool>
+  AggregateMissed("aggregate-missed",
+                  cl::desc("Instead of the annotated source listing, print "
+                           "the missed optimizations sorted by hotness"),
+                  cl::init(false), cl::cat(OptReportCategory));
+
+static cl::opt<std::string>
+  AggregatePass("aggregate-pass",
+                cl::desc("Only aggregate the missed remarks of this pass"),
+                cl::init(""), cl::cat(OptReportCategory));
+
+static cl::opt<unsigned>
+  AggregateLimit("aggregate-limit",
+                 cl::desc("Maximum number of aggregated entries to print "
+                          "(0 = no limit)"),
+                 cl::init(20), cl::cat(OptReportCategory));
+
 namespace {
 // For each location in the source file, the common per-transformation state
 // collected.
@@ -143,34 +168,51 @@ struct OptReportLocationInfo {
 
 typedef std::map<std::string, std::map<int, std::map<std::string, std::map<int,
           OptReportLocationInfo>>>> LocationInfoTy;
-} // anonymous namespace
 
-static bool readLocationInfo(LocationInfoTy &LocationInfo) {
-  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
-      MemoryBuffer::getFile(InputFileName.c_str());
-  if (std::error_code EC = Buf.getError()) {
-    WithColor::error() << "Can't open file " << InputFileName << ": "
-                       << EC.message() << "\n";
-    return false;
-  }
+// The missed remarks that were emitted for the same pass, remark name, source
+// location and function.
+struct MissedRemarkInfo {
+  uint64_t Count = 0;
+  uint64_t Hotness = 0;
 
-  Expected<remarks::Format> Format = remarks::parseFormat(ParserFormat);
-  if (!Format) {
-    handleAllErrors(Format.takeError(), [&](const ErrorInfoBase &PE) {
-      PE.log(WithColor::error());
-      WithColor::error() << '\n';
-    });
-    return false;
+  MissedRemarkInfo &operator+=(const MissedRemarkInfo &RHS) {
+    Count += RHS.Count;
+    Hotness += RHS.Hotness;
+    return *this;
   }
+};
+
+// Pass name, remark name, file, line, column and function name.
+typedef std::tuple<std::string, std::string, std::string, unsigned, unsigned,
+                   std::string> MissedRemarkKey;
+typedef std::map<MissedRemarkKey, MissedRemarkInfo> MissedInfoTy;
+
+// Everything that was read from one input file. The input files are parsed
+// concurrently, each into its own InputInfo, and merged in order afterwards.
+struct InputInfo {
+  LocationInfoTy LocationInfo;
+  MissedInfoTy MissedInfo;
+  std::string ErrorMsg;
+};
+} // anonymous namespace
+
+static Error readLocationInfo(StringRef InputFileName, remarks::Format Format,
+                              LocationInfoTy &LocationInfo,
+                              MissedInfoTy &MissedInfo) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
+      MemoryBuffer::getFileOrSTDIN(InputFileName);
+  if (std::error_code EC = Buf.getError())
+    return createStringError(EC, "Can't open file %s: %s",
+                             InputFileName.str().c_str(),
+                             EC.message().c_str());
 
+  // Bitstream remarks can be emitted as metadata pointing to a separate file.
   Expected<std::unique_ptr<remarks::RemarkParser>> MaybeParser =
-      remarks::createRemarkParser(*Format, (*Buf)->getBuffer());
-  if (!MaybeParser) {
-    handleAllErrors(MaybeParser.takeError(), [&](const ErrorInfoBase &PE) {
-      PE.log(WithColor::error());
-    });
-    return false;
-  }
+      Format == remarks::Format::Bitstream
+          ? remarks::createRemarkParserFromMeta(Format, (*Buf)->getBuffer())
+          : remarks::createRemarkParser(Format, (*Buf)->getBuffer());
+  if (!MaybeParser)
+    return MaybeParser.takeError();
   remarks::RemarkParser &Parser = **MaybeParser;
 
   while (true) {
@@ -182,14 +224,28 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
         consumeError(std::move(E));
         break;
       }
-      handleAllErrors(MaybeRemark.takeError(), [&](const ErrorInfoBase &PE) {
-        PE.log(WithColor::error());
-      });
-      return false;
+      return E;
     }
 
     const remarks::Remark &Remark = **MaybeRemark;
 
+    if (AggregateMissed) {
+      if (Remark.RemarkType != remarks::Type::Missed ||
+          (!AggregatePass.empty() && Remark.PassName != AggregatePass))
+        continue;
+      MissedRemarkKey Key(Remark.PassName, Remark.RemarkName, "", 0, 0,
+                          Remark.FunctionName);
+      if (const Optional<remarks::RemarkLocation> &Loc = Remark.Loc) {
+        std::get<2>(Key) = Loc->SourceFilePath;
+        std::get<3>(Key) = Loc->SourceLine;
+        std::get<4>(Key) = Loc->SourceColumn;
+      }
+      MissedRemarkInfo &MI = MissedInfo[Key];
+      ++MI.Count;
+      MI.Hotness += Remark.Hotness.getValueOr(0);
+      continue;
+    }
+
     bool Transformed = Remark.RemarkType == remarks::Type::Passed;
 
     int VectorizationFactor = 1;
@@ -237,6 +293,113 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
     }
   }
 
+  return Error::success();
+}
+
+// Parse all the input files, using a thread pool if there are several, and
+// merge the results in the order of the inputs.
+static bool readInputs(LocationInfoTy &LocationInfo,
+                       MissedInfoTy &MissedInfo) {
+  Expected<remarks::Format> Format = remarks::parseFormat(ParserFormat);
+  if (!Format) {
+    handleAllErrors(Format.takeError(), [&](const ErrorInfoBase &PE) {
+      PE.log(WithColor::error());
+      WithColor::error() << '\n';
+    });
+    return false;
+  }
+
+  std::vector<InputInfo> Inputs(InputFileNames.size());
+  auto ReadInput = [&](size_t I) {
+    InputInfo &Input = Inputs[I];
+    if (Error E = readLocationInfo(InputFileNames[I], *Format,
+                                   Input.LocationInfo, Input.MissedInfo))
+      Input.ErrorMsg = toString(std::move(E));
+  };
+
+  if (Inputs.size() == 1) {
+    ReadInput(0);
+  } else {
+    unsigned Threads = NumThreads ? NumThreads : hardware_concurrency();
+    ThreadPool Pool(std::min<size_t>(Threads, Inputs.size()));
+    for (size_t I = 0, E = Inputs.size(); I != E; ++I)
+      Pool.async(ReadInput, I);
+    Pool.wait();
+  }
+
+  bool Success = true;
+  for (InputInfo &Input : Inputs) {
+    if (!Input.ErrorMsg.empty()) {
+      WithColor::error() << Input.ErrorMsg << "\n";
+      Success = false;
+      continue;
+    }
+
+    for (auto &FI : Input.LocationInfo)
+      for (auto &LI : FI.second)
+        for (auto &FLI : LI.second)
+          for (auto &CI : FLI.second)
+            LocationInfo[FI.first][LI.first][FLI.first][CI.first] |= CI.second;
+    for (auto &MI : Input.MissedInfo)
+      MissedInfo[MI.first] += MI.second;
+  }
+
+  return Success;
+}
+
+static std::string getFunctionName(const std::string &FuncName) {
+  if (!NoDemangle) {
+    int Status = 0;
+    char *Demangled =
+      itaniumDemangle(FuncName.c_str(), nullptr, nullptr, &Status);
+    std::string Result = Demangled && Status == 0 ? Demangled : FuncName;
+    if (Demangled)
+      std::free(Demangled);
+    return Result;
+  }
+
+  return FuncName;
+}
+
+static bool writeMissedReport(const MissedInfoTy &MissedInfo) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputFileName, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    WithColor::error() << "Can't open file " << OutputFileName << ": "
+                       << EC.message() << "\n";
+    return false;
+  }
+
+  // The hottest entries first. Without profile data, all the hotness values
+  // are 0 and the entries are sorted by the number of remarks.
+  std::vector<const MissedInfoTy::value_type *> Entries;
+  Entries.reserve(MissedInfo.size());
+  for (const auto &MI : MissedInfo)
+    Entries.push_back(&MI);
+  std::stable_sort(Entries.begin(), Entries.end(),
+                   [](const MissedInfoTy::value_type *LHS,
+                      const MissedInfoTy::value_type *RHS) {
+                     return std::make_pair(LHS->second.Hotness,
+                                           LHS->second.Count) >
+                            std::make_pair(RHS->second.Hotness,
+                                           RHS->second.Count);
+                   });
+  if (AggregateLimit && Entries.size() > AggregateLimit)
+    Entries.resize(AggregateLimit);
+
+  OS << "Hotness Count Remark Location Function\n";
+  for (const MissedInfoTy::value_type *Entry : Entries) {
+    const MissedRemarkKey &Key = Entry->first;
+    OS << Entry->second.Hotness << " " << Entry->second.Count << " "
+       << std::get<0>(Key) << ":" << std::get<1>(Key) << " ";
+    if (std::get<2>(Key).empty())
+      OS << "<unknown>";
+    else
+      OS << std::get<2>(Key) << ":" << std::get<3>(Key) << ":"
+         << std::get<4>(Key);
+    OS << " " << getFunctionName(std::get<5>(Key)) << "\n";
+  }
+
   return true;
 }
 
@@ -329,22 +492,7 @@ static bool writeReport(LocationInfoTy &LocationInfo) {
             else
               OS << ", ";
 
-            bool Printed = false;
-            if (!NoDemangle) {
-              int Status = 0;
-              char *Demangled =
-                itaniumDemangle(FuncName.c_str(), nullptr, nullptr, &Status);
-              if (Demangled && Status == 0) {
-                OS << Demangled;
-                Printed = true;
-              }
-
-              if (Demangled)
-                std::free(Demangled);
-            }
-
-            if (!Printed)
-              OS << FuncName;
+            OS << getFunctionName(FuncName);
           }
 
           OS << ":\n";
@@ -459,13 +607,18 @@ int main(int argc, const char **argv) {
   cl::HideUnrelatedOptions(OptReportCategory);
   cl::ParseCommandLineOptions(
       argc, argv,
-      "A tool to generate an optimization report from YAML optimization"
-      " record files.\n");
+      "A tool to generate an optimization report from YAML or bitstream"
+      " optimization record files.\n");
+
+  if (InputFileNames.empty())
+    InputFileNames.push_back("-");
 
   LocationInfoTy LocationInfo;
-  if (!readLocationInfo(LocationInfo))
+  MissedInfoTy MissedInfo;
+  if (!readInputs(LocationInfo, MissedInfo))
     return 1;
-  if (!writeReport(LocationInfo))
+  if (AggregateMissed ? !writeMissedReport(MissedInfo)
+                      : !writeReport(LocationInfo))
     return 1;
 
   return 0;
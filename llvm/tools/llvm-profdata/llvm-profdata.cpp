@@ -20,8 +20,10 @@
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -37,6 +39,7 @@ enum ProfileFormat {
   PF_None = 0,
   PF_Text,
   PF_Compact_Binary,
+  PF_Ext_Binary,
   PF_GCC,
   PF_Binary
 };
@@ -305,21 +308,14 @@ static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   });
 }
 
-static void mergeInstrProfile(const WeightedFileVector &Inputs,
-                              SymbolRemapper *Remapper,
-                              StringRef OutputFilename,
-                              ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads) {
-  if (OutputFilename.compare("-") == 0)
-    exitWithError("Cannot write indexed profdata format to stdout.");
-
-  if (OutputFormat != PF_Binary && OutputFormat != PF_Compact_Binary &&
-      OutputFormat != PF_Text)
-    exitWithError("Unknown format is specified.");
-
-  std::mutex ErrorLock;
-  SmallSet<instrprof_error, 4> WriterErrorCodes;
-
+/// Load \p Inputs into \p NumThreads writer contexts and merge them into a
+/// single context, which is returned. Deferred hard errors are reported
+/// before returning.
+static std::unique_ptr<WriterContext>
+loadAndMergeInputs(ArrayRef<WeightedFile> Inputs, SymbolRemapper *Remapper,
+                   bool OutputSparse, unsigned NumThreads,
+                   std::mutex &ErrorLock,
+                   SmallSet<instrprof_error, 4> &WriterErrorCodes) {
   // If NumThreads is not specified, auto-detect a good default.
   if (NumThreads == 0)
     NumThreads =
@@ -379,12 +375,80 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
            WC->ErrWhence);
   }
 
+  return std::move(Contexts[0]);
+}
+
+/// Write the indexed profile held by \p Writer to a new temporary file and
+/// return the name of that file.
+static std::string writeIntermediateProfile(InstrProfWriter &Writer) {
+  int FD;
+  SmallString<128> Path;
+  if (std::error_code EC = sys::fs::createTemporaryFile(
+          "llvm-profdata", "profdata", FD, Path))
+    exitWithErrorCode(EC, "intermediate profile");
+
+  raw_fd_ostream Output(FD, /*shouldClose=*/true);
+  Writer.write(Output);
+  Output.close();
+  if (Output.has_error())
+    exitWithError("could not write intermediate profile", Path.str());
+  return Path.str();
+}
+
+static void mergeInstrProfile(const WeightedFileVector &Inputs,
+                              SymbolRemapper *Remapper,
+                              StringRef OutputFilename,
+                              ProfileFormat OutputFormat, bool OutputSparse,
+                              unsigned NumThreads, unsigned ChunkSize) {
+  if (OutputFilename.compare("-") == 0)
+    exitWithError("Cannot write indexed profdata format to stdout.");
+
+  if (OutputFormat != PF_Binary && OutputFormat != PF_Compact_Binary &&
+      OutputFormat != PF_Text)
+    exitWithError("Unknown format is specified.");
+
+  std::mutex ErrorLock;
+  SmallSet<instrprof_error, 4> WriterErrorCodes;
+
+  std::unique_ptr<WriterContext> Result;
+  if (ChunkSize == 0 || Inputs.size() <= ChunkSize) {
+    Result = loadAndMergeInputs(Inputs, Remapper, OutputSparse, NumThreads,
+                                ErrorLock, WriterErrorCodes);
+  } else {
+    // Every writer context ends up holding the records of all the functions
+    // its inputs have seen, so merging everything at once needs memory for
+    // NumThreads copies of the merged profile. Instead merge the inputs one
+    // chunk at a time, spill every merged chunk to an indexed profile on disk
+    // and then stream those intermediate profiles into a single writer.
+    std::vector<std::unique_ptr<FileRemover>> Intermediates;
+    WeightedFileVector IntermediateInputs;
+    ArrayRef<WeightedFile> Remaining = Inputs;
+    while (!Remaining.empty()) {
+      ArrayRef<WeightedFile> Chunk = Remaining.take_front(ChunkSize);
+      Remaining = Remaining.drop_front(Chunk.size());
+
+      std::unique_ptr<WriterContext> WC = loadAndMergeInputs(
+          Chunk, Remapper, OutputSparse, NumThreads, ErrorLock,
+          WriterErrorCodes);
+      // Skip chunks that only contained empty raw profiles.
+      if (WC->Writer.getProfileKind() == InstrProfWriter::PF_Unknown)
+        continue;
+      std::string Path = writeIntermediateProfile(WC->Writer);
+      Intermediates.push_back(std::make_unique<FileRemover>(Path));
+      // Weights and remappings have already been applied to the chunk.
+      IntermediateInputs.push_back({Path, 1});
+    }
+    Result = loadAndMergeInputs(IntermediateInputs, /*Remapper=*/nullptr,
+                                OutputSparse, /*NumThreads=*/1, ErrorLock,
+                                WriterErrorCodes);
+  }
+
   std::error_code EC;
   raw_fd_ostream Output(OutputFilename.data(), EC, sys::fs::OF_None);
   if (EC)
     exitWithErrorCode(EC, OutputFilename);
 
-  InstrProfWriter &Writer = Contexts[0]->Writer;
+  InstrProfWriter &Writer = Result->Writer;
   if (OutputFormat == PF_Text) {
     if (Error E = Writer.writeText(Output))
       exitWithError(std::move(E));
@@ -425,13 +489,15 @@ remapSamples(const sampleprof::FunctionSamples &Samples,
 }
 
 static sampleprof::SampleProfileFormat FormatMap[] = {
-    sampleprof::SPF_None, sampleprof::SPF_Text, sampleprof::SPF_Compact_Binary,
-    sampleprof::SPF_GCC, sampleprof::SPF_Binary};
+    sampleprof::SPF_None,          sampleprof::SPF_Text,
+    sampleprof::SPF_Compact_Binary, sampleprof::SPF_Ext_Binary,
+    sampleprof::SPF_GCC,           sampleprof::SPF_Binary};
 
 static void mergeSampleProfile(const WeightedFileVector &Inputs,
                                SymbolRemapper *Remapper,
                                StringRef OutputFilename,
-                               ProfileFormat OutputFormat) {
+                               ProfileFormat OutputFormat,
+                               bool CompressAllSections) {
   using namespace sampleprof;
   StringMap<FunctionSamples> ProfileMap;
   SmallVector<std::unique_ptr<sampleprof::SampleProfileReader>, 5> Readers;
@@ -473,7 +539,16 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
     exitWithErrorCode(EC, OutputFilename);
 
   auto Writer = std::move(WriterOrErr.get());
-  Writer->write(ProfileMap);
+  if (CompressAllSections) {
+    if (OutputFormat != PF_Ext_Binary)
+      warn("-compress-all-sections ignored: it is only meaningful for "
+           "-extbinary");
+    else if (!zlib::isAvailable())
+      exitWithError("cannot compress the profile: zlib is not available");
+    Writer->setToCompressAllSections();
+  }
+  if (std::error_code EC = Writer->write(ProfileMap))
+    exitWithErrorCode(EC, OutputFilename);
 }
 
 static WeightedFile parseWeightedFile(const StringRef &WeightedFilename) {
@@ -586,16 +661,27 @@ static int merge_main(int argc, const char *argv[]) {
       cl::values(clEnumValN(PF_Binary, "binary", "Binary encoding (default)"),
                  clEnumValN(PF_Compact_Binary, "compbinary",
                             "Compact binary encoding"),
+                 clEnumValN(PF_Ext_Binary, "extbinary",
+                            "Extensible binary encoding"),
                  clEnumValN(PF_Text, "text", "Text encoding"),
                  clEnumValN(PF_GCC, "gcc",
                             "GCC encoding (only meaningful for -sample)")));
   cl::opt<bool> OutputSparse("sparse", cl::init(false),
       cl::desc("Generate a sparse profile (only meaningful for -instr)"));
+  cl::opt<bool> CompressAllSections(
+      "compress-all-sections", cl::init(false),
+      cl::desc("Compress all sections when writing the profile (only "
+               "meaningful for -extbinary)"));
   cl::opt<unsigned> NumThreads(
       "num-threads", cl::init(0),
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> ChunkSize(
+      "chunk-size", cl::init(0),
+      cl::desc("Merge instrumentation profiles this many inputs at a time, "
+               "spilling every chunk to a temporary indexed profile to "
+               "bound memory use (default: merge all inputs at once)"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
@@ -626,10 +712,10 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                      OutputFormat, OutputSparse, NumThreads);
+                      OutputFormat, OutputSparse, NumThreads, ChunkSize);
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                       OutputFormat);
+                       OutputFormat, CompressAllSections);
 
   return 0;
 }
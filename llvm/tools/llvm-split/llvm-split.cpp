@@ -39,6 +39,11 @@ static cl::opt<bool>
     PreserveLocals("preserve-locals", cl::Prefix, cl::init(false),
                    cl::desc("Split without externalizing locals"));
 
+static cl::opt<bool>
+    BalanceCost("balance-cost", cl::init(false),
+                cl::desc("Balance the estimated code generation cost of the "
+                         "partitions"));
+
 int main(int argc, char **argv) {
   LLVMContext Context;
   SMDiagnostic Err;
@@ -66,7 +71,8 @@ int main(int argc, char **argv) {
 
     // Declare success.
     Out->keep();
-  }, PreserveLocals);
+  }, PreserveLocals,
+     BalanceCost ? SplitModuleMode::CostBalanced : SplitModuleMode::Hash);
 
   return 0;
 }
@@ -14,6 +14,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/DebugInfo/Symbolize/DIPrinter.h"
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
@@ -23,6 +25,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
 #include <cstring>
@@ -106,6 +109,11 @@ static cl::opt<std::string>
     ClDwpName("dwp", cl::init(""),
               cl::desc("Path to DWP file to be use for any split CUs"));
 
+static cl::opt<bool>
+    ClUseGsym("use-gsym", cl::init(false),
+              cl::desc("Symbolize from <binary>.gsym files when they exist "
+                       "instead of parsing the debug info"));
+
 static cl::list<std::string>
 ClDsymHint("dsym-hint", cl::ZeroOrMore,
            cl::desc("Path to .dSYM bundles to search for debug info for the "
@@ -158,6 +166,14 @@ static cl::opt<DIPrinter::OutputStyle>
                              clEnumValN(DIPrinter::OutputStyle::GNU, "GNU",
                                         "GNU addr2line style")));
 
+static cl::opt<unsigned> ClNumThreads(
+    "num-threads", cl::init(1), cl::value_desc("N"),
+    cl::desc("Symbolize on N threads. The input is read up to its end before "
+             "anything is printed, so this is meant for batches of addresses, "
+             "not for interactive use"));
+static cl::alias ClNumThreadsShort("j", cl::desc("Alias for -num-threads"),
+                                   cl::aliasopt(ClNumThreads));
+
 static cl::extrahelp
     HelpResponse("\nPass @FILE as argument to read options from FILE.\n");
 
@@ -217,20 +233,20 @@ static bool parseCommand(StringRef InputString, Command &Cmd,
 }
 
 static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
-                           DIPrinter &Printer) {
+                           DIPrinter &Printer, raw_ostream &OS) {
   Command Cmd;
   std::string ModuleName;
   uint64_t Offset = 0;
   if (!parseCommand(StringRef(InputString), Cmd, ModuleName, Offset)) {
-    outs() << InputString;
+    OS << InputString;
     return;
   }
 
   if (ClPrintAddress) {
-    outs() << "0x";
-    outs().write_hex(Offset);
+    OS << "0x";
+    OS.write_hex(Offset);
     StringRef Delimiter = ClPrettyPrint ? ": " : "\n";
-    outs() << Delimiter;
+    OS << Delimiter;
   }
   Offset -= ClAdjustVMA;
   if (Cmd == Command::Data) {
@@ -244,7 +260,7 @@ static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
       for (DILocal Local : *ResOrErr)
         Printer << Local;
       if (ResOrErr->empty())
-        outs() << "??\n";
+        OS << "??\n";
     }
   } else if (ClPrintInlining) {
     auto ResOrErr = Symbolizer.symbolizeInlinedCode(
@@ -266,7 +282,45 @@ static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
     Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get());
   }
   if (ClOutputStyle == DIPrinter::OutputStyle::LLVM)
-    outs() << "\n";
+    OS << "\n";
+}
+
+static DIPrinter createPrinter(raw_ostream &OS) {
+  return DIPrinter(OS, ClPrintFunctions != FunctionNameKind::None,
+                   ClPrettyPrint, ClPrintSourceContextLines, ClVerbose,
+                   ClBasenames, ClOutputStyle);
+}
+
+/// Symbolize \p Inputs on \p NumThreads threads and print the results in
+/// input order. The inputs are split between the threads by module, and every
+/// thread has its own symbolizer, so each module is still only loaded once.
+static void symbolizeInputsInParallel(ArrayRef<std::string> Inputs,
+                                      const LLVMSymbolizer::Options &Opts,
+                                      unsigned NumThreads) {
+  std::vector<std::vector<size_t>> Shards(NumThreads);
+  for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+    Command Cmd;
+    std::string ModuleName;
+    uint64_t Offset;
+    parseCommand(Inputs[I], Cmd, ModuleName, Offset);
+    Shards[hash_value(ModuleName) % NumThreads].push_back(I);
+  }
+
+  std::vector<std::string> Outputs(Inputs.size());
+  ThreadPool Pool(NumThreads);
+  for (const std::vector<size_t> &Shard : Shards)
+    Pool.async([&Shard, &Inputs, &Outputs, &Opts]() {
+      LLVMSymbolizer Symbolizer(Opts);
+      for (size_t I : Shard) {
+        raw_string_ostream OS(Outputs[I]);
+        DIPrinter Printer = createPrinter(OS);
+        symbolizeInput(Inputs[I], Symbolizer, Printer, OS);
+      }
+    });
+  Pool.wait();
+
+  for (const std::string &Output : Outputs)
+    outs() << Output;
 }
 
 int main(int argc, char **argv) {
@@ -299,6 +353,7 @@ int main(int argc, char **argv) {
   Opts.DefaultArch = ClDefaultArch;
   Opts.FallbackDebugPath = ClFallbackDebugPath;
   Opts.DWPName = ClDwpName;
+  Opts.UseGsym = ClUseGsym;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -308,23 +363,33 @@ int main(int argc, char **argv) {
                 "\" (must have the '.dSYM' extension).\n";
     }
   }
-  LLVMSymbolizer Symbolizer(Opts);
 
-  DIPrinter Printer(outs(), ClPrintFunctions != FunctionNameKind::None,
-                    ClPrettyPrint, ClPrintSourceContextLines, ClVerbose,
-                    ClBasenames, ClOutputStyle);
+  const int kMaxInputStringLength = 1024;
+  char InputString[kMaxInputStringLength];
 
-  if (ClInputAddresses.empty()) {
-    const int kMaxInputStringLength = 1024;
-    char InputString[kMaxInputStringLength];
+  if (ClNumThreads > 1) {
+    std::vector<std::string> Inputs;
+    if (ClInputAddresses.empty()) {
+      while (fgets(InputString, sizeof(InputString), stdin))
+        Inputs.push_back(InputString);
+    } else {
+      Inputs.assign(ClInputAddresses.begin(), ClInputAddresses.end());
+    }
+    symbolizeInputsInParallel(Inputs, Opts, ClNumThreads);
+    return 0;
+  }
+
+  LLVMSymbolizer Symbolizer(Opts);
+  DIPrinter Printer = createPrinter(outs());
 
+  if (ClInputAddresses.empty()) {
     while (fgets(InputString, sizeof(InputString), stdin)) {
-      symbolizeInput(InputString, Symbolizer, Printer);
+      symbolizeInput(InputString, Symbolizer, Printer, outs());
       outs().flush();
     }
   } else {
     for (StringRef Address : ClInputAddresses)
-      symbolizeInput(Address, Symbolizer, Printer);
+      symbolizeInput(Address, Symbolizer, Printer, outs());
   }
 
   return 0;
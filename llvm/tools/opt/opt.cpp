@@ -566,8 +566,24 @@ int main(int argc, char **argv) {
   std::unique_ptr<ToolOutputFile> RemarksFile = std::move(*RemarksFileOrErr);
 
   // Load the input module...
-  std::unique_ptr<Module> M =
-      parseIRFile(InputFilename, Err, Context, !NoVerify, ClDataLayout);
+  std::unique_ptr<Module> M;
+  if (StripDebug) {
+    // Read bitcode lazily and mark the debug info stripped before
+    // materializing it, so that the reader never loads the debug info
+    // metadata in the first place.
+    M = getLazyIRFileModule(InputFilename, Err, Context,
+                            /*ShouldLazyLoadMetadata=*/true);
+    if (M) {
+      StripDebugInfo(*M);
+      if (Error E = M->materializeAll()) {
+        errs() << argv[0] << ": " << toString(std::move(E)) << '\n';
+        return 1;
+      }
+      if (!ClDataLayout.empty())
+        M->setDataLayout(ClDataLayout);
+    }
+  } else
+    M = parseIRFile(InputFilename, Err, Context, !NoVerify, ClDataLayout);
 
   if (!M) {
     Err.print(argv[0], errs());
@@ -24,18 +24,22 @@
 #include "llvm/Object/Archive.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/COFF.h"
+#include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/MachO.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/Signals.h"
@@ -59,6 +63,7 @@ enum ActionType {
   CoveredFunctionsAction,
   HtmlReportAction,
   MergeAction,
+  MergeRawAction,
   NotCoveredFunctionsAction,
   PrintAction,
   PrintCovPointsAction,
@@ -82,7 +87,9 @@ cl::opt<ActionType> Action(
                    "REMOVED. Use -symbolize & coverage-report-server.py."),
         clEnumValN(SymbolizeAction, "symbolize",
                    "Produces a symbolized JSON report from binary report."),
-        clEnumValN(MergeAction, "merge", "Merges reports.")));
+        clEnumValN(MergeAction, "merge", "Merges reports."),
+        clEnumValN(MergeRawAction, "merge-raw",
+                   "Merges .sancov files into one sparse .sancov file.")));
 
 static cl::list<std::string>
     ClInputFiles(cl::Positional, cl::OneOrMore,
@@ -122,6 +129,9 @@ struct FileHeader {
 static const uint32_t BinCoverageMagic = 0xC0BFFFFF;
 static const uint32_t Bitness32 = 0xFFFFFF32;
 static const uint32_t Bitness64 = 0xFFFFFF64;
+// Sparse files hold the ULEB128-encoded gaps between the sorted addresses,
+// the first one counted from 0.
+static const uint32_t BitnessSparse = 0xFFFFFFC8;
 
 static Regex SancovFileRegex("(.*)\\.[0-9]+\\.sancov");
 static Regex SymcovFileRegex(".*\\.symcov");
@@ -131,14 +141,18 @@ static Regex SymcovFileRegex(".*\\.symcov");
 // Contents of .sancov file: list of coverage point addresses that were
 // executed.
 struct RawCoverage {
-  explicit RawCoverage(std::unique_ptr<std::set<uint64_t>> Addrs)
-      : Addrs(std::move(Addrs)) {}
+  explicit RawCoverage(std::unique_ptr<std::set<uint64_t>> Addrs,
+                       bool FromPcTable = false)
+      : Addrs(std::move(Addrs)), FromPcTable(FromPcTable) {}
 
   // Read binary .sancov file.
   static ErrorOr<std::unique_ptr<RawCoverage>>
   read(const std::string &FileName);
 
   std::unique_ptr<std::set<uint64_t>> Addrs;
+  // Sparse files come from inline-8bit-counters coverage and hold PCs from the
+  // PC table of the binary rather than call sites of __sanitizer_cov*.
+  bool FromPcTable;
 };
 
 // Coverage point has an opaque Id and corresponds to multiple source locations.
@@ -224,6 +238,33 @@ static void readInts(const char *Start, const char *End,
   std::copy(S, E, std::inserter(*Ints, Ints->end()));
 }
 
+static bool readSparseInts(const char *Start, const char *End,
+                           std::set<uint64_t> *Ints) {
+  const uint8_t *P = reinterpret_cast<const uint8_t *>(Start);
+  const uint8_t *E = reinterpret_cast<const uint8_t *>(End);
+  uint64_t Last = 0;
+  while (P < E) {
+    unsigned N;
+    const char *Error = nullptr;
+    Last += decodeULEB128(P, &N, E, &Error);
+    if (Error)
+      return false;
+    Ints->insert(Ints->end(), Last);
+    P += N;
+  }
+  return true;
+}
+
+static void writeSparseInts(const std::set<uint64_t> &Ints, raw_ostream &OS) {
+  FileHeader Header = {BitnessSparse, BinCoverageMagic};
+  OS.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  uint64_t Last = 0;
+  for (uint64_t I : Ints) {
+    encodeULEB128(I - Last, OS);
+    Last = I;
+  }
+}
+
 ErrorOr<std::unique_ptr<RawCoverage>>
 RawCoverage::read(const std::string &FileName) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
@@ -244,6 +285,7 @@ RawCoverage::read(const std::string &FileName) {
   }
 
   auto Addrs = std::make_unique<std::set<uint64_t>>();
+  bool FromPcTable = false;
 
   switch (Header->Bitness) {
   case Bitness64:
@@ -254,6 +296,14 @@ RawCoverage::read(const std::string &FileName) {
     readInts<uint32_t>(Buf->getBufferStart() + 8, Buf->getBufferEnd(),
                        Addrs.get());
     break;
+  case BitnessSparse:
+    if (!readSparseInts(Buf->getBufferStart() + 8, Buf->getBufferEnd(),
+                        Addrs.get())) {
+      errs() << "Malformed sparse coverage: " << FileName << '\n';
+      return make_error_code(errc::illegal_byte_sequence);
+    }
+    FromPcTable = true;
+    break;
   default:
     errs() << "Unsupported bitness: " << Header->Bitness << '\n';
     return make_error_code(errc::illegal_byte_sequence);
@@ -263,7 +313,8 @@ RawCoverage::read(const std::string &FileName) {
   // to compactify the data.
   Addrs->erase(0);
 
-  return std::unique_ptr<RawCoverage>(new RawCoverage(std::move(Addrs)));
+  return std::unique_ptr<RawCoverage>(
+      new RawCoverage(std::move(Addrs), FromPcTable));
 }
 
 // Print coverage addresses.
@@ -793,11 +844,83 @@ static uint64_t getPreviousInstructionPc(uint64_t PC,
   }
 }
 
+static bool isPcTableSection(const object::SectionRef &Section) {
+  Expected<StringRef> NameOrErr = Section.getName();
+  failIfError(NameOrErr);
+  // COFF linkers merge the .SCOVP$M sections into .SCOVP.
+  return *NameOrErr == "__sancov_pcs" || NameOrErr->startswith(".SCOVP");
+}
+
+static bool hasPcTable(const object::ObjectFile &O) {
+  return any_of(O.sections(), isPcTableSection);
+}
+
+// Locate addresses of all coverage points in the PC table of a file built
+// with -fsanitize-coverage=pc-table. The table is an array of {PC, flags}
+// pairs, one per instrumented basic block.
+static void getPcTableCoveragePoints(const object::ObjectFile &O,
+                                     std::set<uint64_t> *Addrs) {
+  for (object::SectionRef Section : O.sections()) {
+    if (!isPcTableSection(Section))
+      continue;
+    Expected<StringRef> BytesStr = Section.getContents();
+    failIfError(BytesStr);
+    uint64_t SectionAddr = Section.getAddress();
+    uint64_t SectionEnd = SectionAddr + BytesStr->size();
+
+    // The PCs of position-independent code are only filled in by dynamic
+    // relocations.
+    std::map<uint64_t, uint64_t> RelocatedPCs;
+    if (isa<object::ELFObjectFileBase>(&O)) {
+      for (object::SectionRef RelSection : O.dynamic_relocation_sections()) {
+        for (object::ELFRelocationRef Reloc : RelSection.relocations()) {
+          uint64_t Offset = Reloc.getOffset();
+          if (Offset < SectionAddr || Offset >= SectionEnd)
+            continue;
+          Expected<int64_t> AddendOrErr = Reloc.getAddend();
+          if (!AddendOrErr) {
+            // REL relocations keep the addend in the section contents.
+            consumeError(AddendOrErr.takeError());
+            continue;
+          }
+          uint64_t PC = *AddendOrErr;
+          object::symbol_iterator Symbol = Reloc.getSymbol();
+          if (Symbol != O.symbol_end()) {
+            Expected<uint64_t> AddressOrErr = Symbol->getAddress();
+            failIfError(AddressOrErr);
+            PC += *AddressOrErr;
+          }
+          RelocatedPCs[Offset - SectionAddr] = PC;
+        }
+      }
+    }
+
+    DataExtractor Data(*BytesStr, O.isLittleEndian(), O.getBytesInAddress());
+    uint64_t Offset = 0;
+    while (Data.isValidOffsetForDataOfSize(Offset,
+                                           2 * O.getBytesInAddress())) {
+      auto It = RelocatedPCs.find(Offset);
+      uint64_t PC = Data.getAddress(&Offset);
+      if (It != RelocatedPCs.end())
+        PC = It->second;
+      Data.getAddress(&Offset); // Flags.
+      if (PC)
+        Addrs->insert(PC);
+    }
+  }
+}
+
 // Locate addresses of all coverage points in a file. Coverage point
 // is defined as the 'address of instruction following __sanitizer_cov
-// call - 1'.
+// call - 1', or as a PC from the PC table for inline-8bit-counters coverage.
 static void getObjectCoveragePoints(const object::ObjectFile &O,
+                                    bool FromPcTable,
                                     std::set<uint64_t> *Addrs) {
+  if (FromPcTable) {
+    getPcTableCoveragePoints(O, Addrs);
+    return;
+  }
+
   Triple TheTriple("unknown-unknown-unknown");
   TheTriple.setArch(Triple::ArchType(O.getArch()));
   auto TripleName = TheTriple.getTriple();
@@ -910,19 +1033,30 @@ findSanitizerCovFunctions(const std::string &FileName) {
   return Result;
 }
 
+static bool hasPcTable(const std::string &FileName) {
+  bool Result = false;
+  visitObjectFiles(FileName, [&](const object::ObjectFile &O) {
+    Result |= hasPcTable(O);
+  });
+  return Result;
+}
+
 // Locate addresses of all coverage points in a file. Coverage point
 // is defined as the 'address of instruction following __sanitizer_cov
-// call - 1'.
-static std::set<uint64_t> findCoveragePointAddrs(const std::string &FileName) {
+// call - 1', or as a PC from the PC table for inline-8bit-counters coverage.
+static std::set<uint64_t> findCoveragePointAddrs(const std::string &FileName,
+                                                 bool FromPcTable = false) {
   std::set<uint64_t> Result;
   visitObjectFiles(FileName, [&](const object::ObjectFile &O) {
-    getObjectCoveragePoints(O, &Result);
+    getObjectCoveragePoints(O, FromPcTable, &Result);
   });
   return Result;
 }
 
 static void printCovPoints(const std::string &ObjFile, raw_ostream &OS) {
-  for (uint64_t Addr : findCoveragePointAddrs(ObjFile)) {
+  bool FromPcTable =
+      findSanitizerCovFunctions(ObjFile).empty() && hasPcTable(ObjFile);
+  for (uint64_t Addr : findCoveragePointAddrs(ObjFile, FromPcTable)) {
     OS << "0x";
     OS.write_hex(Addr);
     OS << "\n";
@@ -982,7 +1116,8 @@ symbolize(const RawCoverage &Data, const std::string ObjectFile) {
     Coverage->CoveredIds.insert(utohexstr(Addr, true));
   }
 
-  std::set<uint64_t> AllAddrs = findCoveragePointAddrs(ObjectFile);
+  std::set<uint64_t> AllAddrs =
+      findCoveragePointAddrs(ObjectFile, Data.FromPcTable);
   if (!std::includes(AllAddrs.begin(), AllAddrs.end(), Data.Addrs->begin(),
                      Data.Addrs->end())) {
     fail("Coverage points in binary and .sancov file do not match.");
@@ -1107,6 +1242,19 @@ static void readAndPrintRawCoverage(const std::vector<std::string> &FileNames,
   }
 }
 
+// Read list of files and write the union of their coverage as a sparse
+// .sancov file, e.g. to combine the coverage of one module from many runs.
+static void readAndMergeRawCoverage(const std::vector<std::string> &FileNames,
+                                    raw_ostream &OS) {
+  std::set<uint64_t> Addrs;
+  for (const auto &FileName : FileNames) {
+    auto Cov = RawCoverage::read(FileName);
+    failIfError(Cov);
+    Addrs.insert(Cov.get()->Addrs->begin(), Cov.get()->Addrs->end());
+  }
+  writeSparseInts(Addrs, OS);
+}
+
 static std::unique_ptr<SymbolizedCoverage>
 merge(const std::vector<std::unique_ptr<SymbolizedCoverage>> &Coverages) {
   if (Coverages.empty())
@@ -1202,7 +1350,8 @@ readSymbolizeAndMergeCmdArguments(std::vector<std::string> FileNames) {
 
     // Read raw coverage and symbolize it.
     for (const auto &Pair : CoverageByObjFile) {
-      if (findSanitizerCovFunctions(Pair.first).empty()) {
+      if (findSanitizerCovFunctions(Pair.first).empty() &&
+          !hasPcTable(Pair.first)) {
         errs()
             << "WARNING: Ignoring " << Pair.first
             << " and its coverage because  __sanitizer_cov* functions were not "
@@ -1241,6 +1390,7 @@ int main(int Argc, char **Argv) {
       "  Depending on chosen action the tool expects different input files:\n"
       "    -print-coverage-pcs     - coverage-instrumented binary files\n"
       "    -print-coverage         - .sancov files\n"
+      "    -merge-raw              - .sancov files\n"
       "    <other actions>         - .sancov files & corresponding binary "
       "files, .symcov files\n"
       );
@@ -1249,6 +1399,11 @@ int main(int Argc, char **Argv) {
   if (Action == PrintAction) {
     readAndPrintRawCoverage(ClInputFiles, outs());
     return 0;
+  } else if (Action == MergeRawAction) {
+    // -merge-raw doesn't need object files either.
+    sys::ChangeStdoutToBinary();
+    readAndMergeRawCoverage(ClInputFiles, outs());
+    return 0;
   } else if (Action == PrintCovPointsAction) {
     // -print-coverage-points doesn't need coverage files.
     for (const std::string &ObjFile : ClInputFiles) {
@@ -1285,6 +1440,7 @@ int main(int Argc, char **Argv) {
     return 1;
   case PrintAction:
   case PrintCovPointsAction:
+  case MergeRawAction:
     llvm_unreachable("unsupported action");
   }
 }
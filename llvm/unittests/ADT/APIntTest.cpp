@@ -214,6 +214,41 @@ TEST(APIntTest, i256) {
   EXPECT_EQ(static_cast<int64_t>((~0ull << 60) | 15), s256.getSExtValue());
 }
 
+TEST(APIntTest, InlineStorage) {
+  // Values of up to 128 bits do not allocate.
+  EXPECT_FALSE(APInt(64, 1).needsCleanup());
+  EXPECT_FALSE(APInt(65, 1).needsCleanup());
+  EXPECT_FALSE(APInt(128, 1).needsCleanup());
+  EXPECT_TRUE(APInt(129, 1).needsCleanup());
+
+  APInt A = APInt::getAllOnesValue(128);
+  APInt B = A.zext(129);
+  EXPECT_EQ(128u, B.countPopulation());
+  EXPECT_EQ(A, B.trunc(128));
+  EXPECT_EQ(APInt::getAllOnesValue(256), A.sext(256));
+  EXPECT_EQ(APInt::getAllOnesValue(100), B.trunc(100));
+
+  // Assignment between inline and heap allocated values.
+  APInt C(128, 7);
+  C = B;
+  EXPECT_EQ(B, C);
+  C = A;
+  EXPECT_EQ(A, C);
+  EXPECT_FALSE(C.needsCleanup());
+  C = std::move(B);
+  EXPECT_EQ(129u, C.getBitWidth());
+  EXPECT_EQ(128u, C.countPopulation());
+  C = std::move(A);
+  EXPECT_EQ(APInt::getAllOnesValue(128), C);
+
+  APInt D(128, 0);
+  D.setBit(127);
+  D += APInt(128, 1);
+  EXPECT_EQ(2u, D.countPopulation());
+  EXPECT_EQ(APInt(128, 1), D.lshr(127));
+  EXPECT_EQ(APInt(128, 1), D * D);
+}
+
 TEST(APIntTest, i1) {
   const APInt neg_two(1, static_cast<uint64_t>(-2), true);
   const APInt neg_one(1, static_cast<uint64_t>(-1), true);
@@ -33,7 +33,7 @@ TEST(APSIntTest, MoveTest) {
   A = APSInt(64, true);
   EXPECT_TRUE(A.isUnsigned());
 
-  Wide = APInt(128, 1);
+  Wide = APInt(256, 1);
   Bits = Wide.getRawData();
   A = std::move(Wide);
   EXPECT_TRUE(A.isUnsigned());
@@ -148,6 +148,18 @@ TEST(APSIntTest, FromString) {
   EXPECT_EQ(APSInt("0").getExtValue(), 0);
   EXPECT_EQ(APSInt("56789").getExtValue(), 56789);
   EXPECT_EQ(APSInt("-1234").getExtValue(), -1234);
+
+  // Check the widths on both sides of the 64-bit fast path.
+  EXPECT_EQ(APSInt("255").getBitWidth(), 8u);
+  EXPECT_TRUE(APSInt("255").isUnsigned());
+  EXPECT_EQ(APSInt("-128").getBitWidth(), 8u);
+  EXPECT_EQ(APSInt("-129").getBitWidth(), 9u);
+  EXPECT_EQ(APSInt("0").getBitWidth(), 5u);
+  EXPECT_EQ(APSInt("999999999999999999").getExtValue(), 999999999999999999);
+  EXPECT_EQ(APSInt("-99999999999999999").getExtValue(), -99999999999999999);
+  EXPECT_EQ(APSInt("9223372036854775807").getBitWidth(), 63u);
+  EXPECT_EQ(APSInt("-9223372036854775808").getBitWidth(), 64u);
+  EXPECT_EQ(APSInt("18446744073709551616").getBitWidth(), 65u);
 }
 
 #if defined(GTEST_HAS_DEATH_TEST) && !defined(NDEBUG)
@@ -0,0 +1,142 @@
+//===- llvm/unittest/ADT/FlatHashMapTest.cpp - FlatHashMap unit tests -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/FlatHashMap.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(FlatHashMapTest, EmptyMap) {
+  FlatHashMap<int, int> M;
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ(0u, M.size());
+  EXPECT_TRUE(M.begin() == M.end());
+  EXPECT_EQ(0u, M.count(1));
+  EXPECT_TRUE(M.find(1) == M.end());
+  EXPECT_EQ(0, M.lookup(1));
+  EXPECT_FALSE(M.erase(1));
+  EXPECT_EQ(0u, M.getMemorySize());
+}
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<int, int> M;
+  EXPECT_TRUE(M.insert(std::make_pair(1, 10)).second);
+  EXPECT_FALSE(M.insert(std::make_pair(1, 20)).second);
+  EXPECT_EQ(10, M.lookup(1));
+  EXPECT_EQ(1u, M.size());
+
+  M[2] = 20;
+  EXPECT_EQ(20, M.find(2)->second);
+  EXPECT_TRUE(M.try_emplace(3, 30).second);
+  EXPECT_EQ(3u, M.size());
+
+  EXPECT_TRUE(M.erase(2));
+  EXPECT_FALSE(M.erase(2));
+  EXPECT_EQ(0u, M.count(2));
+  EXPECT_EQ(2u, M.size());
+
+  M.erase(M.find(3));
+  EXPECT_EQ(1u, M.size());
+  EXPECT_EQ(10, M.lookup(1));
+
+  M.clear();
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ(0u, M.count(1));
+}
+
+// Keys with the DenseMapInfo empty and tombstone values are ordinary keys.
+TEST(FlatHashMapTest, SpecialKeys) {
+  FlatHashMap<unsigned, int> M;
+  M[DenseMapInfo<unsigned>::getEmptyKey()] = 1;
+  M[DenseMapInfo<unsigned>::getTombstoneKey()] = 2;
+  EXPECT_EQ(2u, M.size());
+  EXPECT_EQ(1, M.lookup(DenseMapInfo<unsigned>::getEmptyKey()));
+  EXPECT_EQ(2, M.lookup(DenseMapInfo<unsigned>::getTombstoneKey()));
+}
+
+// Compare against std::map under a random mix of insertions and erasures,
+// which exercises growing and reusing deleted buckets.
+TEST(FlatHashMapTest, RandomOperations) {
+  std::mt19937 Rand;
+  FlatHashMap<unsigned, unsigned> M;
+  std::map<unsigned, unsigned> Ref;
+  for (unsigned I = 0; I < 100000; ++I) {
+    unsigned Key = Rand() % 5000;
+    if (Rand() % 3 == 0) {
+      EXPECT_EQ(Ref.erase(Key) != 0, M.erase(Key));
+    } else {
+      auto R = M.try_emplace(Key, I);
+      EXPECT_EQ(Ref.emplace(Key, I).second, R.second);
+    }
+  }
+  EXPECT_EQ(Ref.size(), M.size());
+  for (auto &KV : Ref)
+    EXPECT_EQ(KV.second, M.lookup(KV.first));
+
+  size_t Count = 0;
+  for (auto &KV : M) {
+    EXPECT_EQ(Ref[KV.first], KV.second);
+    ++Count;
+  }
+  EXPECT_EQ(Ref.size(), Count);
+}
+
+TEST(FlatHashMapTest, CopyAndMove) {
+  FlatHashMap<int, std::string> M;
+  for (int I = 0; I < 100; ++I)
+    M[I] = std::to_string(I);
+
+  FlatHashMap<int, std::string> Copy(M);
+  EXPECT_EQ(100u, Copy.size());
+  EXPECT_EQ("42", Copy.lookup(42));
+
+  FlatHashMap<int, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_EQ("99", Moved.lookup(99));
+
+  Copy = Moved;
+  EXPECT_EQ(100u, Copy.size());
+  Moved = std::move(M);
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_EQ("0", Moved.lookup(0));
+}
+
+TEST(FlatHashMapTest, MoveOnlyValues) {
+  FlatHashMap<int, std::unique_ptr<int>> M;
+  for (int I = 0; I < 1000; ++I)
+    M.try_emplace(I, std::make_unique<int>(I));
+  for (int I = 0; I < 1000; ++I)
+    EXPECT_EQ(I, *M.find(I)->second);
+}
+
+TEST(FlatHashMapTest, Reserve) {
+  FlatHashMap<int, int> M(1000);
+  size_t Size = M.getMemorySize();
+  for (int I = 0; I < 1000; ++I)
+    M[I] = I;
+  EXPECT_EQ(Size, M.getMemorySize());
+}
+
+TEST(FlatHashMapTest, ConstIterator) {
+  FlatHashMap<int, int> M = {{1, 2}, {3, 4}};
+  const FlatHashMap<int, int> &CM = M;
+  FlatHashMap<int, int>::const_iterator I = M.begin();
+  EXPECT_TRUE(I == CM.begin());
+  int Sum = 0;
+  for (const auto &KV : CM)
+    Sum += KV.first + KV.second;
+  EXPECT_EQ(10, Sum);
+}
+
+} // namespace
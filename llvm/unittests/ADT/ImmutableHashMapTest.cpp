@@ -0,0 +1,110 @@
+//===------- ImmutableHashMapTest.cpp - ImmutableHashMap unit tests -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ImmutableHashMap.h"
+#include "llvm/ADT/DenseMap.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+using IntMap = ImmutableHashMap<int, int>;
+
+TEST(ImmutableHashMapTest, EmptyIntMapTest) {
+  IntMap::Factory f;
+
+  EXPECT_TRUE(f.getEmptyMap() == f.getEmptyMap());
+  EXPECT_FALSE(f.getEmptyMap() != f.getEmptyMap());
+  EXPECT_TRUE(f.getEmptyMap().isEmpty());
+
+  IntMap S = f.getEmptyMap();
+  EXPECT_TRUE(S.begin() == S.end());
+  EXPECT_FALSE(S.begin() != S.end());
+  EXPECT_EQ(nullptr, S.lookup(3));
+}
+
+TEST(ImmutableHashMapTest, MultiElemIntMapTest) {
+  IntMap::Factory f;
+  IntMap S = f.getEmptyMap();
+
+  IntMap S2 = f.add(f.add(f.add(S, 3, 10), 4, 11), 5, 12);
+
+  EXPECT_TRUE(S.isEmpty());
+  EXPECT_FALSE(S2.isEmpty());
+
+  EXPECT_EQ(nullptr, S.lookup(3));
+  EXPECT_EQ(nullptr, S2.lookup(9));
+
+  EXPECT_EQ(10, *S2.lookup(3));
+  EXPECT_EQ(11, *S2.lookup(4));
+  EXPECT_EQ(12, *S2.lookup(5));
+
+  IntMap S3 = f.add(S2, 4, 13);
+  EXPECT_EQ(13, *S3.lookup(4));
+  EXPECT_EQ(11, *S2.lookup(4));
+  EXPECT_TRUE(f.add(S2, 4, 11) == S2);
+}
+
+TEST(ImmutableHashMapTest, ManyElemIntMapTest) {
+  IntMap::Factory f;
+  IntMap S = f.getEmptyMap();
+  for (int I = 0; I < 1000; ++I)
+    S = f.add(S, I, -I);
+
+  for (int I = 0; I < 1000; ++I) {
+    ASSERT_TRUE(S.contains(I));
+    EXPECT_EQ(-I, *S.lookup(I));
+  }
+  EXPECT_FALSE(S.contains(1000));
+
+  for (int I = 0; I < 1000; I += 2)
+    S = f.remove(S, I);
+  for (int I = 0; I < 1000; ++I)
+    EXPECT_EQ(I % 2 == 1, S.contains(I));
+}
+
+TEST(ImmutableHashMapTest, CanonicalTest) {
+  IntMap::Factory f;
+  IntMap Forward = f.getEmptyMap();
+  IntMap Backward = f.getEmptyMap();
+  for (int I = 0; I < 200; ++I) {
+    Forward = f.add(Forward, I, I * 3);
+    Backward = f.add(Backward, 199 - I, (199 - I) * 3);
+  }
+  EXPECT_TRUE(Forward == Backward);
+  EXPECT_EQ(Forward.getRoot(), Backward.getRoot());
+
+  IntMap Small = f.add(f.add(f.getEmptyMap(), 1, 3), 2, 6);
+  IntMap Shrunk = Forward;
+  for (int I = 0; I < 200; ++I)
+    if (I != 1 && I != 2)
+      Shrunk = f.remove(Shrunk, I);
+  EXPECT_TRUE(Small == Shrunk);
+  EXPECT_TRUE(f.remove(f.remove(Shrunk, 1), 2).isEmpty());
+  EXPECT_TRUE(f.remove(Small, 7) == Small);
+}
+
+TEST(ImmutableHashMapTest, IteratorTest) {
+  IntMap::Factory f;
+  IntMap S = f.getEmptyMap();
+  for (int I = 0; I < 300; ++I)
+    S = f.add(S, I, I + 1);
+
+  DenseMap<int, int> Seen;
+  for (IntMap::iterator I = S.begin(), E = S.end(); I != E; ++I) {
+    EXPECT_EQ(I->first + 1, I->second);
+    EXPECT_EQ(I.getKey() + 1, I.getData());
+    ++Seen[I.getKey()];
+  }
+  EXPECT_EQ(300u, Seen.size());
+  for (const auto &Entry : Seen)
+    EXPECT_EQ(1, Entry.second);
+}
+
+} // end anonymous namespace
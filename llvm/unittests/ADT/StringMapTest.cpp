@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/DataTypes.h"
 #include "gtest/gtest.h"
@@ -516,4 +517,45 @@ TEST(StringMapCustomTest, StringMapEntrySize) {
   EXPECT_EQ(LargeValue, Key.size());
 }
 
+
+TEST(StringMapCustomTest, PrecomputedHash) {
+  StringMap<int> Map;
+  uint32_t Hash = StringMap<int>::hash("key");
+  EXPECT_TRUE(Map.try_emplace_with_hash("key", Hash, 1).second);
+  EXPECT_FALSE(Map.try_emplace_with_hash("key", Hash, 2).second);
+  EXPECT_EQ(1, Map.find("key", Hash)->second);
+  EXPECT_EQ(1, Map.lookup("key"));
+  EXPECT_EQ(1u, Map.count("key", Hash));
+  EXPECT_EQ(0u, Map.count("other", StringMap<int>::hash("other")));
+
+  const StringMap<int> &ConstMap = Map;
+  EXPECT_EQ(1, ConstMap.find("key", Hash)->second);
+}
+
+TEST(StringMapCustomTest, BatchFind) {
+  StringMap<unsigned> Map;
+  SmallVector<std::string, 0> Names;
+  for (unsigned I = 0; I < 100; ++I) {
+    Names.push_back("name" + std::to_string(I));
+    if (I % 3 != 0)
+      Map[Names.back()] = I;
+  }
+  SmallVector<StringRef, 0> Keys(Names.begin(), Names.end());
+  SmallVector<StringMap<unsigned>::iterator, 0> Results(Keys.size());
+  EXPECT_EQ(Results.end(), Map.find_batch(Keys, Results.begin()));
+  for (unsigned I = 0; I < 100; ++I) {
+    if (I % 3 == 0) {
+      EXPECT_TRUE(Results[I] == Map.end());
+    } else {
+      ASSERT_TRUE(Results[I] != Map.end());
+      EXPECT_EQ(I, Results[I]->second);
+    }
+  }
+
+  StringMap<unsigned> Empty;
+  Empty.find_batch(Keys, Results.begin());
+  for (auto &R : Results)
+    EXPECT_TRUE(R == Empty.end());
+}
+
 } // end anonymous namespace
@@ -0,0 +1,120 @@
+//===- InlineCostTest.cpp - Inline cost analysis unit tests ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/InlineCost.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class InlineCostTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  std::unique_ptr<TargetTransformInfo> TTI;
+  DenseMap<Function *, std::unique_ptr<AssumptionCache>> ACs;
+  std::function<AssumptionCache &(Function &)> GetAssumptionCache =
+      [this](Function &F) -> AssumptionCache & {
+    auto &AC = ACs[&F];
+    if (!AC)
+      AC.reset(new AssumptionCache(F));
+    return *AC;
+  };
+  SmallVector<CallBase *, 4> Calls;
+
+  void SetUp() override {
+    SMDiagnostic Err;
+    M = parseAssemblyString("declare void @ext()\n"
+                            "define i32 @callee(i32 %x) {\n"
+                            "entry:\n"
+                            "  %c = icmp eq i32 %x, 0\n"
+                            "  br i1 %c, label %small, label %big\n"
+                            "small:\n"
+                            "  call void @ext()\n"
+                            "  ret i32 0\n"
+                            "big:\n"
+                            "  %a = mul i32 %x, %x\n"
+                            "  %b = mul i32 %a, %x\n"
+                            "  %d = mul i32 %b, %x\n"
+                            "  ret i32 %d\n"
+                            "}\n"
+                            "define i32 @caller(i32 %y) {\n"
+                            "  %r0 = call i32 @callee(i32 0)\n"
+                            "  %r1 = call i32 @callee(i32 0)\n"
+                            "  %r2 = call i32 @callee(i32 %y)\n"
+                            "  %s0 = add i32 %r0, %r1\n"
+                            "  %s1 = add i32 %s0, %r2\n"
+                            "  ret i32 %s1\n"
+                            "}\n",
+                            Err, Context);
+    if (!M)
+      Err.print("InlineCostTest", errs());
+    ASSERT_TRUE(M);
+    TTI.reset(new TargetTransformInfo(M->getDataLayout()));
+    for (Instruction &I : M->getFunction("caller")->getEntryBlock())
+      if (auto *Call = dyn_cast<CallBase>(&I))
+        Calls.push_back(Call);
+    ASSERT_EQ(3u, Calls.size());
+  }
+
+  int getCost(CallBase *Call, InlineCostCache *Cache = nullptr) {
+    InlineCost IC = getInlineCost(*Call, getInlineParams(), *TTI,
+                                  GetAssumptionCache, None, nullptr, nullptr,
+                                  Cache);
+    EXPECT_TRUE(IC.isVariable());
+    return IC.isVariable() ? IC.getCost() : 0;
+  }
+
+  /// Remove the call to @ext, which only the call sites passing 0 pay for.
+  void removeExtCall() {
+    for (Instruction &I : instructions(*M->getFunction("callee")))
+      if (auto *Call = dyn_cast<CallInst>(&I)) {
+        Call->eraseFromParent();
+        return;
+      }
+  }
+};
+
+TEST_F(InlineCostTest, CachedCostsMatchFreshAnalysis) {
+  int Zero = getCost(Calls[0]);
+  int Unknown = getCost(Calls[2]);
+  EXPECT_NE(Zero, Unknown);
+
+  InlineCostCache Cache;
+  EXPECT_EQ(Zero, getCost(Calls[0], &Cache));
+  EXPECT_EQ(Zero, getCost(Calls[1], &Cache));
+  EXPECT_EQ(Unknown, getCost(Calls[2], &Cache));
+  EXPECT_EQ(Zero, getCost(Calls[1], &Cache));
+}
+
+TEST_F(InlineCostTest, EquivalentCallSitesShareAnalysis) {
+  InlineCostCache Cache;
+  int Zero = getCost(Calls[0], &Cache);
+
+  // The cache doesn't notice that the callee changed, which shows that the
+  // second call site with the same constant argument reuses the analysis of
+  // the first one.
+  removeExtCall();
+  int Fresh = getCost(Calls[1]);
+  EXPECT_LT(Fresh, Zero);
+  EXPECT_EQ(Zero, getCost(Calls[1], &Cache));
+
+  Cache.invalidate(M->getFunction("callee"));
+  EXPECT_EQ(Fresh, getCost(Calls[1], &Cache));
+}
+
+} // end anonymous namespace
@@ -210,5 +210,33 @@ TEST_F(ProfileSummaryInfoTest, SampleProf) {
   EXPECT_TRUE(PSI.isHotCallSite(CS2, &BFI));
 }
 
+TEST_F(ProfileSummaryInfoTest, ColdPercentileCutoff) {
+  auto M = makeLLVMModule("SampleProfile");
+  Function *F = M->getFunction("f");
+  ProfileSummaryInfo PSI = buildPSI(M.get());
+
+  // The thresholds come from the minimum counts of the detailed summary.
+  EXPECT_TRUE(PSI.isColdCountNthPercentile(999999, 5));
+  EXPECT_FALSE(PSI.isColdCountNthPercentile(999999, 100));
+  EXPECT_TRUE(PSI.isColdCountNthPercentile(999000, 100));
+  EXPECT_FALSE(PSI.isColdCountNthPercentile(999000, 400));
+  EXPECT_TRUE(PSI.isColdCountNthPercentile(10000, 1000));
+
+  BasicBlock &BB0 = F->getEntryBlock();
+  BasicBlock *BB1 = BB0.getTerminator()->getSuccessor(0);
+  BasicBlock *BB2 = BB0.getTerminator()->getSuccessor(1);
+
+  BlockFrequencyInfo BFI = buildBFI(*F);
+  EXPECT_FALSE(PSI.isColdBlock(BB2, &BFI));
+  EXPECT_TRUE(PSI.isColdBlockNthPercentile(999000, BB2, &BFI));
+  EXPECT_FALSE(PSI.isColdBlockNthPercentile(999000, BB1, &BFI));
+  EXPECT_FALSE(PSI.isColdBlockNthPercentile(999000, &BB0, &BFI));
+
+  // Without a profile nothing is cold.
+  auto NoProfM = makeLLVMModule(/*ProfKind=*/nullptr);
+  ProfileSummaryInfo NoProfPSI = buildPSI(NoProfM.get());
+  EXPECT_FALSE(NoProfPSI.isColdCountNthPercentile(999000, 0));
+}
+
 } // end anonymous namespace
 } // end namespace llvm
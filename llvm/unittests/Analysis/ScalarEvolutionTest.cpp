@@ -22,6 +22,7 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
@@ -1745,4 +1746,81 @@ TEST_F(ScalarEvolutionsTest, SCEVComputeConstantDifference) {
   });
 }
 
+TEST_F(ScalarEvolutionsTest, SCEVExprBudget) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define i32 @foo(i32 %a, i32 %b, i32 %c, i32 %d) { "
+      "entry: "
+      "  %x1 = mul i32 %a, %b "
+      "  %x2 = add i32 %x1, %c "
+      "  %x3 = mul i32 %x2, %d "
+      "  %x4 = add i32 %x3, %a "
+      "  ret i32 %x4 "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  auto *MaxExprs = static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["scalar-evolution-max-exprs"]);
+  ASSERT_TRUE(MaxExprs);
+
+  runWithSE(*M, "foo", [](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    EXPECT_TRUE(isa<SCEVAddExpr>(SE.getSCEV(getInstructionByName(F, "x4"))));
+  });
+
+  // %a, %b and %x1 use up the budget, so %x4 is left opaque.
+  MaxExprs->setValue(3);
+  runWithSE(*M, "foo", [](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    EXPECT_TRUE(isa<SCEVMulExpr>(SE.getSCEV(getInstructionByName(F, "x1"))));
+    EXPECT_TRUE(isa<SCEVUnknown>(SE.getSCEV(getInstructionByName(F, "x4"))));
+  });
+  MaxExprs->setValue(0);
+}
+
+TEST_F(ScalarEvolutionsTest, SCEVMemoizedKnownPredicates) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define void @foo(i32 %n) { "
+      "entry: "
+      "  %guard = icmp sgt i32 %n, 0 "
+      "  br i1 %guard, label %loop, label %exit "
+      "loop: "
+      "  %iv = phi i32 [ %iv.next, %loop ], [ 0, %entry ] "
+      "  %iv.next = add nsw i32 %iv, 1 "
+      "  %cmp = icmp slt i32 %iv.next, %n "
+      "  br i1 %cmp, label %loop, label %exit "
+      "exit: "
+      "  ret void "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  auto *Memoize = static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["scalar-evolution-memoize-predicates"]);
+  ASSERT_TRUE(Memoize);
+  Memoize->setValue(true);
+
+  runWithSE(*M, "foo", [](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    const SCEV *N = SE.getSCEV(&*F.arg_begin());
+    const SCEV *IV = SE.getSCEV(getInstructionByName(F, "iv"));
+    const SCEV *Zero = SE.getZero(N->getType());
+    // Ask twice, so that the second answer comes from the cache.
+    for (int I = 0; I != 2; ++I) {
+      EXPECT_TRUE(SE.isKnownPredicate(ICmpInst::ICMP_SGE, IV, Zero));
+      EXPECT_FALSE(SE.isKnownPredicate(ICmpInst::ICMP_SLT, IV, Zero));
+      EXPECT_FALSE(SE.isKnownPredicate(ICmpInst::ICMP_SGT, IV, N));
+    }
+    SE.forgetLoop(LI.getLoopFor(getInstructionByName(F, "iv")->getParent()));
+    EXPECT_TRUE(SE.isKnownPredicate(ICmpInst::ICMP_SGE, IV, Zero));
+    EXPECT_FALSE(SE.isKnownPredicate(ICmpInst::ICMP_SLT, IV, Zero));
+  });
+  Memoize->setValue(false);
+}
+
 }  // end namespace llvm
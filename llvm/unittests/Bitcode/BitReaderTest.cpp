@@ -11,13 +11,21 @@
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/DebugInfo.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_mmap_ostream.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -190,4 +198,307 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+// Parse the bitcode in \p Mem and print the module.
+static std::string parseAndPrint(SmallString<1024> &Mem) {
+  LLVMContext Context;
+  Expected<std::unique_ptr<Module>> ModuleOrErr =
+      parseBitcodeFile(MemoryBufferRef(Mem.str(), "test"), Context);
+  if (!ModuleOrErr)
+    report_fatal_error("Could not parse bitcode module");
+  EXPECT_FALSE(verifyModule(**ModuleOrErr, &dbgs()));
+  std::string S;
+  raw_string_ostream OS(S);
+  (*ModuleOrErr)->print(OS, nullptr);
+  return OS.str();
+}
+
+// Tests that decoding function bodies in parallel produces the same module as
+// the serial reader, across several batches of functions that have nested
+// constant, symbol table and metadata blocks and reference each other's
+// blocks.
+TEST(BitReaderTest, ParallelFunctionDecoding) {
+  std::string Assembly = "define i8* @first() {\n"
+                         "  ret i8* blockaddress(@last, %bb)\n"
+                         "}\n";
+  std::string Metadata;
+  for (int I = 0; I < 600; ++I) {
+    std::string N = std::to_string(I);
+    std::string SP = "!" + std::to_string(10 + 2 * I);
+    std::string Loc = "!" + std::to_string(11 + 2 * I);
+    Assembly += "define i32 @f" + N + "(i32 %a, i1 %c) !dbg " + SP + " {\n" +
+                "entry:\n" +
+                "  %x = add i32 %a, " + N + ", !dbg " + Loc + "\n" +
+                "  br i1 %c, label %then, label %done\n" +
+                "then:\n" +
+                "  %y = mul i32 %x, 7, !annotation !4\n" +
+                "  br label %done\n" +
+                "done:\n" +
+                "  %r = phi i32 [ %x, %entry ], [ %y, %then ]\n" +
+                "  ret i32 %r\n" +
+                "}\n";
+    Metadata += SP + " = distinct !DISubprogram(name: \"f" + N +
+                "\", scope: !1, file: !1, type: !2, unit: !0, " +
+                "spFlags: DISPFlagDefinition)\n" + Loc +
+                " = !DILocation(line: " + N + ", scope: " + SP + ")\n";
+  }
+  Assembly += "define void @last() {\n"
+              "  unreachable\n"
+              "bb:\n"
+              "  unreachable\n"
+              "}\n"
+              "!llvm.dbg.cu = !{!0}\n"
+              "!llvm.module.flags = !{!3}\n"
+              "!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, "
+              "emissionKind: FullDebug)\n"
+              "!1 = !DIFile(filename: \"t.c\", directory: \"/\")\n"
+              "!2 = !DISubroutineType(types: !{})\n"
+              "!3 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+              "!4 = !{!\"note\"}\n" +
+              Metadata;
+
+  SmallString<1024> Mem;
+  {
+    LLVMContext Context;
+    writeModuleToBuffer(parseAssembly(Context, Assembly.c_str()), Mem);
+  }
+
+  auto &Opt = *static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["bitcode-parallel-function-decoding"]);
+  std::string Serial = parseAndPrint(Mem);
+  Opt = true;
+  std::string Parallel = parseAndPrint(Mem);
+  Opt = false;
+  EXPECT_EQ(Serial, Parallel);
+}
+
+static const char DebugInfoAssembly[] =
+    "define void @live(i32 %x, i1 %c) !dbg !5 {\n"
+    "entry:\n"
+    "  call void @llvm.dbg.value(metadata i32 %x, metadata !9, "
+    "metadata !DIExpression()), !dbg !10\n"
+    "  %y = add i32 %x, 1, !annotation !14\n"
+    "  br label %loop\n"
+    "loop:\n"
+    "  br i1 %c, label %loop, label %exit, !llvm.loop !15\n"
+    "exit:\n"
+    "  ret void, !dbg !10\n"
+    "}\n"
+    "define void @dead() !dbg !11 {\n"
+    "  ret void, !dbg !13\n"
+    "}\n"
+    "declare void @llvm.dbg.value(metadata, metadata, metadata)\n"
+    "!llvm.dbg.cu = !{!0}\n"
+    "!llvm.module.flags = !{!2}\n"
+    "!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, "
+    "emissionKind: FullDebug)\n"
+    "!1 = !DIFile(filename: \"cu.c\", directory: \"/\")\n"
+    "!2 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+    "!3 = !DIFile(filename: \"live.c\", directory: \"/\")\n"
+    "!4 = !DISubroutineType(types: !{})\n"
+    "!5 = distinct !DISubprogram(name: \"live\", scope: !3, file: !3, "
+    "type: !4, unit: !0, spFlags: DISPFlagDefinition)\n"
+    "!6 = !DIFile(filename: \"var.c\", directory: \"/\")\n"
+    "!7 = !DIBasicType(name: \"int\", size: 32, encoding: DW_ATE_signed)\n"
+    "!9 = !DILocalVariable(name: \"x\", arg: 1, scope: !5, file: !6, "
+    "type: !7)\n"
+    "!10 = !DILocation(line: 1, scope: !5)\n"
+    "!11 = distinct !DISubprogram(name: \"dead\", scope: !12, file: !12, "
+    "type: !4, unit: !0, spFlags: DISPFlagDefinition)\n"
+    "!12 = !DIFile(filename: \"dead.c\", directory: \"/\")\n"
+    "!13 = !DILocation(line: 2, scope: !11)\n"
+    "!14 = !{!\"note\"}\n"
+    "!15 = distinct !{!15, !16}\n"
+    "!16 = !{!\"llvm.loop.unroll.disable\"}\n";
+
+// Write DebugInfoAssembly with a metadata index, which is only written for
+// larger modules by default.
+static void writeDebugInfoModule(SmallVectorImpl<char> &Mem) {
+  auto &Threshold = *static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["bitcode-mdindex-threshold"]);
+  unsigned OldThreshold = Threshold;
+  Threshold = 0;
+  LLVMContext Context;
+  writeModuleToBuffer(parseAssembly(Context, DebugInfoAssembly), Mem);
+  Threshold = OldThreshold;
+}
+
+static bool hasFile(LLVMContext &Context, StringRef Filename) {
+  return DIFile::getIfExists(Context, Filename, "/");
+}
+
+// Tests that writing to a mapped file, with function blocks flushed to the
+// file as soon as they are complete, produces the same bitcode as writing to
+// a buffer.
+TEST(BitReaderTest, WriteToMappedFile) {
+  auto &MDThreshold = *static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["bitcode-mdindex-threshold"]);
+  auto &FlushThreshold = *static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["bitcode-flush-threshold"]);
+  unsigned OldMDThreshold = MDThreshold;
+  unsigned OldFlushThreshold = FlushThreshold;
+  MDThreshold = 0;
+  FlushThreshold = 0;
+
+  LLVMContext Context;
+  std::unique_ptr<Module> M = parseAssembly(Context, DebugInfoAssembly);
+  SmallString<1024> Mem;
+  raw_svector_ostream MemOS(Mem);
+  WriteBitcodeToFile(*M, MemOS);
+
+  SmallString<128> Dir, Path;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("bitcode", Dir));
+  sys::path::append(Path, Dir, "file.bc");
+  Expected<std::unique_ptr<raw_mmap_ostream>> OSOrErr =
+      raw_mmap_ostream::create(Path);
+  ASSERT_TRUE(bool(OSOrErr));
+  WriteBitcodeToFile(*M, **OSOrErr);
+  ASSERT_FALSE(bool((*OSOrErr)->commit()));
+
+  MDThreshold = OldMDThreshold;
+  FlushThreshold = OldFlushThreshold;
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(BufOrErr));
+  EXPECT_EQ(Mem.str(), (*BufOrErr)->getBuffer());
+  sys::fs::remove(Path);
+  sys::fs::remove(Dir);
+}
+
+// Tests that lazily loaded metadata is only loaded for the functions that are
+// materialized.
+TEST(BitReaderTest, LazyMetadataForDeadFunction) {
+  SmallString<1024> Mem;
+  writeDebugInfoModule(Mem);
+
+  LLVMContext Context;
+  Expected<std::unique_ptr<Module>> ModuleOrErr = getLazyBitcodeModule(
+      MemoryBufferRef(Mem.str(), "test"), Context,
+      /*ShouldLazyLoadMetadata=*/true);
+  ASSERT_TRUE(!!ModuleOrErr);
+  Module &M = **ModuleOrErr;
+  M.getFunction("dead")->deleteBody();
+  ASSERT_FALSE(M.materializeAll());
+  EXPECT_FALSE(verifyModule(M, &dbgs()));
+
+  EXPECT_TRUE(hasFile(Context, "cu.c"));
+  EXPECT_TRUE(hasFile(Context, "live.c"));
+  EXPECT_TRUE(hasFile(Context, "var.c"));
+  EXPECT_FALSE(hasFile(Context, "dead.c"));
+  EXPECT_TRUE(M.getFunction("live")->getSubprogram());
+}
+
+// Tests that debug info stripped before metadata is materialized is never
+// loaded.
+TEST(BitReaderTest, LazyMetadataStripDebugInfo) {
+  SmallString<1024> Mem;
+  writeDebugInfoModule(Mem);
+
+  std::string Stripped;
+  {
+    LLVMContext Context;
+    Expected<std::unique_ptr<Module>> ModuleOrErr =
+        parseBitcodeFile(MemoryBufferRef(Mem.str(), "test"), Context);
+    ASSERT_TRUE(!!ModuleOrErr);
+    StripDebugInfo(**ModuleOrErr);
+    raw_string_ostream OS(Stripped);
+    (*ModuleOrErr)->print(OS, nullptr);
+  }
+
+  LLVMContext Context;
+  Expected<std::unique_ptr<Module>> ModuleOrErr = getLazyBitcodeModule(
+      MemoryBufferRef(Mem.str(), "test"), Context,
+      /*ShouldLazyLoadMetadata=*/true);
+  ASSERT_TRUE(!!ModuleOrErr);
+  Module &M = **ModuleOrErr;
+  StripDebugInfo(M);
+  ASSERT_FALSE(M.materializeAll());
+  EXPECT_FALSE(verifyModule(M, &dbgs()));
+
+  EXPECT_FALSE(M.getNamedMetadata("llvm.dbg.cu"));
+  EXPECT_FALSE(hasFile(Context, "cu.c"));
+  EXPECT_FALSE(hasFile(Context, "live.c"));
+  EXPECT_FALSE(hasFile(Context, "var.c"));
+  EXPECT_FALSE(hasFile(Context, "dead.c"));
+
+  std::string Actual;
+  raw_string_ostream OS(Actual);
+  M.print(OS, nullptr);
+  EXPECT_EQ(Stripped, OS.str());
+}
+
+static const char CombinedIndexAssembly[] =
+    "^0 = module: (path: \"a.o\", hash: (0, 0, 0, 0, 0))\n"
+    "^1 = module: (path: \"b.o\", hash: (0, 0, 0, 0, 0))\n"
+    "^2 = gv: (guid: 1, summaries: (function: (module: ^0, flags: (linkage: "
+    "external, notEligibleToImport: 0, live: 0, dsoLocal: 0), insts: 10)))\n"
+    "^3 = gv: (guid: 2, summaries: (function: (module: ^1, flags: (linkage: "
+    "external, notEligibleToImport: 0, live: 0, dsoLocal: 0), insts: 5, "
+    "calls: ((callee: ^2)))))\n"
+    "^4 = gv: (guid: 3, summaries: (alias: (module: ^0, flags: (linkage: "
+    "external, notEligibleToImport: 0, live: 0, dsoLocal: 0), aliasee: ^2)))\n"
+    "^5 = gv: (guid: 4, summaries: (variable: (module: ^1, flags: (linkage: "
+    "external, notEligibleToImport: 0, live: 0, dsoLocal: 0), varFlags: "
+    "(readonly: 0, writeonly: 0))))\n"
+    "^6 = gv: (guid: 5, summaries: (function: (module: ^0, flags: (linkage: "
+    "internal, notEligibleToImport: 0, live: 0, dsoLocal: 1), insts: 1)), "
+    "(function: (module: ^1, flags: (linkage: internal, "
+    "notEligibleToImport: 0, live: 0, dsoLocal: 1), insts: 2)))\n";
+
+static void writeCombinedIndex(SmallVectorImpl<char> &Mem) {
+  SMDiagnostic Err;
+  std::unique_ptr<ModuleSummaryIndex> Index = parseSummaryIndexAssembly(
+      MemoryBufferRef(CombinedIndexAssembly, "index"), Err);
+  ASSERT_TRUE(Index) << Err.getMessage().str();
+  raw_svector_ostream OS(Mem);
+  WriteIndexToFile(*Index, OS);
+}
+
+static size_t getNumSummaries(const ModuleSummaryIndex &Index,
+                              GlobalValue::GUID GUID) {
+  ValueInfo VI = Index.getValueInfo(GUID);
+  return VI ? VI.getSummaryList().size() : 0;
+}
+
+// Tests that only the requested summaries, and the aliasees of requested
+// aliases, are read from a combined index.
+TEST(BitReaderTest, ReadSummariesForGUIDs) {
+  SmallString<1024> Mem;
+  writeCombinedIndex(Mem);
+  MemoryBufferRef Buffer(Mem.str(), "test");
+
+  Expected<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+      getModuleSummaryIndex(Buffer, {2, 3});
+  ASSERT_TRUE(!!IndexOrErr) << toString(IndexOrErr.takeError());
+  ModuleSummaryIndex &Index = **IndexOrErr;
+  EXPECT_EQ(1u, getNumSummaries(Index, 1));
+  EXPECT_EQ(1u, getNumSummaries(Index, 2));
+  EXPECT_EQ(1u, getNumSummaries(Index, 3));
+  EXPECT_EQ(0u, getNumSummaries(Index, 4));
+  EXPECT_EQ(0u, getNumSummaries(Index, 5));
+
+  auto *FS = cast<FunctionSummary>(
+      Index.getValueInfo(2).getSummaryList()[0].get());
+  EXPECT_EQ(5u, FS->instCount());
+  ASSERT_EQ(1u, FS->calls().size());
+  EXPECT_EQ(1u, FS->calls()[0].first.getGUID());
+  auto *AS =
+      cast<AliasSummary>(Index.getValueInfo(3).getSummaryList()[0].get());
+  EXPECT_EQ(1u, AS->getAliaseeGUID());
+  EXPECT_EQ(10u, cast<FunctionSummary>(&AS->getAliasee())->instCount());
+
+  // Both copies of a local are read.
+  IndexOrErr = getModuleSummaryIndex(Buffer, {5});
+  ASSERT_TRUE(!!IndexOrErr) << toString(IndexOrErr.takeError());
+  EXPECT_EQ(2u, getNumSummaries(**IndexOrErr, 5));
+  EXPECT_EQ(0u, getNumSummaries(**IndexOrErr, 1));
+
+  // Reading the whole index is unaffected by the GUID table.
+  IndexOrErr = getModuleSummaryIndex(Buffer);
+  ASSERT_TRUE(!!IndexOrErr) << toString(IndexOrErr.takeError());
+  for (GlobalValue::GUID GUID : {1, 2, 3, 4})
+    EXPECT_EQ(1u, getNumSummaries(**IndexOrErr, GUID));
+  EXPECT_EQ(2u, getNumSummaries(**IndexOrErr, 5));
+}
+
 } // end namespace
@@ -9,6 +9,10 @@
 #include "llvm/Bitstream/BitstreamWriter.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_mmap_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -55,4 +59,67 @@ TEST(BitstreamWriterTest, emitBlob4ByteAligned) {
   EXPECT_EQ(StringRef("str0"), Buffer);
 }
 
+TEST(BitstreamWriterTest, emitBlobInPlace) {
+  SmallString<64> Buffer;
+  BitstreamWriter W(Buffer);
+  W.emitBlob(3, [](char *Buf) { memcpy(Buf, "str", 3); },
+             /* ShouldEmitSize */ false);
+  EXPECT_EQ(StringRef("str\0", 4), Buffer);
+}
+
+// Write a stream that is flushed to a file between blocks, with placeholders
+// that are backpatched after they have been flushed, and check that the file
+// matches the stream written in memory.
+TEST(BitstreamWriterTest, flushToFile) {
+  auto WriteStream = [](BitstreamWriter &W) {
+    W.Emit(0xBC, 8);
+    // An unaligned placeholder, which is flushed before it is patched.
+    W.Emit(0x5, 3);
+    uint64_t PlaceholderBit = W.GetCurrentBitNo();
+    W.Emit(0, 32);
+    W.Emit(0, 29);
+    for (unsigned I = 0; I != 4; ++I) {
+      W.EnterSubblock(8, 3);
+      for (unsigned J = 0; J != 10 * I; ++J)
+        W.EmitVBR(J * 1000, 6);
+      W.ExitBlock();
+      W.FlushToFile();
+    }
+    W.BackpatchWord(PlaceholderBit, 0xDEADBEEF);
+  };
+
+  SmallString<64> InMemory;
+  {
+    BitstreamWriter W(InMemory);
+    WriteStream(W);
+  }
+
+  SmallString<128> Dir, Path;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("bitstream", Dir));
+  sys::path::append(Path, Dir, "file.out");
+  {
+    Expected<std::unique_ptr<raw_mmap_ostream>> OSOrErr =
+        raw_mmap_ostream::create(Path);
+    ASSERT_TRUE(bool(OSOrErr));
+    raw_mmap_ostream &OS = **OSOrErr;
+    // The stream need not start at the beginning of the file.
+    OS << "head";
+    SmallString<64> Buffer;
+    {
+      BitstreamWriter W(Buffer, &OS, /* FlushThreshold */ 4);
+      WriteStream(W);
+    }
+    EXPECT_LT(Buffer.size(), InMemory.size());
+    OS << Buffer;
+    ASSERT_FALSE(bool(OS.commit()));
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(BufOrErr));
+  EXPECT_EQ(("head" + InMemory).str(), (*BufOrErr)->getBuffer());
+  sys::fs::remove(Path);
+  sys::fs::remove(Dir);
+}
+
 } // end namespace
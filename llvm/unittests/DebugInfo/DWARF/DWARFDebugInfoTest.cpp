@@ -29,6 +29,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 #include <string>
@@ -1400,6 +1401,60 @@ TEST(DWARFDebugInfo, TestEmptyChildren) {
   EXPECT_EQ(CUDie.begin(), CUDie.end());
 }
 
+TEST(DWARFDebugInfo, TestConcurrentDIEExtraction) {
+  const char *yamldata = "debug_abbrev:\n"
+                         "  - Code:            0x00000001\n"
+                         "    Tag:             DW_TAG_compile_unit\n"
+                         "    Children:        DW_CHILDREN_yes\n"
+                         "    Attributes:\n"
+                         "  - Code:            0x00000002\n"
+                         "    Tag:             DW_TAG_subprogram\n"
+                         "    Children:        DW_CHILDREN_no\n"
+                         "    Attributes:\n"
+                         "debug_info:\n"
+                         "  - Length:\n"
+                         "      TotalLength:          0\n"
+                         "    Version:         4\n"
+                         "    AbbrOffset:      0\n"
+                         "    AddrSize:        8\n"
+                         "    Entries:\n"
+                         "      - AbbrCode:        0x00000001\n"
+                         "        Values:\n"
+                         "      - AbbrCode:        0x00000002\n"
+                         "        Values:\n"
+                         "      - AbbrCode:        0x00000002\n"
+                         "        Values:\n"
+                         "      - AbbrCode:        0x00000002\n"
+                         "        Values:\n"
+                         "      - AbbrCode:        0x00000000\n"
+                         "        Values:\n";
+
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(StringRef(yamldata), true);
+  ASSERT_TRUE((bool)ErrOrSections);
+  std::unique_ptr<DWARFContext> DwarfContext =
+      DWARFContext::create(*ErrOrSections, 8);
+  DWARFUnit *U = DwarfContext->getUnitAtIndex(0);
+  ASSERT_TRUE(U);
+
+  // Users racing to extract the DIEs of the same unit all see the complete
+  // DIE array, which is only extracted once.
+  ThreadPool Pool(4);
+  std::vector<unsigned> NumDIEs(8);
+  std::vector<const DWARFDebugInfoEntry *> UnitDIEs(8);
+  for (unsigned I = 0; I != NumDIEs.size(); ++I)
+    Pool.async([&, I]() {
+      UnitDIEs[I] =
+          U->getUnitDIE(/*ExtractUnitDIEOnly=*/false).getDebugInfoEntry();
+      NumDIEs[I] = U->getNumDIEs();
+    });
+  Pool.wait();
+
+  for (unsigned I = 0; I != NumDIEs.size(); ++I) {
+    EXPECT_EQ(5u, NumDIEs[I]);
+    EXPECT_EQ(U->getUnitDIE().getDebugInfoEntry(), UnitDIEs[I]);
+  }
+}
+
 TEST(DWARFDebugInfo, TestAttributeIterators) {
   Triple Triple = getNormalizedDefaultTargetTriple();
   if (!isConfigurationSupported(Triple))
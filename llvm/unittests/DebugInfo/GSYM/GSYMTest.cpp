@@ -8,11 +8,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/DebugInfo/GSYM/FileEntry.h"
+#include "llvm/DebugInfo/GSYM/FileWriter.h"
 #include "llvm/DebugInfo/GSYM/FunctionInfo.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include "llvm/DebugInfo/GSYM/Header.h"
 #include "llvm/DebugInfo/GSYM/InlineInfo.h"
 #include "llvm/DebugInfo/GSYM/Range.h"
 #include "llvm/DebugInfo/GSYM/StringTable.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Testing/Support/Error.h"
 
 #include "gtest/gtest.h"
@@ -379,3 +386,310 @@ TEST(GSYMTest, TestStringTable) {
   // Test pointing to past end gets empty string.
   EXPECT_EQ(StrTab.getString(13), "");
 }
+
+static void TestHeaderEncodeDecode(const Header &H,
+                                   support::endianness ByteOrder) {
+  const bool IsLittleEndian = ByteOrder == llvm::support::little;
+  SmallString<512> Str;
+  raw_svector_ostream OutStrm(Str);
+  FileWriter FW(OutStrm, ByteOrder);
+  llvm::Error Err = H.encode(FW);
+  ASSERT_FALSE(Err);
+  std::string Bytes(OutStrm.str());
+  EXPECT_EQ(Bytes.size(), sizeof(Header));
+  DataExtractor Data(Bytes, IsLittleEndian, 8);
+  llvm::Expected<Header> Decoded = Header::decode(Data);
+  ASSERT_THAT_EXPECTED(Decoded, Succeeded());
+  EXPECT_EQ(H, *Decoded);
+}
+
+static Header getValidHeader() {
+  Header H;
+  memset(&H, 0, sizeof(H));
+  H.Magic = GSYM_MAGIC;
+  H.Version = GSYM_VERSION;
+  H.AddrOffSize = 4;
+  H.UUIDSize = 16;
+  H.BaseAddress = 0x1000;
+  H.NumAddresses = 1;
+  H.StrtabOffset = 0x2000;
+  H.StrtabSize = 0x1000;
+  for (size_t I = 0; I < GSYM_MAX_UUID_SIZE; ++I) {
+    if (I < H.UUIDSize)
+      H.UUID[I] = static_cast<uint8_t>(I);
+    else
+      H.UUID[I] = 0;
+  }
+  return H;
+}
+
+TEST(GSYMTest, TestHeader) {
+  Header H = getValidHeader();
+  EXPECT_THAT_ERROR(H.checkForError(), Succeeded());
+  TestHeaderEncodeDecode(H, llvm::support::little);
+  TestHeaderEncodeDecode(H, llvm::support::big);
+
+  // Make sure every kind of invalid header is caught.
+  H.Magic = 12;
+  EXPECT_THAT_ERROR(H.checkForError(), Failed());
+  H = getValidHeader();
+  H.Version = GSYM_VERSION + 1;
+  EXPECT_THAT_ERROR(H.checkForError(), Failed());
+  H = getValidHeader();
+  H.AddrOffSize = 3;
+  EXPECT_THAT_ERROR(H.checkForError(), Failed());
+  H = getValidHeader();
+  H.UUIDSize = GSYM_MAX_UUID_SIZE + 1;
+  EXPECT_THAT_ERROR(H.checkForError(), Failed());
+
+  // Decoding a header that is too short fails.
+  DataExtractor Data(StringRef("GSYM"), true, 8);
+  EXPECT_THAT_EXPECTED(Header::decode(Data), Failed());
+}
+
+static void TestFunctionInfoEncodeDecode(llvm::support::endianness ByteOrder,
+                                         const FunctionInfo &FI) {
+  SmallString<512> Str;
+  raw_svector_ostream OutStrm(Str);
+  FileWriter FW(OutStrm, ByteOrder);
+  llvm::Expected<uint64_t> ExpectedOffset = FI.encode(FW);
+  ASSERT_THAT_EXPECTED(ExpectedOffset, Succeeded());
+  EXPECT_EQ(*ExpectedOffset, 0u);
+  std::string Bytes(OutStrm.str());
+  DataExtractor Data(Bytes, ByteOrder == llvm::support::little, 8);
+  llvm::Expected<FunctionInfo> Decoded =
+      FunctionInfo::decode(Data, FI.Range.Start);
+  ASSERT_THAT_EXPECTED(Decoded, Succeeded());
+  EXPECT_EQ(FI, *Decoded);
+}
+
+TEST(GSYMTest, TestFunctionInfoEncodeDecode) {
+  const uint64_t FuncAddr = 0x1000;
+  const uint64_t FuncSize = 0x100;
+  FunctionInfo FI(FuncAddr, FuncSize, 1);
+  // Encode a function with only a name and a range.
+  TestFunctionInfoEncodeDecode(llvm::support::little, FI);
+  TestFunctionInfoEncodeDecode(llvm::support::big, FI);
+
+  // Add a line table whose line numbers go up and down.
+  FI.Lines.push_back(LineEntry(FuncAddr, 1, 10));
+  FI.Lines.push_back(LineEntry(FuncAddr + 0x10, 2, 5));
+  FI.Lines.push_back(LineEntry(FuncAddr + 0x20, 2, 30));
+  TestFunctionInfoEncodeDecode(llvm::support::little, FI);
+  TestFunctionInfoEncodeDecode(llvm::support::big, FI);
+
+  // Add inline information with nested children.
+  FI.Inline.Ranges.insert(FI.Range);
+  InlineInfo Inline1;
+  Inline1.Ranges.insert(AddressRange(FuncAddr + 0x10, FuncAddr + 0x30));
+  Inline1.Name = 2;
+  Inline1.CallFile = 1;
+  Inline1.CallLine = 11;
+  InlineInfo Inline1Sub1;
+  Inline1Sub1.Ranges.insert(AddressRange(FuncAddr + 0x20, FuncAddr + 0x28));
+  Inline1Sub1.Name = 3;
+  Inline1Sub1.CallFile = 2;
+  Inline1Sub1.CallLine = 22;
+  Inline1.Children.push_back(Inline1Sub1);
+  FI.Inline.Children.push_back(Inline1);
+  TestFunctionInfoEncodeDecode(llvm::support::little, FI);
+  TestFunctionInfoEncodeDecode(llvm::support::big, FI);
+}
+
+TEST(GSYMTest, TestFunctionInfoEncodeErrors) {
+  SmallString<512> Str;
+  raw_svector_ostream OutStrm(Str);
+  FileWriter FW(OutStrm, llvm::support::little);
+  // A function without a name is invalid.
+  FunctionInfo FI(0x1000, 0x100, 0);
+  EXPECT_THAT_EXPECTED(FI.encode(FW), Failed());
+  // Line table entries can't precede their function.
+  FI.Name = 1;
+  FI.Lines.push_back(LineEntry(0x100, 1, 10));
+  EXPECT_THAT_EXPECTED(FI.encode(FW), Failed());
+  // Inlined functions must be contained in their parent.
+  FI.Lines.clear();
+  FI.Inline.Ranges.insert(FI.Range);
+  InlineInfo Inline1;
+  Inline1.Ranges.insert(AddressRange(0x1080, 0x1200));
+  Inline1.Name = 2;
+  FI.Inline.Children.push_back(Inline1);
+  EXPECT_THAT_EXPECTED(FI.encode(FW), Failed());
+}
+
+static void TestGsymCreatorAndReader(llvm::support::endianness ByteOrder) {
+  // Create a GSYM file with three functions:
+  //
+  // Range              Name  Info
+  // ================== ===== ===========================================
+  // [0x1000-0x1100)    main  line table and inline info:
+  //   [0x1010-0x1030)  foo   called from main.cpp:12
+  //     [0x1020-0x1028) bar  called from foo.h:22
+  // [0x2000-0x2000)    sym   only a symbol without a size
+  // [0x3000-0x3010)    dup   from the symbol table and from debug info
+  GsymCreator GC;
+  const uint32_t MainName = GC.insertString("main");
+  const uint32_t FooName = GC.insertString("foo");
+  const uint32_t BarName = GC.insertString("bar");
+  const uint32_t MainFile = GC.insertFile("/tmp/main.cpp");
+  const uint32_t FooFile = GC.insertFile("/tmp/foo.h");
+  // Strings and files are uniqued.
+  EXPECT_EQ(MainName, GC.insertString("main"));
+  EXPECT_EQ(FooFile, GC.insertFile("/tmp/foo.h"));
+  EXPECT_NE(MainFile, FooFile);
+
+  FunctionInfo Main(0x1000, 0x100, MainName);
+  Main.Lines.push_back(LineEntry(0x1000, MainFile, 10));
+  Main.Lines.push_back(LineEntry(0x1010, FooFile, 20));
+  Main.Lines.push_back(LineEntry(0x1020, FooFile, 30));
+  Main.Lines.push_back(LineEntry(0x1030, MainFile, 13));
+  Main.Inline.Ranges.insert(Main.Range);
+  InlineInfo Foo;
+  Foo.Name = FooName;
+  Foo.CallFile = MainFile;
+  Foo.CallLine = 12;
+  Foo.Ranges.insert(AddressRange(0x1010, 0x1030));
+  InlineInfo Bar;
+  Bar.Name = BarName;
+  Bar.CallFile = FooFile;
+  Bar.CallLine = 22;
+  Bar.Ranges.insert(AddressRange(0x1020, 0x1028));
+  Foo.Children.push_back(Bar);
+  Main.Inline.Children.push_back(Foo);
+  GC.addFunctionInfo(std::move(Main));
+  GC.addFunctionInfo(FunctionInfo(0x2000, 0, GC.insertString("sym")));
+  // Add the last function twice, the version with a line table must win.
+  const uint32_t DupName = GC.insertString("dup");
+  GC.addFunctionInfo(FunctionInfo(0x3000, 0x10, DupName));
+  FunctionInfo Dup(0x3000, 0x10, DupName);
+  Dup.Lines.push_back(LineEntry(0x3000, MainFile, 40));
+  GC.addFunctionInfo(std::move(Dup));
+  const uint8_t UUID[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  GC.setUUID(UUID);
+
+  std::string Log;
+  raw_string_ostream LogStrm(Log);
+  // Encoding requires the creator to be finalized.
+  {
+    SmallString<512> Str;
+    raw_svector_ostream OutStrm(Str);
+    FileWriter FW(OutStrm, ByteOrder);
+    EXPECT_THAT_ERROR(GC.encode(FW), Failed());
+  }
+  ASSERT_THAT_ERROR(GC.finalize(LogStrm), Succeeded());
+  EXPECT_THAT_ERROR(GC.finalize(LogStrm), Failed());
+  EXPECT_EQ(GC.getNumFunctionInfos(), 3u);
+
+  SmallString<512> Str;
+  raw_svector_ostream OutStrm(Str);
+  {
+    FileWriter FW(OutStrm, ByteOrder);
+    ASSERT_THAT_ERROR(GC.encode(FW), Succeeded());
+  }
+  Expected<GsymReader> GR = GsymReader::copyBuffer(OutStrm.str());
+  ASSERT_THAT_EXPECTED(GR, Succeeded());
+
+  const Header &Hdr = GR->getHeader();
+  EXPECT_EQ(Hdr.BaseAddress, 0x1000u);
+  EXPECT_EQ(Hdr.NumAddresses, 3u);
+  EXPECT_EQ(Hdr.AddrOffSize, 2u);
+  EXPECT_EQ(Hdr.UUIDSize, sizeof(UUID));
+  EXPECT_EQ(GR->getAddress(0), Optional<uint64_t>(0x1000));
+  EXPECT_EQ(GR->getAddress(1), Optional<uint64_t>(0x2000));
+  EXPECT_EQ(GR->getAddress(2), Optional<uint64_t>(0x3000));
+  EXPECT_FALSE(GR->getAddress(3));
+  Optional<FileEntry> FE = GR->getFile(FooFile);
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(GR->getString(FE->Dir), "/tmp");
+  EXPECT_EQ(GR->getString(FE->Base), "foo.h");
+  EXPECT_FALSE(GR->getFile(FooFile + 1));
+
+  // Addresses before the first function and in gaps between functions that
+  // have a size aren't in the GSYM.
+  EXPECT_THAT_EXPECTED(GR->lookup(0xfff), Failed());
+  EXPECT_THAT_EXPECTED(GR->lookup(0x1100), Failed());
+  EXPECT_THAT_EXPECTED(GR->lookup(0x3010), Failed());
+  EXPECT_THAT_EXPECTED(GR->getFunctionInfo(0x1100), Failed());
+
+  // Full decoding gives back the function that was added.
+  Expected<FunctionInfo> MainFI = GR->getFunctionInfo(0x1050);
+  ASSERT_THAT_EXPECTED(MainFI, Succeeded());
+  EXPECT_EQ(MainFI->Name, MainName);
+  EXPECT_EQ(MainFI->Lines.size(), 4u);
+  EXPECT_TRUE(MainFI->Inline.isValid());
+
+  // An address in the concrete function only.
+  Expected<LookupResult> LR = GR->lookup(0x1004);
+  ASSERT_THAT_EXPECTED(LR, Succeeded());
+  EXPECT_EQ(LR->FuncName, "main");
+  EXPECT_EQ(LR->FuncRange, AddressRange(0x1000, 0x1100));
+  ASSERT_EQ(LR->Locations.size(), 1u);
+  EXPECT_EQ(LR->Locations[0].Name, "main");
+  EXPECT_EQ(LR->Locations[0].Line, 10u);
+  EXPECT_EQ(LR->getSourceFile(0), "/tmp/main.cpp");
+
+  // An address in "foo" inlined in "main".
+  LR = GR->lookup(0x1018);
+  ASSERT_THAT_EXPECTED(LR, Succeeded());
+  ASSERT_EQ(LR->Locations.size(), 2u);
+  EXPECT_EQ(LR->Locations[0].Name, "foo");
+  EXPECT_EQ(LR->Locations[0].Base, "foo.h");
+  EXPECT_EQ(LR->Locations[0].Line, 20u);
+  EXPECT_EQ(LR->Locations[1].Name, "main");
+  EXPECT_EQ(LR->Locations[1].Base, "main.cpp");
+  EXPECT_EQ(LR->Locations[1].Line, 12u);
+
+  // An address in "bar" inlined in "foo" inlined in "main".
+  LR = GR->lookup(0x1024);
+  ASSERT_THAT_EXPECTED(LR, Succeeded());
+  ASSERT_EQ(LR->Locations.size(), 3u);
+  EXPECT_EQ(LR->Locations[0].Name, "bar");
+  EXPECT_EQ(LR->Locations[0].Line, 30u);
+  EXPECT_EQ(LR->Locations[1].Name, "foo");
+  EXPECT_EQ(LR->Locations[1].Base, "foo.h");
+  EXPECT_EQ(LR->Locations[1].Line, 22u);
+  EXPECT_EQ(LR->Locations[2].Name, "main");
+  EXPECT_EQ(LR->Locations[2].Line, 12u);
+
+  // Back in the concrete function after the inlined code.
+  LR = GR->lookup(0x10ff);
+  ASSERT_THAT_EXPECTED(LR, Succeeded());
+  ASSERT_EQ(LR->Locations.size(), 1u);
+  EXPECT_EQ(LR->Locations[0].Line, 13u);
+
+  // A symbol without a size covers everything up to the next function and
+  // has no source locations.
+  LR = GR->lookup(0x2fff);
+  ASSERT_THAT_EXPECTED(LR, Succeeded());
+  EXPECT_EQ(LR->FuncName, "sym");
+  EXPECT_TRUE(LR->Locations.empty());
+
+  // The duplicate with a line table was kept.
+  LR = GR->lookup(0x3008);
+  ASSERT_THAT_EXPECTED(LR, Succeeded());
+  EXPECT_EQ(LR->FuncName, "dup");
+  ASSERT_EQ(LR->Locations.size(), 1u);
+  EXPECT_EQ(LR->Locations[0].Line, 40u);
+}
+
+TEST(GSYMTest, TestGsymCreatorAndReader) {
+  TestGsymCreatorAndReader(llvm::support::little);
+  TestGsymCreatorAndReader(llvm::support::big);
+}
+
+TEST(GSYMTest, TestGsymReaderErrors) {
+  // Not a GSYM file.
+  std::string Bytes(sizeof(Header), 'x');
+  EXPECT_THAT_EXPECTED(GsymReader::copyBuffer(Bytes), Failed());
+
+  // A valid header whose tables don't fit in the data.
+  Header H = getValidHeader();
+  H.NumAddresses = 100;
+  SmallString<512> Str;
+  raw_svector_ostream OutStrm(Str);
+  {
+    FileWriter FW(OutStrm, llvm::support::little);
+    ASSERT_THAT_ERROR(H.encode(FW), Succeeded());
+  }
+  EXPECT_THAT_EXPECTED(GsymReader::copyBuffer(OutStrm.str()), Failed());
+}
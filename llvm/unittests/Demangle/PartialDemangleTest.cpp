@@ -191,3 +191,52 @@ TEST(PartialDemanglerTest, TestPrintCases) {
 
   std::free(Buf);
 }
+
+TEST(PartialDemanglerTest, TestDemangle) {
+  llvm::ItaniumPartialDemangler D;
+  char *Buf = nullptr;
+  size_t N = 0;
+
+  // The name need not be null-terminated.
+  const char Line[] = "_Z1fv _ZN1a1b1cIiiiEEvm";
+  Buf = D.demangle(Line, 5, Buf, &N);
+  ASSERT_NE(nullptr, Buf);
+  EXPECT_STREQ("f()", Buf);
+  EXPECT_EQ(strlen(Buf) + 1, N);
+  EXPECT_TRUE(D.isFunction());
+
+  // Passing the buffer back in reuses or grows it.
+  char *Res = D.demangle(Line + 6, sizeof(Line) - 7, Buf, &N);
+  ASSERT_NE(nullptr, Res);
+  EXPECT_STREQ("void a::b::c<int, int, int>(unsigned long)", Res);
+  EXPECT_EQ(strlen(Res) + 1, N);
+  Buf = Res;
+
+  // Names that need more than the arena's first block demangle the same
+  // way every time the arena is reused.
+  std::string Long = "_Z1f";
+  std::string Expected = "f(";
+  for (int I = 0; I != 200; ++I) {
+    Long += I % 2 ? "PFivE" : "PFvvE";
+    Expected += I ? ", " : "";
+    Expected += I % 2 ? "int (*)()" : "void (*)()";
+  }
+  Expected += ")";
+  for (int Round = 0; Round != 3; ++Round) {
+    Res = D.demangle(Long.data(), Long.size(), Buf, &N);
+    ASSERT_NE(nullptr, Res);
+    EXPECT_EQ(Expected, Res);
+    Buf = Res;
+    Res = D.demangle(Line, 5, Buf, &N);
+    ASSERT_NE(nullptr, Res);
+    EXPECT_STREQ("f()", Res);
+    Buf = Res;
+  }
+
+  // Failure case: the buffer is left alone.
+  N = 7;
+  EXPECT_EQ(nullptr, D.demangle("_Z", 2, Buf, &N));
+  EXPECT_EQ(7u, N);
+
+  std::free(Buf);
+}
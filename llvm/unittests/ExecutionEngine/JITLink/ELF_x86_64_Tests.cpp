@@ -0,0 +1,216 @@
+//===---------- ELF_x86_64.cpp - Tests for JITLink ELF/x86-64 -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "JITLinkTestCommon.h"
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+class JITLinkTest_ELF_x86_64 : public JITLinkTestCommon,
+                               public testing::Test {
+public:
+  using BasicVerifyGraphFunction =
+      std::function<void(AtomGraph &, const MCDisassembler &)>;
+
+  void runBasicVerifyGraphTest(StringRef AsmSrc,
+                               StringMap<JITEvaluatedSymbol> Externals,
+                               BasicVerifyGraphFunction RunGraphTest) {
+    auto TR = getTestResources(AsmSrc, "x86_64-unknown-linux-gnu", true,
+                               false, MCTargetOptions());
+    if (!TR) {
+      dbgs() << "Skipping JITLInk unit test: " << toString(TR.takeError())
+             << "\n";
+      return;
+    }
+
+    auto MemMgr = InProcessSlabMemoryManager::Create(1 << 20);
+    ASSERT_THAT_EXPECTED(MemMgr, Succeeded());
+
+    auto JTCtx = std::make_unique<TestJITLinkContext>(
+        **TR, [&](AtomGraph &G) { RunGraphTest(G, (*TR)->getDisassembler()); });
+
+    JTCtx->externals() = std::move(Externals);
+    JTCtx->setMemoryManager(std::move(*MemMgr));
+
+    jitLink_ELF_x86_64(std::move(JTCtx));
+  }
+
+protected:
+  static void verifyIsPointerTo(AtomGraph &G, DefinedAtom &A, Atom &Target) {
+    EXPECT_EQ(A.edges_size(), 1U) << "Incorrect number of edges for pointer";
+    if (A.edges_size() != 1U)
+      return;
+    auto &E = *A.edges().begin();
+    EXPECT_EQ(E.getKind(), Pointer64)
+        << "Expected pointer to have a pointer64 relocation";
+    EXPECT_EQ(&E.getTarget(), &Target) << "Expected edge to point at target";
+    EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, A), HasValue(Target.getAddress()))
+        << "Pointer does not point to target";
+  }
+
+  static void verifyCall(const MCDisassembler &Dis, DefinedAtom &Caller,
+                         Edge &E, Atom &Callee) {
+    EXPECT_EQ(&E.getTarget(), &Callee)
+        << "Edge does not point at expected callee";
+
+    JITTargetAddress FixupAddress = Caller.getAddress() + E.getOffset();
+    uint64_t PCRelDelta = Callee.getAddress() - (FixupAddress + 4);
+
+    EXPECT_THAT_EXPECTED(
+        decodeImmediateOperand(Dis, Caller, 0, E.getOffset() - 1),
+        HasValue(PCRelDelta));
+  }
+};
+
+} // end anonymous namespace
+
+TEST_F(JITLinkTest_ELF_x86_64, BasicRelocations) {
+  runBasicVerifyGraphTest(
+      R"(
+            .text
+            .globl  bar
+            .p2align        4, 0x90
+            .type   bar,@function
+    bar:
+            callq   baz@PLT
+
+            .globl  foo
+            .p2align        4, 0x90
+            .type   foo,@function
+    foo:
+            callq   bar
+    foo.1:
+            movq    y@GOTPCREL(%rip), %rcx
+    foo.2:
+            movq    p(%rip), %rdx
+    foo.3:
+            leaq    .Lstr+2(%rip), %rsi
+
+            .data
+            .globl  x
+            .p2align        2
+    x:
+            .long   42
+
+            .globl  p
+            .p2align        3
+    p:
+            .quad   x
+
+            .section        .rodata.str1.1,"aMS",@progbits,1
+    .Lstr:
+            .asciz  "hello")",
+      {{"y", JITEvaluatedSymbol(0xdeadbeef, JITSymbolFlags::Exported)},
+       {"baz", JITEvaluatedSymbol(0xcafef00d, JITSymbolFlags::Exported)}},
+      [](AtomGraph &G, const MCDisassembler &Dis) {
+        auto &Baz = atom(G, "baz");
+        auto &Y = atom(G, "y");
+
+        auto &Bar = definedAtom(G, "bar");
+        auto &Foo = definedAtom(G, "foo");
+        auto &Foo_1 = definedAtom(G, "foo.1");
+        auto &Foo_2 = definedAtom(G, "foo.2");
+        auto &Foo_3 = definedAtom(G, "foo.3");
+        auto &X = definedAtom(G, "x");
+        auto &P = definedAtom(G, "p");
+
+        auto relocations = [](DefinedAtom &DA) {
+          std::vector<Edge *> Relocs;
+          for (auto &E : DA.edges())
+            if (E.isRelocation())
+              Relocs.push_back(&E);
+          return Relocs;
+        };
+
+        // Check the absolute pointer in p.
+        {
+          auto Relocs = relocations(P);
+          ASSERT_EQ(Relocs.size(), 1U) << "Unexpected number of relocations";
+          EXPECT_EQ(Relocs[0]->getKind(), Pointer64);
+          EXPECT_THAT_EXPECTED(readInt<uint64_t>(G, P),
+                               HasValue(X.getAddress()))
+              << "Pointer64 relocation did not apply correctly";
+        }
+
+        // Check that bar calls baz through a stub that jumps through a GOT
+        // entry.
+        {
+          auto Relocs = relocations(Bar);
+          ASSERT_EQ(Relocs.size(), 1U) << "Incorrect number of edges for bar";
+          auto &E = *Relocs[0];
+          EXPECT_EQ(E.getKind(), Branch32);
+          ASSERT_TRUE(E.getTarget().isDefined()) << "Call is not to a stub";
+          verifyCall(Dis, Bar, E, E.getTarget());
+
+          auto &Stub = static_cast<DefinedAtom &>(E.getTarget());
+          ASSERT_EQ(Stub.edges_size(), 1U);
+          auto &StubEdge = *Stub.edges().begin();
+          EXPECT_EQ(StubEdge.getKind(), PCRel32);
+          ASSERT_TRUE(StubEdge.getTarget().isDefined());
+          auto &GOTEntry = static_cast<DefinedAtom &>(StubEdge.getTarget());
+          verifyIsPointerTo(G, GOTEntry, Baz);
+
+          uint64_t PCRelDelta = GOTEntry.getAddress() - (Stub.getAddress() + 6);
+          EXPECT_THAT_EXPECTED(decodeImmediateOperand(Dis, Stub, 3, 0),
+                               HasValue(PCRelDelta));
+        }
+
+        // Check that foo calls bar directly.
+        {
+          auto Relocs = relocations(Foo);
+          ASSERT_EQ(Relocs.size(), 1U) << "Incorrect number of edges for foo";
+          verifyCall(Dis, Foo, *Relocs[0], Bar);
+        }
+
+        // Check the GOT load in foo.1.
+        {
+          auto Relocs = relocations(Foo_1);
+          ASSERT_EQ(Relocs.size(), 1U);
+          auto &E = *Relocs[0];
+          EXPECT_EQ(E.getKind(), PCRel32);
+          ASSERT_TRUE(E.getTarget().isDefined()) << "Load is not from GOT";
+          verifyIsPointerTo(G, static_cast<DefinedAtom &>(E.getTarget()), Y);
+        }
+
+        // Check the PC-relative load of p in foo.2.
+        {
+          auto Relocs = relocations(Foo_2);
+          ASSERT_EQ(Relocs.size(), 1U);
+          EXPECT_EQ(Relocs[0]->getKind(), PCRel32);
+          JITTargetAddress FixupAddress =
+              Foo_2.getAddress() + Relocs[0]->getOffset();
+          uint64_t PCRelDelta = P.getAddress() - (FixupAddress + 4);
+          EXPECT_THAT_EXPECTED(decodeImmediateOperand(Dis, Foo_2, 4, 0),
+                               HasValue(PCRelDelta));
+        }
+
+        // Check the reference into the anonymous string section in foo.3,
+        // which is relocated against a section symbol.
+        {
+          auto Relocs = relocations(Foo_3);
+          ASSERT_EQ(Relocs.size(), 1U);
+          auto &E = *Relocs[0];
+          EXPECT_EQ(E.getKind(), PCRel32);
+          ASSERT_TRUE(E.getTarget().isDefined());
+          auto &Str = static_cast<DefinedAtom &>(E.getTarget());
+          EXPECT_EQ(Str.getContent(), StringRef("hello", 6));
+          JITTargetAddress FixupAddress = Foo_3.getAddress() + E.getOffset();
+          uint64_t PCRelDelta = Str.getAddress() + 2 - (FixupAddress + 4);
+          EXPECT_THAT_EXPECTED(decodeImmediateOperand(Dis, Foo_3, 4, 0),
+                               HasValue(PCRelDelta));
+        }
+      });
+}
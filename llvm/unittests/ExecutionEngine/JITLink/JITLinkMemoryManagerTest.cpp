@@ -0,0 +1,96 @@
+//===--- JITLinkMemoryManagerTest.cpp - Tests for JITLink memory managers -===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Testing/Support/Error.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+
+namespace {
+
+const auto ReadWrite = static_cast<sys::Memory::ProtectionFlags>(
+    sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+const auto ReadExec = static_cast<sys::Memory::ProtectionFlags>(
+    sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+
+TEST(InProcessSlabMemoryManagerTest, AllocationsShareTheSlab) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  uint64_t SlabSize = 8 * PageSize;
+  auto MemMgr = InProcessSlabMemoryManager::Create(SlabSize);
+  ASSERT_THAT_EXPECTED(MemMgr, Succeeded());
+
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[ReadExec] = {16, 16, 0, 1};
+  Request[ReadWrite] = {8, 8, 32, 8};
+
+  auto A1 = (*MemMgr)->allocate(Request);
+  ASSERT_THAT_EXPECTED(A1, Succeeded());
+  auto A2 = (*MemMgr)->allocate(Request);
+  ASSERT_THAT_EXPECTED(A2, Succeeded());
+
+  // Each segment gets its own pages, and all of them lie within the slab.
+  JITTargetAddress Lo = (*A1)->getTargetMemory(ReadExec);
+  JITTargetAddress Hi = Lo;
+  for (auto *A : {A1->get(), A2->get()})
+    for (auto Prot : {ReadExec, ReadWrite}) {
+      JITTargetAddress Addr = A->getTargetMemory(Prot);
+      EXPECT_EQ(Addr % PageSize, 0U);
+      Lo = std::min(Lo, Addr);
+      Hi = std::max(Hi, Addr);
+    }
+  EXPECT_LT(Hi - Lo, SlabSize);
+
+  // Zero-fill memory is cleared.
+  auto WorkingMem = (*A1)->getWorkingMemory(ReadWrite);
+  ASSERT_EQ(WorkingMem.size(), 40U);
+  for (char C : WorkingMem.slice(8))
+    EXPECT_EQ(C, 0);
+  memset(WorkingMem.data(), 0xff, WorkingMem.size());
+
+  // Released memory is reused, and zero-fill is cleared again.
+  JITTargetAddress A1Data = (*A1)->getTargetMemory(ReadWrite);
+  EXPECT_THAT_ERROR((*A1)->deallocate(), Succeeded());
+  auto A3 = (*MemMgr)->allocate(Request);
+  ASSERT_THAT_EXPECTED(A3, Succeeded());
+  EXPECT_EQ((*A3)->getTargetMemory(ReadWrite), A1Data);
+  for (char C : (*A3)->getWorkingMemory(ReadWrite).slice(8))
+    EXPECT_EQ(C, 0);
+
+  EXPECT_THAT_ERROR((*A2)->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR((*A3)->deallocate(), Succeeded());
+}
+
+TEST(InProcessSlabMemoryManagerTest, Exhaustion) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  auto MemMgr = InProcessSlabMemoryManager::Create(2 * PageSize);
+  ASSERT_THAT_EXPECTED(MemMgr, Succeeded());
+
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[ReadWrite] = {PageSize, 8, 0, 1};
+
+  auto A1 = (*MemMgr)->allocate(Request);
+  ASSERT_THAT_EXPECTED(A1, Succeeded());
+  auto A2 = (*MemMgr)->allocate(Request);
+  ASSERT_THAT_EXPECTED(A2, Succeeded());
+  EXPECT_THAT_EXPECTED((*MemMgr)->allocate(Request), Failed());
+
+  // Freeing both pages coalesces them into a range big enough for a two page
+  // request.
+  EXPECT_THAT_ERROR((*A2)->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR((*A1)->deallocate(), Succeeded());
+  Request[ReadWrite] = {2 * PageSize, 8, 0, 1};
+  auto A3 = (*MemMgr)->allocate(Request);
+  ASSERT_THAT_EXPECTED(A3, Succeeded());
+  EXPECT_THAT_ERROR((*A3)->deallocate(), Succeeded());
+}
+
+} // end anonymous namespace
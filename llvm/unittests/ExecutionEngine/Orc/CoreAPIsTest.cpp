@@ -665,6 +665,44 @@ TEST_F(CoreAPIsStandardTest, DefineMaterializingSymbol) {
       << "Expected Bar == BarSym";
 }
 
+TEST_F(CoreAPIsStandardTest, DispatchPriority) {
+  std::vector<std::pair<SymbolStringPtr, MaterializationPriority>> Dispatched;
+  ES.setPrioritizedDispatchMaterialization(
+      [&](JITDylib &JD, std::unique_ptr<MaterializationUnit> MU,
+          MaterializationPriority Priority) {
+        for (auto &KV : MU->getSymbols())
+          Dispatched.push_back({KV.first, Priority});
+        MU->doMaterialize(JD);
+      });
+
+  auto MakeMU = [](SymbolStringPtr Name, JITEvaluatedSymbol Sym) {
+    return std::make_unique<SimpleMaterializationUnit>(
+        SymbolFlagsMap({{Name, Sym.getFlags()}}),
+        [=](MaterializationResponsibility R) {
+          R.notifyResolved(SymbolMap({{Name, Sym}}));
+          R.notifyEmitted();
+        });
+  };
+  cantFail(JD.define(MakeMU(Foo, FooSym)));
+  cantFail(JD.define(MakeMU(Bar, BarSym)));
+
+  bool FooReady = false;
+  ES.lookup(JITDylibSearchList({{&JD, false}}), {Foo}, SymbolState::Ready,
+            [&](Expected<SymbolMap> Result) {
+              cantFail(std::move(Result));
+              FooReady = true;
+            },
+            NoDependenciesToRegister, MaterializationPriority::Speculative);
+  EXPECT_TRUE(FooReady) << "Speculative lookup did not complete";
+  cantFail(ES.lookup(JITDylibSearchList({{&JD, false}}), Bar));
+
+  ASSERT_EQ(2U, Dispatched.size());
+  EXPECT_EQ(Foo, Dispatched[0].first);
+  EXPECT_EQ(MaterializationPriority::Speculative, Dispatched[0].second);
+  EXPECT_EQ(Bar, Dispatched[1].first);
+  EXPECT_EQ(MaterializationPriority::OnDemand, Dispatched[1].second);
+}
+
 TEST_F(CoreAPIsStandardTest, GeneratorTest) {
   cantFail(JD.define(absoluteSymbols({{Foo, FooSym}})));
 
@@ -0,0 +1,80 @@
+//===- PersistentObjectCacheTest.cpp - Unit tests for the object cache ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class PersistentObjectCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("orc-object-cache", CacheDir));
+    M = std::make_unique<Module>("M", Ctx);
+    addFunction("foo");
+  }
+
+  void TearDown() override { sys::fs::remove_directories(CacheDir); }
+
+  void addFunction(StringRef Name) {
+    Function::Create(FunctionType::get(Type::getVoidTy(Ctx), false),
+                     GlobalValue::ExternalLinkage, Name, *M);
+  }
+
+  std::unique_ptr<PersistentObjectCache> createCache(StringRef CPU = "") {
+    JITTargetMachineBuilder JTMB((Triple("x86_64-unknown-linux-gnu")));
+    JTMB.setCPU(CPU.str());
+    auto Cache = PersistentObjectCache::Create(CacheDir, JTMB);
+    EXPECT_THAT_EXPECTED(Cache, Succeeded());
+    return Cache ? std::move(*Cache) : nullptr;
+  }
+
+  SmallString<128> CacheDir;
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M;
+};
+
+TEST_F(PersistentObjectCacheTest, RoundTrip) {
+  const char ObjBytes[] = "not really an object file";
+  MemoryBufferRef Obj(StringRef(ObjBytes, sizeof(ObjBytes)), "obj");
+
+  {
+    auto Cache = createCache();
+    ASSERT_TRUE(Cache);
+    EXPECT_FALSE(Cache->getObject(M.get()));
+    Cache->notifyObjectCompiled(M.get(), Obj);
+  }
+
+  // A new cache instance (as in a new process) finds the stored object.
+  auto Cache = createCache();
+  ASSERT_TRUE(Cache);
+  std::unique_ptr<MemoryBuffer> Hit = Cache->getObject(M.get());
+  ASSERT_TRUE(Hit);
+  EXPECT_EQ(Obj.getBuffer(), Hit->getBuffer());
+
+  // Objects compiled for another target configuration are not reused.
+  auto OtherCPUCache = createCache("znver1");
+  ASSERT_TRUE(OtherCPUCache);
+  EXPECT_FALSE(OtherCPUCache->getObject(M.get()));
+
+  // Neither are objects compiled from different IR.
+  addFunction("bar");
+  EXPECT_FALSE(Cache->getObject(M.get()));
+}
+
+} // end anonymous namespace
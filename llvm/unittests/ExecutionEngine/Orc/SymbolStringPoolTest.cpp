@@ -39,6 +39,20 @@ TEST(SymbolStringPool, Dereference) {
   EXPECT_EQ(*Foo, "foo") << "Equality on dereferenced string failed";
 }
 
+TEST(SymbolStringPool, InternAll) {
+  SymbolStringPool SP;
+  auto Foo = SP.intern("foo");
+
+  std::vector<StringRef> Names = {"bar", "foo", "baz", "bar"};
+  auto Interned = SP.internAll(Names);
+  ASSERT_EQ(Interned.size(), Names.size());
+  for (unsigned I = 0; I != Names.size(); ++I)
+    EXPECT_EQ(*Interned[I], Names[I]) << "Results out of order";
+  EXPECT_EQ(Interned[1], Foo) << "Failed to unique against existing entry";
+  EXPECT_EQ(Interned[0], Interned[3]) << "Failed to unique within batch";
+  EXPECT_NE(Interned[0], Interned[2]);
+}
+
 TEST(SymbolStringPool, ClearDeadEntries) {
   SymbolStringPool SP;
   {
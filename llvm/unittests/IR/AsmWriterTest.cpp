@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 //===----------------------------------------------------------------------===//
+#include "llvm/AsmParser/Parser.h"
 #include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Function.h"
@@ -12,6 +13,8 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -62,4 +65,40 @@ TEST(AsmWriterTest, DumpDIExpression) {
             OS.str());
 }
 
+TEST(AsmWriterTest, ParallelFunctionPrinting) {
+  // Functions large enough to be printed by different tasks, with unnamed
+  // values and types, and metadata and call attributes that are only
+  // numbered once a function is reached.
+  std::string Text = "%0 = type { i32 }\n"
+                     "declare void @g(%0*)\n";
+  for (unsigned F = 0; F != 8; ++F) {
+    std::string N = std::to_string(F);
+    Text += "define i32 @f" + N + "(i32) {\n"
+            "entry:\n";
+    for (unsigned I = 0; I != 1000; ++I)
+      Text += "  %" + std::to_string(I + 1) + " = add i32 %" +
+              std::to_string(I) + ", " + N + ", !md !{i32 " + N + "}\n";
+    Text += "  call void @g(%0* null) #" + N + "\n"
+            "  ret i32 %1000\n"
+            "}\n"
+            "attributes #" + N + " = { \"n\"=\"" + N + "\" }\n";
+  }
+
+  LLVMContext Ctx;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(Text, Err, Ctx);
+  ASSERT_TRUE(M);
+
+  auto *Parallel = static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["asm-writer-parallel-functions"]);
+  ASSERT_TRUE(Parallel);
+  std::string Serial, Concurrent;
+  raw_string_ostream SerialOS(Serial), ConcurrentOS(Concurrent);
+  M->print(SerialOS, nullptr);
+  Parallel->setValue(true);
+  M->print(ConcurrentOS, nullptr);
+  Parallel->setValue(false);
+  EXPECT_EQ(SerialOS.str(), ConcurrentOS.str());
+}
+
 }
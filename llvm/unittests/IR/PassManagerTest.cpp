@@ -518,6 +518,39 @@ TEST_F(PassManagerTest, Basic) {
   EXPECT_EQ(1, ModuleAnalysisRuns);
 }
 
+TEST_F(PassManagerTest, AnalysisInvalidatedCallback) {
+  PassInstrumentationCallbacks PIC;
+  std::vector<std::string> Invalidated;
+  PIC.registerAnalysisInvalidatedCallback([&](StringRef A, Any IR) {
+    ASSERT_TRUE(any_isa<const Function *>(IR));
+    if (A.endswith("TestFunctionAnalysis"))
+      Invalidated.push_back(any_cast<const Function *>(IR)->getName().str());
+  });
+
+  FunctionAnalysisManager FAM;
+  int FunctionAnalysisRuns = 0;
+  FAM.registerPass([&] { return TestFunctionAnalysis(FunctionAnalysisRuns); });
+  FAM.registerPass([&] { return PassInstrumentationAnalysis(&PIC); });
+
+  ModuleAnalysisManager MAM;
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  MAM.registerPass([&] { return PassInstrumentationAnalysis(&PIC); });
+  FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+
+  ModulePassManager MPM;
+  FunctionPassManager FPM;
+  FPM.addPass(RequireAnalysisPass<TestFunctionAnalysis, Function>());
+  FPM.addPass(TestInvalidationFunctionPass("g"));
+  // Already invalidated, so reported only once.
+  FPM.addPass(TestInvalidationFunctionPass("g"));
+  MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+  MPM.run(*M, MAM);
+
+  EXPECT_EQ(3, FunctionAnalysisRuns);
+  ASSERT_EQ(1u, Invalidated.size());
+  EXPECT_EQ("g", Invalidated[0]);
+}
+
 // A customized pass manager that passes extra arguments through the
 // infrastructure.
 typedef AnalysisManager<Function, int> CustomizedAnalysisManager;
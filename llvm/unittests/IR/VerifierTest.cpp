@@ -17,6 +17,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
 #include "gtest/gtest.h"
 
 namespace llvm {
@@ -190,5 +191,43 @@ TEST(VerifierTest, DetectInvalidDebugInfo) {
   }
 }
 
+TEST(VerifierTest, IncrementalModuleVerifier) {
+  LLVMContext C;
+  Module M("M", C);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), false);
+  Function *F = Function::Create(FTy, Function::ExternalLinkage, "f", M);
+  Function *G = Function::Create(FTy, Function::ExternalLinkage, "g", M);
+  ReturnInst::Create(C, BasicBlock::Create(C, "entry", F));
+  ReturnInst::Create(C, BasicBlock::Create(C, "entry", G));
+
+  FunctionAnalysisManager FAM;
+  ModuleAnalysisManager MAM;
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+  FAM.registerPass([&] { return VerifierAnalysis(); });
+  MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+  FAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+
+  ModulePassManager MPM;
+  MPM.addPass(VerifierPass(/*FatalErrors=*/false, /*Incremental=*/true));
+  MPM.run(M, MAM);
+  ASSERT_TRUE(FAM.getCachedResult<VerifierAnalysis>(*F));
+  ASSERT_TRUE(FAM.getCachedResult<VerifierAnalysis>(*G));
+  EXPECT_FALSE(FAM.getCachedResult<VerifierAnalysis>(*F)->IRBroken);
+  EXPECT_FALSE(FAM.getCachedResult<VerifierAnalysis>(*G)->IRBroken);
+
+  // Break both functions by dropping their terminators, but only report the
+  // change to f. The cached result of g is reused.
+  F->getEntryBlock().getTerminator()->eraseFromParent();
+  G->getEntryBlock().getTerminator()->eraseFromParent();
+  FAM.invalidate(*F, PreservedAnalyses::none());
+  MPM.run(M, MAM);
+  EXPECT_TRUE(FAM.getCachedResult<VerifierAnalysis>(*F)->IRBroken);
+  EXPECT_FALSE(FAM.getCachedResult<VerifierAnalysis>(*G)->IRBroken);
+
+  ReturnInst::Create(C, &F->getEntryBlock());
+  ReturnInst::Create(C, &G->getEntryBlock());
+}
+
 } // end anonymous namespace
 } // end namespace llvm
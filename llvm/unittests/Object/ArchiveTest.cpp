@@ -0,0 +1,75 @@
+//===- ArchiveTest.cpp - Tests for Archive.cpp ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/Archive.h"
+#include "llvm/Object/ArchiveWriter.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+TEST(ArchiveTest, SymbolIndexLookup) {
+  SmallString<128> Path;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("ArchiveTest", "a", Path));
+
+  std::vector<NewArchiveMember> Members;
+  Members.emplace_back(MemoryBufferRef("first\n", "a.o"));
+  Members.back().Symbols = std::vector<StringRef>({"foo", "bar"});
+  Members.emplace_back(MemoryBufferRef("second\n", "b.o"));
+  Members.back().Symbols = std::vector<StringRef>({"foo", "baz"});
+  ASSERT_THAT_ERROR(writeArchive(Path, Members, /*WriteSymtab=*/true,
+                                 Archive::K_GNU, /*Deterministic=*/true,
+                                 /*Thin=*/false),
+                    Succeeded());
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(BufOrErr));
+  Expected<std::unique_ptr<Archive>> ArchiveOrErr =
+      Archive::create(BufOrErr.get()->getMemBufferRef());
+  ASSERT_THAT_EXPECTED(ArchiveOrErr, Succeeded());
+  Archive &A = **ArchiveOrErr;
+
+  ArchiveSymbolIndex Index(A);
+  EXPECT_EQ(3u, Index.size());
+  EXPECT_FALSE(Index.lookup("qux").hasValue());
+  EXPECT_FALSE(Index.lookup("").hasValue());
+
+  auto getMemberName = [](const Archive::Symbol &S) -> std::string {
+    Expected<Archive::Child> ChildOrErr = S.getMember();
+    EXPECT_THAT_EXPECTED(ChildOrErr, Succeeded());
+    if (!ChildOrErr)
+      return "";
+    Expected<StringRef> NameOrErr = ChildOrErr->getName();
+    EXPECT_THAT_EXPECTED(NameOrErr, Succeeded());
+    return NameOrErr ? NameOrErr->str() : "";
+  };
+  for (StringRef Name : {"foo", "bar", "baz"}) {
+    Optional<Archive::Symbol> S = Index.lookup(Name);
+    ASSERT_TRUE(S.hasValue());
+    EXPECT_EQ(Name, S->getName());
+
+    // The index agrees with the linear search, including for the duplicate.
+    Expected<Optional<Archive::Child>> ChildOrErr = A.findSym(Name);
+    ASSERT_THAT_EXPECTED(ChildOrErr, Succeeded());
+    ASSERT_TRUE(ChildOrErr->hasValue());
+    Expected<StringRef> NameOrErr = (*ChildOrErr)->getName();
+    ASSERT_THAT_EXPECTED(NameOrErr, Succeeded());
+    EXPECT_EQ(*NameOrErr, getMemberName(*S));
+  }
+  EXPECT_EQ("a.o", getMemberName(*Index.lookup("foo")));
+  EXPECT_EQ("b.o", getMemberName(*Index.lookup("baz")));
+
+  ASSERT_FALSE(sys::fs::remove(Path));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,60 @@
+//===- ArchiveWriterTest.cpp - Tests for ArchiveWriter.cpp ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ArchiveWriter.h"
+#include "llvm/Object/Archive.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+TEST(ArchiveWriterTest, KnownSymbolsAreNotRecomputed) {
+  SmallString<128> Path;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("ArchiveWriterTest", "a", Path));
+
+  // None of the members is an object file, so the only symbols in the
+  // archive symbol table are the ones the members say they define.
+  std::vector<NewArchiveMember> Members;
+  Members.emplace_back(MemoryBufferRef("first\n", "a.o"));
+  Members.back().Symbols = std::vector<StringRef>({"foo", "bar"});
+  Members.emplace_back(MemoryBufferRef("text\n", "b.txt"));
+  Members.emplace_back(MemoryBufferRef("second\n", "c.o"));
+  Members.back().Symbols = std::vector<StringRef>({"baz"});
+  ASSERT_THAT_ERROR(writeArchive(Path, Members, /*WriteSymtab=*/true,
+                                 Archive::K_GNU, /*Deterministic=*/true,
+                                 /*Thin=*/false),
+                    Succeeded());
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(BufOrErr));
+  Expected<std::unique_ptr<Archive>> ArchiveOrErr =
+      Archive::create(BufOrErr.get()->getMemBufferRef());
+  ASSERT_THAT_EXPECTED(ArchiveOrErr, Succeeded());
+  Archive &A = **ArchiveOrErr;
+
+  std::vector<std::pair<std::string, std::string>> Symbols;
+  for (const Archive::Symbol &S : A.symbols()) {
+    Expected<Archive::Child> ChildOrErr = S.getMember();
+    ASSERT_THAT_EXPECTED(ChildOrErr, Succeeded());
+    Expected<StringRef> NameOrErr = ChildOrErr->getName();
+    ASSERT_THAT_EXPECTED(NameOrErr, Succeeded());
+    Symbols.emplace_back(S.getName().str(), NameOrErr->str());
+  }
+  std::vector<std::pair<std::string, std::string>> ExpectedSymbols = {
+      {"foo", "a.o"}, {"bar", "a.o"}, {"baz", "c.o"}};
+  EXPECT_EQ(ExpectedSymbols, Symbols);
+
+  ASSERT_FALSE(sys::fs::remove(Path));
+}
+
+} // end anonymous namespace
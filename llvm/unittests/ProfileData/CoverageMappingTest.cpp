@@ -11,6 +11,8 @@
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/ProfileData/InstrProfWriter.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Testing/Support/Error.h"
 #include "llvm/Testing/Support/SupportHelpers.h"
@@ -98,6 +100,14 @@ struct CoverageMappingReaderMock : CoverageMappingReader {
 
     return Error::success();
   }
+
+  Optional<size_t> getNumRecords() const override { return Functions.size(); }
+
+  Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                   CoverageMappingRecordBuffers &Buffers) const override {
+    Functions[Index].fillCoverageMappingRecord(Record);
+    return Error::success();
+  }
 };
 
 struct InputFunctionCoverageData {
@@ -128,6 +138,7 @@ struct InputFunctionCoverageData {
 
 struct CoverageMappingTest : ::testing::TestWithParam<std::pair<bool, bool>> {
   bool UseMultipleReaders;
+  unsigned NumThreads = 1;
   StringMap<unsigned> Files;
   std::vector<InputFunctionCoverageData> InputFunctions;
   std::vector<OutputFunctionCoverageData> OutputFunctions;
@@ -241,7 +252,7 @@ struct CoverageMappingTest : ::testing::TestWithParam<std::pair<bool, bool>> {
       CoverageReaders.push_back(
           std::make_unique<CoverageMappingReaderMock>(Funcs));
     }
-    return CoverageMapping::load(CoverageReaders, *ProfileReader);
+    return CoverageMapping::load(CoverageReaders, *ProfileReader, NumThreads);
   }
 
   Error loadCoverageMapping(bool EmitFilenames = true) {
@@ -888,6 +899,165 @@ TEST_P(CoverageMappingTest, skip_duplicate_function_record) {
   ASSERT_EQ(3U, NumFuncs);
 }
 
+TEST_P(CoverageMappingTest, parallel_load_matches_serial_load) {
+  for (unsigned I = 0; I < 64; ++I) {
+    std::string Name = "func" + std::to_string(I);
+    ProfileWriter.addRecord({Name, 0x1234, {I, 2 * I}}, Err);
+    startFunction(Name, I % 8 ? 0x1234 : 0x4321);
+    std::string File = "file" + std::to_string(I % 3);
+    addCMR(Counter::getCounter(0), File, I + 1, 1, I + 10, 1);
+    addCMR(Counter::getCounter(1), File, I + 2, 1, I + 5, 1);
+  }
+  EXPECT_THAT_ERROR(loadCoverageMapping(), Succeeded());
+  std::unique_ptr<CoverageMapping> SerialCoverage = std::move(LoadedCoverage);
+
+  NumThreads = 4;
+  auto CoverageOrErr = readOutputFunctions();
+  ASSERT_THAT_ERROR(CoverageOrErr.takeError(), Succeeded());
+  LoadedCoverage = std::move(CoverageOrErr.get());
+
+  // Every eighth function has a mismatched hash.
+  EXPECT_EQ(8U, LoadedCoverage->getMismatchedCount());
+  auto Serial = SerialCoverage->getHashMismatches();
+  auto Parallel = LoadedCoverage->getHashMismatches();
+  EXPECT_TRUE(std::equal(Serial.begin(), Serial.end(), Parallel.begin(),
+                         Parallel.end()));
+
+  std::vector<std::string> SerialNames, ParallelNames;
+  for (const auto &F : SerialCoverage->getCoveredFunctions())
+    SerialNames.push_back(F.Name);
+  for (const auto &F : LoadedCoverage->getCoveredFunctions())
+    ParallelNames.push_back(F.Name);
+  EXPECT_EQ(56U, ParallelNames.size());
+  EXPECT_EQ(SerialNames, ParallelNames);
+
+  for (StringRef File : {"file0", "file1", "file2"}) {
+    CoverageData SerialData = SerialCoverage->getCoverageForFile(File);
+    CoverageData ParallelData = LoadedCoverage->getCoverageForFile(File);
+    std::vector<CoverageSegment> SerialSegments(SerialData.begin(),
+                                                SerialData.end());
+    std::vector<CoverageSegment> ParallelSegments(ParallelData.begin(),
+                                                  ParallelData.end());
+    EXPECT_FALSE(ParallelSegments.empty());
+    EXPECT_EQ(SerialSegments, ParallelSegments);
+  }
+}
+
+TEST_P(CoverageMappingTest, parallel_load_reports_errors) {
+  for (unsigned I = 0; I < 16; ++I) {
+    std::string Name = I == 11 ? "" : "func" + std::to_string(I);
+    ProfileWriter.addRecord({Name, 0x1234, {10}}, Err);
+    startFunction(Name, 0x1234);
+    addCMR(Counter::getCounter(0), "foo", 1, 1, 5, 5);
+  }
+  NumThreads = 4;
+  EXPECT_TRUE(ErrorEquals(coveragemap_error::malformed, loadCoverageMapping()));
+}
+
+class CoverageMappingFormatTest : public ::testing::TestWithParam<bool> {
+protected:
+  bool Compress;
+
+  void SetUp() override { Compress = GetParam() && zlib::isAvailable(); }
+};
+
+TEST_P(CoverageMappingFormatTest, filenames_round_trip) {
+  std::vector<std::string> Storage;
+  for (unsigned I = 0; I < 32; ++I)
+    Storage.push_back("/a/rather/long/path/to/the/sources/file" +
+                      std::to_string(I) + ".cpp");
+  std::vector<StringRef> Paths(Storage.begin(), Storage.end());
+
+  std::string Encoded;
+  {
+    raw_string_ostream OS(Encoded);
+    CoverageFilenamesSectionWriter(Paths).write(OS, Compress);
+  }
+
+  std::vector<StringRef> ReadPaths;
+  DecompressedCoverageData Decompressed;
+  RawCoverageFilenamesReader Reader(Encoded, ReadPaths);
+  EXPECT_THAT_ERROR(Reader.read(CovMapVersion::CurrentVersion, Decompressed),
+                    Succeeded());
+  EXPECT_EQ(Paths, ReadPaths);
+  EXPECT_EQ(Compress, !Decompressed.empty());
+}
+
+TEST_P(CoverageMappingFormatTest, read_translation_unit) {
+  std::vector<std::string> Names = {"func"};
+  std::string NameData;
+  ASSERT_THAT_ERROR(collectPGOFuncNameStrings(Names, false, NameData),
+                    Succeeded());
+  InstrProfSymtab Symtab;
+  ASSERT_THAT_ERROR(Symtab.create(StringRef(NameData), 0), Succeeded());
+
+  StringRef Paths[] = {"/path/to/file.c", "/path/to/file.h"};
+  std::string Filenames;
+  {
+    raw_string_ostream OS(Filenames);
+    CoverageFilenamesSectionWriter(Paths).write(OS, Compress);
+  }
+
+  // Enough similar regions for the mappings to be worth compressing.
+  unsigned FileIDs[] = {0, 1};
+  std::vector<CounterMappingRegion> Regions;
+  for (unsigned I = 1; I <= 64; ++I)
+    Regions.push_back(CounterMappingRegion::makeRegion(Counter::getCounter(0),
+                                                       0, I, 1, I, 10));
+  Regions.push_back(
+      CounterMappingRegion::makeRegion(Counter::getCounter(1), 1, 2, 1, 3, 1));
+  std::vector<std::string> FuncMappings(1);
+  {
+    raw_string_ostream OS(FuncMappings[0]);
+    CoverageMappingWriter(FileIDs, None, Regions).write(OS);
+  }
+  std::string Mappings;
+  {
+    raw_string_ostream OS(Mappings);
+    CoverageMappingsSectionWriter(FuncMappings).write(OS, Compress);
+  }
+  size_t Padding = (8 - (Filenames.size() + Mappings.size()) % 8) % 8;
+
+  std::string Coverage;
+  {
+    raw_string_ostream OS(Coverage);
+    support::endian::Writer W(OS, support::little);
+    W.write<uint32_t>(1);
+    W.write<uint32_t>(Filenames.size());
+    W.write<uint32_t>(Mappings.size() + Padding);
+    W.write<uint32_t>(CovMapVersion::Version4);
+    W.write<uint64_t>(IndexedInstrProf::ComputeHash("func"));
+    W.write<uint32_t>(FuncMappings[0].size());
+    W.write<uint64_t>(0x1234);
+    OS << Filenames << Mappings;
+    OS.write_zeros(Padding);
+  }
+
+  auto ReaderOrErr = BinaryCoverageReader::createCoverageReaderFromBuffer(
+      Coverage, std::move(Symtab), 8, support::little);
+  ASSERT_THAT_ERROR(ReaderOrErr.takeError(), Succeeded());
+  std::unique_ptr<BinaryCoverageReader> Reader = std::move(*ReaderOrErr);
+  CoverageMappingRecord Record;
+  ASSERT_THAT_ERROR(Reader->readNextRecord(Record), Succeeded());
+  EXPECT_EQ("func", Record.FunctionName);
+  EXPECT_EQ(0x1234U, Record.FunctionHash);
+  ASSERT_EQ(2U, Record.Filenames.size());
+  EXPECT_EQ(Paths[0], Record.Filenames[0]);
+  EXPECT_EQ(Paths[1], Record.Filenames[1]);
+  ASSERT_EQ(Regions.size(), Record.MappingRegions.size());
+  for (unsigned I = 0, E = Regions.size(); I != E; ++I) {
+    EXPECT_EQ(Regions[I].FileID, Record.MappingRegions[I].FileID);
+    EXPECT_EQ(Regions[I].startLoc(), Record.MappingRegions[I].startLoc());
+    EXPECT_EQ(Regions[I].endLoc(), Record.MappingRegions[I].endLoc());
+  }
+  EXPECT_EQ(Compress, Mappings.size() < FuncMappings[0].size());
+  EXPECT_TRUE(ErrorEquals(coveragemap_error::eof,
+                          Reader->readNextRecord(Record)));
+}
+
+INSTANTIATE_TEST_CASE_P(CompressedAndUncompressed, CoverageMappingFormatTest,
+                        ::testing::Values(false, true),);
+
 // FIXME: Use ::testing::Combine() when llvm updates its copy of googletest.
 INSTANTIATE_TEST_CASE_P(ParameterizedCovMapTest, CoverageMappingTest,
                         ::testing::Values(std::pair<bool, bool>({false, false}),
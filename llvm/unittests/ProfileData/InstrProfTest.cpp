@@ -138,6 +138,31 @@ TEST_P(MaybeSparseInstrProfTest, get_function_counts) {
   ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, std::move(E2)));
 }
 
+TEST_P(MaybeSparseInstrProfTest, get_instr_prof_record_ref) {
+  for (unsigned I = 0; I < 64; ++I)
+    Writer.addRecord({"func" + std::to_string(I), 0x1234, {I + 1, 7}}, Err);
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  // Prefetching, also of names that aren't in the profile, doesn't change
+  // what lookups return.
+  Reader->prefetchRecords({"func3", "func42", "func63", "bar", "func3"});
+  Reader->prefetchRecords({});
+
+  Expected<const NamedInstrProfRecord &> R =
+      Reader->getInstrProfRecordRef("func42", 0x1234);
+  EXPECT_THAT_ERROR(R.takeError(), Succeeded());
+  EXPECT_EQ("func42", R->Name);
+  ASSERT_EQ(2U, R->Counts.size());
+  ASSERT_EQ(43U, R->Counts[0]);
+  ASSERT_EQ(7U, R->Counts[1]);
+
+  R = Reader->getInstrProfRecordRef("func42", 0x5678);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::hash_mismatch, R.takeError()));
+  R = Reader->getInstrProfRecordRef("bar", 0x1234);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, R.takeError()));
+}
+
 // Profile data is copied from general.proftext
 TEST_F(InstrProfTest, get_profile_summary) {
   Writer.addRecord({"func1", 0x1234, {97531}}, Err);
@@ -221,6 +246,23 @@ TEST_F(InstrProfTest, test_writer_merge) {
   ASSERT_EQ(0U, R->Counts[1]);
 }
 
+TEST_F(InstrProfTest, test_writer_merge_profile_kind) {
+  InstrProfWriter Writer2;
+  EXPECT_THAT_ERROR(Writer2.setIsIRLevelProfile(true, true), Succeeded());
+  Writer.mergeRecordsFromWriter(std::move(Writer2), Err);
+  ASSERT_EQ(InstrProfWriter::PF_IRLevelWithCS, Writer.getProfileKind());
+
+  InstrProfWriter Writer3;
+  EXPECT_THAT_ERROR(Writer3.setIsIRLevelProfile(false, false), Succeeded());
+  bool Reported = false;
+  Writer.mergeRecordsFromWriter(std::move(Writer3), [&](Error E) {
+    EXPECT_TRUE(ErrorEquals(instrprof_error::unsupported_version,
+                            std::move(E)));
+    Reported = true;
+  });
+  ASSERT_TRUE(Reported);
+}
+
 static const char callee1[] = "callee1";
 static const char callee2[] = "callee2";
 static const char callee3[] = "callee3";
@@ -15,6 +15,7 @@
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -57,11 +58,14 @@ struct SampleProfTest : ::testing::Test {
     Reader->collectFuncsToUse(M);
   }
 
-  void testRoundTrip(SampleProfileFormat Format, bool Remap) {
+  void testRoundTrip(SampleProfileFormat Format, bool Remap,
+                     bool CompressAll = false) {
     SmallVector<char, 128> ProfilePath;
     ASSERT_TRUE(NoError(llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
     StringRef Profile(ProfilePath.data(), ProfilePath.size());
     createWriter(Format, Profile);
+    if (CompressAll)
+      Writer->setToCompressAllSections();
 
     StringRef FooName("_Z3fooi");
     FunctionSamples FooSamples;
@@ -285,6 +289,16 @@ TEST_F(SampleProfTest, roundtrip_compact_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Compact_Binary, false);
 }
 
+TEST_F(SampleProfTest, roundtrip_ext_binary_profile) {
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false);
+}
+
+TEST_F(SampleProfTest, roundtrip_compressed_ext_binary_profile) {
+  if (!zlib::isAvailable())
+    return;
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, false, true);
+}
+
 TEST_F(SampleProfTest, remap_text_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Text, true);
 }
@@ -293,6 +307,42 @@ TEST_F(SampleProfTest, remap_raw_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Binary, true);
 }
 
+TEST_F(SampleProfTest, remap_ext_binary_profile) {
+  testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, true);
+}
+
+TEST_F(SampleProfTest, ext_binary_loads_only_module_functions) {
+  SmallVector<char, 128> ProfilePath;
+  ASSERT_TRUE(NoError(
+      llvm::sys::fs::createTemporaryFile("profile", "", ProfilePath)));
+  StringRef ProfileFile(ProfilePath.data(), ProfilePath.size());
+
+  StringMap<FunctionSamples> ProfMap;
+  addFunctionSamples(&ProfMap, "foo", 20301, 1437);
+  addFunctionSamples(&ProfMap, "bar", 20303, 1439);
+  addFunctionSamples(&ProfMap, "baz", 20305, 1441);
+  createWriter(SampleProfileFormat::SPF_Ext_Binary, ProfileFile);
+  ASSERT_TRUE(NoError(Writer->write(ProfMap)));
+  Writer->getOutputStream().flush();
+
+  // Only the functions defined in the module are decoded.
+  Module M("my_module", Context);
+  FunctionType *FnType =
+      FunctionType::get(Type::getVoidTy(Context), {}, false);
+  M.getOrInsertFunction("foo", FnType);
+  M.getOrInsertFunction("baz", FnType);
+  readProfile(M, ProfileFile);
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_EQ(2u, Reader->getProfiles().size());
+  FunctionSamples *Foo = Reader->getSamplesFor("foo");
+  ASSERT_TRUE(Foo != nullptr);
+  ASSERT_EQ(20301u, Foo->getTotalSamples());
+  FunctionSamples *Baz = Reader->getSamplesFor("baz");
+  ASSERT_TRUE(Baz != nullptr);
+  ASSERT_EQ(20305u, Baz->getTotalSamples());
+  ASSERT_EQ(nullptr, Reader->getSamplesFor("bar"));
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
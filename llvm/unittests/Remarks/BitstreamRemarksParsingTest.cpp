@@ -0,0 +1,192 @@
+//===- unittest/Support/BitstreamRemarksParsingTest.cpp - Parsing tests ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm-c/Remarks.h"
+#include "llvm/Remarks/Remark.h"
+#include "llvm/Remarks/RemarkParser.h"
+#include "llvm/Remarks/RemarkSerializer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+static remarks::Remark makeRemark() {
+  remarks::Remark R;
+  R.RemarkType = remarks::Type::Missed;
+  R.PassName = "loop-vectorize";
+  R.RemarkName = "MissedDetails";
+  R.FunctionName = "foo";
+  R.Loc = remarks::RemarkLocation{"file.c", 3, 12};
+  R.Hotness = 4;
+  R.Args.emplace_back();
+  R.Args.back().Key = "String";
+  R.Args.back().Val = "loop not vectorized";
+  R.Args.emplace_back();
+  R.Args.back().Key = "Callee";
+  R.Args.back().Val = "bar";
+  R.Args.back().Loc = remarks::RemarkLocation{"file.h", 1, 2};
+  return R;
+}
+
+static void checkRemark(const remarks::Remark &R) {
+  EXPECT_EQ(R.RemarkType, remarks::Type::Missed);
+  EXPECT_EQ(R.PassName, "loop-vectorize");
+  EXPECT_EQ(R.RemarkName, "MissedDetails");
+  EXPECT_EQ(R.FunctionName, "foo");
+  ASSERT_TRUE(R.Loc.hasValue());
+  EXPECT_EQ(R.Loc->SourceFilePath, "file.c");
+  EXPECT_EQ(R.Loc->SourceLine, 3U);
+  EXPECT_EQ(R.Loc->SourceColumn, 12U);
+  ASSERT_TRUE(R.Hotness.hasValue());
+  EXPECT_EQ(*R.Hotness, 4U);
+  ASSERT_EQ(R.Args.size(), 2U);
+  EXPECT_EQ(R.Args[0].Key, "String");
+  EXPECT_EQ(R.Args[0].Val, "loop not vectorized");
+  EXPECT_FALSE(R.Args[0].Loc.hasValue());
+  EXPECT_EQ(R.Args[1].Key, "Callee");
+  EXPECT_EQ(R.Args[1].Val, "bar");
+  ASSERT_TRUE(R.Args[1].Loc.hasValue());
+  EXPECT_EQ(R.Args[1].Loc->SourceFilePath, "file.h");
+  EXPECT_EQ(R.Args[1].Loc->SourceLine, 1U);
+  EXPECT_EQ(R.Args[1].Loc->SourceColumn, 2U);
+}
+
+// Parse two remarks from the parser and expect the end of the file after.
+static void parseAndCheck(remarks::RemarkParser &Parser) {
+  for (unsigned I = 0; I < 2; ++I) {
+    Expected<std::unique_ptr<remarks::Remark>> MaybeRemark = Parser.next();
+    EXPECT_FALSE(errorToBool(MaybeRemark.takeError()));
+    ASSERT_TRUE(*MaybeRemark != nullptr);
+    checkRemark(**MaybeRemark);
+  }
+  Expected<std::unique_ptr<remarks::Remark>> MaybeRemark = Parser.next();
+  Error E = MaybeRemark.takeError();
+  EXPECT_TRUE(E.isA<remarks::EndOfFileError>());
+  EXPECT_TRUE(errorToBool(std::move(E)));
+}
+
+TEST(BitstreamRemarks, ParsingStandalone) {
+  std::string Buf;
+  raw_string_ostream OS(Buf);
+  Expected<std::unique_ptr<remarks::RemarkSerializer>> MaybeSerializer =
+      remarks::createRemarkSerializer(remarks::Format::Bitstream,
+                                      remarks::SerializerMode::Standalone, OS,
+                                      remarks::StringTable());
+  ASSERT_FALSE(errorToBool(MaybeSerializer.takeError()));
+  // The string table is emitted with the first remark, so fill it up front.
+  remarks::Remark R = makeRemark();
+  remarks::StringTable &StrTab = *(*MaybeSerializer)->StrTab;
+  for (StringRef Str : {R.RemarkName, R.PassName, R.FunctionName,
+                        R.Loc->SourceFilePath, R.Args[0].Key, R.Args[0].Val,
+                        R.Args[1].Key, R.Args[1].Val,
+                        R.Args[1].Loc->SourceFilePath})
+    StrTab.add(Str);
+  (*MaybeSerializer)->emit(R);
+  (*MaybeSerializer)->emit(R);
+
+  Expected<std::unique_ptr<remarks::RemarkParser>> MaybeParser =
+      remarks::createRemarkParser(remarks::Format::Bitstream, OS.str());
+  ASSERT_FALSE(errorToBool(MaybeParser.takeError()));
+  parseAndCheck(**MaybeParser);
+
+  // The metadata of a standalone file is the file itself.
+  MaybeParser =
+      remarks::createRemarkParserFromMeta(remarks::Format::Bitstream, OS.str());
+  ASSERT_FALSE(errorToBool(MaybeParser.takeError()));
+  parseAndCheck(**MaybeParser);
+}
+
+TEST(BitstreamRemarks, ParsingSeparate) {
+  SmallString<64> RemarksPath;
+  ASSERT_FALSE(
+      sys::fs::createTemporaryFile("remarks", "bitstream", RemarksPath));
+  std::string MetaBuf;
+  {
+    std::error_code EC;
+    raw_fd_ostream OS(RemarksPath, EC, sys::fs::OF_None);
+    ASSERT_FALSE(EC);
+    Expected<std::unique_ptr<remarks::RemarkSerializer>> MaybeSerializer =
+        remarks::createRemarkSerializer(remarks::Format::Bitstream,
+                                        remarks::SerializerMode::Separate, OS);
+    ASSERT_FALSE(errorToBool(MaybeSerializer.takeError()));
+    remarks::Remark R = makeRemark();
+    (*MaybeSerializer)->emit(R);
+    (*MaybeSerializer)->emit(R);
+
+    raw_string_ostream MetaOS(MetaBuf);
+    (*MaybeSerializer)
+        ->metaSerializer(MetaOS, StringRef(RemarksPath))
+        ->emit();
+    MetaOS.flush();
+  }
+
+  Expected<std::unique_ptr<remarks::RemarkParser>> MaybeParser =
+      remarks::createRemarkParserFromMeta(remarks::Format::Bitstream, MetaBuf);
+  ASSERT_FALSE(errorToBool(MaybeParser.takeError()));
+  parseAndCheck(**MaybeParser);
+
+  // Without the metadata, there is no string table.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> RemarksBuf =
+      MemoryBuffer::getFile(RemarksPath);
+  ASSERT_TRUE(bool(RemarksBuf));
+  MaybeParser = remarks::createRemarkParser(remarks::Format::Bitstream,
+                                            (*RemarksBuf)->getBuffer());
+  ASSERT_FALSE(errorToBool(MaybeParser.takeError()));
+  Expected<std::unique_ptr<remarks::Remark>> MaybeRemark =
+      (*MaybeParser)->next();
+  EXPECT_TRUE(errorToBool(MaybeRemark.takeError()));
+
+  sys::fs::remove(RemarksPath);
+}
+
+TEST(BitstreamRemarks, ParsingBadMagic) {
+  Expected<std::unique_ptr<remarks::RemarkParser>> MaybeParser =
+      remarks::createRemarkParser(remarks::Format::Bitstream, "WXYZ");
+  ASSERT_FALSE(errorToBool(MaybeParser.takeError()));
+  Expected<std::unique_ptr<remarks::Remark>> MaybeRemark =
+      (*MaybeParser)->next();
+  Error E = MaybeRemark.takeError();
+  EXPECT_FALSE(E.isA<remarks::EndOfFileError>());
+  EXPECT_EQ(toString(std::move(E)),
+            "Unknown magic number: expecting RMRK, got WXYZ.");
+}
+
+TEST(BitstreamRemarks, ParsingCAPI) {
+  std::string Buf;
+  raw_string_ostream OS(Buf);
+  Expected<std::unique_ptr<remarks::RemarkSerializer>> MaybeSerializer =
+      remarks::createRemarkSerializer(remarks::Format::Bitstream,
+                                      remarks::SerializerMode::Standalone, OS,
+                                      remarks::StringTable());
+  ASSERT_FALSE(errorToBool(MaybeSerializer.takeError()));
+  remarks::Remark R = makeRemark();
+  remarks::StringTable &StrTab = *(*MaybeSerializer)->StrTab;
+  for (StringRef Str : {R.RemarkName, R.PassName, R.FunctionName,
+                        R.Loc->SourceFilePath, R.Args[0].Key, R.Args[0].Val,
+                        R.Args[1].Key, R.Args[1].Val,
+                        R.Args[1].Loc->SourceFilePath})
+    StrTab.add(Str);
+  (*MaybeSerializer)->emit(R);
+  OS.flush();
+
+  LLVMRemarkParserRef Parser =
+      LLVMRemarkParserCreateBitstream(Buf.data(), Buf.size());
+  LLVMRemarkEntryRef Remark = LLVMRemarkParserGetNext(Parser);
+  ASSERT_TRUE(Remark != nullptr);
+  EXPECT_EQ(StringRef(LLVMRemarkStringGetData(
+                LLVMRemarkEntryGetPassName(Remark))),
+            "loop-vectorize");
+  EXPECT_EQ(LLVMRemarkEntryGetHotness(Remark), 4U);
+  EXPECT_EQ(LLVMRemarkEntryGetNumArgs(Remark), 2U);
+  LLVMRemarkEntryDispose(Remark);
+  EXPECT_EQ(LLVMRemarkParserGetNext(Parser), nullptr);
+  EXPECT_FALSE(LLVMRemarkParserHasError(Parser));
+  LLVMRemarkParserDispose(Parser);
+}
@@ -8,6 +8,9 @@
 
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -64,6 +67,15 @@ TEST(CachePruningPolicyParser, MaxSizeBytes) {
   EXPECT_EQ(4ull * 1024ull * 1024ull * 1024ull, P->MaxSizeBytes);
 }
 
+TEST(CachePruningPolicyParser, FullScanInterval) {
+  auto P = parseCachePruningPolicy("");
+  ASSERT_TRUE(bool(P));
+  EXPECT_FALSE(P->FullScanInterval.hasValue());
+  P = parseCachePruningPolicy("full_scan_interval=24h");
+  ASSERT_TRUE(bool(P));
+  EXPECT_EQ(std::chrono::hours(24), *P->FullScanInterval);
+}
+
 TEST(CachePruningPolicyParser, Multiple) {
   auto P = parseCachePruningPolicy("prune_after=1s:cache_size=50%");
   ASSERT_TRUE(bool(P));
@@ -94,3 +106,65 @@ TEST(CachePruningPolicyParser, Errors) {
   EXPECT_EQ("Unknown key: 'foo'",
             toString(parseCachePruningPolicy("foo=bar").takeError()));
 }
+
+// Tests that pruning with an index only prunes the files of the index between
+// full scans, using the times of last use recorded in the index.
+TEST(CachePruning, Index) {
+  using namespace std::chrono;
+  SmallString<128> Dir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("cache-pruning", Dir));
+  auto FilePath = [&](StringRef Name) {
+    SmallString<128> Path(Dir);
+    sys::path::append(Path, Name);
+    return Path;
+  };
+  auto CreateFile = [&](StringRef Name) {
+    std::error_code EC;
+    raw_fd_ostream OS(FilePath(Name), EC);
+    OS << "object";
+  };
+  auto Exists = [&](StringRef Name) {
+    return sys::fs::exists(FilePath(Name));
+  };
+
+  CachePruningPolicy Policy;
+  Policy.Interval = seconds(0);
+  Policy.Expiration = hours(1);
+  Policy.MaxSizePercentageOfAvailableSpace = 0;
+  Policy.MaxSizeFiles = 0;
+  Policy.FullScanInterval = hours(24);
+
+  // The first pruning scans the directory and creates the index.
+  CreateFile("llvmcache-a");
+  CreateFile("llvmcache-b");
+  EXPECT_TRUE(pruneCache(Dir, Policy));
+  EXPECT_TRUE(Exists("llvmcache-a"));
+  EXPECT_TRUE(Exists("llvmcache-b"));
+  EXPECT_TRUE(Exists("llvmcache.index"));
+
+  // An expired file that is only in the index is pruned, a file that is
+  // missing from the index is left for the next full scan. A file whose
+  // latest use is recent is kept.
+  CreateFile("llvmcache-c");
+  CreateFile("llvmcache-d");
+  recordCacheFileUse(Dir, "llvmcache-d", 6, system_clock::now() - hours(2));
+  recordCacheFileUse(Dir, "llvmcache-a", 6, system_clock::now() - hours(2));
+  recordCacheFileUse(Dir, "llvmcache-a", 6);
+  EXPECT_TRUE(pruneCache(Dir, Policy));
+  EXPECT_TRUE(Exists("llvmcache-a"));
+  EXPECT_TRUE(Exists("llvmcache-b"));
+  EXPECT_TRUE(Exists("llvmcache-c"));
+  EXPECT_FALSE(Exists("llvmcache-d"));
+
+  // A full scan picks up the files missing from the index.
+  Policy.FullScanInterval = seconds(0);
+  recordCacheFileUse(Dir, "llvmcache-c", 6, system_clock::now() - hours(2));
+  EXPECT_TRUE(pruneCache(Dir, Policy));
+  EXPECT_TRUE(Exists("llvmcache-c"));
+
+  for (StringRef Name : {"llvmcache-a", "llvmcache-b", "llvmcache-c",
+                         "llvmcache.index", "llvmcache.timestamp",
+                         "llvmcache.fullscan"})
+    sys::fs::remove(FilePath(Name));
+  sys::fs::remove(Dir);
+}
@@ -0,0 +1,118 @@
+//===- unittests/Support/CachingFileSystemTest.cpp ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CachingFileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+/// Counts the calls that reach the underlying file system.
+class CountingFileSystem : public vfs::ProxyFileSystem {
+public:
+  explicit CountingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    ++NumStatus;
+    return ProxyFileSystem::status(Path);
+  }
+  ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    ++NumOpen;
+    return ProxyFileSystem::openFileForRead(Path);
+  }
+
+  unsigned NumStatus = 0;
+  unsigned NumOpen = 0;
+};
+
+class CachingFileSystemTest : public ::testing::Test {
+protected:
+  CachingFileSystemTest()
+      : MemFS(new vfs::InMemoryFileSystem),
+        Counting(new CountingFileSystem(MemFS)) {
+    MemFS->addFile("/dir/a.h", 0, MemoryBuffer::getMemBuffer("int a;"));
+    MemFS->addFile("/dir/b.h", 0, MemoryBuffer::getMemBuffer("int a;"));
+    MemFS->addFile("/dir/c.h", 0, MemoryBuffer::getMemBuffer("int c;"));
+  }
+
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> MemFS;
+  IntrusiveRefCntPtr<CountingFileSystem> Counting;
+  vfs::SharedFileSystemCache Cache;
+};
+
+TEST_F(CachingFileSystemTest, SharesEntries) {
+  auto FS1 = vfs::createCachingFileSystem(Cache, Counting);
+  auto FS2 = vfs::createCachingFileSystem(Cache, Counting);
+
+  auto Buffer1 = FS1->getBufferForFile("/dir/a.h");
+  auto Buffer2 = FS2->getBufferForFile("/dir/a.h");
+  ASSERT_TRUE(Buffer1);
+  ASSERT_TRUE(Buffer2);
+  EXPECT_EQ("int a;", (*Buffer1)->getBuffer());
+  EXPECT_EQ((*Buffer1)->getBufferStart(), (*Buffer2)->getBufferStart());
+  EXPECT_EQ(1u, Counting->NumOpen);
+
+  auto Stat = FS2->status("/dir/a.h");
+  ASSERT_TRUE(Stat);
+  EXPECT_EQ(6u, Stat->getSize());
+  EXPECT_EQ(0u, Counting->NumStatus);
+}
+
+TEST_F(CachingFileSystemTest, CachesMissingFiles) {
+  auto FS1 = vfs::createCachingFileSystem(Cache, Counting);
+  auto FS2 = vfs::createCachingFileSystem(Cache, Counting);
+
+  EXPECT_FALSE(FS1->status("/dir/missing.h"));
+  EXPECT_FALSE(FS2->status("/dir/missing.h"));
+  EXPECT_EQ(1u, Counting->NumStatus);
+
+  EXPECT_FALSE(FS1->openFileForRead("/dir/missing.h"));
+  EXPECT_FALSE(FS2->openFileForRead("/dir/missing.h"));
+  EXPECT_EQ(1u, Counting->NumOpen);
+}
+
+TEST_F(CachingFileSystemTest, DeduplicatesContents) {
+  auto FS = vfs::createCachingFileSystem(Cache, Counting);
+
+  auto A = FS->getBufferForFile("/dir/a.h");
+  auto B = FS->getBufferForFile("/dir/b.h");
+  auto C = FS->getBufferForFile("/dir/c.h");
+  ASSERT_TRUE(A);
+  ASSERT_TRUE(B);
+  ASSERT_TRUE(C);
+  EXPECT_EQ((*A)->getBufferStart(), (*B)->getBufferStart());
+  EXPECT_NE((*A)->getBufferStart(), (*C)->getBufferStart());
+  EXPECT_EQ("int c;", (*C)->getBuffer());
+}
+
+TEST_F(CachingFileSystemTest, SeparateWorkingDirectories) {
+  MemFS->addFile("/other/a.h", 0, MemoryBuffer::getMemBuffer("int other;"));
+  auto FS1 = vfs::createCachingFileSystem(Cache, Counting);
+  auto FS2 = vfs::createCachingFileSystem(Cache, Counting);
+  ASSERT_FALSE(FS1->setCurrentWorkingDirectory("/dir"));
+  ASSERT_FALSE(FS2->setCurrentWorkingDirectory("/other"));
+  EXPECT_TRUE(FS1->setCurrentWorkingDirectory("/dir/a.h"));
+
+  auto Buffer1 = FS1->getBufferForFile("a.h");
+  auto Buffer2 = FS2->getBufferForFile("a.h");
+  ASSERT_TRUE(Buffer1);
+  ASSERT_TRUE(Buffer2);
+  EXPECT_EQ("int a;", (*Buffer1)->getBuffer());
+  EXPECT_EQ("int other;", (*Buffer2)->getBuffer());
+
+  auto Stat = FS1->status("a.h");
+  ASSERT_TRUE(Stat);
+  EXPECT_EQ("a.h", Stat->getName());
+  EXPECT_EQ("/dir", *FS1->getCurrentWorkingDirectory());
+}
+
+} // end anonymous namespace
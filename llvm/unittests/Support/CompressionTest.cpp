@@ -65,6 +65,36 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+void TestZlibParallelCompression(StringRef Input, int Level,
+                                 size_t BlockSize) {
+  SmallString<32> Compressed;
+  SmallString<32> Uncompressed;
+
+  Error E = zlib::compressParallel(Input, Compressed, Level, BlockSize);
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+
+  E = zlib::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
+TEST(CompressionTest, ZlibParallel) {
+  std::string Data;
+  for (size_t i = 0; i < 100000; ++i)
+    Data += std::to_string(i * i % 1237);
+
+  TestZlibParallelCompression("", zlib::DefaultCompression, 16);
+  TestZlibParallelCompression("hello, world!", zlib::DefaultCompression, 4);
+  for (size_t BlockSize : {1000, 4096, 65536, 1 << 20}) {
+    TestZlibParallelCompression(Data, zlib::NoCompression, BlockSize);
+    TestZlibParallelCompression(Data, zlib::BestSpeedCompression, BlockSize);
+    TestZlibParallelCompression(Data, zlib::DefaultCompression, BlockSize);
+    TestZlibParallelCompression(Data, zlib::BestSizeCompression, BlockSize);
+  }
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
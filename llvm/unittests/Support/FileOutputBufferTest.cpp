@@ -118,6 +118,38 @@ TEST(FileOutputBuffer, Test) {
   EXPECT_TRUE(IsExecutable);
   ASSERT_NO_ERROR(fs::remove(File4.str()));
 
+  // TEST 5: Verify streaming case.
+  SmallString<128> File5(TestDirectory);
+  File5.append("/file5");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File5, 8192, FileOutputBuffer::F_streaming);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memcpy(Buffer->getBufferStart() + 100, "AABBCCDDEEFFGGHHIIJJ", 20);
+    Buffer->flush(100, 20);
+    // Modify a range after it was flushed and flush it again.
+    memcpy(Buffer->getBufferStart() + 1000, "AABBCCDDEEFFGGHHIIJJ", 20);
+    Buffer->flush(1000, 20);
+    memcpy(Buffer->getBufferStart() + 1000, "KKLL", 4);
+    Buffer->flush(1000, 4);
+    // Leave the end of the buffer to commit().
+    memcpy(Buffer->getBufferEnd() - 20, "AABBCCDDEEFFGGHHIIJJ", 20);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(File5);
+    ASSERT_NO_ERROR(BufOrErr.getError());
+    StringRef Data = (*BufOrErr)->getBuffer();
+    ASSERT_EQ(Data.size(), 8192ULL);
+    EXPECT_EQ(Data.substr(100, 20), "AABBCCDDEEFFGGHHIIJJ");
+    EXPECT_EQ(Data.substr(1000, 20), "KKLLCCDDEEFFGGHHIIJJ");
+    EXPECT_EQ(Data.substr(8192 - 20), "AABBCCDDEEFFGGHHIIJJ");
+    EXPECT_EQ(Data[0], '\0');
+  }
+  ASSERT_NO_ERROR(fs::remove(File5.str()));
+
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
@@ -227,6 +227,55 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData2.substr(0x2FF8,8).equals("abcdefgh"));
 }
 
+TEST_F(MemoryBufferTest, dontNeedIfMmap) {
+  // Create a file large enough to be mapped rather than read.
+  int FD;
+  SmallString<64> TestPath;
+  sys::fs::createTemporaryFile("MemoryBufferTest_DontNeed", "temp", FD,
+                               TestPath);
+  FileRemover Cleanup(TestPath);
+  raw_fd_ostream OF(FD, true);
+  for (unsigned i = 0; i < 0x1000; ++i)
+    OF << "0123456789abcdef";
+  OF.close();
+
+  auto MBOrError = MemoryBuffer::getFile(TestPath, /*FileSize=*/-1,
+                                         /*RequiresNullTerminator=*/false);
+  ASSERT_FALSE(MBOrError.getError());
+  auto &MB = **MBOrError;
+  EXPECT_EQ(MemoryBuffer::MemoryBuffer_MMap, MB.getBufferKind());
+
+  // The contents must still be readable after the pages are discarded.
+  MB.dontNeedIfMmap();
+  ASSERT_EQ(0x10000u, MB.getBufferSize());
+  for (size_t i = 0; i < MB.getBufferSize(); i += 0x10)
+    EXPECT_EQ("0123456789abcdef", MB.getBuffer().substr(i, 0x10)) << "i: " << i;
+}
+
+TEST_F(MemoryBufferTest, getFileWithOptions) {
+  int FD;
+  SmallString<64> TestPath;
+  sys::fs::createTemporaryFile("MemoryBufferTest_Options", "temp", FD,
+                               TestPath);
+  FileRemover Cleanup(TestPath);
+  raw_fd_ostream OF(FD, true);
+  for (unsigned i = 0; i < 0x1000; ++i)
+    OF << "0123456789abcdef";
+  OF.close();
+
+  MemoryBufferOpenOptions Options;
+  Options.RequiresNullTerminator = false;
+  Options.Advice = sys::fs::mapped_file_region::willneed;
+  Options.HugePages = true;
+  auto MBOrError = MemoryBuffer::getFile(TestPath, Options);
+  ASSERT_FALSE(MBOrError.getError());
+  auto &MB = **MBOrError;
+  EXPECT_EQ(MemoryBuffer::MemoryBuffer_MMap, MB.getBufferKind());
+  ASSERT_EQ(0x10000u, MB.getBufferSize());
+  for (size_t i = 0; i < MB.getBufferSize(); i += 0x10)
+    EXPECT_EQ("0123456789abcdef", MB.getBuffer().substr(i, 0x10)) << "i: " << i;
+}
+
 TEST_F(MemoryBufferTest, writableSlice) {
   // Create a file initialized with some data
   int FD;
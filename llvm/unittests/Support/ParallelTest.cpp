@@ -14,7 +14,10 @@
 #include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 #include <array>
+#include <atomic>
 #include <random>
+#include <string>
+#include <vector>
 
 uint32_t array[1024 * 1024];
 
@@ -49,4 +52,39 @@ TEST(Parallel, parallel_for) {
   ASSERT_EQ(range[2049], 1u);
 }
 
+TEST(Parallel, nested_parallel_for) {
+  // Inner loops must not deadlock waiting for tasks that no thread is free to
+  // run, and must see all of their iterations executed.
+  std::atomic<size_t> count{0};
+  for_each_n(parallel::par, 0, 64, [&](size_t) {
+    for_each_n(parallel::par, 0, 4096, [&](size_t) { ++count; });
+  });
+  ASSERT_EQ(count, 64u * 4096u);
+}
+
+TEST(Parallel, transform_reduce) {
+  // Check that the results are the same as the sequential version.
+  std::vector<uint32_t> range(5000);
+  for (size_t I = 0; I < range.size(); ++I)
+    range[I] = I;
+  auto square = [](uint32_t V) { return uint64_t(V) * V; };
+  auto add = [](uint64_t A, uint64_t B) { return A + B; };
+  uint64_t seq = transform_reduce(parallel::seq, range.begin(), range.end(),
+                                  uint64_t(0), add, square);
+  uint64_t par = transform_reduce(parallel::par, range.begin(), range.end(),
+                                  uint64_t(0), add, square);
+  ASSERT_EQ(seq, par);
+  ASSERT_EQ(uint64_t(0),
+            transform_reduce(parallel::par, range.begin(), range.begin(),
+                             uint64_t(0), add, square));
+
+  // Reduce is only required to be associative, so the order must be kept.
+  std::vector<std::string> strs = {"a", "b", "c", "d", "e", "f"};
+  std::string joined = transform_reduce(
+      parallel::par, strs.begin(), strs.end(), std::string(),
+      [](std::string A, std::string B) { return A + B; },
+      [](const std::string &S) { return S; });
+  ASSERT_EQ("abcdef", joined);
+}
+
 #endif
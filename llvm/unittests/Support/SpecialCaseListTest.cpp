@@ -232,6 +232,28 @@ TEST_F(SpecialCaseListTest, PopularTrigram) {
   EXPECT_TRUE(SCL->inSection("", "fun", "aaaabbbaaa"));
 }
 
+TEST_F(SpecialCaseListTest, Wildcards) {
+  std::unique_ptr<SpecialCaseList> SCL = makeSpecialCaseList("fun:foo*\n"
+                                                             "fun:*bar\n"
+                                                             "fun:b.z\n"
+                                                             "fun:*o*o*\n"
+                                                             "fun:(qu|x)ux*\n"
+                                                             "fun:q*\n");
+  EXPECT_EQ(1u, SCL->inSectionBlame("", "fun", "foobar"));
+  EXPECT_EQ(1u, SCL->inSectionBlame("", "fun", "foo"));
+  EXPECT_EQ(2u, SCL->inSectionBlame("", "fun", "bar"));
+  EXPECT_EQ(2u, SCL->inSectionBlame("", "fun", "oobar"));
+  EXPECT_EQ(3u, SCL->inSectionBlame("", "fun", "baz"));
+  EXPECT_EQ(0u, SCL->inSectionBlame("", "fun", "bz"));
+  EXPECT_EQ(4u, SCL->inSectionBlame("", "fun", "zoo"));
+  EXPECT_EQ(4u, SCL->inSectionBlame("", "fun", "boa.o"));
+  EXPECT_EQ(0u, SCL->inSectionBlame("", "fun", "zo"));
+  EXPECT_EQ(5u, SCL->inSectionBlame("", "fun", "quux"));
+  EXPECT_EQ(5u, SCL->inSectionBlame("", "fun", "xux"));
+  EXPECT_EQ(6u, SCL->inSectionBlame("", "fun", "qux"));
+  EXPECT_EQ(0u, SCL->inSectionBlame("", "fun", "fo"));
+}
+
 TEST_F(SpecialCaseListTest, EscapedSymbols) {
   std::unique_ptr<SpecialCaseList> SCL = makeSpecialCaseList("src:*c\\+\\+abi*\n"
                                                              "src:*hello\\\\world*\n");
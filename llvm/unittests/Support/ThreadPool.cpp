@@ -163,3 +163,40 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, GroupWait) {
+  CHECK_UNSUPPORTED();
+  // Test that waiting for a group does not wait for the tasks of other groups.
+  ThreadPool Pool{2};
+  ThreadPoolTaskGroup Blocked(Pool);
+  ThreadPoolTaskGroup Group(Pool);
+  std::atomic_int checked_in{0};
+  Blocked.async([this] { waitForMainThread(); });
+  for (size_t i = 0; i < 5; ++i)
+    Group.async([&checked_in] { ++checked_in; });
+  Group.wait();
+  ASSERT_EQ(5, checked_in);
+  setMainThreadReady();
+  Blocked.wait();
+}
+
+TEST_F(ThreadPoolTest, BoundedQueue) {
+  CHECK_UNSUPPORTED();
+  // Test that tryAsync fails while the queue is full and that async waits for
+  // room in the queue.
+  ThreadPool Pool{1, 1};
+  std::atomic_int checked_in{0};
+  std::atomic_bool started{false};
+  Pool.async([this, &started] {
+    started = true;
+    waitForMainThread();
+  });
+  while (!started)
+    std::this_thread::yield();
+  ASSERT_TRUE(Pool.tryAsync([&checked_in] { ++checked_in; }).hasValue());
+  ASSERT_FALSE(Pool.tryAsync([&checked_in] { ++checked_in; }).hasValue());
+  setMainThreadReady();
+  Pool.async([&checked_in] { ++checked_in; });
+  Pool.wait();
+  ASSERT_EQ(2, checked_in);
+}
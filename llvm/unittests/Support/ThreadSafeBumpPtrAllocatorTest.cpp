@@ -0,0 +1,48 @@
+//===- ThreadSafeBumpPtrAllocatorTest.cpp ---------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadSafeBumpPtrAllocator.h"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <set>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ThreadSafeBumpPtrAllocatorTest, SingleThread) {
+  ThreadSafeBumpPtrAllocator Alloc;
+  uint64_t *A = Alloc.Allocate<uint64_t>(10);
+  uint64_t *B = Alloc.Allocate<uint64_t>(10);
+  EXPECT_NE(A, B);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(A) % alignof(uint64_t));
+  EXPECT_LE(160u, Alloc.getBytesAllocated());
+  EXPECT_LE(Alloc.getBytesAllocated(), Alloc.getTotalMemory());
+
+  Alloc.Reset();
+  EXPECT_EQ(0u, Alloc.getBytesAllocated());
+}
+
+// Allocations made concurrently from parallel algorithms must not overlap.
+TEST(ThreadSafeBumpPtrAllocatorTest, Parallel) {
+  ThreadSafeBumpPtrAllocator Alloc;
+  const size_t N = 100000;
+  std::vector<uint32_t *> Ptrs(N);
+  parallel::for_each_n(parallel::par, size_t(0), N, [&](size_t I) {
+    Ptrs[I] = Alloc.Allocate<uint32_t>();
+    *Ptrs[I] = I;
+  });
+
+  std::set<uint32_t *> Unique(Ptrs.begin(), Ptrs.end());
+  EXPECT_EQ(N, Unique.size());
+  for (size_t I = 0; I < N; ++I)
+    EXPECT_EQ(I, *Ptrs[I]);
+  EXPECT_LE(N * sizeof(uint32_t), Alloc.getBytesAllocated());
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+//===- unittests/Support/TimeProfilerTest.cpp - TimeProfiler tests --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Threading.h"
+#include "gtest/gtest.h"
+#include <set>
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+json::Value writeTrace() {
+  SmallString<1024> Buf;
+  raw_svector_ostream OS(Buf);
+  timeTraceProfilerWrite(OS);
+  timeTraceProfilerCleanup();
+  Expected<json::Value> V = json::parse(Buf);
+  EXPECT_TRUE(bool(V));
+  if (!V) {
+    consumeError(V.takeError());
+    return nullptr;
+  }
+  return std::move(*V);
+}
+
+// Returns the events of the trace named \p Name.
+std::vector<const json::Object *> getEvents(const json::Value &Trace,
+                                            StringRef Name) {
+  std::vector<const json::Object *> Result;
+  for (const json::Value &E : *Trace.getAsObject()->getArray("traceEvents")) {
+    const json::Object *O = E.getAsObject();
+    if (O->getString("name") == Name)
+      Result.push_back(O);
+  }
+  return Result;
+}
+
+TEST(TimeProfiler, Sections) {
+  timeTraceProfilerInitialize(0, "test");
+  EXPECT_TRUE(timeTraceProfilerEnabled());
+  {
+    TimeTraceScope Outer("Outer", StringRef("detail"));
+    for (int I = 0; I < 3; ++I) {
+      TimeTraceScope Inner("Inner");
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  json::Value Trace = writeTrace();
+  EXPECT_FALSE(timeTraceProfilerEnabled());
+
+  auto Outer = getEvents(Trace, "Outer");
+  ASSERT_EQ(1u, Outer.size());
+  EXPECT_EQ("X", *Outer[0]->getString("ph"));
+  EXPECT_EQ("detail",
+            *Outer[0]->getObject("args")->getString("detail"));
+  EXPECT_EQ(3u, getEvents(Trace, "Inner").size());
+
+  auto Total = getEvents(Trace, "Total Inner");
+  ASSERT_EQ(1u, Total.size());
+  EXPECT_EQ(3, *Total[0]->getObject("args")->getInteger("count"));
+
+  auto Proc = getEvents(Trace, "process_name");
+  ASSERT_EQ(1u, Proc.size());
+  EXPECT_EQ("test", *Proc[0]->getObject("args")->getString("name"));
+}
+
+TEST(TimeProfiler, Counters) {
+  timeTraceProfilerInitialize(0, "test");
+  timeTraceProfilerCounter("Memory", 10);
+  timeTraceProfilerCounter("Memory", 20);
+  json::Value Trace = writeTrace();
+
+  auto Counters = getEvents(Trace, "Memory");
+  ASSERT_EQ(2u, Counters.size());
+  EXPECT_EQ("C", *Counters[0]->getString("ph"));
+  EXPECT_EQ(10, *Counters[0]->getObject("args")->getInteger("Memory"));
+  EXPECT_EQ(20, *Counters[1]->getObject("args")->getInteger("Memory"));
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(TimeProfiler, Threads) {
+  timeTraceProfilerInitialize(0, "test");
+  std::vector<std::thread> Threads;
+  for (int I = 0; I < 4; ++I)
+    Threads.emplace_back([] {
+      timeTraceProfilerInitialize(0, "test");
+      {
+        TimeTraceScope Scope("Work");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      timeTraceProfilerFinishThread();
+      EXPECT_FALSE(timeTraceProfilerEnabled());
+    });
+  for (std::thread &T : Threads)
+    T.join();
+  json::Value Trace = writeTrace();
+
+  // Each thread gets its own track, and the totals add up all threads.
+  auto Work = getEvents(Trace, "Work");
+  ASSERT_EQ(4u, Work.size());
+  std::set<int64_t> Tids;
+  for (const json::Object *O : Work)
+    Tids.insert(*O->getInteger("tid"));
+  EXPECT_EQ(4u, Tids.size());
+
+  auto Total = getEvents(Trace, "Total Work");
+  ASSERT_EQ(1u, Total.size());
+  EXPECT_EQ(4, *Total[0]->getObject("args")->getInteger("count"));
+  EXPECT_EQ(5u, getEvents(Trace, "thread_name").size());
+}
+#endif
+
+} // namespace
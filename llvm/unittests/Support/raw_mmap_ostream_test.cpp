@@ -0,0 +1,118 @@
+//===- raw_mmap_ostream_test.cpp - raw_mmap_ostream tests -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_mmap_ostream.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::sys;
+
+namespace {
+
+class raw_mmap_ostreamTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(fs::createUniqueDirectory("raw_mmap_ostream", Dir));
+    path::append(Path, Dir, "file.out");
+  }
+
+  void TearDown() override {
+    fs::remove(Path);
+    fs::remove(Dir);
+  }
+
+  std::string readFile() {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buf = MemoryBuffer::getFile(Path);
+    if (!Buf)
+      return "<error>";
+    return (*Buf)->getBuffer();
+  }
+
+  SmallString<128> Dir;
+  SmallString<128> Path;
+};
+
+TEST_F(raw_mmap_ostreamTest, Commit) {
+  Expected<std::unique_ptr<raw_mmap_ostream>> OSOrErr =
+      raw_mmap_ostream::create(Path, 16);
+  ASSERT_THAT_EXPECTED(OSOrErr, Succeeded());
+  raw_mmap_ostream &OS = **OSOrErr;
+  OS << "abcd";
+  EXPECT_EQ(4u, OS.tell());
+  OS.pwrite("x", 1, 1);
+  ASSERT_THAT_ERROR(OS.commit(), Succeeded());
+  EXPECT_EQ("axcd", readFile());
+}
+
+TEST_F(raw_mmap_ostreamTest, WrittenData) {
+  Expected<std::unique_ptr<raw_mmap_ostream>> OSOrErr =
+      raw_mmap_ostream::create(Path);
+  ASSERT_THAT_EXPECTED(OSOrErr, Succeeded());
+  raw_mmap_ostream &OS = **OSOrErr;
+  OS << "abcd";
+  MutableArrayRef<char> Data = OS.getWrittenData();
+  ASSERT_EQ(4u, Data.size());
+  EXPECT_EQ("abcd", StringRef(Data.data(), Data.size()));
+  Data[2] = 'x';
+  OS << "ef";
+  ASSERT_THAT_ERROR(OS.commit(), Succeeded());
+  EXPECT_EQ("abxdef", readFile());
+}
+
+// Write more than the initial mapping, both through the buffer and as large
+// strings, so that the file is grown and remapped.
+TEST_F(raw_mmap_ostreamTest, Grow) {
+  std::string Want;
+  {
+    auto OSOrErr = raw_mmap_ostream::create(Path);
+    ASSERT_THAT_EXPECTED(OSOrErr, Succeeded());
+    raw_mmap_ostream &OS = **OSOrErr;
+    std::string Large(3 * 1024 * 1024 + 7, 'x');
+    for (int I = 0; I < 100000; ++I) {
+      OS << I << ' ';
+      Want += std::to_string(I) + ' ';
+    }
+    OS << Large;
+    Want += Large;
+    for (int I = 0; I < 100000; ++I) {
+      OS << I;
+      Want += std::to_string(I);
+    }
+    EXPECT_EQ(Want.size(), OS.tell());
+    OS.pwrite("y", 1, 0);
+    Want[0] = 'y';
+    ASSERT_THAT_ERROR(OS.commit(), Succeeded());
+  }
+  EXPECT_EQ(Want, readFile());
+}
+
+TEST_F(raw_mmap_ostreamTest, Discard) {
+  {
+    auto OSOrErr = raw_mmap_ostream::create(Path);
+    ASSERT_THAT_EXPECTED(OSOrErr, Succeeded());
+    **OSOrErr << "abcd";
+  }
+  EXPECT_FALSE(fs::exists(Path));
+
+  // Only the output file should ever exist in the directory.
+  std::error_code EC;
+  fs::directory_iterator I(Dir, EC);
+  EXPECT_FALSE(EC);
+  EXPECT_EQ(fs::directory_iterator(), I);
+}
+
+TEST_F(raw_mmap_ostreamTest, Directory) {
+  EXPECT_THAT_EXPECTED(raw_mmap_ostream::create(Dir), Failed());
+}
+
+} // end anonymous namespace
@@ -9,6 +9,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -127,6 +128,17 @@ TEST(raw_ostreamTest, TinyBuffer) {
   EXPECT_EQ("hello1world", OS.str());
 }
 
+// A string larger than the buffer written after buffered bytes bypasses the
+// buffer.
+TEST(raw_ostreamTest, LargeWriteAfterBufferedBytes) {
+  std::string Str;
+  raw_string_ostream OS(Str);
+  OS.SetBufferSize(16);
+  std::string Large(100, 'x');
+  OS << "abc" << Large << "def" << Large;
+  EXPECT_EQ("abc" + Large + "def" + Large, OS.str());
+}
+
 TEST(raw_ostreamTest, WriteEscaped) {
   std::string Str;
 
@@ -336,6 +348,24 @@ TEST(raw_ostreamTest, FormattedHexBytes) {
             format_bytes_with_ascii_str(B.take_front(12), 0, 7, 1));
 }
 
+TEST(raw_fd_ostreamTest, LargeWriteAfterBufferedBytes) {
+  int FD;
+  SmallString<64> Path;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("raw_fd_ostream", "", FD, Path));
+  std::string Large(100000, 'x');
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.SetBufferSize(64);
+    OS << "abc" << Large << "def";
+    EXPECT_EQ(Large.size() + 6, OS.tell());
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(Buf));
+  EXPECT_EQ("abc" + Large + "def", (*Buf)->getBuffer());
+  sys::fs::remove(Path);
+}
+
 TEST(raw_fd_ostreamTest, multiple_raw_fd_ostream_to_stdout) {
   std::error_code EC;
 
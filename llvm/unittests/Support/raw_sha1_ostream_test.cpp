@@ -10,6 +10,7 @@
 #include "llvm/Support/raw_sha1_ostream.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <string>
 
 using namespace llvm;
@@ -43,6 +44,21 @@ TEST(sha1_hash_test, Basic) {
   ASSERT_EQ("2EF7BDE608CE5404E97D5F042F95F89F1C232871", Hash);
 }
 
+// An input of many blocks, hashed in one piece and in pieces that do not
+// line up with the blocks.
+TEST(sha1_hash_test, MultipleBlocks) {
+  std::string Input(1000000, 'a');
+  ArrayRef<uint8_t> Data((const uint8_t *)Input.data(), Input.size());
+  std::array<uint8_t, 20> Vec = SHA1::hash(Data);
+  ASSERT_EQ("34AA973CD4C4DAA4F61EEB2BDBAD27316534016F",
+            toHex({(const char *)Vec.data(), 20}));
+
+  SHA1 Hash;
+  for (size_t I = 0, N = 1; I < Data.size(); I += N, N = N * 3 % 1000 + 1)
+    Hash.update(Data.slice(I, std::min(N, Data.size() - I)));
+  ASSERT_EQ("34AA973CD4C4DAA4F61EEB2BDBAD27316534016F", toHex(Hash.final()));
+}
+
 // Check that getting the intermediate hash in the middle of the stream does
 // not invalidate the final result.
 TEST(raw_sha1_ostreamTest, Intermediate) {
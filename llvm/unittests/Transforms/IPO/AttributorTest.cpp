@@ -0,0 +1,162 @@
+//===- AttributorTest.cpp - Unit tests for the Attributor -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/Attributor.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class AttributorTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+
+  /// Parse IR and run the Attributor on it. Return true if the module changed.
+  bool runAttributor(StringRef IR) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("AttributorTest", errs());
+    assert(M && "Could not parse module");
+
+    ModuleAnalysisManager MAM;
+    PreservedAnalyses PA = AttributorPass().run(*M, MAM);
+    EXPECT_FALSE(verifyModule(*M, &errs()));
+    return !PA.areAllPreserved();
+  }
+
+  bool paramHasAttr(StringRef FnName, unsigned ArgNo,
+                    Attribute::AttrKind Kind) {
+    return M->getFunction(FnName)->hasParamAttribute(ArgNo, Kind);
+  }
+
+  /// Return the first call in function \p FnName.
+  CallInst *getFirstCall(StringRef FnName) {
+    for (BasicBlock &BB : *M->getFunction(FnName))
+      for (Instruction &I : BB)
+        if (auto *CI = dyn_cast<CallInst>(&I))
+          return CI;
+    return nullptr;
+  }
+};
+
+TEST_F(AttributorTest, NoAliasArgumentFromAlloca) {
+  EXPECT_TRUE(runAttributor(
+      "define internal void @callee(i32* nocapture %p) {\n"
+      "  store i32 0, i32* %p\n"
+      "  ret void\n"
+      "}\n"
+      "define i32 @caller() {\n"
+      "  %a = alloca i32\n"
+      "  store i32 1, i32* %a\n"
+      "  call void @callee(i32* %a)\n"
+      "  %v = load i32, i32* %a\n"
+      "  ret i32 %v\n"
+      "}\n"));
+  EXPECT_TRUE(paramHasAttr("callee", 0, Attribute::NoAlias));
+  EXPECT_TRUE(getFirstCall("caller")->paramHasAttr(0, Attribute::NoAlias));
+}
+
+TEST_F(AttributorTest, NoAliasArgumentThroughCallChain) {
+  // The noalias argument of @middle is passed on to @leaf.
+  runAttributor("define internal void @leaf(i32* nocapture %p) {\n"
+                "  store i32 0, i32* %p\n"
+                "  ret void\n"
+                "}\n"
+                "define internal void @middle(i32* nocapture %p) {\n"
+                "  call void @leaf(i32* %p)\n"
+                "  ret void\n"
+                "}\n"
+                "define void @root() {\n"
+                "  %a = alloca i32\n"
+                "  call void @middle(i32* %a)\n"
+                "  ret void\n"
+                "}\n");
+  EXPECT_TRUE(paramHasAttr("middle", 0, Attribute::NoAlias));
+  EXPECT_TRUE(paramHasAttr("leaf", 0, Attribute::NoAlias));
+}
+
+TEST_F(AttributorTest, NoNoAliasForEscapingOrRepeatedArgument) {
+  runAttributor("@g = global i32* null\n"
+                "define internal void @one(i32* nocapture %p) {\n"
+                "  store i32 0, i32* %p\n"
+                "  ret void\n"
+                "}\n"
+                "define internal void @two(i32* nocapture %p,\n"
+                "                          i32* nocapture %q) {\n"
+                "  store i32 0, i32* %p\n"
+                "  store i32 1, i32* %q\n"
+                "  ret void\n"
+                "}\n"
+                "define internal void @capturing(i32* %p) {\n"
+                "  store i32* %p, i32** @g\n"
+                "  ret void\n"
+                "}\n"
+                "define void @caller() {\n"
+                "  %a = alloca i32\n"
+                "  store i32* %a, i32** @g\n"
+                "  call void @one(i32* %a)\n"
+                "  %b = alloca i32\n"
+                "  call void @two(i32* %b, i32* %b)\n"
+                "  %c = alloca i32\n"
+                "  call void @capturing(i32* %c)\n"
+                "  ret void\n"
+                "}\n");
+  EXPECT_FALSE(paramHasAttr("one", 0, Attribute::NoAlias));
+  EXPECT_FALSE(paramHasAttr("two", 0, Attribute::NoAlias));
+  EXPECT_FALSE(paramHasAttr("two", 1, Attribute::NoAlias));
+  EXPECT_FALSE(paramHasAttr("capturing", 0, Attribute::NoAlias));
+}
+
+TEST_F(AttributorTest, UpdateBudgetKeepsResultsSound) {
+  auto *MaxUpdates = static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["attributor-max-updates-per-aa"]);
+  ASSERT_TRUE(MaxUpdates);
+  unsigned OldMaxUpdates = *MaxUpdates;
+  MaxUpdates->setValue(1);
+
+  // The optimistic nonnull assumption for @a and @b is only invalidated after
+  // @c was updated. With a budget of a single update per abstract attribute
+  // the iteration stops before @a and @b are revisited, so they have to be
+  // reverted instead of being manifested.
+  runAttributor("declare i32* @unknown()\n"
+                "define internal i32* @a() {\n"
+                "  %r = call i32* @b()\n"
+                "  ret i32* %r\n"
+                "}\n"
+                "define internal i32* @b() {\n"
+                "  %r = call i32* @c()\n"
+                "  ret i32* %r\n"
+                "}\n"
+                "define internal i32* @c() {\n"
+                "  %r = call i32* @unknown()\n"
+                "  ret i32* %r\n"
+                "}\n"
+                "define i32* @root() {\n"
+                "  %r = call i32* @a()\n"
+                "  ret i32* %r\n"
+                "}\n");
+  MaxUpdates->setValue(OldMaxUpdates);
+
+  for (StringRef Name : {"a", "b", "c"})
+    EXPECT_FALSE(M->getFunction(Name)->getAttributes().hasAttribute(
+        AttributeList::ReturnIndex, Attribute::NonNull))
+        << Name;
+}
+
+} // end anonymous namespace
@@ -0,0 +1,127 @@
+//===- HotColdSplittingTest.cpp - Unit tests for hot/cold splitting -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Transforms/IPO.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class HotColdSplittingTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+
+  /// Parse IR and run hot/cold splitting on it. Return true if the module
+  /// changed.
+  bool runHotColdSplitting(StringRef IR) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("HotColdSplittingTest", errs());
+    assert(M && "Could not parse module");
+
+    legacy::PassManager PM;
+    PM.add(createHotColdSplittingPass());
+    bool Changed = PM.run(*M);
+    EXPECT_FALSE(verifyModule(*M, &errs()));
+    return Changed;
+  }
+
+  /// Return the function the cold code of \p FnName was split into, if any.
+  Function *getSplitFunction(StringRef FnName) {
+    return M->getFunction((FnName + ".cold.1").str());
+  }
+};
+
+TEST_F(HotColdSplittingTest, SplitFunctionIsUnlikely) {
+  EXPECT_TRUE(runHotColdSplitting("declare void @sink() cold\n"
+                                  "define void @f(i32 %cond) {\n"
+                                  "entry:\n"
+                                  "  %c = icmp eq i32 %cond, 0\n"
+                                  "  br i1 %c, label %cold, label %exit\n"
+                                  "cold:\n"
+                                  "  call void @sink()\n"
+                                  "  call void @sink()\n"
+                                  "  call void @sink()\n"
+                                  "  unreachable\n"
+                                  "exit:\n"
+                                  "  ret void\n"
+                                  "}\n"));
+  Function *Split = getSplitFunction("f");
+  ASSERT_TRUE(Split);
+  EXPECT_TRUE(Split->hasFnAttribute(Attribute::Cold));
+  ASSERT_TRUE(Split->getSectionPrefix().hasValue());
+  EXPECT_EQ(".unlikely", *Split->getSectionPrefix());
+  EXPECT_FALSE(M->getFunction("f")->getSectionPrefix().hasValue());
+}
+
+static const char *SampleProfileIR =
+    "declare void @g(i32)\n"
+    "define void @f(i32 %x) !prof !20 {\n"
+    "entry:\n"
+    "  %c = icmp eq i32 %x, 0\n"
+    "  br i1 %c, label %likely, label %rare, !prof !21\n"
+    "rare:\n"
+    "  call void @g(i32 1)\n"
+    "  call void @g(i32 2)\n"
+    "  call void @g(i32 3)\n"
+    "  call void @g(i32 4)\n"
+    "  unreachable\n"
+    "likely:\n"
+    "  ret void\n"
+    "}\n"
+    "!20 = !{!\"function_entry_count\", i64 400}\n"
+    "!21 = !{!\"branch_weights\", i32 64, i32 4}\n"
+    "!llvm.module.flags = !{!1}\n"
+    "!1 = !{i32 1, !\"ProfileSummary\", !2}\n"
+    "!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}\n"
+    "!3 = !{!\"ProfileFormat\", !\"SampleProfile\"}\n"
+    "!4 = !{!\"TotalCount\", i64 10000}\n"
+    "!5 = !{!\"MaxCount\", i64 10}\n"
+    "!6 = !{!\"MaxInternalCount\", i64 1}\n"
+    "!7 = !{!\"MaxFunctionCount\", i64 1000}\n"
+    "!8 = !{!\"NumCounts\", i64 3}\n"
+    "!9 = !{!\"NumFunctions\", i64 3}\n"
+    "!10 = !{!\"DetailedSummary\", !11}\n"
+    "!11 = !{!12, !13, !14}\n"
+    "!12 = !{i32 10000, i64 1000, i32 1}\n"
+    "!13 = !{i32 999000, i64 300, i32 3}\n"
+    "!14 = !{i32 999999, i64 5, i32 10}\n";
+
+TEST_F(HotColdSplittingTest, ColdPercentileCutoff) {
+  auto *Cutoff = static_cast<cl::opt<int> *>(
+      cl::getRegisteredOptions()["hotcoldsplit-cold-percentile"]);
+  ASSERT_TRUE(Cutoff);
+
+  // With the default cold cutoff a block has to run at most 5 times to be
+  // cold, which the rare block (~23 runs) doesn't.
+  EXPECT_FALSE(runHotColdSplitting(SampleProfileIR));
+  EXPECT_FALSE(getSplitFunction("f"));
+
+  // Lowering the cutoff raises the cold count threshold to 300.
+  Cutoff->setValue(999000);
+  EXPECT_TRUE(runHotColdSplitting(SampleProfileIR));
+  Cutoff->setValue(0);
+  Function *Split = getSplitFunction("f");
+  ASSERT_TRUE(Split);
+  ASSERT_TRUE(Split->getEntryCount().hasValue());
+  EXPECT_EQ(0u, Split->getEntryCount().getCount());
+  EXPECT_EQ(".unlikely", *Split->getSectionPrefix());
+}
+
+} // end anonymous namespace
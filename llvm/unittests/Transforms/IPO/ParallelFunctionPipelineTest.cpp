@@ -0,0 +1,125 @@
+//===- ParallelFunctionPipelineTest.cpp - Unit tests for parallel passes --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/ParallelFunctionPipeline.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+#include <mutex>
+
+using namespace llvm;
+
+namespace {
+
+std::unique_ptr<Module> parseIR(LLVMContext &C, const char *IR) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(IR, Err, C);
+  if (!M)
+    Err.print("ParallelFunctionPipelineTest", errs());
+  return M;
+}
+
+const char *const TestIR = R"(
+  @0 = internal global i32 1
+  @p = global void ()* @b
+
+  define internal i32 @local() {
+    %v = load i32, i32* @0
+    ret i32 %v
+  }
+
+  define i32 @a() {
+    %v = call i32 @local()
+    %w = add i32 %v, 1
+    ret i32 %w
+  }
+
+  define void @b() {
+    %v = call i32 @a()
+    call void @ext(i32 %v)
+    ret void
+  }
+
+  define linkonce_odr void @unused() {
+    ret void
+  }
+
+  declare void @ext(i32)
+
+  !llvm.ident = !{!0}
+  !0 = !{!"ident"}
+)";
+
+TEST(ParallelFunctionPipelineTest, RunsOnPartitions) {
+  LLVMContext C;
+  std::unique_ptr<Module> M = parseIR(C, TestIR);
+  ASSERT_TRUE(M);
+
+  std::mutex Mutex;
+  unsigned NumCalls = 0;
+  unsigned NumDefinitions = 0;
+  ParallelFunctionPipelinePass Pass(2, [&](Module &Part) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    EXPECT_NE(&C, &Part.getContext());
+    ++NumCalls;
+    for (Function &F : Part) {
+      if (F.isDeclaration())
+        continue;
+      F.addFnAttr("optimized");
+      ++NumDefinitions;
+    }
+  });
+  ModuleAnalysisManager MAM;
+  Pass.run(*M, MAM);
+
+  EXPECT_EQ(2u, NumCalls);
+  EXPECT_EQ(4u, NumDefinitions);
+  EXPECT_FALSE(verifyModule(*M, &errs()));
+
+  for (const char *Name : {"local", "a", "b", "unused"}) {
+    Function *F = M->getFunction(Name);
+    ASSERT_TRUE(F) << Name;
+    EXPECT_FALSE(F->isDeclaration()) << Name;
+    EXPECT_TRUE(F->hasFnAttribute("optimized")) << Name;
+  }
+  EXPECT_TRUE(M->getFunction("local")->hasInternalLinkage());
+  EXPECT_TRUE(M->getFunction("unused")->hasLinkOnceODRLinkage());
+  EXPECT_TRUE(M->getFunction("ext")->isDeclaration());
+
+  // The unnamed variable keeps its linkage and stays unnamed.
+  ASSERT_EQ(2u, M->getGlobalList().size());
+  GlobalVariable *Unnamed = nullptr;
+  for (GlobalVariable &GV : M->globals())
+    if (GV.getName() != "p")
+      Unnamed = &GV;
+  ASSERT_TRUE(Unnamed);
+  EXPECT_FALSE(Unnamed->hasName());
+  EXPECT_TRUE(Unnamed->hasInternalLinkage());
+  EXPECT_EQ(M->getFunction("b"),
+            M->getNamedGlobal("p")->getInitializer()->stripPointerCasts());
+
+  // Named metadata is not duplicated by linking the partitions.
+  EXPECT_EQ(1u, M->getNamedMetadata("llvm.ident")->getNumOperands());
+}
+
+TEST(ParallelFunctionPipelineTest, SinglePartition) {
+  LLVMContext C;
+  std::unique_ptr<Module> M = parseIR(C, TestIR);
+  ASSERT_TRUE(M);
+
+  Module *Seen = nullptr;
+  ParallelFunctionPipelinePass Pass(1, [&](Module &Part) { Seen = &Part; });
+  ModuleAnalysisManager MAM;
+  Pass.run(*M, MAM);
+  EXPECT_EQ(M.get(), Seen);
+}
+
+} // end anonymous namespace
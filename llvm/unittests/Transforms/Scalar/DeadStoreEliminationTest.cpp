@@ -0,0 +1,196 @@
+//===- DeadStoreEliminationTest.cpp - DSE unit tests ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/DeadStoreElimination.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/PhiValues.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class DSEMemorySSATest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  cl::opt<bool> *EnableMemorySSA = nullptr;
+
+  void SetUp() override {
+    EnableMemorySSA = static_cast<cl::opt<bool> *>(
+        cl::getRegisteredOptions()["enable-dse-memoryssa"]);
+    ASSERT_TRUE(EnableMemorySSA);
+    EnableMemorySSA->setValue(true);
+  }
+
+  void TearDown() override { EnableMemorySSA->setValue(false); }
+
+  /// Parse IR and run DSE on function @f, checking that MemorySSA is still
+  /// valid afterwards.
+  Function &runDSE(StringRef IR) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("DeadStoreEliminationTest", errs());
+    assert(M && "Could not parse module");
+    Function &F = *M->getFunction("f");
+
+    FunctionAnalysisManager FAM;
+    FAM.registerPass([] {
+      AAManager AA;
+      AA.registerFunctionAnalysis<BasicAA>();
+      return AA;
+    });
+    FAM.registerPass([] { return AssumptionAnalysis(); });
+    FAM.registerPass([] { return BasicAA(); });
+    FAM.registerPass([] { return DominatorTreeAnalysis(); });
+    FAM.registerPass([] { return LoopAnalysis(); });
+    FAM.registerPass([] { return MemorySSAAnalysis(); });
+    FAM.registerPass([] { return PassInstrumentationAnalysis(); });
+    FAM.registerPass([] { return PhiValuesAnalysis(); });
+    FAM.registerPass([] { return PostDominatorTreeAnalysis(); });
+    FAM.registerPass([] { return TargetLibraryAnalysis(); });
+    DSEPass DSE;
+    PreservedAnalyses PA = DSE.run(F, FAM);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+    if (PA.getChecker<MemorySSAAnalysis>().preserved())
+      FAM.getResult<MemorySSAAnalysis>(F).getMSSA().verifyMemorySSA();
+    return F;
+  }
+
+  static unsigned countStores(Function &F) {
+    unsigned N = 0;
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB)
+        N += isa<StoreInst>(I) || isa<MemIntrinsic>(I);
+    return N;
+  }
+};
+
+TEST_F(DSEMemorySSATest, CrossBlock) {
+  // The first store is overwritten on both paths.
+  Function &F = runDSE("define void @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br i1 %c, label %a, label %b\n"
+                       "a:\n"
+                       "  br label %exit\n"
+                       "b:\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  store i32 2, i32* %p\n"
+                       "  ret void\n"
+                       "}\n");
+  EXPECT_EQ(1u, countStores(F));
+}
+
+TEST_F(DSEMemorySSATest, NotOnAllPaths) {
+  Function &F = runDSE("define void @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br i1 %c, label %a, label %exit\n"
+                       "a:\n"
+                       "  store i32 2, i32* %p\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  ret void\n"
+                       "}\n");
+  EXPECT_EQ(2u, countStores(F));
+}
+
+TEST_F(DSEMemorySSATest, ReadInBetween) {
+  Function &F = runDSE("define i32 @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br i1 %c, label %a, label %exit\n"
+                       "a:\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  %r = phi i32 [ %v, %a ], [ 0, %entry ]\n"
+                       "  store i32 2, i32* %p\n"
+                       "  ret i32 %r\n"
+                       "}\n");
+  EXPECT_EQ(2u, countStores(F));
+}
+
+TEST_F(DSEMemorySSATest, StoreInLoop) {
+  // %q changes on every iteration, so the store in the loop is only
+  // overwritten on the last one.
+  Function &F = runDSE("define void @f(i32* %p, i32 %n) {\n"
+                       "entry:\n"
+                       "  br label %loop\n"
+                       "loop:\n"
+                       "  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]\n"
+                       "  %q = getelementptr i32, i32* %p, i32 %i\n"
+                       "  store i32 1, i32* %q\n"
+                       "  %i.next = add i32 %i, 1\n"
+                       "  %c = icmp slt i32 %i.next, %n\n"
+                       "  br i1 %c, label %loop, label %exit\n"
+                       "exit:\n"
+                       "  store i32 2, i32* %q\n"
+                       "  ret void\n"
+                       "}\n");
+  EXPECT_EQ(2u, countStores(F));
+}
+
+TEST_F(DSEMemorySSATest, MayThrowInBetween) {
+  Function &F = runDSE("declare void @g()\n"
+                       "define void @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br i1 %c, label %a, label %exit\n"
+                       "a:\n"
+                       "  call void @g() readnone\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  store i32 2, i32* %p\n"
+                       "  ret void\n"
+                       "}\n");
+  EXPECT_EQ(2u, countStores(F));
+}
+
+TEST_F(DSEMemorySSATest, UnreadAlloca) {
+  // Stores to a local that is only read on one path. Only the one that is
+  // never read again is dead.
+  Function &F = runDSE("declare void @use(i32*)\n"
+                       "define void @f(i1 %c) {\n"
+                       "entry:\n"
+                       "  %a = alloca i32\n"
+                       "  store i32 1, i32* %a\n"
+                       "  br i1 %c, label %read, label %exit\n"
+                       "read:\n"
+                       "  call void @use(i32* %a)\n"
+                       "  store i32 2, i32* %a\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  ret void\n"
+                       "}\n");
+  EXPECT_EQ(1u, countStores(F));
+  auto *SI = cast<StoreInst>(&*F.getEntryBlock().getFirstInsertionPt()
+                                   ->getNextNode());
+  EXPECT_EQ(1, cast<ConstantInt>(SI->getValueOperand())->getSExtValue());
+}
+
+} // end anonymous namespace
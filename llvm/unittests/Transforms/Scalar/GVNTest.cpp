@@ -0,0 +1,228 @@
+//===- GVNTest.cpp - GVN unit tests ---------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/PhiValues.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class GVNMemorySSATest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  cl::opt<bool> *EnableMemorySSA = nullptr;
+
+  void SetUp() override {
+    EnableMemorySSA = static_cast<cl::opt<bool> *>(
+        cl::getRegisteredOptions()["enable-gvn-memoryssa"]);
+    ASSERT_TRUE(EnableMemorySSA);
+    EnableMemorySSA->setValue(true);
+  }
+
+  void TearDown() override { EnableMemorySSA->setValue(false); }
+
+  /// Parse IR and run GVN on function @f, checking that MemorySSA is still
+  /// valid afterwards.
+  Function &runGVN(StringRef IR) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("GVNTest", errs());
+    assert(M && "Could not parse module");
+    Function &F = *M->getFunction("f");
+
+    FunctionAnalysisManager FAM;
+    FAM.registerPass([] {
+      AAManager AA;
+      AA.registerFunctionAnalysis<BasicAA>();
+      return AA;
+    });
+    FAM.registerPass([] { return AssumptionAnalysis(); });
+    FAM.registerPass([] { return BasicAA(); });
+    FAM.registerPass([] { return DominatorTreeAnalysis(); });
+    FAM.registerPass([] { return LoopAnalysis(); });
+    FAM.registerPass([] { return MemoryDependenceAnalysis(); });
+    FAM.registerPass([] { return MemorySSAAnalysis(); });
+    FAM.registerPass([] { return OptimizationRemarkEmitterAnalysis(); });
+    FAM.registerPass([] { return PassInstrumentationAnalysis(); });
+    FAM.registerPass([] { return PhiValuesAnalysis(); });
+    FAM.registerPass([] { return TargetLibraryAnalysis(); });
+    GVN G;
+    PreservedAnalyses PA = G.run(F, FAM);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+    if (PA.getChecker<MemorySSAAnalysis>().preserved())
+      FAM.getResult<MemorySSAAnalysis>(F).getMSSA().verifyMemorySSA();
+    return F;
+  }
+
+  static unsigned countLoads(Function &F) {
+    unsigned N = 0;
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB)
+        N += isa<LoadInst>(I);
+    return N;
+  }
+
+  static Value *getReturnValue(Function &F) {
+    for (BasicBlock &BB : F)
+      if (auto *RI = dyn_cast<ReturnInst>(BB.getTerminator()))
+        return RI->getReturnValue();
+    return nullptr;
+  }
+};
+
+TEST_F(GVNMemorySSATest, LocalStore) {
+  Function &F = runGVN("define i32 @f(i32* %p, i32 %x) {\n"
+                       "  store i32 %x, i32* %p\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  ret i32 %v\n"
+                       "}\n");
+  EXPECT_EQ(0u, countLoads(F));
+  EXPECT_EQ(F.getArg(1), getReturnValue(F));
+}
+
+TEST_F(GVNMemorySSATest, StoresOnAllPaths) {
+  Function &F = runGVN("define i32 @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  br i1 %c, label %a, label %b\n"
+                       "a:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br label %exit\n"
+                       "b:\n"
+                       "  store i32 2, i32* %p\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  ret i32 %v\n"
+                       "}\n");
+  EXPECT_EQ(0u, countLoads(F));
+  EXPECT_TRUE(isa<PHINode>(getReturnValue(F)));
+}
+
+TEST_F(GVNMemorySSATest, DominatingLoad) {
+  // The store in %a does not alias %p, so the second load reads the same
+  // value as the first.
+  Function &F = runGVN("define i32 @f(i32* noalias %p, i32* noalias %q,\n"
+                       "              i1 %c) {\n"
+                       "entry:\n"
+                       "  %v0 = load i32, i32* %p\n"
+                       "  br i1 %c, label %a, label %exit\n"
+                       "a:\n"
+                       "  store i32 0, i32* %q\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  %v1 = load i32, i32* %p\n"
+                       "  %r = add i32 %v0, %v1\n"
+                       "  ret i32 %r\n"
+                       "}\n");
+  EXPECT_EQ(1u, countLoads(F));
+  auto *Add = cast<BinaryOperator>(getReturnValue(F));
+  EXPECT_EQ(Add->getOperand(0), Add->getOperand(1));
+}
+
+TEST_F(GVNMemorySSATest, LoadPRE) {
+  // The load is available on one path and clobbered on the other, so it is
+  // moved into the clobbered predecessor.
+  Function &F = runGVN("declare void @g()\n"
+                       "define i32 @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  br i1 %c, label %a, label %b\n"
+                       "a:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br label %exit\n"
+                       "b:\n"
+                       "  call void @g()\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  ret i32 %v\n"
+                       "}\n");
+  EXPECT_EQ(1u, countLoads(F));
+  EXPECT_TRUE(isa<PHINode>(getReturnValue(F)));
+  for (BasicBlock &BB : F)
+    for (Instruction &I : BB)
+      if (isa<LoadInst>(I))
+        EXPECT_EQ("b", BB.getName());
+}
+
+TEST_F(GVNMemorySSATest, LoadPRECriticalEdge) {
+  // Placing the load on the critical edge from %entry to %exit splits it.
+  Function &F = runGVN("define i32 @f(i32* %p, i1 %c) {\n"
+                       "entry:\n"
+                       "  br i1 %c, label %a, label %exit\n"
+                       "a:\n"
+                       "  store i32 1, i32* %p\n"
+                       "  br label %exit\n"
+                       "exit:\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  ret i32 %v\n"
+                       "}\n");
+  EXPECT_EQ(1u, countLoads(F));
+  EXPECT_EQ(4u, F.size());
+}
+
+TEST_F(GVNMemorySSATest, LoopVariantAddress) {
+  // The load reads the element of the current iteration, not the one the
+  // previous iteration stored to.
+  Function &F = runGVN("define void @f(i32* %base, i64 %n) {\n"
+                       "entry:\n"
+                       "  br label %loop\n"
+                       "loop:\n"
+                       "  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]\n"
+                       "  br label %body\n"
+                       "body:\n"
+                       "  %p = getelementptr i32, i32* %base, i64 %i\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  %v1 = add i32 %v, 1\n"
+                       "  store i32 %v1, i32* %p\n"
+                       "  %i.next = add i64 %i, 1\n"
+                       "  %c = icmp ult i64 %i.next, %n\n"
+                       "  br i1 %c, label %loop, label %exit\n"
+                       "exit:\n"
+                       "  ret void\n"
+                       "}\n");
+  EXPECT_EQ(1u, countLoads(F));
+}
+
+TEST_F(GVNMemorySSATest, AssumeFalse) {
+  // assume(false) is replaced by a store to null, which must be added to
+  // MemorySSA.
+  Function &F = runGVN("declare void @llvm.assume(i1)\n"
+                       "define i32 @f(i32* %p, i32 %x) {\n"
+                       "  store i32 %x, i32* %p\n"
+                       "  call void @llvm.assume(i1 false)\n"
+                       "  %v = load i32, i32* %p\n"
+                       "  ret i32 %v\n"
+                       "}\n");
+  unsigned NumStores = 0;
+  for (Instruction &I : F.getEntryBlock())
+    NumStores += isa<StoreInst>(I);
+  EXPECT_EQ(2u, NumStores);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,218 @@
+//===- LoopTilingTest.cpp - Loop tiling unit tests ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class LoopTilingTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  FunctionAnalysisManager FAM;
+  cl::opt<unsigned> *TileSize = nullptr;
+
+  void SetUp() override {
+    TileSize = static_cast<cl::opt<unsigned> *>(
+        cl::getRegisteredOptions()["loop-tile-size"]);
+    ASSERT_TRUE(TileSize);
+    TileSize->setValue(32);
+
+    FAM.registerPass([] {
+      AAManager AA;
+      AA.registerFunctionAnalysis<BasicAA>();
+      return AA;
+    });
+    FAM.registerPass([] { return AssumptionAnalysis(); });
+    FAM.registerPass([] { return BasicAA(); });
+    FAM.registerPass([] { return DependenceAnalysis(); });
+    FAM.registerPass([] { return DominatorTreeAnalysis(); });
+    FAM.registerPass([] { return LoopAnalysis(); });
+    FAM.registerPass([] { return OptimizationRemarkEmitterAnalysis(); });
+    FAM.registerPass([] { return PassInstrumentationAnalysis(); });
+    FAM.registerPass([] { return ScalarEvolutionAnalysis(); });
+    FAM.registerPass([] { return TargetIRAnalysis(); });
+    FAM.registerPass([] { return TargetLibraryAnalysis(); });
+  }
+
+  void TearDown() override { TileSize->setValue(0); }
+
+  /// Parse IR and run loop tiling on function @f. Return true if the function
+  /// changed.
+  bool runLoopTiling(StringRef IR) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("LoopTilingTest", errs());
+    assert(M && "Could not parse module");
+    Function &F = *M->getFunction("f");
+
+    LoopTilingPass LT;
+    PreservedAnalyses PA = LT.run(F, FAM);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+    if (PA.getChecker<LoopAnalysis>().preserved()) {
+      auto &DT = FAM.getResult<DominatorTreeAnalysis>(F);
+      FAM.getResult<LoopAnalysis>(F).verify(DT);
+    }
+    return !PA.areAllPreserved();
+  }
+
+  /// Return the depth of the only loop nest of @f.
+  unsigned getNestDepth() {
+    Function &F = *M->getFunction("f");
+    LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
+    EXPECT_EQ(1, std::distance(LI.begin(), LI.end()));
+    unsigned Depth = 0;
+    for (Loop *L = *LI.begin(); L; L = L->getSubLoops().empty()
+                                           ? nullptr
+                                           : L->getSubLoops().front())
+      ++Depth;
+    return Depth;
+  }
+};
+
+static const char *TransposeIR =
+    "define void @f([1024 x [1024 x float]]* noalias %a,\n"
+    "               [1024 x [1024 x float]]* noalias %b) {\n"
+    "entry:\n"
+    "  br label %outer.header\n"
+    "outer.header:\n"
+    "  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]\n"
+    "  br label %inner\n"
+    "inner:\n"
+    "  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]\n"
+    "  %src = getelementptr inbounds [1024 x [1024 x float]],\n"
+    "         [1024 x [1024 x float]]* %b, i64 0, i64 %j, i64 %i\n"
+    "  %v = load float, float* %src\n"
+    "  %dst = getelementptr inbounds [1024 x [1024 x float]],\n"
+    "         [1024 x [1024 x float]]* %a, i64 0, i64 %i, i64 %j\n"
+    "  store float %v, float* %dst\n"
+    "  %j.next = add nuw nsw i64 %j, 1\n"
+    "  %inner.cond = icmp ult i64 %j.next, 1024\n"
+    "  br i1 %inner.cond, label %inner, label %outer.latch\n"
+    "outer.latch:\n"
+    "  %i.next = add nuw nsw i64 %i, 1\n"
+    "  %outer.cond = icmp ult i64 %i.next, 1024\n"
+    "  br i1 %outer.cond, label %outer.header, label %exit\n"
+    "exit:\n"
+    "  ret void\n"
+    "}\n";
+
+TEST_F(LoopTilingTest, TilesTranspose) {
+  EXPECT_TRUE(runLoopTiling(TransposeIR));
+  EXPECT_EQ(3u, getNestDepth());
+
+  // The inner loop now starts at the tile induction variable and stops at the
+  // bound of the tile.
+  Function &F = *M->getFunction("f");
+  LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
+  Loop *TileLoop = *LI.begin();
+  Loop *Inner = TileLoop->getSubLoops().front()->getSubLoops().front();
+  auto *J = cast<PHINode>(&Inner->getHeader()->front());
+  auto *Start = dyn_cast<PHINode>(
+      J->getIncomingValueForBlock(Inner->getLoopPreheader()));
+  ASSERT_TRUE(Start);
+  EXPECT_EQ(TileLoop->getHeader(), Start->getParent());
+  auto *Br = cast<BranchInst>(Inner->getLoopLatch()->getTerminator());
+  auto *Cmp = cast<ICmpInst>(Br->getCondition());
+  EXPECT_EQ("tile.end", Cmp->getOperand(1)->getName());
+}
+
+TEST_F(LoopTilingTest, ReversedDependence) {
+  // a[i][j] = a[i-1][j+1] has a (<, >) dependence that tiling would reverse.
+  EXPECT_FALSE(runLoopTiling(
+      "define void @f([1024 x [1024 x float]]* %a) {\n"
+      "entry:\n"
+      "  br label %outer.header\n"
+      "outer.header:\n"
+      "  %i = phi i64 [ 1, %entry ], [ %i.next, %outer.latch ]\n"
+      "  %i.prev = add nsw i64 %i, -1\n"
+      "  br label %inner\n"
+      "inner:\n"
+      "  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]\n"
+      "  %j.next = add nuw nsw i64 %j, 1\n"
+      "  %src = getelementptr inbounds [1024 x [1024 x float]],\n"
+      "         [1024 x [1024 x float]]* %a, i64 0, i64 %i.prev, i64 %j.next\n"
+      "  %v = load float, float* %src\n"
+      "  %dst = getelementptr inbounds [1024 x [1024 x float]],\n"
+      "         [1024 x [1024 x float]]* %a, i64 0, i64 %i, i64 %j\n"
+      "  store float %v, float* %dst\n"
+      "  %inner.cond = icmp ult i64 %j.next, 1023\n"
+      "  br i1 %inner.cond, label %inner, label %outer.latch\n"
+      "outer.latch:\n"
+      "  %i.next = add nuw nsw i64 %i, 1\n"
+      "  %outer.cond = icmp ult i64 %i.next, 1024\n"
+      "  br i1 %outer.cond, label %outer.header, label %exit\n"
+      "exit:\n"
+      "  ret void\n"
+      "}\n"));
+  EXPECT_EQ(2u, getNestDepth());
+}
+
+TEST_F(LoopTilingTest, ValueUsedAfterNest) {
+  EXPECT_FALSE(runLoopTiling(
+      "define float @f([1024 x [1024 x float]]* noalias %a,\n"
+      "                [1024 x [1024 x float]]* noalias %b) {\n"
+      "entry:\n"
+      "  br label %outer.header\n"
+      "outer.header:\n"
+      "  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]\n"
+      "  br label %inner\n"
+      "inner:\n"
+      "  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]\n"
+      "  %src = getelementptr inbounds [1024 x [1024 x float]],\n"
+      "         [1024 x [1024 x float]]* %b, i64 0, i64 %j, i64 %i\n"
+      "  %v = load float, float* %src\n"
+      "  %dst = getelementptr inbounds [1024 x [1024 x float]],\n"
+      "         [1024 x [1024 x float]]* %a, i64 0, i64 %i, i64 %j\n"
+      "  store float %v, float* %dst\n"
+      "  %j.next = add nuw nsw i64 %j, 1\n"
+      "  %inner.cond = icmp ult i64 %j.next, 1024\n"
+      "  br i1 %inner.cond, label %inner, label %outer.latch\n"
+      "outer.latch:\n"
+      "  %v.lcssa = phi float [ %v, %inner ]\n"
+      "  %i.next = add nuw nsw i64 %i, 1\n"
+      "  %outer.cond = icmp ult i64 %i.next, 1024\n"
+      "  br i1 %outer.cond, label %outer.header, label %exit\n"
+      "exit:\n"
+      "  %v.last = phi float [ %v.lcssa, %outer.latch ]\n"
+      "  ret float %v.last\n"
+      "}\n"));
+  EXPECT_EQ(2u, getNestDepth());
+}
+
+TEST_F(LoopTilingTest, NoCacheInformation) {
+  // Without a forced tile size the pass needs the cache parameters of the
+  // target, which the default TargetTransformInfo does not provide.
+  TileSize->setValue(0);
+  EXPECT_FALSE(runLoopTiling(TransposeIR));
+  EXPECT_EQ(2u, getNestDepth());
+}
+
+} // end anonymous namespace
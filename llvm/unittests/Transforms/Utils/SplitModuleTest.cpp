@@ -0,0 +1,141 @@
+//===- SplitModuleTest.cpp - Unit tests for SplitModule -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+std::unique_ptr<Module> parseIR(LLVMContext &C, const char *IR) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(IR, Err, C);
+  if (!M)
+    Err.print("SplitModuleTest", errs());
+  return M;
+}
+
+// Returns the index of the partition that defines Name, or -1 if none or more
+// than one partition defines it.
+int findDefinition(ArrayRef<std::unique_ptr<Module>> Parts, StringRef Name) {
+  int Found = -1;
+  for (unsigned I = 0, E = Parts.size(); I != E; ++I) {
+    GlobalValue *GV = Parts[I]->getNamedValue(Name);
+    if (!GV || GV->isDeclaration())
+      continue;
+    if (Found != -1)
+      return -1;
+    Found = I;
+  }
+  return Found;
+}
+
+std::vector<std::unique_ptr<Module>> split(std::unique_ptr<Module> M,
+                                           unsigned N) {
+  std::vector<std::unique_ptr<Module>> Parts;
+  SplitModule(std::move(M), N,
+              [&](std::unique_ptr<Module> MPart) {
+                EXPECT_FALSE(verifyModule(*MPart, &errs()));
+                Parts.push_back(std::move(MPart));
+              },
+              /*PreserveLocals=*/false, SplitModuleMode::CostBalanced);
+  return Parts;
+}
+
+TEST(SplitModuleTest, CostBalanced) {
+  LLVMContext C;
+  // Two call chains of similar cost, with a variable used by one of them.
+  std::unique_ptr<Module> M = parseIR(C, R"(
+    @g = global i32 0
+
+    define i32 @big1(i32 %x) {
+      %a = add i32 %x, 1
+      %b = mul i32 %a, %a
+      %c = add i32 %b, 3
+      %d = mul i32 %c, %c
+      %e = call i32 @small1(i32 %d)
+      ret i32 %e
+    }
+
+    define i32 @small1(i32 %x) {
+      %v = load i32, i32* @g
+      %r = add i32 %x, %v
+      ret i32 %r
+    }
+
+    define i32 @big2(i32 %x) {
+      %a = sub i32 %x, 1
+      %b = mul i32 %a, %a
+      %c = sub i32 %b, 3
+      %d = mul i32 %c, %c
+      %e = call i32 @small2(i32 %d)
+      ret i32 %e
+    }
+
+    define i32 @small2(i32 %x) {
+      %r = sub i32 %x, 2
+      ret i32 %r
+    }
+  )");
+  ASSERT_TRUE(M);
+
+  std::vector<std::unique_ptr<Module>> Parts = split(std::move(M), 2);
+  ASSERT_EQ(2u, Parts.size());
+
+  int Big1 = findDefinition(Parts, "big1");
+  int Big2 = findDefinition(Parts, "big2");
+  ASSERT_NE(-1, Big1);
+  ASSERT_NE(-1, Big2);
+  // The costly functions are balanced across the partitions, and the others
+  // follow the functions that reference them.
+  EXPECT_NE(Big1, Big2);
+  EXPECT_EQ(Big1, findDefinition(Parts, "small1"));
+  EXPECT_EQ(Big1, findDefinition(Parts, "g"));
+  EXPECT_EQ(Big2, findDefinition(Parts, "small2"));
+}
+
+TEST(SplitModuleTest, CostBalancedKeepsClustersTogether) {
+  LLVMContext C;
+  std::unique_ptr<Module> M = parseIR(C, R"(
+    $c = comdat any
+
+    define void @f1() comdat($c) {
+      ret void
+    }
+
+    define void @f2() comdat($c) {
+      ret void
+    }
+
+    @a = alias void (), void ()* @f3
+
+    define void @f3() {
+      ret void
+    }
+
+    define void @f4() {
+      ret void
+    }
+  )");
+  ASSERT_TRUE(M);
+
+  std::vector<std::unique_ptr<Module>> Parts = split(std::move(M), 3);
+  ASSERT_EQ(3u, Parts.size());
+  for (StringRef Name : {"f1", "f2", "a", "f3", "f4"})
+    EXPECT_NE(-1, findDefinition(Parts, Name)) << Name;
+  EXPECT_EQ(findDefinition(Parts, "f1"), findDefinition(Parts, "f2"));
+  EXPECT_EQ(findDefinition(Parts, "f3"), findDefinition(Parts, "a"));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,203 @@
+//===- OuterLoopVectorizeTest.cpp - VPlan-native path tests ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Vectorize/LoopVectorize.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/Analysis/DemandedBits.h"
+#include "llvm/Analysis/LoopAccessAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class OuterLoopVectorizeTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  cl::opt<bool> *EnableNativePath = nullptr;
+
+  void SetUp() override {
+    EnableNativePath = static_cast<cl::opt<bool> *>(
+        cl::getRegisteredOptions()["enable-vplan-native-path"]);
+    ASSERT_TRUE(EnableNativePath);
+    EnableNativePath->setValue(true);
+  }
+
+  void TearDown() override { EnableNativePath->setValue(false); }
+
+  /// Parse IR and run the loop vectorizer on function @f.
+  Function &vectorize(StringRef IR, bool ExpectChanged = true) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("OuterLoopVectorizeTest", errs());
+    assert(M && "Could not parse module");
+    Function &F = *M->getFunction("f");
+
+    TargetLibraryInfoImpl TLII(Triple(M->getTargetTriple()));
+    TargetLibraryInfo TLI(TLII);
+    AssumptionCache AC(F);
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+    ScalarEvolution SE(F, TLI, AC, DT, LI);
+    BasicAAResult BAR(M->getDataLayout(), F, TLI, AC, &DT);
+    AAResults AA(TLI);
+    AA.addAAResult(BAR);
+    BranchProbabilityInfo BPI(F, LI, &TLI);
+    BlockFrequencyInfo BFI(F, BPI, LI);
+    DemandedBits DB(F, AC, DT);
+    OptimizationRemarkEmitter ORE(&F);
+    TargetTransformInfo TTI(M->getDataLayout());
+
+    DenseMap<Loop *, std::unique_ptr<LoopAccessInfo>> LAIs;
+    std::function<const LoopAccessInfo &(Loop &)> GetLAA =
+        [&](Loop &L) -> const LoopAccessInfo & {
+      auto &LAI = LAIs[&L];
+      if (!LAI)
+        LAI = std::make_unique<LoopAccessInfo>(&L, &SE, &TLI, &AA, &DT, &LI);
+      return *LAI;
+    };
+
+    LoopVectorizePass LV;
+    EXPECT_EQ(ExpectChanged, LV.runImpl(F, SE, LI, TTI, DT, BFI, &TLI, DB, AA,
+                                        AC, GetLAA, ORE, nullptr));
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+    return F;
+  }
+
+  /// Count the loads and stores of <4 x float>, and the gathers and scatters.
+  static void countMemoryOps(Function &F, unsigned &Wide, unsigned &Gathers) {
+    Type *VecTy = VectorType::get(Type::getFloatTy(F.getContext()), 4);
+    Wide = Gathers = 0;
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB) {
+        if (auto *II = dyn_cast<IntrinsicInst>(&I))
+          Gathers += II->getIntrinsicID() == Intrinsic::masked_gather ||
+                     II->getIntrinsicID() == Intrinsic::masked_scatter;
+        else if (auto *LI = dyn_cast<LoadInst>(&I))
+          Wide += LI->getType() == VecTy;
+        else if (auto *SI = dyn_cast<StoreInst>(&I))
+          Wide += SI->getValueOperand()->getType() == VecTy;
+      }
+  }
+};
+
+// Sum a column of b into a: the inner loop walks down the rows, so the loads
+// are consecutive along the outer loop.
+static const char *const ColumnSumIR =
+    "define void @f(float* noalias %a, float* noalias %b) {\n"
+    "entry:\n"
+    "  br label %outer\n"
+    "outer:\n"
+    "  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]\n"
+    "  br label %inner\n"
+    "inner:\n"
+    "  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]\n"
+    "  %s = phi float [ 0.0, %outer ], [ %s.next, %inner ]\n"
+    "  %row = mul nuw nsw i64 %j, 1024\n"
+    "  %idx = add nuw nsw i64 %row, %i\n"
+    "  %p = getelementptr inbounds float, float* %b, i64 %idx\n"
+    "  %v = load float, float* %p\n"
+    "  %s.next = fadd float %s, %v\n"
+    "  %j.next = add nuw nsw i64 %j, 1\n"
+    "  %ec = icmp eq i64 %j.next, 64\n"
+    "  br i1 %ec, label %outer.latch, label %inner\n"
+    "outer.latch:\n"
+    "  %s.lcssa = phi float [ %s.next, %inner ]\n"
+    "  %q = getelementptr inbounds float, float* %a, i64 %i\n"
+    "  store float %s.lcssa, float* %q\n"
+    "  %i.next = add nuw nsw i64 %i, 1\n"
+    "  %oc = icmp eq i64 %i.next, 1024\n"
+    "  br i1 %oc, label %exit, label %outer, !llvm.loop !0\n"
+    "exit:\n"
+    "  ret void\n"
+    "}\n"
+    "!0 = distinct !{!0, !1, !2, !3}\n"
+    "!1 = !{!\"llvm.loop.vectorize.enable\", i1 true}\n"
+    "!2 = !{!\"llvm.loop.vectorize.width\", i32 4}\n";
+
+TEST_F(OuterLoopVectorizeTest, ConsecutiveAccessesAreWidened) {
+  std::string IR = ColumnSumIR;
+  IR += "!3 = !{!\"llvm.loop.interleave.count\", i32 1}\n";
+  Function &F = vectorize(IR);
+  unsigned Wide, Gathers;
+  countMemoryOps(F, Wide, Gathers);
+  EXPECT_EQ(2u, Wide);
+  EXPECT_EQ(0u, Gathers);
+}
+
+TEST_F(OuterLoopVectorizeTest, Interleave) {
+  std::string IR = ColumnSumIR;
+  IR += "!3 = !{!\"llvm.loop.interleave.count\", i32 2}\n";
+  Function &F = vectorize(IR);
+  unsigned Wide, Gathers;
+  countMemoryOps(F, Wide, Gathers);
+  EXPECT_EQ(4u, Wide);
+  EXPECT_EQ(0u, Gathers);
+}
+
+TEST_F(OuterLoopVectorizeTest, StridedAccessesAreGathered) {
+  // Sum a row of b into a: the loads are 64 elements apart along the outer
+  // loop.
+  Function &F = vectorize(
+      "define void @f(float* noalias %a, float* noalias %b) {\n"
+      "entry:\n"
+      "  br label %outer\n"
+      "outer:\n"
+      "  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]\n"
+      "  %row = mul nuw nsw i64 %i, 64\n"
+      "  br label %inner\n"
+      "inner:\n"
+      "  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]\n"
+      "  %s = phi float [ 0.0, %outer ], [ %s.next, %inner ]\n"
+      "  %idx = add nuw nsw i64 %row, %j\n"
+      "  %p = getelementptr inbounds float, float* %b, i64 %idx\n"
+      "  %v = load float, float* %p\n"
+      "  %s.next = fadd float %s, %v\n"
+      "  %j.next = add nuw nsw i64 %j, 1\n"
+      "  %ec = icmp eq i64 %j.next, 64\n"
+      "  br i1 %ec, label %outer.latch, label %inner\n"
+      "outer.latch:\n"
+      "  %s.lcssa = phi float [ %s.next, %inner ]\n"
+      "  %q = getelementptr inbounds float, float* %a, i64 %i\n"
+      "  store float %s.lcssa, float* %q\n"
+      "  %i.next = add nuw nsw i64 %i, 1\n"
+      "  %oc = icmp eq i64 %i.next, 1024\n"
+      "  br i1 %oc, label %exit, label %outer, !llvm.loop !0\n"
+      "exit:\n"
+      "  ret void\n"
+      "}\n"
+      "!0 = distinct !{!0, !1, !2}\n"
+      "!1 = !{!\"llvm.loop.vectorize.enable\", i1 true}\n"
+      "!2 = !{!\"llvm.loop.vectorize.width\", i32 4}\n");
+  unsigned Wide, Gathers;
+  countMemoryOps(F, Wide, Gathers);
+  EXPECT_EQ(1u, Wide);
+  EXPECT_EQ(1u, Gathers);
+}
+
+} // end anonymous namespace
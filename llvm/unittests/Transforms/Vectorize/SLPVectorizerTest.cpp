@@ -0,0 +1,184 @@
+//===- SLPVectorizerTest.cpp - SLP vectorizer unit tests ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Vectorize/SLPVectorizer.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/DemandedBits.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class SLPVectorizerTest : public testing::Test {
+protected:
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+
+  static void SetUpTestCase() {
+    // The default TTI has 32-bit vector registers; let SLP use all of them.
+    cl::getRegisteredOptions()["slp-min-reg-size"]->addOccurrence(
+        0, "slp-min-reg-size", "32");
+  }
+
+  /// Parse IR and run the SLP vectorizer on function @f.
+  Function &vectorize(StringRef IR, bool ExpectChanged = true) {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IR, Err, Context);
+    if (!M)
+      Err.print("SLPVectorizerTest", errs());
+    assert(M && "Could not parse module");
+    Function &F = *M->getFunction("f");
+
+    TargetLibraryInfoImpl TLII(Triple(M->getTargetTriple()));
+    TargetLibraryInfo TLI(TLII);
+    AssumptionCache AC(F);
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+    ScalarEvolution SE(F, TLI, AC, DT, LI);
+    BasicAAResult BAR(M->getDataLayout(), F, TLI, AC, &DT);
+    AAResults AA(TLI);
+    AA.addAAResult(BAR);
+    DemandedBits DB(F, AC, DT);
+    OptimizationRemarkEmitter ORE(&F);
+    TargetTransformInfo TTI(M->getDataLayout());
+
+    SLPVectorizerPass SLP;
+    EXPECT_EQ(ExpectChanged,
+              SLP.runImpl(F, &SE, &TTI, &TLI, &AA, &LI, &DT, &AC, &DB, &ORE));
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+    return F;
+  }
+
+  /// Count the instructions with opcode \p Opcode producing or storing a
+  /// vector.
+  static unsigned countVectorOps(Function &F, unsigned Opcode) {
+    unsigned N = 0;
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB) {
+        Type *Ty = isa<StoreInst>(I) ? I.getOperand(0)->getType() : I.getType();
+        N += I.getOpcode() == Opcode && Ty->isVectorTy();
+      }
+    return N;
+  }
+};
+
+TEST_F(SLPVectorizerTest, AlternateOpcodeReduction) {
+  // A max reduction over a mix of adds and subs.
+  Function &F = vectorize(
+      "define i8 @f(i8* %a, i8* %b) {\n"
+      "  %a1p = getelementptr inbounds i8, i8* %a, i64 1\n"
+      "  %a2p = getelementptr inbounds i8, i8* %a, i64 2\n"
+      "  %a3p = getelementptr inbounds i8, i8* %a, i64 3\n"
+      "  %b1p = getelementptr inbounds i8, i8* %b, i64 1\n"
+      "  %b2p = getelementptr inbounds i8, i8* %b, i64 2\n"
+      "  %b3p = getelementptr inbounds i8, i8* %b, i64 3\n"
+      "  %a0 = load i8, i8* %a\n"
+      "  %a1 = load i8, i8* %a1p\n"
+      "  %a2 = load i8, i8* %a2p\n"
+      "  %a3 = load i8, i8* %a3p\n"
+      "  %b0 = load i8, i8* %b\n"
+      "  %b1 = load i8, i8* %b1p\n"
+      "  %b2 = load i8, i8* %b2p\n"
+      "  %b3 = load i8, i8* %b3p\n"
+      "  %x0 = add i8 %a0, %b0\n"
+      "  %x1 = sub i8 %a1, %b1\n"
+      "  %x2 = add i8 %a2, %b2\n"
+      "  %x3 = sub i8 %a3, %b3\n"
+      "  %c1 = icmp sgt i8 %x0, %x1\n"
+      "  %m1 = select i1 %c1, i8 %x0, i8 %x1\n"
+      "  %c2 = icmp sgt i8 %m1, %x2\n"
+      "  %m2 = select i1 %c2, i8 %m1, i8 %x2\n"
+      "  %c3 = icmp sgt i8 %m2, %x3\n"
+      "  %m3 = select i1 %c3, i8 %m2, i8 %x3\n"
+      "  ret i8 %m3\n"
+      "}\n");
+  EXPECT_EQ(1u, countVectorOps(F, Instruction::Add));
+  EXPECT_EQ(1u, countVectorOps(F, Instruction::Sub));
+  EXPECT_EQ(2u, countVectorOps(F, Instruction::Load));
+}
+
+TEST_F(SLPVectorizerTest, StraightLineBlocks) {
+  // Half of the stores are in each block, which is too few to vectorize
+  // either half on its own.
+  static const char *const IR =
+      "define void @f(i8* noalias %p, i8* noalias %q) {\n"
+      "entry:\n"
+      "  %q1 = getelementptr inbounds i8, i8* %q, i64 1\n"
+      "  %p1 = getelementptr inbounds i8, i8* %p, i64 1\n"
+      "  %v0 = load i8, i8* %q\n"
+      "  %v1 = load i8, i8* %q1\n"
+      "  store i8 %v0, i8* %p\n"
+      "  store i8 %v1, i8* %p1\n"
+      "  br label %next\n"
+      "next:\n"
+      "  %q2 = getelementptr inbounds i8, i8* %q, i64 2\n"
+      "  %q3 = getelementptr inbounds i8, i8* %q, i64 3\n"
+      "  %p2 = getelementptr inbounds i8, i8* %p, i64 2\n"
+      "  %p3 = getelementptr inbounds i8, i8* %p, i64 3\n"
+      "  %v2 = load i8, i8* %q2\n"
+      "  %v3 = load i8, i8* %q3\n"
+      "  store i8 %v2, i8* %p2\n"
+      "  store i8 %v3, i8* %p3\n"
+      "  ret void\n"
+      "}\n";
+  Function &Unchanged = vectorize(IR, /*ExpectChanged=*/false);
+  EXPECT_EQ(0u, countVectorOps(Unchanged, Instruction::Store));
+
+  auto *Opt = static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["slp-vectorize-straight-line-blocks"]);
+  ASSERT_TRUE(Opt);
+  Opt->setValue(true);
+  Function &F = vectorize(IR);
+  Opt->setValue(false);
+  EXPECT_EQ(1u, countVectorOps(F, Instruction::Store));
+  EXPECT_EQ(1u, countVectorOps(F, Instruction::Load));
+  EXPECT_EQ(2u, F.size());
+}
+
+TEST_F(SLPVectorizerTest, PartialBuildVector) {
+  // The upper half of an existing vector is filled in from scalars.
+  Function &F = vectorize(
+      "define <8 x i8> @f(<8 x i8> %v, i8* %p) {\n"
+      "  %p1 = getelementptr inbounds i8, i8* %p, i64 1\n"
+      "  %p2 = getelementptr inbounds i8, i8* %p, i64 2\n"
+      "  %p3 = getelementptr inbounds i8, i8* %p, i64 3\n"
+      "  %x0 = load i8, i8* %p\n"
+      "  %x1 = load i8, i8* %p1\n"
+      "  %x2 = load i8, i8* %p2\n"
+      "  %x3 = load i8, i8* %p3\n"
+      "  %y0 = add i8 %x0, 1\n"
+      "  %y1 = add i8 %x1, 2\n"
+      "  %y2 = add i8 %x2, 3\n"
+      "  %y3 = add i8 %x3, 4\n"
+      "  %i0 = insertelement <8 x i8> %v, i8 %y0, i32 4\n"
+      "  %i1 = insertelement <8 x i8> %i0, i8 %y1, i32 5\n"
+      "  %i2 = insertelement <8 x i8> %i1, i8 %y2, i32 6\n"
+      "  %i3 = insertelement <8 x i8> %i2, i8 %y3, i32 7\n"
+      "  ret <8 x i8> %i3\n"
+      "}\n");
+  EXPECT_EQ(1u, countVectorOps(F, Instruction::Add));
+  EXPECT_EQ(1u, countVectorOps(F, Instruction::Load));
+}
+
+} // end anonymous namespace
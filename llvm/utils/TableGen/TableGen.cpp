@@ -132,13 +132,19 @@ namespace {
   Class("class", cl::desc("Print Enum list for this class"),
         cl::value_desc("class name"), cl::cat(PrintEnumsCat));
 
+  cl::list<std::string> ExtraOutputs(
+      "extra-output",
+      cl::desc("Also perform <action> on the parsed records and write the "
+               "result to <file>, e.g. -extra-output=gen-instr-info=X.inc"),
+      cl::value_desc("action=file"));
+
 cl::opt<bool, true>
     TimeRegionsOpt("time-regions",
                    cl::desc("Time regions of tablegens execution"),
                    cl::location(TimeRegions));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+bool emitAction(ActionType Kind, raw_ostream &OS, RecordKeeper &Records) {
+  switch (Kind) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
     break;
@@ -251,6 +257,10 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return emitAction(Action, OS, Records);
+}
 }
 
 int main(int argc, char **argv) {
@@ -260,7 +270,23 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  std::vector<TableGenExtraOutput> Extras;
+  for (StringRef Spec : ExtraOutputs) {
+    StringRef Name, Filename;
+    std::tie(Name, Filename) = Spec.split('=');
+    ActionType Kind;
+    if (Filename.empty() || Action.getParser().parse(Action, Name, "", Kind)) {
+      errs() << argv[0] << ": invalid -extra-output '" << Spec
+             << "', expected <action>=<file>\n";
+      return 1;
+    }
+    Extras.push_back(
+        {Filename, [Kind](raw_ostream &OS, RecordKeeper &Records) {
+           return emitAction(Kind, OS, Records);
+         }});
+  }
+
+  return TableGenMain(argv[0], &LLVMTableGenMain, Extras);
 }
 
 #ifdef __has_feature
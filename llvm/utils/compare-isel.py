@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+"""Compare the instruction selectors of llc on a set of IR files.
+
+Every input is compiled to an object file once per selector: SelectionDAG,
+FastISel and GlobalISel. For each run the script reports the best wall-clock
+time over a number of repetitions, the size of the resulting object file and,
+for GlobalISel, how many functions fell back to SelectionDAG.
+
+Example usage:
+  compare-isel.py --llc ./bin/llc -O0 --repeat 3 test-suite-bitcode/
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+SELECTORS = {
+    'sdag': ['-fast-isel=false', '-global-isel=false'],
+    'fast': ['-fast-isel=true', '-global-isel=false'],
+    'gisel': ['-global-isel=true', '-global-isel-abort=2'],
+}
+
+FALLBACK_MARKER = 'Instruction selection used fallback path'
+
+
+def collect_inputs(paths):
+  for path in paths:
+    if not os.path.isdir(path):
+      yield path
+      continue
+    for root, _, files in os.walk(path):
+      for name in sorted(files):
+        if name.endswith(('.ll', '.bc')):
+          yield os.path.join(root, name)
+
+
+def compile_once(args, input, selector, output):
+  cmd = [args.llc, '-O' + args.opt_level, '-filetype=obj', '-o', output]
+  if args.mtriple:
+    cmd.append('-mtriple=' + args.mtriple)
+  cmd += SELECTORS[selector] + args.llc_args + [input]
+  start = time.time()
+  proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+  _, stderr = proc.communicate()
+  elapsed = time.time() - start
+  if proc.returncode != 0:
+    return None
+  return elapsed, stderr.count(FALLBACK_MARKER)
+
+
+def measure(args, input, selector):
+  fd, output = tempfile.mkstemp(suffix='.o')
+  os.close(fd)
+  try:
+    best = None
+    fallbacks = 0
+    for _ in range(args.repeat):
+      result = compile_once(args, input, selector, output)
+      if result is None:
+        return None
+      elapsed, fallbacks = result
+      best = elapsed if best is None else min(best, elapsed)
+    return best, os.path.getsize(output), fallbacks
+  finally:
+    os.remove(output)
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__,
+      formatter_class=argparse.RawTextHelpFormatter)
+  parser.add_argument('--llc', default='llc', help='The llc binary to use')
+  parser.add_argument('-O', dest='opt_level', default='0',
+                      help='The optimization level to compile at')
+  parser.add_argument('--mtriple', default='x86_64-unknown-linux-gnu',
+                      help='The target triple to compile for')
+  parser.add_argument('--repeat', type=int, default=1,
+                      help='Keep the best time of this many runs')
+  parser.add_argument('--selectors', default='sdag,fast,gisel',
+                      help='Comma separated list of selectors to compare')
+  parser.add_argument('--llc-args', default='',
+                      help='Extra arguments passed to every llc invocation')
+  parser.add_argument('inputs', nargs='+',
+                      help='IR files or directories containing them')
+  args = parser.parse_args()
+  args.llc_args = args.llc_args.split()
+
+  selectors = args.selectors.split(',')
+  for selector in selectors:
+    if selector not in SELECTORS:
+      parser.error('unknown selector: ' + selector)
+
+  totals = dict((s, [0.0, 0, 0]) for s in selectors)
+  failures = 0
+  print('%-40s %8s %10s %12s %10s' % ('input', 'selector', 'time (s)',
+                                       'size (B)', 'fallbacks'))
+  for input in collect_inputs(args.inputs):
+    results = {}
+    for selector in selectors:
+      results[selector] = measure(args, input, selector)
+    if any(r is None for r in results.values()):
+      print('%-40s compilation failed' % input, file=sys.stderr)
+      failures += 1
+      continue
+    for selector in selectors:
+      elapsed, size, fallbacks = results[selector]
+      print('%-40s %8s %10.3f %12d %10d' % (os.path.basename(input), selector,
+                                             elapsed, size, fallbacks))
+      totals[selector][0] += elapsed
+      totals[selector][1] += size
+      totals[selector][2] += fallbacks
+
+  print()
+  base = selectors[0]
+  for selector in selectors:
+    elapsed, size, fallbacks = totals[selector]
+    time_ratio = elapsed / totals[base][0] if totals[base][0] else 0.0
+    size_ratio = float(size) / totals[base][1] if totals[base][1] else 0.0
+    print('%-8s total %10.3f s (%.2fx) %12d B (%.2fx) %6d fallbacks' %
+          (selector, elapsed, time_ratio, size, size_ratio, fallbacks))
+  return 1 if failures else 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -1667,6 +1667,10 @@ typedef struct KMP_ALIGN_CACHE dispatch_private_info {
   void *parent; /* hierarchical scheduling parent pointer */
 #endif
   enum cons_type pushed_ws;
+  // adaptive schedule(auto): call site, start time and trip count of the loop
+  struct kmp_auto_site *auto_site;
+  kmp_uint64 auto_start;
+  kmp_uint64 auto_tc;
 } dispatch_private_info_t;
 
 typedef struct dispatch_shared_info32 {
@@ -1698,6 +1702,10 @@ typedef struct dispatch_shared_info {
   volatile kmp_int32 doacross_buf_idx; // teamwise index
   volatile kmp_uint32 *doacross_flags; // shared array of iteration flags (0/1)
   kmp_int32 doacross_num_done; // count finished threads
+  // adaptive schedule(auto): candidate + 1 used by the team (0 until chosen),
+  // and the longest time a thread spent in the loop
+  volatile kmp_int32 auto_choice;
+  volatile kmp_uint64 auto_max_time;
 #if KMP_USE_HIER_SCHED
   void *hier;
 #endif
@@ -2062,6 +2070,7 @@ extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
 extern int __kmp_enable_task_throttling;
+extern int __kmp_lockfree_task_deque;
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
 // Set via OMP_MAX_TASK_PRIORITY if specified, defaults to 0 otherwise
@@ -2181,10 +2190,9 @@ struct kmp_dephash_entry {
 typedef struct kmp_dephash {
   kmp_dephash_entry_t **buckets;
   size_t size;
-#ifdef KMP_DEBUG
+  size_t generation; // index of size in the table of dephash sizes
   kmp_uint32 nelements;
   kmp_uint32 nconflicts;
-#endif
 } kmp_dephash_t;
 
 typedef struct kmp_task_affinity_info {
@@ -2319,6 +2327,7 @@ typedef struct kmp_base_thread_data {
   kmp_uint32 td_deque_head; // Head of deque (will wrap)
   kmp_uint32 td_deque_tail; // Tail of deque (will wrap)
   kmp_int32 td_deque_ntasks; // Number of tasks in deque
+  kmp_int32 td_deque_lockfree; // Owner pushes and pops without td_deque_lock
   // GEH: shouldn't this be volatile since used in while-spin?
   kmp_int32 td_deque_last_stolen; // Thread number of last successful steal
 #ifdef BUILD_TIED_TASK_STACK
@@ -2843,6 +2852,10 @@ extern char const *__kmp_barrier_branch_bit_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_type_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_name[bp_last_bar];
+/* Were KMP_<type>_BARRIER and KMP_<type>_BARRIER_PATTERN specified? */
+extern int __kmp_env_barrier_branch_bit[bs_last_barrier];
+extern int __kmp_env_barrier_pattern[bs_last_barrier];
+extern int __kmp_topology_barrier; /* pick barriers from machine topology */
 
 /* Global Locks */
 extern kmp_bootstrap_lock_t __kmp_initz_lock; /* control initialization */
@@ -2868,6 +2881,7 @@ extern enum sched_type __kmp_sched; /* default runtime scheduling */
 extern enum sched_type __kmp_static; /* default static scheduling method */
 extern enum sched_type __kmp_guided; /* default guided scheduling method */
 extern enum sched_type __kmp_auto; /* default auto scheduling method */
+extern int __kmp_adaptive_auto_schedule; /* tune schedule(auto) per loop */
 extern int __kmp_chunk; /* default runtime chunk size */
 
 extern size_t __kmp_stksize; /* stack size per thread         */
@@ -3331,6 +3345,8 @@ extern kmp_str_buf_t *__kmp_affinity_str_buf_mask(kmp_str_buf_t *buf,
                                                   kmp_affin_mask_t *mask);
 extern void __kmp_affinity_initialize(void);
 extern void __kmp_affinity_uninitialize(void);
+extern void __kmp_affinity_get_topology(int *npackages, int *ncores_per_pkg,
+                                        int *nthreads_per_core);
 extern void __kmp_affinity_set_init_mask(
     int gtid, int isa_root); /* set affinity according to KMP_AFFINITY */
 extern void __kmp_affinity_set_place(int gtid);
@@ -3451,6 +3467,9 @@ extern int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
                          void (*reduce)(void *, void *));
 extern void __kmp_end_split_barrier(enum barrier_type bt, int gtid);
 extern int __kmp_barrier_gomp_cancel(int gtid);
+extern void __kmp_select_barriers_from_topology(int npackages,
+                                                int ncores_per_pkg,
+                                                int nthreads_per_core);
 
 /*!
  * Tell the fork call which compiler generated the fork call, and therefore how
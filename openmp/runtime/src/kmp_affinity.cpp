@@ -4668,6 +4668,15 @@ void __kmp_affinity_initialize(void) {
   }
 }
 
+// Return the topology found by __kmp_affinity_initialize(). All the counts are
+// zero if it has not run.
+void __kmp_affinity_get_topology(int *npackages, int *ncores_per_pkg,
+                                 int *nthreads_per_core) {
+  *npackages = nPackages;
+  *ncores_per_pkg = nCoresPerPkg;
+  *nthreads_per_core = __kmp_nThreadsPerCore;
+}
+
 void __kmp_affinity_uninitialize(void) {
   if (__kmp_affinity_masks != NULL) {
     KMP_CPU_FREE_ARRAY(__kmp_affinity_masks, __kmp_affinity_num_masks);
@@ -2159,3 +2159,53 @@ void __kmp_setup_icv_copy(kmp_team_t *team, int new_nproc,
   ngo_sync();
 #endif // KMP_BARRIER_ICV_PULL
 }
+
+// Pick the barrier patterns and branching factors from the machine topology.
+// Barriers with KMP_<type>_BARRIER or KMP_<type>_BARRIER_PATTERN set in the
+// environment are left alone.
+//
+// With more than one package, the hierarchical barrier follows the machine
+// hierarchy: threads of a core, then of a package, synchronize with each other
+// first, so that only one thread per package waits on remote cache lines.
+// Within a single package, the hyper barrier stays, with a branching factor
+// large enough for the threads of the package to be gathered in two rounds.
+void __kmp_select_barriers_from_topology(int npackages, int ncores_per_pkg,
+                                         int nthreads_per_core) {
+  int nthreads_per_pkg = ncores_per_pkg * nthreads_per_core;
+  // The flat map, used when the topology is unknown, has one thread per
+  // package.
+  if (npackages <= 0 || nthreads_per_pkg <= 1)
+    return;
+#if KMP_MIC_SUPPORTED
+  if (__kmp_mic_type == mic2) // KNC defaults are already tuned.
+    return;
+#endif
+  kmp_uint32 branch_bits = 0;
+  while ((1 << branch_bits) < nthreads_per_pkg)
+    ++branch_bits;
+  branch_bits = (branch_bits + 1) / 2;
+  if (branch_bits < __kmp_barrier_gather_bb_dflt)
+    branch_bits = __kmp_barrier_gather_bb_dflt;
+
+  for (int i = bs_plain_barrier; i < bs_last_barrier; i++) {
+    if (__kmp_env_barrier_branch_bit[i] || __kmp_env_barrier_pattern[i])
+      continue;
+    if (npackages > 1) {
+      __kmp_barrier_gather_pattern[i] = bp_hierarchical_bar;
+      __kmp_barrier_release_pattern[i] = bp_hierarchical_bar;
+    } else {
+#if KMP_FAST_REDUCTION_BARRIER
+      if (i == bs_reduction_barrier) // Keep the tuned reduction branching.
+        continue;
+#endif
+      __kmp_barrier_gather_branch_bits[i] = branch_bits;
+      __kmp_barrier_release_branch_bits[i] = branch_bits;
+    }
+    KA_TRACE(10, ("__kmp_select_barriers_from_topology: %s: %s,%s %d,%d\n",
+                  __kmp_barrier_type_name[i],
+                  __kmp_barrier_pattern_name[__kmp_barrier_gather_pattern[i]],
+                  __kmp_barrier_pattern_name[__kmp_barrier_release_pattern[i]],
+                  __kmp_barrier_gather_branch_bits[i],
+                  __kmp_barrier_release_branch_bits[i]));
+  }
+}
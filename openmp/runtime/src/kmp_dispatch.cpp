@@ -754,6 +754,96 @@ void __kmp_dispatch_free_hierarchies(kmp_team_t *team) {
 
 // UT - unsigned flavor of T, ST - signed flavor of T,
 // DBL - double if sizeof(T)==4, or long double if sizeof(T)==8
+// Adaptive schedule(auto)
+// With KMP_ADAPTIVE_AUTO_SCHEDULE set, every call site of a schedule(auto) loop
+// keeps its own timing: the first executions of the loop try each candidate
+// schedule below in turn and measure how long the slowest thread took per
+// iteration, which covers both load imbalance and dispatching overhead. After
+// that the site uses the fastest candidate until its times move far from what
+// was measured, or until it is time to check again, and the candidates are
+// tried once more. All threads of a team agree on the candidate for one
+// execution through the shared dispatch buffer.
+#define KMP_AUTO_NCANDIDATES 4
+#define KMP_AUTO_TRIALS 2 // executions of each candidate while exploring
+#define KMP_AUTO_EXPLORE (KMP_AUTO_NCANDIDATES * KMP_AUTO_TRIALS)
+#define KMP_AUTO_RECHECK 1024 // executions before exploring again
+#define KMP_AUTO_SITES 512 // must be a power of 2
+#define KMP_AUTO_PROBES 8
+
+static const struct {
+  enum sched_type schedule;
+  kmp_int32 chunks_per_thread; // 0 means KMP_DEFAULT_CHUNK
+} __kmp_auto_candidates[KMP_AUTO_NCANDIDATES] = {
+    {kmp_sch_static_balanced, 0},
+    {kmp_sch_dynamic_chunked, 4},
+    {kmp_sch_dynamic_chunked, 32},
+    {kmp_sch_guided_iterative_chunked, 0}};
+
+struct kmp_auto_site {
+  ident_t *volatile loc;
+  kmp_uint32 ncalls; // executions measured since exploring last started
+  kmp_int32 choice; // fastest candidate once done exploring
+  double time[KMP_AUTO_NCANDIDATES]; // best time per iteration measured
+};
+
+static kmp_auto_site __kmp_auto_sites[KMP_AUTO_SITES];
+static kmp_bootstrap_lock_t __kmp_auto_sites_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_auto_sites_lock);
+
+// Returns the statistics of the loop at loc, or NULL if the table is too full
+static kmp_auto_site *__kmp_auto_find_site(ident_t *loc) {
+  kmp_uintptr_t h = ((kmp_uintptr_t)loc >> 4) ^ ((kmp_uintptr_t)loc >> 13);
+  for (int i = 0; i < KMP_AUTO_PROBES; ++i) {
+    kmp_auto_site *site = &__kmp_auto_sites[(h + i) & (KMP_AUTO_SITES - 1)];
+    if (site->loc == NULL)
+      KMP_COMPARE_AND_STORE_PTR(&site->loc, NULL, loc);
+    if (site->loc == loc)
+      return site;
+  }
+  return NULL;
+}
+
+static kmp_int32 __kmp_auto_next_choice(kmp_auto_site *site) {
+  kmp_uint32 ncalls = site->ncalls;
+  if (ncalls < KMP_AUTO_EXPLORE)
+    return ncalls % KMP_AUTO_NCANDIDATES;
+  return site->choice;
+}
+
+// Called by the last thread to finish an execution of the loop
+static void __kmp_auto_update_site(kmp_auto_site *site, kmp_int32 choice,
+                                   kmp_uint64 max_time, kmp_uint64 tc) {
+  if (tc == 0)
+    return;
+  double t = (double)max_time / tc;
+  __kmp_acquire_bootstrap_lock(&__kmp_auto_sites_lock);
+  kmp_uint32 ncalls = site->ncalls;
+  if (ncalls < KMP_AUTO_EXPLORE) {
+    // Teams running the same loop concurrently may have used another
+    // candidate than the one being explored, ignore those
+    if (choice == (kmp_int32)(ncalls % KMP_AUTO_NCANDIDATES)) {
+      if (ncalls < KMP_AUTO_NCANDIDATES || t < site->time[choice])
+        site->time[choice] = t;
+      site->ncalls = ++ncalls;
+      if (ncalls == KMP_AUTO_EXPLORE) {
+        kmp_int32 best = 0;
+        for (kmp_int32 i = 1; i < KMP_AUTO_NCANDIDATES; ++i)
+          if (site->time[i] < site->time[best])
+            best = i;
+        site->choice = best;
+        KD_TRACE(10, ("__kmp_auto_update_site: loop %s uses candidate %d\n",
+                      site->loc->psource, best));
+      }
+    }
+  } else if (choice == site->choice) {
+    site->ncalls = ++ncalls;
+    if (t > 2 * site->time[choice] || 2 * t < site->time[choice] ||
+        ncalls >= KMP_AUTO_EXPLORE + KMP_AUTO_RECHECK)
+      site->ncalls = 0; // explore again
+  }
+  __kmp_release_bootstrap_lock(&__kmp_auto_sites_lock);
+}
+
 template <typename T>
 static void
 __kmp_dispatch_init(ident_t *loc, int gtid, enum sched_type schedule, T lb,
@@ -866,6 +956,55 @@ __kmp_dispatch_init(ident_t *loc, int gtid, enum sched_type schedule, T lb,
                   my_buffer_index));
   }
 
+  kmp_auto_site *auto_site = NULL;
+  if (__kmp_adaptive_auto_schedule && active && loc != NULL && st != 0) {
+    enum sched_type my_sched = SCHEDULE_WITHOUT_MODIFIERS(schedule);
+    if (my_sched == kmp_sch_runtime)
+      my_sched = SCHEDULE_WITHOUT_MODIFIERS(team->t.t_sched.r_sched_type);
+    if (my_sched == kmp_sch_auto
+#if KMP_USE_HIER_SCHED
+        && !pr->flags.use_hier
+#endif
+    )
+      auto_site = __kmp_auto_find_site(loc);
+  }
+  pr->auto_site = auto_site;
+  if (auto_site) {
+    // The first thread to get the shared buffer picks the candidate for the
+    // whole team, so the buffer has to be ours before the schedule is set up
+    __kmp_wait<kmp_uint32>(&sh->buffer_index, my_buffer_index,
+                           __kmp_eq<kmp_uint32> USE_ITT_BUILD_ARG(NULL));
+    if (sh->auto_choice == 0)
+      KMP_COMPARE_AND_STORE_ACQ32(&sh->auto_choice, 0,
+                                  __kmp_auto_next_choice(auto_site) + 1);
+    kmp_int32 choice = sh->auto_choice - 1;
+
+    UT tc;
+    if (st > 0)
+      tc = ub >= lb ? (UT)(ub - lb) / st + 1 : 0;
+    else
+      tc = lb >= ub ? (UT)(lb - ub) / (-st) + 1 : 0;
+    kmp_int32 chunks_per_thread =
+        __kmp_auto_candidates[choice].chunks_per_thread;
+    if (chunks_per_thread) {
+      chunk = tc / ((UT)th->th.th_team_nproc * chunks_per_thread);
+      if (chunk < 1)
+        chunk = 1;
+    } else {
+      chunk = KMP_DEFAULT_CHUNK;
+    }
+    schedule = (enum sched_type)(SCHEDULE_GET_MODIFIERS(schedule) |
+                                 __kmp_auto_candidates[choice].schedule);
+#if USE_ITT_BUILD
+    cur_chunk = chunk;
+#endif
+    KD_TRACE(10, ("__kmp_dispatch_init: T#%d adaptive auto: candidate:%d "
+                  "schedule:%d\n",
+                  gtid, choice, schedule));
+    pr->auto_tc = tc;
+    pr->auto_start = KMP_NOW();
+  }
+
   __kmp_dispatch_init_algorithm(loc, gtid, pr, schedule, lb, ub, st,
 #if USE_ITT_BUILD
                                 &cur_chunk,
@@ -2046,6 +2185,16 @@ static int __kmp_dispatch_next(ident_t *loc, int gtid, kmp_int32 *p_last,
     if (status == 0) {
       UT num_done;
 
+      if (pr->auto_site) {
+        // The last thread to finish records the longest time of the team
+        kmp_uint64 time = KMP_NOW() - pr->auto_start;
+        kmp_uint64 max_time;
+        do {
+          max_time = sh->auto_max_time;
+        } while (time > max_time &&
+                 !KMP_COMPARE_AND_STORE_ACQ64(&sh->auto_max_time, max_time,
+                                              time));
+      }
       num_done = test_then_inc<ST>((volatile ST *)&sh->u.s.num_done);
 #ifdef KMP_DEBUG
       {
@@ -2078,6 +2227,13 @@ static int __kmp_dispatch_next(ident_t *loc, int gtid, kmp_int32 *p_last,
           }
         }
 #endif
+        if (pr->auto_site) {
+          __kmp_auto_update_site(pr->auto_site, sh->auto_choice - 1,
+                                 sh->auto_max_time, pr->auto_tc);
+          sh->auto_choice = 0;
+          sh->auto_max_time = 0;
+        }
+
         /* NOTE: release this buffer to be reused */
 
         KMP_MB(); /* Flush all pending memory write invalidates.  */
@@ -147,6 +147,10 @@ template <typename T> struct KMP_ALIGN_CACHE dispatch_private_info_template {
   kmp_hier_top_unit_t<T> *get_parent() { return hier_parent; }
 #endif
   enum cons_type pushed_ws;
+  // adaptive schedule(auto): call site, start time and trip count of the loop
+  struct kmp_auto_site *auto_site;
+  kmp_uint64 auto_start;
+  kmp_uint64 auto_tc;
 };
 
 // replaces dispatch_shared_info{32,64} structures and
@@ -174,6 +178,10 @@ template <typename T> struct dispatch_shared_info_template {
   volatile kmp_int32 doacross_buf_idx; // teamwise index
   kmp_uint32 *doacross_flags; // array of iteration flags (0/1)
   kmp_int32 doacross_num_done; // count finished threads
+  // adaptive schedule(auto): candidate + 1 used by the team (0 until chosen),
+  // and the longest time a thread spent in the loop
+  volatile kmp_int32 auto_choice;
+  volatile kmp_uint64 auto_max_time;
 #if KMP_USE_HIER_SCHED
   kmp_hier_t<T> *hier;
 #endif
@@ -6795,6 +6795,16 @@ static void __kmp_do_middle_initialize(void) {
       __kmp_affinity_set_init_mask(i, TRUE);
     }
   }
+
+  // The barrier defaults set in __kmp_do_serial_initialize() did not know
+  // the machine topology yet.
+  if (__kmp_topology_barrier) {
+    int npackages, ncores_per_pkg, nthreads_per_core;
+    __kmp_affinity_get_topology(&npackages, &ncores_per_pkg,
+                                &nthreads_per_core);
+    __kmp_select_barriers_from_topology(npackages, ncores_per_pkg,
+                                        nthreads_per_core);
+  }
 #endif /* KMP_AFFINITY_SUPPORTED */
 
   KMP_ASSERT(__kmp_xproc > 0);
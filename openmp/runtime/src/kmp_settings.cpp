@@ -1534,6 +1534,7 @@ static void __kmp_stg_parse_barrier_branch_bit(char const *name,
     if ((strcmp(var, name) == 0) && (value != 0)) {
       char *comma;
 
+      __kmp_env_barrier_branch_bit[i] = TRUE;
       comma = CCAST(char *, strchr(value, ','));
       __kmp_barrier_gather_branch_bits[i] =
           (kmp_uint32)__kmp_str_to_int(value, ',');
@@ -1601,6 +1602,8 @@ static void __kmp_stg_parse_barrier_pattern(char const *name, char const *value,
       int j;
       char *comma = CCAST(char *, strchr(value, ','));
 
+      __kmp_env_barrier_pattern[i] = TRUE;
+
       /* handle first parameter: gather pattern */
       for (j = bp_linear_bar; j < bp_last_bar; j++) {
         if (__kmp_match_with_sentinel(__kmp_barrier_pattern_name[j], value, 1,
@@ -1655,6 +1658,19 @@ static void __kmp_stg_print_barrier_pattern(kmp_str_buf_t *buffer,
   }
 } // __kmp_stg_print_barrier_pattern
 
+// -----------------------------------------------------------------------------
+// KMP_TOPOLOGY_BARRIER
+
+static void __kmp_stg_parse_topology_barrier(char const *name,
+                                             char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_topology_barrier);
+} // __kmp_stg_parse_topology_barrier
+
+static void __kmp_stg_print_topology_barrier(kmp_str_buf_t *buffer,
+                                             char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_topology_barrier);
+} // __kmp_stg_print_topology_barrier
+
 // -----------------------------------------------------------------------------
 // KMP_ABORT_DELAY
 
@@ -4621,6 +4637,34 @@ static void __kmp_stg_print_task_throttling(kmp_str_buf_t *buffer,
   __kmp_stg_print_bool(buffer, name, __kmp_enable_task_throttling);
 } // __kmp_stg_print_task_throttling
 
+// -----------------------------------------------------------------------------
+// KMP_ADAPTIVE_AUTO_SCHEDULE
+
+static void __kmp_stg_parse_adaptive_auto_schedule(char const *name,
+                                                   char const *value,
+                                                   void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_adaptive_auto_schedule);
+} // __kmp_stg_parse_adaptive_auto_schedule
+
+static void __kmp_stg_print_adaptive_auto_schedule(kmp_str_buf_t *buffer,
+                                                   char const *name,
+                                                   void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_adaptive_auto_schedule);
+} // __kmp_stg_print_adaptive_auto_schedule
+
+// -----------------------------------------------------------------------------
+// KMP_LOCKFREE_TASK_DEQUE
+
+static void __kmp_stg_parse_lockfree_task_deque(char const *name,
+                                                char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_lockfree_task_deque);
+} // __kmp_stg_parse_lockfree_task_deque
+
+static void __kmp_stg_print_lockfree_task_deque(kmp_str_buf_t *buffer,
+                                                char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_lockfree_task_deque);
+} // __kmp_stg_print_lockfree_task_deque
+
 // -----------------------------------------------------------------------------
 // OMP_DISPLAY_ENV
 
@@ -4823,6 +4867,8 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_REDUCTION_BARRIER_PATTERN", __kmp_stg_parse_barrier_pattern,
      __kmp_stg_print_barrier_pattern, NULL, 0, 0},
 #endif
+    {"KMP_TOPOLOGY_BARRIER", __kmp_stg_parse_topology_barrier,
+     __kmp_stg_print_topology_barrier, NULL, 0, 0},
 
     {"KMP_ABORT_DELAY", __kmp_stg_parse_abort_delay,
      __kmp_stg_print_abort_delay, NULL, 0, 0},
@@ -4924,6 +4970,10 @@ static kmp_setting_t __kmp_stg_table[] = {
 #endif
     {"KMP_ENABLE_TASK_THROTTLING", __kmp_stg_parse_task_throttling,
      __kmp_stg_print_task_throttling, NULL, 0, 0},
+    {"KMP_LOCKFREE_TASK_DEQUE", __kmp_stg_parse_lockfree_task_deque,
+     __kmp_stg_print_lockfree_task_deque, NULL, 0, 0},
+    {"KMP_ADAPTIVE_AUTO_SCHEDULE", __kmp_stg_parse_adaptive_auto_schedule,
+     __kmp_stg_print_adaptive_auto_schedule, NULL, 0, 0},
 
     {"OMP_DISPLAY_ENV", __kmp_stg_parse_omp_display_env,
      __kmp_stg_print_omp_display_env, NULL, 0, 0},
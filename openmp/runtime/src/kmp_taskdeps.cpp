@@ -52,7 +52,14 @@ static inline kmp_depnode_t *__kmp_node_ref(kmp_depnode_t *node) {
   return node;
 }
 
-enum { KMP_DEPHASH_OTHER_SIZE = 97, KMP_DEPHASH_MASTER_SIZE = 997 };
+// Dephash sizes are primes roughly doubling from one generation to the next.
+// Explicit tasks start with the first one, implicit tasks (which typically
+// spawn many more tasks with dependences) with the second.
+static const size_t __kmp_dephash_sizes[] = {
+    97, 997, 2003, 4001, 8191, 16001, 32003, 64007, 131071, 270029};
+static const size_t KMP_DEPHASH_MAX_GEN =
+    sizeof(__kmp_dephash_sizes) / sizeof(__kmp_dephash_sizes[0]) - 1;
+enum { KMP_DEPHASH_OTHER_GEN = 0, KMP_DEPHASH_MASTER_GEN = 1 };
 
 static inline kmp_int32 __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
   // TODO alternate to try: set = (((Addr64)(addrUsefulBits * 9.618)) %
@@ -60,17 +67,11 @@ static inline kmp_int32 __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
   return ((addr >> 6) ^ (addr >> 2)) % hsize;
 }
 
-static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
-                                           kmp_taskdata_t *current_task) {
+static kmp_dephash_t *__kmp_dephash_alloc(kmp_info_t *thread,
+                                          size_t generation) {
   kmp_dephash_t *h;
 
-  size_t h_size;
-
-  if (current_task->td_flags.tasktype == TASK_IMPLICIT)
-    h_size = KMP_DEPHASH_MASTER_SIZE;
-  else
-    h_size = KMP_DEPHASH_OTHER_SIZE;
-
+  size_t h_size = __kmp_dephash_sizes[generation];
   kmp_int32 size =
       h_size * sizeof(kmp_dephash_entry_t *) + sizeof(kmp_dephash_t);
 
@@ -80,11 +81,9 @@ static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
   h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size);
 #endif
   h->size = h_size;
-
-#ifdef KMP_DEBUG
+  h->generation = generation;
   h->nelements = 0;
   h->nconflicts = 0;
-#endif
   h->buckets = (kmp_dephash_entry **)(h + 1);
 
   for (size_t i = 0; i < h_size; i++)
@@ -93,11 +92,60 @@ static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
   return h;
 }
 
+static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
+                                           kmp_taskdata_t *current_task) {
+  if (current_task->td_flags.tasktype == TASK_IMPLICIT)
+    return __kmp_dephash_alloc(thread, KMP_DEPHASH_MASTER_GEN);
+  return __kmp_dephash_alloc(thread, KMP_DEPHASH_OTHER_GEN);
+}
+
+// Moves the entries of h to a table of the next generation and frees h. The
+// entries themselves are not copied, nodes and lists still point to them.
+static kmp_dephash_t *__kmp_dephash_extend(kmp_info_t *thread,
+                                           kmp_dephash_t *h) {
+  if (h->generation >= KMP_DEPHASH_MAX_GEN)
+    return h;
+
+  kmp_dephash_t *new_h = __kmp_dephash_alloc(thread, h->generation + 1);
+  for (size_t i = 0; i < h->size; i++) {
+    kmp_dephash_entry_t *next;
+    for (kmp_dephash_entry_t *entry = h->buckets[i]; entry; entry = next) {
+      next = entry->next_in_bucket;
+      kmp_int32 bucket = __kmp_dephash_hash(entry->addr, new_h->size);
+      entry->next_in_bucket = new_h->buckets[bucket];
+      if (entry->next_in_bucket)
+        new_h->nconflicts++;
+      new_h->buckets[bucket] = entry;
+      new_h->nelements++;
+    }
+  }
+  KA_TRACE(30, ("__kmp_dephash_extend: T#%d extended dephash %p of %d "
+                "elements from %d to %d buckets\n",
+                __kmp_gtid_from_thread(thread), new_h, (int)new_h->nelements,
+                (int)h->size, (int)new_h->size));
+
+#if USE_FAST_MEMORY
+  __kmp_fast_free(thread, h);
+#else
+  __kmp_thread_free(thread, h);
+#endif
+  return new_h;
+}
+
 #define ENTRY_LAST_INS 0
 #define ENTRY_LAST_MTXS 1
 
 static kmp_dephash_entry *
-__kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t *h, kmp_intptr_t addr) {
+__kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t **hash,
+                   kmp_intptr_t addr) {
+  kmp_dephash_t *h = *hash;
+  // Grow the table once there are as many collisions as buckets, so that
+  // lookups stay short for tasks with thousands of dependences
+  if (h->nconflicts >= h->size && h->generation < KMP_DEPHASH_MAX_GEN) {
+    h = __kmp_dephash_extend(thread, h);
+    *hash = h;
+  }
+
   kmp_int32 bucket = __kmp_dephash_hash(addr, h->size);
 
   kmp_dephash_entry_t *entry;
@@ -122,11 +170,9 @@ __kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t *h, kmp_intptr_t addr) {
     entry->mtx_lock = NULL;
     entry->next_in_bucket = h->buckets[bucket];
     h->buckets[bucket] = entry;
-#ifdef KMP_DEBUG
     h->nelements++;
     if (entry->next_in_bucket)
       h->nconflicts++;
-#endif
   }
   return entry;
 }
@@ -190,7 +236,10 @@ __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
     kmp_depnode_t *dep = p->node;
     if (dep->dn.task) {
       KMP_ACQUIRE_DEPNODE(gtid, dep);
-      if (dep->dn.task) {
+      // Only the thread registering node adds it as a successor, so if dep
+      // already got it from an earlier depend item it is still at the head.
+      if (dep->dn.task &&
+          (!dep->dn.successors || dep->dn.successors->node != node)) {
         __kmp_track_dependence(dep, node, task);
         dep->dn.successors = __kmp_add_node(thread, dep->dn.successors, node);
         KA_TRACE(40, ("__kmp_process_deps: T#%d adding dependence from %p to "
@@ -216,7 +265,8 @@ static inline kmp_int32 __kmp_depnode_link_successor(kmp_int32 gtid,
   if (sink->dn.task) {
     // synchronously add source to sink' list of successors
     KMP_ACQUIRE_DEPNODE(gtid, sink);
-    if (sink->dn.task) {
+    if (sink->dn.task &&
+        (!sink->dn.successors || sink->dn.successors->node != source)) {
       __kmp_track_dependence(sink, source, task);
       sink->dn.successors = __kmp_add_node(thread, sink->dn.successors, source);
       KA_TRACE(40, ("__kmp_process_deps: T#%d adding dependence from %p to "
@@ -232,7 +282,7 @@ static inline kmp_int32 __kmp_depnode_link_successor(kmp_int32 gtid,
 
 template <bool filter>
 static inline kmp_int32
-__kmp_process_deps(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t *hash,
+__kmp_process_deps(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t **hash,
                    bool dep_barrier, kmp_int32 ndeps,
                    kmp_depend_info_t *dep_list, kmp_task_t *task) {
   KA_TRACE(30, ("__kmp_process_deps<%d>: T#%d processing %d dependencies : "
@@ -350,9 +400,60 @@ __kmp_process_deps(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t *hash,
 #define NO_DEP_BARRIER (false)
 #define DEP_BARRIER (true)
 
+// depend clauses with more items than this are filtered for duplicate
+// addresses by sorting instead of comparing all pairs
+#define KMP_DEPS_SORT_THRESHOLD 32
+
+// merge the flags of a later depend item on the same address into dep
+static inline void __kmp_merge_dep_flags(kmp_depend_info_t *dep,
+                                         const kmp_depend_info_t *other) {
+  dep->flags.in |= other->flags.in;
+  dep->flags.out |= (other->flags.out || (dep->flags.in && other->flags.mtx) ||
+                     (dep->flags.mtx && other->flags.in));
+  dep->flags.mtx = dep->flags.mtx | other->flags.mtx && !dep->flags.out;
+}
+
+typedef struct kmp_dep_order {
+  kmp_intptr_t addr;
+  kmp_int32 index;
+} kmp_dep_order_t;
+
+static int __kmp_dep_order_compare(const void *a, const void *b) {
+  const kmp_dep_order_t *x = (const kmp_dep_order_t *)a;
+  const kmp_dep_order_t *y = (const kmp_dep_order_t *)b;
+  if (x->addr != y->addr)
+    return x->addr < y->addr ? -1 : 1;
+  return x->index - y->index;
+}
+
+// Same filtering as the pairwise loop in __kmp_check_deps, in O(n log n): the
+// first item on each address absorbs the later ones in their original order.
+static void __kmp_filter_deps_sorted(kmp_info_t *thread, kmp_int32 ndeps,
+                                     kmp_depend_info_t *dep_list) {
+  kmp_dep_order_t *order = (kmp_dep_order_t *)__kmp_thread_malloc(
+      thread, ndeps * sizeof(kmp_dep_order_t));
+  kmp_int32 n = 0;
+  for (kmp_int32 i = 0; i < ndeps; i++) {
+    if (dep_list[i].base_addr != 0) {
+      order[n].addr = dep_list[i].base_addr;
+      order[n].index = i;
+      n++;
+    }
+  }
+  qsort(order, n, sizeof(kmp_dep_order_t), __kmp_dep_order_compare);
+  for (kmp_int32 k = 0, l; k < n; k = l) {
+    kmp_depend_info_t *first = &dep_list[order[k].index];
+    for (l = k + 1; l < n && order[l].addr == order[k].addr; l++) {
+      __kmp_merge_dep_flags(first, &dep_list[order[l].index]);
+      dep_list[order[l].index].base_addr = 0; // Mark element as void
+    }
+  }
+  __kmp_thread_free(thread, order);
+}
+
 // returns true if the task has any outstanding dependence
 static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
-                             kmp_task_t *task, kmp_dephash_t *hash,
+                             kmp_task_t *task, kmp_dephash_t **hash,
                              bool dep_barrier, kmp_int32 ndeps,
                              kmp_depend_info_t *dep_list,
                              kmp_int32 ndeps_noalias,
@@ -367,31 +468,29 @@ static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
                 gtid, taskdata, ndeps, ndeps_noalias, dep_barrier));
 
   // Filter deps in dep_list
-  // TODO: Different algorithm for large dep_list ( > 10 ? )
-  for (i = 0; i < ndeps; i++) {
-    if (dep_list[i].base_addr != 0) {
+  if (ndeps > KMP_DEPS_SORT_THRESHOLD) {
+    __kmp_filter_deps_sorted(__kmp_threads[gtid], ndeps, dep_list);
+  } else {
+    for (i = 0; i < ndeps; i++) {
+      if (dep_list[i].base_addr == 0)
+        continue;
       for (int j = i + 1; j < ndeps; j++) {
         if (dep_list[i].base_addr == dep_list[j].base_addr) {
-          dep_list[i].flags.in |= dep_list[j].flags.in;
-          dep_list[i].flags.out |=
-              (dep_list[j].flags.out ||
-               (dep_list[i].flags.in && dep_list[j].flags.mtx) ||
-               (dep_list[i].flags.mtx && dep_list[j].flags.in));
-          dep_list[i].flags.mtx =
-              dep_list[i].flags.mtx | dep_list[j].flags.mtx &&
-              !dep_list[i].flags.out;
+          __kmp_merge_dep_flags(&dep_list[i], &dep_list[j]);
           dep_list[j].base_addr = 0; // Mark j element as void
         }
       }
-      if (dep_list[i].flags.mtx) {
-        // limit number of mtx deps to MAX_MTX_DEPS per node
-        if (n_mtxs < MAX_MTX_DEPS && task != NULL) {
-          ++n_mtxs;
-        } else {
-          dep_list[i].flags.in = 1; // downgrade mutexinoutset to inout
-          dep_list[i].flags.out = 1;
-          dep_list[i].flags.mtx = 0;
-        }
+    }
+  }
+  for (i = 0; i < ndeps; i++) {
+    if (dep_list[i].base_addr != 0 && dep_list[i].flags.mtx) {
+      // limit number of mtx deps to MAX_MTX_DEPS per node
+      if (n_mtxs < MAX_MTX_DEPS && task != NULL) {
+        ++n_mtxs;
+      } else {
+        dep_list[i].flags.in = 1; // downgrade mutexinoutset to inout
+        dep_list[i].flags.out = 1;
+        dep_list[i].flags.mtx = 0;
       }
     }
   }
@@ -552,7 +651,7 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
     __kmp_init_node(node);
     new_taskdata->td_depnode = node;
 
-    if (__kmp_check_deps(gtid, node, new_task, current_task->td_dephash,
+    if (__kmp_check_deps(gtid, node, new_task, &current_task->td_dephash,
                          NO_DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
                          noalias_dep_list)) {
       KA_TRACE(10, ("__kmpc_omp_task_with_deps(exit): T#%d task had blocking "
@@ -633,7 +732,7 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
   kmp_depnode_t node = {0};
   __kmp_init_node(&node);
 
-  if (!__kmp_check_deps(gtid, &node, NULL, current_task->td_dephash,
+  if (!__kmp_check_deps(gtid, &node, NULL, &current_task->td_dephash,
                         DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
                         noalias_dep_list)) {
     KA_TRACE(10, ("__kmpc_omp_wait_deps(exit): T#%d has no blocking "
@@ -320,6 +320,28 @@ static void __kmp_realloc_task_deque(kmp_info_t *thread,
   thread_data->td.td_deque_size = new_size;
 }
 
+// __kmp_use_lockfree_deque:
+// Called by the owner of a deque before it pushes or pops, returns whether it
+// may do so without the deque_lock. Thieves always hold the lock and take from
+// the head while the owner works on the tail; the two agree on who gets the
+// last task by atomically claiming it from td_deque_ntasks first. Proxy tasks
+// are pushed to the tail by threads outside the team and stealing untied tasks
+// removes them from the middle, so once the task team has seen either kind the
+// owner takes the lock again. The mode only changes with the lock held, so
+// those paths see no lock-free push or pop in flight when they check it.
+static inline bool __kmp_use_lockfree_deque(kmp_task_team_t *task_team,
+                                            kmp_thread_data_t *thread_data) {
+  kmp_int32 lockfree = __kmp_lockfree_task_deque &&
+                       !TCR_4(task_team->tt.tt_found_proxy_tasks) &&
+                       !task_team->tt.tt_untied_task_encountered;
+  if (UNLIKELY(lockfree != thread_data->td.td_deque_lockfree)) {
+    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+    thread_data->td.td_deque_lockfree = lockfree;
+    __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  }
+  return lockfree;
+}
+
 //  __kmp_push_task: Add a task to the thread's deque
 static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
   kmp_info_t *thread = __kmp_threads[gtid];
@@ -367,6 +389,27 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
     __kmp_alloc_task_deque(thread, thread_data);
   }
 
+  // A thief may still be reading the head slot of a task it has claimed, so
+  // leave one slot free when pushing without the lock.
+  if (__kmp_use_lockfree_deque(task_team, thread_data) &&
+      TCR_4(thread_data->td.td_deque_ntasks) <
+          TASK_DEQUE_SIZE(thread_data->td) - 1) {
+    thread_data->td.td_deque[thread_data->td.td_deque_tail] =
+        taskdata; // Push taskdata
+    // Wrap index.
+    thread_data->td.td_deque_tail =
+        (thread_data->td.td_deque_tail + 1) & TASK_DEQUE_MASK(thread_data->td);
+    // Publish the task to thieves, the atomic add is a full barrier
+    KMP_TEST_THEN_INC32(&thread_data->td.td_deque_ntasks);
+
+    KA_TRACE(20, ("__kmp_push_task: T#%d returning TASK_SUCCESSFULLY_PUSHED: "
+                  "task=%p ntasks=%d head=%u tail=%u (lock-free)\n",
+                  gtid, taskdata, thread_data->td.td_deque_ntasks,
+                  thread_data->td.td_deque_head,
+                  thread_data->td.td_deque_tail));
+    return TASK_SUCCESSFULLY_PUSHED;
+  }
+
   int locked = 0;
   // Check if deque is full
   if (TCR_4(thread_data->td.td_deque_ntasks) >=
@@ -2587,7 +2630,12 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
                 gtid, thread_data->td.td_deque_ntasks,
                 thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
 
-  if (TCR_4(thread_data->td.td_deque_ntasks) == 0) {
+  // Check the mode even if the deque is empty, a thread waiting for proxy
+  // tasks to be given to it has to switch to the locked mode first
+  bool lockfree = thread_data->td.td_deque != NULL &&
+                  __kmp_use_lockfree_deque(task_team, thread_data);
+
+  if (TCR_4(thread_data->td.td_deque_ntasks) <= 0) {
     KA_TRACE(10,
              ("__kmp_remove_my_task(exit #1): T#%d No tasks to remove: "
               "ntasks=%d head=%u tail=%u\n",
@@ -2596,6 +2644,47 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
     return NULL;
   }
 
+  if (lockfree) {
+    // Claim the tail task before looking at it, a thief may have claimed the
+    // last one in the meantime
+    if (KMP_TEST_THEN_DEC32(&thread_data->td.td_deque_ntasks) <= 0) {
+      KMP_TEST_THEN_INC32(&thread_data->td.td_deque_ntasks);
+      KA_TRACE(10,
+               ("__kmp_remove_my_task(exit #2): T#%d No tasks to remove: "
+                "ntasks=%d head=%u tail=%u (lock-free)\n",
+                gtid, thread_data->td.td_deque_ntasks,
+                thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+      return NULL;
+    }
+
+    tail = (thread_data->td.td_deque_tail - 1) &
+           TASK_DEQUE_MASK(thread_data->td); // Wrap index.
+    taskdata = thread_data->td.td_deque[tail];
+
+    if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata,
+                               thread->th.th_current_task)) {
+      // The TSC does not allow to steal victim task, give it back
+      KMP_TEST_THEN_INC32(&thread_data->td.td_deque_ntasks);
+      KA_TRACE(10,
+               ("__kmp_remove_my_task(exit #3): T#%d TSC blocks tail task: "
+                "ntasks=%d head=%u tail=%u (lock-free)\n",
+                gtid, thread_data->td.td_deque_ntasks,
+                thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+      return NULL;
+    }
+
+    thread_data->td.td_deque_tail = tail;
+
+    KA_TRACE(10, ("__kmp_remove_my_task(exit #4): T#%d task %p removed: "
+                  "ntasks=%d head=%u tail=%u (lock-free)\n",
+                  gtid, taskdata, thread_data->td.td_deque_ntasks,
+                  thread_data->td.td_deque_head,
+                  thread_data->td.td_deque_tail));
+
+    task = KMP_TASKDATA_TO_TASK(taskdata);
+    return task;
+  }
+
   __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
 
   if (TCR_4(thread_data->td.td_deque_ntasks) == 0) {
@@ -2691,6 +2780,53 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
 
   KMP_DEBUG_ASSERT(victim_td->td.td_deque != NULL);
   current = __kmp_threads[gtid]->th.th_current_task;
+  if (victim_td->td.td_deque_lockfree) {
+    // The victim pops from the tail without the lock, so claim the head task
+    // before looking at it. A finished thread counts itself back in first, as
+    // the victim may leave the barrier as soon as its deque looks empty.
+    if (*thread_finished)
+      KMP_ATOMIC_INC(unfinished_threads);
+    taskdata = NULL;
+    if (KMP_TEST_THEN_DEC32(&victim_td->td.td_deque_ntasks) > 0) {
+      taskdata = victim_td->td.td_deque[victim_td->td.td_deque_head];
+      if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata, current))
+        taskdata = NULL;
+    }
+    if (taskdata == NULL) {
+      // Lost the race for the last task, or the TSC does not allow to steal
+      // it; untied tasks are never stolen from the middle of a lock-free deque
+      KMP_TEST_THEN_INC32(&victim_td->td.td_deque_ntasks);
+      if (*thread_finished)
+        KMP_ATOMIC_DEC(unfinished_threads);
+      __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+      KA_TRACE(10, ("__kmp_steal_task(exit #3): T#%d could not steal from "
+                    "T#%d: task_team=%p ntasks=%d head=%u tail=%u "
+                    "(lock-free)\n",
+                    gtid, __kmp_gtid_from_thread(victim_thr), task_team, ntasks,
+                    victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
+      return NULL;
+    }
+    // Bump head pointer and Wrap.
+    victim_td->td.td_deque_head =
+        (victim_td->td.td_deque_head + 1) & TASK_DEQUE_MASK(victim_td->td);
+    if (*thread_finished) {
+      KA_TRACE(20, ("__kmp_steal_task: T#%d inc unfinished_threads: "
+                    "task_team=%p\n",
+                    gtid, task_team));
+      *thread_finished = FALSE;
+    }
+    __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+
+    KMP_COUNT_BLOCK(TASK_stolen);
+    KA_TRACE(10, ("__kmp_steal_task(exit #5): T#%d stole task %p from T#%d: "
+                  "task_team=%p ntasks=%d head=%u tail=%u (lock-free)\n",
+                  gtid, taskdata, __kmp_gtid_from_thread(victim_thr),
+                  task_team, ntasks, victim_td->td.td_deque_head,
+                  victim_td->td.td_deque_tail));
+
+    task = KMP_TASKDATA_TO_TASK(taskdata);
+    return task;
+  }
   taskdata = victim_td->td.td_deque[victim_td->td.td_deque_head];
   if (__kmp_task_is_allowed(gtid, is_constrained, taskdata, current)) {
     // Bump head pointer and Wrap.
@@ -3649,27 +3785,31 @@ static bool __kmp_give_task(kmp_info_t *thread, kmp_int32 tid, kmp_task_t *task,
     // thread
     if (TASK_DEQUE_SIZE(thread_data->td) / INITIAL_TASK_DEQUE_SIZE >= pass)
       return result;
+  }
 
-    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
-    __kmp_realloc_task_deque(thread, thread_data);
-
-  } else {
+  __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
 
-    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+  if (thread_data->td.td_deque_lockfree) {
+    // The owner has not seen the proxy task flag yet and may be pushing or
+    // popping without the lock, go find another thread
+    KA_TRACE(30, ("__kmp_give_task: queue is lock-free while giving task %p "
+                  "to thread %d.\n",
+                  taskdata, tid));
+    goto release_and_exit;
+  }
 
-    if (TCR_4(thread_data->td.td_deque_ntasks) >=
-        TASK_DEQUE_SIZE(thread_data->td)) {
-      KA_TRACE(30, ("__kmp_give_task: queue is full while giving task %p to "
-                    "thread %d.\n",
-                    taskdata, tid));
+  if (TCR_4(thread_data->td.td_deque_ntasks) >=
+      TASK_DEQUE_SIZE(thread_data->td)) {
+    KA_TRACE(30, ("__kmp_give_task: queue is full while giving task %p to "
+                  "thread %d.\n",
+                  taskdata, tid));
 
-      // if this deque is bigger than the pass ratio give a chance to another
-      // thread
-      if (TASK_DEQUE_SIZE(thread_data->td) / INITIAL_TASK_DEQUE_SIZE >= pass)
-        goto release_and_exit;
+    // if this deque is bigger than the pass ratio give a chance to another
+    // thread
+    if (TASK_DEQUE_SIZE(thread_data->td) / INITIAL_TASK_DEQUE_SIZE >= pass)
+      goto release_and_exit;
 
-      __kmp_realloc_task_deque(thread, thread_data);
-    }
+    __kmp_realloc_task_deque(thread, thread_data);
   }
 
   // lock is held here, and there is space in the deque
@@ -0,0 +1,72 @@
+// A microbenchmark of fork/join and barrier latency, which also checks that
+// the threads stay in step with every barrier pattern. Run it with -v to print
+// the average latencies, e.g. to compare KMP_*_BARRIER_PATTERN settings with
+// the ones picked from the machine topology.
+//
+// RUN: %libomp-compile-and-run
+// RUN: env KMP_TOPOLOGY_BARRIER=false %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=linear KMP_FORKJOIN_BARRIER_PATTERN=linear %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=tree KMP_FORKJOIN_BARRIER_PATTERN=tree %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=hyper KMP_PLAIN_BARRIER=4,4 KMP_FORKJOIN_BARRIER_PATTERN=hyper %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=hierarchical KMP_FORKJOIN_BARRIER_PATTERN=hierarchical %libomp-run
+#include <stdio.h>
+#include <string.h>
+#include "omp_testsuite.h"
+
+#define NUM_FORKS 2000
+#define NUM_BARRIERS 20000
+#define MAX_THREADS 1024
+
+// Each thread writes its own phase before the barrier, and checks the phases
+// of all the others after it.
+static volatile int phase[MAX_THREADS];
+
+int main(int argc, char *argv[]) {
+  int verbose = argc > 1 && !strcmp(argv[1], "-v");
+  int nthreads = omp_get_max_threads();
+  int errors = 0;
+  double start, fork_us, barrier_us;
+  int i;
+
+  if (nthreads > MAX_THREADS)
+    nthreads = MAX_THREADS;
+  if (nthreads < 4)
+    nthreads = 4;
+
+  // Warm up, so that thread creation does not count as fork/join latency.
+  #pragma omp parallel num_threads(nthreads)
+  {}
+
+  start = omp_get_wtime();
+  for (i = 0; i < NUM_FORKS; i++) {
+    #pragma omp parallel num_threads(nthreads)
+    phase[omp_get_thread_num()] = i;
+  }
+  fork_us = (omp_get_wtime() - start) * 1e6 / NUM_FORKS;
+
+  start = omp_get_wtime();
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    int tid = omp_get_thread_num();
+    int n = omp_get_num_threads();
+    int b, t;
+    for (b = 1; b <= NUM_BARRIERS; b++) {
+      phase[tid] = b;
+      #pragma omp barrier
+      // Only check now and then, so that the loop mostly times the barrier.
+      if (b % 1000 == 0)
+        for (t = 0; t < n; t++)
+          if (phase[t] != b)
+            errors++;
+      #pragma omp barrier
+    }
+  }
+  barrier_us = (omp_get_wtime() - start) * 1e6 / (2 * NUM_BARRIERS);
+
+  if (verbose)
+    printf("threads: %d, fork/join: %.3f us, barrier: %.3f us\n", nthreads,
+           fork_us, barrier_us);
+  if (errors)
+    fprintf(stderr, "threads were not in step %d times\n", errors);
+  return errors != 0;
+}
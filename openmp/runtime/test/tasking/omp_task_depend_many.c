@@ -0,0 +1,58 @@
+// RUN: %libomp-compile-and-run
+
+#include <stdio.h>
+
+/**
+ * Tasks with many depend items and a task graph over many more addresses
+ * than the dependence hash initially has buckets: every element of the array
+ * is written by its own chain of tasks, and a consumer task with a long
+ * depend clause (which also names some elements twice) has to see all of
+ * those writes.
+ */
+
+#define N 8192
+#define CHAIN 3
+#define GROUP 64
+
+#define D4(i) a[(i)], a[(i) + 1], a[(i) + 2], a[(i) + 3]
+#define D16(i) D4(i), D4((i) + 4), D4((i) + 8), D4((i) + 12)
+#define D64(i) D16(i), D16((i) + 16), D16((i) + 32), D16((i) + 48)
+
+static int a[N];
+static int sums[N / GROUP];
+
+int main() {
+  int i, j, errors = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    for (j = 0; j < CHAIN; j++) {
+      for (i = 0; i < N; i++) {
+        #pragma omp task depend(inout : a[i]) firstprivate(i)
+        a[i]++;
+      }
+    }
+    for (i = 0; i < N; i += GROUP) {
+      #pragma omp task depend(in : D64(i)) depend(in : D4(i)) firstprivate(i)
+      {
+        int k, sum = 0;
+        for (k = 0; k < GROUP; k++)
+          sum += a[i + k];
+        sums[i / GROUP] = sum;
+      }
+    }
+  }
+
+  for (i = 0; i < N / GROUP; i++) {
+    if (sums[i] != GROUP * CHAIN) {
+      fprintf(stderr, "group %d: sum %d, expected %d\n", i, sums[i],
+              GROUP * CHAIN);
+      errors++;
+    }
+  }
+  if (errors)
+    return 1;
+  printf("passed\n");
+  return 0;
+}
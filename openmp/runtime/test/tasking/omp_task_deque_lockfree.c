@@ -0,0 +1,73 @@
+// RUN: %libomp-compile && env KMP_LOCKFREE_TASK_DEQUE=0 %libomp-run
+// RUN: %libomp-compile && env KMP_LOCKFREE_TASK_DEQUE=1 %libomp-run
+
+#include <stdio.h>
+
+/**
+ * Stress the task deques of all threads: a recursive computation creates
+ * far more tasks than there are threads, so the owners push and pop their
+ * tails while idle threads steal from the heads and the last task of a deque
+ * is raced for. A second region runs untied tasks, which makes the owners
+ * switch their deques back to locked pushes and pops.
+ */
+
+#define N 22
+#define ROUNDS 4
+
+static int fib(int n) {
+  int x, y;
+  if (n < 2)
+    return n;
+  #pragma omp task shared(x) firstprivate(n)
+  x = fib(n - 1);
+  #pragma omp task shared(y) firstprivate(n)
+  y = fib(n - 2);
+  #pragma omp taskwait
+  return x + y;
+}
+
+static int fib_untied(int n) {
+  int x, y;
+  if (n < 2)
+    return n;
+  #pragma omp task shared(x) firstprivate(n) untied
+  x = fib_untied(n - 1);
+  #pragma omp task shared(y) firstprivate(n) untied
+  y = fib_untied(n - 2);
+  #pragma omp taskwait
+  return x + y;
+}
+
+static int fib_serial(int n) {
+  return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+int main() {
+  int i, result;
+  int expected = fib_serial(N);
+  int errors = 0;
+
+  for (i = 0; i < ROUNDS; i++) {
+    #pragma omp parallel shared(result)
+    #pragma omp single
+    result = fib(N);
+    if (result != expected) {
+      fprintf(stderr, "fib(%d) = %d, expected %d\n", N, result, expected);
+      errors++;
+    }
+
+    #pragma omp parallel shared(result)
+    #pragma omp single
+    result = fib_untied(N);
+    if (result != expected) {
+      fprintf(stderr, "untied fib(%d) = %d, expected %d\n", N, result,
+              expected);
+      errors++;
+    }
+  }
+
+  if (errors)
+    return 1;
+  printf("passed\n");
+  return 0;
+}
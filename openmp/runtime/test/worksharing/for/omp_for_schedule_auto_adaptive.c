@@ -0,0 +1,70 @@
+// RUN: %libomp-compile && env KMP_ADAPTIVE_AUTO_SCHEDULE=1 %libomp-run
+// RUN: %libomp-compile && env KMP_ADAPTIVE_AUTO_SCHEDULE=1 OMP_SCHEDULE=auto %libomp-run
+#include <stdio.h>
+#include <stdlib.h>
+#include "omp_testsuite.h"
+
+// With adaptive schedule(auto), each loop below is executed with every
+// candidate schedule while it is being tuned, and then with the fastest one.
+// Every iteration must still run exactly once, whatever the schedule.
+
+#define N 2000
+#define EXECUTIONS 40
+
+static int count[N];
+
+static void work(int i) {
+  // irregular iterations, the high ones are much more expensive
+  volatile int x = 0;
+  int k;
+  for (k = 0; k < (i * i) / 1000; k++)
+    x += k;
+  count[i]++;
+}
+
+int test_omp_for_auto_adaptive() {
+  int i, e, errors = 0;
+
+  for (i = 0; i < N; i++)
+    count[i] = 0;
+
+  for (e = 0; e < EXECUTIONS; e++) {
+    int n = e % 4 == 3 ? N / 7 : N; // the trip count changes over executions
+    #pragma omp parallel
+    {
+      #pragma omp for schedule(auto)
+      for (i = 0; i < n; i++)
+        work(i);
+      #pragma omp for schedule(runtime)
+      for (i = N - 1; i >= n; i--) // empty when n == N
+        work(i);
+      #pragma omp for schedule(auto) nowait
+      for (i = 0; i < N; i += 3)
+        count[i]--;
+      #pragma omp for schedule(auto)
+      for (i = 0; i < N; i += 3)
+        count[i]++;
+    }
+  }
+
+  for (i = 0; i < N; i++) {
+    if (count[i] != EXECUTIONS) {
+      fprintf(stderr, "iteration %d executed %d times, expected %d\n", i,
+              count[i], EXECUTIONS);
+      errors++;
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_omp_for_auto_adaptive()) {
+      num_failed++;
+    }
+  }
+  return num_failed;
+}
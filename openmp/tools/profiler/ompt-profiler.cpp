@@ -0,0 +1,602 @@
+/*
+ * ompt-profiler.cpp -- Lightweight OMPT profiling tool.
+ */
+
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// The profiler records, for every parallel region, worksharing loop and task
+// construct of the program (identified by its return address), how often it
+// ran, how long it took and how evenly the work was spread over the threads.
+// All statistics are gathered in per-thread tables without any locking and
+// are only merged when the runtime shuts down, at which point a summary is
+// printed and, if requested, a trace in the Chrome trace event format is
+// written.
+//
+// The tool is loaded by the runtime with
+//   OMP_TOOL_LIBRARIES=libompprofiler.so
+// and configured with space separated options in OMP_PROFILER_OPTIONS:
+//   summary=0|1      print the summary (default 1)
+//   output=<file>    write the summary to <file> instead of stderr
+//   trace=<file>     write a Chrome trace (chrome://tracing) to <file>
+//   trace_limit=<n>  keep at most <n> trace events per thread (default 1M)
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "omp-tools.h"
+
+namespace {
+
+class ProfilerFlags {
+public:
+  int Summary = 1;
+  std::string Output;
+  std::string Trace;
+  uint64_t TraceLimit = 1000000;
+
+  ProfilerFlags(const char *Env) {
+    if (!Env)
+      return;
+    std::istringstream Options(Env);
+    std::string Token;
+    while (Options >> Token) {
+      unsigned long long Limit;
+      if (sscanf(Token.c_str(), "summary=%d", &Summary))
+        continue;
+      if (sscanf(Token.c_str(), "trace_limit=%llu", &Limit)) {
+        TraceLimit = Limit;
+        continue;
+      }
+      if (Token.compare(0, 7, "output=") == 0) {
+        Output = Token.substr(7);
+        continue;
+      }
+      if (Token.compare(0, 6, "trace=") == 0) {
+        Trace = Token.substr(6);
+        continue;
+      }
+      fprintf(stderr, "Profiler: unknown option '%s' in OMP_PROFILER_OPTIONS\n",
+              Token.c_str());
+    }
+  }
+};
+
+ProfilerFlags *Flags;
+
+uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+enum class EventKind : uint8_t { Parallel, Loop, Barrier, Task };
+
+struct TraceEvent {
+  const void *Codeptr;
+  uint64_t Begin;
+  uint64_t End;
+  EventKind Kind;
+};
+
+struct RegionStats {
+  uint64_t Count = 0;
+  uint64_t Time = 0;
+  uint64_t MaxTime = 0;
+  // Sum over all executions of the busy time of the busiest thread and of
+  // the average busy time of the team; their ratio is the imbalance.
+  uint64_t MaxBusy = 0;
+  uint64_t MeanBusy = 0;
+  unsigned MaxThreads = 0;
+
+  void merge(const RegionStats &Other) {
+    Count += Other.Count;
+    Time += Other.Time;
+    MaxTime = std::max(MaxTime, Other.MaxTime);
+    MaxBusy += Other.MaxBusy;
+    MeanBusy += Other.MeanBusy;
+    MaxThreads = std::max(MaxThreads, Other.MaxThreads);
+  }
+};
+
+struct LoopStats {
+  uint64_t Count = 0;
+  uint64_t Iterations = 0;
+  uint64_t Time = 0;
+};
+
+struct TaskStats {
+  uint64_t Created = 0;
+  uint64_t Executed = 0;
+  uint64_t Time = 0;
+};
+
+/// Everything one thread records. Only the owning thread touches it until
+/// the runtime shuts down.
+struct ThreadData {
+  uint64_t Id;
+  std::unordered_map<const void *, RegionStats> Regions;
+  std::unordered_map<const void *, LoopStats> Loops;
+  std::unordered_map<const void *, TaskStats> Tasks;
+  std::vector<TraceEvent> Events;
+  uint64_t DroppedEvents = 0;
+  // Begin time and trip count of the worksharing loops being executed.
+  std::vector<std::pair<uint64_t, uint64_t>> LoopBegin;
+  // Total time this thread spent executing explicit tasks.
+  uint64_t TaskTime = 0;
+
+  explicit ThreadData(uint64_t Id) : Id(Id) {}
+
+  void record(EventKind Kind, const void *Codeptr, uint64_t Begin,
+              uint64_t End) {
+    if (Flags->Trace.empty())
+      return;
+    if (Events.size() >= Flags->TraceLimit) {
+      DroppedEvents++;
+      return;
+    }
+    Events.push_back({Codeptr, Begin, End, Kind});
+  }
+};
+
+// The registry of all threads is allocated by ompt_start_tool and only freed
+// by ompt_finalize: the runtime shuts down after the static destructors of
+// the tool have run.
+std::mutex *ThreadsMutex;
+std::vector<std::unique_ptr<ThreadData>> *Threads;
+thread_local ThreadData *CurrentThread;
+
+ThreadData *getThreadData() {
+  if (!CurrentThread) {
+    std::lock_guard<std::mutex> Lock(*ThreadsMutex);
+    Threads->emplace_back(new ThreadData(Threads->size()));
+    CurrentThread = Threads->back().get();
+  }
+  return CurrentThread;
+}
+
+struct ParallelData {
+  const void *Codeptr;
+  uint64_t Begin;
+  unsigned TeamSize;
+  // Busy time of every thread of the team when it arrived at its last
+  // barrier. Each thread only writes its own slot, and the master reads them
+  // after the closing barrier.
+  std::vector<uint64_t> Busy;
+
+  ParallelData(const void *Codeptr, unsigned RequestedSize)
+      : Codeptr(Codeptr), Begin(now()), TeamSize(RequestedSize),
+        Busy(RequestedSize) {}
+};
+
+/// Common part of the data attached to implicit and explicit tasks, which
+/// both show up in the task scheduling callback.
+struct TaskBase {
+  bool Implicit;
+  explicit TaskBase(bool Implicit) : Implicit(Implicit) {}
+};
+
+struct ImplicitTaskData : TaskBase {
+  ParallelData *Parallel;
+  unsigned ThreadNum;
+  uint64_t Begin;
+  // Time spent idle in the barriers of the region so far.
+  uint64_t Idle = 0;
+  uint64_t BarrierBegin = 0;
+  uint64_t TaskTimeAtBarrier = 0;
+
+  ImplicitTaskData(ParallelData *Parallel, unsigned ThreadNum)
+      : TaskBase(true), Parallel(Parallel), ThreadNum(ThreadNum),
+        Begin(now()) {}
+};
+
+struct ExplicitTaskData : TaskBase {
+  const void *Codeptr;
+  uint64_t Resumed = 0;
+  uint64_t Time = 0;
+
+  explicit ExplicitTaskData(const void *Codeptr)
+      : TaskBase(false), Codeptr(Codeptr) {}
+};
+
+void on_ompt_callback_parallel_begin(ompt_data_t *encountering_task_data,
+                                     const ompt_frame_t *encountering_frame,
+                                     ompt_data_t *parallel_data,
+                                     uint32_t requested_team_size, int flag,
+                                     const void *codeptr_ra) {
+  // The leagues of a teams construct are not profiled.
+  if (!(flag & ompt_parallel_team))
+    return;
+  parallel_data->ptr = new ParallelData(codeptr_ra, requested_team_size);
+}
+
+void on_ompt_callback_parallel_end(ompt_data_t *parallel_data,
+                                   ompt_data_t *encountering_task_data,
+                                   int flag, const void *codeptr_ra) {
+  ParallelData *Data = static_cast<ParallelData *>(parallel_data->ptr);
+  if (!Data)
+    return;
+  uint64_t End = now();
+  uint64_t Time = End - Data->Begin;
+  uint64_t MaxBusy = 0, SumBusy = 0;
+  unsigned TeamSize = std::min<unsigned>(Data->TeamSize, Data->Busy.size());
+  for (unsigned I = 0; I < TeamSize; I++) {
+    MaxBusy = std::max(MaxBusy, Data->Busy[I]);
+    SumBusy += Data->Busy[I];
+  }
+
+  ThreadData *Thread = getThreadData();
+  RegionStats &Stats = Thread->Regions[Data->Codeptr];
+  Stats.Count++;
+  Stats.Time += Time;
+  Stats.MaxTime = std::max(Stats.MaxTime, Time);
+  Stats.MaxBusy += MaxBusy;
+  Stats.MeanBusy += TeamSize ? SumBusy / TeamSize : 0;
+  Stats.MaxThreads = std::max(Stats.MaxThreads, TeamSize);
+  Thread->record(EventKind::Parallel, Data->Codeptr, Data->Begin, End);
+
+  parallel_data->ptr = nullptr;
+  delete Data;
+}
+
+void on_ompt_callback_implicit_task(ompt_scope_endpoint_t endpoint,
+                                    ompt_data_t *parallel_data,
+                                    ompt_data_t *task_data,
+                                    unsigned int team_size,
+                                    unsigned int thread_num, int flags) {
+  if (endpoint == ompt_scope_begin) {
+    ParallelData *Parallel = nullptr;
+    if (!(flags & ompt_task_initial) && parallel_data)
+      Parallel = static_cast<ParallelData *>(parallel_data->ptr);
+    if (Parallel && thread_num == 0)
+      Parallel->TeamSize = team_size;
+    task_data->ptr = new ImplicitTaskData(Parallel, thread_num);
+    return;
+  }
+  // The workers of a team report the end of their implicit task only when
+  // the next region starts, so the region's data must not be touched here.
+  delete static_cast<ImplicitTaskData *>(task_data->ptr);
+  task_data->ptr = nullptr;
+}
+
+void on_ompt_callback_sync_region(ompt_sync_region_t kind,
+                                  ompt_scope_endpoint_t endpoint,
+                                  ompt_data_t *parallel_data,
+                                  ompt_data_t *task_data,
+                                  const void *codeptr_ra) {
+  if (kind != ompt_sync_region_barrier &&
+      kind != ompt_sync_region_barrier_implicit &&
+      kind != ompt_sync_region_barrier_explicit &&
+      kind != ompt_sync_region_barrier_implementation)
+    return;
+  TaskBase *Task = static_cast<TaskBase *>(task_data->ptr);
+  if (!Task || !Task->Implicit)
+    return;
+  ImplicitTaskData *Data = static_cast<ImplicitTaskData *>(Task);
+  ThreadData *Thread = getThreadData();
+  uint64_t Time = now();
+
+  if (endpoint == ompt_scope_begin) {
+    Data->BarrierBegin = Time;
+    Data->TaskTimeAtBarrier = Thread->TaskTime;
+    ParallelData *Parallel = Data->Parallel;
+    if (Parallel && Data->ThreadNum < Parallel->Busy.size())
+      Parallel->Busy[Data->ThreadNum] = Time - Data->Begin - Data->Idle;
+    return;
+  }
+  // Tasks run while waiting in the barrier are work, not idle time.
+  uint64_t Wait = Time - Data->BarrierBegin;
+  uint64_t TaskTime = Thread->TaskTime - Data->TaskTimeAtBarrier;
+  Data->Idle += Wait > TaskTime ? Wait - TaskTime : 0;
+  Thread->record(EventKind::Barrier, codeptr_ra, Data->BarrierBegin, Time);
+}
+
+void on_ompt_callback_work(ompt_work_t wstype, ompt_scope_endpoint_t endpoint,
+                           ompt_data_t *parallel_data, ompt_data_t *task_data,
+                           uint64_t count, const void *codeptr_ra) {
+  if (wstype != ompt_work_loop)
+    return;
+  ThreadData *Thread = getThreadData();
+  if (endpoint == ompt_scope_begin) {
+    Thread->LoopBegin.emplace_back(now(), count);
+    return;
+  }
+  // An untied task may have begun the loop on another thread.
+  if (Thread->LoopBegin.empty())
+    return;
+  uint64_t Begin = Thread->LoopBegin.back().first;
+  uint64_t Iterations = Thread->LoopBegin.back().second;
+  Thread->LoopBegin.pop_back();
+  uint64_t End = now();
+  LoopStats &Stats = Thread->Loops[codeptr_ra];
+  Stats.Count++;
+  Stats.Iterations += Iterations;
+  Stats.Time += End - Begin;
+  Thread->record(EventKind::Loop, codeptr_ra, Begin, End);
+}
+
+void on_ompt_callback_task_create(ompt_data_t *encountering_task_data,
+                                  const ompt_frame_t *encountering_task_frame,
+                                  ompt_data_t *new_task_data, int type,
+                                  int has_dependences,
+                                  const void *codeptr_ra) {
+  if (!(type & ompt_task_explicit))
+    return;
+  new_task_data->ptr = new ExplicitTaskData(codeptr_ra);
+  getThreadData()->Tasks[codeptr_ra].Created++;
+}
+
+void on_ompt_callback_task_schedule(ompt_data_t *first_task_data,
+                                    ompt_task_status_t prior_task_status,
+                                    ompt_data_t *second_task_data) {
+  ThreadData *Thread = getThreadData();
+  uint64_t Time = now();
+
+  TaskBase *Prior = static_cast<TaskBase *>(first_task_data->ptr);
+  if (Prior && !Prior->Implicit) {
+    ExplicitTaskData *Task = static_cast<ExplicitTaskData *>(Prior);
+    if (!Task->Resumed)
+      Task->Resumed = Time;
+    uint64_t Segment = Time - Task->Resumed;
+    Task->Time += Segment;
+    Thread->TaskTime += Segment;
+    Thread->record(EventKind::Task, Task->Codeptr, Task->Resumed, Time);
+    if (prior_task_status == ompt_task_complete ||
+        prior_task_status == ompt_task_cancel) {
+      TaskStats &Stats = Thread->Tasks[Task->Codeptr];
+      Stats.Executed++;
+      Stats.Time += Task->Time;
+      first_task_data->ptr = nullptr;
+      delete Task;
+    }
+  }
+
+  TaskBase *Next = second_task_data ? static_cast<TaskBase *>(
+                                          second_task_data->ptr)
+                                    : nullptr;
+  if (Next && !Next->Implicit)
+    static_cast<ExplicitTaskData *>(Next)->Resumed = Time;
+}
+
+/// Describes a code location as "function+offset (module)" if the symbol is
+/// known, and by its address otherwise.
+std::string describe(const void *Codeptr) {
+  char Buffer[64];
+  Dl_info Info;
+  if (Codeptr && dladdr(Codeptr, &Info) && Info.dli_fname) {
+    const char *Module = strrchr(Info.dli_fname, '/');
+    Module = Module ? Module + 1 : Info.dli_fname;
+    std::string Result;
+    if (Info.dli_sname) {
+      snprintf(Buffer, sizeof(Buffer), "+0x%tx",
+               (const char *)Codeptr - (const char *)Info.dli_saddr);
+      Result = std::string(Info.dli_sname) + Buffer;
+    } else {
+      snprintf(Buffer, sizeof(Buffer), "%p", Codeptr);
+      Result = Buffer;
+    }
+    return Result + " (" + Module + ")";
+  }
+  snprintf(Buffer, sizeof(Buffer), "%p", Codeptr);
+  return Buffer;
+}
+
+double toMs(uint64_t Ns) { return Ns / 1e6; }
+
+template <typename StatsT>
+std::vector<std::pair<const void *, StatsT>>
+sortByTime(const std::unordered_map<const void *, StatsT> &Map) {
+  std::vector<std::pair<const void *, StatsT>> Sorted(Map.begin(), Map.end());
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const std::pair<const void *, StatsT> &A,
+               const std::pair<const void *, StatsT> &B) {
+              return A.second.Time > B.second.Time;
+            });
+  return Sorted;
+}
+
+void printSummary(FILE *Out) {
+  std::unordered_map<const void *, RegionStats> Regions;
+  std::unordered_map<const void *, LoopStats> Loops;
+  // Per loop: the total and the largest time any single thread spent in it.
+  std::unordered_map<const void *, uint64_t> LoopMaxThreadTime;
+  std::unordered_map<const void *, unsigned> LoopThreads;
+  std::unordered_map<const void *, TaskStats> Tasks;
+  uint64_t Dropped = 0;
+
+  for (auto &Thread : *Threads) {
+    for (auto &Region : Thread->Regions)
+      Regions[Region.first].merge(Region.second);
+    for (auto &Loop : Thread->Loops) {
+      LoopStats &Stats = Loops[Loop.first];
+      // Every thread of the team reports each execution of the loop.
+      Stats.Count = std::max(Stats.Count, Loop.second.Count);
+      Stats.Iterations += Loop.second.Iterations;
+      Stats.Time += Loop.second.Time;
+      uint64_t &Max = LoopMaxThreadTime[Loop.first];
+      Max = std::max(Max, Loop.second.Time);
+      LoopThreads[Loop.first]++;
+    }
+    for (auto &Task : Thread->Tasks) {
+      TaskStats &Stats = Tasks[Task.first];
+      Stats.Created += Task.second.Created;
+      Stats.Executed += Task.second.Executed;
+      Stats.Time += Task.second.Time;
+    }
+    Dropped += Thread->DroppedEvents;
+  }
+
+  fprintf(Out, "OpenMP profile: %zu threads, %zu parallel regions, %zu loops, "
+               "%zu task constructs\n",
+          Threads->size(), Regions.size(), Loops.size(), Tasks.size());
+
+  if (!Regions.empty()) {
+    fprintf(Out, "\nParallel regions:\n");
+    fprintf(Out, "%10s %12s %10s %10s %7s %9s  %s\n", "count", "total(ms)",
+            "mean(ms)", "max(ms)", "threads", "imbalance", "location");
+    for (auto &Region : sortByTime(Regions)) {
+      const RegionStats &Stats = Region.second;
+      double Imbalance =
+          Stats.MaxBusy ? 100.0 * (Stats.MaxBusy - Stats.MeanBusy) /
+                              Stats.MaxBusy
+                        : 0.0;
+      fprintf(Out, "%10" PRIu64 " %12.3f %10.3f %10.3f %7u %8.1f%%  %s\n",
+              Stats.Count, toMs(Stats.Time), toMs(Stats.Time) / Stats.Count,
+              toMs(Stats.MaxTime), Stats.MaxThreads, Imbalance,
+              describe(Region.first).c_str());
+    }
+  }
+
+  if (!Loops.empty()) {
+    fprintf(Out, "\nWorksharing loops:\n");
+    fprintf(Out, "%10s %12s %12s %12s %9s  %s\n", "count", "iterations",
+            "thread(ms)", "max(ms)", "imbalance", "location");
+    for (auto &Loop : sortByTime(Loops)) {
+      const LoopStats &Stats = Loop.second;
+      uint64_t Max = LoopMaxThreadTime[Loop.first];
+      double Mean = (double)Stats.Time / LoopThreads[Loop.first];
+      double Imbalance = Max ? 100.0 * (Max - Mean) / Max : 0.0;
+      fprintf(Out, "%10" PRIu64 " %12" PRIu64 " %12.3f %12.3f %8.1f%%  %s\n",
+              Stats.Count, Stats.Iterations, toMs(Stats.Time), toMs(Max),
+              Imbalance, describe(Loop.first).c_str());
+    }
+  }
+
+  if (!Tasks.empty()) {
+    fprintf(Out, "\nTasks:\n");
+    fprintf(Out, "%10s %10s %12s %10s  %s\n", "created", "executed",
+            "total(ms)", "mean(us)", "location");
+    for (auto &Task : sortByTime(Tasks)) {
+      const TaskStats &Stats = Task.second;
+      fprintf(Out, "%10" PRIu64 " %10" PRIu64 " %12.3f %10.3f  %s\n",
+              Stats.Created, Stats.Executed, toMs(Stats.Time),
+              Stats.Executed ? Stats.Time / 1e3 / Stats.Executed : 0.0,
+              describe(Task.first).c_str());
+    }
+  }
+
+  if (Dropped)
+    fprintf(Out, "\n%" PRIu64 " trace events were dropped, increase "
+                 "trace_limit to keep them\n",
+            Dropped);
+}
+
+void writeTrace(FILE *Out) {
+  static const char *const KindNames[] = {"parallel", "loop", "barrier",
+                                          "task"};
+  std::unordered_map<const void *, std::string> Names;
+  uint64_t Origin = UINT64_MAX;
+  for (auto &Thread : *Threads)
+    for (const TraceEvent &Event : Thread->Events)
+      Origin = std::min(Origin, Event.Begin);
+
+  int Pid = getpid();
+  bool First = true;
+  fprintf(Out, "{\"traceEvents\":[\n");
+  for (auto &Thread : *Threads) {
+    for (const TraceEvent &Event : Thread->Events) {
+      auto It = Names.find(Event.Codeptr);
+      if (It == Names.end())
+        It = Names.emplace(Event.Codeptr, describe(Event.Codeptr)).first;
+      std::string Name;
+      for (char C : It->second) {
+        if (C == '"' || C == '\\')
+          Name += '\\';
+        Name += C;
+      }
+      const char *Kind = KindNames[static_cast<int>(Event.Kind)];
+      fprintf(Out,
+              "%s{\"name\":\"%s %s\",\"cat\":\"%s\",\"ph\":\"X\","
+              "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%" PRIu64 "}",
+              First ? "" : ",\n", Kind, Name.c_str(), Kind,
+              (Event.Begin - Origin) / 1e3, (Event.End - Event.Begin) / 1e3,
+              Pid, Thread->Id);
+      First = false;
+    }
+  }
+  fprintf(Out, "\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+int ompt_initialize(ompt_function_lookup_t lookup, int device_num,
+                    ompt_data_t *tool_data) {
+  ompt_set_callback_t ompt_set_callback =
+      (ompt_set_callback_t)lookup("ompt_set_callback");
+  if (!ompt_set_callback)
+    return 0; // failed
+
+#define SET_CALLBACK(event)                                                    \
+  ompt_set_callback(ompt_callback_##event,                                     \
+                    (ompt_callback_t)&on_ompt_callback_##event)
+
+  SET_CALLBACK(parallel_begin);
+  SET_CALLBACK(parallel_end);
+  SET_CALLBACK(implicit_task);
+  SET_CALLBACK(sync_region);
+  SET_CALLBACK(work);
+  SET_CALLBACK(task_create);
+  SET_CALLBACK(task_schedule);
+#undef SET_CALLBACK
+
+  return 1; // success
+}
+
+// The runtime has reaped its worker threads when it finalizes the tool, so
+// nothing records any more.
+void ompt_finalize(ompt_data_t *tool_data) {
+  if (Flags->Summary) {
+    FILE *Out = stderr;
+    if (!Flags->Output.empty() &&
+        !(Out = fopen(Flags->Output.c_str(), "w"))) {
+      fprintf(stderr, "Profiler: cannot open '%s', printing to stderr\n",
+              Flags->Output.c_str());
+      Out = stderr;
+    }
+    printSummary(Out);
+    if (Out != stderr)
+      fclose(Out);
+  }
+  if (!Flags->Trace.empty()) {
+    if (FILE *Out = fopen(Flags->Trace.c_str(), "w")) {
+      writeTrace(Out);
+      fclose(Out);
+    } else {
+      fprintf(stderr, "Profiler: cannot open trace file '%s'\n",
+              Flags->Trace.c_str());
+    }
+  }
+  delete Threads;
+  delete ThreadsMutex;
+  delete Flags;
+  Threads = nullptr;
+  ThreadsMutex = nullptr;
+  Flags = nullptr;
+}
+
+} // namespace
+
+extern "C" ompt_start_tool_result_t *
+ompt_start_tool(unsigned int omp_version, const char *runtime_version) {
+  static ompt_start_tool_result_t ompt_start_tool_result = {
+      &ompt_initialize, &ompt_finalize, {0}};
+  Flags = new ProfilerFlags(getenv("OMP_PROFILER_OPTIONS"));
+  ThreadsMutex = new std::mutex;
+  Threads = new std::vector<std::unique_ptr<ThreadData>>;
+  return &ompt_start_tool_result;
+}
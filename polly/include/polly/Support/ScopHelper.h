@@ -13,10 +13,12 @@
 #ifndef POLLY_SUPPORT_IRHELPER_H
 #define POLLY_SUPPORT_IRHELPER_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/Timer.h"
 
 namespace llvm {
 class LoopInfo;
@@ -497,5 +499,19 @@ bool isDebugCall(llvm::Instruction *Inst);
 ///
 /// Such a statement must not be removed, even if has no side-effects.
 bool hasDebugCall(ScopStmt *Stmt);
+
+/// Measure the time spent in one phase of processing the SCoP of a region.
+///
+/// Only if -polly-time-scops is given; the times are printed when the
+/// compiler exits, in a table with one row per SCoP and phase. The time of a
+/// phase that runs several times for the same SCoP is added up.
+class ScopPhaseTimer {
+  llvm::Optional<llvm::NamedRegionTimer> Timer;
+
+public:
+  /// @param R     The region of the SCoP.
+  /// @param Phase The name of the phase, e.g. "dependences".
+  ScopPhaseTimer(const llvm::Region &R, llvm::StringRef Phase);
+};
 } // namespace polly
 #endif
@@ -25,6 +25,7 @@
 #include "polly/ScopInfo.h"
 #include "polly/Support/GICHelper.h"
 #include "polly/Support/ISLTools.h"
+#include "polly/Support/ScopHelper.h"
 #include "llvm/Support/Debug.h"
 #include "isl/aff.h"
 #include "isl/ctx.h"
@@ -46,6 +47,12 @@ static cl::opt<int> OptComputeOut(
              "computational steps (0 means no bound)"),
     cl::Hidden, cl::init(500000), cl::ZeroOrMore, cl::cat(PollyCategory));
 
+static cl::opt<unsigned> OptMaxAccesses(
+    "polly-dependences-max-accesses",
+    cl::desc("Do not compute the dependences of a scop with more memory "
+             "accesses than this (0 means no bound)"),
+    cl::Hidden, cl::init(0), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<bool> LegalityCheckDisabled(
     "disable-polly-legality", cl::desc("Disable polly legality check"),
     cl::Hidden, cl::init(false), cl::ZeroOrMore, cl::cat(PollyCategory));
@@ -410,8 +417,24 @@ void Dependences::calculateDependences(Scop &S) {
   isl_schedule *Schedule;
   isl_union_set *TaggedStmtDomain;
 
+  ScopPhaseTimer Timer(S.getRegion(), "dependences");
+
   LLVM_DEBUG(dbgs() << "Scop: \n" << S << "\n");
 
+  // Like running out of the quota below, but without wasting the time it
+  // takes to get there: the dependences stay invalid.
+  if (OptMaxAccesses > 0) {
+    unsigned NumAccesses = 0;
+    for (ScopStmt &Stmt : S)
+      NumAccesses += Stmt.size();
+    if (NumAccesses > OptMaxAccesses) {
+      LLVM_DEBUG(dbgs() << "Too many memory accesses (" << NumAccesses
+                        << "), not computing dependences\n");
+      RAW = WAW = WAR = RED = TC_RED = nullptr;
+      return;
+    }
+  }
+
   collectInfo(S, Read, MustWrite, MayWrite, ReductionTagMap, TaggedStmtDomain,
               Level);
 
@@ -941,15 +964,9 @@ DependenceInfoPrinterPass::run(Scop &S, ScopAnalysisManager &SAM,
                                SPMUpdater &U) {
   auto &DI = SAM.getResult<DependenceAnalysis>(S, SAR);
 
-  if (auto d = DI.D[OptAnalysisLevel].get()) {
-    d->print(OS);
-    return PreservedAnalyses::all();
-  }
-
-  // Otherwise create the dependences on-the-fly and print them
-  Dependences D(S.getSharedIslCtx(), OptAnalysisLevel);
-  D.calculateDependences(S);
-  D.print(OS);
+  // Compute the dependences through the analysis result, if they are not
+  // known yet, so that the passes after the printer can use them as well.
+  DI.getDependences(OptAnalysisLevel).print(OS);
 
   return PreservedAnalyses::all();
 }
@@ -1020,8 +1037,10 @@ const Dependences &DependenceInfoWrapperPass::recomputeDependences(
     Scop *S, Dependences::AnalysisLevel Level) {
   std::unique_ptr<Dependences> D(new Dependences(S->getSharedIslCtx(), Level));
   D->calculateDependences(*S);
-  auto Inserted = ScopToDepsMap.insert(std::make_pair(S, std::move(D)));
-  return *Inserted.first->second;
+  // Replace the dependences of another level; inserting would keep them.
+  std::unique_ptr<Dependences> &Entry = ScopToDepsMap[S];
+  Entry = std::move(D);
+  return *Entry;
 }
 
 bool DependenceInfoWrapperPass::runOnFunction(Function &F) {
@@ -86,6 +86,12 @@ static cl::opt<int>
                   cl::Hidden, cl::init(800000), cl::ZeroOrMore,
                   cl::cat(PollyCategory));
 
+static cl::opt<unsigned> MaxAccesses(
+    "polly-scop-max-accesses",
+    cl::desc("Give up on a scop with more memory accesses than this before "
+             "its domains are built (0 means no bound)"),
+    cl::Hidden, cl::init(0), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<bool> PollyAllowDereferenceOfAllFunctionParams(
     "polly-allow-dereference-of-all-function-parameters",
     cl::desc(
@@ -3587,6 +3593,7 @@ static void verifyUses(Scop *S, LoopInfo &LI, DominatorTree &DT) {
 #endif
 
 void ScopBuilder::buildScop(Region &R, AssumptionCache &AC) {
+  ScopPhaseTimer Timer(R, "build");
   scop.reset(new Scop(R, SE, LI, DT, *SD.getDetectionContext(&R), ORE));
 
   buildStmts(R);
@@ -3619,6 +3626,21 @@ void ScopBuilder::buildScop(Region &R, AssumptionCache &AC) {
   }
   buildAccessFunctions();
 
+  // Everything that follows, starting with the domains, gets more expensive
+  // with every access; give up before spending the time on a scop that is
+  // too big to be worth it.
+  if (MaxAccesses > 0) {
+    unsigned NumAccesses = 0;
+    for (ScopStmt &Stmt : *scop)
+      NumAccesses += Stmt.size();
+    if (NumAccesses > MaxAccesses) {
+      LLVM_DEBUG(dbgs() << "Bailing-out because the scop has too many "
+                           "memory accesses\n");
+      scop->invalidate(COMPLEXITY, DebugLoc());
+      return;
+    }
+  }
+
   // In case the region does not have an exiting block we will later (during
   // code generation) split the exit block. This will move potential PHI nodes
   // from the current exit block into the new region exiting block. Hence, PHI
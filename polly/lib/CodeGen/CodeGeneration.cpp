@@ -191,6 +191,8 @@ static bool CodeGen(Scop &S, IslAstInfo &AI, LoopInfo &LI, DominatorTree &DT,
   if (!AstRoot)
     return false;
 
+  ScopPhaseTimer Timer(S.getRegion(), "codegen");
+
   // Collect statistics. Do it before we modify the IR to avoid having it any
   // influence on the result.
   auto ScopStats = S.getStatistics();
@@ -35,6 +35,7 @@
 #include "polly/ScopInfo.h"
 #include "polly/ScopPass.h"
 #include "polly/Support/GICHelper.h"
+#include "polly/Support/ScopHelper.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Support/Debug.h"
@@ -572,6 +573,7 @@ void IslAst::init(const Dependences &D) {
 }
 
 IslAst IslAst::create(Scop &Scop, const Dependences &D) {
+  ScopPhaseTimer Timer(Scop.getRegion(), "ast");
   IslAst Ast{Scop};
   Ast.init(D);
   return Ast;
@@ -38,6 +38,11 @@ static cl::list<std::string> DebugFunctions(
              "Polly-transformed code."),
     cl::Hidden, cl::ZeroOrMore, cl::CommaSeparated, cl::cat(PollyCategory));
 
+static cl::opt<bool> PollyTimeScops(
+    "polly-time-scops",
+    cl::desc("Report the time spent in each phase of processing each SCoP"),
+    cl::Hidden, cl::init(false), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 // Ensures that there is just one predecessor to the entry node from outside the
 // region.
 // The identity of the region entry node is preserved.
@@ -762,3 +767,13 @@ bool polly::hasDebugCall(ScopStmt *Stmt) {
 
   return false;
 }
+
+ScopPhaseTimer::ScopPhaseTimer(const Region &R, StringRef Phase) {
+  if (!PollyTimeScops)
+    return;
+  std::string Name =
+      (R.getEntry()->getParent()->getName() + ":" + R.getNameStr() + " " +
+       Phase)
+          .str();
+  Timer.emplace(Name, Name, "polly-scops", "Polly SCoP Processing Time");
+}
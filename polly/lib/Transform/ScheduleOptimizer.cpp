@@ -55,6 +55,7 @@
 #include "polly/ScopPass.h"
 #include "polly/Simplify.h"
 #include "polly/Support/ISLOStream.h"
+#include "polly/Support/ScopHelper.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/Function.h"
@@ -579,60 +580,79 @@ isl::map permuteDimensions(isl::map Map, isl::dim DimType, unsigned DstPos,
   return Map;
 }
 
+/// Get the loop dimensions that index an operand of a contraction.
+///
+/// Check that the access relation @p AccMap has the form
+/// S[i0, ..., in] -> M[i_p0, ..., i_pm] on all of @p Domain, where p0, ...,
+/// pm are distinct, and return p0, ..., pm in @p Dims.
+///
+/// @param Domain The domain of the statement that performs the access.
+/// @param AccMap The access relation to be checked.
+/// @param Dims   The indices of the input dimensions that are mapped to the
+///               output dimensions.
+/// @return       True in case @p AccMap has the expected form and false,
+///               otherwise.
+static bool getOperandDims(isl::set Domain, isl::map AccMap,
+                           SmallVectorImpl<int> &Dims) {
+  AccMap = AccMap.intersect_domain(Domain);
+  isl::map Universe = isl::map::universe(AccMap.get_space());
+  isl::map Expected = Universe;
+  int InDims = AccMap.dim(isl::dim::in);
+  int OutDims = AccMap.dim(isl::dim::out);
+  Dims.clear();
+  for (int Out = 0; Out < OutDims; Out++) {
+    int In = 0;
+    for (; In < InDims; In++)
+      if (AccMap.is_subset(
+              Universe.equate(isl::dim::in, In, isl::dim::out, Out)))
+        break;
+    if (In == InDims || is_contained(Dims, In))
+      return false;
+    Dims.push_back(In);
+    Expected = Expected.equate(isl::dim::in, In, isl::dim::out, Out);
+  }
+
+  // If AccMap does not span the entire domain, the accesses are not complete,
+  // or in other words, it is a partial access and those must be rejected.
+  return AccMap.is_equal(Expected.intersect_domain(Domain));
+}
+
 /// Check the form of the access relation.
 ///
-/// Check that the access relation @p AccMap has the form M[i][j], where i
-/// is a @p FirstPos and j is a @p SecondPos.
+/// Check that the access relation @p AccMap has the form
+/// M[..., i][j], where i is a @p FirstPos and j is a @p SecondPos. The
+/// leading dimensions, if any, are the batch dimensions of a batched matrix
+/// multiplication, or the free dimensions of a tensor contraction.
 ///
 /// @param AccMap    The access relation to be checked.
 /// @param FirstPos  The index of the input dimension that is mapped to
-///                  the first output dimension.
+///                  the second to last output dimension.
 /// @param SecondPos The index of the input dimension that is mapped to the
-///                  second output dimension.
+///                  last output dimension.
 /// @return          True in case @p AccMap has the expected form and false,
 ///                  otherwise.
 static bool isMatMulOperandAcc(isl::set Domain, isl::map AccMap, int &FirstPos,
                                int &SecondPos) {
-  isl::space Space = AccMap.get_space();
-  isl::map Universe = isl::map::universe(Space);
-
-  if (Space.dim(isl::dim::out) != 2)
-    return false;
-
   // MatMul has the form:
   // for (i = 0; i < N; i++)
   //   for (j = 0; j < M; j++)
   //     for (k = 0; k < P; k++)
   //       C[i, j] += A[i, k] * B[k, j]
   //
-  // Permutation of three outer loops: 3! = 6 possibilities.
-  int FirstDims[] = {0, 0, 1, 1, 2, 2};
-  int SecondDims[] = {1, 2, 2, 0, 0, 1};
-  for (int i = 0; i < 6; i += 1) {
-    auto PossibleMatMul =
-        Universe.equate(isl::dim::in, FirstDims[i], isl::dim::out, 0)
-            .equate(isl::dim::in, SecondDims[i], isl::dim::out, 1);
-
-    AccMap = AccMap.intersect_domain(Domain);
-    PossibleMatMul = PossibleMatMul.intersect_domain(Domain);
-
-    // If AccMap spans entire domain (Non-partial write),
-    // compute FirstPos and SecondPos.
-    // If AccMap != PossibleMatMul here (the two maps have been gisted at
-    // this point), it means that the writes are not complete, or in other
-    // words, it is a Partial write and Partial writes must be rejected.
-    if (AccMap.is_equal(PossibleMatMul)) {
-      if (FirstPos != -1 && FirstPos != FirstDims[i])
-        continue;
-      FirstPos = FirstDims[i];
-      if (SecondPos != -1 && SecondPos != SecondDims[i])
-        continue;
-      SecondPos = SecondDims[i];
-      return true;
-    }
-  }
+  // in any permutation of the loops. A batched MatMul or a tensor contraction
+  // wraps it in further loops, which index all of C and some of A and B.
+  SmallVector<int, 4> Dims;
+  if (!getOperandDims(Domain, AccMap, Dims) || Dims.size() < 2)
+    return false;
 
-  return false;
+  int First = Dims[Dims.size() - 2];
+  int Second = Dims[Dims.size() - 1];
+  if ((FirstPos != -1 && FirstPos != First) ||
+      (SecondPos != -1 && SecondPos != Second))
+    return false;
+  FirstPos = First;
+  SecondPos = Second;
+  return true;
 }
 
 /// Does the memory access represent a non-scalar operand of the matrix
@@ -760,6 +780,9 @@ static bool containsOnlyMatMulDep(isl::map Schedule, const Dependences *D,
 ///    and all memory accesses of the SCoP that are different from MA1, MA2,
 ///    MA3, and MA4 have stride 0, if the innermost loop is exchanged with any
 ///    of loops i1, i2 and i3.
+/// 4. The operands may be indexed by further loops in front of their last two
+///    dimensions, as in a batched matrix multiplication or a tensor
+///    contraction, as long as each of those loops indexes the result MA1.
 ///
 /// @param PartialSchedule The PartialSchedule that contains a SCoP statement
 ///        to check.
@@ -794,6 +817,28 @@ static bool containsMatrMult(isl::map PartialSchedule, const Dependences *D,
 
   if (!MMI.A || !MMI.B || !MMI.ReadFromC)
     return false;
+
+  // The loops around i, j and k must be the batch or free dimensions of C,
+  // which C is read and written at, and which no other loop of the
+  // multiplication indexes.
+  isl::set Domain = Stmt->getDomain();
+  SmallVector<int, 4> DimsC, DimsReadC, DimsA, DimsB;
+  getOperandDims(Domain, MMI.WriteToC->getLatestAccessRelation(), DimsC);
+  getOperandDims(Domain, MMI.ReadFromC->getLatestAccessRelation(), DimsReadC);
+  getOperandDims(Domain, MMI.A->getLatestAccessRelation(), DimsA);
+  getOperandDims(Domain, MMI.B->getLatestAccessRelation(), DimsB);
+  if (DimsC != DimsReadC)
+    return false;
+  for (int Dim : {MMI.i, MMI.j, MMI.k}) {
+    if (is_contained(makeArrayRef(DimsC).drop_back(2), Dim) ||
+        is_contained(makeArrayRef(DimsA).drop_back(2), Dim) ||
+        is_contained(makeArrayRef(DimsB).drop_back(2), Dim))
+      return false;
+  }
+  for (int Dim = 0, E = Domain.dim(isl::dim::set); Dim < E; Dim++)
+    if (Dim != MMI.i && Dim != MMI.j && Dim != MMI.k &&
+        !is_contained(DimsC, Dim))
+      return false;
   return true;
 }
 
@@ -913,6 +958,15 @@ getMicroKernelParams(const TargetTransformInfo *TTI, MatMulInfoTy MMI) {
   int Nr =
       ceil(sqrt(Nvec * LatencyVectorFma * ThroughputVectorFma) / Nvec) * Nvec;
   int Mr = ceil(Nvec * LatencyVectorFma * ThroughputVectorFma / Nr);
+
+  // The Mr x Nr block of C, a row of the block of B and an element of A are
+  // kept in vector registers. Give up some of the latency hiding rather than
+  // spill them on a target with few registers.
+  long NumRegisters = TTI->getNumberOfRegisters(true);
+  long NrRegisters = (Nr + Nvec - 1) / Nvec;
+  while (NumRegisters > 0 && Mr > 1 &&
+         Mr * NrRegisters + NrRegisters + 1 > NumRegisters)
+    Mr--;
   return {Mr, Nr};
 }
 
@@ -1017,8 +1071,9 @@ getMacroKernelParams(const llvm::TargetTransformInfo *TTI,
 ///        the matrix multiplication pattern.
 ///
 /// Create an access relation of the following form:
-/// [O0, O1, O2, O3, O4, O5, O6, O7, O8] -> [OI, O5, OJ]
-/// where I is @p FirstDim, J is @p SecondDim.
+/// [..., O0, O1, O2, O3, O4, O5, O6, O7, O8] -> [OI, O5, OJ]
+/// where I is @p FirstDim, J is @p SecondDim, and the dimensions in front of
+/// O0 are the loops around the kernels, if any.
 ///
 /// It can be used, for example, to create relations that helps to consequently
 /// access elements of operands of a matrix multiplication after creation of
@@ -1041,11 +1096,15 @@ getMacroKernelParams(const llvm::TargetTransformInfo *TTI,
 /// @return The specified access relation.
 isl::map getMatMulAccRel(isl::map MapOldIndVar, unsigned FirstDim,
                          unsigned SecondDim) {
-  auto AccessRelSpace = isl::space(MapOldIndVar.get_ctx(), 0, 9, 3);
+  unsigned Dims = MapOldIndVar.dim(isl::dim::out);
+  unsigned Offset = Dims - 9;
+  auto AccessRelSpace = isl::space(MapOldIndVar.get_ctx(), 0, Dims, 3);
   auto AccessRel = isl::map::universe(AccessRelSpace);
-  AccessRel = AccessRel.equate(isl::dim::in, FirstDim, isl::dim::out, 0);
-  AccessRel = AccessRel.equate(isl::dim::in, 5, isl::dim::out, 1);
-  AccessRel = AccessRel.equate(isl::dim::in, SecondDim, isl::dim::out, 2);
+  AccessRel =
+      AccessRel.equate(isl::dim::in, Offset + FirstDim, isl::dim::out, 0);
+  AccessRel = AccessRel.equate(isl::dim::in, Offset + 5, isl::dim::out, 1);
+  AccessRel =
+      AccessRel.equate(isl::dim::in, Offset + SecondDim, isl::dim::out, 2);
   return MapOldIndVar.apply_range(AccessRel);
 }
 
@@ -1095,6 +1154,9 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
                                  MatMulInfoTy &MMI) {
   auto InputDimsId = MapOldIndVar.get_tuple_id(isl::dim::in);
   auto *Stmt = static_cast<ScopStmt *>(InputDimsId.get_user());
+  // The number of loops around the kernels, which copy a block of A and B for
+  // each of their iterations.
+  unsigned Offset = MapOldIndVar.dim(isl::dim::out) - 9;
 
   // Create a copy statement that corresponds to the memory access to the
   // matrix B, the second operand of the matrix multiplication.
@@ -1110,8 +1172,8 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
   AccRel = AccRel.set_tuple_id(isl::dim::out, SAI->getBasePtrId());
   auto OldAcc = MMI.B->getLatestAccessRelation();
   MMI.B->setNewAccessRelation(AccRel);
-  auto ExtMap = MapOldIndVar.project_out(isl::dim::out, 2,
-                                         MapOldIndVar.dim(isl::dim::out) - 2);
+  auto ExtMap = MapOldIndVar.project_out(
+      isl::dim::out, Offset + 2, MapOldIndVar.dim(isl::dim::out) - Offset - 2);
   ExtMap = ExtMap.reverse();
   ExtMap = ExtMap.fix_si(isl::dim::out, MMI.i, 0);
   auto Domain = Stmt->getDomain();
@@ -1138,8 +1200,8 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
   AccRel = AccRel.set_tuple_id(isl::dim::out, SAI->getBasePtrId());
   OldAcc = MMI.A->getLatestAccessRelation();
   MMI.A->setNewAccessRelation(AccRel);
-  ExtMap = MapOldIndVar.project_out(isl::dim::out, 3,
-                                    MapOldIndVar.dim(isl::dim::out) - 3);
+  ExtMap = MapOldIndVar.project_out(
+      isl::dim::out, Offset + 3, MapOldIndVar.dim(isl::dim::out) - Offset - 3);
   ExtMap = ExtMap.reverse();
   ExtMap = ExtMap.fix_si(isl::dim::out, MMI.j, 0);
   NewStmt = Stmt->getParent()->addScopStmt(
@@ -1162,7 +1224,9 @@ optimizeDataLayoutMatrMulPattern(isl::schedule_node Node, isl::map MapOldIndVar,
 /// @param MicroKernelParams, MacroKernelParams Parameters of the BLIS kernel
 ///                                             to be taken into account.
 /// @return  The relation mapping original induction variables to the ones
-///          produced by schedule transformation.
+///          produced by schedule transformation. Its last nine output
+///          dimensions are those of the kernels; the ones in front of them
+///          are the loops around the kernels.
 /// @see ScheduleTreeOptimizer::createMicroKernel
 /// @see ScheduleTreeOptimizer::createMacroKernel
 /// @see getMacroKernelParams
@@ -1173,9 +1237,8 @@ getInductionVariablesSubstitution(isl::schedule_node Node,
   auto Child = Node.child(0);
   auto UnMapOldIndVar = Child.get_prefix_schedule_union_map();
   auto MapOldIndVar = isl::map::from_union_map(UnMapOldIndVar);
-  if (MapOldIndVar.dim(isl::dim::out) > 9)
-    return MapOldIndVar.project_out(isl::dim::out, 0,
-                                    MapOldIndVar.dim(isl::dim::out) - 9);
+  if (MapOldIndVar.dim(isl::dim::out) < 9)
+    return nullptr;
   return MapOldIndVar;
 }
 
@@ -1288,6 +1351,17 @@ ScheduleTreeOptimizer::optimizeMatMulPattern(isl::schedule_node Node,
   Node = permuteBandNodeDimensions(Node, NewJ, DimOutNum - 2);
   NewK = NewK == DimOutNum - 2 ? NewJ : NewK;
   Node = permuteBandNodeDimensions(Node, NewK, DimOutNum - 1);
+
+  // The loops of a batched matrix multiplication or a tensor contraction that
+  // are not i, j or k stay a band of their own around the kernels. They carry
+  // no dependences.
+  if (DimOutNum > 3) {
+    Node = isl::manage(
+        isl_schedule_node_band_split(Node.release(), DimOutNum - 3));
+    for (int i = 0; i < DimOutNum - 3; i++)
+      Node = Node.band_member_set_coincident(i, true);
+    Node = Node.child(0);
+  }
   auto MicroKernelParams = getMicroKernelParams(TTI, MMI);
   auto MacroKernelParams = getMacroKernelParams(TTI, MicroKernelParams, MMI);
   Node = createMacroKernel(Node, MacroKernelParams);
@@ -1479,6 +1553,9 @@ bool IslScheduleOptimizer::runOnScop(Scop &S) {
   const Dependences &D =
       getAnalysis<DependenceInfo>().getDependences(Dependences::AL_Statement);
 
+  // Start after the dependences, which are timed on their own.
+  ScopPhaseTimer Timer(S.getRegion(), "schedule");
+
   if (D.getSharedIslCtx() != S.getSharedIslCtx()) {
     LLVM_DEBUG(dbgs() << "DependenceInfo for another SCoP/isl_ctx\n");
     return false;